@@ -50,12 +50,20 @@ namespace onnx_mlir {
  *
  *  This call rely on executing onnx-mlir compiler. The user can override its
  *  default location by using the ONNX_MLIR_BIN_PATH environment variable.
+ *  When the ONNX_MLIR_DAEMON_SOCKET environment variable gives the Unix
+ *  socket of an onnx-mlir started with "--daemon", the compile is sent to it
+ *  instead, saving the startup of the compiler.
  *
  *  When generating libraries or jar files, the compiler will link in
  *  lightweight runtimes / jar files. If these libraries / jar files are not in
  *  the system wide directory (typically /usr/local/lib), the user can override
  *  the default location using the ONNX_MLIR_LIBRARY_PATH environment variable.
  *
+ *  When the "--compile-cache-dir" option or the ONNX_MLIR_COMPILE_CACHE_DIR
+ *  environment variable gives a cache directory, a library, object or jar file
+ *  compiled before from the same model with the same flags, target and
+ *  compiler version is copied from the cache instead of being compiled again.
+ *
  *  @param inputFilename File name pointing onnx model protobuf or MLIR.
  *  Name may include a path, and must include the file name and its extention.
  *
@@ -74,12 +82,17 @@ ONNX_MLIR_EXPORT int64_t omCompileFromFile(const char *inputFilename,
     const char *flags, const char **outputFilename, const char **errorMessage);
 
 /*!
- *  Compile an onnx model from an ONNX protobuf array. This method is not thread
- *  safe, and borrows the current compiler options currently defined in this
- *  process. When generating libraries or jar files, the compiler will link in
- *  lightweight runtimes / jar files. If these libraries / jar files are not in
- *  the system wide directory (typically /usr/local/lib), the user can override
- *  the default location using the ONNX_MLIR_LIBRARY_PATH environment variable.
+ *  Compile an onnx model from an ONNX protobuf array. This method borrows the
+ *  current compiler options currently defined in this process, and is thus not
+ *  thread safe with respect to the calls setting them. The compile sessions
+ *  below give their own options to each compile instead. When generating
+ *  libraries or jar files, the compiler will link in lightweight runtimes /
+ *  jar files. If these libraries / jar files are not in the system wide
+ *  directory (typically /usr/local/lib), the user can override the default
+ *  location using the ONNX_MLIR_LIBRARY_PATH environment variable.
+ *  As for omCompileFromFile, the output file is copied from the compilation
+ *  cache when the ONNX_MLIR_COMPILE_CACHE_DIR environment variable is set and
+ *  the cache has it, the key covering the current compiler options.
  *
  *  @param inputBuffer ONNX protobuf array.
  *  @param bufferSize Size of ONNX protobuf array.
@@ -98,6 +111,108 @@ ONNX_MLIR_EXPORT int64_t omCompileFromArray(const void *inputBuffer,
     EmissionTargetType emissionTarget, const char **outputFilename,
     const char **errorMessage);
 
+/*!
+ *  Compile an onnx model from an ONNX protobuf array into a shared library
+ *  returned in a memory buffer, e.g. to be loaded by an ExecutionSession
+ *  without a library file. The options are borrowed as by
+ *  omCompileFromArray. The files of the compilation are written in a
+ *  temporary directory, given by the TMPDIR environment variable, e.g. on a
+ *  tmpfs, which is removed before returning. Models whose constants are
+ *  stored in a separate file with --store-constants-to-file are not
+ *  supported.
+ *
+ *  @param inputBuffer ONNX protobuf array.
+ *  @param bufferSize Size of ONNX protobuf array.
+ *  @param outputBuffer Output buffer holding the shared library. User is
+ * responsible for freeing the buffer.
+ *  @param outputBufferSize Output size of the shared library in bytes.
+ *  @param errorMessage Error message. User is responsible for freeing the
+ * string.
+ *  @return 0 on success or OnnxMlirCompilerErrorCodes failure.
+ */
+ONNX_MLIR_EXPORT int64_t omCompileFromArrayToBuffer(const void *inputBuffer,
+    int64_t bufferSize, void **outputBuffer, int64_t *outputBufferSize,
+    const char **errorMessage);
+
+/*!
+ *  Opaque handle to a compile session, which owns the compiler options of the
+ *  compiles it runs as well as the context setup they share.
+ */
+struct OMCompileSession;
+#ifndef __cplusplus
+typedef struct OMCompileSession OMCompileSession;
+#endif
+
+/*!
+ *  Create a compile session compiling with the given flags. The flags are the
+ *  options of onnx-mlir, other than the input file, the output file and the
+ *  emission target, which are given to each compile. They are parsed once by
+ *  this call and given to each compile of the session, whatever the options
+ *  of the process or of the other sessions.
+ *
+ *  Sessions may be created, used and destroyed from any number of threads, a
+ *  session running compiles from several threads at once. The compiler passes
+ *  reading the process-global options, the compiles of all the sessions and
+ *  omCompileFromArray are serialized. Each compile of a session sets the
+ *  options of the process to its own, the others being reset to their
+ *  defaults. The contexts of the compiles of a session share its thread pool.
+ *
+ *  @param flags A char * contains all the options of the compiles.
+ *  @param errorMessage Output error message, if any. User is responsible for
+ * freeing the string.
+ *  @return pointer to the session created, NULL if the flags are invalid.
+ */
+ONNX_MLIR_EXPORT OMCompileSession *omCompileSessionCreate(
+    const char *flags, const char **errorMessage);
+
+/*!
+ *  Compile an onnx model from an ONNX protobuf array with the options of the
+ *  session, as by omCompileFromArray. The compilation cache key covers the
+ *  flags of the session.
+ *
+ *  @param session Session giving the options of the compile.
+ *  @param inputBuffer ONNX protobuf array.
+ *  @param bufferSize Size of ONNX protobuf array.
+ *  @param outputBaseName File name without extension to write output.
+ *  @param emissionTarget Target format to compile to.
+ *  @param outputFilename Output file name of the compiled output for the given
+ * emission target. User is responsible for freeing the string.
+ *  @param errorMessage Error message. User is responsible for freeing the
+ * string.
+ *  @return 0 on success or OnnxMlirCompilerErrorCodes failure.
+ */
+ONNX_MLIR_EXPORT int64_t omCompileSessionCompileFromArray(
+    OMCompileSession *session, const void *inputBuffer, int64_t bufferSize,
+    const char *outputBaseName, EmissionTargetType emissionTarget,
+    const char **outputFilename, const char **errorMessage);
+
+/*!
+ *  Compile an onnx model from an ONNX protobuf array into a shared library
+ *  returned in a memory buffer with the options of the session, as by
+ *  omCompileFromArrayToBuffer.
+ *
+ *  @param session Session giving the options of the compile.
+ *  @param inputBuffer ONNX protobuf array.
+ *  @param bufferSize Size of ONNX protobuf array.
+ *  @param outputBuffer Output buffer holding the shared library. User is
+ * responsible for freeing the buffer.
+ *  @param outputBufferSize Output size of the shared library in bytes.
+ *  @param errorMessage Error message. User is responsible for freeing the
+ * string.
+ *  @return 0 on success or OnnxMlirCompilerErrorCodes failure.
+ */
+ONNX_MLIR_EXPORT int64_t omCompileSessionCompileFromArrayToBuffer(
+    OMCompileSession *session, const void *inputBuffer, int64_t bufferSize,
+    void **outputBuffer, int64_t *outputBufferSize, const char **errorMessage);
+
+/*!
+ *  Destroy a compile session, once none of its compiles is running.
+ *
+ *  @param session Session to destroy. The function simply returns when the
+ * pointer is null.
+ */
+ONNX_MLIR_EXPORT void omCompileSessionDestroy(OMCompileSession *session);
+
 #ifdef __cplusplus
 } // namespace onnx_mlir
 } // extern C
@@ -22,11 +22,15 @@
 #include <stdint.h>
 #endif
 
+#include <onnx-mlir/Runtime/OMAllocator.h>
+#include <onnx-mlir/Runtime/OMArena.h>
 #include <onnx-mlir/Runtime/OMEntryPoint.h>
 #include <onnx-mlir/Runtime/OMInstrument.h>
+#include <onnx-mlir/Runtime/OMMetrics.h>
 #include <onnx-mlir/Runtime/OMSignature.h>
 #include <onnx-mlir/Runtime/OMTensor.h>
 #include <onnx-mlir/Runtime/OMTensorList.h>
+#include <onnx-mlir/Runtime/OMThreadPool.h>
 
 /*! \mainpage ONNX-MLIR Runtime API documentation
  *
@@ -67,6 +71,27 @@
  * Intuitively, the model takes a list of tensors as input and returns a list of
  * tensors as output.
  *
+ * Every entry point also comes with a variant writing the results into output
+ * tensors preallocated by the caller, instead of allocating them:
+ *
+ * ```c
+ * OMTensorList* run_main_graph_into(OMTensorList* input, OMTensorList* output);
+ * ```
+ *
+ * The output list must hold one tensor per model output, whose data type,
+ * rank and buffer size match the ones of the result. The results are written
+ * into the tensor data buffers and the tensor shapes and strides are updated.
+ * When all the results have static shapes and are computed by the model, they
+ * are computed in place in the buffers, without any allocation or copy.
+ * Otherwise, they are copied into the buffers.
+ * The output list is returned on success, and NULL with errno set otherwise.
+ * The caller keeps the ownership of the output list and its tensors, so that
+ * their memory may be reused across inferences.
+ *
+ * An entry point may also run asynchronously in a worker of the runtime thread
+ * pool with `omRunAsync`, which calls back with the output list once the
+ * inference is done, so that several inferences may be in flight at once.
+ *
  * \subsection invoke-models-using-c-runtime-api Invoke Models Using C Runtime
  * API
  *
@@ -136,11 +161,80 @@
  * Otherwise, if owning is set to "false", the tensor array will not be freed upon destruction (needs to be freed manually).
  *
  *
+ * \subsection parallel-loops Parallel Loops
+ *
+ * Models compiled with `--parallel` run their parallel loops on a thread
+ * pool of the runtime. By default, loops run on a pool sized by the
+ * OM_NUM_THREADS env variable, or else by the number of online CPUs. A thread
+ * calling models may instead select its own pool, e.g. with workers pinned to
+ * some CPUs, and cap the number of threads taking part in each loop:
+ *
+ * ```c
+ * int64_t cpus[] = {0, 1, 2, 3};
+ * OMThreadPool *pool = omThreadPoolCreate(4, cpus);
+ * omThreadPoolBind(pool, 2);
+ * OMTensorList *outputList = run_main_graph(input);
+ * ```
+ *
+ * The runtime is statically linked into each model library, which thus has
+ * its own default pool and its own pool selected by each thread, shared by
+ * the models of that library only. The pools must then be created and bound
+ * with the functions of the model library, e.g. looked up with dlsym, as the
+ * ones of a program linked with the runtime library select the pools of
+ * another copy of the runtime. A process running the models of several
+ * libraries at once starts one default pool per library, and should rather
+ * give each library a smaller pool, e.g. on distinct CPUs.
+ *
+ * \subsection memory-arena Memory Arena
+ *
+ * Models compiled with `--dynamic-memory-arena` allocate their internal
+ * buffers of dynamic shape from a memory arena of the calling thread rather
+ * than with one malloc and free per buffer. The arena is given back at the
+ * end of each inference and its memory is kept for the next ones. Models
+ * compiled with `--static-memory-arena` also allocate their memory pools of
+ * static shape from it, so that with both options the internal buffers of an
+ * inference take a single block of the arena. A thread may reserve this block
+ * before its first inference, e.g. with the peak usage measured by
+ * `omArenaGetStats`, and free it once done with inferences:
+ *
+ * ```c
+ * omArenaReserve(peakBytes);
+ * OMTensorList *outputList = run_main_graph(input);
+ * omArenaDestroy();
+ * ```
+ *
+ * \subsection allocators Allocators
+ *
+ * The blocks of the memory arenas, and the constants of models compiled with
+ * a constants file, are allocated by the allocator of the thread running the
+ * inference. By default it is the malloc one; an `OMAllocator` of the caller
+ * or a built-in one may instead be selected for the calling thread, or for
+ * all the threads without one. The built-in allocators back their memory
+ * with huge pages, transparent or explicit, and place it on a NUMA node,
+ * e.g. to run one model replica per socket on threads pinned to it:
+ *
+ * ```c
+ * OMAllocator *allocator =
+ *     omAllocatorCreate(OM_PAGES_TRANSPARENT_HUGE, OM_NUMA_NODE_LOCAL);
+ * omAllocatorBind(allocator);
+ * OMTensorList *outputList = run_main_graph(input);
+ * ```
+ *
+ * Constants are copied into memory of the allocator when first loaded,
+ * instead of being mapped from the file.
+ *
+ * The memory allocated by the runtime is accounted without locking, see
+ * `omAllocatorGetStats`, as are the buffers of the memory arena of each
+ * thread, see `omArenaGetStats`. The instrumentation reports both.
+ *
  * \subsection reference Reference
  *
  * For full reference to available C Runtime API, refer to
- * `include/onnx-mlir/Runtime/OMTensor.h` and
- * `include/onnx-mlir/Runtime/OMTensorList.h`.
+ * `include/onnx-mlir/Runtime/OMTensor.h`,
+ * `include/onnx-mlir/Runtime/OMTensorList.h`,
+ * `include/onnx-mlir/Runtime/OMThreadPool.h`,
+ * `include/onnx-mlir/Runtime/OMArena.h` and
+ * `include/onnx-mlir/Runtime/OMAllocator.h`.
  *
  */
 
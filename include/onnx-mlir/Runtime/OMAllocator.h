@@ -0,0 +1,204 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------ OMAllocator.h - OMAllocator Declaration header ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declaration of the allocators backing the memory arenas
+// and the constants of compiled models.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ONNX_MLIR_OMALLOCATOR_H
+#define ONNX_MLIR_OMALLOCATOR_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif // #ifdef __cplusplus
+
+#include <onnx-mlir/Compiler/OMCompilerMacros.h>
+
+/**
+ * Allocator of the memory of the runtime.
+ *
+ * A buffer returned by alloc is given back to free of the same allocator,
+ * with the size it was allocated with. Both are called with the context of
+ * the allocator and may be called concurrently from several threads.
+ */
+typedef struct OMAllocator {
+  /** Allocate size bytes aligned on alignment, a power of two, or return
+   * NULL. */
+  void *(*alloc)(void *context, int64_t size, int64_t alignment);
+  /** Free a buffer of size bytes returned by alloc. */
+  void (*free)(void *context, void *ptr, int64_t size);
+  void *context;
+} OMAllocator;
+
+/**
+ * Pages backing the memory of the built-in allocators.
+ */
+typedef enum {
+  /** Regular pages. */
+  OM_PAGES_DEFAULT = 0,
+  /** Transparent huge pages, given by the kernel when it can. */
+  OM_PAGES_TRANSPARENT_HUGE = 1,
+  /** Explicit huge pages reserved by the administrator, or else transparent
+   * huge pages once the reserved ones are exhausted. */
+  OM_PAGES_EXPLICIT_HUGE = 2,
+} OMAllocatorPages;
+
+/**
+ * Accounting of the memory allocated by the runtime.
+ */
+typedef struct OMMemoryStats {
+  /** Bytes currently allocated. */
+  int64_t currentBytes;
+  /** Highest number of bytes allocated at once. */
+  int64_t peakBytes;
+  /** Number of allocations. */
+  int64_t numAllocs;
+} OMMemoryStats;
+
+/** Node of a built-in allocator placing its memory on any NUMA node. */
+#define OM_NUMA_NODE_ANY -1
+/** Node of a built-in allocator placing its memory on the NUMA node of the
+ * CPU allocating it. */
+#define OM_NUMA_NODE_LOCAL -2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the built-in allocator using malloc, which allocates the memory of the
+ * threads without any other allocator.
+ *
+ * @return pointer to the allocator.
+ */
+OM_EXTERNAL_VISIBILITY const OMAllocator *omAllocatorGetMalloc();
+
+/**
+ * Create a built-in allocator mapping its buffers onto pages of the given
+ * kind, placed on the given NUMA node.
+ *
+ * Buffers are mapped directly from the kernel and their size is rounded up
+ * to a whole number of pages, of 2 MB for huge pages, so that the allocator
+ * fits large buffers such as the blocks of the memory arenas and the
+ * constants of the models. NUMA placement is a preference and pages are
+ * taken from another node once the requested one is full. Huge pages and
+ * NUMA placement are only supported on Linux and silently ignored otherwise.
+ *
+ * @param pages kind of pages backing the buffers.
+ * @param node NUMA node of the buffers, OM_NUMA_NODE_ANY or
+ * OM_NUMA_NODE_LOCAL.
+ * @return pointer to the allocator, or NULL with errno set if it cannot be
+ * created.
+ */
+OM_EXTERNAL_VISIBILITY OMAllocator *omAllocatorCreate(
+    OMAllocatorPages pages, int64_t node);
+
+/**
+ * Destroy an allocator created by omAllocatorCreate, after all its buffers
+ * are freed and it is no longer bound nor the default.
+ *
+ * @param allocator pointer to the allocator, or NULL.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorDestroy(OMAllocator *allocator);
+
+/**
+ * Select the allocator of the memory of the calling thread, e.g. an
+ * allocator placing the memory on the NUMA node of the CPUs the thread is
+ * pinned to. The allocator must outlive the buffers it allocated, e.g. the
+ * blocks of the memory arena of the thread, see omArenaDestroy.
+ *
+ * @param allocator pointer to the allocator, or NULL for the default one.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorBind(const OMAllocator *allocator);
+
+/**
+ * Set the allocator of the memory of the threads that did not select one,
+ * including the workers of the thread pools. It must not be called while
+ * other threads run inferences.
+ *
+ * @param allocator pointer to the allocator, or NULL for the malloc one.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorSetDefault(const OMAllocator *allocator);
+
+/**
+ * Get the allocator of the memory of the calling thread.
+ *
+ * @return pointer to the allocator bound to the calling thread, or else to
+ * the default one.
+ */
+OM_EXTERNAL_VISIBILITY const OMAllocator *omAllocatorGet();
+
+/**
+ * Allocate a buffer with an allocator, accounted in the statistics of
+ * omAllocatorGetStats. The runtime allocates the blocks of the memory arenas
+ * and the constants of the models with it.
+ *
+ * @param allocator pointer to the allocator.
+ * @param size size of the buffer in bytes.
+ * @param alignment alignment of the buffer in bytes, a power of two.
+ * @return pointer to the buffer, or NULL if it cannot be allocated.
+ */
+OM_EXTERNAL_VISIBILITY void *omAllocatorAlloc(
+    const OMAllocator *allocator, int64_t size, int64_t alignment);
+
+/**
+ * Free a buffer allocated by omAllocatorAlloc with the same allocator.
+ *
+ * @param allocator pointer to the allocator.
+ * @param ptr pointer to the buffer, or NULL.
+ * @param size size of the buffer in bytes, as allocated.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorFree(
+    const OMAllocator *allocator, void *ptr, int64_t size);
+
+/**
+ * Allocate a buffer whose consecutive parts are placed on consecutive NUMA
+ * nodes, e.g. for the constants read by the threads of each node in turn.
+ *
+ * The buffer is mapped directly from the kernel in pages, part n being
+ * preferably placed on node n from the page containing its first byte on, as
+ * for the allocators created by omAllocatorCreate. NUMA placement is only
+ * supported on Linux, and the buffer is allocated by malloc otherwise. It is
+ * accounted as the buffers of omAllocatorAlloc.
+ *
+ * @param size size of the buffer in bytes.
+ * @param numNodes number of parts, placed on the nodes 0 to numNodes - 1.
+ * @param partOffsets array of the numNodes offsets in bytes of the parts, in
+ * increasing order from 0.
+ * @return pointer to the buffer, aligned on 4096 bytes, or NULL with errno
+ * set if it cannot be allocated.
+ */
+OM_EXTERNAL_VISIBILITY void *omAllocatorAllocOnNodes(
+    int64_t size, int64_t numNodes, const int64_t *partOffsets);
+
+/**
+ * Free a buffer allocated by omAllocatorAllocOnNodes.
+ *
+ * @param ptr pointer to the buffer, or NULL.
+ * @param size size of the buffer in bytes, as allocated.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorFreeOnNodes(void *ptr, int64_t size);
+
+/**
+ * Get the accounting of the buffers allocated by omAllocatorAlloc, by all
+ * the threads. It is read without stopping the threads allocating buffers.
+ *
+ * @param stats pointer to the statistics to set.
+ */
+OM_EXTERNAL_VISIBILITY void omAllocatorGetStats(OMMemoryStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONNX_MLIR_OMALLOCATOR_H
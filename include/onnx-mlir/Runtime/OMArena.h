@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------- OMArena.h - OMArena Declaration header ----------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declaration of the memory arena holding the buffers of
+// dynamic shape of compiled models.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ONNX_MLIR_OMARENA_H
+#define ONNX_MLIR_OMARENA_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif // #ifdef __cplusplus
+
+#include <onnx-mlir/Compiler/OMCompilerMacros.h>
+#include <onnx-mlir/Runtime/OMAllocator.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocate a buffer from the memory arena of the calling thread.
+ *
+ * Buffers are bump allocated from blocks of the arena and are not freed
+ * individually: they are all given back at once by omArenaRelease. Each
+ * thread has its own arena, so concurrent inferences do not contend on a
+ * lock. Blocks are sized by powers of two and kept from one inference to the
+ * next. Once the arena is released, the blocks are merged into a single one
+ * sized for the peak usage, so that steady state inferences make no call to
+ * malloc. The blocks are allocated by the allocator of the calling thread,
+ * see omAllocatorBind, e.g. on huge pages.
+ *
+ * This is called by compiled models for their internal buffers of dynamic
+ * shape when compiled with `--dynamic-memory-arena`.
+ *
+ * @param size size of the buffer in bytes.
+ * @param alignment alignment of the buffer in bytes, a power of two.
+ * @return pointer to the buffer, or NULL if it cannot be allocated.
+ */
+OM_EXTERNAL_VISIBILITY void *omArenaAlloc(int64_t size, int64_t alignment);
+
+/**
+ * Get the current position in the memory arena of the calling thread.
+ *
+ * @return position to give to omArenaRelease.
+ */
+OM_EXTERNAL_VISIBILITY int64_t omArenaMark();
+
+/**
+ * Give back to the memory arena of the calling thread all the buffers
+ * allocated since the position was obtained by omArenaMark.
+ *
+ * @param mark position returned by omArenaMark.
+ */
+OM_EXTERNAL_VISIBILITY void omArenaRelease(int64_t mark);
+
+/**
+ * Reserve a first block of at least the given size in the memory arena of the
+ * calling thread, so that even the first inference of a session allocating
+ * at most this size from the arena makes no call to malloc. The block is
+ * allocated by the allocator of the calling thread. Nothing is done when the
+ * arena holds buffers or already has such a block.
+ *
+ * @param size size of the block in bytes, e.g. the peak usage of an inference
+ * given by omArenaGetStats.
+ * @return 0 on success, -1 if the block cannot be allocated.
+ */
+OM_EXTERNAL_VISIBILITY int omArenaReserve(int64_t size);
+
+/**
+ * Get the accounting of the buffers of the memory arena of the calling
+ * thread: the bytes they span, alignment included, currently and at most
+ * since the arena was destroyed or its peak reset, and the number of buffers
+ * allocated.
+ *
+ * @param stats pointer to the statistics to set.
+ */
+OM_EXTERNAL_VISIBILITY void omArenaGetStats(OMMemoryStats *stats);
+
+/**
+ * Lower the peak of the accounting of the memory arena of the calling thread
+ * to its current usage, so that omArenaGetStats then gives the peak usage of
+ * the next inferences, e.g. of each inference for the metrics. The blocks of
+ * the arena are still sized for the peak usage of all the inferences.
+ */
+OM_EXTERNAL_VISIBILITY void omArenaResetPeak();
+
+/**
+ * Free the blocks of the memory arena of the calling thread, e.g. before the
+ * thread exits. The arena must not hold any buffer.
+ */
+OM_EXTERNAL_VISIBILITY void omArenaDestroy();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONNX_MLIR_OMARENA_H
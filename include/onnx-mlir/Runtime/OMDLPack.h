@@ -0,0 +1,143 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------- OMDLPack.h - OMTensor DLPack Interop -----------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declaration of the conversions between OMTensors and
+// DLPack tensors, such as the ones of PyTorch, NumPy or CuPy, sharing their
+// data without copying it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ONNX_MLIR_OMDLPACK_H
+#define ONNX_MLIR_OMDLPACK_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif // #ifdef __cplusplus
+
+#include "onnx-mlir/Compiler/OMCompilerMacros.h"
+#include "onnx-mlir/Runtime/OMTensor.h"
+
+/* The types of the DLPack ABI used by the conversions, as declared by
+ * dlpack.h (https://github.com/dmlc/dlpack), which may be included instead,
+ * before or after this header.
+ */
+#ifndef DLPACK_DLPACK_H_
+#define DLPACK_DLPACK_H_
+
+#define DLPACK_VERSION 80
+#define DLPACK_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+  kDLOpenCL = 4,
+  kDLVulkan = 7,
+  kDLMetal = 8,
+  kDLVPI = 9,
+  kDLROCM = 10,
+  kDLROCMHost = 11,
+  kDLExtDev = 12,
+  kDLCUDAManaged = 13,
+  kDLOneAPI = 14,
+  kDLWebGPU = 15,
+  kDLHexagon = 16,
+} DLDeviceType;
+
+typedef struct {
+  DLDeviceType device_type;
+  int32_t device_id;
+} DLDevice;
+
+typedef enum {
+  kDLInt = 0U,
+  kDLUInt = 1U,
+  kDLFloat = 2U,
+  kDLOpaqueHandle = 3U,
+  kDLBfloat = 4U,
+  kDLComplex = 5U,
+  kDLBool = 6U,
+} DLDataTypeCode;
+
+typedef struct {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+  void *data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t *shape;
+  int64_t *strides;
+  uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void *manager_ctx;
+  void (*deleter)(struct DLManagedTensor *self);
+} DLManagedTensor;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DLPACK_DLPACK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Create an OMTensor viewing the data of a DLPack tensor in place.
+ *
+ * The OMTensor has the shape, strides and element type of the DLPack tensor,
+ * and does not own its data: the caller keeps the DLPack tensor alive until
+ * the OMTensor is destroyed, and then releases it by calling its deleter.
+ * The strides of a DLPack tensor without strides are the ones of its
+ * contiguous row-major layout.
+ *
+ * @param dlTensor pointer to the DLPack tensor, in the memory of the CPU, of
+ * elements of one lane of an ONNX data type.
+ * @return pointer to OMTensor created, or NULL with errno set to EINVAL if the
+ * DLPack tensor is not supported, or to ENOMEM.
+ */
+OM_EXTERNAL_VISIBILITY OMTensor *omTensorFromDLPack(
+    const DLManagedTensor *dlTensor);
+
+/**
+ * \brief Create a DLPack tensor taking the ownership of an OMTensor.
+ *
+ * The DLPack tensor shares the data, shape and strides of the OMTensor, which
+ * its deleter destroys, freeing the data if the OMTensor owns it. The
+ * OMTensor is no longer used by the caller.
+ *
+ * @param tensor pointer to the OMTensor, of an ONNX data type other than
+ * STRING.
+ * @return pointer to the DLPack tensor, or NULL with errno set to EINVAL if
+ * the data type is not supported, or to ENOMEM, in which case the OMTensor
+ * is left to the caller.
+ */
+OM_EXTERNAL_VISIBILITY DLManagedTensor *omTensorToDLPack(OMTensor *tensor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONNX_MLIR_OMDLPACK_H
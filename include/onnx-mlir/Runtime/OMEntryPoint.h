@@ -24,6 +24,9 @@ extern "C" {
  * \brief Return all entry point names in a model. These entry point names are
  * the symbols of the inference functions in the model. Users use them to run
  * inference, e.g. by calling `entry_point_name(OMTensorList).
+ * Each entry point also has a variant named `entry_point_name_into` that
+ * writes the results into preallocated output tensors, e.g. by calling
+ * `entry_point_name_into(OMTensorList, OMTensorList)`.
  *
  * An entry point name can be passed to functions `omInputSignature` and
  * `omOutputSignature` to query its input and output signatures, respectively.
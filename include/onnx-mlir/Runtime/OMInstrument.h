@@ -65,6 +65,66 @@ OM_EXTERNAL_VISIBILITY void OMInstrumentInit();
 OM_EXTERNAL_VISIBILITY void OMInstrumentPoint(
     const char *opName, int64_t tag, const char *nodeName);
 
+/**
+ * Add bytes to the op being run by the calling thread, e.g. the bytes
+ * converted by a stick or unstick op. They are reported with the op at its
+ * next instrument point after the op.
+ *
+ * @param bytes number of bytes to add.
+ * @return void
+ *
+ */
+OM_EXTERNAL_VISIBILITY void OMInstrumentBytes(int64_t bytes);
+
+/**
+ * Report the latencies of the instrumented ops in profiling mode.
+ * Profiling mode is enabled by the OMINSTRUMENTPROFILE env variable. In this
+ * mode, instrument points record the latency of each op in per-thread
+ * buffers instead of printing it. The report lists the count, total, mean,
+ * median (p50), 99th percentile (p99), and maximum latency of each op type
+ * and of each node, in microseconds, and the bytes added by
+ * OMInstrumentBytes. When NNPA ops are recorded, the total latency is also
+ * split between NNPA calls, stick/unstick conversions, and other CPU ops. It
+ * is also printed at exit to the file named by OMINSTRUMENTPROFILE.
+ *
+ * @param fileName name of the file to write the report to, or NULL, "", or
+ * "-" to write the report to stdout.
+ * @return 0 on success, or -1 with errno set if the file cannot be written.
+ *
+ */
+OM_EXTERNAL_VISIBILITY int OMInstrumentProfileReport(const char *fileName);
+
+/**
+ * Discard the latencies recorded so far in profiling mode.
+ *
+ */
+OM_EXTERNAL_VISIBILITY void OMInstrumentProfileReset();
+
+/**
+ * Enable tracing mode, as the OMINSTRUMENTTRACE env variable does.
+ * In tracing mode, instrument points record the start and end times of each
+ * op in per-thread buffers, as in profiling mode, and each thread also keeps
+ * its records in a trace buffer of its own, bounded to 65536 records beyond
+ * which its ops are dropped from the trace. Nothing is written at instrument
+ * points: the trace is written by OMInstrumentTraceWrite, and at exit to the
+ * file named by OMINSTRUMENTTRACE.
+ *
+ */
+OM_EXTERNAL_VISIBILITY void OMInstrumentTraceEnable();
+
+/**
+ * Write the records of tracing mode as a Chrome Trace Event JSON file, which
+ * can be loaded into chrome://tracing or Perfetto. Each op is a complete
+ * event, named after the op type, with the node name and the bytes added by
+ * OMInstrumentBytes as arguments, on the timeline of the thread that ran it.
+ *
+ * @param fileName name of the file to write the trace to, or NULL, "", or
+ * "-" to write the trace to stdout.
+ * @return 0 on success, or -1 with errno set if the file cannot be written.
+ *
+ */
+OM_EXTERNAL_VISIBILITY int OMInstrumentTraceWrite(const char *fileName);
+
 #ifdef __cplusplus
 }
 #endif
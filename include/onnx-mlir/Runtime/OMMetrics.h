@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------- OMMetrics.h - OMMetrics Declaration header ------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declaration of the callback reporting the metrics of each
+// inference, e.g. to export them to a monitoring system.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ONNX_MLIR_OMMETRICS_H
+#define ONNX_MLIR_OMMETRICS_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif // #ifdef __cplusplus
+
+#include <onnx-mlir/Compiler/OMCompilerMacros.h>
+
+/**
+ * Metrics of an inference, measured in the thread running it.
+ * Fields are only ever appended, so that a callback compiled against an
+ * older version of the struct reads the fields it knows, and may check
+ * structSize before reading the newer ones.
+ */
+typedef struct OMInferenceMetrics {
+  /** Size of the struct in bytes. */
+  int64_t structSize;
+  /** Name of the entry point run, e.g. "run_main_graph". */
+  const char *entryPointName;
+  /** Latency of the inference in nanoseconds. */
+  int64_t latencyNanos;
+  /** Bytes of the output tensors allocated for the caller, 0 when the
+   * outputs are preallocated by the caller. */
+  int64_t outputBytes;
+  /** Peak bytes used in the memory arena of the thread, see omArenaAlloc,
+   * and number of buffers allocated from it. */
+  int64_t peakArenaBytes;
+  int64_t numArenaAllocs;
+  /** Highest number of threads taking part in a parallel loop of the
+   * inference, 0 if it ran no parallel loop. */
+  int64_t numThreads;
+  /** Errno of a failed inference, or 0. */
+  int errorCode;
+} OMInferenceMetrics;
+
+/**
+ * Callback called with the metrics of each inference, in the thread that ran
+ * it, once it is done. It must be cheap, e.g. only update counters and
+ * histograms, as it delays the return of the inference. The metrics are only
+ * valid during the call.
+ */
+typedef void (*OMMetricsCallback)(
+    void *context, const OMInferenceMetrics *metrics);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Register the callback reporting the metrics of each inference run through
+ * the ExecutionSession and ExecutionEntryPoint classes, synchronously or
+ * not. When no callback is registered, the inferences measure nothing. It
+ * must not be called while other threads run inferences. Unlike the
+ * OMInstrument functions, which trace the ops of models compiled with
+ * instrumentation, it reports whole inferences of any model.
+ *
+ * @param callback function called after each inference, or NULL to stop
+ * reporting metrics.
+ * @param context argument passed to each call of callback.
+ */
+OM_EXTERNAL_VISIBILITY void omMetricsSetCallback(
+    OMMetricsCallback callback, void *context);
+
+/**
+ * Get the callback registered by omMetricsSetCallback.
+ *
+ * @param context pointer to set to the context of the callback, or NULL.
+ * @return the callback, or NULL if none is registered.
+ */
+OM_EXTERNAL_VISIBILITY OMMetricsCallback omMetricsGetCallback(void **context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONNX_MLIR_OMMETRICS_H
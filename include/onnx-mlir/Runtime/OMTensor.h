@@ -143,6 +143,46 @@ OM_EXTERNAL_VISIBILITY OMTensor *omTensorCreateWithOwnership(void *data_ptr,
 OM_EXTERNAL_VISIBILITY OMTensor *omTensorCreateEmpty(
     int64_t *shape, int64_t rank, OM_DATA_TYPE dtype);
 
+/**
+ * \brief Create a string OMTensor from contiguous strings, given as in Apache
+ * Arrow by a byte array and the offsets of the strings in it.
+ *
+ * The element i of the tensor, in row-major order, is made of the bytes
+ * [offsets[i], offsets[i + 1]) of the byte array, without null terminator.
+ * The OMTensor owns a single buffer holding the pointers to its strings,
+ * followed by the bytes of the strings, each one null terminated, so that the
+ * strings of consecutive elements are adjacent in memory and the tensor is
+ * created with one allocation, whatever its number of elements.
+ *
+ * @param bytes pointer to the bytes of the strings.
+ * @param offsets offsets of the strings in the bytes, the number of elements
+ * plus one.
+ * @param shape list of integers indicating the tensor shape.
+ * @param rank tensor rank.
+ * @return pointer to OMTensor created, NULL if creation failed.
+ *
+ */
+OM_EXTERNAL_VISIBILITY OMTensor *omTensorCreateStrings(
+    const char *bytes, const int64_t *offsets, int64_t *shape, int64_t rank);
+
+/**
+ * \brief Get the elements of a string OMTensor as contiguous strings, given by
+ * a byte array and the offsets of the strings in it as in Apache Arrow.
+ *
+ * Sets the offsets so that the element i of the tensor, in row-major order,
+ * is made of the bytes [offsets[i], offsets[i + 1]) of the byte array, and
+ * copies the strings, without their null terminator, into the byte array.
+ * Either array may be NULL, e.g. to get the size of the byte array first.
+ *
+ * @param tensor pointer to the string OMTensor.
+ * @param bytes pointer to the byte array, or NULL.
+ * @param offsets pointer to the offsets, the number of elements plus one, or
+ * NULL.
+ * @return size in bytes of the strings.
+ */
+OM_EXTERNAL_VISIBILITY int64_t omTensorGetStrings(
+    const OMTensor *tensor, char *bytes, int64_t *offsets);
+
 /**
  * \brief Destroy the OMTensor struct.
  *
@@ -107,6 +107,53 @@ OM_EXTERNAL_VISIBILITY int64_t omTensorListGetSize(OMTensorList *list);
 OM_EXTERNAL_VISIBILITY OMTensor *omTensorListGetOmtByIndex(
     OMTensorList *list, int64_t index);
 
+/**
+ * \brief OMTensorList aligned data pointers getter
+ *
+ * The data of the OMTensors that are not aligned to the given alignment are
+ * copied into aligned buffers allocated by the current allocator, the other
+ * OMTensors having their own data pointers returned. The compiled models call
+ * it to pass aligned inputs to their entry points. The OMTensors are not
+ * modified and the returned pointers must be freed by
+ * omTensorListFreeAlignedDataPtrs once they are no longer used.
+ *
+ * @param list pointer to the OMTensorList
+ * @param alignment alignment of the data pointers in bytes, a power of two
+ * @return pointer to the array of data pointers, NULL if a buffer cannot be
+ * allocated.
+ */
+OM_EXTERNAL_VISIBILITY void **omTensorListGetAlignedDataPtrs(
+    OMTensorList *list, int64_t alignment);
+
+/**
+ * \brief OMTensorList aligned data pointers destroyer
+ *
+ * Free the copies made by omTensorListGetAlignedDataPtrs and the array of the
+ * data pointers.
+ *
+ * @param list pointer to the OMTensorList given to
+ * omTensorListGetAlignedDataPtrs
+ * @param ptrs pointer to the array of data pointers, or NULL.
+ */
+OM_EXTERNAL_VISIBILITY void omTensorListFreeAlignedDataPtrs(
+    OMTensorList *list, void **ptrs);
+
+/**
+ * \brief OMTensorList signature checker
+ *
+ * Check the data types and shapes of the OMTensors against a packed
+ * signature: the number of OMTensors, followed by the data type, the rank and
+ * the dims of each OMTensor, a dim of -1 matching any non-negative size. The
+ * compiled models call it to verify their inputs at once, emitting the
+ * messages describing a mismatch only when it fails.
+ *
+ * @param list pointer to the OMTensorList
+ * @param signature pointer to the packed signature
+ * @return 1 if the OMTensors match the signature, 0 otherwise.
+ */
+OM_EXTERNAL_VISIBILITY int64_t omTensorListHasSignature(
+    OMTensorList *list, const int64_t *signature);
+
 #ifdef __cplusplus
 }
 #endif
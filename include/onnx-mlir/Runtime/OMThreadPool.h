@@ -0,0 +1,248 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------ OMThreadPool.h - OMThreadPool Declaration header --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declaration of the thread pool running the parallel
+// loops of compiled models, and the inferences run asynchronously.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ONNX_MLIR_OMTHREADPOOL_H
+#define ONNX_MLIR_OMTHREADPOOL_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif // #ifdef __cplusplus
+
+#include <onnx-mlir/Compiler/OMCompilerMacros.h>
+#include <onnx-mlir/Runtime/OMTensorList.h>
+
+struct OMThreadPool;
+typedef struct OMThreadPool OMThreadPool;
+
+/**
+ * Function running the iterations [begin, end) of a parallel loop.
+ */
+typedef void (*OMParallelForBody)(void *context, int64_t begin, int64_t end);
+
+/**
+ * Function running a task submitted to a thread pool.
+ */
+typedef void (*OMTaskFunc)(void *context);
+
+/**
+ * Model entry point, e.g. run_main_graph.
+ */
+typedef OMTensorList *(*OMEntryPointFunc)(OMTensorList *input);
+
+/**
+ * Function called with the output of an inference run asynchronously, or
+ * NULL and the errno set by the entry point if it failed.
+ */
+typedef void (*OMRunCallback)(void *context, OMTensorList *output, int err);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create a thread pool.
+ *
+ * The iterations of a parallel loop are split into one range per thread
+ * taking part in the loop, namely the calling thread and up to numThreads
+ * workers of the pool. A thread running out of iterations steals them from
+ * the ranges of the other threads. Concurrent loops, e.g. from inferences of
+ * several models run by different threads, share the workers of a pool.
+ *
+ * On a host with several NUMA nodes, given by the OM_NUMA_NODES env variable
+ * or else by the online nodes, the iterations are first split evenly among
+ * the nodes, and the threads running on a node take the ranges of the node
+ * first, so that they read the parts of the constants placed on the node by
+ * omNumaPartitionConstant. Setting OM_NUMA_NODES to 1 disables it.
+ *
+ * @param numThreads number of worker threads of the pool.
+ * @param cpus NULL, or array of numThreads CPU numbers to pin the workers to,
+ * a negative number leaving its worker unpinned. Pinning is only supported
+ * on Linux and silently ignored otherwise.
+ * @return pointer to the pool, or NULL with errno set if it cannot be
+ * created.
+ */
+OM_EXTERNAL_VISIBILITY OMThreadPool *omThreadPoolCreate(
+    int64_t numThreads, const int64_t *cpus);
+
+/**
+ * Destroy a thread pool, after all the parallel loops running on it and all
+ * the tasks submitted to it are done.
+ *
+ * @param pool pointer to the pool, or NULL.
+ */
+OM_EXTERNAL_VISIBILITY void omThreadPoolDestroy(OMThreadPool *pool);
+
+/**
+ * Get the number of worker threads of a pool.
+ *
+ * @param pool pointer to the pool.
+ * @return number of worker threads.
+ */
+OM_EXTERNAL_VISIBILITY int64_t omThreadPoolGetNumThreads(
+    const OMThreadPool *pool);
+
+/**
+ * Get the default thread pool, created at the first call.
+ *
+ * Its workers, together with the calling thread, amount to the number of
+ * threads given by the OM_NUM_THREADS env variable, or else to the number of
+ * online CPUs. The OM_THREAD_AFFINITY env variable may give a comma separated
+ * list of CPU numbers, assigned to the workers in turn.
+ *
+ * @return pointer to the default pool, or NULL if it cannot be created.
+ */
+OM_EXTERNAL_VISIBILITY OMThreadPool *omThreadPoolGetDefault();
+
+/**
+ * Select the pool running the parallel loops of the models called by the
+ * calling thread.
+ *
+ * @param pool pointer to the pool, or NULL for the default pool.
+ * @param maxConcurrency maximum number of threads taking part in each loop,
+ * including the calling thread, or 0 for no limit. With 1, loops run
+ * sequentially in the calling thread.
+ * @return 0 on success, or -1 with errno set on failure.
+ */
+OM_EXTERNAL_VISIBILITY int omThreadPoolBind(
+    OMThreadPool *pool, int64_t maxConcurrency);
+
+/**
+ * Set the priority of the parallel loops run by the calling thread. The
+ * workers of a pool join the loops of the highest priority first, and the
+ * loops of the same priority oldest first, so that the loops of
+ * latency-critical inferences get the workers before the ones of batch
+ * inferences running concurrently on the same pool.
+ *
+ * @param priority priority of the loops, 0 by default, higher first.
+ * @return 0 on success, or -1 with errno set on failure.
+ */
+OM_EXTERNAL_VISIBILITY int omThreadPoolSetPriority(int64_t priority);
+
+/**
+ * Run the iterations [0, numIterations) of a parallel loop on the pool bound
+ * to the calling thread and return once they are all done. Loops nested in
+ * the body of a parallel loop run sequentially.
+ *
+ * This is the entry point of the parallel loops of compiled models.
+ *
+ * @param body function running a range of iterations.
+ * @param context argument passed to each call of body.
+ * @param numIterations number of iterations.
+ */
+OM_EXTERNAL_VISIBILITY void omParallelFor(
+    OMParallelForBody body, void *context, int64_t numIterations);
+
+/**
+ * Return a copy of constants read by a parallel loop whose iteration i reads
+ * the part i of the constants, e.g. the panel of the columns of the weights
+ * of a matrix multiplication computed by the iteration, with each part
+ * placed on the NUMA node whose threads run the iteration, see
+ * omThreadPoolCreate. The parts are copied at the first call, e.g. when the
+ * model is first run, and the copy is cached in addr, a global of the model
+ * library initialized to NULL, until the process exits. The constants are
+ * used in place on a host with a single NUMA node, or if they cannot be
+ * copied.
+ *
+ * This is called by compiled models for the weights of their large matrix
+ * multiplications.
+ *
+ * @param addr pointer to the cached address of the copy.
+ * @param data pointer to the constants.
+ * @param size size of the constants in bytes, a multiple of numParts.
+ * @param numParts number of parts of the constants, equal to the number of
+ * iterations of the loop.
+ * @return pointer to the copy of the constants, or to the constants.
+ */
+OM_EXTERNAL_VISIBILITY void *omNumaPartitionConstant(
+    void **addr, const void *data, int64_t size, int64_t numParts);
+
+/**
+ * Run the tasks [0, numTasks) of a task graph on the pool bound to the
+ * calling thread and return once they are all done. A task runs once all of
+ * its predecessors are done, tasks independent of each other running
+ * concurrently in the calling thread and in workers of the pool, while the
+ * parallel loops of the tasks are joined by the workers left idle. The tasks
+ * are numbered in a topological order of the graph, in which they run
+ * sequentially in the body of a parallel loop or without workers.
+ *
+ * This is the entry point of the task graphs of compiled models.
+ *
+ * @param body function running the tasks [begin, end), called with one task
+ * at a time unless the tasks run sequentially.
+ * @param context argument passed to each call of body.
+ * @param numTasks number of tasks.
+ * @param predecessorCounts array of the number of predecessors of each task.
+ * @param successorOffsets array of numTasks + 1 offsets into successors, the
+ * successors of task i being at offsets [successorOffsets[i],
+ * successorOffsets[i + 1]).
+ * @param successors array of the successors of the tasks.
+ */
+OM_EXTERNAL_VISIBILITY void omRunTaskGraph(OMParallelForBody body,
+    void *context, int64_t numTasks, const int64_t *predecessorCounts,
+    const int64_t *successorOffsets, const int64_t *successors);
+
+/**
+ * Submit a task to be run by a worker of a pool, and return without waiting
+ * for it. The workers run the tasks in submission order, giving priority to
+ * joining parallel loops. The parallel loops of a task run on the same pool,
+ * as if the task was run by a thread outside of the pool, and tasks may
+ * submit tasks. With a pool without workers, the task runs in the calling
+ * thread before returning.
+ *
+ * @param pool pointer to the pool, or NULL for the default pool.
+ * @param func function running the task.
+ * @param context argument passed to func.
+ * @return 0 on success, or -1 with errno set on failure.
+ */
+OM_EXTERNAL_VISIBILITY int omThreadPoolSubmit(
+    OMThreadPool *pool, OMTaskFunc func, void *context);
+
+/**
+ * Get the highest number of threads, the calling thread included, that took
+ * part in a parallel loop run by the calling thread since the previous call,
+ * and reset it, e.g. to report the threads used by each inference. Without
+ * pthreads, loops run sequentially and the result is always 1.
+ *
+ * @return number of threads, or 0 if the thread ran no parallel loop.
+ */
+OM_EXTERNAL_VISIBILITY int64_t omThreadPoolTakeMaxThreads();
+
+/**
+ * Run an inference asynchronously: submit a task to a pool calling the entry
+ * point of a model and then the callback, in a worker of the pool. Several
+ * inferences may be in flight at once, e.g. to overlap the decoding of the
+ * inputs of the next requests with the computations. The input list must be
+ * kept alive until the callback is called, which takes the ownership of the
+ * output list as the caller of the entry point does.
+ *
+ * @param pool pointer to the pool, or NULL for the default pool.
+ * @param entryPoint entry point of the model, e.g. run_main_graph.
+ * @param input input list passed to the entry point.
+ * @param callback function called with the output list.
+ * @param context argument passed to callback.
+ * @return 0 on success, or -1 with errno set if the task cannot be submitted,
+ * in which case the callback is not called.
+ */
+OM_EXTERNAL_VISIBILITY int omRunAsync(OMThreadPool *pool,
+    OMEntryPointFunc entryPoint, OMTensorList *input, OMRunCallback callback,
+    void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ONNX_MLIR_OMTHREADPOOL_H
@@ -23,7 +23,8 @@
 #include "include/onnx-mlir/Compiler/OMCompilerTypes.h"
 #include "src/Accelerators/Accelerators.inc"
 
-// TODO: Remove NNPA from this header
+// TODO: Remove NNPA and GPU from this header
+#include "src/Accelerators/GPU/Compiler/GPUCompilerOptions.hpp"
 #include "src/Accelerators/NNPA/Compiler/NNPACompilerOptions.hpp"
 
 // Define the macros used to generate various accelerators artifacts (via the
@@ -50,6 +51,9 @@
 #define ACCEL_INSTRUMENTSTAGE_CL_ENUM(name) INSTRUMENTSTAGE_CL_ENUM_##name
 
 namespace onnx_mlir {
+
+class DimAnalysis;
+
 namespace accel {
 
 class Accelerator {
@@ -104,6 +108,20 @@ public:
   /// accelerator.
   virtual void initPasses(int optLevel) const = 0;
 
+  //===--------------------------------------------------------------------===//
+  // Hooks for accelerator-placement pass
+  //===--------------------------------------------------------------------===//
+
+  /// Return the estimated cost, in nanoseconds, of running an ONNX op on the
+  /// accelerator, including the transfers of its operands and results between
+  /// the CPU and the accelerator. Return a negative value if the accelerator
+  /// cannot run the op. Ops that several accelerators can run are placed on
+  /// the cheapest one.
+  virtual double getOpCost(mlir::Operation *op,
+      const onnx_mlir::DimAnalysis *dimAnalysis) const {
+    return -1;
+  }
+
   //===--------------------------------------------------------------------===//
   // Hooks for onnx-to-krnl pass
   //===--------------------------------------------------------------------===//
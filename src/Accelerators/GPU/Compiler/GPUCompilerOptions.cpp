@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------------- GPUCompilerOptions.cpp ---------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Compiler Options for GPU
+//
+//===----------------------------------------------------------------------===//
+#include "src/Accelerators/GPU/Compiler/GPUCompilerOptions.hpp"
+
+#define DEBUG_TYPE "GPUCompilerOptions"
+
+namespace onnx_mlir {
+
+llvm::cl::opt<std::string> gpuTriple("gpu-triple",
+    llvm::cl::desc("Target triple of the GPU kernels "
+                   "(default=nvptx64-nvidia-cuda)."),
+    llvm::cl::init("nvptx64-nvidia-cuda"), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> gpuChip("gpu-chip",
+    llvm::cl::desc("Architecture of the GPU the kernels are compiled for "
+                   "(default=sm_70)."),
+    llvm::cl::init("sm_70"), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> gpuFeatures("gpu-features",
+    llvm::cl::desc("Features of the GPU the kernels are compiled for "
+                   "(default=+ptx60)."),
+    llvm::cl::init("+ptx60"), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::list<int64_t> gpuTileSizes("gpu-tile-sizes",
+    llvm::cl::desc("Comma-separated tile sizes of the parallel loops run on "
+                   "the GPU, from the outermost dimension. The tiles are run "
+                   "by the blocks of the kernels, and each iteration of a "
+                   "tile by a thread of the block (default=256)."),
+    llvm::cl::CommaSeparated, llvm::cl::ZeroOrMore,
+    llvm::cl::cat(OnnxMlirOptions));
+
+} // namespace onnx_mlir
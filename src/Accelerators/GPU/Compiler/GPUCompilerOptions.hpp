@@ -0,0 +1,30 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------------- GPUCompilerOptions.hpp ---------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Compiler Options for GPU
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include "llvm/Support/CommandLine.h"
+
+// The GPU accelerator has no instrumentation stage of its own.
+#define INSTRUMENTSTAGE_EUM_GPU
+#define INSTRUMENTSTAGE_CL_ENUM_GPU clEnumVal(Onnx, "Profile for onnx ops.")
+
+namespace onnx_mlir {
+
+extern llvm::cl::OptionCategory OnnxMlirOptions;
+extern llvm::cl::opt<std::string> gpuTriple;
+extern llvm::cl::opt<std::string> gpuChip;
+extern llvm::cl::opt<std::string> gpuFeatures;
+extern llvm::cl::list<int64_t> gpuTileSizes;
+
+} // namespace onnx_mlir
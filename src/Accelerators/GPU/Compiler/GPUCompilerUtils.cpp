@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------------------- GPUCompilerUtils.cpp ----------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Compiler Utilities for GPU
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
+#include "mlir/Conversion/GPUToNVVM/GPUToNVVMPass.h"
+#include "mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h"
+#include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
+#include "mlir/Conversion/SCFToGPU/SCFToGPUPass.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/GPU/Transforms/Passes.h"
+#include "mlir/Dialect/SCF/Transforms/Passes.h"
+#include "mlir/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+
+#include "src/Accelerators/GPU/Compiler/GPUCompilerOptions.hpp"
+#include "src/Accelerators/GPU/Compiler/GPUCompilerUtils.hpp"
+#include "src/Accelerators/GPU/Pass/GPUPasses.hpp"
+#include "src/Compiler/CompilerOptions.hpp"
+#include "src/Compiler/CompilerPasses.hpp"
+
+#define DEBUG_TYPE "GPUCompilerUtils"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+void addKrnlToGPUPasses(mlir::PassManager &pm) {
+  pm.addPass(mlir::createLowerAffinePass());
+
+  // Tile the parallel loops, so that the loops over the tiles are run by the
+  // blocks of the kernels and the loops within a tile by their threads.
+  SmallVector<int64_t, 4> tileSizes(gpuTileSizes.begin(), gpuTileSizes.end());
+  if (tileSizes.empty())
+    tileSizes.emplace_back(256);
+  pm.addNestedPass<func::FuncOp>(mlir::createParallelLoopTilingPass(tileSizes));
+  pm.addNestedPass<func::FuncOp>(mlir::createGpuMapParallelLoopsPass());
+  pm.addNestedPass<func::FuncOp>(mlir::createParallelLoopToGpuPass());
+  // The bounds of the partial tiles are affine.min ops.
+  pm.addPass(mlir::createLowerAffinePass());
+  pm.addPass(mlir::createCanonicalizerPass());
+  pm.addPass(mlir::createGpuKernelOutliningPass());
+
+  // Place the buffers of the kernels in the device memory, now that the
+  // operands of the kernels are known.
+  pm.addNestedPass<func::FuncOp>(onnx_mlir::createGPUDeviceMemoryPass());
+
+  // Compile the kernels to a binary embedded in their gpu.module, which
+  // gpu.launch_func loads when it is lowered with the Krnl ops.
+  pm.addNestedPass<gpu::GPUModuleOp>(mlir::createConvertSCFToCFPass());
+  pm.addNestedPass<gpu::GPUModuleOp>(mlir::createStripDebugInfoPass());
+  pm.addNestedPass<gpu::GPUModuleOp>(mlir::createLowerGpuOpsToNVVMOpsPass());
+  pm.addNestedPass<gpu::GPUModuleOp>(
+      mlir::createReconcileUnrealizedCastsPass());
+  pm.addNestedPass<gpu::GPUModuleOp>(
+      mlir::createGpuSerializeToCubinPass(gpuTriple, gpuChip, gpuFeatures));
+}
+
+void addPassesGPU(mlir::OwningOpRef<mlir::ModuleOp> &module,
+    mlir::PassManager &pm, EmissionTargetType &emissionTarget) {
+  InputIRLevelType inputIRLevel = determineInputIRLevel(module);
+
+  if (inputIRLevel <= ONNXLevel && emissionTarget >= EmitONNXIR)
+    addONNXToMLIRPasses(pm, /*target CPU*/ maccel.empty());
+
+  if (emissionTarget >= EmitMLIR) {
+    // The kernels are generated from the parallel loops. The loops are not
+    // tiled or vectorized for the CPU, as they are tiled for the threads of
+    // the blocks instead.
+    enableParallel = true;
+    if (inputIRLevel <= ONNXLevel)
+      addONNXToKrnlPasses(pm, std::min<int>(OptimizationLevel, 2),
+          /*enableCSE*/ true, instrumentONNXSignature, ONNXOpStats);
+    if (inputIRLevel <= MLIRLevel)
+      addKrnlToAffinePasses(pm);
+  }
+
+  if (inputIRLevel <= LLVMLevel && emissionTarget >= EmitLLVMIR) {
+    // Outline the parallel loops to GPU kernels, before the remaining ones
+    // are outlined to the thread pool of the runtime.
+    addKrnlToGPUPasses(pm);
+    addKrnlToLLVMPasses(pm, /*enableCSE=*/true, verifyInputTensors);
+  }
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------------------- GPUAccelerator.cpp ------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Add accelerator support for NVIDIA GPUs. The parallel loops of the model
+// are run as CUDA kernels, see addKrnlToGPUPasses, and the other code on the
+// CPU.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/GPUCommon/GPUCommonPass.h"
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/LLVMIR/NVVMDialect.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "llvm/Support/Debug.h"
+
+#include "src/Accelerators/GPU/Compiler/GPUCompilerUtils.hpp"
+#include "src/Accelerators/GPU/GPUAccelerator.hpp"
+#include "src/Accelerators/GPU/Pass/GPUPasses.hpp"
+#include "src/Compiler/CompilerOptions.hpp"
+
+#include <memory>
+
+#define DEBUG_TYPE "GPUAccelerator"
+
+namespace onnx_mlir {
+namespace accel {
+
+Accelerator *createGPU() { return GPUAccelerator::getInstance(); }
+
+GPUAccelerator *GPUAccelerator::instance = nullptr;
+
+GPUAccelerator *GPUAccelerator::getInstance() {
+  if (instance == nullptr)
+    instance = new GPUAccelerator();
+  return instance;
+}
+
+GPUAccelerator::GPUAccelerator() : Accelerator(Accelerator::Kind::GPU) {
+  LLVM_DEBUG(llvm::dbgs() << "Creating a GPU accelerator\n");
+  acceleratorTargets.push_back(this);
+  // The kernels are loaded and launched, and the device memory allocated, by
+  // the CUDA runtime wrappers of MLIR.
+  addCompilerConfig(CCM_SHARED_LIB_DEPS, {"mlir_cuda_runtime"});
+};
+
+GPUAccelerator::~GPUAccelerator() { delete instance; }
+
+uint64_t GPUAccelerator::getVersionNumber() const { return 0x000100; }
+
+void GPUAccelerator::getOrLoadDialects(mlir::MLIRContext &context) const {
+  LLVM_DEBUG(llvm::dbgs() << "Loading dialects for GPU accelerator\n");
+  context.getOrLoadDialect<mlir::gpu::GPUDialect>();
+  context.getOrLoadDialect<mlir::NVVM::NVVMDialect>();
+}
+
+void GPUAccelerator::addPasses(mlir::OwningOpRef<mlir::ModuleOp> &module,
+    mlir::PassManager &pm,
+    onnx_mlir::EmissionTargetType &emissionTarget) const {
+  LLVM_DEBUG(llvm::dbgs() << "Adding passes for GPU accelerator\n");
+  addPassesGPU(module, pm, emissionTarget);
+}
+
+void GPUAccelerator::registerDialects(mlir::DialectRegistry &registry) const {
+  LLVM_DEBUG(llvm::dbgs() << "Registering dialects for GPU accelerator\n");
+  registry.insert<mlir::gpu::GPUDialect>();
+  registry.insert<mlir::NVVM::NVVMDialect>();
+}
+
+void GPUAccelerator::initPasses(int optLevel) const {
+  LLVM_DEBUG(llvm::dbgs() << "Initializing passes for GPU accelerator\n");
+  mlir::registerPass([]() -> std::unique_ptr<mlir::Pass> {
+    return onnx_mlir::createGPUDeviceMemoryPass();
+  });
+}
+
+mlir::MemRefType GPUAccelerator::convertTensorTypeToMemRefType(
+    const mlir::TensorType tensorType) const {
+  // The tensors have the memref types of the CPU.
+  return nullptr;
+}
+
+int64_t GPUAccelerator::getDefaultAllocAlignment(
+    const mlir::TensorType tensorType) const {
+  return -1;
+}
+
+void GPUAccelerator::conversionTargetONNXToKrnl(
+    mlir::ConversionTarget &target) const {}
+
+void GPUAccelerator::rewritePatternONNXToKrnl(
+    mlir::RewritePatternSet &patterns, mlir::TypeConverter &typeConverter,
+    mlir::MLIRContext *ctx) const {}
+
+void GPUAccelerator::conversionTargetKrnlToLLVM(
+    mlir::ConversionTarget &target) const {
+  // The kernels are already compiled to the binary attached to their module.
+  target.addLegalOp<mlir::gpu::GPUModuleOp>();
+  target.markOpRecursivelyLegal<mlir::gpu::GPUModuleOp>();
+}
+
+void GPUAccelerator::rewritePatternKrnlToLLVM(
+    mlir::RewritePatternSet &patterns, mlir::LLVMTypeConverter &typeConverter,
+    mlir::MLIRContext *ctx) const {
+  mlir::populateGpuToLLVMConversionPatterns(
+      typeConverter, patterns, mlir::gpu::getDefaultGpuBinaryAnnotation());
+}
+
+} // namespace accel
+} // namespace onnx_mlir
@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------------------- GPUAccelerator.hpp -----------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// ===========================================================================
+//
+// Accelerator support for NVIDIA GPUs.
+//
+//===---------------------------------------------------------------------===//
+
+#pragma once
+
+#include "mlir/IR/BuiltinTypes.h"
+#include "src/Accelerators/Accelerator.hpp"
+
+namespace onnx_mlir {
+namespace accel {
+
+/// Singleton class to construct a GPU accelerator.
+class GPUAccelerator final : public Accelerator {
+private:
+  static GPUAccelerator *instance;
+  GPUAccelerator();
+
+public:
+  /// Singleton should not be clonable or assignable.
+  GPUAccelerator(GPUAccelerator &) = delete;
+  void operator=(const GPUAccelerator &) = delete;
+
+  ~GPUAccelerator();
+
+  /// Creates an instance on the first invocation. Subsequent invocations
+  /// return the existing instance.
+  static GPUAccelerator *getInstance();
+
+  /// Define classof to be able to use isa<>, cast<>, dyn_cast<>, etc.
+  static bool classof(const Accelerator *accel) {
+    return accel->getKind() == Accelerator::Kind::GPU;
+  }
+  static bool classof(const GPUAccelerator *) { return true; }
+
+  uint64_t getVersionNumber() const final;
+
+  //===--------------------------------------------------------------------===//
+  // Hooks for onnx-mlir-opt driver
+  //===--------------------------------------------------------------------===//
+  virtual void getOrLoadDialects(mlir::MLIRContext &context) const final;
+  virtual void addPasses(mlir::OwningOpRef<mlir::ModuleOp> &module,
+      mlir::PassManager &pm,
+      onnx_mlir::EmissionTargetType &emissionTarget) const final;
+  //===--------------------------------------------------------------------===//
+  // Hooks for onnx-mlir-opt driver
+  //===--------------------------------------------------------------------===//
+  virtual void registerDialects(mlir::DialectRegistry &registry) const final;
+  virtual void initPasses(int optLevel) const final;
+  //===--------------------------------------------------------------------===//
+  // Hooks for onnx-to-krnl pass
+  //===--------------------------------------------------------------------===//
+  virtual mlir::MemRefType convertTensorTypeToMemRefType(
+      const mlir::TensorType tensorType) const final;
+  virtual void conversionTargetONNXToKrnl(
+      mlir::ConversionTarget &target) const final;
+  virtual void rewritePatternONNXToKrnl(mlir::RewritePatternSet &patterns,
+      mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx) const final;
+  virtual int64_t getDefaultAllocAlignment(
+      const mlir::TensorType tensorType) const final;
+  //===--------------------------------------------------------------------===//
+  // Hooks for krnl-to-llvm pass
+  //===--------------------------------------------------------------------===//
+  virtual void conversionTargetKrnlToLLVM(
+      mlir::ConversionTarget &target) const final;
+  virtual void rewritePatternKrnlToLLVM(mlir::RewritePatternSet &patterns,
+      mlir::LLVMTypeConverter &typeConverter,
+      mlir::MLIRContext *ctx) const final;
+};
+
+} // namespace accel
+} // namespace onnx_mlir
@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------- GPUPasses.hpp - GPU Passes Definition --------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file exposes the entry points to create compiler passes for GPU in
+// addition to the passes used by ONNX MLIR.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "mlir/Pass/Pass.h"
+
+namespace onnx_mlir {
+
+/// Pass for placing the buffers of the GPU kernels in the device memory.
+std::unique_ptr<mlir::Pass> createGPUDeviceMemoryPass();
+
+} // namespace onnx_mlir
@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- DeviceMemory.cpp - Place GPU kernel buffers on the device ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// The kernels outlined from the parallel loops read and write the buffers of
+// the host, which the device cannot access. This pass places the memrefs used
+// by the gpu.launch_func ops of a function in the device memory:
+//
+// - A buffer allocated by the function and only used by kernels is allocated
+//   in the device memory instead, and never copied.
+// - An input of the function, or a constant of the model, that no kernel
+//   writes is copied to the device once at the entry of the function, and
+//   the copy is freed before the function returns.
+// - Any other memref, e.g. a buffer also read by CPU loops, is copied to the
+//   device before each kernel using it, and copied back after the kernel if
+//   the kernel may write it.
+//
+// The copies and allocations are synchronous gpu ops, lowered to the calls of
+// the CUDA runtime wrappers of MLIR together with the Krnl ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/MapVector.h"
+
+#include "src/Accelerators/GPU/Pass/GPUPasses.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+/// Return true if the memref may be written, through the views of it.
+bool mayWrite(Value memref) {
+  for (Operation *user : memref.getUsers()) {
+    if (auto viewOp = dyn_cast<ViewLikeOpInterface>(user)) {
+      if (viewOp.getViewSource() == memref && mayWrite(user->getResult(0)))
+        return true;
+      continue;
+    }
+    auto effectOp = dyn_cast<MemoryEffectOpInterface>(user);
+    if (!effectOp)
+      return true;
+    SmallVector<MemoryEffects::EffectInstance, 2> effects;
+    effectOp.getEffectsOnValue(memref, effects);
+    if (llvm::any_of(effects, [](const MemoryEffects::EffectInstance &effect) {
+          return isa<MemoryEffects::Write>(effect.getEffect());
+        }))
+      return true;
+  }
+  return false;
+}
+
+/// Return true if the kernel launched with the operand may write it.
+bool mayBeWrittenByKernel(OpOperand &use) {
+  auto launchOp = cast<gpu::LaunchFuncOp>(use.getOwner());
+  auto kernel = SymbolTable::lookupNearestSymbolFrom<gpu::GPUFuncOp>(
+      launchOp, launchOp.getKernel());
+  if (!kernel)
+    return true;
+  unsigned firstKernelOperand =
+      launchOp->getNumOperands() - launchOp.getNumKernelOperands();
+  return mayWrite(
+      kernel.getArgument(use.getOperandNumber() - firstKernelOperand));
+}
+
+/// Return true if a memref of the type can be copied to the device, which
+/// needs a contiguous buffer.
+bool isCopyable(Type type) {
+  auto memRefType = type.dyn_cast<MemRefType>();
+  return memRefType && memRefType.getLayout().isIdentity();
+}
+
+/// Allocate a device buffer of the type of a host memref and copy the host
+/// memref to it.
+Value copyToDevice(OpBuilder &builder, Location loc, Value host) {
+  auto type = host.getType().cast<MemRefType>();
+  SmallVector<Value, 4> dynamicSizes;
+  for (int64_t i = 0; i < type.getRank(); ++i)
+    if (type.isDynamicDim(i))
+      dynamicSizes.emplace_back(builder.create<memref::DimOp>(loc, host, i));
+  Value device = builder
+                     .create<gpu::AllocOp>(loc, type, /*asyncToken=*/Type(),
+                         /*asyncDependencies=*/ValueRange(), dynamicSizes,
+                         /*symbolOperands=*/ValueRange())
+                     .getMemref();
+  builder.create<gpu::MemcpyOp>(
+      loc, /*asyncToken=*/Type(), ValueRange(), device, host);
+  return device;
+}
+
+class GPUDeviceMemoryPass
+    : public PassWrapper<GPUDeviceMemoryPass, OperationPass<func::FuncOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(GPUDeviceMemoryPass)
+
+  StringRef getArgument() const override { return "gpu-device-memory"; }
+
+  StringRef getDescription() const override {
+    return "Place the buffers of the GPU kernels in the device memory.";
+  }
+
+  void runOnOperation() final;
+
+private:
+  // Replace a buffer only used by kernels with a device buffer.
+  void allocateOnDevice(memref::AllocOp allocOp);
+
+  // Copy a memref that no kernel writes to the device at the entry of the
+  // function.
+  void copyAtEntry(Value host);
+
+  // Copy the host memrefs of a kernel to the device around its launch.
+  LogicalResult copyAroundLaunch(gpu::LaunchFuncOp launchOp);
+};
+
+void GPUDeviceMemoryPass::allocateOnDevice(memref::AllocOp allocOp) {
+  OpBuilder builder(allocOp);
+  Location loc = allocOp.getLoc();
+  Value device =
+      builder
+          .create<gpu::AllocOp>(loc, allocOp.getType(), /*asyncToken=*/Type(),
+              /*asyncDependencies=*/ValueRange(), allocOp.getDynamicSizes(),
+              allocOp.getSymbolOperands())
+          .getMemref();
+  // Free the buffer where it was freed, or else after its last use.
+  Block *block = allocOp->getBlock();
+  Operation *lastUser = allocOp;
+  bool isFreed = false;
+  for (Operation *user : llvm::make_early_inc_range(allocOp->getUsers())) {
+    if (auto deallocOp = dyn_cast<memref::DeallocOp>(user)) {
+      builder.setInsertionPoint(deallocOp);
+      builder.create<gpu::DeallocOp>(
+          loc, /*asyncToken=*/Type(), ValueRange(), device);
+      deallocOp.erase();
+      isFreed = true;
+      continue;
+    }
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    if (ancestor && lastUser->isBeforeInBlock(ancestor))
+      lastUser = ancestor;
+  }
+  if (!isFreed) {
+    builder.setInsertionPointAfter(lastUser);
+    builder.create<gpu::DeallocOp>(
+        loc, /*asyncToken=*/Type(), ValueRange(), device);
+  }
+  allocOp.getResult().replaceAllUsesWith(device);
+  allocOp.erase();
+}
+
+void GPUDeviceMemoryPass::copyAtEntry(Value host) {
+  Block &entryBlock = getOperation().getBody().front();
+  OpBuilder builder(&getContext());
+  if (Operation *defOp = host.getDefiningOp())
+    builder.setInsertionPointAfter(defOp);
+  else
+    builder.setInsertionPointToStart(&entryBlock);
+  Value device = copyToDevice(builder, host.getLoc(), host);
+  host.replaceUsesWithIf(device,
+      [](OpOperand &use) { return isa<gpu::LaunchFuncOp>(use.getOwner()); });
+  builder.setInsertionPoint(entryBlock.getTerminator());
+  builder.create<gpu::DeallocOp>(
+      host.getLoc(), /*asyncToken=*/Type(), ValueRange(), device);
+}
+
+LogicalResult GPUDeviceMemoryPass::copyAroundLaunch(
+    gpu::LaunchFuncOp launchOp) {
+  // The memrefs of the kernel in the host memory, and whether the kernel may
+  // write them.
+  llvm::SmallMapVector<Value, bool, 4> hostMemRefs;
+  for (OpOperand &use : launchOp->getOpOperands()) {
+    Value operand = use.get();
+    if (!operand.getType().isa<MemRefType>() ||
+        operand.getDefiningOp<gpu::AllocOp>())
+      continue;
+    if (!isCopyable(operand.getType()))
+      return launchOp.emitError("cannot copy a memref of type ")
+             << operand.getType() << " to the device";
+    hostMemRefs[operand] |= mayBeWrittenByKernel(use);
+  }
+  Location loc = launchOp.getLoc();
+  OpBuilder before(launchOp);
+  OpBuilder after(launchOp->getContext());
+  after.setInsertionPointAfter(launchOp);
+  for (auto [host, isWritten] : hostMemRefs) {
+    Value device = copyToDevice(before, loc, host);
+    launchOp->replaceUsesOfWith(host, device);
+    if (isWritten)
+      after.create<gpu::MemcpyOp>(
+          loc, /*asyncToken=*/Type(), ValueRange(), host, device);
+    after.create<gpu::DeallocOp>(
+        loc, /*asyncToken=*/Type(), ValueRange(), device);
+  }
+  return success();
+}
+
+void GPUDeviceMemoryPass::runOnOperation() {
+  func::FuncOp funcOp = getOperation();
+  SmallVector<gpu::LaunchFuncOp, 8> launchOps;
+  funcOp.walk([&](gpu::LaunchFuncOp op) { launchOps.emplace_back(op); });
+  if (launchOps.empty())
+    return;
+
+  // Buffers only used by kernels.
+  SmallVector<memref::AllocOp, 8> deviceAllocOps;
+  funcOp.walk([&](memref::AllocOp allocOp) {
+    Value buffer = allocOp.getResult();
+    if (isCopyable(buffer.getType()) && !buffer.use_empty() &&
+        llvm::all_of(buffer.getUsers(), [](Operation *user) {
+          return isa<gpu::LaunchFuncOp, memref::DeallocOp>(user);
+        }))
+      deviceAllocOps.emplace_back(allocOp);
+  });
+  for (memref::AllocOp allocOp : deviceAllocOps)
+    allocateOnDevice(allocOp);
+
+  // Inputs and constants that no kernel writes. Their copies, made in the
+  // entry block, must dominate the returns of the function.
+  if (funcOp.getBody().hasOneBlock()) {
+    Block &entryBlock = funcOp.getBody().front();
+    SmallVector<Value, 8> entryMemRefs(
+        entryBlock.getArguments().begin(), entryBlock.getArguments().end());
+    for (KrnlGlobalOp globalOp : entryBlock.getOps<KrnlGlobalOp>())
+      entryMemRefs.emplace_back(globalOp.getResult());
+    for (Value host : entryMemRefs) {
+      if (!isCopyable(host.getType()))
+        continue;
+      bool isUsedByKernels = false;
+      bool isWritten = false;
+      for (OpOperand &use : host.getUses())
+        if (isa<gpu::LaunchFuncOp>(use.getOwner())) {
+          isUsedByKernels = true;
+          isWritten |= mayBeWrittenByKernel(use);
+        }
+      if (isUsedByKernels && !isWritten)
+        copyAtEntry(host);
+    }
+  }
+
+  // Remaining host memrefs.
+  for (gpu::LaunchFuncOp launchOp : launchOps)
+    if (failed(copyAroundLaunch(launchOp)))
+      return signalPassFailure();
+}
+
+} // namespace
+
+std::unique_ptr<Pass> createGPUDeviceMemoryPass() {
+  return std::make_unique<GPUDeviceMemoryPass>();
+}
+
+} // namespace onnx_mlir
@@ -34,4 +34,23 @@ llvm::cl::list<std::string> execNodesOnCpu{"execNodesOnCpu",
     llvm::cl::CommaSeparated, llvm::cl::ZeroOrMore,
     llvm::cl::cat(OnnxMlirOptions)};
 
+llvm::cl::opt<bool> nnpaPlacementCostModel("nnpa-placement-cost-model",
+    llvm::cl::desc("Place ops on CPU or NNPA using a cost model, so that "
+                   "small ops whose layout conversions cost more than their "
+                   "computation run on the CPU (default=false)."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> nnpaAsyncOverlap("nnpa-async-overlap",
+    llvm::cl::desc("Run NNPA ops concurrently with independent CPU loops. "
+                   "Takes effect only with --parallel (default=false)."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> nnpaFuseLayoutConversion("nnpa-fuse-layout-conversion",
+    llvm::cl::desc("Stickify the inputs computed by CPU ops and unstickify "
+                   "the outputs used by CPU ops in CPU loops, fused with the "
+                   "loops of these ops so that their f32 tensors are never "
+                   "materialized. Takes effect only with --fusion "
+                   "(default=false)."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
 } // namespace onnx_mlir
@@ -38,5 +38,8 @@ typedef enum {
   extern llvm::cl::OptionCategory OnnxMlirOptions;
   extern llvm::cl::opt<onnx_mlir::NNPAEmissionTargetType> nnpaEmissionTarget;
   extern llvm::cl::list<std::string> execNodesOnCpu;
+  extern llvm::cl::opt<bool> nnpaPlacementCostModel;
+  extern llvm::cl::opt<bool> nnpaAsyncOverlap;
+  extern llvm::cl::opt<bool> nnpaFuseLayoutConversion;
 
 } // namespace onnx_mlir
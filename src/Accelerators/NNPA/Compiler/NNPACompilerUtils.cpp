@@ -29,6 +29,7 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
+#include "src/Accelerators/Accelerator.hpp"
 #include "src/Accelerators/NNPA/Compiler/NNPACompilerOptions.hpp"
 #include "src/Accelerators/NNPA/Compiler/NNPACompilerUtils.hpp"
 #include "src/Accelerators/NNPA/Dialect/ZHigh/ZHighOps.hpp"
@@ -62,6 +63,12 @@ void addONNXToZHighPasses(
   if (instrumentStage == onnx_mlir::InstrumentStages::Onnx)
     pm.addNestedPass<func::FuncOp>(onnx_mlir::createInstrumentPass(
         instrumentOps, instrumentControlBits.getBits()));
+  // Place ops on the cheapest accelerator when there are others than NNPA.
+  if (onnx_mlir::accel::Accelerator::getAccelerators().size() > 1)
+    pm.addPass(onnx_mlir::createAcceleratorPlacementPass());
+  // Place ops on CPU or NNPA by cost before lowering them to zhigh.
+  if (nnpaPlacementCostModel)
+    pm.addPass(onnx_mlir::createDevicePlacementPass(execNodesOnCpu));
   pm.addPass(onnx_mlir::createONNXToZHighPass(execNodesOnCpu));
   pm.addPass(onnx_mlir::createShapeInferencePass());
   // There are more opportunities for const propagation once all zhigh ops were
@@ -152,6 +159,9 @@ void addPassesNNPA(mlir::OwningOpRef<mlir::ModuleOp> &module,
         pm.addPass(mlir::createCanonicalizerPass());
         // Constant folding for std.alloc.
         pm.addNestedPass<func::FuncOp>(onnx_mlir::createFoldStdAllocPass());
+        // Overlap NNPA ops with independent CPU loops.
+        if (nnpaAsyncOverlap)
+          pm.addNestedPass<func::FuncOp>(zlow::createZLowAsyncOverlapPass());
       }
       // Insert an instrumentation after lowering zhigh to zlow to get profiling
       // for zlow ops
@@ -0,0 +1,331 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------- DevicePlacement.cpp - Place ONNX ops on CPU or NNPA ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that assigns the ONNX ops that can run on NNPA
+// to either the CPU or NNPA, using a cost model, by setting their `device`
+// attribute. The attribute is honored by the lowering of ONNX to ZHigh.
+//
+// The ops that can run on NNPA are grouped into regions of ops connected by
+// their operands and results. Inside a region, the tensors stay stickified
+// once ZHighLayoutPropagation has removed the unstick/stick pairs between
+// consecutive ZHigh ops. So the cost of running a region on NNPA is the cost
+// of its ops plus the cost of the layout conversions at its boundaries:
+// sticking its inputs computed on the CPU and unsticking its results used on
+// the CPU. A region is placed on the CPU when running all of its ops there is
+// cheaper.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Debug.h"
+
+#include "src/Accelerators/NNPA/Conversion/ONNXToZHigh/ONNXToZHighCommon.hpp"
+#include "src/Accelerators/NNPA/Pass/NNPAPasses.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Transform/ONNX/ONNXDimAnalysis.hpp"
+
+#define DEBUG_TYPE "device-placement"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Rough throughputs of the CPU and NNPA, in operations per nanosecond, and
+// fixed cost in nanoseconds of launching an op on NNPA.
+static constexpr double kCPUOpsPerNs = 8.0;
+static constexpr double kNNPAOpsPerNs = 256.0;
+static constexpr double kNNPALaunchNs = 2000.0;
+
+// Cost in nanoseconds per element of converting a tensor to or from the
+// stickified layout of NNPA. 4D tensors additionally are transposed between
+// the NCHW layout of ONNX and the NHWC layout of NNPA.
+static constexpr double kStickNsPerElement = 0.5;
+static constexpr double kNCHWToNHWCFactor = 2.0;
+
+// Return the number of elements of a value, or -1 if unknown.
+int64_t getNumElements(Value val) {
+  auto type = val.getType().dyn_cast<ShapedType>();
+  if (!type || !type.hasStaticShape())
+    return -1;
+  return type.getNumElements();
+}
+
+// Return the size of a static dimension of a value, or -1 if unknown.
+int64_t getDimSize(Value val, int64_t axis) {
+  auto type = val.getType().dyn_cast<ShapedType>();
+  if (!type || !type.hasRank())
+    return -1;
+  int64_t rank = type.getRank();
+  if (axis < 0)
+    axis += rank;
+  if (axis < 0 || axis >= rank || type.isDynamicDim(axis))
+    return -1;
+  return type.getDimSize(axis);
+}
+
+// Return the number of arithmetic operations computed by an op, or -1 if
+// unknown.
+double getNumOps(Operation *op) {
+  int64_t outputSize = getNumElements(op->getResult(0));
+  if (outputSize < 0)
+    return -1;
+  auto contraction = [&](int64_t reductionSize) -> double {
+    if (reductionSize < 0)
+      return -1;
+    return 2.0 * outputSize * reductionSize;
+  };
+  return TypeSwitch<Operation *, double>(op)
+      .Case<ONNXMatMulOp>([&](ONNXMatMulOp matMulOp) {
+        return contraction(getDimSize(matMulOp.getA(), -1));
+      })
+      .Case<ONNXGemmOp>([&](ONNXGemmOp gemmOp) {
+        return contraction(
+            getDimSize(gemmOp.getA(), gemmOp.getTransA() ? 0 : 1));
+      })
+      .Case<ONNXConvOp>([&](ONNXConvOp convOp) {
+        // Each output value reduces the input channels of its group over the
+        // kernel window, which is the size of a filter.
+        int64_t filterSize = getNumElements(convOp.getW());
+        int64_t numFilters = getDimSize(convOp.getW(), 0);
+        if (filterSize < 0 || numFilters <= 0)
+          return -1.0;
+        return contraction(filterSize / numFilters);
+      })
+      .Case<ONNXLSTMOp, ONNXGRUOp>([&](auto rnnOp) {
+        // Each timestep multiplies the input and the hidden state by the
+        // weights of all the gates.
+        int64_t seqLength = getDimSize(rnnOp.getX(), 0);
+        int64_t batchSize = getDimSize(rnnOp.getX(), 1);
+        int64_t inputSize = getDimSize(rnnOp.getX(), 2);
+        int64_t numDirections = getDimSize(rnnOp.getW(), 0);
+        int64_t gatesSize = getDimSize(rnnOp.getW(), 1);
+        int64_t hiddenSize = getDimSize(rnnOp.getR(), 2);
+        if (seqLength < 0 || batchSize < 0 || inputSize < 0 ||
+            numDirections < 0 || gatesSize < 0 || hiddenSize < 0)
+          return -1.0;
+        return 2.0 * numDirections * seqLength * batchSize * gatesSize *
+               (inputSize + hiddenSize);
+      })
+      .Case<ONNXMaxPoolSingleOutOp, ONNXAveragePoolOp>([&](auto poolOp) {
+        double kernelSize = 1;
+        for (Attribute dim : poolOp.getKernelShape())
+          kernelSize *= dim.cast<IntegerAttr>().getInt();
+        return outputSize * kernelSize;
+      })
+      .Case<ONNXReduceMeanV13Op>([&](ONNXReduceMeanV13Op reduceOp) {
+        return (double)getNumElements(reduceOp.getData());
+      })
+      .Case<ONNXSoftmaxOp>([&](ONNXSoftmaxOp) {
+        // Max, exp and sum, then division.
+        return 4.0 * outputSize;
+      })
+      .Default([&](Operation *) {
+        // Elementwise ops.
+        return (double)outputSize;
+      });
+}
+
+// Return the cost of converting a value to or from the stickified layout, or
+// -1 if unknown.
+double getStickCost(Value val) {
+  int64_t numElements = getNumElements(val);
+  if (numElements < 0)
+    return -1;
+  double cost = kStickNsPerElement * numElements;
+  if (val.getType().cast<ShapedType>().getRank() == 4)
+    cost *= kNCHWToNHWCFactor;
+  return cost;
+}
+
+// Check whether an op can be lowered to NNPA.
+bool isLegalOnNNPA(Operation *op, const DimAnalysis *dimAnalysis) {
+  return TypeSwitch<Operation *, bool>(op)
+      .Case<ONNXAddOp, ONNXSubOp, ONNXMulOp, ONNXDivOp, ONNXSumOp, ONNXMinOp,
+          ONNXMaxOp, ONNXReluOp, ONNXTanhOp, ONNXSigmoidOp, ONNXLogOp,
+          ONNXExpOp, ONNXSoftmaxOp, ONNXMaxPoolSingleOutOp, ONNXAveragePoolOp,
+          ONNXMatMulOp, ONNXGemmOp, ONNXReduceMeanV13Op, ONNXLSTMOp, ONNXGRUOp,
+          ONNXConvOp>([&](auto onnxOp) {
+        return canRunOnZDNN<decltype(onnxOp)>(onnxOp, dimAnalysis);
+      })
+      .Default([](Operation *) { return false; });
+}
+
+//===----------------------------------------------------------------------===//
+// Device placement pass
+//===----------------------------------------------------------------------===//
+
+struct DevicePlacementPass
+    : public PassWrapper<DevicePlacementPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DevicePlacementPass)
+
+  StringRef getArgument() const override { return "device-placement"; }
+
+  StringRef getDescription() const override {
+    return "Place ONNX ops on CPU or NNPA using a cost model.";
+  }
+
+  // Make sure that we have a valid default constructor and copy
+  // constructor to make sure that the options are initialized properly.
+  DevicePlacementPass() = default;
+  DevicePlacementPass(const DevicePlacementPass &pass)
+      : PassWrapper<DevicePlacementPass, OperationPass<ModuleOp>>() {}
+  DevicePlacementPass(mlir::ArrayRef<std::string> execNodesOnCpu) {
+    this->execNodesOnCpu = execNodesOnCpu;
+  }
+  void runOnOperation() final;
+
+public:
+  ListOption<std::string> execNodesOnCpu{*this, "execNodesOnCpu",
+      llvm::cl::desc("Comma-separated list of node names in an onnx graph. The "
+                     "specified nodes are forced to run on the CPU instead of "
+                     "using the zDNN. The node name is an optional attribute "
+                     "in onnx graph, which is `onnx_node_name` in ONNX IR"),
+      llvm::cl::ZeroOrMore};
+
+private:
+  // Check whether an op can be placed on NNPA.
+  bool canRunOnNNPA(Operation *op, const DimAnalysis *dimAnalysis) {
+    if (isForcedOnCPU(op, execNodesOnCpu))
+      return false;
+    return isLegalOnNNPA(op, dimAnalysis);
+  }
+};
+
+void DevicePlacementPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  MLIRContext *context = &getContext();
+
+  // Run the unknown dimension analysis to help check equality of unknown
+  // dimensions at compile time.
+  DimAnalysis dimAnalysis(module);
+  dimAnalysis.analyze();
+
+  // Group the ops that can run on NNPA into regions of connected ops.
+  llvm::SetVector<Operation *> candidates;
+  module.walk([&](Operation *op) {
+    if (canRunOnNNPA(op, &dimAnalysis))
+      candidates.insert(op);
+  });
+  llvm::EquivalenceClasses<Operation *> regions;
+  for (Operation *op : candidates) {
+    regions.insert(op);
+    for (Value operand : op->getOperands()) {
+      Operation *defOp = operand.getDefiningOp();
+      if (defOp && candidates.contains(defOp))
+        regions.unionSets(defOp, op);
+    }
+  }
+
+  // Place each region on the cheapest device.
+  for (auto it = regions.begin(); it != regions.end(); ++it) {
+    if (!it->isLeader())
+      continue;
+    SmallVector<Operation *, 4> ops(
+        regions.member_begin(it), regions.member_end());
+    llvm::SmallPtrSet<Operation *, 4> inRegion(ops.begin(), ops.end());
+    double cpuCost = 0, nnpaCost = 0;
+    bool isKnown = true;
+    llvm::SmallPtrSet<Value, 4> boundaryValues;
+    for (Operation *op : ops) {
+      double numOps = getNumOps(op);
+      if (numOps < 0) {
+        isKnown = false;
+        break;
+      }
+      cpuCost += numOps / kCPUOpsPerNs;
+      nnpaCost += kNNPALaunchNs + numOps / kNNPAOpsPerNs;
+      // Inputs computed on the CPU are sticked. Constants are sticked at
+      // compile time.
+      for (Value operand : op->getOperands()) {
+        Operation *defOp = operand.getDefiningOp();
+        if (!operand.getType().isa<ShapedType>() ||
+            (defOp && (inRegion.contains(defOp) || isa<ONNXConstantOp>(defOp))))
+          continue;
+        boundaryValues.insert(operand);
+      }
+      // Results used on the CPU are unsticked.
+      for (Value result : op->getResults()) {
+        if (llvm::any_of(result.getUsers(), [&](Operation *user) {
+              return !inRegion.contains(user);
+            }))
+          boundaryValues.insert(result);
+      }
+    }
+    for (Value val : boundaryValues) {
+      double stickCost = getStickCost(val);
+      if (stickCost < 0) {
+        isKnown = false;
+        break;
+      }
+      nnpaCost += stickCost;
+    }
+    // Regions with unknown costs stay on NNPA, where they run without the
+    // cost model.
+    bool onCPU = isKnown && cpuCost < nnpaCost;
+    LLVM_DEBUG(llvm::dbgs() << "Region of " << ops.size() << " ops: CPU cost "
+                            << cpuCost << " ns, NNPA cost " << nnpaCost
+                            << " ns, placed on " << (onCPU ? "CPU" : "NNPA")
+                            << "\n");
+    StringAttr device =
+        StringAttr::get(context, onCPU ? CPU_DEVICE : NNPA_DEVICE);
+    for (Operation *op : ops)
+      op->setAttr(DEVICE_ATTRIBUTE, device);
+  }
+}
+
+} // end anonymous namespace.
+
+std::unique_ptr<Pass> createDevicePlacementPass() {
+  return std::make_unique<DevicePlacementPass>();
+}
+
+std::unique_ptr<Pass> createDevicePlacementPass(
+    mlir::ArrayRef<std::string> execNodesOnCpu) {
+  return std::make_unique<DevicePlacementPass>(execNodesOnCpu);
+}
+
+} // namespace onnx_mlir
+
+double getNNPAOpCost(
+    Operation *op, const onnx_mlir::DimAnalysis *dimAnalysis) {
+  using namespace onnx_mlir;
+  if (!isLegalOnNNPA(op, dimAnalysis))
+    return -1;
+  double numOps = getNumOps(op);
+  if (numOps < 0)
+    return -1;
+  double cost = kNNPALaunchNs + numOps / kNNPAOpsPerNs;
+  // Operands are sticked, except constants that are sticked at compile time,
+  // and results are unsticked.
+  SmallVector<Value, 4> convertedValues;
+  for (Value operand : op->getOperands())
+    if (operand.getType().isa<ShapedType>() &&
+        !operand.getDefiningOp<ONNXConstantOp>())
+      convertedValues.emplace_back(operand);
+  convertedValues.append(op->result_begin(), op->result_end());
+  for (Value val : convertedValues) {
+    double stickCost = getStickCost(val);
+    if (stickCost < 0)
+      return -1;
+    cost += stickCost;
+  }
+  return cost;
+}
@@ -309,6 +309,9 @@ void ONNXToZHighLoweringPass::runOnOperation() {
   combinedPatterns.insert<replaceONNXMatMulAddPattern1>(&getContext());
   combinedPatterns.insert<replaceONNXMatMulAddPattern2>(&getContext());
   combinedPatterns.insert<replaceONNXReluConvPattern>(&getContext());
+  combinedPatterns.insert<replaceONNXConvAddPattern1>(&getContext());
+  combinedPatterns.insert<replaceONNXConvAddPattern2>(&getContext());
+  combinedPatterns.insert<replaceONNXReluZHighConvPattern>(&getContext());
   combinedPatterns.insert<replaceONNXLogSoftmaxPattern>(&getContext());
 
   // It's ok to fail.
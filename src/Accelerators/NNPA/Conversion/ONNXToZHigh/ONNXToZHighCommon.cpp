@@ -14,9 +14,35 @@
 //===----------------------------------------------------------------------===//
 
 #include "src/Accelerators/NNPA/Conversion/ONNXToZHigh/ONNXToZHighCommon.hpp"
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
 
 using namespace mlir;
 
+bool isForcedOnCPU(Operation *op, ArrayRef<std::string> execNodesOnCpu) {
+  StringAttr nodeName = op->getAttrOfType<StringAttr>("onnx_node_name");
+  if (nodeName && llvm::any_of(execNodesOnCpu, [nodeName](StringRef val) {
+        return nodeName.getValue().equals_insensitive(val);
+      }))
+    return true;
+  StringAttr device = op->getAttrOfType<StringAttr>(DEVICE_ATTRIBUTE);
+  return device && !device.getValue().equals_insensitive(NNPA_DEVICE);
+}
+
+bool exceedsZDNNDimensionLimit(Operation *op) {
+  return llvm::any_of(op->getOperands(), [](Value operand) {
+    if (auto valueType = operand.getType().dyn_cast<ShapedType>()) {
+      // Check if static dimension size exceeds zDNN limitations
+      ArrayRef<int64_t> valueShape = valueType.getShape();
+      if (llvm::any_of(valueShape, [](int64_t dim) {
+            return (!ShapedType::isDynamic(dim)) &&
+                   (dim > NNPA_MAXIMUM_DIMENSION_INDEX_SIZE);
+          }))
+        return true;
+    }
+    return false;
+  });
+}
+
 /// Get transposed tensor by using a permutation array.
 /// TODO: migrate this to onnx-mlir.
 Value emitONNXTranspose(
@@ -49,3 +75,31 @@ Value emitONNXTransposeWithType(Location loc, PatternRewriter &rewriter,
       loc, transposedType, x, rewriter.getI64ArrayAttr(perms));
   return transposedInput.getResult();
 }
+
+bool isConvChannelBias(Value conv, Value bias) {
+  auto convType = conv.getType().dyn_cast<RankedTensorType>();
+  auto biasType = bias.getType().dyn_cast<RankedTensorType>();
+  if (!convType || !biasType || convType.getRank() != 4 ||
+      !biasType.hasStaticShape() ||
+      convType.getElementType() != biasType.getElementType())
+    return false;
+  ArrayRef<int64_t> shape = biasType.getShape();
+  int64_t rank = biasType.getRank();
+  if (rank != 3 && !(rank == 4 && shape[0] == 1))
+    return false;
+  int64_t channels = convType.getShape()[1];
+  return !ShapedType::isDynamic(channels) && shape[rank - 3] == channels &&
+         shape[rank - 2] == 1 && shape[rank - 1] == 1;
+}
+
+Value emitONNXReshapeConvBiasTo1D(
+    Location loc, PatternRewriter &rewriter, Value bias) {
+  auto biasType = bias.getType().cast<RankedTensorType>();
+  int64_t channels = biasType.getShape()[biasType.getRank() - 3];
+  onnx_mlir::MultiDialectBuilder<onnx_mlir::OnnxBuilder> create(
+      rewriter, loc);
+  Type resType = RankedTensorType::get({channels}, biasType.getElementType());
+  return create.onnx.reshape(
+      resType, bias, create.onnx.constantInt64({channels}));
+}
+
@@ -19,45 +19,48 @@
 #include "src/Accelerators/NNPA/Support/LayoutHelper.hpp"
 #include "src/Transform/ONNX/ONNXDimAnalysis.hpp"
 
+/// Attribute set on ONNX ops by the device placement, with the device the op
+/// is assigned to.
+const std::string DEVICE_ATTRIBUTE = "device";
+const std::string CPU_DEVICE = "cpu";
+const std::string NNPA_DEVICE = "nnpa";
+
+/// Check whether an op is forced to run on the CPU, either because its node
+/// name is in execNodesOnCpu or because the device placement assigned it to
+/// the CPU or to another accelerator.
+bool isForcedOnCPU(
+    mlir::Operation *op, mlir::ArrayRef<std::string> execNodesOnCpu);
+
+/// Return the estimated cost, in nanoseconds, of running an op alone on NNPA,
+/// including sticking its operands and unsticking its results. Return -1 if
+/// the op cannot run on NNPA or its cost is unknown.
+double getNNPAOpCost(
+    mlir::Operation *op, const onnx_mlir::DimAnalysis *dimAnalysis);
+
+/// Check whether a static dimension of an operand of an op exceeds the zDNN
+/// limitations.
+bool exceedsZDNNDimensionLimit(mlir::Operation *op);
+
+/// Check whether an op can be lowered to zDNN.
+template <typename OP_TYPE>
+bool canRunOnZDNN(OP_TYPE op, const onnx_mlir::DimAnalysis *dimAnalysis) {
+  // TODO: Check tensor size NNPA_MAXIMUM_TENSOR_SIZE of another limitation
+  if (exceedsZDNNDimensionLimit(op.getOperation()))
+    return false;
+  return isSuitableForZDNN<OP_TYPE>(op, dimAnalysis);
+}
+
 template <typename OP_TYPE>
 void addDynamicallyLegalOpFor(mlir::ConversionTarget *target,
     const onnx_mlir::DimAnalysis *dimAnalysis,
     mlir::ArrayRef<std::string> execNodesOnCpu) {
-  target->addDynamicallyLegalOp<OP_TYPE>([dimAnalysis, execNodesOnCpu](
-                                             OP_TYPE op) {
-    // Check operations to be forced to run on CPU.
-    mlir::Operation *genericOp = op.getOperation();
-    mlir::StringAttr nodeName =
-        genericOp->getAttrOfType<mlir::StringAttr>("onnx_node_name");
-    if (nodeName) {
-      bool exists =
-          llvm::any_of(execNodesOnCpu, [nodeName](llvm::StringRef val) {
-            return nodeName.getValue().equals_insensitive(val);
-          });
-      if (exists)
-        return true;
-    }
-
-    // Check zDNN limitations
-    // TODO: Check tensor size NNPA_MAXIMUM_TENSOR_SIZE of another limitation
-    bool exceedLimit =
-        llvm::any_of(genericOp->getOperands(), [](mlir::Value operand) {
-          if (auto valueType = operand.getType().dyn_cast<mlir::ShapedType>()) {
-            // Check if static dimension size exceeds zDNN limitations
-            llvm::ArrayRef<int64_t> valueShape = valueType.getShape();
-            if (llvm::any_of(valueShape, [](int64_t dim) {
-                  return (!mlir::ShapedType::isDynamic(dim)) &&
-                         (dim > NNPA_MAXIMUM_DIMENSION_INDEX_SIZE);
-                }))
-              return true;
-          }
-          return false;
-        });
-    if (exceedLimit)
-      return true;
-
-    return !isSuitableForZDNN<OP_TYPE>(op, dimAnalysis);
-  });
+  target->addDynamicallyLegalOp<OP_TYPE>(
+      [dimAnalysis, execNodesOnCpu](OP_TYPE op) {
+        // Check operations to be forced to run on CPU.
+        if (isForcedOnCPU(op.getOperation(), execNodesOnCpu))
+          return true;
+        return !canRunOnZDNN<OP_TYPE>(op, dimAnalysis);
+      });
 }
 
 /// Get transposed tensor by using a permutation array.
@@ -69,3 +72,11 @@ mlir::Value emitONNXTranspose(mlir::Location loc,
 mlir::Value emitONNXTransposeWithType(mlir::Location loc,
     mlir::PatternRewriter &rewriter, mlir::Type transposedType, mlir::Value x,
     mlir::ArrayRef<int64_t> perms);
+
+/// Check whether `bias` is a per-channel bias for the NCHW result of a
+/// convolution, i.e. it has shape [C, 1, 1] or [1, C, 1, 1].
+bool isConvChannelBias(mlir::Value conv, mlir::Value bias);
+
+/// Reshape a per-channel bias of shape [C, 1, 1] or [1, C, 1, 1] to [C].
+mlir::Value emitONNXReshapeConvBiasTo1D(
+    mlir::Location loc, mlir::PatternRewriter &rewriter, mlir::Value bias);
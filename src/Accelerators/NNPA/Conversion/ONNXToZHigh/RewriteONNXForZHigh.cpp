@@ -310,6 +310,143 @@ Type CreatePaddedXType(Value x, ArrayAttr pads) {
   return paddedType;
 }
 
+//===----------------------------------------------------------------------===//
+// Tiling of ops exceeding the NNPA dimension limit.
+//
+// An op whose static dimension exceeds NNPA_MAXIMUM_DIMENSION_INDEX_SIZE is
+// split along that dimension of its result into tiles that fit the limit, so
+// that each tile runs on NNPA. The operands are split along the matching
+// dimension, or used whole when they are broadcasted along it, and the results
+// of the tiles are concatenated.
+//
+//===----------------------------------------------------------------------===//
+
+/// Check if an op computes its result element-wise from its operands, with
+/// broadcasting.
+bool isElementwiseForNNPATiling(Operation *op) {
+  return isa<ONNXAddOp, ONNXSubOp, ONNXMulOp, ONNXDivOp, ONNXSumOp, ONNXMinOp,
+      ONNXMaxOp, ONNXReluOp, ONNXTanhOp, ONNXSigmoidOp, ONNXLogOp, ONNXExpOp>(
+      op);
+}
+
+/// Return the axis of an operand that is split when the result of an op is
+/// split along the given axis, or -1 if each tile uses the whole operand.
+int64_t getOperandTileAxis(Operation *op, unsigned operandIndex, int64_t axis) {
+  Value operand = op->getOperand(operandIndex);
+  int64_t outputRank = getRank(op->getResult(0).getType());
+  int64_t rank = getRank(operand.getType());
+  ArrayRef<int64_t> shape = getShape(operand.getType());
+  // Broadcasted dimensions are aligned on the innermost dimensions.
+  auto broadcastAxis = [&]() -> int64_t {
+    int64_t operandAxis = axis - (outputRank - rank);
+    if (operandAxis < 0 || shape[operandAxis] == 1)
+      return -1;
+    return operandAxis;
+  };
+  if (isElementwiseForNNPATiling(op))
+    return broadcastAxis();
+  if (isa<ONNXMatMulOp>(op)) {
+    // A: [B1, ..., Bk, M, K], B: [B1, ..., Bk, K, N] and Y: [B1, ..., Bk, M, N]
+    if (axis == outputRank - 2)
+      return (operandIndex == 0) ? rank - 2 : -1;
+    if (axis == outputRank - 1)
+      return (operandIndex == 1) ? rank - 1 : -1;
+    if (rank == 2)
+      return -1;
+    return broadcastAxis();
+  }
+  if (isa<ONNXConvOp>(op)) {
+    // X: [N, C, H, W], W: [M, C, KH, KW], B: [M] and Y: [N, M, H', W']
+    if (axis == 0)
+      return (operandIndex == 0) ? 0 : -1;
+    return (operandIndex == 0) ? -1 : 0;
+  }
+  llvm_unreachable("Unsupported op for NNPA tiling");
+}
+
+/// Return the axis of the result along which an op exceeding the NNPA
+/// dimension limit is split into tiles, or -1 if the op must not be split.
+int64_t getNNPATileAxis(
+    Operation *op, ArrayRef<std::string> execNodesOnCpu = {}) {
+  if (!isElementwiseForNNPATiling(op) && !isa<ONNXMatMulOp, ONNXConvOp>(op))
+    return -1;
+  if (isForcedOnCPU(op, execNodesOnCpu))
+    return -1;
+  // Only split static float tensors.
+  Type outputType = op->getResult(0).getType();
+  if (!hasStaticShape(outputType) || !getElementType(outputType).isF32())
+    return -1;
+  for (Value operand : op->getOperands())
+    if (!operand.getType().isa<NoneType>() &&
+        !hasStaticShape(operand.getType()))
+      return -1;
+
+  // Axes of the result that can be split.
+  int64_t outputRank = getRank(outputType);
+  SmallVector<bool, 4> isTileable(outputRank, true);
+  if (auto matMulOp = dyn_cast<ONNXMatMulOp>(op)) {
+    if (getRank(matMulOp.getA().getType()) < 2 ||
+        getRank(matMulOp.getB().getType()) < 2)
+      return -1;
+  } else if (auto convOp = dyn_cast<ONNXConvOp>(op)) {
+    // Split along N, or along M when there are no groups.
+    if (outputRank != 4)
+      return -1;
+    isTileable[1] = (convOp.getGroup() == 1);
+    isTileable[2] = isTileable[3] = false;
+  }
+
+  // Split along the first axis exceeding the limit. All the dimensions of the
+  // operands exceeding the limit must be split too, otherwise the tiles would
+  // not run on NNPA anyway.
+  ArrayRef<int64_t> outputShape = getShape(outputType);
+  int64_t tileAxis = -1;
+  SmallVector<SmallVector<bool, 4>, 4> isSplit;
+  for (Value operand : op->getOperands())
+    isSplit.emplace_back(operand.getType().isa<NoneType>()
+                             ? 0
+                             : getRank(operand.getType()),
+        false);
+  for (int64_t axis = 0; axis < outputRank; ++axis) {
+    if (outputShape[axis] <= NNPA_MAXIMUM_DIMENSION_INDEX_SIZE)
+      continue;
+    if (!isTileable[axis])
+      return -1;
+    if (tileAxis == -1)
+      tileAxis = axis;
+    for (unsigned i = 0; i < op->getNumOperands(); ++i) {
+      if (op->getOperand(i).getType().isa<NoneType>())
+        continue;
+      int64_t operandAxis = getOperandTileAxis(op, i, axis);
+      if (operandAxis >= 0)
+        isSplit[i][operandAxis] = true;
+    }
+  }
+  if (tileAxis == -1)
+    return -1;
+  for (unsigned i = 0; i < op->getNumOperands(); ++i) {
+    Type type = op->getOperand(i).getType();
+    if (type.isa<NoneType>())
+      continue;
+    ArrayRef<int64_t> shape = getShape(type);
+    for (unsigned d = 0; d < shape.size(); ++d)
+      if (shape[d] > NNPA_MAXIMUM_DIMENSION_INDEX_SIZE && !isSplit[i][d])
+        return -1;
+  }
+  return tileAxis;
+}
+
+/// Return balanced tile sizes splitting a dimension into tiles that do not
+/// exceed the NNPA dimension limit.
+SmallVector<int64_t, 4> getNNPATileSizes(int64_t dimSize) {
+  int64_t numTiles =
+      llvm::divideCeil(dimSize, NNPA_MAXIMUM_DIMENSION_INDEX_SIZE);
+  SmallVector<int64_t, 4> tileSizes;
+  for (int64_t t = 0; t < numTiles; ++t)
+    tileSizes.emplace_back(dimSize / numTiles + (t < dimSize % numTiles));
+  return tileSizes;
+}
+
 //===----------------------------------------------------------------------===//
 // Rewrite ONNX ops to ZHigh ops and ONNX ops for ZHigh.
 //===----------------------------------------------------------------------===//
@@ -381,6 +518,70 @@ struct ExpandPowToMulPattern : public ConversionPattern {
   };
 };
 
+/// Split an op exceeding the NNPA dimension limit into tiles along the axis
+/// given by getNNPATileAxis, and concatenate the results of the tiles. The
+/// tiles that still exceed the limit along other axes are split again.
+struct SplitForNNPALimitPattern : public ConversionPattern {
+  SplitForNNPALimitPattern(StringRef opName, MLIRContext *context)
+      : ConversionPattern(opName, 1, context) {}
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const final {
+    Location loc = op->getLoc();
+    int64_t axis = getNNPATileAxis(op);
+    if (axis < 0)
+      return failure();
+
+    // Rewrite
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, loc);
+    Type outputType = op->getResult(0).getType();
+    ArrayRef<int64_t> outputShape = getShape(outputType);
+    SmallVector<int64_t, 4> tileSizes = getNNPATileSizes(outputShape[axis]);
+    int64_t numTiles = tileSizes.size();
+
+    // Split the operands, or use them whole in each tile.
+    SmallVector<SmallVector<Value, 4>, 4> tileOperands(numTiles);
+    for (unsigned i = 0; i < operands.size(); ++i) {
+      Value operand = operands[i];
+      int64_t operandAxis = operand.getType().isa<NoneType>()
+                                ? -1
+                                : getOperandTileAxis(op, i, axis);
+      if (operandAxis < 0) {
+        for (int64_t t = 0; t < numTiles; ++t)
+          tileOperands[t].emplace_back(operand);
+        continue;
+      }
+      SmallVector<Type, 4> splitTypes;
+      SmallVector<int64_t, 4> splitShape(getShape(operand.getType()));
+      for (int64_t t = 0; t < numTiles; ++t) {
+        splitShape[operandAxis] = tileSizes[t];
+        splitTypes.emplace_back(
+            RankedTensorType::get(splitShape, getElementType(outputType)));
+      }
+      auto splitOp = rewriter.create<ONNXSplitOp>(loc, splitTypes, operand,
+          create.onnx.constantInt64(tileSizes),
+          rewriter.getIntegerAttr(rewriter.getIntegerType(64, true),
+              operandAxis));
+      for (int64_t t = 0; t < numTiles; ++t)
+        tileOperands[t].emplace_back(splitOp.getResult(t));
+    }
+
+    // Compute the tiles with the same op and attributes.
+    SmallVector<Value, 4> tiles;
+    SmallVector<int64_t, 4> tileShape(outputShape);
+    for (int64_t t = 0; t < numTiles; ++t) {
+      tileShape[axis] = tileSizes[t];
+      Type tileType =
+          RankedTensorType::get(tileShape, getElementType(outputType));
+      Operation *tileOp = rewriter.create(loc, op->getName().getIdentifier(),
+          tileOperands[t], tileType, op->getAttrs());
+      tiles.emplace_back(tileOp->getResult(0));
+    }
+    Value result = create.onnx.concat(outputType, tiles, axis);
+    rewriter.replaceOp(op, result);
+    return success();
+  };
+};
+
 struct RewriteONNXForZHighPass
     : public PassWrapper<RewriteONNXForZHighPass, OperationPass<ModuleOp>> {
 
@@ -427,25 +628,33 @@ void RewriteONNXForZHighPass::runOnOperation() {
   //
   // This is preferred for NNPA because NNPA BinaryOp does not support
   // broadcasting.
-  target.addDynamicallyLegalOp<ONNXAddOp>([](ONNXAddOp op) {
+  target.addDynamicallyLegalOp<ONNXAddOp>([this](ONNXAddOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     return !((isDefinedByONNXConstantOp(op.getA()) &&
                  isUniBroadcatableFirstToSecond(op.getA(), op.getB())) ||
              (isDefinedByONNXConstantOp(op.getB()) &&
                  isUniBroadcatableFirstToSecond(op.getB(), op.getA())));
   });
-  target.addDynamicallyLegalOp<ONNXDivOp>([](ONNXDivOp op) {
+  target.addDynamicallyLegalOp<ONNXDivOp>([this](ONNXDivOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     return !((isDefinedByONNXConstantOp(op.getA()) &&
                  isUniBroadcatableFirstToSecond(op.getA(), op.getB())) ||
              (isDefinedByONNXConstantOp(op.getB()) &&
                  isUniBroadcatableFirstToSecond(op.getB(), op.getA())));
   });
-  target.addDynamicallyLegalOp<ONNXMulOp>([](ONNXMulOp op) {
+  target.addDynamicallyLegalOp<ONNXMulOp>([this](ONNXMulOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     return !((isDefinedByONNXConstantOp(op.getA()) &&
                  isUniBroadcatableFirstToSecond(op.getA(), op.getB())) ||
              (isDefinedByONNXConstantOp(op.getB()) &&
                  isUniBroadcatableFirstToSecond(op.getB(), op.getA())));
   });
-  target.addDynamicallyLegalOp<ONNXSubOp>([](ONNXSubOp op) {
+  target.addDynamicallyLegalOp<ONNXSubOp>([this](ONNXSubOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     return !((isDefinedByONNXConstantOp(op.getA()) &&
                  isUniBroadcatableFirstToSecond(op.getA(), op.getB())) ||
              (isDefinedByONNXConstantOp(op.getB()) &&
@@ -457,7 +666,10 @@ void RewriteONNXForZHighPass::runOnOperation() {
   // - one input is N-D, N > 3 and the other is 2-D.
   // Rewrite patterns will be added to turn this MatMulOp into the one where N-D
   // will become 3-D.
-  target.addDynamicallyLegalOp<ONNXMatMulOp>([&dimAnalysis](ONNXMatMulOp op) {
+  target.addDynamicallyLegalOp<ONNXMatMulOp>([this, &dimAnalysis](
+                                                 ONNXMatMulOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     Type aType = op.getA().getType();
     Type bType = op.getB().getType();
     if (!isRankedShapedType(aType) || !isRankedShapedType(bType))
@@ -512,15 +724,33 @@ void RewriteONNXForZHighPass::runOnOperation() {
     return true;
   });
 
-  target.addDynamicallyLegalOp<ONNXConvOp>([](ONNXConvOp op) {
+  target.addDynamicallyLegalOp<ONNXConvOp>([this](ONNXConvOp op) {
+    if (getNNPATileAxis(op, execNodesOnCpu) >= 0)
+      return false;
     return isSuitableForZDNN<ONNXConvOp>(op) ||
            !canInferencePadsForNNPAConv(op);
   });
 
+  // Illegalize the other ops exceeding the NNPA dimension limit that can be
+  // split into NNPA-legal tiles.
+  target.addDynamicallyLegalOp<ONNXSumOp, ONNXMinOp, ONNXMaxOp, ONNXReluOp,
+      ONNXTanhOp, ONNXSigmoidOp, ONNXLogOp, ONNXExpOp>([this](Operation *op) {
+    return getNNPATileAxis(op, execNodesOnCpu) < 0;
+  });
+
   // Single ONNX to ZHigh operation lowering.
   RewritePatternSet patterns(&getContext());
   populateWithGenerated(patterns);
   patterns.insert<ExpandPowToMulPattern>(&getContext());
+  for (StringRef opName : {ONNXAddOp::getOperationName(),
+           ONNXSubOp::getOperationName(), ONNXMulOp::getOperationName(),
+           ONNXDivOp::getOperationName(), ONNXSumOp::getOperationName(),
+           ONNXMinOp::getOperationName(), ONNXMaxOp::getOperationName(),
+           ONNXReluOp::getOperationName(), ONNXTanhOp::getOperationName(),
+           ONNXSigmoidOp::getOperationName(), ONNXLogOp::getOperationName(),
+           ONNXExpOp::getOperationName(), ONNXMatMulOp::getOperationName(),
+           ONNXConvOp::getOperationName()})
+    patterns.insert<SplitForNNPALimitPattern>(opName, &getContext());
 
   // With the target and rewrite patterns defined, we can now attempt the
   // conversion. The conversion will signal failure if any of our `illegal`
@@ -27,6 +27,8 @@
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 
+#include <unordered_map>
+
 using namespace mlir;
 using namespace onnx_mlir::zlow;
 
@@ -478,14 +480,139 @@ ZMemRefType convertZTensorToMemRefType(Type type) {
   return resZMemRefType;
 }
 
+//===----------------------------------------------------------------------===//
+// Helper functions converting stickified tensors in CPU loop nests
+//===----------------------------------------------------------------------===//
+
+/// Return true if a ztensor of the given type is stickified or unstickified by
+/// a CPU loop nest converting its elements one at a time when the conversion
+/// is fused with the CPU loops. The layouts whose padding must be zero, or
+/// which transpose or concatenate their tensors, are left to zDNN.
+static bool isConvertedByCPULoops(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  if (!tensorType || !tensorType.getEncoding())
+    return false;
+  switch (getZTensorLayout(tensorType)) {
+  case ZTensorEncodingAttr::DataLayout::_1D:
+  case ZTensorEncodingAttr::DataLayout::_2D:
+  case ZTensorEncodingAttr::DataLayout::_3D:
+  case ZTensorEncodingAttr::DataLayout::_4D:
+  case ZTensorEncodingAttr::DataLayout::_2DS:
+  case ZTensorEncodingAttr::DataLayout::_3DS:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Return true if the op runs on the CPU once lowered, i.e. it is an ONNX op.
+static bool isCPUOp(Operation *op) {
+  return op && isa_and_nonnull<ONNXDialect>(op->getDialect());
+}
+
+// Bit patterns of the dlfloat16 format, with 1 sign, 6 exponent and 9
+// fraction bits, and of f32, used to convert between them as
+// Stickify/Convert.cpp does.
+static constexpr int64_t kDLF16FractionShift = 23 - 9;
+static constexpr int64_t kDLF16ExponentBiasDiff = 127 - 31;
+static constexpr int64_t kDLF16Sign = 0x8000;
+static constexpr int64_t kDLF16NINF = 0x7fff;
+static constexpr int64_t kF32Abs = 0x7fffffff;
+static constexpr int64_t kF32NaN = 0x7fc00000;
+static constexpr int64_t kF32DLF16Round = 1 << (kDLF16FractionShift - 1);
+static constexpr int64_t kF32DLF16NMAX =
+    ((63 + kDLF16ExponentBiasDiff) << 23) | (((1 << 9) - 2) << 14) |
+    (kF32DLF16Round - 1);
+
+/// Convert a dlfloat16 element, loaded as f16, to f32. Values are exact, NINF
+/// converts to NaN.
+static Value emitDLF16ToF32(const MathBuilder &createMath, Value dlf16) {
+  OpBuilder &b = createMath.getBuilder();
+  Location loc = createMath.getLoc();
+  Type i32Type = b.getI32Type();
+  Value bits16 = b.create<arith::BitcastOp>(loc, b.getI16Type(), dlf16);
+  Value bits = b.create<arith::ExtUIOp>(loc, i32Type, bits16);
+  Value shift16 = createMath.constant(i32Type, 16);
+  Value sign = b.create<arith::ShLIOp>(loc,
+      createMath.andi(bits, createMath.constant(i32Type, kDLF16Sign)),
+      shift16);
+  Value abs = createMath.andi(bits, createMath.constant(i32Type, kDLF16NINF));
+  Value shifted = b.create<arith::ShLIOp>(
+      loc, abs, createMath.constant(i32Type, kDLF16FractionShift));
+  Value rebiased = createMath.add(shifted,
+      createMath.constant(i32Type, kDLF16ExponentBiasDiff << 23));
+  Value fp32 = createMath.ori(sign, rebiased);
+  fp32 = createMath.select(
+      createMath.eq(abs, createMath.constant(i32Type, 0)), sign, fp32);
+  fp32 = createMath.select(
+      createMath.eq(abs, createMath.constant(i32Type, kDLF16NINF)),
+      createMath.constant(i32Type, kF32NaN), fp32);
+  return b.create<arith::BitcastOp>(loc, b.getF32Type(), fp32);
+}
+
+/// Convert an f32 element to dlfloat16, stored as f16, rounding to nearest.
+/// Values too small flush to zero, values too large, infinity and NaN
+/// saturate to NINF.
+static Value emitF32ToDLF16(const MathBuilder &createMath, Value fp32) {
+  OpBuilder &b = createMath.getBuilder();
+  Location loc = createMath.getLoc();
+  Type i32Type = b.getI32Type();
+  Value bits = b.create<arith::BitcastOp>(loc, i32Type, fp32);
+  Value sign = createMath.andi(
+      b.create<arith::ShRUIOp>(loc, bits, createMath.constant(i32Type, 16)),
+      createMath.constant(i32Type, kDLF16Sign));
+  Value abs = createMath.andi(bits, createMath.constant(i32Type, kF32Abs));
+  // Rounding carries into the exponent when the fraction overflows.
+  Value rounded = b.create<arith::ShRUIOp>(loc,
+      createMath.add(abs, createMath.constant(i32Type, kF32DLF16Round)),
+      createMath.constant(i32Type, kDLF16FractionShift));
+  Value bias = createMath.constant(i32Type, kDLF16ExponentBiasDiff << 9);
+  Value inRange = b.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::uge, rounded, bias);
+  Value magnitude = createMath.select(inRange, createMath.sub(rounded, bias),
+      createMath.constant(i32Type, 0));
+  Value tooLarge = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::ugt,
+      abs, createMath.constant(i32Type, kF32DLF16NMAX));
+  magnitude = createMath.select(
+      tooLarge, createMath.constant(i32Type, kDLF16NINF), magnitude);
+  Value bits16 = b.create<arith::TruncIOp>(
+      loc, b.getI16Type(), createMath.ori(sign, magnitude));
+  return b.create<arith::BitcastOp>(loc, b.getF16Type(), bits16);
+}
+
+/// Emit a loop nest over the given dims converting each element of the input,
+/// f32 when stickifying or a ztensor memref when unstickifying, into the
+/// output. The ztensor memrefs are accessed through their layout map.
+static void emitStickifyLoops(ConversionPatternRewriter &rewriter,
+    Location loc, Value input, Value output, ArrayRef<IndexExpr> dims,
+    bool stickify) {
+  MultiDialectBuilder<KrnlBuilder> create(rewriter, loc);
+  int64_t rank = dims.size();
+  ValueRange loopDef = create.krnl.defineLoops(rank);
+  SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+  create.krnl.iterateIE(loopDef, loopDef, lbs, dims,
+      [&](KrnlBuilder &createKrnl, ValueRange indices) {
+        MultiDialectBuilder<MathBuilder> create(createKrnl);
+        Value element = createKrnl.load(input, indices);
+        Value converted = stickify ? emitF32ToDLF16(create.math, element)
+                                   : emitDLF16ToF32(create.math, element);
+        createKrnl.store(converted, output, indices);
+      });
+}
+
 //===----------------------------------------------------------------------===//
 // Lower ZHigh Stick to ZLow Stick
 //===----------------------------------------------------------------------===//
 
 struct ZHighToZLowStickOpLowering : public ConversionPattern {
-  ZHighToZLowStickOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+  ZHighToZLowStickOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool convertOnCPU)
       : ConversionPattern(
-            typeConverter, ZHighStickOp::getOperationName(), 1, ctx) {}
+            typeConverter, ZHighStickOp::getOperationName(), 1, ctx),
+        convertOnCPU(convertOnCPU) {}
+
+  // Whether the inputs computed by CPU ops are stickified by CPU loops.
+  bool convertOnCPU;
 
   LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const final {
@@ -506,6 +633,17 @@ struct ZHighToZLowStickOpLowering : public ConversionPattern {
     Value alloc = insertAllocAndDeallocZMemRef(
         zMemRefType, shapeHelper.getOutputDims(), op, rewriter);
 
+    // Stickify the input computed by a CPU op in a CPU loop nest, which the
+    // loop fusion merges with the loops of the op storing the input, so that
+    // the input in f32 is never materialized.
+    if (convertOnCPU && isConvertedByCPULoops(*op->result_type_begin()) &&
+        isCPUOp(op->getOperand(0).getDefiningOp())) {
+      emitStickifyLoops(rewriter, loc, operandAdaptor.getIn(), alloc,
+          shapeHelper.getOutputDims(), /*stickify=*/true);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // Set pre-transformed layout: if NHWC, we can directly stickify from NCHW.
     if (isNHWCLayout(layout))
       layout = getNCHWLayoutAttr(rewriter);
@@ -596,9 +734,14 @@ struct ZHighToZLowStickForGRUOpLowering : public ConversionPattern {
 //===----------------------------------------------------------------------===//
 
 struct ZHighToZLowUnstickOpLowering : public ConversionPattern {
-  ZHighToZLowUnstickOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+  ZHighToZLowUnstickOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool convertOnCPU)
       : ConversionPattern(
-            typeConverter, ZHighUnstickOp::getOperationName(), 1, ctx) {}
+            typeConverter, ZHighUnstickOp::getOperationName(), 1, ctx),
+        convertOnCPU(convertOnCPU) {}
+
+  // Whether the outputs only used by CPU ops are unstickified by CPU loops.
+  bool convertOnCPU;
 
   LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const final {
@@ -626,6 +769,17 @@ struct ZHighToZLowUnstickOpLowering : public ConversionPattern {
     Value alloc = insertAllocAndDeallocZMemRef(
         zMemRefType, shapeHelper.getOutputDims(), op, rewriter);
 
+    // Unstickify the output only used by CPU ops in a CPU loop nest, which the
+    // loop fusion merges with the loops of the ops loading the output, so that
+    // the output in f32 is never materialized.
+    if (convertOnCPU && isConvertedByCPULoops(op->getOperand(0).getType()) &&
+        llvm::all_of(op->getUsers(), isCPUOp)) {
+      emitStickifyLoops(rewriter, loc, input, alloc,
+          shapeHelper.getOutputDims(), /*stickify=*/false);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // Set layout: if NHWC, we can directly unstickify to NCHW.
     if (isNHWCLayout(layout))
       layout = getNCHWLayoutAttr(rewriter);
@@ -680,24 +834,54 @@ struct ZHighToZLowStickifiedConstantOpLowering : public ConversionPattern {
     assert((data.size() == (uint64_t)memRefSizeInBytes) &&
            "The stickified tensor's buffer size and MemRef's size mismatched");
 
+    // Constants with the same type and content, e.g. a weight used by
+    // several ops or entry points, share the name and value of the first
+    // one, so that they are lowered to a single global.
+    Type memRefType = zMemRefType.value;
+    size_t hash = llvm::hash_combine(memRefType.getAsOpaquePointer(),
+        llvm::hash_combine_range(data.begin(), data.end()));
+    StringAttr name;
+    Attribute value;
+    for (const SharedConstant &shared : sharedConstants[hash]) {
+      if (shared.type == memRefType && shared.data == data) {
+        name = shared.name;
+        value = shared.value;
+        break;
+      }
+    }
+    if (!name) {
+      name = rewriter.getStringAttr(
+          "constant_stickify_" + std::to_string(constantID));
+      value = stickifiedConstOp.getValueAttr();
+      sharedConstants[hash].push_back({memRefType, data, name, value});
+      // Increment constant ID:
+      constantID++;
+    }
+
     // Create a KrnlGlobalOp.
-    KrnlGlobalOp constantGlobal =
-        rewriter.create<KrnlGlobalOp>(loc, zMemRefType.value,
-            /*shape=*/
-            rewriter.getI64ArrayAttr(normalizedShape),
-            /*name=*/
-            rewriter.getStringAttr(
-                "constant_stickify_" + std::to_string(constantID)),
-            /*value=*/stickifiedConstOp.getValueAttr(),
-            /*offset=*/nullptr,
-            /*alignment=*/stickifiedConstOp.getAlignmentAttr());
-
-    // Increment constant ID:
-    constantID++;
+    KrnlGlobalOp constantGlobal = rewriter.create<KrnlGlobalOp>(loc,
+        memRefType,
+        /*shape=*/
+        rewriter.getI64ArrayAttr(normalizedShape),
+        /*name=*/name,
+        /*value=*/value,
+        /*offset=*/nullptr,
+        /*alignment=*/stickifiedConstOp.getAlignmentAttr());
 
     rewriter.replaceOp(op, constantGlobal.getResult());
     return success();
   }
+
+private:
+  struct SharedConstant {
+    Type type;
+    ArrayRef<char> data;
+    StringAttr name;
+    Attribute value;
+  };
+  // Lowered constants, by hash of their type and content.
+  mutable std::unordered_map<size_t, SmallVector<SharedConstant, 1>>
+      sharedConstants;
 };
 
 int ZHighToZLowStickifiedConstantOpLowering::constantID = 0;
@@ -1311,13 +1495,16 @@ struct ZHighToZLowBatchNormOpLowering : public ConversionPattern {
 };
 
 void populateZHighToZLowConversionPattern(mlir::RewritePatternSet &patterns,
-    mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx) {
+    mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx,
+    bool convertLayoutOnCPU) {
   // Stickify and unstickify operations.
   patterns.insert<ZHighToZLowStickifiedConstantOpLowering>(typeConverter, ctx);
-  patterns.insert<ZHighToZLowStickOpLowering>(typeConverter, ctx);
+  patterns.insert<ZHighToZLowStickOpLowering>(
+      typeConverter, ctx, convertLayoutOnCPU);
   patterns.insert<ZHighToZLowStickForLSTMOpLowering>(typeConverter, ctx);
   patterns.insert<ZHighToZLowStickForGRUOpLowering>(typeConverter, ctx);
-  patterns.insert<ZHighToZLowUnstickOpLowering>(typeConverter, ctx);
+  patterns.insert<ZHighToZLowUnstickOpLowering>(
+      typeConverter, ctx, convertLayoutOnCPU);
   // Binary operations
   patterns.insert<ZHighToZLowBinaryOpLowering<ZHighAddOp>>(typeConverter, ctx);
   patterns.insert<ZHighToZLowBinaryOpLowering<ZHighSubOp>>(typeConverter, ctx);
@@ -50,9 +50,13 @@ mlir::Value insertAllocAndDeallocZMemRef(ZMemRefType zType,
     mlir::ArrayRef<IndexExpr> dims, mlir::Operation *op,
     mlir::PatternRewriter &rewriter, int64_t alignment);
 
-/// Populate all conversion patterns for ZHigh Ops.
+/// Populate all conversion patterns for ZHigh Ops. With convertLayoutOnCPU,
+/// the stickified inputs computed by CPU ops and the unstickified outputs only
+/// used by CPU ops are converted by CPU loop nests, to be fused with the loops
+/// of these ops, instead of zDNN.
 void populateZHighToZLowConversionPattern(mlir::RewritePatternSet &patterns,
-    mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx);
+    mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx,
+    bool convertLayoutOnCPU = false);
 
 } // namespace zhigh
 } // namespace onnx_mlir
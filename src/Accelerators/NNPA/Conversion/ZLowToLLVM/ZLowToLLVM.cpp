@@ -124,6 +124,7 @@ public:
     Value unstickI8Ptr = zTensorHelper.getAlignedI8Ptr(operandAdaptor.getX());
     callApi(rewriter, loc, module, apiRegistry, API::ZDNN_TRANSFORM_ZTENSOR,
         {toOpaquePtr(rewriter, loc, module, zTensor.val), unstickI8Ptr});
+    emitInstrumentBytes(rewriter, loc, module, op, zTensor.bufferSize);
 
     rewriter.eraseOp(op);
     return success();
@@ -213,6 +214,7 @@ public:
     callApi(rewriter, loc, module, apiRegistry, API::ZDNN_TRANSFORM_ZTENSOR,
         {toOpaquePtr(rewriter, loc, module, zTensor.val), fGatePtr, iGatePtr,
             cGatePtr, oGatePtr});
+    emitInstrumentBytes(rewriter, loc, module, op, zTensor.bufferSize);
 
     rewriter.eraseOp(op);
     return success();
@@ -300,6 +302,7 @@ public:
     callApi(rewriter, loc, module, apiRegistry, API::ZDNN_TRANSFORM_ZTENSOR,
         {toOpaquePtr(rewriter, loc, module, zTensor.val), zGatePtr, rGatePtr,
             hGatePtr});
+    emitInstrumentBytes(rewriter, loc, module, op, zTensor.bufferSize);
 
     rewriter.eraseOp(op);
     return success();
@@ -715,6 +718,7 @@ public:
     Value unstickI8Ptr = zTensorHelper.getAlignedI8Ptr(operandAdaptor.getOut());
     callApi(rewriter, loc, module, apiRegistry, API::ZDNN_TRANSFORM_ORIGTENSOR,
         {toOpaquePtr(rewriter, loc, module, zTensor.val), unstickI8Ptr});
+    emitInstrumentBytes(rewriter, loc, module, op, zTensor.bufferSize);
 
     rewriter.eraseOp(op);
     return success();
@@ -19,6 +19,7 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 
 #include "src/Accelerators/NNPA/Conversion/ZLowToLLVM/ZLowToLLVMCommon.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
 #include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "zdnn.h"
 
@@ -548,5 +549,19 @@ void fillInZTensor(PatternRewriter &rewriter, Location loc, ModuleOp module,
   // 6. Set reserved (not currently used), not touch
 }
 
+void emitInstrumentBytes(PatternRewriter &rewriter, Location loc,
+    ModuleOp module, Operation *op, Value bytes) {
+  auto instrumentOp = dyn_cast_or_null<KrnlInstrumentOp>(op->getNextNode());
+  if (!instrumentOp || instrumentOp.getOpName() != op->getName().getStringRef())
+    return;
+  MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+  // Create a function declaration for OMInstrumentBytes, the signature is:
+  //   `void (i64)`
+  Type llvmVoidTy = LLVM::LLVMVoidType::get(module.getContext());
+  FlatSymbolRefAttr funcRef = create.llvm.getOrInsertSymbolRef(module,
+      StringRef("OMInstrumentBytes"), llvmVoidTy, {rewriter.getI64Type()});
+  create.llvm.call({}, funcRef, {bytes});
+}
+
 } // namespace zlow
 } // namespace onnx_mlir
@@ -195,5 +195,10 @@ void fillInZTensor(mlir::PatternRewriter &rewriter, mlir::Location loc,
     mlir::Value preTransformedDescPtr, mlir::Value transformedDescPtr,
     bool isTransformed, mlir::Value bufferSize, mlir::Value alignedBuffer);
 
+/// Report the bytes converted by a stick or unstick op to the instrumentation
+/// runtime, if the op is instrumented, i.e. followed by its KrnlInstrumentOp.
+void emitInstrumentBytes(mlir::PatternRewriter &rewriter, mlir::Location loc,
+    mlir::ModuleOp module, mlir::Operation *op, mlir::Value bytes);
+
 } // namespace zlow
 } // namespace onnx_mlir
@@ -17,7 +17,9 @@
 #include "mlir/Transforms/Passes.h"
 #include "llvm/Support/Debug.h"
 
+#include "src/Accelerators/NNPA/Compiler/NNPACompilerOptions.hpp"
 #include "src/Accelerators/NNPA/Compiler/NNPACompilerUtils.hpp"
+#include "src/Accelerators/NNPA/Conversion/ONNXToZHigh/ONNXToZHighCommon.hpp"
 #include "src/Accelerators/NNPA/Conversion/ZHighToZLow/ZHighToZLow.hpp"
 #include "src/Accelerators/NNPA/Conversion/ZLowToLLVM/ZLowToLLVM.hpp"
 #include "src/Accelerators/NNPA/Dialect/ZHigh/ZHighOps.hpp"
@@ -78,6 +80,10 @@ void NNPAAccelerator::registerDialects(mlir::DialectRegistry &registry) const {
 
 void NNPAAccelerator::initPasses(int optLevel) const {
   LLVM_DEBUG(llvm::dbgs() << "Initializing passes for NNPA accelerator\n");
+  mlir::registerPass([]() -> std::unique_ptr<mlir::Pass> {
+    return onnx_mlir::createDevicePlacementPass();
+  });
+
   mlir::registerPass([]() -> std::unique_ptr<mlir::Pass> {
     return onnx_mlir::createONNXToZHighPass();
   });
@@ -94,6 +100,10 @@ void NNPAAccelerator::initPasses(int optLevel) const {
     return onnx_mlir::zlow::createZLowDummyOpForMultiDerefPass();
   });
 
+  mlir::registerPass([]() -> std::unique_ptr<mlir::Pass> {
+    return onnx_mlir::zlow::createZLowAsyncOverlapPass();
+  });
+
   mlir::registerPass(
       []() -> std::unique_ptr<mlir::Pass> { return createFoldStdAllocPass(); });
 
@@ -106,6 +116,11 @@ void NNPAAccelerator::initPasses(int optLevel) const {
   });
 }
 
+double NNPAAccelerator::getOpCost(mlir::Operation *op,
+    const onnx_mlir::DimAnalysis *dimAnalysis) const {
+  return getNNPAOpCost(op, dimAnalysis);
+}
+
 mlir::MemRefType NNPAAccelerator::convertTensorTypeToMemRefType(
     const mlir::TensorType tensorType) const {
   assert(tensorType.hasRank() && "expected only ranked shapes");
@@ -137,8 +152,8 @@ void NNPAAccelerator::conversionTargetONNXToKrnl(
 void NNPAAccelerator::rewritePatternONNXToKrnl(
     mlir::RewritePatternSet &patterns, mlir::TypeConverter &typeConverter,
     mlir::MLIRContext *ctx) const {
-  onnx_mlir::zhigh::populateZHighToZLowConversionPattern(
-      patterns, typeConverter, ctx);
+  onnx_mlir::zhigh::populateZHighToZLowConversionPattern(patterns,
+      typeConverter, ctx, nnpaFuseLayoutConversion && enableFusion);
 }
 
 void NNPAAccelerator::conversionTargetKrnlToLLVM(
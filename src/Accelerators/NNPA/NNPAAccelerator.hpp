@@ -58,6 +58,11 @@ public:
   virtual void registerDialects(mlir::DialectRegistry &registry) const final;
   virtual void initPasses(int optLevel) const final;
   //===--------------------------------------------------------------------===//
+  // Hooks for accelerator-placement pass
+  //===--------------------------------------------------------------------===//
+  virtual double getOpCost(mlir::Operation *op,
+      const onnx_mlir::DimAnalysis *dimAnalysis) const final;
+  //===--------------------------------------------------------------------===//
   // Hooks for onnx-to-krnl pass
   //===--------------------------------------------------------------------===//
   virtual mlir::MemRefType convertTensorTypeToMemRefType(
@@ -19,6 +19,11 @@
 
 namespace onnx_mlir {
 
+/// Add pass for placing ONNX ops on CPU or NNPA using a cost model.
+std::unique_ptr<mlir::Pass> createDevicePlacementPass();
+std::unique_ptr<mlir::Pass> createDevicePlacementPass(
+    mlir::ArrayRef<std::string> execNodesOnCpu);
+
 /// Add pass for lowering ONNX ops to ZHigh ops.
 std::unique_ptr<mlir::Pass> createONNXToZHighPass();
 std::unique_ptr<mlir::Pass> createONNXToZHighPass(
@@ -50,5 +55,8 @@ std::unique_ptr<mlir::Pass> createZLowRewritePass();
 /// Add pass for rewriting ZLow ops.
 std::unique_ptr<mlir::Pass> createZLowDummyOpForMultiDerefPass();
 
+/// Add pass for overlapping ZLow ops with independent CPU loops.
+std::unique_ptr<mlir::Pass> createZLowAsyncOverlapPass();
+
 } // namespace zlow
 } // namespace onnx_mlir
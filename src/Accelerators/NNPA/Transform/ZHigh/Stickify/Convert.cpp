@@ -15,18 +15,79 @@
 #include "src/Accelerators/NNPA/Transform/ZHigh/Stickify/Convert.hpp"
 #include "src/Accelerators/NNPA/Transform/ZHigh/Stickify/DLF16Conversion.hpp"
 
+// The NNP-assist facility of z16 converts vectors between fp32 and dlf16.
+#if defined(__s390x__) && defined(__NNP_ASSIST__)
+#include <vecintrin.h>
+#define HAS_NNP_ASSIST_VECTOR 1
+#endif
+
+/// Branch-free versions of NNP1::convert working on the bit patterns, so that
+/// the conversion loops below are vectorized by the compiler (e.g. with the
+/// vector facility of z/Architecture). They compute the same values as
+/// NNP1::convert.
+static inline uint16_t fp32_bits_to_dlf16(uint32_t fp32) {
+  constexpr uint32_t shift = FP32::FRACTION_BITS - NNP1::FRACTION_BITS;
+  constexpr uint32_t bias = (FP32::EXPONENT_BIAS - NNP1::EXPONENT_BIAS)
+                            << NNP1::FRACTION_BITS;
+  uint32_t sign = (fp32 & FP32::SIGN) >> 16;
+  uint32_t abs = fp32 & ~FP32::SIGN;
+  // Rounding carries into the exponent when the fraction overflows.
+  uint32_t rounded = (abs + FP32::NNP1_ROUND) >> shift;
+  // Values too small for dlf16 flush to zero, values too large (including
+  // infinity and NaN) saturate to NINF.
+  uint32_t magnitude = rounded >= bias ? rounded - bias : 0;
+  magnitude = abs > FP32::NNP1_NMAX ? NNP1::NINF : magnitude;
+  return sign | magnitude;
+}
+
+static inline uint32_t dlf16_to_fp32_bits(uint16_t dlf16) {
+  constexpr uint32_t shift = FP32::FRACTION_BITS - NNP1::FRACTION_BITS;
+  constexpr uint32_t bias = (FP32::EXPONENT_BIAS - NNP1::EXPONENT_BIAS)
+                            << FP32::FRACTION_BITS;
+  constexpr uint32_t nan = 0x7fc00000;
+  uint32_t sign = (uint32_t)(dlf16 & NNP1::SIGN) << 16;
+  uint32_t abs = dlf16 & ~NNP1::SIGN;
+  uint32_t fp32 = sign | ((abs << shift) + bias);
+  fp32 = abs == 0 ? sign : fp32;
+  return abs == NNP1::NINF ? nan : fp32;
+}
+
 /// fp32 -> dlf16 conversion.
 uint64_t fp32_to_dlf16(
     float *fp32_data, uint16_t *dflt16_data, uint64_t num_fields) {
-  for (uint64_t i = 0; i < num_fields; i++)
-    dflt16_data[i] = NNP1(fp32_data[i]).uint();
+  uint64_t i = 0;
+#ifdef HAS_NNP_ASSIST_VECTOR
+  // 8 values are rounded into one vector of dlf16.
+  for (; i + 8 <= num_fields; i += 8) {
+    __vector float lo = *(__vector float *)(fp32_data + i);
+    __vector float hi = *(__vector float *)(fp32_data + i + 4);
+    *(__vector unsigned short *)(dflt16_data + i) =
+        vec_round_from_fp32(lo, hi, 0);
+  }
+#endif
+  for (; i < num_fields; i++) {
+    uint32_t fp32;
+    memcpy(&fp32, fp32_data + i, sizeof(fp32));
+    dflt16_data[i] = fp32_bits_to_dlf16(fp32);
+  }
   return num_fields;
 }
 
 /// dlf16 -> fp32 conversion.
 uint64_t dlf16_to_fp32(
     uint16_t *dflt16_data, float *fp32_data, uint64_t num_fields) {
-  for (uint64_t i = 0; i < num_fields; i++)
-    fp32_data[i] = NNP1(dflt16_data[i]).convert();
+  uint64_t i = 0;
+#ifdef HAS_NNP_ASSIST_VECTOR
+  // One vector of dlf16 is extended into 8 values.
+  for (; i + 8 <= num_fields; i += 8) {
+    __vector unsigned short v = *(__vector unsigned short *)(dflt16_data + i);
+    *(__vector float *)(fp32_data + i) = vec_extend_to_fp32_hi(v, 0);
+    *(__vector float *)(fp32_data + i + 4) = vec_extend_to_fp32_lo(v, 0);
+  }
+#endif
+  for (; i < num_fields; i++) {
+    uint32_t fp32 = dlf16_to_fp32_bits(dflt16_data[i]);
+    memcpy(fp32_data + i, &fp32, sizeof(fp32));
+  }
   return num_fields;
 }
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <errno.h>
 #include <fenv.h>
 #include <stdarg.h>
@@ -24,6 +25,7 @@
 #include "src/Accelerators/NNPA/Conversion/ONNXToZHigh/NNPALimit.h"
 #include "src/Accelerators/NNPA/Transform/ZHigh/Stickify/Convert.hpp"
 #include "src/Accelerators/NNPA/Transform/ZHigh/Stickify/Stickify.hpp"
+#include "llvm/Support/Parallel.h"
 
 #ifdef __MVS__
 #pragma export(zdnn_get_library_version_str)
@@ -52,6 +54,10 @@ zdnn_status verify_transformed_descriptor(const zdnn_tensor_desc *tfrmd_desc);
   ((uint32_t)CEIL(x, AIU_2BYTE_CELLS_PER_STICK) * AIU_2BYTE_CELLS_PER_STICK)
 #define ZDNN_STATUS_OK ZDNN_OK
 
+// Minimum number of elements for the rows of a tensor to be stickified in
+// parallel.
+#define STICKIFY_PARALLEL_MIN_ELEMENTS (64 * 1024)
+
 typedef enum elements_mode {
   ELEMENTS_AIU,
   ELEMENTS_PRE,
@@ -734,85 +740,94 @@ zdnn_status transform_ztensor(const void *in_buf, zdnn_ztensor *ztensor) {
 
     if (ztensor->pre_transformed_desc->layout != ZDNN_NCHW) {
 
-      // N
-      for (uint32_t e4x = 0; e4x < ztensor->transformed_desc->dim4; e4x++) {
-
-        // used for pushing out_offset from n to n+1 (i.e., + bytes_per_n)
-        uint64_t out_offset_n = output_offset;
-
-        // H
-        for (uint32_t e3x = 0; e3x < ztensor->transformed_desc->dim3; e3x++) {
-
-          // W
-          for (uint32_t e2x = 0; e2x < ztensor->transformed_desc->dim2; e2x++) {
-            // Prefetch (read) the next input buffer to be used. The HW should
-            // "notice" our sequential accesses and continue them, so we won't
-            // need to aggressively prefetch here.
+      // Each (n, h) row of W x C input values fills its own 4K pages, one page
+      // per 32 w-entries of each C-stick, so rows are independent and are
+      // converted in parallel when the tensor is large enough.
+      uint32_t dim1 = ztensor->transformed_desc->dim1;
+      uint32_t dim2 = ztensor->transformed_desc->dim2;
+      uint32_t dim3 = ztensor->transformed_desc->dim3;
+      uint64_t num_rows = (uint64_t)ztensor->transformed_desc->dim4 * dim3;
+      uint64_t bytes_per_h =
+          CEIL(dim2, AIU_STICKS_PER_PAGE) * AIU_PAGESIZE_IN_BYTES;
+      uint64_t input_bytes_per_h = ((uint64_t)dim2 * dim1) << input_cell_shift;
+
+      // FP exception flags are per thread, so each row collects its own and
+      // they are combined once all the rows are converted.
+      std::atomic<int> fe_flags(0);
+      std::atomic<bool> failed(false);
+      auto transform_row = [&](size_t row) {
+        uint64_t e4x = row / dim3, e3x = row % dim3;
+        feclearexcept(FE_ALL_EXCEPT);
+        uint64_t row_input_offset = row * input_bytes_per_h;
+        uint64_t row_output_offset = e4x * bytes_per_n + e3x * bytes_per_h;
+
+        // W
+        for (uint32_t e2x = 0; e2x < dim2; e2x++) {
+          // Prefetch (read) the next input buffer to be used. The HW should
+          // "notice" our sequential accesses and continue them, so we won't
+          // need to aggressively prefetch here.
 #if defined(__MVS__)
-            __dcbt((void *)((uintptr_t)in_buf + input_offset));
+          __dcbt((void *)((uintptr_t)in_buf + row_input_offset));
 #else
-            __builtin_prefetch((void *)((uintptr_t)in_buf + input_offset), 0);
+          __builtin_prefetch((void *)((uintptr_t)in_buf + row_input_offset), 0);
 #endif
-            // used for pushing out_offset from w to w+1 (i.e., +
-            // AIU_BYTES_PER_STICK)
-            uint64_t out_offset_w = output_offset;
-
-            // process each C-stick (i.e., every 64 elements or whatever
-            // left in dim1)
-            for (uint32_t e1x = 0; e1x < ztensor->transformed_desc->dim1;
-                 e1x += AIU_2BYTE_CELLS_PER_STICK) {
-              // Prefetch to L1 newest offset to write that HW wouldn't
-              // know about
+          // w-entries are AIU_BYTES_PER_STICK bytes apart in each C-stick.
+          uint64_t out_offset = row_output_offset + e2x * AIU_BYTES_PER_STICK;
+
+          // process each C-stick (i.e., every 64 elements or whatever
+          // left in dim1)
+          for (uint32_t e1x = 0; e1x < dim1; e1x += AIU_2BYTE_CELLS_PER_STICK) {
+            // Prefetch to L1 newest offset to write that HW wouldn't
+            // know about
 #if defined(__MVS__)
-              __dcbtst((void *)((uintptr_t)ztensor->buffer + output_offset));
+            __dcbtst((void *)((uintptr_t)ztensor->buffer + out_offset));
 #else
-              __builtin_prefetch(
-                  (void *)((uintptr_t)ztensor->buffer + output_offset), 1);
+            __builtin_prefetch(
+                (void *)((uintptr_t)ztensor->buffer + out_offset), 1);
 #endif
-              fields_to_convert = MIN((ztensor->transformed_desc->dim1 - e1x),
-                  AIU_2BYTE_CELLS_PER_STICK);
+            uint32_t fields =
+                MIN((dim1 - e1x), (uint32_t)AIU_2BYTE_CELLS_PER_STICK);
 
-              nbr_fields_converted = convert_data_format(
-                  (void *)((uintptr_t)in_buf + input_offset),
-                  ztensor->pre_transformed_desc->type,
-                  (void *)((uintptr_t)ztensor->buffer + output_offset),
-                  ztensor->transformed_desc->type, fields_to_convert);
+            uint32_t converted = convert_data_format(
+                (void *)((uintptr_t)in_buf + row_input_offset),
+                ztensor->pre_transformed_desc->type,
+                (void *)((uintptr_t)ztensor->buffer + out_offset),
+                ztensor->transformed_desc->type, fields);
 
-              if (nbr_fields_converted == 0) {
-                return ZDNN_CONVERT_FAILURE;
-              }
+            if (converted == 0) {
+              failed = true;
+              return;
+            }
 
-              // Release L1 cacheline for stick. The next "touch" will be
-              // from NNPA, and it doesn't need L1 caching.
+            // Release L1 cacheline for stick. The next "touch" will be
+            // from NNPA, and it doesn't need L1 caching.
 #if defined(__MVS__)
-              __dcbf((void *)((uintptr_t)ztensor->buffer + output_offset));
+            __dcbf((void *)((uintptr_t)ztensor->buffer + out_offset));
 #else
 // No known equivalent fn without dropping to ASM....
 #endif
-              // push input_offset the next c-stick, fake the multiply by
-              // bit-shifting
-              input_offset += (nbr_fields_converted << input_cell_shift);
-
-              // push output_offset to the next c-stick of the same super
-              // c-stick, which is bytes_all_h number of bytes away.
-              output_offset += bytes_all_h;
-            }
+            // push input offset the next c-stick, fake the multiply by
+            // bit-shifting
+            row_input_offset += (converted << input_cell_shift);
 
-            // output_offset was pushed around in dim1 loops, so reset it to
-            // the next w
-            output_offset = out_offset_w + AIU_BYTES_PER_STICK;
+            // push output offset to the next c-stick of the same super
+            // c-stick, which is bytes_all_h number of bytes away.
+            out_offset += bytes_all_h;
           }
-
-          // after processing all the w-entries, go to the next 4k-boundary
-          // location (aka stick padding)
-          output_offset = (output_offset + (AIU_PAGESIZE_IN_BYTES - 1)) &
-                          (-AIU_PAGESIZE_IN_BYTES);
         }
-
-        // output_offset was pushed around in the dims[2-0] loops, so reset it
-        // to the next n
-        output_offset = out_offset_n + bytes_per_n;
-      }
+        fe_flags |= fetestexcept(FE_ALL_EXCEPT);
+      };
+
+      uint64_t num_elements = num_rows * dim2 * dim1;
+      if (num_rows > 1 && num_elements >= STICKIFY_PARALLEL_MIN_ELEMENTS)
+        llvm::parallelFor(0, num_rows, transform_row);
+      else
+        for (uint64_t row = 0; row < num_rows; row++)
+          transform_row(row);
+
+      if (failed)
+        return ZDNN_CONVERT_FAILURE;
+      feraiseexcept(fe_flags);
 
     } else { // NCHW
 
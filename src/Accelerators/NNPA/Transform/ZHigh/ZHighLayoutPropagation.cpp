@@ -262,7 +262,8 @@ public:
 
 private:
   // Check if there are no pads along the given axis when stickifying values by
-  // using the given layout.
+  // using the given layout. The N and H dimensions are not tiled, so there are
+  // never pads along them.
   bool haveNoPadsWhenStickified(
       ValueRange values, StringAttr layoutAttr, IntegerAttr axisAttr) const {
     if (!layoutAttr)
@@ -271,12 +272,19 @@ private:
     // stickification scheme.
     if (!(isNHWCLayout(layoutAttr) || is4DLayout(layoutAttr)))
       return false;
-    // Only support C dimension at this moment.
-    int CAxis = 3; // C is at 3 for 4D and NHWC.
-    if (isNHWCLayout(layoutAttr))
-      // Value is NCHW that will be directly stickified to NHWC. So C is at 1.
+    int64_t axis = axisAttr.getValue().getSExtValue();
+    int NAxis = 0, HAxis = 1; // N and H are at 0 and 1 for 4D and NHWC.
+    int CAxis = 3;            // C is at 3 for 4D and NHWC.
+    if (isNHWCLayout(layoutAttr)) {
+      // Value is NCHW that will be directly stickified to NHWC. So H is at 2
+      // and C is at 1.
+      HAxis = 2;
       CAxis = 1;
-    if (axisAttr.getValue().getSExtValue() != CAxis)
+    }
+    if (axis == NAxis || axis == HAxis)
+      return true;
+    // Only support C dimension among the tiled dimensions at this moment.
+    if (axis != CAxis)
       return false;
 
     // C dimension is tiled by 64 when stickified. Hence, checking `C mod 64`
@@ -310,6 +318,84 @@ private:
   }
 };
 
+/// The pattern
+///   onnx.Transpose (zhigh.Unstick (%X)) { perm }
+/// can be replaced by
+///   zhigh.Unstick (onnx.Transpose (%X) { new_perm })
+/// Transpose copies elements one by one through the layout of the zTensor, so
+/// it avoids unstickifying and stickifying again the whole tensor.
+class ONNXTransposeLayoutPropagatePattern
+    : public OpRewritePattern<ONNXTransposeOp> {
+public:
+  using OpRewritePattern<ONNXTransposeOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXTransposeOp transposeOp, PatternRewriter &rewriter) const override {
+    Operation *genericOp = transposeOp.getOperation();
+    Location loc = genericOp->getLoc();
+    Value input = transposeOp.getData();
+    Value output = transposeOp.getTransposed();
+    Optional<ArrayAttr> permAttr = transposeOp.getPerm();
+
+    // Input is a CPU tensor, do nothing.
+    if (input.isa<BlockArgument>() ||
+        !isa<ZHighUnstickOp>(input.getDefiningOp()))
+      return failure();
+    Value zTensor = cast<ZHighUnstickOp>(input.getDefiningOp()).getIn();
+    StringAttr layout = convertZTensorDataLayoutToStringAttr(
+        rewriter, getZTensorLayout(zTensor.getType()));
+
+    // Only support LAYOUT_4D and LAYOUT_NHWC at this moment. They have the same
+    // stickification scheme.
+    if (!(isNHWCLayout(layout) || is4DLayout(layout)))
+      return failure();
+    auto inputType = input.getType().dyn_cast<RankedTensorType>();
+    if (!permAttr.has_value() || !inputType || inputType.getRank() != 4 ||
+        !output.getType().isa<RankedTensorType>())
+      return failure();
+
+    // A transpose that only moves dimensions of size 1 is a view of a CPU
+    // tensor, so it is already free.
+    ArrayRef<int64_t> dims = inputType.getShape();
+    SmallVector<int64_t, 4> perm, originalAxes, permutedAxes;
+    for (unsigned i = 0; i < 4; ++i) {
+      perm.emplace_back(ArrayAttrIntVal(permAttr, i));
+      if (dims[i] != 1)
+        originalAxes.emplace_back(i);
+      if (dims[perm[i]] != 1)
+        permutedAxes.emplace_back(perm[i]);
+    }
+    if (originalAxes == permutedAxes)
+      return failure();
+
+    // Rewrite
+    ArrayAttr newPerm = getNewTransposePerm(rewriter, layout, perm);
+    Type newOutputType = getZTensorType(rewriter, loc, output, layout);
+    Value zOutput =
+        rewriter.create<ONNXTransposeOp>(loc, newOutputType, zTensor, newPerm);
+    Value replacedValue =
+        rewriter.create<ZHighUnstickOp>(loc, output.getType(), zOutput);
+    rewriter.replaceOp(genericOp, replacedValue);
+    return success();
+  }
+
+private:
+  // Express the permutation of the CPU tensor in the dimensions of the
+  // zTensor.
+  ArrayAttr getNewTransposePerm(PatternRewriter &rewriter, StringAttr layout,
+      ArrayRef<int64_t> perm) const {
+    if (!isNHWCLayout(layout))
+      return rewriter.getI64ArrayAttr(perm);
+    // The NCHW tensor is stickified into a NHWC zTensor.
+    SmallVector<int64_t, 4> NHWCtoNCHW = {0, 2, 3, 1};
+    SmallVector<int64_t, 4> NCHWtoNHWC = {0, 3, 1, 2};
+    SmallVector<int64_t, 4> newPerm;
+    for (int64_t axis : NHWCtoNCHW)
+      newPerm.emplace_back(NCHWtoNHWC[perm[axis]]);
+    return rewriter.getI64ArrayAttr(newPerm);
+  }
+};
+
 /// Use anonymous namespace to avoid duplication symbol `populateWithGenerated`
 /// among multiple tablegen-based definitions.
 
@@ -360,6 +446,8 @@ struct ZHighLayoutPropagationPass
 
     // Concat
     patterns.insert<ONNXConcatLayoutPropagatePattern>(&getContext());
+    // Transpose
+    patterns.insert<ONNXTransposeLayoutPropagatePattern>(&getContext());
 
     // We want to canonicalize stick/unstick ops during this pass to simplify
     // rules in this pass.
@@ -0,0 +1,256 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------- ZLowAsyncOverlap.cpp - Overlap ZLow ops with CPU code -------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// zDNN calls are synchronous: the CPU waits while the NNPA runs a zlow op.
+// This pass overlaps a zlow op with the CPU loops that follow it and that are
+// independent of it, so that both run at the same time. The zlow op and the
+// independent CPU ops are put into the two iterations of an scf.parallel
+// loop, each inside a krnl.region, which is later outlined to the runtime
+// thread pool when parallelization is enabled.
+//
+// Independence is decided at compile time from the memref footprint of each
+// op. Memrefs are traced through view-like ops to their root buffer. Two ops
+// conflict if one of them writes a root buffer the other one reads or writes,
+// or if one of them uses a value defined by the other one.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include "src/Accelerators/NNPA/Dialect/ZLow/ZLowOps.hpp"
+#include "src/Accelerators/NNPA/Pass/NNPAPasses.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace zlow {
+
+namespace {
+
+bool isZLowOp(Operation *op) {
+  return op->getDialect() &&
+         op->getDialect()->getNamespace() == ZLowDialect::getDialectNamespace();
+}
+
+/// Memrefs read and written by an op and its nested ops.
+struct MemoryFootprint {
+  llvm::SmallPtrSet<Value, 8> reads;
+  llvm::SmallPtrSet<Value, 8> writes;
+  // Set when the op has side effects that cannot be attributed to a memref.
+  bool unknown = false;
+
+  void merge(const MemoryFootprint &other) {
+    reads.insert(other.reads.begin(), other.reads.end());
+    writes.insert(other.writes.begin(), other.writes.end());
+    unknown |= other.unknown;
+  }
+
+  bool conflictsWith(const MemoryFootprint &other) const {
+    if (unknown || other.unknown)
+      return true;
+    for (Value v : writes)
+      if (other.reads.contains(v) || other.writes.contains(v))
+        return true;
+    for (Value v : other.writes)
+      if (reads.contains(v))
+        return true;
+    return false;
+  }
+};
+
+class ZLowAsyncOverlapPass
+    : public PassWrapper<ZLowAsyncOverlapPass, OperationPass<func::FuncOp>> {
+public:
+  StringRef getArgument() const override { return "zlow-async-overlap"; }
+
+  StringRef getDescription() const override {
+    return "Overlap ZLow ops with independent CPU loops.";
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, scf::SCFDialect, KrnlDialect>();
+  }
+
+  void runOnOperation() override {
+    func::FuncOp funcOp = getOperation();
+    if (!funcOp.getBody().hasOneBlock())
+      return;
+    Block &block = funcOp.getBody().front();
+
+    SmallVector<Operation *, 4> zlowOps;
+    for (Operation &op : block)
+      if (isZLowOp(&op))
+        zlowOps.emplace_back(&op);
+    for (Operation *zlowOp : zlowOps)
+      overlap(block, zlowOp);
+  }
+
+private:
+  /// Return the buffer a memref is a view of.
+  Value getRootMemRef(Value v) const {
+    while (auto viewOp = v.getDefiningOp<ViewLikeOpInterface>())
+      v = viewOp.getViewSource();
+    // Function arguments are distinct buffers: model outputs are allocated
+    // inside the function, and inputs are never written.
+    return v;
+  }
+
+  /// Add the effects of `op`, but not of its nested ops, to `fp`.
+  void addEffects(Operation *op, MemoryFootprint &fp) const {
+    if (op->hasTrait<OpTrait::HasRecursiveMemoryEffects>() ||
+        isMemoryEffectFree(op))
+      return;
+    if (auto iface = dyn_cast<MemoryEffectOpInterface>(op)) {
+      SmallVector<MemoryEffects::EffectInstance, 4> effects;
+      iface.getEffects(effects);
+      for (MemoryEffects::EffectInstance &effect : effects) {
+        // A fresh buffer does not conflict with anything.
+        if (isa<MemoryEffects::Allocate>(effect.getEffect()))
+          continue;
+        Value v = effect.getValue();
+        if (!v) {
+          fp.unknown = true;
+          continue;
+        }
+        if (isa<MemoryEffects::Read>(effect.getEffect()))
+          fp.reads.insert(getRootMemRef(v));
+        else
+          fp.writes.insert(getRootMemRef(v));
+      }
+      return;
+    }
+    // ZLow ops and other ops without declared effects are assumed to write
+    // every memref they take.
+    bool hasMemRef = false;
+    for (Value operand : op->getOperands()) {
+      if (!operand.getType().isa<MemRefType>())
+        continue;
+      fp.writes.insert(getRootMemRef(operand));
+      hasMemRef = true;
+    }
+    if (!hasMemRef)
+      fp.unknown = true;
+  }
+
+  MemoryFootprint getFootprint(Operation *op) const {
+    MemoryFootprint fp;
+    op->walk([&](Operation *nestedOp) { addEffects(nestedOp, fp); });
+    return fp;
+  }
+
+  /// Return true if `op` or one of its nested ops uses a value defined by an
+  /// op in `defs`.
+  bool usesValueOf(Block &block, Operation *op,
+      const llvm::SmallPtrSetImpl<Operation *> &defs) const {
+    WalkResult result = op->walk([&](Operation *nestedOp) {
+      for (Value operand : nestedOp->getOperands()) {
+        Operation *defOp = operand.getDefiningOp();
+        if (!defOp)
+          continue;
+        Operation *topOp = block.findAncestorOpInBlock(*defOp);
+        if (topOp && topOp != op && defs.contains(topOp))
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    return result.wasInterrupted();
+  }
+
+  /// Overlap `zlowOp` with the independent CPU loops that follow it, up to
+  /// the next zlow op.
+  void overlap(Block &block, Operation *zlowOp) const {
+    // Ops that must stay after zlowOp, and their footprint.
+    llvm::SmallPtrSet<Operation *, 8> blocked;
+    blocked.insert(zlowOp);
+    MemoryFootprint blockedFp = getFootprint(zlowOp);
+    // Independent CPU ops, in program order.
+    SmallVector<Operation *, 4> cpuOps;
+    // Independent ops without memory effects, e.g. allocs and constants.
+    SmallVector<Operation *, 4> hoistedOps;
+    bool hasLoop = false;
+
+    for (Operation *op = zlowOp->getNextNode(); op; op = op->getNextNode()) {
+      if (isZLowOp(op) || op->hasTrait<OpTrait::IsTerminator>())
+        break;
+      MemoryFootprint fp = getFootprint(op);
+      if (fp.conflictsWith(blockedFp) || usesValueOf(block, op, blocked)) {
+        blocked.insert(op);
+        blockedFp.merge(fp);
+        continue;
+      }
+      bool touchesMemory =
+          fp.unknown || !fp.reads.empty() || !fp.writes.empty();
+      if (!touchesMemory && op->getNumRegions() == 0) {
+        hoistedOps.emplace_back(op);
+        continue;
+      }
+      // Values defined inside a krnl.region cannot be used outside of it.
+      if (op->getNumResults() != 0) {
+        blocked.insert(op);
+        blockedFp.merge(fp);
+        continue;
+      }
+      cpuOps.emplace_back(op);
+      hasLoop |= op->getNumRegions() != 0;
+    }
+    if (!hasLoop)
+      return;
+
+    for (Operation *op : hoistedOps)
+      op->moveBefore(zlowOp);
+
+    OpBuilder builder(zlowOp);
+    Location loc = zlowOp->getLoc();
+    MultiDialectBuilder<MathBuilder, SCFBuilder> create(builder, loc);
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value two = create.math.constantIndex(2);
+    // Move ops into a krnl.region, so that their loops get their own affine
+    // scope.
+    auto emitBranch = [&](SCFBuilder &createSCF, ArrayRef<Operation *> ops) {
+      OpBuilder &b = createSCF.getBuilder();
+      KrnlRegionOp regionOp = b.create<KrnlRegionOp>(loc);
+      Block &body = regionOp.getBodyRegion().front();
+      for (Operation *op : ops)
+        op->moveBefore(&body, body.end());
+    };
+    create.scf.parallelLoop({zero}, {two}, {one},
+        [&](SCFBuilder &createSCF, ValueRange parInd) {
+          MathBuilder createMath(createSCF);
+          Value isNNPA = createMath.eq(parInd[0], zero);
+          createSCF.ifThenElse(
+              isNNPA,
+              [&](SCFBuilder &createBranch) {
+                emitBranch(createBranch, {zlowOp});
+              },
+              [&](SCFBuilder &createBranch) {
+                emitBranch(createBranch, cpuOps);
+              });
+        });
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> createZLowAsyncOverlapPass() {
+  return std::make_unique<ZLowAsyncOverlapPass>();
+}
+
+} // namespace zlow
+} // namespace onnx_mlir
@@ -12,7 +12,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Alignment.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -37,38 +39,22 @@ size_t parseOffsetOrLength(const std::string &value) {
   return offsetOrLength;
 }
 
-// Reads external data from file location specified in tensor proto.
-// The data is little endian encoded.
-// See https://github.com/onnx/onnx/blob/main/docs/ExternalData.md
-std::unique_ptr<llvm::MemoryBuffer> readExternalData_LE(
-    const std::string &externalDataDir, const onnx::TensorProto &tp) {
-  std::string location;
-  uint64_t offset = 0;
-  uint64_t length = -1; // MemoryBuffer uses -1 to mean infinity
-  for (const onnx::StringStringEntryProto &entry : tp.external_data()) {
-    assert(entry.has_key() && "external_data entry must have key");
-    assert(entry.has_value() && "external_data entry must have value");
-    if (entry.key() == "location") {
-      location = entry.value();
-    } else if (entry.key() == "offset") {
-      offset = parseOffsetOrLength(entry.value());
-    } else if (entry.key() == "length") {
-      length = parseOffsetOrLength(entry.value());
-    }
-  }
-  assert(!location.empty() && "missing external data location");
-  llvm::SmallVector<char> path(externalDataDir.begin(), externalDataDir.end());
-  llvm::sys::path::append(path, location);
-  auto bufferOrError = llvm::MemoryBuffer::getFileSlice(
-      path, length, offset, /*IsVolatile=*/false);
-  if (std::error_code ec = bufferOrError.getError()) {
-    std::string pathStr(path.data(), path.size());
-    llvm::errs() << "Error " << ec.message() << " reading from file " << pathStr
-                 << ", offset=" << offset << ", length=" << length << "\n";
-    llvm_unreachable("llvm::MemoryBuffer::getFileSlice failed");
+// A MemoryBuffer pointing into the buffer of a mapped file or into the raw
+// data of a model, which it keeps alive.
+class MemoryBufferSlice : public llvm::MemoryBuffer {
+public:
+  MemoryBufferSlice(std::shared_ptr<const void> owner, llvm::StringRef slice,
+      BufferKind kind)
+      : owner(std::move(owner)), kind(kind) {
+    init(slice.begin(), slice.end(), /*RequiresNullTerminator=*/false);
   }
-  return std::move(bufferOrError.get());
-}
+
+  BufferKind getBufferKind() const override { return kind; }
+
+private:
+  std::shared_ptr<const void> owner;
+  BufferKind kind;
+};
 
 template <typename T>
 struct TransformValueToONNXData {
@@ -149,27 +135,42 @@ T swappedBytes(T x) {
     return llvm::sys::getSwappedBytes(x);
 }
 
+template <typename T>
+mlir::ElementsAttr createElmAttrFromRawBytes_LE(
+    mlir::RankedTensorType tensorType, llvm::ArrayRef<char> bytes) {
+  llvm::ArrayRef<T> array = onnx_mlir::castArrayRef<T>(bytes);
+  return createElmAttrFromArray<T>(tensorType, array,
+      [](T x) { return shouldSwapLEBytes<T> ? swappedBytes<T>(x) : x; });
+}
+
 template <typename T>
 mlir::ElementsAttr createElementsAttrFromMemoryBuffer_LE(
     mlir::RankedTensorType tensorType,
     std::unique_ptr<llvm::MemoryBuffer> membuf) {
   mlir::MLIRContext *ctx = tensorType.getContext();
   assert(tensorType.getElementType() == onnx_mlir::toMlirType<T>(ctx));
+  // Copy misaligned data, and floating point data that needs a byte swap
+  // because widening floating point numbers with swapped bytes could alter
+  // the bytes of NaNs.
+  if (!llvm::isAddrAligned(llvm::Align(alignof(T)), membuf->getBufferStart()) ||
+      (shouldSwapLEBytes<T> && !std::is_integral_v<T>))
+    return createElmAttrFromRawBytes_LE<T>(
+        tensorType, onnx_mlir::asArrayRef(membuf->getBuffer()));
+
+  onnx_mlir::OnnxElementsAttrBuilder elmsBuilder(ctx);
+  mlir::ElementsAttr elms =
+      elmsBuilder.fromMemoryBuffer(tensorType, std::move(membuf));
   if (shouldSwapLEBytes<T>) {
-    llvm::ArrayRef<T> array = onnx_mlir::asArrayRef<T>(membuf->getBuffer());
-    return createElmAttrFromArray<T>(tensorType, array, swappedBytes<T>);
-  } else {
-    return onnx_mlir::OnnxElementsAttrBuilder(ctx).fromMemoryBuffer(
-        tensorType, std::move(membuf));
+    // Swap the bytes of integers lazily, whenever the elements are read,
+    // instead of copying them.
+    constexpr onnx_mlir::BType btype = onnx_mlir::toBType<T>;
+    elms = elmsBuilder.transform(elms, tensorType.getElementType(),
+        [](onnx_mlir::WideNum n) -> onnx_mlir::WideNum {
+          return onnx_mlir::WideNum::widen<btype>(
+              swappedBytes(n.narrow<btype>()));
+        });
   }
-}
-
-template <typename T>
-mlir::ElementsAttr createElmAttrFromRawBytes_LE(
-    mlir::RankedTensorType tensorType, llvm::ArrayRef<char> bytes) {
-  llvm::ArrayRef<T> array = onnx_mlir::castArrayRef<T>(bytes);
-  return createElmAttrFromArray<T>(tensorType, array,
-      [](T x) { return shouldSwapLEBytes<T> ? swappedBytes<T>(x) : x; });
+  return elms;
 }
 
 // Converts to the cpp type 'To' that correspond's to the tensor element type
@@ -195,13 +196,18 @@ mlir::ElementsAttr createElmAttrFromProtoData(mlir::RankedTensorType tensorType,
 // Returns ElementsAttr with tp's data.
 template <typename T>
 mlir::ElementsAttr createElmAttr(mlir::RankedTensorType tensorType,
-    const onnx::TensorProto &tp, const std::string &externalDataDir) {
+    const onnx::TensorProto &tp,
+    onnx_mlir::ExternalDataFileSlicer &externalDataFileSlicer) {
   if (tp.has_data_location() &&
       tp.data_location() == onnx::TensorProto::EXTERNAL) {
     return createElementsAttrFromMemoryBuffer_LE<T>(
-        tensorType, readExternalData_LE(externalDataDir, tp));
+        tensorType, externalDataFileSlicer.slice(tp));
   }
   if (tp.has_raw_data()) {
+    if (std::unique_ptr<llvm::MemoryBuffer> membuf =
+            externalDataFileSlicer.sliceRawData(tp))
+      return createElementsAttrFromMemoryBuffer_LE<T>(
+          tensorType, std::move(membuf));
     return createElmAttrFromRawBytes_LE<T>(
         tensorType, onnx_mlir::asArrayRef(tp.raw_data()));
   }
@@ -229,8 +235,63 @@ mlir::ElementsAttr createStringElmAttr(
 
 namespace onnx_mlir {
 
+// The data is little endian encoded.
+std::unique_ptr<llvm::MemoryBuffer> ExternalDataFileSlicer::slice(
+    const onnx::TensorProto &tp) {
+  std::string location;
+  uint64_t offset = 0;
+  uint64_t length = -1; // -1 means up to the end of the file
+  for (const onnx::StringStringEntryProto &entry : tp.external_data()) {
+    assert(entry.has_key() && "external_data entry must have key");
+    assert(entry.has_value() && "external_data entry must have value");
+    if (entry.key() == "location") {
+      location = entry.value();
+    } else if (entry.key() == "offset") {
+      offset = parseOffsetOrLength(entry.value());
+    } else if (entry.key() == "length") {
+      length = parseOffsetOrLength(entry.value());
+    }
+  }
+  assert(!location.empty() && "missing external data location");
+  llvm::SmallString<128> path(externalDataDir);
+  llvm::sys::path::append(path, location);
+
+  // Map the whole file at its first use. MemoryBuffer maps large files and
+  // reads small ones.
+  std::shared_ptr<llvm::MemoryBuffer> &file = files[path];
+  if (!file) {
+    auto bufferOrError = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+        /*RequiresNullTerminator=*/false, /*IsVolatile=*/false);
+    if (std::error_code ec = bufferOrError.getError()) {
+      llvm::errs() << "Error " << ec.message() << " reading from file "
+                   << path << "\n";
+      llvm_unreachable("llvm::MemoryBuffer::getFile failed");
+    }
+    file = std::move(bufferOrError.get());
+  }
+
+  llvm::StringRef buffer = file->getBuffer();
+  if (length == (uint64_t)-1 && offset <= buffer.size())
+    length = buffer.size() - offset;
+  if (offset > buffer.size() || length > buffer.size() - offset) {
+    llvm::errs() << "Error reading beyond the end of file " << path
+                 << ", offset=" << offset << ", length=" << length << "\n";
+    llvm_unreachable("external data out of file bounds");
+  }
+  return std::make_unique<MemoryBufferSlice>(
+      file, buffer.substr(offset, length), file->getBufferKind());
+}
+
+std::unique_ptr<llvm::MemoryBuffer> ExternalDataFileSlicer::sliceRawData(
+    const onnx::TensorProto &tp) {
+  if (!rawDataOwner)
+    return nullptr;
+  return std::make_unique<MemoryBufferSlice>(rawDataOwner,
+      llvm::StringRef(tp.raw_data()), llvm::MemoryBuffer::MemoryBuffer_Malloc);
+}
+
 mlir::Value EmitInitializerForInputTensor(mlir::Location loc,
-    mlir::OpBuilder &builder, const std::string &externalDataDir,
+    mlir::OpBuilder &builder, ExternalDataFileSlicer &externalDataFileSlicer,
     const onnx::TensorProto &initializer) {
   // Return none if the initializer is an empty tensor, e.g tensor<0xf32>.
   llvm::ArrayRef<int64_t> tensorDims(
@@ -240,12 +301,13 @@ mlir::Value EmitInitializerForInputTensor(mlir::Location loc,
         loc, builder.getNoneType(), builder.getUnitAttr());
 
   mlir::ElementsAttr elmAttr =
-      onnxTensorProtoToElmAttr(builder, externalDataDir, initializer);
+      onnxTensorProtoToElmAttr(builder, externalDataFileSlicer, initializer);
   return builder.create<mlir::ONNXConstantOp>(loc, nullptr, elmAttr);
 }
 
 mlir::ElementsAttr onnxTensorProtoToElmAttr(mlir::OpBuilder &builder,
-    const std::string &externalDataDir, const onnx::TensorProto &tp) {
+    ExternalDataFileSlicer &externalDataFileSlicer,
+    const onnx::TensorProto &tp) {
   // Tensor dimensions.
   llvm::ArrayRef<int64_t> tensorDims(tp.dims().data(), tp.dims().size());
   if (tp.data_type() == onnx::TensorProto::STRING) {
@@ -258,7 +320,7 @@ mlir::ElementsAttr onnxTensorProtoToElmAttr(mlir::OpBuilder &builder,
   auto tensorType = mlir::RankedTensorType::get(tensorDims, elmType);
   return dispatchByBType(btype, [&](auto btype) {
     using cpptype = CppType<btype>;
-    return createElmAttr<cpptype>(tensorType, tp, externalDataDir);
+    return createElmAttr<cpptype>(tensorType, tp, externalDataFileSlicer);
   });
 }
 
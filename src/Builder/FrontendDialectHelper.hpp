@@ -16,16 +16,55 @@
 
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Location.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #include "onnx/onnx_pb.h"
 
+#include <memory>
+#include <string>
+
 namespace onnx_mlir {
 
+// Memory maps the files storing the external data of the tensors of a model,
+// each file once, and slices the mappings into the data of the tensors without
+// copying them. The mappings are released when the slicer and all the slices
+// are destroyed.
+//
+// When given the owner of the model, the raw data of its tensors is sliced
+// too, the slices keeping the model alive instead of its raw data being
+// copied.
+class ExternalDataFileSlicer {
+public:
+  ExternalDataFileSlicer(const std::string &externalDataDir,
+      std::shared_ptr<const void> rawDataOwner = nullptr)
+      : externalDataDir(externalDataDir),
+        rawDataOwner(std::move(rawDataOwner)) {}
+
+  // Returns the external data of tp from the file location specified in tp,
+  // relative to externalDataDir.
+  // See https://github.com/onnx/onnx/blob/main/docs/ExternalData.md
+  std::unique_ptr<llvm::MemoryBuffer> slice(const onnx::TensorProto &tp);
+
+  // Returns the raw data of tp, or nullptr if the model has no owner and the
+  // raw data must be copied.
+  std::unique_ptr<llvm::MemoryBuffer> sliceRawData(
+      const onnx::TensorProto &tp);
+
+private:
+  const std::string externalDataDir;
+  // Keeps alive the model whose raw data is sliced.
+  std::shared_ptr<const void> rawDataOwner;
+  // Mapped files by path.
+  llvm::StringMap<std::shared_ptr<llvm::MemoryBuffer>> files;
+};
+
 mlir::Value EmitInitializerForInputTensor(mlir::Location loc,
-    mlir::OpBuilder &builder, const std::string &externalDataDir,
+    mlir::OpBuilder &builder, ExternalDataFileSlicer &externalDataFileSlicer,
     const onnx::TensorProto &initializer);
 
 mlir::ElementsAttr onnxTensorProtoToElmAttr(mlir::OpBuilder &builder,
-    const std::string &externalDataDir, const onnx::TensorProto &initializer);
+    ExternalDataFileSlicer &externalDataFileSlicer,
+    const onnx::TensorProto &initializer);
 
 } // namespace onnx_mlir
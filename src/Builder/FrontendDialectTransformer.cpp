@@ -49,6 +49,7 @@ SUPPRESS_WARNINGS_POP
 #include <array>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -74,9 +75,13 @@ public:
     InitHandlerMap();
   }
 
-  ModuleOp ImportONNXModel(
-      const onnx::ModelProto &model, ImportOptions options) {
+  // The raw data of the tensors of the model is not copied when the model has
+  // an owner, which the constants then keep alive.
+  ModuleOp ImportONNXModel(const onnx::ModelProto &model,
+      ImportOptions options, std::shared_ptr<const void> modelOwner = nullptr) {
     options_ = options;
+    externalDataFileSlicer_ = std::make_unique<ExternalDataFileSlicer>(
+        options_.externalDataDir, std::move(modelOwner));
     modelInputShaper_.setShapeInformation(options_.shapeInformation);
     SetOpSetImport(model); // Determines which opsets to use.
     importGraph(model.graph());
@@ -99,6 +104,9 @@ private:
 
   ModelInputShaper modelInputShaper_;
 
+  // Maps the files of external data once for all the tensors of the model.
+  std::unique_ptr<ExternalDataFileSlicer> externalDataFileSlicer_;
+
   using ImportHandlerType = void (onnx_mlir::detail::FrontendGenImpl::*)(
       const onnx::NodeProto &);
 
@@ -139,7 +147,7 @@ private:
 
   Value ImportTensor(const onnx::TensorProto &tensor) {
     return EmitInitializerForInputTensor(
-        UnknownLoc(), builder_, options_.externalDataDir, tensor);
+        UnknownLoc(), builder_, *externalDataFileSlicer_, tensor);
   }
 
   /*!
@@ -254,7 +262,7 @@ private:
       break;
     case onnx::AttributeProto::TENSOR:
       mlirAttr = onnxTensorProtoToElmAttr(
-          builder_, options_.externalDataDir, attr.t());
+          builder_, *externalDataFileSlicer_, attr.t());
       break;
     case onnx::AttributeProto::STRINGS: {
       llvm::SmallVector<StringRef, 4> vectorStringRef;
@@ -1171,8 +1179,64 @@ private:
 } // namespace onnx_mlir
 namespace onnx_mlir {
 
-bool ImportFrontendModelInternal(onnx::ModelProto &model, MLIRContext &context,
-    OwningOpRef<ModuleOp> &module, ImportOptions options) {
+namespace {
+// Raw data of at least this many bytes is detached from the initializers of a
+// model while the version converter copies the model, and reattached to the
+// converted model. Smaller raw data, e.g. shapes or scales, may be read by the
+// adapters of the converter.
+constexpr size_t kMinDetachedRawDataSize = 4096;
+
+using DetachedRawData = std::unordered_map<std::string, std::string>;
+
+void detachRawData(onnx::GraphProto &graph, DetachedRawData &rawData) {
+  for (onnx::TensorProto &tensor : *graph.mutable_initializer())
+    if (tensor.raw_data().size() >= kMinDetachedRawDataSize)
+      rawData[tensor.name()].swap(*tensor.mutable_raw_data());
+}
+
+void reattachRawData(onnx::GraphProto &graph, DetachedRawData &rawData) {
+  for (onnx::TensorProto &tensor : *graph.mutable_initializer()) {
+    auto it = rawData.find(tensor.name());
+    if (it != rawData.end() && tensor.raw_data().empty())
+      tensor.mutable_raw_data()->swap(it->second);
+  }
+}
+
+// Clear the typed data of the initializers of the graph, which is copied into
+// the constants of the module, unlike the raw data that they keep alive.
+void releaseCopiedData(onnx::GraphProto &graph) {
+  for (onnx::TensorProto &tensor : *graph.mutable_initializer()) {
+    if (tensor.has_raw_data() ||
+        (tensor.has_data_location() &&
+            tensor.data_location() == onnx::TensorProto::EXTERNAL))
+      continue;
+    tensor.clear_float_data();
+    tensor.clear_int32_data();
+    tensor.clear_string_data();
+    tensor.clear_int64_data();
+    tensor.clear_double_data();
+    tensor.clear_uint64_data();
+  }
+}
+
+// Import a model whose raw data is kept alive by the constants of the module
+// instead of being copied. The rest of the data of the tensors is released
+// after the import.
+void ImportFrontendModelShared(std::shared_ptr<onnx::ModelProto> model,
+    MLIRContext &context, OwningOpRef<ModuleOp> &module,
+    ImportOptions options) {
+  {
+    detail::FrontendGenImpl myONNXGen(context);
+    module = myONNXGen.ImportONNXModel(*model, options, model);
+  }
+  releaseCopiedData(*model->mutable_graph());
+}
+} // namespace
+
+bool ImportFrontendModelInternal(std::shared_ptr<onnx::ModelProto> modelPtr,
+    MLIRContext &context, OwningOpRef<ModuleOp> &module,
+    ImportOptions options) {
+  onnx::ModelProto &model = *modelPtr;
   int originVersion = CURRENT_ONNX_OPSET;
   // Get the version of the model
   // Code copied from onnx/onnx/version_coverter/convert.cc
@@ -1194,15 +1258,23 @@ bool ImportFrontendModelInternal(onnx::ModelProto &model, MLIRContext &context,
   // Did not do downward convert because support for BatchNorm is missing
   if (options.invokeOnnxVersionConverter &&
       originVersion < CURRENT_ONNX_OPSET) {
-    onnx::ModelProto convertModel =
-        onnx::version_conversion::ConvertVersion(model, CURRENT_ONNX_OPSET);
+    // The converter copies the model, so the large raw data is moved out of
+    // the original model and into the converted one instead of being copied.
+    DetachedRawData rawData;
+    detachRawData(*model.mutable_graph(), rawData);
+    auto convertModel = std::make_shared<onnx::ModelProto>(
+        onnx::version_conversion::ConvertVersion(model, CURRENT_ONNX_OPSET));
+    // Release the original model.
+    modelPtr.reset();
+    reattachRawData(*convertModel->mutable_graph(), rawData);
     if (options.useOnnxModelTypes)
-      onnx::shape_inference::InferShapes(convertModel);
-    ImportFrontendModel(convertModel, context, module, options);
+      onnx::shape_inference::InferShapes(*convertModel);
+    ImportFrontendModelShared(
+        std::move(convertModel), context, module, options);
   } else {
     if (options.useOnnxModelTypes)
       onnx::shape_inference::InferShapes(model);
-    ImportFrontendModel(model, context, module, options);
+    ImportFrontendModelShared(std::move(modelPtr), context, module, options);
   }
   return true;
 }
@@ -1211,14 +1283,16 @@ bool ImportFrontendModelInternal(onnx::ModelProto &model, MLIRContext &context,
 int ImportFrontendModelArray(const void *onnxBuffer, int size,
     MLIRContext &context, OwningOpRef<ModuleOp> &module,
     std::string *errorMessage, ImportOptions options) {
-  onnx::ModelProto model;
+  // The model is shared with the constants pointing into its raw data, which
+  // is then parsed out of the buffer once and not copied again.
+  auto model = std::make_shared<onnx::ModelProto>();
 
-  bool parse_success = model.ParseFromArray(onnxBuffer, size);
+  bool parse_success = model->ParseFromArray(onnxBuffer, size);
   if (!parse_success) {
     *errorMessage = "Unable to parse onnxBuffer";
     return InvalidOnnxFormat;
   }
-  ImportFrontendModelInternal(model, context, module, options);
+  ImportFrontendModelInternal(std::move(model), context, module, options);
   return CompilerSuccess;
 }
 
@@ -1226,7 +1300,8 @@ int ImportFrontendModelArray(const void *onnxBuffer, int size,
 int ImportFrontendModelFile(StringRef model_fname, MLIRContext &context,
     OwningOpRef<ModuleOp> &module, std::string *errorMessage,
     ImportOptions options) {
-  onnx::ModelProto model;
+  auto modelPtr = std::make_shared<onnx::ModelProto>();
+  onnx::ModelProto &model = *modelPtr;
   if (model_fname.endswith(".json")) {
     auto buf = openInputFile(model_fname, errorMessage);
     if (!buf) {
@@ -1269,7 +1344,8 @@ int ImportFrontendModelFile(StringRef model_fname, MLIRContext &context,
     }
   }
 
-  if (!ImportFrontendModelInternal(model, context, module, options)) {
+  if (!ImportFrontendModelInternal(
+          std::move(modelPtr), context, module, options)) {
     *errorMessage = "Onnx Model Import Failed on " + model_fname.str();
     return CompilerFailure;
   }
@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------------- CompileProfiler.cpp ------------------------===//
+//
+// Records where the compilation time and memory go, pass by pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Compiler/CompileProfiler.hpp"
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h> // Unsupported on MSVC.
+#endif
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+// The profiler recording the phases run outside of the pass manager.
+CompileProfiler *activeProfiler = nullptr;
+std::mutex activeProfilerMutex;
+
+// Return the peak resident set size of the compiler in KB, or -1 when
+// unknown.
+int64_t getPeakRSSKB() {
+#if defined(__linux__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#elif defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss / 1024;
+#endif
+  return -1;
+}
+
+// Count the ops nested in op, including op, by op name.
+int64_t countOps(Operation *op, llvm::StringMap<int64_t> &opCounts) {
+  int64_t numOps = 0;
+  op->walk([&](Operation *nestedOp) {
+    ++opCounts[nestedOp->getName().getStringRef()];
+    ++numOps;
+  });
+  return numOps;
+}
+
+// Return the name of the op a pass runs on, with its symbol name if any,
+// e.g. "func.func @main_graph".
+std::string getOpName(Operation *op) {
+  std::string name = op->getName().getStringRef().str();
+  if (auto symName =
+          op->getAttrOfType<StringAttr>(SymbolTable::getSymbolAttrName()))
+    name += " @" + symName.str();
+  return name;
+}
+
+double getMilliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // namespace
+
+CompileProfiler::CompileProfiler(std::string profileFilename)
+    : profileFilename(std::move(profileFilename)), startTime(Clock::now()) {
+  std::lock_guard<std::mutex> lock(activeProfilerMutex);
+  activeProfiler = this;
+}
+
+CompileProfiler::~CompileProfiler() {
+  {
+    std::lock_guard<std::mutex> lock(activeProfilerMutex);
+    if (activeProfiler == this)
+      activeProfiler = nullptr;
+  }
+  llvm::json::Object profile{
+      {"total_wall_ms", getMilliseconds(Clock::now() - startTime)},
+      {"peak_rss_kb", getPeakRSSKB()}, {"passes", std::move(passes)},
+      {"subprocesses", std::move(phases)}};
+  std::error_code EC;
+  llvm::raw_fd_ostream os(profileFilename, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "Error: '" << EC.message()
+                 << "' opening compile profile file '" << profileFilename
+                 << "'\n";
+    return;
+  }
+  os << llvm::formatv("{0:2}", llvm::json::Value(std::move(profile))) << "\n";
+}
+
+void CompileProfiler::runBeforePass(Pass *pass, Operation *op) {
+  PassRun run;
+  run.numOps = countOps(op, run.opCounts);
+  run.start = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  runningPasses[{pass, op}] = std::move(run);
+}
+
+void CompileProfiler::runAfterPass(Pass *pass, Operation *op) {
+  recordPass(pass, op, /*failed=*/false);
+}
+
+void CompileProfiler::runAfterPassFailed(Pass *pass, Operation *op) {
+  recordPass(pass, op, /*failed=*/true);
+}
+
+void CompileProfiler::recordPass(Pass *pass, Operation *op, bool failed) {
+  Clock::time_point end = Clock::now();
+  PassRun run;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = runningPasses.find({pass, op});
+    if (it == runningPasses.end())
+      return;
+    run = std::move(it->second);
+    runningPasses.erase(it);
+  }
+
+  // The changes of the number of ops of each type, the ops of a failed pass
+  // being left as they are.
+  llvm::json::Object opCountChanges;
+  int64_t numOps = run.numOps;
+  if (!failed) {
+    llvm::StringMap<int64_t> opCounts;
+    numOps = countOps(op, opCounts);
+    for (auto &entry : opCounts)
+      if (entry.second != run.opCounts.lookup(entry.first()))
+        opCountChanges[entry.first()] =
+            entry.second - run.opCounts.lookup(entry.first());
+    for (auto &entry : run.opCounts)
+      if (!opCounts.count(entry.first()))
+        opCountChanges[entry.first()] = -entry.second;
+  }
+
+  StringRef passName = pass->getArgument();
+  llvm::json::Object passRun{
+      {"pass", passName.empty() ? pass->getName() : passName},
+      {"op", getOpName(op)},
+      {"start_ms", getMilliseconds(run.start - startTime)},
+      {"wall_ms", getMilliseconds(end - run.start)},
+      {"peak_rss_kb", getPeakRSSKB()}, {"ops_before", run.numOps},
+      {"ops_after", numOps}, {"op_count_changes", std::move(opCountChanges)}};
+  if (failed)
+    passRun["failed"] = true;
+  std::lock_guard<std::mutex> lock(mutex);
+  passes.emplace_back(std::move(passRun));
+}
+
+void CompileProfiler::recordPhase(
+    StringRef name, double seconds, int64_t peakRSSKB) {
+  std::lock_guard<std::mutex> activeLock(activeProfilerMutex);
+  if (!activeProfiler)
+    return;
+  CompileProfiler &profiler = *activeProfiler;
+  llvm::json::Object phase{{"name", name},
+      {"start_ms", getMilliseconds(Clock::now() - profiler.startTime) -
+                       seconds * 1000},
+      {"wall_ms", seconds * 1000}, {"peak_rss_kb", peakRSSKB}};
+  std::lock_guard<std::mutex> lock(profiler.mutex);
+  profiler.phases.emplace_back(std::move(phase));
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------------- CompileProfiler.hpp ------------------------===//
+//
+// Records where the compilation time and memory go, pass by pass.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "mlir/Pass/PassInstrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace onnx_mlir {
+
+/// Records the wall time, the peak resident set size and the op counts of
+/// each run of a pass, as well as the time spent in the tools run by the
+/// compiler, e.g. opt, llc and the linker, and writes them in JSON to the
+/// profile file when destroyed. Passes nested on functions may run in
+/// parallel, each of their runs being recorded.
+struct CompileProfiler : public mlir::PassInstrumentation {
+  CompileProfiler(std::string profileFilename);
+  ~CompileProfiler() override;
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override;
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override;
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override;
+
+  /// Record a phase of the compilation run outside of the pass manager, e.g.
+  /// a tool run by the compiler, when a profiler is active. The peak resident
+  /// set size is the one of the tool, or -1 when unknown.
+  static void recordPhase(
+      llvm::StringRef name, double seconds, int64_t peakRSSKB = -1);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PassRun {
+    Clock::time_point start;
+    int64_t numOps;
+    llvm::StringMap<int64_t> opCounts;
+  };
+
+  void recordPass(mlir::Pass *pass, mlir::Operation *op, bool failed);
+
+  std::string profileFilename;
+  Clock::time_point startTime;
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>, PassRun>
+      runningPasses;
+  llvm::json::Array passes;
+  llvm::json::Array phases;
+};
+
+} // namespace onnx_mlir
@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------------------- CompilerCache.cpp -------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Cache of the artifacts compiled by onnx-mlir, keyed by the content of the
+// model, the compiler options, the target and the compiler version.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+
+#include "src/Compiler/CompilerCache.hpp"
+#include "src/Compiler/CompilerOptions.hpp"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Version/Version.hpp"
+
+#include <algorithm>
+
+namespace onnx_mlir {
+
+std::string getCompileCacheDir() {
+  if (!compileCacheDir.empty())
+    return compileCacheDir;
+  if (const auto &envDir = getEnvVar("ONNX_MLIR_COMPILE_CACHE_DIR"))
+    return envDir.value();
+  return "";
+}
+
+bool isCompileCacheable(EmissionTargetType emissionTarget) {
+  // Constants stored into a file are another artifact of the compilation.
+  if (getCompileCacheDir().empty() || storeConstantsToFile)
+    return false;
+  return emissionTarget == EmitObj || emissionTarget == EmitLib ||
+         emissionTarget == EmitJNI;
+}
+
+std::string getCompileCacheKey(llvm::StringRef model,
+    llvm::ArrayRef<std::string> options, EmissionTargetType emissionTarget) {
+  // The options are hashed in order so that their order on the command line
+  // does not matter. Each item is followed by a NUL so that no two sequences
+  // of items hash the same.
+  std::vector<std::string> sortedOptions(options.begin(), options.end());
+  std::sort(sortedOptions.begin(), sortedOptions.end());
+
+  llvm::SHA256 hasher;
+  auto update = [&hasher](llvm::StringRef item) {
+    hasher.update(item);
+    hasher.update(llvm::StringRef("\0", 1));
+  };
+  update(getOnnxMlirFullVersion());
+  update(getTargetTripleOption());
+  update(getTargetCPUOption());
+  update(getTargetArchOption());
+  update(std::to_string(emissionTarget));
+  for (const std::string &option : sortedOptions)
+    update(option);
+  // The tuned tile sizes are read from a file that may be tuned again.
+  if (!matmulTileDB.empty()) {
+    if (auto tileDB = llvm::MemoryBuffer::getFile(matmulTileDB))
+      update((*tileDB)->getBuffer());
+  }
+  // So is the profile used to optimize the model.
+  if (!pgoUse.empty()) {
+    if (auto profile = llvm::MemoryBuffer::getFile(pgoUse))
+      update((*profile)->getBuffer());
+  }
+  update(model);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+// Return the path of the artifact cached with the key, which keeps the
+// extension of the output file.
+static std::string getCachedFilename(
+    const std::string &key, const std::string &outputFilenameWithExt) {
+  llvm::SmallString<256> path(getCompileCacheDir());
+  llvm::sys::path::append(
+      path, key + llvm::sys::path::extension(outputFilenameWithExt).str());
+  return std::string(path);
+}
+
+bool lookupCompileCache(
+    const std::string &key, const std::string &outputFilenameWithExt) {
+  std::string cachedFilename = getCachedFilename(key, outputFilenameWithExt);
+  if (!llvm::sys::fs::exists(cachedFilename))
+    return false;
+  if (llvm::sys::fs::copy_file(cachedFilename, outputFilenameWithExt))
+    return false;
+  if (VerboseOutput)
+    printf("Compilation cache hit: %s copied from %s.\n",
+        outputFilenameWithExt.c_str(), cachedFilename.c_str());
+  return true;
+}
+
+void storeCompileCache(
+    const std::string &key, const std::string &outputFilenameWithExt) {
+  std::string cachedFilename = getCachedFilename(key, outputFilenameWithExt);
+  if (llvm::sys::fs::create_directories(getCompileCacheDir()))
+    return;
+  // Copy into a unique temporary file first, then rename it, so that
+  // concurrent compilations never see a partially written artifact.
+  llvm::SmallString<256> tempFilename;
+  if (llvm::sys::fs::createUniqueFile(cachedFilename + ".%%%%%%", tempFilename))
+    return;
+  if (llvm::sys::fs::copy_file(outputFilenameWithExt, tempFilename) ||
+      llvm::sys::fs::rename(tempFilename, cachedFilename)) {
+    llvm::sys::fs::remove(tempFilename);
+    return;
+  }
+  if (VerboseOutput)
+    printf("Compilation cached: %s copied to %s.\n",
+        outputFilenameWithExt.c_str(), cachedFilename.c_str());
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------------------- CompilerCache.hpp -------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Cache of the artifacts compiled by onnx-mlir, keyed by the content of the
+// model, the compiler options, the target and the compiler version.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "onnx-mlir/Compiler/OMCompilerTypes.h"
+
+#include <string>
+
+namespace onnx_mlir {
+
+// Return the directory of the compilation cache, given by --compile-cache-dir
+// or else by the ONNX_MLIR_COMPILE_CACHE_DIR environment variable. Return an
+// empty string if the cache is disabled.
+std::string getCompileCacheDir();
+
+// Return true if the artifacts of the emission target can be cached, i.e. if
+// the cache is enabled and the target is a single binary file.
+bool isCompileCacheable(EmissionTargetType emissionTarget);
+
+// Return the key of a compilation, a SHA-256 digest of the model, of the
+// options, which are sorted, of the emission target, of the target triple,
+// cpu and architecture, and of the version of the compiler. The options are
+// the command line arguments, excluding the input and output file names.
+std::string getCompileCacheKey(llvm::StringRef model,
+    llvm::ArrayRef<std::string> options, EmissionTargetType emissionTarget);
+
+// Copy the artifact cached with the key into the output file. Return true if
+// the cache has the artifact.
+bool lookupCompileCache(
+    const std::string &key, const std::string &outputFilenameWithExt);
+
+// Copy the output file into the cache with the key. Failures are ignored: the
+// artifact is then compiled again next time.
+void storeCompileCache(
+    const std::string &key, const std::string &outputFilenameWithExt);
+
+} // namespace onnx_mlir
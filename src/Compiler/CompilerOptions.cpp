@@ -75,6 +75,78 @@ llvm::cl::opt<std::string> shapeInformation("shapeInformation",
         "unknown dimensions)"),
     llvm::cl::value_desc("value"), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<std::string> shapeBuckets("shapeBuckets",
+    llvm::cl::desc(
+        "Buckets of shapes for the inputs of the ONNX model, for which "
+        "specializations of the model with static shapes are compiled in "
+        "addition to the model for any shapes.\n"
+        "\"value\" is a list of buckets separated by \";\", each in the "
+        "format of the shapeInformation option. At runtime, the "
+        "specialization of the first bucket matching the shapes of the "
+        "inputs is run"),
+    llvm::cl::value_desc("value"), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> outputSubsets("output-subsets",
+    llvm::cl::desc(
+        "Subsets of the outputs of the ONNX model, for which entry points "
+        "only computing these outputs are compiled in addition to the entry "
+        "point computing all of them (default: none)\n"
+        "\"value\" is a list of subsets separated by \";\", each listing "
+        "output names separated by \",\". The entry point of subset k is "
+        "run_<func>_subset<k>, and ExecutionSession::getEntryPointForOutputs "
+        "returns the smallest entry point computing the requested outputs."),
+    llvm::cl::value_desc("NAME1,NAME2;NAME3;..."), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> extractNodes("extract-nodes",
+    llvm::cl::desc(
+        "Groups of internal nodes of the ONNX model, for which entry points "
+        "returning the results of these nodes and only running the part of "
+        "the model they depend on are compiled, e.g. to extract the features "
+        "computed by a backbone (default: none)\n"
+        "\"value\" is a list of groups separated by \";\", each listing node "
+        "names separated by \",\". The entry point of group k is "
+        "run_<func>_extract<k>, whose outputs are named by the node names, "
+        "or <node>_<i> for the nodes with several results."),
+    llvm::cl::value_desc("NODE1,NODE2;NODE3;..."), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> uint8NHWCInputs("uint8-nhwc-inputs",
+    llvm::cl::desc(
+        "Image inputs of the ONNX model, of 4D float NCHW types, taken as the "
+        "uint8 NHWC tensors of the decoded images instead (default: none)\n"
+        "\"value\" is a list of input names separated by \",\". The "
+        "convolutions reading these inputs convert and transpose them on "
+        "load, without materializing the float NCHW tensors."),
+    llvm::cl::value_desc("NAME1,NAME2,..."), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> packedSequenceOffsets("packed-sequence-offsets",
+    llvm::cl::desc(
+        "Run the transformer encoder of the ONNX model over variable-length "
+        "sequences packed along the token dimension, instead of padded to "
+        "the longest one (default: none)\n"
+        "\"value\" is the name of a new last input of the model, the 1D "
+        "int64 tensor [s_0, ..., s_n] of the offsets of the sequences, "
+        "sequence i being made of the tokens [s_i, s_i+1) of a batch of one. "
+        "The fused attentions only attend to the tokens of the same "
+        "sequence."),
+    llvm::cl::value_desc("NAME"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> pagedKVCache("paged-kv-cache",
+    llvm::cl::desc(
+        "Keep the key/value caches of the decoder attentions of the ONNX "
+        "model in fixed-size blocks, instead of concatenating the past and "
+        "new keys and values at each step (default=false)\n"
+        "The past keys and values of a Concat feeding a fused attention "
+        "become caches of blocks [N, H..., P, D] written in place, read "
+        "through the new last inputs kv_block_table, the int64 [B, M] table "
+        "of the blocks of each sequence, and kv_past_length, the int64 "
+        "tensor<1xi64> of the number of past tokens. An ExecutionState "
+        "created with PagedKVCacheOptions manages both inputs."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<std::string> customEnvFlags("customEnvFlags",
     llvm::cl::desc("Override default option env var OnnxMlirEnvOptionName: "
                    "ONNX_MLIR_FLAGS"),
@@ -90,6 +162,15 @@ llvm::cl::opt<std::string> mcpu("mcpu", llvm::cl::desc("Target cpu"),
     llvm::cl::value_desc("Target a specific CPU type"),
     llvm::cl::cat(OnnxMlirOptions), llvm::cl::ValueRequired);
 
+llvm::cl::list<std::string> mcpuVariants("mcpu-variants",
+    llvm::cl::desc("Comma-separated list of additional target cpus, from the "
+                   "most preferred one. The model is also compiled for each "
+                   "of them into the same library, which runs the first "
+                   "variant supported by the host, or the code for --mcpu "
+                   "otherwise"),
+    llvm::cl::value_desc("Target cpus"), llvm::cl::CommaSeparated,
+    llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<std::string> march("march",
     llvm::cl::desc("Target architecture to generate code for"),
     llvm::cl::value_desc("Target a specific architecture type"),
@@ -126,6 +207,46 @@ llvm::cl::opt<std::string> mllvm("mllvm",
     llvm::cl::value_desc("A valid LLVM's 'opt' and 'llc' option"),
     llvm::cl::cat(OnnxMlirOptions), llvm::cl::Hidden, llvm::cl::ValueRequired);
 
+llvm::cl::opt<bool> inProcessCodegen("in-process-codegen",
+    llvm::cl::desc(
+        "Optimize the LLVM IR and generate the object file(s) within the "
+        "compiler instead of running 'opt' and 'llc' (default=false).\n"
+        "No bitcode file is written in between. Ignored when -Xopt, -Xllc, "
+        "-mllvm or PGO flags are given, as they are options of these tools."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> linkRuntimeBitcode("link-runtime-bitcode",
+    llvm::cl::desc(
+        "Link the bitcode of the stateless OMTensor and OMTensorList "
+        "functions of the runtime into the model before optimizing it, so "
+        "that the entry points can inline them (default=false).\n"
+        "Requires the libcruntime.bc built when the runtime is compiled by "
+        "clang for the target of the model."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> pgoInstrument("pgo-instrument",
+    llvm::cl::desc(
+        "Instrument the model for profile-guided optimization "
+        "(default=false).\n"
+        "Running the model writes a raw profile (default.profraw or the file "
+        "given by LLVM_PROFILE_FILE), to be merged by 'llvm-profdata merge' "
+        "and given to --pgo-use. Requires clang as the linker driver. "
+        "Ignored with --pgo-use."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> pgoUse("pgo-use",
+    llvm::cl::desc("Optimize the model with the given merged profile of a "
+                   "model compiled with --pgo-instrument."),
+    llvm::cl::value_desc("profdata file"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<unsigned> codegenPartitions("codegen-partitions",
+    llvm::cl::desc(
+        "Number of partitions of the LLVM module generated in parallel into "
+        "as many object files by --in-process-codegen, when building a "
+        "shared library or a jar (default=1)."),
+    llvm::cl::init(1), llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<OptLevel> OptimizationLevel(llvm::cl::desc("Levels:"),
     llvm::cl::values(clEnumVal(O0, "Optimization level 0 (default):"),
         clEnumVal(O1, "Optimization level 1,"),
@@ -178,6 +299,23 @@ llvm::cl::opt<bool> enableMemoryBundling("enable-memory-bundling",
         "Set to 'false' if you experience significant compile time."),
     llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<bool> enableDynamicMemoryArena("dynamic-memory-arena",
+    llvm::cl::desc(
+        "Allocate the internal buffers of dynamic shape from a memory arena "
+        "of the runtime (default=false)\n"
+        "Set to 'true' to avoid calls to malloc and free for these buffers "
+        "in steady state inferences."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> enableStaticMemoryArena("static-memory-arena",
+    llvm::cl::desc(
+        "Allocate the internal buffers of static shape, i.e. the memory pools "
+        "with --enable-memory-bundling, from the memory arena of the runtime "
+        "(default=false)\n"
+        "Set to 'true', with --dynamic-memory-arena, to make steady state "
+        "inferences free of calls to malloc and free for internal buffers."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<int> onnxOpTransformThreshold("onnx-op-transform-threshold",
     llvm::cl::desc(
         "Max iteration for dynamic op transform passes (default=3).\n"
@@ -198,18 +336,215 @@ llvm::cl::opt<bool> enableParallel("parallel",
                    "Set to 'true' if you want to enable parallelization."),
     llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<int64_t> parallelThreshold("parallel-threshold",
+    llvm::cl::desc(
+        "Minimum number of elements of the output of an elementwise op for it "
+        "to be parallelized when --parallel is set (default=65536).\n"
+        "Smaller ops are kept sequential as they do not amortize the cost of "
+        "forking and joining threads."),
+    llvm::cl::init(65536), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> enableTaskGraphs("task-graphs",
+    llvm::cl::desc(
+        "Run the independent ops of a model concurrently (default=false)\n"
+        "Set to 'true' to run the loop nests of ops that do not depend on each "
+        "other, e.g. those of parallel branches, as the tasks of a graph on "
+        "the thread pool of the runtime. Combined with --parallel, the "
+        "parallel loops of the tasks run on the threads left idle."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> enableFusion("fusion",
+    llvm::cl::desc(
+        "Enable fusion of chains of elementwise ops (default=false)\n"
+        "Set to 'true' to compute producer/consumer elementwise ops in a "
+        "single loop nest without intermediate buffers, and to fuse the "
+        "producer/consumer affine loop nests lowered from Krnl."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> enableStreamingLoops("streaming-loops",
+    llvm::cl::desc(
+        "Enable streaming lowering of Loop and Scan ops (default=false)\n"
+        "Set to 'true' to write the scan outputs of each iteration in place "
+        "into buffers of their final shape, and to allocate the buffers "
+        "of the loop bodies that do not depend on the iteration once."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<int64_t> convWinogradThreshold("conv-winograd-threshold",
+    llvm::cl::desc(
+        "Minimum number of input and output channels of a 3x3 convolution "
+        "of stride 1 for it to be lowered with Winograd at -O3 "
+        "(default=32)\n"
+        "Set to 0 to force Winograd for all such convolutions."),
+    llvm::cl::init(32), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> matmulTileDB("matmul-tile-db",
+    llvm::cl::desc(
+        "Tuning database of the register and cache tile sizes of the MatMul "
+        "and Gemm ops of given shapes and target cpus, as written by "
+        "utils/TuneMatMulTiles.py.\n"
+        "The tile sizes tuned for --mcpu are used at -O3 for the ops of the "
+        "tuned shapes, and the default ones for the others."),
+    llvm::cl::value_desc("file.json"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> blasLibrary("blas-library",
+    llvm::cl::desc(
+        "CBLAS library computing the large Gemm, MatMul and Conv ops of "
+        "float and double values (default: none)\n"
+        "The model is linked with -l<name>, e.g. openblas, blis or mkl_rt. "
+        "The ops tuned in --matmul-tile-db use the faster backend, and the "
+        "other ones the library from --blas-threshold flops."),
+    llvm::cl::value_desc("name"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<int64_t> blasThreshold("blas-threshold",
+    llvm::cl::desc(
+        "Minimum number of flops of the Gemm, MatMul and Conv ops of static "
+        "shapes computed by the library of --blas-library "
+        "(default=16777216)\n"
+        "The ops of dynamic shapes are computed by the library."),
+    llvm::cl::init(16777216), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<int64_t> sparseWeightThreshold("sparse-weight-threshold",
+    llvm::cl::desc(
+        "Minimum percentage of zero blocks of one vector of the constant "
+        "weights of the f32 MatMul and Gemm ops for them to be multiplied "
+        "in a block-sparse form at O3 (default=80)\n"
+        "Set to 0 to always multiply the weights in their dense form."),
+    llvm::cl::init(80), llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<bool> enableSimdDataLayout("simd-data-layout",
     llvm::cl::desc("Enable SIMD optimization for convolution (default=false)\n"
                    "Set to 'true' if you want to enable SIMD optimizations."),
     llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<std::string> halfPrecisionWeights("half-precision-weights",
+    llvm::cl::desc(
+        "Store the f32 constant weights of the MatMul ops in f16 or bf16 "
+        "(default: none)\n"
+        "The weights are widened to f32 when loaded by the CPU lowering, "
+        "halving their memory footprint and bandwidth."),
+    llvm::cl::value_desc("f16|bf16"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> quantizeWeights("quantize-weights",
+    llvm::cl::desc(
+        "Quantize the f32 constant weights of the MatMul ops to int8, with "
+        "a symmetric scale per column (default: none)\n"
+        "The weights are dequantized when loaded by the CPU lowering, "
+        "dividing their memory footprint and bandwidth by 4. Ignored with "
+        "--half-precision-weights."),
+    llvm::cl::value_desc("int8"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<int> pipelineStages("pipeline-stages",
+    llvm::cl::desc(
+        "Split the model into pipeline stages of balanced cost (default=1)\n"
+        "Each stage is compiled into an entry point run_<func>_stage<k>, "
+        "whose outputs are the inputs of the next stage, so that "
+        "ExecutionPipeline runs the stages on different sockets, each on a "
+        "micro-batch while the next one runs the previous micro-batch. The "
+        "model has no run_<func> entry point then, and is loaded with "
+        "defaultEntryPoint=false."),
+    llvm::cl::init(1), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> outlineRepeatedLayers("outline-repeated-layers",
+    llvm::cl::desc(
+        "Outline the repeated layers of the model, such as the layers of a "
+        "transformer, into a function called by each layer "
+        "(default=false)\n"
+        "The layer is lowered and compiled once, reducing the compile time "
+        "and code size of deep models, but its weights are passed as "
+        "arguments instead of being constants of its ops."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> memoizeSubgraphs("memoize-subgraphs",
+    llvm::cl::desc(
+        "Cache the values only depending on the shapes of the inputs and on "
+        "the inputs of --memoize-inputs across the calls of the model "
+        "(default=false)\n"
+        "Their computation, such as positional encoding tables or attention "
+        "masks, is skipped by the calls whose shapes and inputs were seen by "
+        "one of the last 8 calls computing them."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> memoizeInputs("memoize-inputs",
+    llvm::cl::desc(
+        "Indices of the slowly changing inputs of the model, separated by "
+        "\",\", whose values are cached with --memoize-subgraphs "
+        "(default: none)"),
+    llvm::cl::value_desc("INPUT_ID1,INPUT_ID2,..."), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<bool> verifyInputTensors("verifyInputTensors",
     llvm::cl::desc(
         "Verify input tensors whenever the entry point function is called.\n"
-        "Data type and shape are verified. Enable this may introduce overhead "
-        "at runtime."),
+        "Data type and shape are verified at once against a signature packed "
+        "at compile time, the checks printing the mismatch only running when "
+        "the inputs do not match it."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> storeConstantsToFile("store-constants-to-file",
+    llvm::cl::desc(
+        "Store large constants into <output-files-base-path>.constants.bin "
+        "instead of embedding them into the model (default=false).\n"
+        "The file must be kept alongside the model library, which maps it "
+        "read-only into memory at the first inference, so that processes "
+        "running the same model share its pages."),
+    llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<int64_t> constantsToFileThreshold("constants-to-file-threshold",
+    llvm::cl::desc("Minimum size in bytes of the constants stored into a file "
+                   "when --store-constants-to-file is set (default=1024)."),
+    llvm::cl::init(1024), llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> sharedConstantsFile("shared-constants-file",
+    llvm::cl::desc(
+        "File of the large constants shared by several models, e.g. by the "
+        "fine-tuned variants of a base model, with --store-constants-to-file "
+        "(default: none).\n"
+        "The constants found in the file, identified by the SHA-256 of their "
+        "data in <file>.index, are read from it instead of the constants file "
+        "of the model. If the file does not exist, it is written with the "
+        "constants of the model, e.g. when compiling the base model, and "
+        "never written again. It must be kept alongside the model libraries, "
+        "which map it read-only into memory, so that they share its pages."),
+    llvm::cl::value_desc("file"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<std::string> compressConstants("compress-constants",
+    llvm::cl::desc(
+        "Compress the file of --store-constants-to-file: \"lz4\" or "
+        "\"lz4-shuffle\", which also shuffles the bytes of the float "
+        "constants for them to compress better (default: no compression).\n"
+        "The constants are decompressed in parallel into memory at the first "
+        "inference, or at the warmup of an ExecutionSession running the model, "
+        "instead of being mapped from the file."),
+    llvm::cl::value_desc("lz4|lz4-shuffle"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
+llvm::cl::opt<bool> constantsToObject("constants-to-object",
+    llvm::cl::desc(
+        "Emit the data of the large constants, of at least "
+        "--constants-to-file-threshold bytes, into an object file of its own "
+        "linked into the model library, instead of LLVM IR constant arrays "
+        "(default=false).\n"
+        "The data is assembled from a raw file, without going through the "
+        "bitcode, 'opt' and 'llc', which cuts the compile time and memory of "
+        "models with large weights. Only for --EmitLib and --EmitJNI on ELF "
+        "and Mach-O targets, and ignored with --store-constants-to-file."),
     llvm::cl::init(false), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<std::string> compileCacheDir("compile-cache-dir",
+    llvm::cl::desc(
+        "Directory of the cache of the compiled models (default: the "
+        "ONNX_MLIR_COMPILE_CACHE_DIR environment variable, if set).\n"
+        "An object file, shared library or jar compiled before from the same "
+        "model with the same options, target and compiler version is copied "
+        "from the cache instead of being compiled again."),
+    llvm::cl::value_desc("path"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
 llvm::cl::opt<bool> allowSorting("allowSorting",
     llvm::cl::desc("Perform topological sort on onnx graph"),
     llvm::cl::init(true), llvm::cl::cat(OnnxMlirOptions));
@@ -226,6 +561,13 @@ llvm::cl::opt<std::string> reportHeapAfter("report-heap-after",
                    "<output-files-base-path>.heap.log"),
     llvm::cl::init(""), llvm::cl::cat(OnnxMlirOptions));
 
+llvm::cl::opt<std::string> compileProfile("compile-profile",
+    llvm::cl::desc("Record the wall time, the peak resident set size and the "
+                   "op counts before and after each pass, and the time spent "
+                   "in opt, llc and the linker, in JSON to the given file."),
+    llvm::cl::value_desc("file.json"), llvm::cl::init(""),
+    llvm::cl::cat(OnnxMlirOptions));
+
 // Configuration states associated with certain options.
 // For example, when maccel is specified, NNPA can register
 // dependent libdnn.
@@ -437,6 +779,15 @@ std::vector<std::string> getXllcOption() {
   return flags;
 }
 
+// Support for PGO.
+std::vector<std::string> getPGOOption() {
+  if (!pgoUse.empty())
+    return {"-pgo-kind=pgo-instr-use-pipeline", "-profile-file=" + pgoUse};
+  if (pgoInstrument)
+    return {"-pgo-kind=pgo-instr-gen-pipeline"};
+  return std::vector<std::string>();
+}
+
 // Support for LLVM.
 void setLLVMOption(const std::string &flag) { mllvm = flag; }
 void clearLLVMOption() { mllvm.clear(); }
@@ -48,31 +48,67 @@ extern llvm::cl::opt<bool> preserveMLIR;
 extern llvm::cl::opt<bool> useOnnxModelTypes;
 extern llvm::cl::opt<int> repeatOnnxTransform;
 extern llvm::cl::opt<std::string> shapeInformation;
+extern llvm::cl::opt<std::string> shapeBuckets;
+extern llvm::cl::opt<std::string> outputSubsets;
+extern llvm::cl::opt<std::string> extractNodes;
+extern llvm::cl::opt<std::string> uint8NHWCInputs;
+extern llvm::cl::opt<std::string> packedSequenceOffsets;
+extern llvm::cl::opt<bool> pagedKVCache;
 extern llvm::cl::opt<onnx_mlir::OptLevel> OptimizationLevel;
 extern llvm::cl::opt<std::string> customEnvFlags;
 extern llvm::cl::opt<std::string> mtriple;
 extern llvm::cl::opt<std::string> mcpu;
+extern llvm::cl::list<std::string> mcpuVariants;
 extern llvm::cl::opt<std::string> march;
 extern llvm::cl::list<onnx_mlir::accel::Accelerator::Kind> maccel;
 extern llvm::cl::opt<bool> VerboseOutput;
 extern llvm::cl::list<std::string> Xopt;
 extern llvm::cl::list<std::string> Xllc;
 extern llvm::cl::opt<std::string> mllvm;
+extern llvm::cl::opt<bool> inProcessCodegen;
+extern llvm::cl::opt<bool> linkRuntimeBitcode;
+extern llvm::cl::opt<bool> pgoInstrument;
+extern llvm::cl::opt<std::string> pgoUse;
+extern llvm::cl::opt<unsigned> codegenPartitions;
 extern llvm::cl::opt<bool> verifyInputTensors;
+extern llvm::cl::opt<bool> storeConstantsToFile;
+extern llvm::cl::opt<std::string> compileCacheDir;
+extern llvm::cl::opt<int64_t> constantsToFileThreshold;
+extern llvm::cl::opt<std::string> sharedConstantsFile;
+extern llvm::cl::opt<std::string> compressConstants;
+extern llvm::cl::opt<bool> constantsToObject;
 extern llvm::cl::opt<bool> allowSorting;
 extern llvm::cl::opt<std::string> reportHeapBefore;
 extern llvm::cl::opt<std::string> reportHeapAfter;
+extern llvm::cl::opt<std::string> compileProfile;
 extern llvm::cl::opt<InstrumentStages> instrumentStage;
 extern llvm::cl::opt<std::string> instrumentOps;
 extern llvm::cl::bits<InstrumentActions> instrumentControlBits;
 extern llvm::cl::opt<bool> instrumentONNXSignature;
 extern llvm::cl::opt<std::string> ONNXOpStats;
 extern llvm::cl::opt<bool> enableMemoryBundling;
+extern llvm::cl::opt<bool> enableDynamicMemoryArena;
+extern llvm::cl::opt<bool> enableStaticMemoryArena;
 extern llvm::cl::opt<int> onnxOpTransformThreshold;
 extern llvm::cl::opt<bool> onnxOpTransformReport;
 extern llvm::cl::opt<bool> onnxConstPropReport;
 extern llvm::cl::opt<bool> enableParallel;
+extern llvm::cl::opt<int64_t> parallelThreshold;
+extern llvm::cl::opt<bool> enableTaskGraphs;
+extern llvm::cl::opt<bool> enableFusion;
+extern llvm::cl::opt<bool> enableStreamingLoops;
+extern llvm::cl::opt<int64_t> convWinogradThreshold;
+extern llvm::cl::opt<std::string> matmulTileDB;
+extern llvm::cl::opt<std::string> blasLibrary;
+extern llvm::cl::opt<int64_t> blasThreshold;
+extern llvm::cl::opt<int64_t> sparseWeightThreshold;
 extern llvm::cl::opt<bool> enableSimdDataLayout;
+extern llvm::cl::opt<std::string> halfPrecisionWeights;
+extern llvm::cl::opt<std::string> quantizeWeights;
+extern llvm::cl::opt<int> pipelineStages;
+extern llvm::cl::opt<bool> outlineRepeatedLayers;
+extern llvm::cl::opt<bool> memoizeSubgraphs;
+extern llvm::cl::opt<std::string> memoizeInputs;
 
 // The customEnvFlags must be scanned before the normal options.
 bool parseCustomEnvFlagsCommandLineOption(int argc, const char *const *argv,
@@ -115,6 +151,9 @@ void setLLVMOption(const std::string &flag);
 void clearLLVMOption();
 std::string getLLVMOption();
 
+// Flags of 'opt' instrumenting the model or using a profile of it.
+std::vector<std::string> getPGOOption();
+
 // Options support for OMCompilerOptions.
 using CompilerOptionList =
     llvm::SmallVector<std::pair<onnx_mlir::OptionKind, std::string>, 4>;
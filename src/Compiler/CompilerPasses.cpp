@@ -22,6 +22,7 @@
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
 #include "mlir/Conversion/VectorToLLVM/ConvertVectorToLLVM.h"
 #include "mlir/Conversion/VectorToSCF/VectorToSCF.h"
+#include "mlir/Dialect/Affine/Passes.h"
 #include "mlir/Dialect/Bufferization/Transforms/Passes.h"
 #include "mlir/Dialect/MemRef/Transforms/Passes.h"
 #include "mlir/Pass/Pass.h"
@@ -56,15 +57,57 @@ void addONNXToMLIRPasses(mlir::PassManager &pm, bool targetCPU) {
   pm.addInstrumentation(
       std::make_unique<DisposableGarbageCollector>(pm.getContext()));
 
+  // Take the image inputs as uint8 NHWC tensors first, so that the clones
+  // below take them as well.
+  if (!uint8NHWCInputs.empty())
+    pm.addPass(onnx_mlir::createUint8NHWCInputsPass(uint8NHWCInputs));
+  // Clone the entry point functions for each subset of outputs and each group
+  // of extracted nodes first, so that the clones are optimized, and
+  // specialized for shapes, as the functions.
+  if (!outputSubsets.empty() || !extractNodes.empty())
+    pm.addPass(
+        onnx_mlir::createOutputSubsetsPass(outputSubsets, extractNodes));
+  // Clone the entry point functions for each bucket of shapes before any
+  // shape inference, so that the clones are optimized for their shapes.
+  if (!shapeBuckets.empty())
+    pm.addPass(onnx_mlir::createShapeSpecializationPass(shapeBuckets));
+  // The shape inference passes only infer the ops changed since the previous
+  // ones.
+  std::shared_ptr<ShapeInferenceCache> shapeInferenceCache =
+      onnx_mlir::createShapeInferenceCache();
   pm.addNestedPass<func::FuncOp>(onnx_mlir::createDecomposeONNXToONNXPass());
-  pm.addPass(onnx_mlir::createShapeInferencePass());
+  pm.addPass(onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
   pm.addPass(mlir::createCanonicalizerPass());
-  pm.addPass(onnx_mlir::createShapeInferencePass());
+  pm.addPass(onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
+  // Move the transposes so that they cancel out, the transposes of constants
+  // being folded by the following constant propagation.
+  pm.addNestedPass<func::FuncOp>(
+      onnx_mlir::createSinkTransposeONNXToONNXPass());
   // Convolution Optimization for CPU: enable when there are no accelerators.
   if (targetCPU) {
     pm.addNestedPass<func::FuncOp>(
         onnx_mlir::createConvOptONNXToONNXPass(enableSimdDataLayout));
-    pm.addPass(onnx_mlir::createShapeInferencePass());
+    pm.addPass(onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
+    // Keep the tensors in the SIMD data layout between the convolutions.
+    if (enableSimdDataLayout)
+      pm.addNestedPass<func::FuncOp>(
+          onnx_mlir::createPropagateSimdDataLayoutONNXToONNXPass());
+    // Attention fusion, lowered to a kernel for CPU only.
+    pm.addNestedPass<func::FuncOp>(
+        onnx_mlir::createFuseAttentionONNXToONNXPass());
+    // Packed sequences, supported by the fused attentions.
+    if (!packedSequenceOffsets.empty())
+      pm.addPass(onnx_mlir::createPackedSequencesPass(packedSequenceOffsets));
+    // Paged key/value caches, read by the fused attentions.
+    if (pagedKVCache)
+      pm.addPass(onnx_mlir::createPagedKVCachePass());
+    // Activations fused into the convolutions, lowered for CPU only.
+    pm.addNestedPass<func::FuncOp>(
+        onnx_mlir::createFuseConvActivationONNXToONNXPass());
+    // Broadcasts materialized by Expand and Tile folded into the elementwise
+    // ops, whose CPU lowering supports all broadcasts.
+    pm.addNestedPass<func::FuncOp>(
+        onnx_mlir::createFoldBroadcastONNXToONNXPass());
   }
   // There are more opportunities for const propagation once all tensors have
   // inferred shapes.
@@ -79,7 +122,8 @@ void addONNXToMLIRPasses(mlir::PassManager &pm, bool targetCPU) {
     // Statically add extra passes
     for (int i = 0; i < repeatOnnxTransform; i++) {
       pm.addPass(mlir::createCanonicalizerPass());
-      pm.addPass(onnx_mlir::createShapeInferencePass());
+      pm.addPass(
+          onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
       pm.addNestedPass<func::FuncOp>(
           onnx_mlir::createConstPropONNXToONNXPass(onnxConstPropReport));
     }
@@ -88,6 +132,35 @@ void addONNXToMLIRPasses(mlir::PassManager &pm, bool targetCPU) {
   // Simplify shape-related ops.
   pm.addPass(onnx_mlir::createSimplifyShapeRelatedOpsPass(onnxConstPropReport));
 
+  // Compute the values only used by one branch of an If in that branch, once
+  // no more canonicalization moves them.
+  pm.addNestedPass<func::FuncOp>(
+      onnx_mlir::createSinkIntoIfBranchesONNXToONNXPass());
+
+  // Store the weights of the MatMul ops in half precision, or quantize them to
+  // int8, once no more constant propagation folds their Casts back to f32.
+  if (targetCPU && !halfPrecisionWeights.empty())
+    pm.addNestedPass<func::FuncOp>(
+        onnx_mlir::createHalfPrecisionWeightsPass(halfPrecisionWeights));
+  else if (targetCPU && !quantizeWeights.empty())
+    pm.addNestedPass<func::FuncOp>(
+        onnx_mlir::createQuantizeWeightsPass(quantizeWeights));
+
+  // Cache the values only depending on the shapes of the inputs and on the
+  // slowly changing inputs, once the ops and their shapes are final.
+  if (targetCPU && memoizeSubgraphs)
+    pm.addPass(onnx_mlir::createMemoizeSubgraphsPass(memoizeInputs));
+
+  // Split the entry point functions into pipeline stages, once the ops and
+  // their shapes are final so that the stages are balanced.
+  if (pipelineStages > 1)
+    pm.addPass(onnx_mlir::createSplitPipelineStagesPass(pipelineStages));
+
+  // Outline the repeated layers of the functions, once split, so that each
+  // layer is lowered once.
+  if (outlineRepeatedLayers)
+    pm.addPass(onnx_mlir::createOutlineRepeatedLayersPass());
+
   // Clean dead code.
   pm.addPass(mlir::createSymbolDCEPass());
 
@@ -129,7 +202,23 @@ void addONNXToKrnlPasses(mlir::PassManager &pm, int optLevel, bool enableCSE,
   if (enableInstrumentONNXSignature)
     pm.addNestedPass<func::FuncOp>(
         onnx_mlir::createInstrumentONNXSignaturePass());
-  pm.addPass(onnx_mlir::createLowerToKrnlPass(optLevel, enableParallel));
+  pm.addPass(onnx_mlir::createLowerToKrnlPass(
+      optLevel, enableParallel, parallelThreshold, enableFusion,
+      enableStreamingLoops, convWinogradThreshold,
+      /*enableDimAnalysis=*/optLevel >= 3, matmulTileDB, mcpu,
+      /*enableBLAS=*/!blasLibrary.empty(), blasThreshold,
+      sparseWeightThreshold));
+  // Dispatch the entry point functions to their specializations for static
+  // shapes, now that their inputs are memrefs that can be cast.
+  if (!shapeBuckets.empty())
+    pm.addPass(onnx_mlir::krnl::createShapeDispatchPass());
+  // Pass the results of the outlined layers as output arguments, so that
+  // their buffers are deallocated by the callers.
+  if (outlineRepeatedLayers)
+    pm.addPass(onnx_mlir::krnl::createOutlinedLayerOutParamsPass());
+  // Compute the results of the entry points in output arguments, for the
+  // entry points writing into output tensors preallocated by the callers.
+  pm.addPass(onnx_mlir::krnl::createEntryPointOutParamsPass());
   // An additional pass of canonicalization is helpful because lowering
   // from ONNX dialect to Standard dialect exposes additional canonicalization
   // opportunities.
@@ -142,6 +231,19 @@ void addONNXToKrnlPasses(mlir::PassManager &pm, int optLevel, bool enableCSE,
 void addKrnlToAffinePasses(mlir::PassManager &pm) {
   pm.addNestedPass<func::FuncOp>(
       onnx_mlir::krnl::createConvertKrnlToAffinePass());
+  // Fuse the adjacent loop nests whose consumer reads what the producer
+  // wrote, shrinking the intermediate buffers to what a fused iteration
+  // needs. Running before the buffer deallocation and the memory pools, the
+  // eliminated buffers are never bundled into the pools. The nests reading a
+  // buffer through a view, such as the memref.reinterpret_cast of a Reshape,
+  // are not fused with its producer, as the dependences are tracked by memref
+  // values.
+  if (enableFusion) {
+    pm.addNestedPass<func::FuncOp>(mlir::createLoopFusionPass(
+        /*fastMemorySpace=*/0, /*localBufSizeThreshold=*/0,
+        /*maximalFusion=*/false, mlir::FusionMode::ProducerConsumer));
+    pm.addPass(mlir::createCanonicalizerPass());
+  }
 }
 
 void addKrnlToLLVMPasses(
@@ -156,6 +258,17 @@ void addKrnlToLLVMPasses(
   // After affine is lowered, KrnlRegion for affine scope can be removed.
   pm.addNestedPass<func::FuncOp>(krnl::createLowerKrnlRegionPass());
 
+  // Run the loop nests independent of each other as the tasks of graphs on
+  // the thread pool of the runtime, before the parallel loops of the tasks
+  // are outlined.
+  if (enableTaskGraphs)
+    pm.addPass(krnl::createOutlineTaskGraphsPass());
+
+  // Run the parallel loops on the thread pool of the runtime. Outlining must
+  // happen before buffers are hoisted out of the loops and shared by threads.
+  if (enableParallel)
+    pm.addPass(krnl::createOutlineParallelLoopsPass());
+
   // Hoist allocations out of loop nests to avoid stack overflow.
   pm.addPass(bufferization::createBufferLoopHoistingPass());
 
@@ -169,8 +282,14 @@ void addKrnlToLLVMPasses(
     pm.addNestedPass<func::FuncOp>(krnl::createKrnlEnableMemoryPoolPass());
     pm.addNestedPass<func::FuncOp>(krnl::createKrnlBundleMemoryPoolsPass());
     pm.addPass(mlir::createCanonicalizerPass());
-    pm.addNestedPass<func::FuncOp>(krnl::createKrnlOptimizeMemoryPoolsPass());
+    pm.addNestedPass<func::FuncOp>(
+        krnl::createKrnlOptimizeMemoryPoolsPass(/*planOffsets=*/true));
   }
+  // Allocate the remaining buffers of dynamic shape, and the memory pools of
+  // static shape, from the runtime arena, once their deallocations are known.
+  if (enableDynamicMemoryArena || enableStaticMemoryArena)
+    pm.addPass(krnl::createKrnlEnableDynamicMemoryArenaPass(
+        enableDynamicMemoryArena, enableStaticMemoryArena));
 
   // The pass below is needed for subview and collapseShape.. Unfortunately,
   // MLIR supports only collapse for scalar loaded by scalar memory at this
@@ -179,7 +298,10 @@ void addKrnlToLLVMPasses(
   pm.addNestedPass<func::FuncOp>(mlir::createConvertSCFToCFPass());
 
   pm.addPass(mlir::memref::createFoldMemRefAliasOpsPass());
-  pm.addPass(krnl::createConvertKrnlToLLVMPass(verifyInputTensors));
+  // Share the data of identical constants in the generated code.
+  pm.addPass(krnl::createDedupKrnlGlobalConstantsPass());
+  pm.addPass(krnl::createConvertKrnlToLLVMPass(
+      verifyInputTensors, constantsToFileThreshold));
   pm.addPass(mlir::createReconcileUnrealizedCastsPass());
   pm.addPass(mlir::createCanonicalizerPass());
 }
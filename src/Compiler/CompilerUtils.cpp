@@ -15,27 +15,45 @@
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Export.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 
 #include "ExternalUtil.hpp"
 
 #include "src/Accelerators/Accelerator.hpp"
 #include "src/Compiler/CompilerOptions.hpp"
 #include "src/Compiler/CompilerPasses.hpp"
+#include "src/Compiler/CompileProfiler.hpp"
 #include "src/Compiler/CompilerUtils.hpp"
 #include "src/Compiler/HeapReporter.hpp"
+#include "src/Conversion/KrnlToLLVM/ConvertKrnlToLLVM.hpp"
+#include "src/Dialect/Mlir/VectorMachineSupport.hpp"
 #include "src/Dialect/ONNX/ONNXDialect.hpp"
 #include "src/Version/Version.hpp"
 
+#include <chrono>
+#include <mutex>
 #include <regex>
 
 #define DEBUG_TYPE "compiler_utils"
@@ -224,9 +242,16 @@ int Command::exec(std::string wdir) const {
                  << ": " << llvm::join(argsRef, " ") << "\n";
 
   std::string errMsg;
+  std::optional<llvm::sys::ProcessStatistics> procStat;
+  auto start = std::chrono::steady_clock::now();
   int rc = llvm::sys::ExecuteAndWait(_path, llvm::ArrayRef(argsRef),
       /*Env=*/std::nullopt, /*Redirects=*/std::nullopt,
-      /*SecondsToWait=*/0, /*MemoryLimit=*/0, &errMsg);
+      /*SecondsToWait=*/0, /*MemoryLimit=*/0, &errMsg,
+      /*ExecutionFailed=*/nullptr, &procStat);
+  CompileProfiler::recordPhase(_args.front(),
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count(),
+      procStat ? (int64_t)procStat->PeakMemory : -1);
 
   if (rc != 0) {
     llvm::errs() << llvm::join(argsRef, " ") << "\n"
@@ -271,6 +296,196 @@ static void loadMLIR(std::string inputFilename, mlir::MLIRContext &context,
   }
 }
 
+// Return the names of the entry point functions of the model, including the
+// ones writing into preallocated output tensors.
+static SmallVector<std::string, 4> getEntryPointFuncNames(
+    llvm::Module &llvmModule) {
+  SmallVector<std::string, 4> funcNames;
+  llvm::GlobalVariable *GV =
+      llvmModule.getNamedGlobal(StringRef("_entry_point_arrays"));
+  if (!GV || !GV->isConstant() || !GV->hasDefinitiveInitializer())
+    return funcNames;
+  llvm::Constant *initializer = GV->getInitializer();
+  llvm::ArrayType *AT = dyn_cast<llvm::ArrayType>(initializer->getType());
+  for (uint64_t i = 0; i < AT->getNumElements() - 1; ++i) {
+    llvm::GlobalVariable *entryGV = llvmModule.getNamedGlobal(
+        StringRef("_entry_point_" + std::to_string(i)));
+    if (entryGV->isConstant()) {
+      llvm::ConstantDataSequential *entry =
+          dyn_cast<llvm::ConstantDataSequential>(entryGV->getInitializer());
+      funcNames.emplace_back(entry->getAsCString().str());
+      // Entry point writing into preallocated output tensors.
+      funcNames.emplace_back(entry->getAsCString().str() + "_into");
+    }
+  }
+  return funcNames;
+}
+
+// Return the comma separated list of the features of a target cpu that the
+// target cpu of the compilation does not have, or None if the cpu is unknown.
+static llvm::Optional<std::string> getCPUVariantFeatures(
+    const llvm::Target *target, const std::string &targetTriple,
+    const std::string &cpu) {
+  std::unique_ptr<llvm::MCSubtargetInfo> variantInfo(
+      target->createMCSubtargetInfo(targetTriple, cpu, ""));
+  std::unique_ptr<llvm::MCSubtargetInfo> baseInfo(
+      target->createMCSubtargetInfo(targetTriple, mcpu.getValue(), ""));
+  if (!variantInfo || !baseInfo || !variantInfo->isCPUStringValid(cpu))
+    return llvm::None;
+  std::string features;
+  for (const llvm::SubtargetFeatureKV &feature :
+      variantInfo->getAllProcessorFeatures()) {
+    if (!variantInfo->getFeatureBits()[feature.Value] ||
+        baseInfo->getFeatureBits()[feature.Value])
+      continue;
+    if (!features.empty())
+      features += ",";
+    features += feature.Key;
+  }
+  return features;
+}
+
+// Clone the functions of the model for each target cpu of --mcpu-variants,
+// and turn the entry points into dispatchers to the clones of the first
+// variant supported by the host, selected once when the model library is
+// loaded. The host is checked by the runtime function OMHostCPUSupports, which
+// takes the features of the variant missing from the target cpu of the
+// compilation. The constants are shared by all the variants.
+static void addCPUVariants(llvm::Module &llvmModule) {
+  llvm::LLVMContext &ctx = llvmModule.getContext();
+  std::string error;
+  const std::string targetTriple =
+      (mtriple != "") ? mtriple.getValue() : kDefaultTriple;
+  const llvm::Target *target =
+      llvm::TargetRegistry::lookupTarget(targetTriple, error);
+  if (!target) {
+    llvm::errs() << "Ignoring --mcpu-variants: " << error << "\n";
+    return;
+  }
+
+  SmallVector<llvm::Function *, 8> funcs;
+  for (llvm::Function &func : llvmModule)
+    if (!func.isDeclaration())
+      funcs.emplace_back(&func);
+
+  // Clone the functions for each variant, calls being redirected to the
+  // clones of the same variant.
+  SmallVector<std::string, 4> variantFeatures;
+  SmallVector<llvm::ValueToValueMapTy *, 4> variantMaps;
+  SmallVector<std::unique_ptr<llvm::ValueToValueMapTy>, 4> maps;
+  for (const std::string &cpu : mcpuVariants) {
+    llvm::Optional<std::string> features =
+        getCPUVariantFeatures(target, targetTriple, cpu);
+    if (!features) {
+      llvm::errs() << "Ignoring unknown cpu " << cpu << " of --mcpu-variants\n";
+      continue;
+    }
+    std::string suffix = cpu;
+    for (char &c : suffix)
+      if (!llvm::isAlnum(c))
+        c = '_';
+    maps.emplace_back(std::make_unique<llvm::ValueToValueMapTy>());
+    llvm::ValueToValueMapTy &vmap = *maps.back();
+    for (llvm::Function *func : funcs) {
+      llvm::Function *clone = llvm::Function::Create(func->getFunctionType(),
+          llvm::GlobalValue::InternalLinkage, func->getName() + "." + suffix,
+          llvmModule);
+      vmap[func] = clone;
+      llvm::Function::arg_iterator cloneArg = clone->arg_begin();
+      for (llvm::Argument &arg : func->args())
+        vmap[&arg] = &*cloneArg++;
+    }
+    for (llvm::Function *func : funcs) {
+      llvm::Function *clone = llvm::cast<llvm::Function>(vmap[func]);
+      SmallVector<llvm::ReturnInst *, 4> returns;
+      llvm::CloneFunctionInto(clone, func, vmap,
+          llvm::CloneFunctionChangeType::LocalChangesOnly, returns);
+      clone->setLinkage(llvm::GlobalValue::InternalLinkage);
+      clone->setDLLStorageClass(llvm::GlobalValue::DefaultStorageClass);
+      clone->setComdat(nullptr);
+      clone->addFnAttr("target-cpu", cpu);
+      clone->removeFnAttr("target-features");
+      clone->removeFnAttr("tune-cpu");
+    }
+    variantFeatures.emplace_back(*features);
+    variantMaps.emplace_back(&vmap);
+  }
+  if (variantMaps.empty())
+    return;
+
+  // Select the variant once, when the library is loaded. 0 is the target cpu
+  // of the compilation, i + 1 the i-th variant.
+  llvm::IRBuilder<> builder(ctx);
+  llvm::Type *i32Ty = builder.getInt32Ty();
+  llvm::GlobalVariable *selectedVariant = new llvm::GlobalVariable(llvmModule,
+      i32Ty, /*isConstant=*/false, llvm::GlobalValue::InternalLinkage,
+      builder.getInt32(0), "_cpu_variant");
+  llvm::FunctionCallee supportsFunc = llvmModule.getOrInsertFunction(
+      "OMHostCPUSupports", builder.getInt64Ty(), builder.getInt8PtrTy());
+  llvm::Function *selectFunc = llvm::Function::Create(
+      llvm::FunctionType::get(builder.getVoidTy(), false),
+      llvm::GlobalValue::InternalLinkage, "_select_cpu_variant", llvmModule);
+  llvm::BasicBlock *block = llvm::BasicBlock::Create(ctx, "", selectFunc);
+  for (size_t i = 0; i < variantFeatures.size(); ++i) {
+    builder.SetInsertPoint(block);
+    llvm::Value *features =
+        builder.CreateGlobalStringPtr(variantFeatures[i], "_cpu_features");
+    llvm::Value *supported = builder.CreateICmpNE(
+        builder.CreateCall(supportsFunc, {features}), builder.getInt64(0));
+    llvm::BasicBlock *thenBlock = llvm::BasicBlock::Create(ctx, "", selectFunc);
+    block = llvm::BasicBlock::Create(ctx, "", selectFunc);
+    builder.CreateCondBr(supported, thenBlock, block);
+    builder.SetInsertPoint(thenBlock);
+    builder.CreateStore(builder.getInt32(i + 1), selectedVariant);
+    builder.CreateRetVoid();
+  }
+  builder.SetInsertPoint(block);
+  builder.CreateRetVoid();
+  llvm::appendToGlobalCtors(llvmModule, selectFunc, /*Priority=*/65535);
+
+  // Turn the entry points into dispatchers to the selected variant.
+  for (const std::string &funcName : getEntryPointFuncNames(llvmModule)) {
+    llvm::Function *func = llvmModule.getFunction(funcName);
+    if (!func || func->isDeclaration())
+      continue;
+    llvm::Function *dispatcher = llvm::Function::Create(
+        func->getFunctionType(), func->getLinkage(), "", llvmModule);
+    dispatcher->takeName(func);
+    dispatcher->copyAttributesFrom(func);
+    func->setName(funcName + ".base");
+    func->setLinkage(llvm::GlobalValue::InternalLinkage);
+    func->setDLLStorageClass(llvm::GlobalValue::DefaultStorageClass);
+
+    SmallVector<llvm::Value *, 4> args;
+    for (llvm::Argument &arg : dispatcher->args())
+      args.emplace_back(&arg);
+    auto emitCall = [&](llvm::Function *callee) {
+      llvm::CallInst *call = builder.CreateCall(callee, args);
+      call->setTailCall();
+      if (callee->getReturnType()->isVoidTy())
+        builder.CreateRetVoid();
+      else
+        builder.CreateRet(call);
+    };
+    llvm::BasicBlock *entryBlock =
+        llvm::BasicBlock::Create(ctx, "", dispatcher);
+    llvm::BasicBlock *baseBlock = llvm::BasicBlock::Create(ctx, "", dispatcher);
+    builder.SetInsertPoint(entryBlock);
+    llvm::SwitchInst *switchInst = builder.CreateSwitch(
+        builder.CreateLoad(i32Ty, selectedVariant), baseBlock,
+        variantMaps.size());
+    builder.SetInsertPoint(baseBlock);
+    emitCall(func);
+    for (size_t i = 0; i < variantMaps.size(); ++i) {
+      llvm::BasicBlock *variantBlock =
+          llvm::BasicBlock::Create(ctx, "", dispatcher);
+      switchInst->addCase(builder.getInt32(i + 1), variantBlock);
+      builder.SetInsertPoint(variantBlock);
+      emitCall(llvm::cast<llvm::Function>((*variantMaps[i])[func]));
+    }
+  }
+}
+
 // Tailor LLVMIR to add features that cannot be done with MLIR LLVMIR.
 static void tailorLLVMIR(llvm::Module &llvmModule) {
   llvm::LLVMContext &ctx = llvmModule.getContext();
@@ -312,34 +527,141 @@ static void tailorLLVMIR(llvm::Module &llvmModule) {
 
   // Annotate functions to be accessible from DLL on Windows.
 #ifdef _WIN32
-  SmallVector<StringRef, 4> exportedFuncs;
+  SmallVector<std::string, 4> exportedFuncs;
   // Signature functions.
-  exportedFuncs.emplace_back(StringRef("omInputSignature"));
-  exportedFuncs.emplace_back(StringRef("omOutputSignature"));
-  exportedFuncs.emplace_back(StringRef("omQueryEntryPoints"));
+  exportedFuncs.emplace_back("omInputSignature");
+  exportedFuncs.emplace_back("omOutputSignature");
+  exportedFuncs.emplace_back("omQueryEntryPoints");
   // Entry point funtions.
-  if (llvm::GlobalVariable *GV =
-          llvmModule.getNamedGlobal(StringRef("_entry_point_arrays"))) {
-    if (GV->isConstant() && GV->hasDefinitiveInitializer()) {
-      llvm::Constant *initializer = GV->getInitializer();
-      llvm::ArrayType *AT = dyn_cast<llvm::ArrayType>(initializer->getType());
-      for (uint64_t i = 0; i < AT->getNumElements() - 1; ++i) {
-        llvm::GlobalVariable *entryGV = llvmModule.getNamedGlobal(
-            StringRef("_entry_point_" + std::to_string(i)));
-        if (entryGV->isConstant()) {
-          llvm::ConstantDataSequential *entry =
-              dyn_cast<llvm::ConstantDataSequential>(entryGV->getInitializer());
-          exportedFuncs.emplace_back(entry->getAsCString());
-        }
-      }
-    }
-  }
-  for (StringRef funcName : exportedFuncs)
+  exportedFuncs.append(getEntryPointFuncNames(llvmModule));
+  for (const std::string &funcName : exportedFuncs)
     if (llvm::GlobalValue *GV = llvmModule.getNamedValue(funcName)) {
       GV->setDSOLocal(true);
       GV->setDLLStorageClass(llvm::GlobalValue::DLLExportStorageClass);
     }
 #endif
+
+  // Compile the functions of the model for the additional target cpus too.
+  if (!mcpuVariants.empty())
+    addCPUVariants(llvmModule);
+}
+
+// Return true if the function reads or writes state of the runtime that the
+// bitcode holds in its own variables, such as the per-thread caches of
+// OMTensor.inc, directly or through the functions it calls. These variables
+// have local linkage and would be duplicated in each model linking them.
+static bool isStatefulRuntimeFunc(llvm::Function &func,
+    const llvm::SmallPtrSetImpl<llvm::Function *> &statefulFuncs) {
+  llvm::SmallVector<const llvm::Constant *, 8> worklist;
+  llvm::SmallPtrSet<const llvm::Constant *, 16> visited;
+  for (llvm::Instruction &inst : llvm::instructions(func))
+    for (const llvm::Value *operand : inst.operands())
+      if (auto *constant = llvm::dyn_cast<llvm::Constant>(operand))
+        if (visited.insert(constant).second)
+          worklist.emplace_back(constant);
+  while (!worklist.empty()) {
+    const llvm::Constant *constant = worklist.pop_back_val();
+    if (auto *global = llvm::dyn_cast<llvm::GlobalVariable>(constant)) {
+      if (global->hasLocalLinkage() && !global->isConstant())
+        return true;
+      continue;
+    }
+    if (auto *callee = llvm::dyn_cast<llvm::Function>(constant)) {
+      if (statefulFuncs.count(callee))
+        return true;
+      continue;
+    }
+    for (const llvm::Value *operand : constant->operands())
+      if (auto *nested = llvm::dyn_cast<llvm::Constant>(operand))
+        if (visited.insert(nested).second)
+          worklist.emplace_back(nested);
+  }
+  return false;
+}
+
+// Link the runtime bitcode into the model, so that LLVM can inline the
+// OMTensor and OMTensorList functions called by the entry points. Only the
+// stateless functions used by the model are linked, with internal linkage to
+// not clash with the runtime library the model is still linked with. The
+// functions using the state of the runtime, such as the allocation of the
+// OMTensors, stay calls to that library, and so do its variables, so that
+// this state is not copied into each model. The bitcode is skipped with a
+// warning when it cannot be read by this LLVM or targets another triple.
+// Return 0 on success, error code on failure.
+static int linkRuntimeBitcodeInto(llvm::Module &llvmModule) {
+  std::string bitcodePath = getLibraryPath() + "/libcruntime.bc";
+  if (!llvm::sys::fs::exists(bitcodePath)) {
+    llvm::errs() << bitcodePath << ": No such file or directory\n";
+    return InvalidInputFileAccess;
+  }
+  llvm::SMDiagnostic diag;
+  std::unique_ptr<llvm::Module> runtimeModule =
+      llvm::parseIRFile(bitcodePath, diag, llvmModule.getContext());
+  if (!runtimeModule) {
+    // Most likely written by another version of LLVM.
+    diag.print(bitcodePath.c_str(), llvm::errs());
+    llvm::errs() << "Warning: " << bitcodePath
+                 << " cannot be read, the runtime is not linked into the "
+                    "model.\n";
+    return CompilerSuccess;
+  }
+  if (runtimeModule->getTargetTriple() != llvmModule.getTargetTriple()) {
+    llvm::errs() << "Warning: " << bitcodePath << " targets "
+                 << runtimeModule->getTargetTriple()
+                 << ", the runtime is not linked into the model.\n";
+    return CompilerSuccess;
+  }
+  runtimeModule->setDataLayout(llvmModule.getDataLayout());
+
+  // The constructors and destructors of the runtime, such as the one deleting
+  // the pthread key of OMTensor.inc, run in the library only.
+  for (llvm::StringRef name : {"llvm.global_ctors", "llvm.global_dtors"})
+    if (llvm::GlobalVariable *global = runtimeModule->getNamedGlobal(name))
+      global->eraseFromParent();
+
+  // Find the stateful functions, until no more function calls one of them.
+  llvm::SmallPtrSet<llvm::Function *, 16> statefulFuncs;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (llvm::Function &func : *runtimeModule)
+      if (!func.isDeclaration() && !statefulFuncs.count(&func) &&
+          isStatefulRuntimeFunc(func, statefulFuncs)) {
+        statefulFuncs.insert(&func);
+        changed = true;
+      }
+  }
+
+  // Keep only the declarations of the stateful functions the library
+  // exports. The local ones are then no longer used, and not linked.
+  llvm::StringSet<> runtimeFuncNames;
+  for (llvm::Function &func : *runtimeModule) {
+    if (func.isDeclaration() || func.hasLocalLinkage())
+      continue;
+    if (statefulFuncs.count(&func)) {
+      func.deleteBody();
+      func.setComdat(nullptr);
+      continue;
+    }
+    runtimeFuncNames.insert(func.getName());
+    func.addFnAttr(llvm::Attribute::InlineHint);
+  }
+  for (llvm::GlobalVariable &global : runtimeModule->globals())
+    if (!global.isDeclaration() && !global.hasLocalLinkage()) {
+      global.setInitializer(nullptr);
+      global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+      global.setComdat(nullptr);
+    }
+
+  if (llvm::Linker::linkModules(llvmModule, std::move(runtimeModule),
+          llvm::Linker::Flags::LinkOnlyNeeded)) {
+    llvm::errs() << "Failed to link " << bitcodePath << " into the model.\n";
+    return CompilerFailureInMLIRToLLVM;
+  }
+  for (llvm::Function &func : llvmModule)
+    if (!func.isDeclaration() && runtimeFuncNames.count(func.getName()))
+      func.setLinkage(llvm::GlobalValue::InternalLinkage);
+  return CompilerSuccess;
 }
 
 // Extend the input filename (with possibly a path but no extention) by the
@@ -405,6 +727,11 @@ static int genLLVMBitcode(const mlir::OwningOpRef<ModuleOp> &module,
 
   // Tailor LLVMIR to add features that cannot be done with MLIR LLVMIR.
   tailorLLVMIR(*llvmModule);
+  if (linkRuntimeBitcode) {
+    int rc = linkRuntimeBitcodeInto(*llvmModule);
+    if (rc != CompilerSuccess)
+      return rc;
+  }
 
   // Write LLVMIR to a file.
   std::string llvmirNameWithExt = outputNameNoExt + ".ll";
@@ -431,6 +758,7 @@ static int genLLVMBitcode(const mlir::OwningOpRef<ModuleOp> &module,
                .appendStr(getTargetArchOption())
                .appendStr(getTargetCPUOption())
                .appendList(getXoptOption())
+               .appendList(getPGOOption())
                .appendStr(getLLVMOption())
                .appendList({"-o", optimizedBitcodeNameWithExt})
                .appendStr(unoptimizedBitcodeNameWithExt)
@@ -493,6 +821,9 @@ static int genSharedLib(std::string sharedLibNameWithExt,
 #else
   std::vector<std::string> outputOpt = {"-o", sharedLibNameWithExt};
   std::vector<std::string> sharedLibOpts = {"-shared", "-fPIC"};
+  // Link the profile runtime writing the profile of an instrumented model.
+  if (pgoInstrument && pgoUse.empty())
+    sharedLibOpts.emplace_back("-fprofile-instr-generate");
   llvm::for_each(libs, [](std::string &lib) { lib = "-l" + lib; });
   llvm::for_each(libDirs, [](std::string &libDir) { libDir = "-L" + libDir; });
 #endif
@@ -532,9 +863,223 @@ static int genJniJar(const mlir::OwningOpRef<ModuleOp> &module,
   return rc != 0 ? CompilerFailureInGenJni : CompilerSuccess;
 }
 
+// Get the LLVM Target object corresponding to the target triple (if valid).
+static const llvm::Target *getLLVMTarget(
+    const std::string &targetTriple, const Location &loc) {
+  std::string error;
+  const llvm::Target *LLVMTarget =
+      llvm::TargetRegistry::lookupTarget(targetTriple, error);
+  if (!LLVMTarget) {
+    emitError(loc, Twine("Target architecture is unknown: ") + error);
+    return nullptr;
+  }
+
+  return LLVMTarget;
+}
+
+static std::string getTargetTriple() {
+  return (mtriple != "") ? mtriple.getValue() : kDefaultTriple;
+}
+static std::string getTargetCpu() {
+  return (mcpu != "") ? mcpu.getValue() : "";
+}
+
+// Return whether the LLVM IR can be optimized and compiled in process. The
+// flags forwarded to 'opt' and 'llc' are options of these tools, which are not
+// parsed by the compiler.
+static bool useInProcessCodegen() {
+  return inProcessCodegen && getXoptOption().empty() &&
+         getXllcOption().empty() && getLLVMOption().empty() &&
+         getPGOOption().empty();
+}
+
+// Create the target machine generating the code of the model, with the same
+// triple, arch, cpu, optimization level and relocation model as 'llc'.
+static std::unique_ptr<llvm::TargetMachine> createTargetMachine(
+    const Location &loc) {
+  const std::string targetTriple = getTargetTriple();
+  std::string error;
+  const llvm::Target *LLVMTarget = nullptr;
+  if (march != "") {
+    llvm::Triple triple(targetTriple);
+    LLVMTarget = llvm::TargetRegistry::lookupTarget(march, triple, error);
+    if (!LLVMTarget)
+      emitError(loc, Twine("Target architecture is unknown: ") + error);
+  } else {
+    LLVMTarget = getLLVMTarget(targetTriple, loc);
+  }
+  if (!LLVMTarget)
+    return nullptr;
+
+  llvm::CodeGenOpt::Level codeGenOptLevel = llvm::CodeGenOpt::None;
+  switch (OptimizationLevel) {
+  case O0:
+    codeGenOptLevel = llvm::CodeGenOpt::None;
+    break;
+  case O1:
+    codeGenOptLevel = llvm::CodeGenOpt::Less;
+    break;
+  case O2:
+    codeGenOptLevel = llvm::CodeGenOpt::Default;
+    break;
+  case O3:
+    codeGenOptLevel = llvm::CodeGenOpt::Aggressive;
+    break;
+  }
+  llvm::TargetOptions ops;
+  return std::unique_ptr<llvm::TargetMachine>{
+      LLVMTarget->createTargetMachine(targetTriple, getTargetCpu(),
+          "" /*features*/, ops, llvm::Reloc::PIC_, std::nullopt,
+          codeGenOptLevel)};
+}
+
+// Optimize the LLVM module with the default pipeline of 'opt' at the
+// optimization level of the compilation.
+static void optimizeLLVMModule(
+    llvm::Module &llvmModule, llvm::TargetMachine &targetMachine) {
+  llvm::LoopAnalysisManager LAM;
+  llvm::FunctionAnalysisManager FAM;
+  llvm::CGSCCAnalysisManager CGAM;
+  llvm::ModuleAnalysisManager MAM;
+  llvm::PassBuilder PB(&targetMachine);
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  llvm::ModulePassManager MPM;
+  switch (OptimizationLevel) {
+  case O0:
+    MPM = PB.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+    break;
+  case O1:
+    MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+    break;
+  case O2:
+    MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+    break;
+  case O3:
+    MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+    break;
+  }
+  MPM.run(llvmModule, MAM);
+}
+
+// Translate the module to LLVM IR, optimize it and generate object files
+// within the compiler, without going through bitcode files nor running 'opt'
+// and 'llc'. The module is split into numPartitions partitions generated in
+// parallel, one object file each, which must all be linked together.
+// Return 0 on success, error code on failure.
+static int genModelObjectsInProcess(const mlir::OwningOpRef<ModuleOp> &module,
+    std::string outputNameNoExt, unsigned numPartitions,
+    std::vector<std::string> &modelObjNamesWithExt) {
+  std::error_code error;
+  Location loc = module->getLoc();
+  std::unique_ptr<llvm::TargetMachine> targetMachine =
+      createTargetMachine(loc);
+  if (!targetMachine) {
+    llvm::errs() << "Failed to create target machine.\n";
+    return CompilerFailureInLLVMToObj;
+  }
+
+  llvm::LLVMContext llvmContext;
+  mlir::registerLLVMDialectTranslation(*(module.get().getContext()));
+  std::unique_ptr<llvm::Module> llvmModule =
+      mlir::translateModuleToLLVMIR(*module, llvmContext);
+  if (!llvmModule) {
+    llvm::errs() << "Failed to translate module to LLVMIR.\n";
+    return CompilerFailureInMLIRToLLVM;
+  }
+
+  // Tailor LLVMIR to add features that cannot be done with MLIR LLVMIR.
+  tailorLLVMIR(*llvmModule);
+  if (linkRuntimeBitcode) {
+    int rc = linkRuntimeBitcodeInto(*llvmModule);
+    if (rc != CompilerSuccess)
+      return rc;
+  }
+
+  // Only write the LLVMIR and the bitcode when requested to keep them.
+  if (keepFiles(KeepFilesOfType::LLVMIR)) {
+    std::string llvmirNameWithExt = outputNameNoExt + ".ll";
+    llvm::raw_fd_ostream moduleLLVMIRStream(
+        llvmirNameWithExt, error, llvm::sys::fs::OF_None);
+    if (error) {
+      llvm::errs() << llvmirNameWithExt << ": " << error.message() << "\n";
+      return InvalidTemporaryFileAccess;
+    }
+    llvmModule->print(moduleLLVMIRStream, nullptr);
+  }
+
+  auto optStart = std::chrono::steady_clock::now();
+  optimizeLLVMModule(*llvmModule, *targetMachine);
+  CompileProfiler::recordPhase("opt (in process)",
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - optStart)
+          .count());
+
+  if (keepFiles(KeepFilesOfType::Bitcode)) {
+    std::string bitcodeNameWithExt = outputNameNoExt + ".bc";
+    llvm::raw_fd_ostream moduleBitcodeStream(
+        bitcodeNameWithExt, error, llvm::sys::fs::OF_None);
+    if (error) {
+      llvm::errs() << bitcodeNameWithExt << ": " << error.message() << "\n";
+      return InvalidTemporaryFileAccess;
+    }
+    llvm::WriteBitcodeToFile(*llvmModule, moduleBitcodeStream);
+  }
+
+  // Open one object file per partition, the first one being the object file
+  // of the model.
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> objStreams;
+  SmallVector<llvm::raw_pwrite_stream *, 4> objStreamPtrs;
+  for (unsigned i = 0; i < std::max(numPartitions, 1u); ++i) {
+    std::string objNameNoExt = outputNameNoExt;
+    if (i > 0)
+      objNameNoExt += ".part" + std::to_string(i);
+    std::string objNameWithExt = getTargetFilename(objNameNoExt, EmitObj);
+    objStreams.emplace_back(std::make_unique<llvm::raw_fd_ostream>(
+        objNameWithExt, error, llvm::sys::fs::OF_None));
+    if (error) {
+      llvm::errs() << objNameWithExt << ": " << error.message() << "\n";
+      return InvalidTemporaryFileAccess;
+    }
+    objStreamPtrs.emplace_back(objStreams.back().get());
+    modelObjNamesWithExt.emplace_back(objNameWithExt);
+  }
+
+  // Each partition is generated by a thread of its own, with a target machine
+  // of its own.
+  auto codegenStart = std::chrono::steady_clock::now();
+  llvm::splitCodeGen(
+      *llvmModule, objStreamPtrs, {},
+      [&]() { return createTargetMachine(loc); }, llvm::CGFT_ObjectFile);
+  CompileProfiler::recordPhase("llc (in process)",
+      std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - codegenStart)
+          .count());
+  for (std::unique_ptr<llvm::raw_fd_ostream> &objStream : objStreams) {
+    objStream->close();
+    if (objStream->has_error()) {
+      llvm::errs() << "Failed to write object file: "
+                   << objStream->error().message() << "\n";
+      return CompilerFailureInLLVMToObj;
+    }
+  }
+  return CompilerSuccess;
+}
+
 // Return 0 on success, error code on failure
 static int compileModuleToObject(const mlir::OwningOpRef<ModuleOp> &module,
     std::string outputNameWithoutExt, std::string &objectNameWithExt) {
+  if (useInProcessCodegen()) {
+    std::vector<std::string> objectNamesWithExt;
+    int rc = genModelObjectsInProcess(
+        module, outputNameWithoutExt, 1, objectNamesWithExt);
+    if (!objectNamesWithExt.empty())
+      objectNameWithExt = objectNamesWithExt[0];
+    return rc;
+  }
   std::string bitcodeNameWithExt = outputNameWithoutExt + ".bc";
   int rc = genLLVMBitcode(module, outputNameWithoutExt, bitcodeNameWithExt);
   if (rc != CompilerSuccess)
@@ -545,30 +1090,130 @@ static int compileModuleToObject(const mlir::OwningOpRef<ModuleOp> &module,
   return genModelObject(bitcodeNameWithExt, objectNameWithExt);
 }
 
+// Assemble the raw data of the constants object, written when lowering the
+// module, into an object file defining its global with a hidden visibility,
+// the data being included as is by .incbin.
+// Return 0 on success, error code on failure.
+static int genConstantsObject(std::string rawNameWithExt,
+    std::string outputNameNoExt, std::string &constantsObjNameWithExt) {
+  llvm::SmallString<128> rawPath(rawNameWithExt);
+  llvm::sys::fs::make_absolute(rawPath);
+  std::string escapedRawPath;
+  for (char c : rawPath) {
+    if (c == '"' || c == '\\')
+      escapedRawPath.push_back('\\');
+    escapedRawPath.push_back(c);
+  }
+
+  std::string asmNameWithExt = outputNameNoExt + ".constants.s";
+  llvm::FileRemover asmRemover(
+      asmNameWithExt, !keepFiles(KeepFilesOfType::Object));
+  std::error_code error;
+  llvm::raw_fd_ostream asmStream(
+      asmNameWithExt, error, llvm::sys::fs::OF_Text);
+  if (error) {
+    llvm::errs() << asmNameWithExt << ": " << error.message() << "\n";
+    return InvalidTemporaryFileAccess;
+  }
+  std::string symbol = CONSTANTS_OBJECT_GLOBAL;
+  if (llvm::Triple(getTargetTriple()).isOSBinFormatMachO()) {
+    symbol = "_" + symbol;
+    asmStream << "  .section __TEXT,__const\n"
+              << "  .private_extern " << symbol << "\n";
+  } else {
+    asmStream << "  .section .rodata." << CONSTANTS_OBJECT_GLOBAL
+              << ",\"a\"\n"
+              << "  .hidden " << symbol << "\n";
+  }
+  asmStream << "  .globl " << symbol << "\n"
+            << "  .p2align 12\n"
+            << symbol << ":\n"
+            << "  .incbin \"" << escapedRawPath << "\"\n";
+  // Keep the stack of the library non executable.
+  if (!llvm::Triple(getTargetTriple()).isOSBinFormatMachO())
+    asmStream << "  .section .note.GNU-stack,\"\",%progbits\n";
+  asmStream.close();
+  if (asmStream.has_error()) {
+    llvm::errs() << asmNameWithExt << ": " << asmStream.error().message()
+                 << "\n";
+    return InvalidTemporaryFileAccess;
+  }
+
+  constantsObjNameWithExt =
+      getTargetFilename(outputNameNoExt + ".constants", EmitObj);
+  Command assemble(kCxxPath);
+  int rc = assemble.appendStr("-c")
+               .appendList({"-o", constantsObjNameWithExt})
+               .appendStr(asmNameWithExt)
+               .exec();
+  return rc != 0 ? CompilerFailureInLLVMToObj : CompilerSuccess;
+}
+
+// Compile the module to the object files linked into a shared library, which
+// are the ones of the partitions of the module with in process codegen.
+// Return 0 on success, error code on failure
+static int compileModuleToObjects(const mlir::OwningOpRef<ModuleOp> &module,
+    std::string outputNameWithoutExt,
+    std::vector<std::string> &objectNamesWithExt) {
+  int rc;
+  if (useInProcessCodegen()) {
+    rc = genModelObjectsInProcess(module, outputNameWithoutExt,
+        codegenPartitions, objectNamesWithExt);
+  } else {
+    std::string objectNameWithExt;
+    rc = compileModuleToObject(module, outputNameWithoutExt, objectNameWithExt);
+    if (rc == CompilerSuccess)
+      objectNamesWithExt.emplace_back(objectNameWithExt);
+  }
+  if (rc != CompilerSuccess)
+    return rc;
+
+  // The data of the constants object is linked along with the model.
+  auto rawAttr =
+      (*module)->getAttrOfType<mlir::StringAttr>(CONSTANTS_OBJECT_ATTR);
+  if (!rawAttr)
+    return CompilerSuccess;
+  std::string rawNameWithExt = rawAttr.getValue().str();
+  llvm::FileRemover rawRemover(
+      rawNameWithExt, !keepFiles(KeepFilesOfType::Object));
+  std::string constantsObjNameWithExt;
+  rc = genConstantsObject(
+      rawNameWithExt, outputNameWithoutExt, constantsObjNameWithExt);
+  if (!constantsObjNameWithExt.empty())
+    objectNamesWithExt.emplace_back(constantsObjNameWithExt);
+  return rc;
+}
+
 // Return 0 on success, error code on failure
 static int compileModuleToSharedLibrary(
     const mlir::OwningOpRef<ModuleOp> &module, std::string outputNameNoExt,
     std::string &libNameWithExt) {
-  std::string modelObjNameWithExt;
-  int rc = compileModuleToObject(module, outputNameNoExt, modelObjNameWithExt);
+  std::vector<std::string> modelObjNamesWithExt;
+  int rc =
+      compileModuleToObjects(module, outputNameNoExt, modelObjNamesWithExt);
+  std::vector<std::unique_ptr<llvm::FileRemover>> modelObjRemovers;
+  for (const std::string &modelObjNameWithExt : modelObjNamesWithExt)
+    modelObjRemovers.emplace_back(std::make_unique<llvm::FileRemover>(
+        modelObjNameWithExt, !keepFiles(KeepFilesOfType::Object)));
   if (rc != CompilerSuccess)
     return rc;
-  llvm::FileRemover modelObjRemover(
-      modelObjNameWithExt, !keepFiles(KeepFilesOfType::Object));
   libNameWithExt = getTargetFilename(outputNameNoExt, EmitLib);
-  return genSharedLib(libNameWithExt, {}, {modelObjNameWithExt},
+  return genSharedLib(libNameWithExt, {}, modelObjNamesWithExt,
       getCompilerConfig(CCM_SHARED_LIB_DEPS), {getLibraryPath()});
 }
 
 // Return 0 on success, error code on failure
 static int compileModuleToJniJar(
     const mlir::OwningOpRef<ModuleOp> &module, std::string outputNameNoExt) {
-  std::string modelObjNameWithExt;
-  int rc = compileModuleToObject(module, outputNameNoExt, modelObjNameWithExt);
+  std::vector<std::string> modelObjNamesWithExt;
+  int rc =
+      compileModuleToObjects(module, outputNameNoExt, modelObjNamesWithExt);
+  std::vector<std::unique_ptr<llvm::FileRemover>> modelObjRemovers;
+  for (const std::string &modelObjNameWithExt : modelObjNamesWithExt)
+    modelObjRemovers.emplace_back(std::make_unique<llvm::FileRemover>(
+        modelObjNameWithExt, !keepFiles(KeepFilesOfType::Object)));
   if (rc != CompilerSuccess)
     return rc;
-  llvm::FileRemover modelObjRemover(
-      modelObjNameWithExt, !keepFiles(KeepFilesOfType::Object));
 
   StringRef outputDir = llvm::sys::path::parent_path(outputNameNoExt);
   if (outputDir.empty())
@@ -598,9 +1243,10 @@ static int compileModuleToJniJar(
   { "-z", "noexecstack" }
 #endif
   std::string modelSharedLibPath = getTargetFilename(jniLibBase, EmitLib);
-  rc = genSharedLib(modelSharedLibPath, NOEXECSTACK,
-      {modelObjNameWithExt, jniObjPath}, getCompilerConfig(CCM_SHARED_LIB_DEPS),
-      {getLibraryPath()});
+  std::vector<std::string> objs = modelObjNamesWithExt;
+  objs.emplace_back(jniObjPath);
+  rc = genSharedLib(modelSharedLibPath, NOEXECSTACK, objs,
+      getCompilerConfig(CCM_SHARED_LIB_DEPS), {getLibraryPath()});
   if (rc != CompilerSuccess)
     return rc;
   llvm::FileRemover modelSharedLibRemover(
@@ -739,6 +1385,19 @@ static int emitOutputFiles(std::string outputNameNoExt,
   } break;
   case EmitLib: {
     addCompilerConfig(CCM_SHARED_LIB_DEPS, {"cruntime"});
+#if !defined(_WIN32) && !defined(__MVS__)
+    // The constants file is located with dladdr at runtime.
+    if (storeConstantsToFile)
+      addCompilerConfig(CCM_SHARED_LIB_DEPS, {"dl"});
+    // Parallel loops, and the decompression of the constants, run on the
+    // thread pool of the runtime.
+    if (enableParallel ||
+        (storeConstantsToFile && !compressConstants.empty()))
+      addCompilerConfig(CCM_SHARED_LIB_DEPS, {"pthread"});
+#endif
+    // The BLAS library follows cruntime, whose functions call it.
+    if (!blasLibrary.empty())
+      addCompilerConfig(CCM_SHARED_LIB_DEPS, {blasLibrary});
     std::string sharedLibNameWithExt;
     int rc = compileModuleToSharedLibrary(
         module, outputNameNoExt, sharedLibNameWithExt);
@@ -755,6 +1414,12 @@ static int emitOutputFiles(std::string outputNameNoExt,
   } break;
   case EmitJNI: {
     addCompilerConfig(CCM_SHARED_LIB_DEPS, {"jniruntime", "cruntime"});
+#if !defined(_WIN32) && !defined(__MVS__)
+    if (enableParallel)
+      addCompilerConfig(CCM_SHARED_LIB_DEPS, {"pthread"});
+#endif
+    if (!blasLibrary.empty())
+      addCompilerConfig(CCM_SHARED_LIB_DEPS, {blasLibrary});
     int rc = compileModuleToJniJar(module, outputNameNoExt);
     if (rc != CompilerSuccess)
       return rc;
@@ -796,27 +1461,6 @@ static int emitOutputFiles(std::string outputNameNoExt,
   return CompilerSuccess;
 } // end anonymous namespace
 
-// Get the LLVM Target object corresponding to the target triple (if valid).
-static const llvm::Target *getLLVMTarget(
-    const std::string &targetTriple, const Location &loc) {
-  std::string error;
-  const llvm::Target *LLVMTarget =
-      llvm::TargetRegistry::lookupTarget(targetTriple, error);
-  if (!LLVMTarget) {
-    emitError(loc, Twine("Target architecture is unknown: ") + error);
-    return nullptr;
-  }
-
-  return LLVMTarget;
-}
-
-static std::string getTargetTriple() {
-  return (mtriple != "") ? mtriple.getValue() : kDefaultTriple;
-}
-static std::string getTargetCpu() {
-  return (mcpu != "") ? mcpu.getValue() : "";
-}
-
 /// Return the module datalayout string. The datalayout string is determined
 /// by creating a target machine using the target triple and target cpu.
 static std::string getDataLayout(const Location &loc) {
@@ -839,18 +1483,69 @@ static std::string getDataLayout(const Location &loc) {
   return dataLayoutString;
 }
 
+/// Return the description of the vector unit and of the caches of the target
+/// machine, from the features of its subtarget. The cache sizes are the
+/// typical ones of the targets, unless the subtarget knows them.
+static VectorMachineSupport getVectorMachineSupport(const Location &loc) {
+  VectorMachineSupport support;
+  std::unique_ptr<llvm::TargetMachine> targetMachine = createTargetMachine(loc);
+  if (!targetMachine)
+    return support;
+  const llvm::MCSubtargetInfo *info = targetMachine->getMCSubtargetInfo();
+  const llvm::Triple &triple = targetMachine->getTargetTriple();
+  auto hasFeature = [&](StringRef feature) {
+    return info->checkFeatures(("+" + feature).str());
+  };
+  if (triple.isX86()) {
+    if (hasFeature("avx512f")) {
+      // Cpus preferring 256 bits vectors still have 32 registers.
+      support.simdBitWidth = hasFeature("prefer-256-bit") ? 256 : 512;
+      support.numVectorRegisters = 32;
+      support.l2CacheSize = 1024 * 1024;
+    } else if (hasFeature("avx")) {
+      support.simdBitWidth = 256;
+    }
+    support.hasFMA = hasFeature("fma");
+  } else if (triple.isAArch64()) {
+    support.numVectorRegisters = 32;
+    support.hasFMA = true;
+    support.l1CacheSize = 64 * 1024;
+    support.l2CacheSize = 1024 * 1024;
+  } else if (triple.isSystemZ() && hasFeature("vector")) {
+    support.numVectorRegisters = 32;
+    support.hasFMA = true;
+    support.l1CacheSize = 128 * 1024;
+    support.l2CacheSize = 2 * 1024 * 1024;
+  } else if (triple.isPPC64() && hasFeature("vsx")) {
+    support.numVectorRegisters = 64;
+    support.hasFMA = true;
+  }
+  if (auto l1CacheSize = info->getCacheSize(0))
+    support.l1CacheSize = *l1CacheSize;
+  if (auto l2CacheSize = info->getCacheSize(1))
+    support.l2CacheSize = *l2CacheSize;
+  return support;
+}
+
 // Return 0 on success, error code on failure.
 static int setupModule(mlir::OwningOpRef<ModuleOp> &module,
-    mlir::MLIRContext &context, std::string outputNameNoExt) {
-  // Initialize the targets support for all targets LLVM was configured for.
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
+    mlir::MLIRContext &context, std::string outputNameNoExt,
+    EmissionTargetType emissionTarget) {
+  // Initialize the targets support for all targets LLVM was configured for,
+  // once for all the compiles of the process.
+  static std::once_flag targetsInitialized;
+  std::call_once(targetsInitialized, []() {
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+  });
 
   // Set the module target triple and datalayout.
   Operation &moduleOp = *(module->getOperation());
   Location loc = moduleOp.getLoc();
+  // Size the vectors and tiles of the lowerings for the target machine.
+  VectorMachineSupport::setGlobal(getVectorMachineSupport(loc));
   moduleOp.setAttr(LLVM::LLVMDialect::getTargetTripleAttrName(),
       StringAttr::get(&context, getTargetTriple()));
   moduleOp.setAttr(LLVM::LLVMDialect::getDataLayoutAttrName(),
@@ -867,6 +1562,25 @@ static int setupModule(mlir::OwningOpRef<ModuleOp> &module,
   if (!accelsAttr.empty())
     moduleOp.setAttr("onnx-mlir.accels", ArrayAttr::get(&context, accelsAttr));
 
+  // Set the file to store large constants into, if requested.
+  if (storeConstantsToFile)
+    moduleOp.setAttr(CONSTANTS_FILE_ATTR,
+        StringAttr::get(&context, outputNameNoExt + ".constants.bin"));
+  if (storeConstantsToFile && !sharedConstantsFile.empty())
+    moduleOp.setAttr(SHARED_CONSTANTS_FILE_ATTR,
+        StringAttr::get(&context, sharedConstantsFile));
+  if (storeConstantsToFile && !compressConstants.empty())
+    moduleOp.setAttr(CONSTANTS_FILE_COMPRESSION_ATTR,
+        StringAttr::get(&context, compressConstants));
+#ifndef _WIN32
+  // Otherwise, emit them into an object file linked into the library, if
+  // requested.
+  if (constantsToObject && !storeConstantsToFile &&
+      (emissionTarget == EmitLib || emissionTarget == EmitJNI))
+    moduleOp.setAttr(CONSTANTS_OBJECT_ATTR,
+        StringAttr::get(&context, outputNameNoExt + ".constants.raw"));
+#endif
+
   if (keepFiles(KeepFilesOfType::MLIR)) {
     std::string mlirNameWithExt = outputNameNoExt + ".input.mlir";
     int rc = outputCode(module, mlirNameWithExt);
@@ -896,7 +1610,7 @@ int compileModule(mlir::OwningOpRef<ModuleOp> &module,
   if (!maccel.empty())
     onnx_mlir::accel::initAccelerators(maccel);
 
-  int rc = setupModule(module, context, outputNameNoExt);
+  int rc = setupModule(module, context, outputNameNoExt, emissionTarget);
   if (rc != CompilerSuccess)
     return rc;
 
@@ -919,6 +1633,10 @@ int compileModule(mlir::OwningOpRef<ModuleOp> &module,
     pm.addInstrumentation(std::make_unique<HeapReporter>(
         heapLogFileame, reportHeapBefore, reportHeapAfter));
   }
+  // The profile is written when the pass manager is destroyed, after the
+  // output is emitted, so that it includes the tools run to emit it.
+  if (!compileProfile.empty())
+    pm.addInstrumentation(std::make_unique<CompileProfiler>(compileProfile));
   mlir::applyPassManagerCLOptions(pm);
   mlir::applyDefaultTimingPassManagerCLOptions(pm);
 
@@ -11,13 +11,215 @@
 
 #include "include/OnnxMlirCompiler.h"
 #include "ExternalUtil.hpp"
+#include "src/Compiler/CompilerCache.hpp"
 #include "src/Compiler/CompilerUtils.hpp"
 
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 using namespace mlir;
 using namespace onnx_mlir;
 
 namespace onnx_mlir {
 
+// Serializes the compiles reading the process-global compiler options.
+static std::mutex compilerOptionsMutex;
+
+struct OMCompileSession {
+  OMCompileSession(std::vector<std::string> flags) : flags(std::move(flags)) {}
+
+  // Options of the compiles, as given to onnx-mlir.
+  const std::vector<std::string> flags;
+  // Thread pool shared by the contexts of the compiles.
+  llvm::ThreadPool threadPool;
+};
+
+// Save each space-separated text of the flags in a separate entry.
+static std::vector<std::string> splitFlags(const char *flags) {
+  std::vector<std::string> flagVect;
+  const char *str = flags;
+  do {
+    // Get rid of leading spaces.
+    while (*str && std::isspace(*str))
+      ++str;
+    // Save current location and advance while useful chars.
+    const char *begin = str;
+    while (*str && !std::isspace(*str))
+      ++str;
+    // If not empty, copy new entry into flagVec.
+    if (begin != str)
+      flagVect.push_back(std::string(begin, str));
+  } while (*str);
+  return flagVect;
+}
+
+#if !defined(_WIN32)
+// Send the compile request to the onnx-mlir daemon listening on the Unix
+// socket at the path, see its --daemon option. Return the return code of the
+// compile, or -1 if the daemon cannot be reached.
+static int compileWithDaemon(
+    const std::string &socketPath, const std::vector<std::string> &args) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(addr.sun_path))
+    return -1;
+  strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  llvm::SmallString<128> workingDir;
+  if (llvm::sys::fs::current_path(workingDir)) {
+    close(fd);
+    return -1;
+  }
+  std::string request =
+      workingDir.str().str() + "\n" + llvm::join(args, " ") + "\n";
+  const char *data = request.data();
+  size_t remaining = request.size();
+  while (remaining > 0) {
+    ssize_t written = write(fd, data, remaining);
+    if (written <= 0) {
+      close(fd);
+      return -1;
+    }
+    data += written;
+    remaining -= written;
+  }
+  // The reply is the return code followed by a newline.
+  std::string reply;
+  char buffer[64];
+  ssize_t size;
+  while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+    reply.append(buffer, size);
+  close(fd);
+  int rc;
+  if (llvm::StringRef(reply).trim().getAsInteger(10, rc))
+    return -1;
+  return rc;
+}
+#endif
+
+// Set the compiler options of the process to the flags, the other options
+// being reset to their defaults. Return false with the error message if the
+// flags are invalid. Must be called holding compilerOptionsMutex.
+static bool setCompilerOptionsFromFlags(
+    const std::vector<std::string> &flags, std::string &errorMessage) {
+  std::vector<const char *> argv = {"onnx-mlir"};
+  for (const std::string &flag : flags)
+    argv.push_back(flag.c_str());
+  llvm::cl::ResetAllOptionOccurrences();
+  llvm::raw_string_ostream errs(errorMessage);
+  return llvm::cl::ParseCommandLineOptions(
+      argv.size(), argv.data(), "", &errs);
+}
+
+// Compile the model with the current compiler options, the compilation cache
+// key covering the given options. The context of the compile uses the thread
+// pool if any, or else its own. Must be called holding compilerOptionsMutex.
+static int64_t compileFromArray(const void *inputBuffer, int64_t bufferSize,
+    const char *outputBaseName, EmissionTargetType emissionTarget,
+    const std::vector<std::string> &options, llvm::ThreadPool *threadPool,
+    const char **outputFilename, const char **errorMessage) {
+  std::string outputBaseNameStr(outputBaseName);
+  std::string name = getTargetFilename(outputBaseNameStr, emissionTarget);
+
+  // Copy the output file from the compilation cache if it has it.
+  std::string cacheKey;
+  if (isCompileCacheable(emissionTarget)) {
+    llvm::StringRef model((const char *)inputBuffer, bufferSize);
+    cacheKey = getCompileCacheKey(model, options, emissionTarget);
+    if (lookupCompileCache(cacheKey, name)) {
+      if (outputFilename)
+        *outputFilename = strdup(name.c_str());
+      return CompilerSuccess;
+    }
+  }
+
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  mlir::MLIRContext context(threadPool ? mlir::MLIRContext::Threading::DISABLED
+                                       : mlir::MLIRContext::Threading::ENABLED);
+  if (threadPool)
+    context.setThreadPool(*threadPool);
+  registerDialects(context);
+
+  std::string internalErrorMessage;
+  int rc = processInputArray(
+      inputBuffer, bufferSize, context, module, &internalErrorMessage);
+  if (rc != CompilerSuccess) {
+    if (errorMessage != NULL)
+      *errorMessage = strdup(internalErrorMessage.c_str());
+    return rc;
+  }
+
+  rc = compileModule(module, context, outputBaseNameStr, emissionTarget);
+  if (rc == CompilerSuccess && !cacheKey.empty())
+    storeCompileCache(cacheKey, name);
+  if (rc == CompilerSuccess && outputFilename) {
+    // Copy Filename
+    *outputFilename = strdup(name.c_str());
+  }
+  return rc;
+}
+
+// Compile the model into a shared library in a temporary directory, as by
+// compileFromArray, and copy it into a buffer allocated by malloc. The
+// directory is removed afterwards. Must be called holding
+// compilerOptionsMutex.
+static int64_t compileToBuffer(const void *inputBuffer, int64_t bufferSize,
+    const std::vector<std::string> &options, llvm::ThreadPool *threadPool,
+    void **outputBuffer, int64_t *outputBufferSize,
+    const char **errorMessage) {
+  // The library would then need its constants file next to it.
+  if (storeConstantsToFile) {
+    if (errorMessage != NULL)
+      *errorMessage = strdup("Cannot compile into a buffer with "
+                             "--store-constants-to-file");
+    return InvalidCompilerOption;
+  }
+  llvm::SmallString<64> tempDir;
+  if (llvm::sys::fs::createUniqueDirectory("onnx-mlir", tempDir)) {
+    if (errorMessage != NULL)
+      *errorMessage = strdup("Cannot create a temporary directory");
+    return InvalidTemporaryFileAccess;
+  }
+  llvm::SmallString<64> outputBaseName(tempDir);
+  llvm::sys::path::append(outputBaseName, "model");
+  const char *outputFilename = nullptr;
+  int64_t rc = compileFromArray(inputBuffer, bufferSize,
+      outputBaseName.c_str(), EmitLib, options, threadPool, &outputFilename,
+      errorMessage);
+  if (rc == CompilerSuccess) {
+    auto library = llvm::MemoryBuffer::getFile(outputFilename);
+    if (!library) {
+      rc = InvalidTemporaryFileAccess;
+    } else {
+      *outputBufferSize = (*library)->getBufferSize();
+      *outputBuffer = malloc(*outputBufferSize);
+      memcpy(*outputBuffer, (*library)->getBufferStart(), *outputBufferSize);
+    }
+    free((void *)outputFilename);
+  }
+  llvm::sys::fs::remove_directories(tempDir);
+  return rc;
+}
+
 static std::string deriveOutputFileName(
     std::vector<std::string> &flagVect, std::string inputFilename) {
   // Get output file name.
@@ -62,20 +264,24 @@ ONNX_MLIR_EXPORT int64_t omCompileFromFile(const char *inputFilename,
     const char *flags, const char **outputFilename, const char **errorMessage) {
   // Process the flags, saving each space-separated text in a separate
   // entry in the string vector flagVect.
-  std::vector<std::string> flagVect;
-  const char *str = flags;
-  do {
-    // Get rid of leading spaces.
-    while (*str && std::isspace(*str))
-      ++str;
-    // Save current location and advance while useful chars.
-    const char *begin = str;
-    while (*str && !std::isspace(*str))
-      ++str;
-    // If not empty, copy new entry into flagVec.
-    if (begin != str)
-      flagVect.push_back(std::string(begin, str));
-  } while (*str);
+  std::vector<std::string> flagVect = splitFlags(flags);
+  std::string inputFilenameStr(inputFilename);
+#if !defined(_WIN32)
+  // Send the compile to the onnx-mlir daemon if any, or else run onnx-mlir.
+  const auto &daemonSocket = getEnvVar("ONNX_MLIR_DAEMON_SOCKET");
+  if (daemonSocket) {
+    std::vector<std::string> args(flagVect);
+    args.push_back(inputFilenameStr);
+    int rc = compileWithDaemon(daemonSocket.value(), args);
+    if (rc >= 0) {
+      if (rc == CompilerSuccess && outputFilename) {
+        std::string name = deriveOutputFileName(flagVect, inputFilenameStr);
+        *outputFilename = strdup(name.c_str());
+      }
+      return rc != 0 ? CompilerFailureInLLVMOpt : CompilerSuccess;
+    }
+  }
+#endif
   // Use 'onnx-mlir' command to compile the model.
   std::string onnxMlirPath;
   const auto &envDir = getEnvVar("ONNX_MLIR_BIN_PATH");
@@ -86,7 +292,6 @@ ONNX_MLIR_EXPORT int64_t omCompileFromFile(const char *inputFilename,
   Command onnxMlirCompile(onnxMlirPath);
   // Add flags and input flag.
   onnxMlirCompile.appendList(flagVect);
-  std::string inputFilenameStr(inputFilename);
   onnxMlirCompile.appendStr(inputFilenameStr);
   // Run command.
   int rc = onnxMlirCompile.exec();
@@ -101,27 +306,78 @@ ONNX_MLIR_EXPORT int64_t omCompileFromArray(const void *inputBuffer,
     int64_t bufferSize, const char *outputBaseName,
     EmissionTargetType emissionTarget, const char **outputFilename,
     const char **errorMessage) {
-  mlir::OwningOpRef<mlir::ModuleOp> module;
-  mlir::MLIRContext context;
-  registerDialects(context);
+  std::lock_guard<std::mutex> lock(compilerOptionsMutex);
+  // No flags are given, the options are the ones currently set in the
+  // process.
+  std::vector<std::string> options;
+  for (OptionKind kind :
+      {TargetAccel, CompilerOptLevel, OPTFlag, LLCFlag, LLVMFlag})
+    options.emplace_back(getCompilerOption(kind));
+  return compileFromArray(inputBuffer, bufferSize, outputBaseName,
+      emissionTarget, options, /*threadPool=*/nullptr, outputFilename,
+      errorMessage);
+}
 
+ONNX_MLIR_EXPORT int64_t omCompileFromArrayToBuffer(const void *inputBuffer,
+    int64_t bufferSize, void **outputBuffer, int64_t *outputBufferSize,
+    const char **errorMessage) {
+  std::lock_guard<std::mutex> lock(compilerOptionsMutex);
+  std::vector<std::string> options;
+  for (OptionKind kind :
+      {TargetAccel, CompilerOptLevel, OPTFlag, LLCFlag, LLVMFlag})
+    options.emplace_back(getCompilerOption(kind));
+  return compileToBuffer(inputBuffer, bufferSize, options,
+      /*threadPool=*/nullptr, outputBuffer, outputBufferSize, errorMessage);
+}
+
+ONNX_MLIR_EXPORT OMCompileSession *omCompileSessionCreate(
+    const char *flags, const char **errorMessage) {
+  std::vector<std::string> flagVect = splitFlags(flags);
+  // Check the flags now rather than at each compile.
+  std::lock_guard<std::mutex> lock(compilerOptionsMutex);
   std::string internalErrorMessage;
-  int rc = processInputArray(
-      inputBuffer, bufferSize, context, module, &internalErrorMessage);
-  if (rc != CompilerSuccess) {
+  bool valid = setCompilerOptionsFromFlags(flagVect, internalErrorMessage);
+  llvm::cl::ResetAllOptionOccurrences();
+  if (!valid) {
     if (errorMessage != NULL)
       *errorMessage = strdup(internalErrorMessage.c_str());
-    return rc;
+    return nullptr;
   }
+  return new OMCompileSession(std::move(flagVect));
+}
 
-  std::string outputBaseNameStr(outputBaseName);
-  rc = compileModule(module, context, outputBaseNameStr, emissionTarget);
-  if (rc == CompilerSuccess && outputFilename) {
-    // Copy Filename
-    std::string name = getTargetFilename(outputBaseNameStr, emissionTarget);
-    *outputFilename = strdup(name.c_str());
+ONNX_MLIR_EXPORT int64_t omCompileSessionCompileFromArray(
+    OMCompileSession *session, const void *inputBuffer, int64_t bufferSize,
+    const char *outputBaseName, EmissionTargetType emissionTarget,
+    const char **outputFilename, const char **errorMessage) {
+  std::lock_guard<std::mutex> lock(compilerOptionsMutex);
+  std::string internalErrorMessage;
+  if (!setCompilerOptionsFromFlags(session->flags, internalErrorMessage)) {
+    if (errorMessage != NULL)
+      *errorMessage = strdup(internalErrorMessage.c_str());
+    return InvalidCompilerOption;
   }
-  return rc;
+  return compileFromArray(inputBuffer, bufferSize, outputBaseName,
+      emissionTarget, session->flags, &session->threadPool, outputFilename,
+      errorMessage);
+}
+
+ONNX_MLIR_EXPORT int64_t omCompileSessionCompileFromArrayToBuffer(
+    OMCompileSession *session, const void *inputBuffer, int64_t bufferSize,
+    void **outputBuffer, int64_t *outputBufferSize, const char **errorMessage) {
+  std::lock_guard<std::mutex> lock(compilerOptionsMutex);
+  std::string internalErrorMessage;
+  if (!setCompilerOptionsFromFlags(session->flags, internalErrorMessage)) {
+    if (errorMessage != NULL)
+      *errorMessage = strdup(internalErrorMessage.c_str());
+    return InvalidCompilerOption;
+  }
+  return compileToBuffer(inputBuffer, bufferSize, session->flags,
+      &session->threadPool, outputBuffer, outputBufferSize, errorMessage);
+}
+
+ONNX_MLIR_EXPORT void omCompileSessionDestroy(OMCompileSession *session) {
+  delete session;
 }
 
 } // extern C
@@ -29,12 +29,85 @@
 #include "src/Conversion/KrnlSeqToMemref/ConvertSeqToMemref.hpp"
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Support/KrnlSupport.hpp"
 
 using namespace mlir;
 
 namespace onnx_mlir {
 namespace krnl {
 
+Value allocSeqElement(
+    OpBuilder &builder, Location loc, MemRefType type, ValueRange dynSymbols) {
+  MultiDialectBuilder<LLVMBuilder, MathBuilder, MemRefBuilder> create(
+      builder, loc);
+  // Allocate the header and the data in a single buffer.
+  Value size = create.math.constantIndex(getMemRefEltSizeInBytes(type));
+  for (unsigned i = 0, d = 0; i < type.getShape().size(); ++i) {
+    Value dimSize = type.isDynamicDim(i)
+                        ? dynSymbols[d++]
+                        : create.math.constantIndex(type.getShape()[i]);
+    size = create.math.mul(size, dimSize);
+  }
+  Value bufferSize =
+      create.math.add(size, create.math.constantIndex(gSeqElementHeaderSize));
+  MemRefType bufferType =
+      MemRefType::get({ShapedType::kDynamic}, builder.getI8Type());
+  Value buffer = create.mem.alignedAlloc(bufferType, {bufferSize});
+  // The view shares the allocated pointer of the buffer, so that deallocating
+  // the element deallocates the whole buffer.
+  MemRefType elementType =
+      MemRefType::get(type.getShape(), type.getElementType());
+  Value element =
+      create.mem.view(buffer, gSeqElementHeaderSize, elementType, dynSymbols);
+  MemRefType countType = MemRefType::get({}, builder.getI64Type());
+  Value count = create.mem.view(buffer, 0, countType, {});
+  builder.create<memref::StoreOp>(
+      loc, create.math.constant(builder.getI64Type(), 1), count);
+  return element;
+}
+
+// Return the address of the reference count of an element.
+static Value getSeqElementCountAddr(
+    OpBuilder &builder, Location loc, Value element) {
+  MultiDialectBuilder<LLVMBuilder, MathBuilder> create(builder, loc);
+  Value dataAddr =
+      builder.create<memref::ExtractAlignedPointerAsIndexOp>(loc, element);
+  Value countAddr = create.math.sub(
+      dataAddr, create.math.constantIndex(gSeqElementHeaderSize));
+  Type i64Type = builder.getI64Type();
+  return create.llvm.inttoptr(LLVM::LLVMPointerType::get(i64Type),
+      create.math.cast(i64Type, countAddr));
+}
+
+void retainSeqElement(OpBuilder &builder, Location loc, Value element) {
+  MultiDialectBuilder<LLVMBuilder, MathBuilder> create(builder, loc);
+  Value countAddr = getSeqElementCountAddr(builder, loc, element);
+  Value count = create.llvm.load(countAddr);
+  Value one = create.math.constant(builder.getI64Type(), 1);
+  create.llvm.store(create.math.add(count, one), countAddr);
+}
+
+void releaseSeqElement(OpBuilder &builder, Location loc, Value element) {
+  MultiDialectBuilder<LLVMBuilder, MathBuilder> create(builder, loc);
+  Value countAddr = getSeqElementCountAddr(builder, loc, element);
+  Value count = create.math.sub(create.llvm.load(countAddr),
+      create.math.constant(builder.getI64Type(), 1));
+  Value isLast =
+      create.math.eq(count, create.math.constant(builder.getI64Type(), 0));
+  builder.create<scf::IfOp>(
+      loc, isLast,
+      [&](OpBuilder &thenBuilder, Location thenLoc) {
+        MultiDialectBuilder<MemRefBuilder> create(thenBuilder, thenLoc);
+        create.mem.dealloc(element);
+        thenBuilder.create<scf::YieldOp>(thenLoc);
+      },
+      [&](OpBuilder &elseBuilder, Location elseLoc) {
+        MultiDialectBuilder<LLVMBuilder> create(elseBuilder, elseLoc);
+        create.llvm.store(count, countAddr);
+        elseBuilder.create<scf::YieldOp>(elseLoc);
+      });
+}
+
 struct ConvertSeqToMemrefPass
     : public PassWrapper<ConvertSeqToMemrefPass, OperationPass<func::FuncOp>> {
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ConvertSeqToMemrefPass)
@@ -45,6 +118,10 @@ struct ConvertSeqToMemrefPass
     return "Lower Krnl Seq ops to memref dialect.";
   }
 
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<LLVM::LLVMDialect>();
+  }
+
   void runOnOperation() final;
 };
 
@@ -64,7 +141,8 @@ void ConvertSeqToMemrefPass::runOnOperation() {
   target.addIllegalOp<KrnlSeqStoreOp>();
   target.addLegalDialect<mlir::AffineDialect, mlir::arith::ArithDialect,
       mlir::memref::MemRefDialect, mlir::func::FuncDialect,
-      mlir::vector::VectorDialect, mlir::scf::SCFDialect>();
+      mlir::vector::VectorDialect, mlir::scf::SCFDialect,
+      mlir::LLVM::LLVMDialect>();
 
   // Now that the conversion target has been defined, we just need to provide
   // the set of patterns that will lower the frontend operations.
@@ -15,12 +15,32 @@
 #pragma once
 
 #include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "src/Pass/Passes.hpp"
 #include "src/Support/Common.hpp"
 
 namespace onnx_mlir {
 namespace krnl {
 
+// The elements of the sequences are reference counted, so that the sequences
+// built from other sequences share their elements instead of copying them. The
+// i64 count is stored in a header preceding the data of each element, which is
+// as large as the alignment of the allocations so as to keep the data aligned.
+static constexpr int64_t gSeqElementHeaderSize = gDefaultAllocAlign;
+
+// Allocate an element of the given type referenced once.
+mlir::Value allocSeqElement(mlir::OpBuilder &builder, mlir::Location loc,
+    mlir::MemRefType type, mlir::ValueRange dynSymbols);
+
+// Add a reference to an element stored into a sequence.
+void retainSeqElement(
+    mlir::OpBuilder &builder, mlir::Location loc, mlir::Value element);
+
+// Remove a reference to an element of a sequence, deallocating the element
+// when it was the last one.
+void releaseSeqElement(
+    mlir::OpBuilder &builder, mlir::Location loc, mlir::Value element);
+
 void populateLoweringKrnlSeqAllocOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx);
 
@@ -18,6 +18,7 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 
+#include "src/Conversion/KrnlSeqToMemref/ConvertSeqToMemref.hpp"
 #include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
@@ -51,11 +52,9 @@ public:
         create.math.constantIndex(1), ValueRange(),
         [&](OpBuilder &bodyBuilder, Location bodyLoc, Value forInduction,
             ValueRange iterArgs) {
-          MultiDialectBuilder<MathBuilder, MemRefBuilder> create(
-              bodyBuilder, bodyLoc);
           auto element = bodyBuilder.create<memref::LoadOp>(
               bodyLoc, operandAdaptor.getInputSequence(), forInduction);
-          create.mem.dealloc(element);
+          releaseSeqElement(bodyBuilder, bodyLoc, element);
           bodyBuilder.create<scf::YieldOp>(bodyLoc);
         });
 
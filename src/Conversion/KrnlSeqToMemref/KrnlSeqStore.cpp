@@ -16,6 +16,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 
+#include "src/Conversion/KrnlSeqToMemref/ConvertSeqToMemref.hpp"
 #include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
@@ -40,19 +41,27 @@ public:
   LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const override {
     KrnlSeqStoreOpAdaptor operandAdaptor(operands);
+    KrnlSeqStoreOp thisOp = dyn_cast<KrnlSeqStoreOp>(op);
     Location loc = op->getLoc();
     MultiDialectBuilder<MathBuilder, MemRefBuilder> create(rewriter, loc);
 
-    // Allocate a new tensor and copy input tensor into it
-    auto inputType = operandAdaptor.getInput().getType().cast<MemRefType>();
-    SmallVector<mlir::Value, 4> allocParams;
-    for (size_t i = 0; i < inputType.getShape().size(); i++) {
-      if (inputType.isDynamicDim(i)) {
-        allocParams.emplace_back(create.mem.dim(operandAdaptor.getInput(), i));
+    Value alloc = operandAdaptor.getInput();
+    if (thisOp.getCopy() == 0) {
+      // Share the element of another sequence.
+      retainSeqElement(rewriter, loc, alloc);
+    } else {
+      // Allocate a new tensor and copy input tensor into it
+      auto inputType = operandAdaptor.getInput().getType().cast<MemRefType>();
+      SmallVector<mlir::Value, 4> allocParams;
+      for (size_t i = 0; i < inputType.getShape().size(); i++) {
+        if (inputType.isDynamicDim(i)) {
+          allocParams.emplace_back(
+              create.mem.dim(operandAdaptor.getInput(), i));
+        }
       }
+      alloc = allocSeqElement(rewriter, loc, inputType, allocParams);
+      rewriter.create<memref::CopyOp>(loc, operandAdaptor.getInput(), alloc);
     }
-    Value alloc = create.mem.alignedAlloc(inputType, allocParams);
-    rewriter.create<memref::CopyOp>(loc, operandAdaptor.getInput(), alloc);
 
     // Cast the input tensor to the element type of the sequence
     auto seq = operandAdaptor.getSeq();
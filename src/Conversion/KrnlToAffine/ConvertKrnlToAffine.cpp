@@ -437,15 +437,16 @@ static void removeOps(llvm::SmallPtrSetImpl<Operation *> &opsToErase) {
 
 static LogicalResult interpretOperation(Operation *op, OpBuilder &builder,
     llvm::SmallDenseMap<Value, AffineForOp, 4> &loopRefToOp,
-    llvm::SmallPtrSetImpl<Operation *> &opsToErase, LoopBodyMover &mover) {
+    llvm::SmallPtrSetImpl<Operation *> &opsToErase, LoopBodyMover &mover,
+    UnrollAndJamList &unrollJamLoops) {
   // Recursively interpret nested operations.
   for (auto &region : op->getRegions())
     for (auto &block : region.getBlocks()) {
       auto &blockOps = block.getOperations();
       for (auto itr = blockOps.begin(); itr != blockOps.end();) {
         LLVM_DEBUG(llvm::dbgs() << DEBUG_TYPE << " Call interpretOperation \n");
-        if (failed(interpretOperation(
-                &(*itr), builder, loopRefToOp, opsToErase, mover)))
+        if (failed(interpretOperation(&(*itr), builder, loopRefToOp,
+                opsToErase, mover, unrollJamLoops)))
           return failure();
         else
           ++itr;
@@ -562,6 +563,15 @@ static LogicalResult interpretOperation(Operation *op, OpBuilder &builder,
     assert(succeeded(res) && "failed to unroll");
     opsToErase.insert(op);
     return success();
+  } else if (auto unrollJamOp = dyn_cast_or_null<KrnlUnrollJamOp>(op)) {
+    LLVM_DEBUG(llvm::dbgs() << DEBUG_TYPE << " interpret unroll jam op "
+                            << unrollJamOp << "\n");
+    // The loop body is only moved under the affine for loop at the end, so
+    // the loop is unrolled and jammed once the function is lowered.
+    unrollJamLoops.emplace_back(loopRefToOp[unrollJamOp.getLoop()],
+        unrollJamOp.getFactorAttr().getInt());
+    opsToErase.insert(op);
+    return success();
   }
 
   return success();
@@ -645,8 +655,9 @@ void ConvertKrnlToAffinePass::runOnOperation() {
   // only erase after iteration completes.
   llvm::SmallDenseMap<Value, AffineForOp, 4> loopRefToOp;
   llvm::SmallPtrSet<Operation *, 4> opsToErase;
+  UnrollAndJamList unrollJamLoops;
   if (failed(interpretOperation(
-          funcOp, builder, loopRefToOp, opsToErase, mover))) {
+          funcOp, builder, loopRefToOp, opsToErase, mover, unrollJamLoops))) {
     signalPassFailure();
     return;
   }
@@ -719,6 +730,13 @@ void ConvertKrnlToAffinePass::runOnOperation() {
     assert(succeeded(res) && "failed to optimize");
   }
 
+  // Loops of krnl.unroll_jam ops, left as is when their inner loops have
+  // bounds depending on them.
+  for (auto record : unrollJamLoops)
+    if (failed(loopUnrollJamUpToFactor(record.first, record.second)))
+      LLVM_DEBUG(llvm::dbgs() << DEBUG_TYPE << " cannot unroll and jam loop "
+                              << record.first << "\n");
+
   {
     const std::lock_guard<std::mutex> lock(unrollAndJamMutex);
     unrollAndJamMap.erase(currFuncOp);
@@ -737,6 +755,7 @@ void populateKrnlToAffineConversion(TypeConverter &typeConverter,
       typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlCopyToBufferOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlLoadOpPattern(typeConverter, patterns, ctx);
+  krnl::populateLoweringKrnlPrefetchOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlStoreOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlMatmultOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlMemsetOpPattern(typeConverter, patterns, ctx);
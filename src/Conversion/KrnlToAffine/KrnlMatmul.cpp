@@ -69,6 +69,21 @@ static IndexExpr partialTrip(IndexExpr UB, IndexExpr block, IndexExpr GI) {
   return UB - GI;
 }
 
+// Widen the loaded element(s) of B to the type of the computations, when B is
+// stored in a narrower type, e.g. f16 or bf16 weights of an f32 matmul, or
+// the signed integers of its quantized weights.
+static Value widenB(AffineBuilderKrnlMem &createAffine, Type type, Value b) {
+  if (b.getType() == type)
+    return b;
+  return MathBuilder(createAffine).cast(type, b);
+}
+
+// Return the type of the vectors of B loaded for vectors of vecType.
+static VectorType getBVectorType(Value B, VectorType vecType) {
+  return VectorType::get(
+      vecType.getShape(), B.getType().cast<MemRefType>().getElementType());
+}
+
 // KrnlMatmul will be lowered to vector and affine expressions
 class KrnlMatmulLowering : public ConversionPattern {
 public:
@@ -350,7 +365,8 @@ private:
                     [&](AffineBuilderKrnlMem &createAffine, Value k) {
                       MathBuilder createMath(createAffine);
                       Value a = createAffine.loadIE(A, aStart, {i, k});
-                      Value b = createAffine.loadIE(B, bStart, {k, j});
+                      Value b = widenB(createAffine, elementType,
+                          createAffine.loadIE(B, bStart, {k, j}));
                       Value res = createMath.mul(a, b);
                       res = createMath.add(
                           res, createAffine.load(TmpC, tmpCAccess));
@@ -419,7 +435,9 @@ private:
           // Iterates over the I indices (K is SIMD dim).
           // First compute A[i,k]*B[k, 1] for i=0..iUnrollFactor explicitly.
           // We reuse B[k][0] vector for each iteration of i.
-          Value vb = create.vec.loadIE(vecType, B, bStart, {k, iZero});
+          Value vb = widenB(createAffine, vecType,
+              create.vec.loadIE(
+                  getBVectorType(B, vecType), B, bStart, {k, iZero}));
           // Generate computation for each i, manually unrolled for simplicity.
           for (int64_t i = 0; i < iUnrollFactor; ++i) {
             Value iVal = create.math.constantIndex(i);
@@ -502,7 +520,9 @@ private:
                 kSaved = k;
                 Value a = createAffine.loadIE(A, aStart, {i, k});
                 Value va = create.vec.broadcast(vecType, a);
-                Value vb = create.vec.loadIE(vecType, B, bStart, {k, iZero});
+                Value vb = widenB(createAffine, vecType,
+                    create.vec.loadIE(
+                        getBVectorType(B, vecType), B, bStart, {k, iZero}));
                 // TTmpC() = vector_fma(va, vb, TTmpC());
                 Value tmpVal = createAffine.load(TmpC, tmpCAccess);
                 Value res = create.vec.fma(va, vb, tmpVal);
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------- KrnlPrefetch.cpp - Lower KrnlPrefetchOp ---------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the KrnlPrefetchOp operator.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinTypes.h"
+
+#include "src/Conversion/KrnlToAffine/ConvertKrnlToAffine.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "krnl_to_affine"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace krnl {
+
+/// KrnlPrefetch will be lowered to memref.prefetch or affine.prefetch,
+/// depending on whether the access indices are all affine maps or not.
+class KrnlPrefetchLowering : public ConversionPattern {
+public:
+  explicit KrnlPrefetchLowering(
+      TypeConverter &typeConverter, MLIRContext *context)
+      : ConversionPattern(
+            typeConverter, KrnlPrefetchOp::getOperationName(), 1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto prefetchOp = cast<KrnlPrefetchOp>(op);
+    KrnlPrefetchOpAdaptor operandAdaptor(prefetchOp);
+
+    // Prepare inputs.
+    Value memref = operandAdaptor.getMemref();
+    SmallVector<Value, 4> indices = operandAdaptor.getIndices();
+    bool isWrite = prefetchOp.getIsWrite();
+    unsigned locality = prefetchOp.getLocalityHint();
+
+    // Check whether all indices are affine maps or not.
+    bool affineIndices =
+        !llvm::any_of(indices, [](Value v) { return !isValidDim(v); });
+
+    if (affineIndices) {
+      AffineMap map = rewriter.getMultiDimIdentityMap(indices.size());
+      rewriter.replaceOpWithNewOp<AffinePrefetchOp>(op, memref, map, indices,
+          isWrite, locality, /*isDataCache=*/true);
+    } else {
+      rewriter.replaceOpWithNewOp<memref::PrefetchOp>(
+          op, memref, indices, isWrite, locality, /*isDataCache=*/true);
+    }
+
+    return success();
+  }
+};
+
+void populateLoweringKrnlPrefetchOpPattern(TypeConverter &typeConverter,
+    RewritePatternSet &patterns, MLIRContext *ctx) {
+  patterns.insert<KrnlPrefetchLowering>(typeConverter, ctx);
+}
+
+} // namespace krnl
+} // namespace onnx_mlir
@@ -19,6 +19,7 @@
 #include "src/Conversion/KrnlToAffine/ConvertKrnlToAffine.hpp"
 #include "src/Conversion/KrnlToLLVM/RuntimeAPI.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "krnl_to_affine"
@@ -29,7 +30,9 @@ namespace onnx_mlir {
 namespace krnl {
 
 /// KrnlStore will be lowered to std.store or affine.store, depending on whether
-/// the access indices are all affine maps or not.
+/// the access indices are all affine maps or not. A nontemporal KrnlStore is
+/// lowered to a std.store marked by the gNontemporalAttrName attribute, lowered
+/// by KrnlToLLVM.
 class KrnlStoreLowering : public ConversionPattern {
 public:
   explicit KrnlStoreLowering(TypeConverter &typeConverter, MLIRContext *context)
@@ -50,10 +53,15 @@ public:
     bool affineIndices =
         !llvm::any_of(indices, [](Value v) { return !isValidDim(v); });
 
-    if (affineIndices)
+    if (storeOp.getNontemporal()) {
+      auto nontemporalStoreOp = rewriter.replaceOpWithNewOp<memref::StoreOp>(
+          op, value, memref, indices);
+      nontemporalStoreOp->setAttr(gNontemporalAttrName, rewriter.getUnitAttr());
+    } else if (affineIndices) {
       rewriter.replaceOpWithNewOp<AffineStoreOp>(op, value, memref, indices);
-    else
+    } else {
       rewriter.replaceOpWithNewOp<memref::StoreOp>(op, value, memref, indices);
+    }
 
     return success();
   }
@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--- ConstantsCompression.cpp - Compression of the Constants File -----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements the compression of the sections of the file storing
+// the constants of a model, as chunks in the LZ4 block format, which is simple
+// enough for the runtime to decompress without any library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/KrnlToLLVM/ConstantsCompression.hpp"
+
+#include "llvm/Support/Parallel.h"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace onnx_mlir {
+namespace krnl {
+
+namespace {
+
+// Chunk of a section, with its stored data once compressed.
+struct Chunk {
+  const char *data;
+  int64_t size;
+  int64_t stride;
+  std::vector<char> stored;
+};
+
+// Constraints of the LZ4 block format: a match is at least 4 bytes long and
+// at most 65535 bytes back, the last 5 bytes are literals and the last match
+// starts at least 12 bytes before the end of the block.
+const int64_t kMinMatch = 4;
+const int64_t kMaxOffset = 65535;
+const int64_t kLastLiterals = 5;
+const int64_t kMatchLimit = 12;
+const int kHashLog = 16;
+
+uint32_t read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Append the LZ4 block of the size bytes of src to dst, with greedy matches
+// found through a hash table of the last position of each 4-byte sequence.
+// The search skips faster through the data without matches.
+void compressLZ4(const uint8_t *src, int64_t size, std::vector<char> &dst) {
+  auto emitLength = [&](int64_t length) {
+    for (; length >= 255; length -= 255)
+      dst.push_back((char)255);
+    dst.push_back((char)length);
+  };
+  auto emitSequence = [&](int64_t anchor, int64_t literals, int64_t offset,
+                          int64_t matchLength) {
+    uint8_t token = (uint8_t)(std::min<int64_t>(literals, 15) << 4);
+    if (matchLength > 0)
+      token |= (uint8_t)std::min<int64_t>(matchLength - kMinMatch, 15);
+    dst.push_back((char)token);
+    if (literals >= 15)
+      emitLength(literals - 15);
+    dst.insert(dst.end(), src + anchor, src + anchor + literals);
+    if (matchLength == 0)
+      return;
+    dst.push_back((char)(offset & 0xff));
+    dst.push_back((char)(offset >> 8));
+    if (matchLength - kMinMatch >= 15)
+      emitLength(matchLength - kMinMatch - 15);
+  };
+
+  int64_t anchor = 0;
+  if (size > kMatchLimit) {
+    std::vector<int64_t> table(1 << kHashLog, -1);
+    int64_t misses = 0;
+    for (int64_t pos = 0; pos + kMatchLimit <= size;) {
+      uint32_t sequence = read32(src + pos);
+      uint32_t hash = (sequence * 2654435761u) >> (32 - kHashLog);
+      int64_t candidate = table[hash];
+      table[hash] = pos;
+      if (candidate < 0 || pos - candidate > kMaxOffset ||
+          read32(src + candidate) != sequence) {
+        pos += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+      int64_t length = kMinMatch;
+      while (pos + length < size - kLastLiterals &&
+             src[candidate + length] == src[pos + length])
+        ++length;
+      emitSequence(anchor, pos - anchor, pos - candidate, length);
+      pos += length;
+      anchor = pos;
+    }
+  }
+  emitSequence(anchor, size - anchor, 0, 0);
+}
+
+// Set the stored data of the chunk, its shuffled bytes compressed if that
+// makes them smaller.
+void compressChunk(Chunk &chunk) {
+  std::vector<char> bytes(chunk.size, 0);
+  if (chunk.data && chunk.stride > 1) {
+    int64_t numElements = chunk.size / chunk.stride;
+    for (int64_t i = 0; i < numElements; ++i)
+      for (int64_t b = 0; b < chunk.stride; ++b)
+        bytes[b * numElements + i] = chunk.data[i * chunk.stride + b];
+  } else if (chunk.data) {
+    memcpy(bytes.data(), chunk.data, chunk.size);
+  }
+  compressLZ4(reinterpret_cast<const uint8_t *>(bytes.data()), chunk.size,
+      chunk.stored);
+  if ((int64_t)chunk.stored.size() >= chunk.size)
+    chunk.stored = std::move(bytes);
+}
+
+} // namespace
+
+void compressConstantsSection(llvm::ArrayRef<ConstantsSegment> segments,
+    llvm::SmallVectorImpl<char> &out) {
+  std::vector<Chunk> chunks;
+  for (const ConstantsSegment &segment : segments) {
+    assert(segment.size % segment.stride == 0 &&
+           "Expecting segments made of whole elements");
+    for (int64_t offset = 0; offset < segment.size;
+         offset += CONSTANTS_COMPRESSION_CHUNK_SIZE) {
+      int64_t size = std::min<int64_t>(
+          CONSTANTS_COMPRESSION_CHUNK_SIZE, segment.size - offset);
+      chunks.push_back({segment.data ? segment.data + offset : nullptr, size,
+          segment.stride, {}});
+    }
+  }
+  llvm::parallelFor(
+      0, chunks.size(), [&](size_t i) { compressChunk(chunks[i]); });
+
+  auto append = [&](uint64_t value) {
+    out.append(reinterpret_cast<const char *>(&value),
+        reinterpret_cast<const char *>(&value) + sizeof(value));
+  };
+  append(chunks.size());
+  for (const Chunk &chunk : chunks) {
+    append(chunk.size);
+    append(chunk.stored.size());
+    append(chunk.stride);
+  }
+  for (const Chunk &chunk : chunks)
+    out.append(chunk.stored.begin(), chunk.stored.end());
+}
+
+} // namespace krnl
+} // namespace onnx_mlir
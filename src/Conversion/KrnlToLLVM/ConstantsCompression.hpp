@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--- ConstantsCompression.hpp - Compression of the Constants File -----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file declares the compression of the sections of the file storing the
+// constants of a model, which the runtime decompresses at their first use.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstdint>
+
+namespace onnx_mlir {
+namespace krnl {
+
+// Maximum size in bytes of the uncompressed data of a chunk of a compressed
+// section, the chunks of a section being decompressed in parallel.
+const int64_t CONSTANTS_COMPRESSION_CHUNK_SIZE = 1 << 20;
+
+/// Consecutive bytes of the data of a section, whose bytes are shuffled
+/// before they are compressed when stride is more than 1: the bytes of each
+/// element of stride bytes are then stored apart, all the first bytes of the
+/// elements coming first, then all their second bytes, and so on, which
+/// groups the exponent bytes of floats and makes them compress better. A
+/// segment of null data is made of zeros.
+struct ConstantsSegment {
+  const char *data;
+  int64_t size;
+  int64_t stride;
+};
+
+/// Append to \p out the compressed section made of \p segments, in order. The
+/// section starts with its number of chunks N and with a table of N entries
+/// of three 64-bit integers, the size of the uncompressed data of each chunk,
+/// the size of its stored data and its stride, followed by the stored data of
+/// the chunks, in order. The stored data of a chunk is an LZ4 block, or the
+/// shuffled bytes of the chunk when its stored size is its uncompressed size.
+/// The integers are in the byte order of the host, as are the constants. The
+/// chunks are split out of the segments and compressed in parallel.
+void compressConstantsSection(llvm::ArrayRef<ConstantsSegment> segments,
+    llvm::SmallVectorImpl<char> &out);
+
+} // namespace krnl
+} // namespace onnx_mlir
@@ -32,20 +32,31 @@
 #include "mlir/Dialect/Func/Transforms/Passes.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/Math/Transforms/Passes.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/MemRef/Transforms/Passes.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Vector/Transforms/VectorRewritePatterns.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Target/LLVMIR/ModuleTranslation.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "onnx/onnx_pb.h"
 
 #include "src/Accelerators/Accelerator.hpp"
+#include "src/Conversion/KrnlToLLVM/ConstantsCompression.hpp"
 #include "src/Conversion/KrnlToLLVM/ConvertKrnlToLLVM.hpp"
 #include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
 #include "src/Conversion/KrnlToLLVM/RuntimeAPI.hpp"
@@ -53,6 +64,7 @@
 #include "src/Dialect/Krnl/KrnlOps.hpp"
 #include "src/Pass/Passes.hpp"
 #include "src/Support/Common.hpp"
+#include "src/Support/KrnlSupport.hpp"
 
 using namespace mlir;
 
@@ -69,8 +81,8 @@ uint64_t KRNL_ENTRY_POINT_ID = 0;
 // The result determines whether the returned tensor owns the storage
 // It is assumed that bufferization dealloc pass already added bufferization
 // clone when necessary.
-// Currently, the ViewLikeOp and arith.select are traced back. Any other
-// cases? A general solution is suggested in issue#2033
+// Currently, the ViewLikeOp, arith.select, scf.if and func.call are traced
+// back. Any other cases? A general solution is suggested in issue#2033
 // If this function returns a false positive, seg fault may occur when the
 // storage is freed.
 // If this function returns false negative, memory leak may occur.
@@ -85,8 +97,8 @@ static bool shouldOwn(Value v) {
     // If output is just a view, trace back to find which op was producing the
     // source memref.
     while (auto viewOp = llvm::dyn_cast<ViewLikeOpInterface>(definingOp)) {
-      Value source = viewOp.getViewSource();
-      definingOp = source.getDefiningOp();
+      v = viewOp.getViewSource();
+      definingOp = v.getDefiningOp();
       // Block argument, stop.
       if (!definingOp)
         break;
@@ -104,72 +116,221 @@ static bool shouldOwn(Value v) {
       // which will focus on this problem.
       result = shouldOwn(selectOp.getTrueValue()) &&
                shouldOwn(selectOp.getFalseValue());
+    } else if (auto ifOp = llvm::dyn_cast<scf::IfOp>(definingOp)) {
+      // The value comes from either branch, e.g. in the dispatch of an entry
+      // point function to its shape specializations.
+      unsigned index = v.cast<OpResult>().getResultNumber();
+      result = shouldOwn(ifOp.thenYield().getOperand(index)) &&
+               shouldOwn(ifOp.elseYield().getOperand(index));
+    } else if (auto callOp = llvm::dyn_cast<func::CallOp>(definingOp)) {
+      // The value is returned by the callee. An argument of the callee is an
+      // input of the caller too, and is not owned.
+      auto funcOp = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+          callOp, callOp.getCalleeAttr());
+      if (!funcOp || funcOp.getBody().empty())
+        result = false;
+      else {
+        unsigned index = v.cast<OpResult>().getResultNumber();
+        funcOp.walk([&](func::ReturnOp returnOp) {
+          result = result && shouldOwn(returnOp.getOperand(index));
+        });
+      }
     }
   }
   return result;
 }
 
 void determineOwnershipForOutputOMTensors(
-    ModuleOp &module, SmallVectorImpl<bool> &outputOMTensorOwnerships) {
-  Operation *entryPointOp;
-  auto walkResult = module->walk([&](mlir::Operation *op) -> WalkResult {
-    if (llvm::dyn_cast<KrnlEntryPointOp>(op)) {
-      entryPointOp = op;
-      return WalkResult::interrupt();
+    ModuleOp &module, OutputOMTensorOwnerships &outputOMTensorOwnerships) {
+  module->walk([&](KrnlEntryPointOp entryPointOp) {
+    // Get entry function name.
+    StringRef entryPointFuncName =
+        entryPointOp
+            ->getAttrOfType<SymbolRefAttr>(
+                KrnlEntryPointOp::getEntryPointFuncAttrName())
+            .getLeafReference()
+            .getValue();
+
+    // Get entry function op.
+    auto entryFunc = module.lookupSymbol<func::FuncOp>(entryPointFuncName);
+    assert(entryFunc && "Entry function not found");
+
+    // Get ReturnOp of the entry function op.
+    Operation *returnOp;
+    entryFunc->walk([&](Operation *op) -> WalkResult {
+      if (llvm::dyn_cast<func::ReturnOp>(op)) {
+        returnOp = op;
+        return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+
+    // Check, for each output, if it was transitively produced by a constant
+    // or a block argument.
+    SmallVector<bool, 4> &ownerships =
+        outputOMTensorOwnerships[entryPointFuncName];
+    for (Value v : returnOp->getOperands()) {
+      bool shouldOwnResult = shouldOwn(v);
+      ownerships.emplace_back(shouldOwnResult);
+      LLVM_DEBUG(llvm::dbgs()
+                 << "Should the OMTensor own the output of "
+                 << entryPointFuncName << "? " << shouldOwnResult << "\n");
     }
-    return WalkResult::advance();
   });
+}
 
-  // Do nothing if there is no EntryPoint.
-  if (!walkResult.wasInterrupted())
+void assumeAlignedEntryFunctionInputs(ModuleOp &module) {
+  KrnlEntryPointOp entryPointOp;
+  module->walk([&](KrnlEntryPointOp op) -> WalkResult {
+    entryPointOp = op;
+    return WalkResult::interrupt();
+  });
+  if (!entryPointOp)
     return;
-
-  // Get entry function name.
-  StringRef entryPointFuncName =
+  auto entryFunc = module.lookupSymbol<func::FuncOp>(
       entryPointOp
           ->getAttrOfType<SymbolRefAttr>(
               KrnlEntryPointOp::getEntryPointFuncAttrName())
-          .getLeafReference()
-          .getValue();
-
-  // Get entry function op.
-  Operation *entryFunc;
-  module->walk([&](func::FuncOp op) -> WalkResult {
-    if (SymbolRefAttr::get(op).getValue() == entryPointFuncName) {
-      entryFunc = op;
-      return WalkResult::interrupt();
-    }
-    return WalkResult::advance();
+          .getLeafReference());
+  if (!entryFunc || entryFunc.isExternal())
+    return;
+
+  // The assumptions are lowered to llvm.intr.assume on the aligned pointers of
+  // the inputs, from which LLVM infers the alignment of the vector accesses.
+  // The inputs are only read, but for the paged key/value caches written in
+  // place and returned as is, and no other pointer accesses their data, so
+  // that they are also noalias, which the lowering puts on their pointers.
+  // The function computing the results in output arguments, if any, takes the
+  // same inputs first, followed by the output arguments, which are not
+  // aligned.
+  auto assumeAlignedInputs = [](func::FuncOp funcOp, unsigned numInputs) {
+    OpBuilder builder(funcOp.getBody());
+    for (BlockArgument arg : funcOp.getArguments().take_front(numInputs))
+      if (arg.getType().isa<MemRefType>()) {
+        builder.create<memref::AssumeAlignmentOp>(
+            arg.getLoc(), arg, gDefaultAllocAlign);
+        funcOp.setArgAttr(arg.getArgNumber(),
+            LLVM::LLVMDialect::getNoAliasAttrName(), builder.getUnitAttr());
+      }
+  };
+  unsigned numInputs = entryFunc.getNumArguments();
+  assumeAlignedInputs(entryFunc, numInputs);
+  auto intoFunc = module.lookupSymbol<func::FuncOp>(
+      entryFunc.getName().str() + DYN_ENTRY_POINT_INTO_SUFFIX);
+  if (intoFunc && !intoFunc.isExternal())
+    assumeAlignedInputs(intoFunc, numInputs);
+}
+
+void assumeAlignedAllocs(ModuleOp &module) {
+  module->walk([](memref::AllocOp allocOp) {
+    std::optional<uint64_t> alignment = allocOp.getAlignment();
+    if (!alignment || !allocOp.getType().getLayout().isIdentity())
+      return;
+    OpBuilder builder(allocOp);
+    builder.setInsertionPointAfter(allocOp);
+    builder.create<memref::AssumeAlignmentOp>(
+        allocOp.getLoc(), allocOp.getResult(), *alignment);
   });
-  assert(entryFunc && "Entry function not found");
+}
 
-  // Get ReturnOp of the entry function op.
-  Operation *returnOp;
-  entryFunc->walk([&](Operation *op) -> WalkResult {
-    if (llvm::dyn_cast<func::ReturnOp>(op)) {
-      returnOp = op;
-      return WalkResult::interrupt();
+namespace {
+// Returns the object that a pointer, or an integer converted from a pointer,
+// is derived from: the result of a call to malloc, an llvm.alloca, an
+// llvm.mlir.addressof, or a pointer argument of the function. Returns null
+// for a value derived from no object, e.g. a constant, and std::nullopt when
+// the object is unknown, e.g. for a pointer loaded from memory or derived
+// from several objects.
+std::optional<Value> getUnderlyingObject(Value value, unsigned depth = 0) {
+  if (depth > 64)
+    return std::nullopt;
+  if (auto arg = value.dyn_cast<BlockArgument>()) {
+    if (arg.getOwner()->isEntryBlock() &&
+        arg.getType().isa<LLVM::LLVMPointerType>())
+      return value;
+    return std::nullopt;
+  }
+  Operation *op = value.getDefiningOp();
+  if (isa<LLVM::AllocaOp, LLVM::AddressOfOp>(op))
+    return value;
+  if (auto callOp = dyn_cast<LLVM::CallOp>(op)) {
+    std::optional<StringRef> callee = callOp.getCallee();
+    if (callee && (*callee == "malloc" || *callee == "aligned_alloc"))
+      return value;
+    return std::nullopt;
+  }
+  if (isa<LLVM::ConstantOp>(op))
+    return Value();
+  if (auto gepOp = dyn_cast<LLVM::GEPOp>(op))
+    return getUnderlyingObject(gepOp.getBase(), depth + 1);
+  if (isa<LLVM::BitcastOp, LLVM::AddrSpaceCastOp, LLVM::IntToPtrOp,
+          LLVM::PtrToIntOp>(op))
+    return getUnderlyingObject(op->getOperand(0), depth + 1);
+  // The aligned pointer of an alloc is computed with integer arithmetic on
+  // the allocated pointer.
+  if (isa<LLVM::AddOp, LLVM::SubOp, LLVM::AndOp, LLVM::URemOp>(op)) {
+    Value object;
+    for (Value operand : op->getOperands()) {
+      std::optional<Value> operandObject =
+          getUnderlyingObject(operand, depth + 1);
+      if (!operandObject ||
+          (object && *operandObject && *operandObject != object))
+        return std::nullopt;
+      if (*operandObject)
+        object = *operandObject;
     }
-    return WalkResult::advance();
-  });
+    return object;
+  }
+  // The pointers of a memref descriptor.
+  if (auto extractOp = dyn_cast<LLVM::ExtractValueOp>(op)) {
+    Value container = extractOp.getContainer();
+    while (auto insertOp = container.getDefiningOp<LLVM::InsertValueOp>()) {
+      ArrayRef<int64_t> insertPos = insertOp.getPosition();
+      ArrayRef<int64_t> extractPos = extractOp.getPosition();
+      if (insertPos == extractPos)
+        return getUnderlyingObject(insertOp.getValue(), depth + 1);
+      // A part of the value is inserted otherwise.
+      size_t commonSize = std::min(insertPos.size(), extractPos.size());
+      if (insertPos.take_front(commonSize) ==
+          extractPos.take_front(commonSize))
+        return std::nullopt;
+      container = insertOp.getContainer();
+    }
+  }
+  return std::nullopt;
+}
+} // namespace
 
-  // Check, for each output, if it was transitively produced by a constant or
-  // a block argument.
-  for (Value v : returnOp->getOperands()) {
-    bool shouldOwnResult = shouldOwn(v);
-    outputOMTensorOwnerships.emplace_back(shouldOwnResult);
-    LLVM_DEBUG(llvm::dbgs()
-               << "Should the OMTensor own the entry function output? "
-               << shouldOwnResult << "\n");
+void preserveAllocProvenance(ModuleOp &module) {
+  SmallVector<LLVM::IntToPtrOp, 8> intToPtrOps;
+  module->walk([&](LLVM::IntToPtrOp intToPtrOp) {
+    std::optional<Value> object = getUnderlyingObject(intToPtrOp.getArg());
+    if (object && *object && object->getDefiningOp<LLVM::CallOp>())
+      intToPtrOps.emplace_back(intToPtrOp);
+  });
+  for (LLVM::IntToPtrOp intToPtrOp : intToPtrOps) {
+    Value allocated = *getUnderlyingObject(intToPtrOp.getArg());
+    OpBuilder builder(intToPtrOp);
+    MultiDialectBuilder<LLVMBuilder> create(builder, intToPtrOp.getLoc());
+    Value addr = intToPtrOp.getArg();
+    Value allocatedInt = create.llvm.ptrtoint(addr.getType(), allocated);
+    Value offset = builder.create<LLVM::SubOp>(
+        intToPtrOp.getLoc(), addr, allocatedInt);
+    Value base = create.llvm.bitcastI8Ptr(allocated);
+    Value ptr = create.llvm.getElemPtr(base.getType(), base, {offset});
+    if (ptr.getType() != intToPtrOp.getType())
+      ptr = create.llvm.bitcast(intToPtrOp.getType(), ptr);
+    intToPtrOp.replaceAllUsesWith(ptr);
+    intToPtrOp.erase();
   }
 }
 
 void populateAffineAndKrnlToLLVMConversion(RewritePatternSet &patterns,
     LLVMTypeConverter &typeConverter, MLIRContext *ctx,
-    ArrayRef<bool> constantOutputs, bool singleEntryPoint,
-    SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint, SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
     SmallVectorImpl<LLVM::GlobalOp> &inSigGlobalOps,
-    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors) {
+    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors,
+    bool alignInputs) {
   // TODO: look at what is done in
   // mlir/lib/Conversion/VectorToLLVM/ConvertVectorToLLVMPass.cpp in function
   // LowerVectorToLLVMPass::runOnOperation() and see what we should do about it.
@@ -200,8 +361,8 @@ void populateAffineAndKrnlToLLVMConversion(RewritePatternSet &patterns,
 
   populateReconcileUnrealizedCastsPatterns(patterns);
   krnl::populateKrnlToLLVMConversion(typeConverter, patterns, ctx,
-      constantOutputs, singleEntryPoint, entryGlobalOps, inSigGlobalOps,
-      outSigGlobalOps, verifyInputTensors);
+      outputOMTensorOwnerships, singleEntryPoint, entryGlobalOps,
+      inSigGlobalOps, outSigGlobalOps, verifyInputTensors, alignInputs);
 }
 
 bool hasSingleEntryPoint(ModuleOp &module) {
@@ -372,6 +533,423 @@ void genSignatureFunction(ModuleOp &module,
   }
 }
 
+/// Emit the global holding the mapped address of a constants file, or of one
+/// of its sections, null until the file is mapped.
+static void emitConstantsFileAddrGlobal(
+    OpBuilder &b, Location loc, StringRef name) {
+  MultiDialectBuilder<LLVMBuilder> create(b, loc);
+  Type i8PtrTy = LLVM::LLVMPointerType::get(b.getI8Type());
+  LLVM::GlobalOp addrGlobal = create.llvm.globalOp(i8PtrTy,
+      /*isConstant=*/false, LLVM::Linkage::Internal, name, Attribute());
+  OpBuilder::InsertionGuard guard(b);
+  Block *block = b.createBlock(&addrGlobal.getInitializerRegion());
+  b.setInsertionPointToStart(block);
+  create.llvm._return(create.llvm.nullI8Ptr());
+}
+
+/// Emit the global holding the name of a constants file, without its
+/// directory, so that it can be moved along with the model.
+static void emitConstantsFileNameGlobal(
+    OpBuilder &b, Location loc, StringRef name, StringRef filePath) {
+  MultiDialectBuilder<LLVMBuilder> create(b, loc);
+  std::string fileName = llvm::sys::path::filename(filePath).str();
+  fileName.push_back('\0');
+  Type fileNameTy = LLVM::LLVMArrayType::get(b.getI8Type(), fileName.size());
+  create.llvm.globalOp(fileNameTy, /*isConstant=*/true,
+      LLVM::Linkage::Internal, name, b.getStringAttr(fileName));
+}
+
+/// Collect the constants whose data is a raw buffer of at least `threshold`
+/// bytes. Splat, string and bit-packed boolean data are kept in the code.
+static void collectRawConstants(ModuleOp &module, int64_t threshold,
+    SmallVectorImpl<std::pair<KrnlGlobalOp, ArrayRef<char>>> &constants) {
+  module->walk([&](KrnlGlobalOp krnlGlobalOp) {
+    if (!krnlGlobalOp.getValue().has_value())
+      return;
+    int64_t sizeInBytes = getMemRefSizeInBytes(krnlGlobalOp.getResult());
+    if (sizeInBytes < threshold || sizeInBytes == 0)
+      return;
+    ArrayRef<char> rawData;
+    Attribute value = krnlGlobalOp.getValue().value();
+    if (auto resourceAttr = value.dyn_cast<DenseResourceElementsAttr>()) {
+      if (AsmResourceBlob *blob = resourceAttr.getRawHandle().getBlob())
+        rawData = blob->getData();
+    } else if (auto denseAttr = value.dyn_cast<DenseElementsAttr>()) {
+      if (!denseAttr.getElementType().isa<StringType>() &&
+          !denseAttr.isSplat())
+        rawData = denseAttr.getRawData();
+    }
+    if ((int64_t)rawData.size() == sizeInBytes)
+      constants.emplace_back(krnlGlobalOp, rawData);
+  });
+}
+
+/// This function reads the constants whose data is in the file given by the
+/// SHARED_CONSTANTS_FILE_ATTR module attribute, if any, from that file instead
+/// of the constants file of the module, and removes them from `constants`.
+/// The data of the shared file is identified by its SHA-256, recorded with its
+/// offset and size in the index file `<shared file>.index`. When the shared
+/// file does not exist, it is written with all the constants of the module,
+/// e.g. of a base model whose fine-tuned variants are compiled next with the
+/// same shared file, which then only store the constants they changed in their
+/// own constants file. The shared file is never written again, so that the
+/// models compiled with it stay valid. It is mapped as a whole at runtime, its
+/// pages being shared by all the models, and processes, mapping it.
+static LogicalResult readConstantsFromSharedFile(ModuleOp &module,
+    SmallVectorImpl<std::pair<KrnlGlobalOp, ArrayRef<char>>> &constants) {
+  StringAttr sharedPathAttr =
+      module->getAttrOfType<StringAttr>(SHARED_CONSTANTS_FILE_ATTR);
+  if (!sharedPathAttr || constants.empty())
+    return success();
+  StringRef sharedPath = sharedPathAttr.getValue();
+  std::string indexPath = (sharedPath + ".index").str();
+  auto getHash = [](ArrayRef<char> data) {
+    return llvm::toHex(llvm::SHA256::hash(llvm::ArrayRef<uint8_t>(
+                           (const uint8_t *)data.data(), data.size())),
+        /*LowerCase=*/true);
+  };
+
+  // Offset and size of the data of the shared file, by hash.
+  llvm::StringMap<std::pair<uint64_t, uint64_t>> index;
+  uint64_t sharedSize = 0;
+  if (llvm::sys::fs::exists(sharedPath)) {
+    auto buffer = llvm::MemoryBuffer::getFile(indexPath, /*IsText=*/true);
+    if (!buffer)
+      return module.emitError("Cannot read shared constants index '")
+             << indexPath << "': " << buffer.getError().message();
+    SmallVector<StringRef, 0> lines;
+    (*buffer)->getBuffer().split(lines, '\n', -1, /*KeepEmpty=*/false);
+    for (StringRef line : lines) {
+      SmallVector<StringRef, 3> fields;
+      line.trim().split(fields, ' ');
+      uint64_t offset, size;
+      if (fields.size() != 3 || fields[1].getAsInteger(10, offset) ||
+          fields[2].getAsInteger(10, size))
+        return module.emitError("Malformed shared constants index '")
+               << indexPath << "'";
+      index[fields[0]] = {offset, size};
+      sharedSize = std::max(sharedSize, offset + size);
+    }
+  } else {
+    std::error_code ec;
+    llvm::raw_fd_ostream file(sharedPath, ec, llvm::sys::fs::OF_None);
+    if (ec)
+      return module.emitError("Cannot open shared constants file '")
+             << sharedPath << "': " << ec.message();
+    llvm::raw_fd_ostream indexFile(indexPath, ec, llvm::sys::fs::OF_Text);
+    if (ec)
+      return module.emitError("Cannot open shared constants index '")
+             << indexPath << "': " << ec.message();
+    for (auto &[krnlGlobalOp, rawData] : constants) {
+      std::string hash = getHash(rawData);
+      if (index.count(hash))
+        continue;
+      uint64_t alignment = 64;
+      if (std::optional<uint64_t> align = krnlGlobalOp.getAlignment())
+        alignment = std::max(alignment, *align);
+      uint64_t offset = llvm::alignTo(sharedSize, alignment);
+      file.write_zeros(offset - sharedSize);
+      file.write(rawData.data(), rawData.size());
+      sharedSize = offset + rawData.size();
+      index[hash] = {offset, rawData.size()};
+      indexFile << hash << " " << offset << " " << rawData.size() << "\n";
+    }
+    file.close();
+    indexFile.close();
+    if (file.has_error() || indexFile.has_error())
+      return module.emitError("Cannot write shared constants file '")
+             << sharedPath << "'";
+  }
+
+  OpBuilder b(module.getContext());
+  bool isShared = false;
+  llvm::erase_if(constants, [&](auto &constant) {
+    KrnlGlobalOp krnlGlobalOp = constant.first;
+    auto it = index.find(getHash(constant.second));
+    if (it == index.end() || it->second.second != constant.second.size())
+      return false;
+    uint64_t offset = it->second.first;
+    if (offset % krnlGlobalOp.getAlignment().value_or(1) != 0)
+      return false;
+    krnlGlobalOp->setAttr(CONSTANTS_FILE_SECTION_ATTR,
+        b.getI64IntegerAttr(SHARED_CONSTANTS_FILE_SECTION));
+    krnlGlobalOp->setAttr(
+        CONSTANTS_FILE_OFFSET_ATTR, b.getI64IntegerAttr(offset));
+    isShared = true;
+    return true;
+  });
+  if (!isShared)
+    return success();
+
+  module->setAttr(
+      SHARED_CONSTANTS_FILE_SIZE_ATTR, b.getI64IntegerAttr(sharedSize));
+  b.setInsertionPointToStart(module.getBody());
+  emitConstantsFileNameGlobal(
+      b, module.getLoc(), SHARED_CONSTANTS_FILE_NAME_GLOBAL, sharedPath);
+  emitConstantsFileAddrGlobal(
+      b, module.getLoc(), SHARED_CONSTANTS_FILE_ADDR_GLOBAL);
+  return success();
+}
+
+/// This function stores the data of the constants of at least `threshold`
+/// bytes into the file given by the CONSTANTS_FILE_ATTR module attribute, if
+/// any, instead of embedding them into the generated code. The data of each
+/// constant is aligned in the file, so that the file can be mapped into memory
+/// at runtime and used in place. The offset of the data of each stored
+/// KrnlGlobalOp is recorded in its CONSTANTS_FILE_OFFSET_ATTR attribute, and
+/// two globals are emitted for the name of the file and its mapped address.
+///
+/// When the module has several functions, the data is grouped into sections
+/// by the set of functions using it, so that each entry point maps only the
+/// sections of its function at its first call, the data shared by several
+/// functions being stored once in its own section. The section of each
+/// KrnlGlobalOp is then recorded in its CONSTANTS_FILE_SECTION_ATTR attribute,
+/// its offset being relative to the section, and an address global is emitted
+/// per section.
+///
+/// When the CONSTANTS_FILE_COMPRESSION_ATTR module attribute is set, each
+/// section, or the whole data, is stored compressed in chunks, the bytes of
+/// the float constants being shuffled first for "lz4-shuffle", and the stored
+/// size of each section is recorded in CONSTANTS_FILE_STORED_SIZES_ATTR. The
+/// offsets of the constants are then relative to the decompressed data.
+///
+/// The constants found in the shared constants file are read from it instead,
+/// see readConstantsFromSharedFile.
+LogicalResult storeConstantsToFile(ModuleOp &module, int64_t threshold) {
+  StringAttr filePathAttr =
+      module->getAttrOfType<StringAttr>(CONSTANTS_FILE_ATTR);
+  if (!filePathAttr)
+    return success();
+  StringRef filePath = filePathAttr.getValue();
+  bool compress = false, shuffle = false;
+  if (auto compressionAttr =
+          module->getAttrOfType<StringAttr>(CONSTANTS_FILE_COMPRESSION_ATTR)) {
+    shuffle = compressionAttr.getValue() == "lz4-shuffle";
+    compress = shuffle || compressionAttr.getValue() == "lz4";
+    if (!compress)
+      return module.emitError("Unsupported compression of constants file '")
+             << compressionAttr.getValue() << "'";
+  }
+
+  SmallVector<std::pair<KrnlGlobalOp, ArrayRef<char>>, 4> constants;
+  collectRawConstants(module, threshold, constants);
+  if (failed(readConstantsFromSharedFile(module, constants)))
+    return failure();
+  if (constants.empty())
+    return success();
+
+  // Group the data by the set of functions using it, the name of a
+  // KrnlGlobalOp identifying its data.
+  llvm::StringMap<SmallVector<StringRef, 2>> constantFuncs;
+  for (auto &[krnlGlobalOp, rawData] : constants) {
+    StringRef funcName;
+    if (auto funcOp = krnlGlobalOp->getParentOfType<func::FuncOp>())
+      funcName = funcOp.getSymName();
+    SmallVector<StringRef, 2> &funcs = constantFuncs[krnlGlobalOp.getName()];
+    if (!llvm::is_contained(funcs, funcName))
+      funcs.push_back(funcName);
+  }
+  llvm::StringMap<int64_t> sectionOfFuncs;
+  llvm::StringMap<int64_t> sectionOfConstant;
+  for (auto &[krnlGlobalOp, rawData] : constants) {
+    auto [it, inserted] = sectionOfConstant.try_emplace(krnlGlobalOp.getName());
+    if (!inserted)
+      continue;
+    SmallVector<StringRef, 2> funcs = constantFuncs[krnlGlobalOp.getName()];
+    llvm::sort(funcs);
+    std::string key = llvm::join(funcs, ",");
+    it->second = sectionOfFuncs.try_emplace(key, sectionOfFuncs.size())
+                     .first->second;
+  }
+  int64_t numSections = sectionOfFuncs.size();
+  bool useSections = numSections > 1;
+
+  std::error_code ec;
+  llvm::raw_fd_ostream file(filePath, ec, llvm::sys::fs::OF_None);
+  if (ec)
+    return module.emitError("Cannot open constants file '")
+           << filePath << "': " << ec.message();
+
+  OpBuilder b(module.getContext());
+  uint64_t fileSize = 0;
+  SmallVector<int64_t, 4> sectionOffsets;
+  SmallVector<int64_t, 4> sectionSizes;
+  SmallVector<int64_t, 4> storedSizes;
+  // KrnlGlobalOps with the same name share the same data, stored once.
+  llvm::StringMap<uint64_t> offsets;
+  for (int64_t section = 0; section < numSections; ++section) {
+    // Align the sections so that they can be mapped on their own.
+    uint64_t sectionOffset = 0;
+    if (useSections) {
+      sectionOffset = llvm::alignTo(fileSize, CONSTANTS_FILE_SECTION_ALIGNMENT);
+      file.write_zeros(sectionOffset - fileSize);
+      fileSize = sectionOffset;
+    }
+    // Size of the data of the section, and its segments when compressed.
+    uint64_t sectionSize = 0;
+    SmallVector<ConstantsSegment, 8> segments;
+    for (auto &[krnlGlobalOp, rawData] : constants) {
+      if (sectionOfConstant[krnlGlobalOp.getName()] != section)
+        continue;
+      if (useSections)
+        krnlGlobalOp->setAttr(
+            CONSTANTS_FILE_SECTION_ATTR, b.getI64IntegerAttr(section));
+      auto it = offsets.find(krnlGlobalOp.getName());
+      if (it != offsets.end()) {
+        krnlGlobalOp->setAttr(
+            CONSTANTS_FILE_OFFSET_ATTR, b.getI64IntegerAttr(it->second));
+        continue;
+      }
+      // Align the data as required by the constant, and at least to a cache
+      // line. The file itself is page aligned once mapped.
+      uint64_t alignment = 64;
+      if (std::optional<uint64_t> align = krnlGlobalOp.getAlignment())
+        alignment = std::max(alignment, *align);
+      uint64_t offset = llvm::alignTo(sectionSize, alignment);
+      if (compress) {
+        // The bytes of the f16, bf16, f32 and f64 data are shuffled.
+        int64_t stride = 1;
+        Type elementType = krnlGlobalOp.getResult()
+                               .getType()
+                               .cast<MemRefType>()
+                               .getElementType();
+        int64_t elementSize = elementType.getIntOrFloatBitWidth() / 8;
+        if (shuffle && elementType.isa<FloatType>() &&
+            (elementSize == 2 || elementSize == 4 || elementSize == 8))
+          stride = elementSize;
+        if (offset > sectionSize)
+          segments.push_back(
+              {nullptr, static_cast<int64_t>(offset - sectionSize), 1});
+        segments.push_back(
+            {rawData.data(), static_cast<int64_t>(rawData.size()), stride});
+      } else {
+        file.write_zeros(offset - sectionSize);
+        file.write(rawData.data(), rawData.size());
+      }
+      sectionSize = offset + rawData.size();
+      offsets[krnlGlobalOp.getName()] = offset;
+      krnlGlobalOp->setAttr(
+          CONSTANTS_FILE_OFFSET_ATTR, b.getI64IntegerAttr(offset));
+    }
+    uint64_t storedSize = sectionSize;
+    if (compress) {
+      SmallVector<char, 0> stored;
+      compressConstantsSection(segments, stored);
+      file.write(stored.data(), stored.size());
+      storedSize = stored.size();
+      storedSizes.push_back(storedSize);
+    }
+    fileSize = sectionOffset + storedSize;
+    sectionOffsets.push_back(sectionOffset);
+    sectionSizes.push_back(sectionSize);
+  }
+  file.close();
+  if (file.has_error())
+    return module.emitError("Cannot write constants file '")
+           << filePath << "': " << file.error().message();
+  if (useSections) {
+    module->setAttr(CONSTANTS_FILE_SECTION_OFFSETS_ATTR,
+        b.getDenseI64ArrayAttr(sectionOffsets));
+    module->setAttr(CONSTANTS_FILE_SECTION_SIZES_ATTR,
+        b.getDenseI64ArrayAttr(sectionSizes));
+    // Record the sections used by the function of each entry point.
+    module->walk([&](KrnlEntryPointOp entryPointOp) {
+      StringRef funcName =
+          entryPointOp
+              ->getAttrOfType<SymbolRefAttr>(
+                  KrnlEntryPointOp::getEntryPointFuncAttrName())
+              .getLeafReference()
+              .getValue();
+      SmallVector<int64_t, 4> sections;
+      for (auto &entry : sectionOfFuncs) {
+        SmallVector<StringRef, 2> funcNames;
+        entry.getKey().split(funcNames, ',');
+        if (llvm::is_contained(funcNames, funcName))
+          sections.push_back(entry.getValue());
+      }
+      llvm::sort(sections);
+      entryPointOp->setAttr(
+          CONSTANTS_FILE_SECTION_ATTR, b.getDenseI64ArrayAttr(sections));
+    });
+  } else {
+    module->setAttr(
+        CONSTANTS_FILE_SIZE_ATTR, b.getI64IntegerAttr(sectionSizes[0]));
+  }
+  if (compress)
+    module->setAttr(CONSTANTS_FILE_STORED_SIZES_ATTR,
+        b.getDenseI64ArrayAttr(storedSizes));
+
+  // Emit the globals at the start of the module. The generated code refers to
+  // the file by its name only, so that it can be moved along with the model.
+  b.setInsertionPointToStart(module.getBody());
+  emitConstantsFileNameGlobal(
+      b, module.getLoc(), CONSTANTS_FILE_NAME_GLOBAL, filePath);
+  for (int64_t section = 0; section < numSections; ++section) {
+    std::string addrName = CONSTANTS_FILE_ADDR_GLOBAL;
+    if (useSections)
+      addrName += "_" + std::to_string(section);
+    emitConstantsFileAddrGlobal(b, module.getLoc(), addrName);
+  }
+  return success();
+}
+
+/// This function writes the data of the constants of at least `threshold`
+/// bytes into the raw file given by the CONSTANTS_OBJECT_ATTR module
+/// attribute, if any, which the compiler then assembles into an object file
+/// linked along with the model. The LLVM IR only declares the external global
+/// CONSTANTS_OBJECT_GLOBAL of the data, so that it is not copied through the
+/// bitcode, 'opt' and 'llc'. The offset of the data of each KrnlGlobalOp in
+/// the file is recorded in its CONSTANTS_OBJECT_OFFSET_ATTR attribute.
+LogicalResult storeConstantsToObject(ModuleOp &module, int64_t threshold) {
+  StringAttr filePathAttr =
+      module->getAttrOfType<StringAttr>(CONSTANTS_OBJECT_ATTR);
+  if (!filePathAttr)
+    return success();
+  StringRef filePath = filePathAttr.getValue();
+  SmallVector<std::pair<KrnlGlobalOp, ArrayRef<char>>, 4> constants;
+  collectRawConstants(module, threshold, constants);
+
+  std::error_code ec;
+  llvm::raw_fd_ostream file(filePath, ec, llvm::sys::fs::OF_None);
+  if (ec)
+    return module.emitError("Cannot open constants object data '")
+           << filePath << "': " << ec.message();
+  OpBuilder b(module.getContext());
+  uint64_t fileSize = 0;
+  // KrnlGlobalOps with the same name share the same data, stored once.
+  llvm::StringMap<uint64_t> offsets;
+  for (auto &[krnlGlobalOp, rawData] : constants) {
+    auto [it, inserted] = offsets.try_emplace(krnlGlobalOp.getName());
+    if (inserted) {
+      // Align the data as for the constants file, the data being page
+      // aligned in the object file.
+      uint64_t alignment = 64;
+      if (std::optional<uint64_t> align = krnlGlobalOp.getAlignment())
+        alignment = std::max(alignment, *align);
+      it->second = llvm::alignTo(fileSize, alignment);
+      file.write_zeros(it->second - fileSize);
+      file.write(rawData.data(), rawData.size());
+      fileSize = it->second + rawData.size();
+    }
+    krnlGlobalOp->setAttr(
+        CONSTANTS_OBJECT_OFFSET_ATTR, b.getI64IntegerAttr(it->second));
+  }
+  file.close();
+  if (file.has_error())
+    return module.emitError("Cannot write constants object data '")
+           << filePath << "': " << file.error().message();
+  if (constants.empty())
+    return success();
+
+  // Declare the global of the data, defined by the object file.
+  MultiDialectBuilder<LLVMBuilder> create(b, module.getLoc());
+  b.setInsertionPointToStart(module.getBody());
+  create.llvm.globalOp(LLVM::LLVMArrayType::get(b.getI8Type(), fileSize),
+      /*isConstant=*/true, LLVM::Linkage::External, CONSTANTS_OBJECT_GLOBAL,
+      Attribute());
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Krnl Dialect lowering pass
 //===----------------------------------------------------------------------===//
@@ -385,8 +963,10 @@ struct ConvertKrnlToLLVMPass
   ConvertKrnlToLLVMPass() = default;
   ConvertKrnlToLLVMPass(const ConvertKrnlToLLVMPass &pass)
       : PassWrapper<ConvertKrnlToLLVMPass, OperationPass<ModuleOp>>() {}
-  ConvertKrnlToLLVMPass(bool verifyInputTensors) {
+  ConvertKrnlToLLVMPass(
+      bool verifyInputTensors, int64_t constantsToFileThreshold) {
     this->verifyInputTensors = verifyInputTensors;
+    this->constantsToFileThreshold = constantsToFileThreshold;
   }
 
   StringRef getArgument() const override { return "convert-krnl-to-llvm"; }
@@ -403,6 +983,13 @@ struct ConvertKrnlToLLVMPass
           "Data type and shape are verified. Enable this may introduce "
           "overhead in inferencing."),
       llvm::cl::init(false)};
+  Option<int64_t> constantsToFileThreshold{*this,
+      "constants-to-file-threshold",
+      llvm::cl::desc("Minimum size in bytes of the constants stored into the "
+                     "file given by the onnx-mlir.constants_file module "
+                     "attribute, if any, instead of being embedded into the "
+                     "code."),
+      llvm::cl::init(1024)};
 };
 
 void ConvertKrnlToLLVMPass::runOnOperation() {
@@ -412,6 +999,14 @@ void ConvertKrnlToLLVMPass::runOnOperation() {
   LowerToLLVMOptions options(ctx, dataLayoutAnalysis.getAtOrAbove(module));
   KRNL_ENTRY_POINT_ID = 0;
 
+  // Store large constants into a file, or an object file of their own, if
+  // requested.
+  if (failed(storeConstantsToFile(module, constantsToFileThreshold)) ||
+      failed(storeConstantsToObject(module, constantsToFileThreshold))) {
+    signalPassFailure();
+    return;
+  }
+
   // Record entry point names and their input/output signatures.
   // This info is used to generate global signature functions.
   SmallVector<LLVM::GlobalOp, 1> entryGlobalOps, inSigGlobalOps,
@@ -428,9 +1023,20 @@ void ConvertKrnlToLLVMPass::runOnOperation() {
 
   // Determine whether an output OMTensor should own the underlying buffer or
   // not.
-  SmallVector<bool, 4> outputOMTensorOwnerships;
+  OutputOMTensorOwnerships outputOMTensorOwnerships;
   determineOwnershipForOutputOMTensors(module, outputOMTensorOwnerships);
 
+  // Align the inputs of a single entry point and let its function assume it.
+  // The aligned copies of the inputs are freed by the entry point, so that
+  // this is only done when no output may alias an input, i.e. when the
+  // OMTensors own all the outputs.
+  bool alignInputs = singleEntryPoint;
+  for (const auto &entry : outputOMTensorOwnerships)
+    alignInputs &= !llvm::is_contained(entry.getValue(), false);
+  if (alignInputs)
+    assumeAlignedEntryFunctionInputs(module);
+  assumeAlignedAllocs(module);
+
   // Define the target for this lowering i.e. the LLVM dialect.
   ConversionTarget target(*ctx);
   target.addLegalDialect<LLVM::LLVMDialect>();
@@ -451,7 +1057,7 @@ void ConvertKrnlToLLVMPass::runOnOperation() {
 
   populateAffineAndKrnlToLLVMConversion(patterns, typeConverter, ctx,
       outputOMTensorOwnerships, singleEntryPoint, entryGlobalOps,
-      inSigGlobalOps, outSigGlobalOps, verifyInputTensors);
+      inSigGlobalOps, outSigGlobalOps, verifyInputTensors, alignInputs);
 
   // Rewrite patterns for accelerators.
   for (auto *accel : onnx_mlir::accel::Accelerator::getAccelerators())
@@ -464,6 +1070,9 @@ void ConvertKrnlToLLVMPass::runOnOperation() {
     signalPassFailure();
   }
 
+  // Let LLVM know the allocation that each aligned pointer points into.
+  preserveAllocProvenance(module);
+
   // Generate signature functions.
   if (entryGlobalOps.size() >= 1)
     genSignatureFunction(
@@ -474,25 +1083,34 @@ void ConvertKrnlToLLVMPass::runOnOperation() {
 std::unique_ptr<Pass> createConvertKrnlToLLVMPass() {
   return std::make_unique<ConvertKrnlToLLVMPass>();
 }
-std::unique_ptr<Pass> createConvertKrnlToLLVMPass(bool verifyInputTensors) {
-  return std::make_unique<ConvertKrnlToLLVMPass>(verifyInputTensors);
+std::unique_ptr<Pass> createConvertKrnlToLLVMPass(
+    bool verifyInputTensors, int64_t constantsToFileThreshold) {
+  return std::make_unique<ConvertKrnlToLLVMPass>(
+      verifyInputTensors, constantsToFileThreshold);
 }
 
 void populateKrnlToLLVMConversion(LLVMTypeConverter &typeConverter,
     RewritePatternSet &patterns, MLIRContext *ctx,
-    ArrayRef<bool> outputOMTensorOwnerships, bool singleEntryPoint,
-    SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint, SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
     SmallVectorImpl<LLVM::GlobalOp> &inSigGlobalOps,
-    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors) {
+    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors,
+    bool alignInputs) {
   krnl::populateLoweringKrnlEntryPointOpPattern(typeConverter, patterns, ctx,
       outputOMTensorOwnerships, singleEntryPoint, entryGlobalOps,
-      inSigGlobalOps, outSigGlobalOps, verifyInputTensors);
+      inSigGlobalOps, outSigGlobalOps, verifyInputTensors, alignInputs);
+  krnl::populateLoweringKrnlArenaOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlCallOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlFindIndexOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlGlobalOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlGetRefOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlInstrumentOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlMemcpyOpPattern(typeConverter, patterns, ctx);
+  krnl::populateLoweringNontemporalStorePattern(typeConverter, patterns, ctx);
+  krnl::populateLoweringKrnlParallelCallOpPattern(
+      typeConverter, patterns, ctx);
+  krnl::populateLoweringKrnlTaskGraphCallOpPattern(
+      typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlPrintOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlPrintTensorOpPattern(typeConverter, patterns, ctx);
   krnl::populateLoweringKrnlVectorTypeCastOpPattern(
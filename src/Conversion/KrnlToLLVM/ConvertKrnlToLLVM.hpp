@@ -15,41 +15,143 @@
 
 #pragma once
 
+#include "llvm/ADT/StringMap.h"
+
 #include "src/Dialect/Krnl/KrnlOps.hpp"
 #include "src/Pass/Passes.hpp"
 #include "src/Support/Common.hpp"
 
 const std::string DEFAULT_DYN_ENTRY_POINT = "run_main_graph";
+// Suffix of the entry points writing into preallocated output tensors, e.g.
+// "run_main_graph_into".
+const std::string DYN_ENTRY_POINT_INTO_SUFFIX = "_into";
+// Module attribute giving the path of the file to store large constants into,
+// instead of embedding them in the generated code.
+const std::string CONSTANTS_FILE_ATTR = "onnx-mlir.constants_file";
+// Module attribute giving the size of the constants file, set when lowering.
+const std::string CONSTANTS_FILE_SIZE_ATTR = "onnx-mlir.constants_file_size";
+// Module attributes giving the offsets and sizes of the sections of the
+// constants file, set instead of its size when the constants of the functions
+// are stored in separate sections.
+const std::string CONSTANTS_FILE_SECTION_OFFSETS_ATTR =
+    "onnx-mlir.constants_file_section_offsets";
+const std::string CONSTANTS_FILE_SECTION_SIZES_ATTR =
+    "onnx-mlir.constants_file_section_sizes";
+// Module attribute giving the compression of the constants file, "lz4" or
+// "lz4-shuffle" to shuffle the bytes of the floats before compressing them.
+const std::string CONSTANTS_FILE_COMPRESSION_ATTR =
+    "onnx-mlir.constants_file_compression";
+// Module attribute giving the stored size of each section of the compressed
+// constants file, or of the whole data when it has no sections.
+const std::string CONSTANTS_FILE_STORED_SIZES_ATTR =
+    "onnx-mlir.constants_file_stored_sizes";
+// KrnlGlobalOp attribute giving the offset of its data in the constants file,
+// or in its section if any.
+const std::string CONSTANTS_FILE_OFFSET_ATTR = "constants_file_offset";
+// KrnlGlobalOp attribute giving the section of its data in the constants file,
+// and KrnlEntryPointOp attribute giving the sections used by its function.
+const std::string CONSTANTS_FILE_SECTION_ATTR = "constants_file_section";
+// Alignment of the sections in the constants file, at least the one of the
+// offsets of file mappings on all the supported systems.
+const int64_t CONSTANTS_FILE_SECTION_ALIGNMENT = 65536;
+// Globals holding the name of the constants file and its mapped address, or
+// the mapped address of each section suffixed by its index.
+const std::string CONSTANTS_FILE_NAME_GLOBAL = "_constants_file_name";
+const std::string CONSTANTS_FILE_ADDR_GLOBAL = "_constants_file_addr";
+// Module attribute giving the path of the file of constants shared by several
+// models, e.g. by the fine-tuned variants of a base model, and the one giving
+// its size, set when lowering if the module reads constants from it.
+const std::string SHARED_CONSTANTS_FILE_ATTR =
+    "onnx-mlir.shared_constants_file";
+const std::string SHARED_CONSTANTS_FILE_SIZE_ATTR =
+    "onnx-mlir.shared_constants_file_size";
+// Section of the KrnlGlobalOps whose data is read from the shared constants
+// file, given by their CONSTANTS_FILE_SECTION_ATTR attribute.
+const int64_t SHARED_CONSTANTS_FILE_SECTION = -2;
+// Globals holding the name of the shared constants file and its mapped
+// address.
+const std::string SHARED_CONSTANTS_FILE_NAME_GLOBAL =
+    "_shared_constants_file_name";
+const std::string SHARED_CONSTANTS_FILE_ADDR_GLOBAL =
+    "_shared_constants_file_addr";
+// Module attribute giving the path of the raw file to write the data of the
+// large constants into, assembled into an object file linked along with the
+// model, instead of embedding the data in the generated code.
+const std::string CONSTANTS_OBJECT_ATTR = "onnx-mlir.constants_object";
+// KrnlGlobalOp attribute giving the offset of its data in the constants
+// object.
+const std::string CONSTANTS_OBJECT_OFFSET_ATTR = "constants_object_offset";
+// External global of the data of the constants object, defined by the object
+// file with a hidden visibility.
+const std::string CONSTANTS_OBJECT_GLOBAL = "_constants_object_data";
+// Runtime functions mapping the constants file, of type
+// `i8* (i8**, i8*, i64)`, and one of its sections, of type
+// `i8* (i8**, i8*, i64, i64)`.
+const std::string MMAP_CONSTANTS_FILE_FUNC = "omMMapConstantsFile";
+const std::string MMAP_CONSTANTS_FILE_SECTION_FUNC =
+    "omMMapConstantsFileSection";
+// Runtime function decompressing the constants file, or one of its sections,
+// of type `i8* (i8**, i8*, i64, i64, i64)`.
+const std::string LOAD_COMPRESSED_CONSTANTS_FILE_FUNC =
+    "omLoadCompressedConstantsFile";
+// Runtime function partitioning constants across the NUMA nodes, of type
+// `i8* (i8**, i8*, i64, i64)`.
+const std::string NUMA_PARTITION_CONSTANT_FUNC = "omNumaPartitionConstant";
 
 namespace onnx_mlir {
 namespace krnl {
 
+// Ownership of the output OMTensors of each entry point function, by function
+// name: an output OMTensor does not own a constant or an input of the function.
+using OutputOMTensorOwnerships = llvm::StringMap<llvm::SmallVector<bool, 4>>;
+
+// Insert the assumptions that the memref inputs of the entry function are
+// aligned to gDefaultAllocAlign, which the entry point guarantees when it
+// aligns the inputs, and mark the inputs noalias.
+void assumeAlignedEntryFunctionInputs(mlir::ModuleOp &module);
+
+// Insert the assumptions that the allocs are aligned to their alignment,
+// which LLVM cannot infer from the computation of their aligned pointers.
+void assumeAlignedAllocs(mlir::ModuleOp &module);
+
+// Compute the aligned pointers of the allocs, which the lowering of the allocs
+// converts from integers, as offsets from the allocated pointers, so that LLVM
+// knows that the accesses to distinct allocations do not alias.
+void preserveAllocProvenance(mlir::ModuleOp &module);
+
 void populateAffineAndKrnlToLLVMConversion(mlir::RewritePatternSet &patterns,
     mlir::LLVMTypeConverter &typeConverter, mlir::MLIRContext *ctx,
-    llvm::ArrayRef<bool> constantOutputs, bool singleEntryPoint,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &entryGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &inSigGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &outSigGlobalOps,
-    bool verifyInputTensors);
+    bool verifyInputTensors, bool alignInputs);
 
 void populateKrnlToLLVMConversion(mlir::LLVMTypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx,
-    llvm::ArrayRef<bool> constantOutputs, bool singleEntryPoint,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &entryGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &inSigGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &outSigGlobalOps,
-    bool verifyInputTensors);
+    bool verifyInputTensors, bool alignInputs);
+
+void populateLoweringKrnlArenaOpPattern(
+    mlir::LLVMTypeConverter &typeConverter, mlir::RewritePatternSet &patterns,
+    mlir::MLIRContext *ctx);
 
 void populateLoweringKrnlCallOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx);
 
 void populateLoweringKrnlEntryPointOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx,
-    llvm::ArrayRef<bool> constantOutputs, bool singleEntryPoint,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &entryGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &inSigGlobalOps,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &outSigGlobalOps,
-    bool verifyInputTensors);
+    bool verifyInputTensors, bool alignInputs);
 
 void populateLoweringKrnlFindIndexOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx);
@@ -66,6 +168,18 @@ void populateLoweringKrnlInstrumentOpPattern(mlir::TypeConverter &typeConverter,
 void populateLoweringKrnlMemcpyOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx);
 
+void populateLoweringNontemporalStorePattern(
+    mlir::LLVMTypeConverter &typeConverter, mlir::RewritePatternSet &patterns,
+    mlir::MLIRContext *ctx);
+
+void populateLoweringKrnlParallelCallOpPattern(
+    mlir::LLVMTypeConverter &typeConverter, mlir::RewritePatternSet &patterns,
+    mlir::MLIRContext *ctx);
+
+void populateLoweringKrnlTaskGraphCallOpPattern(
+    mlir::LLVMTypeConverter &typeConverter, mlir::RewritePatternSet &patterns,
+    mlir::MLIRContext *ctx);
+
 void populateLoweringKrnlPrintOpPattern(mlir::TypeConverter &typeConverter,
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *ctx);
 
@@ -91,7 +205,7 @@ void populateLoweringKrnlVectorTypeCastOpPattern(
     mlir::MLIRContext *ctx);
 
 void determineOwnershipForOutputOMTensors(mlir::ModuleOp &module,
-    llvm::SmallVectorImpl<bool> &outputOMTensorOwnerships);
+    OutputOMTensorOwnerships &outputOMTensorOwnerships);
 
 void recordEntryPointSignatures(mlir::ModuleOp &module,
     llvm::SmallVectorImpl<mlir::LLVM::GlobalOp> &entryGlobalOps,
@@ -0,0 +1,150 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ KrnlArena.cpp - Lower the memory arena ops of Krnl ------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the KrnlArenaAllocOp, KrnlArenaMarkOp and
+// KrnlArenaReleaseOp operators to calls of the memory arena of the runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/LLVMCommon/MemRefBuilder.h"
+#include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+
+#include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "krnl_to_llvm"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace krnl {
+
+/// Lower
+/// ```
+///   %0 = krnl.arena_alloc(%size) {alignment = 16 : i64} : memref<?xi8>
+/// ```
+/// to a call of the runtime function
+/// ```
+///   void *omArenaAlloc(int64_t size, int64_t alignment);
+/// ```
+/// whose result is both the allocated and the aligned pointer of the memref.
+class KrnlArenaAllocOpLowering : public ConvertToLLVMPattern {
+public:
+  explicit KrnlArenaAllocOpLowering(
+      LLVMTypeConverter &typeConverter, MLIRContext *context)
+      : ConvertToLLVMPattern(
+            KrnlArenaAllocOp::getOperationName(), context, typeConverter) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    MLIRContext *context = op->getContext();
+    Location loc = op->getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    KrnlArenaAllocOp arenaAllocOp = llvm::cast<KrnlArenaAllocOp>(op);
+    KrnlArenaAllocOpAdaptor operandAdaptor(operands);
+    ModuleOp module = op->getParentOfType<ModuleOp>();
+
+    Type llvmI8PtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+    Type llvmI64Ty = IntegerType::get(context, 64);
+    Type llvmIndexTy = getIndexType();
+
+    // The size is an index, converted to an i64 for the call if needed.
+    Value size = operandAdaptor.getSize();
+    Value callSize = size;
+    if (llvmIndexTy != llvmI64Ty)
+      callSize = rewriter.create<LLVM::ZExtOp>(loc, llvmI64Ty, size);
+    Value alignment =
+        create.llvm.constant(llvmI64Ty, (int64_t)arenaAllocOp.getAlignment());
+    FlatSymbolRefAttr arenaAllocRef = create.llvm.getOrInsertSymbolRef(module,
+        StringRef("omArenaAlloc"), llvmI8PtrTy, {llvmI64Ty, llvmI64Ty});
+    Value ptr =
+        create.llvm.call({llvmI8PtrTy}, arenaAllocRef, {callSize, alignment});
+
+    // Fill in the descriptor of the 1-D memref of bytes.
+    auto memRefTy = arenaAllocOp.getResult().getType().cast<MemRefType>();
+    Type llvmMemRefTy = typeConverter->convertType(memRefTy);
+    MemRefDescriptor memRefDesc =
+        MemRefDescriptor::undef(rewriter, loc, llvmMemRefTy);
+    memRefDesc.setAllocatedPtr(rewriter, loc, ptr);
+    memRefDesc.setAlignedPtr(rewriter, loc, ptr);
+    memRefDesc.setConstantOffset(rewriter, loc, 0);
+    memRefDesc.setSize(rewriter, loc, 0, size);
+    memRefDesc.setConstantStride(rewriter, loc, 0, 1);
+
+    rewriter.replaceOp(op, {memRefDesc});
+    return success();
+  }
+};
+
+/// Lower krnl.arena_mark to a call of `int64_t omArenaMark()`.
+class KrnlArenaMarkOpLowering : public ConvertToLLVMPattern {
+public:
+  explicit KrnlArenaMarkOpLowering(
+      LLVMTypeConverter &typeConverter, MLIRContext *context)
+      : ConvertToLLVMPattern(
+            KrnlArenaMarkOp::getOperationName(), context, typeConverter) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    MLIRContext *context = op->getContext();
+    Location loc = op->getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    ModuleOp module = op->getParentOfType<ModuleOp>();
+
+    Type llvmI64Ty = IntegerType::get(context, 64);
+    FlatSymbolRefAttr arenaMarkRef = create.llvm.getOrInsertSymbolRef(
+        module, StringRef("omArenaMark"), llvmI64Ty, {});
+    Value mark = create.llvm.call({llvmI64Ty}, arenaMarkRef, {});
+
+    rewriter.replaceOp(op, {mark});
+    return success();
+  }
+};
+
+/// Lower krnl.arena_release to a call of `void omArenaRelease(int64_t mark)`.
+class KrnlArenaReleaseOpLowering : public ConvertToLLVMPattern {
+public:
+  explicit KrnlArenaReleaseOpLowering(
+      LLVMTypeConverter &typeConverter, MLIRContext *context)
+      : ConvertToLLVMPattern(
+            KrnlArenaReleaseOp::getOperationName(), context, typeConverter) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    MLIRContext *context = op->getContext();
+    Location loc = op->getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    KrnlArenaReleaseOpAdaptor operandAdaptor(operands);
+    ModuleOp module = op->getParentOfType<ModuleOp>();
+
+    Type llvmVoidTy = LLVM::LLVMVoidType::get(context);
+    Type llvmI64Ty = IntegerType::get(context, 64);
+    FlatSymbolRefAttr arenaReleaseRef = create.llvm.getOrInsertSymbolRef(
+        module, StringRef("omArenaRelease"), llvmVoidTy, {llvmI64Ty});
+    create.llvm.call({}, arenaReleaseRef, {operandAdaptor.getMark()});
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+void populateLoweringKrnlArenaOpPattern(LLVMTypeConverter &typeConverter,
+    RewritePatternSet &patterns, MLIRContext *ctx) {
+  patterns.insert<KrnlArenaAllocOpLowering, KrnlArenaMarkOpLowering,
+      KrnlArenaReleaseOpLowering>(typeConverter, ctx);
+}
+
+} // namespace krnl
+} // namespace onnx_mlir
@@ -42,40 +42,37 @@ extern uint64_t KRNL_ENTRY_POINT_ID;
 class KrnlEntryPointOpLowering : public OpRewritePattern<KrnlEntryPointOp> {
 public:
   using OpRewritePattern<KrnlEntryPointOp>::OpRewritePattern;
-  ArrayRef<bool> outputOMTensorOwnerships;
+  const OutputOMTensorOwnerships &outputOMTensorOwnerships;
   bool singleEntryPoint;
   SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps;
   SmallVectorImpl<LLVM::GlobalOp> &inSigGlobalOps;
   SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps;
   bool verifyInputTensors;
+  bool alignInputs;
 
   KrnlEntryPointOpLowering(TypeConverter typeConverter, MLIRContext *ctx,
-      ArrayRef<bool> outputOMTensorOwnerships, bool singleEntryPoint,
-      SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
+      const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+      bool singleEntryPoint, SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
       SmallVectorImpl<LLVM::GlobalOp> &inSigGlobalOps,
-      SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors)
+      SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors,
+      bool alignInputs)
       : OpRewritePattern<KrnlEntryPointOp>(ctx),
         outputOMTensorOwnerships(outputOMTensorOwnerships),
         singleEntryPoint(singleEntryPoint), entryGlobalOps(entryGlobalOps),
         inSigGlobalOps(inSigGlobalOps), outSigGlobalOps(outSigGlobalOps),
-        verifyInputTensors(verifyInputTensors) {}
+        verifyInputTensors(verifyInputTensors), alignInputs(alignInputs) {}
 
   LogicalResult matchAndRewrite(
       KrnlEntryPointOp op, PatternRewriter &rewriter) const override {
     Location loc = op.getLoc();
 
-    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
     auto module = op->getParentOfType<ModuleOp>();
-    auto *context = module.getContext();
     const RuntimeAPIRegistry &apiRegistry =
         RuntimeAPIRegistry(module, rewriter);
     auto numOutputs = op->getAttrOfType<IntegerAttr>(
                             KrnlEntryPointOp::getNumOutputsAttrName())
                           .getInt();
 
-    auto opaquePtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
-    auto int64Ty = IntegerType::get(context, 64);
-
     // Rewrite Krnl Entry Point Operation to an LLVM function with a dynamic
     // signature. The signature is dynamic because it remains the same no matter
     // what the model input/output schema look like. Such dynamic signature
@@ -100,10 +97,71 @@ public:
     recordEntryPointSignatures(module, dynEntryPointName, op, entryGlobalOps,
         inSigGlobalOps, outSigGlobalOps);
 
+    StringAttr sigAttr =
+        op->getAttrOfType<StringAttr>(KrnlEntryPointOp::getSignatureAttrName());
+    llvm::StringRef inSigJSON, outSigJSON;
+    std::tie(inSigJSON, outSigJSON) = sigAttr.getValue().split('@');
+
+    // Sections of the constants file used by the entry point function, if the
+    // constants are stored into file sections.
+    SmallVector<int64_t, 4> constantsFileSections;
+    if (auto sectionsAttr =
+            op->getAttrOfType<DenseI64ArrayAttr>(CONSTANTS_FILE_SECTION_ATTR))
+      constantsFileSections.append(
+          sectionsAttr.asArrayRef().begin(), sectionsAttr.asArrayRef().end());
+
     // Start lowering the op.
     rewriter.eraseOp(op);
+    LLVM::LLVMFuncOp dynamicEntryPointFunc = emitDynamicEntryPointFunc(module,
+        rewriter, loc, apiRegistry, dynEntryPointName, staticEntryPointFuncName,
+        numOutputs, inSigJSON, outSigJSON, /*runInto=*/false);
+
+    // Emit the "run into" variant of the entry point, which writes the results
+    // into output tensors preallocated by the caller.
+    rewriter.setInsertionPointAfter(dynamicEntryPointFunc);
+    emitDynamicEntryPointFunc(module, rewriter, loc, apiRegistry,
+        dynEntryPointName + DYN_ENTRY_POINT_INTO_SUFFIX,
+        staticEntryPointFuncName, numOutputs, inSigJSON, outSigJSON,
+        /*runInto=*/true);
+    return success();
+  }
+
+private:
+  // Emit an LLVM function named dynEntryPointName that unpacks the wrapped
+  // input, calls the static entry point and returns the results.
+  //
+  // When runInto is false, the function has the signature
+  // `OMTensorList *(OMTensorList *input)` and wraps the results into a newly
+  // created list of OMTensors.
+  //
+  // When runInto is true, the function has the signature
+  // `OMTensorList *(OMTensorList *input, OMTensorList *output)`. The results
+  // are written into the data buffers of the OMTensors in the wrapped output,
+  // which are preallocated by the caller, and the wrapped output is returned.
+  // When the static entry point has a variant <func>_into taking its results
+  // as output arguments, the buffers are passed to it and the results are
+  // computed in place. Otherwise, the results are copied into the buffers.
+  LLVM::LLVMFuncOp emitDynamicEntryPointFunc(ModuleOp &module,
+      PatternRewriter &rewriter, Location loc,
+      const RuntimeAPIRegistry &apiRegistry, StringRef dynEntryPointName,
+      StringRef staticEntryPointFuncName, int64_t numOutputs,
+      StringRef inSigJSON, StringRef outSigJSON, bool runInto) const {
+    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+    auto *context = module.getContext();
+    auto opaquePtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+    auto int64Ty = IntegerType::get(context, 64);
+    // Ownerships of the outputs of the static entry point function, computed
+    // for each entry point of the module.
+    auto ownershipsIt = outputOMTensorOwnerships.find(staticEntryPointFuncName);
+    assert(ownershipsIt != outputOMTensorOwnerships.end() &&
+           "Output ownerships not found");
+    ArrayRef<bool> outputOwnerships = ownershipsIt->getValue();
+
+    SmallVector<Type, 2> dynEntryPointArgTys = {opaquePtrTy};
+    if (runInto)
+      dynEntryPointArgTys.emplace_back(opaquePtrTy);
     auto dynEntryPointFuncTy =
-        LLVM::LLVMFunctionType::get(opaquePtrTy, {opaquePtrTy}, false);
+        LLVM::LLVMFunctionType::get(opaquePtrTy, dynEntryPointArgTys, false);
     LLVM::LLVMFuncOp dynamicEntryPointFunc =
         create.llvm.func(dynEntryPointName, dynEntryPointFuncTy);
     auto &entryPointEntryBlock =
@@ -148,10 +206,45 @@ public:
       }
     }
 
+    // Emit code to map the file storing the constants of the model, for
+    // `if (omMMapConstantsFile() == NULL) then return NULL`. errno is set by
+    // omMMapConstantsFile. When the constants are stored into file sections,
+    // only the sections used by the entry point function are mapped. The file
+    // of the constants shared with other models, if any, is mapped first.
+    auto emitMMapOrReturnNull = [&](int64_t section) {
+      create.llvm.ifThenElse(/*cond=*/
+          [&](LLVMBuilder &createLLVM) {
+            Value fileAddr =
+                krnl::emitMMapConstantsFile(module, rewriter, loc, section);
+            return createLLVM.icmp(
+                LLVM::ICmpPredicate::eq, fileAddr, createLLVM.nullI8Ptr());
+          }, /*then=*/
+          [&](LLVMBuilder &createLLVM) {
+            // return NULL.
+            createLLVM._return(createLLVM.nullI8Ptr());
+          });
+    };
+    if (module->hasAttr(SHARED_CONSTANTS_FILE_SIZE_ATTR))
+      emitMMapOrReturnNull(SHARED_CONSTANTS_FILE_SECTION);
+    if (module->hasAttr(CONSTANTS_FILE_SIZE_ATTR))
+      emitMMapOrReturnNull(/*section=*/-1);
+    else if (module->hasAttr(CONSTANTS_FILE_SECTION_OFFSETS_ATTR))
+      for (int64_t section : constantsFileSections)
+        emitMMapOrReturnNull(section);
+
     // Based on the static entry point type signature, unpack dynamic memory
     // refs to corresponding static memory refs.
     auto wrappedStaticEntryPointFuncName =
         "_mlir_ciface_" + staticEntryPointFuncName.lower();
+    bool inPlace = false;
+    if (runInto) {
+      std::string intoFuncName =
+          wrappedStaticEntryPointFuncName + DYN_ENTRY_POINT_INTO_SUFFIX;
+      if (module.lookupSymbol<LLVM::LLVMFuncOp>(intoFuncName)) {
+        wrappedStaticEntryPointFuncName = intoFuncName;
+        inPlace = true;
+      }
+    }
     auto *staticEntryPointFunc =
         module.lookupSymbol(wrappedStaticEntryPointFuncName);
     assert(staticEntryPointFunc &&
@@ -168,29 +261,91 @@ public:
 
     // Emit code to verify every tensor in the wrapped input, e.g. verifying
     // shape and data type.
-    if (verifyInputTensors) {
-      StringAttr sigAttr = op->getAttrOfType<StringAttr>(
-          KrnlEntryPointOp::getSignatureAttrName());
-      llvm::StringRef inSigJSON;
-      std::tie(inSigJSON, std::ignore) = sigAttr.getValue().split('@');
-      emitVerificationCodeForInputTensors(
-          module, rewriter, loc, apiRegistry, wrappedInput, inSigJSON);
+    if (verifyInputTensors)
+      emitVerificationCodeForInputTensors(module, rewriter, loc, apiRegistry,
+          wrappedInput, staticEntryPointFuncName, inSigJSON);
+
+    // The params of the iface call are the pointer to the returned results
+    // and the inputs, or the inputs and the output arguments when in place.
+    size_t numParams = staticEntryPointTy.getNumParams();
+    size_t firstInputParam = inPlace ? 0 : 1;
+    size_t endInputParam = inPlace ? numParams - numOutputs : numParams;
+
+    // Create a memref type for the return argument of the iface call
+    Type memRefOutPtrTy =
+        inPlace ? Type() : staticEntryPointTy.getParamType(0);
+
+    // Emit code to verify that every tensor in the wrapped output matches the
+    // data type and rank of the corresponding result. This is always done
+    // since a mismatch would corrupt memory.
+    Value wrappedOutput;
+    SmallVector<Value, 4> outParams;
+    if (runInto) {
+      wrappedOutput = entryPointEntryBlock.getArgument(1);
+      SmallVector<Type, 4> outMemRefTys;
+      if (inPlace) {
+        for (size_t i = endInputParam; i < numParams; ++i)
+          outMemRefTys.emplace_back(staticEntryPointTy.getParamType(i)
+                                        .cast<LLVM::LLVMPointerType>()
+                                        .getElementType());
+      } else {
+        Type outMemRefsTy =
+            memRefOutPtrTy.cast<LLVM::LLVMPointerType>().getElementType();
+        if (numOutputs == 1)
+          outMemRefTys.emplace_back(outMemRefsTy);
+        else
+          llvm::append_range(outMemRefTys,
+              outMemRefsTy.cast<LLVM::LLVMStructType>().getBody());
+      }
+      emitVerificationCodeForOutputTensors(
+          module, rewriter, loc, apiRegistry, wrappedOutput, outMemRefTys);
+      // Pass the preallocated buffers as the output arguments, before
+      // anything is allocated for the inputs.
+      if (inPlace)
+        fillOutParamsWithOMTensors(module, rewriter, loc, apiRegistry,
+            wrappedOutput,
+            staticEntryPointTy.getParams().drop_front(endInputParam),
+            outSigJSON, outParams);
     }
 
     Value omTensorPtrArr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
         RuntimeAPI::API::GET_OMT_ARRAY, {wrappedInput});
     Value one = create.llvm.constant(int64Ty, (int64_t)1);
 
-    // Create a memref type for the return argument of the iface call
-    Type memRefOutPtrTy = staticEntryPointTy.getParamType(0);
-    Value ptrToOutMemRef =
-        create.llvm._alloca(memRefOutPtrTy, one, /*alignment=*/0);
-    staticInputs.emplace_back(ptrToOutMemRef);
+    // Emit code to get the data pointers of the inputs, the ones that are not
+    // aligned to gDefaultAllocAlign being copied into aligned buffers, for
+    // `if (omTensorListGetAlignedDataPtrs() == NULL) then return NULL`. The
+    // entry function assumes that its inputs are aligned.
+    Value alignedDataPtrs;
+    if (alignInputs) {
+      create.llvm.ifThenElse(/*cond=*/
+          [&](LLVMBuilder &createLLVM) {
+            Value alignment =
+                createLLVM.constant(int64Ty, (int64_t)gDefaultAllocAlign);
+            alignedDataPtrs = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+                RuntimeAPI::API::GET_ALIGNED_DATA_PTRS,
+                {wrappedInput, alignment});
+            return createLLVM.icmp(LLVM::ICmpPredicate::eq, alignedDataPtrs,
+                createLLVM.null(alignedDataPtrs.getType()));
+          }, /*then=*/
+          [&](LLVMBuilder &createLLVM) {
+            // return NULL.
+            createLLVM._return(createLLVM.nullI8Ptr());
+          });
+    }
 
-    // Start with param 1 because 0 is the return value
-    for (size_t i = 1; i < staticEntryPointTy.getNumParams(); i++) {
+    Value ptrToOutMemRef;
+    if (!inPlace) {
+      ptrToOutMemRef =
+          create.llvm._alloca(memRefOutPtrTy, one, /*alignment=*/0);
+      staticInputs.emplace_back(ptrToOutMemRef);
+    }
+
+    // Start with param 1 because 0 is the return value, unless in place.
+    for (size_t i = firstInputParam; i < endInputParam; i++) {
       // Call API function to retrieve the i-th dynamic memref.
-      Value idxVal = create.llvm.constant(int64Ty, (int64_t)(i - 1));
+      Value idxVal =
+          create.llvm.constant(int64Ty, (int64_t)(i - firstInputParam));
 
       Type omTensorPtrAddrTy = LLVM::LLVMPointerType::get(opaquePtrTy);
       Value omTensorPtrAddr =
@@ -204,18 +359,41 @@ public:
       Value ptrToMemRef =
           create.llvm._alloca(memRefPtrTy, one, /*alignment=*/0);
 
+      // Get the aligned data pointer of the i-th input, if any.
+      Value alignedDataPtr;
+      if (alignInputs) {
+        Value alignedDataPtrAddr = create.llvm.getElemPtr(
+            omTensorPtrAddrTy, alignedDataPtrs, {idxVal});
+        alignedDataPtr = create.llvm.load(alignedDataPtrAddr);
+      }
+
       // Fill in the memref underlying ptrToMemRef with information extracted
       // from omTensorPtr.
-      fillPtrToMemRefWithOMTensor(
-          omTensorPtr, ptrToMemRef, rewriter, loc, apiRegistry, module);
+      fillPtrToMemRefWithOMTensor(omTensorPtr, ptrToMemRef, rewriter, loc,
+          apiRegistry, module, alignedDataPtr);
 
       // ptrToMemRef will be an input to main computation graph function.
       staticInputs.emplace_back(ptrToMemRef);
     }
 
     // Call static entry point with the memref ptrs created, and get output.
+    llvm::append_range(staticInputs, outParams);
     create.llvm.call({}, wrappedStaticEntryPointFuncName, staticInputs);
+
+    // Free the aligned copies of the inputs, which the outputs do not alias
+    // when the inputs are aligned.
+    if (alignInputs)
+      RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::FREE_ALIGNED_DATA_PTRS,
+          {wrappedInput, alignedDataPtrs});
+
+    // The results were written into the preallocated output tensors.
+    if (inPlace) {
+      create.llvm._return(wrappedOutput);
+      return dynamicEntryPointFunc;
+    }
     Value outMemRefs = create.llvm.load(ptrToOutMemRef);
+
     auto outMemRefsType = outMemRefs.getType().dyn_cast<LLVM::LLVMStructType>();
 
     std::vector<mlir::Value> outMemRefList;
@@ -234,6 +412,15 @@ public:
       }
     }
 
+    if (runInto) {
+      // Copy the results into the preallocated output tensors, then return
+      // the wrapped output given by the caller.
+      copyMemRefsIntoOMTensors(module, rewriter, loc, apiRegistry,
+          outMemRefList, outputOwnerships, wrappedOutput);
+      create.llvm._return(wrappedOutput);
+      return dynamicEntryPointFunc;
+    }
+
     Value numOutput =
         create.llvm.constant(int64Ty, (int64_t)outMemRefList.size());
 
@@ -260,7 +447,7 @@ public:
           RuntimeAPI::API::CREATE_OMTENSOR, {outMemRefRankVal});
       // If output is a constant tensor or a block argument, OMTensor does not
       // own it.
-      bool outOwning = outputOMTensorOwnerships[i];
+      bool outOwning = outputOwnerships[i];
       LLVM_DEBUG(llvm::dbgs() << "Output OMTensor " << i
                               << " with owning = " << outOwning << "\n");
       krnl::fillOMTensorWithMemRef(
@@ -276,15 +463,14 @@ public:
     }
 
     // Create wrapped output.
-    Value wrappedOutput = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+    Value wrappedOutputList = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
         RuntimeAPI::API::CREATE_OMTENSOR_LIST, {outOmtPtrsArr, numOutput, one});
 
     // Return wrapped output.
-    create.llvm._return(wrappedOutput);
-    return success();
+    create.llvm._return(wrappedOutputList);
+    return dynamicEntryPointFunc;
   }
 
-private:
   // Helper function to insert an entry block to LLVM function.
   // (TODO): upstream this to MLIR.
   Block &createEntryBlock(Type &dynEntryPoint,
@@ -304,7 +490,8 @@ private:
 
   void fillPtrToMemRefWithOMTensor(Value &rtMemRef, Value &ptrToMemRef,
       PatternRewriter &rewriter, const Location &loc,
-      const RuntimeAPIRegistry &apiRegistry, ModuleOp &module) const {
+      const RuntimeAPIRegistry &apiRegistry, ModuleOp &module,
+      Value alignedDataPtr = nullptr) const {
     MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
     auto *context = module.getContext();
     auto memRefPtrTy = ptrToMemRef.getType().dyn_cast<LLVM::LLVMPointerType>();
@@ -313,9 +500,12 @@ private:
 
     Value memRef = rewriter.create<LLVM::UndefOp>(loc, memRefTy);
 
-    // Set dataPtr and alignedDataPtr;
-    Value dataPtr = RuntimeAPI::callApi(
-        rewriter, loc, apiRegistry, RuntimeAPI::API::GET_DATA, {rtMemRef});
+    // Set dataPtr and alignedDataPtr, using the aligned copy of the data if
+    // given.
+    Value dataPtr = alignedDataPtr;
+    if (!dataPtr)
+      dataPtr = RuntimeAPI::callApi(
+          rewriter, loc, apiRegistry, RuntimeAPI::API::GET_DATA, {rtMemRef});
     dataPtr = create.llvm.bitcast(
         memRefTy.cast<LLVM::LLVMStructType>().getBody()[0], dataPtr);
     memRef = create.llvm.insertValue(memRefTy, memRef, dataPtr, {0});
@@ -407,18 +597,83 @@ private:
         });
   }
 
+  // Emit code verifying the wrapped input against the input signature at
+  // once, with a runtime call comparing the data types and shapes of the
+  // tensors to a signature packed into a global at compile time. Only when it
+  // fails are the tensors verified one check at a time, to print the message
+  // describing the first mismatch.
   void emitVerificationCodeForInputTensors(ModuleOp &module,
       PatternRewriter &rewriter, Location loc,
       const RuntimeAPIRegistry &apiRegistry, Value wrappedInput,
-      StringRef inSigJSON) const {
-    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+      StringRef staticEntryPointFuncName, StringRef inSigJSON) const {
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
     Type int64Ty = rewriter.getI64Type();
-    Type opaquePtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
 
     auto JSONInput = llvm::json::parse(inSigJSON.data());
     assert(JSONInput && "failed to parse json");
     auto JSONArray = JSONInput->getAsArray();
     assert(JSONArray && "failed to parse json as array");
+
+    // Pack the number of inputs, then the data type, the rank and the dims of
+    // each input, the unknown dims being -1.
+    SmallVector<int64_t, 32> packedSig = {(int64_t)JSONArray->size()};
+    for (const llvm::json::Value &JSONValue : *JSONArray) {
+      auto JSONItem = JSONValue.getAsObject();
+      auto JSONItemType = JSONItem->getString("type");
+      assert(JSONItemType && "failed to get type");
+      Type elemTy = parseType(JSONItemType.value(), rewriter.getContext());
+      packedSig.emplace_back(krnl::mlirTypeToOnnxType(elemTy));
+      auto JSONDimArray = JSONItem->getArray("dims");
+      packedSig.emplace_back(JSONDimArray->size());
+      for (const llvm::json::Value &JSONDim : *JSONDimArray) {
+        auto JSONDimValue = JSONDim.getAsInteger();
+        assert(JSONDimValue && "failed to get value");
+        int64_t dim = JSONDimValue.value();
+        packedSig.emplace_back(
+            (ShapedType::isDynamic(dim) || dim == -1) ? -1 : dim);
+      }
+    }
+
+    // The run and run into variants of the entry point share the global.
+    std::string packedSigName =
+        "_" + staticEntryPointFuncName.str() + "_in_sig_packed";
+    auto packedSigGlobal = module.lookupSymbol<LLVM::GlobalOp>(packedSigName);
+    if (!packedSigGlobal) {
+      OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(module.getBody());
+      auto packedSigType = RankedTensorType::get(
+          {(int64_t)packedSig.size()}, rewriter.getI64Type());
+      packedSigGlobal = create.llvm.globalOp(
+          LLVM::LLVMArrayType::get(int64Ty, packedSig.size()),
+          /*isConstant=*/true, LLVM::Linkage::Internal, packedSigName,
+          DenseElementsAttr::get(packedSigType, ArrayRef(packedSig)));
+    }
+
+    create.llvm.ifThenElse(/*cond=*/
+        [&](LLVMBuilder &createLLVM) {
+          Value packedSigAddr = createLLVM.bitcast(
+              LLVM::LLVMPointerType::get(int64Ty),
+              createLLVM.addressOf(packedSigGlobal));
+          Value hasSignature = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+              RuntimeAPI::API::HAS_SIGNATURE, {wrappedInput, packedSigAddr});
+          return createLLVM.icmp(LLVM::ICmpPredicate::eq, hasSignature,
+              createLLVM.constant(int64Ty, (int64_t)0));
+        }, /*then=*/
+        [&](LLVMBuilder &createLLVM) {
+          emitDetailedVerificationCodeForInputTensors(
+              module, rewriter, loc, apiRegistry, wrappedInput, JSONArray);
+        });
+  }
+
+  // Emit code verifying the tensors of the wrapped input one check at a time,
+  // printing a message and returning NULL at the first mismatch.
+  void emitDetailedVerificationCodeForInputTensors(ModuleOp &module,
+      PatternRewriter &rewriter, Location loc,
+      const RuntimeAPIRegistry &apiRegistry, Value wrappedInput,
+      const llvm::json::Array *JSONArray) const {
+    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+    Type int64Ty = rewriter.getI64Type();
+    Type opaquePtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
     int64_t inputNum = JSONArray->size();
 
     // Verify the number of inputs.
@@ -484,7 +739,7 @@ private:
           // the actual dimension size is a non-negative value.
           create.llvm.ifThenElse(/*cond=*/
               [&](LLVMBuilder &createLLVM) {
-                Value zero = createLLVM.constant(int64Ty, (int64_t)d);
+                Value zero = createLLVM.constant(int64Ty, (int64_t)0);
                 return createLLVM.icmp(
                     LLVM::ICmpPredicate::slt, actualDim, zero);
               }, /*then=*/
@@ -514,6 +769,290 @@ private:
     }
   }
 
+  void emitVerificationCodeForOutputTensors(ModuleOp &module,
+      PatternRewriter &rewriter, Location loc,
+      const RuntimeAPIRegistry &apiRegistry, Value wrappedOutput,
+      ArrayRef<Type> outMemRefTys) const {
+    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+    Type int64Ty = rewriter.getI64Type();
+    Type opaquePtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+    int64_t outputNum = outMemRefTys.size();
+
+    // Verify the number of outputs.
+    equalOrFailed(module, rewriter, loc,
+        create.llvm.constant(int64Ty, outputNum),
+        RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+            RuntimeAPI::API::GET_OMTENSOR_LIST_SIZE, {wrappedOutput}),
+        "Wrong number of output tensors: expect " + std::to_string(outputNum) +
+            ", but got ");
+
+    // Get a pointer to the list of output omTensors.
+    Value omTensorPtrArr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+        RuntimeAPI::API::GET_OMT_ARRAY, {wrappedOutput});
+    for (int64_t i = 0; i < outputNum; ++i) {
+      // Call API function to retrieve the i-th omTensor.
+      Value idxVal = create.llvm.constant(int64Ty, i);
+      Value omTensorPtrAddr = create.llvm.getElemPtr(
+          LLVM::LLVMPointerType::get(opaquePtrTy), omTensorPtrArr, {idxVal});
+      Value omTensorPtr = create.llvm.load(omTensorPtrAddr);
+
+      // Verify data type.
+      auto outMemRefTy = outMemRefTys[i].cast<LLVM::LLVMStructType>();
+      Type elemTy = outMemRefTy.getBody()[0]
+                        .cast<LLVM::LLVMPointerType>()
+                        .getElementType();
+      std::string elemTyStr;
+      llvm::raw_string_ostream dstream(elemTyStr);
+      dstream << elemTy;
+      dstream.flush();
+      int64_t dtype = krnl::mlirTypeToOnnxType(elemTy);
+      equalOrFailed(module, rewriter, loc, create.llvm.constant(int64Ty, dtype),
+          RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+              RuntimeAPI::API::GET_DATA_TYPE, {omTensorPtr}),
+          "Wrong data type for the output " + std::to_string(i) +
+              ": expect " + elemTyStr,
+          false);
+
+      // Verify data rank.
+      int64_t rank = krnl::getRankFromMemRefType(outMemRefTy);
+      equalOrFailed(module, rewriter, loc, create.llvm.constant(int64Ty, rank),
+          RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+              RuntimeAPI::API::GET_DATA_RANK, {omTensorPtr}),
+          "Wrong rank for the output " + std::to_string(i) + ": expect " +
+              std::to_string(rank) + ", but got ");
+    }
+  }
+
+  // Emit code to pass the data buffers of the OMTensors in wrappedOutput,
+  // preallocated by the caller, as the output arguments of the static entry
+  // point, whose types are pointed to by outMemRefPtrTys. The results have
+  // static shapes, the ones of the output signature. The buffer sizes are
+  // all checked, and the shapes and strides of the OMTensors are set to the
+  // ones of the results, before the memrefs are filled from the OMTensors.
+  void fillOutParamsWithOMTensors(ModuleOp &module, PatternRewriter &rewriter,
+      Location loc, const RuntimeAPIRegistry &apiRegistry, Value wrappedOutput,
+      ArrayRef<Type> outMemRefPtrTys, StringRef outSigJSON,
+      SmallVectorImpl<Value> &outParams) const {
+    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+    Type int64Ty = rewriter.getI64Type();
+    Type opaquePtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+    Value one = create.llvm.constant(int64Ty, (int64_t)1);
+    auto JSONOutput = llvm::json::parse(outSigJSON.data());
+    assert(JSONOutput && "failed to parse json");
+    auto JSONArray = JSONOutput->getAsArray();
+    assert(JSONArray && JSONArray->size() == outMemRefPtrTys.size() &&
+           "failed to parse json as an array of the outputs");
+
+    Value omTensorPtrArr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+        RuntimeAPI::API::GET_OMT_ARRAY, {wrappedOutput});
+    SmallVector<Value, 4> outOMTensors;
+    SmallVector<SmallVector<int64_t, 4>, 4> outShapes;
+    for (size_t i = 0; i < outMemRefPtrTys.size(); ++i) {
+      auto outMemRefTy = outMemRefPtrTys[i]
+                             .cast<LLVM::LLVMPointerType>()
+                             .getElementType()
+                             .cast<LLVM::LLVMStructType>();
+      Type elemTy = outMemRefTy.getBody()[0]
+                        .cast<LLVM::LLVMPointerType>()
+                        .getElementType();
+
+      // Static shape and size in bytes of the i-th result.
+      SmallVector<int64_t, 4> &shape = outShapes.emplace_back();
+      int64_t sizeInBytes = getElemSizeInBytes(elemTy);
+      for (const llvm::json::Value &JSONDim :
+          *(*JSONArray)[i].getAsObject()->getArray("dims")) {
+        int64_t dim = JSONDim.getAsInteger().value();
+        assert(dim >= 0 && "expected a static output shape");
+        shape.emplace_back(dim);
+        sizeInBytes *= dim;
+      }
+      assert((int64_t)shape.size() ==
+                 krnl::getRankFromMemRefType(outMemRefTy) &&
+             "output signature and result of different ranks");
+
+      // Call API function to retrieve the i-th omTensor.
+      Value idxVal = create.llvm.constant(int64Ty, (int64_t)i);
+      Value omTensorPtrAddr = create.llvm.getElemPtr(
+          LLVM::LLVMPointerType::get(opaquePtrTy), omTensorPtrArr, {idxVal});
+      Value omTensorPtr = create.llvm.load(omTensorPtrAddr);
+
+      // Verify the buffer size.
+      Value sizeInBytesVal = create.llvm.constant(int64Ty, sizeInBytes);
+      Value bufferSize = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_BUFFER_SIZE, {omTensorPtr});
+      create.llvm.ifThenElse(/*cond=*/
+          [&](LLVMBuilder &createLLVM) {
+            return createLLVM.icmp(
+                LLVM::ICmpPredicate::ne, sizeInBytesVal, bufferSize);
+          }, /*then=*/
+          [&](LLVMBuilder &createLLVM) {
+            MultiDialectBuilder<LLVMBuilder, KrnlBuilder> create(createLLVM);
+            // Print an error message.
+            std::string msg = "Wrong buffer size in bytes for the output " +
+                              std::to_string(i) + ": expect ";
+            create.krnl.printf(StringRef(msg), sizeInBytesVal, int64Ty, true);
+            // Set errno.
+            krnl::emitErrNo(module, rewriter, loc, EINVAL);
+            // Return NULL.
+            create.llvm._return(create.llvm.nullI8Ptr());
+          });
+      outOMTensors.emplace_back(omTensorPtr);
+    }
+
+    for (size_t i = 0; i < outMemRefPtrTys.size(); ++i) {
+      Value omTensorPtr = outOMTensors[i];
+      ArrayRef<int64_t> shape = outShapes[i];
+
+      // Set the shape and the row-major strides of the result.
+      Value sizesArrayPtr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_SHAPE, {omTensorPtr});
+      Value stridesArrayPtr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_STRIDES, {omTensorPtr});
+      int64_t stride = 1;
+      for (int64_t d = shape.size() - 1; d >= 0; --d) {
+        Value dimIdx = create.llvm.constant(int64Ty, d);
+        create.llvm.store(create.llvm.constant(int64Ty, shape[d]),
+            create.llvm.getElemPtr(
+                LLVM::LLVMPointerType::get(int64Ty), sizesArrayPtr, {dimIdx}));
+        create.llvm.store(create.llvm.constant(int64Ty, stride),
+            create.llvm.getElemPtr(LLVM::LLVMPointerType::get(int64Ty),
+                stridesArrayPtr, {dimIdx}));
+        stride *= shape[d];
+      }
+
+      // Fill the memref of the output argument from the omTensor.
+      Value ptrToMemRef =
+          create.llvm._alloca(outMemRefPtrTys[i], one, /*alignment=*/0);
+      fillPtrToMemRefWithOMTensor(
+          omTensorPtr, ptrToMemRef, rewriter, loc, apiRegistry, module);
+      outParams.emplace_back(ptrToMemRef);
+    }
+  }
+
+  // Emit code to copy the results of the static entry point into the
+  // preallocated OMTensors in wrappedOutput. The buffer sizes, which may depend
+  // on dynamic dimensions, are all checked before anything is copied. The
+  // results owned by the model are freed, since no OMTensor refers to them.
+  void copyMemRefsIntoOMTensors(ModuleOp &module, PatternRewriter &rewriter,
+      Location loc, const RuntimeAPIRegistry &apiRegistry,
+      ArrayRef<Value> outMemRefs, ArrayRef<bool> outputOwnerships,
+      Value wrappedOutput) const {
+    MultiDialectBuilder<KrnlBuilder, LLVMBuilder> create(rewriter, loc);
+    MLIRContext *context = module.getContext();
+    Type int64Ty = rewriter.getI64Type();
+    Type opaquePtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+    FlatSymbolRefAttr memcpyRef = create.llvm.getOrInsertSymbolRef(module,
+        StringRef("llvm.memcpy.p0.p0.i64"), LLVM::LLVMVoidType::get(context),
+        {opaquePtrTy, opaquePtrTy, int64Ty, rewriter.getI1Type()});
+    FlatSymbolRefAttr freeRef = create.llvm.getOrInsertSymbolRef(module,
+        StringRef("free"), LLVM::LLVMVoidType::get(context), {opaquePtrTy});
+
+    // Free the results owned by the model.
+    auto freeOwnedMemRefs = [&](const LLVMBuilder &createLLVM) {
+      for (unsigned int i = 0; i < outMemRefs.size(); ++i) {
+        if (!outputOwnerships[i])
+          continue;
+        Value memRef = outMemRefs[i];
+        Type allocatedPtrTy =
+            memRef.getType().cast<LLVM::LLVMStructType>().getBody()[0];
+        Value allocatedPtr = createLLVM.bitcastI8Ptr(
+            createLLVM.extractValue(allocatedPtrTy, memRef, {0}));
+        createLLVM.call({}, freeRef, {allocatedPtr});
+      }
+    };
+
+    Value omTensorPtrArr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+        RuntimeAPI::API::GET_OMT_ARRAY, {wrappedOutput});
+    SmallVector<Value, 4> outOMTensors, sizesInBytes;
+    for (unsigned int i = 0; i < outMemRefs.size(); ++i) {
+      Value memRef = outMemRefs[i];
+      auto outMemRefTy = memRef.getType().cast<LLVM::LLVMStructType>();
+      int64_t rank = krnl::getRankFromMemRefType(outMemRefTy);
+      Type elemTy = outMemRefTy.getBody()[0]
+                        .cast<LLVM::LLVMPointerType>()
+                        .getElementType();
+
+      // Compute the size in bytes of the i-th result.
+      Value sizeInBytes =
+          create.llvm.constant(int64Ty, getElemSizeInBytes(elemTy));
+      for (int64_t d = 0; d < rank; ++d) {
+        Value dimSize = create.llvm.extractValue(int64Ty, memRef, {3, d});
+        sizeInBytes = create.llvm.mul(sizeInBytes, dimSize);
+      }
+
+      // Call API function to retrieve the i-th omTensor.
+      Value idxVal = create.llvm.constant(int64Ty, (int64_t)i);
+      Value omTensorPtrAddr = create.llvm.getElemPtr(
+          LLVM::LLVMPointerType::get(opaquePtrTy), omTensorPtrArr, {idxVal});
+      Value omTensorPtr = create.llvm.load(omTensorPtrAddr);
+
+      // Verify the buffer size.
+      Value bufferSize = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_BUFFER_SIZE, {omTensorPtr});
+      create.llvm.ifThenElse(/*cond=*/
+          [&](LLVMBuilder &createLLVM) {
+            return createLLVM.icmp(
+                LLVM::ICmpPredicate::ne, sizeInBytes, bufferSize);
+          }, /*then=*/
+          [&](LLVMBuilder &createLLVM) {
+            MultiDialectBuilder<LLVMBuilder, KrnlBuilder> create(createLLVM);
+            // Print an error message.
+            std::string msg = "Wrong buffer size in bytes for the output " +
+                              std::to_string(i) + ": expect ";
+            create.krnl.printf(StringRef(msg), sizeInBytes, int64Ty, true);
+            freeOwnedMemRefs(create.llvm);
+            // Set errno.
+            krnl::emitErrNo(module, rewriter, loc, EINVAL);
+            // Return NULL.
+            create.llvm._return(create.llvm.nullI8Ptr());
+          });
+      outOMTensors.emplace_back(omTensorPtr);
+      sizesInBytes.emplace_back(sizeInBytes);
+    }
+
+    for (unsigned int i = 0; i < outMemRefs.size(); ++i) {
+      Value memRef = outMemRefs[i];
+      Value omTensorPtr = outOMTensors[i];
+      auto outMemRefTy = memRef.getType().cast<LLVM::LLVMStructType>();
+      int64_t rank = krnl::getRankFromMemRefType(outMemRefTy);
+
+      // Copy the data.
+      Value alignedPtr = create.llvm.bitcastI8Ptr(
+          create.llvm.extractValue(outMemRefTy.getBody()[1], memRef, {1}));
+      Value dataPtr = RuntimeAPI::callApi(
+          rewriter, loc, apiRegistry, RuntimeAPI::API::GET_DATA, {omTensorPtr});
+      Value isVolatile = create.llvm.constant(rewriter.getI1Type(), (int64_t)0);
+      create.llvm.call(
+          {}, memcpyRef, {dataPtr, alignedPtr, sizesInBytes[i], isVolatile});
+
+      // Transfer the shape and strides, which may be dynamic.
+      Value sizesArrayPtr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_SHAPE, {omTensorPtr});
+      Value stridesArrayPtr = RuntimeAPI::callApi(rewriter, loc, apiRegistry,
+          RuntimeAPI::API::GET_DATA_STRIDES, {omTensorPtr});
+      for (int64_t d = 0; d < rank; ++d) {
+        Value dimIdx = create.llvm.constant(int64Ty, d);
+        Value dimSize = create.llvm.extractValue(int64Ty, memRef, {3, d});
+        create.llvm.store(dimSize,
+            create.llvm.getElemPtr(
+                LLVM::LLVMPointerType::get(int64Ty), sizesArrayPtr, {dimIdx}));
+        Value dimStride = create.llvm.extractValue(int64Ty, memRef, {4, d});
+        create.llvm.store(dimStride,
+            create.llvm.getElemPtr(LLVM::LLVMPointerType::get(int64Ty),
+                stridesArrayPtr, {dimIdx}));
+      }
+    }
+    freeOwnedMemRefs(create.llvm);
+  }
+
+  // Size in bytes of an element of a memref lowered to LLVM.
+  int64_t getElemSizeInBytes(Type elemTy) const {
+    // TODO(tjingrant): get pointer size from data layout.
+    if (elemTy.isa<LLVM::LLVMPointerType>())
+      return 8;
+    return (elemTy.getIntOrFloatBitWidth() + 7) / 8;
+  }
+
   void recordEntryPointSignatures(ModuleOp &module,
       std::string currentEntryPointName, KrnlEntryPointOp entryOp,
       SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
@@ -588,13 +1127,14 @@ private:
 
 void populateLoweringKrnlEntryPointOpPattern(TypeConverter &typeConverter,
     RewritePatternSet &patterns, MLIRContext *ctx,
-    ArrayRef<bool> outputOMTensorOwnerships, bool singleEntryPoint,
-    SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
+    const OutputOMTensorOwnerships &outputOMTensorOwnerships,
+    bool singleEntryPoint, SmallVectorImpl<LLVM::GlobalOp> &entryGlobalOps,
     SmallVectorImpl<LLVM::GlobalOp> &inSigGlobalOps,
-    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors) {
+    SmallVectorImpl<LLVM::GlobalOp> &outSigGlobalOps, bool verifyInputTensors,
+    bool alignInputs) {
   patterns.insert<KrnlEntryPointOpLowering>(typeConverter, ctx,
       outputOMTensorOwnerships, singleEntryPoint, entryGlobalOps,
-      inSigGlobalOps, outSigGlobalOps, verifyInputTensors);
+      inSigGlobalOps, outSigGlobalOps, verifyInputTensors, alignInputs);
 }
 
 } // namespace krnl
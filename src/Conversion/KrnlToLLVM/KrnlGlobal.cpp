@@ -18,6 +18,7 @@
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
 
+#include "src/Conversion/KrnlToLLVM/ConvertKrnlToLLVM.hpp"
 #include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
 #include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "src/Support/KrnlSupport.hpp"
@@ -59,31 +60,80 @@ public:
             globalType.cast<Type>(), ArrayAttrIntVal(shape, i));
     }
 
-    // Create the global at the entry of the module.
+    // Constants stored into a file are read from the mapped file, or from the
+    // mapped section of the file, at the offset recorded when the file was
+    // written.
+    if (auto offsetAttr = krnlGlobalOp->getAttrOfType<IntegerAttr>(
+            CONSTANTS_FILE_OFFSET_ATTR)) {
+      ModuleOp module = krnlGlobalOp->getParentOfType<ModuleOp>();
+      Type i8PtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+      int64_t section = -1;
+      if (auto sectionAttr = krnlGlobalOp->getAttrOfType<IntegerAttr>(
+              CONSTANTS_FILE_SECTION_ATTR))
+        section = sectionAttr.getInt();
+      Value fileAddr =
+          krnl::emitMMapConstantsFile(module, rewriter, loc, section);
+      Value offset =
+          create.llvm.constant(rewriter.getI64Type(), offsetAttr.getInt());
+      Value dataAddr = create.llvm.getElemPtr(i8PtrTy, fileAddr, {offset});
+      dataAddr = partitionAcrossNumaNodes(krnlGlobalOp, dataAddr, rewriter);
+      MemRefDescriptor memRefDescr =
+          createMemRefDescriptor(dataAddr, memRefTy, loc, rewriter);
+      rewriter.replaceOp(op, {memRefDescr});
+      return success();
+    }
+
+    // Constants stored into the constants object are read from its global,
+    // at the offset recorded when its data was written.
+    if (auto offsetAttr = krnlGlobalOp->getAttrOfType<IntegerAttr>(
+            CONSTANTS_OBJECT_OFFSET_ATTR)) {
+      ModuleOp module = krnlGlobalOp->getParentOfType<ModuleOp>();
+      Type i8PtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+      auto objectGlobal =
+          module.lookupSymbol<LLVM::GlobalOp>(CONSTANTS_OBJECT_GLOBAL);
+      assert(objectGlobal && "Constants object global not declared");
+      Value objectAddr =
+          create.llvm.bitcastI8Ptr(create.llvm.addressOf(objectGlobal));
+      Value offset =
+          create.llvm.constant(rewriter.getI64Type(), offsetAttr.getInt());
+      Value dataAddr = create.llvm.getElemPtr(i8PtrTy, objectAddr, {offset});
+      dataAddr = partitionAcrossNumaNodes(krnlGlobalOp, dataAddr, rewriter);
+      MemRefDescriptor memRefDescr =
+          createMemRefDescriptor(dataAddr, memRefTy, loc, rewriter);
+      rewriter.replaceOp(op, {memRefDescr});
+      return success();
+    }
+
+    // Create the global at the entry of the module, unless a KrnlGlobalOp with
+    // the same name, and thus the same value, has already created it.
     assert(krnlGlobalOp.getValue().has_value() &&
            "Krnl Global must always have a value");
     auto value = krnlGlobalOp.getValue().value();
-    LLVM::GlobalOp global;
-    TypeSwitch<Attribute>(value)
-        .Case<DenseResourceElementsAttr>([&](DenseResourceElementsAttr attr) {
-          global =
-              lowerDenseResourceConstant(krnlGlobalOp, globalType, rewriter);
-        })
-        .Case<DenseElementsAttr>([&](DenseElementsAttr attr) {
-          global = lowerDenseConstant(krnlGlobalOp, globalType, rewriter);
-        })
-        .Default([&](Attribute attr) {
-          llvm_unreachable("Unsupported attribute type");
-        });
+    ModuleOp module = krnlGlobalOp->getParentOfType<ModuleOp>();
+    LLVM::GlobalOp global =
+        module.lookupSymbol<LLVM::GlobalOp>(krnlGlobalOp.getName());
+    if (!global)
+      TypeSwitch<Attribute>(value)
+          .Case<DenseResourceElementsAttr>([&](DenseResourceElementsAttr attr) {
+            global =
+                lowerDenseResourceConstant(krnlGlobalOp, globalType, rewriter);
+          })
+          .Case<DenseElementsAttr>([&](DenseElementsAttr attr) {
+            global = lowerDenseConstant(krnlGlobalOp, globalType, rewriter);
+          })
+          .Default([&](Attribute attr) {
+            llvm_unreachable("Unsupported attribute type");
+          });
 
     // Set the global alignment based on the alignment attribute if it exists,
     // otherwise use the module datalayout info.
-    krnl::setAlignment(global, krnlGlobalOp.getAlignmentAttr(),
-        krnlGlobalOp->getParentOfType<ModuleOp>(), rewriter,
-        *getTypeConverter());
+    krnl::setAlignment(global, krnlGlobalOp.getAlignmentAttr(), module,
+        rewriter, *getTypeConverter());
 
     // Prepare data to be inserted into a MemRefDescriptor (a struct).
     Value globalOpAddr = create.llvm.addressOf(global);
+    globalOpAddr =
+        partitionAcrossNumaNodes(krnlGlobalOp, globalOpAddr, rewriter);
     MemRefDescriptor memRefDescr =
         createMemRefDescriptor(globalOpAddr, memRefTy, loc, rewriter);
 
@@ -194,6 +244,53 @@ private:
     return numElements * getMemRefEltSizeInBytes(memRefTy);
   }
 
+  // Return the address of the copy of the data of the KrnlGlobalOp whose
+  // parts are placed on the NUMA nodes running the iterations reading them,
+  // made at its first use, if the KrnlGlobalOp has the
+  // KRNL_GLOBAL_NUMA_PARTITIONS_ATTR attribute, or else the given address of
+  // its data.
+  Value partitionAcrossNumaNodes(KrnlGlobalOp &krnlGlobalOp, Value dataAddr,
+      ConversionPatternRewriter &rewriter) const {
+    auto numPartsAttr = krnlGlobalOp->getAttrOfType<IntegerAttr>(
+        KRNL_GLOBAL_NUMA_PARTITIONS_ATTR);
+    if (!numPartsAttr)
+      return dataAddr;
+    Location loc = krnlGlobalOp.getLoc();
+    ModuleOp module = krnlGlobalOp->getParentOfType<ModuleOp>();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    Type i8PtrTy = LLVM::LLVMPointerType::get(rewriter.getI8Type());
+    Type i8PtrPtrTy = LLVM::LLVMPointerType::get(i8PtrTy);
+    Type i64Ty = rewriter.getI64Type();
+
+    // The address of the copy is cached in a global, null until the first
+    // use.
+    std::string addrName = (krnlGlobalOp.getName() + "_numa_addr").str();
+    auto addrGlobal = module.lookupSymbol<LLVM::GlobalOp>(addrName);
+    if (!addrGlobal) {
+      OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(module.getBody());
+      addrGlobal = create.llvm.globalOp(i8PtrTy,
+          /*isConstant=*/false, LLVM::Linkage::Internal, addrName, Attribute());
+      Block *block = rewriter.createBlock(&addrGlobal.getInitializerRegion());
+      rewriter.setInsertionPointToStart(block);
+      create.llvm._return(create.llvm.nullI8Ptr());
+    }
+
+    // Create 'omNumaPartitionConstant' function signature:
+    // `i8* (i8**, i8*, i64, i64)`
+    FlatSymbolRefAttr funcRef = create.llvm.getOrInsertSymbolRef(module,
+        StringRef(NUMA_PARTITION_CONSTANT_FUNC), i8PtrTy,
+        {i8PtrPtrTy, i8PtrTy, i64Ty, i64Ty});
+    Value addrPtr = create.llvm.addressOf(addrGlobal);
+    Value data = dataAddr.getType() == i8PtrTy
+                     ? dataAddr
+                     : create.llvm.bitcastI8Ptr(dataAddr);
+    Value size = create.llvm.constant(i64Ty, computeSizeInBytes(krnlGlobalOp));
+    Value numParts = create.llvm.constant(i64Ty, numPartsAttr.getInt());
+    return create.llvm.call(
+        i8PtrTy, funcRef, ArrayRef<Value>({addrPtr, data, size, numParts}));
+  }
+
   // Store the given address into a MemRefDescriptor (a struct).
   MemRefDescriptor createMemRefDescriptor(Value address, MemRefType memRefType,
       Location loc, OpBuilder &builder) const {
@@ -211,8 +308,12 @@ private:
         builder, loc, typeConverter, memRefType, bitCastOp);
   }
 
-  // Generate a global string for each krnlGlobalOp string value, and store
-  // the address of the global strings into an array. Return the array address.
+  // Generate a global holding the krnlGlobalOp string values back to back,
+  // each one with its null terminator, and store the addresses of the strings
+  // into an array. Return the array address. The strings being contiguous,
+  // the lookups scanning them, e.g. of CategoryMapper, stay in a few cache
+  // lines, and the strings compared with strncmp past their end are
+  // terminated.
   LLVM::GlobalOp lowerStringLiteral(
       KrnlGlobalOp &krnlGlobalOp, Type globalType, OpBuilder &builder) const {
     assert(krnlGlobalOp.getValue().value().isa<DenseElementsAttr>() &&
@@ -227,33 +328,45 @@ private:
 
     Type i8Type = IntegerType::get(builder.getContext(), 8);
     Type i8PtrType = LLVM::LLVMPointerType::get(i8Type);
+    Type i64Type = IntegerType::get(builder.getContext(), 64);
 
-    // Generate LLVM GlobalOps for each string in the KrnlGlobalOp dense
-    // attribute.
-    SmallVector<LLVM::GlobalOp> globalOps;
+    // Generate an LLVM GlobalOp for the characters of all the strings in the
+    // KrnlGlobalOp dense attribute.
+    std::string chars;
+    SmallVector<int64_t> offsets;
     for (StringRef str : denseAttr.getValues<StringRef>()) {
-      LLVM::GlobalOp globalOp = krnl::getOrCreateGlobalString(
-          str, loc, builder, module, getTypeConverter());
-      globalOps.push_back(globalOp);
+      offsets.emplace_back(chars.size());
+      chars.append(str.begin(), str.end());
+      chars.push_back('\0');
     }
+    auto charsType = LLVM::LLVMArrayType::get(i8Type, chars.size());
+    std::string charsName = (krnlGlobalOp.getName() + "_chars").str();
+    LLVM::GlobalOp charsGlobal = create.llvm.globalOp(charsType,
+        /*isConstant=*/true, LLVM::Linkage::Internal, charsName,
+        StringAttr::get(builder.getContext(), StringRef(chars)));
+    krnl::setAlignment(
+        charsGlobal, nullptr, module, builder, *getTypeConverter());
 
     // Generate an LLVM GlobalOps with an initializer region containing one
     // block.
-    auto arrayType = LLVM::LLVMArrayType::get(i8PtrType, globalOps.size());
+    auto arrayType = LLVM::LLVMArrayType::get(i8PtrType, offsets.size());
     auto global = create.llvm.globalOp(arrayType,
         /*isConstant=*/true, LLVM::Linkage::Internal, krnlGlobalOp.getName(),
         Attribute());
     Region &region = global.getInitializerRegion();
     Block *block = builder.createBlock(&region);
 
-    // Initialize an array with the addresses of the global strings.
+    // Initialize an array with the addresses of the strings.
     builder.setInsertionPoint(block, block->begin());
     Value array = builder.create<LLVM::UndefOp>(loc, arrayType);
+    Value charsAddr = create.llvm.addressOf(charsGlobal);
+    Value zero = create.llvm.constant(i64Type, (int64_t)0);
 
     int32_t index = 0;
     Value lastValue = array;
-    for (const LLVM::GlobalOp &globalOp : globalOps) {
-      Value strAddr = krnl::getPtrToGlobalString(globalOp, loc, builder);
+    for (int64_t offset : offsets) {
+      Value strAddr = create.llvm.getElemPtr(i8PtrType, charsAddr,
+          {zero, create.llvm.constant(i64Type, offset)});
       lastValue =
           create.llvm.insertValue(arrayType, lastValue, strAddr, {index++});
     }
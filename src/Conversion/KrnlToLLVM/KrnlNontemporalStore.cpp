@@ -0,0 +1,102 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ KrnlNontemporalStore.cpp - Lower Nontemporal Stores -----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the memref and vector stores marked nontemporal by the
+// lowering of the Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+
+#include "src/Conversion/KrnlToLLVM/ConvertKrnlToLLVM.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "krnl_to_llvm"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace krnl {
+
+/// A memref.store marked by the gNontemporalAttrName attribute is lowered to a
+/// nontemporal llvm.store. It takes precedence over the default lowering of
+/// memref.store.
+class NontemporalMemRefStoreOpLowering
+    : public ConvertOpToLLVMPattern<memref::StoreOp> {
+public:
+  explicit NontemporalMemRefStoreOpLowering(LLVMTypeConverter &typeConverter)
+      : ConvertOpToLLVMPattern<memref::StoreOp>(typeConverter, 2) {}
+
+  LogicalResult matchAndRewrite(memref::StoreOp storeOp, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    if (!storeOp->hasAttr(gNontemporalAttrName))
+      return failure();
+    Value dataPtr = getStridedElementPtr(storeOp.getLoc(),
+        storeOp.getMemRefType(), adaptor.getMemref(), adaptor.getIndices(),
+        rewriter);
+    rewriter.replaceOpWithNewOp<LLVM::StoreOp>(storeOp, adaptor.getValue(),
+        dataPtr, /*alignment=*/0, /*isVolatile=*/false,
+        /*isNonTemporal=*/true);
+    return success();
+  }
+};
+
+/// A vector.store marked by the gNontemporalAttrName attribute is lowered to a
+/// nontemporal llvm.store. Its address is aligned to the smaller of the vector
+/// size and gDefaultAllocAlign, as the streaming stores of most targets
+/// require their address to be aligned.
+class NontemporalVectorStoreOpLowering
+    : public ConvertOpToLLVMPattern<vector::StoreOp> {
+public:
+  explicit NontemporalVectorStoreOpLowering(LLVMTypeConverter &typeConverter)
+      : ConvertOpToLLVMPattern<vector::StoreOp>(typeConverter, 2) {}
+
+  LogicalResult matchAndRewrite(vector::StoreOp storeOp, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    if (!storeOp->hasAttr(gNontemporalAttrName))
+      return failure();
+    MemRefType memRefType = storeOp.getMemRefType();
+    VectorType vecType = storeOp.getVectorType();
+    if (vecType.getRank() != 1 ||
+        !vecType.getElementType().isIntOrFloat() ||
+        vecType.getElementTypeBitWidth() % 8 != 0)
+      return failure();
+    Location loc = storeOp.getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+
+    Value dataPtr = getStridedElementPtr(loc, memRefType, adaptor.getBase(),
+        adaptor.getIndices(), rewriter);
+    Type vecPtrType =
+        LLVM::LLVMPointerType::get(getTypeConverter()->convertType(vecType),
+            memRefType.getMemorySpaceAsInt());
+    Value vecPtr = create.llvm.bitcast(vecPtrType, dataPtr);
+    int64_t vecSize =
+        vecType.getNumElements() * vecType.getElementTypeBitWidth() / 8;
+    rewriter.replaceOpWithNewOp<LLVM::StoreOp>(storeOp,
+        adaptor.getValueToStore(), vecPtr,
+        /*alignment=*/std::min(vecSize, gDefaultAllocAlign),
+        /*isVolatile=*/false, /*isNonTemporal=*/true);
+    return success();
+  }
+};
+
+void populateLoweringNontemporalStorePattern(LLVMTypeConverter &typeConverter,
+    RewritePatternSet &patterns, MLIRContext *ctx) {
+  patterns.insert<NontemporalMemRefStoreOpLowering,
+      NontemporalVectorStoreOpLowering>(typeConverter);
+}
+
+} // namespace krnl
+} // namespace onnx_mlir
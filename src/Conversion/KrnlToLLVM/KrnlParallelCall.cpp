@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ KrnlParallelCall.cpp - Lower KrnlParallelCallOp ---------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the KrnlParallelCallOp and KrnlTaskGraphCallOp operators.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/LLVMCommon/MemRefBuilder.h"
+#include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+
+#include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "krnl_to_llvm"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace krnl {
+
+namespace {
+
+/// Store the converted args into a context struct on the stack, and return a
+/// pointer to it, or a null pointer without args. The stack pointer to
+/// restore once the call using the context returns is set if the struct is
+/// allocated.
+Value packContext(ConversionPatternRewriter &rewriter, Location loc,
+    ValueRange args, LLVM::LLVMStructType contextTy, Value &stackPtr) {
+  MLIRContext *context = rewriter.getContext();
+  MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+  Type llvmI8PtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+  Type llvmI64Ty = IntegerType::get(context, 64);
+  if (args.empty())
+    return create.llvm.nullI8Ptr();
+  stackPtr = rewriter.create<LLVM::StackSaveOp>(loc, llvmI8PtrTy);
+  Value one = create.llvm.constant(llvmI64Ty, (int64_t)1);
+  Value contextAddr = create.llvm._alloca(
+      LLVM::LLVMPointerType::get(contextTy), one, /*alignment=*/0);
+  Value contextVal = rewriter.create<LLVM::UndefOp>(loc, contextTy);
+  for (size_t i = 0; i < args.size(); ++i)
+    contextVal =
+        create.llvm.insertValue(contextTy, contextVal, args[i], {(int64_t)i});
+  create.llvm.store(contextVal, contextAddr);
+  return create.llvm.bitcastI8Ptr(contextAddr);
+}
+
+/// Return the trampoline of the callee, inserting it into the module if
+/// necessary. Its signature is `void (i8*, i64, i64)`. The args are the
+/// unconverted args of the call, whose converted values are in the context.
+LLVM::LLVMFuncOp getOrInsertTrampoline(PatternRewriter &rewriter,
+    ModuleOp module, Location loc, FlatSymbolRefAttr callee, ValueRange args,
+    LLVM::LLVMStructType contextTy) {
+  MLIRContext *context = module.getContext();
+  std::string name = (callee.getValue() + "_trampoline").str();
+  if (auto trampoline = module.lookupSymbol<LLVM::LLVMFuncOp>(name))
+    return trampoline;
+
+  MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+  Type llvmVoidTy = LLVM::LLVMVoidType::get(context);
+  Type llvmI8PtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+  Type llvmI64Ty = IntegerType::get(context, 64);
+  auto trampolineTy = LLVM::LLVMFunctionType::get(
+      llvmVoidTy, {llvmI8PtrTy, llvmI64Ty, llvmI64Ty}, /*isVarArg=*/false);
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(module.getBody());
+  auto trampoline = rewriter.create<LLVM::LLVMFuncOp>(
+      loc, name, trampolineTy, LLVM::Linkage::Internal);
+  Block *entryBlock = trampoline.addEntryBlock();
+  rewriter.setInsertionPointToStart(entryBlock);
+
+  // Call the callee with the bounds of the range followed by the args.
+  SmallVector<Value, 16> calleeArgs = {
+      entryBlock->getArgument(1), entryBlock->getArgument(2)};
+  if (!args.empty()) {
+    Value contextAddr = create.llvm.bitcast(
+        LLVM::LLVMPointerType::get(contextTy), entryBlock->getArgument(0));
+    Value contextVal = create.llvm.load(contextAddr);
+    for (size_t i = 0; i < args.size(); ++i) {
+      Value arg = create.llvm.extractValue(
+          contextTy.getBody()[i], contextVal, {(int64_t)i});
+      if (auto memRefTy = args[i].getType().dyn_cast<MemRefType>())
+        MemRefDescriptor::unpack(rewriter, loc, arg, memRefTy, calleeArgs);
+      else
+        calleeArgs.emplace_back(arg);
+    }
+  }
+  create.llvm.call({}, callee, calleeArgs);
+  rewriter.create<LLVM::ReturnOp>(loc, ValueRange());
+  return trampoline;
+}
+
+/// Return the struct type of the context holding the converted args.
+LLVM::LLVMStructType getContextType(MLIRContext *context, ValueRange args) {
+  SmallVector<Type, 8> argTypes;
+  for (Value arg : args)
+    argTypes.emplace_back(arg.getType());
+  return LLVM::LLVMStructType::getLiteral(context, argTypes);
+}
+
+} // namespace
+
+/// Lower
+/// ```
+///   krnl.parallel_call @f(%n) (%args)
+/// ```
+/// to a call of the runtime function
+/// ```
+///   void omParallelFor(void (*body)(void *, int64_t, int64_t), void *context,
+///       int64_t numIterations);
+/// ```
+/// where the context is a struct of the args on the stack, and where the body
+/// is a trampoline unpacking the args from the context and calling @f with
+/// the calling convention of converted functions, in which memref descriptors
+/// are expanded into their fields.
+class KrnlParallelCallOpLowering : public ConvertToLLVMPattern {
+public:
+  explicit KrnlParallelCallOpLowering(
+      LLVMTypeConverter &typeConverter, MLIRContext *context)
+      : ConvertToLLVMPattern(
+            KrnlParallelCallOp::getOperationName(), context, typeConverter) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    MLIRContext *context = op->getContext();
+    Location loc = op->getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    KrnlParallelCallOp parallelCallOp = llvm::cast<KrnlParallelCallOp>(op);
+    KrnlParallelCallOpAdaptor operandAdaptor(operands);
+    ModuleOp module = op->getParentOfType<ModuleOp>();
+
+    Type llvmVoidTy = LLVM::LLVMVoidType::get(context);
+    Type llvmI8PtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+    Type llvmI64Ty = IntegerType::get(context, 64);
+
+    // Store the args into a context struct, on the stack until the call
+    // returns.
+    ValueRange args = operandAdaptor.getArgs();
+    auto contextTy = getContextType(context, args);
+    Value stackPtr;
+    Value contextPtr = packContext(rewriter, loc, args, contextTy, stackPtr);
+
+    LLVM::LLVMFuncOp trampoline = getOrInsertTrampoline(rewriter, module, loc,
+        parallelCallOp.getCalleeAttr(), parallelCallOp.getArgs(), contextTy);
+    Value bodyPtr = rewriter.create<LLVM::AddressOfOp>(loc, trampoline);
+    FlatSymbolRefAttr parallelForRef = create.llvm.getOrInsertSymbolRef(module,
+        StringRef("omParallelFor"), llvmVoidTy,
+        {bodyPtr.getType(), llvmI8PtrTy, llvmI64Ty});
+    create.llvm.call({}, parallelForRef,
+        {bodyPtr, contextPtr, operandAdaptor.getNumIterations()});
+    if (stackPtr)
+      rewriter.create<LLVM::StackRestoreOp>(loc, stackPtr);
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+/// Lower
+/// ```
+///   krnl.task_graph_call @f(%args) {predecessorCounts = [...],
+///       successorOffsets = [...], successors = [...]}
+/// ```
+/// to a call of the runtime function
+/// ```
+///   void omRunTaskGraph(void (*body)(void *, int64_t, int64_t),
+///       void *context, int64_t numTasks, const int64_t *predecessorCounts,
+///       const int64_t *successorOffsets, const int64_t *successors);
+/// ```
+/// where the context and the body are those of krnl.parallel_call, and where
+/// the arrays describing the graph are constant globals.
+class KrnlTaskGraphCallOpLowering : public ConvertToLLVMPattern {
+public:
+  explicit KrnlTaskGraphCallOpLowering(
+      LLVMTypeConverter &typeConverter, MLIRContext *context)
+      : ConvertToLLVMPattern(
+            KrnlTaskGraphCallOp::getOperationName(), context, typeConverter) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    MLIRContext *context = op->getContext();
+    Location loc = op->getLoc();
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    KrnlTaskGraphCallOp taskGraphCallOp = llvm::cast<KrnlTaskGraphCallOp>(op);
+    KrnlTaskGraphCallOpAdaptor operandAdaptor(operands);
+    ModuleOp module = op->getParentOfType<ModuleOp>();
+
+    Type llvmVoidTy = LLVM::LLVMVoidType::get(context);
+    Type llvmI8PtrTy = LLVM::LLVMPointerType::get(IntegerType::get(context, 8));
+    Type llvmI64Ty = IntegerType::get(context, 64);
+    Type llvmI64PtrTy = LLVM::LLVMPointerType::get(llvmI64Ty);
+
+    ValueRange args = operandAdaptor.getArgs();
+    auto contextTy = getContextType(context, args);
+    Value stackPtr;
+    Value contextPtr = packContext(rewriter, loc, args, contextTy, stackPtr);
+
+    LLVM::LLVMFuncOp trampoline = getOrInsertTrampoline(rewriter, module, loc,
+        taskGraphCallOp.getCalleeAttr(), taskGraphCallOp.getArgs(), contextTy);
+    Value bodyPtr = rewriter.create<LLVM::AddressOfOp>(loc, trampoline);
+    StringRef callee = taskGraphCallOp.getCallee();
+    Value predecessorCounts = getOrInsertArray(rewriter, module, loc,
+        "_" + callee.str() + "_predecessor_counts",
+        taskGraphCallOp.getPredecessorCounts());
+    Value successorOffsets = getOrInsertArray(rewriter, module, loc,
+        "_" + callee.str() + "_successor_offsets",
+        taskGraphCallOp.getSuccessorOffsets());
+    Value successors = getOrInsertArray(rewriter, module, loc,
+        "_" + callee.str() + "_successors", taskGraphCallOp.getSuccessors());
+    int64_t numTasks = taskGraphCallOp.getPredecessorCounts().size();
+
+    FlatSymbolRefAttr runTaskGraphRef = create.llvm.getOrInsertSymbolRef(
+        module, StringRef("omRunTaskGraph"), llvmVoidTy,
+        {bodyPtr.getType(), llvmI8PtrTy, llvmI64Ty, llvmI64PtrTy, llvmI64PtrTy,
+            llvmI64PtrTy});
+    create.llvm.call({}, runTaskGraphRef,
+        {bodyPtr, contextPtr, create.llvm.constant(llvmI64Ty, numTasks),
+            predecessorCounts, successorOffsets, successors});
+    if (stackPtr)
+      rewriter.create<LLVM::StackRestoreOp>(loc, stackPtr);
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+private:
+  /// Return a pointer to the first element of a constant global array of the
+  /// given values, inserting the global into the module if necessary. Empty
+  /// arrays are given a single element, never read.
+  Value getOrInsertArray(PatternRewriter &rewriter, ModuleOp module,
+      Location loc, StringRef name, ArrayAttr values) const {
+    MultiDialectBuilder<LLVMBuilder> create(rewriter, loc);
+    Type llvmI64Ty = rewriter.getI64Type();
+    auto global = module.lookupSymbol<LLVM::GlobalOp>(name);
+    if (!global) {
+      SmallVector<int64_t, 16> elements;
+      for (Attribute value : values)
+        elements.emplace_back(value.cast<IntegerAttr>().getInt());
+      if (elements.empty())
+        elements.emplace_back(0);
+      OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(module.getBody());
+      auto arrayType =
+          RankedTensorType::get({(int64_t)elements.size()}, llvmI64Ty);
+      global = create.llvm.globalOp(
+          LLVM::LLVMArrayType::get(llvmI64Ty, elements.size()),
+          /*isConstant=*/true, LLVM::Linkage::Internal, name,
+          DenseElementsAttr::get(arrayType, ArrayRef(elements)));
+    }
+    return create.llvm.bitcast(
+        LLVM::LLVMPointerType::get(llvmI64Ty), create.llvm.addressOf(global));
+  }
+};
+
+void populateLoweringKrnlParallelCallOpPattern(LLVMTypeConverter &typeConverter,
+    RewritePatternSet &patterns, MLIRContext *ctx) {
+  patterns.insert<KrnlParallelCallOpLowering>(typeConverter, ctx);
+}
+
+void populateLoweringKrnlTaskGraphCallOpPattern(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    MLIRContext *ctx) {
+  patterns.insert<KrnlTaskGraphCallOpLowering>(typeConverter, ctx);
+}
+
+} // namespace krnl
+} // namespace onnx_mlir
@@ -14,6 +14,7 @@
 
 #include "src/Conversion/KrnlToLLVM/KrnlToLLVMHelper.hpp"
 #include "mlir/Target/LLVMIR/TypeToLLVM.h"
+#include "src/Conversion/KrnlToLLVM/ConvertKrnlToLLVM.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
 #include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
@@ -268,5 +269,86 @@ void emitErrNo(ModuleOp module, OpBuilder &builder, Location loc, int errCode) {
   createLLVM.store(errNoVal, errNoPos);
 }
 
+Value emitMMapConstantsFile(
+    ModuleOp module, OpBuilder &builder, Location loc, int64_t section) {
+  MultiDialectBuilder<LLVMBuilder> create(builder, loc);
+  LLVMBuilder createLLVMModuleLoc(builder, module.getLoc());
+  Type i8PtrTy = LLVM::LLVMPointerType::get(builder.getI8Type());
+  Type i8PtrPtrTy = LLVM::LLVMPointerType::get(i8PtrTy);
+  Type i64Ty = builder.getI64Type();
+
+  auto fileNameGlobal =
+      module.lookupSymbol<LLVM::GlobalOp>(CONSTANTS_FILE_NAME_GLOBAL);
+  // Compressed constants are decompressed instead of mapped.
+  auto storedSizesAttr = module->getAttrOfType<DenseI64ArrayAttr>(
+      CONSTANTS_FILE_STORED_SIZES_ATTR);
+  auto loadCompressed = [&](LLVM::GlobalOp addrGlobal, int64_t offset,
+                            int64_t storedSize, int64_t size) {
+    // Create 'omLoadCompressedConstantsFile' function signature:
+    // `i8* (i8**, i8*, i64, i64, i64)`
+    FlatSymbolRefAttr funcRef = createLLVMModuleLoc.getOrInsertSymbolRef(
+        module, StringRef(LOAD_COMPRESSED_CONSTANTS_FILE_FUNC), i8PtrTy,
+        {i8PtrPtrTy, i8PtrTy, i64Ty, i64Ty, i64Ty});
+    Value addrPtr = create.llvm.addressOf(addrGlobal);
+    Value fileName = getPtrToGlobalString(fileNameGlobal, loc, builder);
+    Value offsetV = create.llvm.constant(i64Ty, offset);
+    Value storedSizeV = create.llvm.constant(i64Ty, storedSize);
+    Value sizeV = create.llvm.constant(i64Ty, size);
+    return create.llvm.call(i8PtrTy, funcRef,
+        ArrayRef<Value>({addrPtr, fileName, offsetV, storedSizeV, sizeV}));
+  };
+  if (section >= 0) {
+    auto addrGlobal = module.lookupSymbol<LLVM::GlobalOp>(
+        CONSTANTS_FILE_ADDR_GLOBAL + "_" + std::to_string(section));
+    auto offsetsAttr = module->getAttrOfType<DenseI64ArrayAttr>(
+        CONSTANTS_FILE_SECTION_OFFSETS_ATTR);
+    auto sizesAttr = module->getAttrOfType<DenseI64ArrayAttr>(
+        CONSTANTS_FILE_SECTION_SIZES_ATTR);
+    assert(fileNameGlobal && addrGlobal && offsetsAttr && sizesAttr &&
+           "Expecting a module with constants stored into file sections");
+    if (storedSizesAttr)
+      return loadCompressed(addrGlobal, offsetsAttr[section],
+          storedSizesAttr[section], sizesAttr[section]);
+
+    // Create 'omMMapConstantsFileSection' function signature:
+    // `i8* (i8**, i8*, i64, i64)`
+    FlatSymbolRefAttr funcRef = createLLVMModuleLoc.getOrInsertSymbolRef(
+        module, StringRef(MMAP_CONSTANTS_FILE_SECTION_FUNC), i8PtrTy,
+        {i8PtrPtrTy, i8PtrTy, i64Ty, i64Ty});
+    Value addrPtr = create.llvm.addressOf(addrGlobal);
+    Value fileName = getPtrToGlobalString(fileNameGlobal, loc, builder);
+    Value offset = create.llvm.constant(i64Ty, offsetsAttr[section]);
+    Value size = create.llvm.constant(i64Ty, sizesAttr[section]);
+    return create.llvm.call(i8PtrTy, funcRef,
+        ArrayRef<Value>({addrPtr, fileName, offset, size}));
+  }
+
+  // The shared constants file is never compressed, to be mapped as a whole.
+  bool isShared = section == SHARED_CONSTANTS_FILE_SECTION;
+  if (isShared)
+    fileNameGlobal =
+        module.lookupSymbol<LLVM::GlobalOp>(SHARED_CONSTANTS_FILE_NAME_GLOBAL);
+  const std::string &addrName =
+      isShared ? SHARED_CONSTANTS_FILE_ADDR_GLOBAL : CONSTANTS_FILE_ADDR_GLOBAL;
+  auto addrGlobal = module.lookupSymbol<LLVM::GlobalOp>(addrName);
+  auto fileSizeAttr = module->getAttrOfType<IntegerAttr>(
+      isShared ? SHARED_CONSTANTS_FILE_SIZE_ATTR : CONSTANTS_FILE_SIZE_ATTR);
+  assert(fileNameGlobal && addrGlobal && fileSizeAttr &&
+         "Expecting a module with constants stored into a file");
+  if (storedSizesAttr && !isShared)
+    return loadCompressed(
+        addrGlobal, 0, storedSizesAttr[0], fileSizeAttr.getInt());
+
+  // Create 'omMMapConstantsFile' function signature: `i8* (i8**, i8*, i64)`
+  FlatSymbolRefAttr funcRef = createLLVMModuleLoc.getOrInsertSymbolRef(module,
+      StringRef(MMAP_CONSTANTS_FILE_FUNC), i8PtrTy,
+      {i8PtrPtrTy, i8PtrTy, i64Ty});
+  Value addrPtr = create.llvm.addressOf(addrGlobal);
+  Value fileName = getPtrToGlobalString(fileNameGlobal, loc, builder);
+  Value fileSize = create.llvm.constant(i64Ty, fileSizeAttr.getInt());
+  return create.llvm.call(
+      i8PtrTy, funcRef, ArrayRef<Value>({addrPtr, fileName, fileSize}));
+}
+
 } // namespace krnl
 } // namespace onnx_mlir
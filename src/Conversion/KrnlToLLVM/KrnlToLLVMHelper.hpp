@@ -66,5 +66,13 @@ std::string e2a_s(std::string e_s);
 void emitErrNo(mlir::ModuleOp module, mlir::OpBuilder &builder,
     mlir::Location loc, int err);
 
+/// Generate LLVM code to get the address of the file storing the constants of
+/// the module, or of the given section of the file, which is mapped into
+/// memory at the first call, or decompressed if the file is compressed. The
+/// address is null if it cannot be mapped. The SHARED_CONSTANTS_FILE_SECTION
+/// section gives the address of the shared constants file instead.
+mlir::Value emitMMapConstantsFile(mlir::ModuleOp module,
+    mlir::OpBuilder &builder, mlir::Location loc, int64_t section = -1);
+
 } // namespace krnl
 } // namespace onnx_mlir
@@ -84,6 +84,10 @@ RuntimeAPIRegistry::RuntimeAPIRegistry(ModuleOp &module, OpBuilder &builder)
     RuntimeAPI(API::GET_OMT_ARRAY, "omTensorListGetOmtArray", opaquePtrPtrTy, {opaquePtrTy}),
     RuntimeAPI(API::PRINT_OMTENSOR, "omTensorPrint", voidTy, {opaquePtrTy, opaquePtrTy}),
     RuntimeAPI(API::GET_OMTENSOR_LIST_SIZE, "omTensorListGetSize", int64Ty, {opaquePtrTy}),
+    RuntimeAPI(API::GET_DATA_BUFFER_SIZE, "omTensorGetBufferSize", int64Ty, {opaquePtrTy}),
+    RuntimeAPI(API::GET_ALIGNED_DATA_PTRS, "omTensorListGetAlignedDataPtrs", opaquePtrPtrTy, {opaquePtrTy, int64Ty}),
+    RuntimeAPI(API::FREE_ALIGNED_DATA_PTRS, "omTensorListFreeAlignedDataPtrs", voidTy, {opaquePtrTy, opaquePtrPtrTy}),
+    RuntimeAPI(API::HAS_SIGNATURE, "omTensorListHasSignature", int64Ty, {opaquePtrTy, int64PtrTy}),
   };
   // clang-format on
 
@@ -46,6 +46,10 @@ public:
     GET_OMT_ARRAY,
     PRINT_OMTENSOR,
     GET_OMTENSOR_LIST_SIZE,
+    GET_DATA_BUFFER_SIZE,
+    GET_ALIGNED_DATA_PTRS,
+    FREE_ALIGNED_DATA_PTRS,
+    HAS_SIGNATURE,
   };
 
   // Call the runtime API identified by \p apiId, return the SSA value
@@ -0,0 +1,509 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------- FusedAttention.cpp - Lowering FusedAttention Op --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNXFusedAttentionOp to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/KrnlHelper.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+// Number of keys whose scores are computed at once. The scores of a tile and
+// the accumulator of a query are meant to stay in the L1 cache.
+static constexpr int64_t kAttentionKeyTile = 64;
+// Unroll factor of the SIMD loops.
+static constexpr int64_t kAttentionSimdUnroll = 4;
+
+// Return the scalar, splat into a vector if the type is a vector type.
+static Value splatIfVector(KrnlBuilder &createKrnl, Type type, Value scalar) {
+  if (VectorType vecType = type.dyn_cast<VectorType>())
+    return VectorBuilder(createKrnl).splat(vecType, scalar);
+  return scalar;
+}
+
+// Compute the range [tokenStart[t], tokenEnd[t]) of the tokens of the
+// sequence of each token t, given the offsets of the packed sequences clamped
+// to [0, numKeys]. The start is the greatest offset not after t and the end
+// the smallest offset after it. The range is empty for the tokens before the
+// first offset or from the last one on, which belong to no sequence.
+static void emitSequenceRanges(KrnlBuilder &createKrnl, Value offsets,
+    IndexExpr numTokens, IndexExpr numKeys, Value tokenStart, Value tokenEnd) {
+  MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder, MathBuilder>
+      create(createKrnl);
+  IndexExpr numOffsets = create.krnlIE.getShapeAsDim(offsets, 0);
+  Value iZero = create.math.constantIndex(0);
+  Value numKeysVal = numKeys.getValue();
+  Value lastOffsetInd =
+      create.math.sub(numOffsets.getValue(), create.math.constantIndex(1));
+  auto loadOffset = [&](KrnlBuilder &ck, Value k) {
+    MultiDialectBuilder<MathBuilder> create(ck);
+    Value offset = create.math.castToIndex(ck.load(offsets, {k}));
+    return create.math.min(create.math.max(offset, iZero), numKeysVal);
+  };
+
+  ValueRange tokenLoopDef = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(tokenLoopDef, tokenLoopDef, {LiteralIndexExpr(0)},
+      {numTokens}, [&](KrnlBuilder &ck, ValueRange tokenInd) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+        Value t = tokenInd[0];
+        create.krnl.store(iZero, tokenStart, {t});
+        create.krnl.store(numKeysVal, tokenEnd, {t});
+        // Branch-free min and max over the offsets.
+        ValueRange offsetLoopDef = create.krnl.defineLoops(1);
+        create.krnl.iterateIE(offsetLoopDef, offsetLoopDef,
+            {LiteralIndexExpr(0)}, {SymbolIndexExpr(numOffsets)},
+            [&](KrnlBuilder &ck, ValueRange offsetInd) {
+              MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+              Value offset = loadOffset(ck, offsetInd[0]);
+              Value start = create.krnl.load(tokenStart, {t});
+              Value end = create.krnl.load(tokenEnd, {t});
+              Value notAfter = create.math.sle(offset, t);
+              create.krnl.store(
+                  create.math.select(
+                      notAfter, create.math.max(start, offset), start),
+                  tokenStart, {t});
+              create.krnl.store(
+                  create.math.select(
+                      notAfter, end, create.math.min(end, offset)),
+                  tokenEnd, {t});
+            });
+        Value inSequence =
+            create.math.andi(create.math.sle(loadOffset(ck, iZero), t),
+                create.math.slt(t, loadOffset(ck, lastOffsetInd)));
+        Value start = create.krnl.load(tokenStart, {t});
+        Value end = create.krnl.load(tokenEnd, {t});
+        create.krnl.store(
+            create.math.select(inSequence, end, start), tokenEnd, {t});
+      });
+}
+
+/// Lower the attention of each query
+/// ```
+///   Y[b, s, :] = Softmax(scale * Q[b, s, :] * K[b] + mask[b, s, :]) * V[b]
+/// ```
+/// with an online softmax over tiles of keys. For each tile, the scores of
+/// the query are computed in a buffer of kAttentionKeyTile values, the
+/// running max of the scores is updated, and the accumulator of the values
+/// weighted by the exps of the scores is rescaled by exp(oldMax - newMax)
+/// before adding the values of the tile. The accumulator is divided by the
+/// sum of the exps once all the tiles are done.
+///
+/// With sequence offsets, the keys of the query s are the tokens of its
+/// sequence, from tokenStart[s] to tokenEnd[s] as precomputed for all the
+/// tokens, so that the sequences packed along the query and key dims do not
+/// attend to each other and no work is spent on the keys of the other ones.
+///
+/// With a block table, the key t of the batch b is read from the block
+/// blockTable[b, t / P] of the paged K and V at the position t % P. The keys
+/// of a tile are then not contiguous, and the score of each key is a dot
+/// product over the head dim instead.
+struct ONNXFusedAttentionOpLowering
+    : public OpConversionPattern<ONNXFusedAttentionOp> {
+  ONNXFusedAttentionOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD) {}
+  bool enableSIMD;
+
+  LogicalResult matchAndRewrite(ONNXFusedAttentionOp attentionOp,
+      OpAdaptor adaptor, ConversionPatternRewriter &rewriter) const final {
+    Operation *op = attentionOp.getOperation();
+    Location loc = ONNXLoc<ONNXFusedAttentionOp>(op);
+    Value Q = adaptor.getQ();
+    Value K = adaptor.getK();
+    Value V = adaptor.getV();
+    Value mask = adaptor.getMask();
+    bool hasMask = !isFromNone(mask);
+    Value offsets = adaptor.getSequenceOffsets();
+    bool hasOffsets = !isFromNone(offsets);
+    Value blockTable = adaptor.getBlockTable();
+    bool isPaged = !isFromNone(blockTable);
+    float scale = adaptor.getScale().convertToFloat();
+
+    MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder, MathBuilder,
+        MemRefBuilder, VectorBuilder>
+        create(rewriter, loc);
+    IndexExprScope scope(create.krnlIE);
+
+    // Get shape.
+    ONNXFusedAttentionOpShapeHelper shapeHelper(
+        op, adaptor.getOperands(), &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    DimsExpr outputDims = shapeHelper.getOutputDims();
+    int64_t rank = outputDims.size();
+    IndexExpr headDim = create.krnlIE.getShapeAsDim(Q, rank - 1);
+    IndexExpr numKeys = create.krnlIE.getShapeAsDim(K, rank - 1);
+    IndexExpr valueDim = outputDims[rank - 1];
+    Value blockSize = nullptr;
+    if (isPaged) {
+      // The key length is loaded outside of the loops to be a valid affine
+      // symbol.
+      numKeys = SymbolIndexExpr(create.math.castToIndex(create.krnl.load(
+          adaptor.getKeyLength(), {create.math.constantIndex(0)})));
+      blockSize = create.krnlIE.getShapeAsDim(K, rank - 2).getValue();
+    }
+
+    // Allocate the result.
+    MemRefType outputMemRefType =
+        typeConverter->convertType(attentionOp.getY().getType())
+            .cast<MemRefType>();
+    Type elementType = outputMemRefType.getElementType();
+    Value alloc = create.mem.alignedAlloc(outputMemRefType, outputDims);
+
+    int64_t VL = 1;
+    if (enableSIMD)
+      VL = create.vec.getMachineVectorLength(elementType) *
+           kAttentionSimdUnroll;
+    VectorType vecType = VectorType::get({VL}, elementType);
+
+    // Buffers reused by all the queries: the scores of a tile, the running max
+    // and sum of the exps of the scores, the accumulator of the weighted
+    // values, and the accumulators of the reductions over a tile.
+    Value scores = create.mem.alignedAlloca(
+        MemRefType::get({kAttentionKeyTile}, elementType));
+    Value runMax = create.mem.alloca(MemRefType::get({1}, elementType));
+    Value runSum = create.mem.alloca(MemRefType::get({1}, elementType));
+    DimsExpr accDims = {valueDim};
+    Value acc = create.mem.alignedAlloc(
+        MemRefType::get({valueDim.isLiteral() ? valueDim.getLiteral()
+                                              : ShapedType::kDynamic},
+            elementType),
+        accDims);
+    Value scalarRed = create.mem.alloca(MemRefType::get({1}, elementType));
+    Value vecRed =
+        VL > 1 ? create.mem.alignedAlloca(MemRefType::get({VL}, elementType))
+               : nullptr;
+    auto getRed = [&](Type type) {
+      return type.isa<VectorType>() ? vecRed : scalarRed;
+    };
+
+    Value zero = create.math.constant(elementType, 0);
+    Value one = create.math.constant(elementType, 1);
+    Value negInfinity = create.math.constant(
+        elementType, -std::numeric_limits<float>::infinity());
+    Value scaleVal = create.math.constant(elementType, scale);
+    Value iZero = create.math.constantIndex(0);
+
+    // Reset the reduction accumulators, or combine them into a scalar.
+    auto resetRed = [&](KrnlBuilder &ck, Value init) {
+      MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(ck);
+      if (vecRed)
+        create.vec.store(create.vec.splat(vecType, init), vecRed, {iZero});
+      create.krnl.store(init, scalarRed, {iZero});
+    };
+    auto combineRed = [&](KrnlBuilder &ck, vector::CombiningKind kind) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
+      Value res = create.krnl.load(scalarRed, {iZero});
+      if (!vecRed)
+        return res;
+      Value vecRes =
+          create.vec.reduction(kind, create.vec.load(vecType, vecRed, {iZero}));
+      return kind == vector::CombiningKind::ADD ? create.math.add(vecRes, res)
+                                                : create.math.max(vecRes, res);
+    };
+
+    // The mask is broadcast to the scores [B..., S, T].
+    ArrayRef<int64_t> maskShape;
+    if (hasMask)
+      maskShape = mask.getType().cast<MemRefType>().getShape();
+    int64_t maskRank = maskShape.size();
+    bool maskBroadcastOverKeys =
+        hasMask && (maskRank == 0 || maskShape[maskRank - 1] == 1);
+
+    // The ranges of keys of the tokens of packed sequences.
+    Value tokenStart, tokenEnd;
+    if (hasOffsets) {
+      IndexExpr numTokens = outputDims[rank - 2];
+      DimsExpr rangeDims = {numTokens};
+      MemRefType rangeType =
+          MemRefType::get({numTokens.isLiteral() ? numTokens.getLiteral()
+                                                 : ShapedType::kDynamic},
+              rewriter.getIndexType());
+      tokenStart = create.mem.alignedAlloc(rangeType, rangeDims);
+      tokenEnd = create.mem.alignedAlloc(rangeType, rangeDims);
+      emitSequenceRanges(
+          create.krnl, offsets, numTokens, numKeys, tokenStart, tokenEnd);
+    }
+
+    // Iterate over the batch dims and the queries.
+    ValueRange outerLoopDef = create.krnl.defineLoops(rank - 1);
+    SmallVector<IndexExpr, 4> lbs(rank - 1, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs(outputDims.begin(), outputDims.end() - 1);
+    create.krnl.iterateIE(outerLoopDef, outerLoopDef, lbs, ubs,
+        [&](KrnlBuilder &ck, ValueRange outerInd) {
+          // With packed sequences, the range of keys of the query is loaded
+          // in a krnl.region for its bounds to be valid affine symbols.
+          OpBuilder &builder = ck.getBuilder();
+          std::optional<OpBuilder::InsertionGuard> insertGuard;
+          if (hasOffsets) {
+            KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+            insertGuard.emplace(builder);
+            builder.setInsertionPointToStart(
+                &regionOp.getBodyRegion().front());
+          }
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+          IndexExprScope queryScope(create.krnl);
+          Value query = outerInd[rank - 2];
+          Value keyBegin = nullptr;
+          IndexExpr keyCount = SymbolIndexExpr(numKeys);
+          if (hasOffsets) {
+            keyBegin = create.krnl.load(tokenStart, {query});
+            Value keyEnd = create.krnl.load(tokenEnd, {query});
+            keyCount = SymbolIndexExpr(create.math.sub(keyEnd, keyBegin));
+          }
+          // Indices [b..., i, j] of Q, K, V and Y.
+          auto getIndices = [&](Value i, Value j) {
+            SmallVector<Value, 4> indices(
+                outerInd.begin(), outerInd.begin() + rank - 2);
+            indices.emplace_back(i);
+            indices.emplace_back(j);
+            return indices;
+          };
+          // Indices [b..., key, 0] of K and V or, when paged, [block, h...,
+          // pos, 0], whose last index is set to the feature read.
+          auto getKeyIndices = [&](KrnlBuilder &ck, Value key) {
+            if (!isPaged)
+              return getIndices(key, iZero);
+            MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+            Value block = create.math.castToIndex(create.krnl.load(
+                blockTable, {outerInd[0], create.math.div(key, blockSize)}));
+            SmallVector<Value, 4> indices = {block};
+            indices.append(outerInd.begin() + 1, outerInd.begin() + rank - 2);
+            indices.emplace_back(create.math.rem(key, blockSize));
+            indices.emplace_back(iZero);
+            return indices;
+          };
+          auto withFeature = [](ArrayRef<Value> keyIndices, Value f) {
+            SmallVector<Value, 4> indices(keyIndices.begin(), keyIndices.end());
+            indices.back() = f;
+            return indices;
+          };
+          auto getMaskIndices = [&](Value key) {
+            SmallVector<Value, 4> indices;
+            for (int64_t i = 0; i < maskRank; ++i) {
+              int64_t d = rank - maskRank + i;
+              if (maskShape[i] == 1)
+                indices.emplace_back(iZero);
+              else
+                indices.emplace_back(d == rank - 1 ? key : outerInd[d]);
+            }
+            return indices;
+          };
+          Value maskVal = maskBroadcastOverKeys
+                              ? create.krnl.load(mask, getMaskIndices(iZero))
+                              : nullptr;
+
+          create.krnl.store(negInfinity, runMax, {iZero});
+          create.krnl.store(zero, runSum, {iZero});
+          emitSimdLoopWithScalarTail(create.krnl, SymbolIndexExpr(valueDim),
+              VL, elementType, [&](KrnlBuilder &ck, Type type, Value dv) {
+                storeScalarOrVector(
+                    ck, splatIfVector(ck, type, zero), acc, {dv});
+              });
+
+          // Iterate over the tiles of keys.
+          ValueRange tileLoopDef = create.krnl.defineLoops(1);
+          ValueRange tileBlockDef =
+              create.krnl.block(tileLoopDef[0], kAttentionKeyTile);
+          create.krnl.iterateIE(tileLoopDef, {tileBlockDef[0]},
+              {LiteralIndexExpr(0)}, {keyCount},
+              [&](KrnlBuilder &ck, ValueRange tileInd) {
+                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+                IndexExprScope tileScope(ck);
+                Value tileStart = tileInd[0];
+                IndexExpr tileSize = IndexExpr::min(
+                    SymbolIndexExpr(keyCount) - DimIndexExpr(tileStart),
+                    kAttentionKeyTile);
+                Value tileSizeVal = tileSize.getValue();
+                auto getKey = [&](KrnlBuilder &ck, Value j) {
+                  MathBuilder createMath(ck);
+                  Value key = createMath.add(tileStart, j);
+                  return keyBegin ? createMath.add(keyBegin, key) : key;
+                };
+
+                if (isPaged) {
+                  // Scores of the tile, a dot product per key as the keys of
+                  // the blocks are not contiguous.
+                  ValueRange keyLoopDef = create.krnl.defineLoops(1);
+                  create.krnl.iterateIE(keyLoopDef, keyLoopDef,
+                      {LiteralIndexExpr(0)}, {tileSize},
+                      [&](KrnlBuilder &ck, ValueRange keyInd) {
+                        IndexExprScope keyScope(ck);
+                        Value j = keyInd[0];
+                        SmallVector<Value, 4> keyIndices =
+                            getKeyIndices(ck, getKey(ck, j));
+                        resetRed(ck, zero);
+                        emitSimdLoopWithScalarTail(ck,
+                            SymbolIndexExpr(headDim), VL, elementType,
+                            [&](KrnlBuilder &ck, Type type, Value d) {
+                              MultiDialectBuilder<MathBuilder> create(ck);
+                              Value q = loadScalarOrVector(
+                                  ck, type, Q, getIndices(query, d));
+                              Value k = loadScalarOrVector(
+                                  ck, type, K, withFeature(keyIndices, d));
+                              Value red = getRed(type);
+                              Value sum =
+                                  loadScalarOrVector(ck, type, red, {iZero});
+                              storeScalarOrVector(ck,
+                                  create.math.add(sum, create.math.mul(q, k)),
+                                  red, {iZero});
+                            });
+                        ck.store(combineRed(ck, vector::CombiningKind::ADD),
+                            scores, {j});
+                      });
+                } else {
+                  // Scores of the tile, accumulated over the head dim so that
+                  // the keys are read contiguously.
+                  emitSimdLoopWithScalarTail(create.krnl, tileSize, VL,
+                      elementType, [&](KrnlBuilder &ck, Type type, Value j) {
+                        storeScalarOrVector(
+                            ck, splatIfVector(ck, type, zero), scores, {j});
+                      });
+                  ValueRange headLoopDef = create.krnl.defineLoops(1);
+                  create.krnl.iterateIE(headLoopDef, headLoopDef,
+                      {LiteralIndexExpr(0)}, {SymbolIndexExpr(headDim)},
+                      [&](KrnlBuilder &ck, ValueRange headInd) {
+                        IndexExprScope headScope(ck);
+                        Value d = headInd[0];
+                        Value q = ck.load(Q, getIndices(query, d));
+                        emitSimdLoopWithScalarTail(ck,
+                            SymbolIndexExpr(tileSizeVal), VL, elementType,
+                            [&](KrnlBuilder &ck, Type type, Value j) {
+                              MultiDialectBuilder<MathBuilder> create(ck);
+                              Value k = loadScalarOrVector(
+                                  ck, type, K, getIndices(d, getKey(ck, j)));
+                              Value s =
+                                  loadScalarOrVector(ck, type, scores, {j});
+                              Value qk = create.math.mul(
+                                  splatIfVector(ck, type, q), k);
+                              storeScalarOrVector(
+                                  ck, create.math.add(s, qk), scores, {j});
+                            });
+                      });
+                }
+
+                // Scale and mask the scores, and compute their max.
+                resetRed(create.krnl, negInfinity);
+                emitSimdLoopWithScalarTail(create.krnl, tileSize, VL,
+                    elementType, [&](KrnlBuilder &ck, Type type, Value j) {
+                      MultiDialectBuilder<MathBuilder> create(ck);
+                      Value s = loadScalarOrVector(ck, type, scores, {j});
+                      if (scale != 1.0f)
+                        s = create.math.mul(
+                            s, splatIfVector(ck, type, scaleVal));
+                      if (maskVal)
+                        s = create.math.add(
+                            s, splatIfVector(ck, type, maskVal));
+                      else if (hasMask)
+                        s = create.math.add(s,
+                            loadScalarOrVector(ck, type, mask,
+                                getMaskIndices(getKey(ck, j))));
+                      storeScalarOrVector(ck, s, scores, {j});
+                      Value red = getRed(type);
+                      Value max = loadScalarOrVector(ck, type, red, {iZero});
+                      storeScalarOrVector(
+                          ck, create.math.max(max, s), red, {iZero});
+                    });
+                Value oldMax = create.krnl.load(runMax, {iZero});
+                Value tileMax =
+                    combineRed(create.krnl, vector::CombiningKind::MAXF);
+                Value newMax = create.math.max(oldMax, tileMax);
+                Value correction =
+                    create.math.exp(create.math.sub(oldMax, newMax));
+                create.krnl.store(newMax, runMax, {iZero});
+
+                // Exps of the scores minus the new max, and their sum.
+                resetRed(create.krnl, zero);
+                emitSimdLoopWithScalarTail(create.krnl, tileSize, VL,
+                    elementType, [&](KrnlBuilder &ck, Type type, Value j) {
+                      MultiDialectBuilder<MathBuilder> create(ck);
+                      Value s = loadScalarOrVector(ck, type, scores, {j});
+                      Value p = create.math.exp(
+                          create.math.sub(s, splatIfVector(ck, type, newMax)));
+                      storeScalarOrVector(ck, p, scores, {j});
+                      Value red = getRed(type);
+                      Value sum = loadScalarOrVector(ck, type, red, {iZero});
+                      storeScalarOrVector(
+                          ck, create.math.add(sum, p), red, {iZero});
+                    });
+                Value sum = create.math.mul(
+                    create.krnl.load(runSum, {iZero}), correction);
+                sum = create.math.add(
+                    sum, combineRed(create.krnl, vector::CombiningKind::ADD));
+                create.krnl.store(sum, runSum, {iZero});
+
+                // Rescale the accumulator, and add the values of the tile
+                // weighted by the exps.
+                emitSimdLoopWithScalarTail(create.krnl,
+                    SymbolIndexExpr(valueDim), VL, elementType,
+                    [&](KrnlBuilder &ck, Type type, Value dv) {
+                      MultiDialectBuilder<MathBuilder> create(ck);
+                      Value a = loadScalarOrVector(ck, type, acc, {dv});
+                      storeScalarOrVector(ck,
+                          create.math.mul(
+                              a, splatIfVector(ck, type, correction)),
+                          acc, {dv});
+                    });
+                ValueRange keyLoopDef = create.krnl.defineLoops(1);
+                create.krnl.iterateIE(keyLoopDef, keyLoopDef,
+                    {LiteralIndexExpr(0)}, {tileSize},
+                    [&](KrnlBuilder &ck, ValueRange keyInd) {
+                      IndexExprScope keyScope(ck);
+                      Value j = keyInd[0];
+                      SmallVector<Value, 4> keyIndices =
+                          getKeyIndices(ck, getKey(ck, j));
+                      Value p = ck.load(scores, {j});
+                      emitSimdLoopWithScalarTail(ck, SymbolIndexExpr(valueDim),
+                          VL, elementType,
+                          [&](KrnlBuilder &ck, Type type, Value dv) {
+                            MultiDialectBuilder<MathBuilder> create(ck);
+                            Value v = loadScalarOrVector(
+                                ck, type, V, withFeature(keyIndices, dv));
+                            Value a = loadScalarOrVector(ck, type, acc, {dv});
+                            Value pv =
+                                create.math.mul(splatIfVector(ck, type, p), v);
+                            storeScalarOrVector(
+                                ck, create.math.add(a, pv), acc, {dv});
+                          });
+                    });
+              });
+
+          // Normalize the accumulator by the sum of the exps. The sum is 0
+          // for the tokens of packed sequences that belong to no sequence.
+          Value sum = create.krnl.load(runSum, {iZero});
+          Value invSum = create.math.div(one, sum);
+          if (hasOffsets)
+            invSum = create.math.select(
+                create.math.gt(sum, zero), invSum, zero);
+          emitSimdLoopWithScalarTail(create.krnl, SymbolIndexExpr(valueDim),
+              VL, elementType, [&](KrnlBuilder &ck, Type type, Value dv) {
+                MultiDialectBuilder<MathBuilder> create(ck);
+                Value a = loadScalarOrVector(ck, type, acc, {dv});
+                storeScalarOrVector(ck,
+                    create.math.mul(a, splatIfVector(ck, type, invSum)), alloc,
+                    getIndices(query, dv));
+              });
+        });
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXFusedAttentionOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD) {
+  patterns.insert<ONNXFusedAttentionOpLowering>(typeConverter, ctx, enableSIMD);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------------- Memo.cpp - Lowering Memo Op --------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNXMemoOp to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+struct ONNXMemoOpLowering : public OpConversionPattern<ONNXMemoOp> {
+  ONNXMemoOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+
+  /// The keys are looked up in the cache of the memo by the runtime, which
+  /// stores into a state buffer whether they were found and then the dims of
+  /// the cached results. An scf.if copies the cached results into buffers of
+  /// these dims when found, or computes the body of the memo and stores its
+  /// results into the cache otherwise, as in the OMMemo.inc protocol.
+  LogicalResult matchAndRewrite(ONNXMemoOp memoOp, ONNXMemoOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = memoOp.getOperation();
+    Location loc = ONNXLoc<ONNXMemoOp>(op);
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        rewriter, loc);
+
+    SmallVector<Type, 4> resultTypes;
+    if (failed(typeConverter->convertTypes(
+            memoOp.getResultTypes(), resultTypes)))
+      return failure();
+    int64_t numDims = 0;
+    for (Type type : resultTypes) {
+      auto memRefType = type.dyn_cast<MemRefType>();
+      if (!memRefType || !memRefType.getLayout().isIdentity())
+        return rewriter.notifyMatchFailure(op, "unsupported result type");
+      numDims += memRefType.getRank();
+    }
+
+    // State [hit, entry, dims...] of the lookup.
+    Type i64Type = rewriter.getI64Type();
+    Value state = create.mem.alloca(MemRefType::get({2 + numDims}, i64Type));
+    Value id = create.math.constant(i64Type, memoOp.getId());
+    Value numKeys = create.math.constant(i64Type, adaptor.getKeys().size());
+    for (auto [k, key] : llvm::enumerate(adaptor.getKeys()))
+      rewriter.create<KrnlCallOp>(loc, "omMemoKey", state,
+          ValueRange{key, id, create.math.constant(i64Type, k), numKeys});
+    rewriter.create<KrnlCallOp>(loc, "omMemoLookup", state,
+        ValueRange{create.math.constant(i64Type, resultTypes.size())});
+    Value hit = create.math.eq(
+        create.krnl.load(state, {create.math.constantIndex(0)}),
+        create.math.constant(i64Type, 1));
+
+    scf::IfOp ifOp = rewriter.create<scf::IfOp>(
+        loc, resultTypes, hit, /*withElseRegion=*/true);
+    emitLoadBranch(rewriter, loc, state, resultTypes, ifOp.getThenRegion());
+    emitComputeBranch(rewriter, loc, state, memoOp.getBody(), ifOp);
+    rewriter.replaceOp(op, ifOp.getResults());
+    return success();
+  }
+
+private:
+  // Copy the cached results into buffers of the dims of the state.
+  void emitLoadBranch(ConversionPatternRewriter &rewriter, Location loc,
+      Value state, ArrayRef<Type> resultTypes, Region &branch) const {
+    OpBuilder::InsertionGuard insertGuard(rewriter);
+    rewriter.setInsertionPointToEnd(&branch.front());
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        rewriter, loc);
+    Type i64Type = rewriter.getI64Type();
+    SmallVector<Value, 4> results;
+    int64_t dim = 2;
+    for (auto [r, type] : llvm::enumerate(resultTypes)) {
+      MemRefType memRefType = type.cast<MemRefType>();
+      SmallVector<Value, 4> dynDims;
+      for (int64_t d = 0; d < memRefType.getRank(); ++d, ++dim)
+        if (memRefType.isDynamicDim(d))
+          dynDims.emplace_back(create.math.castToIndex(
+              create.krnl.load(state, {create.math.constantIndex(dim)})));
+      Value alloc = create.mem.alignedAlloc(memRefType, dynDims);
+      rewriter.create<KrnlCallOp>(loc, "omMemoLoad", alloc,
+          ValueRange{state, create.math.constant(i64Type, r)});
+      results.emplace_back(alloc);
+    }
+    rewriter.create<scf::YieldOp>(loc, results);
+  }
+
+  // Compute the body of the memo and store its results into the cache.
+  void emitComputeBranch(ConversionPatternRewriter &rewriter, Location loc,
+      Value state, Region &body, scf::IfOp ifOp) const {
+    OpBuilder::InsertionGuard insertGuard(rewriter);
+    Region &branch = ifOp.getElseRegion();
+    rewriter.eraseBlock(&branch.back());
+    branch.takeBody(body);
+    Operation *returnOp = branch.back().getTerminator();
+    rewriter.setInsertionPoint(returnOp);
+    MathBuilder createMath(rewriter, loc);
+    SmallVector<Value, 4> outputs;
+    if (failed(rewriter.getRemappedValues(returnOp->getOperands(), outputs)))
+      llvm_unreachable("failed to convert memo return values");
+    Type i64Type = rewriter.getI64Type();
+    for (auto [r, output] : llvm::enumerate(outputs))
+      rewriter.create<KrnlCallOp>(loc, "omMemoStore", state,
+          ValueRange{output, createMath.constant(i64Type, r)});
+    rewriter.replaceOpWithNewOp<scf::YieldOp>(returnOp, outputs);
+  }
+};
+
+void populateLoweringONNXMemoOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXMemoOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------- PagedKVCacheWrite.cpp - Lowering PagedKVCacheWrite Op ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNXPagedKVCacheWriteOp to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/KrnlHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+/// Lower the write of the new tokens
+/// ```
+///   cache[blockTable[b, (p + s) / P], h..., (p + s) % P, :] = X[b, h..., s, :]
+/// ```
+/// by storing into the cache buffer, which replaces the result, so that a
+/// step costs the size of its new tokens instead of the one of the cache.
+struct ONNXPagedKVCacheWriteOpLowering
+    : public OpConversionPattern<ONNXPagedKVCacheWriteOp> {
+  using OpConversionPattern<ONNXPagedKVCacheWriteOp>::OpConversionPattern;
+
+  LogicalResult matchAndRewrite(ONNXPagedKVCacheWriteOp writeOp,
+      OpAdaptor adaptor, ConversionPatternRewriter &rewriter) const final {
+    Operation *op = writeOp.getOperation();
+    Location loc = ONNXLoc<ONNXPagedKVCacheWriteOp>(op);
+    Value cache = adaptor.getCache();
+    Value blockTable = adaptor.getBlockTable();
+    Value X = adaptor.getX();
+
+    MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder, MathBuilder>
+        create(rewriter, loc);
+    IndexExprScope scope(create.krnlIE);
+    int64_t rank = X.getType().cast<MemRefType>().getRank();
+    Value pastLength = create.math.castToIndex(create.krnl.load(
+        adaptor.getPastLength(), {create.math.constantIndex(0)}));
+    Value blockSize = create.krnlIE.getShapeAsDim(cache, rank - 2).getValue();
+
+    // Iterate over the new tokens [b, h..., s, d].
+    ValueRange loopDef = create.krnl.defineLoops(rank);
+    SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs;
+    create.krnlIE.getShapeAsDims(X, ubs);
+    create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &ck, ValueRange loopInd) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+          Value token = create.math.add(pastLength, loopInd[rank - 2]);
+          Value block = create.math.castToIndex(create.krnl.load(blockTable,
+              {loopInd[0], create.math.div(token, blockSize)}));
+          SmallVector<Value, 4> cacheInd = {block};
+          cacheInd.append(loopInd.begin() + 1, loopInd.begin() + rank - 2);
+          cacheInd.emplace_back(create.math.rem(token, blockSize));
+          cacheInd.emplace_back(loopInd[rank - 1]);
+          create.krnl.store(create.krnl.load(X, loopInd), cache, cacheInd);
+        });
+
+    rewriter.replaceOp(op, cache);
+    return success();
+  }
+};
+
+void populateLoweringONNXPagedKVCacheWriteOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXPagedKVCacheWriteOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -23,8 +23,18 @@ using namespace mlir;
 namespace onnx_mlir {
 
 struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
-  explicit ONNXLoopOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  explicit ONNXLoopOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableStreamingLoops, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableStreamingLoops(enableStreamingLoops),
+        enableParallel(enableParallel) {}
+
+  // Write the scan outputs with dynamic dims in place into buffers of their
+  // final shape instead of accumulating them into sequences, and allocate the
+  // buffer of the iteration number once for all the iterations.
+  bool enableStreamingLoops;
+  // Run the iterations in parallel when they do not depend on each other.
+  bool enableParallel;
 
   LogicalResult matchAndRewrite(ONNXLoopOp loopOp, ONNXLoopOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -56,6 +66,10 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
     //    used to accumulate the scan output. This seqType result is
     //    transformed into memref<?x?xT> after the loop when the shape is
     //    known.
+    //    With enableStreamingLoops, the buffer of memref<?x?xT> is instead
+    //    allocated in the first iteration, when the shape is known, and
+    //    stored in a Value of type memref<1xmemref<?x?xT>>. Each iteration
+    //    then writes its result in place into its slice of the buffer.
 
     SmallVector<Value, 4> outputs;
     allocateMemoryForVFinal(loc, rewriter, op, adaptor, outputs);
@@ -63,6 +77,20 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
     MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder> create(
         rewriter, loc);
 
+    // The iterations are independent when the loop carried dependencies pass
+    // through the body unchanged, so that every iteration only depends on its
+    // iteration number and writes its own slice of the scan outputs. Scan
+    // outputs allocated by the first iteration prevent running them in
+    // parallel.
+    size_t numVFinal = loopOp.v_final().size();
+    bool parallel = enableParallel && hasIndependentIterations(loopOp);
+    for (unsigned i = numVFinal; parallel && i < outputs.size(); i++)
+      parallel = !isStreamedScanOutput(outputs[i],
+          loopOp.scan_outputs()[i - numVFinal]
+              .getType()
+              .cast<ShapedType>()
+              .getRank());
+
     // Copy content of vInit to vFinal, which is used to host intermediate
     // values produced by loop body function invocation in a scope accessible by
     // all loop iterations.
@@ -97,10 +125,16 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
     Value maxTripCount = createKrnl.load(adaptor.getM());
     maxTripCount = rewriter.create<arith::IndexCastOp>(
         loc, rewriter.getIndexType(), maxTripCount);
-    ValueRange loopDef = createKrnl.defineLoops(1);
     Value zero = create.math.constantIndex(0);
-    createKrnl.iterate(loopDef, loopDef, {zero}, {maxTripCount},
-        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+    // The iteration number passed to the body does not depend on the
+    // iteration, allocate its buffer once unless the iterations run in
+    // parallel.
+    Value hoistedIVMemRef;
+    if (enableStreamingLoops && !parallel)
+      hoistedIVMemRef =
+          create.mem.alloc(MemRefType::get({}, rewriter.getI64Type()));
+    emitIterations(rewriter, loc, parallel, zero, maxTripCount,
+        [&](ValueRange loopInd) {
           OpBuilder::InsertionGuard insertGuard(rewriter);
 
           Value condReg = createKrnl.load(cond);
@@ -120,8 +154,10 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
                              loc, rewriter.getI64Type(), origIV)
                          .getResult();
           MemRefBuilder createMemRef(rewriter, loc);
-          Value ivMemRef =
-              createMemRef.alloc(MemRefType::get({}, rewriter.getI64Type()));
+          Value ivMemRef = hoistedIVMemRef;
+          if (!ivMemRef)
+            ivMemRef =
+                createMemRef.alloc(MemRefType::get({}, rewriter.getI64Type()));
           createKrnl.store(iv, ivMemRef);
 
           // Make the call to loop body function.
@@ -206,7 +242,9 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
           }
 
           // Copy the newly computed loop condition to pre-allocated buffer.
-          emitCopy(rewriter, loc, bodyOutputs[0], cond);
+          // It is the initial condition when the iterations are independent.
+          if (!parallel)
+            emitCopy(rewriter, loc, bodyOutputs[0], cond);
 
           // Copy intermediate values of scan outputs to their corresponding
           // slice in the loop scan output tensor.
@@ -219,26 +257,34 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
               outputs.begin() + adaptor.getVInitial().size(), outputs.end());
           for (auto scanIntermediateToFinal :
               llvm::zip(scanIntermediate, scanOutputs)) {
-            Type elementType = std::get<1>(scanIntermediateToFinal)
-                                   .getType()
-                                   .cast<MemRefType>()
-                                   .getElementType();
-            if (elementType.dyn_cast<MemRefType>()) {
+            Value bodyScanOutput = std::get<0>(scanIntermediateToFinal);
+            Value scanOutput = std::get<1>(scanIntermediateToFinal);
+            Type elementType =
+                scanOutput.getType().cast<MemRefType>().getElementType();
+            int64_t scanRank =
+                bodyScanOutput.getType().cast<MemRefType>().getRank() + 1;
+            if (isStreamedScanOutput(scanOutput, scanRank)) {
+              // Write in place into the buffer of the final shape, which is
+              // allocated by the first iteration.
+              emitAllocForStreamedScanOutput(
+                  rewriter, loc, bodyScanOutput, scanOutput, origIV);
+              Value scanBuffer = create.krnl.load(scanOutput, zero);
+              emitCopy(rewriter, loc, bodyScanOutput, scanBuffer,
+                  /*writePrefix=*/{origIV});
+            } else if (elementType.dyn_cast<MemRefType>()) {
               // accumulate dynamic tensor
-              rewriter.create<KrnlSeqStoreOp>(loc,
-                  std::get<0>(scanIntermediateToFinal),
-                  std::get<1>(scanIntermediateToFinal), origIV);
+              create.krnl.seqstore(bodyScanOutput, scanOutput, origIV);
             } else {
-              emitCopy(rewriter, loc, std::get<0>(scanIntermediateToFinal),
-                  std::get<1>(scanIntermediateToFinal),
+              emitCopy(rewriter, loc, bodyScanOutput, scanOutput,
                   /*writePrefix=*/{origIV});
             }
           }
 
           // Copy intermediate values of loop carried dependencies to MemRef
           // outside the iteration scope so next iteration can use them as init
-          // value.
-          for (unsigned long i = 0; i < loopOp.getVInitial().size(); i++) {
+          // value. They are unchanged when the iterations are independent.
+          for (unsigned long i = 0;
+               !parallel && i < loopOp.getVInitial().size(); i++) {
             if (loopOp.getVInitial()[i].getType().isa<SeqType>()) {
               create.krnl.store(bodyOutputs[i + 1], outputs[i], zero);
             } else {
@@ -270,8 +316,12 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
           output.getType().cast<MemRefType>().getElementType();
       if (seqElementType.isa<MemRefType>()) {
         // need to distinguish seqType in v_final and scan
-        if (i < loopOp.v_final().size()) {
-          // In v_final
+        if (i < numVFinal ||
+            isStreamedScanOutput(output, loopOp.scan_outputs()[i - numVFinal]
+                                             .getType()
+                                             .cast<ShapedType>()
+                                             .getRank())) {
+          // In v_final, or scan output written in place
           Value v = create.krnl.load(output, zero);
           newOutputs.emplace_back(v);
         } else {
@@ -412,7 +462,20 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
           }
         }
         MemRefBuilder createMemRef(rewriter, loc);
-        if (isDynamic) {
+        if (isDynamic && enableStreamingLoops && !isWhile) {
+          // Use memref<1xmemref<d1 x d2, ..., dnxT>>, holding the buffer of
+          // the final shape once allocated by the first iteration. Initialize
+          // it with an empty buffer, which is the output if the loop body is
+          // never executed.
+          SmallVector<mlir::Value, 4> emptyParams(allocParams);
+          for (int i = 1; i < rankedScanOutTy.getRank(); i++)
+            if (rankedScanOutTy.isDynamicDim(i))
+              emptyParams.emplace_back(create.math.constantIndex(0));
+          Value empty = createMemRef.alignedAlloc(rankedScanOutTy, emptyParams);
+          alloc = createMemRef.alignedAlloc(
+              MemRefType::get({1}, rankedScanOutTy));
+          create.krnl.store(empty, alloc, create.math.constantIndex(0));
+        } else if (isDynamic) {
           // Suppose the scan out type is is <d1 , d2,... dnxT>
           // Use memref<d1xmemref<d2, ..., dnxT>>
           // seqElementType: memref<d2, ..., dnxT>
@@ -432,6 +495,70 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
     }
   }
 
+  // Return true if the scan output of the given rank is written in place into
+  // a buffer of its final shape, held by the storage of type
+  // memref<1xmemref<d1 x d2, ..., dnxT>>.
+  static bool isStreamedScanOutput(Value storage, int64_t rank) {
+    Type elementType = storage.getType().cast<MemRefType>().getElementType();
+    auto bufferType = elementType.dyn_cast<MemRefType>();
+    return bufferType && bufferType.getRank() == rank;
+  }
+
+  // In the first iteration, replace the empty buffer held by the storage of a
+  // streamed scan output by a buffer of its final shape, whose leading dim is
+  // the one of the empty buffer and whose other dims are the ones of the
+  // output of the body.
+  void emitAllocForStreamedScanOutput(ConversionPatternRewriter &rewriter,
+      const Location &loc, Value bodyOutput, Value storage, Value iv) const {
+    OpBuilder::InsertionGuard insertGuard(rewriter);
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        rewriter, loc);
+    Value zero = create.math.constantIndex(0);
+    auto ifOp = rewriter.create<scf::IfOp>(
+        loc, create.math.eq(iv, zero), /*withElseRegion=*/false);
+    rewriter.setInsertionPointToStart(&ifOp.getThenRegion().front());
+    Value empty = create.krnl.load(storage, zero);
+    auto bufferType = empty.getType().cast<MemRefType>();
+    SmallVector<Value, 4> allocParams;
+    if (bufferType.isDynamicDim(0))
+      allocParams.emplace_back(create.mem.dim(empty, 0));
+    for (int64_t i = 1; i < bufferType.getRank(); i++)
+      if (bufferType.isDynamicDim(i))
+        allocParams.emplace_back(create.mem.dim(bodyOutput, i - 1));
+    Value buffer = create.mem.alignedAlloc(bufferType, allocParams);
+    create.krnl.store(buffer, storage, zero);
+  }
+
+  // Emit the iterations from lb to ub, as a parallel loop when parallel is set.
+  void emitIterations(ConversionPatternRewriter &rewriter, const Location &loc,
+      bool parallel, Value lb, Value ub,
+      function_ref<void(ValueRange)> bodyFn) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder> create(
+        rewriter, loc);
+    if (parallel) {
+      create.scf.parallelLoop({lb}, {ub}, {create.math.constantIndex(1)},
+          [&](SCFBuilder &createSCF, ValueRange loopInd) { bodyFn(loopInd); });
+      return;
+    }
+    ValueRange loopDef = create.krnl.defineLoops(1);
+    create.krnl.iterate(loopDef, loopDef, {lb}, {ub},
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) { bodyFn(loopInd); });
+  }
+
+  // Return true if the loop carried dependencies and the condition are passed
+  // through the body unchanged, so that the iterations are independent.
+  static bool hasIndependentIterations(ONNXLoopOp loopOp) {
+    Block &bodyBlock = loopOp.getBody().front();
+    Operation *returnOp = bodyBlock.getTerminator();
+    // The body arguments are the iteration number, the condition and the loop
+    // carried dependencies, the results the condition, the loop carried
+    // dependencies and the scan outputs.
+    for (unsigned i = 0, e = loopOp.getVInitial().size() + 1; i < e; i++)
+      if (returnOp->getOperand(i) != bodyBlock.getArgument(i + 1))
+        return false;
+    return true;
+  }
+
   // Helper function to emit code that copies data from src to dest.
   //
   // writePrefix enables copying to a contiguous subtensor of the same shape
@@ -779,8 +906,10 @@ struct ONNXLoopOpLowering : public OpConversionPattern<ONNXLoopOp> {
 };
 
 void populateLoweringONNXLoopOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXLoopOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableStreamingLoops,
+    bool enableParallel) {
+  patterns.insert<ONNXLoopOpLowering>(
+      typeConverter, ctx, enableStreamingLoops, enableParallel);
 }
 
 } // namespace onnx_mlir
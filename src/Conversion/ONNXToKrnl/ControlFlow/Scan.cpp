@@ -22,8 +22,18 @@ using namespace mlir;
 namespace onnx_mlir {
 
 struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
-  explicit ONNXScanOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  explicit ONNXScanOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableStreamingLoops, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableStreamingLoops(enableStreamingLoops),
+        enableParallel(enableParallel) {}
+
+  // Allocate the buffers of the slices of the scan inputs once for all the
+  // iterations, and support scan outputs with dynamic dims by writing them in
+  // place into buffers allocated by the first iteration.
+  bool enableStreamingLoops;
+  // Run the iterations in parallel when they do not depend on each other.
+  bool enableParallel;
 
   LogicalResult matchAndRewrite(ONNXScanOp scanOp, ONNXScanOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -40,8 +50,14 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
     // concatenated together).
     SmallVector<Value, 4> outputs;
     allocateMemoryForVFinal(loc, rewriter, typeConverter, op, adaptor, outputs);
-    allocateMemoryForScanOutput(
-        loc, rewriter, typeConverter, op, adaptor, outputs);
+    allocateMemoryForScanOutput(loc, rewriter, typeConverter, op, adaptor,
+        outputs, enableStreamingLoops);
+
+    // The iterations are independent when the scan carried dependencies pass
+    // through the body unchanged, unless a scan output is allocated by the
+    // first iteration.
+    bool parallel = enableParallel && hasIndependentIterations(scanOp) &&
+                    llvm::none_of(outputs, isStreamedScanOutput);
 
     // Copy content of vInit to vFinal, which is used to host intermediate
     // values produced by scan body function invocation in a scope accessible
@@ -58,15 +74,35 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
     MemRefBuilder createMemRef(rewriter, loc);
     Value maxTripCount = createMemRef.dim(*inputOperands.begin(), 0);
 
-    // Create the scan iteration.
-    std::vector<Value> loop;
-    defineLoops(rewriter, loc, loop, 1);
-    krnl::KrnlIterateOperandPack pack(rewriter, loop);
-    pack.pushConstantBound(0);
-    pack.pushOperandBound(maxTripCount);
-    KrnlBuilder createKrnl(rewriter, loc);
-    KrnlIterateOp iterateOp = createKrnl.iterate(pack);
-    Block &iterationBlock = iterateOp.getBodyRegion().front();
+    // The slices of the scan inputs passed to the body have a constant shape,
+    // their buffers do not depend on the iteration unless the iterations run
+    // in parallel.
+    auto bodyScanInputRange = llvm::make_range(
+        bodyArgs.begin() + (bodyArgs.size() - numInputs), bodyArgs.end());
+    SmallVector<Value, 4> hoistedBodyScanInputs;
+    if (enableStreamingLoops && !parallel)
+      for (Value bodyScanInput : bodyScanInputRange)
+        hoistedBodyScanInputs.emplace_back(allocateMemoryForBodyScanInput(
+            loc, rewriter, typeConverter, bodyScanInput.getType()));
+
+    // Create the scan iteration, as a parallel loop when the iterations are
+    // independent.
+    Operation *iterateOp;
+    if (parallel) {
+      MathBuilder createMath(rewriter, loc);
+      iterateOp = rewriter.create<scf::ParallelOp>(loc,
+          ValueRange(createMath.constantIndex(0)), ValueRange(maxTripCount),
+          ValueRange(createMath.constantIndex(1)));
+    } else {
+      std::vector<Value> loop;
+      defineLoops(rewriter, loc, loop, 1);
+      krnl::KrnlIterateOperandPack pack(rewriter, loop);
+      pack.pushConstantBound(0);
+      pack.pushOperandBound(maxTripCount);
+      KrnlBuilder createKrnl(rewriter, loc);
+      iterateOp = createKrnl.iterate(pack);
+    }
+    Block &iterationBlock = iterateOp->getRegion(0).front();
     rewriter.setInsertionPointToStart(&iterationBlock);
 
     {
@@ -82,14 +118,15 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
 
       auto opScanInputRange = llvm::make_range(
           operands.begin() + (operands.size() - numInputs), operands.end());
-      auto bodyScanInputRange = llvm::make_range(
-          bodyArgs.begin() + (bodyArgs.size() - numInputs), bodyArgs.end());
       for (const auto &opAndBodyScanInput :
-          llvm::zip(opScanInputRange, bodyScanInputRange)) {
-        auto opScanInput = std::get<0>(opAndBodyScanInput);
-        auto bodyScanInput = std::get<1>(opAndBodyScanInput);
-        auto bodyScanInputMemRef = allocateMemoryForBodyScanInput(
-            scanOp->getLoc(), rewriter, typeConverter, bodyScanInput.getType());
+          llvm::enumerate(llvm::zip(opScanInputRange, bodyScanInputRange))) {
+        auto opScanInput = std::get<0>(opAndBodyScanInput.value());
+        auto bodyScanInput = std::get<1>(opAndBodyScanInput.value());
+        Value bodyScanInputMemRef =
+            enableStreamingLoops
+                ? hoistedBodyScanInputs[opAndBodyScanInput.index()]
+                : allocateMemoryForBodyScanInput(scanOp->getLoc(), rewriter,
+                      typeConverter, bodyScanInput.getType());
         emitCopyFromTensorSlice(
             rewriter, scanOp->getLoc(), opScanInput, bodyScanInputMemRef, {iv});
         params.emplace_back(bodyScanInputMemRef);
@@ -160,12 +197,13 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
 
       // Copy intermediate values of scan carried dependencies to MemRef
       // outside the iteration scope so next iteration can have use them as
-      // init value.
+      // init value. They are unchanged when the iterations are independent.
       auto vIntermediate = llvm::make_range(bodyOutputs.begin(),
           bodyOutputs.begin() + scanOp.getVInitial().size());
       for (auto vIntermediateToFinal : llvm::zip(vIntermediate, outputs))
-        emitCopy(rewriter, loc, std::get<0>(vIntermediateToFinal),
-            std::get<1>(vIntermediateToFinal));
+        if (!parallel)
+          emitCopy(rewriter, loc, std::get<0>(vIntermediateToFinal),
+              std::get<1>(vIntermediateToFinal));
 
       // Copy intermediate values of scan outputs to their corresponding slice
       // in the scan scan output tensor.
@@ -174,10 +212,21 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
       auto scanOutputs = llvm::make_range(
           outputs.begin() + scanOp.getVInitial().size(), outputs.end());
       for (auto scanIntermediateToFinal :
-          llvm::zip(scanIntermediate, scanOutputs))
-        emitCopy(rewriter, loc, std::get<0>(scanIntermediateToFinal),
-            std::get<1>(scanIntermediateToFinal),
+          llvm::zip(scanIntermediate, scanOutputs)) {
+        Value bodyScanOutput = std::get<0>(scanIntermediateToFinal);
+        Value scanOutput = std::get<1>(scanIntermediateToFinal);
+        if (isStreamedScanOutput(scanOutput)) {
+          // Write in place into the buffer of the final shape, which is
+          // allocated by the first iteration.
+          emitAllocForStreamedScanOutput(
+              rewriter, loc, bodyScanOutput, scanOutput, iv);
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+          scanOutput =
+              create.krnl.load(scanOutput, create.math.constantIndex(0));
+        }
+        emitCopy(rewriter, loc, bodyScanOutput, scanOutput,
             /*writePrefix=*/{iv});
+      }
 
       // Remove scan body terminator op.
       rewriter.eraseOp(scanBodyTerminator);
@@ -193,10 +242,28 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
       rewriter.eraseBlock(&scanBodyBlock);
     }
 
+    // Load the buffers of the scan outputs written in place.
+    rewriter.setInsertionPointAfter(iterateOp);
+    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+    for (Value &output : outputs)
+      if (isStreamedScanOutput(output))
+        output = create.krnl.load(output, create.math.constantIndex(0));
+
     rewriter.replaceOp(op, outputs);
     return success();
   }
 
+  // Return true if the scan carried dependencies are passed through the body
+  // unchanged, so that the iterations are independent.
+  static bool hasIndependentIterations(ONNXScanOp scanOp) {
+    Block &bodyBlock = scanOp.getBody().front();
+    Operation *yieldOp = bodyBlock.getTerminator();
+    for (unsigned i = 0, e = scanOp.getVInitial().size(); i < e; i++)
+      if (yieldOp->getOperand(i) != bodyBlock.getArgument(i))
+        return false;
+    return true;
+  }
+
   static void allocateMemoryForVFinal(mlir::Location loc,
       ConversionPatternRewriter &rewriter, TypeConverter *typeConverter,
       Operation *op, ONNXScanOpAdaptor adaptor,
@@ -225,7 +292,7 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
   static void allocateMemoryForScanOutput(mlir::Location loc,
       ConversionPatternRewriter &rewriter, TypeConverter *typeConverter,
       Operation *op, ONNXScanOpAdaptor adaptor,
-      SmallVectorImpl<mlir::Value> &outputs) {
+      SmallVectorImpl<mlir::Value> &outputs, bool enableStreamingLoops) {
     auto scanOp = dyn_cast<ONNXScanOp>(op);
     for (const auto &opScanOutput : scanOp.scan_outputs()) {
       // Convert opScanOutput's type to MemRefType.
@@ -241,9 +308,28 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
       // which is easier to obtain.
       Value alloc;
       MemRefBuilder createMemRef(rewriter, loc);
+      bool hasDynamicScanDims = false;
+      for (int i = 1; i < memRefType.getRank(); i++)
+        hasDynamicScanDims |= memRefType.isDynamicDim(i);
       if (hasAllConstantDimensions(memRefType))
         alloc = createMemRef.alignedAlloc(memRefType);
-      else {
+      else if (hasDynamicScanDims && enableStreamingLoops) {
+        // Use memref<1xmemref<d1 x d2, ..., dnxT>>, holding the buffer of the
+        // final shape once allocated by the first iteration, when the output
+        // of the body is known. Initialize it with an empty buffer, which is
+        // the output if the scan inputs are empty.
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+        SmallVector<mlir::Value, 4> emptyParams;
+        if (memRefType.isDynamicDim(0))
+          emptyParams.emplace_back(
+              createMemRef.dim(scanOp.scan_inputs().front(), 0));
+        for (int i = 1; i < memRefType.getRank(); i++)
+          if (memRefType.isDynamicDim(i))
+            emptyParams.emplace_back(create.math.constantIndex(0));
+        Value empty = createMemRef.alignedAlloc(memRefType, emptyParams);
+        alloc = createMemRef.alignedAlloc(MemRefType::get({1}, memRefType));
+        create.krnl.store(empty, alloc, create.math.constantIndex(0));
+      } else {
         auto rankedScanOutTy = memRefType;
         SmallVector<mlir::Value, 4> allocParams;
         for (int i = 0; i < rankedScanOutTy.getRank(); i++) {
@@ -270,6 +356,41 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
     }
   }
 
+  // Return true if the scan output is written in place into a buffer of its
+  // final shape, held by the storage of type memref<1xmemref<d1 x d2, ...,
+  // dnxT>>.
+  static bool isStreamedScanOutput(Value storage) {
+    return storage.getType()
+        .cast<MemRefType>()
+        .getElementType()
+        .isa<MemRefType>();
+  }
+
+  // In the first iteration, replace the empty buffer held by the storage of a
+  // streamed scan output by a buffer of its final shape, whose leading dim is
+  // the one of the empty buffer and whose other dims are the ones of the
+  // output of the body.
+  static void emitAllocForStreamedScanOutput(OpBuilder &builder,
+      const Location &loc, Value bodyOutput, Value storage, Value iv) {
+    OpBuilder::InsertionGuard insertGuard(builder);
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        builder, loc);
+    Value zero = create.math.constantIndex(0);
+    auto ifOp = builder.create<scf::IfOp>(
+        loc, create.math.eq(iv, zero), /*withElseRegion=*/false);
+    builder.setInsertionPointToStart(&ifOp.getThenRegion().front());
+    Value empty = create.krnl.load(storage, zero);
+    auto bufferType = empty.getType().cast<MemRefType>();
+    SmallVector<Value, 4> allocParams;
+    if (bufferType.isDynamicDim(0))
+      allocParams.emplace_back(create.mem.dim(empty, 0));
+    for (int64_t i = 1; i < bufferType.getRank(); i++)
+      if (bufferType.isDynamicDim(i))
+        allocParams.emplace_back(create.mem.dim(bodyOutput, i - 1));
+    Value buffer = create.mem.alignedAlloc(bufferType, allocParams);
+    create.krnl.store(buffer, storage, zero);
+  }
+
   static mlir::Value allocateMemoryForBodyScanInput(mlir::Location loc,
       ConversionPatternRewriter &rewriter, TypeConverter *typeConverter,
       mlir::Type bodyScanInputTy) {
@@ -362,7 +483,9 @@ struct ONNXScanOpLowering : public OpConversionPattern<ONNXScanOp> {
 };
 
 void populateLoweringONNXScanOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXScanOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableStreamingLoops,
+    bool enableParallel) {
+  patterns.insert<ONNXScanOpLowering>(
+      typeConverter, ctx, enableStreamingLoops, enableParallel);
 }
 } // namespace onnx_mlir
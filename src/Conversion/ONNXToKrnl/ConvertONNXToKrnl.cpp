@@ -16,11 +16,14 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Shape/IR/Shape.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/IR/Threading.h"
 
 #include "src/Accelerators/Accelerator.hpp"
 #include "src/Builder/ModelInputShaper.hpp"
 #include "src/Compiler/CompilerOptions.hpp"
+#include "src/Conversion/ONNXToKrnl/MatMulTiles.hpp"
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Transform/ONNX/ONNXDimAnalysis.hpp"
 
 using namespace mlir;
 
@@ -172,7 +175,10 @@ std::map<std::string, std::string> ONNXEntryPointLowering::typeMap = {
 
 void populateONNXToKrnlConversionPattern(RewritePatternSet &patterns,
     TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling,
-    bool enableSIMD, bool enableParallel) {
+    bool enableSIMD, bool enableParallel, int64_t parallelThreshold,
+    bool enableFusion, bool enableStreamingLoops, int64_t convWinogradThreshold,
+    bool enableBLAS, int64_t blasThreshold, const MatMulTileDB *tileDB,
+    int64_t sparseWeightThreshold) {
   // Type conversion for function signatures.
   // Call MLIR FuncOp signature conversion when result type is
   // a ranked tensor.
@@ -184,36 +190,61 @@ void populateONNXToKrnlConversionPattern(RewritePatternSet &patterns,
   // Frontend operation lowering.
   // ControlFlow
   populateLoweringONNXIfOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXLoopOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXScanOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXLoopOpPattern(
+      patterns, typeConverter, ctx, enableStreamingLoops, enableParallel);
+  populateLoweringONNXScanOpPattern(
+      patterns, typeConverter, ctx, enableStreamingLoops, enableParallel);
   // Math
+  // The Gemm, MatMul and Conv ops chosen to be computed by the external BLAS
+  // library are matched first, and the other ones lowered to Krnl loops.
+  if (enableBLAS)
+    populateLoweringONNXToBLASPattern(
+        patterns, typeConverter, ctx, blasThreshold, tileDB);
+  populateLoweringONNXBernoulliOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXClipOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXCumSumOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXElementwiseOpPattern(
+  populateLoweringONNXCumSumOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
+  populateLoweringONNXDFTOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXElementwiseOpPattern(patterns, typeConverter, ctx,
+      enableSIMD, enableParallel, parallelThreshold, enableFusion);
+  populateLoweringONNXGemmOpPattern(patterns, typeConverter, ctx,
+      enableTiling, enableParallel, tileDB, sparseWeightThreshold);
+  populateLoweringONNXHardmaxOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
+  populateLoweringONNXReductionOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
+  populateLoweringONNXSoftmaxOpPattern(
       patterns, typeConverter, ctx, enableSIMD);
-  populateLoweringONNXGemmOpPattern(patterns, typeConverter, ctx, enableTiling);
-  populateLoweringONNXHardmaxOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXReductionOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXSoftmaxOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXTopKOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXMatMulOpPattern(
-      patterns, typeConverter, ctx, enableTiling);
+  populateLoweringONNXMatMulOpPattern(patterns, typeConverter, ctx,
+      enableTiling, enableParallel, tileDB, sparseWeightThreshold);
   populateLoweringONNXRandomNormalOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXRandomNormalLikeOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXLRNOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXRandomUniformOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXLRNOpPattern(patterns, typeConverter, ctx, enableSIMD);
   // ML
-  populateLoweringONNXCategoryMapperOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXCategoryMapperOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
   // ObjectDetection
-  populateLoweringONNXNonMaxSuppressionOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXNonMaxSuppressionOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
+  // Quantization
+  populateLoweringONNXDequantizeLinearOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXDynamicQuantizeLinearOpPattern(
+      patterns, typeConverter, ctx);
+  populateLoweringONNXQuantizeLinearOpPattern(patterns, typeConverter, ctx);
   // Tensor
-  populateLoweringONNXArgMinMaxOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXArgMinMaxOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
   populateLoweringONNXDimOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXReshapeOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXPadOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXUnsqueezeOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXUnsqueezeV11OpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXTransposeOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXGatherOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXTransposeOpPattern(
+      patterns, typeConverter, ctx, enableSIMD);
+  populateLoweringONNXGatherOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
   populateLoweringONNXGatherElementsOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXGatherNDOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXIdentityOpPattern(patterns, typeConverter, ctx);
@@ -237,23 +268,33 @@ void populateONNXToKrnlConversionPattern(RewritePatternSet &patterns,
   populateLoweringONNXFlattenOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXRangeOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXResizeOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXNonZeroOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXNonZeroOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
   populateLoweringONNXReverseSequenceOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXExpandOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXOneHotOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXCompressOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXCompressOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
+  populateLoweringONNXUniqueOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXPrintSignaturePattern(patterns, typeConverter, ctx);
   populateLoweringONNXLayoutTransformOpPattern(patterns, typeConverter, ctx);
 
   // Neural network
-  populateLoweringONNXConvOpPattern(
-      patterns, typeConverter, ctx, enableParallel);
-  populateLoweringONNXNormalizationOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXPoolingOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXConvOpPattern(patterns, typeConverter, ctx,
+      enableTiling, enableParallel, convWinogradThreshold);
+  populateLoweringONNXConvTransposeOpPattern(
+      patterns, typeConverter, ctx, enableTiling, enableParallel);
+  populateLoweringONNXNormalizationOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
+  populateLoweringONNXPoolingOpPattern(
+      patterns, typeConverter, ctx, enableSIMD, enableParallel);
   // Recurrent neural network
-  populateLoweringONNXGRUOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXLSTMOpPattern(patterns, typeConverter, ctx);
-  populateLoweringONNXRNNOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXGRUOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
+  populateLoweringONNXLSTMOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
+  populateLoweringONNXRNNOpPattern(
+      patterns, typeConverter, ctx, enableParallel);
   // Sequence
   populateLoweringONNXSequenceAtOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXSequenceEmptyOpPattern(patterns, typeConverter, ctx);
@@ -263,9 +304,36 @@ void populateONNXToKrnlConversionPattern(RewritePatternSet &patterns,
   // Entry point
   patterns.insert<ONNXEntryPointLowering>(ctx);
   // Additional
+  populateLoweringONNXFusedAttentionOpPattern(
+      patterns, typeConverter, ctx, enableSIMD);
+  populateLoweringONNXMemoOpPattern(patterns, typeConverter, ctx);
+  populateLoweringONNXPagedKVCacheWriteOpPattern(patterns, typeConverter, ctx);
   populateLoweringONNXShapeTransformOpPattern(patterns, typeConverter, ctx);
 }
 
+// Erase the shapes that are only written, their users having read the scalars
+// stored in them instead, see IndexExprBuilderForKrnl::getVal. The shape
+// computations of the function then need no buffer.
+static void eraseUnreadShapes(Operation *op) {
+  SmallVector<memref::AllocOp, 8> allocOps;
+  op->walk([&](memref::AllocOp allocOp) {
+    if (!isShapeLikeMemRef(allocOp.getType()))
+      return;
+    Value shape = allocOp.getResult();
+    if (llvm::all_of(shape.getUsers(), [&](Operation *user) {
+          if (auto storeOp = dyn_cast<KrnlStoreOp>(user))
+            return storeOp.getMemref() == shape;
+          return isa<memref::ReinterpretCastOp>(user) && user->use_empty();
+        }))
+      allocOps.emplace_back(allocOp);
+  });
+  for (memref::AllocOp allocOp : allocOps) {
+    for (Operation *user : llvm::make_early_inc_range(allocOp->getUsers()))
+      user->erase();
+    allocOp.erase();
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Frontend to Krnl Dialect lowering pass
 //===----------------------------------------------------------------------===//
@@ -295,12 +363,32 @@ struct FrontendToKrnlLoweringPass
     this->enableSIMD = enableSIMD;
     this->enableParallel = enableParallel;
   }
-  FrontendToKrnlLoweringPass(int optLevel, bool enableParallel)
+  FrontendToKrnlLoweringPass(int optLevel, bool enableParallel,
+      int64_t parallelThreshold, bool enableFusion, bool enableStreamingLoops,
+      int64_t convWinogradThreshold, bool enableDimAnalysis,
+      std::string matmulTileDB, std::string targetCPU, bool enableBLAS,
+      int64_t blasThreshold, int64_t sparseWeightThreshold)
       : FrontendToKrnlLoweringPass(/*enableTiling=*/optLevel >= 3,
-            /*enableSIMD=*/optLevel >= 3, enableParallel) {}
+            /*enableSIMD=*/optLevel >= 3, enableParallel) {
+    this->parallelThreshold = parallelThreshold;
+    this->enableFusion = enableFusion;
+    this->enableStreamingLoops = enableStreamingLoops;
+    this->convWinogradThreshold = convWinogradThreshold;
+    this->enableDimAnalysis = enableDimAnalysis;
+    this->matmulTileDB = matmulTileDB;
+    this->targetCPU = targetCPU;
+    this->enableBLAS = enableBLAS;
+    this->blasThreshold = blasThreshold;
+    this->sparseWeightThreshold = sparseWeightThreshold;
+  }
 
   void runOnOperation() final;
 
+  // Lower the ONNX ops nested in the given op. Each call has a conversion
+  // target, type converter and patterns of its own, so that the functions can
+  // be lowered in parallel.
+  LogicalResult lowerToKrnl(Operation *op);
+
 public:
   // Some ops (RNN ops for example) are lowered to other ONNX ops such as
   // ONNXMatMulOp, ONNXSplitOp, ONNXTransposeOp, etc. These ONNX ops are then
@@ -324,11 +412,118 @@ public:
       llvm::cl::desc("Enable SIMD code gen"), llvm::cl::init(false)};
   Option<bool> enableParallel{*this, "enable-parallel",
       llvm::cl::desc("Enable parallelization"), llvm::cl::init(false)};
+  Option<int64_t> parallelThreshold{*this, "parallel-threshold",
+      llvm::cl::desc("Minimum number of elements of the output of an "
+                     "elementwise op for it to be parallelized"),
+      llvm::cl::init(65536)};
+  Option<bool> enableFusion{*this, "enable-fusion",
+      llvm::cl::desc("Enable fusion of chains of elementwise ops"),
+      llvm::cl::init(false)};
+  Option<bool> enableStreamingLoops{*this, "enable-streaming-loops",
+      llvm::cl::desc("Write the scan outputs of Loop and Scan ops in place "
+                     "and hoist the allocations invariant in their bodies"),
+      llvm::cl::init(false)};
+  Option<int64_t> convWinogradThreshold{*this, "conv-winograd-threshold",
+      llvm::cl::desc("Minimum number of input and output channels of a 3x3 "
+                     "convolution of stride 1 for it to be lowered with "
+                     "Winograd when tiling is enabled"),
+      llvm::cl::init(32)};
+  Option<bool> enableDimAnalysis{*this, "enable-dim-analysis",
+      llvm::cl::desc("Compute the runtime dimensions proven equal by the "
+                     "dimension analysis from the same operand dimensions"),
+      llvm::cl::init(false)};
+  Option<std::string> matmulTileDB{*this, "matmul-tile-db",
+      llvm::cl::desc("Tuning database of the tile sizes of the MatMul and "
+                     "Gemm ops of given shapes, as written by "
+                     "utils/TuneMatMulTiles.py"),
+      llvm::cl::init("")};
+  Option<std::string> targetCPU{*this, "target-cpu",
+      llvm::cl::desc("Target CPU whose tuned tile sizes are used"),
+      llvm::cl::init("")};
+  Option<bool> enableBLAS{*this, "enable-blas",
+      llvm::cl::desc("Compute the large enough Gemm, MatMul and Conv ops "
+                     "with the external BLAS library of the runtime"),
+      llvm::cl::init(false)};
+  Option<int64_t> blasThreshold{*this, "blas-threshold",
+      llvm::cl::desc("Minimum number of flops of the Gemm, MatMul and Conv "
+                     "ops of static shapes computed by the BLAS library, "
+                     "when their shapes were not tuned"),
+      llvm::cl::init(16777216)};
+  Option<int64_t> sparseWeightThreshold{*this, "sparse-weight-threshold",
+      llvm::cl::desc("Minimum percentage of zero blocks of one vector of a "
+                     "constant f32 B of a MatMul or Gemm op for it to be "
+                     "multiplied in a block-sparse form when tiling is "
+                     "enabled, 0 disabling it"),
+      llvm::cl::init(80)};
+
+private:
+  // Tile sizes loaded from matmulTileDB, shared by the lowering of all the
+  // functions.
+  std::unique_ptr<MatMulTileDB> tileDB;
 };
 
 void FrontendToKrnlLoweringPass::runOnOperation() {
   ModuleOp module = getOperation();
 
+  // Load the tile sizes autotuned for the target CPU.
+  tileDB.reset();
+  if (!matmulTileDB.empty()) {
+    std::string error;
+    tileDB = MatMulTileDB::load(matmulTileDB, targetCPU, error);
+    if (!tileDB) {
+      module.emitError("matmul-tile-db: ") << error;
+      return signalPassFailure();
+    }
+  }
+
+  // Group the runtime dimensions proven equal, for the shape helpers to
+  // compute equal dimensions the same way. The sizes of equal dynamic buffers
+  // and the bounds of their loops then become the same values, which lets the
+  // memory pools reuse the buffers and CSE share the size computations.
+  ONNXOpShapeHelper::DimGroupMapT dimGroups;
+  if (enableDimAnalysis) {
+    DimAnalysis dimAnalysis(module);
+    dimAnalysis.analyze();
+    for (auto &entry : dimAnalysis.getGroupingResult())
+      for (const DimAnalysis::DimT &dim : entry.second)
+        dimGroups[dim] = entry.first;
+  }
+
+  // Lower the module level ops first, e.g. the entry points whose signatures
+  // are made of the tensor types of their functions.
+  SmallVector<Operation *, 4> funcOps;
+  for (Operation &op : llvm::make_early_inc_range(*module.getBody())) {
+    if (isa<func::FuncOp>(op))
+      funcOps.emplace_back(&op);
+    else if (failed(lowerToKrnl(&op)))
+      return signalPassFailure();
+  }
+
+  // The functions are isolated from each other, and lowered in parallel when
+  // multithreading is enabled in the context. The dimension groups are set
+  // in each thread, as the shape helpers keep them in a thread local.
+  if (failed(failableParallelForEach(
+          &getContext(), funcOps, [&](Operation *funcOp) {
+            if (enableDimAnalysis)
+              ONNXOpShapeHelper::setDimGroups(&dimGroups);
+            LogicalResult result = lowerToKrnl(funcOp);
+            ONNXOpShapeHelper::setDimGroups(nullptr);
+            return result;
+          })))
+    return signalPassFailure();
+
+  // The constants are numbered in the order the threads create them. Number
+  // them again in the order of the module, for the names not to depend on
+  // the scheduling of the threads.
+  int64_t constantID = 0;
+  module.walk([&](KrnlGlobalOp globalOp) {
+    StringRef name = globalOp.getName().rtrim("0123456789");
+    globalOp.setNameAttr(StringAttr::get(
+        &getContext(), name + std::to_string(constantID++)));
+  });
+}
+
+LogicalResult FrontendToKrnlLoweringPass::lowerToKrnl(Operation *op) {
   // The first thing to define is the conversion target. This will define the
   // final target for this lowering.
   ConversionTarget target(getContext());
@@ -416,7 +611,10 @@ void FrontendToKrnlLoweringPass::runOnOperation() {
 
   // Define patterns.
   populateONNXToKrnlConversionPattern(patterns, krnlTypeConverter,
-      &getContext(), enableTiling, enableSIMD, enableParallel);
+      &getContext(), enableTiling, enableSIMD, enableParallel,
+      parallelThreshold, enableFusion, enableStreamingLoops,
+      convWinogradThreshold, enableBLAS, blasThreshold, tileDB.get(),
+      sparseWeightThreshold);
 
   // Rewrite patterns for accelerators.
   for (auto *accel : onnx_mlir::accel::Accelerator::getAccelerators())
@@ -425,17 +623,25 @@ void FrontendToKrnlLoweringPass::runOnOperation() {
   // With the target and rewrite patterns defined, we can now attempt the
   // conversion. The conversion will signal failure if any of our `illegal`
   // operations were not converted successfully.
-  if (failed(applyPartialConversion(module, target, std::move(patterns)))) {
-    signalPassFailure();
-  }
+  if (failed(applyPartialConversion(op, target, std::move(patterns))))
+    return failure();
+  eraseUnreadShapes(op);
+  return success();
 }
 
 std::unique_ptr<Pass> createLowerToKrnlPass() {
   return std::make_unique<FrontendToKrnlLoweringPass>();
 }
 
-std::unique_ptr<Pass> createLowerToKrnlPass(int optLevel, bool enableParallel) {
-  return std::make_unique<FrontendToKrnlLoweringPass>(optLevel, enableParallel);
+std::unique_ptr<Pass> createLowerToKrnlPass(int optLevel,
+    bool enableParallel, int64_t parallelThreshold, bool enableFusion,
+    bool enableStreamingLoops, int64_t convWinogradThreshold,
+    bool enableDimAnalysis, std::string matmulTileDB, std::string targetCPU,
+    bool enableBLAS, int64_t blasThreshold, int64_t sparseWeightThreshold) {
+  return std::make_unique<FrontendToKrnlLoweringPass>(optLevel,
+      enableParallel, parallelThreshold, enableFusion, enableStreamingLoops,
+      convWinogradThreshold, enableDimAnalysis, matmulTileDB, targetCPU,
+      enableBLAS, blasThreshold, sparseWeightThreshold);
 }
 
 std::unique_ptr<Pass> createLowerToKrnlPass(
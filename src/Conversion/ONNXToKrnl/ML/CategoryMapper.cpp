@@ -27,6 +27,11 @@
 using namespace mlir;
 
 namespace onnx_mlir {
+
+// Minimum number of input elements for which the lookups are distributed with
+// a parallel loop. Dynamic shapes are assumed to be large enough.
+static constexpr int64_t kCategoryMapperParallelMinElements = 1024;
+
 struct ONNXCategoryMapperOpLowering
     : public OpConversionPattern<ONNXCategoryMapperOp> {
   using PerfectHashTable = struct {
@@ -39,10 +44,14 @@ struct ONNXCategoryMapperOpLowering
   static const bool emitPrintStmts = false;
 
   using LocalDialectBuilder = MultiDialectBuilder<KrnlBuilder,
-      IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>;
+      IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder, SCFBuilder>;
+
+  bool enableParallel;
 
-  ONNXCategoryMapperOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXCategoryMapperOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableParallel(enableParallel) {}
 
   LogicalResult matchAndRewrite(ONNXCategoryMapperOp categoryMapperOp,
       ONNXCategoryMapperOpAdaptor adaptor,
@@ -119,6 +128,21 @@ struct ONNXCategoryMapperOpLowering
     Value constantForCatsStrings = create.krnl.constant(
         catsStringsInMemRefType, "cats_strings", cats_strings);
 
+    // The lengths of the strings, including their null terminator, are
+    // computed at compile time, so that the lookups of input strings need no
+    // strlen. Comparing the null terminator rejects the input strings that a
+    // category is a prefix of.
+    Value constantForCatsStringsLengths = nullptr;
+    if (elementType.isa<krnl::StringType>()) {
+      SmallVector<int64_t> lengths;
+      for (Attribute cat : cats_stringsAttr.getValue())
+        lengths.emplace_back(cat.cast<StringAttr>().getValue().size() + 1);
+      MemRefType lengthsType = MemRefType::get(
+          {static_cast<int64_t>(lengths.size())}, rewriter.getI64Type());
+      constantForCatsStringsLengths = create.krnl.constant(lengthsType,
+          "cats_strings_lengths", rewriter.getI64TensorAttr(lengths));
+    }
+
     Value defaultInt64 = (default_int64)
                              ? create.math.constant(rewriter.getIntegerType(64),
                                    default_int64.getSInt())
@@ -130,43 +154,38 @@ struct ONNXCategoryMapperOpLowering
                                "default_string", default_string)
                          : nullptr;
 
-    // Lookup the index in the perfect hash table corresponding to
-    // each input value.
-    LiteralIndexExpr zeroIE(0);
-    SmallVector<IndexExpr, 4> lbs(rank, zeroIE);
-    SmallVector<IndexExpr, 4> ubs;
-    create.krnlIE.getShapeAsDims(X, ubs);
-
     if (emitPrintStmts)
       create.krnl.printTensor("Input tensor:\n", X);
 
-    ValueRange loopDef = create.krnl.defineLoops(rank);
-    create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
-        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
-          // Determine the index of 'inputElem' in the perfect hash table
-          // 'pHash'. Note: the index might not be valid (this happens
-          // when the 'inputElem' is not present in the perfect hash
-          // table).
-          Value inputElem =
-              loadElement(X, loopInd, elementType, rank, createKrnl);
-          if (emitPrintStmts)
-            create.krnl.printf("inputElem: ", inputElem, elementType);
-
-          Value index, isIndexValid;
-          std::tie(index, isIndexValid) =
-              emitFindIndex(inputElem, elementType, perfectHashTable,
-                  constantForCatsInt64s, constantForCatsStrings, create);
-
-          if (emitPrintStmts)
-            create.krnl.printf("index: ", index, index.getType());
-
-          // Store the final result.
-          scf::IfOp ifOp = rewriter.create<scf::IfOp>(
-              loc, isIndexValid, /*withElseRegion=*/true);
-          storeResult(index, elementType, ifOp, constantForCatsInt64s,
-              constantForCatsStrings, defaultInt64, defaultString, alloc,
-              loopInd, createKrnl, rewriter);
-        });
+    // Lookup the index in the perfect hash table corresponding to
+    // each input value.
+    auto mapElement = [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+      LocalDialectBuilder create(createKrnl);
+      // Determine the index of 'inputElem' in the perfect hash table
+      // 'pHash'. Note: the index might not be valid (this happens
+      // when the 'inputElem' is not present in the perfect hash
+      // table).
+      Value inputElem = loadElement(X, loopInd, elementType, rank, createKrnl);
+      if (emitPrintStmts)
+        create.krnl.printf("inputElem: ", inputElem, elementType);
+
+      Value index, isIndexValid;
+      std::tie(index, isIndexValid) = emitFindIndex(inputElem, elementType,
+          perfectHashTable, constantForCatsInt64s, constantForCatsStrings,
+          constantForCatsStringsLengths, create);
+
+      if (emitPrintStmts)
+        create.krnl.printf("index: ", index, index.getType());
+
+      // Store the final result.
+      OpBuilder &builder = createKrnl.getBuilder();
+      scf::IfOp ifOp =
+          builder.create<scf::IfOp>(loc, isIndexValid, /*withElseRegion=*/true);
+      storeResult(index, elementType, ifOp, constantForCatsInt64s,
+          constantForCatsStrings, defaultInt64, defaultString, alloc, loopInd,
+          createKrnl);
+    };
+    emitMappingLoops(X, isParallelProfitable(inputType), mapElement, create);
 
     rewriter.replaceOp(op, alloc);
 
@@ -184,6 +203,59 @@ private:
     return arr.getValue()[idx];
   }
 
+  // Return true when the lookups of the input elements are worth distributing
+  // with a parallel loop.
+  bool isParallelProfitable(ShapedType inputType) const {
+    if (!enableParallel || inputType.getRank() == 0)
+      return false;
+    if (!inputType.hasStaticShape())
+      return true;
+    return inputType.getNumElements() >= kCategoryMapperParallelMinElements;
+  }
+
+  // Emit a loop nest over all the elements of 'X' and call 'bodyFn' with the
+  // indices of the current element. When 'parallel' is set, the outermost
+  // dimension that is not a static 1 is distributed with an scf.parallel, and
+  // the remaining loops are emitted inside a krnl.region so that the parallel
+  // induction variable is a valid affine symbol for the Krnl loops.
+  void emitMappingLoops(Value X, bool parallel,
+      function_ref<void(KrnlBuilder &createKrnl, ValueRange loopInd)> bodyFn,
+      const LocalDialectBuilder &create) const {
+    int64_t rank = X.getType().cast<MemRefType>().getRank();
+    if (!parallel) {
+      SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+      SmallVector<IndexExpr, 4> ubs;
+      create.krnlIE.getShapeAsDims(X, ubs);
+      ValueRange loopDef = create.krnl.defineLoops(rank);
+      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs, bodyFn);
+      return;
+    }
+    // Skip the leading unit dimensions.
+    ArrayRef<int64_t> shape = X.getType().cast<MemRefType>().getShape();
+    int64_t parDim = 0;
+    while (parDim < rank - 1 && shape[parDim] == 1)
+      ++parDim;
+    Location loc = create.krnl.getLoc();
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    SmallVector<Value, 4> lbs(rank, zero);
+    SmallVector<Value, 4> ubs;
+    for (int64_t d = 0; d < rank; ++d)
+      ubs.emplace_back(create.mem.dim(X, d));
+    create.scf.parallelLoop({zero}, {ubs[parDim]}, {one},
+        [&](SCFBuilder &createSCF, ValueRange parInd) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+          lbs[parDim] = parInd[0];
+          ubs[parDim] = create.math.add(parInd[0], one);
+          ValueRange loopDef = create.krnl.defineLoops(rank);
+          create.krnl.iterate(loopDef, loopDef, lbs, ubs, bodyFn);
+        });
+  }
+
   // Generate a perfect hash table for the input dictionary.
   // Depending on the runtime type 'elementType' (the type of the element of
   // the input tensor) this function created a perfect hash table for:
@@ -277,7 +349,8 @@ private:
   // valid or not.
   std::tuple<Value, Value> emitFindIndex(Value inputElem, Type elementType,
       const PerfectHashTable &pHash, Value constantForCatsInt64s,
-      Value constantForCatsStrings, const LocalDialectBuilder &create) const {
+      Value constantForCatsStrings, Value constantForCatsStringsLengths,
+      const LocalDialectBuilder &create) const {
     OpBuilder builder = create.krnl.getBuilder();
     Value index = create.krnl.findIndex(inputElem, pHash.G, pHash.V, pHash.len);
 
@@ -294,11 +367,11 @@ private:
         .Case<krnl::StringType>([&](krnl::StringType type) {
           // Determine whether the index returned is valid.
           // The index is valid if 'inputElem' compares equal to the string in
-          // 'constantForCatsStrings'.
+          // 'constantForCatsStrings', including its null terminator.
           Value compareVal = create.krnl.load(constantForCatsStrings, {index});
-          Value strlenRes = create.krnl.strlen(compareVal);
-          Value strncmpRes =
-              create.krnl.strncmp(inputElem, compareVal, strlenRes);
+          Value length =
+              create.krnl.load(constantForCatsStringsLengths, {index});
+          Value strncmpRes = create.krnl.strncmp(inputElem, compareVal, length);
           Value zeroVal = create.math.constant(builder.getIntegerType(32), 0);
           Value isIndexValid = create.math.eq(strncmpRes, zeroVal);
           res = std::make_tuple(index, isIndexValid);
@@ -320,28 +393,28 @@ private:
   void storeResult(Value index, Type elementType, scf::IfOp ifOp,
       Value constantForCatsInt64s, Value constantForCatsStrings,
       Value defaultInt64, Value defaultString, Value alloc, ValueRange loopInd,
-      const KrnlBuilder &createKrnl,
-      ConversionPatternRewriter &rewriter) const {
+      const KrnlBuilder &createKrnl) const {
+    OpBuilder &builder = createKrnl.getBuilder();
     TypeSwitch<Type>(elementType)
         .Case<IntegerType>([&](IntegerType type) {
           // index is valid: retrieve the value from 'cat_strings'.
-          rewriter.setInsertionPointToStart(&ifOp.getThenRegion().front());
+          builder.setInsertionPointToStart(&ifOp.getThenRegion().front());
           Value loadData = createKrnl.load(constantForCatsStrings, {index});
           createKrnl.store(loadData, alloc, loopInd);
 
           // index is not valid: store the default value.
-          rewriter.setInsertionPointToStart(&ifOp.getElseRegion().front());
+          builder.setInsertionPointToStart(&ifOp.getElseRegion().front());
           Value loadDefault = createKrnl.load(defaultString);
           createKrnl.store(loadDefault, alloc, loopInd);
         })
         .Case<krnl::StringType>([&](krnl::StringType type) {
           // index is valid: retrieve the value from 'cat_int64s'.
-          rewriter.setInsertionPointToStart(&ifOp.getThenRegion().front());
+          builder.setInsertionPointToStart(&ifOp.getThenRegion().front());
           Value loadData = createKrnl.load(constantForCatsInt64s, {index});
           createKrnl.store(loadData, alloc, loopInd);
 
           // index is not valid: store the default value.
-          rewriter.setInsertionPointToStart(&ifOp.getElseRegion().front());
+          builder.setInsertionPointToStart(&ifOp.getElseRegion().front());
           createKrnl.store(defaultInt64, alloc, loopInd);
         })
         .Default([&](Type type) {
@@ -352,8 +425,9 @@ private:
 };
 
 void populateLoweringONNXCategoryMapperOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXCategoryMapperOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
+  patterns.insert<ONNXCategoryMapperOpLowering>(
+      typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
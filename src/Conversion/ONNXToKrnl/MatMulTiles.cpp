@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//====------------ MatMulTiles.cpp - Tuned MatMul Tile Sizes --------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the implementation of the database of the tile sizes
+// found by autotuning the matrix multiplications of given shapes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/MatMulTiles.hpp"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#define DEBUG_TYPE "matmul_tiles"
+
+using namespace llvm;
+
+namespace onnx_mlir {
+
+// Read the array of 3 positive sizes named `name` of an entry, the array being
+// optional when `optional` is set.
+static bool readTriple(const json::Object &entry, StringRef name,
+    int64_t triple[3], bool optional) {
+  const json::Array *array = entry.getArray(name);
+  if (!array)
+    return optional;
+  if (array->size() != 3)
+    return false;
+  for (int i = 0; i < 3; ++i) {
+    Optional<int64_t> size = (*array)[i].getAsInteger();
+    if (!size || *size <= 0)
+      return false;
+    triple[i] = *size;
+  }
+  return true;
+}
+
+std::unique_ptr<MatMulTileDB> MatMulTileDB::load(
+    StringRef path, StringRef mcpu, std::string &error) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> buffer =
+      MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (std::error_code ec = buffer.getError()) {
+    error = formatv("cannot read '{0}': {1}", path, ec.message()).str();
+    return nullptr;
+  }
+  Expected<json::Value> db = json::parse((*buffer)->getBuffer());
+  if (!db) {
+    error = formatv("cannot parse '{0}': {1}", path, toString(db.takeError()))
+                .str();
+    return nullptr;
+  }
+  const json::Object *root = db->getAsObject();
+  const json::Array *tiles = root ? root->getArray("matmul_tiles") : nullptr;
+  if (!tiles) {
+    error = formatv("'{0}' has no \"matmul_tiles\" array", path).str();
+    return nullptr;
+  }
+
+  auto tileDB = std::make_unique<MatMulTileDB>();
+  for (size_t n = 0; n < tiles->size(); ++n) {
+    const json::Object *entry = (*tiles)[n].getAsObject();
+    Optional<StringRef> entryCPU = entry ? entry->getString("mcpu") : None;
+    Optional<StringRef> op = entry ? entry->getString("op") : None;
+    Optional<StringRef> backend = entry ? entry->getString("backend") : None;
+    bool useBLAS = backend && *backend == "blas";
+    // Only the generated code of MatMul and Gemm ops has register tiles.
+    bool hasTiles = op && *op != "Conv" && !useBLAS;
+    int64_t shape[3];
+    MatMulTileSizes sizes;
+    if (!entryCPU || !op ||
+        (*op != "MatMul" && *op != "Gemm" && *op != "Conv") ||
+        (backend && *backend != "blas" && *backend != "krnl") ||
+        !readTriple(*entry, "shape", shape, /*optional=*/false) ||
+        !readTriple(*entry, "reg", sizes.regTile, /*optional=*/!hasTiles) ||
+        !readTriple(*entry, "cache", sizes.cacheTile, /*optional=*/true)) {
+      error = formatv("invalid entry {0} of '{1}'", n, path).str();
+      return nullptr;
+    }
+    // Register tiles are iterated within cache tiles, so that the latter must
+    // be multiples of the former.
+    if (sizes.regTile[0] &&
+        (sizes.cacheTile[0] % sizes.regTile[0] != 0 ||
+            sizes.cacheTile[1] % sizes.regTile[1] != 0)) {
+      error = formatv("entry {0} of '{1}' has cache tiles that are not "
+                      "multiples of its register tiles",
+          n, path)
+                  .str();
+      return nullptr;
+    }
+    if (*entryCPU != mcpu)
+      continue;
+    KeyTy key = {op->str(), shape[0], shape[1], shape[2]};
+    if (sizes.regTile[0])
+      tileDB->entries[key] = sizes;
+    if (backend || *op == "Conv")
+      tileDB->backends[key] = useBLAS;
+  }
+  LLVM_DEBUG(dbgs() << "loaded " << tileDB->entries.size()
+                    << " tuned matmul tile sizes for cpu '" << mcpu << "'\n");
+  return tileDB;
+}
+
+const MatMulTileSizes *MatMulTileDB::lookup(
+    StringRef op, int64_t I, int64_t J, int64_t K) const {
+  auto it = entries.find({op.str(), I, J, K});
+  return it == entries.end() ? nullptr : &it->second;
+}
+
+Optional<bool> MatMulTileDB::lookupBLAS(
+    StringRef op, int64_t I, int64_t J, int64_t K) const {
+  auto it = backends.find({op.str(), I, J, K});
+  if (it == backends.end())
+    return None;
+  return it->second;
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//====------------ MatMulTiles.hpp - Tuned MatMul Tile Sizes --------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the declaration of the database of the tile sizes found
+// by autotuning the matrix multiplications of given shapes on a target CPU.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace onnx_mlir {
+
+/// Register and cache tile sizes of a matrix multiplication, in the order
+/// I, J, K. A cache tile of zero stands for the default one.
+struct MatMulTileSizes {
+  int64_t regTile[3] = {0, 0, 0};
+  int64_t cacheTile[3] = {0, 0, 0};
+};
+
+/// Tile sizes of the matrix multiplications of MatMul and Gemm ops, by shape,
+/// read from a tuning database written by utils/TuneMatMulTiles.py. The
+/// database is a JSON object whose "matmul_tiles" array has entries such as
+///   {"mcpu": "z16", "op": "Gemm", "shape": [I, J, K], "reg": [4, 16, 8],
+///    "cache": [32, 64, 256]}
+///   {"mcpu": "z16", "op": "Conv", "shape": [I, J, K], "backend": "blas"}
+/// and only the entries of the target CPU are loaded. The optional backend,
+/// "krnl" by default, records whether the generated code or the external BLAS
+/// library was faster. The shape of a Conv entry is the one of the matrix
+/// multiplication of a group of an image, namely the output channels, the
+/// output spatial size and the reduction size of the group. Entries of the
+/// "blas" backend and Conv entries have no register tiles.
+class MatMulTileDB {
+public:
+  /// Load the entries of the given target CPU, or return nullptr and set
+  /// error if the database cannot be read or has an invalid entry.
+  static std::unique_ptr<MatMulTileDB> load(
+      llvm::StringRef path, llvm::StringRef mcpu, std::string &error);
+
+  /// Return the tile sizes of the given op, namely "MatMul" or "Gemm", for
+  /// the given sizes, or nullptr if they were not tuned.
+  const MatMulTileSizes *lookup(
+      llvm::StringRef op, int64_t I, int64_t J, int64_t K) const;
+
+  /// Return the backend of the given op, namely "MatMul", "Gemm" or "Conv",
+  /// for the given sizes, that is true for the external BLAS library and
+  /// false for the generated code, or None if it was not tuned.
+  llvm::Optional<bool> lookupBLAS(
+      llvm::StringRef op, int64_t I, int64_t J, int64_t K) const;
+
+private:
+  using KeyTy = std::tuple<std::string, int64_t, int64_t, int64_t>;
+  std::map<KeyTy, MatMulTileSizes> entries;
+  std::map<KeyTy, bool> backends;
+};
+
+} // namespace onnx_mlir
@@ -0,0 +1,261 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------- BLAS.cpp - Lowering to an External BLAS ----------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the large enough Gemm, MatMul and Conv ops to calls of the
+// functions of the runtime computing them with an external BLAS library, as
+// an alternative to their lowering to Krnl loops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/MatMulTiles.hpp"
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// The patterns of the BLAS library take precedence over the ones of the
+// generated code, which lower the ops they fail to match.
+const int64_t kBLASPatternBenefit = 2;
+
+// The CBLAS functions compute with float and double values.
+bool isBLASType(Type elementType) {
+  return elementType.isF32() || elementType.isF64();
+}
+
+// Return whether the given values are memrefs of the BLAS element type of the
+// output.
+bool haveBLASType(Type elementType, ValueRange values) {
+  if (!isBLASType(elementType))
+    return false;
+  return llvm::all_of(values, [&](Value value) {
+    return value.getType().cast<MemRefType>().getElementType() == elementType;
+  });
+}
+
+// Return whether the `count` matrix multiplications of an I x K matrix by a
+// K x J matrix of an op, namely "Gemm", "MatMul" or "Conv", are computed by
+// the BLAS library. The choice of the autotuning for the target CPU is used
+// when the sizes were tuned, and the heuristic is otherwise that the BLAS
+// library is faster for at least `threshold` flops. Dynamic sizes are assumed
+// to be large.
+bool useBLAS(StringRef opName, int64_t count, int64_t I, int64_t J, int64_t K,
+    int64_t threshold, const MatMulTileDB *tileDB) {
+  bool isStaticProduct = !ShapedType::isDynamic(I) &&
+                         !ShapedType::isDynamic(J) && !ShapedType::isDynamic(K);
+  if (tileDB && isStaticProduct)
+    if (Optional<bool> tuned = tileDB->lookupBLAS(opName, I, J, K))
+      return *tuned;
+  if (!isStaticProduct || ShapedType::isDynamic(count))
+    return true;
+  return 2.0 * count * I * J * K >= threshold;
+}
+
+// Return the product of the given sizes, or ShapedType::kDynamic if one of
+// them is dynamic.
+int64_t getSizeProduct(ArrayRef<int64_t> sizes) {
+  int64_t product = 1;
+  for (int64_t size : sizes) {
+    if (ShapedType::isDynamic(size))
+      return ShapedType::kDynamic;
+    product *= size;
+  }
+  return product;
+}
+
+} // namespace
+
+struct ONNXGemmOpBLASLowering : public OpConversionPattern<ONNXGemmOp> {
+  ONNXGemmOpBLASLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      int64_t blasThreshold, const MatMulTileDB *tileDB)
+      : OpConversionPattern(typeConverter, ctx, kBLASPatternBenefit),
+        blasThreshold(blasThreshold), tileDB(tileDB) {}
+  int64_t blasThreshold;
+  const MatMulTileDB *tileDB;
+
+  LogicalResult matchAndRewrite(ONNXGemmOp gemmOp, ONNXGemmOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = gemmOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXGemmOp>(op);
+    Value A = adaptor.getA(), B = adaptor.getB(), C = adaptor.getC();
+    bool hasC = !isFromNone(C);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    Type elementType = memRefType.getElementType();
+    SmallVector<Value, 3> inputs = {A, B};
+    if (hasC)
+      inputs.emplace_back(C);
+    if (!haveBLASType(elementType, inputs))
+      return failure();
+    bool transA = adaptor.getTransA() != 0, transB = adaptor.getTransB() != 0;
+    ArrayRef<int64_t> aShape = A.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> bShape = B.getType().cast<MemRefType>().getShape();
+    if (!useBLAS("Gemm", 1, aShape[transA ? 1 : 0], bShape[transB ? 0 : 1],
+            aShape[transA ? 0 : 1], blasThreshold, tileDB))
+      return failure();
+
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>
+        create(rewriter, loc);
+    ONNXGemmOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    // C is not read by the runtime when beta is zero.
+    Type i64Type = rewriter.getI64Type(), f64Type = rewriter.getF64Type();
+    double beta = hasC ? adaptor.getBeta().convertToDouble() : 0.0;
+    SmallVector<Value, 8> callOperands = {A, B, hasC ? C : alloc,
+        create.math.constant(i64Type, transA),
+        create.math.constant(i64Type, transB),
+        create.math.constant(f64Type, adaptor.getAlpha().convertToDouble()),
+        create.math.constant(f64Type, beta)};
+    rewriter.create<KrnlCallOp>(loc, "omTensorGemm", alloc, callOperands);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+struct ONNXMatMulOpBLASLowering : public OpConversionPattern<ONNXMatMulOp> {
+  ONNXMatMulOpBLASLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      int64_t blasThreshold, const MatMulTileDB *tileDB)
+      : OpConversionPattern(typeConverter, ctx, kBLASPatternBenefit),
+        blasThreshold(blasThreshold), tileDB(tileDB) {}
+  int64_t blasThreshold;
+  const MatMulTileDB *tileDB;
+
+  LogicalResult matchAndRewrite(ONNXMatMulOp matMulOp,
+      ONNXMatMulOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = matMulOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXMatMulOp>(op);
+    Value A = adaptor.getA(), B = adaptor.getB();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    ArrayRef<int64_t> aShape = A.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> bShape = B.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> outputShape = memRefType.getShape();
+    int64_t rank = outputShape.size();
+    // The matrix vector products are left to the generated code.
+    if (!haveBLASType(memRefType.getElementType(), {A, B}) ||
+        aShape.size() < 2 || bShape.size() < 2)
+      return failure();
+    int64_t numBatches = getSizeProduct(outputShape.drop_back(2));
+    if (!useBLAS("MatMul", numBatches, outputShape[rank - 2],
+            outputShape[rank - 1], aShape.back(), blasThreshold, tileDB))
+      return failure();
+
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
+        rewriter, loc);
+    ONNXMatMulOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    SmallVector<Value, 2> callOperands = {A, B};
+    rewriter.create<KrnlCallOp>(loc, "omTensorMatMul", alloc, callOperands);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+struct ONNXConvOpBLASLowering : public OpConversionPattern<ONNXConvOp> {
+  ONNXConvOpBLASLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      int64_t blasThreshold, const MatMulTileDB *tileDB)
+      : OpConversionPattern(typeConverter, ctx, kBLASPatternBenefit),
+        blasThreshold(blasThreshold), tileDB(tileDB) {}
+  int64_t blasThreshold;
+  const MatMulTileDB *tileDB;
+
+  LogicalResult matchAndRewrite(ONNXConvOp convOp, ONNXConvOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = convOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXConvOp>(op);
+    Value X = adaptor.getX(), W = adaptor.getW(), bias = adaptor.getB();
+    bool hasBias = !isFromNone(bias);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    SmallVector<Value, 3> inputs = {X, W};
+    if (hasBias)
+      inputs.emplace_back(bias);
+    // Only the 2D convolutions are computed by the runtime.
+    if (!haveBLASType(memRefType.getElementType(), inputs) ||
+        memRefType.getRank() != 4)
+      return failure();
+    int64_t group = adaptor.getGroup();
+    ArrayRef<int64_t> xShape = X.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> wShape = W.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int64_t channelsOut = ShapedType::isDynamic(wShape[0])
+                              ? ShapedType::kDynamic
+                              : wShape[0] / group;
+    int64_t batchSize = xShape[0];
+    int64_t numImages = ShapedType::isDynamic(batchSize)
+                            ? ShapedType::kDynamic
+                            : batchSize * group;
+    if (!useBLAS("Conv", numImages, channelsOut,
+            getSizeProduct(yShape.drop_front(2)),
+            getSizeProduct(wShape.drop_front(1)), blasThreshold, tileDB))
+      return failure();
+
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>
+        create(rewriter, loc);
+    ONNXGenericPoolOpShapeHelper<ONNXConvOp> shapeHelper(
+        op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    // The bias is not read by the runtime in the absence of bias.
+    Type i64Type = rewriter.getI64Type();
+    SmallVector<Value, 12> callOperands = {X, W, hasBias ? bias : W,
+        create.math.constant(i64Type, hasBias),
+        create.math.constant(i64Type, group)};
+    for (int i = 0; i < 2; ++i)
+      callOperands.emplace_back(
+          create.math.cast(i64Type, shapeHelper.pads[i].getValue()));
+    for (int64_t stride : shapeHelper.strides)
+      callOperands.emplace_back(create.math.constant(i64Type, stride));
+    for (int64_t dilation : shapeHelper.dilations)
+      callOperands.emplace_back(create.math.constant(i64Type, dilation));
+    rewriter.create<KrnlCallOp>(loc, "omTensorConv", alloc, callOperands);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXToBLASPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx, int64_t blasThreshold,
+    const MatMulTileDB *tileDB) {
+  patterns.insert<ONNXGemmOpBLASLowering, ONNXMatMulOpBLASLowering,
+      ONNXConvOpBLASLowering>(typeConverter, ctx, blasThreshold, tileDB);
+}
+
+} // namespace onnx_mlir
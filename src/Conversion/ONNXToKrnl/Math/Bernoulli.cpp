@@ -0,0 +1,90 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------- Bernoulli.cpp - Lowering Bernoulli Op ------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX Bernoulli Operator to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+struct ONNXBernoulliOpLowering : public OpConversionPattern<ONNXBernoulliOp> {
+  ONNXBernoulliOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+  LogicalResult matchAndRewrite(ONNXBernoulliOp bernoulliOp,
+      ONNXBernoulliOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = bernoulliOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXBernoulliOp>(op);
+    Value input = adaptor.getInput();
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    Type outputElementType = outputMemRefType.getElementType();
+    int64_t rank = outputMemRefType.getRank();
+
+    // Uniform values are drawn in double precision for double probabilities,
+    // and in single precision otherwise.
+    Type inputElementType =
+        input.getType().cast<MemRefType>().getElementType();
+    Type uniformElementType = inputElementType.isF64()
+                                  ? rewriter.getF64Type()
+                                  : rewriter.getF32Type();
+
+    ONNXBernoulliOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    DimsExpr outputDims = shapeHelper.getOutputDims();
+    Value alloc = create.mem.alignedAlloc(outputMemRefType, outputDims);
+    Value uniform = create.mem.alignedAlloc(
+        MemRefType::get(outputMemRefType.getShape(), uniformElementType),
+        outputDims);
+    emitRandomUniform(rewriter, loc, uniform, 0.0, 1.0, adaptor.getSeed());
+
+    // A value is one with the probability given by the input, namely when the
+    // uniform value in [0, 1) is below it.
+    Value one = create.math.constant(outputElementType, 1);
+    Value zero = create.math.constant(outputElementType, 0);
+    ValueRange loopDef = create.krnl.defineLoops(rank);
+    SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, outputDims,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+          Value probability = create.math.cast(
+              uniformElementType, create.krnl.load(input, loopInd));
+          Value value = create.krnl.load(uniform, loopInd);
+          Value isOne = create.math.lt(value, probability);
+          create.krnl.store(
+              create.math.select(isOne, one, zero), alloc, loopInd);
+        });
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXBernoulliOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXBernoulliOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
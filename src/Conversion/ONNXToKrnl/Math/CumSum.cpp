@@ -20,69 +20,104 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
-static Value getLoopIndexByAxisAndOffset(MathBuilder &createMath,
-    SmallVectorImpl<Value> &resLoopIndex, ValueRange &baseLoopIndex,
-    SmallVectorImpl<IndexExpr> &upperBounds, Value axis, Value offset,
-    bool reverse) {
-  Type boolTy = createMath.getBuilder().getI1Type();
-  Type indexTy = createMath.getBuilder().getIndexType();
-  Value notSameAsBaseIndex = createMath.constant(boolTy, 0);
-  for (uint64_t r = 0; r < upperBounds.size(); ++r) {
-    Value iVal = baseLoopIndex[r];
-    Value rVal = createMath.constant(indexTy, r);
-    Value dimSize = upperBounds[r].getValue();
-
-    // Whether we are in the right axis.
-    Value isAxis = createMath.eq(rVal, axis);
-
-    // Whether (index - offset) (or index + offset in case of reverse) is still
-    // in the valid range or not.
-    Value iOffset, isValidOffset;
-    if (reverse) {
-      iOffset = createMath.add(iVal, offset);
-      isValidOffset = createMath.slt(iOffset, dimSize);
-    } else {
-      Value zero = createMath.constant(indexTy, 0);
-      iOffset = createMath.sub(iVal, offset);
-      isValidOffset = createMath.sge(iOffset, zero);
-    }
+// Number of rows along the axis scanned by each thread when a scan is
+// parallelized. Scans along shorter axes are sequential.
+static constexpr int64_t kCumSumBlockSize = 4096;
+
+// Return the index of the row `r` of a scan along an axis of `n` rows, where
+// the rows are numbered in the order of the scan, i.e. from the last one when
+// `reverse`.
+static IndexExpr getScanRow(IndexExpr r, IndexExpr n, bool reverse) {
+  return reverse ? n - 1 - r : r;
+}
 
-    Value ok = createMath.andi(isAxis, isValidOffset);
-    notSameAsBaseIndex = createMath.ori(ok, notSameAsBaseIndex);
+// Scan the rows [start, end) of the [outer, n, inner] views `X` and `Y` of the
+// input and output at outer index `o`, with SIMD code over the `inner`
+// contiguous values of each row. The first row gets its input row, or zeros
+// when `exclusive`. Each other row gets the previous output row plus its input
+// row, or the previous input row when `exclusive`.
+static void emitScanRows(KrnlBuilder &createKrnl, Value X, Value Y, Value o,
+    IndexExpr n, IndexExpr inner, IndexExpr start, IndexExpr end,
+    bool exclusive, bool reverse, int64_t VL) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+      createKrnl);
+  IndexExprScope scope(createKrnl);
+  SymbolIndexExpr startIE(start), endIE(end);
+  Type elementType = Y.getType().cast<MemRefType>().getElementType();
+  Value zero = create.math.constant(elementType, 0);
+  Value vecZero = nullptr;
+  if (VL > 1)
+    vecZero = create.vec.splat(VectorType::get({VL}, elementType), zero);
 
-    Value accessIndex = createMath.select(ok, iOffset, iVal);
-    resLoopIndex.emplace_back(accessIndex);
-  }
-  return notSameAsBaseIndex;
+  // First row, if any.
+  ValueRange firstLoopDef = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(firstLoopDef, firstLoopDef, {startIE},
+      {IndexExpr::min(startIE + 1, endIE)},
+      [&](KrnlBuilder &ck, ValueRange loopInd) {
+        IndexExprScope rowScope(ck);
+        SymbolIndexExpr nIE(n), innerIE(inner);
+        DimIndexExpr r(loopInd[0]);
+        Value row = getScanRow(r, nIE, reverse).getValue();
+        emitSimdLoopWithScalarTail(ck, innerIE, VL, elementType,
+            [&](KrnlBuilder &ck, Type type, Value k) {
+              Value y;
+              if (exclusive)
+                y = type.isa<VectorType>() ? vecZero : zero;
+              else
+                y = loadScalarOrVector(ck, type, X, {o, row, k});
+              storeScalarOrVector(ck, y, Y, {o, row, k});
+            });
+      });
+
+  // Other rows, accumulated onto the previous ones.
+  ValueRange loopDef = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(loopDef, loopDef, {startIE + 1}, {endIE},
+      [&](KrnlBuilder &ck, ValueRange loopInd) {
+        IndexExprScope rowScope(ck);
+        SymbolIndexExpr nIE(n), innerIE(inner);
+        DimIndexExpr r(loopInd[0]);
+        Value row = getScanRow(r, nIE, reverse).getValue();
+        Value prevRow = getScanRow(r - 1, nIE, reverse).getValue();
+        Value srcRow = exclusive ? prevRow : row;
+        emitSimdLoopWithScalarTail(ck, innerIE, VL, elementType,
+            [&](KrnlBuilder &ck, Type type, Value k) {
+              MultiDialectBuilder<MathBuilder> create(ck);
+              Value prev = loadScalarOrVector(ck, type, Y, {o, prevRow, k});
+              Value x = loadScalarOrVector(ck, type, X, {o, srcRow, k});
+              storeScalarOrVector(ck, create.math.add(prev, x), Y, {o, row, k});
+            });
+      });
 }
 
 struct ONNXCumSumOpLowering : public OpConversionPattern<ONNXCumSumOp> {
-  ONNXCumSumOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXCumSumOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD),
+        enableParallel(enableParallel) {}
+
+  bool enableSIMD;
+  bool enableParallel;
 
-  /// We use a parallel algorithm for cumsum [1] as follows:
-  /// Assume that input is x whose shape in [n,m], and axis for cumsum is 0.
-  /// We double-buffer the output to avoid intermediate result being overwritten
-  /// by multiple threads.
+  /// The input and output are viewed as [outer, n, inner] memrefs, where n is
+  /// the size of the axis, so that the scan is over n rows of inner contiguous
+  /// values, each computed with SIMD code. For each outer index:
   /// ```
-  /// buf = x
-  /// for step in range(log2(n)):
-  ///   for i in range(n):
-  ///     for k in range(m):
-  ///       if i >= 2^step:
-  ///         y[i,k] = buf[i - 2^step,k] + buf[i,k]
-  ///       else:
-  ///         y[i,k] = buf[i,k]
-  ///   buf = y
+  /// y[0,:] = x[0,:]
+  /// for i in range(1, n):
+  ///   y[i,:] = y[i-1,:] + x[i,:]
   /// ```
+  /// which streams once through the input and output.
   ///
-  /// Blelloch algorithm [2] is more work-efficient. However, it is not
-  /// affine-friendly, because the inner bounds depend on the outer bounds.
-  ///
-  /// [1] Hillis, W. Daniel, and Guy L. Steele, Jr. 1986. "Data Parallel
-  /// Algorithms." Communications of the ACM 29(12), pp. 1170–1183.
+  /// Long axes are scanned in parallel in three steps. The rows are split in
+  /// blocks of kCumSumBlockSize rows, which are first scanned locally, one
+  /// block per thread. The carry of each block, namely the sum of the rows of
+  /// the previous blocks, is then computed from the last rows of the local
+  /// scans in one sequential pass over the blocks. Finally, the carries are
+  /// added to the rows of their blocks, again one block per thread. This is
+  /// the blocked variant of the work-efficient scan of Blelloch [1], whose
+  /// memory traffic is linear in the size of the input.
   ///
-  /// [2] Blelloch, Guy E. 1990. "Prefix Sums and Their Applications." Technical
+  /// [1] Blelloch, Guy E. 1990. "Prefix Sums and Their Applications." Technical
   /// Report CMU-CS-90-190, School of Computer Science, Carnegie Mellon
   /// University.
   LogicalResult matchAndRewrite(ONNXCumSumOp csOp, ONNXCumSumOpAdaptor adaptor,
@@ -94,7 +129,7 @@ struct ONNXCumSumOpLowering : public OpConversionPattern<ONNXCumSumOp> {
     IndexExprScope mainScope(&rewriter, loc);
 
     MultiDialectBuilder<KrnlBuilder, MathBuilder, IndexExprBuilderForKrnl,
-        MemRefBuilder>
+        MemRefBuilder, SCFBuilder, VectorBuilder>
         create(rewriter, loc);
 
     // Convert the output type to MemRefType.
@@ -105,14 +140,13 @@ struct ONNXCumSumOpLowering : public OpConversionPattern<ONNXCumSumOp> {
 
     // Common information.
     Type elementType = memRefType.getElementType();
-    Type i64Ty = rewriter.getI64Type();
-    Type f32Ty = rewriter.getF32Type();
-    Type indexTy = rewriter.getIndexType();
 
     Value X = adaptor.getX();
     Value axis = adaptor.getAxis();
     bool exclusive = csOp.getExclusive() == 1;
     bool reverse = csOp.getReverse() == 1;
+    if (hasNonIdentityLayout(X))
+      return op->emitError("input with a non-identity layout not supported");
 
     DimsExpr xDims;
     uint64_t rank = create.krnlIE.getShapedTypeRank(X);
@@ -127,124 +161,192 @@ struct ONNXCumSumOpLowering : public OpConversionPattern<ONNXCumSumOp> {
 
     // Insert an allocation and deallocation for the result of this operation.
     Value resMemRef = create.mem.alignedAlloc(X, memRefType);
-    Value bufMemRef = create.mem.alignedAlloc(X, memRefType);
 
-    // Get the size of dimension 'axis'.
-    IndexExpr axisSize = LiteralIndexExpr(-1);
-    for (uint64_t i = 0; i < rank; ++i)
+    // Get the sizes of the views: the product of the dimensions before the
+    // axis, the size of the axis, and the product of the dimensions after it.
+    IndexExpr outer = LiteralIndexExpr(1);
+    IndexExpr axisSize = LiteralIndexExpr(1);
+    IndexExpr inner = LiteralIndexExpr(1);
+    for (uint64_t i = 0; i < rank; ++i) {
+      outer = IndexExpr::select(axisIE > i, outer * xDims[i], outer);
       axisSize = IndexExpr::select(axisIE == i, xDims[i], axisSize);
+      inner = IndexExpr::select(axisIE < i, inner * xDims[i], inner);
+    }
+    SmallVector<IndexExpr, 3> viewDims = {outer, axisSize, inner};
+    Value XView = create.mem.reinterpretCast(X, viewDims);
+    Value YView = create.mem.reinterpretCast(resMemRef, viewDims);
 
-    // Compute log2(n), the number of steps.
-    IndexExpr numberOfStep;
-    if (axisSize.isLiteral()) {
-      int64_t n = axisSize.getLiteral();
-      int64_t logN = (int64_t)std::ceil(std::log2(n));
-      numberOfStep = LiteralIndexExpr(logN);
-    } else {
-      Value nos = create.math.cast(f32Ty, axisSize.getValue());
-      // Use this when math::CeilOp is available in MLIR.
-      // nos = create.math.ceil(create.math.log2(nos));
-      nos = create.math.log2(nos);
-      nos = create.math.cast(i64Ty, nos);
-      // Use this when math::CeilOp is available in MLIR.
-      // numberOfStep = SymbolIndexExpr(nos);
-      numberOfStep = SymbolIndexExpr(nos) + LiteralIndexExpr(1);
+    // Rows that are statically shorter than a vector use scalar code.
+    int64_t VL = 1;
+    if (enableSIMD) {
+      VL = create.vec.getMachineVectorLength(elementType);
+      if (inner.isLiteral() && inner.getLiteral() < VL)
+        VL = 1;
     }
 
-    // Input and output have the same shape, so they share the bounds.
-    SmallVector<IndexExpr, 4> lbs(rank, zeroIE);
-    SmallVector<IndexExpr, 4> ubs;
-    create.krnlIE.getShapeAsDims(X, ubs);
-
-    // Initialize the temporary buffer: copy values from the input.
-    ValueRange initLoopDef = create.krnl.defineLoops(rank);
-    create.krnl.iterateIE(initLoopDef, initLoopDef, lbs, ubs,
-        [&](KrnlBuilder &ck, ValueRange initLoopInd) {
-          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
-          if (!exclusive) {
-            Value x = create.krnl.load(X, initLoopInd);
-            create.krnl.store(x, bufMemRef, initLoopInd);
-          } else {
-            // Exclusive mode is equivalent to shifting all elements right (left
-            // if reversed) and set the first element (the last element if
-            // reversed) to 0.
-            //
-            // For example, doing exclusive mode on the input:
-            //   input = [2, 3, 4]
-            // is equivalent to doing non-exclusive mode on:
-            //   new_input = [0, 2, 3]
-            // or
-            //   new_input = [3, 4, 0] if reversed.
-            Value axis = axisIE.getValue();
-
-            // Load input[i - 1,k] or get zero.
-            SmallVector<Value, 4> loopInd;
-            Value offsetOne = create.math.constant(indexTy, 1);
-            Value shiftOrSet0 = getLoopIndexByAxisAndOffset(create.math,
-                loopInd, initLoopInd, ubs, axis, offsetOne, reverse);
-            Value res = create.krnl.load(X, loopInd);
-            Value zeroVal = create.math.constant(elementType, 0);
-            res = create.math.select(shiftOrSet0, res, zeroVal);
-            create.krnl.store(res, bufMemRef, initLoopInd);
-          }
-        });
+    if (!enableParallel || !axisSize.isLiteral() ||
+        axisSize.getLiteral() < 2 * kCumSumBlockSize) {
+      ValueRange outerLoopDef = create.krnl.defineLoops(1);
+      create.krnl.iterateIE(outerLoopDef, outerLoopDef, {zeroIE}, {outer},
+          [&](KrnlBuilder &ck, ValueRange outerInd) {
+            emitScanRows(ck, XView, YView, outerInd[0], axisSize, inner,
+                zeroIE, axisSize, exclusive, reverse, VL);
+          });
+      rewriter.replaceOp(op, resMemRef);
+      return success();
+    }
 
-    // Outer loop iterates over the number of steps.
-    ValueRange stepLoopDef = create.krnl.defineLoops(1);
-    create.krnl.iterateIE(stepLoopDef, stepLoopDef, {zeroIE}, {numberOfStep},
-        [&](KrnlBuilder &ck, ValueRange stepLoopInd) {
-          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
-
-          // Compute index offset: offset = 2^step.
-          Value step = stepLoopInd[0];
-          step = create.math.cast(f32Ty, step);
-          Value offset = create.math.exp2(step);
-          offset = create.math.castToIndex(offset);
-
-          // Inner loop iterates over the output to compute sums.
-          //   for i range(n):
-          //     for k range(m):
-          //       if i >= 2^step:
-          //         y[i,k] = buf[i - 2^step,k] + buf[i,k]
-          //       else:
-          //         y[i,k] = buf[i,k]
-          ValueRange sumLoopDef = create.krnl.defineLoops(rank);
-          create.krnl.iterateIE(sumLoopDef, sumLoopDef, lbs, ubs,
-              [&](KrnlBuilder &ck, ValueRange sumLoopInd) {
-                IndexExprScope ieScope(ck);
-                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
-                Value axis = axisIE.getValue();
-                // Load buf[i,k].
-                Value b1 = create.krnl.load(bufMemRef, sumLoopInd);
-                // Load buf[i - 2^step,k].
-                SmallVector<Value, 4> loopInd;
-                Value shouldUpdate = getLoopIndexByAxisAndOffset(create.math,
-                    loopInd, sumLoopInd, ubs, axis, offset, reverse);
-                Value b2 = create.krnl.load(bufMemRef, loopInd);
-                Value zeroVal = create.math.constant(elementType, 0);
-                Value addOrZero = create.math.select(shouldUpdate, b2, zeroVal);
-                Value res = create.math.add(b1, addOrZero);
-                create.krnl.store(res, resMemRef, sumLoopInd);
-              });
+    int64_t n = axisSize.getLiteral();
+    int64_t numBlocks = llvm::divideCeil(n, kCumSumBlockSize);
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value outerVal = outer.getValue();
+    Value numBlocksVal = create.math.constantIndex(numBlocks);
+    // Emit `bodyFn` for each block in [firstBlock, numBlocks) of each outer
+    // index, one block per thread.
+    auto emitParallelBlocks = [&](Value firstBlock,
+                                  function_ref<void(KrnlBuilder &createKrnl,
+                                      Value o, Value block, IndexExpr start,
+                                      IndexExpr end)>
+                                      bodyFn) {
+      create.scf.parallelLoop({zero, firstBlock}, {outerVal, numBlocksVal},
+          {one, one}, [&](SCFBuilder &createSCF, ValueRange parInd) {
+            OpBuilder &builder = createSCF.getBuilder();
+            KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+            OpBuilder::InsertionGuard insertGuard(builder);
+            builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+            KrnlBuilder createKrnl(builder, loc);
+            IndexExprScope blockScope(createKrnl);
+            IndexExpr start = DimIndexExpr(parInd[1]) * kCumSumBlockSize;
+            IndexExpr end = IndexExpr::min(start + kCumSumBlockSize, n);
+            bodyFn(createKrnl, parInd[0], parInd[1], start, end);
+          });
+    };
 
-          // Reset the temporary buffer to the latest output.
-          // buf = y
-          ValueRange bufLoopDef = create.krnl.defineLoops(rank);
-          create.krnl.iterateIE(bufLoopDef, bufLoopDef, lbs, ubs,
-              [&](KrnlBuilder &createKrnl, ValueRange bufLoopInd) {
-                Value x = createKrnl.load(resMemRef, bufLoopInd);
-                createKrnl.store(x, bufMemRef, bufLoopInd);
+    // 1. Local scans of the blocks.
+    emitParallelBlocks(zero, [&](KrnlBuilder &ck, Value o, Value block,
+                                 IndexExpr start, IndexExpr end) {
+      emitScanRows(ck, XView, YView, o, axisSize, inner, start, end,
+          exclusive, reverse, VL);
+    });
+
+    // 2. Carries of the blocks: carry[o,0,:] = 0 and carry[o,b,:] =
+    // carry[o,b-1,:] + total of the rows of block b-1, namely its last output
+    // row plus, when exclusive, its last input row.
+    SmallVector<IndexExpr, 3> carryDims = {
+        outer, LiteralIndexExpr(numBlocks), inner};
+    SmallVector<int64_t, 3> carryShape;
+    IndexExpr::getShape(carryDims, carryShape);
+    Value carries = create.mem.alignedAlloc(
+        MemRefType::get(carryShape, elementType), carryDims);
+    ValueRange carryLoopDef = create.krnl.defineLoops(1);
+    create.krnl.iterateIE(carryLoopDef, carryLoopDef, {zeroIE}, {outer},
+        [&](KrnlBuilder &ck, ValueRange outerInd) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+              ck);
+          IndexExprScope outerScope(ck);
+          SymbolIndexExpr innerIE(inner);
+          Value o = outerInd[0];
+          Value zeroVal = create.math.constant(elementType, 0);
+          Value vecZero = nullptr;
+          if (VL > 1)
+            vecZero =
+                create.vec.splat(VectorType::get({VL}, elementType), zeroVal);
+          emitSimdLoopWithScalarTail(create.krnl, innerIE, VL, elementType,
+              [&](KrnlBuilder &ck, Type type, Value k) {
+                storeScalarOrVector(ck,
+                    type.isa<VectorType>() ? vecZero : zeroVal, carries,
+                    {o, zero, k});
+              });
+          ValueRange blockLoopDef = create.krnl.defineLoops(1);
+          create.krnl.iterateIE(blockLoopDef, blockLoopDef,
+              {LiteralIndexExpr(1)}, {LiteralIndexExpr(numBlocks)},
+              [&](KrnlBuilder &ck, ValueRange blockInd) {
+                IndexExprScope blockScope(ck);
+                SymbolIndexExpr innerIE(inner);
+                DimIndexExpr b(blockInd[0]);
+                Value prevBlock = (b - 1).getValue();
+                IndexExpr lastRowOfPrevBlock = b * kCumSumBlockSize - 1;
+                Value lastRow =
+                    getScanRow(lastRowOfPrevBlock, LiteralIndexExpr(n), reverse)
+                        .getValue();
+                emitSimdLoopWithScalarTail(ck, innerIE, VL, elementType,
+                    [&](KrnlBuilder &ck, Type type, Value k) {
+                      MultiDialectBuilder<MathBuilder> create(ck);
+                      Value carry = loadScalarOrVector(
+                          ck, type, carries, {o, prevBlock, k});
+                      Value y =
+                          loadScalarOrVector(ck, type, YView, {o, lastRow, k});
+                      carry = create.math.add(carry, y);
+                      if (exclusive) {
+                        Value x = loadScalarOrVector(
+                            ck, type, XView, {o, lastRow, k});
+                        carry = create.math.add(carry, x);
+                      }
+                      storeScalarOrVector(
+                          ck, carry, carries, {o, blockInd[0], k});
+                    });
               });
         });
 
+    // 3. Addition of the carries to the rows of their blocks. With a single
+    // value per row, the rows of a block are contiguous and are processed
+    // with SIMD code adding the splatted carry.
+    bool singleValueRows = inner.isLiteral() && inner.getLiteral() == 1;
+    int64_t rowsVL =
+        enableSIMD ? create.vec.getMachineVectorLength(elementType) : 1;
+    emitParallelBlocks(one, [&](KrnlBuilder &ck, Value o, Value block,
+                                IndexExpr start, IndexExpr end) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
+      if (singleValueRows) {
+        Value carry = create.krnl.load(carries, {o, block, zero});
+        Value vecCarry = nullptr;
+        if (rowsVL > 1)
+          vecCarry =
+              create.vec.splat(VectorType::get({rowsVL}, elementType), carry);
+        // First of the contiguous rows of the block.
+        IndexExpr first = reverse ? LiteralIndexExpr(n) - end : start;
+        Value firstVal = first.getValue();
+        emitSimdLoopWithScalarTail(create.krnl, end - start, rowsVL,
+            elementType, [&](KrnlBuilder &ck, Type type, Value i) {
+              MultiDialectBuilder<MathBuilder> create(ck);
+              Value row = create.math.add(firstVal, i);
+              Value y = loadScalarOrVector(ck, type, YView, {o, row, zero});
+              Value c = type.isa<VectorType>() ? vecCarry : carry;
+              storeScalarOrVector(ck, create.math.add(y, c), YView,
+                  {o, row, zero});
+            });
+        return;
+      }
+      ValueRange rowLoopDef = create.krnl.defineLoops(1);
+      create.krnl.iterateIE(rowLoopDef, rowLoopDef, {start}, {end},
+          [&](KrnlBuilder &ck, ValueRange rowInd) {
+            IndexExprScope rowScope(ck);
+            SymbolIndexExpr innerIE(inner);
+            DimIndexExpr r(rowInd[0]);
+            Value row = getScanRow(r, LiteralIndexExpr(n), reverse).getValue();
+            emitSimdLoopWithScalarTail(ck, innerIE, VL, elementType,
+                [&](KrnlBuilder &ck, Type type, Value k) {
+                  MultiDialectBuilder<MathBuilder> create(ck);
+                  Value carry =
+                      loadScalarOrVector(ck, type, carries, {o, block, k});
+                  Value y = loadScalarOrVector(ck, type, YView, {o, row, k});
+                  storeScalarOrVector(
+                      ck, create.math.add(y, carry), YView, {o, row, k});
+                });
+          });
+    });
+
     rewriter.replaceOp(op, resMemRef);
     return success();
   }
 };
 
 void populateLoweringONNXCumSumOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXCumSumOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
+  patterns.insert<ONNXCumSumOpLowering>(
+      typeConverter, ctx, enableSIMD, enableParallel);
 }
 
 } // namespace onnx_mlir
@@ -0,0 +1,145 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------- DFT.cpp - Lowering DFT and STFT Ops --------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX DFT and STFT operators to calls of the FFT
+// functions of the runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+// The FFT functions of the runtime compute in double precision and support
+// float and double tensors.
+static bool isSupportedFFTType(Type elementType) {
+  return elementType.isF32() || elementType.isF64();
+}
+
+struct ONNXDFTOpLowering : public OpConversionPattern<ONNXDFTOp> {
+  ONNXDFTOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+  LogicalResult matchAndRewrite(ONNXDFTOp dftOp, ONNXDFTOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = dftOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXDFTOp>(op);
+    Value input = adaptor.getInput();
+
+    // Builders.
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>
+        create(rewriter, loc);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    if (!isSupportedFFTType(memRefType.getElementType()))
+      return emitError(loc, "not implemented yet");
+
+    // Common types.
+    Type i64Type = rewriter.getI64Type();
+
+    // Op's Attributes.
+    int64_t rank = input.getType().cast<MemRefType>().getRank();
+    int64_t axis = adaptor.getAxis();
+    axis = axis < 0 ? axis + rank : axis;
+    assert(axis >= 0 && axis < rank - 1 && "axis is out of bound");
+
+    // Compute the output's dimension sizes, which include the number of bins
+    // returned by the runtime.
+    ONNXDFTOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    // Length of the DFT, which defaults to the length of the signal.
+    Value dftLength = adaptor.getDftLength();
+    IndexExpr length =
+        isFromNone(dftLength)
+            ? create.krnlIE.getShapeAsDim(input, axis)
+            : create.krnlIE.getIntFromArrayAsSymbol(dftLength, 0);
+
+    Value valAxis = create.math.constant(i64Type, axis);
+    Value valLength = create.math.cast(i64Type, length.getValue());
+    Value valInverse = create.math.constant(i64Type, adaptor.getInverse());
+    SmallVector<Value, 4> callOperands = {
+        input, valAxis, valLength, valInverse};
+    rewriter.create<KrnlCallOp>(loc, "omTensorDFT", alloc, callOperands);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+struct ONNXSTFTOpLowering : public OpConversionPattern<ONNXSTFTOp> {
+  ONNXSTFTOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+  LogicalResult matchAndRewrite(ONNXSTFTOp stftOp, ONNXSTFTOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = stftOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXSTFTOp>(op);
+    Value signal = adaptor.getSignal();
+    Value window = adaptor.getWindow();
+
+    // Builders.
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    Type elementType = memRefType.getElementType();
+    if (!isSupportedFFTType(elementType))
+      return emitError(loc, "not implemented yet");
+
+    // Compute the output's dimension sizes, which include the number of bins
+    // returned by the runtime.
+    ONNXSTFTOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    // The runtime takes the frame length from the window, so a rectangular
+    // window of frame_length ones is used in the absence of a window.
+    if (isFromNone(window)) {
+      DimsExpr windowDims;
+      windowDims.emplace_back(
+          create.krnlIE.getIntFromArrayAsSymbol(adaptor.getFrameLength(), 0));
+      window = create.mem.alignedAlloc(
+          MemRefType::get({ShapedType::kDynamic}, elementType), windowDims);
+      create.krnl.memset(window, create.math.constant(elementType, 1.0));
+    }
+
+    IndexExpr step =
+        create.krnlIE.getIntFromArrayAsSymbol(adaptor.getFrameStep(), 0);
+    Value valStep = create.math.cast(rewriter.getI64Type(), step.getValue());
+    SmallVector<Value, 4> callOperands = {signal, window, valStep};
+    rewriter.create<KrnlCallOp>(loc, "omTensorSTFT", alloc, callOperands);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXDFTOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXDFTOpLowering, ONNXSTFTOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -12,6 +12,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/TypeSwitch.h"
+
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
 #include "src/Dialect/Krnl/DialectBuilder.hpp"
 #include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
@@ -250,7 +252,7 @@ template <>
 struct ScalarOp<ONNXCastOp> {
   using FOp = CustomScalarOp;
   using IOp = CustomScalarOp;
-  using SimdEnabled = NoSimdScalarOp; // TODO: can it be simdized?
+  using SimdEnabled = SimdScalarOp;
 };
 
 template <>
@@ -260,9 +262,30 @@ Value emitScalarOpFor<ONNXCastOp>(ConversionPatternRewriter &rewriter,
 
   // TODO: currently don't support String to * or * to String
   MultiDialectBuilder<MathBuilder> create(rewriter, loc);
+  // Vector casts convert the vectors of the operand type.
   return create.math.cast(elementType, scalarOperands[0]);
 }
 
+// Return true if the element types of the input and output of a unary op can
+// be loaded and stored as vectors. Only matters for the ops changing types.
+template <typename Op>
+static bool hasSimdElementTypes(Value /*input*/, Type /*outputElementType*/) {
+  return true;
+}
+
+// Casts are simdized for integer and float types, e.g. u8 to f32 for images
+// or f32 to f16. Vectors of i1 are packed in memory unlike memrefs of i1, and
+// strings have no vector form.
+template <>
+bool hasSimdElementTypes<ONNXCastOp>(Value input, Type outputElementType) {
+  auto isSimdType = [](Type type) {
+    return (type.isa<FloatType>() || type.isa<IntegerType>()) &&
+           !type.isInteger(1);
+  };
+  return isSimdType(getElementType(input.getType())) &&
+         isSimdType(outputElementType);
+}
+
 //===----------------------------------------------------------------------===//
 // Scalar unary ops for lowering ONNXSinhOp
 //===----------------------------------------------------------------------===//
@@ -943,28 +966,351 @@ Value emitScalarOpFor<ONNXRoundOp>(ConversionPatternRewriter &rewriter,
   return create.math.select(rEqualHalf, y2, y1);
 }
 
+using MDBuilder = MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder,
+    MemRefBuilder, VectorBuilder>;
+
 //===----------------------------------------------------------------------===//
-// SIMD code gen for kernels where data can be fully flattened.
+// Parallel code gen for elementwise kernels.
 //===----------------------------------------------------------------------===//
 
-using MDBuilder = MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder,
-    MemRefBuilder, VectorBuilder>;
+// Number of chunks a flattened SIMD loop is split into when its output has
+// exactly `parallelThreshold` elements. Larger outputs get more chunks of the
+// same size.
+static constexpr int64_t kParallelChunksAtThreshold = 8;
+
+// Return true when the output is large enough to pay for the fork/join of a
+// parallel loop. Dynamic dimensions are counted as 1, so that the number of
+// elements used in the decision is a lower bound of the actual one.
+static bool isParallelProfitable(MemRefType outputMemRefType,
+    bool enableParallel, int64_t parallelThreshold) {
+  if (!enableParallel || outputMemRefType.getRank() == 0)
+    return false;
+  int64_t numElements = 1;
+  for (int64_t d : outputMemRefType.getShape())
+    if (!ShapedType::isDynamic(d))
+      numElements *= d;
+  return numElements >= parallelThreshold;
+}
+
+// Emit a loop nest over all the elements of a memref shaped as `shapedVal`
+// and call `bodyFn` with the indices of the current element. When `parallel`
+// is set, the outermost dimension that is not a static 1 is distributed with
+// an scf.parallel, and the remaining loops are emitted inside a krnl.region so
+// that the parallel induction variable is a valid affine symbol for the Krnl
+// loops.
+static void emitElementwiseLoops(ConversionPatternRewriter &rewriter,
+    Location loc, Value shapedVal, bool parallel,
+    function_ref<void(KrnlBuilder &createKrnl, ValueRange loopInd)> bodyFn) {
+  MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder, MathBuilder,
+      MemRefBuilder, SCFBuilder>
+      create(rewriter, loc);
+  MemRefType memRefType = shapedVal.getType().cast<MemRefType>();
+  int64_t rank = memRefType.getRank();
+  if (!parallel) {
+    ValueRange loopDef = create.krnl.defineLoops(rank);
+    SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs;
+    create.krnlIE.getShapeAsDims(shapedVal, ubs);
+    create.krnl.iterateIE(loopDef, loopDef, lbs, ubs, bodyFn);
+    return;
+  }
+  // Skip the leading unit dimensions, e.g. the batch of 1 of vision models.
+  ArrayRef<int64_t> shape = memRefType.getShape();
+  int64_t parDim = 0;
+  while (parDim < rank - 1 && shape[parDim] == 1)
+    ++parDim;
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  SmallVector<Value, 4> lbs(rank, zero);
+  SmallVector<Value, 4> ubs;
+  for (int64_t d = 0; d < rank; ++d)
+    ubs.emplace_back(create.mem.dim(shapedVal, d));
+  create.scf.parallelLoop({zero}, {ubs[parDim]}, {one},
+      [&](SCFBuilder &createSCF, ValueRange parInd) {
+        OpBuilder &builder = createSCF.getBuilder();
+        KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+        OpBuilder::InsertionGuard insertGuard(builder);
+        builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+        lbs[parDim] = parInd[0];
+        ubs[parDim] = create.math.add(parInd[0], one);
+        ValueRange loopDef = create.krnl.defineLoops(rank);
+        create.krnl.iterate(loopDef, loopDef, lbs, ubs, bodyFn);
+      });
+}
+
+// Emit a flattened loop over `totSize` elements blocked by VL, and call
+// `bodyFn` with the index of the first element of each block. The last block,
+// when partial, is called with the mask of its valid elements, and a null
+// mask otherwise. When `parallel` is set, the loop is split in chunks that are
+// multiples of VL and distributed with an scf.parallel.
+static void emitFlattenedSimdLoop(ConversionPatternRewriter &rewriter,
+    Location loc, IndexExpr totSize, int64_t VL, bool parallel,
+    int64_t parallelThreshold,
+    function_ref<void(KrnlBuilder &createKrnl, ValueRange loopInd, Value mask)>
+        bodyFn) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder> create(
+      rewriter, loc);
+  if (!parallel) {
+    emitSimdLoopWithMaskedTail(create.krnl, totSize, VL,
+        [&](KrnlBuilder &ck, Value index, Value mask) {
+          bodyFn(ck, {index}, mask);
+        });
+    return;
+  }
+  Value zero = create.math.constantIndex(0);
+  Value totSizeVal = totSize.getValue();
+  int64_t chunk = llvm::alignTo(
+      std::max(parallelThreshold / kParallelChunksAtThreshold, VL), VL);
+  Value chunkVal = create.math.constantIndex(chunk);
+  create.scf.parallelLoop({zero}, {totSizeVal}, {chunkVal},
+      [&](SCFBuilder &createSCF, ValueRange parInd) {
+        OpBuilder &builder = createSCF.getBuilder();
+        KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+        OpBuilder::InsertionGuard insertGuard(builder);
+        builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+        Value ub =
+            create.math.min(create.math.add(parInd[0], chunkVal), totSizeVal);
+        // Only the last chunk may end with a partial block.
+        IndexExprScope chunkScope(create.krnl);
+        DimIndexExpr chunkSize(create.math.sub(ub, parInd[0]));
+        emitSimdLoopWithMaskedTail(create.krnl, chunkSize, VL,
+            [&](KrnlBuilder &ck, Value index, Value mask) {
+              MathBuilder createMath(ck);
+              bodyFn(ck, {createMath.add(parInd[0], index)}, mask);
+            });
+      });
+}
+
+//===----------------------------------------------------------------------===//
+// Fusion of chains of elementwise ops.
+//===----------------------------------------------------------------------===//
+
+// Elementwise ops that can be fused into the loop nest of a preceding
+// elementwise op. Each computes one output element from one element of each
+// of its (at most two) operands.
+template <typename... Ops>
+struct FusibleElementwiseOps {
+  static bool isFusible(Operation *op) { return isa<Ops...>(op); }
+
+  static bool isSimdizable(Operation *op) {
+    return TypeSwitch<Operation *, bool>(op)
+        .template Case<Ops...>([](auto fusedOp) {
+          return SimdizableOp<decltype(fusedOp)>::value;
+        })
+        .Default([](Operation *) { return false; });
+  }
+
+  static Value emitScalarOp(ConversionPatternRewriter &rewriter, Location loc,
+      Operation *op, Type elementType, ArrayRef<Value> scalarOperands) {
+    return TypeSwitch<Operation *, Value>(op)
+        .template Case<Ops...>([&](auto fusedOp) {
+          return emitScalarOpFor<decltype(fusedOp)>(
+              rewriter, loc, op, elementType, scalarOperands);
+        })
+        .Default([](Operation *) -> Value {
+          llvm_unreachable("unsupported fused op");
+        });
+  }
+};
+
+// Ops with a type change (e.g. Cast, Less) or a post-processing step (Mean)
+// are not listed.
+using FusibleOps = FusibleElementwiseOps<ONNXAbsOp, ONNXAcosOp, ONNXAcoshOp,
+    ONNXAddOp, ONNXAndOp, ONNXAsinOp, ONNXAsinhOp, ONNXAtanOp, ONNXAtanhOp,
+    ONNXCeilOp, ONNXCosOp, ONNXCoshOp, ONNXDivOp, ONNXEluOp, ONNXErfOp,
+    ONNXExpOp, ONNXFloorOp, ONNXHardSigmoidOp, ONNXLeakyReluOp, ONNXLogOp,
+    ONNXMaxOp, ONNXMinOp, ONNXModOp, ONNXMulOp, ONNXNegOp, ONNXOrOp, ONNXPowOp,
+    ONNXReciprocalOp, ONNXReluOp, ONNXRoundOp, ONNXSeluOp, ONNXSigmoidOp,
+    ONNXSignOp, ONNXSinOp, ONNXSinhOp, ONNXSoftplusOp, ONNXSoftsignOp,
+    ONNXSqrtOp, ONNXSubOp, ONNXSumOp, ONNXTanOp, ONNXTanhOp, ONNXXorOp>;
+
+// Helper to fuse a chain of elementwise ops into the loop nest of the op being
+// lowered (the root). Each op of the chain is the single user of the previous
+// one and has the same output type as the root. Its other operand, if any, is
+// available before the root and is either of the output shape or broadcast to
+// it. The intermediate results of the chain thus stay in registers instead of
+// being stored into memrefs.
+class ElementwiseFusionHelper {
+public:
+  ElementwiseFusionHelper(ConversionPatternRewriter &rewriter,
+      TypeConverter *typeConverter, Operation *root,
+      MemRefType outputMemRefType, bool enableFusion, bool isSIMD)
+      : root(root), outputMemRefType(outputMemRefType), isSIMD(isSIMD) {
+    if (!enableFusion || !outputMemRefType.hasStaticShape())
+      return;
+    Operation *current = root;
+    while (current->getNumResults() == 1 &&
+           current->getResult(0).hasOneUse()) {
+      Value chainVal = current->getResult(0);
+      Operation *user = *chainVal.getUsers().begin();
+      if (!FusibleOps::isFusible(user) ||
+          user->getBlock() != root->getBlock() || user->getNumOperands() > 2)
+        break;
+      if (isSIMD && !FusibleOps::isSimdizable(user))
+        break;
+      if (typeConverter->convertType(user->getResult(0).getType()) !=
+          outputMemRefType)
+        break;
+      Value other;
+      unsigned chainIndex = 0;
+      if (user->getNumOperands() == 2) {
+        chainIndex = (user->getOperand(0) == chainVal) ? 0 : 1;
+        Value otherOperand = user->getOperand(1 - chainIndex);
+        if (otherOperand == chainVal || !isAvailableBeforeRoot(otherOperand))
+          break;
+        other = rewriter.getRemappedValue(otherOperand);
+        if (!other || !isFusibleOtherOperand(other))
+          break;
+      }
+      fusedOps.emplace_back(user);
+      otherOperands.emplace_back(other);
+      chainIndices.emplace_back(chainIndex);
+      current = user;
+    }
+  }
+
+  // Flatten the other operands that are not scalars, to be accessed with the
+  // index of the flattened SIMD loop.
+  void flattenOtherOperands(MDBuilder &create) {
+    for (Value &other : otherOperands) {
+      if (!other || other.getType().cast<MemRefType>().getNumElements() == 1)
+        continue;
+      SmallVector<IndexExpr, 4> otherDims;
+      Value otherSize;
+      create.krnlIE.getShapeAsSymbols(other, otherDims);
+      other = create.mem.reshapeToFlat(other, otherDims, otherSize);
+    }
+  }
+
+  // Apply the fused ops to `rootResult`, the scalar (or vector, in SIMD mode)
+  // result of the root for the output element(s) at `loopInd`. In SIMD mode,
+  // `mask`, if any, selects the valid elements of a partial vector.
+  Value emitFusedOps(ConversionPatternRewriter &rewriter,
+      KrnlBuilder &createKrnl, Type elementType, Value rootResult,
+      ValueRange loopInd, Value mask = nullptr) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+        createKrnl);
+    Value result = rootResult;
+    for (size_t i = 0; i < fusedOps.size(); ++i) {
+      Value other = otherOperands[i];
+      if (!other) {
+        result = FusibleOps::emitScalarOp(
+            rewriter, create.getLoc(), fusedOps[i], elementType, {result});
+        continue;
+      }
+      MemRefType otherType = other.getType().cast<MemRefType>();
+      Value zero = create.math.constantIndex(0);
+      Value otherVal;
+      if (isSIMD && otherType.getNumElements() == 1) {
+        SmallVector<Value, 4> zeros(otherType.getRank(), zero);
+        otherVal = create.vec.splat(
+            elementType.cast<VectorType>(), create.krnl.load(other, zeros));
+      } else if (isSIMD) {
+        otherVal = loadScalarOrVector(create.krnl, elementType, other,
+            loopInd, mask,
+            create.math.constant(otherType.getElementType(), 1));
+      } else {
+        // Broadcast the other operand along its dimensions of size 1.
+        ArrayRef<int64_t> outputShape = outputMemRefType.getShape();
+        ArrayRef<int64_t> otherShape = otherType.getShape();
+        int64_t offset = outputShape.size() - otherShape.size();
+        SmallVector<Value, 4> otherInd;
+        for (int64_t d = 0; d < (int64_t)otherShape.size(); ++d)
+          otherInd.emplace_back(
+              (otherShape[d] == 1 && outputShape[offset + d] != 1)
+                  ? zero
+                  : loopInd[offset + d]);
+        otherVal = create.krnl.load(other, otherInd);
+      }
+      SmallVector<Value, 2> scalarOperands(2, otherVal);
+      scalarOperands[chainIndices[i]] = result;
+      result = FusibleOps::emitScalarOp(
+          rewriter, create.getLoc(), fusedOps[i], elementType, scalarOperands);
+    }
+    return result;
+  }
+
+  // Replace the last op of the chain by `alloc` and erase the other ops of the
+  // chain, including the root.
+  void replaceOrEraseONNXOps(
+      ConversionPatternRewriter &rewriter, Value alloc) const {
+    if (fusedOps.empty()) {
+      rewriter.replaceOp(root, alloc);
+      return;
+    }
+    rewriter.replaceOp(fusedOps.back(), alloc);
+    for (int64_t i = (int64_t)fusedOps.size() - 2; i >= 0; --i)
+      rewriter.eraseOp(fusedOps[i]);
+    rewriter.eraseOp(root);
+  }
+
+private:
+  // The other operand is used by an op located after the root in the same
+  // block, so it dominates the root unless it is defined in that block after
+  // the root.
+  bool isAvailableBeforeRoot(Value val) const {
+    Operation *defOp = val.getDefiningOp();
+    return !defOp || defOp->getBlock() != root->getBlock() ||
+           defOp->isBeforeInBlock(root);
+  }
+
+  bool isFusibleOtherOperand(Value other) const {
+    MemRefType otherType = other.getType().dyn_cast<MemRefType>();
+    if (!otherType || !otherType.hasStaticShape() ||
+        !otherType.getLayout().isIdentity() ||
+        otherType.getElementType() != outputMemRefType.getElementType())
+      return false;
+    ArrayRef<int64_t> outputShape = outputMemRefType.getShape();
+    ArrayRef<int64_t> otherShape = otherType.getShape();
+    if (otherType.getNumElements() == 1)
+      return otherShape.size() <= outputShape.size();
+    // The flattened SIMD loop can only access operands of the output shape.
+    if (isSIMD)
+      return otherShape == outputShape;
+    if (otherShape.size() > outputShape.size())
+      return false;
+    int64_t offset = outputShape.size() - otherShape.size();
+    for (int64_t d = 0; d < (int64_t)otherShape.size(); ++d)
+      if (otherShape[d] != 1 && otherShape[d] != outputShape[offset + d])
+        return false;
+    return true;
+  }
+
+  Operation *root;
+  MemRefType outputMemRefType;
+  bool isSIMD;
+  // Fused ops, in the order of the chain, with their other operand (null for
+  // unary ops) and the operand index of the value coming from the chain.
+  SmallVector<Operation *, 4> fusedOps;
+  SmallVector<Value, 4> otherOperands;
+  SmallVector<unsigned, 4> chainIndices;
+};
+
+//===----------------------------------------------------------------------===//
+// SIMD code gen for kernels where data can be fully flattened.
+//===----------------------------------------------------------------------===//
 
 //
 template <typename ElementwiseUnaryOp>
 static LogicalResult getUnaryBinarySimdCodeFullyFlattened(
     ConversionPatternRewriter &rewriter, MDBuilder &create,
     ONNXOpShapeHelper *shapeHelper, Operation *op, MemRefType outputMemRefType,
-    ValueRange operands, int64_t alignment, int64_t simdUnroll) {
+    ValueRange operands, int64_t alignment, int64_t simdUnroll, bool parallel,
+    int64_t parallelThreshold, ElementwiseFusionHelper &fusion,
+    Value alloc = nullptr) {
   Type outputElementType = outputMemRefType.getElementType();
 
   // generate SIMD code of VL elements per vector.
   IndexExprScope allocScope(create.vec, shapeHelper->getScope());
   int64_t VL =
       create.vec.getMachineVectorLength(outputElementType) * simdUnroll;
-  // Alloc memory with padding for SIMD.
-  Value alloc = create.mem.alignedAllocWithSimdPadding(
-      outputMemRefType, shapeHelper->getOutputDims(), simdUnroll, alignment);
+  // Alloc memory, unless given a buffer to write to. The last partial vector
+  // is stored with a mask, so no padding is needed.
+  if (!alloc)
+    alloc = create.mem.alignedAlloc(
+        outputMemRefType, shapeHelper->getOutputDims(), alignment);
   // Create flat inputs.
   llvm::SmallVector<Value, 4> flatOperands;
   for (Value oper : operands) {
@@ -974,37 +1320,45 @@ static LogicalResult getUnaryBinarySimdCodeFullyFlattened(
     Value flatOper = create.mem.reshapeToFlat(oper, operDims, operSize);
     flatOperands.emplace_back(flatOper);
   }
+  fusion.flattenOtherOperands(create);
   // Create flat output.
   Value totOutputSize;
   Value flatAlloc = create.mem.reshapeToFlat(
       alloc, shapeHelper->getOutputDims(), totOutputSize);
   IndexExpr totSize = DimIndexExpr(totOutputSize);
-  // Create loop iteration (flattened to one dim) and blocked by mVL.
-  ValueRange loopDef = create.krnl.defineLoops(1);
-  ValueRange blockedLoopDef = create.krnl.block(loopDef[0], VL);
-  SmallVector<IndexExpr, 1> lbs(1, LiteralIndexExpr(0));
-  SmallVector<IndexExpr, 1> ubs(1, totSize);
+  bool nontemporal = useNontemporalStores(outputMemRefType);
   // Create the vector type to operate over.
   VectorType vecElementType = VectorType::get({VL}, outputElementType);
-  // Iterate only over the blocks.
-  create.krnl.iterateIE(loopDef, {blockedLoopDef[0]}, lbs, ubs,
-      [&](KrnlBuilder &ck, ValueRange loopInd) {
-        MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(ck);
+  // Create loop iteration (flattened to one dim) and blocked by mVL. Iterate
+  // only over the blocks.
+  emitFlattenedSimdLoop(rewriter, create.getLoc(), totSize, VL, parallel,
+      parallelThreshold, [&](KrnlBuilder &ck, ValueRange loopInd, Value mask) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
         llvm::SmallVector<Value, 4> loadedVals;
         for (Value flatOper : flatOperands) {
           MemRefType memRefType = flatOper.getType().dyn_cast<MemRefType>();
           assert(memRefType && "expected memref");
           VectorType vecType =
               VectorType::get({VL}, memRefType.getElementType());
-          Value loadedVal = create.vec.load(vecType, flatOper, loopInd);
+          // The masked off elements are ones, valid operands of all ops.
+          Value loadedVal = loadScalarOrVector(ck, vecType, flatOper, loopInd,
+              mask, create.math.constant(memRefType.getElementType(), 1));
           loadedVals.emplace_back(loadedVal);
         }
         Value loweredOpResult = emitScalarOpFor<ElementwiseUnaryOp>(
             rewriter, create.getLoc(), op, vecElementType, loadedVals);
-        // Store result in the resulting array.
-        create.vec.store(loweredOpResult, flatAlloc, loopInd);
+        loweredOpResult = fusion.emitFusedOps(
+            rewriter, ck, vecElementType, loweredOpResult, loopInd, mask);
+        // Store result in the resulting array, bypassing the caches when
+        // it is too large to be read from them.
+        if (mask)
+          create.vec.maskedStore(loweredOpResult, flatAlloc, loopInd, mask);
+        else if (nontemporal)
+          create.vec.storeNontemporal(loweredOpResult, flatAlloc, loopInd);
+        else
+          create.vec.store(loweredOpResult, flatAlloc, loopInd);
       });
-  rewriter.replaceOp(op, alloc);
+  fusion.replaceOrEraseONNXOps(rewriter, alloc);
   return success();
 }
 
@@ -1012,7 +1366,8 @@ template <typename ElementwiseVariadicOp>
 static LogicalResult getVariadicSimdCodeFullyFlattened(
     ConversionPatternRewriter &rewriter, MDBuilder &create,
     ONNXOpShapeHelper *shapeHelper, Operation *op, MemRefType outputMemRefType,
-    ValueRange operands, int64_t alignment, int64_t simdUnroll) {
+    ValueRange operands, int64_t alignment, int64_t simdUnroll, bool parallel,
+    int64_t parallelThreshold, ElementwiseFusionHelper &fusion) {
   Type outputElementType = outputMemRefType.getElementType();
   unsigned numArgs = op->getNumOperands();
 
@@ -1020,9 +1375,10 @@ static LogicalResult getVariadicSimdCodeFullyFlattened(
   IndexExprScope allocScope(create.vec, shapeHelper->getScope());
   int64_t VL =
       create.vec.getMachineVectorLength(outputElementType) * simdUnroll;
-  // Alloc memory with padding for SIMD.
-  Value alloc = create.mem.alignedAllocWithSimdPadding(
-      outputMemRefType, shapeHelper->getOutputDims(), simdUnroll, alignment);
+  // Alloc memory. The last partial vector is stored with a mask, so no padding
+  // is needed.
+  Value alloc = create.mem.alignedAlloc(
+      outputMemRefType, shapeHelper->getOutputDims(), alignment);
   // Create flat inputs.
   llvm::SmallVector<Value, 4> flatOperands;
   for (Value oper : operands) {
@@ -1032,22 +1388,20 @@ static LogicalResult getVariadicSimdCodeFullyFlattened(
     Value flatOper = create.mem.reshapeToFlat(oper, operDims, operSize);
     flatOperands.emplace_back(flatOper);
   }
+  fusion.flattenOtherOperands(create);
   // Create flat output.
   Value totOutputSize;
   Value flatAlloc = create.mem.reshapeToFlat(
       alloc, shapeHelper->getOutputDims(), totOutputSize);
   IndexExpr totSize = DimIndexExpr(totOutputSize);
-  // Create loop iteration (flattened to one dim) and blocked by mVL.
-  ValueRange loopDef = create.krnl.defineLoops(1);
-  ValueRange blockedLoopDef = create.krnl.block(loopDef[0], VL);
-  SmallVector<IndexExpr, 1> lbs(1, LiteralIndexExpr(0));
-  SmallVector<IndexExpr, 1> ubs(1, totSize);
+  bool nontemporal = useNontemporalStores(outputMemRefType);
   // Create the vector type to operate over.
   VectorType vecElementType = VectorType::get({VL}, outputElementType);
-  // Iterate only over the blocks.
-  create.krnl.iterateIE(loopDef, {blockedLoopDef[0]}, lbs, ubs,
-      [&](KrnlBuilder &ck, ValueRange loopInd) {
-        MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(ck);
+  // Create loop iteration (flattened to one dim) and blocked by mVL. Iterate
+  // only over the blocks.
+  emitFlattenedSimdLoop(rewriter, create.getLoc(), totSize, VL, parallel,
+      parallelThreshold, [&](KrnlBuilder &ck, ValueRange loopInd, Value mask) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
         llvm::SmallVector<Value, 4> loadedVals;
         // Load all the values
         for (Value flatOper : flatOperands) {
@@ -1055,7 +1409,9 @@ static LogicalResult getVariadicSimdCodeFullyFlattened(
           assert(memRefType && "expected memref");
           VectorType vecType =
               VectorType::get({VL}, memRefType.getElementType());
-          Value loadedVal = create.vec.load(vecType, flatOper, loopInd);
+          // The masked off elements are ones, valid operands of all ops.
+          Value loadedVal = loadScalarOrVector(ck, vecType, flatOper, loopInd,
+              mask, create.math.constant(memRefType.getElementType(), 1));
           loadedVals.emplace_back(loadedVal);
         }
         // Use the first operand as temporary result.
@@ -1070,13 +1426,199 @@ static LogicalResult getVariadicSimdCodeFullyFlattened(
         // Postprocessing (dummy op if none).
         Value finalResult = emitPostProcessingFor<ElementwiseVariadicOp>(
             rewriter, create.getLoc(), op, vecElementType, accumulated);
-        // Store result in the resulting array.
-        create.vec.store(finalResult, flatAlloc, loopInd);
+        finalResult = fusion.emitFusedOps(
+            rewriter, ck, vecElementType, finalResult, loopInd, mask);
+        // Store result in the resulting array, bypassing the caches when
+        // it is too large to be read from them.
+        if (mask)
+          create.vec.maskedStore(finalResult, flatAlloc, loopInd, mask);
+        else if (nontemporal)
+          create.vec.storeNontemporal(finalResult, flatAlloc, loopInd);
+        else
+          create.vec.store(finalResult, flatAlloc, loopInd);
       });
-  rewriter.replaceOp(op, alloc);
+  fusion.replaceOrEraseONNXOps(rewriter, alloc);
   return success();
 }
 
+//===----------------------------------------------------------------------===//
+// SIMD code gen for kernels with broadcasts, versioned by broadcast pattern.
+//===----------------------------------------------------------------------===//
+
+// Access pattern of an operand once the output is collapsed into an outer and
+// an inner dimension: the operand either spans both of them, or is broadcast
+// along the outer (row), inner (column), or both (scalar) dimensions.
+enum class SimdBroadcastKind { Full, Row, Column, Scalar };
+
+// Find the largest inner part of the dimensions of the static output, made of
+// whole vectors of VL elements, along which each operand is either not
+// broadcast or fully broadcast, and likewise along the outer part. Return
+// the first dimension of the inner part, or -1 if there is no such split.
+static int64_t getSimdBroadcastSplit(MemRefType outputMemRefType,
+    ValueRange operands, int64_t VL,
+    SmallVectorImpl<SimdBroadcastKind> &kinds) {
+  if (!outputMemRefType.hasStaticShape() || outputMemRefType.getRank() == 0)
+    return -1;
+  ArrayRef<int64_t> outputShape = outputMemRefType.getShape();
+  int64_t rank = outputShape.size();
+  // Operand shapes, padded with leading 1s to the output rank.
+  SmallVector<SmallVector<int64_t, 4>, 4> shapes;
+  for (Value oper : operands) {
+    MemRefType memRefType = oper.getType().cast<MemRefType>();
+    if (!memRefType.hasStaticShape() || memRefType.getRank() > rank)
+      return -1;
+    SmallVector<int64_t, 4> shape(rank - memRefType.getRank(), 1);
+    shape.append(memRefType.getShape().begin(), memRefType.getShape().end());
+    shapes.emplace_back(shape);
+  }
+  auto classify = [&](ArrayRef<int64_t> shape, int64_t lb, int64_t ub,
+                      bool &full, bool &ones) {
+    full = ones = true;
+    for (int64_t d = lb; d < ub; ++d) {
+      full &= (shape[d] == outputShape[d]);
+      ones &= (shape[d] == 1);
+    }
+  };
+  int64_t innerSize = 1;
+  for (int64_t d = 0; d < rank; ++d)
+    innerSize *= outputShape[d];
+  for (int64_t split = 0; split < rank; innerSize /= outputShape[split++]) {
+    if (innerSize % VL != 0)
+      continue;
+    kinds.clear();
+    bool hasFullInner = false;
+    for (ArrayRef<int64_t> shape : shapes) {
+      bool innerFull, innerOnes, outerFull, outerOnes;
+      classify(shape, split, rank, innerFull, innerOnes);
+      classify(shape, 0, split, outerFull, outerOnes);
+      if ((!innerFull && !innerOnes) || (!outerFull && !outerOnes))
+        break;
+      hasFullInner |= innerFull;
+      if (innerFull)
+        kinds.emplace_back(
+            outerFull ? SimdBroadcastKind::Full : SimdBroadcastKind::Row);
+      else
+        kinds.emplace_back(
+            outerFull ? SimdBroadcastKind::Column : SimdBroadcastKind::Scalar);
+    }
+    if (kinds.size() == operands.size() && hasFullInner)
+      return split;
+  }
+  return -1;
+}
+
+// Emit the SIMD loops of an elementwise op whose operands have the broadcast
+// `kinds` for the output collapsed at `split`. The version is chosen at
+// compile time, so that the inner loop only has vector loads of the operands
+// that are not broadcast along it, the other operands being splat once per
+// outer iteration (column) or before the loops (scalar). `emitComputation`
+// computes the result vector from the vectors of the operands.
+static Value emitSimdBroadcastLoops(ConversionPatternRewriter &rewriter,
+    MDBuilder &create, MemRefType outputMemRefType, ValueRange operands,
+    int64_t alignment, int64_t VL, int64_t split,
+    ArrayRef<SimdBroadcastKind> kinds, bool parallel,
+    function_ref<Value(KrnlBuilder &, ArrayRef<Value>)> emitComputation) {
+  Location loc = create.getLoc();
+  ArrayRef<int64_t> outputShape = outputMemRefType.getShape();
+  int64_t outerSize = 1, innerSize = 1;
+  for (int64_t d = 0; d < (int64_t)outputShape.size(); ++d)
+    (d < split ? outerSize : innerSize) *= outputShape[d];
+
+  // Static shapes: the output has no padding, as it is made of whole vectors.
+  SmallVector<IndexExpr, 4> outputDims;
+  for (int64_t d : outputShape)
+    outputDims.emplace_back(LiteralIndexExpr(d));
+  Value alloc = create.mem.alignedAlloc(outputMemRefType, alignment);
+  Value outputSize;
+  Value flatAlloc = create.mem.reshapeToFlat(alloc, outputDims, outputSize);
+  // Flatten the operands, and splat the scalar ones before the loops.
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> createVec(
+      create.krnl);
+  Value zero = createVec.math.constantIndex(0);
+  SmallVector<Value, 4> flatOperands, splats;
+  SmallVector<VectorType, 4> operandVecTypes;
+  for (auto operAndKind : llvm::zip(operands, kinds)) {
+    Value oper = std::get<0>(operAndKind);
+    SmallVector<IndexExpr, 4> operDims;
+    Value operSize;
+    create.krnlIE.getShapeAsSymbols(oper, operDims);
+    flatOperands.emplace_back(
+        create.mem.reshapeToFlat(oper, operDims, operSize));
+    operandVecTypes.emplace_back(VectorType::get(
+        {VL}, oper.getType().cast<MemRefType>().getElementType()));
+    Value splat;
+    if (std::get<1>(operAndKind) == SimdBroadcastKind::Scalar)
+      splat = createVec.vec.splat(operandVecTypes.back(),
+          createVec.krnl.load(flatOperands.back(), {zero}));
+    splats.emplace_back(splat);
+  }
+
+  auto emitInnerLoop = [&](KrnlBuilder &ck, Value outerInd) {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
+    // Splat the column operands, invariant along the inner loop.
+    SmallVector<Value, 4> outerSplats(splats);
+    for (unsigned i = 0; i < kinds.size(); ++i)
+      if (kinds[i] == SimdBroadcastKind::Column)
+        outerSplats[i] = create.vec.splat(operandVecTypes[i],
+            create.krnl.load(flatOperands[i], {outerInd}));
+    ValueRange loopDef = create.krnl.defineLoops(1);
+    ValueRange blockedLoopDef = create.krnl.block(loopDef[0], VL);
+    Value innerSizeVal = create.math.constantIndex(innerSize);
+    create.krnl.iterate(loopDef, {blockedLoopDef[0]}, {zero}, {innerSizeVal},
+        [&](KrnlBuilder &ck, ValueRange loopInd) {
+          MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(ck);
+          IndexExprScope innerScope(ck);
+          IndexExpr innerInd = DimIndexExpr(loopInd[0]);
+          IndexExpr fullInd =
+              DimIndexExpr(outerInd) * LiteralIndexExpr(innerSize) + innerInd;
+          SmallVector<Value, 4> loadedVals;
+          for (unsigned i = 0; i < kinds.size(); ++i) {
+            if (kinds[i] == SimdBroadcastKind::Full)
+              loadedVals.emplace_back(create.vec.load(operandVecTypes[i],
+                  flatOperands[i], {fullInd.getValue()}));
+            else if (kinds[i] == SimdBroadcastKind::Row)
+              loadedVals.emplace_back(create.vec.load(operandVecTypes[i],
+                  flatOperands[i], {innerInd.getValue()}));
+            else
+              loadedVals.emplace_back(outerSplats[i]);
+          }
+          Value result = emitComputation(ck, loadedVals);
+          create.vec.store(result, flatAlloc, {fullInd.getValue()});
+        });
+  };
+
+  // Iterate over the outer dimension, in parallel if profitable.
+  Value outerSizeVal = createVec.math.constantIndex(outerSize);
+  if (parallel && outerSize > 1) {
+    MultiDialectBuilder<MathBuilder, SCFBuilder> createSCF(rewriter, loc);
+    Value one = createSCF.math.constantIndex(1);
+    createSCF.scf.parallelLoop({zero}, {outerSizeVal}, {one},
+        [&](SCFBuilder &createSCF, ValueRange parInd) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          KrnlBuilder createKrnl(builder, loc);
+          emitInnerLoop(createKrnl, parInd[0]);
+        });
+  } else {
+    ValueRange outerLoopDef = create.krnl.defineLoops(1);
+    create.krnl.iterate(outerLoopDef, outerLoopDef, {zero}, {outerSizeVal},
+        [&](KrnlBuilder &ck, ValueRange outerInd) {
+          emitInnerLoop(ck, outerInd[0]);
+        });
+  }
+  return alloc;
+}
+
+// Return the input buffer of a unary elementwise op when the op can write its
+// result in place into it: the buffer is an alloc of the output type in the
+// block of the op, and the input is not used after the op.
+static Value getInPlaceBuffer(
+    Operation *op, Value X, MemRefType outputMemRefType) {
+  return getInPlaceOperandBuffer(op, 0, X, outputMemRefType);
+}
+
 //===----------------------------------------------------------------------===//
 // Element-wise unary ops lowering to Krnl dialect.
 //===----------------------------------------------------------------------===//
@@ -1086,11 +1628,16 @@ struct ONNXElementwiseUnaryOpLowering
     : public OpConversionPattern<ElementwiseUnaryOp> {
   using OpAdaptor = typename ElementwiseUnaryOp::Adaptor;
   bool enableSIMD = false;
+  bool enableParallel = false;
+  int64_t parallelThreshold;
+  bool enableFusion = false;
 
-  ONNXElementwiseUnaryOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+  ONNXElementwiseUnaryOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel,
+      int64_t parallelThreshold, bool enableFusion)
       : OpConversionPattern<ElementwiseUnaryOp>(typeConverter, ctx),
-        enableSIMD(enableSIMD) {}
+        enableSIMD(enableSIMD), enableParallel(enableParallel),
+        parallelThreshold(parallelThreshold), enableFusion(enableFusion) {}
 
   LogicalResult matchAndRewrite(ElementwiseUnaryOp elmsOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -1126,31 +1673,43 @@ struct ONNXElementwiseUnaryOpLowering
     shapeHelper.computeShapeAndAssertOnFailure();
 
     bool scalar = hasAllScalarValues(operands);
+    bool parallel = !scalar &&
+                    isParallelProfitable(memRefType, enableParallel,
+                        parallelThreshold);
     if constexpr (SimdizableOp<ElementwiseUnaryOp>::value) {
       // SIMD is enabled for this operation, test if desired and feasible
-      if (enableSIMD && !scalar && !hasNonIdentityLayout(operands)) {
+      if (enableSIMD && !scalar && !hasNonIdentityLayout(operands) &&
+          hasSimdElementTypes<ElementwiseUnaryOp>(X, elementType)) {
         int64_t simdUnroll = 1;
+        ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+            memRefType, enableFusion, /*isSIMD=*/true);
         return getUnaryBinarySimdCodeFullyFlattened<ElementwiseUnaryOp>(
             rewriter, create, &shapeHelper, op, memRefType, operands, alignment,
-            simdUnroll);
+            simdUnroll, parallel, parallelThreshold, fusion,
+            getInPlaceBuffer(op, X, memRefType));
       }
     }
 
-    // Insert an allocation for the result of this operation.
-    Value alloc = create.mem.alignedAlloc(
-        memRefType, shapeHelper.getOutputDims(), alignment);
+    // Insert an allocation for the result of this operation, unless it can be
+    // written in place into the input.
+    Value alloc;
+    if (!scalar)
+      alloc = getInPlaceBuffer(op, X, memRefType);
+    if (!alloc)
+      alloc = create.mem.alignedAlloc(
+          memRefType, shapeHelper.getOutputDims(), alignment);
+    ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+        memRefType, enableFusion && !scalar, /*isSIMD=*/false);
 
     // Only create krnl.iterate if one of the operands is not scalar tensor.
     if (!scalar) {
-      ValueRange loopDef = create.krnl.defineLoops(memRefType.getRank());
-      SmallVector<IndexExpr, 4> lbs(memRefType.getRank(), LiteralIndexExpr(0));
-      SmallVector<IndexExpr, 4> ubs;
-      create.krnlIE.getShapeAsDims(X, ubs);
-      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      emitElementwiseLoops(rewriter, loc, X, parallel,
           [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
             Value loadedVal = createKrnl.load(X, loopInd);
-            auto loweredOpResult = emitScalarOpFor<ElementwiseUnaryOp>(
+            Value loweredOpResult = emitScalarOpFor<ElementwiseUnaryOp>(
                 rewriter, loc, op, elementType, {loadedVal});
+            loweredOpResult = fusion.emitFusedOps(
+                rewriter, createKrnl, elementType, loweredOpResult, loopInd);
             // Store result in the resulting array.
             createKrnl.store(loweredOpResult, alloc, loopInd);
           });
@@ -1162,7 +1721,7 @@ struct ONNXElementwiseUnaryOpLowering
       create.krnl.store(loweredOpResult, alloc);
     }
 
-    rewriter.replaceOp(op, alloc);
+    fusion.replaceOrEraseONNXOps(rewriter, alloc);
     return success();
   }
 };
@@ -1178,12 +1737,19 @@ struct ONNXElementwiseBinaryOpLowering
     : public OpConversionPattern<ElementwiseBinaryOp> {
   using OpAdaptor = typename ElementwiseBinaryOp::Adaptor;
   bool enableSIMD = false;
+  bool enableParallel = false;
+  int64_t parallelThreshold;
+  bool enableFusion = false;
   bool isUniBroadcasting = false;
 
   ONNXElementwiseBinaryOpLowering(TypeConverter &typeConverter,
-      MLIRContext *ctx, bool enableSIMD, bool isUniBroadcasting = false)
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel,
+      int64_t parallelThreshold, bool enableFusion,
+      bool isUniBroadcasting = false)
       : OpConversionPattern<ElementwiseBinaryOp>(typeConverter, ctx),
-        enableSIMD(enableSIMD), isUniBroadcasting(isUniBroadcasting) {}
+        enableSIMD(enableSIMD), enableParallel(enableParallel),
+        parallelThreshold(parallelThreshold), enableFusion(enableFusion),
+        isUniBroadcasting(isUniBroadcasting) {}
 
   LogicalResult matchAndRewrite(ElementwiseBinaryOp elmsOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -1200,7 +1766,6 @@ struct ONNXElementwiseBinaryOpLowering
            "Failed to convert type to MemRefType");
     MemRefType outputMemRefType = convertedType.cast<MemRefType>();
     Type outputElementType = outputMemRefType.getElementType();
-    uint64_t outputRank = outputMemRefType.getRank();
 
     // Shape helper.
     MDBuilder create(rewriter, loc);
@@ -1209,28 +1774,49 @@ struct ONNXElementwiseBinaryOpLowering
     shapeHelper.computeShapeAndAssertOnFailure();
 
     bool scalar = hasAllScalarValues(operands);
+    bool parallel = !scalar &&
+                    isParallelProfitable(outputMemRefType, enableParallel,
+                        parallelThreshold);
     if constexpr (SimdizableOp<ElementwiseBinaryOp>::value) {
       // SIMD is enabled for this operation, test if desired and feasible
       if (enableSIMD && !scalar && !hasNonIdentityLayout(operands) &&
           shapeHelper.hasNoBroadcast()) {
         int64_t simdUnroll = 1;
+        ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+            outputMemRefType, enableFusion, /*isSIMD=*/true);
         return getUnaryBinarySimdCodeFullyFlattened<ElementwiseBinaryOp>(
             rewriter, create, &shapeHelper, op, outputMemRefType, operands,
-            alignment, simdUnroll);
+            alignment, simdUnroll, parallel, parallelThreshold, fusion);
+      }
+      // Static broadcasts, e.g. of biases, with a loop version per pattern.
+      int64_t VL = create.vec.getMachineVectorLength(outputElementType);
+      SmallVector<SimdBroadcastKind, 4> kinds;
+      if (enableSIMD && !scalar && !hasNonIdentityLayout(operands)) {
+        int64_t split =
+            getSimdBroadcastSplit(outputMemRefType, operands, VL, kinds);
+        if (split >= 0) {
+          VectorType vecElementType = VectorType::get({VL}, outputElementType);
+          Value alloc = emitSimdBroadcastLoops(rewriter, create,
+              outputMemRefType, operands, alignment, VL, split, kinds,
+              parallel, [&](KrnlBuilder &ck, ArrayRef<Value> loadedVals) {
+                return emitScalarOpFor<ElementwiseBinaryOp>(rewriter,
+                    ck.getLoc(), op, vecElementType, loadedVals);
+              });
+          rewriter.replaceOp(op, alloc);
+          return success();
+        }
       }
     }
 
     // Insert an allocation and deallocation for the result of this operation.
     Value alloc = create.mem.alignedAlloc(
         outputMemRefType, shapeHelper.getOutputDims(), alignment);
+    ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+        outputMemRefType, enableFusion && !scalar, /*isSIMD=*/false);
 
     // Only create krnl.iterate if one of the operands is not scalar tensor.
     if (!scalar) {
-      ValueRange loopDef = create.krnl.defineLoops(outputRank);
-      SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
-      SmallVector<IndexExpr, 4> ubs;
-      create.krnlIE.getShapeAsDims(alloc, ubs);
-      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      emitElementwiseLoops(rewriter, loc, alloc, parallel,
           [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
             IndexExprScope innerScope(createKrnl, shapeHelper.getScope());
             SmallVector<IndexExpr, 4> outputAccessExprs;
@@ -1253,6 +1839,8 @@ struct ONNXElementwiseBinaryOpLowering
             // Apply the element-wise function.
             Value result = emitScalarOpFor<ElementwiseBinaryOp>(
                 rewriter, loc, op, outputElementType, {lhs, rhs});
+            result = fusion.emitFusedOps(
+                rewriter, createKrnl, outputElementType, result, loopInd);
 
             // Store result in the resulting array.
             createKrnl.store(result, alloc, loopInd);
@@ -1269,7 +1857,7 @@ struct ONNXElementwiseBinaryOpLowering
       create.krnl.store(result, alloc);
     }
 
-    rewriter.replaceOp(op, alloc);
+    fusion.replaceOrEraseONNXOps(rewriter, alloc);
 
     return success();
   }
@@ -1284,11 +1872,16 @@ struct ONNXElementwiseVariadicOpLowering
     : public OpConversionPattern<ElementwiseVariadicOp> {
   using OpAdaptor = typename ElementwiseVariadicOp::Adaptor;
   bool enableSIMD = false;
+  bool enableParallel = false;
+  int64_t parallelThreshold;
+  bool enableFusion = false;
 
-  ONNXElementwiseVariadicOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+  ONNXElementwiseVariadicOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel,
+      int64_t parallelThreshold, bool enableFusion)
       : OpConversionPattern<ElementwiseVariadicOp>(typeConverter, ctx),
-        enableSIMD(enableSIMD) {}
+        enableSIMD(enableSIMD), enableParallel(enableParallel),
+        parallelThreshold(parallelThreshold), enableFusion(enableFusion) {}
 
   LogicalResult matchAndRewrite(ElementwiseVariadicOp elmsOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -1306,7 +1899,6 @@ struct ONNXElementwiseVariadicOpLowering
            "Failed to convert type to MemRefType");
     MemRefType outputMemRefType = convertedType.cast<MemRefType>();
     Type outputElementType = outputMemRefType.getElementType();
-    uint64_t outputRank = outputMemRefType.getRank();
 
     // Shape helper.
     MDBuilder create(rewriter, loc);
@@ -1314,29 +1906,54 @@ struct ONNXElementwiseVariadicOpLowering
     shapeHelper.computeShapeAndAssertOnFailure();
 
     bool scalar = hasAllScalarValues(operands);
+    bool parallel = !scalar &&
+                    isParallelProfitable(outputMemRefType, enableParallel,
+                        parallelThreshold);
     if constexpr (SimdizableOp<ElementwiseVariadicOp>::value) {
       // SIMD is enabled for this operation, test if desired and feasible
       if (enableSIMD && !scalar && !hasNonIdentityLayout(operands) &&
           shapeHelper.hasNoBroadcast()) {
         int64_t simdUnroll = 1;
+        ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+            outputMemRefType, enableFusion, /*isSIMD=*/true);
         return getVariadicSimdCodeFullyFlattened<ElementwiseVariadicOp>(
             rewriter, create, &shapeHelper, op, outputMemRefType, operands,
-            alignment, simdUnroll);
+            alignment, simdUnroll, parallel, parallelThreshold, fusion);
+      }
+      // Static broadcasts, e.g. of biases, with a loop version per pattern.
+      int64_t VL = create.vec.getMachineVectorLength(outputElementType);
+      SmallVector<SimdBroadcastKind, 4> kinds;
+      if (enableSIMD && !scalar && !hasNonIdentityLayout(operands)) {
+        int64_t split =
+            getSimdBroadcastSplit(outputMemRefType, operands, VL, kinds);
+        if (split >= 0) {
+          VectorType vecElementType = VectorType::get({VL}, outputElementType);
+          Value alloc = emitSimdBroadcastLoops(rewriter, create,
+              outputMemRefType, operands, alignment, VL, split, kinds,
+              parallel, [&](KrnlBuilder &ck, ArrayRef<Value> loadedVals) {
+                Value accumulated = loadedVals[0];
+                for (unsigned i = 1; i < numArgs; ++i)
+                  accumulated = emitScalarOpFor<ElementwiseVariadicOp>(
+                      rewriter, ck.getLoc(), op, vecElementType,
+                      {accumulated, loadedVals[i]});
+                return emitPostProcessingFor<ElementwiseVariadicOp>(
+                    rewriter, ck.getLoc(), op, vecElementType, accumulated);
+              });
+          rewriter.replaceOp(op, alloc);
+          return success();
+        }
       }
     }
 
     // Insert an allocation and deallocation for the result of this operation.
     Value alloc = create.mem.alignedAlloc(
         outputMemRefType, shapeHelper.getOutputDims(), alignment);
+    ElementwiseFusionHelper fusion(rewriter, this->typeConverter, op,
+        outputMemRefType, enableFusion && !scalar, /*isSIMD=*/false);
 
     // Only create krnl.iterate if one of the operands is not scalar tensor.
     if (!hasAllScalarValues(operands)) {
-      ValueRange loopDef = create.krnl.defineLoops(outputRank);
-      SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
-      SmallVector<IndexExpr, 4> ubs;
-      create.krnlIE.getShapeAsDims(alloc, ubs);
-
-      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      emitElementwiseLoops(rewriter, loc, alloc, parallel,
           [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
             IndexExprScope innerScope(createKrnl, shapeHelper.getScope());
             SmallVector<IndexExpr, 4> outputAccessExprs;
@@ -1365,6 +1982,8 @@ struct ONNXElementwiseVariadicOpLowering
 
             Value finalResult = emitPostProcessingFor<ElementwiseVariadicOp>(
                 rewriter, loc, op, outputElementType, accumulated);
+            finalResult = fusion.emitFusedOps(
+                rewriter, createKrnl, outputElementType, finalResult, loopInd);
 
             // Store result in the resulting array.
             createKrnl.storeIE(finalResult, alloc, outputAccessExprs);
@@ -1385,7 +2004,7 @@ struct ONNXElementwiseVariadicOpLowering
       // Store result in the resulting array.
       create.krnl.store(finalResult, alloc);
     }
-    rewriter.replaceOp(op, alloc);
+    fusion.replaceOrEraseONNXOps(rewriter, alloc);
     return success();
   }
 };
@@ -1396,12 +2015,16 @@ struct ONNXElementwiseVariadicOpLowering
 
 struct ONNXWhereOpLowering : public ConversionPattern {
   bool enableSIMD = false;
+  bool enableParallel = false;
+  int64_t parallelThreshold;
 
-  ONNXWhereOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+  ONNXWhereOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel, int64_t parallelThreshold,
+      bool /*enableFusion*/)
       : ConversionPattern(
             typeConverter, ONNXWhereOp::getOperationName(), 1, ctx),
-        enableSIMD(enableSIMD) {}
+        enableSIMD(enableSIMD), enableParallel(enableParallel),
+        parallelThreshold(parallelThreshold) {}
 
   LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
       ConversionPatternRewriter &rewriter) const final {
@@ -1414,7 +2037,6 @@ struct ONNXWhereOpLowering : public ConversionPattern {
     assert(convertedType && convertedType.isa<MemRefType>() &&
            "Failed to convert type to MemRefType");
     MemRefType outputMemRefType = convertedType.cast<MemRefType>();
-    uint64_t outputRank = outputMemRefType.getRank();
     ONNXWhereOpAdaptor operandAdaptor(operands);
 
     // Shape helper.
@@ -1429,11 +2051,9 @@ struct ONNXWhereOpLowering : public ConversionPattern {
 
     // Only create krnl.iterate if one of the operands is not scalar tensor.
     if (!hasAllScalarValues(operands)) {
-      ValueRange loopDef = create.krnl.defineLoops(outputRank);
-      SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
-      SmallVector<IndexExpr, 4> ubs;
-      create.krnlIE.getShapeAsDims(alloc, ubs);
-      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      bool parallel = isParallelProfitable(
+          outputMemRefType, enableParallel, parallelThreshold);
+      emitElementwiseLoops(rewriter, loc, alloc, parallel,
           [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
             IndexExprScope innerScope(&rewriter, shapeHelper.getScope());
             SmallVector<IndexExpr, 4> outputAccessExprs;
@@ -1495,7 +2115,8 @@ struct ONNXWhereOpLowering : public ConversionPattern {
 };
 
 void populateLoweringONNXElementwiseOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel, int64_t parallelThreshold, bool enableFusion) {
   patterns.insert<ONNXElementwiseUnaryOpLowering<mlir::ONNXAbsOp>,
       ONNXElementwiseVariadicOpLowering<mlir::ONNXAddOp>,
       ONNXElementwiseVariadicOpLowering<mlir::ONNXAndOp>,
@@ -1549,9 +2170,11 @@ void populateLoweringONNXElementwiseOpPattern(RewritePatternSet &patterns,
       ONNXElementwiseUnaryOpLowering<mlir::ONNXTanOp>,
       ONNXElementwiseUnaryOpLowering<mlir::ONNXTanhOp>, ONNXWhereOpLowering,
       ONNXElementwiseVariadicOpLowering<mlir::ONNXXorOp>>(
-      typeConverter, ctx, enableSIMD);
+      typeConverter, ctx, enableSIMD, enableParallel, parallelThreshold,
+      enableFusion);
   patterns.insert<ONNXElementwiseBinaryOpLowering<mlir::ONNXPReluOp>>(
-      typeConverter, ctx, enableSIMD, /*isUniBroadcasting=*/true);
+      typeConverter, ctx, enableSIMD, enableParallel, parallelThreshold,
+      enableFusion, /*isUniBroadcasting=*/true);
 }
 
 } // namespace onnx_mlir
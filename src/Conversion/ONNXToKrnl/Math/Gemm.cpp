@@ -14,9 +14,12 @@
 
 #include "llvm/Support/Debug.h"
 
+#include "src/Conversion/ONNXToKrnl/MatMulTiles.hpp"
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Conversion/ONNXToKrnl/SparseMatMul.hpp"
 #include "src/Dialect/Krnl/DialectBuilder.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
+#include "src/Dialect/Mlir/VectorMachineSupport.hpp"
 #include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
 
 // Used to trace which op are used, good for profiling apps.
@@ -24,8 +27,12 @@
 #define DEBUG_SIMD_OFF 0
 #define DEBUG_UNROLL_OFF 0
 #define DEBUG_OPTIMIZED_OFF 0
+#define DEBUG_PACKING_OFF 0
 
 static constexpr int BUFFER_ALIGN = 128;
+// Size of the packed B from which its panels are partitioned across the NUMA
+// nodes, large enough for the Gemm to be bound by the memory bandwidth.
+static constexpr int64_t NUMA_PARTITION_MIN_BYTES = 4 << 20;
 
 using namespace mlir;
 
@@ -33,13 +40,21 @@ namespace onnx_mlir {
 
 template <typename GemmOp>
 struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
-  ONNXGemmOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling)
+  ONNXGemmOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel, const MatMulTileDB *tileDB,
+      int64_t sparseWeightThreshold)
       : OpConversionPattern<GemmOp>(typeConverter, ctx),
-        enableTiling(enableTiling) {}
+        enableTiling(enableTiling), enableParallel(enableParallel),
+        tileDB(tileDB), sparseWeightThreshold(sparseWeightThreshold) {}
 
   using OpAdaptor = typename GemmOp::Adaptor;
   bool enableTiling;
+  bool enableParallel;
+  // Tuned tile sizes of the target CPU, if any.
+  const MatMulTileDB *tileDB;
+  // Minimum percentage of zero blocks of a constant B for it to be
+  // multiplied in its block-sparse form.
+  int64_t sparseWeightThreshold;
 
   void genericGemm(ONNXGemmOpAdaptor &adaptor, Type elementType,
       ONNXGemmOpShapeHelper &shapeHelper, Value alloc, Value zeroVal,
@@ -109,6 +124,46 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
         });
   }
 
+  // Returns B packed at compile time into a krnl.global if B is a constant,
+  // and nullptr otherwise. The packed layout is that of the tile buffers of B:
+  // the panels of jCacheTile columns of B (rows when transposed) are laid out
+  // one after the other, each as K rows of jCacheTile contiguous elements,
+  // padded with zeros. The kCacheTile x jCacheTile tile of B at (k1, j1) is
+  // thus laid out as its tile buffer, starting at row
+  // (j1 / jCacheTile) * K + k1 of the packed B. Sets panelRows to K.
+  Value packConstantB(Value B, bool bTrans, Type elementType,
+      int64_t jCacheTile, int64_t &panelRows,
+      ConversionPatternRewriter &rewriter, Location loc) const {
+    DenseElementsAttr bAttr = getDenseElementAttrFromConstValue(B);
+    if (!bAttr || !elementType.isF32())
+      return nullptr;
+    ArrayRef<int64_t> bShape = bAttr.getType().getShape();
+    int64_t K = bTrans ? bShape[1] : bShape[0];
+    int64_t J = bTrans ? bShape[0] : bShape[1];
+    int64_t numPanels = (J + jCacheTile - 1) / jCacheTile;
+    // Do not let the padding more than double the size of small weights.
+    if (numPanels * jCacheTile > 2 * J)
+      return nullptr;
+
+    std::vector<float> packed(numPanels * K * jCacheTile, 0.0f);
+    auto bValues = bAttr.getValues<float>();
+    for (int64_t k = 0; k < K; ++k)
+      for (int64_t j = 0; j < J; ++j)
+        packed[((j / jCacheTile) * K + k) * jCacheTile + j % jCacheTile] =
+            bValues[bTrans ? j * K + k : k * J + j];
+    MemRefType packedType =
+        MemRefType::get({numPanels * K, jCacheTile}, elementType);
+    DenseElementsAttr packedAttr = DenseElementsAttr::get(
+        RankedTensorType::get(packedType.getShape(), elementType),
+        llvm::makeArrayRef(packed));
+    LLVM_DEBUG(llvm::dbgs() << "Gemm: pack constant B into " << numPanels
+                            << " panels\n");
+    panelRows = K;
+    MultiDialectBuilder<KrnlBuilder> create(rewriter, loc);
+    return create.krnl.constant(packedType, "packed_constant_", packedAttr,
+        std::nullopt, rewriter.getI64IntegerAttr(BUFFER_ALIGN));
+  }
+
   void tiledTransposedGemm(ONNXGemmOpAdaptor &adaptor, Type elementType,
       ONNXGemmOpShapeHelper &shapeHelper, Value alloc, Value zeroVal,
       Value alphaVal, Value betaVal, ConversionPatternRewriter &rewriter,
@@ -129,9 +184,38 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
     create.krnl.memset(R, zeroVal);
 
     // Prepare for the computations.
-    // 1) Define blocking, with simdization along the j axis.
-    const int64_t iCacheTile(32), jCacheTile(64), kCacheTile(256);
-    const int64_t iRegTile(4), jRegTile(16);
+    // 1) Define blocking, with simdization along the j axis. By default, rows
+    // of 4 vectors of accumulators use all the vector registers, the tile of A
+    // fits in the level 1 cache and the tile of B in a quarter of the level 2
+    // cache (4 x 16 and 32 x 256 x 64 with 16 registers of 4 floats, 32KB and
+    // 256KB).
+    const VectorMachineSupport &vms = VectorMachineSupport::getGlobal();
+    int64_t kCacheTile(256);
+    int64_t iRegTile = vms.getRegTileRows(4, vms.numVectorRegisters);
+    int64_t jRegTile = 4 * vms.getVectorLength(elementType);
+    int64_t iCacheTile = std::max(iRegTile,
+        vms.getL1TileRows(elementType, kCacheTile) / iRegTile * iRegTile);
+    int64_t jCacheTile = vms.getL2TileCols(elementType, kCacheTile, jRegTile);
+    // Use the tuned sizes when the sizes were autotuned for the target CPU.
+    // The K register tile is the K cache tile, over which krnl.matmul computes.
+    const MatMulTileSizes *tuned = nullptr;
+    if (tileDB && I.isLiteral() && J.isLiteral() && K.isLiteral())
+      tuned = tileDB->lookup(
+          "Gemm", I.getLiteral(), J.getLiteral(), K.getLiteral());
+    if (tuned) {
+      iRegTile = tuned->regTile[0];
+      jRegTile = tuned->regTile[1];
+      if (tuned->cacheTile[0]) {
+        iCacheTile = tuned->cacheTile[0];
+        jCacheTile = tuned->cacheTile[1];
+        kCacheTile = tuned->cacheTile[2];
+      }
+      LLVM_DEBUG({
+        llvm::dbgs() << "Gemm: Tuned tiling I " << iRegTile << "/"
+                     << iCacheTile << ", J " << jRegTile << "/" << jCacheTile
+                     << ", K " << kCacheTile << "\n";
+      });
+    }
 
     bool unrollAndJam = DEBUG_UNROLL_OFF ? false : true;
     // Simdize with jRegTile as the vector length.
@@ -158,120 +242,222 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
       }
     }
 
-    // 2) Alloc data for tiles.
+    // 2) Data for tiles. A constant B is packed at compile time in the layout
+    // of its tile buffer, so that its tiles are used in place instead of being
+    // copied at runtime.
     MemRefType aTileType =
         MemRefType::get({iCacheTile, kCacheTile}, elementType);
     MemRefType bTileType =
         MemRefType::get({kCacheTile, jCacheTile}, elementType);
-    SmallVector<IndexExpr, 1> empty;
-    Value aBuff = create.mem.alignedAlloc(aTileType, BUFFER_ALIGN);
-    Value bBuff = create.mem.alignedAlloc(bTileType, BUFFER_ALIGN);
-    Value rBuff;
-    if (mustTileR)
-      rBuff = create.mem.alignedAlloc(aTileType, BUFFER_ALIGN);
-
-    // 3) introduce the loops and permute them
-    // I, J, K loop.
-    ValueRange origLoop = create.krnl.defineLoops(3);
-    Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
-    // Tile I.
-    ValueRange iCacheBlock = create.krnl.block(ii, iCacheTile);
-    ValueRange iRegBlock = create.krnl.block(iCacheBlock[1], iRegTile);
-    Value ii1(iCacheBlock[0]), ii2(iRegBlock[0]), ii3(iRegBlock[1]);
-    // Tile J.
-    ValueRange jCacheBlock = create.krnl.block(jj, jCacheTile);
-    ValueRange jRegBlock = create.krnl.block(jCacheBlock[1], jRegTile);
-    Value jj1(jCacheBlock[0]), jj2(jRegBlock[0]), jj3(jRegBlock[1]);
-    // Tile K.
-    ValueRange kCacheBlock = create.krnl.block(kk, kCacheTile);
-    Value kk1(kCacheBlock[0]), kk2(kCacheBlock[1]);
-
-    // If we must tile the result R, then we put I & J in the outermost.
-    // Otherwise, we follow the more traditional scheme of having J & K in the
-    // outermost.
-    if (mustTileR) {
-      // (cache) ii1 jj1 kk1,    (reg) jj2, ii2,    (matmul) ii3, jj3, kk3
-      create.krnl.permute({ii1, ii2, ii3, jj1, jj2, jj3, kk1, kk2},
-          {/*i*/ 0, 4, 5, /*j*/ 1, 3, 6, /*k*/ 2, 7});
-      // Compute: A[i, k] * b[k, j] -> R[i, j])
-      create.krnl.iterateIE({ii, jj, kk}, {ii1, jj1}, {zeroIE, zeroIE, zeroIE},
-          {I, J, K}, [&](KrnlBuilder &createKrnl, ValueRange i1_j1_indices) {
-            Value i1(i1_j1_indices[0]), j1(i1_j1_indices[1]);
-            createKrnl.copyToBuffer(rBuff, R, {i1, j1}, zeroVal, false);
-            createKrnl.iterateIE({}, {kk1}, {}, {},
-                [&](KrnlBuilder &createKrnl, ValueRange k1_index) {
-                  Value k1(k1_index[0]);
-                  if (aTrans)
-                    createKrnl.copyToBuffer(aBuff, A, {k1, i1}, zeroVal, true);
-                  else
-                    createKrnl.copyToBuffer(aBuff, A, {i1, k1}, zeroVal, false);
-                  if (bTrans)
-                    createKrnl.copyToBuffer(bBuff, B, {j1, k1}, zeroVal, true);
-                  else
-                    createKrnl.copyToBuffer(bBuff, B, {k1, j1}, zeroVal, false);
-                  createKrnl.iterate({}, {jj2, ii2}, {}, {},
-                      [&](KrnlBuilder &createKrnl, ValueRange j2_i2_indices) {
-                        Value j2(j2_i2_indices[0]), i2(j2_i2_indices[1]);
-                        ArrayRef<int64_t> empty;
-                        createKrnl.matmul(aBuff, {i1, k1}, bBuff, {k1, j1},
-                            rBuff, {i1, j1},
-                            /*loops*/ {ii3, jj3, kk2},
-                            /*compute start*/ {i2, j2, k1},
-                            /*ubs*/ {I.getValue(), J.getValue(), K.getValue()},
-                            /*compute tile*/ {iRegTile, jRegTile, kCacheTile},
-                            /* a/b/c tiles*/ empty, empty, empty, simdize,
-                            unrollAndJam, false);
-                      });
-                });
-            createKrnl.copyFromBuffer(rBuff, R, {i1, j1});
-          });
+    Value iVal(I.getValue()), jVal(J.getValue()), kVal(K.getValue());
+    int64_t panelRows = 0;
+    Value packedB = DEBUG_PACKING_OFF ? nullptr
+                                      : packConstantB(B, bTrans, elementType,
+                                            jCacheTile, panelRows, rewriter,
+                                            loc);
+    // When the iterations of the parallel loop are the panels of a large
+    // packed B, the panels are partitioned across the NUMA nodes running the
+    // iterations, so that the threads of each node read their panels from its
+    // local memory, and write their columns of R in place.
+    if (packedB && enableParallel && !mustTileR) {
+      MemRefType packedType = packedB.getType().cast<MemRefType>();
+      int64_t numPanels = packedType.getShape()[0] / panelRows;
+      int64_t packedBytes = packedType.getNumElements() *
+                            packedType.getElementTypeBitWidth() / 8;
+      if (numPanels > 1 && packedBytes >= NUMA_PARTITION_MIN_BYTES)
+        packedB.getDefiningOp()->setAttr(KRNL_GLOBAL_NUMA_PARTITIONS_ATTR,
+            rewriter.getI64IntegerAttr(numPanels));
+    }
 
-    } else {
-      // Does not have to tile the result.
-      // (cache) jj1 kk1, ii1, (reg) jj2, ii2, (matmul) ii3, jj3, kk3
-      // Krnl Rule: put all the values in the permute, including the ones that
-      // are not iterated over explicitly. All of the same derived (tiled)
-      // variable must be consecutive, and different original variables must be
-      // ordered in the same permute order. Js must be first as the outermost
-      // level is a j, then all the Ks, then all the Is.
-      create.krnl.permute({jj1, jj2, jj3, kk1, kk2, ii1, ii2, ii3},
-          {/*j*/ 0, 3, 5, /*k*/ 1, 6, /*i*/ 2, 4, 7});
-      // Compute: A[i, k] * b[k, j] -> R[i, j])
-      // Krnl Rule: must put all the iter bounds at once, but can only put the
-      // "not currently used ones" like ii here last. Gave an error when ii was
-      // listed first.
-      create.krnl.iterateIE({jj, kk, ii}, {jj1, kk1}, {zeroIE, zeroIE, zeroIE},
-          {J, K, I}, [&](KrnlBuilder &createKrnl, ValueRange j1_k1_indices) {
-            Value j1(j1_k1_indices[0]), k1(j1_k1_indices[1]);
-            if (bTrans)
-              createKrnl.copyToBuffer(bBuff, B, {j1, k1}, zeroVal, true);
-            else
-              createKrnl.copyToBuffer(bBuff, B, {k1, j1}, zeroVal, false);
-            createKrnl.iterateIE({}, {ii1}, {}, {},
-                [&](KrnlBuilder &createKrnl, ValueRange i1_index) {
-                  Value i1(i1_index[0]);
-                  if (aTrans)
-                    createKrnl.copyToBuffer(aBuff, A, {k1, i1}, zeroVal, true);
-                  else
-                    createKrnl.copyToBuffer(aBuff, A, {i1, k1}, zeroVal, false);
-                  createKrnl.iterate({}, {jj2, ii2}, {}, {},
-                      [&](KrnlBuilder &createKrnl, ValueRange j2_i2_indices) {
-                        Value j2(j2_i2_indices[0]), i2(j2_i2_indices[1]);
-                        createKrnl.matmul(aBuff, {i1, k1}, bBuff, {k1, j1}, R,
-                            {z, z},
-                            /*loops*/ {ii3, jj3, kk2},
-                            /*compute start*/ {i2, j2, k1},
-                            /*ubs*/ {I.getValue(), J.getValue(), K.getValue()},
-                            /*compute tile*/ {iRegTile, jRegTile, kCacheTile},
-                            /* a/b/c tiles*/ {}, {}, {}, simdize, unrollAndJam,
-                            false);
-                      });
-                });
+    // Returns the B operand of the matmul on the tile of B at (k1, j1), and
+    // sets the global indices at which it starts. The tile is copied into
+    // bBuff unless B is packed.
+    auto getBTile = [&](KrnlBuilder &createKrnl, Value bBuff, Value k1,
+                        Value j1, SmallVectorImpl<Value> &bStart) -> Value {
+      if (packedB) {
+        IndexExprScope scope(createKrnl);
+        DimIndexExpr j1IE(j1);
+        IndexExpr panelStart = j1IE.floorDiv(jCacheTile) * (-panelRows);
+        bStart.assign({panelStart.getValue(), j1});
+        return packedB;
+      }
+      if (bTrans)
+        createKrnl.copyToBuffer(bBuff, B, {j1, k1}, zeroVal, true);
+      else
+        createKrnl.copyToBuffer(bBuff, B, {k1, j1}, zeroVal, false);
+      bStart.assign({k1, j1});
+      return bBuff;
+    };
+
+    // 3) introduce the loops and permute them. The blocks of the outermost
+    // cache tiled loop (I when R is tiled, J otherwise) are restricted to the
+    // [outerLB, outerUB) range.
+    auto emitTiledGemm = [&](KrnlBuilder &createKrnl, Value aBuff, Value bBuff,
+                             Value rBuff, Value outerLB, Value outerUB) {
+      MultiDialectBuilder<KrnlBuilder> create(createKrnl);
+      // I, J, K loop.
+      ValueRange origLoop = create.krnl.defineLoops(3);
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      // Tile I.
+      ValueRange iCacheBlock = create.krnl.block(ii, iCacheTile);
+      ValueRange iRegBlock = create.krnl.block(iCacheBlock[1], iRegTile);
+      Value ii1(iCacheBlock[0]), ii2(iRegBlock[0]), ii3(iRegBlock[1]);
+      // Tile J.
+      ValueRange jCacheBlock = create.krnl.block(jj, jCacheTile);
+      ValueRange jRegBlock = create.krnl.block(jCacheBlock[1], jRegTile);
+      Value jj1(jCacheBlock[0]), jj2(jRegBlock[0]), jj3(jRegBlock[1]);
+      // Tile K.
+      ValueRange kCacheBlock = create.krnl.block(kk, kCacheTile);
+      Value kk1(kCacheBlock[0]), kk2(kCacheBlock[1]);
+
+      // If we must tile the result R, then we put I & J in the outermost.
+      // Otherwise, we follow the more traditional scheme of having J & K in
+      // the outermost.
+      if (mustTileR) {
+        // (cache) ii1 jj1 kk1,    (reg) jj2, ii2,    (matmul) ii3, jj3, kk3
+        create.krnl.permute({ii1, ii2, ii3, jj1, jj2, jj3, kk1, kk2},
+            {/*i*/ 0, 4, 5, /*j*/ 1, 3, 6, /*k*/ 2, 7});
+        // Compute: A[i, k] * b[k, j] -> R[i, j])
+        create.krnl.iterate({ii, jj, kk}, {ii1, jj1}, {outerLB, z, z},
+            {outerUB, jVal, kVal},
+            [&](KrnlBuilder &createKrnl, ValueRange i1_j1_indices) {
+              Value i1(i1_j1_indices[0]), j1(i1_j1_indices[1]);
+              createKrnl.copyToBuffer(rBuff, R, {i1, j1}, zeroVal, false);
+              createKrnl.iterateIE({}, {kk1}, {}, {},
+                  [&](KrnlBuilder &createKrnl, ValueRange k1_index) {
+                    Value k1(k1_index[0]);
+                    if (aTrans)
+                      createKrnl.copyToBuffer(
+                          aBuff, A, {k1, i1}, zeroVal, true);
+                    else
+                      createKrnl.copyToBuffer(
+                          aBuff, A, {i1, k1}, zeroVal, false);
+                    SmallVector<Value, 2> bStart;
+                    Value bTile = getBTile(createKrnl, bBuff, k1, j1, bStart);
+                    createKrnl.iterate({}, {jj2, ii2}, {}, {},
+                        [&](KrnlBuilder &createKrnl, ValueRange j2_i2_indices) {
+                          Value j2(j2_i2_indices[0]), i2(j2_i2_indices[1]);
+                          ArrayRef<int64_t> empty;
+                          createKrnl.matmul(aBuff, {i1, k1}, bTile, bStart,
+                              rBuff, {i1, j1},
+                              /*loops*/ {ii3, jj3, kk2},
+                              /*compute start*/ {i2, j2, k1},
+                              /*ubs*/ {iVal, jVal, kVal},
+                              /*compute tile*/ {iRegTile, jRegTile, kCacheTile},
+                              /* a/b/c tiles*/ empty, empty, empty, simdize,
+                              unrollAndJam, false);
+                        });
+                  });
+              createKrnl.copyFromBuffer(rBuff, R, {i1, j1});
+            });
+
+      } else {
+        // Does not have to tile the result.
+        // (cache) jj1 kk1, ii1, (reg) jj2, ii2, (matmul) ii3, jj3, kk3
+        // Krnl Rule: put all the values in the permute, including the ones
+        // that are not iterated over explicitly. All of the same derived
+        // (tiled) variable must be consecutive, and different original
+        // variables must be ordered in the same permute order. Js must be
+        // first as the outermost level is a j, then all the Ks, then all the
+        // Is.
+        create.krnl.permute({jj1, jj2, jj3, kk1, kk2, ii1, ii2, ii3},
+            {/*j*/ 0, 3, 5, /*k*/ 1, 6, /*i*/ 2, 4, 7});
+        // Compute: A[i, k] * b[k, j] -> R[i, j])
+        // Krnl Rule: must put all the iter bounds at once, but can only put
+        // the "not currently used ones" like ii here last. Gave an error when
+        // ii was listed first.
+        create.krnl.iterate({jj, kk, ii}, {jj1, kk1}, {outerLB, z, z},
+            {outerUB, kVal, iVal},
+            [&](KrnlBuilder &createKrnl, ValueRange j1_k1_indices) {
+              Value j1(j1_k1_indices[0]), k1(j1_k1_indices[1]);
+              SmallVector<Value, 2> bStart;
+              Value bTile = getBTile(createKrnl, bBuff, k1, j1, bStart);
+              createKrnl.iterateIE({}, {ii1}, {}, {},
+                  [&](KrnlBuilder &createKrnl, ValueRange i1_index) {
+                    Value i1(i1_index[0]);
+                    if (aTrans)
+                      createKrnl.copyToBuffer(
+                          aBuff, A, {k1, i1}, zeroVal, true);
+                    else
+                      createKrnl.copyToBuffer(
+                          aBuff, A, {i1, k1}, zeroVal, false);
+                    createKrnl.iterate({}, {jj2, ii2}, {}, {},
+                        [&](KrnlBuilder &createKrnl, ValueRange j2_i2_indices) {
+                          Value j2(j2_i2_indices[0]), i2(j2_i2_indices[1]);
+                          createKrnl.matmul(aBuff, {i1, k1}, bTile, bStart,
+                              R, {z, z},
+                              /*loops*/ {ii3, jj3, kk2},
+                              /*compute start*/ {i2, j2, k1},
+                              /*ubs*/ {iVal, jVal, kVal},
+                              /*compute tile*/ {iRegTile, jRegTile, kCacheTile},
+                              /* a/b/c tiles*/ {}, {}, {}, simdize,
+                              unrollAndJam, false);
+                        });
+                  });
+            });
+      }
+    };
+
+    // The outermost loop is I when we must tile R, and J otherwise.
+    int64_t outerCacheTile = mustTileR ? iCacheTile : jCacheTile;
+    Value outerUB = mustTileR ? iVal : jVal;
+    if (enableParallel) {
+      // Each thread computes a distinct set of blocks of the outermost loop,
+      // and thus writes to disjoint regions of R. Tile buffers are private to
+      // each thread, and are thus allocated within the parallel loop.
+      MultiDialectBuilder<MathBuilder, SCFBuilder> create(rewriter, loc);
+      Value outerStep = create.math.constantIndex(outerCacheTile);
+      create.scf.parallelLoop({z}, {outerUB}, {outerStep},
+          [&](SCFBuilder &createSCF, ValueRange parIndices) {
+            // Wrap the Krnl loops in a krnl.region so that the induction
+            // variable of the parallel loop is a valid affine symbol.
+            KrnlRegionOp regionOp = rewriter.create<KrnlRegionOp>(loc);
+            OpBuilder::InsertionGuard insertGuard(rewriter);
+            rewriter.setInsertionPointToStart(
+                &regionOp.getBodyRegion().front());
+            MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+                rewriter, loc);
+            Value aBuff = create.mem.alignedAlloca(aTileType, BUFFER_ALIGN);
+            Value bBuff;
+            if (!packedB)
+              bBuff = create.mem.alignedAlloca(bTileType, BUFFER_ALIGN);
+            Value rBuff;
+            if (mustTileR)
+              rBuff = create.mem.alignedAlloca(aTileType, BUFFER_ALIGN);
+            Value outerLB = parIndices[0];
+            Value outerBlockUB =
+                create.math.min(create.math.add(outerLB, outerStep), outerUB);
+            emitTiledGemm(
+                create.krnl, aBuff, bBuff, rBuff, outerLB, outerBlockUB);
           });
+    } else {
+      Value aBuff = create.mem.alignedAlloc(aTileType, BUFFER_ALIGN);
+      Value bBuff;
+      if (!packedB)
+        bBuff = create.mem.alignedAlloc(bTileType, BUFFER_ALIGN);
+      Value rBuff;
+      if (mustTileR)
+        rBuff = create.mem.alignedAlloc(aTileType, BUFFER_ALIGN);
+      emitTiledGemm(create.krnl, aBuff, bBuff, rBuff, z, outerUB);
     }
 
     // Perform the alpha/beta computations.
-    float alphaLit = adaptor.getAlpha().convertToFloat();
+    emitAlphaBeta(adaptor, shapeHelper, R, alphaVal, betaVal,
+        /*scaleByAlpha=*/true, rewriter, loc);
+  }
+
+  // Compute R = alpha * R + beta * C in place, R being scaled by alpha only
+  // when scaleByAlpha.
+  void emitAlphaBeta(ONNXGemmOpAdaptor &adaptor,
+      ONNXGemmOpShapeHelper &shapeHelper, Value R, Value alphaVal,
+      Value betaVal, bool scaleByAlpha, ConversionPatternRewriter &rewriter,
+      Location loc) const {
+    MultiDialectBuilder<KrnlBuilder> create(rewriter, loc);
+    LiteralIndexExpr zeroIE(0);
+    IndexExpr I = shapeHelper.getOutputDims()[0];
+    IndexExpr J = shapeHelper.getOutputDims()[1];
+    float alphaLit =
+        scaleByAlpha ? adaptor.getAlpha().convertToFloat() : 1.0f;
     float betaLit = adaptor.getBeta().convertToFloat();
     if (alphaLit == 1.0 && (betaLit == 0.0 || !shapeHelper.hasBias)) {
       // No need for the multiply/add.
@@ -343,6 +529,8 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
         llvm::dbgs() << "Gemm unroll off\n";
       if (DEBUG_OPTIMIZED_OFF)
         llvm::dbgs() << "Gemm optimized path off\n";
+      if (DEBUG_PACKING_OFF)
+        llvm::dbgs() << "Gemm packing of constant B off\n";
 
       bool aTrans = adaptor.getTransA();
       bool bTrans = adaptor.getTransB();
@@ -370,6 +558,23 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
       }
     });
 
+    // Pruned constant weights are multiplied in their block-sparse form, by
+    // blocks of one vector, and scaled by alpha at compile time.
+    if (enableTiling && elementType.isF32()) {
+      MultiDialectBuilder<VectorBuilder> createVec(rewriter, loc);
+      int64_t VL = createVec.vec.getMachineVectorLength(elementType);
+      if (Optional<BlockSparseMatrix> sparseB =
+              getBlockSparseConstant(adaptor.getB(), adaptor.getTransB(), VL,
+                  sparseWeightThreshold, alphaLit)) {
+        emitBlockSparseMatMul(rewriter, loc, adaptor.getA(),
+            adaptor.getTransA(), *sparseB, alloc, enableParallel);
+        emitAlphaBeta(adaptor, shapeHelper, alloc, alpha, beta,
+            /*scaleByAlpha=*/false, rewriter, loc);
+        rewriter.replaceOp(op, alloc);
+        return success();
+      }
+    }
+
     if (enableTiling && !DEBUG_OPTIMIZED_OFF) {
       tiledTransposedGemm(adaptor, elementType, shapeHelper, alloc, zero, alpha,
           beta, rewriter, loc);
@@ -383,9 +588,11 @@ struct ONNXGemmOpLowering : public OpConversionPattern<GemmOp> {
 };
 
 void populateLoweringONNXGemmOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling) {
-  patterns.insert<ONNXGemmOpLowering<ONNXGemmOp>>(
-      typeConverter, ctx, enableTiling);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling,
+    bool enableParallel, const MatMulTileDB *tileDB,
+    int64_t sparseWeightThreshold) {
+  patterns.insert<ONNXGemmOpLowering<ONNXGemmOp>>(typeConverter, ctx,
+      enableTiling, enableParallel, tileDB, sparseWeightThreshold);
 }
 
 } // namespace onnx_mlir
@@ -78,8 +78,13 @@ static Value emitArgmax(ConversionPatternRewriter &rewriter, Location loc,
 }
 
 struct ONNXHardmaxOpLowering : public OpConversionPattern<ONNXHardmaxOp> {
-  ONNXHardmaxOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  bool enableSIMD;
+  bool enableParallel;
+
+  ONNXHardmaxOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD),
+        enableParallel(enableParallel) {}
   LogicalResult matchAndRewrite(ONNXHardmaxOp hardmaxOp,
       ONNXHardmaxOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -112,6 +117,39 @@ struct ONNXHardmaxOpLowering : public OpConversionPattern<ONNXHardmaxOp> {
     // Insert an allocation and deallocation for the result of this operation.
     Value resMemRef = create.mem.alignedAlloc(memRefType, ubs);
 
+    // Rows of large enough static float tensors along the innermost axis use
+    // SIMD code, each row being set to zero before its argmax is set to 1.
+    if (enableSIMD && axis == rank - 1 &&
+        emitSimdArgMinMax(rewriter, loc, input, /*isMin=*/false,
+            enableParallel,
+            [&](KrnlBuilder &createKrnl, ValueRange outerIndices,
+                Value argIndex) {
+              MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder>
+                  create(createKrnl);
+              IndexExprScope rowScope(createKrnl);
+              int64_t VL = create.vec.getMachineVectorLength(elementType);
+              Value fZero = create.math.constant(elementType, 0);
+              Value vecZero =
+                  create.vec.splat(VectorType::get({VL}, elementType), fZero);
+              SmallVector<Value, 4> indices(
+                  outerIndices.begin(), outerIndices.end());
+              IndexExpr N = LiteralIndexExpr(memRefType.getShape()[axis]);
+              emitSimdLoopWithScalarTail(createKrnl, N, VL, elementType,
+                  [&](KrnlBuilder &ck, Type type, Value col) {
+                    indices.emplace_back(col);
+                    storeScalarOrVector(ck,
+                        type.isa<VectorType>() ? vecZero : fZero, resMemRef,
+                        indices);
+                    indices.pop_back();
+                  });
+              indices.emplace_back(argIndex);
+              create.krnl.store(
+                  create.math.constant(elementType, 1), resMemRef, indices);
+            })) {
+      rewriter.replaceOp(op, resMemRef);
+      return success();
+    }
+
     // Compute argmax.
     Value argmax = emitArgmax(rewriter, loc, input, axis);
 
@@ -140,7 +178,7 @@ struct ONNXHardmaxOpLowering : public OpConversionPattern<ONNXHardmaxOp> {
               /*else*/
               [&](SCFBuilder &createSCF) {
                 MultiDialectBuilder<MathBuilder, KrnlBuilder> create(createSCF);
-                Value zero = create.math.constant(elementType, 0);
+                Value fZero = create.math.constant(elementType, 0);
                 create.krnl.store(zero, resMemRef, loopInd);
               });
         });
@@ -151,8 +189,10 @@ struct ONNXHardmaxOpLowering : public OpConversionPattern<ONNXHardmaxOp> {
 };
 
 void populateLoweringONNXHardmaxOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXHardmaxOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
+  patterns.insert<ONNXHardmaxOpLowering>(
+      typeConverter, ctx, enableSIMD, enableParallel);
 }
 
 } // namespace onnx_mlir
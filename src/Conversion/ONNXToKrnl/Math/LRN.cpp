@@ -20,11 +20,13 @@ using namespace mlir;
 namespace onnx_mlir {
 
 struct ONNXLRNOpLowering : public OpConversionPattern<ONNXLRNOp> {
-  ONNXLRNOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXLRNOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD) {}
+  bool enableSIMD;
 
   using LocalMultiDialectBuilder = MultiDialectBuilder<KrnlBuilder,
-      IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>;
+      IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder, VectorBuilder>;
 
   LogicalResult matchAndRewrite(ONNXLRNOp lrnOp, ONNXLRNOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -61,6 +63,13 @@ struct ONNXLRNOpLowering : public OpConversionPattern<ONNXLRNOp> {
     Value alloc =
         create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
 
+    if (enableSIMD &&
+        emitSimdLRN(rewriter, loc, input, alloc, shapeHelper.getOutputDims(),
+            biasLit, alphaLit / (float)sizeLit, betaLit, sizeLit)) {
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     ValueRange outputLoopDef = create.krnl.defineLoops(outputRank);
     SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
     create.krnl.iterateIE(outputLoopDef, outputLoopDef, lbs,
@@ -145,11 +154,118 @@ struct ONNXLRNOpLowering : public OpConversionPattern<ONNXLRNOp> {
     rewriter.replaceOp(op, alloc);
     return success();
   }
+
+  // Emit the sliding window SIMD code of LRN for f32 values with identity
+  // layouts, returning false when not applicable. The values of each batch
+  // are viewed as C channels of S contiguous spatial values, of which blocks
+  // of VL values are normalized channel after channel. From one channel to
+  // the next, the sum of squares over the window of channels is updated by
+  // adding the square of the channel entering the window and subtracting the
+  // one of the channel leaving it, which takes O(C) operations per block of
+  // spatial values instead of O(C * size).
+  bool emitSimdLRN(ConversionPatternRewriter &rewriter, Location loc,
+      Value input, Value alloc, DimsExpr &dims, float biasLit,
+      float alphaDivSizeLit, float betaLit, int sizeLit) const {
+    LocalMultiDialectBuilder create(rewriter, loc);
+    Type elementType = input.getType().cast<MemRefType>().getElementType();
+    int64_t rank = dims.size();
+    if (!elementType.isF32() || rank < 3 || hasNonIdentityLayout(input) ||
+        hasNonIdentityLayout(alloc))
+      return false;
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    IndexExpr S = LiteralIndexExpr(1);
+    for (int64_t d = 2; d < rank; ++d)
+      S = S * dims[d];
+    if (S.isLiteral() && S.getLiteral() < VL)
+      return false;
+    SmallVector<IndexExpr, 3> viewDims = {dims[0], dims[1], S};
+    Value xView = create.mem.reinterpretCast(input, viewDims);
+    Value yView = create.mem.reinterpretCast(alloc, viewDims);
+
+    // The window of channel c is [c - lo, c + hi], clipped to [0, C - 1].
+    int64_t lo = (sizeLit - 1) / 2;
+    int64_t hi = sizeLit / 2;
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value C = dims[1].getValue();
+    Value lastChannel = (dims[1] - 1).getValue();
+    Value firstWindowUb = IndexExpr::min(dims[1], hi + 1).getValue();
+
+    ValueRange batchLoopDef = create.krnl.defineLoops(1);
+    create.krnl.iterateIE(batchLoopDef, batchLoopDef, {LiteralIndexExpr(0)},
+        {dims[0]}, [&](KrnlBuilder &createKrnl, ValueRange batchInd) {
+          IndexExprScope batchScope(createKrnl);
+          Value n = batchInd[0];
+          emitSimdLoopWithScalarTail(createKrnl, SymbolIndexExpr(S), VL,
+              elementType, [&](KrnlBuilder &ck, Type type, Value s) {
+                OpBuilder &builder = ck.getBuilder();
+                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(ck);
+                Value fZero = create.math.constant(type, 0);
+                Value biasVal = create.math.constant(type, biasLit);
+                Value alphaDivSizeVal =
+                    create.math.constant(type, alphaDivSizeLit);
+                Value betaVal = create.math.constant(type, betaLit);
+                auto square = [&](KrnlBuilder &createSquare, Value c) {
+                  Value x =
+                      loadScalarOrVector(createSquare, type, xView, {n, c, s});
+                  return MathBuilder(createSquare).mul(x, x);
+                };
+
+                // Sum of squares of the window of the first channel.
+                scf::ForOp firstWindowLoop = builder.create<scf::ForOp>(loc,
+                    zero, firstWindowUb, one, ValueRange{fZero},
+                    [&](OpBuilder &forBuilder, Location forLoc, Value c,
+                        ValueRange sums) {
+                      KrnlBuilder createKrnl(forBuilder, forLoc);
+                      Value sum = MathBuilder(createKrnl)
+                                      .add(sums[0], square(createKrnl, c));
+                      forBuilder.create<scf::YieldOp>(forLoc, sum);
+                    });
+
+                // For each channel, y = x / (bias + alpha / size * sum) ^
+                // beta, and slide the window to the next channel.
+                builder.create<scf::ForOp>(loc, zero, C, one,
+                    ValueRange{firstWindowLoop.getResult(0)},
+                    [&](OpBuilder &forBuilder, Location forLoc, Value c,
+                        ValueRange sums) {
+                      MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                          forBuilder, forLoc);
+                      Value x = loadScalarOrVector(
+                          create.krnl, type, xView, {n, c, s});
+                      Value denom = create.math.pow(
+                          create.math.add(biasVal,
+                              create.math.mul(alphaDivSizeVal, sums[0])),
+                          betaVal);
+                      storeScalarOrVector(create.krnl,
+                          create.math.div(x, denom), yView, {n, c, s});
+                      // The channels entering and leaving the window are
+                      // clipped to valid ones, whose squares are then
+                      // discarded.
+                      Value cIn =
+                          create.math.add(c, create.math.constantIndex(hi + 1));
+                      Value cOut =
+                          create.math.sub(c, create.math.constantIndex(lo));
+                      Value inSquare = square(
+                          create.krnl, create.math.min(cIn, lastChannel));
+                      inSquare = create.math.select(
+                          create.math.slt(cIn, C), inSquare, fZero);
+                      Value outSquare =
+                          square(create.krnl, create.math.max(cOut, zero));
+                      outSquare = create.math.select(
+                          create.math.sge(cOut, zero), outSquare, fZero);
+                      Value sum = create.math.sub(
+                          create.math.add(sums[0], inSquare), outSquare);
+                      forBuilder.create<scf::YieldOp>(forLoc, sum);
+                    });
+              });
+        });
+    return true;
+  }
 };
 
 void populateLoweringONNXLRNOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXLRNOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD) {
+  patterns.insert<ONNXLRNOpLowering>(typeConverter, ctx, enableSIMD);
 }
 
 } // namespace onnx_mlir
@@ -8,17 +8,21 @@
 //
 // =============================================================================
 //
-// This file lowers the ONNX Matmul Operator to Krnl dialect.
+// This file lowers the ONNX Matmul Operator, and its MatMulInteger and
+// QLinearMatMul integer variants, to Krnl dialect.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Debug.h"
 
+#include "src/Conversion/ONNXToKrnl/MatMulTiles.hpp"
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Conversion/ONNXToKrnl/SparseMatMul.hpp"
 #include "src/Dialect/Krnl/DialectBuilder.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 #include "src/Dialect/Mlir/DialectBuilder.hpp"
 #include "src/Dialect/Mlir/IndexExpr.hpp"
+#include "src/Dialect/Mlir/VectorMachineSupport.hpp"
 #include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
 
 #define DEBUG_TYPE "matmul"
@@ -28,15 +32,24 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
-struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
-  ONNXMatMulOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling)
-      : OpConversionPattern(typeConverter, ctx), enableTiling(enableTiling) {}
+// Code generation of matrix multiplications, shared by the lowering of MatMul
+// and of its integer variants. The element type of A and C is the type of the
+// computations. B may have a narrower float type, or the signed integer type of
+// quantized weights, its elements being widened when loaded.
+struct MatMulLoweringBase {
+  MatMulLoweringBase(
+      bool enableTiling, bool enableParallel, const MatMulTileDB *tileDB)
+      : enableTiling(enableTiling), enableParallel(enableParallel),
+        tileDB(tileDB) {}
   bool enableTiling;
+  bool enableParallel;
+  // Tuned tile sizes of the target CPU, if any.
+  const MatMulTileDB *tileDB;
   // Handle the generic cases, including when there are broadcasts.
-  void replaceGenericMatmul(ONNXMatMulOpAdaptor &operandAdaptor,
-      Type elementType, ONNXMatMulOpShapeHelper &shapeHelper, Value alloc,
-      Value fZero, ConversionPatternRewriter &rewriter, Location loc) const {
+  template <typename ShapeHelperType>
+  void replaceGenericMatmul(Value A, Value B, Type elementType,
+      ShapeHelperType &shapeHelper, Value alloc, Value fZero,
+      ConversionPatternRewriter &rewriter, Location loc) const {
 
     // Define loops and bounds.
     MultiDialectBuilder<KrnlBuilder, MemRefBuilder> create(rewriter, loc);
@@ -101,10 +114,9 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
                   }
                 }
                 // Add mat mul operation.
-                Value loadedA =
-                    create.krnl.load(operandAdaptor.getA(), aAccessFct);
-                Value loadedB =
-                    create.krnl.load(operandAdaptor.getB(), bAccessFct);
+                Value loadedA = create.krnl.load(A, aAccessFct);
+                Value loadedB = create.math.cast(
+                    elementType, create.krnl.load(B, bAccessFct));
                 Value loadedY = create.krnl.load(reductionVal);
                 Value AB = create.math.mul(loadedA, loadedB);
                 Value accumulated = create.math.add(loadedY, AB);
@@ -115,14 +127,35 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
         });
   }
 
-  void computeTileSizeForMatMatProduct(DimIndexExpr dimI, DimIndexExpr dimJ,
-      DimIndexExpr dimK, int64_t &iRegTile, int64_t &jRegTile,
-      int64_t &kRegTile, bool &simdize) const {
+  void computeTileSizeForMatMatProduct(int64_t mVL, DimIndexExpr dimI,
+      DimIndexExpr dimJ, DimIndexExpr dimK, int64_t &iRegTile,
+      int64_t &jRegTile, int64_t &kRegTile, bool &simdize) const {
+
+    // Tuned values, when the sizes were autotuned for the target CPU.
+    const MatMulTileSizes *tuned = nullptr;
+    if (tileDB && dimI.isLiteral() && dimJ.isLiteral() && dimK.isLiteral())
+      tuned = tileDB->lookup(
+          "MatMul", dimI.getLiteral(), dimJ.getLiteral(), dimK.getLiteral());
+    if (tuned) {
+      iRegTile = tuned->regTile[0];
+      jRegTile = tuned->regTile[1];
+      kRegTile = tuned->regTile[2];
+      if (dimJ.getLiteral() < jRegTile)
+        simdize = false;
+      LLVM_DEBUG({
+        llvm::dbgs() << "MatMul mat: Tuned tiling I " << iRegTile << ", J "
+                     << jRegTile << ", K " << kRegTile << ", simd " << simdize
+                     << "\n";
+      });
+      return;
+    }
 
-    // Default values
-    iRegTile = 4;
-    jRegTile = 8;
-    kRegTile = 8; // SIMD dim.
+    // Default values: rows of 2 vectors of accumulators, using half of the
+    // vector registers of the machine (4 x 8 with 16 registers of 4 floats).
+    const VectorMachineSupport &vms = VectorMachineSupport::getGlobal();
+    iRegTile = vms.getRegTileRows(2, vms.numVectorRegisters / 2);
+    jRegTile = 2 * mVL; // SIMD dim.
+    kRegTile = 8;
 
     if (dimI.isLiteral()) {
       int64_t constI = dimI.getLiteral();
@@ -223,15 +256,189 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
     });
   }
 
+  // Maximum number of rows of A, once its leading dimensions are flattened,
+  // for the matmul to be computed as a few vector times matrix products, e.g.
+  // for fully connected layers of batch 1 and for token generation.
+  static constexpr int64_t kSmallMMaxRows = 4;
+  // Minimum number of elements of B for the blocks of columns of C to be
+  // computed in parallel.
+  static constexpr int64_t kSmallMParallelMinElements = 65536;
+
+  // Return the number of rows of A when the matmul is computed by
+  // replaceSmallMMatmul, or 0 otherwise. The dimensions of A, but the
+  // reduction one, must be literal, and B must be a matrix of at least one
+  // vector of literal columns.
+  int64_t getSmallMRows(
+      Value A, Value B, Type elementType, const VectorBuilder &vec) const {
+    if (!enableTiling || !elementType.isa<FloatType>())
+      return 0;
+    MemRefType aType = A.getType().cast<MemRefType>();
+    MemRefType bType = B.getType().cast<MemRefType>();
+    if (aType.getRank() < 2 || bType.getRank() != 2)
+      return 0;
+    int64_t M = 1;
+    for (int64_t dim : aType.getShape().drop_back()) {
+      if (dim == ShapedType::kDynamic)
+        return 0;
+      M *= dim;
+    }
+    int64_t J = bType.getShape()[1];
+    if (M < 1 || M > kSmallMMaxRows || J == ShapedType::kDynamic ||
+        J < vec.getMachineVectorLength(elementType))
+      return 0;
+    return M;
+  }
+
+  // Handle the matmuls of the M <= kSmallMMaxRows rows of A by a matrix B.
+  // These are bound by the bandwidth of streaming B, whose rows are loaded as
+  // a few vectors along J once for all the rows of A. Each block of columns of
+  // C is accumulated along K into several vectors per row to hide the latency
+  // of the FMAs, and the blocks are distributed among the threads.
+  void replaceSmallMMatmul(Value A, Value B, Type elementType, int64_t M,
+      Value alloc, Value zeroVal, ConversionPatternRewriter &rewriter,
+      Location loc) const {
+    Value C(alloc);
+    MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, VectorBuilder,
+        SCFBuilder>
+        create(rewriter, loc);
+    ArrayRef<int64_t> aShape = A.getType().cast<MemRefType>().getShape();
+    MemRefType bType = B.getType().cast<MemRefType>();
+    int64_t aRank = aShape.size();
+    int64_t KLit = aShape[aRank - 1];
+    int64_t J = bType.getShape()[1];
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value K = create.mem.dim(A, aRank - 1);
+
+    // Blocks of vecsPerRow vectors of columns, so that all the rows have
+    // half of the vector registers as accumulators, but at least 2 each.
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    VectorType vecType = VectorType::get({VL}, elementType);
+    VectorType bVecType = VectorType::get({VL}, bType.getElementType());
+    int64_t numAccumulators =
+        VectorMachineSupport::getGlobal().numVectorRegisters / 2;
+    int64_t vecsPerRow = std::max<int64_t>(numAccumulators / M, 2);
+    int64_t blockCols = vecsPerRow * VL;
+    int64_t numBlocks = J / blockCols;
+    int64_t blockedJ = numBlocks * blockCols;
+
+    // Indices of the leading dimensions of each row of A, shared by C.
+    SmallVector<SmallVector<Value, 4>, 4> rowIndices(M);
+    for (int64_t r = 0; r < M; ++r) {
+      SmallVector<int64_t, 4> indices(aRank - 1);
+      int64_t rem = r;
+      for (int64_t d = aRank - 2; d >= 0; --d) {
+        indices[d] = rem % aShape[d];
+        rem /= aShape[d];
+      }
+      for (int64_t index : indices)
+        rowIndices[r].emplace_back(create.math.constantIndex(index));
+    }
+
+    // Compute the numCols columns of C starting at j0 with vectors of VL
+    // columns, or one column at a time when not simd, the sums of all the rows
+    // being carried along K by the loop.
+    auto emitColumns = [&](KrnlBuilder &createKrnl, Value j0, int64_t numCols,
+                           bool simd) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+          createKrnl);
+      int64_t width = simd ? VL : 1;
+      int64_t numAcc = numCols / width;
+      Type accType = simd ? Type(vecType) : elementType;
+      SmallVector<Value, 8> cols;
+      for (int64_t u = 0; u < numAcc; ++u)
+        cols.emplace_back(
+            create.math.add(j0, create.math.constantIndex(u * width)));
+      Value accZero = simd ? create.vec.splat(vecType, zeroVal) : zeroVal;
+      SmallVector<Value, 16> accInit(M * numAcc, accZero);
+      auto accumulate = [&](OpBuilder &forBuilder, Location forLoc, Value k,
+                            ValueRange sums) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+            forBuilder, forLoc);
+        // Load the columns of the row k of B once for all the rows of A.
+        SmallVector<Value, 8> bVals;
+        for (int64_t u = 0; u < numAcc; ++u) {
+          Value b = simd ? create.vec.load(bVecType, B, {k, cols[u]})
+                         : create.krnl.load(B, {k, cols[u]});
+          if (b.getType() != accType)
+            b = create.math.cast(accType, b);
+          bVals.emplace_back(b);
+        }
+        SmallVector<Value, 16> results;
+        for (int64_t r = 0; r < M; ++r) {
+          SmallVector<Value, 4> aIndices(rowIndices[r]);
+          aIndices.emplace_back(k);
+          Value a = create.krnl.load(A, aIndices);
+          if (simd)
+            a = create.vec.splat(vecType, a);
+          for (int64_t u = 0; u < numAcc; ++u) {
+            Value sum = sums[r * numAcc + u];
+            results.emplace_back(simd ? create.vec.fma(a, bVals[u], sum)
+                                      : create.math.add(sum,
+                                            create.math.mul(a, bVals[u])));
+          }
+        }
+        forBuilder.create<scf::YieldOp>(forLoc, results);
+      };
+      ValueRange sums = createKrnl.getBuilder()
+                            .create<scf::ForOp>(createKrnl.getLoc(), zero, K,
+                                one, accInit, accumulate)
+                            .getResults();
+      for (int64_t r = 0; r < M; ++r)
+        for (int64_t u = 0; u < numAcc; ++u) {
+          SmallVector<Value, 4> cIndices(rowIndices[r]);
+          cIndices.emplace_back(cols[u]);
+          if (simd)
+            create.vec.store(sums[r * numAcc + u], C, cIndices);
+          else
+            create.krnl.store(sums[r * numAcc + u], C, cIndices);
+        }
+    };
+
+    // Blocks of blockCols columns, in parallel for a large enough B.
+    if (numBlocks > 0) {
+      Value blockStep = create.math.constantIndex(blockCols);
+      Value blockedJVal = create.math.constantIndex(blockedJ);
+      bool parallel = enableParallel && numBlocks > 1 &&
+                      (KLit == ShapedType::kDynamic ||
+                          KLit * J >= kSmallMParallelMinElements);
+      if (parallel) {
+        create.scf.parallelLoop({zero}, {blockedJVal}, {blockStep},
+            [&](SCFBuilder &createSCF, ValueRange parIndices) {
+              emitMatmulInParallelRegion(createSCF, parIndices[0], blockStep,
+                  blockedJVal,
+                  [&](KrnlBuilder &createKrnl, Value jLB, Value jUB) {
+                    emitColumns(createKrnl, jLB, blockCols, /*simd=*/true);
+                  });
+            });
+      } else {
+        ValueRange jLoop = create.krnl.defineLoops(1);
+        ValueRange jBlock = create.krnl.block(jLoop[0], blockCols);
+        create.krnl.iterate(jLoop, {jBlock[0]}, {zero}, {blockedJVal},
+            [&](KrnlBuilder &createKrnl, ValueRange jIndices) {
+              emitColumns(createKrnl, jIndices[0], blockCols, /*simd=*/true);
+            });
+      }
+    }
+    // Remaining vectors of columns, then remaining columns.
+    int64_t vecEnd = blockedJ + ((J - blockedJ) / VL) * VL;
+    if (vecEnd > blockedJ)
+      emitColumns(create.krnl, create.math.constantIndex(blockedJ),
+          vecEnd - blockedJ, /*simd=*/true);
+    if (J > vecEnd)
+      emitColumns(create.krnl, create.math.constantIndex(vecEnd), J - vecEnd,
+          /*simd=*/false);
+  }
+
   // Handle the cases with 2x2 matrices both for A, B, and C without
   // broadcast. Implementation here uses the efficient 1d tiling plus kernel
   // substitution.
-  void replace2x2Matmul2d(ONNXMatMulOpAdaptor &operandAdaptor, Type elementType,
-      ONNXMatMulOpShapeHelper &shapeHelper, Value alloc, Value zeroVal,
-      ConversionPatternRewriter &rewriter, Location loc) const {
+  void replace2x2Matmul2d(Value A, Value B, Type elementType, Value alloc,
+      Value zeroVal, ConversionPatternRewriter &rewriter, Location loc) const {
     // Prepare: loop bounds and zero
-    Value A(operandAdaptor.getA()), B(operandAdaptor.getB()), C(alloc);
-    MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, VectorBuilder>
+    Value C(alloc);
+    MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, VectorBuilder,
+        SCFBuilder>
         create(rewriter, loc);
     Value zero = create.math.constantIndex(0);
     Value I = create.mem.dim(C, 0);
@@ -252,29 +459,67 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
       computeTileSizeForMatVectProduct(
           mVL, dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
     } else {
+      int64_t mVL = create.vec.getMachineVectorLength(elementType);
       computeTileSizeForMatMatProduct(
-          dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
+          mVL, dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
     }
 
-    // I, J, K loop.
-    ValueRange origLoop = create.krnl.defineLoops(3);
-    Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
-    // Define blocked loop and permute.
-    ValueRange iRegBlock = create.krnl.block(ii, iRegTile);
-    Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
-    ValueRange jRegBlock = create.krnl.block(jj, jRegTile);
-    Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
-    ValueRange kRegBlock = create.krnl.block(kk, kRegTile);
-    Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
-    create.krnl.permute({ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
-    create.krnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {zero, zero, zero},
-        {I, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
-          Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
-          createKrnl.matmul(A, {zero, zero}, B, {zero, zero}, C, {zero, zero},
-              {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
-              {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
-              /*unroll*/ true, /*overCompute*/ false);
-        });
+    // Emit the tiled I, J, K loops computing rows [iLB, iUB) of C.
+    auto emitTiledMatmul = [&](KrnlBuilder &createKrnl, Value iLB, Value iUB) {
+      // I, J, K loop.
+      ValueRange origLoop = createKrnl.defineLoops(3);
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      // Define blocked loop and permute.
+      ValueRange iRegBlock = createKrnl.block(ii, iRegTile);
+      Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
+      ValueRange jRegBlock = createKrnl.block(jj, jRegTile);
+      Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
+      ValueRange kRegBlock = createKrnl.block(kk, kRegTile);
+      Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
+      createKrnl.permute({ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
+      createKrnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {iLB, zero, zero},
+          {iUB, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
+            createKrnl.matmul(A, {zero, zero}, B, {zero, zero}, C,
+                {zero, zero}, {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
+                {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
+                /*unroll*/ true, /*overCompute*/ false);
+          });
+    };
+
+    if (enableParallel) {
+      // Distribute the blocks of iRegTile rows of C among the threads. Each
+      // block writes a disjoint set of rows of C, so no synchronization is
+      // needed.
+      Value iStep = create.math.constantIndex(iRegTile);
+      create.scf.parallelLoop({zero}, {I}, {iStep},
+          [&](SCFBuilder &createSCF, ValueRange parIndices) {
+            emitMatmulInParallelRegion(createSCF, parIndices[0], iStep, I,
+                [&](KrnlBuilder &createKrnl, Value iLB, Value iUB) {
+                  emitTiledMatmul(createKrnl, iLB, iUB);
+                });
+          });
+    } else {
+      emitTiledMatmul(create.krnl, zero, I);
+    }
+  }
+
+  // Emit, within the body of a parallel loop, a krnl.region hosting the Krnl
+  // loops that compute the current block of rows [iLB, min(iLB+iStep, I)).
+  // The region is an affine scope, so the induction variable of the parallel
+  // loop can be used as a symbol by the affine loops generated from Krnl.
+  void emitMatmulInParallelRegion(SCFBuilder &createSCF, Value iLB, Value iStep,
+      Value I,
+      function_ref<void(KrnlBuilder &createKrnl, Value iLB, Value iUB)>
+          bodyFn) const {
+    OpBuilder &builder = createSCF.getBuilder();
+    Location loc = createSCF.getLoc();
+    KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+    OpBuilder::InsertionGuard insertGuard(builder);
+    builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+    Value iUB = create.math.min(create.math.add(iLB, iStep), I);
+    bodyFn(create.krnl, iLB, iUB);
   }
 
   // Handle the cases with 2x2 matrices with broadcasting.
@@ -284,17 +529,19 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
   // broadcasting ranks. In such case, sameStaticBroadcast is true, and the
   // value of broadcastingB does not matter as they treated as both
   // broadcasting.
-  void replace2x2Matmul2dBroadcasting(ONNXMatMulOpAdaptor &operandAdaptor,
-      Type elementType, ONNXMatMulOpShapeHelper &shapeHelper,
-      bool broadcastingB, bool sameStaticBroadcast, Value alloc, Value zeroVal,
+  template <typename ShapeHelperType>
+  void replace2x2Matmul2dBroadcasting(Value A, Value B, Type elementType,
+      ShapeHelperType &shapeHelper, bool broadcastingB,
+      bool sameStaticBroadcast, Value alloc, Value zeroVal,
       ConversionPatternRewriter &rewriter, Location loc) const {
     // Prepare: loop bounds and zero
-    Value A(operandAdaptor.getA()), B(operandAdaptor.getB()), C(alloc);
+    Value C(alloc);
     int64_t ARank = shapeHelper.aDims.size();
     int64_t BRank = shapeHelper.bDims.size();
     int64_t broadcastRank = (broadcastingB ? BRank : ARank) - 2;
     assert(broadcastRank > 0 && "expected broadcast dims for A or B");
-    MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, VectorBuilder>
+    MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, VectorBuilder,
+        SCFBuilder>
         create(rewriter, loc);
     Value zero = create.math.constantIndex(0);
     Value I = create.mem.dim(C, broadcastRank + 0); // C has broadcast.
@@ -321,115 +568,129 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
       computeTileSizeForMatVectProduct(
           mVL, dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
     } else {
+      int64_t mVL = create.vec.getMachineVectorLength(elementType);
       computeTileSizeForMatMatProduct(
-          dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
+          mVL, dimI, dimJ, dimK, iRegTile, jRegTile, kRegTile, simdize);
     }
 
+    // Emit the tiled I, J, K loops computing rows [iLB, iUB) of the C matrix
+    // selected by broadcastIndices.
+    auto emitTiledMatmul = [&](KrnlBuilder &createKrnl,
+                               ValueRange broadcastIndices, Value iLB,
+                               Value iUB) {
+      MultiDialectBuilder<KrnlBuilder> create(createKrnl);
+      // I, J, K loop.
+      ValueRange origLoop = create.krnl.defineLoops(3);
+      // IJK indices.
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      // Define blocked loop and permute.
+      ValueRange iRegBlock = create.krnl.block(ii, iRegTile);
+      Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
+      ValueRange jRegBlock = create.krnl.block(jj, jRegTile);
+      Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
+      ValueRange kRegBlock = create.krnl.block(kk, kRegTile);
+      Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
+      create.krnl.permute(
+          {ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
+      create.krnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {iLB, zero, zero},
+          {iUB, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
+            // Compute global start for B/C: {broadcastIndices, 0, 0}
+            SmallVector<Value, 4> broadcastGlobalStart;
+            for (int64_t i = 0; i < broadcastRank; ++i)
+              broadcastGlobalStart.emplace_back(broadcastIndices[i]);
+            broadcastGlobalStart.emplace_back(zero);
+            broadcastGlobalStart.emplace_back(zero);
+            if (sameStaticBroadcast) {
+              // Each of A, B, & C starts at broadcastGlobalStart.
+              createKrnl.matmul(A, broadcastGlobalStart, B,
+                  broadcastGlobalStart, C, broadcastGlobalStart,
+                  {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
+                  {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
+                  /*unroll*/ true, /*overCompute*/ false);
+            } else if (broadcastingB) {
+              // B & C start at broadcastGlobalStart, A starts at {0,0}.
+              createKrnl.matmul(A, {zero, zero}, B, broadcastGlobalStart, C,
+                  broadcastGlobalStart, {ii2, jj2, kk2}, {i1, j1, k1},
+                  {I, J, K}, {iRegTile, jRegTile, kRegTile}, {}, {}, {},
+                  simdize, /*unroll*/ true, /*overCompute*/ false);
+            } else {
+              // A & C start at broadcastGlobalStart, B starts at {0,0}.
+              createKrnl.matmul(A, broadcastGlobalStart, B, {zero, zero}, C,
+                  broadcastGlobalStart, {ii2, jj2, kk2}, {i1, j1, k1},
+                  {I, J, K}, {iRegTile, jRegTile, kRegTile}, {}, {}, {},
+                  simdize, /*unroll*/ true, /*overCompute*/ false);
+            }
+          });
+    };
+
     // Broadcast loops
-    ValueRange broadcastLoop = create.krnl.defineLoops(broadcastRank);
     SmallVector<Value, 4> broadcastLB(broadcastRank, zero);
     SmallVector<Value, 4> broadcastUB;
     for (int64_t i = 0; i < broadcastRank; ++i)
       broadcastUB.emplace_back(create.mem.dim(C, i));
-    create.krnl.iterate(broadcastLoop, broadcastLoop, broadcastLB, broadcastUB,
-        [&](KrnlBuilder &createKrnl, ValueRange broadcastIndices) {
-          MultiDialectBuilder<KrnlBuilder> create(createKrnl);
-          // I, J, K loop.
-          ValueRange origLoop = create.krnl.defineLoops(3);
-          // IJK indices.
-          Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
-          // Define blocked loop and permute.
-          ValueRange iRegBlock = create.krnl.block(ii, iRegTile);
-          Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
-          ValueRange jRegBlock = create.krnl.block(jj, jRegTile);
-          Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
-          ValueRange kRegBlock = create.krnl.block(kk, kRegTile);
-          Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
-          create.krnl.permute(
-              {ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
-          create.krnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {zero, zero, zero},
-              {I, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
-                Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
-                // Compute global start for B/C: {broadcastIndices, 0, 0}
-                SmallVector<Value, 4> broadcastGlobalStart;
-                for (int64_t i = 0; i < broadcastRank; ++i)
-                  broadcastGlobalStart.emplace_back(broadcastIndices[i]);
-                broadcastGlobalStart.emplace_back(zero);
-                broadcastGlobalStart.emplace_back(zero);
-                if (sameStaticBroadcast) {
-                  // Each of A, B, & C starts at broadcastGlobalStart.
-                  createKrnl.matmul(A, broadcastGlobalStart, B,
-                      broadcastGlobalStart, C, broadcastGlobalStart,
-                      {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
-                      {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
-                      /*unroll*/ true, /*overCompute*/ false);
-                } else if (broadcastingB) {
-                  // B & C start at broadcastGlobalStart, A starts at {0,0}.
-                  createKrnl.matmul(A, {zero, zero}, B, broadcastGlobalStart, C,
-                      broadcastGlobalStart, {ii2, jj2, kk2}, {i1, j1, k1},
-                      {I, J, K}, {iRegTile, jRegTile, kRegTile}, {}, {}, {},
-                      simdize, /*unroll*/ true, /*overCompute*/ false);
-                } else {
-                  // A & C start at broadcastGlobalStart, B starts at {0,0}.
-                  createKrnl.matmul(A, broadcastGlobalStart, B, {zero, zero}, C,
-                      broadcastGlobalStart, {ii2, jj2, kk2}, {i1, j1, k1},
-                      {I, J, K}, {iRegTile, jRegTile, kRegTile}, {}, {}, {},
-                      simdize, /*unroll*/ true, /*overCompute*/ false);
-                }
-              });
-        });
+    if (enableParallel) {
+      // Distribute both the broadcast dimensions and the blocks of iRegTile
+      // rows of each C matrix among the threads, so that there is enough
+      // parallelism even when the broadcast dimensions are small.
+      Value one = create.math.constantIndex(1);
+      Value iStep = create.math.constantIndex(iRegTile);
+      SmallVector<Value, 4> parLB(broadcastLB), parUB(broadcastUB);
+      SmallVector<Value, 4> parSteps(broadcastRank, one);
+      parLB.emplace_back(zero);
+      parUB.emplace_back(I);
+      parSteps.emplace_back(iStep);
+      create.scf.parallelLoop(parLB, parUB, parSteps,
+          [&](SCFBuilder &createSCF, ValueRange parIndices) {
+            ValueRange broadcastIndices = parIndices.take_front(broadcastRank);
+            emitMatmulInParallelRegion(createSCF, parIndices[broadcastRank],
+                iStep, I, [&](KrnlBuilder &createKrnl, Value iLB, Value iUB) {
+                  emitTiledMatmul(createKrnl, broadcastIndices, iLB, iUB);
+                });
+          });
+    } else {
+      ValueRange broadcastLoop = create.krnl.defineLoops(broadcastRank);
+      create.krnl.iterate(broadcastLoop, broadcastLoop, broadcastLB,
+          broadcastUB,
+          [&](KrnlBuilder &createKrnl, ValueRange broadcastIndices) {
+            emitTiledMatmul(createKrnl, broadcastIndices, zero, I);
+          });
+    }
   }
 
   // Handle the cases with 2x2 matrices both for A, B, and C without
   // broadcast, broadcast of A to rank 2 B,  broadcast of B to rank 2 A, or
   // static, identical shaped broadcasting size A & B.
   // Implementation here uses the efficient 2d tiling plus kernel substitution.
-  LogicalResult matchAndRewrite(ONNXMatMulOp matMulOp,
-      ONNXMatMulOpAdaptor adaptor,
-      ConversionPatternRewriter &rewriter) const final {
-    Operation *op = matMulOp.getOperation();
-    ValueRange operands = adaptor.getOperands();
-    Location loc = ONNXLoc<ONNXMatMulOp>(op);
-    MultiDialectBuilder<IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>
-        create(rewriter, loc);
-
-    // Get shape.
-    ONNXMatMulOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
-    shapeHelper.computeShapeAndAssertOnFailure();
-
-    // Convert the output type to MemRefType.
-    Type convertedType = typeConverter->convertType(*op->result_type_begin());
-    assert(convertedType && convertedType.isa<MemRefType>() &&
-           "Failed to convert type to MemRefType");
-    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
-
-    // Insert an allocation and deallocation for the output of this operation.
-    Type elementType = outputMemRefType.getElementType();
-    Value alloc =
-        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
-
+  // Other cases are handled by the generic implementation.
+  template <typename ShapeHelperType>
+  void emitMatmul(Value A, Value B, Type elementType,
+      ShapeHelperType &shapeHelper, Value alloc,
+      ConversionPatternRewriter &rewriter, Location loc) const {
+    MultiDialectBuilder<MathBuilder, VectorBuilder> create(rewriter, loc);
     // Get the constants: zero.
     Value zero = create.math.constant(elementType, 0);
 
-    Value A(adaptor.getA()), B(adaptor.getB());
     int aRank = A.getType().cast<MemRefType>().getShape().size();
     int bRank = B.getType().cast<MemRefType>().getShape().size();
     int cRank = alloc.getType().cast<MemRefType>().getShape().size();
-    if (enableTiling && aRank == 2 && bRank == 2) {
+    if (int64_t M = getSmallMRows(A, B, elementType, create.vec)) {
+      // Few rows of A, e.g. a fully connected layer of batch 1.
+      replaceSmallMMatmul(A, B, elementType, M, alloc, zero, rewriter, loc);
+    } else if (enableTiling && aRank == 2 && bRank == 2) {
       // Optimized Matmul only when 2D and allowed to tile and unroll.
       assert(cRank == 2 && "expected IxK * KxJ = IxJ 2D result");
-      replace2x2Matmul2d(
-          adaptor, elementType, shapeHelper, alloc, zero, rewriter, loc);
+      replace2x2Matmul2d(A, B, elementType, alloc, zero, rewriter, loc);
     } else if (enableTiling && aRank == 2 && bRank > 2) {
       // Broadcasting B.
       assert(cRank == bRank && "expected IxK * *xKxJ = *xIxJ result");
-      replace2x2Matmul2dBroadcasting(adaptor, elementType, shapeHelper,
+      replace2x2Matmul2dBroadcasting(A, B, elementType, shapeHelper,
           /*broadcasting B*/ true,
           /*same static broadcast*/ false, alloc, zero, rewriter, loc);
     } else if (enableTiling && aRank > 2 && bRank == 2) {
       // Broadcasting A.
       assert(cRank == aRank && "expected IxK * *xKxJ = *xIxJ result");
-      replace2x2Matmul2dBroadcasting(adaptor, elementType, shapeHelper,
+      replace2x2Matmul2dBroadcasting(A, B, elementType, shapeHelper,
           /*broadcasting B*/ false,
           /*same static broadcast*/ false, alloc, zero, rewriter, loc);
     } else {
@@ -448,23 +709,381 @@ struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp> {
       // same logic as in replace2x2Matmul2dBroadcasting. So reuse that code.
       if (sameStaticBroadcast) {
         assert(cRank == aRank && "expected IxK * *xKxJ = *xIxJ result");
-        replace2x2Matmul2dBroadcasting(adaptor, elementType, shapeHelper,
+        replace2x2Matmul2dBroadcasting(A, B, elementType, shapeHelper,
             /*broadcasting B*/ true,
             /*same static broadcast*/ true, alloc, zero, rewriter, loc);
       } else {
         replaceGenericMatmul(
-            adaptor, elementType, shapeHelper, alloc, zero, rewriter, loc);
+            A, B, elementType, shapeHelper, alloc, zero, rewriter, loc);
       }
     }
+  }
+};
+
+// Return true if the cast widens a half precision tensor to f32 for MatMul ops
+// only, as their B operand. These MatMul ops read the half precision tensor and
+// widen its elements when loading them, so that the f32 tensor is never
+// materialized.
+static bool isWidenedOnLoad(ONNXCastOp castOp) {
+  Value output = castOp.getOutput();
+  Type inputElementType = getElementType(castOp.getInput().getType());
+  if (!getElementType(output.getType()).isF32() ||
+      !(inputElementType.isF16() || inputElementType.isBF16()) ||
+      output.use_empty())
+    return false;
+  return llvm::all_of(output.getUses(), [&](OpOperand &use) {
+    auto matMulOp = dyn_cast<ONNXMatMulOp>(use.getOwner());
+    return matMulOp && use.getOperandNumber() == 1 &&
+           matMulOp.getA() != output;
+  });
+}
+
+// The casts widened on load by the MatMul ops are replaced by a placeholder,
+// left dead once the MatMul ops are lowered.
+struct ONNXWidenedOnLoadCastOpLowering
+    : public OpConversionPattern<ONNXCastOp> {
+  ONNXWidenedOnLoadCastOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/2) {}
+
+  LogicalResult matchAndRewrite(ONNXCastOp castOp, ONNXCastOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    if (!isWidenedOnLoad(castOp))
+      return failure();
+    Type convertedType = typeConverter->convertType(castOp.getType());
+    if (!convertedType || !adaptor.getInput().getType().isa<MemRefType>())
+      return failure();
+    rewriter.replaceOpWithNewOp<UnrealizedConversionCastOp>(
+        castOp, convertedType, adaptor.getInput());
+    return success();
+  }
+};
+
+// Return true if the DequantizeLinear dequantizes int8 weights of rank 2 or
+// more to f32, with one f32 scale per column and no zero point, for MatMul ops
+// only, as their B operand. These MatMul ops read the int8 weights and widen
+// them when loading them, then scale the columns of their result, so that the
+// f32 weights are never materialized.
+static bool isDequantizedOnLoad(ONNXDequantizeLinearOp dequantizeOp) {
+  Value output = dequantizeOp.getY();
+  auto xType = dequantizeOp.getX().getType().dyn_cast<RankedTensorType>();
+  auto scaleType =
+      dequantizeOp.getXScale().getType().dyn_cast<RankedTensorType>();
+  if (!xType || !xType.getElementType().isInteger(8) || xType.getRank() < 2 ||
+      !scaleType || scaleType.getRank() != 1 ||
+      !scaleType.getElementType().isF32() ||
+      !getElementType(output.getType()).isF32() ||
+      !isFromNone(dequantizeOp.getXZeroPoint()) || output.use_empty())
+    return false;
+  int64_t rank = xType.getRank();
+  int64_t axis = dequantizeOp.getAxis();
+  if (axis != rank - 1 && axis != -1)
+    return false;
+  return llvm::all_of(output.getUses(), [&](OpOperand &use) {
+    auto matMulOp = dyn_cast<ONNXMatMulOp>(use.getOwner());
+    return matMulOp && use.getOperandNumber() == 1 &&
+           matMulOp.getA() != output;
+  });
+}
+
+// The dequantizations on load of the MatMul ops are replaced by a
+// placeholder, left dead once the MatMul ops are lowered.
+struct ONNXDequantizedOnLoadOpLowering
+    : public OpConversionPattern<ONNXDequantizeLinearOp> {
+  ONNXDequantizedOnLoadOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/2) {}
+
+  LogicalResult matchAndRewrite(ONNXDequantizeLinearOp dequantizeOp,
+      ONNXDequantizeLinearOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    if (!isDequantizedOnLoad(dequantizeOp))
+      return failure();
+    Type convertedType = typeConverter->convertType(dequantizeOp.getType());
+    if (!convertedType || !adaptor.getX().getType().isa<MemRefType>())
+      return failure();
+    rewriter.replaceOpWithNewOp<UnrealizedConversionCastOp>(
+        dequantizeOp, convertedType, adaptor.getX());
+    return success();
+  }
+};
+
+// Multiply in place each element of C by the scale of its column.
+static void emitColumnScaling(ConversionPatternRewriter &rewriter,
+    Location loc, Value C, Value scale) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl> create(
+      rewriter, loc);
+  int64_t rank = C.getType().cast<MemRefType>().getRank();
+  DimsExpr ubs;
+  create.krnlIE.getShapeAsDims(C, ubs);
+  ValueRange loopDef = create.krnl.defineLoops(rank);
+  SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+  create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+        Value c = create.krnl.load(C, loopInd);
+        Value s = create.krnl.load(scale, {loopInd[rank - 1]});
+        create.krnl.store(create.math.mul(c, s), C, loopInd);
+      });
+}
+
+struct ONNXMatMulOpLowering : public OpConversionPattern<ONNXMatMulOp>,
+                              MatMulLoweringBase {
+  ONNXMatMulOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel, const MatMulTileDB *tileDB,
+      int64_t sparseWeightThreshold)
+      : OpConversionPattern(typeConverter, ctx),
+        MatMulLoweringBase(enableTiling, enableParallel, tileDB),
+        sparseWeightThreshold(sparseWeightThreshold) {}
+  // Minimum percentage of zero blocks of a constant B for it to be
+  // multiplied in its block-sparse form.
+  int64_t sparseWeightThreshold;
+
+  LogicalResult matchAndRewrite(ONNXMatMulOp matMulOp,
+      ONNXMatMulOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = matMulOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXMatMulOp>(op);
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
+        rewriter, loc);
+
+    // Get shape.
+    ONNXMatMulOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+
+    // Insert an allocation and deallocation for the output of this operation.
+    Type elementType = outputMemRefType.getElementType();
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
+
+    // Pruned constant weights of a matrix by matrix product are multiplied in
+    // their block-sparse form, by blocks of one vector.
+    int64_t aRank = adaptor.getA().getType().cast<MemRefType>().getRank();
+    if (enableTiling && elementType.isF32() && aRank >= 2) {
+      MultiDialectBuilder<VectorBuilder> createVec(rewriter, loc);
+      int64_t VL = createVec.vec.getMachineVectorLength(elementType);
+      if (Optional<BlockSparseMatrix> sparseB = getBlockSparseConstant(
+              adaptor.getB(), /*bTrans=*/false, VL, sparseWeightThreshold)) {
+        emitBlockSparseMatMul(rewriter, loc, adaptor.getA(), /*aTrans=*/false,
+            *sparseB, alloc, enableParallel);
+        rewriter.replaceOp(op, alloc);
+        return success();
+      }
+    }
+
+    // Read the half precision B of a cast widened on load.
+    Value B = adaptor.getB();
+    if (auto castOp = matMulOp.getB().getDefiningOp<ONNXCastOp>()) {
+      Value halfB = rewriter.getRemappedValue(castOp.getInput());
+      if (isWidenedOnLoad(castOp) && halfB && halfB.getType().isa<MemRefType>())
+        B = halfB;
+    }
+    // Read the int8 B of a dequantization on load, whose scales are applied to
+    // the columns of the result.
+    Value bScale;
+    if (auto dequantizeOp =
+            matMulOp.getB().getDefiningOp<ONNXDequantizeLinearOp>()) {
+      Value quantizedB = rewriter.getRemappedValue(dequantizeOp.getX());
+      Value scale = rewriter.getRemappedValue(dequantizeOp.getXScale());
+      if (isDequantizedOnLoad(dequantizeOp) && elementType.isF32() &&
+          quantizedB && quantizedB.getType().isa<MemRefType>() && scale &&
+          scale.getType().isa<MemRefType>()) {
+        B = quantizedB;
+        bScale = scale;
+      }
+    }
+    emitMatmul(
+        adaptor.getA(), B, elementType, shapeHelper, alloc, rewriter, loc);
+    if (bScale)
+      emitColumnScaling(rewriter, loc, alloc, bScale);
+    // Done.
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+// Returns a copy of the quantized X converted to i32, minus its zero point.
+// The zero point is per tensor, or per index along axis of X.
+static Value emitZeroPointShift(ConversionPatternRewriter &rewriter,
+    Location loc, Value X, Value zeroPoint, int64_t axis) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+      MemRefBuilder>
+      create(rewriter, loc);
+  Type i32Type = rewriter.getI32Type();
+  MemRefType xType = X.getType().cast<MemRefType>();
+  MemRefType shiftedType = MemRefType::get(xType.getShape(), i32Type);
+  Value shifted = create.mem.alignedAlloc(X, shiftedType);
+  DimsExpr ubs;
+  create.krnlIE.getShapeAsDims(X, ubs);
+  int64_t rank = xType.getRank();
+  ValueRange loopDef = create.krnl.defineLoops(rank);
+  SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+  create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+        Value x = create.math.cast(i32Type, create.krnl.load(X, loopInd));
+        Value zeroPointVal = loadQuantizationParameter(
+            rewriter, loc, zeroPoint, loopInd, axis, i32Type);
+        create.krnl.store(create.math.sub(x, zeroPointVal), shifted, loopInd);
+      });
+  return shifted;
+}
+
+// Axis of the per-row zero points and scales of A.
+static int64_t getRowAxis(Value A) {
+  return std::max<int64_t>(A.getType().cast<MemRefType>().getRank() - 2, 0);
+}
+
+// Axis of the per-column zero points and scales of B.
+static int64_t getColumnAxis(Value B) {
+  return B.getType().cast<MemRefType>().getRank() - 1;
+}
+
+struct ONNXMatMulIntegerOpLowering
+    : public OpConversionPattern<ONNXMatMulIntegerOp>,
+      MatMulLoweringBase {
+  ONNXMatMulIntegerOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel, const MatMulTileDB *tileDB)
+      : OpConversionPattern(typeConverter, ctx),
+        MatMulLoweringBase(enableTiling, enableParallel, tileDB) {}
+
+  LogicalResult matchAndRewrite(ONNXMatMulIntegerOp matMulIntegerOp,
+      ONNXMatMulIntegerOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = matMulIntegerOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXMatMulIntegerOp>(op);
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
+        rewriter, loc);
+
+    // Get shape.
+    ONNXMatMulIntegerOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+
+    // Insert an allocation and deallocation for the output of this operation.
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
+
+    // Multiply and accumulate in i32 the inputs minus their zero points.
+    Value A = adaptor.getA(), B = adaptor.getB();
+    Value shiftedA = emitZeroPointShift(
+        rewriter, loc, A, adaptor.getAZeroPoint(), getRowAxis(A));
+    Value shiftedB = emitZeroPointShift(
+        rewriter, loc, B, adaptor.getBZeroPoint(), getColumnAxis(B));
+    emitMatmul(shiftedA, shiftedB, rewriter.getI32Type(), shapeHelper, alloc,
+        rewriter, loc);
+    // Done.
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+struct ONNXQLinearMatMulOpLowering
+    : public OpConversionPattern<ONNXQLinearMatMulOp>,
+      MatMulLoweringBase {
+  ONNXQLinearMatMulOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel, const MatMulTileDB *tileDB)
+      : OpConversionPattern(typeConverter, ctx),
+        MatMulLoweringBase(enableTiling, enableParallel, tileDB) {}
+
+  LogicalResult matchAndRewrite(ONNXQLinearMatMulOp qlinearMatMulOp,
+      ONNXQLinearMatMulOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    using LocalDialectBuilder = MultiDialectBuilder<KrnlBuilder,
+        IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>;
+    Operation *op = qlinearMatMulOp.getOperation();
+    ValueRange operands = adaptor.getOperands();
+    Location loc = ONNXLoc<ONNXQLinearMatMulOp>(op);
+    LocalDialectBuilder create(rewriter, loc);
+
+    // Get shape.
+    ONNXQLinearMatMulOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    DimsExpr outputDims = shapeHelper.getOutputDims();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    Type quantizedType = outputMemRefType.getElementType();
+    Type i32Type = rewriter.getI32Type();
+    Type floatType = rewriter.getF32Type();
+
+    // Insert an allocation and deallocation for the output of this operation,
+    // and for the i32 accumulations.
+    Value alloc = create.mem.alignedAlloc(outputMemRefType, outputDims);
+    MemRefType accType = MemRefType::get(outputMemRefType.getShape(), i32Type);
+    Value acc = create.mem.alignedAlloc(accType, outputDims);
+
+    // Multiply and accumulate in i32 the inputs minus their zero points.
+    Value A = adaptor.getA(), B = adaptor.getB();
+    Value shiftedA = emitZeroPointShift(
+        rewriter, loc, A, adaptor.getAZeroPoint(), getRowAxis(A));
+    Value shiftedB = emitZeroPointShift(
+        rewriter, loc, B, adaptor.getBZeroPoint(), getColumnAxis(B));
+    emitMatmul(shiftedA, shiftedB, i32Type, shapeHelper, acc, rewriter, loc);
+
+    // Requantize the accumulations:
+    // y = saturate(round(acc * a_scale * b_scale / y_scale) + y_zero_point).
+    int64_t rank = outputMemRefType.getRank();
+    int64_t rowAxis = std::max<int64_t>(rank - 2, 0);
+    int64_t columnAxis = rank - 1;
+    auto computeResult = [&](LocalDialectBuilder &create, ValueRange loopInd) {
+      Value x = create.math.cast(floatType, create.krnl.load(acc, loopInd));
+      Value aScale = loadQuantizationParameter(
+          rewriter, loc, adaptor.getAScale(), loopInd, rowAxis, floatType);
+      Value bScale = loadQuantizationParameter(
+          rewriter, loc, adaptor.getBScale(), loopInd, columnAxis, floatType);
+      Value yScale = loadQuantizationParameter(
+          rewriter, loc, adaptor.getYScale(), loopInd, rowAxis, floatType);
+      Value yZeroPoint = loadQuantizationParameter(
+          rewriter, loc, adaptor.getYZeroPoint(), loopInd, rowAxis, floatType);
+      x = create.math.mul(x, create.math.mul(aScale, bScale));
+      Value y = emitQuantizeLinearScalar(
+          rewriter, loc, op, x, yScale, yZeroPoint, quantizedType);
+      create.krnl.store(y, alloc, loopInd);
+    };
+    if (rank > 0) {
+      ValueRange loopDef = create.krnl.defineLoops(rank);
+      SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+      create.krnl.iterateIE(loopDef, loopDef, lbs, outputDims,
+          [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+            LocalDialectBuilder create(createKrnl);
+            computeResult(create, loopInd);
+          });
+    } else {
+      computeResult(create, {});
+    }
     // Done.
     rewriter.replaceOp(op, alloc);
     return success();
   }
-}; // namespace onnx_mlir
+};
 
 void populateLoweringONNXMatMulOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling) {
-  patterns.insert<ONNXMatMulOpLowering>(typeConverter, ctx, enableTiling);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling,
+    bool enableParallel, const MatMulTileDB *tileDB,
+    int64_t sparseWeightThreshold) {
+  patterns.insert<ONNXMatMulOpLowering>(typeConverter, ctx, enableTiling,
+      enableParallel, tileDB, sparseWeightThreshold);
+  patterns.insert<ONNXMatMulIntegerOpLowering, ONNXQLinearMatMulOpLowering>(
+      typeConverter, ctx, enableTiling, enableParallel, tileDB);
+  patterns.insert<ONNXWidenedOnLoadCastOpLowering,
+      ONNXDequantizedOnLoadOpLowering>(typeConverter, ctx);
 }
 
 } // namespace onnx_mlir
@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- RandomUniform.cpp - Lowering RandomUniform Op -------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX RandomUniform and RandomUniformLike Operators to
+// calls of the random generator of the runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+// The random generator of the runtime supports float and double tensors.
+static bool isSupportedRandomType(Type elementType) {
+  return elementType.isF32() || elementType.isF64();
+}
+
+struct ONNXRandomUniformOpLowering
+    : public OpConversionPattern<ONNXRandomUniformOp> {
+  ONNXRandomUniformOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+  LogicalResult matchAndRewrite(ONNXRandomUniformOp randOp,
+      ONNXRandomUniformOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = randOp.getOperation();
+    Location loc = ONNXLoc<ONNXRandomUniformOp>(op);
+    MultiDialectBuilder<MemRefBuilder> create(rewriter, loc);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    if (!isSupportedRandomType(outputMemRefType.getElementType()))
+      return emitError(loc, "not implemented yet");
+
+    // The shape of the output is given by an attribute, hence static.
+    Value alloc = create.mem.alignedAlloc(outputMemRefType);
+    emitRandomUniform(rewriter, loc, alloc,
+        adaptor.getLow().convertToDouble(), adaptor.getHigh().convertToDouble(),
+        adaptor.getSeed());
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+struct ONNXRandomUniformLikeOpLowering
+    : public OpConversionPattern<ONNXRandomUniformLikeOp> {
+  ONNXRandomUniformLikeOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+  LogicalResult matchAndRewrite(ONNXRandomUniformLikeOp randOp,
+      ONNXRandomUniformLikeOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = randOp.getOperation();
+    Location loc = ONNXLoc<ONNXRandomUniformLikeOp>(op);
+    Value input = adaptor.getInput();
+    MultiDialectBuilder<MemRefBuilder> create(rewriter, loc);
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    if (!isSupportedRandomType(outputMemRefType.getElementType()))
+      return emitError(loc, "not implemented yet");
+
+    // The output has the shape of the input.
+    Value alloc = create.mem.alignedAlloc(input, outputMemRefType);
+    emitRandomUniform(rewriter, loc, alloc,
+        adaptor.getLow().convertToDouble(), adaptor.getHigh().convertToDouble(),
+        adaptor.getSeed());
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXRandomUniformOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXRandomUniformOpLowering,
+      ONNXRandomUniformLikeOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -179,15 +179,294 @@ Value emitScalarOpFor<ONNXReduceMinOp>(ConversionPatternRewriter &rewriter,
   return createMath.select(min, lhs, rhs);
 }
 
+//===----------------------------------------------------------------------===//
+// SIMD and parallel reductions of static float tensors.
+//===----------------------------------------------------------------------===//
+
+// Number of values of the input of a full reduction reduced by each thread
+// into a partial result when the reduction is parallelized.
+static constexpr int64_t kReductionParallelChunk = 16384;
+
+// Kind of the vector.reduction combining the lanes of a vector accumulator.
+template <typename ONNXReductionOp>
+struct ReductionCombiningKind {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::ADD;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceMaxV13Op> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MAXF;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceMaxOp> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MAXF;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceMinV13Op> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MINF;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceMinOp> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MINF;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceProdV13Op> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MUL;
+};
+template <>
+struct ReductionCombiningKind<ONNXReduceProdOp> {
+  static constexpr vector::CombiningKind value = vector::CombiningKind::MUL;
+};
+
+// Reduce the `size` values of the 1-D memref `input` starting at `offset`, and
+// return the result. Blocks of VL values are reduced into the vector
+// accumulator `vecAcc` whose lanes are combined at the end, the last partial
+// block being loaded with the identity in its lanes past the end. When not
+// given, the accumulator is allocated here.
+template <typename ONNXReductionOp>
+static Value emitSimdAccumulation(ConversionPatternRewriter &rewriter,
+    Location loc, Operation *op, Value input, Value offset, IndexExpr size,
+    int64_t VL, Value vecAcc = nullptr) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, VectorBuilder>
+      create(rewriter, loc);
+  Type elementType = input.getType().cast<MemRefType>().getElementType();
+  VectorType vecType = VectorType::get({VL}, elementType);
+  Value identity =
+      getIdentityValue<ONNXReductionOp>(rewriter, loc, elementType);
+  Value iZero = create.math.constantIndex(0);
+
+  if (!vecAcc)
+    vecAcc = create.mem.alignedAlloca(MemRefType::get({VL}, elementType));
+  create.vec.store(create.vec.splat(vecType, identity), vecAcc, {iZero});
+  emitSimdLoopWithMaskedTail(
+      create.krnl, size, VL, [&](KrnlBuilder &ck, Value index, Value mask) {
+        MultiDialectBuilder<MathBuilder, VectorBuilder> create(ck);
+        Value x = loadScalarOrVector(ck, vecType, input,
+            {create.math.add(offset, index)}, mask, identity);
+        Value accumulated = create.vec.load(vecType, vecAcc, {iZero});
+        accumulated = emitScalarOpFor<ONNXReductionOp>(
+            rewriter, loc, op, vecType, {accumulated, x});
+        create.vec.store(accumulated, vecAcc, {iZero});
+      });
+  vector::CombiningKind kind = ReductionCombiningKind<ONNXReductionOp>::value;
+  return create.vec.reduction(kind, create.vec.load(vecType, vecAcc, {iZero}));
+}
+
+// Emit SIMD code for the reduction of the static float tensor `input` along
+// `axes` into `alloc`, and return false when the reduction is not amenable to
+// it. Three cases are handled:
+// - The innermost dimension is kept: the output values along it are
+//   contiguous, so that each value of the input loops is combined with a
+//   vector of output values, e.g. for reductions over the channels of NCHW.
+// - All the values are reduced: each chunk of the flattened input is reduced
+//   into a partial result, by one thread each when `enableParallel`, and the
+//   partial results are then reduced into the output.
+// - Only the outermost dimensions are kept: each output value is the
+//   reduction of a contiguous row of the flattened input, and the rows are
+//   reduced in parallel when `enableParallel`, e.g. for GlobalAveragePool and
+//   GlobalMaxPool, that are rewritten into reductions over the spatial dims.
+// The output is finally divided by the number of values reduced into each of
+// its values when `computeMean`.
+template <typename ONNXReductionOp>
+static bool emitSimdReduction(ConversionPatternRewriter &rewriter,
+    Location loc, Operation *op, Value input, Value alloc,
+    std::map<int64_t, int64_t> &outInDimMap, bool computeMean,
+    bool enableParallel) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, SCFBuilder,
+      VectorBuilder>
+      create(rewriter, loc);
+  MemRefType inType = input.getType().cast<MemRefType>();
+  MemRefType outType = alloc.getType().cast<MemRefType>();
+  Type elementType = outType.getElementType();
+  if (!elementType.isF32() || !inType.hasStaticShape() ||
+      !outType.hasStaticShape() || hasNonIdentityLayout(input) ||
+      hasNonIdentityLayout(alloc))
+    return false;
+  int64_t inRank = inType.getRank();
+  int64_t outRank = outType.getRank();
+  int64_t inSize = inType.getNumElements();
+  int64_t outSize = outType.getNumElements();
+  if (inRank == 0 || inSize == outSize)
+    return false;
+  int64_t VL = create.vec.getMachineVectorLength(elementType);
+  VectorType vecType = VectorType::get({VL}, elementType);
+  bool keepsInnermost = outRank > 0 && outInDimMap.count(outRank - 1) &&
+                        outInDimMap[outRank - 1] == inRank - 1;
+  int64_t innerSize = inType.getShape()[inRank - 1];
+  bool isFullReduction = outSize == 1;
+  // The dims kept in the output are the outermost ones, in order.
+  bool keepsOutermost = !keepsInnermost && !outInDimMap.empty() &&
+                        outInDimMap.rbegin()->second ==
+                            (int64_t)outInDimMap.size() - 1;
+  int64_t rowSize = inSize / outSize;
+  if (!(keepsInnermost && innerSize >= VL) &&
+      !(isFullReduction && inSize >= VL) &&
+      !(keepsOutermost && rowSize >= VL))
+    return false;
+
+  IndexExprScope scope(&rewriter, loc);
+  Value iZero = create.math.constantIndex(0);
+  SmallVector<IndexExpr, 1> outFlatDims = {LiteralIndexExpr(outSize)};
+  Value allocFlat = create.mem.reinterpretCast(alloc, outFlatDims);
+  SmallVector<IndexExpr, 1> inFlatDims = {LiteralIndexExpr(inSize)};
+  Value inputFlat = create.mem.reinterpretCast(input, inFlatDims);
+  if (keepsInnermost) {
+    // Initialize the output with the identity.
+    Value identity =
+        getIdentityValue<ONNXReductionOp>(rewriter, loc, elementType);
+    Value vecIdentity = create.vec.splat(vecType, identity);
+    emitSimdLoopWithMaskedTail(create.krnl, LiteralIndexExpr(outSize), VL,
+        [&](KrnlBuilder &ck, Value index, Value mask) {
+          storeScalarOrVector(ck, vecIdentity, allocFlat, {index}, mask);
+        });
+    // Combine the rows of the input along the innermost dimension with the
+    // corresponding rows of the output.
+    ValueRange loopDef = create.krnl.defineLoops(inRank - 1);
+    SmallVector<IndexExpr, 4> lbs(inRank - 1, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs;
+    for (int64_t i = 0; i < inRank - 1; ++i)
+      ubs.emplace_back(LiteralIndexExpr(inType.getShape()[i]));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          emitSimdLoopWithMaskedTail(createKrnl, LiteralIndexExpr(innerSize),
+              VL, [&](KrnlBuilder &ck, Value col, Value mask) {
+                SmallVector<Value, 4> inInd(loopInd.begin(), loopInd.end());
+                inInd.emplace_back(col);
+                SmallVector<Value, 4> outInd(outRank, iZero);
+                for (auto &outInDim : outInDimMap)
+                  outInd[outInDim.first] = inInd[outInDim.second];
+                Value x = loadScalarOrVector(
+                    ck, vecType, input, inInd, mask, identity);
+                Value accumulated = loadScalarOrVector(
+                    ck, vecType, alloc, outInd, mask, identity);
+                accumulated = emitScalarOpFor<ONNXReductionOp>(
+                    rewriter, loc, op, vecType, {accumulated, x});
+                storeScalarOrVector(ck, accumulated, alloc, outInd, mask);
+              });
+        });
+  } else if (isFullReduction && enableParallel &&
+             inSize >= 2 * kReductionParallelChunk) {
+    // Reduce each chunk into a partial result with one thread each, then
+    // reduce the partial results.
+    int64_t numChunks = llvm::divideCeil(inSize, kReductionParallelChunk);
+    Value partials = create.mem.alignedAlloc(
+        MemRefType::get({numChunks}, elementType));
+    Value chunkVal = create.math.constantIndex(kReductionParallelChunk);
+    create.scf.parallelLoop({iZero}, {create.math.constantIndex(numChunks)},
+        {create.math.constantIndex(1)},
+        [&](SCFBuilder &createSCF, ValueRange parInd) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+          IndexExprScope chunkScope(create.krnl);
+          DimIndexExpr chunk(parInd[0]);
+          IndexExpr size = IndexExpr::min(
+              LiteralIndexExpr(inSize) - chunk * kReductionParallelChunk,
+              kReductionParallelChunk);
+          Value offset = create.math.mul(parInd[0], chunkVal);
+          Value partial = emitSimdAccumulation<ONNXReductionOp>(
+              rewriter, loc, op, inputFlat, offset, size, VL);
+          create.krnl.store(partial, partials, {parInd[0]});
+        });
+    Value res = emitSimdAccumulation<ONNXReductionOp>(rewriter, loc, op,
+        partials, iZero, LiteralIndexExpr(numChunks), VL);
+    create.krnl.store(res, allocFlat, {iZero});
+  } else if (isFullReduction) {
+    Value res = emitSimdAccumulation<ONNXReductionOp>(rewriter, loc, op,
+        inputFlat, iZero, LiteralIndexExpr(inSize), VL);
+    create.krnl.store(res, allocFlat, {iZero});
+  } else if (enableParallel) {
+    // Reduce each row into its output value with one thread each.
+    Value rowSizeVal = create.math.constantIndex(rowSize);
+    create.scf.parallelLoop({iZero}, {create.math.constantIndex(outSize)},
+        {create.math.constantIndex(1)},
+        [&](SCFBuilder &createSCF, ValueRange parInd) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+          Value offset = create.math.mul(parInd[0], rowSizeVal);
+          Value res = emitSimdAccumulation<ONNXReductionOp>(rewriter, loc, op,
+              inputFlat, offset, LiteralIndexExpr(rowSize), VL);
+          create.krnl.store(res, allocFlat, {parInd[0]});
+        });
+  } else {
+    // Reduce each row into its output value, with accumulators shared by all
+    // the rows.
+    Value vecAcc = create.mem.alignedAlloca(MemRefType::get({VL}, elementType));
+    Value rowSizeVal = create.math.constantIndex(rowSize);
+    ValueRange loopDef = create.krnl.defineLoops(1);
+    create.krnl.iterateIE(loopDef, loopDef, {LiteralIndexExpr(0)},
+        {LiteralIndexExpr(outSize)},
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+          Value offset = create.math.mul(loopInd[0], rowSizeVal);
+          Value res = emitSimdAccumulation<ONNXReductionOp>(rewriter, loc, op,
+              inputFlat, offset, LiteralIndexExpr(rowSize), VL, vecAcc);
+          create.krnl.store(res, allocFlat, {loopInd[0]});
+        });
+  }
+
+  if (computeMean) {
+    Value divisor = create.math.constant(elementType, inSize / outSize);
+    Value vecDivisor = create.vec.splat(vecType, divisor);
+    emitSimdLoopWithMaskedTail(create.krnl, LiteralIndexExpr(outSize), VL,
+        [&](KrnlBuilder &ck, Value index, Value mask) {
+          MultiDialectBuilder<MathBuilder> create(ck);
+          Value sum = loadScalarOrVector(
+              ck, vecType, allocFlat, {index}, mask, divisor);
+          Value mean = create.math.div(sum, vecDivisor);
+          storeScalarOrVector(ck, mean, allocFlat, {index}, mask);
+        });
+  }
+  return true;
+}
+
+// Factor by which the scalar reductions unroll and jam the loop over the
+// second innermost dim of the input into the innermost loop.
+static constexpr int64_t kReductionUnrollJamFactor = 4;
+
+// Unroll and jam the loop over the second innermost dim of `input` among the
+// reduction `loops`, when its static size is a multiple of the factor, so
+// that several values are reduced at a time: into independent outputs when
+// the dim is kept, or into the same outputs, loaded once, when only the
+// innermost dim is kept. The loop is left as is when both dims are reduced,
+// as jamming would change the order in which the values of an output are
+// reduced.
+static void unrollJamReductionLoop(const KrnlBuilder &createKrnl,
+    ArrayRef<Value> loops, Value input,
+    const std::map<int64_t, int64_t> &outInDimMap) {
+  ArrayRef<int64_t> shape = input.getType().cast<MemRefType>().getShape();
+  int64_t rank = shape.size();
+  if (rank < 2 || ShapedType::isDynamic(shape[rank - 2]) ||
+      shape[rank - 2] % kReductionUnrollJamFactor != 0)
+    return;
+  auto isKept = [&](int64_t inDim) {
+    return llvm::any_of(outInDimMap,
+        [&](const std::pair<const int64_t, int64_t> &outIn) {
+          return outIn.second == inDim;
+        });
+  };
+  if (!isKept(rank - 2) && !isKept(rank - 1))
+    return;
+  createKrnl.unrollJam(loops[rank - 2], kReductionUnrollJamFactor);
+}
+
 template <typename ONNXReductionOp>
 struct ONNXOldReductionOpLowering
     : public OpConversionPattern<ONNXReductionOp> {
   using OpAdaptor = typename ONNXReductionOp::Adaptor;
+  bool enableSIMD = false;
+  bool enableParallel = false;
   bool computeMean = false;
 
-  ONNXOldReductionOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool computeMean = false)
+  ONNXOldReductionOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel, bool computeMean = false)
       : OpConversionPattern<ONNXReductionOp>(typeConverter, ctx) {
+    this->enableSIMD = enableSIMD;
+    this->enableParallel = enableParallel;
     this->computeMean = computeMean;
   }
 
@@ -267,6 +546,14 @@ struct ONNXOldReductionOpLowering
     // Insert an allocation and deallocation for the result of this operation.
     Value alloc = create.mem.alignedAlloc(input, memRefOutType);
 
+    // Reductions of large enough static float tensors use SIMD code.
+    if (enableSIMD &&
+        emitSimdReduction<ONNXReductionOp>(rewriter, loc, op, input, alloc,
+            outInDimMap, computeMean, enableParallel)) {
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // There are two required and one optional Krnl loops:
     // - One to initialize the result memref,
     // - One to do reduction, and
@@ -304,6 +591,8 @@ struct ONNXOldReductionOpLowering
     auto ipMainRegion = rewriter.saveInsertionPoint();
     std::vector<Value> originalLoops;
     defineLoops(rewriter, loc, originalLoops, inRank);
+    if (enableSIMD)
+      unrollJamReductionLoop(create.krnl, originalLoops, input, outInDimMap);
     // Iteration information
     // TODO use new KrnlDialectBuilder.
     krnl::KrnlIterateOperandPack pack(rewriter, originalLoops);
@@ -395,11 +684,14 @@ struct ONNXOldReductionOpLowering
 template <typename ONNXReductionOp>
 struct ONNXReductionOpLowering : public OpConversionPattern<ONNXReductionOp> {
   using OpAdaptor = typename ONNXReductionOp::Adaptor;
+  bool enableSIMD = false;
+  bool enableParallel = false;
   bool computeMean = false;
 
-  ONNXReductionOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool computeMean = false)
+  ONNXReductionOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel, bool computeMean = false)
       : OpConversionPattern<ONNXReductionOp>(typeConverter, ctx),
+        enableSIMD(enableSIMD), enableParallel(enableParallel),
         computeMean(computeMean) {}
 
   LogicalResult matchAndRewrite(ONNXReductionOp reduceOp, OpAdaptor adaptor,
@@ -602,6 +894,15 @@ struct ONNXReductionOpLowering : public OpConversionPattern<ONNXReductionOp> {
       alloc = create.mem.alignedAlloc(memRefOutType, allocOperands);
     }
 
+    // Reductions of large enough static float tensors along constant axes use
+    // SIMD code.
+    if (enableSIMD && !dynamicAxes &&
+        emitSimdReduction<ONNXReductionOp>(rewriter, loc, op, input, alloc,
+            outInDimMap, computeMean, enableParallel)) {
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // There are two required and one optional Krnl loops:
     // - One to initialize the result memref,
     // - One to do reduction, and
@@ -640,6 +941,8 @@ struct ONNXReductionOpLowering : public OpConversionPattern<ONNXReductionOp> {
     auto ipMainRegion = rewriter.saveInsertionPoint();
     std::vector<Value> originalLoops;
     defineLoops(rewriter, loc, originalLoops, inRank);
+    if (enableSIMD && !dynamicAxes)
+      unrollJamReductionLoop(create.krnl, originalLoops, input, outInDimMap);
     // Iteration information
     // TODO use new KrnlDialectBuilder.
     krnl::KrnlIterateOperandPack pack(rewriter, originalLoops);
@@ -728,7 +1031,8 @@ struct ONNXReductionOpLowering : public OpConversionPattern<ONNXReductionOp> {
 };
 
 void populateLoweringONNXReductionOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
   patterns.insert<ONNXOldReductionOpLowering<mlir::ONNXReduceMaxV13Op>,
       ONNXOldReductionOpLowering<mlir::ONNXReduceMinV13Op>,
       ONNXOldReductionOpLowering<mlir::ONNXReduceProdV13Op>,
@@ -736,10 +1040,11 @@ void populateLoweringONNXReductionOpPattern(RewritePatternSet &patterns,
       ONNXReductionOpLowering<mlir::ONNXReduceMaxOp>,
       ONNXReductionOpLowering<mlir::ONNXReduceMinOp>,
       ONNXReductionOpLowering<mlir::ONNXReduceProdOp>,
-      ONNXReductionOpLowering<mlir::ONNXReduceSumOp>>(typeConverter, ctx);
+      ONNXReductionOpLowering<mlir::ONNXReduceSumOp>>(
+      typeConverter, ctx, enableSIMD, enableParallel);
   patterns.insert<ONNXOldReductionOpLowering<mlir::ONNXReduceMeanV13Op>,
-      ONNXReductionOpLowering<mlir::ONNXReduceMeanOp>>(
-      typeConverter, ctx, /*computeMean=*/true);
+      ONNXReductionOpLowering<mlir::ONNXReduceMeanOp>>(typeConverter, ctx,
+      enableSIMD, enableParallel, /*computeMean=*/true);
 }
 
 } // namespace onnx_mlir
@@ -233,11 +233,92 @@ void emitInstForSoftmax<ONNXSoftmaxOp>(ConversionPatternRewriter &rewriter,
       });
 }
 
+// Unroll factor of the SIMD loops along the rows, giving independent chains of
+// accumulations to hide the latency of the vector ops.
+static constexpr int64_t kSoftmaxSimdUnroll = 4;
+
+// Emit SIMD code computing the softmax of the rows of the 2-D view `input` of
+// `numRows` rows of `rowSize` contiguous values, into the 2-D view `alloc`. A
+// first pass over each row computes its max, and a second pass computes the
+// exp of the values minus the max, stored into alloc, and their sum. The
+// stored values, still in cache, are then multiplied by the inverse of the
+// sum. Each pass uses a vector accumulator that is reduced at the end of the
+// row, the last partial vector of a row being loaded with -inf past its end,
+// which leaves the max unchanged and adds exps of 0 to the sum.
+static void emitSimdSoftmax(ConversionPatternRewriter &rewriter, Location loc,
+    Value input, Value alloc, IndexExpr numRows, IndexExpr rowSize,
+    int64_t VL) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+      rewriter, loc);
+  Type elementType = alloc.getType().cast<MemRefType>().getElementType();
+  VectorType vecType = VectorType::get({VL}, elementType);
+  Value zero = create.math.constant(elementType, 0);
+  Value one = create.math.constant(elementType, 1);
+  Value negInfinity = create.math.constant(
+      elementType, -std::numeric_limits<float>::infinity());
+  Value iZero = create.math.constantIndex(0);
+  Value vecAcc = create.mem.alignedAlloca(MemRefType::get({VL}, elementType));
+
+  ValueRange rowLoopDef = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(rowLoopDef, rowLoopDef, {LiteralIndexExpr(0)},
+      {numRows}, [&](KrnlBuilder &ck, ValueRange rowInd) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(ck);
+        IndexExprScope rowScope(ck);
+        SymbolIndexExpr rowSizeIE(rowSize);
+        Value row = rowInd[0];
+
+        // First pass: max of the row.
+        create.vec.store(
+            create.vec.splat(vecType, negInfinity), vecAcc, {iZero});
+        emitSimdLoopWithMaskedTail(create.krnl, rowSizeIE, VL,
+            [&](KrnlBuilder &ck, Value col, Value mask) {
+              MultiDialectBuilder<MathBuilder, VectorBuilder> create(ck);
+              Value x = loadScalarOrVector(
+                  ck, vecType, input, {row, col}, mask, negInfinity);
+              Value max = create.vec.load(vecType, vecAcc, {iZero});
+              create.vec.store(create.math.max(max, x), vecAcc, {iZero});
+            });
+        Value max = create.vec.reduction(vector::CombiningKind::MAXF,
+            create.vec.load(vecType, vecAcc, {iZero}));
+
+        // Second pass: exp of the values minus the max, and their sum.
+        create.vec.store(create.vec.splat(vecType, zero), vecAcc, {iZero});
+        Value vecMax = create.vec.splat(vecType, max);
+        emitSimdLoopWithMaskedTail(create.krnl, rowSizeIE, VL,
+            [&](KrnlBuilder &ck, Value col, Value mask) {
+              MultiDialectBuilder<MathBuilder, VectorBuilder> create(ck);
+              Value x = loadScalarOrVector(
+                  ck, vecType, input, {row, col}, mask, negInfinity);
+              Value exp = create.math.exp(create.math.sub(x, vecMax));
+              storeScalarOrVector(ck, exp, alloc, {row, col}, mask);
+              Value sum = create.vec.load(vecType, vecAcc, {iZero});
+              create.vec.store(create.math.add(sum, exp), vecAcc, {iZero});
+            });
+        Value sum = create.vec.reduction(vector::CombiningKind::ADD,
+            create.vec.load(vecType, vecAcc, {iZero}));
+
+        // Scale the exps by the inverse of the sum.
+        Value invSum = create.math.div(one, sum);
+        Value vecInvSum = create.vec.splat(vecType, invSum);
+        emitSimdLoopWithMaskedTail(create.krnl, rowSizeIE, VL,
+            [&](KrnlBuilder &ck, Value col, Value mask) {
+              MultiDialectBuilder<MathBuilder> create(ck);
+              Value exp = loadScalarOrVector(
+                  ck, vecType, alloc, {row, col}, mask, zero);
+              Value res = create.math.mul(exp, vecInvSum);
+              storeScalarOrVector(ck, res, alloc, {row, col}, mask);
+            });
+      });
+}
+
 template <typename SoftmaxOp>
 struct ONNXSoftmaxLowering : public OpConversionPattern<SoftmaxOp> {
-  ONNXSoftmaxLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern<SoftmaxOp>(typeConverter, ctx) {}
+  ONNXSoftmaxLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+      : OpConversionPattern<SoftmaxOp>(typeConverter, ctx),
+        enableSIMD(enableSIMD) {}
   using OpAdaptor = typename SoftmaxOp::Adaptor;
+  bool enableSIMD;
 
   LogicalResult matchAndRewrite(SoftmaxOp softmaxOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -264,9 +345,43 @@ struct ONNXSoftmaxLowering : public OpConversionPattern<SoftmaxOp> {
 
     // Insert an allocation and deallocation for the result of this operation.
     Type elementType = memRefType.getElementType();
-    MultiDialectBuilder<MemRefBuilder, MathBuilder> create(rewriter, loc);
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder, MathBuilder,
+        VectorBuilder>
+        create(rewriter, loc);
     Value alloc = create.mem.alignedAlloc(input, memRefType);
 
+    // The rows of the softmax are contiguous when the input is coerced at axis
+    // (opset < 13) or when the softmax is along the innermost dimension. View
+    // the input and output as 2-D memrefs of such rows and emit SIMD code.
+    bool hasContiguousRows =
+        std::is_same<SoftmaxOp, ONNXSoftmaxV11Op>::value || axis == rank - 1;
+    if (enableSIMD && hasContiguousRows && elementType.isF32() &&
+        !hasNonIdentityLayout(input)) {
+      int64_t VL =
+          create.vec.getMachineVectorLength(elementType) * kSoftmaxSimdUnroll;
+      IndexExprScope scope(&rewriter, loc);
+      SmallVector<IndexExpr, 4> inputDims;
+      create.krnlIE.getShapeAsSymbols(input, inputDims);
+      IndexExpr numRows = LiteralIndexExpr(1);
+      IndexExpr rowSize = LiteralIndexExpr(1);
+      for (int64_t i = 0; i < rank; ++i) {
+        if (i < axis)
+          numRows = numRows * inputDims[i];
+        else
+          rowSize = rowSize * inputDims[i];
+      }
+      // Rows that are statically too short for a block use the scalar code.
+      if (!rowSize.isLiteral() || rowSize.getLiteral() >= VL) {
+        SmallVector<IndexExpr, 2> viewDims = {numRows, rowSize};
+        Value inputView = create.mem.reinterpretCast(input, viewDims);
+        Value allocView = create.mem.reinterpretCast(alloc, viewDims);
+        emitSimdSoftmax(
+            rewriter, loc, inputView, allocView, numRows, rowSize, VL);
+        rewriter.replaceOp(op, alloc);
+        return success();
+      }
+    }
+
     // Insert allocations and deallocations for sum and max.
     MemRefType scalarMemRefType = MemRefType::get({}, elementType, {}, 0);
     Value sumOp = create.mem.alignedAlloc(scalarMemRefType);
@@ -285,9 +400,9 @@ struct ONNXSoftmaxLowering : public OpConversionPattern<SoftmaxOp> {
 };
 
 void populateLoweringONNXSoftmaxOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD) {
   patterns.insert<ONNXSoftmaxLowering<ONNXSoftmaxOp>,
-      ONNXSoftmaxLowering<ONNXSoftmaxV11Op>>(typeConverter, ctx);
+      ONNXSoftmaxLowering<ONNXSoftmaxV11Op>>(typeConverter, ctx, enableSIMD);
 }
 
 } // namespace onnx_mlir
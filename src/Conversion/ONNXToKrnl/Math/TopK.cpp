@@ -19,6 +19,10 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum ratio of the axis length to K for which the first K values are
+// selected with a partial sort instead of a full sort of the axis.
+static constexpr int64_t kTopKPartialSortMinRatio = 8;
+
 struct ONNXTopKOpLowering : public OpConversionPattern<ONNXTopKOp> {
   ONNXTopKOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
       : OpConversionPattern(typeConverter, ctx) {}
@@ -64,9 +68,19 @@ struct ONNXTopKOpLowering : public OpConversionPattern<ONNXTopKOp> {
     Value resIndexMemRef = create.mem.alignedAlloc(
         MemRefType::get(resMemRefType.getShape(), i64Type), resDims);
 
-    // Compute argSort of X along axis.
-    Value argSort = emitArgSort(rewriter, loc, X, axis,
-        /*ascending=*/ascendingMode);
+    // Compute argSort of X along axis, or only its first K values when K is
+    // much smaller than the axis length.
+    int64_t axisSize = X.getType().cast<MemRefType>().getShape()[axis];
+    bool partialSort =
+        (rank <= 6) && (axis == rank - 1) && resDims[axis].isLiteral() &&
+        !ShapedType::isDynamic(axisSize) &&
+        resDims[axis].getLiteral() * kTopKPartialSortMinRatio <= axisSize;
+    Value argSort =
+        partialSort
+            ? emitArgTopK(rewriter, loc, X, axis, resDims[axis].getLiteral(),
+                  /*ascending=*/ascendingMode)
+            : emitArgSort(rewriter, loc, X, axis,
+                  /*ascending=*/ascendingMode);
 
     // Produce the final result.
     SmallVector<IndexExpr> zeroDims(rank, LiteralIndexExpr(0));
@@ -8,7 +8,14 @@
 //
 // =============================================================================
 //
-// This file lowers the ONNX Convolution Operators to Krnl dialect.
+// This file lowers the ONNX Convolution Operators, with their fused
+// activations if any, to Krnl dialect. The 3x3 convolutions of stride 1 with
+// enough channels are lowered with Winograd, the depthwise convolutions to a
+// loop nest vectorized along the output columns, the other large enough
+// convolutions to an im2col buffer multiplied by the filter with krnl.matmul,
+// and the remaining ones to a direct loop nest. The im2col and direct
+// lowerings read the uint8 NHWC images of the inputs taken as such through
+// their cast and transpose, converting the elements on load.
 //
 //===----------------------------------------------------------------------===//
 
@@ -20,16 +27,317 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
-struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
-  ONNXConvOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
-      : OpConversionPattern(typeConverter, ctx),
-        enableParallel(enableParallel) {}
+namespace {
+
+// Pointwise activation applied to each output value of a convolution before
+// it is stored, with its parameters.
+struct ConvActivation {
+  StringRef name;
+  double alpha;
+  double beta;
+};
+
+// Plain convolutions have no activation.
+void getConvActivations(
+    ONNXConvOp convOp, SmallVectorImpl<ConvActivation> &activations) {}
+
+void getConvActivations(
+    ONNXFusedConvOp convOp, SmallVectorImpl<ConvActivation> &activations) {
+  Optional<ArrayAttr> alphaOpt = convOp.getActivationAlpha();
+  Optional<ArrayAttr> betaOpt = convOp.getActivationBeta();
+  for (auto activation : llvm::enumerate(convOp.getActivations())) {
+    int64_t i = activation.index();
+    ConvActivation act;
+    act.name = activation.value().cast<StringAttr>().getValue();
+    act.alpha = 0.0;
+    if (alphaOpt.has_value())
+      act.alpha = alphaOpt.value()[i].cast<FloatAttr>().getValueAsDouble();
+    act.beta = 0.0;
+    if (betaOpt.has_value())
+      act.beta = betaOpt.value()[i].cast<FloatAttr>().getValueAsDouble();
+    activations.emplace_back(act);
+  }
+}
+
+// Apply the activations to a scalar output value.
+Value applyConvActivations(const MathBuilder &createMath,
+    ArrayRef<ConvActivation> activations, Value result) {
+  Type elementType = result.getType();
+  for (const ConvActivation &act : activations) {
+    if (act.name == "Relu") {
+      Value zero = createMath.constant(elementType, 0.0);
+      result = createMath.max(result, zero);
+    } else if (act.name == "LeakyRelu") {
+      Value zero = createMath.constant(elementType, 0.0);
+      Value alpha = createMath.constant(elementType, act.alpha);
+      result = createMath.select(createMath.lt(result, zero),
+          createMath.mul(alpha, result), result);
+    } else if (act.name == "Clip") {
+      Value min = createMath.constant(elementType, act.alpha);
+      Value max = createMath.constant(elementType, act.beta);
+      result = createMath.min(createMath.max(result, min), max);
+    } else {
+      llvm_unreachable("unsupported activation of a convolution");
+    }
+  }
+  return result;
+}
+
+// Return true if the transpose to NCHW of the cast of an NHWC tensor of static
+// shape, as inserted for the inputs taken as uint8 NHWC images, is only used
+// as the input of convolutions with a single group. These convolutions read
+// the NHWC tensor and convert its elements when loading them, so that neither
+// the cast nor the transposed tensor are materialized.
+bool isCastAndTransposedOnLoad(ONNXTransposeOp transposeOp) {
+  auto castOp = transposeOp.getData().getDefiningOp<ONNXCastOp>();
+  Value output = transposeOp.getTransposed();
+  if (!castOp || !castOp.getOutput().hasOneUse() || output.use_empty())
+    return false;
+  auto inputType = castOp.getInput().getType().dyn_cast<RankedTensorType>();
+  if (!inputType || inputType.getRank() != 4 || !inputType.hasStaticShape() ||
+      !(inputType.getElementType().isa<FloatType>() ||
+          (inputType.getElementType().isa<IntegerType>() &&
+              !inputType.getElementType().isInteger(1))))
+    return false;
+  ArrayAttr permAttr = transposeOp.getPermAttr();
+  if (!permAttr || ArrayAttrIntVal(permAttr, 0) != 0 ||
+      ArrayAttrIntVal(permAttr, 1) != 3 || ArrayAttrIntVal(permAttr, 2) != 1 ||
+      ArrayAttrIntVal(permAttr, 3) != 2)
+    return false;
+  return llvm::all_of(output.getUses(), [](OpOperand &use) {
+    Operation *user = use.getOwner();
+    if (use.getOperandNumber() != 0)
+      return false;
+    if (auto convOp = dyn_cast<ONNXConvOp>(user))
+      return convOp.getGroup() == 1;
+    if (auto convOp = dyn_cast<ONNXFusedConvOp>(user))
+      return convOp.getGroup() == 1;
+    return false;
+  });
+}
+
+// The casts and transposes read on load by the convolutions are replaced by
+// placeholders, left dead once the convolutions are lowered.
+struct ONNXCastTransposedOnLoadOpLowering
+    : public OpConversionPattern<ONNXCastOp> {
+  ONNXCastTransposedOnLoadOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/2) {}
+
+  LogicalResult matchAndRewrite(ONNXCastOp castOp, ONNXCastOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    if (!castOp->hasOneUse())
+      return failure();
+    auto transposeOp = dyn_cast<ONNXTransposeOp>(*castOp->user_begin());
+    if (!transposeOp || !isCastAndTransposedOnLoad(transposeOp))
+      return failure();
+    Type convertedType = typeConverter->convertType(castOp.getType());
+    if (!convertedType || !adaptor.getInput().getType().isa<MemRefType>())
+      return failure();
+    rewriter.replaceOpWithNewOp<UnrealizedConversionCastOp>(
+        castOp, convertedType, adaptor.getInput());
+    return success();
+  }
+};
+
+struct ONNXTransposedOnLoadOpLowering
+    : public OpConversionPattern<ONNXTransposeOp> {
+  ONNXTransposedOnLoadOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx, /*benefit=*/2) {}
+
+  LogicalResult matchAndRewrite(ONNXTransposeOp transposeOp,
+      ONNXTransposeOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    if (!isCastAndTransposedOnLoad(transposeOp))
+      return failure();
+    Type convertedType = typeConverter->convertType(transposeOp.getType());
+    if (!convertedType || !adaptor.getData().getType().isa<MemRefType>())
+      return failure();
+    rewriter.replaceOpWithNewOp<UnrealizedConversionCastOp>(
+        transposeOp, convertedType, adaptor.getData());
+    return success();
+  }
+};
+
+// Load the element of the input X of a convolution at the NCHW indices, or of
+// the NHWC tensor read on load in place of X if set, converted to the element
+// type of the convolution.
+Value loadConvInput(const KrnlBuilder &createKrnl,
+    const MathBuilder &createMath, Value X, Value nhwcX,
+    ArrayRef<IndexExpr> indices, Type elementType) {
+  if (!nhwcX)
+    return createKrnl.loadIE(X, indices);
+  SmallVector<IndexExpr, 4> nhwcIndices = {
+      indices[0], indices[2], indices[3], indices[1]};
+  Value element = createKrnl.loadIE(nhwcX, nhwcIndices);
+  if (element.getType() == elementType)
+    return element;
+  return createMath.cast(elementType, element);
+}
+
+// Minimum size of the reduction, CI * KH * KW, and of the output channels and
+// spatial dims of a convolution lowered to an im2col buffer multiplied by the
+// filter with krnl.matmul. Smaller convolutions are better served by the
+// direct loop nest.
+const int64_t kIm2ColMinReductionSize = 16;
+const int64_t kIm2ColMinChannelOut = 8;
+const int64_t kIm2ColMinOutputSize = 16;
+// Maximum number of elements of the im2col buffer, which holds the patches of
+// one image of the batch at a time.
+const int64_t kIm2ColMaxBufferSize = 16 * 1024 * 1024;
+
+// Number of output channels computed together by the direct loop nest, whose
+// loop is unrolled and jammed into the reduction loops, so that each value of
+// the input loaded is reused for all of them.
+const int64_t kConvChannelOutBlock = 4;
+
+// Maximum number of elements of the transformed inputs and outputs of the
+// tiles of one image lowered with Winograd.
+const int64_t kWinogradMaxBufferSize = 16 * 1024 * 1024;
+
+// Alignment of the filter transformed at compile time.
+static constexpr int BUFFER_ALIGN = 128;
+
+// Winograd minimal filtering F(m x m, 3 x 3), from Lavin and Gray, "Fast
+// Algorithms for Convolutional Neural Networks". Each m x m tile Y of the
+// output of a 3x3 convolution of stride 1 is computed from the
+// (m + 2) x (m + 2) tile d of the input starting at the same position as
+//   Y = AT * [(G * g * GT) . (BT * d * B)] * A
+// where g is the 3x3 filter and . the elementwise product. Summed over the
+// input channels, the elementwise products become (m + 2)^2 independent
+// matrix multiplications, with (m + 2)^2 / (9 * m^2) of the multiplications of
+// the direct convolution.
+struct WinogradTransforms {
+  int64_t m;           // Size of the output tiles.
+  int64_t alpha;       // Size of the input tiles, m + 2.
+  ArrayRef<double> BT; // alpha x alpha.
+  ArrayRef<double> G;  // alpha x 3.
+  ArrayRef<double> AT; // m x alpha.
+};
+
+// clang-format off
+const double kWinogradF2x2BT[] = {
+    1,  0, -1,  0,
+    0,  1,  1,  0,
+    0, -1,  1,  0,
+    0,  1,  0, -1};
+const double kWinogradF2x2G[] = {
+    1,    0,   0,
+    0.5,  0.5, 0.5,
+    0.5, -0.5, 0.5,
+    0,    0,   1};
+const double kWinogradF2x2AT[] = {
+    1, 1,  1,  0,
+    0, 1, -1, -1};
+
+const double kWinogradF4x4BT[] = {
+    4,  0, -5,  0, 1, 0,
+    0, -4, -4,  1, 1, 0,
+    0,  4, -4, -1, 1, 0,
+    0, -2, -1,  2, 1, 0,
+    0,  2, -1, -2, 1, 0,
+    0,  4,  0, -5, 0, 1};
+const double kWinogradF4x4G[] = {
+     1.0 / 4,       0,             0,
+    -1.0 / 6,      -1.0 / 6,      -1.0 / 6,
+    -1.0 / 6,       1.0 / 6,      -1.0 / 6,
+     1.0 / 24,      1.0 / 12,      1.0 / 6,
+     1.0 / 24,     -1.0 / 12,      1.0 / 6,
+     0,             0,             1};
+const double kWinogradF4x4AT[] = {
+    1, 1,  1, 1,  1, 0,
+    0, 1, -1, 2, -2, 0,
+    0, 1,  1, 4,  4, 0,
+    0, 1, -1, 8, -8, 1};
+// clang-format on
+
+WinogradTransforms getWinogradTransforms(int64_t m) {
+  if (m == 2)
+    return {2, 4, kWinogradF2x2BT, kWinogradF2x2G, kWinogradF2x2AT};
+  assert(m == 4 && "expected Winograd F(2x2, 3x3) or F(4x4, 3x3)");
+  return {4, 6, kWinogradF4x4BT, kWinogradF4x4G, kWinogradF4x4AT};
+}
+
+// Emit sum_i coefs[i] * vals[i], eliding the products by 0, 1 and -1.
+Value emitLinearCombination(const MathBuilder &createMath,
+    ArrayRef<double> coefs, ArrayRef<Value> vals, Value zero) {
+  Value res;
+  for (size_t i = 0; i < coefs.size(); ++i) {
+    double c = coefs[i];
+    if (c == 0.0)
+      continue;
+    Value term = vals[i];
+    if (c != 1.0 && c != -1.0)
+      term = createMath.mul(createMath.constant(term.getType(), c), term);
+    if (!res)
+      res = (c == -1.0) ? createMath.sub(zero, term) : term;
+    else
+      res = (c == -1.0) ? createMath.sub(res, term) : createMath.add(res, term);
+  }
+  return res ? res : zero;
+}
+
+// Emit Y = L * X * LT, with L a constant p x q matrix and X a q x q matrix
+// of scalar values, both row major.
+void emitWinogradTransform(const MathBuilder &createMath, ArrayRef<double> L,
+    int64_t p, int64_t q, ArrayRef<Value> X, Value zero,
+    SmallVectorImpl<Value> &Y) {
+  // T = L * X, p x q.
+  SmallVector<Value, 36> T;
+  for (int64_t i = 0; i < p; ++i)
+    for (int64_t j = 0; j < q; ++j) {
+      SmallVector<Value, 6> col;
+      for (int64_t k = 0; k < q; ++k)
+        col.emplace_back(X[k * q + j]);
+      T.emplace_back(emitLinearCombination(
+          createMath, L.slice(i * q, q), col, zero));
+    }
+  // Y = T * LT, p x p.
+  Y.clear();
+  for (int64_t i = 0; i < p; ++i)
+    for (int64_t j = 0; j < p; ++j)
+      Y.emplace_back(emitLinearCombination(createMath, L.slice(j * q, q),
+          ArrayRef<Value>(T).slice(i * q, q), zero));
+}
+
+// Compute u = G * g * GT for the 3x3 filter g, at compile time.
+void computeWinogradFilter(const WinogradTransforms &wt, ArrayRef<float> g,
+    SmallVectorImpl<double> &u) {
+  int64_t alpha = wt.alpha;
+  // T = G * g, alpha x 3.
+  SmallVector<double, 18> T(alpha * 3, 0.0);
+  for (int64_t i = 0; i < alpha; ++i)
+    for (int64_t j = 0; j < 3; ++j)
+      for (int64_t k = 0; k < 3; ++k)
+        T[i * 3 + j] += wt.G[i * 3 + k] * g[k * 3 + j];
+  // u = T * GT, alpha x alpha.
+  u.assign(alpha * alpha, 0.0);
+  for (int64_t i = 0; i < alpha; ++i)
+    for (int64_t j = 0; j < alpha; ++j)
+      for (int64_t k = 0; k < 3; ++k)
+        u[i * alpha + j] += T[i * 3 + k] * wt.G[j * 3 + k];
+}
+
+} // namespace
+
+template <typename CONV_OP>
+struct ONNXConvOpLowering : public OpConversionPattern<CONV_OP> {
+  using OpAdaptor = typename CONV_OP::Adaptor;
+  using ShapeHelper = ONNXGenericPoolOpShapeHelper<CONV_OP>;
+
+  ONNXConvOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel, int64_t convWinogradThreshold)
+      : OpConversionPattern<CONV_OP>(typeConverter, ctx),
+        enableTiling(enableTiling), enableParallel(enableParallel),
+        convWinogradThreshold(convWinogradThreshold) {}
+  bool enableTiling;
   bool enableParallel;
+  int64_t convWinogradThreshold;
 
-  void convUnoptimized(ConversionPatternRewriter &rewriter, ONNXConvOp &convOp,
-      ONNXConvOpAdaptor &operandAdaptor, ONNXConvOpShapeHelper &shapeHelper,
-      MemRefType &memRefType, Value alloc) const {
+  void convUnoptimized(ConversionPatternRewriter &rewriter, CONV_OP &convOp,
+      OpAdaptor &operandAdaptor, ShapeHelper &shapeHelper,
+      ArrayRef<ConvActivation> activations, MemRefType &memRefType,
+      Value alloc, Value nhwcInput) const {
     Location loc = convOp.getLoc();
     MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, SCFBuilder,
         MathBuilder, MemRefBuilder>
@@ -69,9 +377,18 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
     IndexExpr iZero = LiteralIndexExpr(0);
     IndexExpr iOne = LiteralIndexExpr(1);
 
+    // With tiling, blocks of coBlock output channels are computed together,
+    // with one accumulator each, when their number per group is a multiple of
+    // the block.
+    int64_t coBlock = 1;
+    if (enableTiling && COPerGroup.isLiteral() &&
+        COPerGroup.getLiteral() % kConvChannelOutBlock == 0)
+      coBlock = kConvChannelOutBlock;
+    IndexExpr COBlocksPerGroup = COPerGroup.floorDiv(coBlock);
+
     SmallVector<Value, 3> lbsStorage, ubsStorage, stepsStorage;
     SmallVector<IndexExpr, 3> outerLbs = {iZero, iZero, iZero};
-    SmallVector<IndexExpr, 3> outerUbs = {N, G, COPerGroup};
+    SmallVector<IndexExpr, 3> outerUbs = {N, G, COBlocksPerGroup};
     SmallVector<IndexExpr, 3> outerSteps = {iOne, iOne, iOne};
     IndexExpr::getValues(outerLbs, lbsStorage);
     IndexExpr::getValues(outerUbs, ubsStorage);
@@ -82,20 +399,23 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
     // Iterate over the outer loops
     // for n = 0 .. N:
     //   for g = 0 .. G:
-    //     for coPerGroup = 0 .. COPerGroup:
+    //     for coPerGroup = 0 .. COPerGroup step coBlock:
     //       co = g * COPerGroup + coPerGroup;
 
-    // Create a local reduction value.
-    MemRefType tmpType = MemRefType::get({}, memRefType.getElementType());
-    // Single scalar, no need for default alignment.
+    // Create a local reduction value, one per output channel of a block.
+    MemRefType tmpType =
+        (coBlock == 1)
+            ? MemRefType::get({}, memRefType.getElementType())
+            : MemRefType::get({coBlock}, memRefType.getElementType());
+    // Few scalars, no need for default alignment.
     Value reductionVal = create.mem.alloca(tmpType);
     auto bodyFunction = [&](ValueRange outerIndices) {
       // Compute the Channel In Indices.
       IndexExprScope outerScope(create.krnl);
-      // Compute the channel out index "co".
+      // Compute the channel out index "co", of the first channel of the block.
       DimIndexExpr g(outerIndices[1]);
       DimIndexExpr coPerGroup(outerIndices[2]);
-      IndexExpr co = g * SymbolIndexExpr(COPerGroup) + coPerGroup;
+      IndexExpr co = g * SymbolIndexExpr(COPerGroup) + coPerGroup * coBlock;
       // Compute g * CIPerGroup for later use.
       IndexExpr gTimesCIPerGroup = g * SymbolIndexExpr(CIPerGroup);
       // Determine the bounds for the output spacial dimensions.
@@ -117,99 +437,134 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
             MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl,
                 MathBuilder>
                 create(createKrnl);
-            // Reset reduction value to zero.
-            create.krnl.store(fZero, reductionVal);
 
             // Bounds for reduction loops.
-            ValueRange redLoops = create.krnl.defineLoops(spacialRank + 1);
             SmallVector<IndexExpr, 4> redLbs, redUbs, pMinOS;
-            // First: loop over channel in per group.
-            redLbs.emplace_back(iZero);
-            redUbs.emplace_back(SymbolIndexExpr(CIPerGroup));
-            // For each spacial dim, do the following.
-            for (int i = 0; i < spacialRank; ++i) {
-              // Get data for dis spacial dimension.
-              DimIndexExpr o(outputSpatialIndices[i]);
-              SymbolIndexExpr I(create.krnlIE.getShapeAsSymbol(
-                  inputOperand, spatialStartIndex + i));
-              SymbolIndexExpr K(create.krnlIE.getShapeAsSymbol(
-                  filterOperand, spatialStartIndex + i));
-              SymbolIndexExpr p(shapeHelper.pads[i]); // Beginning/left/top pad.
-              LiteralIndexExpr s(shapeHelper.strides[i]);
-              LiteralIndexExpr d(shapeHelper.dilations[i]);
-              // lb = ceil((p - o * s) / d)
-              IndexExpr pos = p - (o * s);
-              IndexExpr lb = pos.ceilDiv(d);
-              lb = IndexExpr::max(lb, 0);
-              redLbs.emplace_back(lb);
-              // ub = ceil((I + p - o * s) / d)
-              IndexExpr ipos = I + pos;
-              IndexExpr ub = ipos.ceilDiv(d);
-              ub = IndexExpr::min(ub, K);
-              redUbs.emplace_back(ub);
-              // Save p - o * s for later use.
-              pMinOS.emplace_back(pos);
-            }
-            // for ciPerGroup = 0 .. CIPerGroup:
-            //   for kh in lb .. ub:
-            //     for kw in lb .. ub:
-            create.krnl.iterateIE(redLoops, redLoops, redLbs, redUbs,
-                [&](KrnlBuilder &createKrnl, ValueRange redIndices) {
-                  IndexExprScope redScope(createKrnl);
-                  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl,
-                      MathBuilder>
-                      create(createKrnl);
-                  // Create access function for input image:
-                  // [n, ci, ho * sh + kh * dh - ph, wo * sw + kw * dw -
-                  // pw].
-                  SmallVector<IndexExpr, 4> inputAccessFct;
-                  DimIndexExpr n(outerIndices[0]);
-                  inputAccessFct.emplace_back(n);
-                  // ci = g * CIPerG + ciPerG
-                  DimIndexExpr ciPerG(redIndices[0]);
-                  IndexExpr ci = SymbolIndexExpr(gTimesCIPerGroup) + ciPerG;
-                  inputAccessFct.emplace_back(ci);
-                  for (int i = 0; i < spacialRank; ++i) {
-                    // for each spacial dims: access is o * s + k * d - p.
-                    DimIndexExpr k(redIndices[1 + i]);
-                    SymbolIndexExpr pos(pMinOS[i]);
-                    LiteralIndexExpr d(shapeHelper.dilations[i]);
-                    // k*d - (p - o*s) = k*d + o*s - p
-                    IndexExpr t = (k * d) - pos;
-                    inputAccessFct.emplace_back(t);
-                  }
-                  Value image =
-                      create.krnl.loadIE(inputOperand, inputAccessFct);
-                  // Create access fct for filter: [co, ciPerG, kh, kw].
-                  SmallVector<IndexExpr, 4> filterAccessFct;
-                  filterAccessFct.emplace_back(DimIndexExpr(co));
-                  filterAccessFct.emplace_back(DimIndexExpr(ciPerG));
-
-                  for (int i = 0; i < spacialRank; ++i) {
-                    DimIndexExpr k(redIndices[1 + i]);
-                    filterAccessFct.emplace_back(k);
-                  }
-                  Value filter =
-                      create.krnl.loadIE(filterOperand, filterAccessFct);
-                  Value oldRed = create.krnl.load(reductionVal);
-                  Value mul = create.math.mul(image, filter);
-                  Value newRed = create.math.add(oldRed, mul);
-                  create.krnl.store(newRed, reductionVal);
-                }); // Reduction loops.
-                    // Finish the reduction and store in result array.
-            Value result = create.krnl.load(reductionVal);
-            // Store the result. Optionally add bias.
-            SymbolIndexExpr coInOutputSpacial(co);
-            if (hasBias) {
-              Value bias = create.krnl.loadIE(biasOperand, {coInOutputSpacial});
-              result = create.math.add(result, bias);
+            auto computeReductionBounds = [&]() {
+              // First: loop over channel in per group.
+              redLbs.emplace_back(iZero);
+              redUbs.emplace_back(SymbolIndexExpr(CIPerGroup));
+              // For each spacial dim, do the following.
+              for (int i = 0; i < spacialRank; ++i) {
+                // Get data for dis spacial dimension.
+                DimIndexExpr o(outputSpatialIndices[i]);
+                SymbolIndexExpr I(create.krnlIE.getShapeAsSymbol(
+                    inputOperand, spatialStartIndex + i));
+                SymbolIndexExpr K(create.krnlIE.getShapeAsSymbol(
+                    filterOperand, spatialStartIndex + i));
+                SymbolIndexExpr p(shapeHelper.pads[i]); // Beginning pad.
+                LiteralIndexExpr s(shapeHelper.strides[i]);
+                LiteralIndexExpr d(shapeHelper.dilations[i]);
+                // lb = ceil((p - o * s) / d)
+                IndexExpr pos = p - (o * s);
+                IndexExpr lb = pos.ceilDiv(d);
+                lb = IndexExpr::max(lb, 0);
+                redLbs.emplace_back(lb);
+                // ub = ceil((I + p - o * s) / d)
+                IndexExpr ipos = I + pos;
+                IndexExpr ub = ipos.ceilDiv(d);
+                ub = IndexExpr::min(ub, K);
+                redUbs.emplace_back(ub);
+                // Save p - o * s for later use.
+                pMinOS.emplace_back(pos);
+              }
+            };
+
+            // Compute the output channel co + coInBlock, whose reduction
+            // value is at accIndices in reductionVal.
+            auto computeChannelOut = [&](KrnlBuilder &createKrnl,
+                                         IndexExpr coInBlock,
+                                         ValueRange accIndices) {
+              MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+              IndexExpr coOut = SymbolIndexExpr(co) + coInBlock;
+              // Reset reduction value to zero.
+              create.krnl.store(fZero, reductionVal, accIndices);
+
+              ValueRange redLoops = create.krnl.defineLoops(spacialRank + 1);
+              if (redLbs.empty())
+                computeReductionBounds();
+              // for ciPerGroup = 0 .. CIPerGroup:
+              //   for kh in lb .. ub:
+              //     for kw in lb .. ub:
+              create.krnl.iterateIE(redLoops, redLoops, redLbs, redUbs,
+                  [&](KrnlBuilder &createKrnl, ValueRange redIndices) {
+                    IndexExprScope redScope(createKrnl);
+                    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl,
+                        MathBuilder>
+                        create(createKrnl);
+                    // Create access function for input image:
+                    // [n, ci, ho * sh + kh * dh - ph, wo * sw + kw * dw -
+                    // pw].
+                    SmallVector<IndexExpr, 4> inputAccessFct;
+                    DimIndexExpr n(outerIndices[0]);
+                    inputAccessFct.emplace_back(n);
+                    // ci = g * CIPerG + ciPerG
+                    DimIndexExpr ciPerG(redIndices[0]);
+                    IndexExpr ci = SymbolIndexExpr(gTimesCIPerGroup) + ciPerG;
+                    inputAccessFct.emplace_back(ci);
+                    for (int i = 0; i < spacialRank; ++i) {
+                      // for each spacial dims: access is o * s + k * d - p.
+                      DimIndexExpr k(redIndices[1 + i]);
+                      SymbolIndexExpr pos(pMinOS[i]);
+                      LiteralIndexExpr d(shapeHelper.dilations[i]);
+                      // k*d - (p - o*s) = k*d + o*s - p
+                      IndexExpr t = (k * d) - pos;
+                      inputAccessFct.emplace_back(t);
+                    }
+                    Value image = loadConvInput(create.krnl, create.math,
+                        inputOperand, nhwcInput, inputAccessFct,
+                        memRefType.getElementType());
+                    // Create access fct for filter: [co, ciPerG, kh, kw].
+                    SmallVector<IndexExpr, 4> filterAccessFct;
+                    filterAccessFct.emplace_back(DimIndexExpr(coOut));
+                    filterAccessFct.emplace_back(DimIndexExpr(ciPerG));
+
+                    for (int i = 0; i < spacialRank; ++i) {
+                      DimIndexExpr k(redIndices[1 + i]);
+                      filterAccessFct.emplace_back(k);
+                    }
+                    Value filter =
+                        create.krnl.loadIE(filterOperand, filterAccessFct);
+                    Value oldRed = create.krnl.load(reductionVal, accIndices);
+                    Value mul = create.math.mul(image, filter);
+                    Value newRed = create.math.add(oldRed, mul);
+                    create.krnl.store(newRed, reductionVal, accIndices);
+                  }); // Reduction loops.
+              // Finish the reduction and store in result array.
+              Value result = create.krnl.load(reductionVal, accIndices);
+              // Store the result. Optionally add bias.
+              if (hasBias) {
+                Value bias = create.krnl.loadIE(biasOperand, {coOut});
+                result = create.math.add(result, bias);
+              }
+              // Apply the fused activations, if any, before the store.
+              result = applyConvActivations(create.math, activations, result);
+              SmallVector<IndexExpr, 4> resAccessFunc;
+              resAccessFunc.emplace_back(SymbolIndexExpr(outerIndices[0]));
+              resAccessFunc.emplace_back(coOut);
+              for (Value o : outputSpatialIndices)
+                resAccessFunc.emplace_back(DimIndexExpr(o));
+              create.krnl.storeIE(result, alloc, resAccessFunc);
+            };
+
+            if (coBlock == 1) {
+              computeChannelOut(create.krnl, LiteralIndexExpr(0), {});
+              return;
             }
-            SmallVector<IndexExpr, 4> resAccessFunc;
-            resAccessFunc.emplace_back(SymbolIndexExpr(outerIndices[0]));
-            resAccessFunc.emplace_back(coInOutputSpacial);
-            for (Value o : outputSpatialIndices)
-              resAccessFunc.emplace_back(DimIndexExpr(o));
-            create.krnl.storeIE(result, alloc, resAccessFunc);
+            // The bounds of the reduction loops only depend on the output
+            // position. They are computed out of the loop over the channels
+            // of the block, which is then jammed into the reduction loops, so
+            // that each input value is loaded once for the coBlock channels.
+            // for coInBlock = 0 .. coBlock:
+            computeReductionBounds();
+            ValueRange blockLoop = create.krnl.defineLoops(1);
+            create.krnl.unrollJam(blockLoop[0], coBlock);
+            create.krnl.iterateIE(blockLoop, blockLoop, {iZero},
+                {LiteralIndexExpr(coBlock)},
+                [&](KrnlBuilder &createKrnl, ValueRange blockIndices) {
+                  computeChannelOut(createKrnl, DimIndexExpr(blockIndices[0]),
+                      blockIndices);
+                });
           }); // Output spacial loops.
     };
 
@@ -227,21 +582,806 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
     }
   }
 
-  LogicalResult matchAndRewrite(ONNXConvOp convOp, ONNXConvOpAdaptor adaptor,
+  // Check that the input, filter and output have the standard layout. The
+  // blocked layouts of the SIMD data layout optimization are only supported by
+  // the direct loop nest, which accesses them through their affine maps.
+  bool hasIdentityLayouts(
+      OpAdaptor &operandAdaptor, MemRefType memRefType) const {
+    return !hasNonIdentityLayout(operandAdaptor.getX()) &&
+           !hasNonIdentityLayout(operandAdaptor.getW()) &&
+           memRefType.getLayout().isIdentity();
+  }
+
+  // Determine if the convolution is lowered with Winograd, and set the size m
+  // of its output tiles: 3x3 f32 convolutions of stride 1 and static shapes,
+  // without dilation nor groups, with enough input and output channels for
+  // the savings on the matrix multiplications to outweigh the transforms of
+  // the inputs and outputs.
+  bool useWinograd(CONV_OP convOp, OpAdaptor &operandAdaptor,
+      ShapeHelper &shapeHelper, MemRefType memRefType, int64_t &m) const {
+    if (!enableTiling || convOp.getGroup() != 1 ||
+        !memRefType.getElementType().isF32())
+      return false;
+    auto xType = operandAdaptor.getX().getType().template cast<MemRefType>();
+    auto wType = operandAdaptor.getW().getType().template cast<MemRefType>();
+    if (!xType.hasStaticShape() || !wType.hasStaticShape() ||
+        !memRefType.hasStaticShape() || memRefType.getRank() != 4)
+      return false;
+    ArrayRef<int64_t> wShape = wType.getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    if (wShape[2] != 3 || wShape[3] != 3)
+      return false;
+    for (int i = 0; i < 2; ++i)
+      if (shapeHelper.strides[i] != 1 || shapeHelper.dilations[i] != 1)
+        return false;
+    if (!hasIdentityLayouts(operandAdaptor, memRefType))
+      return false;
+    for (IndexExpr pad : shapeHelper.pads)
+      if (!pad.isLiteral())
+        return false;
+    if (std::min(wShape[0], wShape[1]) < convWinogradThreshold)
+      return false;
+    // The larger tiles save more multiplications, when the output is large
+    // enough not to waste most of them on its borders.
+    m = (yShape[2] >= 8 && yShape[3] >= 8) ? 4 : 2;
+    int64_t alpha = m + 2;
+    int64_t numTiles =
+        llvm::divideCeil(yShape[2], m) * llvm::divideCeil(yShape[3], m);
+    return alpha * alpha * std::max(wShape[0], wShape[1]) * numTiles <=
+           kWinogradMaxBufferSize;
+  }
+
+  // Return the filter transformed at compile time into a krnl.global of
+  // [alpha^2, CO, CI] elements if it is a constant, and nullptr otherwise.
+  Value transformConstantFilter(Value filterOperand,
+      const WinogradTransforms &wt, Type elementType,
+      ConversionPatternRewriter &rewriter, Location loc) const {
+    DenseElementsAttr wAttr = getDenseElementAttrFromConstValue(filterOperand);
+    if (!wAttr)
+      return nullptr;
+    ArrayRef<int64_t> wShape = wAttr.getType().getShape();
+    int64_t CO = wShape[0], CI = wShape[1];
+    int64_t alpha2 = wt.alpha * wt.alpha;
+    std::vector<float> wValues(wAttr.getValues<float>().begin(),
+        wAttr.getValues<float>().end());
+    std::vector<float> transformed(alpha2 * CO * CI);
+    SmallVector<double, 36> u;
+    for (int64_t co = 0; co < CO; ++co)
+      for (int64_t ci = 0; ci < CI; ++ci) {
+        computeWinogradFilter(wt,
+            ArrayRef<float>(wValues).slice((co * CI + ci) * 9, 9), u);
+        for (int64_t xi = 0; xi < alpha2; ++xi)
+          transformed[(xi * CO + co) * CI + ci] = u[xi];
+      }
+    MemRefType transformedType =
+        MemRefType::get({alpha2, CO, CI}, elementType);
+    DenseElementsAttr transformedAttr = DenseElementsAttr::get(
+        RankedTensorType::get(transformedType.getShape(), elementType),
+        llvm::makeArrayRef(transformed));
+    MultiDialectBuilder<KrnlBuilder> create(rewriter, loc);
+    return create.krnl.constant(transformedType, "winograd_filter_",
+        transformedAttr, std::nullopt,
+        rewriter.getI64IntegerAttr(BUFFER_ALIGN));
+  }
+
+  // Lower the convolution with Winograd F(m x m, 3 x 3). For each image of
+  // the batch:
+  //   V[xi, ci, t] = (BT * d(ci, t) * B)[xi], for the input tiles d(ci, t)
+  //   M[xi] = U[xi] * V[xi], for the alpha^2 positions xi in a tile
+  //   Y(co, t) = AT * M[:, co, t] * A + B[co]
+  // where U = G * g * GT is the transformed filter, computed at compile time
+  // when the filter is a constant. The alpha^2 matrix multiplications are
+  // done with krnl.matmul, the transforms being straight-line code with
+  // constant coefficients.
+  void convWinograd(ConversionPatternRewriter &rewriter, CONV_OP &convOp,
+      OpAdaptor &operandAdaptor, ShapeHelper &shapeHelper,
+      ArrayRef<ConvActivation> activations, MemRefType &memRefType,
+      Value alloc, int64_t m) const {
+    Location loc = convOp.getLoc();
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        rewriter, loc);
+    WinogradTransforms wt = getWinogradTransforms(m);
+    int64_t alpha = wt.alpha;
+    int64_t alpha2 = alpha * alpha;
+
+    Value inputOperand = operandAdaptor.getX();
+    Value filterOperand = operandAdaptor.getW();
+    Value biasOperand = operandAdaptor.getB();
+    bool hasBias = !biasOperand.getType().isa<NoneType>();
+    Type elementType = memRefType.getElementType();
+    Value fZero = create.math.constant(elementType, 0);
+    ArrayRef<int64_t> xShape =
+        inputOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int64_t CI = xShape[1];
+    int64_t CO = yShape[1];
+    int64_t HO = yShape[2], WO = yShape[3];
+    int64_t TH = llvm::divideCeil(HO, m), TW = llvm::divideCeil(WO, m);
+    int64_t numTiles = TH * TW;
+    int64_t padH = shapeHelper.pads[0].getLiteral();
+    int64_t padW = shapeHelper.pads[1].getLiteral();
+    // The tiles on the borders of the output are partial.
+    bool hasPartialTiles = (HO % m != 0) || (WO % m != 0);
+
+    // Transformed filter, [alpha^2, CO, CI].
+    Value U = transformConstantFilter(filterOperand, wt, elementType, rewriter,
+        loc);
+    if (!U) {
+      MemRefType uType = MemRefType::get({alpha2, CO, CI}, elementType);
+      U = create.mem.alignedAlloc(uType);
+      ValueRange filterLoops = create.krnl.defineLoops(2);
+      create.krnl.iterateIE(filterLoops, filterLoops,
+          {LiteralIndexExpr(0), LiteralIndexExpr(0)},
+          {LiteralIndexExpr(CO), LiteralIndexExpr(CI)},
+          [&](KrnlBuilder &createKrnl, ValueRange filterIndices) {
+            MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+            Value co(filterIndices[0]), ci(filterIndices[1]);
+            SmallVector<Value, 9> g;
+            for (int64_t i = 0; i < 3; ++i)
+              for (int64_t j = 0; j < 3; ++j)
+                g.emplace_back(create.krnl.load(filterOperand,
+                    {co, ci, create.math.constantIndex(i),
+                        create.math.constantIndex(j)}));
+            // u = G * g * GT, the transform of the filter being the one of
+            // the inputs with G instead of BT, on a 3x3 matrix.
+            SmallVector<Value, 36> gGT, u;
+            for (int64_t i = 0; i < 3; ++i)
+              for (int64_t j = 0; j < alpha; ++j)
+                gGT.emplace_back(emitLinearCombination(create.math,
+                    wt.G.slice(j * 3, 3), ArrayRef<Value>(g).slice(i * 3, 3),
+                    fZero));
+            for (int64_t i = 0; i < alpha; ++i)
+              for (int64_t j = 0; j < alpha; ++j) {
+                SmallVector<Value, 3> col;
+                for (int64_t k = 0; k < 3; ++k)
+                  col.emplace_back(gGT[k * alpha + j]);
+                u.emplace_back(emitLinearCombination(
+                    create.math, wt.G.slice(i * 3, 3), col, fZero));
+              }
+            for (int64_t xi = 0; xi < alpha2; ++xi)
+              create.krnl.store(
+                  u[xi], U, {create.math.constantIndex(xi), co, ci});
+          });
+    }
+
+    // Transformed input and output tiles of an image.
+    MemRefType vType = MemRefType::get({alpha2, CI, numTiles}, elementType);
+    Value V = create.mem.alignedAlloc(vType);
+    MemRefType mType = MemRefType::get({alpha2, CO, numTiles}, elementType);
+    Value M = create.mem.alignedAlloc(mType);
+
+    // Tile sizes of krnl.matmul, with simdization along the tiles, the same
+    // as for the MatMul of 2D matrices.
+    int64_t iRegTile = std::min<int64_t>(4, CO);
+    int64_t jRegTile = 8;
+    int64_t kRegTile = std::min<int64_t>(8, CI);
+    bool simdize = numTiles >= jRegTile;
+    Value zero = create.math.constantIndex(0);
+    Value I = create.math.constantIndex(CO);
+    Value J = create.math.constantIndex(numTiles);
+    Value K = create.math.constantIndex(CI);
+
+    // Emit the tiled I, J, K loops of M[xi] = U[xi] * V[xi].
+    auto emitTiledMatmul = [&](KrnlBuilder &createKrnl, Value xi) {
+      ValueRange origLoop = createKrnl.defineLoops(3);
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      ValueRange iRegBlock = createKrnl.block(ii, iRegTile);
+      Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
+      ValueRange jRegBlock = createKrnl.block(jj, jRegTile);
+      Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
+      ValueRange kRegBlock = createKrnl.block(kk, kRegTile);
+      Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
+      createKrnl.permute({ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
+      createKrnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {zero, zero, zero},
+          {I, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
+            createKrnl.matmul(U, {xi, zero, zero}, V, {xi, zero, zero}, M,
+                {xi, zero, zero}, {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
+                {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
+                /*unroll*/ true, /*overCompute*/ false);
+          });
+    };
+
+    // for n = 0 .. N:
+    ValueRange batchLoop = create.krnl.defineLoops(1);
+    create.krnl.iterateIE(batchLoop, batchLoop, {LiteralIndexExpr(0)},
+        {LiteralIndexExpr(yShape[0])},
+        [&](KrnlBuilder &createKrnl, ValueRange batchIndices) {
+          Value n = batchIndices[0];
+          // Transform the input tiles.
+          // for ci = 0 .. CI, th = 0 .. TH, tw = 0 .. TW:
+          ValueRange inputLoops = createKrnl.defineLoops(3);
+          createKrnl.iterateIE(inputLoops, inputLoops,
+              {LiteralIndexExpr(0), LiteralIndexExpr(0), LiteralIndexExpr(0)},
+              {LiteralIndexExpr(CI), LiteralIndexExpr(TH),
+                  LiteralIndexExpr(TW)},
+              [&](KrnlBuilder &createKrnl, ValueRange tileIndices) {
+                IndexExprScope tileScope(createKrnl);
+                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                    createKrnl);
+                DimIndexExpr ci(tileIndices[0]);
+                DimIndexExpr th(tileIndices[1]), tw(tileIndices[2]);
+                // Load the input tile, clamped into the image so that it can
+                // always be loaded, the padding being then selected out.
+                SmallVector<Value, 36> d;
+                for (int64_t i = 0; i < alpha; ++i)
+                  for (int64_t j = 0; j < alpha; ++j) {
+                    IndexExpr h = th * m + (i - padH);
+                    IndexExpr w = tw * m + (j - padW);
+                    IndexExpr inBounds = (h >= 0) & (h < xShape[2]) &
+                                         (w >= 0) & (w < xShape[3]);
+                    h = IndexExpr::min(IndexExpr::max(h, 0), xShape[2] - 1);
+                    w = IndexExpr::min(IndexExpr::max(w, 0), xShape[3] - 1);
+                    Value image = create.krnl.loadIE(
+                        inputOperand, {DimIndexExpr(n), ci, h, w});
+                    d.emplace_back(
+                        create.math.select(inBounds.getValue(), image, fZero));
+                  }
+                SmallVector<Value, 36> v;
+                emitWinogradTransform(
+                    create.math, wt.BT, alpha, alpha, d, fZero, v);
+                IndexExpr t = th * TW + tw;
+                for (int64_t xi = 0; xi < alpha2; ++xi)
+                  create.krnl.storeIE(v[xi], V, {LiteralIndexExpr(xi), ci, t});
+              });
+
+          // Multiply the transformed filter and input tiles.
+          // for xi = 0 .. alpha^2:
+          createKrnl.memset(M, fZero);
+          if (enableParallel) {
+            // The alpha^2 matrix multiplications are independent.
+            MultiDialectBuilder<MathBuilder, SCFBuilder> create(createKrnl);
+            create.scf.parallelLoop({zero},
+                {create.math.constantIndex(alpha2)},
+                {create.math.constantIndex(1)},
+                [&](SCFBuilder &createSCF, ValueRange parIndices) {
+                  // The krnl.region is an affine scope, in which the
+                  // induction variable of the parallel loop is a symbol.
+                  OpBuilder &builder = createSCF.getBuilder();
+                  KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+                  OpBuilder::InsertionGuard insertGuard(builder);
+                  builder.setInsertionPointToStart(
+                      &regionOp.getBodyRegion().front());
+                  KrnlBuilder createKrnl(builder, loc);
+                  emitTiledMatmul(createKrnl, parIndices[0]);
+                });
+          } else {
+            ValueRange xiLoop = createKrnl.defineLoops(1);
+            createKrnl.iterateIE(xiLoop, xiLoop, {LiteralIndexExpr(0)},
+                {LiteralIndexExpr(alpha2)},
+                [&](KrnlBuilder &createKrnl, ValueRange xiIndices) {
+                  emitTiledMatmul(createKrnl, xiIndices[0]);
+                });
+          }
+
+          // Transform the output tiles, add the bias and apply the fused
+          // activations, if any.
+          // for co = 0 .. CO, th = 0 .. TH, tw = 0 .. TW:
+          ValueRange outputLoops = createKrnl.defineLoops(3);
+          createKrnl.iterateIE(outputLoops, outputLoops,
+              {LiteralIndexExpr(0), LiteralIndexExpr(0), LiteralIndexExpr(0)},
+              {LiteralIndexExpr(CO), LiteralIndexExpr(TH),
+                  LiteralIndexExpr(TW)},
+              [&](KrnlBuilder &createKrnl, ValueRange tileIndices) {
+                IndexExprScope tileScope(createKrnl);
+                MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder>
+                    create(createKrnl);
+                DimIndexExpr co(tileIndices[0]);
+                DimIndexExpr th(tileIndices[1]), tw(tileIndices[2]);
+                IndexExpr t = th * TW + tw;
+                SmallVector<Value, 36> mTile;
+                for (int64_t xi = 0; xi < alpha2; ++xi)
+                  mTile.emplace_back(
+                      create.krnl.loadIE(M, {LiteralIndexExpr(xi), co, t}));
+                SmallVector<Value, 16> y;
+                emitWinogradTransform(
+                    create.math, wt.AT, m, alpha, mTile, fZero, y);
+                Value bias;
+                if (hasBias)
+                  bias = create.krnl.loadIE(biasOperand, {co});
+                for (int64_t i = 0; i < m; ++i)
+                  for (int64_t j = 0; j < m; ++j) {
+                    Value result = y[i * m + j];
+                    if (hasBias)
+                      result = create.math.add(result, bias);
+                    result =
+                        applyConvActivations(create.math, activations, result);
+                    IndexExpr ho = th * m + i;
+                    IndexExpr wo = tw * m + j;
+                    SmallVector<IndexExpr, 4> resAccessFct = {
+                        DimIndexExpr(n), co, ho, wo};
+                    if (!hasPartialTiles) {
+                      create.krnl.storeIE(result, alloc, resAccessFct);
+                      continue;
+                    }
+                    IndexExpr inOutput = (ho < HO) & (wo < WO);
+                    create.scf.ifThenElse(
+                        inOutput.getValue(), [&](SCFBuilder &createSCF) {
+                          KrnlBuilder createKrnl(createSCF);
+                          createKrnl.storeIE(result, alloc, resAccessFct);
+                        });
+                  }
+              });
+        });
+  }
+
+  // Determine if the convolution is a depthwise 2D convolution, with a single
+  // filter per input channel, lowered with the output columns vectorized. Only
+  // f32 convolutions of static shapes are supported, when tiling is enabled.
+  bool useDepthwise(CONV_OP convOp, OpAdaptor &operandAdaptor,
+      ShapeHelper &shapeHelper, MemRefType memRefType) const {
+    int64_t groupNum = convOp.getGroup();
+    if (!enableTiling || groupNum == 1 || memRefType.getRank() != 4 ||
+        !memRefType.getElementType().isF32())
+      return false;
+    auto xType = operandAdaptor.getX().getType().template cast<MemRefType>();
+    auto wType = operandAdaptor.getW().getType().template cast<MemRefType>();
+    if (!xType.hasStaticShape() || !wType.hasStaticShape() ||
+        !memRefType.hasStaticShape())
+      return false;
+    if (!hasIdentityLayouts(operandAdaptor, memRefType))
+      return false;
+    for (IndexExpr pad : shapeHelper.pads)
+      if (!pad.isLiteral())
+        return false;
+    return xType.getShape()[1] == groupNum && wType.getShape()[1] == 1 &&
+           memRefType.getShape()[1] == groupNum;
+  }
+
+  // Lower a depthwise 2D convolution, whose output channel c only depends on
+  // the input channel c:
+  //   Y[n, c, ho, wo] = B[c] + sum_{kh, kw} W[c, 0, kh, kw] *
+  //       X[n, c, ho * sh + kh * dh - ph, wo * sw + kw * dw - pw]
+  // The KH * KW taps of the filter are unrolled, with their weights loaded
+  // once per channel. The output columns whose taps are all in the columns of
+  // the image are computed VL at a time with vector loads and fmas, the ones
+  // reaching into the padding one at a time. The taps in the padding load
+  // from a position clamped into the image, and the loaded values are then
+  // selected out.
+  void convDepthwise(ConversionPatternRewriter &rewriter, CONV_OP &convOp,
+      OpAdaptor &operandAdaptor, ShapeHelper &shapeHelper,
+      ArrayRef<ConvActivation> activations, MemRefType &memRefType,
+      Value alloc) const {
+    Location loc = convOp.getLoc();
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder, VectorBuilder>
+        create(rewriter, loc);
+
+    Value inputOperand = operandAdaptor.getX();
+    Value filterOperand = operandAdaptor.getW();
+    Value biasOperand = operandAdaptor.getB();
+    bool hasBias = !biasOperand.getType().isa<NoneType>();
+    Type elementType = memRefType.getElementType();
+    ArrayRef<int64_t> xShape =
+        inputOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> wShape =
+        filterOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int64_t H = xShape[2], W = xShape[3];
+    int64_t KH = wShape[2], KW = wShape[3];
+    int64_t HO = yShape[2], WO = yShape[3];
+    int64_t sh = shapeHelper.strides[0], sw = shapeHelper.strides[1];
+    int64_t dh = shapeHelper.dilations[0], dw = shapeHelper.dilations[1];
+    int64_t ph = shapeHelper.pads[0].getLiteral();
+    int64_t pw = shapeHelper.pads[1].getLiteral();
+
+    // Whether some taps may be in the padding, before or after the image.
+    bool checkRows = ph > 0 || (HO - 1) * sh + (KH - 1) * dh - ph > H - 1;
+    bool checkCols = pw > 0 || (WO - 1) * sw + (KW - 1) * dw - pw > W - 1;
+
+    // The output columns [woLo, woLo + numVec * VL) are computed VL at a time,
+    // each tap loading VL * sw contiguous columns of the image, of which every
+    // sw-th one is kept. A block starting at wo0 requires
+    //   wo0 * sw - pw >= 0
+    //   wo0 * sw + (KW - 1) * dw - pw + VL * sw - 1 <= W - 1.
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    int64_t loadLength = VL * sw;
+    VectorType vecType = VectorType::get({VL}, elementType);
+    VectorType loadType = VectorType::get({loadLength}, elementType);
+    int64_t woLo = std::min<int64_t>(llvm::divideCeil(pw, sw), WO);
+    int64_t maxStart = W - loadLength - (KW - 1) * dw + pw;
+    int64_t numVec = 0;
+    if (maxStart >= woLo * sw)
+      numVec = std::min((maxStart / sw - woLo) / VL + 1, (WO - woLo) / VL);
+    int64_t woVecEnd = woLo + numVec * VL;
+    SmallVector<int64_t, 16> strideMask;
+    for (int64_t i = 0; i < VL; ++i)
+      strideMask.emplace_back(i * sw);
+
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value fZero = create.math.constant(elementType, 0);
+    Value vecZero = create.math.constant(loadType, 0);
+
+    // for n = 0 .. N:
+    //   for c = 0 .. C:
+    auto bodyFunction = [&](ValueRange outerIndices) {
+      Value n(outerIndices[0]), c(outerIndices[1]);
+      // Weights of the taps of the channel, and its bias.
+      SmallVector<Value, 9> weights, weightVecs;
+      for (int64_t kh = 0; kh < KH; ++kh) {
+        for (int64_t kw = 0; kw < KW; ++kw) {
+          Value weight = create.krnl.load(filterOperand,
+              {c, zero, create.math.constantIndex(kh),
+                  create.math.constantIndex(kw)});
+          weights.emplace_back(weight);
+          weightVecs.emplace_back(create.vec.splat(vecType, weight));
+        }
+      }
+      Value bias = hasBias ? create.krnl.load(biasOperand, {c}) : fZero;
+
+      // for ho = 0 .. HO:
+      ValueRange rowLoop = create.krnl.defineLoops(1);
+      create.krnl.iterateIE(rowLoop, rowLoop, {LiteralIndexExpr(0)},
+          {LiteralIndexExpr(HO)},
+          [&](KrnlBuilder &createKrnl, ValueRange rowIndices) {
+            IndexExprScope rowScope(createKrnl);
+            MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+            Value ho = rowIndices[0];
+            // Rows of the taps, clamped into the image, and whether they are
+            // in the image.
+            SmallVector<Value, 3> rows, rowsIn;
+            for (int64_t kh = 0; kh < KH; ++kh) {
+              IndexExpr h = DimIndexExpr(ho) * sh + (kh * dh - ph);
+              if (checkRows) {
+                rowsIn.emplace_back(((h >= 0) & (h < H)).getValue());
+                h = IndexExpr::min(IndexExpr::max(h, 0), H - 1);
+              }
+              rows.emplace_back(h.getValue());
+            }
+
+            // for wo = woLB .. woUB, one output column at a time.
+            auto emitScalarColumns = [&](int64_t woLB, int64_t woUB) {
+              if (woLB >= woUB)
+                return;
+              ValueRange colLoop = create.krnl.defineLoops(1);
+              create.krnl.iterateIE(colLoop, colLoop,
+                  {LiteralIndexExpr(woLB)}, {LiteralIndexExpr(woUB)},
+                  [&](KrnlBuilder &createKrnl, ValueRange colIndices) {
+                    IndexExprScope colScope(createKrnl);
+                    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                        createKrnl);
+                    Value wo = colIndices[0];
+                    Value result = bias;
+                    for (int64_t kw = 0; kw < KW; ++kw) {
+                      IndexExpr w = DimIndexExpr(wo) * sw + (kw * dw - pw);
+                      Value colIn;
+                      if (checkCols) {
+                        colIn = ((w >= 0) & (w < W)).getValue();
+                        w = IndexExpr::min(IndexExpr::max(w, 0), W - 1);
+                      }
+                      for (int64_t kh = 0; kh < KH; ++kh) {
+                        Value image = create.krnl.load(
+                            inputOperand, {n, c, rows[kh], w.getValue()});
+                        Value isIn = colIn;
+                        if (checkRows)
+                          isIn = colIn ? create.math.andi(colIn, rowsIn[kh])
+                                       : rowsIn[kh];
+                        if (isIn)
+                          image = create.math.select(isIn, image, fZero);
+                        Value weight = weights[kh * KW + kw];
+                        result = create.math.add(
+                            result, create.math.mul(image, weight));
+                      }
+                    }
+                    result =
+                        applyConvActivations(create.math, activations, result);
+                    create.krnl.store(result, alloc, {n, c, ho, wo});
+                  });
+            };
+
+            // Output columns on the left side, reaching into the padding.
+            emitScalarColumns(0, woLo);
+
+            // for wo = woLo .. woVecEnd step VL, VL output columns at a time.
+            if (numVec > 0) {
+              ValueRange vecLoop = create.krnl.defineLoops(1);
+              ValueRange blockedVecLoop = create.krnl.block(vecLoop[0], VL);
+              create.krnl.iterateIE(vecLoop, {blockedVecLoop[0]},
+                  {LiteralIndexExpr(woLo)}, {LiteralIndexExpr(woVecEnd)},
+                  [&](KrnlBuilder &createKrnl, ValueRange vecIndices) {
+                    IndexExprScope vecScope(createKrnl);
+                    MultiDialectBuilder<KrnlBuilder, MathBuilder,
+                        VectorBuilder>
+                        create(createKrnl);
+                    Value wo = vecIndices[0];
+                    Value result = create.vec.splat(vecType, bias);
+                    for (int64_t kw = 0; kw < KW; ++kw) {
+                      IndexExpr w = DimIndexExpr(wo) * sw + (kw * dw - pw);
+                      for (int64_t kh = 0; kh < KH; ++kh) {
+                        Value image = create.vec.load(loadType, inputOperand,
+                            {n, c, rows[kh], w.getValue()});
+                        if (checkRows)
+                          image =
+                              create.math.select(rowsIn[kh], image, vecZero);
+                        if (sw > 1)
+                          image = create.vec.shuffle(image, image, strideMask);
+                        result = create.vec.fma(
+                            image, weightVecs[kh * KW + kw], result);
+                      }
+                    }
+                    result =
+                        applyConvActivations(create.math, activations, result);
+                    create.vec.store(result, alloc, {n, c, ho, wo});
+                  });
+            }
+
+            // Remaining output columns, on the right side.
+            emitScalarColumns(woVecEnd, WO);
+          });
+    };
+
+    Value N = create.math.constantIndex(yShape[0]);
+    Value C = create.math.constantIndex(yShape[1]);
+    if (enableParallel) {
+      create.scf.parallelLoop({zero, zero}, {N, C}, {one, one},
+          [&](SCFBuilder &create, ValueRange outerIndices) {
+            bodyFunction(outerIndices);
+          });
+    } else {
+      ValueRange outerLoops = create.krnl.defineLoops(2);
+      create.krnl.iterate(outerLoops, outerLoops, {zero, zero}, {N, C},
+          [&](KrnlBuilder &create, ValueRange outerIndices) {
+            bodyFunction(outerIndices);
+          });
+    }
+  }
+
+  // Determine if the convolution is lowered to an im2col buffer multiplied by
+  // the filter with krnl.matmul, whose tiled SIMD kernel outperforms the
+  // direct loop nest for large enough convolutions. Only f32 convolutions of
+  // static shapes with a single group are supported, when tiling is enabled.
+  bool useIm2Col(CONV_OP convOp, OpAdaptor &operandAdaptor,
+      ShapeHelper &shapeHelper, MemRefType memRefType) const {
+    if (!enableTiling || convOp.getGroup() != 1 ||
+        !memRefType.getElementType().isF32())
+      return false;
+    auto xType = operandAdaptor.getX().getType().template cast<MemRefType>();
+    auto wType = operandAdaptor.getW().getType().template cast<MemRefType>();
+    if (!xType.hasStaticShape() || !wType.hasStaticShape() ||
+        !memRefType.hasStaticShape())
+      return false;
+    if (!hasIdentityLayouts(operandAdaptor, memRefType))
+      return false;
+    for (IndexExpr pad : shapeHelper.pads)
+      if (!pad.isLiteral())
+        return false;
+    ArrayRef<int64_t> wShape = wType.getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int64_t reductionSize = wShape[1];
+    int64_t outputSize = 1;
+    for (size_t i = 2; i < yShape.size(); ++i) {
+      reductionSize *= wShape[i];
+      outputSize *= yShape[i];
+    }
+    return reductionSize >= kIm2ColMinReductionSize &&
+           yShape[1] >= kIm2ColMinChannelOut &&
+           outputSize >= kIm2ColMinOutputSize &&
+           reductionSize * outputSize <= kIm2ColMaxBufferSize;
+  }
+
+  // Lower the convolution of each image of the batch to a matrix
+  // multiplication:
+  //   col[ci * KH * KW + kh * KW + kw, ho * WO + wo] =
+  //       X[n, ci, ho * sh + kh * dh - ph, wo * sw + kw * dw - pw]
+  //   Y[n] = reshape(W, [CO, CI * KH * KW]) * col + B
+  // where col is zero for the positions in the padding. The bias initializes
+  // the output accumulated into by krnl.matmul, and the activations, if any,
+  // are applied by a last sweep over the output of the image.
+  void convIm2Col(ConversionPatternRewriter &rewriter, CONV_OP &convOp,
+      OpAdaptor &operandAdaptor, ShapeHelper &shapeHelper,
+      ArrayRef<ConvActivation> activations, MemRefType &memRefType,
+      Value alloc, Value nhwcInput) const {
+    Location loc = convOp.getLoc();
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        rewriter, loc);
+    // Spatial data starts from the second dimension.
+    int spatialStartIndex = 2;
+
+    Value inputOperand = operandAdaptor.getX();
+    Value filterOperand = operandAdaptor.getW();
+    Value biasOperand = operandAdaptor.getB();
+    bool hasBias = !biasOperand.getType().isa<NoneType>();
+    Type elementType = memRefType.getElementType();
+    Value fZero = create.math.constant(elementType, 0);
+    ArrayRef<int64_t> xShape =
+        inputOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> wShape =
+        filterOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int outputRank = yShape.size();
+    int spacialRank = outputRank - spatialStartIndex;
+
+    // Sizes of the matrix multiplication of each image:
+    // [CO x CI * KH * KW] * [CI * KH * KW x HO * WO] = [CO x HO * WO].
+    int64_t CI = wShape[1];
+    int64_t CO = yShape[1];
+    int64_t reductionSize = CI;
+    int64_t outputSize = 1;
+    for (int i = spatialStartIndex; i < outputRank; ++i) {
+      reductionSize *= wShape[i];
+      outputSize *= yShape[i];
+    }
+    bool hasPadding = llvm::any_of(
+        shapeHelper.pads, [](IndexExpr pad) { return pad.getLiteral() != 0; });
+
+    // Views of the filter and of the output as matrices, and the im2col
+    // buffer, reused by all the images of the batch.
+    SmallVector<IndexExpr, 2> filterDims = {
+        LiteralIndexExpr(CO), LiteralIndexExpr(reductionSize)};
+    Value filter = create.mem.reinterpretCast(filterOperand, filterDims);
+    SmallVector<IndexExpr, 3> resDims = {LiteralIndexExpr(yShape[0]),
+        LiteralIndexExpr(CO), LiteralIndexExpr(outputSize)};
+    Value res = create.mem.reinterpretCast(alloc, resDims);
+    MemRefType colType =
+        MemRefType::get({reductionSize, outputSize}, elementType);
+    Value col = create.mem.alignedAlloc(colType);
+
+    // Tile sizes of krnl.matmul, with simdization along the output spatial
+    // dims, the same as for the MatMul of 2D matrices.
+    int64_t iRegTile = std::min<int64_t>(4, CO);
+    int64_t jRegTile = 8;
+    int64_t kRegTile = std::min<int64_t>(8, reductionSize);
+    bool simdize = outputSize >= jRegTile;
+    Value zero = create.math.constantIndex(0);
+    Value I = create.math.constantIndex(CO);
+    Value J = create.math.constantIndex(outputSize);
+    Value K = create.math.constantIndex(reductionSize);
+
+    // Emit the tiled I, J, K loops accumulating rows [iLB, iUB) of the
+    // product of the filter and the im2col buffer into the output of image n.
+    auto emitTiledMatmul = [&](KrnlBuilder &createKrnl, Value n, Value iLB,
+                               Value iUB) {
+      ValueRange origLoop = createKrnl.defineLoops(3);
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      ValueRange iRegBlock = createKrnl.block(ii, iRegTile);
+      Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
+      ValueRange jRegBlock = createKrnl.block(jj, jRegTile);
+      Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
+      ValueRange kRegBlock = createKrnl.block(kk, kRegTile);
+      Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
+      createKrnl.permute({ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
+      createKrnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {iLB, zero, zero},
+          {iUB, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
+            createKrnl.matmul(filter, {zero, zero}, col, {zero, zero}, res,
+                {n, zero, zero}, {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
+                {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
+                /*unroll*/ true, /*overCompute*/ false);
+          });
+    };
+
+    // for n = 0 .. N:
+    ValueRange batchLoop = create.krnl.defineLoops(1);
+    create.krnl.iterateIE(batchLoop, batchLoop, {LiteralIndexExpr(0)},
+        {LiteralIndexExpr(yShape[0])},
+        [&](KrnlBuilder &createKrnl, ValueRange batchIndices) {
+          Value n = batchIndices[0];
+          // Fill the im2col buffer.
+          // for ci = 0 .. CI:
+          //   for kh = 0 .. KH, kw = 0 .. KW:
+          //     for ho = 0 .. HO, wo = 0 .. WO:
+          ValueRange colLoops = createKrnl.defineLoops(1 + 2 * spacialRank);
+          SmallVector<IndexExpr, 7> colLbs, colUbs;
+          colLbs.emplace_back(LiteralIndexExpr(0));
+          colUbs.emplace_back(LiteralIndexExpr(CI));
+          for (int i = spatialStartIndex; i < outputRank; ++i) {
+            colLbs.emplace_back(LiteralIndexExpr(0));
+            colUbs.emplace_back(LiteralIndexExpr(wShape[i]));
+          }
+          for (int i = spatialStartIndex; i < outputRank; ++i) {
+            colLbs.emplace_back(LiteralIndexExpr(0));
+            colUbs.emplace_back(LiteralIndexExpr(yShape[i]));
+          }
+          createKrnl.iterateIE(colLoops, colLoops, colLbs, colUbs,
+              [&](KrnlBuilder &createKrnl, ValueRange colIndices) {
+                IndexExprScope colScope(createKrnl);
+                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                    createKrnl);
+                DimIndexExpr ci(colIndices[0]);
+                IndexExpr row = ci;
+                IndexExpr column = LiteralIndexExpr(0);
+                IndexExpr inBounds;
+                SmallVector<IndexExpr, 4> inputAccessFct;
+                inputAccessFct.emplace_back(DimIndexExpr(n));
+                inputAccessFct.emplace_back(ci);
+                for (int i = 0; i < spacialRank; ++i) {
+                  DimIndexExpr k(colIndices[1 + i]);
+                  DimIndexExpr o(colIndices[1 + spacialRank + i]);
+                  row = row * wShape[spatialStartIndex + i] + k;
+                  column = column * yShape[spatialStartIndex + i] + o;
+                  // Position o * s + k * d - p in the image, clamped into it
+                  // when the convolution is padded so that it can always be
+                  // loaded, the padding being then selected out.
+                  IndexExpr t = o * shapeHelper.strides[i] +
+                                k * shapeHelper.dilations[i] -
+                                shapeHelper.pads[i].getLiteral();
+                  if (hasPadding) {
+                    int64_t inputSize = xShape[spatialStartIndex + i];
+                    IndexExpr isIn = (t >= 0) & (t < inputSize);
+                    inBounds = (i == 0) ? isIn : (inBounds & isIn);
+                    t = IndexExpr::min(IndexExpr::max(t, 0), inputSize - 1);
+                  }
+                  inputAccessFct.emplace_back(t);
+                }
+                Value image = loadConvInput(create.krnl, create.math,
+                    inputOperand, nhwcInput, inputAccessFct, elementType);
+                if (hasPadding)
+                  image = create.math.select(inBounds.getValue(), image, fZero);
+                create.krnl.storeIE(image, col, {row, column});
+              });
+
+          // Initialize the output of the image with the bias, or zero.
+          // for co = 0 .. CO:
+          //   for p = 0 .. HO * WO:
+          ValueRange initLoops = createKrnl.defineLoops(2);
+          createKrnl.iterate(initLoops, initLoops, {zero, zero}, {I, J},
+              [&](KrnlBuilder &createKrnl, ValueRange initIndices) {
+                Value co(initIndices[0]), p(initIndices[1]);
+                Value init =
+                    hasBias ? createKrnl.load(biasOperand, {co}) : fZero;
+                createKrnl.store(init, res, {n, co, p});
+              });
+
+          // Accumulate filter * col into the output of the image.
+          if (enableParallel) {
+            // Distribute the blocks of iRegTile output channels among the
+            // threads, each writing a disjoint set of rows of the output.
+            MultiDialectBuilder<MathBuilder, SCFBuilder> create(createKrnl);
+            Value iStep = create.math.constantIndex(iRegTile);
+            create.scf.parallelLoop({zero}, {I}, {iStep},
+                [&](SCFBuilder &createSCF, ValueRange parIndices) {
+                  // The krnl.region is an affine scope, in which the
+                  // induction variable of the parallel loop is a symbol.
+                  OpBuilder &builder = createSCF.getBuilder();
+                  KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+                  OpBuilder::InsertionGuard insertGuard(builder);
+                  builder.setInsertionPointToStart(
+                      &regionOp.getBodyRegion().front());
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      builder, loc);
+                  Value iLB = parIndices[0];
+                  Value iUB = create.math.min(create.math.add(iLB, iStep), I);
+                  emitTiledMatmul(create.krnl, n, iLB, iUB);
+                });
+          } else {
+            emitTiledMatmul(createKrnl, n, zero, I);
+          }
+
+          // Apply the fused activations, if any, to the output of the image.
+          if (activations.empty())
+            return;
+          ValueRange actLoops = createKrnl.defineLoops(2);
+          createKrnl.iterate(actLoops, actLoops, {zero, zero}, {I, J},
+              [&](KrnlBuilder &createKrnl, ValueRange actIndices) {
+                MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                    createKrnl);
+                Value co(actIndices[0]), p(actIndices[1]);
+                Value result = create.krnl.load(res, {n, co, p});
+                result = applyConvActivations(create.math, activations, result);
+                create.krnl.store(result, res, {n, co, p});
+              });
+        });
+  }
+
+  LogicalResult matchAndRewrite(CONV_OP convOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
     Operation *op = convOp.getOperation();
-    Location loc = ONNXLoc<ONNXConvOp>(op);
+    Location loc = ONNXLoc<CONV_OP>(op);
     ValueRange operands = adaptor.getOperands();
 
     // Get shape.
     MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
         rewriter, loc);
 
-    ONNXConvOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    ShapeHelper shapeHelper(op, operands, &create.krnlIE);
     shapeHelper.computeShapeAndAssertOnFailure();
 
+    SmallVector<ConvActivation, 2> activations;
+    getConvActivations(convOp, activations);
+
     // Convert the output type to MemRefType.
-    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    Type convertedType =
+        this->typeConverter->convertType(*op->result_type_begin());
     assert(convertedType && convertedType.isa<MemRefType>() &&
            "Failed to convert type to MemRefType");
     MemRefType memRefType = convertedType.cast<MemRefType>();
@@ -250,7 +1390,32 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
     Value alloc =
         create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
 
-    convUnoptimized(rewriter, convOp, adaptor, shapeHelper, memRefType, alloc);
+    // The NHWC tensor read on load in place of the input, if any, by the
+    // im2col and direct lowerings.
+    Value nhwcInput;
+    Value X = convOp.getX();
+    if (auto transposeOp = X.getDefiningOp<ONNXTransposeOp>())
+      if (isCastAndTransposedOnLoad(transposeOp)) {
+        auto castOp = transposeOp.getData().getDefiningOp<ONNXCastOp>();
+        nhwcInput = rewriter.getRemappedValue(castOp.getInput());
+        assert(nhwcInput && nhwcInput.getType().isa<MemRefType>() &&
+               "expected the NHWC input to be converted to a memref");
+      }
+
+    int64_t winogradTileSize;
+    if (!nhwcInput && useWinograd(convOp, adaptor, shapeHelper, memRefType,
+                          winogradTileSize))
+      convWinograd(rewriter, convOp, adaptor, shapeHelper, activations,
+          memRefType, alloc, winogradTileSize);
+    else if (useDepthwise(convOp, adaptor, shapeHelper, memRefType))
+      convDepthwise(rewriter, convOp, adaptor, shapeHelper, activations,
+          memRefType, alloc);
+    else if (useIm2Col(convOp, adaptor, shapeHelper, memRefType))
+      convIm2Col(rewriter, convOp, adaptor, shapeHelper, activations,
+          memRefType, alloc, nhwcInput);
+    else
+      convUnoptimized(rewriter, convOp, adaptor, shapeHelper, activations,
+          memRefType, alloc, nhwcInput);
 
     rewriter.replaceOp(op, alloc);
     return success();
@@ -258,8 +1423,13 @@ struct ONNXConvOpLowering : public OpConversionPattern<ONNXConvOp> {
 };
 
 void populateLoweringONNXConvOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
-  patterns.insert<ONNXConvOpLowering>(typeConverter, ctx, enableParallel);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling,
+    bool enableParallel, int64_t convWinogradThreshold) {
+  patterns.insert<ONNXConvOpLowering<ONNXConvOp>,
+      ONNXConvOpLowering<ONNXFusedConvOp>>(typeConverter, ctx, enableTiling,
+      enableParallel, convWinogradThreshold);
+  patterns.insert<ONNXCastTransposedOnLoadOpLowering,
+      ONNXTransposedOnLoadOpLowering>(typeConverter, ctx);
 }
 
 } // namespace onnx_mlir
@@ -0,0 +1,532 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------- ConvTranspose.cpp - Lowering ConvTranspose Op -------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX ConvTranspose Operator to Krnl dialect. Each input
+// value, multiplied by the filter, is scattered into the output positions
+// i * s + k * d - p it contributes to. The 2D f32 transposed convolutions of
+// static shapes are lowered to a multiplication of the transposed filter by
+// the input with krnl.matmul, whose result is scattered into the output by a
+// col2im vectorized along the output width, and the other ones to a direct
+// loop nest.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Maximum number of elements of the column buffer, which holds the
+// contributions of one group of one image of the batch at a time.
+const int64_t kConvTransposeMaxBufferSize = 16 * 1024 * 1024;
+
+} // namespace
+
+struct ONNXConvTransposeOpLowering
+    : public OpConversionPattern<ONNXConvTransposeOp> {
+  ONNXConvTransposeOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableTiling, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableTiling(enableTiling),
+        enableParallel(enableParallel) {}
+  bool enableTiling;
+  bool enableParallel;
+
+  // Initialize the output with the bias of its channels, or zero, the
+  // contributions of the input being then accumulated into it.
+  void initOutput(ConversionPatternRewriter &rewriter, Location loc,
+      Value biasOperand, ONNXConvTransposeOpShapeHelper &shapeHelper,
+      MemRefType memRefType, Value alloc) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+    if (biasOperand.getType().isa<NoneType>()) {
+      create.krnl.memset(
+          alloc, create.math.constant(memRefType.getElementType(), 0));
+      return;
+    }
+    int64_t rank = memRefType.getRank();
+    ValueRange loopDef = create.krnl.defineLoops(rank);
+    SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, shapeHelper.getOutputDims(),
+        [&](KrnlBuilder &createKrnl, ValueRange indices) {
+          Value bias = createKrnl.load(biasOperand, {indices[1]});
+          createKrnl.store(bias, alloc, indices);
+        });
+  }
+
+  // Accumulate, for each image n, group g and output channel co of the group
+  //   Y[n, g * COPerGroup + co, i * s + k * d - p] +=
+  //       X[n, g * CIPerGroup + ci, i] * W[g * CIPerGroup + ci, co, k]
+  // over the input channels ci of the group, the kernel positions k, and the
+  // input positions i whose output position is in the output.
+  void convTransposeUnoptimized(ConversionPatternRewriter &rewriter,
+      ONNXConvTransposeOp convTransposeOp,
+      ONNXConvTransposeOpAdaptor &operandAdaptor,
+      ONNXConvTransposeOpShapeHelper &shapeHelper, Value alloc) const {
+    Location loc = convTransposeOp.getLoc();
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, SCFBuilder,
+        MathBuilder>
+        create(rewriter, loc);
+    // Spatial data starts from the second dimension.
+    int spatialStartIndex = 2;
+
+    Value inputOperand = operandAdaptor.getX();
+    Value filterOperand = operandAdaptor.getW();
+    int64_t groupNum = convTransposeOp.getGroup();
+    IndexExpr G = LiteralIndexExpr(groupNum);
+    int outputRank = shapeHelper.getOutputDims().size();
+    int spacialRank = outputRank - spatialStartIndex;
+
+    // Bounds for input image X: [N x CI x HI x WI] and kernel/filter W:
+    // [CI x COPerGroup x KH x KW], with CI a multiple of the group num.
+    IndexExpr N = shapeHelper.getOutputDims()[0];
+    IndexExpr CIPerGroup =
+        create.krnlIE.getShapeAsSymbol(inputOperand, 1).floorDiv(G);
+    IndexExpr COPerGroup = create.krnlIE.getShapeAsSymbol(filterOperand, 1);
+    IndexExpr iZero = LiteralIndexExpr(0);
+    IndexExpr iOne = LiteralIndexExpr(1);
+
+    SmallVector<Value, 3> lbsStorage, ubsStorage, stepsStorage;
+    SmallVector<IndexExpr, 3> outerLbs = {iZero, iZero, iZero};
+    SmallVector<IndexExpr, 3> outerUbs = {N, G, COPerGroup};
+    SmallVector<IndexExpr, 3> outerSteps = {iOne, iOne, iOne};
+    IndexExpr::getValues(outerLbs, lbsStorage);
+    IndexExpr::getValues(outerUbs, ubsStorage);
+    IndexExpr::getValues(outerSteps, stepsStorage);
+
+    // for n = 0 .. N:
+    //   for g = 0 .. G:
+    //     for coPerGroup = 0 .. COPerGroup:
+    //       co = g * COPerGroup + coPerGroup;
+    // Each iteration writes a distinct output channel.
+    auto bodyFunction = [&](ValueRange outerIndices) {
+      IndexExprScope outerScope(create.krnl);
+      DimIndexExpr n(outerIndices[0]);
+      DimIndexExpr g(outerIndices[1]);
+      DimIndexExpr coPerGroup(outerIndices[2]);
+      IndexExpr co = g * SymbolIndexExpr(COPerGroup) + coPerGroup;
+      IndexExpr gTimesCIPerGroup = g * SymbolIndexExpr(CIPerGroup);
+
+      // for ciPerGroup = 0 .. CIPerGroup:
+      //   for kh = 0 .. KH, kw = 0 .. KW:
+      ValueRange redLoops = create.krnl.defineLoops(spacialRank + 1);
+      SmallVector<IndexExpr, 4> redLbs, redUbs;
+      redLbs.emplace_back(iZero);
+      redUbs.emplace_back(SymbolIndexExpr(CIPerGroup));
+      for (int i = 0; i < spacialRank; ++i) {
+        redLbs.emplace_back(iZero);
+        redUbs.emplace_back(SymbolIndexExpr(shapeHelper.kernelShape[i]));
+      }
+      create.krnl.iterateIE(redLoops, redLoops, redLbs, redUbs,
+          [&](KrnlBuilder &createKrnl, ValueRange redIndices) {
+            IndexExprScope redScope(createKrnl);
+            MultiDialectBuilder<KrnlBuilder, MathBuilder> create(createKrnl);
+            DimIndexExpr ciPerG(redIndices[0]);
+            IndexExpr ci = SymbolIndexExpr(gTimesCIPerGroup) + ciPerG;
+            // Filter: [ci, coPerGroup, kh, kw].
+            SmallVector<IndexExpr, 4> filterAccessFct;
+            filterAccessFct.emplace_back(ci);
+            filterAccessFct.emplace_back(DimIndexExpr(coPerGroup));
+            for (int i = 0; i < spacialRank; ++i)
+              filterAccessFct.emplace_back(DimIndexExpr(redIndices[1 + i]));
+            Value filter = create.krnl.loadIE(filterOperand, filterAccessFct);
+
+            // Bounds of the input positions i whose output position
+            // o = i * s - (p - k * d) is in [0, O):
+            //   ceil((p - k * d) / s) <= i < floor((O - 1 + p - k * d) / s) + 1
+            ValueRange inputLoops = create.krnl.defineLoops(spacialRank);
+            SmallVector<IndexExpr, 3> inputLbs, inputUbs, pMinKD;
+            for (int i = 0; i < spacialRank; ++i) {
+              DimIndexExpr k(redIndices[1 + i]);
+              SymbolIndexExpr I(create.krnlIE.getShapeAsSymbol(
+                  inputOperand, spatialStartIndex + i));
+              SymbolIndexExpr O(
+                  shapeHelper.getOutputDims()[spatialStartIndex + i]);
+              SymbolIndexExpr p(shapeHelper.pads[i]); // Beginning/left/top pad.
+              int64_t s = shapeHelper.strides[i];
+              IndexExpr pos = p - k * shapeHelper.dilations[i];
+              inputLbs.emplace_back(IndexExpr::max(pos.ceilDiv(s), 0));
+              IndexExpr ub = (pos + O - 1).floorDiv(s) + 1;
+              inputUbs.emplace_back(IndexExpr::min(ub, I));
+              pMinKD.emplace_back(pos);
+            }
+            // for ih = lb .. ub, iw = lb .. ub:
+            create.krnl.iterateIE(inputLoops, inputLoops, inputLbs, inputUbs,
+                [&](KrnlBuilder &createKrnl, ValueRange inputIndices) {
+                  IndexExprScope inputScope(createKrnl);
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      createKrnl);
+                  SmallVector<IndexExpr, 4> inputAccessFct, resAccessFct;
+                  inputAccessFct.emplace_back(DimIndexExpr(n));
+                  inputAccessFct.emplace_back(DimIndexExpr(ci));
+                  resAccessFct.emplace_back(DimIndexExpr(n));
+                  resAccessFct.emplace_back(DimIndexExpr(co));
+                  for (int i = 0; i < spacialRank; ++i) {
+                    DimIndexExpr x(inputIndices[i]);
+                    inputAccessFct.emplace_back(x);
+                    resAccessFct.emplace_back(x * shapeHelper.strides[i] -
+                                              SymbolIndexExpr(pMinKD[i]));
+                  }
+                  Value image =
+                      create.krnl.loadIE(inputOperand, inputAccessFct);
+                  Value res = create.krnl.loadIE(alloc, resAccessFct);
+                  res = create.math.add(res, create.math.mul(image, filter));
+                  create.krnl.storeIE(res, alloc, resAccessFct);
+                });
+          });
+    };
+
+    if (enableParallel) {
+      create.scf.parallelLoop(ValueRange(lbsStorage), ValueRange(ubsStorage),
+          ValueRange(stepsStorage),
+          [&](SCFBuilder &create, ValueRange outerIndices) {
+            bodyFunction(outerIndices);
+          });
+    } else {
+      ValueRange outerLoops = create.krnl.defineLoops(3);
+      create.krnl.iterateIE(outerLoops, outerLoops, outerLbs, outerUbs,
+          [&](KrnlBuilder &create, ValueRange outerIndices) {
+            bodyFunction(outerIndices);
+          });
+    }
+  }
+
+  // Determine if the transposed convolution is lowered to a matrix
+  // multiplication with krnl.matmul followed by a col2im: 2D f32 transposed
+  // convolutions of static shapes, when tiling is enabled.
+  bool useGemm(ONNXConvTransposeOpAdaptor &operandAdaptor,
+      ONNXConvTransposeOpShapeHelper &shapeHelper,
+      MemRefType memRefType) const {
+    if (!enableTiling || memRefType.getRank() != 4 ||
+        !memRefType.getElementType().isF32())
+      return false;
+    auto xType = operandAdaptor.getX().getType().cast<MemRefType>();
+    auto wType = operandAdaptor.getW().getType().cast<MemRefType>();
+    if (!xType.hasStaticShape() || !wType.hasStaticShape() ||
+        !memRefType.hasStaticShape())
+      return false;
+    for (IndexExpr pad : shapeHelper.pads)
+      if (!pad.isLiteral())
+        return false;
+    ArrayRef<int64_t> xShape = xType.getShape();
+    ArrayRef<int64_t> wShape = wType.getShape();
+    int64_t rows = wShape[1] * wShape[2] * wShape[3];
+    int64_t cols = xShape[2] * xShape[3];
+    return rows * cols <= kConvTransposeMaxBufferSize;
+  }
+
+  // Lower the transposed convolution of each group g of each image n to the
+  // matrix multiplication
+  //   col[co * KH * KW + kh * KW + kw, ih * W + iw] =
+  //       sum_ci W[g * CIPerGroup + ci, co, kh, kw] *
+  //           X[n, g * CIPerGroup + ci, ih, iw]
+  // of the filter of the group, transposed once into a
+  // [COPerGroup * KH * KW x CIPerGroup] matrix, by the input of the group,
+  // followed by the col2im
+  //   Y[n, g * COPerGroup + co, ih * sh + kh * dh - ph, iw * sw + kw * dw - pw]
+  //       += col[co * KH * KW + kh * KW + kw, ih * W + iw]
+  // of the contributions landing in the output. For a width stride of 1, the
+  // contributions of consecutive input columns land in consecutive output
+  // columns, and are accumulated VL at a time.
+  void convTransposeGemm(ConversionPatternRewriter &rewriter,
+      ONNXConvTransposeOp convTransposeOp,
+      ONNXConvTransposeOpAdaptor &operandAdaptor,
+      ONNXConvTransposeOpShapeHelper &shapeHelper, MemRefType memRefType,
+      Value alloc) const {
+    Location loc = convTransposeOp.getLoc();
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, VectorBuilder>
+        create(rewriter, loc);
+
+    Value inputOperand = operandAdaptor.getX();
+    Value filterOperand = operandAdaptor.getW();
+    Type elementType = memRefType.getElementType();
+    Value fZero = create.math.constant(elementType, 0);
+    ArrayRef<int64_t> xShape =
+        inputOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> wShape =
+        filterOperand.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> yShape = memRefType.getShape();
+    int64_t G = convTransposeOp.getGroup();
+    int64_t H = xShape[2], W = xShape[3];
+    int64_t CIPerGroup = xShape[1] / G;
+    int64_t COPerGroup = wShape[1];
+    int64_t KH = wShape[2], KW = wShape[3];
+    int64_t HO = yShape[2], WO = yShape[3];
+    int64_t sh = shapeHelper.strides[0], sw = shapeHelper.strides[1];
+    int64_t dh = shapeHelper.dilations[0], dw = shapeHelper.dilations[1];
+    int64_t ph = shapeHelper.pads[0].getLiteral();
+    int64_t pw = shapeHelper.pads[1].getLiteral();
+
+    // Sizes of the matrix multiplication of each group of each image:
+    // [COPerGroup * KH * KW x CIPerGroup] * [CIPerGroup x H * W].
+    int64_t rows = COPerGroup * KH * KW;
+    int64_t cols = H * W;
+
+    // Transpose the filter of each group:
+    //   WT[g, co * KH * KW + kh * KW + kw, ci] =
+    //       W[g * CIPerGroup + ci, co, kh, kw]
+    // for g = 0 .. G, ci = 0 .. CIPerGroup, co = 0 .. COPerGroup,
+    //   kh = 0 .. KH, kw = 0 .. KW:
+    MemRefType wtType = MemRefType::get({G, rows, CIPerGroup}, elementType);
+    Value wt = create.mem.alignedAlloc(wtType);
+    ValueRange wtLoops = create.krnl.defineLoops(5);
+    SmallVector<IndexExpr, 5> wtLbs(5, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 5> wtUbs = {LiteralIndexExpr(G),
+        LiteralIndexExpr(CIPerGroup), LiteralIndexExpr(COPerGroup),
+        LiteralIndexExpr(KH), LiteralIndexExpr(KW)};
+    create.krnl.iterateIE(wtLoops, wtLoops, wtLbs, wtUbs,
+        [&](KrnlBuilder &createKrnl, ValueRange wtIndices) {
+          IndexExprScope wtScope(createKrnl);
+          DimIndexExpr g(wtIndices[0]), ci(wtIndices[1]), co(wtIndices[2]),
+              kh(wtIndices[3]), kw(wtIndices[4]);
+          Value filter = createKrnl.loadIE(
+              filterOperand, {g * CIPerGroup + ci, co, kh, kw});
+          createKrnl.storeIE(filter, wt, {g, (co * KH + kh) * KW + kw, ci});
+        });
+
+    // View of the input as [CIPerGroup, H * W] matrices per group of each
+    // image, and the column buffer reused by all of them.
+    SmallVector<IndexExpr, 4> inputDims = {LiteralIndexExpr(xShape[0]),
+        LiteralIndexExpr(G), LiteralIndexExpr(CIPerGroup),
+        LiteralIndexExpr(cols)};
+    Value input = create.mem.reinterpretCast(inputOperand, inputDims);
+    MemRefType colType = MemRefType::get({rows, cols}, elementType);
+    Value col = create.mem.alignedAlloc(colType);
+
+    // Tile sizes of krnl.matmul, with simdization along the input spatial
+    // dims, the same as for the MatMul of 2D matrices.
+    int64_t iRegTile = std::min<int64_t>(4, rows);
+    int64_t jRegTile = 8;
+    int64_t kRegTile = std::min<int64_t>(8, CIPerGroup);
+    bool simdize = cols >= jRegTile;
+    Value zero = create.math.constantIndex(0);
+    Value I = create.math.constantIndex(rows);
+    Value J = create.math.constantIndex(cols);
+    Value K = create.math.constantIndex(CIPerGroup);
+
+    // Emit the tiled I, J, K loops computing rows [iLB, iUB) of the column
+    // buffer of group g of image n.
+    auto emitTiledMatmul = [&](KrnlBuilder &createKrnl, Value n, Value g,
+                               Value iLB, Value iUB) {
+      ValueRange origLoop = createKrnl.defineLoops(3);
+      Value ii(origLoop[0]), jj(origLoop[1]), kk(origLoop[2]);
+      ValueRange iRegBlock = createKrnl.block(ii, iRegTile);
+      Value ii1(iRegBlock[0]), ii2(iRegBlock[1]);
+      ValueRange jRegBlock = createKrnl.block(jj, jRegTile);
+      Value jj1(jRegBlock[0]), jj2(jRegBlock[1]);
+      ValueRange kRegBlock = createKrnl.block(kk, kRegTile);
+      Value kk1(kRegBlock[0]), kk2(kRegBlock[1]);
+      createKrnl.permute({ii1, ii2, jj1, jj2, kk1, kk2}, {0, 3, 1, 4, 2, 5});
+      createKrnl.iterate({ii, jj, kk}, {ii1, jj1, kk1}, {iLB, zero, zero},
+          {iUB, J, K}, [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            Value i1(indices[0]), j1(indices[1]), k1(indices[2]);
+            createKrnl.matmul(wt, {g, zero, zero}, input, {n, g, zero, zero},
+                col, {zero, zero}, {ii2, jj2, kk2}, {i1, j1, k1}, {I, J, K},
+                {iRegTile, jRegTile, kRegTile}, {}, {}, {}, simdize,
+                /*unroll*/ true, /*overCompute*/ false);
+          });
+    };
+
+    // Emit the col2im of output channel co of group g of image n.
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    VectorType vecType = VectorType::get({VL}, elementType);
+    auto emitCol2Im = [&](KrnlBuilder &createKrnl, Value n, Value g,
+                          Value co) {
+      // for kh = 0 .. KH:
+      ValueRange khLoop = createKrnl.defineLoops(1);
+      createKrnl.iterateIE(khLoop, khLoop, {LiteralIndexExpr(0)},
+          {LiteralIndexExpr(KH)},
+          [&](KrnlBuilder &createKrnl, ValueRange khIndices) {
+            IndexExprScope khScope(createKrnl);
+            DimIndexExpr kh(khIndices[0]);
+            // Input rows whose output row ih * sh - (ph - kh * dh) is in
+            // [0, HO).
+            IndexExpr pos = LiteralIndexExpr(ph) - kh * dh;
+            IndexExpr ihLB = IndexExpr::max(pos.ceilDiv(sh), 0);
+            IndexExpr ihUB =
+                IndexExpr::min((pos + (HO - 1)).floorDiv(sh) + 1, H);
+            // for ih = lb .. ub:
+            ValueRange ihLoop = createKrnl.defineLoops(1);
+            createKrnl.iterateIE(ihLoop, ihLoop, {ihLB}, {ihUB},
+                [&](KrnlBuilder &createKrnl, ValueRange ihIndices) {
+                  IndexExprScope ihScope(createKrnl);
+                  DimIndexExpr ih(ihIndices[0]);
+                  Value c =
+                      (DimIndexExpr(g) * COPerGroup + DimIndexExpr(co))
+                          .getValue();
+                  Value oh = (ih * sh - SymbolIndexExpr(pos)).getValue();
+                  IndexExpr rowOfKW0 =
+                      (DimIndexExpr(co) * KH + DimIndexExpr(kh)) * KW;
+                  Value colOfIW0 = (ih * W).getValue();
+                  // for kw = 0 .. KW, unrolled:
+                  for (int64_t kw = 0; kw < KW; ++kw) {
+                    // Input columns whose output column
+                    // iw * sw - (pw - kw * dw) is in [0, WO).
+                    IndexExpr posw = LiteralIndexExpr(pw - kw * dw);
+                    int64_t iwLB = std::max<int64_t>(
+                        posw.ceilDiv(sw).getLiteral(), 0);
+                    int64_t iwUB = std::min<int64_t>(
+                        (posw + (WO - 1)).floorDiv(sw).getLiteral() + 1, W);
+                    if (iwLB >= iwUB)
+                      continue;
+                    Value row = (rowOfKW0 + kw).getValue();
+                    int64_t numVec = (sw == 1) ? (iwUB - iwLB) / VL : 0;
+                    int64_t iwVecEnd = iwLB + numVec * VL;
+                    // Accumulate the contribution of input column iw.
+                    auto emitScatter = [&](KrnlBuilder &createKrnl, Value iw,
+                                           bool vectorized) {
+                      MultiDialectBuilder<KrnlBuilder, MathBuilder,
+                          VectorBuilder>
+                          create(createKrnl);
+                      Value colIndex = create.math.add(colOfIW0, iw);
+                      Value ow = create.math.add(
+                          create.math.mul(iw, create.math.constantIndex(sw)),
+                          create.math.constantIndex(-posw.getLiteral()));
+                      if (vectorized) {
+                        Value contrib =
+                            create.vec.load(vecType, col, {row, colIndex});
+                        Value res =
+                            create.vec.load(vecType, alloc, {n, c, oh, ow});
+                        res = create.math.add(res, contrib);
+                        create.vec.store(res, alloc, {n, c, oh, ow});
+                      } else {
+                        Value contrib = create.krnl.load(col, {row, colIndex});
+                        Value res = create.krnl.load(alloc, {n, c, oh, ow});
+                        res = create.math.add(res, contrib);
+                        create.krnl.store(res, alloc, {n, c, oh, ow});
+                      }
+                    };
+                    // for iw = iwLB .. iwVecEnd step VL:
+                    if (numVec > 0) {
+                      ValueRange vecLoop = createKrnl.defineLoops(1);
+                      ValueRange blockedVecLoop =
+                          createKrnl.block(vecLoop[0], VL);
+                      createKrnl.iterateIE(vecLoop, {blockedVecLoop[0]},
+                          {LiteralIndexExpr(iwLB)},
+                          {LiteralIndexExpr(iwVecEnd)},
+                          [&](KrnlBuilder &createKrnl, ValueRange iwIndices) {
+                            emitScatter(createKrnl, iwIndices[0], true);
+                          });
+                    }
+                    // for iw = iwVecEnd .. iwUB:
+                    if (iwVecEnd < iwUB) {
+                      ValueRange iwLoop = createKrnl.defineLoops(1);
+                      createKrnl.iterateIE(iwLoop, iwLoop,
+                          {LiteralIndexExpr(iwVecEnd)},
+                          {LiteralIndexExpr(iwUB)},
+                          [&](KrnlBuilder &createKrnl, ValueRange iwIndices) {
+                            emitScatter(createKrnl, iwIndices[0], false);
+                          });
+                    }
+                  }
+                });
+          });
+    };
+
+    // for n = 0 .. N, g = 0 .. G:
+    ValueRange groupLoops = create.krnl.defineLoops(2);
+    create.krnl.iterateIE(groupLoops, groupLoops,
+        {LiteralIndexExpr(0), LiteralIndexExpr(0)},
+        {LiteralIndexExpr(yShape[0]), LiteralIndexExpr(G)},
+        [&](KrnlBuilder &createKrnl, ValueRange groupIndices) {
+          Value n(groupIndices[0]), g(groupIndices[1]);
+          MultiDialectBuilder<MathBuilder, SCFBuilder> create(createKrnl);
+          Value COG = create.math.constantIndex(COPerGroup);
+          createKrnl.memset(col, fZero);
+          if (enableParallel) {
+            // Distribute the blocks of iRegTile rows of the column buffer
+            // among the threads, and then its output channels, each writing
+            // a disjoint part of the buffer and of the output.
+            Value iStep = create.math.constantIndex(iRegTile);
+            Value one = create.math.constantIndex(1);
+            create.scf.parallelLoop({zero}, {I}, {iStep},
+                [&](SCFBuilder &createSCF, ValueRange parIndices) {
+                  // The krnl.region is an affine scope, in which the
+                  // induction variable of the parallel loop is a symbol.
+                  OpBuilder &builder = createSCF.getBuilder();
+                  KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+                  OpBuilder::InsertionGuard insertGuard(builder);
+                  builder.setInsertionPointToStart(
+                      &regionOp.getBodyRegion().front());
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      builder, loc);
+                  Value iLB = parIndices[0];
+                  Value iUB = create.math.min(create.math.add(iLB, iStep), I);
+                  emitTiledMatmul(create.krnl, n, g, iLB, iUB);
+                });
+            create.scf.parallelLoop({zero}, {COG}, {one},
+                [&](SCFBuilder &createSCF, ValueRange parIndices) {
+                  OpBuilder &builder = createSCF.getBuilder();
+                  KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+                  OpBuilder::InsertionGuard insertGuard(builder);
+                  builder.setInsertionPointToStart(
+                      &regionOp.getBodyRegion().front());
+                  KrnlBuilder createKrnl(builder, loc);
+                  emitCol2Im(createKrnl, n, g, parIndices[0]);
+                });
+          } else {
+            emitTiledMatmul(createKrnl, n, g, zero, I);
+            // for co = 0 .. COPerGroup:
+            ValueRange coLoop = createKrnl.defineLoops(1);
+            createKrnl.iterate(coLoop, coLoop, {zero}, {COG},
+                [&](KrnlBuilder &createKrnl, ValueRange coIndices) {
+                  emitCol2Im(createKrnl, n, g, coIndices[0]);
+                });
+          }
+        });
+  }
+
+  LogicalResult matchAndRewrite(ONNXConvTransposeOp convTransposeOp,
+      ONNXConvTransposeOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = convTransposeOp.getOperation();
+    Location loc = ONNXLoc<ONNXConvTransposeOp>(op);
+    ValueRange operands = adaptor.getOperands();
+
+    // Get shape.
+    MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
+        rewriter, loc);
+    ONNXConvTransposeOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+
+    // Insert an allocation and deallocation for the result of this operation.
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+    initOutput(
+        rewriter, loc, adaptor.getB(), shapeHelper, memRefType, alloc);
+
+    if (useGemm(adaptor, shapeHelper, memRefType))
+      convTransposeGemm(
+          rewriter, convTransposeOp, adaptor, shapeHelper, memRefType, alloc);
+    else
+      convTransposeUnoptimized(
+          rewriter, convTransposeOp, adaptor, shapeHelper, alloc);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXConvTransposeOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableTiling,
+    bool enableParallel) {
+  patterns.insert<ONNXConvTransposeOpLowering>(
+      typeConverter, ctx, enableTiling, enableParallel);
+}
+
+} // namespace onnx_mlir
@@ -135,11 +135,338 @@ struct ONNXBatchNormalizationInferenceModeOpLowering
   }
 };
 
+using MDBuilder = MultiDialectBuilder<IndexExprBuilderForKrnl, KrnlBuilder,
+    MathBuilder, MemRefBuilder, VectorBuilder>;
+
+// Unroll factor of the SIMD loops along the normalized values, giving
+// independent chains of accumulations to hide the latency of the vector ops.
+static constexpr int64_t kLayerNormSimdUnroll = 4;
+
+// Return a 1-D view of the `rowSize` values of `operand` (Scale or B) broadcast
+// to the normalized dimensions `normDims` of X. The operand is first copied
+// into a buffer of the normalized shape when it is actually broadcast.
+static Value getFlatNormalizedOperand(MDBuilder &create, Value operand,
+    DimsExpr &normDims, IndexExpr rowSize) {
+  MemRefType memRefType = operand.getType().cast<MemRefType>();
+  ArrayRef<int64_t> shape = memRefType.getShape();
+  int64_t rank = memRefType.getRank();
+  int64_t normRank = normDims.size();
+  int64_t offset = normRank - rank;
+  bool isBroadcast = offset > 0;
+  for (int64_t i = 0; i < rank; ++i)
+    if (shape[i] == 1 && !(normDims[offset + i].isLiteral() &&
+                             normDims[offset + i].getLiteral() == 1))
+      isBroadcast = true;
+  if (isBroadcast) {
+    SmallVector<int64_t, 4> normShape;
+    IndexExpr::getShape(normDims, normShape);
+    MemRefType normMemRefType =
+        MemRefType::get(normShape, memRefType.getElementType());
+    Value buffer = create.mem.alignedAlloc(normMemRefType, normDims);
+    Value zero = create.math.constantIndex(0);
+    ValueRange loopDef = create.krnl.defineLoops(normRank);
+    SmallVector<IndexExpr, 4> lbs(normRank, LiteralIndexExpr(0));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, normDims,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          SmallVector<Value, 4> operandInd;
+          for (int64_t i = 0; i < rank; ++i)
+            operandInd.emplace_back(shape[i] == 1 ? zero : loopInd[offset + i]);
+          Value val = createKrnl.load(operand, operandInd);
+          createKrnl.store(val, buffer, loopInd);
+        });
+    operand = buffer;
+  }
+  SmallVector<IndexExpr, 1> flatDims = {rowSize};
+  return create.mem.reinterpretCast(operand, flatDims);
+}
+
+// Emit the layer normalization of the rows of the 2-D view `X` of `numRows`
+// rows of `rowSize` contiguous values into the 2-D view `Y`. `scale` and
+// `bias` (or null) are 1-D views of `rowSize` values, unless `isRowAffine`, in
+// which case they are 1-D views of values applied to whole rows, row r using
+// the value at r modulo their size. The mean and inverse standard deviation of
+// each row are stored into the 1-D views `mean` and `invStdDev` of `numRows`
+// values, when not null. The values are computed in `computeType`.
+//
+// A first pass over each row accumulates the sum and the sum of squares of its
+// values, giving the mean and the variance E[x^2] - E[x]^2. A second pass
+// normalizes the values. When VL > 1, both passes process blocks of VL values
+// with SIMD code, whose vector accumulators are reduced at the end of the row.
+// When `enableParallel`, the rows are normalized in parallel, each with its own
+// accumulators.
+static void emitLayerNormalization(ConversionPatternRewriter &rewriter,
+    Location loc, Value X, Value scale, Value bias, Value Y, Value mean,
+    Value invStdDev, IndexExpr numRows, IndexExpr rowSize, double epsilon,
+    Type computeType, int64_t VL, bool isRowAffine, bool enableParallel) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, SCFBuilder>
+      create(rewriter, loc);
+  Type elementType = Y.getType().cast<MemRefType>().getElementType();
+  VectorType vecType = VectorType::get({VL}, computeType);
+  Value zero = create.math.constant(computeType, 0);
+  Value one = create.math.constant(computeType, 1);
+  Value epsilonVal = create.math.constant(computeType, epsilon);
+  Value iZero = create.math.constantIndex(0);
+
+  // Accumulators of the sums and of the sums of squares, for the blocks of VL
+  // values and for the remaining values of a row. Loads and stores of type
+  // `type` go to the accumulators of that type.
+  Value vecSumAcc, vecSqSumAcc, scalarSumAcc, scalarSqSumAcc;
+  auto allocateAccumulators = [&](MemRefBuilder &createMemRef) {
+    if (VL > 1) {
+      MemRefType vecAccType = MemRefType::get({VL}, computeType);
+      vecSumAcc = createMemRef.alignedAlloca(vecAccType);
+      vecSqSumAcc = createMemRef.alignedAlloca(vecAccType);
+    }
+    MemRefType scalarAccType = MemRefType::get({1}, computeType);
+    scalarSumAcc = createMemRef.alloca(scalarAccType);
+    scalarSqSumAcc = createMemRef.alloca(scalarAccType);
+  };
+
+  auto emitRow = [&](KrnlBuilder &ck, Value row) {
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        VectorBuilder>
+        create(ck);
+    IndexExprScope rowScope(ck);
+    SymbolIndexExpr rowSizeIE(rowSize);
+
+    // First pass: sum and sum of squares of the row.
+    if (VL > 1) {
+      Value vecZero = create.vec.splat(vecType, zero);
+      create.vec.store(vecZero, vecSumAcc, {iZero});
+      create.vec.store(vecZero, vecSqSumAcc, {iZero});
+    }
+    create.krnl.store(zero, scalarSumAcc, {iZero});
+    create.krnl.store(zero, scalarSqSumAcc, {iZero});
+    emitSimdLoopWithScalarTail(create.krnl, rowSizeIE, VL, elementType,
+        [&](KrnlBuilder &ck, Type type, Value col) {
+          MultiDialectBuilder<MathBuilder> create(ck);
+          bool isVec = type.isa<VectorType>();
+          Value sumAcc = isVec ? vecSumAcc : scalarSumAcc;
+          Value sqSumAcc = isVec ? vecSqSumAcc : scalarSqSumAcc;
+          Value x = create.math.cast(isVec ? vecType : computeType,
+              loadScalarOrVector(ck, type, X, {row, col}));
+          Value sum = create.math.add(
+              loadScalarOrVector(ck, x.getType(), sumAcc, {iZero}), x);
+          storeScalarOrVector(ck, sum, sumAcc, {iZero});
+          Value sqSum = create.math.add(
+              loadScalarOrVector(ck, x.getType(), sqSumAcc, {iZero}),
+              create.math.mul(x, x));
+          storeScalarOrVector(ck, sqSum, sqSumAcc, {iZero});
+        });
+    Value sum = create.krnl.load(scalarSumAcc, {iZero});
+    Value sqSum = create.krnl.load(scalarSqSumAcc, {iZero});
+    if (VL > 1) {
+      sum = create.math.add(sum,
+          create.vec.reduction(vector::CombiningKind::ADD,
+              create.vec.load(vecType, vecSumAcc, {iZero})));
+      sqSum = create.math.add(sqSum,
+          create.vec.reduction(vector::CombiningKind::ADD,
+              create.vec.load(vecType, vecSqSumAcc, {iZero})));
+    }
+    Value size = create.math.cast(computeType, rowSizeIE.getValue());
+    Value meanVal = create.math.div(sum, size);
+    Value variance = create.math.sub(
+        create.math.div(sqSum, size), create.math.mul(meanVal, meanVal));
+    // Rounding errors may give a slightly negative variance.
+    variance = create.math.max(variance, zero);
+    Value invStdDevVal = create.math.div(
+        one, create.math.sqrt(create.math.add(variance, epsilonVal)));
+    if (mean)
+      create.krnl.store(meanVal, mean, {row});
+    if (invStdDev)
+      create.krnl.store(invStdDevVal, invStdDev, {row});
+
+    // Second pass: y = (x - mean) * invStdDev * scale + bias, that is
+    // y = x * factor + term when the scale and bias of the row are scalars,
+    // with factor = invStdDev * scale and term = bias - mean * factor.
+    Value factor, term;
+    if (isRowAffine) {
+      Value affineInd = create.math.rem(
+          row, create.krnlIE.getShapeAsSymbol(scale, 0).getValue());
+      factor = create.math.mul(invStdDevVal,
+          create.math.cast(computeType, create.krnl.load(scale, {affineInd})));
+      term = create.math.neg(create.math.mul(meanVal, factor));
+      if (bias)
+        term = create.math.add(term,
+            create.math.cast(computeType, create.krnl.load(bias, {affineInd})));
+    }
+    Value vecMean, vecInvStdDev, vecFactor, vecTerm;
+    if (VL > 1 && isRowAffine) {
+      vecFactor = create.vec.splat(vecType, factor);
+      vecTerm = create.vec.splat(vecType, term);
+    } else if (VL > 1) {
+      vecMean = create.vec.splat(vecType, meanVal);
+      vecInvStdDev = create.vec.splat(vecType, invStdDevVal);
+    }
+    emitSimdLoopWithScalarTail(create.krnl, rowSizeIE, VL, elementType,
+        [&](KrnlBuilder &ck, Type type, Value col) {
+          MultiDialectBuilder<MathBuilder, VectorBuilder> create(ck);
+          bool isVec = type.isa<VectorType>();
+          Type valType = isVec ? vecType : computeType;
+          Value x = create.math.cast(
+              valType, loadScalarOrVector(ck, type, X, {row, col}));
+          Value y;
+          if (isRowAffine && isVec) {
+            y = create.vec.fma(x, vecFactor, vecTerm);
+          } else if (isRowAffine) {
+            y = create.math.add(create.math.mul(x, factor), term);
+          } else {
+            Value s = create.math.cast(
+                valType, loadScalarOrVector(ck, type, scale, {col}));
+            y = create.math.sub(x, isVec ? vecMean : meanVal);
+            y = create.math.mul(y, isVec ? vecInvStdDev : invStdDevVal);
+            y = create.math.mul(y, s);
+            if (bias) {
+              Value b = create.math.cast(
+                  valType, loadScalarOrVector(ck, type, bias, {col}));
+              y = create.math.add(y, b);
+            }
+          }
+          storeScalarOrVector(ck, create.math.cast(type, y), Y, {row, col});
+        });
+  };
+
+  // Each row is computed inside a krnl.region when in parallel, so that its
+  // Krnl ops get their own affine scope, and its accumulators are allocated
+  // there.
+  if (enableParallel &&
+      !(numRows.isLiteral() && numRows.getLiteral() <= 1)) {
+    create.scf.parallelLoop({iZero}, {numRows.getValue()},
+        {create.math.constantIndex(1)},
+        [&](SCFBuilder &createSCF, ValueRange rowInd) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          MultiDialectBuilder<KrnlBuilder, MemRefBuilder> create(builder, loc);
+          allocateAccumulators(create.mem);
+          emitRow(create.krnl, rowInd[0]);
+        });
+    return;
+  }
+  allocateAccumulators(create.mem);
+  ValueRange rowLoopDef = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(rowLoopDef, rowLoopDef, {LiteralIndexExpr(0)},
+      {numRows}, [&](KrnlBuilder &ck, ValueRange rowInd) {
+        emitRow(ck, rowInd[0]);
+      });
+}
+
+// Return the number of values of the blocks of the SIMD code normalizing rows
+// of `rowSize` values, or 1 for scalar code. SIMD code is used when computing
+// in f32, the element type of X, unless the rows are statically too short for a
+// block.
+static int64_t getLayerNormalizationVL(MDBuilder &create, bool enableSIMD,
+    Type elementType, Type computeType, IndexExpr rowSize) {
+  if (!enableSIMD || !elementType.isF32() || computeType != elementType)
+    return 1;
+  int64_t simdVL =
+      create.vec.getMachineVectorLength(elementType) * kLayerNormSimdUnroll;
+  if (rowSize.isLiteral() && rowSize.getLiteral() < simdVL)
+    return 1;
+  return simdVL;
+}
+
+struct ONNXLayerNormalizationOpLowering
+    : public OpConversionPattern<ONNXLayerNormalizationOp> {
+  ONNXLayerNormalizationOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD),
+        enableParallel(enableParallel) {}
+  bool enableSIMD;
+  bool enableParallel;
+
+  LogicalResult matchAndRewrite(ONNXLayerNormalizationOp lnOp,
+      ONNXLayerNormalizationOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    // layer_normalization{axis, epsilon}(x, scale, bias) =
+    //      scale * (x - mean) / sqrt(variance + epsilon) + bias
+    // where mean and variance are computed over the dimensions from axis on.
+    Operation *op = lnOp.getOperation();
+    Location loc = ONNXLoc<ONNXLayerNormalizationOp>(op);
+    MDBuilder create(rewriter, loc);
+
+    Value X = adaptor.getX();
+    Value scale = adaptor.getScale();
+    Value bias = adaptor.getB();
+    MemRefType xMemRefType = X.getType().cast<MemRefType>();
+    Type elementType = xMemRefType.getElementType();
+    int64_t rank = xMemRefType.getRank();
+    int64_t axis = adaptor.getAxis();
+    axis = axis >= 0 ? axis : rank + axis;
+    // Mean and InvStdDev are computed in float when stash_type is 1.
+    Type computeType =
+        adaptor.getStashType() == 1 ? rewriter.getF32Type() : elementType;
+
+    // Shape helper.
+    ONNXLayerNormalizationOpShapeHelper shapeHelper(
+        op, adaptor.getOperands(), &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Insert allocations for the results, the optional ones being null if
+    // not used.
+    SmallVector<Value, 3> results;
+    for (unsigned i = 0; i < op->getNumResults(); ++i) {
+      if (isFromNone(op->getResult(i))) {
+        results.emplace_back(nullptr);
+        continue;
+      }
+      Type convertedType =
+          typeConverter->convertType(op->getResult(i).getType());
+      assert(convertedType && convertedType.isa<MemRefType>() &&
+             "Failed to convert type to MemRefType");
+      results.emplace_back(create.mem.alignedAlloc(
+          convertedType.cast<MemRefType>(), shapeHelper.getOutputDims(i)));
+    }
+
+    // View X and Y as rows of the normalized values, Scale and B as one such
+    // row, and Mean and InvStdDev as one value per row.
+    DimsExpr xDims = shapeHelper.getOutputDims(0);
+    DimsExpr normDims;
+    IndexExpr numRows = LiteralIndexExpr(1);
+    IndexExpr rowSize = LiteralIndexExpr(1);
+    for (int64_t i = 0; i < rank; ++i) {
+      if (i < axis) {
+        numRows = numRows * xDims[i];
+      } else {
+        rowSize = rowSize * xDims[i];
+        normDims.emplace_back(xDims[i]);
+      }
+    }
+    SmallVector<IndexExpr, 2> viewDims = {numRows, rowSize};
+    SmallVector<IndexExpr, 1> statDims = {numRows};
+    Value xView = create.mem.reinterpretCast(X, viewDims);
+    Value yView = create.mem.reinterpretCast(results[0], viewDims);
+    Value scaleView =
+        getFlatNormalizedOperand(create, scale, normDims, rowSize);
+    Value biasView, meanView, invStdDevView;
+    if (!bias.getType().isa<NoneType>())
+      biasView = getFlatNormalizedOperand(create, bias, normDims, rowSize);
+    if (results[1])
+      meanView = create.mem.reinterpretCast(results[1], statDims);
+    if (results[2])
+      invStdDevView = create.mem.reinterpretCast(results[2], statDims);
+
+    int64_t VL = getLayerNormalizationVL(
+        create, enableSIMD, elementType, computeType, rowSize);
+    emitLayerNormalization(rewriter, loc, xView, scaleView, biasView, yView,
+        meanView, invStdDevView, numRows, rowSize,
+        adaptor.getEpsilon().convertToDouble(), computeType, VL,
+        /*isRowAffine=*/false, enableParallel);
+
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
 struct ONNXInstanceNormalizationOpLowering
     : public OpConversionPattern<ONNXInstanceNormalizationOp> {
-  ONNXInstanceNormalizationOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXInstanceNormalizationOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD),
+        enableParallel(enableParallel) {}
+  bool enableSIMD;
+  bool enableParallel;
 
   LogicalResult matchAndRewrite(ONNXInstanceNormalizationOp instanceOp,
       ONNXInstanceNormalizationOpAdaptor adaptor,
@@ -148,10 +475,7 @@ struct ONNXInstanceNormalizationOpLowering
     //      scale * (x - mean) / sqrt(variance + epsilon) + bias
     Operation *op = instanceOp.getOperation();
     Location loc = ONNXLoc<ONNXInstanceNormalizationOp>(op);
-
-    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder,
-        MathBuilder>
-        create(rewriter, loc);
+    MDBuilder create(rewriter, loc);
 
     // Convert the output type to MemRefType.
     Type convertedType = typeConverter->convertType(*op->result_type_begin());
@@ -176,6 +500,28 @@ struct ONNXInstanceNormalizationOpLowering
     IndexExprScope outerScope(create.krnl);
     SmallVector<IndexExpr, 4> inputBounds;
     create.krnlIE.getShapeAsSymbols(inputMemRef, inputBounds);
+
+    // With SIMD code, the spatial values of each channel of each batch are
+    // normalized in one row of a layer normalization, with the scale and bias
+    // of the channel.
+    IndexExpr numRows = inputBounds[0] * inputBounds[1];
+    IndexExpr rowSize = LiteralIndexExpr(1);
+    for (int d = 2; d < rank; ++d)
+      rowSize = rowSize * inputBounds[d];
+    int64_t VL = getLayerNormalizationVL(
+        create, enableSIMD, elementType, elementType, rowSize);
+    if (VL > 1) {
+      SmallVector<IndexExpr, 2> viewDims = {numRows, rowSize};
+      Value xView = create.mem.reinterpretCast(inputMemRef, viewDims);
+      Value yView = create.mem.reinterpretCast(resMemRef, viewDims);
+      emitLayerNormalization(rewriter, loc, xView, scaleMemRef, biasMemRef,
+          yView, nullptr, nullptr, numRows, rowSize,
+          adaptor.getEpsilon().convertToDouble(), elementType, VL,
+          /*isRowAffine=*/true, enableParallel);
+      rewriter.replaceOp(op, resMemRef);
+      return success();
+    }
+
     MemRefType tmpType = MemRefType::get({}, elementType);
     Value fZero = create.math.constant(elementType, 0);
     Value tmpMemRef = create.mem.alloca(tmpType);
@@ -283,11 +629,78 @@ struct ONNXInstanceNormalizationOpLowering
   }
 };
 
+struct ONNXGroupNormalizationOpLowering
+    : public OpConversionPattern<ONNXGroupNormalizationOp> {
+  ONNXGroupNormalizationOpLowering(TypeConverter &typeConverter,
+      MLIRContext *ctx, bool enableSIMD, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD),
+        enableParallel(enableParallel) {}
+  bool enableSIMD;
+  bool enableParallel;
+
+  LogicalResult matchAndRewrite(ONNXGroupNormalizationOp gnOp,
+      ONNXGroupNormalizationOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    // group_normalization{epsilon, num_groups}(x, scale, bias) =
+    //      scale * (x - mean) / sqrt(variance + epsilon) + bias
+    // where mean and variance are computed over the channels of each group
+    // and the spatial dimensions, and scale and bias are given per group.
+    Operation *op = gnOp.getOperation();
+    Location loc = ONNXLoc<ONNXGroupNormalizationOp>(op);
+    MDBuilder create(rewriter, loc);
+
+    Value X = adaptor.getX();
+    Type elementType = X.getType().cast<MemRefType>().getElementType();
+    int64_t rank = X.getType().cast<MemRefType>().getRank();
+    int64_t numGroups = adaptor.getNumGroups();
+
+    // Shape helper.
+    ONNXGroupNormalizationOpShapeHelper shapeHelper(
+        op, adaptor.getOperands(), &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    Value alloc = create.mem.alignedAlloc(
+        convertedType.cast<MemRefType>(), shapeHelper.getOutputDims());
+
+    // View X and Y as one row per group of each batch, the values of the
+    // channels of a group being contiguous, normalized with the scale and bias
+    // of the group.
+    DimsExpr xDims = shapeHelper.getOutputDims();
+    IndexExpr numRows = xDims[0] * numGroups;
+    IndexExpr rowSize = xDims[1].floorDiv(numGroups);
+    for (int64_t i = 2; i < rank; ++i)
+      rowSize = rowSize * xDims[i];
+    SmallVector<IndexExpr, 2> viewDims = {numRows, rowSize};
+    Value xView = create.mem.reinterpretCast(X, viewDims);
+    Value yView = create.mem.reinterpretCast(alloc, viewDims);
+
+    int64_t VL = getLayerNormalizationVL(
+        create, enableSIMD, elementType, elementType, rowSize);
+    emitLayerNormalization(rewriter, loc, xView, adaptor.getScale(),
+        adaptor.getBias(), yView, nullptr, nullptr, numRows, rowSize,
+        adaptor.getEpsilon().convertToDouble(), elementType, VL,
+        /*isRowAffine=*/true, enableParallel);
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
 void populateLoweringONNXNormalizationOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
   patterns.insert<ONNXBatchNormalizationInferenceModeOpLowering>(
       typeConverter, ctx);
-  patterns.insert<ONNXInstanceNormalizationOpLowering>(typeConverter, ctx);
+  patterns.insert<ONNXInstanceNormalizationOpLowering>(
+      typeConverter, ctx, enableSIMD, enableParallel);
+  patterns.insert<ONNXLayerNormalizationOpLowering>(
+      typeConverter, ctx, enableSIMD, enableParallel);
+  patterns.insert<ONNXGroupNormalizationOpLowering>(
+      typeConverter, ctx, enableSIMD, enableParallel);
 }
 
 } // namespace onnx_mlir
@@ -192,13 +192,25 @@ void postProcessPoolingWindow<ONNXAveragePoolOp>(
   create.krnl.store(average, alloc, resultIndices);
 }
 
+// Maximum number of taps of the pooling windows unrolled by the SIMD code.
+static constexpr int64_t kSimdPoolingMaxTaps = 64;
+
+// Number of channels pooled together by the scalar code, reusing the bounds
+// and positions of the windows.
+static constexpr int64_t kPoolChannelBlock = 4;
+
 //===----------------------------------------------------------------------===//
 // Template function that does pooling.
 //
 template <typename PoolOp, typename PoolOpAdaptor, typename PoolOpShapeHelper>
 struct ONNXPoolOpLowering : public OpConversionPattern<PoolOp> {
-  ONNXPoolOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern<PoolOp>(typeConverter, ctx) {}
+  bool enableSIMD = false;
+  bool enableParallel = false;
+
+  ONNXPoolOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel)
+      : OpConversionPattern<PoolOp>(typeConverter, ctx),
+        enableSIMD(enableSIMD), enableParallel(enableParallel) {}
 
   LogicalResult matchAndRewrite(PoolOp poolOp, PoolOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -245,6 +257,13 @@ struct ONNXPoolOpLowering : public OpConversionPattern<PoolOp> {
     Value alloc =
         create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
 
+    // 2D poolings of static float tensors without dilation use SIMD code.
+    if (enableSIMD && !isDilated &&
+        emitSimdPooling(rewriter, poolOp, shapeHelper, inputOperand, alloc)) {
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // input = Pool(output)
     //
     // The input/output shapes will look like this:
@@ -324,20 +343,34 @@ struct ONNXPoolOpLowering : public OpConversionPattern<PoolOp> {
 
     // Identity value of the operation.
     auto identity = getIdentityValue<PoolOp>(rewriter, loc, outputElementType);
+
+    // With SIMD, blocks of cBlock channels are pooled together, with one
+    // reduction value each, when the number of channels is a multiple of the
+    // block. The bounds of the pooling windows only depend on the output
+    // position, so that the loop over the channels of a block is jammed into
+    // the loops over the windows.
+    int64_t cBlock = 1;
+    if (enableSIMD && kernelOffset == 2 && outputShape[1] > 0 &&
+        outputShape[1] % kPoolChannelBlock == 0)
+      cBlock = kPoolChannelBlock;
+
     // Create a local reduction value for output[n][c][ho][wo].
-    // Single scalar, no need for default alignment.
-    Value reductionVal =
-        create.mem.alloca(MemRefType::get({}, memRefType.getElementType()));
+    // Few scalars, no need for default alignment.
+    Value reductionVal = create.mem.alloca(
+        (cBlock == 1) ? MemRefType::get({}, memRefType.getElementType())
+                      : MemRefType::get({cBlock}, memRefType.getElementType()));
 
     // 1. Define output loops to compute one output pixel.
     // for n in range(N):
-    //   for c in range(C):
+    //   for c in range(C) step cBlock:
     //     for ho in range(HO):
     //       for wo in range(WO):
     ValueRange calcLoopDef = create.krnl.defineLoops(outputShape.size());
     SmallVector<IndexExpr, 4> lbs(outputShape.size(), LiteralIndexExpr(0));
     SmallVector<IndexExpr, 4> ubs;
     create.krnlIE.getShapeAsDims(alloc, ubs);
+    if (cBlock > 1)
+      ubs[1] = LiteralIndexExpr(outputShape[1] / cBlock);
     create.krnl.iterateIE(calcLoopDef, calcLoopDef, lbs, ubs,
         [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
           MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl,
@@ -351,9 +384,6 @@ struct ONNXPoolOpLowering : public OpConversionPattern<PoolOp> {
           for (unsigned int i = 0; i < outputShape.size(); ++i)
             outputIndices.emplace_back(DimIndexExpr(loopInd[i]));
 
-          // 2.1 Emit: output[n][c][ho][wo] = identity
-          create.krnl.store(identity, reductionVal);
-
           // 2.2 Emit affine maps which express the lower and upper bounds
           // for the pooling window's dimensions. The pooling window can be
           // smaller than the kernel when slicing it over the border edges.
@@ -363,155 +393,420 @@ struct ONNXPoolOpLowering : public OpConversionPattern<PoolOp> {
           //   startH = max(firstValidH, ho * sH - ptH)
           //   endH = min(H, ho * sH + (kH - 1) * dH  + 1 - pbH)
           //   hDim = round(float(endH - startH) / float(dH))
-
-          // Prepare induction variables.
           SmallVector<SmallVector<IndexExpr, 4>, 4> IVExprs;
-          for (int i = 0; i < kernelShapeSize; ++i) {
-            int j = i + kernelOffset;
-            SmallVector<IndexExpr, 4> ic;
-            // d0, output
-            ic.emplace_back(outputIndices[j]);
-            // s0, input dim
-            ic.emplace_back(create.krnlIE.getShapeAsDim(inputOperand, j));
-            // s1, kernel dim
-            ic.emplace_back(SymbolIndexExpr(shapeHelper.kernelShape[i]));
-            // s2, pad dim
-            ic.emplace_back(SymbolIndexExpr(shapeHelper.pads[i]));
-            // s3, stride dim
-            ic.emplace_back(LiteralIndexExpr(shapeHelper.strides[i]));
-            // s4, dilation dim
-            ic.emplace_back(LiteralIndexExpr(shapeHelper.dilations[i]));
-            IVExprs.emplace_back(ic);
-          }
-
-          // Compute the start and end position of the conv window.
-          //   firstValidH = ceil(float(ptH / dH)) * dH - ptH
-          //   startH = max(firstValidH, ho * sH - ptH)
-          //   endH = min(H, ho * sH + (kH - 1) * dH  + 1 - pbH)
           SmallVector<IndexExpr, 4> windowStartExprs, windowEndExprs;
-          for (int i = 0; i < kernelShapeSize; ++i) {
-            std::vector<IndexExpr> exprs =
-                getIndexExprsForConvWindow(IVExprs[i], ceilMode, isDilated);
-            windowStartExprs.emplace_back(exprs[0]);
-            windowEndExprs.emplace_back(exprs[1]);
-          }
-
-          // Compute the size of the full conv window.
-          //   hDim = round(float(endH - startH) / float(dH))
-          //   wDim = round(float(endW - startW) / float(dW))
           SmallVector<Value, 4> fullWindowSize;
-          for (int i = 0; i < kernelShapeSize; ++i) {
-            Value dim = create.math.sub(
-                windowEndExprs[i].getValue(), windowStartExprs[i].getValue());
-            if (isDilated) {
-              Value one = create.math.constantIndex(1);
-              Value numerator = create.math.add(dim, one);
-              Value denominator = IVExprs[i][5].getValue(); // dilations[i]
-              dim = create.math.div(numerator, denominator);
-              if (ceilMode) {
-                auto remainder = rewriter.create<arith::RemSIOp>(
-                    loc, numerator, denominator);
-                Value zero = create.math.constantIndex(0);
-                Value isZero = create.math.eq(remainder, zero);
-                Value dimPlusOne = create.math.add(dim, one);
-                dim = create.math.select(isZero, dim, dimPlusOne);
-              }
+          // Operands of the bounds of the pooling loops, when computed ahead
+          // of the loop over the channels of a block.
+          SmallVector<SmallVector<Value, 4>, 4> windowOperands;
+          auto computeWindows = [&]() {
+            // Prepare induction variables.
+            for (int i = 0; i < kernelShapeSize; ++i) {
+              int j = i + kernelOffset;
+              SmallVector<IndexExpr, 4> ic;
+              // d0, output
+              ic.emplace_back(outputIndices[j]);
+              // s0, input dim
+              ic.emplace_back(create.krnlIE.getShapeAsDim(inputOperand, j));
+              // s1, kernel dim
+              ic.emplace_back(SymbolIndexExpr(shapeHelper.kernelShape[i]));
+              // s2, pad dim
+              ic.emplace_back(SymbolIndexExpr(shapeHelper.pads[i]));
+              // s3, stride dim
+              ic.emplace_back(LiteralIndexExpr(shapeHelper.strides[i]));
+              // s4, dilation dim
+              ic.emplace_back(LiteralIndexExpr(shapeHelper.dilations[i]));
+              IVExprs.emplace_back(ic);
             }
-            fullWindowSize.emplace_back(dim);
-          }
 
-          // 2.3 Define pooling loops.
-          //  for hp in range(hDim):
-          //    for wp in range(wDim):
-          //      hi = hp * dH + startH
-          //      wi = wp * dW + startW
-          //      output[n][c][ho][wo] =
-          //        emitScalarOpFor(output[n][c][ho][wo], input[n, c, hi,
-          //        wi]);
-
-          // Old style krnl loop generation, do not reuse this pattern.
-          std::vector<Value> poolingLoops;
-          defineLoops(rewriter, loc, poolingLoops, kernelShapeSize);
-          krnl::KrnlIterateOperandPack pack(rewriter, poolingLoops);
-
-          // Push bounds.
-          AffineMap windowSizeMap =
-              getWindowAffineMap(rewriter, ceilMode, isDilated);
-          for (int i = 0; i < kernelShapeSize; ++i) {
-            // Affine map's operands.
-            SmallVector<Value, 4> operands;
-            for (IndexExpr expr : IVExprs[i])
-              operands.emplace_back(expr.getValue());
-            pack.pushConstantBound(0);
-            pack.pushAffineMapBound(windowSizeMap, operands);
-          }
-          KrnlIterateOp iterateOp = create.krnl.iterate(pack);
-          auto ipOuterLoopRegion = rewriter.saveInsertionPoint();
-          Block &iterationBlock = iterateOp.getBodyRegion().front();
-          rewriter.setInsertionPointToStart(&iterationBlock);
-          SmallVector<Value, 4> poolingLoopInd(
-              iterationBlock.getArguments().begin(),
-              iterationBlock.getArguments().end());
-
-          {
-            // 2.4 Emit the body of the pooling loop nest.
-            // Prepare indices to access a pixel in the input.
-            SmallVector<IndexExpr, 4> inputIndices;
-            { // Construct inputIndices
-              for (int i = 0; i < kernelOffset; ++i)
-                inputIndices.emplace_back(outputIndices[i]);
-              for (int i = kernelOffset; i < (int)inputShape.size(); ++i) {
-                int j = i - kernelOffset;
-                DimIndexExpr hp(poolingLoopInd[j]);
-                IndexExpr startH = windowStartExprs[j];
-                if (isDilated) {
-                  // hi = hp * dH + startH
-                  IndexExpr dH = IVExprs[j][5];
-                  inputIndices.emplace_back(hp * dH + startH);
-                } else {
-                  // hi = hp + startH
-                  inputIndices.emplace_back(hp + startH);
+            // Compute the start and end position of the conv window.
+            //   firstValidH = ceil(float(ptH / dH)) * dH - ptH
+            //   startH = max(firstValidH, ho * sH - ptH)
+            //   endH = min(H, ho * sH + (kH - 1) * dH  + 1 - pbH)
+            for (int i = 0; i < kernelShapeSize; ++i) {
+              std::vector<IndexExpr> exprs =
+                  getIndexExprsForConvWindow(IVExprs[i], ceilMode, isDilated);
+              windowStartExprs.emplace_back(exprs[0]);
+              windowEndExprs.emplace_back(exprs[1]);
+            }
+
+            // Compute the size of the full conv window.
+            //   hDim = round(float(endH - startH) / float(dH))
+            //   wDim = round(float(endW - startW) / float(dW))
+            for (int i = 0; i < kernelShapeSize; ++i) {
+              Value dim = create.math.sub(windowEndExprs[i].getValue(),
+                  windowStartExprs[i].getValue());
+              if (isDilated) {
+                Value one = create.math.constantIndex(1);
+                Value numerator = create.math.add(dim, one);
+                Value denominator = IVExprs[i][5].getValue(); // dilations[i]
+                dim = create.math.div(numerator, denominator);
+                if (ceilMode) {
+                  auto remainder = rewriter.create<arith::RemSIOp>(
+                      loc, numerator, denominator);
+                  Value zero = create.math.constantIndex(0);
+                  Value isZero = create.math.eq(remainder, zero);
+                  Value dimPlusOne = create.math.add(dim, one);
+                  dim = create.math.select(isZero, dim, dimPlusOne);
                 }
               }
+              fullWindowSize.emplace_back(dim);
             }
-
-            // Apply pooling operation.
+          };
+          auto getWindowOperands = [&](int i) {
+            SmallVector<Value, 4> operands;
+            for (IndexExpr expr : IVExprs[i])
+              operands.emplace_back(expr.getValue());
+            return operands;
+          };
+
+          // Pool the channel outputIndices[1], whose reduction value is at
+          // accIndices in reductionVal.
+          auto poolChannel = [&](ValueRange accIndices) {
+            // 2.1 Emit: output[n][c][ho][wo] = identity
+            create.krnl.store(identity, reductionVal, accIndices);
+            if (IVExprs.empty())
+              computeWindows();
+
+            // 2.3 Define pooling loops.
+            //  for hp in range(hDim):
+            //    for wp in range(wDim):
+            //      hi = hp * dH + startH
+            //      wi = wp * dW + startW
             //      output[n][c][ho][wo] =
             //        emitScalarOpFor(output[n][c][ho][wo], input[n, c, hi,
             //        wi]);
-            Value loadInput = create.krnl.loadIE(inputOperand, inputIndices);
-            Value loadPartialOutput = create.krnl.load(reductionVal);
-            Value output = emitScalarOpFor<PoolOp>(rewriter, loc, op,
-                outputElementType, {loadPartialOutput, loadInput});
-            create.krnl.store(output, reductionVal);
+
+            // Old style krnl loop generation, do not reuse this pattern.
+            std::vector<Value> poolingLoops;
+            defineLoops(rewriter, loc, poolingLoops, kernelShapeSize);
+            krnl::KrnlIterateOperandPack pack(rewriter, poolingLoops);
+
+            // Push bounds.
+            AffineMap windowSizeMap =
+                getWindowAffineMap(rewriter, ceilMode, isDilated);
+            for (int i = 0; i < kernelShapeSize; ++i) {
+              // Affine map's operands.
+              SmallVector<Value, 4> operands = windowOperands.empty()
+                                                   ? getWindowOperands(i)
+                                                   : windowOperands[i];
+              pack.pushConstantBound(0);
+              pack.pushAffineMapBound(windowSizeMap, operands);
+            }
+            KrnlIterateOp iterateOp = create.krnl.iterate(pack);
+            auto ipOuterLoopRegion = rewriter.saveInsertionPoint();
+            Block &iterationBlock = iterateOp.getBodyRegion().front();
+            rewriter.setInsertionPointToStart(&iterationBlock);
+            SmallVector<Value, 4> poolingLoopInd(
+                iterationBlock.getArguments().begin(),
+                iterationBlock.getArguments().end());
+
+            {
+              // 2.4 Emit the body of the pooling loop nest.
+              // Prepare indices to access a pixel in the input.
+              SmallVector<IndexExpr, 4> inputIndices;
+              { // Construct inputIndices
+                for (int i = 0; i < kernelOffset; ++i)
+                  inputIndices.emplace_back(outputIndices[i]);
+                for (int i = kernelOffset; i < (int)inputShape.size(); ++i) {
+                  int j = i - kernelOffset;
+                  DimIndexExpr hp(poolingLoopInd[j]);
+                  IndexExpr startH = windowStartExprs[j];
+                  if (isDilated) {
+                    // hi = hp * dH + startH
+                    IndexExpr dH = IVExprs[j][5];
+                    inputIndices.emplace_back(hp * dH + startH);
+                  } else {
+                    // hi = hp + startH
+                    inputIndices.emplace_back(hp + startH);
+                  }
+                }
+              }
+
+              // Apply pooling operation.
+              //      output[n][c][ho][wo] =
+              //        emitScalarOpFor(output[n][c][ho][wo], input[n, c, hi,
+              //        wi]);
+              Value loadInput = create.krnl.loadIE(inputOperand, inputIndices);
+              Value loadPartialOutput =
+                  create.krnl.load(reductionVal, accIndices);
+              Value output = emitScalarOpFor<PoolOp>(rewriter, loc, op,
+                  outputElementType, {loadPartialOutput, loadInput});
+              create.krnl.store(output, reductionVal, accIndices);
+            }
+            rewriter.restoreInsertionPoint(ipOuterLoopRegion);
+            Value output = create.krnl.load(reductionVal, accIndices);
+            create.krnl.storeIE(output, alloc, outputIndices);
+
+            // 2.5 Post-processing for the pooling window, e.g. taking
+            // average.
+            SmallVector<Value, 4> outputIndicesInValue;
+            for (IndexExpr expr : outputIndices)
+              outputIndicesInValue.emplace_back(expr.getValue());
+            postProcessPoolingWindow<PoolOp>(rewriter, loc, poolOp, alloc,
+                outputIndicesInValue, shapeHelper.kernelShape, fullWindowSize);
+          };
+
+          if (cBlock == 1) {
+            poolChannel({});
+            return;
           }
-          rewriter.restoreInsertionPoint(ipOuterLoopRegion);
-          Value output = createKrnl.load(reductionVal);
-          create.krnl.storeIE(output, alloc, outputIndices);
-
-          // 2.5 Post-processing for the pooling window, e.g. taking
-          // average.
-          SmallVector<Value, 4> outputIndicesInValue;
-          for (IndexExpr expr : outputIndices)
-            outputIndicesInValue.emplace_back(expr.getValue());
-          postProcessPoolingWindow<PoolOp>(rewriter, loc, poolOp, alloc,
-              outputIndicesInValue, shapeHelper.kernelShape, fullWindowSize);
+          // for cInBlock in range(cBlock):
+          //   c = cb * cBlock + cInBlock
+          computeWindows();
+          for (int i = 0; i < kernelShapeSize; ++i)
+            windowOperands.emplace_back(getWindowOperands(i));
+          IndexExpr cb = outputIndices[1];
+          ValueRange blockLoop = create.krnl.defineLoops(1);
+          create.krnl.unrollJam(blockLoop[0], cBlock);
+          create.krnl.iterateIE(blockLoop, blockLoop, {LiteralIndexExpr(0)},
+              {LiteralIndexExpr(cBlock)},
+              [&](KrnlBuilder &createKrnl, ValueRange blockIndices) {
+                outputIndices[1] = cb * cBlock + DimIndexExpr(blockIndices[0]);
+                poolChannel(blockIndices);
+              });
         });
 
     rewriter.replaceOp(op, alloc);
 
     return success();
   }
+
+  // Emit SIMD code for the 2D pooling of the static float tensor `input`
+  // without dilation into `alloc`:
+  //   Y[n, c, ho, wo] =
+  //       op_{kh, kw} X[n, c, ho * sh + kh - ph, wo * sw + kw - pw]
+  // and return false when the pooling is not amenable to it. The KH * KW taps
+  // of the window are unrolled. The output columns whose taps are all in the
+  // columns of the image are computed VL at a time with vector loads, without
+  // any check of the padding, and the ones reaching into the padding one at a
+  // time, in separate loops on the left and right sides. The taps in the
+  // padding rows load from a row clamped into the image, and the loaded values
+  // are then replaced by the identity. The (n, c) planes are computed in
+  // parallel when `enableParallel`.
+  bool emitSimdPooling(ConversionPatternRewriter &rewriter, PoolOp poolOp,
+      PoolOpShapeHelper &shapeHelper, Value input, Value alloc) const {
+    Operation *op = poolOp.getOperation();
+    Location loc = ONNXLoc<PoolOp>(op);
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder, VectorBuilder>
+        create(rewriter, loc);
+
+    MemRefType xType = input.getType().cast<MemRefType>();
+    MemRefType yType = alloc.getType().cast<MemRefType>();
+    Type elementType = yType.getElementType();
+    if (!elementType.isF32() || xType.getRank() != 4 ||
+        !xType.hasStaticShape() || !yType.hasStaticShape() ||
+        hasNonIdentityLayout(input) || hasNonIdentityLayout(alloc))
+      return false;
+    for (IndexExpr kernel : shapeHelper.kernelShape)
+      if (!kernel.isLiteral())
+        return false;
+    for (IndexExpr pad : shapeHelper.pads)
+      if (!pad.isLiteral())
+        return false;
+    ArrayRef<int64_t> xShape = xType.getShape();
+    ArrayRef<int64_t> yShape = yType.getShape();
+    int64_t H = xShape[2], W = xShape[3];
+    int64_t KH = shapeHelper.kernelShape[0].getLiteral();
+    int64_t KW = shapeHelper.kernelShape[1].getLiteral();
+    int64_t HO = yShape[2], WO = yShape[3];
+    int64_t sh = shapeHelper.strides[0], sw = shapeHelper.strides[1];
+    int64_t ph = shapeHelper.pads[0].getLiteral();
+    int64_t pw = shapeHelper.pads[1].getLiteral();
+    if (KH * KW > kSimdPoolingMaxTaps)
+      return false;
+
+    // The output columns [woLo, woLo + numVec * VL) are computed VL at a time,
+    // each tap loading VL * sw contiguous columns of the image, of which every
+    // sw-th one is kept. A block starting at wo0 requires
+    //   wo0 * sw - pw >= 0
+    //   wo0 * sw + KW - 1 - pw + VL * sw - 1 <= W - 1.
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    int64_t loadLength = VL * sw;
+    VectorType vecType = VectorType::get({VL}, elementType);
+    VectorType loadType = VectorType::get({loadLength}, elementType);
+    int64_t woLo = std::min<int64_t>(llvm::divideCeil(pw, sw), WO);
+    int64_t maxStart = W - loadLength - (KW - 1) + pw;
+    int64_t numVec = 0;
+    if (maxStart >= woLo * sw)
+      numVec = std::min((maxStart / sw - woLo) / VL + 1, (WO - woLo) / VL);
+    if (numVec == 0)
+      return false;
+    int64_t woVecEnd = woLo + numVec * VL;
+    SmallVector<int64_t, 16> strideMask;
+    for (int64_t i = 0; i < VL; ++i)
+      strideMask.emplace_back(i * sw);
+
+    // Whether some taps may be in the padding, before or after the image.
+    bool checkRows = ph > 0 || (HO - 1) * sh + KH - 1 - ph > H - 1;
+    bool isAverage = std::is_same<PoolOp, ONNXAveragePoolOp>::value;
+    bool countIncludePad = getCountIncludePad<PoolOp>(poolOp);
+
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value identity = getIdentityValue<PoolOp>(rewriter, loc, elementType);
+    Value vecIdentity = create.vec.splat(vecType, identity);
+    Value loadIdentity = create.vec.splat(loadType, identity);
+
+    // Divisor of the sum of the `numTaps` taps in the image, for AveragePool.
+    auto getDivisor = [&](Value numTaps) -> Value {
+      if (countIncludePad)
+        return create.math.constant(elementType, KH * KW);
+      Value divisor = rewriter.create<arith::IndexCastOp>(
+          loc, rewriter.getI64Type(), numTaps);
+      return rewriter.create<arith::SIToFPOp>(loc, elementType, divisor);
+    };
+
+    // for n = 0 .. N:
+    //   for c = 0 .. C:
+    auto bodyFunction = [&](ValueRange outerIndices) {
+      Value n(outerIndices[0]), c(outerIndices[1]);
+
+      // for ho = 0 .. HO:
+      ValueRange rowLoop = create.krnl.defineLoops(1);
+      create.krnl.iterateIE(rowLoop, rowLoop, {LiteralIndexExpr(0)},
+          {LiteralIndexExpr(HO)},
+          [&](KrnlBuilder &createKrnl, ValueRange rowIndices) {
+            IndexExprScope rowScope(createKrnl);
+            MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder>
+                create(createKrnl);
+            Value ho = rowIndices[0];
+            // Rows of the taps, clamped into the image, whether they are in
+            // the image, and their number in the image.
+            SmallVector<Value, 8> rows, rowsIn;
+            for (int64_t kh = 0; kh < KH; ++kh) {
+              IndexExpr h = DimIndexExpr(ho) * sh + (kh - ph);
+              if (checkRows) {
+                rowsIn.emplace_back(((h >= 0) & (h < H)).getValue());
+                h = IndexExpr::min(IndexExpr::max(h, 0), H - 1);
+              }
+              rows.emplace_back(h.getValue());
+            }
+            IndexExpr numRowsExpr = LiteralIndexExpr(KH);
+            if (checkRows) {
+              IndexExpr h0 = DimIndexExpr(ho) * sh - ph;
+              numRowsExpr =
+                  IndexExpr::min(h0 + KH, H) - IndexExpr::max(h0, 0);
+            }
+            Value numRows = numRowsExpr.getValue();
+
+            // for wo = woLB .. woUB, one output column at a time.
+            auto emitScalarColumns = [&](int64_t woLB, int64_t woUB) {
+              if (woLB >= woUB)
+                return;
+              ValueRange colLoop = create.krnl.defineLoops(1);
+              create.krnl.iterateIE(colLoop, colLoop,
+                  {LiteralIndexExpr(woLB)}, {LiteralIndexExpr(woUB)},
+                  [&](KrnlBuilder &createKrnl, ValueRange colIndices) {
+                    IndexExprScope colScope(createKrnl);
+                    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                        createKrnl);
+                    Value wo = colIndices[0];
+                    Value result = identity;
+                    for (int64_t kw = 0; kw < KW; ++kw) {
+                      IndexExpr w = DimIndexExpr(wo) * sw + (kw - pw);
+                      Value colIn = ((w >= 0) & (w < W)).getValue();
+                      w = IndexExpr::min(IndexExpr::max(w, 0), W - 1);
+                      for (int64_t kh = 0; kh < KH; ++kh) {
+                        Value image = create.krnl.load(
+                            input, {n, c, rows[kh], w.getValue()});
+                        Value isIn = colIn;
+                        if (checkRows)
+                          isIn = create.math.andi(colIn, rowsIn[kh]);
+                        image = create.math.select(isIn, image, identity);
+                        result = emitScalarOpFor<PoolOp>(rewriter, loc, op,
+                            elementType, {result, image});
+                      }
+                    }
+                    if (isAverage) {
+                      IndexExpr w0 = DimIndexExpr(wo) * sw - pw;
+                      IndexExpr numCols =
+                          IndexExpr::min(w0 + KW, W) - IndexExpr::max(w0, 0);
+                      Value numTaps =
+                          create.math.mul(numRows, numCols.getValue());
+                      result = create.math.div(result, getDivisor(numTaps));
+                    }
+                    create.krnl.store(result, alloc, {n, c, ho, wo});
+                  });
+            };
+
+            // Output columns on the left side, reaching into the padding.
+            emitScalarColumns(0, woLo);
+
+            // for wo = woLo .. woVecEnd step VL, VL output columns at a time.
+            Value vecDivisor;
+            if (isAverage) {
+              Value numTaps = create.math.mul(
+                  numRows, create.math.constantIndex(KW));
+              vecDivisor = create.vec.splat(vecType, getDivisor(numTaps));
+            }
+            ValueRange vecLoop = create.krnl.defineLoops(1);
+            ValueRange blockedVecLoop = create.krnl.block(vecLoop[0], VL);
+            create.krnl.iterateIE(vecLoop, {blockedVecLoop[0]},
+                {LiteralIndexExpr(woLo)}, {LiteralIndexExpr(woVecEnd)},
+                [&](KrnlBuilder &createKrnl, ValueRange vecIndices) {
+                  IndexExprScope vecScope(createKrnl);
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder>
+                      create(createKrnl);
+                  Value wo = vecIndices[0];
+                  Value result = vecIdentity;
+                  for (int64_t kw = 0; kw < KW; ++kw) {
+                    IndexExpr w = DimIndexExpr(wo) * sw + (kw - pw);
+                    for (int64_t kh = 0; kh < KH; ++kh) {
+                      Value image = create.vec.load(
+                          loadType, input, {n, c, rows[kh], w.getValue()});
+                      if (checkRows)
+                        image =
+                            create.math.select(rowsIn[kh], image, loadIdentity);
+                      if (sw > 1)
+                        image = create.vec.shuffle(image, image, strideMask);
+                      result = emitScalarOpFor<PoolOp>(
+                          rewriter, loc, op, vecType, {result, image});
+                    }
+                  }
+                  if (isAverage)
+                    result = create.math.div(result, vecDivisor);
+                  create.vec.store(result, alloc, {n, c, ho, wo});
+                });
+
+            // Remaining output columns, on the right side.
+            emitScalarColumns(woVecEnd, WO);
+          });
+    };
+
+    Value N = create.math.constantIndex(yShape[0]);
+    Value C = create.math.constantIndex(yShape[1]);
+    if (enableParallel) {
+      // Each plane is computed inside a krnl.region, so that its Krnl loops
+      // get their own affine scope.
+      create.scf.parallelLoop({zero, zero}, {N, C}, {one, one},
+          [&](SCFBuilder &createSCF, ValueRange outerIndices) {
+            OpBuilder &builder = createSCF.getBuilder();
+            KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+            OpBuilder::InsertionGuard insertGuard(builder);
+            builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+            bodyFunction(outerIndices);
+          });
+    } else {
+      ValueRange outerLoops = create.krnl.defineLoops(2);
+      create.krnl.iterate(outerLoops, outerLoops, {zero, zero}, {N, C},
+          [&](KrnlBuilder &create, ValueRange outerIndices) {
+            bodyFunction(outerIndices);
+          });
+    }
+    return true;
+  }
 };
 
 void populateLoweringONNXPoolingOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
   patterns.insert<ONNXPoolOpLowering<ONNXMaxPoolSingleOutOp,
       ONNXMaxPoolSingleOutOpAdaptor, ONNXMaxPoolSingleOutOpShapeHelper>>(
-      typeConverter, ctx);
+      typeConverter, ctx, enableSIMD, enableParallel);
   patterns.insert<ONNXPoolOpLowering<ONNXAveragePoolOp,
       ONNXAveragePoolOpAdaptor, ONNXAveragePoolOpShapeHelper>>(
-      typeConverter, ctx);
+      typeConverter, ctx, enableSIMD, enableParallel);
 }
 
 } // namespace onnx_mlir
@@ -23,6 +23,10 @@
 #include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
 #include "src/Dialect/ONNX/OnnxElementsAttrBuilder.hpp"
 
+#include <ctime>
+#include <limits>
+#include <numeric>
+
 using namespace mlir;
 
 namespace onnx_mlir {
@@ -129,6 +133,39 @@ bool indicesAreNonNegativeConstants(Value indices) {
       [](const IntegerAttr &val) { return val.getInt() >= 0; });
 }
 
+/// Check if the stores of an output of the given type should bypass the caches,
+/// namely when it has a static shape larger than the last level cache, so that
+/// its lines would be evicted before being read again.
+bool useNontemporalStores(MemRefType outputType) {
+  // Size in bytes of a typical last level cache.
+  static constexpr int64_t kNontemporalStoreMinSize = 32 * 1024 * 1024;
+  Type elementType = outputType.getElementType();
+  if (!outputType.hasStaticShape() || !elementType.isIntOrFloat())
+    return false;
+  int64_t sizeInBytes =
+      outputType.getNumElements() * elementType.getIntOrFloatBitWidth() / 8;
+  return sizeInBytes >= kNontemporalStoreMinSize;
+}
+
+bool isShapeLikeMemRef(MemRefType type) {
+  // Maximum number of elements of a shape, above the rank of any model.
+  static constexpr int64_t kShapeMaxSize = 16;
+  return type.hasStaticShape() && type.getRank() <= 1 &&
+         type.getLayout().isIdentity() &&
+         type.getElementType().isa<IntegerType>() &&
+         type.getNumElements() <= kShapeMaxSize;
+}
+
+Value getInPlaceOperandBuffer(Operation *op, unsigned operandIndex,
+    Value operand, MemRefType outputType) {
+  auto allocOp = operand.getDefiningOp<memref::AllocOp>();
+  if (!allocOp || allocOp->getBlock() != op->getBlock() ||
+      allocOp.getType() != outputType ||
+      !op->getOperand(operandIndex).hasOneUse())
+    return nullptr;
+  return allocOp.getResult();
+}
+
 // Create a mapping from result type's dimensions to input type's dimensions,
 // given that the result type is the result of a reduction op over the input
 // type.
@@ -196,10 +233,6 @@ Value getDimOrConstant(ConversionPatternRewriter &rewriter, Location loc,
              : create.math.constant(type, shape[axis]);
 }
 
-namespace {
-// Returns the DenseElementsAttr of input if it's a krnl.global constant or
-// onnx.Constant, or if it's one step removed from a krnl/onnx constant by a
-// builtin.unrealized_conversion_cast. Otherwise returns a nullptr attribute.
 DenseElementsAttr getDenseElementAttrFromConstValue(mlir::Value value) {
   Operation *definingOp = value.getDefiningOp();
   if (auto castOp = dyn_cast_or_null<UnrealizedConversionCastOp>(definingOp)) {
@@ -216,7 +249,6 @@ DenseElementsAttr getDenseElementAttrFromConstValue(mlir::Value value) {
   }
   return nullptr;
 }
-} // namespace
 
 /// Emit an ONNXSqueezeV11Op. If the input is constant, do const propagation,
 /// and return a constant.
@@ -426,6 +458,443 @@ Value emitArgSort(ConversionPatternRewriter &rewriter, Location loc,
   return order;
 }
 
+/// Emit a krnl.call to compute the indices of the first k values in the
+/// sorting order along the innermost axis. By default, select the largest
+/// values.
+Value emitArgTopK(ConversionPatternRewriter &rewriter, Location loc,
+    Value input, int64_t axis, int64_t k, bool ascending) {
+  MultiDialectBuilder<IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>
+      create(rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+
+  MemRefType inputMemRefType = input.getType().cast<MemRefType>();
+  int64_t rank = inputMemRefType.getRank();
+  assert((rank <= 6) && (axis == (rank - 1)) &&
+         "omTensorTopK assumes rank <= 6 and axis == (rank - 1)");
+
+  // Create the result, which omTensorTopK fully initializes.
+  SmallVector<IndexExpr, 4> dims;
+  create.krnlIE.getShapeAsDims(input, dims);
+  dims[axis] = LiteralIndexExpr(k);
+  SmallVector<int64_t, 4> shape(inputMemRefType.getShape());
+  shape[axis] = k;
+  MemRefType type = MemRefType::get(shape, rewriter.getIndexType());
+  Value order = create.mem.alignedAlloc(type, dims);
+
+  // Emit krnl.Call to call omTensorTopK API
+  Type intType = rewriter.getIntegerType(64);
+  Value valAxis = create.math.constant(intType, axis);
+  Value valAscending = create.math.constant(intType, (int64_t)ascending);
+  SmallVector<Value, 4> operands = {input, valAxis, valAscending};
+  rewriter.create<KrnlCallOp>(loc, "omTensorTopK", order, operands);
+  return order;
+}
+
+void emitRandomUniform(ConversionPatternRewriter &rewriter, Location loc,
+    Value alloc, double low, double high, llvm::Optional<APFloat> seed) {
+  MultiDialectBuilder<MathBuilder> create(rewriter, loc);
+  Type elementType = alloc.getType().cast<MemRefType>().getElementType();
+  assert((elementType.isF32() || elementType.isF64()) &&
+         "omTensorRandomUniform assumes float or double values");
+  srand(time(NULL));
+  double doubleSeed = rand() % 100;
+  if (seed)
+    doubleSeed = seed->convertToDouble();
+
+  // Emit krnl.Call to call omTensorRandomUniform API
+  Type f64Type = rewriter.getF64Type();
+  Value valLow = create.math.constant(f64Type, low);
+  Value valHigh = create.math.constant(f64Type, high);
+  Value valSeed = create.math.constant(f64Type, doubleSeed);
+  SmallVector<Value, 4> operands = {valLow, valHigh, valSeed};
+  rewriter.create<KrnlCallOp>(loc, "omTensorRandomUniform", alloc, operands);
+}
+
+// Maximum number of blocks of omTensorNonZeroCount, which splits the values
+// into blocks of at least 4096 values.
+static constexpr int64_t kNonZeroMaxBlocks = 256;
+
+Value emitNonZeroCount(ConversionPatternRewriter &rewriter, Location loc,
+    Value input, Value &count) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+      rewriter, loc);
+
+  // omTensorNonZeroCount writes the offsets of the blocks, followed by the
+  // total number of nonzero values.
+  Type intType = rewriter.getIntegerType(64);
+  Value offsets = create.mem.alignedAlloc(
+      MemRefType::get({kNonZeroMaxBlocks + 1}, intType));
+  rewriter.create<KrnlCallOp>(
+      loc, "omTensorNonZeroCount", offsets, ValueRange{input});
+  Value total = create.krnl.load(
+      offsets, {create.math.constantIndex(kNonZeroMaxBlocks)});
+  count = create.math.cast(rewriter.getIndexType(), total);
+  return offsets;
+}
+
+//===----------------------------------------------------------------------===//
+// Support for bulk copies of contiguous runs of elements.
+//===----------------------------------------------------------------------===//
+
+// Minimum number of elements of the contiguous runs copied by emitBulkCopy,
+// below which copying them element by element is as fast.
+static constexpr int64_t kBulkCopyMinRunSize = 64;
+
+// Return the outermost dim spanned by the contiguous runs of the copy,
+// namely the dim before its innermost dims that are whole dims of src and
+// dest. Set runSize to a lower bound of the number of elements of a run.
+static int64_t getBulkCopyRunDim(MemRefType srcType,
+    ArrayRef<IndexExpr> srcStarts, MemRefType destType,
+    ArrayRef<IndexExpr> destStarts, ArrayRef<IndexExpr> sizes,
+    int64_t &runSize) {
+  ArrayRef<int64_t> srcShape = srcType.getShape();
+  ArrayRef<int64_t> destShape = destType.getShape();
+  int64_t d = sizes.size() - 1;
+  runSize = 1;
+  auto isWholeDim = [&](int64_t k) {
+    return sizes[k].isLiteral() && srcStarts[k].isLiteralAndIdenticalTo(0) &&
+           destStarts[k].isLiteralAndIdenticalTo(0) &&
+           srcShape[k] == sizes[k].getLiteral() &&
+           destShape[k] == sizes[k].getLiteral();
+  };
+  while (d > 0 && isWholeDim(d))
+    runSize *= sizes[d--].getLiteral();
+  if (sizes[d].isLiteral())
+    runSize *= sizes[d].getLiteral();
+  return d;
+}
+
+bool canEmitBulkCopy(Value src, ArrayRef<IndexExpr> srcStarts, Value dest,
+    ArrayRef<IndexExpr> destStarts, ArrayRef<IndexExpr> sizes) {
+  MemRefType srcType = src.getType().cast<MemRefType>();
+  MemRefType destType = dest.getType().cast<MemRefType>();
+  if (sizes.empty() || !srcType.getLayout().isIdentity() ||
+      !destType.getLayout().isIdentity() ||
+      srcType.getElementType() != destType.getElementType())
+    return false;
+  int64_t runSize;
+  getBulkCopyRunDim(srcType, srcStarts, destType, destStarts, sizes, runSize);
+  return runSize >= kBulkCopyMinRunSize;
+}
+
+void emitBulkCopy(ConversionPatternRewriter &rewriter, Location loc,
+    Value src, ArrayRef<IndexExpr> srcStarts, Value dest,
+    ArrayRef<IndexExpr> destStarts, ArrayRef<IndexExpr> sizes) {
+  assert(canEmitBulkCopy(src, srcStarts, dest, destStarts, sizes) &&
+         "expected a copy of contiguous runs");
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder>
+      create(rewriter, loc);
+  int64_t runSize;
+  int64_t d = getBulkCopyRunDim(src.getType().cast<MemRefType>(), srcStarts,
+      dest.getType().cast<MemRefType>(), destStarts, sizes, runSize);
+
+  // Strides of the dims up to d in src and dest.
+  DimsExpr srcDims, destDims;
+  create.krnlIE.getShapeAsSymbols(src, srcDims);
+  create.krnlIE.getShapeAsSymbols(dest, destDims);
+  int64_t rank = sizes.size();
+  SmallVector<IndexExpr, 4> srcStrides(d + 1), destStrides(d + 1);
+  IndexExpr srcStride = LiteralIndexExpr(1);
+  IndexExpr destStride = LiteralIndexExpr(1);
+  for (int64_t k = rank - 1; k >= 0; --k) {
+    if (k <= d) {
+      srcStrides[k] = srcStride;
+      destStrides[k] = destStride;
+    }
+    srcStride = srcStride * srcDims[k];
+    destStride = destStride * destDims[k];
+  }
+  IndexExpr numElems = sizes[d];
+  for (int64_t k = d + 1; k < rank; ++k)
+    numElems = numElems * sizes[k];
+  Value numElemsI64 =
+      create.math.cast(rewriter.getI64Type(), numElems.getValue());
+
+  // Copy the run starting at the given indices of the dims before d.
+  auto copyRun = [&](KrnlBuilder &createKrnl, ValueRange outerIndices) {
+    IndexExprScope runScope(createKrnl);
+    MultiDialectBuilder<KrnlBuilder> create(createKrnl);
+    IndexExpr srcOffset = SymbolIndexExpr(srcStarts[d]) *
+                          SymbolIndexExpr(srcStrides[d]);
+    IndexExpr destOffset = SymbolIndexExpr(destStarts[d]) *
+                           SymbolIndexExpr(destStrides[d]);
+    for (int64_t k = 0; k < d; ++k) {
+      DimIndexExpr index(outerIndices[k]);
+      srcOffset = srcOffset + (index + SymbolIndexExpr(srcStarts[k])) *
+                                  SymbolIndexExpr(srcStrides[k]);
+      destOffset = destOffset + (index + SymbolIndexExpr(destStarts[k])) *
+                                    SymbolIndexExpr(destStrides[k]);
+    }
+    create.krnl.memcpy(dest, src, numElemsI64, destOffset.getValue(),
+        srcOffset.getValue());
+  };
+  if (d == 0) {
+    copyRun(create.krnl, {});
+    return;
+  }
+  ValueRange loopDef = create.krnl.defineLoops(d);
+  SmallVector<IndexExpr, 4> lbs(d, LiteralIndexExpr(0));
+  SmallVector<IndexExpr, 4> ubs(sizes.begin(), sizes.begin() + d);
+  create.krnl.iterateIE(loopDef, loopDef, lbs, ubs, copyRun);
+}
+
+//===----------------------------------------------------------------------===//
+// Support for views of byte buffers.
+//===----------------------------------------------------------------------===//
+
+Value getOrCreateByteBuffer(ConversionPatternRewriter &rewriter, Operation *op,
+    Value val, int64_t &byteOffset) {
+  MemRefType type = val.getType().dyn_cast<MemRefType>();
+  if (!type || !type.hasStaticShape() || !type.getLayout().isIdentity() ||
+      !type.getElementType().isIntOrFloat() ||
+      type.getElementTypeBitWidth() % 8 != 0)
+    return nullptr;
+  // Look through a view of a byte buffer.
+  if (auto viewOp = val.getDefiningOp<memref::ViewOp>()) {
+    auto byteShift =
+        viewOp.getByteShift().getDefiningOp<arith::ConstantIndexOp>();
+    if (!byteShift)
+      return nullptr;
+    byteOffset = byteShift.value();
+    return viewOp.getSource();
+  }
+  auto allocOp = val.getDefiningOp<memref::AllocOp>();
+  if (!allocOp || allocOp->getBlock() != op->getBlock())
+    return nullptr;
+  // Replace the alloc by a view of a byte buffer of the same size.
+  OpBuilder::InsertionGuard insertGuard(rewriter);
+  rewriter.setInsertionPoint(allocOp);
+  MultiDialectBuilder<MemRefBuilder> create(rewriter, allocOp.getLoc());
+  MemRefType bufferType = MemRefType::get(
+      {type.getNumElements() * type.getElementTypeBitWidth() / 8},
+      rewriter.getIntegerType(8));
+  Value buffer = allocOp.getAlignment().has_value()
+                     ? create.mem.alignedAlloc(
+                           bufferType, allocOp.getAlignment().value())
+                     : create.mem.alloc(bufferType);
+  Value view = create.mem.view(buffer, 0, type, {});
+  rewriter.replaceOp(allocOp, view);
+  byteOffset = 0;
+  return buffer;
+}
+
+//===----------------------------------------------------------------------===//
+// Support for SIMD kernels along the innermost dimension.
+//===----------------------------------------------------------------------===//
+
+void emitSimdLoopWithScalarTail(KrnlBuilder &createKrnl, IndexExpr ub,
+    int64_t VL, Type elementType,
+    function_ref<void(KrnlBuilder &createKrnl, Type type, Value index)>
+        bodyFn) {
+  IndexExpr simdUb = LiteralIndexExpr(0);
+  if (VL > 1) {
+    // Iterate only over the full blocks.
+    simdUb = ub.floorDiv(VL) * VL;
+    VectorType vecType = VectorType::get({VL}, elementType);
+    ValueRange loopDef = createKrnl.defineLoops(1);
+    ValueRange blockedLoopDef = createKrnl.block(loopDef[0], VL);
+    createKrnl.iterateIE(loopDef, {blockedLoopDef[0]}, {LiteralIndexExpr(0)},
+        {simdUb}, [&](KrnlBuilder &ck, ValueRange loopInd) {
+          bodyFn(ck, vecType, loopInd[0]);
+        });
+  }
+  // Remaining iterations, if any.
+  if (simdUb.isLiteral() && ub.isLiteral() &&
+      simdUb.getLiteral() == ub.getLiteral())
+    return;
+  ValueRange loopDef = createKrnl.defineLoops(1);
+  createKrnl.iterateIE(loopDef, loopDef, {simdUb}, {ub},
+      [&](KrnlBuilder &ck, ValueRange loopInd) {
+        bodyFn(ck, elementType, loopInd[0]);
+      });
+}
+
+void emitSimdLoopWithMaskedTail(KrnlBuilder &createKrnl, IndexExpr ub,
+    int64_t VL,
+    function_ref<void(KrnlBuilder &createKrnl, Value index, Value mask)>
+        bodyFn) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder> create(createKrnl);
+  // Iterate over the full blocks, if any.
+  IndexExpr simdUb = ub.floorDiv(VL) * VL;
+  if (!simdUb.isLiteral() || simdUb.getLiteral() > 0) {
+    ValueRange loopDef = create.krnl.defineLoops(1);
+    ValueRange blockedLoopDef = create.krnl.block(loopDef[0], VL);
+    create.krnl.iterateIE(loopDef, {blockedLoopDef[0]}, {LiteralIndexExpr(0)},
+        {simdUb}, [&](KrnlBuilder &ck, ValueRange loopInd) {
+          bodyFn(ck, loopInd[0], nullptr);
+        });
+  }
+  // Last partial block, if any.
+  IndexExpr numValid = ub - simdUb;
+  if (numValid.isLiteral() && numValid.getLiteral() == 0)
+    return;
+  auto emitTail = [&](KrnlBuilder &ck) {
+    MultiDialectBuilder<VectorBuilder> create(ck);
+    bodyFn(ck, simdUb.getValue(),
+        create.vec.createMask(VL, numValid.getValue()));
+  };
+  if (numValid.isLiteral()) {
+    emitTail(create.krnl);
+    return;
+  }
+  create.scf.ifThenElse(
+      create.math.gt(numValid.getValue(), create.math.constantIndex(0)),
+      [&](SCFBuilder &createSCF) {
+        KrnlBuilder ck(createSCF);
+        emitTail(ck);
+      });
+}
+
+Value loadScalarOrVector(KrnlBuilder &createKrnl, Type type, Value memref,
+    ValueRange indices, Value mask, Value passThru) {
+  MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(createKrnl);
+  VectorType vecType = type.dyn_cast<VectorType>();
+  if (vecType && mask)
+    return create.vec.maskedLoad(vecType, memref, indices, mask,
+        create.vec.splat(vecType, passThru));
+  if (vecType)
+    return create.vec.load(vecType, memref, indices);
+  return create.krnl.load(memref, indices);
+}
+
+void storeScalarOrVector(KrnlBuilder &createKrnl, Value val, Value memref,
+    ValueRange indices, Value mask) {
+  MultiDialectBuilder<KrnlBuilder, VectorBuilder> create(createKrnl);
+  if (val.getType().isa<VectorType>() && mask)
+    create.vec.maskedStore(val, memref, indices, mask);
+  else if (val.getType().isa<VectorType>())
+    create.vec.store(val, memref, indices);
+  else
+    create.krnl.store(val, memref, indices);
+}
+
+bool emitSimdArgMinMax(ConversionPatternRewriter &rewriter, Location loc,
+    Value input, bool isMin, bool enableParallel,
+    function_ref<void(
+        KrnlBuilder &createKrnl, ValueRange outerIndices, Value argIndex)>
+        rowFn) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder, VectorBuilder>
+      create(rewriter, loc);
+  MemRefType inputType = input.getType().cast<MemRefType>();
+  Type elementType = inputType.getElementType();
+  int64_t rank = inputType.getRank();
+  if (!elementType.isF32() || rank == 0 || !inputType.hasStaticShape() ||
+      hasNonIdentityLayout(input))
+    return false;
+  ArrayRef<int64_t> shape = inputType.getShape();
+  int64_t N = shape[rank - 1];
+  int64_t VL = create.vec.getMachineVectorLength(elementType);
+  if (N < VL || N > std::numeric_limits<int32_t>::max())
+    return false;
+
+  // The lanes track the best value of their columns and its index, as i32
+  // to have as many lanes as the values. A value replaces the best one only
+  // if strictly better, which keeps the first index of the ties of a lane
+  // and never selects a NaN.
+  Type i32Type = rewriter.getI32Type();
+  VectorType vecType = VectorType::get({VL}, elementType);
+  VectorType indexVecType = VectorType::get({VL}, i32Type);
+  SmallVector<int32_t, 16> laneIds(VL);
+  std::iota(laneIds.begin(), laneIds.end(), 0);
+  Value laneIdsVec = rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(indexVecType, llvm::makeArrayRef(laneIds)));
+  double inf = std::numeric_limits<double>::infinity();
+  Value worst = create.math.constant(elementType, isMin ? inf : -inf);
+  Value iZero = create.math.constant(i32Type, 0);
+  Value iMax =
+      create.math.constant(i32Type, std::numeric_limits<int32_t>::max());
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  Value vecLen = create.math.constantIndex(VL);
+  Value simdUb = create.math.constantIndex(N / VL * VL);
+  Value ub = create.math.constantIndex(N);
+
+  auto emitRow = [&](KrnlBuilder &createKrnl, ValueRange outerIndices) {
+    OpBuilder &builder = createKrnl.getBuilder();
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+        createKrnl);
+    auto isBetter = [&](MathBuilder &createMath, Value x, Value best) {
+      return isMin ? createMath.lt(x, best) : createMath.gt(x, best);
+    };
+    // Update the best value and its index with the values at column `col`.
+    auto update = [&](OpBuilder &forBuilder, Location forLoc, Value col,
+                      ValueRange bests, Type type) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+          forBuilder, forLoc);
+      SmallVector<Value, 4> indices(outerIndices.begin(), outerIndices.end());
+      indices.emplace_back(col);
+      Value x = loadScalarOrVector(create.krnl, type, input, indices);
+      Value pos = create.math.cast(i32Type, col);
+      if (type.isa<VectorType>())
+        pos = create.math.add(create.vec.splat(indexVecType, pos), laneIdsVec);
+      Value better = isBetter(create.math, x, bests[0]);
+      forBuilder.create<scf::YieldOp>(forLoc,
+          ValueRange{create.math.select(better, x, bests[0]),
+              create.math.select(better, pos, bests[1])});
+    };
+    scf::ForOp simdLoop = builder.create<scf::ForOp>(loc, zero, simdUb, vecLen,
+        ValueRange{create.vec.splat(vecType, worst),
+            create.vec.splat(indexVecType, iZero)},
+        [&](OpBuilder &forBuilder, Location forLoc, Value col,
+            ValueRange bests) {
+          update(forBuilder, forLoc, col, bests, vecType);
+        });
+    scf::ForOp tailLoop = builder.create<scf::ForOp>(loc, simdUb, ub, one,
+        ValueRange{worst, iZero},
+        [&](OpBuilder &forBuilder, Location forLoc, Value col,
+            ValueRange bests) {
+          update(forBuilder, forLoc, col, bests, elementType);
+        });
+
+    // The first index of the best value is the smallest index of the lanes
+    // holding it, unless the remaining values hold a strictly better one.
+    Value bestVec = simdLoop.getResult(0);
+    Value best = create.vec.reduction(isMin ? vector::CombiningKind::MINF
+                                            : vector::CombiningKind::MAXF,
+        bestVec);
+    Value isBest = create.math.eq(bestVec, create.vec.splat(vecType, best));
+    Value arg = create.vec.reduction(vector::CombiningKind::MINSI,
+        create.math.select(isBest, simdLoop.getResult(1),
+            create.vec.splat(indexVecType, iMax)));
+    Value tailBetter = isBetter(create.math, tailLoop.getResult(0), best);
+    arg = create.math.select(tailBetter, tailLoop.getResult(1), arg);
+    // As in the scalar lowering, a NaN first value is never replaced.
+    SmallVector<Value, 4> firstIndices(
+        outerIndices.begin(), outerIndices.end());
+    firstIndices.emplace_back(zero);
+    Value first = create.krnl.load(input, firstIndices);
+    arg = create.math.select(create.math.eq(first, first), arg, iZero);
+    rowFn(create.krnl, outerIndices, create.math.castToIndex(arg));
+  };
+
+  // Each row is computed inside a krnl.region when in parallel, so that its
+  // Krnl ops get their own affine scope.
+  int64_t outerRank = rank - 1;
+  SmallVector<Value, 4> lbs(outerRank, zero), ubs, steps(outerRank, one);
+  for (int64_t d = 0; d < outerRank; ++d)
+    ubs.emplace_back(create.math.constantIndex(shape[d]));
+  if (outerRank == 0) {
+    emitRow(create.krnl, {});
+  } else if (enableParallel && inputType.getNumElements() > N) {
+    create.scf.parallelLoop(lbs, ubs, steps,
+        [&](SCFBuilder &createSCF, ValueRange outerIndices) {
+          OpBuilder &builder = createSCF.getBuilder();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          KrnlBuilder createKrnl(builder, loc);
+          emitRow(createKrnl, outerIndices);
+        });
+  } else {
+    ValueRange loopDef = create.krnl.defineLoops(outerRank);
+    create.krnl.iterate(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &createKrnl, ValueRange outerIndices) {
+          emitRow(createKrnl, outerIndices);
+        });
+  }
+  return true;
+}
+
 /// This function returns a scalar of type 'dtype' from an optional value.
 /// Optional value must be: NoneType, memref<1xdtype> or memref<dtype>.
 /// Default value is used in case of NoneType.
@@ -442,6 +911,47 @@ Value getOptionalScalarValue(ConversionPatternRewriter &rewriter, Location loc,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Support functions for quantization.
+//===----------------------------------------------------------------------===//
+
+Value loadQuantizationParameter(ConversionPatternRewriter &rewriter,
+    Location loc, Value param, ValueRange loopIndices, int64_t axis,
+    Type elementType) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+  if (isFromNone(param))
+    return create.math.constant(elementType, 0);
+  ArrayRef<int64_t> shape = param.getType().cast<MemRefType>().getShape();
+  assert(shape.size() <= 1 && "expected a scalar or 1-D parameter");
+  Value val;
+  if (shape.empty())
+    val = create.krnl.load(param, {});
+  else if (shape[0] == 1)
+    val = create.krnl.load(param, {create.math.constantIndex(0)});
+  else
+    val = create.krnl.load(param, {loopIndices[axis]});
+  return create.math.cast(elementType, val);
+}
+
+Value emitQuantizeLinearScalar(ConversionPatternRewriter &rewriter,
+    Location loc, Operation *op, Value x, Value scale, Value zeroPoint,
+    Type quantizedType) {
+  MultiDialectBuilder<MathBuilder> create(rewriter, loc);
+  Type floatType = x.getType();
+  Value y = create.math.div(x, scale);
+  y = emitScalarOpFor<ONNXRoundOp>(rewriter, loc, op, floatType, {y});
+  y = create.math.add(y, zeroPoint);
+  // Saturate to the range of the quantized type.
+  unsigned width = quantizedType.getIntOrFloatBitWidth();
+  bool isUnsigned = quantizedType.isUnsignedInteger();
+  assert(width < 64 && "expected a quantized type narrower than 64 bits");
+  double qMin = isUnsigned ? 0 : -(1LL << (width - 1));
+  double qMax = isUnsigned ? (1LL << width) - 1 : (1LL << (width - 1)) - 1;
+  y = create.math.max(y, create.math.constant(floatType, qMin));
+  y = create.math.min(y, create.math.constant(floatType, qMax));
+  return create.math.cast(quantizedType, y);
+}
+
 //===----------------------------------------------------------------------===//
 // Support functions for help with custom layout.
 //===----------------------------------------------------------------------===//
@@ -90,6 +90,24 @@ bool hasAllScalarValues(mlir::ValueRange values);
 /// integer constants.
 bool indicesAreNonNegativeConstants(mlir::Value indices);
 
+/// Check if the stores of an output of the given type should bypass the caches,
+/// namely when it has a static shape larger than the last level cache, so that
+/// its lines would be evicted before being read again.
+bool useNontemporalStores(mlir::MemRefType outputType);
+
+/// Check if a memref of the given type holds a shape, namely if it is a small
+/// static array of integers. The elements of such outputs are stored one by
+/// one as scalars, so that the shape helpers of their users read the scalars
+/// instead of loading them, see IndexExprBuilderForKrnl::getVal.
+bool isShapeLikeMemRef(mlir::MemRefType type);
+
+/// Return the buffer of the operand of op at operandIndex, whose lowered value
+/// is `operand`, when the output of op of the given type can be written in
+/// place into it, namely when it is an alloc of that type in the block of op
+/// and op is the only user of the operand. Return nullptr otherwise.
+mlir::Value getInPlaceOperandBuffer(mlir::Operation *op,
+    unsigned operandIndex, mlir::Value operand, mlir::MemRefType outputType);
+
 // Create a mapping from result type's dimensions to input type's dimensions,
 // given that the result type is the result of a reduction op over the input
 // type.
@@ -118,6 +136,11 @@ mlir::Value getDimOrConstant(mlir::ConversionPatternRewriter &rewriter,
 // Fold and emit support.
 //===----------------------------------------------------------------------===//
 
+/// Returns the DenseElementsAttr of value if it's a krnl.global constant or
+/// onnx.Constant, or if it's one step removed from a krnl/onnx constant by a
+/// builtin.unrealized_conversion_cast. Otherwise returns a nullptr attribute.
+mlir::DenseElementsAttr getDenseElementAttrFromConstValue(mlir::Value value);
+
 /// Emit an ONNXSqueezeOp. If the input is constant, do const propagation, and
 /// return a constant.
 mlir::Value foldOrEmitONNXSqueezeV11Op(
@@ -156,6 +179,112 @@ mlir::Value emitArgSort(mlir::ConversionPatternRewriter &rewriter,
     mlir::Location loc, mlir::Value input, int64_t axis,
     bool ascending = false);
 
+/// Emit a krnl.call to compute the indices of the first k values in the
+/// sorting order of a given MemRef along its innermost axis, sorted. Output
+/// MemRef has the shape of the input MemRef with k along the axis, and is of
+/// IndexType.
+mlir::Value emitArgTopK(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value input, int64_t axis, int64_t k,
+    bool ascending = false);
+
+/// Emit a krnl.call to fill a given float or double MemRef with random values
+/// drawn from the uniform distribution over [low, high). In the absence of a
+/// seed, one is drawn at compile time as done for RandomNormal.
+void emitRandomUniform(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value alloc, double low, double high,
+    llvm::Optional<llvm::APFloat> seed);
+
+/// Emit a krnl.call counting the nonzero values of a given MemRef by blocks
+/// processed in parallel. Return the offsets of the blocks in the output of
+/// the nonzero values, to pass to the krnl.call writing it, and set 'count'
+/// to the number of nonzero values, as an index.
+mlir::Value emitNonZeroCount(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value input, mlir::Value &count);
+
+//===----------------------------------------------------------------------===//
+// Support for bulk copies of contiguous runs of elements.
+//===----------------------------------------------------------------------===//
+
+/// Check if the copy of a box of the given sizes, from src at srcStarts into
+/// dest at destStarts, is made of contiguous runs of enough elements in both
+/// memrefs to be copied one run at a time by emitBulkCopy. The runs span the
+/// innermost dims of the box that are whole static dims of src and dest.
+bool canEmitBulkCopy(mlir::Value src, llvm::ArrayRef<IndexExpr> srcStarts,
+    mlir::Value dest, llvm::ArrayRef<IndexExpr> destStarts,
+    llvm::ArrayRef<IndexExpr> sizes);
+
+/// Emit the copy of a box of the given sizes, from src at srcStarts into dest
+/// at destStarts, with one krnl.memcpy per contiguous run of elements. The
+/// copy must satisfy canEmitBulkCopy.
+void emitBulkCopy(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value src, llvm::ArrayRef<IndexExpr> srcStarts,
+    mlir::Value dest, llvm::ArrayRef<IndexExpr> destStarts,
+    llvm::ArrayRef<IndexExpr> sizes);
+
+//===----------------------------------------------------------------------===//
+// Support for views of byte buffers.
+//===----------------------------------------------------------------------===//
+
+/// Return the 1-D byte buffer holding the static memref `val`, and set
+/// byteOffset to the offset of `val` in it, so that other memrefs can alias
+/// its memory with views of the buffer. A view of a byte buffer at a constant
+/// offset is looked through, and an alloc in the block of `op` is replaced by
+/// a view of a new byte buffer. Return nullptr for any other value.
+mlir::Value getOrCreateByteBuffer(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Operation *op, mlir::Value val, int64_t &byteOffset);
+
+//===----------------------------------------------------------------------===//
+// Support for SIMD kernels along the innermost dimension.
+//===----------------------------------------------------------------------===//
+
+/// Emit a loop over the indices [0, ub) of the innermost dimension of the
+/// memrefs accessed by `bodyFn`. The indices are first iterated by blocks of VL
+/// consecutive ones, then one by one for the remaining ones. `bodyFn` is called
+/// with the type of the values processed by one iteration, namely
+/// vector<VLxelementType> for the blocks and elementType for the others, and
+/// with the first index of the iteration.
+void emitSimdLoopWithScalarTail(KrnlBuilder &createKrnl, IndexExpr ub,
+    int64_t VL, mlir::Type elementType,
+    mlir::function_ref<void(
+        KrnlBuilder &createKrnl, mlir::Type type, mlir::Value index)>
+        bodyFn);
+
+/// Emit a loop over the indices [0, ub) of the innermost dimension of the
+/// memrefs accessed by `bodyFn`, by blocks of VL consecutive indices. The last
+/// block, when partial, is computed with the mask of its valid lanes, so that
+/// the memrefs need no padding and short rows keep full vectors. `bodyFn` is
+/// called with the first index of each block and with the mask of its lanes,
+/// null for the full blocks.
+void emitSimdLoopWithMaskedTail(KrnlBuilder &createKrnl, IndexExpr ub,
+    int64_t VL,
+    mlir::function_ref<void(
+        KrnlBuilder &createKrnl, mlir::Value index, mlir::Value mask)>
+        bodyFn);
+
+/// Load a value of the given type, scalar or vector, at the given indices.
+/// With a mask, only the lanes set in the mask are loaded, the others being
+/// taken from `passThru`, a scalar splat into them.
+mlir::Value loadScalarOrVector(KrnlBuilder &createKrnl, mlir::Type type,
+    mlir::Value memref, mlir::ValueRange indices, mlir::Value mask = nullptr,
+    mlir::Value passThru = nullptr);
+
+/// Store a scalar or vector value at the given indices. With a mask, only the
+/// lanes set in the mask are stored.
+void storeScalarOrVector(KrnlBuilder &createKrnl, mlir::Value val,
+    mlir::Value memref, mlir::ValueRange indices, mlir::Value mask = nullptr);
+
+/// Emit SIMD code computing the index of the first maximum value, or minimum
+/// value when `isMin`, of each row along the innermost dimension of the static
+/// f32 memref `input`, and return false when the input is not amenable to it.
+/// `rowFn` is called with the indices of each row in the outer dimensions and
+/// with the index of its maximum or minimum value. The rows are computed in
+/// parallel when `enableParallel`.
+bool emitSimdArgMinMax(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value input, bool isMin, bool enableParallel,
+    mlir::function_ref<void(KrnlBuilder &createKrnl,
+        mlir::ValueRange outerIndices, mlir::Value argIndex)>
+        rowFn);
+
 //===----------------------------------------------------------------------===//
 // This is to get a scalar operation of a given type for a specific operation.
 //===----------------------------------------------------------------------===//
@@ -227,6 +356,13 @@ mlir::Value emitScalarOpFor(mlir::ConversionPatternRewriter &rewriter,
   }
 }
 
+// Round half to even, also used by the lowering of quantization ops.
+template <>
+mlir::Value emitScalarOpFor<mlir::ONNXRoundOp>(
+    mlir::ConversionPatternRewriter &rewriter, mlir::Location loc,
+    mlir::Operation *op, mlir::Type elementType,
+    llvm::ArrayRef<mlir::Value> scalarOperands);
+
 //===----------------------------------------------------------------------===//
 // Type conversion from Onnx types to Krnl types:
 //   - from Tensor type to the Standard dialect MemRef type
@@ -264,6 +400,9 @@ public:
 // Functions to add lowering patterns for frontend operations.
 //===----------------------------------------------------------------------===//
 
+// Tuned tile sizes of MatMul and Gemm ops, see MatMulTiles.hpp.
+class MatMulTileDB;
+
 // For all ONNX operations.
 void populateONNXToKrnlConversionPattern(mlir::RewritePatternSet &,
     mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling);
@@ -271,60 +410,93 @@ void populateONNXToKrnlConversionPattern(mlir::RewritePatternSet &,
 // `ControlFlow` directory methods:
 void populateLoweringONNXIfOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXLoopOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXScanOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXLoopOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableStreamingLoops,
+    bool enableParallel);
+void populateLoweringONNXScanOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableStreamingLoops,
+    bool enableParallel);
 
 // `Math` directory methods:
+void populateLoweringONNXToBLASPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, int64_t blasThreshold,
+    const MatMulTileDB *tileDB);
+void populateLoweringONNXBernoulliOpPattern(
+    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXClipOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXCumSumOpPattern(
+void populateLoweringONNXCumSumOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
+void populateLoweringONNXDFTOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXElementwiseOpPattern(mlir::RewritePatternSet &,
-    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD);
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel, int64_t parallelThreshold, bool enableFusion);
 void populateLoweringONNXGemmOpPattern(mlir::RewritePatternSet &,
-    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling);
-void populateLoweringONNXHardmaxOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXLRNOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling,
+    bool enableParallel, const MatMulTileDB *tileDB,
+    int64_t sparseWeightThreshold);
+void populateLoweringONNXHardmaxOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
+void populateLoweringONNXLRNOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD);
 void populateLoweringONNXMatMulOpPattern(mlir::RewritePatternSet &,
-    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling);
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling,
+    bool enableParallel, const MatMulTileDB *tileDB,
+    int64_t sparseWeightThreshold);
 void populateLoweringONNXRandomNormalOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXRandomNormalLikeOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXReductionOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXSoftmaxOpPattern(
+void populateLoweringONNXRandomUniformOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXReductionOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
+void populateLoweringONNXSoftmaxOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD);
 void populateLoweringONNXTopKOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 
 // `ML` directory methods:
-void populateLoweringONNXCategoryMapperOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXCategoryMapperOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
 
 // `NN` directory methods:
 void populateLoweringONNXConvOpPattern(mlir::RewritePatternSet &,
-    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling);
-void populateLoweringONNXNormalizationOpPattern(
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling,
+    bool enableParallel, int64_t convWinogradThreshold);
+void populateLoweringONNXConvTransposeOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableTiling,
+    bool enableParallel);
+void populateLoweringONNXNormalizationOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
+void populateLoweringONNXPoolingOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
+
+// `Quantization` directory methods:
+void populateLoweringONNXDequantizeLinearOpPattern(
+    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXDynamicQuantizeLinearOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXPoolingOpPattern(
+void populateLoweringONNXQuantizeLinearOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 
 // `ObjectDetection` directory methods:
-void populateLoweringONNXNonMaxSuppressionOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXNonMaxSuppressionOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
 
 // `RNN` directory methods:
-void populateLoweringONNXGRUOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXLSTMOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXRNNOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXGRUOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
+void populateLoweringONNXLSTMOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
+void populateLoweringONNXRNNOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
 
 // `Sequence` directory methods:
 void populateLoweringONNXSequenceAtOpPattern(
@@ -339,18 +511,19 @@ void populateLoweringONNXSequenceLengthOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 
 // `Tensor` directory methods:
-void populateLoweringONNXArgMinMaxOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXArgMinMaxOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD,
+    bool enableParallel);
 void populateLoweringONNXDimOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXUnsqueezeOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXUnsqueezeV11OpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXTransposeOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXGatherOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXTransposeOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD);
+void populateLoweringONNXGatherOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
 void populateLoweringONNXGatherElementsOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXGatherNDOpPattern(
@@ -401,15 +574,17 @@ void populateLoweringONNXFlattenOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXResizeOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXNonZeroOpPattern(
-    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXNonZeroOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
 void populateLoweringONNXReverseSequenceOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXExpandOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXOneHotOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
-void populateLoweringONNXCompressOpPattern(
+void populateLoweringONNXCompressOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableParallel);
+void populateLoweringONNXUniqueOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXPrintSignaturePattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
@@ -417,6 +592,12 @@ void populateLoweringONNXLayoutTransformOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 
 // `Additional` directory methods:
+void populateLoweringONNXFusedAttentionOpPattern(mlir::RewritePatternSet &,
+    mlir::TypeConverter &, mlir::MLIRContext *, bool enableSIMD);
+void populateLoweringONNXMemoOpPattern(
+    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
+void populateLoweringONNXPagedKVCacheWriteOpPattern(
+    mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 void populateLoweringONNXShapeTransformOpPattern(
     mlir::RewritePatternSet &, mlir::TypeConverter &, mlir::MLIRContext *);
 
@@ -452,6 +633,25 @@ mlir::Value getOptionalScalarValue(mlir::ConversionPatternRewriter &rewriter,
     mlir::Location loc, mlir::Value optionalScalar, mlir::Type elementType,
     double defaultValue);
 
+//===----------------------------------------------------------------------===//
+// Support functions for quantization.
+//===----------------------------------------------------------------------===//
+
+/// Load the scale or zero point of a per-tensor or per-axis quantization and
+/// convert it to elementType. The parameter is a scalar, a 1-element tensor,
+/// or a 1-D tensor indexed by the loop index along axis. A none zero point is
+/// 0.
+mlir::Value loadQuantizationParameter(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value param, mlir::ValueRange loopIndices,
+    int64_t axis, mlir::Type elementType);
+
+/// Emit saturate(round(x / scale) + zeroPoint), rounding half to even and
+/// saturating to the range of the integer quantizedType. The scale and the
+/// zero point are floats of the type of x.
+mlir::Value emitQuantizeLinearScalar(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Operation *op, mlir::Value x, mlir::Value scale,
+    mlir::Value zeroPoint, mlir::Type quantizedType);
+
 //===----------------------------------------------------------------------===//
 // Support functions for help with custom layout.
 //===----------------------------------------------------------------------===//
@@ -20,6 +20,33 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum static number of boxes for which the boxes are selected with the
+// optimized algorithm of emitOptimizedSelection.
+static constexpr int64_t kNMSOptimizedMinBoxes = 64;
+
+/// Compute the IOU score between two boxes given as
+/// [y_min, x_min, y_max, x_max, area].
+static Value emitIOUOfCorners(
+    MathBuilder &createMath, ArrayRef<Value> box1, ArrayRef<Value> box2) {
+  Value intersection_x_min = createMath.max(box1[1], box2[1]);
+  Value intersection_y_min = createMath.max(box1[0], box2[0]);
+  Value intersection_x_max = createMath.min(box1[3], box2[3]);
+  Value intersection_y_max = createMath.min(box1[2], box2[2]);
+
+  Value zero = createMath.constant(intersection_x_min.getType(), 0);
+  Value intersection_w = createMath.sub(intersection_x_max, intersection_x_min);
+  Value intersection_h = createMath.sub(intersection_y_max, intersection_y_min);
+  Value intersection_area = createMath.mul(createMath.max(intersection_w, zero),
+      createMath.max(intersection_h, zero));
+
+  Value union_area = createMath.add(box1[4], box2[4]);
+  union_area = createMath.sub(union_area, intersection_area);
+  // Avoid zero division.
+  Value epsilon = createMath.constant(zero.getType(), 1e-8);
+  union_area = createMath.add(union_area, epsilon);
+  return createMath.div(intersection_area, union_area);
+}
+
 /// Compute the intersection-over-union (IOU) score between two boxes.
 /// IOU tells us how much two boxes are overlapped.
 static Value emitIOU(MathBuilder &createMath, SmallVectorImpl<Value> &box1,
@@ -72,23 +99,8 @@ static Value emitIOU(MathBuilder &createMath, SmallVectorImpl<Value> &box1,
     area2 = createMath.mul(h2, w2);
   }
 
-  Value intersection_x_min = createMath.max(x1_min, x2_min);
-  Value intersection_y_min = createMath.max(y1_min, y2_min);
-  Value intersection_x_max = createMath.min(x1_max, x2_max);
-  Value intersection_y_max = createMath.min(y1_max, y2_max);
-
-  Value zero = createMath.constant(intersection_x_min.getType(), 0);
-  Value intersection_w = createMath.sub(intersection_x_max, intersection_x_min);
-  Value intersection_h = createMath.sub(intersection_y_max, intersection_y_min);
-  Value intersection_area = createMath.mul(createMath.max(intersection_w, zero),
-      createMath.max(intersection_h, zero));
-
-  Value union_area = createMath.add(area1, area2);
-  union_area = createMath.sub(union_area, intersection_area);
-  // Avoid zero division.
-  Value epsilon = createMath.constant(zero.getType(), 1e-8);
-  union_area = createMath.add(union_area, epsilon);
-  return createMath.div(intersection_area, union_area);
+  return emitIOUOfCorners(createMath, {y1_min, x1_min, y1_max, x1_max, area1},
+      {y2_min, x2_min, y2_max, x2_max, area2});
 }
 
 /// Suppress the number of output bounding boxes per class by scores.
@@ -203,11 +215,275 @@ static Value tryToUnflip(
   return resMemRef;
 }
 
+/// Convert the bounding boxes [num_of_batch, spatial_dimension, 4] into a
+/// structure of arrays [num_of_batch, 5, spatial_dimension] of their y_min,
+/// x_min, y_max, x_max and area, so that they are not converted again for
+/// each pair of boxes whose IOU score is computed.
+static Value emitBoxCorners(ConversionPatternRewriter &rewriter, Location loc,
+    Value boundingBoxes, int64_t centerPointBox) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+      create(rewriter, loc);
+  SmallVector<IndexExpr, 4> ubs;
+  create.krnlIE.getShapeAsDims(boundingBoxes, ubs);
+  IndexExpr bs = ubs[0]; // batch size.
+  IndexExpr ss = ubs[1]; // spatial size.
+  LiteralIndexExpr zeroIE(0);
+
+  MemRefType boxesType = boundingBoxes.getType().cast<MemRefType>();
+  ArrayRef<int64_t> boxesShape = boxesType.getShape();
+  SmallVector<IndexExpr, 3> dims = {bs, LiteralIndexExpr(5), ss};
+  Value corners = create.mem.alignedAlloc(
+      MemRefType::get({boxesShape[0], 5, boxesShape[1]},
+          boxesType.getElementType()),
+      dims);
+
+  ValueRange loopDef = create.krnl.defineLoops(2);
+  create.krnl.iterateIE(loopDef, loopDef, {zeroIE, zeroIE}, {bs, ss},
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        DimIndexExpr b(loopInd[0]), s(loopInd[1]);
+        // Load a bounding box.
+        SmallVector<Value, 4> box;
+        for (int64_t i = 0; i < 4; ++i)
+          box.emplace_back(
+              createKrnl.loadIE(boundingBoxes, {b, s, LiteralIndexExpr(i)}));
+
+        SmallVector<Value, 5> corner;
+        if (centerPointBox == 0) {
+          // The box data is supplied as [y1, x1, y2, x2], already unflipped.
+          corner.assign(box.begin(), box.end());
+          corner.emplace_back(createMath.mul(
+              createMath.sub(box[2], box[0]), createMath.sub(box[3], box[1])));
+        } else {
+          // The box data is supplied as [x_center, y_center, width, height].
+          Value two = createMath.constant(box[2].getType(), 2);
+          Value halfW = createMath.div(box[2], two);
+          Value halfH = createMath.div(box[3], two);
+          corner.emplace_back(createMath.sub(box[1], halfH));
+          corner.emplace_back(createMath.sub(box[0], halfW));
+          corner.emplace_back(createMath.add(box[1], halfH));
+          corner.emplace_back(createMath.add(box[0], halfW));
+          corner.emplace_back(createMath.mul(box[3], box[2]));
+        }
+        for (int64_t i = 0; i < 5; ++i)
+          createKrnl.storeIE(corner[i], corners, {b, LiteralIndexExpr(i), s});
+      });
+  return corners;
+}
+
+/// Remove the candidates of positions [lb, ub) in the descending order of
+/// scores that are overlapped too much with the selected box, using IOU.
+static void emitRemoveCandidates(OpBuilder &builder, Location loc,
+    Value corners, Value order, Value removed, Value b, Value c,
+    ArrayRef<Value> selectedBox, Value lb, Value ub, Value iouTH) {
+  Value one = MathBuilder(builder, loc).constantIndex(1);
+  builder.create<scf::ForOp>(loc, lb, ub, one, ValueRange{},
+      [&](OpBuilder &forBuilder, Location forLoc, Value q, ValueRange) {
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+            forBuilder, forLoc);
+        // Pick the current box.
+        Value otherBI = create.krnl.load(order, {b, c, q});
+        SmallVector<Value, 5> otherBox;
+        for (int64_t i = 0; i < 5; ++i) {
+          Value iVal = create.math.constantIndex(i);
+          otherBox.emplace_back(create.krnl.load(corners, {b, iVal, otherBI}));
+        }
+        // Mark the current box as removed if IOU >= iou_threshold.
+        Value iou = emitIOUOfCorners(create.math, selectedBox, otherBox);
+        Value isRemoved = create.krnl.load(removed, {q});
+        Value checkIOU = create.math.sge(iou, iouTH);
+        create.krnl.store(create.math.ori(isRemoved, checkIOU), removed, {q});
+        forBuilder.create<scf::YieldOp>(forLoc);
+      });
+}
+
+/// Select the bounding boxes of all classes, and return the selected indices
+/// [num_selected_indices, 3].
+///
+/// Compared to the generic algorithm, the candidates of a class are only the
+/// boxes whose score is greater than the threshold, namely the first ones in
+/// the descending order of scores. A selected candidate only removes the
+/// candidates following it, and their IOU scores are computed from the
+/// precomputed corners and areas of the boxes. Each class writes its own
+/// selected boxes, so that the classes are run in parallel when enabled. The
+/// selected boxes are then gathered in the order of the batches and classes.
+static Value emitOptimizedSelection(ConversionPatternRewriter &rewriter,
+    Location loc, Value boxes, Value scores, Value order, Value scoreTH,
+    Value iouTH, Value MOPC, int64_t centerPointBox, Type elementType,
+    bool enableParallel) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+      MemRefBuilder, SCFBuilder>
+      create(rewriter, loc);
+  Type indexType = rewriter.getIndexType();
+  Type boolType = rewriter.getI1Type();
+
+  // scores: [num_of_batch, num_of_class, spatial_dimension]
+  ArrayRef<int64_t> scoresShape =
+      scores.getType().cast<MemRefType>().getShape();
+  IndexExpr bsIE = create.krnlIE.getShapeAsDim(scores, 0); // batch size.
+  IndexExpr csIE = create.krnlIE.getShapeAsDim(scores, 1); // class size.
+  IndexExpr ssIE = create.krnlIE.getShapeAsDim(scores, 2); // spatial size.
+  Value bs = bsIE.getValue();
+  Value cs = csIE.getValue();
+  Value ss = ssIE.getValue();
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  Value two = create.math.constantIndex(2);
+  Value falseVal = create.math.constant(boolType, 0);
+
+  Value corners = emitBoxCorners(rewriter, loc, boxes, centerPointBox);
+
+  // Indices of the selected boxes of each class, and their number.
+  SmallVector<IndexExpr, 2> countDims = {bsIE, csIE};
+  Value numSelected = create.mem.alignedAlloc(
+      MemRefType::get({scoresShape[0], scoresShape[1]}, indexType), countDims);
+  SmallVector<IndexExpr, 3> selectedDims = {bsIE, csIE, DimIndexExpr(MOPC)};
+  Value selected = create.mem.alignedAlloc(
+      MemRefType::get(
+          {scoresShape[0], scoresShape[1], ShapedType::kDynamic}, indexType),
+      selectedDims);
+
+  auto emitClass = [&](OpBuilder &builder, Value b, Value c) {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder> create(
+        builder, loc);
+    // Number of candidates, the scores greater than the threshold.
+    Value numCandidates =
+        builder
+            .create<scf::ForOp>(loc, zero, ss, one, ValueRange{zero},
+                [&](OpBuilder &forBuilder, Location forLoc, Value s,
+                    ValueRange args) {
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      forBuilder, forLoc);
+                  Value score = create.krnl.load(scores, {b, c, s});
+                  Value gt = create.math.sgt(score, scoreTH);
+                  Value next =
+                      create.math.select(gt, create.math.add(args[0], one),
+                          args[0]);
+                  forBuilder.create<scf::YieldOp>(forLoc, next);
+                })
+            .getResult(0);
+
+    // Removed candidates, by position in the descending order of scores.
+    Value removed = create.mem.alignedAlloc(
+        MemRefType::get({scoresShape[2]}, boolType));
+    create.krnl.memset(removed, falseVal);
+
+    // Iterate over the candidates in the descending order of scores.
+    Value count =
+        builder
+            .create<scf::ForOp>(loc, zero, numCandidates, one,
+                ValueRange{zero},
+                [&](OpBuilder &forBuilder, Location forLoc, Value p,
+                    ValueRange args) {
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      forBuilder, forLoc);
+                  Value currentMOPC = args[0];
+                  // Select the candidate if there are not yet enough outputs
+                  // and it has not yet been removed.
+                  Value isRemoved = create.krnl.load(removed, {p});
+                  Value canSelectBox =
+                      create.math.andi(create.math.slt(currentMOPC, MOPC),
+                          create.math.eq(isRemoved, falseVal));
+                  auto ifOp = forBuilder.create<scf::IfOp>(forLoc,
+                      TypeRange{indexType}, canSelectBox,
+                      [&](OpBuilder &thenBuilder, Location thenLoc) {
+                        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                            thenBuilder, thenLoc);
+                        Value selectedBI = create.krnl.load(order, {b, c, p});
+                        create.krnl.store(
+                            selectedBI, selected, {b, c, currentMOPC});
+                        SmallVector<Value, 5> selectedBox;
+                        for (int64_t i = 0; i < 5; ++i) {
+                          Value iVal = create.math.constantIndex(i);
+                          selectedBox.emplace_back(
+                              create.krnl.load(corners, {b, iVal, selectedBI}));
+                        }
+                        // Remove the following candidates overlapped too much
+                        // with the selected box, using IOU.
+                        emitRemoveCandidates(thenBuilder, thenLoc, corners,
+                            order, removed, b, c, selectedBox,
+                            create.math.add(p, one), numCandidates, iouTH);
+                        thenBuilder.create<scf::YieldOp>(
+                            thenLoc, create.math.add(currentMOPC, one));
+                      },
+                      [&](OpBuilder &elseBuilder, Location elseLoc) {
+                        elseBuilder.create<scf::YieldOp>(elseLoc, currentMOPC);
+                      });
+                  forBuilder.create<scf::YieldOp>(forLoc, ifOp.getResult(0));
+                })
+            .getResult(0);
+    create.krnl.store(count, numSelected, {b, c});
+  };
+
+  if (enableParallel) {
+    create.scf.parallelLoop({zero, zero}, {bs, cs}, {one, one},
+        [&](SCFBuilder &createSCF, ValueRange bcInd) {
+          emitClass(createSCF.getBuilder(), bcInd[0], bcInd[1]);
+        });
+  } else {
+    ValueRange bcLoopDef = create.krnl.defineLoops(2);
+    create.krnl.iterate(bcLoopDef, bcLoopDef, {zero, zero}, {bs, cs},
+        [&](KrnlBuilder &createKrnl, ValueRange bcLoopInd) {
+          emitClass(createKrnl.getBuilder(), bcLoopInd[0], bcLoopInd[1]);
+        });
+  }
+
+  // Total number of selected indices.
+  Value numSelectedIndices = create.mem.alloca(MemRefType::get({}, indexType));
+  create.krnl.store(zero, numSelectedIndices, {});
+  ValueRange sumLoopDef = create.krnl.defineLoops(2);
+  create.krnl.iterate(sumLoopDef, sumLoopDef, {zero, zero}, {bs, cs},
+      [&](KrnlBuilder &createKrnl, ValueRange bcLoopInd) {
+        MathBuilder createMath(createKrnl);
+        Value total = createKrnl.load(numSelectedIndices, {});
+        Value n = createKrnl.load(numSelected, bcLoopInd);
+        createKrnl.store(createMath.add(total, n), numSelectedIndices, {});
+      });
+
+  // Insert allocation and deallocation for the final output.
+  Value effectiveNSI = create.krnl.load(numSelectedIndices, {});
+  SmallVector<IndexExpr, 2> resDims = {
+      DimIndexExpr(effectiveNSI), LiteralIndexExpr(3)};
+  Value resMemRef = create.mem.alignedAlloc(
+      MemRefType::get({ShapedType::kDynamic, 3}, elementType), resDims);
+
+  // Gather the selected indices [b, c, selected_box_index] of the classes.
+  create.krnl.store(zero, numSelectedIndices, {});
+  ValueRange resLoopDef = create.krnl.defineLoops(2);
+  create.krnl.iterate(resLoopDef, resLoopDef, {zero, zero}, {bs, cs},
+      [&](KrnlBuilder &createKrnl, ValueRange bcLoopInd) {
+        MathBuilder createMath(createKrnl);
+        Value b(bcLoopInd[0]), c(bcLoopInd[1]);
+        Value offset = createKrnl.load(numSelectedIndices, {});
+        Value n = createKrnl.load(numSelected, bcLoopInd);
+        Value bVal = createMath.cast(elementType, b);
+        Value cVal = createMath.cast(elementType, c);
+        createKrnl.getBuilder().create<scf::ForOp>(loc, zero, n, one,
+            ValueRange{},
+            [&](OpBuilder &forBuilder, Location forLoc, Value k, ValueRange) {
+              MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                  forBuilder, forLoc);
+              Value soVal = create.math.add(offset, k);
+              Value selectedBI = create.krnl.load(selected, {b, c, k});
+              create.krnl.store(bVal, resMemRef, {soVal, zero});
+              create.krnl.store(cVal, resMemRef, {soVal, one});
+              create.krnl.store(create.math.cast(elementType, selectedBI),
+                  resMemRef, {soVal, two});
+              forBuilder.create<scf::YieldOp>(forLoc);
+            });
+        createKrnl.store(createMath.add(offset, n), numSelectedIndices, {});
+      });
+  return resMemRef;
+}
+
 struct ONNXNonMaxSuppressionOpLowering
     : public OpConversionPattern<ONNXNonMaxSuppressionOp> {
   ONNXNonMaxSuppressionOpLowering(
-      TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableParallel(enableParallel) {}
+
+  bool enableParallel;
 
   /// To understand how code is generated for NonMaxSuppression, look at the
   /// python implementation at the end of this file.
@@ -289,6 +565,15 @@ struct ONNXNonMaxSuppressionOpLowering
     if (centerPointBox == 0)
       boxes = tryToUnflip(rewriter, loc, boxes);
 
+    // With many boxes, select them with the optimized algorithm.
+    if (ssIE.isLiteral() && ssIE.getLiteral() >= kNMSOptimizedMinBoxes) {
+      Value resMemRef = emitOptimizedSelection(rewriter, loc, boxes, scores,
+          order, scoreTH, iouTH, MOPC, centerPointBox, elementType,
+          enableParallel);
+      rewriter.replaceOp(op, resMemRef);
+      return success();
+    }
+
     // The total number of output selected indices.
     IndexExpr numSelectedIndicesIE = bsIE * csIE * DimIndexExpr(MOPC);
 
@@ -461,8 +746,9 @@ struct ONNXNonMaxSuppressionOpLowering
 };
 
 void populateLoweringONNXNonMaxSuppressionOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXNonMaxSuppressionOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
+  patterns.insert<ONNXNonMaxSuppressionOpLowering>(
+      typeConverter, ctx, enableParallel);
 }
 
 // clang-format off
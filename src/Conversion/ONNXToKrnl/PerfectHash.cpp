@@ -4,7 +4,7 @@
 
 //====--------------- PerfectHash.cpp - Perfect Hash Table ----------------===//
 //
-// Copyright 2021 The IBM Research Authors.
+// Copyright 2021-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -16,6 +16,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <map>
@@ -29,21 +30,46 @@ namespace onnx_mlir {
 
 class Utilities {
 public:
-  // Perform a 32-bit FNV (Fowler-Noll-Vo) hash on the given string.
-  static inline uint32_t hash(uint32_t hval, llvm::StringRef str) {
-    constexpr uint32_t prime = 0x01000193;
-    hval = (hval == 0) ? prime : hval;
+  // Multipliers of the 64-bit xxHash.
+  static constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+
+  // Mix one word into the hash state, as a round of the 64-bit xxHash.
+  static inline uint64_t round(uint64_t acc, uint64_t word) {
+    acc ^= word * prime2;
+    return ((acc << 31) | (acc >> 33)) * prime1;
+  }
 
-    for (const char c : str) {
-      hval *= prime;
-      hval ^= c;
+  // Avalanche the hash state into a 32-bit hash.
+  static inline uint32_t finalize(uint64_t acc) {
+    acc = (acc ^ (acc >> 33)) * prime2;
+    acc = (acc ^ (acc >> 29)) * prime3;
+    return static_cast<uint32_t>(acc ^ (acc >> 32));
+  }
+
+  // Hash the given string 8 bytes at a time, read as little-endian words.
+  // Must be kept in sync with the hash of the runtime, in OMIndexLookup.inc.
+  static inline uint32_t hash(uint32_t hval, llvm::StringRef str) {
+    uint64_t len = str.size();
+    uint64_t acc = (hval + prime3) ^ (len * prime1);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+      acc = round(acc, llvm::support::endian::read64le(str.data() + i));
+    if (i < len) {
+      uint64_t word = 0;
+      for (size_t j = i; j < len; ++j)
+        word |= static_cast<uint64_t>(static_cast<uint8_t>(str[j]))
+                << (8 * (j - i));
+      acc = round(acc, word);
     }
-    return hval;
+    return finalize(acc);
   }
 
-  // Adaptation of 32-bit FNV for int64_t values.
+  // Hash the given int64_t value, as a string of its 8 bytes.
   static inline uint32_t hash(uint32_t hval, int64_t val) {
-    return hash(hval, std::to_string(val));
+    uint64_t acc = (hval + prime3) ^ (8 * prime1);
+    return finalize(round(acc, static_cast<uint64_t>(val)));
   }
 
   // Extracts the keys of the given map.
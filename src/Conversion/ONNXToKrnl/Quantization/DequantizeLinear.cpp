@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------- DequantizeLinear.cpp - Lowering DequantizeLinear Op --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX DequantizeLinear Operator to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+struct ONNXDequantizeLinearOpLowering
+    : public OpConversionPattern<ONNXDequantizeLinearOp> {
+  ONNXDequantizeLinearOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+
+  LogicalResult matchAndRewrite(ONNXDequantizeLinearOp dqlOp,
+      ONNXDequantizeLinearOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    using LocalDialectBuilder = MultiDialectBuilder<KrnlBuilder,
+        IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>;
+    Operation *op = dqlOp.getOperation();
+    Location loc = ONNXLoc<ONNXDequantizeLinearOp>(op);
+    LocalDialectBuilder create(rewriter, loc);
+
+    ValueRange operands = adaptor.getOperands();
+    Value X = adaptor.getX();
+    Value scale = adaptor.getXScale();
+    Value zeroPoint = adaptor.getXZeroPoint();
+
+    // Convert the output type to MemRefType.
+    Type convertedType =
+        typeConverter->convertType(dqlOp.getResult().getType());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType memRefType = convertedType.cast<MemRefType>();
+    Type floatType = memRefType.getElementType();
+
+    // Get shape.
+    ONNXDequantizeLinearOpShapeHelper shapeHelper(
+        op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Axis of the per-axis quantization, unused when per-tensor.
+    int64_t rank = memRefType.getRank();
+    int64_t axis = adaptor.getAxis();
+    if (axis < 0)
+      axis += rank;
+
+    // Insert an allocation and deallocation for the result of this operation.
+    Value alloc =
+        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+
+    // y = (x - x_zero_point) * x_scale.
+    auto computeResult = [&](LocalDialectBuilder &create, ValueRange loopInd) {
+      Value x = create.math.cast(floatType, create.krnl.load(X, loopInd));
+      Value scaleVal = loadQuantizationParameter(
+          rewriter, loc, scale, loopInd, axis, floatType);
+      Value zeroPointVal = loadQuantizationParameter(
+          rewriter, loc, zeroPoint, loopInd, axis, floatType);
+      Value y = create.math.mul(create.math.sub(x, zeroPointVal), scaleVal);
+      create.krnl.store(y, alloc, loopInd);
+    };
+
+    // Create a loop only if the input is not a scalar tensor.
+    if (rank > 0) {
+      ValueRange loopDef = create.krnl.defineLoops(rank);
+      SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+      create.krnl.iterateIE(loopDef, loopDef, lbs, shapeHelper.getOutputDims(),
+          [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+            LocalDialectBuilder create(createKrnl);
+            computeResult(create, loopInd);
+          });
+    } else {
+      computeResult(create, {});
+    }
+
+    rewriter.replaceOp(op, alloc);
+    return success();
+  }
+};
+
+void populateLoweringONNXDequantizeLinearOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXDequantizeLinearOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,131 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--- DynamicQuantizeLinear.cpp - Lowering DynamicQuantizeLinear Op ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX DynamicQuantizeLinear Operator to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+struct ONNXDynamicQuantizeLinearOpLowering
+    : public OpConversionPattern<ONNXDynamicQuantizeLinearOp> {
+  ONNXDynamicQuantizeLinearOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+
+  LogicalResult matchAndRewrite(ONNXDynamicQuantizeLinearOp dqlOp,
+      ONNXDynamicQuantizeLinearOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    using LocalDialectBuilder = MultiDialectBuilder<KrnlBuilder,
+        IndexExprBuilderForKrnl, MathBuilder, MemRefBuilder>;
+    Operation *op = dqlOp.getOperation();
+    Location loc = ONNXLoc<ONNXDynamicQuantizeLinearOp>(op);
+    LocalDialectBuilder create(rewriter, loc);
+
+    ValueRange operands = adaptor.getOperands();
+    Value X = adaptor.getX();
+
+    // Convert the output types to MemRefType.
+    Type convertedYType = typeConverter->convertType(dqlOp.getY().getType());
+    assert(convertedYType && convertedYType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType yMemRefType = convertedYType.cast<MemRefType>();
+    Type quantizedType = yMemRefType.getElementType();
+    Type floatType = X.getType().cast<MemRefType>().getElementType();
+    MemRefType scaleMemRefType = MemRefType::get({}, floatType);
+    MemRefType zeroPointMemRefType = MemRefType::get({}, quantizedType);
+
+    // Get shape.
+    ONNXDynamicQuantizeLinearOpShapeHelper shapeHelper(
+        op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+    DimsExpr outputDims = shapeHelper.getOutputDims(0);
+    int64_t rank = yMemRefType.getRank();
+
+    // Insert allocations and deallocations for the results of this operation.
+    Value Y = create.mem.alignedAlloc(yMemRefType, outputDims);
+    Value YScale = create.mem.alignedAlloc(scaleMemRefType);
+    Value YZeroPoint = create.mem.alignedAlloc(zeroPointMemRefType);
+
+    // Iterate over all the elements of x, or emit the body once for a scalar.
+    using BodyFn =
+        function_ref<void(LocalDialectBuilder &create, ValueRange loopInd)>;
+    auto iterateOverX = [&](BodyFn bodyFn) {
+      if (rank > 0) {
+        ValueRange loopDef = create.krnl.defineLoops(rank);
+        SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+        create.krnl.iterateIE(loopDef, loopDef, lbs, outputDims,
+            [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+              LocalDialectBuilder create(createKrnl);
+              bodyFn(create, loopInd);
+            });
+      } else {
+        bodyFn(create, {});
+      }
+    };
+
+    // Compute the range of x, adjusted to include 0 by starting from 0.
+    Value zero = create.math.constant(floatType, 0);
+    Value minAlloc = create.mem.alignedAlloca(MemRefType::get({}, floatType));
+    Value maxAlloc = create.mem.alignedAlloca(MemRefType::get({}, floatType));
+    create.krnl.store(zero, minAlloc);
+    create.krnl.store(zero, maxAlloc);
+    iterateOverX([&](LocalDialectBuilder &create, ValueRange loopInd) {
+      Value x = create.krnl.load(X, loopInd);
+      Value minVal = create.math.min(create.krnl.load(minAlloc), x);
+      Value maxVal = create.math.max(create.krnl.load(maxAlloc), x);
+      create.krnl.store(minVal, minAlloc);
+      create.krnl.store(maxVal, maxAlloc);
+    });
+    Value minVal = create.krnl.load(minAlloc);
+    Value maxVal = create.krnl.load(maxAlloc);
+
+    // y_scale = (max(x) - min(x)) / (qmax - qmin).
+    Value qRange = create.math.constant(floatType, 255);
+    Value scale = create.math.div(create.math.sub(maxVal, minVal), qRange);
+    create.krnl.store(scale, YScale);
+    // When x is all zeros, so are y and y_zero_point: divide by 1 instead of
+    // the 0 scale.
+    Value one = create.math.constant(floatType, 1);
+    Value isZeroScale = create.math.eq(scale, zero);
+    Value divisor = create.math.select(isZeroScale, one, scale);
+
+    // y_zero_point = saturate(round(qmin - min(x) / y_scale)).
+    Value zeroPoint = emitQuantizeLinearScalar(rewriter, loc, op,
+        create.math.neg(minVal), divisor, zero, quantizedType);
+    create.krnl.store(zeroPoint, YZeroPoint);
+
+    // y = saturate(round(x / y_scale) + y_zero_point).
+    Value zeroPointVal = create.math.cast(floatType, zeroPoint);
+    iterateOverX([&](LocalDialectBuilder &create, ValueRange loopInd) {
+      Value x = create.krnl.load(X, loopInd);
+      Value y = emitQuantizeLinearScalar(
+          rewriter, loc, op, x, divisor, zeroPointVal, quantizedType);
+      create.krnl.store(y, Y, loopInd);
+    });
+
+    rewriter.replaceOp(op, {Y, YScale, YZeroPoint});
+    return success();
+  }
+};
+
+void populateLoweringONNXDynamicQuantizeLinearOpPattern(
+    RewritePatternSet &patterns, TypeConverter &typeConverter,
+    MLIRContext *ctx) {
+  patterns.insert<ONNXDynamicQuantizeLinearOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
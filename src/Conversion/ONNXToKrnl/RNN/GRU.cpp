@@ -385,11 +385,18 @@ GruState allocAndInitializeStates<ONNXGRUOp, GruState>(
   return state;
 }
 
+template <>
+Value getInputWeightT<GruWeightPack>(GruWeightPack weight) {
+  return weight.WT;
+}
+
 template <>
 void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
-    ConversionPatternRewriter &rewriter, Location loc, Value Xt, GruState state,
+    ConversionPatternRewriter &rewriter, Location loc, Value XtWT,
+    GruState state,
     GruActivationPack activationPack, GruWeightPack weightPack,
-    GruBiasPack biasPack, Value sequenceIV, Value directionIV, bool isForward) {
+    GruBiasPack biasPack, Value sequenceIV, Value directionIV, bool isForward,
+    bool parallelBatch) {
   // Equations (Default: f=Sigmoid, g=Tanh):"
   // zt = f(Xt*(Wz^T) + Ht-1*(Rz^T) + Wbz + Rbz)"
   // rt = f(Xt*(Wr^T) + Ht-1*(Rr^T) + Wbr + Rbr)"
@@ -402,13 +409,11 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
   MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, OnnxBuilder>
       create(rewriter, loc);
 
-  ArrayRef<int64_t> xtShape = Xt.getType().cast<ShapedType>().getShape();
-  int64_t batchSize = xtShape[0];
-
   // Get Ht.
   Value Ht = (isForward) ? state.forwardHt : state.reverseHt;
 
   ArrayRef<int64_t> htShape = Ht.getType().cast<ShapedType>().getShape();
+  int64_t batchSize = htShape[0];
   int64_t hiddenSize = htShape[1];
 
   // Frequently used types.
@@ -418,9 +423,7 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
   MemRefType matrixAllGatesType =
       MemRefType::get({batchSize, 3 * hiddenSize}, elementType);
 
-  // Common matrix multiplications.
-  Value XtWT = create.onnx.toMemref(
-      create.onnx.matmul(matrixAllGatesType, Xt, weightPack.WT));
+  // Common matrix multiplications, Xt * WT being given as XtWT.
   Value one = create.math.constant(elementType, 1);
 
   // Lower and upper bounds derived from Ht tensor.
@@ -442,8 +445,7 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
         create.onnx.matmul(matrixAllGatesType, Ht, weightPack.RT));
 
     // Do element-wise computations. Fuse them into a single nested loop.
-    ValueRange loops = create.krnl.defineLoops(htRank);
-    create.krnl.iterate(loops, loops, htLbs, htUbs,
+    emitStateLoops(rewriter, loc, htLbs, htUbs, parallelBatch,
         [&](KrnlBuilder &createKrnl, ValueRange indices) {
           MathBuilder createMath(createKrnl);
           IndexExprScope ieScope(createKrnl);
@@ -528,8 +530,7 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
     }
 
     // Emit rt and (rt (.) Ht-1).
-    ValueRange loops1 = create.krnl.defineLoops(htRank);
-    create.krnl.iterate(loops1, loops1, htLbs, htUbs,
+    emitStateLoops(rewriter, loc, htLbs, htUbs, parallelBatch,
         [&](KrnlBuilder &createKrnl, ValueRange indices) {
           MathBuilder createMath(createKrnl);
           IndexExprScope ieScope(createKrnl);
@@ -561,8 +562,7 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
         create.onnx.matmul(matrixType, rtHt, weightPack.Rh));
 
     // Do element-wise computations. Fuse them into a single nested loop.
-    ValueRange loops2 = create.krnl.defineLoops(htRank);
-    create.krnl.iterate(loops2, loops2, htLbs, htUbs,
+    emitStateLoops(rewriter, loc, htLbs, htUbs, parallelBatch,
         [&](KrnlBuilder &createKrnl, ValueRange indices) {
           MathBuilder createMath(createKrnl);
           IndexExprScope ieScope(createKrnl);
@@ -610,6 +610,17 @@ void calculateState<GruState, GruActivationPack, GruWeightPack, GruBiasPack>(
   }
 }
 
+template <>
+GruState getActiveState<GruState>(ConversionPatternRewriter &rewriter,
+    Location loc, GruState state, Value activeBatch) {
+  GruState activeState = state;
+  activeState.forwardHt =
+      emitActiveRows(rewriter, loc, state.forwardHt, activeBatch);
+  activeState.reverseHt =
+      emitActiveRows(rewriter, loc, state.reverseHt, activeBatch);
+  return activeState;
+}
+
 template <>
 void stateToOutput<ONNXGRUOp, GruState>(ConversionPatternRewriter &rewriter,
     Location loc, ONNXGRUOp *op, GruState state, std::vector<Value> &outputs) {
@@ -628,9 +639,9 @@ void stateToOutput<ONNXGRUOp, GruState>(ConversionPatternRewriter &rewriter,
 }
 
 void populateLoweringONNXGRUOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
   patterns.insert<ONNXRNNOpLowering<ONNXGRUOp, GruState, GruActivationPack,
-      GruWeightPack, GruBiasPack>>(typeConverter, ctx);
+      GruWeightPack, GruBiasPack>>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
@@ -438,12 +438,17 @@ LstmState allocAndInitializeStates<ONNXLSTMOp, LstmState>(
   return state;
 }
 
+template <>
+Value getInputWeightT<LstmWeightPack>(LstmWeightPack weight) {
+  return weight.WT;
+}
+
 template <>
 void calculateState<LstmState, LstmActivationPack, LstmWeightPack,
-    LstmBiasPack>(ConversionPatternRewriter &rewriter, Location loc, Value Xt,
+    LstmBiasPack>(ConversionPatternRewriter &rewriter, Location loc, Value XtWT,
     LstmState state, LstmActivationPack activationPack,
     LstmWeightPack weightPack, LstmBiasPack biasPack, Value sequenceIV,
-    Value directionIV, bool isForward) {
+    Value directionIV, bool isForward, bool parallelBatch) {
   // Equations for LSTM.
   // it = f(Xt*(Wi^T) + Ht-1*(Ri^T) + Pi (.) Ct-1 + Wbi + Rbi)
   // ft = f(Xt*(Wf^T) + Ht-1*(Rf^T) + Pf (.) Ct-1 + Wbf + Rbf)
@@ -456,14 +461,12 @@ void calculateState<LstmState, LstmActivationPack, LstmWeightPack,
   MultiDialectBuilder<KrnlBuilder, MathBuilder, MemRefBuilder, OnnxBuilder>
       create(rewriter, loc);
 
-  ArrayRef<int64_t> xtShape = Xt.getType().cast<ShapedType>().getShape();
-  int64_t batchSize = xtShape[0];
-
   // Get Ht, Ct.
   Value Ht = (isForward) ? state.forwardHt : state.reverseHt;
   Value Ct = (isForward) ? state.forwardCt : state.reverseCt;
 
   ArrayRef<int64_t> htShape = Ht.getType().cast<ShapedType>().getShape();
+  int64_t batchSize = htShape[0];
   int64_t hiddenSize = htShape[1];
 
   // Frequently used types.
@@ -473,11 +476,9 @@ void calculateState<LstmState, LstmActivationPack, LstmWeightPack,
       MemRefType::get({batchSize, 4 * hiddenSize}, elementType);
 
   // Do matrix multiplications.
-  // Xt * (Wi^T ++ Wo^T ++ Wf^T ++ Wc^T)
+  // Xt * (Wi^T ++ Wo^T ++ Wf^T ++ Wc^T), given as XtWT
   // Ht * (Ri^T ++ Ro^T ++ Rf^T ++ Rc^T)
   // where '++' is matrix concatenation.
-  Value XtWT = create.onnx.toMemref(
-      create.onnx.matmul(matrixAllGatesType, Xt, weightPack.WT));
   Value HtRT = create.onnx.toMemref(
       create.onnx.matmul(matrixAllGatesType, Ht, weightPack.RT));
 
@@ -491,8 +492,7 @@ void calculateState<LstmState, LstmActivationPack, LstmWeightPack,
     HtUbs.emplace_back(create.mem.dim(Ht, r));
   }
 
-  ValueRange loops = create.krnl.defineLoops(HtRank);
-  create.krnl.iterate(loops, loops, HtLbs, HtUbs,
+  emitStateLoops(rewriter, loc, HtLbs, HtUbs, parallelBatch,
       [&](KrnlBuilder &createKrnl, ValueRange indices) {
         MathBuilder createMath(createKrnl);
         IndexExprScope ieScope(createKrnl);
@@ -587,6 +587,21 @@ void calculateState<LstmState, LstmActivationPack, LstmWeightPack,
       });
 }
 
+template <>
+LstmState getActiveState<LstmState>(ConversionPatternRewriter &rewriter,
+    Location loc, LstmState state, Value activeBatch) {
+  LstmState activeState = state;
+  activeState.forwardHt =
+      emitActiveRows(rewriter, loc, state.forwardHt, activeBatch);
+  activeState.reverseHt =
+      emitActiveRows(rewriter, loc, state.reverseHt, activeBatch);
+  activeState.forwardCt =
+      emitActiveRows(rewriter, loc, state.forwardCt, activeBatch);
+  activeState.reverseCt =
+      emitActiveRows(rewriter, loc, state.reverseCt, activeBatch);
+  return activeState;
+}
+
 template <>
 void stateToOutput<ONNXLSTMOp, LstmState>(ConversionPatternRewriter &rewriter,
     Location loc, ONNXLSTMOp *op, LstmState state,
@@ -615,9 +630,9 @@ void stateToOutput<ONNXLSTMOp, LstmState>(ConversionPatternRewriter &rewriter,
 }
 
 void populateLoweringONNXLSTMOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
   patterns.insert<ONNXRNNOpLowering<ONNXLSTMOp, LstmState, LstmActivationPack,
-      LstmWeightPack, LstmBiasPack>>(typeConverter, ctx);
+      LstmWeightPack, LstmBiasPack>>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
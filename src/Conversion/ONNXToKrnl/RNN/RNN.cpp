@@ -296,15 +296,22 @@ RnnState allocAndInitializeStates<ONNXRNNOp, RnnState>(
   return state;
 }
 
+template <>
+Value getInputWeightT<RnnWeightPack>(RnnWeightPack weight) {
+  return weight.Wi;
+}
+
 template <>
 void calculateState<RnnState, RnnActivationPack, RnnWeightPack, RnnBiasPack>(
-    ConversionPatternRewriter &rewriter, Location loc, Value Xt, RnnState state,
+    ConversionPatternRewriter &rewriter, Location loc, Value XtWi,
+    RnnState state,
     RnnActivationPack activationPack, RnnWeightPack weightPack,
-    RnnBiasPack biasPack, Value sequenceIV, Value directionIV, bool isForward) {
+    RnnBiasPack biasPack, Value sequenceIV, Value directionIV, bool isForward,
+    bool parallelBatch) {
   // Equations for RNN.
   // Ht = f(Xt*(Wi^T) + Ht-1*(Ri^T) + Wbi + Rbi)
   // Shape information:
-  // Xt : [seq_length, batch_size, input_size]
+  // XtWi: [batch_size, hidden_size]
   // Wi : [hidden_size, input_size]
   // Ri : [hidden_size, hidden_size]
   // Ht : [batch_size, hidden_size]
@@ -319,9 +326,7 @@ void calculateState<RnnState, RnnActivationPack, RnnWeightPack, RnnBiasPack>(
   MemRefType matrixType = Ht.getType().cast<MemRefType>();
   unsigned htRank = matrixType.getRank();
 
-  // Do matrix multiplications.
-  Value XtWi =
-      create.onnx.toMemref(create.onnx.matmul(matrixType, Xt, weightPack.Wi));
+  // Do matrix multiplications, Xt * Wi being given as XtWi.
   Value HtRi =
       create.onnx.toMemref(create.onnx.matmul(matrixType, Ht, weightPack.Ri));
 
@@ -333,8 +338,7 @@ void calculateState<RnnState, RnnActivationPack, RnnWeightPack, RnnBiasPack>(
   for (unsigned r = 0; r < htRank; ++r) {
     htUbs.emplace_back(create.mem.dim(Ht, r));
   }
-  ValueRange loops = create.krnl.defineLoops(htRank);
-  create.krnl.iterate(loops, loops, htLbs, htUbs,
+  emitStateLoops(rewriter, loc, htLbs, htUbs, parallelBatch,
       [&](KrnlBuilder &createKrnl, ValueRange indices) {
         MathBuilder createMath(createKrnl);
         Value bs(indices[0]), hs(indices[1]);
@@ -359,6 +363,17 @@ void calculateState<RnnState, RnnActivationPack, RnnWeightPack, RnnBiasPack>(
       });
 }
 
+template <>
+RnnState getActiveState<RnnState>(ConversionPatternRewriter &rewriter,
+    Location loc, RnnState state, Value activeBatch) {
+  RnnState activeState = state;
+  activeState.forwardHt =
+      emitActiveRows(rewriter, loc, state.forwardHt, activeBatch);
+  activeState.reverseHt =
+      emitActiveRows(rewriter, loc, state.reverseHt, activeBatch);
+  return activeState;
+}
+
 template <>
 void stateToOutput<ONNXRNNOp, RnnState>(ConversionPatternRewriter &rewriter,
     Location loc, ONNXRNNOp *op, RnnState state, std::vector<Value> &outputs) {
@@ -378,9 +393,9 @@ void stateToOutput<ONNXRNNOp, RnnState>(ConversionPatternRewriter &rewriter,
 }
 
 void populateLoweringONNXRNNOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
   patterns.insert<ONNXRNNOpLowering<ONNXRNNOp, RnnState, RnnActivationPack,
-      RnnWeightPack, RnnBiasPack>>(typeConverter, ctx);
+      RnnWeightPack, RnnBiasPack>>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
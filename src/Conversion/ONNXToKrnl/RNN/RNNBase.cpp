@@ -298,21 +298,24 @@ Value applyActivation(OpBuilder &rewriter, Location loc,
 /// does not have enough information about the parent context. Users must
 /// deallocate the copy by themselves.
 Value emitXSliceAt(ConversionPatternRewriter &rewriter, Location loc, Value X,
-    Value timestepIV) {
+    Value timestepIV, Value activeBatch) {
   // TODO remove
   IndexExprScope scope(&rewriter, loc);
   MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
       MemRefBuilder>
       create(rewriter, loc);
 
-  int64_t batchSize = dimAt(X, 1);
+  int64_t batchSize = activeBatch ? ShapedType::kDynamic : dimAt(X, 1);
   int64_t inputSize = dimAt(X, 2);
   Type elementType = X.getType().cast<ShapedType>().getElementType();
   MemRefType sliceXType = MemRefType::get({batchSize, inputSize}, elementType);
 
-  // Allocate a buffer
+  // Allocate a buffer, of the leading active rows only if any.
   SmallVector<IndexExpr, 2> dims;
-  dims.emplace_back(create.krnlIE.getShapeAsDim(X, 1));
+  if (activeBatch)
+    dims.emplace_back(SymbolIndexExpr(activeBatch));
+  else
+    dims.emplace_back(create.krnlIE.getShapeAsDim(X, 1));
   dims.emplace_back(create.krnlIE.getShapeAsDim(X, 2));
   Value sliceX = create.mem.alignedAlloc(sliceXType, dims);
 
@@ -334,4 +337,343 @@ Value emitXSliceAt(ConversionPatternRewriter &rewriter, Location loc, Value X,
   return sliceX;
 }
 
+/// Project the input at all timesteps with a single matrix multiplication.
+Value emitInputProjection(
+    ConversionPatternRewriter &rewriter, Location loc, Value X, Value WT) {
+  IndexExprScope scope(&rewriter, loc);
+  MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder, OnnxBuilder>
+      create(rewriter, loc);
+
+  int64_t sequenceSize = dimAt(X, 0);
+  int64_t batchSize = dimAt(X, 1);
+  int64_t gatesSize = dimAt(WT, 1);
+  Type elementType = X.getType().cast<ShapedType>().getElementType();
+  int64_t rows = ShapedType::isDynamic(batchSize) ? ShapedType::kDynamic
+                                                  : sequenceSize * batchSize;
+  MemRefType projection2DType =
+      MemRefType::get({rows, gatesSize}, elementType);
+
+  // View X as a [seq_length * batch_size, input_size] matrix.
+  IndexExpr S = create.krnlIE.getShapeAsDim(X, 0);
+  IndexExpr B = create.krnlIE.getShapeAsDim(X, 1);
+  SmallVector<IndexExpr, 2> x2DDims;
+  x2DDims.emplace_back(S * B);
+  x2DDims.emplace_back(create.krnlIE.getShapeAsDim(X, 2));
+  Value X2D = create.mem.reinterpretCast(X, x2DDims);
+
+  // Do the matrix multiplication, and view its result as
+  // [seq_length, batch_size, gates * hidden_size].
+  Value XWT2D = create.onnx.toMemref(
+      create.onnx.matmul(projection2DType, X2D, WT));
+  SmallVector<IndexExpr, 3> projectionDims;
+  projectionDims.emplace_back(S);
+  projectionDims.emplace_back(B);
+  projectionDims.emplace_back(create.krnlIE.getShapeAsDim(XWT2D, 1));
+  return create.mem.reinterpretCast(XWT2D, projectionDims);
+}
+
+/// Get the projection of the input at a specific timestep.
+Value emitInputProjectionAt(ConversionPatternRewriter &rewriter, Location loc,
+    Value X, Value WT, Value XWT, Value timestepIV, Value activeBatch) {
+  MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder, OnnxBuilder>
+      create(rewriter, loc);
+
+  // Projection of a slice of X.
+  if (!XWT) {
+    Value Xt = emitXSliceAt(rewriter, loc, X, timestepIV, activeBatch);
+    Type elementType = X.getType().cast<ShapedType>().getElementType();
+    MemRefType projectionType =
+        MemRefType::get({dimAt(Xt, 0), dimAt(WT, 1)}, elementType);
+    return create.onnx.toMemref(create.onnx.matmul(projectionType, Xt, WT));
+  }
+
+  // View of the projection at all timesteps, the timestep dim being removed.
+  IndexExprScope scope(&rewriter, loc);
+  SmallVector<IndexExpr, 3> offsets, sizes, strides;
+  offsets.emplace_back(DimIndexExpr(timestepIV));
+  offsets.emplace_back(LiteralIndexExpr(0));
+  offsets.emplace_back(LiteralIndexExpr(0));
+  sizes.emplace_back(LiteralIndexExpr(1));
+  sizes.emplace_back(create.krnlIE.getShapeAsDim(XWT, 1));
+  sizes.emplace_back(create.krnlIE.getShapeAsDim(XWT, 2));
+  strides.assign(3, LiteralIndexExpr(1));
+  return create.mem.subView(XWT, offsets, sizes, strides);
+}
+
+/// Sort the sequences of a ragged batch by decreasing length.
+RaggedBatch emitRaggedBatch(ConversionPatternRewriter &rewriter, Location loc,
+    Value X, Value sequenceLens) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+      MemRefBuilder>
+      create(rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+  Type indexType = rewriter.getIndexType();
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  SmallVector<IndexExpr, 1> batchDims, sequenceDims;
+  batchDims.emplace_back(create.krnlIE.getShapeAsDim(X, 1));
+  sequenceDims.emplace_back(create.krnlIE.getShapeAsDim(X, 0));
+  Value sequenceSize = sequenceDims[0].getValue();
+  auto batchType = MemRefType::get({dimAt(X, 1)}, indexType);
+  auto sequenceType = MemRefType::get({dimAt(X, 0)}, indexType);
+  RaggedBatch batch;
+  Value lengths = create.mem.alignedAlloc(batchType, batchDims);
+  Value ranks = create.mem.alignedAlloc(batchType, batchDims);
+  batch.order = create.mem.alignedAlloc(batchType, batchDims);
+  batch.sortedLengths = create.mem.alignedAlloc(batchType, batchDims);
+  batch.activeBatch = create.mem.alignedAlloc(sequenceType, sequenceDims);
+  Value maxLength = create.mem.alignedAlloc(MemRefType::get({}, indexType));
+  create.krnl.store(zero, maxLength, {});
+
+  // Clamp the lengths to [0, seq_length] and find the longest one.
+  SmallVector<IndexExpr, 2> lbs(2, LiteralIndexExpr(0));
+  ValueRange batchLoop = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(batchLoop, batchLoop, {lbs[0]}, batchDims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        Value length =
+            createMath.castToIndex(createKrnl.load(sequenceLens, loopInd));
+        length = createMath.min(createMath.max(length, zero), sequenceSize);
+        createKrnl.store(length, lengths, loopInd);
+        createKrnl.store(zero, ranks, loopInd);
+        Value longest = createKrnl.load(maxLength, {});
+        createKrnl.store(createMath.max(longest, length), maxLength, {});
+      });
+
+  // The rank of a sequence is the number of sequences longer than it, or as
+  // long and before it in the batch.
+  ValueRange rankLoops = create.krnl.defineLoops(2);
+  create.krnl.iterateIE(rankLoops, rankLoops, lbs,
+      {batchDims[0], batchDims[0]},
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        Value b(loopInd[0]), c(loopInd[1]);
+        Value lengthB = createKrnl.load(lengths, {b});
+        Value lengthC = createKrnl.load(lengths, {c});
+        Value isBefore = createMath.ori(createMath.sgt(lengthC, lengthB),
+            createMath.andi(
+                createMath.eq(lengthC, lengthB), createMath.slt(c, b)));
+        Value rank = createKrnl.load(ranks, {b});
+        rank = createMath.add(rank, createMath.select(isBefore, one, zero));
+        createKrnl.store(rank, ranks, {b});
+      });
+  ValueRange orderLoop = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(orderLoop, orderLoop, {lbs[0]}, batchDims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        Value rank = createKrnl.load(ranks, loopInd);
+        createKrnl.store(loopInd[0], batch.order, {rank});
+        createKrnl.store(
+            createKrnl.load(lengths, loopInd), batch.sortedLengths, {rank});
+      });
+
+  // Count the sequences longer than each timestep.
+  ValueRange zeroLoop = create.krnl.defineLoops(1);
+  create.krnl.iterateIE(zeroLoop, zeroLoop, {lbs[0]}, sequenceDims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        createKrnl.store(zero, batch.activeBatch, loopInd);
+      });
+  ValueRange countLoops = create.krnl.defineLoops(2);
+  create.krnl.iterateIE(countLoops, countLoops, lbs,
+      {batchDims[0], sequenceDims[0]},
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        Value b(loopInd[0]), t(loopInd[1]);
+        Value isActive = createMath.slt(t, createKrnl.load(lengths, {b}));
+        Value count = createKrnl.load(batch.activeBatch, {t});
+        count = createMath.add(count, createMath.select(isActive, one, zero));
+        createKrnl.store(count, batch.activeBatch, {t});
+      });
+  batch.maxLength = create.krnl.load(maxLength, {});
+  return batch;
+}
+
+/// Copy the input of a ragged batch with its sequences sorted by decreasing
+/// length, each sequence being reversed within its length if `reverse`.
+Value emitRaggedInput(ConversionPatternRewriter &rewriter, Location loc,
+    Value X, const RaggedBatch &batch, bool reverse) {
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+      create(rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+  SmallVector<IndexExpr, 3> dims;
+  create.krnlIE.getShapeAsDims(X, dims);
+  Value sortedX =
+      create.mem.alignedAlloc(X.getType().cast<MemRefType>(), dims);
+  SmallVector<IndexExpr, 3> lbs(3, LiteralIndexExpr(0));
+  ValueRange loopDef = create.krnl.defineLoops(3);
+  create.krnl.iterateIE(loopDef, loopDef, lbs, dims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        Value t(loopInd[0]), i(loopInd[1]), j(loopInd[2]);
+        Value b = createKrnl.load(batch.order, {i});
+        Value timestep = t;
+        if (reverse) {
+          // Timestep length - 1 - t of the sequence, the padding being kept
+          // in place.
+          Value length = createKrnl.load(batch.sortedLengths, {i});
+          Value reverseT = createMath.sub(
+              createMath.sub(length, createMath.constantIndex(1)), t);
+          timestep =
+              createMath.select(createMath.slt(t, length), reverseT, t);
+        }
+        Value val = createKrnl.load(X, {timestep, b, j});
+        createKrnl.store(val, sortedX, {t, i, j});
+      });
+  return sortedX;
+}
+
+/// Copy an initial state of shape [num_directions, batch_size, hidden_size]
+/// with its batch sorted as the sequences of a ragged batch.
+Value emitRaggedState(ConversionPatternRewriter &rewriter, Location loc,
+    Value initial, const RaggedBatch &batch) {
+  if (isFromNone(initial))
+    return initial;
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+      create(rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+  SmallVector<IndexExpr, 3> dims;
+  create.krnlIE.getShapeAsDims(initial, dims);
+  Value sortedInitial =
+      create.mem.alignedAlloc(initial.getType().cast<MemRefType>(), dims);
+  SmallVector<IndexExpr, 3> lbs(3, LiteralIndexExpr(0));
+  ValueRange loopDef = create.krnl.defineLoops(3);
+  create.krnl.iterateIE(loopDef, loopDef, lbs, dims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        Value d(loopInd[0]), i(loopInd[1]), h(loopInd[2]);
+        Value b = createKrnl.load(batch.order, {i});
+        Value val = createKrnl.load(initial, {d, b, h});
+        createKrnl.store(val, sortedInitial, {d, i, h});
+      });
+  return sortedInitial;
+}
+
+/// Copy an output computed over the sorted sequences of a ragged batch back
+/// to the order of the batch.
+Value emitRaggedOutput(ConversionPatternRewriter &rewriter, Location loc,
+    Value output, const RaggedBatch &batch, StringRef direction) {
+  if (!output)
+    return output;
+  MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+      create(rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+  auto memRefType = output.getType().cast<MemRefType>();
+  int64_t rank = memRefType.getRank();
+  SmallVector<IndexExpr, 4> dims;
+  create.krnlIE.getShapeAsDims(output, dims);
+  Value result = create.mem.alignedAlloc(memRefType, dims);
+  SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
+  ValueRange loopDef = create.krnl.defineLoops(rank);
+  create.krnl.iterateIE(loopDef, loopDef, lbs, dims,
+      [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        MathBuilder createMath(createKrnl);
+        // Y_h or Y_c, of shape [num_directions, batch_size, hidden_size].
+        if (rank == 3) {
+          Value d(loopInd[0]), i(loopInd[1]), h(loopInd[2]);
+          Value b = createKrnl.load(batch.order, {i});
+          Value val = createKrnl.load(output, {d, i, h});
+          createKrnl.store(val, result, {d, b, h});
+          return;
+        }
+        // Y, of shape [seq_length, num_directions, batch_size, hidden_size],
+        // zero past the length of each sequence. The reverse direction is
+        // computed over the sequences reversed within their length.
+        Value t(loopInd[0]), d(loopInd[1]), i(loopInd[2]), h(loopInd[3]);
+        Value b = createKrnl.load(batch.order, {i});
+        Value length = createKrnl.load(batch.sortedLengths, {i});
+        Value isValid = createMath.slt(t, length);
+        Value timestep = t;
+        if (direction == REVERSE || direction == BIDIRECTIONAL) {
+          Value reverseT = createMath.sub(
+              createMath.sub(length, createMath.constantIndex(1)), t);
+          reverseT = createMath.select(isValid, reverseT, t);
+          timestep = direction == REVERSE
+                         ? reverseT
+                         : createMath.select(
+                               createMath.eq(d, createMath.constantIndex(1)),
+                               reverseT, t);
+        }
+        Value val = createKrnl.load(output, {timestep, d, i, h});
+        Value zero = createMath.constant(memRefType.getElementType(), 0);
+        createKrnl.store(
+            createMath.select(isValid, val, zero), result, {t, d, b, h});
+      });
+  return result;
+}
+
+/// View the leading rows of a state of shape [batch_size, hidden_size].
+Value emitActiveRows(ConversionPatternRewriter &rewriter, Location loc,
+    Value state, Value activeBatch) {
+  if (!state)
+    return state;
+  MultiDialectBuilder<IndexExprBuilderForKrnl, MemRefBuilder> create(
+      rewriter, loc);
+  IndexExprScope scope(create.krnlIE);
+  SmallVector<IndexExpr, 2> dims;
+  dims.emplace_back(SymbolIndexExpr(activeBatch));
+  dims.emplace_back(create.krnlIE.getShapeAsDim(state, 1));
+  return create.mem.reinterpretCast(state, dims);
+}
+
+/// Emit a loop nest over the elements of a state, in parallel over the batch.
+void emitStateLoops(ConversionPatternRewriter &rewriter, Location loc,
+    ArrayRef<Value> lbs, ArrayRef<Value> ubs, bool parallel,
+    function_ref<void(KrnlBuilder &, ValueRange)> bodyFn) {
+  MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder> create(
+      rewriter, loc);
+  int64_t rank = lbs.size();
+  if (!parallel) {
+    ValueRange loopDef = create.krnl.defineLoops(rank);
+    create.krnl.iterate(loopDef, loopDef, lbs, ubs, bodyFn);
+    return;
+  }
+  // The Krnl loops are emitted inside a krnl.region so that the parallel
+  // induction variable is a valid affine symbol for them.
+  Value one = create.math.constantIndex(1);
+  create.scf.parallelLoop({lbs[0]}, {ubs[0]}, {one},
+      [&](SCFBuilder &createSCF, ValueRange parInd) {
+        OpBuilder &builder = createSCF.getBuilder();
+        KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+        OpBuilder::InsertionGuard insertGuard(builder);
+        builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+        MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+        SmallVector<Value, 4> stateLbs(lbs.begin(), lbs.end());
+        SmallVector<Value, 4> stateUbs(ubs.begin(), ubs.end());
+        stateLbs[0] = parInd[0];
+        stateUbs[0] = create.math.add(parInd[0], one);
+        ValueRange loopDef = create.krnl.defineLoops(rank);
+        create.krnl.iterate(loopDef, loopDef, stateLbs, stateUbs, bodyFn);
+      });
+}
+
+/// Emit the two directions of a bidirectional RNN concurrently.
+void emitDirectionsInParallel(ConversionPatternRewriter &rewriter,
+    Location loc, function_ref<void()> forwardFn,
+    function_ref<void()> reverseFn) {
+  MultiDialectBuilder<MathBuilder, SCFBuilder> create(rewriter, loc);
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  Value two = create.math.constantIndex(2);
+  // Emit a direction inside a krnl.region, so that its Krnl loops get their
+  // own affine scope.
+  auto emitDirection = [&](SCFBuilder &createSCF, function_ref<void()> fn) {
+    OpBuilder &builder = createSCF.getBuilder();
+    KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+    OpBuilder::InsertionGuard insertGuard(builder);
+    builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+    fn();
+  };
+  create.scf.parallelLoop({zero}, {two}, {one},
+      [&](SCFBuilder &createSCF, ValueRange parInd) {
+        MathBuilder createMath(createSCF);
+        Value isForward = createMath.eq(parInd[0], zero);
+        createSCF.ifThenElse(
+            isForward,
+            [&](SCFBuilder &createBranch) {
+              emitDirection(createBranch, forwardFn);
+            },
+            [&](SCFBuilder &createBranch) {
+              emitDirection(createBranch, reverseFn);
+            });
+      });
+}
+
 } // namespace onnx_mlir
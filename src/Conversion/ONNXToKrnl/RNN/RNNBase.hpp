@@ -22,6 +22,15 @@ static constexpr int BUFFER_ALIGN = 128;
 static constexpr llvm::StringRef FORWARD = "forward";
 static constexpr llvm::StringRef REVERSE = "reverse";
 static constexpr llvm::StringRef BIDIRECTIONAL = "bidirectional";
+// Minimum static sequence length for which the input is projected at all
+// timesteps at once, before the sequence loop.
+static constexpr int64_t BATCHED_PROJECTION_MIN_SEQ_LENGTH = 8;
+// Minimum static batch size for which the elementwise computations of a
+// timestep are distributed over the batch with parallel execution enabled.
+static constexpr int64_t PARALLEL_BATCH_MIN_SIZE = 32;
+// Index of the initial_h operand of the RNN ops, followed by the initial_c
+// operand of LSTM.
+static constexpr unsigned INITIAL_H_OPERAND_INDEX = 5;
 
 namespace onnx_mlir {
 
@@ -31,6 +40,21 @@ struct RNNActivation {
   llvm::Optional<mlir::FloatAttr> beta;
 };
 
+/// The sequences of a batch given with their lengths, sorted by decreasing
+/// length so that the sequences still running at a timestep are the leading
+/// rows of the batch.
+struct RaggedBatch {
+  // Index in the batch of each sorted sequence, memref<batch_size x index>.
+  mlir::Value order;
+  // Length of each sorted sequence, memref<batch_size x index>.
+  mlir::Value sortedLengths;
+  // Number of sequences longer than each timestep,
+  // memref<seq_length x index>.
+  mlir::Value activeBatch;
+  // Length of the longest sequence.
+  mlir::Value maxLength;
+};
+
 /// Get a dimension of the tensor's shape.
 int64_t dimAt(mlir::Value val, int index);
 
@@ -71,17 +95,77 @@ void stateToOutputForHiddenOrCell(mlir::ConversionPatternRewriter &rewriter,
 mlir::Value applyActivation(mlir::OpBuilder &rewriter, mlir::Location loc,
     RNNActivation activation, mlir::Value operand);
 
-/// Get a slice of X at a specific timestep.
+/// Get a slice of X at a specific timestep, of its leading activeBatch rows
+/// if given.
 mlir::Value emitXSliceAt(mlir::ConversionPatternRewriter &rewriter,
-    mlir::Location loc, mlir::Value X, mlir::Value timestep);
+    mlir::Location loc, mlir::Value X, mlir::Value timestep,
+    mlir::Value activeBatch = nullptr);
+
+/// Project the input at all timesteps, X * WT of shape
+/// [seq_length, batch_size, gates * hidden_size], with a single matrix
+/// multiplication of X viewed as a [seq_length * batch_size, input_size]
+/// matrix.
+mlir::Value emitInputProjection(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value X, mlir::Value WT);
+
+/// Get the projection Xt * WT of the input at a specific timestep: a view of
+/// the projection at all timesteps XWT if any, or the projection of a slice
+/// of X otherwise, restricted to its leading activeBatch rows if given.
+mlir::Value emitInputProjectionAt(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value X, mlir::Value WT, mlir::Value XWT,
+    mlir::Value timestep, mlir::Value activeBatch = nullptr);
+
+/// Sort the sequences of a batch by decreasing length, given by
+/// sequence_lens, the lengths being clamped to [0, seq_length].
+RaggedBatch emitRaggedBatch(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value X, mlir::Value sequenceLens);
+
+/// Copy X with its sequences sorted as in the ragged batch. With `reverse`,
+/// each sequence is reversed within its length, so that the reverse direction
+/// starts at the last timestep of each sequence.
+mlir::Value emitRaggedInput(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value X, const RaggedBatch &batch, bool reverse);
+
+/// Copy an initial hidden or cell state with its batch sorted as the
+/// sequences of the ragged batch.
+mlir::Value emitRaggedState(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value initial, const RaggedBatch &batch);
+
+/// Copy an output of the RNN op computed over the sorted sequences of the
+/// ragged batch back to the order of the batch, the all hidden output being
+/// zero past the length of each sequence.
+mlir::Value emitRaggedOutput(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value output, const RaggedBatch &batch,
+    llvm::StringRef direction);
+
+/// View the leading activeBatch rows of an intermediate state of shape
+/// [batch_size, hidden_size].
+mlir::Value emitActiveRows(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value state, mlir::Value activeBatch);
+
+/// Emit a loop nest over the [batch_size, hidden_size] elements of a state
+/// between the given bounds. When `parallel` is set, the batch dim is
+/// distributed with an scf.parallel.
+void emitStateLoops(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, llvm::ArrayRef<mlir::Value> lbs,
+    llvm::ArrayRef<mlir::Value> ubs, bool parallel,
+    mlir::function_ref<void(KrnlBuilder &, mlir::ValueRange)> bodyFn);
+
+/// Emit the sequence loops of the two directions of a bidirectional RNN
+/// concurrently, one per iteration of a 2-iteration scf.parallel.
+void emitDirectionsInParallel(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::function_ref<void()> forwardFn,
+    mlir::function_ref<void()> reverseFn);
 
 // Override the following methods when lowering an RNN operation:
 // - hasAllNoneOutput
 // - getActivationPack
 // - getWeightPack
 // - getBiasPack
+// - getInputWeightT
 // - allocAndInitializeStates
 // - calculateState
+// - getActiveState
 // - stateToOutput
 
 // Check whether all outputs have NoneType or not.
@@ -106,17 +190,31 @@ template <typename RNNOp, typename B>
 std::tuple<B, B> getBiasPack(
     mlir::ConversionPatternRewriter &rewriter, mlir::Location loc, RNNOp *op);
 
+/// Obtain the transposed input weights of all the gates, of shape
+/// [input_size, gates * hidden_size].
+template <typename W>
+mlir::Value getInputWeightT(W weight);
+
 // Allocate memory for RNN states and initialize them.
 template <typename RNNOp, typename S>
 S allocAndInitializeStates(mlir::ConversionPatternRewriter &rewriter,
     mlir::Location loc, mlir::TypeConverter *typeConverter, RNNOp *op,
     typename RNNOp::Adaptor operandAdaptor);
 
-// Calculate new states from the current input and states.
+// Calculate new states from the projection Xt * WT of the current input and
+// the states. The elementwise computations are distributed over the batch
+// when parallelBatch is set.
 template <typename S, typename A, typename W, typename B>
 void calculateState(mlir::ConversionPatternRewriter &rewriter,
-    mlir::Location loc, mlir::Value Xt, S state, A activationSet, W weight,
-    B bias, mlir::Value sequenceIV, mlir::Value directionIV, bool isForward);
+    mlir::Location loc, mlir::Value XtWT, S state, A activationSet, W weight,
+    B bias, mlir::Value sequenceIV, mlir::Value directionIV, bool isForward,
+    bool parallelBatch);
+
+// Restrict the intermediate states to their leading activeBatch rows, the
+// sequences still running in a ragged batch.
+template <typename S>
+S getActiveState(mlir::ConversionPatternRewriter &rewriter, mlir::Location loc,
+    S state, mlir::Value activeBatch);
 
 // Write states to the RNN's outputs.
 template <typename RNNOp, typename S>
@@ -128,8 +226,12 @@ template <typename RNNOp, typename S, typename A, typename W, typename B>
 struct ONNXRNNOpLowering : public mlir::OpConversionPattern<RNNOp> {
   using OpAdaptor = typename RNNOp::Adaptor;
 
-  ONNXRNNOpLowering(mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx)
-      : mlir::OpConversionPattern<RNNOp>(typeConverter, ctx) {}
+  ONNXRNNOpLowering(mlir::TypeConverter &typeConverter, mlir::MLIRContext *ctx,
+      bool enableParallel)
+      : mlir::OpConversionPattern<RNNOp>(typeConverter, ctx),
+        enableParallel(enableParallel) {}
+
+  bool enableParallel;
 
   mlir::LogicalResult matchAndRewrite(RNNOp rnnOp, OpAdaptor adaptor,
       mlir::ConversionPatternRewriter &rewriter) const final {
@@ -142,9 +244,44 @@ struct ONNXRNNOpLowering : public mlir::OpConversionPattern<RNNOp> {
       return mlir::success();
     }
 
+    int64_t sequenceDimSize = dimAt(rnnOp.getX(), 0);
+    auto direction = rnnOp.getDirection();
+    bool hasForward = direction == FORWARD || direction == BIDIRECTIONAL;
+    bool hasReverse = direction == REVERSE || direction == BIDIRECTIONAL;
+
+    // With sequence_lens, the sequences are sorted by decreasing length, so
+    // that the sequences still running at a timestep are the leading rows of
+    // the batch. The sequence loops stop at the longest sequence, and each
+    // timestep only computes, matrix multiplications included, the rows still
+    // running, the states of the other rows keeping their last value. The
+    // reverse direction runs over the sequences reversed within their length.
+    // The outputs are put back in the order of the batch at the end.
+    mlir::Value sequenceLens = adaptor.getSequenceLens();
+    bool ragged = !isFromNone(sequenceLens);
+    RaggedBatch raggedBatch;
+    mlir::Value forwardX = X, reverseX = X;
+    llvm::SmallVector<mlir::Value, 8> operands(adaptor.getOperands());
+    if (ragged) {
+      raggedBatch = emitRaggedBatch(rewriter, loc, X, sequenceLens);
+      if (hasForward)
+        forwardX = emitRaggedInput(
+            rewriter, loc, X, raggedBatch, /*reverse=*/false);
+      if (hasReverse)
+        reverseX =
+            emitRaggedInput(rewriter, loc, X, raggedBatch, /*reverse=*/true);
+      // The states are initialized with the sorted inputs and initial states.
+      operands[0] = hasForward ? forwardX : reverseX;
+      for (unsigned i = INITIAL_H_OPERAND_INDEX; i < operands.size(); ++i)
+        if (!isFromNone(operands[i]) &&
+            operands[i].getType().cast<mlir::ShapedType>().getRank() == 3)
+          operands[i] =
+              emitRaggedState(rewriter, loc, operands[i], raggedBatch);
+    }
+    OpAdaptor stateAdaptor(operands, op->getAttrDictionary());
+
     // Initialize output states.
     S state = allocAndInitializeStates<RNNOp, S>(
-        rewriter, loc, this->typeConverter, &rnnOp, adaptor);
+        rewriter, loc, this->typeConverter, &rnnOp, stateAdaptor);
 
     // Activation functions.
     A activationForward, activationReverse;
@@ -161,57 +298,116 @@ struct ONNXRNNOpLowering : public mlir::OpConversionPattern<RNNOp> {
     std::tie(biasForward, biasReverse) =
         getBiasPack<RNNOp, B>(rewriter, loc, &rnnOp);
 
-    int64_t sequenceDimSize = dimAt(rnnOp.getX(), 0);
-    auto direction = rnnOp.getDirection();
+    // For long enough sequences, project the input at all timesteps with a
+    // single large matrix multiplication instead of one per timestep, only the
+    // recurrent ones being left in the sequence loop.
+    bool batchedProjection =
+        !mlir::ShapedType::isDynamic(sequenceDimSize) &&
+        sequenceDimSize >= BATCHED_PROJECTION_MIN_SEQ_LENGTH;
 
     MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder,
         MathBuilder>
         create(rewriter, loc);
 
-    if (direction == FORWARD || direction == BIDIRECTIONAL) {
+    // Distribute the elementwise computations of each timestep over the
+    // batch when it is large enough.
+    int64_t batchDimSize = dimAt(rnnOp.getX(), 1);
+    bool parallelBatch = enableParallel &&
+                         !mlir::ShapedType::isDynamic(batchDimSize) &&
+                         batchDimSize >= PARALLEL_BATCH_MIN_SIZE;
+
+    // Emit one timestep of a ragged batch over the sequences still running,
+    // inside a krnl.region so that their number, loaded at each timestep, is
+    // a valid affine symbol for the loops of the timestep.
+    auto emitRaggedTimestep = [&](mlir::Value X, mlir::Value WT,
+                                  mlir::Value XWT, mlir::Value sequenceIV,
+                                  mlir::Value directionIV, A activation,
+                                  W weight, B bias, bool isForward) {
+      KrnlRegionOp regionOp = rewriter.create<KrnlRegionOp>(loc);
+      mlir::OpBuilder::InsertionGuard insertGuard(rewriter);
+      rewriter.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+      KrnlBuilder createKrnl(rewriter, loc);
+      mlir::Value activeBatch =
+          createKrnl.load(raggedBatch.activeBatch, {sequenceIV});
+      mlir::Value XtWT = emitInputProjectionAt(
+          rewriter, loc, X, WT, XWT, sequenceIV, activeBatch);
+      S activeState = getActiveState<S>(rewriter, loc, state, activeBatch);
+      calculateState<S, A, W, B>(rewriter, loc, XtWT, activeState, activation,
+          weight, bias, sequenceIV, directionIV, isForward, parallelBatch);
+    };
+
+    // Get the upper bound of the sequence loops.
+    auto getSequenceUB = [&](mlir::Value X) -> IndexExpr {
+      if (ragged)
+        return SymbolIndexExpr(raggedBatch.maxLength);
+      if (!mlir::ShapedType::isDynamic(sequenceDimSize))
+        return LiteralIndexExpr(sequenceDimSize);
+      return create.krnlIE.getShapeAsDim(X, 0);
+    };
+
+    auto emitForward = [&]() {
+      mlir::Value X = forwardX;
+      mlir::Value WT = getInputWeightT<W>(weightForward);
+      mlir::Value XWT;
+      if (batchedProjection)
+        XWT = emitInputProjection(rewriter, loc, X, WT);
       IndexExprScope childScope(create.krnl);
       mlir::ValueRange loopDef = create.krnl.defineLoops(1);
       llvm::SmallVector<IndexExpr, 4> lbs(1, LiteralIndexExpr(0));
       llvm::SmallVector<IndexExpr, 4> ubs;
-      if (!mlir::ShapedType::isDynamic(sequenceDimSize))
-        ubs.emplace_back(LiteralIndexExpr(sequenceDimSize));
-      else
-        ubs.emplace_back(create.krnlIE.getShapeAsDim(X, 0));
+      ubs.emplace_back(getSequenceUB(X));
       create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
           [&](KrnlBuilder &createKrnl, mlir::ValueRange loopInd) {
             MathBuilder createMath(createKrnl);
             mlir::Value directionIV =
                 createMath.constant(rewriter.getIndexType(), 0);
             mlir::Value sequenceIV = loopInd[0];
-            // Get a slice of X at the current timestep.
-            mlir::Value Xt = emitXSliceAt(rewriter, loc, X, sequenceIV);
+            if (ragged) {
+              emitRaggedTimestep(X, WT, XWT, sequenceIV, directionIV,
+                  activationForward, weightForward, biasForward,
+                  /*isForward=*/true);
+              return;
+            }
+            // Get the projection of X at the current timestep.
+            mlir::Value XtWT =
+                emitInputProjectionAt(rewriter, loc, X, WT, XWT, sequenceIV);
             // Emit calculation for one RNN step.
-            calculateState<S, A, W, B>(rewriter, loc, Xt, state,
+            calculateState<S, A, W, B>(rewriter, loc, XtWT, state,
                 activationForward, weightForward, biasForward, sequenceIV,
                 directionIV,
-                /*isForward=*/true);
+                /*isForward=*/true, parallelBatch);
           });
-    }
-
-    if (direction == REVERSE || direction == BIDIRECTIONAL) {
+    };
+
+    auto emitReverse = [&]() {
+      mlir::Value X = reverseX;
+      mlir::Value WT = getInputWeightT<W>(weightReverse);
+      mlir::Value XWT;
+      if (batchedProjection)
+        XWT = emitInputProjection(rewriter, loc, X, WT);
       IndexExprScope childScope(create.krnl);
       mlir::ValueRange loopDef = create.krnl.defineLoops(1);
       llvm::SmallVector<IndexExpr, 4> lbs(1, LiteralIndexExpr(0));
       llvm::SmallVector<IndexExpr, 4> ubs;
-      if (!mlir::ShapedType::isDynamic(sequenceDimSize))
-        ubs.emplace_back(LiteralIndexExpr(sequenceDimSize));
-      else
-        ubs.emplace_back(create.krnlIE.getShapeAsDim(X, 0));
+      ubs.emplace_back(getSequenceUB(X));
       create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
           [&](KrnlBuilder &ck, mlir::ValueRange loopInd) {
             MultiDialectBuilder<MemRefBuilder, MathBuilder> create(ck);
 
+            mlir::Value directionIV = create.math.constant(
+                rewriter.getIndexType(), (direction == REVERSE) ? 0 : 1);
+            // The sequences of a ragged batch are already reversed.
+            if (ragged) {
+              emitRaggedTimestep(X, WT, XWT, loopInd[0], directionIV,
+                  activationReverse, weightReverse, biasReverse,
+                  /*isForward=*/false);
+              return;
+            }
+
             mlir::AffineMap reverseIVMap = mlir::AffineMap::get(1, 1,
                 rewriter.getAffineSymbolExpr(0) - rewriter.getAffineDimExpr(0) -
                     1);
 
-            mlir::Value directionIV = create.math.constant(
-                rewriter.getIndexType(), (direction == REVERSE) ? 0 : 1);
             mlir::Value sequenceSize =
                 (!mlir::ShapedType::isDynamic(sequenceDimSize))
                     ? create.math.constant(
@@ -221,18 +417,34 @@ struct ONNXRNNOpLowering : public mlir::OpConversionPattern<RNNOp> {
             mlir::Value reverseSequenceIV =
                 rewriter.create<mlir::AffineApplyOp>(loc, reverseIVMap,
                     std::vector<mlir::Value>{loopInd[0], sequenceSize});
-            // Get a slice of X at the current timestep.
-            mlir::Value Xt = emitXSliceAt(rewriter, loc, X, reverseSequenceIV);
+            // Get the projection of X at the current timestep.
+            mlir::Value XtWT = emitInputProjectionAt(
+                rewriter, loc, X, WT, XWT, reverseSequenceIV);
             // Emit calculation for one RNN step.
-            calculateState<S, A, W, B>(rewriter, loc, Xt, state,
+            calculateState<S, A, W, B>(rewriter, loc, XtWT, state,
                 activationReverse, weightReverse, biasReverse,
                 reverseSequenceIV, directionIV,
-                /*isForward=*/false);
+                /*isForward=*/false, parallelBatch);
           });
+    };
+
+    if (direction == BIDIRECTIONAL && enableParallel) {
+      // The two directions are independent until their outputs are
+      // concatenated.
+      emitDirectionsInParallel(rewriter, loc, emitForward, emitReverse);
+    } else {
+      if (hasForward)
+        emitForward();
+      if (hasReverse)
+        emitReverse();
     }
 
     std::vector<mlir::Value> outputs;
     stateToOutput<RNNOp, S>(rewriter, loc, &rnnOp, state, outputs);
+    if (ragged)
+      for (mlir::Value &output : outputs)
+        output =
+            emitRaggedOutput(rewriter, loc, output, raggedBatch, direction);
     rewriter.replaceOp(op, outputs);
     return mlir::success();
   }
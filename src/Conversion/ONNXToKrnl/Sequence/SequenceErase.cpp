@@ -74,8 +74,8 @@ struct ONNXSequenceEraseOpLowering
         [&](KrnlBuilder createKrnl, ValueRange indicesLoopInd) {
           Value element =
               createKrnl.load(adaptor.getInputSequence(), indicesLoopInd[0]);
-          createKrnl.seqstore(element, alloc, positionIE);
-          // createKrnl.store(element, alloc, indicesLoopInd[0]);
+          createKrnl.seqstore(
+              element, alloc, indicesLoopInd[0], /*copy=*/false);
         });
 
     // Copy the elements after the position
@@ -90,7 +90,7 @@ struct ONNXSequenceEraseOpLowering
               createKrnl.load(adaptor.getInputSequence(), indicesLoopInd[0]);
           Value oneIndex = create.math.constantIndex(1);
           Value outputIndex = create.math.sub(indicesLoopInd[0], oneIndex);
-          createKrnl.seqstore(element, alloc, outputIndex);
+          createKrnl.seqstore(element, alloc, outputIndex, /*copy=*/false);
         });
 
     rewriter.replaceOp(op, alloc);
@@ -86,13 +86,13 @@ struct ONNXSequenceInsertOpLowering
           [&](KrnlBuilder createKrnl, ValueRange indicesLoopInd) {
             auto element =
                 createKrnl.load(adaptor.getInputSequence(), indicesLoopInd[0]);
-            createKrnl.seqstore(element, alloc, positionIE);
-            // createKrnl.store(element, alloc, indicesLoopInd[0]);
+            createKrnl.seqstore(
+                element, alloc, indicesLoopInd[0], /*copy=*/false);
           });
 
       // Copy the elements after the position
       SmallVector<IndexExpr, 1> lbs1;
-      lbs1.emplace_back(positionIE + 1);
+      lbs1.emplace_back(positionIE);
       SmallVector<IndexExpr, 1> ubs1;
       ubs1.emplace_back(boundIE);
       ValueRange secondLoopDef = createKrnl.defineLoops(1);
@@ -102,7 +102,7 @@ struct ONNXSequenceInsertOpLowering
                 createKrnl.load(adaptor.getInputSequence(), indicesLoopInd[0]);
             auto oneIndex = create.math.constantIndex(1);
             auto outputIndex = create.math.add(indicesLoopInd[0], oneIndex);
-            createKrnl.seqstore(element, alloc, outputIndex);
+            createKrnl.seqstore(element, alloc, outputIndex, /*copy=*/false);
           });
     }
 
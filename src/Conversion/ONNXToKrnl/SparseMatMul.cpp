@@ -0,0 +1,213 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//====----------- SparseMatMul.cpp - Block-Sparse Constant Weights --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the conversion of the pruned constant weights of matrix
+// multiplications to a block-sparse form, and the lowering of their products
+// to Krnl, SCF and vector ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/SparseMatMul.hpp"
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ElementsAttr/ElementsAttrHelper.hpp"
+
+#include "llvm/Support/Debug.h"
+
+#include <limits>
+
+#define DEBUG_TYPE "sparse_matmul"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+// Return the elements of a constant, either an ONNXConstantOp or the
+// krnl.global it was lowered to, or nullptr. The elements are dense or
+// disposable ones.
+static ElementsAttr getConstantElements(Value value) {
+  Operation *definingOp = value.getDefiningOp();
+  if (auto castOp = dyn_cast_or_null<UnrealizedConversionCastOp>(definingOp)) {
+    if (castOp.getNumOperands() != 1)
+      return nullptr;
+    definingOp = castOp.getOperand(0).getDefiningOp();
+  }
+  if (auto globalOp = dyn_cast_or_null<KrnlGlobalOp>(definingOp)) {
+    if (globalOp.getValue().has_value())
+      return globalOp.getValueAttr().dyn_cast<ElementsAttr>();
+  } else if (auto constOp = dyn_cast_or_null<ONNXConstantOp>(definingOp)) {
+    if (constOp.getValue().has_value())
+      return constOp.getValueAttr().dyn_cast<ElementsAttr>();
+  }
+  return nullptr;
+}
+
+Optional<BlockSparseMatrix> getBlockSparseConstant(Value B, bool bTrans,
+    int64_t blockCols, int64_t thresholdPercent, float alpha) {
+  if (thresholdPercent <= 0 || thresholdPercent > 100 || blockCols < 1)
+    return std::nullopt;
+  // Splat weights, such as zeros, are left to the dense lowering.
+  ElementsAttr bAttr = getConstantElements(B);
+  if (!bAttr || bAttr.isSplat() || !bAttr.getElementType().isF32() ||
+      bAttr.getShapedType().getRank() != 2)
+    return std::nullopt;
+  ArrayRef<int64_t> bShape = bAttr.getShapedType().getShape();
+  BlockSparseMatrix sparse;
+  sparse.K = bTrans ? bShape[1] : bShape[0];
+  sparse.J = bTrans ? bShape[0] : bShape[1];
+  sparse.blockCols = blockCols;
+  int64_t numPanels = sparse.getNumPanels();
+  int64_t totalBlocks = numPanels * sparse.K;
+  if (sparse.J % blockCols != 0 || totalBlocks == 0 ||
+      totalBlocks > std::numeric_limits<int32_t>::max())
+    return std::nullopt;
+
+  // Keep the blocks with a nonzero value, NaNs included.
+  ArrayBuffer<float> bBuffer = getElementsArray<float>(bAttr);
+  ArrayRef<float> bValues = bBuffer.get();
+  std::vector<float> block(blockCols);
+  sparse.panelOffsets.emplace_back(0);
+  for (int64_t p = 0; p < numPanels; ++p) {
+    for (int64_t k = 0; k < sparse.K; ++k) {
+      bool isZero = true;
+      for (int64_t c = 0; c < blockCols; ++c) {
+        int64_t j = p * blockCols + c;
+        block[c] = bValues[bTrans ? j * sparse.K + k : k * sparse.J + j];
+        isZero &= block[c] == 0.0f;
+      }
+      if (isZero)
+        continue;
+      sparse.blockRows.emplace_back(k);
+      for (float value : block)
+        sparse.blockValues.emplace_back(alpha * value);
+    }
+    sparse.panelOffsets.emplace_back(sparse.getNumBlocks());
+  }
+  int64_t numZeroBlocks = totalBlocks - sparse.getNumBlocks();
+  LLVM_DEBUG(llvm::dbgs() << "Sparse matmul: " << numZeroBlocks << " of "
+                          << totalBlocks << " blocks of 1x" << blockCols
+                          << " are zero\n");
+  if (numZeroBlocks * 100 < thresholdPercent * totalBlocks)
+    return std::nullopt;
+  return sparse;
+}
+
+void emitBlockSparseMatMul(ConversionPatternRewriter &rewriter, Location loc,
+    Value A, bool aTrans, const BlockSparseMatrix &B, Value C,
+    bool enableParallel) {
+  MultiDialectBuilder<KrnlBuilder, MemRefBuilder, MathBuilder, SCFBuilder>
+      create(rewriter, loc);
+  MemRefType cType = C.getType().cast<MemRefType>();
+  Type elementType = cType.getElementType();
+  int64_t cRank = cType.getRank();
+  int64_t VL = B.blockCols;
+  int64_t numPanels = B.getNumPanels();
+  VectorType vecType = VectorType::get({VL}, elementType);
+
+  // The blocks are kept in krnl.globals, with at least one block so that the
+  // globals are not empty when all the weights are zero.
+  int64_t numBlocks = std::max<int64_t>(B.getNumBlocks(), 1);
+  std::vector<int32_t> blockRows(B.blockRows);
+  std::vector<float> blockValues(B.blockValues);
+  blockRows.resize(numBlocks, 0);
+  blockValues.resize(numBlocks * VL, 0.0f);
+  Type i32Type = rewriter.getI32Type();
+  MemRefType offsetsType = MemRefType::get({numPanels + 1}, i32Type);
+  MemRefType rowsType = MemRefType::get({numBlocks}, i32Type);
+  MemRefType valuesType = MemRefType::get({numBlocks, VL}, elementType);
+  auto getAttr = [](MemRefType type, auto values) {
+    return DenseElementsAttr::get(
+        RankedTensorType::get(type.getShape(), type.getElementType()),
+        llvm::makeArrayRef(values));
+  };
+  Value offsetsGlobal = create.krnl.constant(
+      offsetsType, "sparse_offsets_", getAttr(offsetsType, B.panelOffsets));
+  Value rowsGlobal = create.krnl.constant(
+      rowsType, "sparse_rows_", getAttr(rowsType, blockRows));
+  Value valuesGlobal = create.krnl.constant(
+      valuesType, "sparse_values_", getAttr(valuesType, blockValues));
+
+  Value zero = create.math.constantIndex(0);
+  Value one = create.math.constantIndex(1);
+  Value vecLen = create.math.constantIndex(VL);
+  Value fZero = create.math.constant(elementType, 0);
+  SmallVector<Value, 4> rowUbs;
+  for (int64_t d = 0; d < cRank - 1; ++d)
+    rowUbs.emplace_back(create.mem.dim(C, d));
+
+  // Compute the panels [pLB, pUB) of all the rows of C, each vector of C
+  // being the sum of the blocks of its panel times the elements of A in their
+  // rows, carried by the loop over the blocks.
+  auto emitPanels = [&](KrnlBuilder &createKrnl, Value pLB, Value pUB) {
+    SmallVector<Value, 4> lbs(cRank - 1, zero), ubs(rowUbs);
+    lbs.emplace_back(pLB);
+    ubs.emplace_back(pUB);
+    ValueRange loopDef = createKrnl.defineLoops(cRank);
+    createKrnl.iterate(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &createKrnl, ValueRange indices) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+              createKrnl);
+          Value p = indices[cRank - 1];
+          Value begin =
+              create.math.castToIndex(create.krnl.load(offsetsGlobal, {p}));
+          Value end = create.math.castToIndex(
+              create.krnl.load(offsetsGlobal, {create.math.add(p, one)}));
+          auto accumulate = [&](OpBuilder &forBuilder, Location forLoc,
+                                Value b, ValueRange sums) {
+            MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+                forBuilder, forLoc);
+            Value k =
+                create.math.castToIndex(create.krnl.load(rowsGlobal, {b}));
+            SmallVector<Value, 4> aIndices;
+            if (aTrans) {
+              aIndices = {k, indices[0]};
+            } else {
+              aIndices.append(indices.begin(), indices.end() - 1);
+              aIndices.emplace_back(k);
+            }
+            Value a = create.vec.splat(vecType, create.krnl.load(A, aIndices));
+            Value bVec = create.vec.load(vecType, valuesGlobal, {b, zero});
+            forBuilder.create<scf::YieldOp>(
+                forLoc, create.vec.fma(a, bVec, sums[0]));
+          };
+          Value sum = createKrnl.getBuilder()
+                          .create<scf::ForOp>(createKrnl.getLoc(), begin, end,
+                              one, ValueRange{create.vec.splat(vecType, fZero)},
+                              accumulate)
+                          .getResult(0);
+          SmallVector<Value, 4> cIndices(indices.begin(), indices.end() - 1);
+          cIndices.emplace_back(create.math.mul(p, vecLen));
+          create.vec.store(sum, C, cIndices);
+        });
+  };
+
+  // The panels are distributed among the threads, each one hosting its Krnl
+  // loops in a krnl.region for the parallel induction variable to be a valid
+  // affine symbol.
+  Value numPanelsVal = create.math.constantIndex(numPanels);
+  if (enableParallel && numPanels > 1) {
+    create.scf.parallelLoop({zero}, {numPanelsVal}, {one},
+        [&](SCFBuilder &createSCF, ValueRange parIndices) {
+          OpBuilder &builder = createSCF.getBuilder();
+          Location loc = createSCF.getLoc();
+          KrnlRegionOp regionOp = builder.create<KrnlRegionOp>(loc);
+          OpBuilder::InsertionGuard insertGuard(builder);
+          builder.setInsertionPointToStart(&regionOp.getBodyRegion().front());
+          MultiDialectBuilder<KrnlBuilder, MathBuilder> create(builder, loc);
+          emitPanels(create.krnl, parIndices[0],
+              create.math.add(parIndices[0], one));
+        });
+  } else {
+    emitPanels(create.krnl, zero, numPanelsVal);
+  }
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//====----------- SparseMatMul.hpp - Block-Sparse Constant Weights --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the declaration of the block-sparse form of the constant
+// weights of matrix multiplications, and of the lowering of their products.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/Optional.h"
+
+#include <vector>
+
+namespace onnx_mlir {
+
+/// Constant K x J matrix B of f32 values whose blocks of 1 x blockCols
+/// elements, along J, are dropped when they are all zero. The J / blockCols
+/// panels of blockCols columns are stored one after the other: the blocks of
+/// panel p are the blocks panelOffsets[p] to panelOffsets[p+1] excluded, in
+/// increasing rows, with the row of block b at blockRows[b] and its values at
+/// blockValues[b * blockCols] to blockValues[(b + 1) * blockCols] excluded.
+struct BlockSparseMatrix {
+  int64_t K = 0;
+  int64_t J = 0;
+  int64_t blockCols = 0;
+  std::vector<int32_t> panelOffsets;
+  std::vector<int32_t> blockRows;
+  std::vector<float> blockValues;
+
+  int64_t getNumPanels() const { return J / blockCols; }
+  int64_t getNumBlocks() const { return blockRows.size(); }
+};
+
+/// Return the block-sparse form of the constant B, transposed when bTrans and
+/// scaled by alpha, when it is a rank 2 f32 constant whose columns are a
+/// multiple of blockCols and whose percentage of zero blocks is at least
+/// thresholdPercent, and std::nullopt otherwise.
+llvm::Optional<BlockSparseMatrix> getBlockSparseConstant(mlir::Value B,
+    bool bTrans, int64_t blockCols, int64_t thresholdPercent,
+    float alpha = 1.0f);
+
+/// Emit C = A * B for the block-sparse B, A being a matrix of rank at least 2
+/// whose leading dimensions are batches shared with C, or a transposed K x I
+/// matrix when aTrans. Each vector of blockCols elements of C is accumulated
+/// over the nonzero blocks of its panel, the panels being computed in
+/// parallel when enableParallel. C is fully written.
+void emitBlockSparseMatMul(mlir::ConversionPatternRewriter &rewriter,
+    mlir::Location loc, mlir::Value A, bool aTrans, const BlockSparseMatrix &B,
+    mlir::Value C, bool enableParallel);
+
+} // namespace onnx_mlir
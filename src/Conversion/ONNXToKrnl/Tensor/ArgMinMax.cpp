@@ -38,9 +38,13 @@ inline Value getCondition<ONNXArgMaxOp>(
 template <typename ARG_OP>
 struct ONNXArgMinMaxOpLowering : public OpConversionPattern<ARG_OP> {
   using OpAdaptor = typename ARG_OP::Adaptor;
+  bool enableSIMD;
+  bool enableParallel;
 
-  ONNXArgMinMaxOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern<ARG_OP>(typeConverter, ctx) {}
+  ONNXArgMinMaxOpLowering(TypeConverter &typeConverter, MLIRContext *ctx,
+      bool enableSIMD, bool enableParallel)
+      : OpConversionPattern<ARG_OP>(typeConverter, ctx),
+        enableSIMD(enableSIMD), enableParallel(enableParallel) {}
 
   LogicalResult matchAndRewrite(ARG_OP argOp, OpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -91,6 +95,26 @@ struct ONNXArgMinMaxOpLowering : public OpConversionPattern<ARG_OP> {
     // Insert alloc and dealloc
     Value alloc = create.mem.alignedAlloc(reducedMemRefType, outputDims);
 
+    // Arg min/max of the rows of large enough static float tensors along the
+    // innermost axis use SIMD code.
+    if (enableSIMD && axis == dataRank - 1 && argOp.getSelectLastIndex() == 0 &&
+        emitSimdArgMinMax(rewriter, loc, data,
+            /*isMin=*/std::is_same<ARG_OP, ONNXArgMinOp>::value,
+            enableParallel,
+            [&](KrnlBuilder &createKrnl, ValueRange outerIndices,
+                Value argIndex) {
+              MathBuilder createMath(createKrnl);
+              SmallVector<Value, 4> outIndices(
+                  outerIndices.begin(), outerIndices.end());
+              if (isKeepdims)
+                outIndices.emplace_back(createMath.constantIndex(0));
+              createKrnl.store(createMath.cast(reducedElementType, argIndex),
+                  alloc, outIndices);
+            })) {
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // Constant Value
     Value minusOne = create.math.constant(reducedElementType, -1);
     Value zero = create.math.constant(reducedElementType, 0);
@@ -155,11 +179,12 @@ struct ONNXArgMinMaxOpLowering : public OpConversionPattern<ARG_OP> {
 };
 
 void populateLoweringONNXArgMinMaxOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD,
+    bool enableParallel) {
   patterns.insert<ONNXArgMinMaxOpLowering<mlir::ONNXArgMinOp>>(
-      typeConverter, ctx);
+      typeConverter, ctx, enableSIMD, enableParallel);
   patterns.insert<ONNXArgMinMaxOpLowering<mlir::ONNXArgMaxOp>>(
-      typeConverter, ctx);
+      typeConverter, ctx, enableSIMD, enableParallel);
 }
 
 } // namespace onnx_mlir
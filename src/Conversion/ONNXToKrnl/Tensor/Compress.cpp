@@ -19,10 +19,17 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum number of elements of a static input for which the input is
+// compressed by blocks of conditions in parallel.
+static constexpr int64_t kCompressParallelMinElements = 4096;
+
 struct ONNXCompressOpLowering : public OpConversionPattern<ONNXCompressOp> {
+  bool enableParallel;
 
-  ONNXCompressOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXCompressOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableParallel(enableParallel) {}
 
   LogicalResult matchAndRewrite(ONNXCompressOp compressOp,
       ONNXCompressOpAdaptor adaptor,
@@ -51,31 +58,40 @@ struct ONNXCompressOpLowering : public OpConversionPattern<ONNXCompressOp> {
     LiteralIndexExpr zeroIE(0), oneIE(1);
 
     // First compute how many "true" values there are along the condition, as
-    // this defines the dynamic dimension pointed to by axis.
-    // Create temp memory for summing up the true value and init to zero.
+    // this defines the dynamic dimension pointed to by axis. With
+    // parallelization, the runtime counts them by blocks of conditions, and
+    // later copies the input of the blocks in parallel.
+    Value condMemRef = adaptor.getCondition();
+    bool parallel =
+        isParallelProfitable(inputMemRef.getType().cast<MemRefType>());
     Type indexType = rewriter.getIndexType();
     MemRefType indexMemRefType = MemRefType::get({}, indexType);
-    Value sumMemRef = create.mem.alloca(indexMemRefType);
-    create.krnl.store(zeroIE.getValue(), sumMemRef);
-    // Now create a loop to iterate over all conditions.
-    Value condMemRef = adaptor.getCondition();
-    IndexExpr condShapeFirstRank = create.krnlIE.getShapeAsDim(condMemRef, 0);
-    ValueRange loopDef = create.krnl.defineLoops(1);
-    create.krnl.iterateIE(loopDef, loopDef, {zeroIE}, {condShapeFirstRank},
-        [&](KrnlBuilder createKrnl, ValueRange loopInd) {
-          MathBuilder createMath(createKrnl);
-          // Load the condition
-          Value currCond = createKrnl.load(condMemRef, loopInd); // Type i1.
-          Value isOn = createMath.neq(currCond, falseVal);       // Compare i1s.
-          Value inc =
-              createMath.select(isOn, oneIE.getValue(), zeroIE.getValue());
-          Value oldSum = createKrnl.load(sumMemRef);
-          Value newSum = createMath.add(oldSum, inc); // Increment by 0 or 1.
-          createKrnl.store(newSum, sumMemRef);
-        });
+    Value sumMemRef, offsets, sum;
+    if (parallel) {
+      offsets = emitNonZeroCount(rewriter, loc, condMemRef, sum);
+    } else {
+      // Create temp memory for summing up the true value and init to zero.
+      sumMemRef = create.mem.alloca(indexMemRefType);
+      create.krnl.store(zeroIE.getValue(), sumMemRef);
+      // Now create a loop to iterate over all conditions.
+      IndexExpr condShapeFirstRank = create.krnlIE.getShapeAsDim(condMemRef, 0);
+      ValueRange loopDef = create.krnl.defineLoops(1);
+      create.krnl.iterateIE(loopDef, loopDef, {zeroIE}, {condShapeFirstRank},
+          [&](KrnlBuilder createKrnl, ValueRange loopInd) {
+            MathBuilder createMath(createKrnl);
+            // Load the condition
+            Value currCond = createKrnl.load(condMemRef, loopInd); // Type i1.
+            Value isOn = createMath.neq(currCond, falseVal); // Compare i1s.
+            Value inc =
+                createMath.select(isOn, oneIE.getValue(), zeroIE.getValue());
+            Value oldSum = createKrnl.load(sumMemRef);
+            Value newSum = createMath.add(oldSum, inc); // Increment by 0 or 1.
+            createKrnl.store(newSum, sumMemRef);
+          });
+      sum = create.krnl.load(sumMemRef);
+    }
 
     // Now replace questionmark by actual computed size.
-    Value sum = create.krnl.load(sumMemRef);
     DimIndexExpr dynDim(sum);
     if (!axis.has_value()) {
       shapeHelper.getOutputDims()[0] = dynDim;
@@ -95,6 +111,20 @@ struct ONNXCompressOpLowering : public OpConversionPattern<ONNXCompressOp> {
     Value alloc =
         create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
 
+    if (parallel) {
+      int64_t axisValue = -1;
+      if (axis.has_value())
+        axisValue =
+            (axis.value() >= 0) ? axis.value() : axis.value() + inputRank;
+      Value valAxis =
+          create.math.constant(rewriter.getIntegerType(64), axisValue);
+      SmallVector<Value, 4> callOperands = {
+          inputMemRef, condMemRef, offsets, valAxis};
+      rewriter.create<KrnlCallOp>(loc, "omTensorCompress", alloc, callOperands);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // Perform the copy depending on the conditions.
     // We will store the current index to write into the output array in
     // indexMemRef. We reuse here the same memref as used to sum the true
@@ -271,11 +301,19 @@ struct ONNXCompressOpLowering : public OpConversionPattern<ONNXCompressOp> {
     rewriter.replaceOp(op, alloc);
     return success();
   }
+
+  bool isParallelProfitable(MemRefType inputType) const {
+    if (!enableParallel)
+      return false;
+    if (!inputType.hasStaticShape())
+      return true;
+    return inputType.getNumElements() >= kCompressParallelMinElements;
+  }
 };
 
 void populateLoweringONNXCompressOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXCompressOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
+  patterns.insert<ONNXCompressOpLowering>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
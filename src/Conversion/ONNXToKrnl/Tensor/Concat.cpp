@@ -24,6 +24,101 @@ struct ONNXConcatOpLowering : public OpConversionPattern<ONNXConcatOp> {
   ONNXConcatOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
       : OpConversionPattern(typeConverter, ctx) {}
 
+  // Determine if the inputs of the concat can be computed in place in its
+  // output. The shapes must be static and the dims before the axis of size 1,
+  // so that each input is a contiguous range of the output, and each input
+  // must be a buffer allocated in this block for the concat only.
+  static bool canConcatInPlace(ONNXConcatOp concatOp, ValueRange operands,
+      MemRefType outputMemRefType, unsigned int axis) {
+    Type elementType = outputMemRefType.getElementType();
+    if (!outputMemRefType.hasStaticShape() ||
+        !outputMemRefType.getLayout().isIdentity() ||
+        !elementType.isIntOrFloat() ||
+        elementType.getIntOrFloatBitWidth() % 8 != 0)
+      return false;
+    for (unsigned int r = 0; r < axis; ++r)
+      if (outputMemRefType.getShape()[r] != 1)
+        return false;
+    // A returned output would be a view of the buffer.
+    for (Operation *user : concatOp.getResult().getUsers())
+      if (user->hasTrait<OpTrait::ReturnLike>())
+        return false;
+    SmallPtrSet<Operation *, 4> allocs;
+    for (unsigned int i = 0; i < operands.size(); ++i) {
+      auto allocOp = operands[i].getDefiningOp<memref::AllocOp>();
+      if (!allocOp || allocOp->getBlock() != concatOp->getBlock() ||
+          !allocOp.getType().hasStaticShape() ||
+          !allocOp.getType().getLayout().isIdentity() ||
+          !concatOp.getOperand(i).hasOneUse() ||
+          !allocs.insert(allocOp).second)
+        return false;
+    }
+    return true;
+  }
+
+  // Allocate the output of the concat as a buffer of bytes, and replace the
+  // allocs of the inputs by views of their range in the buffer, so that the
+  // inputs are written directly into the output.
+  static Value emitConcatInPlace(ConversionPatternRewriter &rewriter,
+      Location loc, ValueRange operands, MemRefType outputMemRefType,
+      int64_t alignment) {
+    MultiDialectBuilder<MemRefBuilder> create(rewriter, loc);
+    int64_t elementBytes =
+        outputMemRefType.getElementType().getIntOrFloatBitWidth() / 8;
+    Operation *firstAlloc = nullptr;
+    for (Value operand : operands) {
+      Operation *allocOp = operand.getDefiningOp();
+      if (!firstAlloc || allocOp->isBeforeInBlock(firstAlloc))
+        firstAlloc = allocOp;
+    }
+    Value buffer;
+    {
+      OpBuilder::InsertionGuard insertGuard(rewriter);
+      rewriter.setInsertionPoint(firstAlloc);
+      buffer = create.mem.alignedAlloc(
+          MemRefType::get({outputMemRefType.getNumElements() * elementBytes},
+              rewriter.getIntegerType(8)),
+          alignment);
+    }
+    int64_t byteOffset = 0;
+    for (Value operand : operands) {
+      auto allocOp = operand.getDefiningOp<memref::AllocOp>();
+      MemRefType inputType = allocOp.getType();
+      OpBuilder::InsertionGuard insertGuard(rewriter);
+      rewriter.setInsertionPoint(allocOp);
+      Value view = create.mem.view(buffer, byteOffset, inputType, {});
+      rewriter.replaceOp(allocOp, view);
+      byteOffset += inputType.getNumElements() * elementBytes;
+    }
+    return create.mem.view(buffer, 0, outputMemRefType, {});
+  }
+
+  // Concatenate shapes by storing their elements one by one, read as scalars
+  // from the inputs when they are shapes computed in this function too, so
+  // that the users of the output also read the scalars.
+  static Value emitConcatOfShapes(ConversionPatternRewriter &rewriter,
+      Location loc, ValueRange operands, MemRefType outputMemRefType,
+      DimsExpr &outputDims, int64_t alignment) {
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, outputDims, alignment);
+    Type elementType = outputMemRefType.getElementType();
+    int64_t position = 0;
+    for (Value operand : operands) {
+      int64_t size = operand.getType().cast<MemRefType>().getShape()[0];
+      for (int64_t i = 0; i < size; ++i) {
+        IndexExprScope scope(&rewriter, loc);
+        Value val =
+            create.krnlIE.getIntFromArrayAsSymbol(operand, i).getValue();
+        create.krnl.storeIE(create.math.cast(elementType, val), alloc,
+            {LiteralIndexExpr(position++)});
+      }
+    }
+    return alloc;
+  }
+
   LogicalResult matchAndRewrite(ONNXConcatOp concatOp,
       ONNXConcatOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -55,6 +150,21 @@ struct ONNXConcatOpLowering : public OpConversionPattern<ONNXConcatOp> {
     // Alloc and dealloc.
     int64_t alignment =
         KrnlTypeConverter::getDefaultAllocAlignment(outputTensorType);
+    if (isShapeLikeMemRef(outputMemRefType) &&
+        llvm::all_of(operands, [](Value operand) {
+          return operand.getType().cast<MemRefType>().hasStaticShape();
+        })) {
+      Value alloc = emitConcatOfShapes(rewriter, loc, operands,
+          outputMemRefType, shapeHelper.getOutputDims(), alignment);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+    if (canConcatInPlace(concatOp, operands, outputMemRefType, axis)) {
+      Value alloc = emitConcatInPlace(
+          rewriter, loc, operands, outputMemRefType, alignment);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
     Value alloc = create.mem.alignedAlloc(
         outputMemRefType, shapeHelper.getOutputDims(), alignment);
 
@@ -72,13 +182,23 @@ struct ONNXConcatOpLowering : public OpConversionPattern<ONNXConcatOp> {
       // symbol
       Value accumulatedOffsetValue = accumulatedOffset.getValue();
       OpBuilder::InsertionGuard insertGuard(rewriter);
-      // Create loop.
-      ValueRange loopDef = create.krnl.defineLoops(rank);
       SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
       SmallVector<IndexExpr, 4> ubs;
       create.krnlIE.getShapeAsDims(operands[i], ubs);
       // For each input, only the dimension 'axis' is different
       commonUB[axis] = ubs[axis];
+      // Copy the contiguous runs of the input with memcpy when possible.
+      SmallVector<IndexExpr, 4> writeStarts(rank, LiteralIndexExpr(0));
+      writeStarts[axis] = accumulatedOffset;
+      if (canEmitBulkCopy(operands[i], lbs, alloc, writeStarts, commonUB)) {
+        emitBulkCopy(
+            rewriter, loc, operands[i], lbs, alloc, writeStarts, commonUB);
+        accumulatedOffset = accumulatedOffset +
+                            create.krnlIE.getShapeAsDim(operands[i], axis);
+        continue;
+      }
+      // Create loop.
+      ValueRange loopDef = create.krnl.defineLoops(rank);
       create.krnl.iterateIE(loopDef, loopDef, lbs, commonUB,
           [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
             // Indices for the read and write.
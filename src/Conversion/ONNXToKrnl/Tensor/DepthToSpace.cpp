@@ -15,9 +15,6 @@
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 #include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
-#include "llvm/Support/Debug.h"
-
-#define DEBUG_TYPE "depth_to_space_onnx_to_krnl"
 
 using namespace mlir;
 
@@ -36,8 +33,8 @@ struct ONNXDepthToSpaceOpLowering
     ValueRange operands = adaptor.getOperands();
     Value input = adaptor.getInput();
 
-    MultiDialectBuilder<IndexExprBuilderForKrnl, OnnxToKrnlBuilder> create(
-        rewriter, loc);
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+        create(rewriter, loc);
 
     // Get shape.
     ONNXDepthToSpaceOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
@@ -47,52 +44,43 @@ struct ONNXDepthToSpaceOpLowering
     StringRef mode = depthToSpaceOp.getMode();
     assert(create.krnlIE.getShapedTypeRank(input) == 4 &&
            "Input tensor should have rank equal to 4");
-
-    // Compute the new dimensions.
-
-    DimIndexExpr B(create.krnlIE.getShapeAsDim(input, 0));
-    DimIndexExpr C(create.krnlIE.getShapeAsDim(input, 1));
-    DimIndexExpr H(create.krnlIE.getShapeAsDim(input, 2));
-    DimIndexExpr W(create.krnlIE.getShapeAsDim(input, 3));
-    DimIndexExpr newC = C.floorDiv(bs * bs);
-    DimIndexExpr newH = H * bs;
-    DimIndexExpr newW = W * bs;
-
-    // Compute the output dimension of the first reshape operation, and the
-    // permutation array for the transpose operation.
-    LiteralIndexExpr bsLit(bs);
-    SmallVector<DimIndexExpr, 6> outputDims1;
-    SmallVector<int64_t, 6> perm;
-    if (mode == "DCR") {
-      outputDims1 = {B, bsLit, bsLit, newC, H, W};
-      perm = {0, 3, 4, 1, 5, 2};
-    } else {
-      assert(mode == "CRD" && "Unexpected mode");
-      outputDims1 = {B, newC, bsLit, bsLit, H, W};
-      perm = {0, 1, 4, 2, 5, 3};
-    }
-
-    // OnnxToKrnlBuilder create(rewriter, loc);
-
-    // Reshape input tensor to shape:
-    //   [B, bs, bs, C/(bs*bs), H, W] when mode=DCR
-    //   [B, C/(bs*bs), bs, bs, H, W] when mode=CRD
-    Value reshapeRes1 = create.krnlOnnx.reshape(input, outputDims1);
-    LLVM_DEBUG(llvm::dbgs() << "reshapeRes1: " << reshapeRes1 << "\n");
-
-    // Transpose the reshape result into shape [B, C/(bs*bs), H, bs, W, bs].
-    SmallVector<DimIndexExpr> outputDims2({B, newC, H, bsLit, W, bsLit});
-    Value transposeRes =
-        create.krnlOnnx.transpose(reshapeRes1, perm, outputDims2);
-    LLVM_DEBUG(llvm::dbgs() << "transposeRes: " << transposeRes << "\n");
-
-    // Reshape the transpose result into shape [B, C/(bs*bs), H*bs, W*bs].
-    SmallVector<DimIndexExpr> outputDims3({B, newC, newH, newW});
-    Value reshapeRes2 = create.krnlOnnx.reshape(transposeRes, outputDims3);
-    LLVM_DEBUG(llvm::dbgs() << "reshapeRes2: " << reshapeRes2 << "\n");
-
-    rewriter.replaceOp(op, reshapeRes2);
-
+    assert((mode == "DCR" || mode == "CRD") && "Unexpected mode");
+    bool isDCR = mode == "DCR";
+
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
+
+    // Copy the input in a single pass over the output, without materializing
+    // the transposed [B, C/(bs*bs), H, bs, W, bs] tensor of the definition,
+    // each input index being an affine function of the output indices:
+    //   output[b, c, h * bs + i, w * bs + j] = input[b, c', h, w] with
+    //   c' = (i * bs + j) * C/(bs*bs) + c when mode=DCR
+    //   c' = (c * bs + i) * bs + j when mode=CRD
+    // The output is written contiguously, and each of its rows is read from
+    // bs contiguous rows of the input.
+    DimsExpr outputDims = shapeHelper.getOutputDims();
+    ValueRange loopDef = create.krnl.defineLoops(4);
+    SmallVector<IndexExpr, 4> lbs(4, LiteralIndexExpr(0));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, outputDims,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          IndexExprScope innerScope(createKrnl);
+          DimIndexExpr b(loopInd[0]), c(loopInd[1]), oh(loopInd[2]),
+              ow(loopInd[3]);
+          IndexExpr h = oh.floorDiv(bs), i = oh % bs;
+          IndexExpr w = ow.floorDiv(bs), j = ow % bs;
+          SymbolIndexExpr newC(outputDims[1]);
+          IndexExpr inputC =
+              isDCR ? (i * bs + j) * newC + c : (c * bs + i) * bs + j;
+          Value val = createKrnl.loadIE(input, {b, inputC, h, w});
+          createKrnl.store(val, alloc, loopInd);
+        });
+
+    rewriter.replaceOp(op, alloc);
     return success();
   }
 };
@@ -19,9 +19,251 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum number of elements of the rows of data, namely its dims after axis
+// 0, for which a gather along axis 0 copies whole rows.
+static constexpr int64_t kGatherRowCopyMinSize = 16;
+// Number of indices between the row being copied and the row prefetched.
+static constexpr int64_t kGatherPrefetchDistance = 8;
+
 struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
-  ONNXGatherOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXGatherOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableParallel(enableParallel) {}
+
+  bool enableParallel;
+
+  // Determine if a gather copies whole rows of data, namely when it is along
+  // axis 0 of a data whose rows are contiguous, of a static number of
+  // elements, set in rowSize.
+  static bool isRowGather(
+      Value data, int64_t axis, int64_t indicesRank, int64_t &rowSize) {
+    MemRefType dataType = data.getType().cast<MemRefType>();
+    if (axis != 0 || indicesRank == 0 || !dataType.getLayout().isIdentity())
+      return false;
+    rowSize = 1;
+    for (int64_t dim : dataType.getShape().drop_front()) {
+      if (ShapedType::isDynamic(dim))
+        return false;
+      rowSize *= dim;
+    }
+    return rowSize >= kGatherRowCopyMinSize;
+  }
+
+  // Return the ReduceSum, if any, that is the only user of a row gather and
+  // sums the rows over the last dim of the indices, in which case the two ops
+  // are lowered together as a bag of embeddings. Return null otherwise.
+  static ONNXReduceSumOp getFusibleReduceSum(
+      ONNXGatherOp gatherOp, int64_t indicesRank) {
+    Value result = gatherOp.getResult();
+    if (!result.hasOneUse())
+      return nullptr;
+    auto reduceOp = dyn_cast<ONNXReduceSumOp>(*result.getUsers().begin());
+    if (!reduceOp || reduceOp->getBlock() != gatherOp->getBlock() ||
+        !reduceOp.getResult().getType().isa<RankedTensorType>())
+      return nullptr;
+    ONNXConstantOp axesOp = getONNXConstantOp(reduceOp.getAxes());
+    if (!axesOp)
+      return nullptr;
+    auto axesAttr = axesOp.getValueAttr().dyn_cast_or_null<DenseElementsAttr>();
+    if (!axesAttr || axesAttr.getNumElements() != 1)
+      return nullptr;
+    int64_t outputRank = result.getType().cast<ShapedType>().getRank();
+    int64_t axis = (*axesAttr.getValues<IntegerAttr>().begin()).getInt();
+    axis = axis < 0 ? axis + outputRank : axis;
+    if (axis != indicesRank - 1)
+      return nullptr;
+    return reduceOp;
+  }
+
+  // Load the index at position j of the flattened indices, as a row of data.
+  static Value loadRowIndex(const KrnlBuilder &createKrnl,
+      const MathBuilder &createMath, Value flatIndices, Value j, Value axisDim,
+      bool indicesMayBeNegative) {
+    Value row = createMath.castToIndex(createKrnl.load(flatIndices, {j}));
+    if (indicesMayBeNegative) {
+      Value zero = createMath.constantIndex(0);
+      row = createMath.select(
+          createMath.slt(row, zero), createMath.add(row, axisDim), row);
+    }
+    return row;
+  }
+
+  // Emit the loop over the ids, in parallel when enabled.
+  void emitIdLoop(ConversionPatternRewriter &rewriter, Location loc,
+      Value numIds, function_ref<void(Value)> bodyFn) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, SCFBuilder> create(
+        rewriter, loc);
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    if (enableParallel) {
+      create.scf.parallelLoop({zero}, {numIds}, {one},
+          [&](SCFBuilder &create, ValueRange loopInd) { bodyFn(loopInd[0]); });
+    } else {
+      ValueRange loopDef = create.krnl.defineLoops(1);
+      create.krnl.iterate(loopDef, loopDef, {zero}, {numIds},
+          [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+            bodyFn(loopInd[0]);
+          });
+    }
+  }
+
+  // Gather whole rows of data along axis 0:
+  //   for j = 0 .. numIds:
+  //     prefetch(data[indices[j + kGatherPrefetchDistance]])
+  //     memcpy(out[j], data[indices[j]], rowSize)
+  // where j iterates over the flattened indices. Only the first cache line
+  // of a row is prefetched, the hardware prefetchers following the rest of
+  // it.
+  void emitRowGather(ConversionPatternRewriter &rewriter, Location loc,
+      Value data, Value indices, Value alloc, int64_t rowSize,
+      bool indicesMayBeNegative) const {
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+    int64_t dataRank = data.getType().cast<MemRefType>().getRank();
+    DimsExpr indicesDims;
+    create.krnlIE.getShapeAsSymbols(indices, indicesDims);
+    Value numIds;
+    Value flatIndices = create.mem.reshapeToFlat(indices, indicesDims, numIds);
+    Value axisDim = create.mem.dim(data, 0);
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value lastId = create.math.sub(numIds, one);
+    Value distance = create.math.constantIndex(kGatherPrefetchDistance);
+    Value rowSizeVal = create.math.constantIndex(rowSize);
+    Value rowSizeI64 = create.math.constant(rewriter.getI64Type(), rowSize);
+
+    emitIdLoop(rewriter, loc, numIds, [&](Value j) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+      Value ahead = create.math.min(create.math.add(j, distance), lastId);
+      SmallVector<Value, 4> aheadIndices(dataRank, zero);
+      aheadIndices[0] = loadRowIndex(create.krnl, create.math, flatIndices,
+          ahead, axisDim, indicesMayBeNegative);
+      create.krnl.prefetch(
+          data, aheadIndices, /*isWrite=*/false, /*locality=*/3);
+      Value row = loadRowIndex(create.krnl, create.math, flatIndices, j,
+          axisDim, indicesMayBeNegative);
+      create.krnl.memcpy(alloc, data, rowSizeI64,
+          create.math.mul(j, rowSizeVal), create.math.mul(row, rowSizeVal));
+    });
+  }
+
+  // Sum the gathered rows of each bag of ids, namely each row of the indices
+  // over its last dim of size L, into alloc:
+  //   for b = 0 .. numBags:
+  //     for e = 0 .. rowSize step VL:
+  //       out[b, e] = sum_l data[indices[b * L + l], e]
+  // The elements of the row are computed VL at a time when VL divides the
+  // row size, accumulated in a vector register over the bag.
+  void emitEmbeddingBag(ConversionPatternRewriter &rewriter, Location loc,
+      Value data, Value indices, Value alloc, int64_t rowSize,
+      bool indicesMayBeNegative) const {
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder, VectorBuilder>
+        create(rewriter, loc);
+    MemRefType dataType = data.getType().cast<MemRefType>();
+    Type elementType = dataType.getElementType();
+    int64_t indicesRank = indices.getType().cast<MemRefType>().getRank();
+    DimsExpr indicesDims, dataDims, allocDims;
+    create.krnlIE.getShapeAsSymbols(indices, indicesDims);
+    create.krnlIE.getShapeAsSymbols(data, dataDims);
+    create.krnlIE.getShapeAsSymbols(alloc, allocDims);
+    Value numIds, dataSize, allocSize;
+    Value flatIndices = create.mem.reshapeToFlat(indices, indicesDims, numIds);
+    Value flatData = create.mem.reshapeToFlat(data, dataDims, dataSize);
+    Value flatAlloc = create.mem.reshapeToFlat(alloc, allocDims, allocSize);
+    Value axisDim = create.mem.dim(data, 0);
+    Value bagSize = indicesDims[indicesRank - 1].getValue();
+    IndexExpr numBagsIE = LiteralIndexExpr(1);
+    for (int64_t i = 0; i < indicesRank - 1; ++i)
+      numBagsIE = numBagsIE * indicesDims[i];
+    Value numBags = numBagsIE.getValue();
+    Value zero = create.math.constantIndex(0);
+    Value one = create.math.constantIndex(1);
+    Value rowSizeVal = create.math.constantIndex(rowSize);
+
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    bool simd = elementType.isa<FloatType>() && rowSize % VL == 0;
+    VectorType vecType = VectorType::get({VL}, elementType);
+    Type accType = simd ? Type(vecType) : elementType;
+    Value accZero = create.math.constant(accType, 0);
+
+    emitIdLoop(rewriter, loc, numBags, [&](Value b) {
+      MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+      Value bagStart = create.math.mul(b, bagSize);
+      Value outStart = create.math.mul(b, rowSizeVal);
+      ValueRange loopDef = create.krnl.defineLoops(1);
+      ValueRange optLoopDef =
+          simd ? create.krnl.block(loopDef[0], VL) : loopDef;
+      create.krnl.iterate(loopDef, {optLoopDef[0]}, {zero}, {rowSizeVal},
+          [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+            Value e = loopInd[0];
+            // Accumulate the elements of the rows of the bag.
+            auto accumulate = [&](OpBuilder &forBuilder, Location forLoc,
+                                  Value l, ValueRange args) {
+              MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder>
+                  create(forBuilder, forLoc);
+              Value row = loadRowIndex(create.krnl, create.math, flatIndices,
+                  create.math.add(bagStart, l), axisDim, indicesMayBeNegative);
+              Value pos =
+                  create.math.add(create.math.mul(row, rowSizeVal), e);
+              Value val =
+                  simd ? create.vec.load(vecType, flatData, {pos})
+                       : create.krnl.load(flatData, {pos});
+              forBuilder.create<scf::YieldOp>(
+                  forLoc, create.math.add(args[0], val));
+            };
+            Value sum = createKrnl.getBuilder()
+                            .create<scf::ForOp>(loc, zero, bagSize, one,
+                                ValueRange{accZero}, accumulate)
+                            .getResult(0);
+            MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder>
+                create(createKrnl);
+            Value outPos = create.math.add(outStart, e);
+            if (simd)
+              create.vec.store(sum, flatAlloc, {outPos});
+            else
+              create.krnl.store(sum, flatAlloc, {outPos});
+          });
+    });
+  }
+
+  // Gather the elements of a 1D data, e.g. a shape, at constant indices, by
+  // storing them one by one, read as scalars from the data when it is a shape
+  // computed in this function too, see IndexExprBuilderForKrnl::getVal.
+  // Return null if the indices are not constants.
+  static Value emitGatherOfShape(ConversionPatternRewriter &rewriter,
+      Location loc, Value data, Value indices, MemRefType outputMemRefType) {
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+    IndexExprScope scope(&rewriter, loc);
+    int64_t dataSize = data.getType().cast<MemRefType>().getShape()[0];
+    SmallVector<int64_t, 4> positions;
+    for (int64_t j = 0; j < outputMemRefType.getNumElements(); ++j) {
+      IndexExpr index = create.krnlIE.getIntFromArrayAsSymbol(indices, j);
+      if (!index.isLiteral())
+        return nullptr;
+      int64_t position = index.getLiteral();
+      position = position < 0 ? position + dataSize : position;
+      if (position < 0 || position >= dataSize)
+        return nullptr;
+      positions.emplace_back(position);
+    }
+    Value alloc = create.mem.alignedAlloc(outputMemRefType);
+    Type elementType = outputMemRefType.getElementType();
+    for (auto [j, position] : llvm::enumerate(positions)) {
+      Value val =
+          create.krnlIE.getIntFromArrayAsSymbol(data, position).getValue();
+      SmallVector<IndexExpr, 1> outputIndices;
+      if (outputMemRefType.getRank() == 1)
+        outputIndices.emplace_back(LiteralIndexExpr(j));
+      create.krnl.storeIE(
+          create.math.cast(elementType, val), alloc, outputIndices);
+    }
+    return alloc;
+  }
 
   LogicalResult matchAndRewrite(ONNXGatherOp gatherOp,
       ONNXGatherOpAdaptor adaptor,
@@ -43,10 +285,6 @@ struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
            "Failed to convert type to MemRefType");
     MemRefType outputMemRefType = convertedType.cast<MemRefType>();
 
-    // Insert an allocation and deallocation for the output of this operation.
-    Value alloc =
-        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
-
     // Operands and attributes.
     Value data = adaptor.getData();
     Value indices = adaptor.getIndices();
@@ -60,6 +298,52 @@ struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
     // Negative value means counting dimensions from the back.
     axisLit = axisLit < 0 ? axisLit + dataRank : axisLit;
 
+    // Gather the elements of a shape at constant indices as scalars.
+    if (isShapeLikeMemRef(outputMemRefType) && dataRank == 1 &&
+        data.getType().cast<MemRefType>().hasStaticShape()) {
+      if (Value alloc = emitGatherOfShape(
+              rewriter, loc, data, indices, outputMemRefType)) {
+        rewriter.replaceOp(op, alloc);
+        return success();
+      }
+    }
+
+    // Copy whole rows when gathering along axis 0, and sum them per bag of
+    // ids when the gather is followed by a ReduceSum over the bags.
+    int64_t rowSize;
+    if (isRowGather(data, axisLit, indicesRank, rowSize)) {
+      if (ONNXReduceSumOp reduceOp =
+              getFusibleReduceSum(gatherOp, indicesRank)) {
+        MemRefType reduceMemRefType =
+            typeConverter->convertType(reduceOp.getResult().getType())
+                .cast<MemRefType>();
+        // The dims of the gather output, without the one of the bags or with
+        // it set to 1 when the reduced dims are kept.
+        DimsExpr reduceDims(shapeHelper.getOutputDims());
+        if (reduceOp.getKeepdims() == 1)
+          reduceDims[indicesRank - 1] = LiteralIndexExpr(1);
+        else
+          reduceDims.erase(reduceDims.begin() + indicesRank - 1);
+        Value reduceAlloc =
+            create.mem.alignedAlloc(reduceMemRefType, reduceDims);
+        emitEmbeddingBag(rewriter, loc, data, indices, reduceAlloc, rowSize,
+            indicesMayBeNegative);
+        rewriter.replaceOp(reduceOp, reduceAlloc);
+        rewriter.eraseOp(op);
+        return success();
+      }
+      Value alloc = create.mem.alignedAlloc(
+          outputMemRefType, shapeHelper.getOutputDims());
+      emitRowGather(
+          rewriter, loc, data, indices, alloc, rowSize, indicesMayBeNegative);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
+    // Insert an allocation and deallocation for the output of this operation.
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
+
     int64_t outputRank = shapeHelper.getOutputDims().size();
     int iIndexStart = 0;
     int jIndexStart = iIndexStart + axisLit;
@@ -79,6 +363,9 @@ struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
           for kk in ndindex(Nk):
             out[ii + jj + kk] = data[ii + (indices[jj],) + kk]
     */
+    // Large outputs are stored bypassing the caches.
+    bool nontemporal = useNontemporalStores(outputMemRefType);
+
     // Define loops and iteration trip counts (equivalent to size of output)
     ValueRange loopDef = create.krnl.defineLoops(outputRank);
     DimsExpr lbs(outputRank, zeroIE);
@@ -116,7 +403,7 @@ struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
           Value dataVal = createKrnl.loadIE(data, dataAccessFct);
 
           // Save data into output
-          createKrnl.storeIE(dataVal, alloc, outputAccessFct);
+          createKrnl.storeIE(dataVal, alloc, outputAccessFct, nontemporal);
         });
     rewriter.replaceOp(op, alloc);
     return success();
@@ -124,8 +411,8 @@ struct ONNXGatherOpLowering : public OpConversionPattern<ONNXGatherOp> {
 };
 
 void populateLoweringONNXGatherOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXGatherOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
+  patterns.insert<ONNXGatherOpLowering>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
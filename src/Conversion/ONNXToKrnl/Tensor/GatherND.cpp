@@ -123,7 +123,7 @@ struct ONNXGatherNDOpLowering : public OpConversionPattern<ONNXGatherNDOp> {
     // Allocate a 1D output buffer.
     const int64_t outputDimsSize = std::accumulate(
         outputShape.begin(), outputShape.end(), 1, std::multiplies<int64_t>());
-    Value outputDataBuffer = create.mem.alloc(
+    Value outputDataBuffer = create.mem.alignedAlloc(
         MemRefType::get({outputDimsSize}, outputMemRefType.getElementType()));
 
     // Initialize the index used to store the result values.
@@ -133,6 +133,12 @@ struct ONNXGatherNDOpLowering : public OpConversionPattern<ONNXGatherNDOp> {
         create.mem.alloca(MemRefType::get({}, rewriter.getIndexType()));
     create.krnl.store(iZero, storeIndex);
 
+    // Number of elements of the slices gathered when indices.shape[-1] is less
+    // than (rank(data) - b).
+    int64_t sliceSize = 1;
+    for (int64_t i = b + indicesLastDim; i < dataRank; ++i)
+      sliceSize *= dataShape[i];
+
     // for (i,j) in (0..reshapedIndices.shape[0]), 0..reshapedIndices.shape[1])
     // {
     //   idx = tuple(reshapedIndices[i][j])
@@ -212,37 +218,29 @@ struct ONNXGatherNDOpLowering : public OpConversionPattern<ONNXGatherNDOp> {
                    "rank(indices) - b");
 
             // When indices.shape[-1] is less than (rank(data) - b) the
-            // `reshapedDataAccessFct` computed so far yields a slice which
-            // needs to be inserted into the output buffer.
-            int64_t reshapedDataLastDim = dataShape[dataRank - 1];
-            for (int64_t i = 0; i < reshapedDataLastDim; ++i) {
-              IndexExpr ind = LiteralIndexExpr(i);
-              reshapedDataAccessFct.emplace_back(ind);
-              assert(
-                  (int64_t)reshapedDataAccessFct.size() == reshapedDataRank &&
-                  "Access function should have the same rank as reshapedData");
-
-              if (emitPrintStmts)
-                printIndices("data indices", reshapedDataAccessFct, createKrnl);
-
-              // Gather value from the 'data' tensor and store it into
-              // 'outputDataBuffer'.
-              Value val =
-                  createKrnl.loadIE(reshapedData, reshapedDataAccessFct);
-              reshapedDataAccessFct.pop_back();
-
-              if (emitPrintStmts) {
-                createKrnl.printf("val = ", val, val.getType());
-                createKrnl.printf("\n");
-              }
-
-              Value storeIndexVal = createKrnl.load(storeIndex);
-              createKrnl.store(val, outputDataBuffer, storeIndexVal);
-
-              // Bump up the storeIndex.
-              createKrnl.store(
-                  create.math.add(storeIndexVal, iOne), storeIndex);
-            }
+            // `reshapedDataAccessFct` computed so far yields a slice made of
+            // the last (rank(data) - b - indices.shape[-1]) dims of
+            // 'reshapedData', which is contiguous in 'data' and is copied
+            // whole into 'outputDataBuffer'.
+            IndexExpr srcOffset = reshapedDataAccessFct[0];
+            for (int64_t i = 1; i <= indicesLastDim; ++i)
+              srcOffset = srcOffset * LiteralIndexExpr(dataShape[b + i - 1]) +
+                          reshapedDataAccessFct[i];
+            srcOffset = srcOffset * LiteralIndexExpr(sliceSize);
+
+            if (emitPrintStmts)
+              printIndices("data indices", reshapedDataAccessFct, createKrnl);
+
+            Value sliceSizeVal = create.math.constantIndex(sliceSize);
+            Value sliceSizeI64 =
+                create.math.constant(rewriter.getI64Type(), sliceSize);
+            Value storeIndexVal = createKrnl.load(storeIndex);
+            createKrnl.memcpy(outputDataBuffer, data, sliceSizeI64,
+                storeIndexVal, srcOffset.getValue());
+
+            // Bump up the storeIndex.
+            createKrnl.store(
+                create.math.add(storeIndexVal, sliceSizeVal), storeIndex);
           }
         });
 
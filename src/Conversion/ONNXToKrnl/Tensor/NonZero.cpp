@@ -19,9 +19,17 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum number of elements of a static input for which the nonzero values
+// are computed by blocks in parallel.
+static constexpr int64_t kNonZeroParallelMinElements = 4096;
+
 struct ONNXNonZeroOpLowering : public OpConversionPattern<ONNXNonZeroOp> {
-  ONNXNonZeroOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  bool enableParallel;
+
+  ONNXNonZeroOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel)
+      : OpConversionPattern(typeConverter, ctx),
+        enableParallel(enableParallel) {}
 
   /// Given an input of shape (3, 2):
   /// [[2, 1],
@@ -72,6 +80,11 @@ struct ONNXNonZeroOpLowering : public OpConversionPattern<ONNXNonZeroOp> {
   ///      p = (i < s and p == -1) ? j : p
   ///   out[0][i] = p
   /// ```
+  ///
+  /// With parallelization, the runtime instead counts the nonzero values of
+  /// blocks of the input in parallel, computes the offsets of the blocks in
+  /// the output with a prefix sum, then writes the indices of the nonzero
+  /// values of the blocks in parallel.
 
   LogicalResult matchAndRewrite(ONNXNonZeroOp noneZeroOp,
       ONNXNonZeroOpAdaptor adaptor,
@@ -100,6 +113,19 @@ struct ONNXNonZeroOpLowering : public OpConversionPattern<ONNXNonZeroOp> {
     Type xElementType = xMemRefType.getElementType();
     Type resElementType = resMemRefType.getElementType();
 
+    if (isParallelProfitable(xMemRefType)) {
+      Value numberOfNonZeros;
+      Value offsets = emitNonZeroCount(rewriter, loc, X, numberOfNonZeros);
+      SmallVector<IndexExpr, 2> dimExprs;
+      dimExprs.emplace_back(LiteralIndexExpr(xRank));
+      dimExprs.emplace_back(DimIndexExpr(numberOfNonZeros));
+      Value resMemRef = create.mem.alignedAlloc(resMemRefType, dimExprs);
+      SmallVector<Value, 2> operands = {X, offsets};
+      rewriter.create<KrnlCallOp>(loc, "omTensorNonZero", resMemRef, operands);
+      rewriter.replaceOp(op, resMemRef);
+      return success();
+    }
+
     // Constant values.
     Value iZero = create.math.constantIndex(0);
     Value iOne = create.math.constantIndex(1);
@@ -220,11 +246,24 @@ struct ONNXNonZeroOpLowering : public OpConversionPattern<ONNXNonZeroOp> {
 
     return success();
   }
+
+  // The runtime supports inputs of numbers and bools, which are unlikely to
+  // be worth its parallel loops when small.
+  bool isParallelProfitable(MemRefType inputType) const {
+    if (!enableParallel || inputType.getRank() == 0)
+      return false;
+    Type elementType = inputType.getElementType();
+    if (!elementType.isIntOrFloat())
+      return false;
+    if (!inputType.hasStaticShape())
+      return true;
+    return inputType.getNumElements() >= kNonZeroParallelMinElements;
+  }
 };
 
 void populateLoweringONNXNonZeroOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXNonZeroOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableParallel) {
+  patterns.insert<ONNXNonZeroOpLowering>(typeConverter, ctx, enableParallel);
 }
 
 } // namespace onnx_mlir
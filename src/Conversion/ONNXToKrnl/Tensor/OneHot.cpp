@@ -51,10 +51,14 @@ struct ONNXOneHotOpLowering : public OpConversionPattern<ONNXOneHotOp> {
         create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
 
     // Load off/on vals found in values memref.
-    LiteralIndexExpr minusOneIE(-1), zeroIE(0), oneIE(1);
+    LiteralIndexExpr zeroIE(0), oneIE(1);
     Value offVal = create.krnl.loadIE(values, zeroIE);
     Value onVal = create.krnl.loadIE(values, oneIE);
 
+    // All the values are first set off, after which only the on values are
+    // written, one per input value.
+    create.krnl.memset(alloc, offVal);
+
     // Iterate over all of the inputs.
     int64_t indicesRank = create.krnlIE.getShapedTypeRank(indices);
     SmallVector<IndexExpr, 4> indicesLbs(indicesRank, zeroIE);
@@ -78,37 +82,25 @@ struct ONNXOneHotOpLowering : public OpConversionPattern<ONNXOneHotOp> {
           IndexExpr isNeg = input < zeroIE;
           IndexExpr inputIndex = IndexExpr::select(isNeg, inputNegVal, input);
           // Now compute in inputIndex is still out of bound, in which case all
-          // values are off.
-          IndexExpr isTooSmall = inputIndex < zeroIE;
-          IndexExpr isTooBig = inputIndex >= depth;
-          IndexExpr outOfBound = isTooSmall | isTooBig;
-          // Define here the index that has the on Value. If out of bound, put
-          // -1 here as this value will never occur.
-          IndexExpr onValueIndex =
-              IndexExpr::select(outOfBound, minusOneIE, inputIndex);
-          Value onValueIndexVal = onValueIndex.getValue();
-          // Now we have the index that is on, iterate over the depth values
-          // along axis, and set the right one to the value on.
-          ValueRange depthLoopDef = createKrnl.defineLoops(1);
-          createKrnl.iterateIE(depthLoopDef, depthLoopDef, {zeroIE}, {depth},
-              [&](KrnlBuilder createBuilder, ValueRange depthLoopInd) {
-                MathBuilder createMath(createKrnl);
-                Value onCond = createMath.eq(depthLoopInd[0], onValueIndexVal);
-                Value res = createMath.select(onCond, onVal, offVal);
-                // Output access function is input indices with depth index
-                // spliced in the axis location.
-                SmallVector<Value, 4> outputAccessFct;
-                int64_t dec = 0;
-                for (int64_t i = 0; i < indicesRank + 1; ++i) {
-                  if (i == axis) {
-                    outputAccessFct.emplace_back(depthLoopInd[0]);
-                    dec = 1;
-                  } else {
-                    outputAccessFct.emplace_back(indicesLoopInd[i - dec]);
-                  }
-                }
-                createKrnl.store(res, alloc, outputAccessFct);
-              });
+          // values are left off. Otherwise, write the on value at inputIndex.
+          IndexExpr inBound = (inputIndex >= zeroIE) & (inputIndex < depth);
+          Value onValueIndexVal = inputIndex.getValue();
+          SCFBuilder createSCF(createKrnl);
+          createSCF.ifThenElse(inBound.getValue(), [&](SCFBuilder &createSCF) {
+            // Output access function is input indices with inputIndex
+            // spliced in the axis location.
+            SmallVector<Value, 4> outputAccessFct;
+            int64_t dec = 0;
+            for (int64_t i = 0; i < indicesRank + 1; ++i) {
+              if (i == axis) {
+                outputAccessFct.emplace_back(onValueIndexVal);
+                dec = 1;
+              } else {
+                outputAccessFct.emplace_back(indicesLoopInd[i - dec]);
+              }
+            }
+            KrnlBuilder(createSCF).store(onVal, alloc, outputAccessFct);
+          });
         });
 
     rewriter.replaceOp(op, alloc);
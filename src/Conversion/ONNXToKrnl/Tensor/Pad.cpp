@@ -82,6 +82,14 @@ struct ONNXPadOpLowering : public OpConversionPattern<ONNXPadOp> {
       SmallVector<IndexExpr, 4> lbs(rank, zero);
       SmallVector<IndexExpr, 4> ubs;
       create.krnlIE.getShapeAsDims(data, ubs);
+      // Copy the contiguous runs of the input with memcpy when possible.
+      SmallVector<IndexExpr, 4> padStarts(
+          shapeHelper.pads.begin(), shapeHelper.pads.begin() + rank);
+      if (canEmitBulkCopy(data, lbs, resMemRef, padStarts, ubs)) {
+        emitBulkCopy(rewriter, loc, data, lbs, resMemRef, padStarts, ubs);
+        rewriter.replaceOp(op, resMemRef);
+        return success();
+      }
       ValueRange mainLoopDef = create.krnl.defineLoops(rank);
       create.krnl.iterateIE(mainLoopDef, mainLoopDef, lbs, ubs,
           [&](KrnlBuilder &createKrnl, ValueRange dataLoopInd) {
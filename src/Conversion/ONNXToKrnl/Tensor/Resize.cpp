@@ -19,10 +19,419 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum number of output elements for which the linear and cubic modes are
+// lowered to Krnl loops instead of a call to the runtime.
+static constexpr int64_t kResizeNativeMinOutputSize = 4096;
+
+// Compute, for each of the outLen positions of an axis of the output, the K
+// positions of the input it is interpolated from, clamped into [0, inLen),
+// and their coefficients, with K = 2 for linear and K = 4 for cubic.
+static void computeResizeAxisCoefficients(StringRef mode,
+    StringRef coordinateTransformationMode, float cubicCoeffA, float scale,
+    int64_t inLen, int64_t outLen, SmallVectorImpl<int64_t> &indices,
+    SmallVectorImpl<float> &coeffs) {
+  bool cubic = (mode == "cubic");
+  int64_t K = cubic ? 4 : 2;
+  float A = cubicCoeffA;
+  // Cubic convolution kernel for |t| <= 1 and 1 < |t| < 2.
+  auto nearCubic = [&](float t) {
+    return ((A + 2) * t - (A + 3)) * t * t + 1;
+  };
+  auto farCubic = [&](float t) {
+    return ((A * t - 5 * A) * t + 8 * A) * t - 4 * A;
+  };
+  for (int64_t o = 0; o < outLen; ++o) {
+    float x = o;
+    float xOri;
+    if (coordinateTransformationMode == "asymmetric")
+      xOri = x / scale;
+    else if (coordinateTransformationMode == "align_corners")
+      xOri = (outLen == 1) ? 0 : x * (inLen - 1) / (outLen - 1);
+    else if (coordinateTransformationMode == "pytorch_half_pixel")
+      xOri = (outLen == 1) ? 0 : (x + 0.5f) / scale - 0.5f;
+    else // half_pixel
+      xOri = (x + 0.5f) / scale - 0.5f;
+    float xFloor = std::floor(xOri);
+    float ratio = xOri - xFloor;
+    // Leftmost of the K input positions.
+    int64_t first = static_cast<int64_t>(xFloor) - (cubic ? 1 : 0);
+    for (int64_t k = 0; k < K; ++k)
+      indices.emplace_back(
+          std::min(std::max(first + k, (int64_t)0), inLen - 1));
+    if (cubic) {
+      coeffs.emplace_back(farCubic(ratio + 1));
+      coeffs.emplace_back(nearCubic(ratio));
+      coeffs.emplace_back(nearCubic(1 - ratio));
+      coeffs.emplace_back(farCubic(2 - ratio));
+    } else {
+      coeffs.emplace_back(1 - ratio);
+      coeffs.emplace_back(ratio);
+    }
+  }
+}
+
 struct ONNXResizeOpLowering : public OpConversionPattern<ONNXResizeOp> {
   ONNXResizeOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
       : OpConversionPattern(typeConverter, ctx) {}
 
+  // Determine if a linear or cubic resize is lowered to Krnl loops. The
+  // shapes must be static and the scales known at compile time, so that the
+  // coefficients of each axis are precomputed, and the output large enough
+  // for it to pay off over the runtime call.
+  bool useNativeLowering(ONNXResizeOp resizeOp, Value data,
+      MemRefType memRefType, ArrayRef<IndexExpr> scales) const {
+    StringRef mode = resizeOp.getMode();
+    StringRef ctm = resizeOp.getCoordinateTransformationMode();
+    MemRefType dataType = data.getType().cast<MemRefType>();
+    if (mode != "linear" && mode != "cubic")
+      return false;
+    if (ctm != "half_pixel" && ctm != "pytorch_half_pixel" &&
+        ctm != "align_corners" && ctm != "asymmetric")
+      return false;
+    if (resizeOp.getExcludeOutside() != 0)
+      return false;
+    if (!memRefType.getElementType().isF32() || !dataType.hasStaticShape() ||
+        !memRefType.hasStaticShape())
+      return false;
+    if (memRefType.getNumElements() < kResizeNativeMinOutputSize)
+      return false;
+    for (IndexExpr scale : scales)
+      if (!scale.isLiteral())
+        return false;
+    // Some axis must be resized.
+    for (int64_t i = 0; i < memRefType.getRank(); ++i)
+      if (dataType.getShape()[i] != memRefType.getShape()[i] ||
+          scales[i].getFloatLiteral() != 1.0)
+        return true;
+    return false;
+  }
+
+  // Determine if a nearest resize is lowered to the replication of each input
+  // element. The shapes must be static, the scales integers, the ones of the
+  // axes before the two innermost ones 1, and the modes such that output
+  // position o is read from input position o / scale: "floor" for
+  // "asymmetric", or rounding for "half_pixel" and "pytorch_half_pixel",
+  // where (o + 0.5) / scale - 0.5 is strictly within 0.5 of o / scale.
+  bool useNearestIntegerLowering(ONNXResizeOp resizeOp, Value data,
+      MemRefType memRefType, ArrayRef<IndexExpr> scales) const {
+    StringRef ctm = resizeOp.getCoordinateTransformationMode();
+    StringRef nearestMode = resizeOp.getNearestMode();
+    MemRefType dataType = data.getType().cast<MemRefType>();
+    if (resizeOp.getMode() != "nearest")
+      return false;
+    bool floorMode = (ctm == "asymmetric" && nearestMode == "floor");
+    bool roundMode = (ctm == "half_pixel" || ctm == "pytorch_half_pixel") &&
+                     (nearestMode == "round_prefer_floor" ||
+                         nearestMode == "round_prefer_ceil");
+    if (!floorMode && !roundMode)
+      return false;
+    if (!dataType.hasStaticShape() || !memRefType.hasStaticShape())
+      return false;
+    if (memRefType.getNumElements() < kResizeNativeMinOutputSize)
+      return false;
+    ArrayRef<int64_t> inShape = dataType.getShape();
+    ArrayRef<int64_t> outShape = memRefType.getShape();
+    int64_t rank = outShape.size();
+    if (rank < 2)
+      return false;
+    for (int64_t i = 0; i < rank; ++i) {
+      if (!scales[i].isLiteral())
+        return false;
+      double scale = scales[i].getFloatLiteral();
+      int64_t intScale = static_cast<int64_t>(scale);
+      if (scale != intScale || intScale < 1 ||
+          (i < rank - 2 && intScale != 1) ||
+          outShape[i] != inShape[i] * intScale)
+        return false;
+    }
+    return true;
+  }
+
+  // Lower a nearest resize by integer scales sH and sW of the two innermost
+  // axes. Each input row is copied into the first of its sH output rows,
+  // VL elements at a time, each vector shuffled into the sW vectors of its
+  // replicated elements. That output row is then copied into the sH - 1
+  // next ones by krnl.memcpy.
+  void emitNearestIntegerResize(ConversionPatternRewriter &rewriter,
+      Location loc, Value data, Value alloc,
+      ArrayRef<IndexExpr> scales) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+        rewriter, loc);
+    MemRefType allocType = alloc.getType().cast<MemRefType>();
+    ArrayRef<int64_t> inShape = data.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> outShape = allocType.getShape();
+    Type elementType = allocType.getElementType();
+    int64_t rank = outShape.size();
+    int64_t sH = scales[rank - 2].getFloatLiteral();
+    int64_t sW = scales[rank - 1].getFloatLiteral();
+    int64_t inW = inShape[rank - 1];
+    int64_t outW = outShape[rank - 1];
+    int64_t VL = create.vec.getMachineVectorLength(elementType);
+    int64_t vecEnd = (VL > 1) ? (inW / VL) * VL : 0;
+    VectorType vecType = VectorType::get({VL}, elementType);
+    // Lanes of the input vector in each of the sW output vectors.
+    SmallVector<SmallVector<int64_t, 16>, 4> masks(sW);
+    for (int64_t j = 0; j < sW; ++j)
+      for (int64_t l = 0; l < VL; ++l)
+        masks[j].emplace_back((j * VL + l) / sW);
+
+    // for each input row:
+    ValueRange loopDef = create.krnl.defineLoops(rank - 1);
+    SmallVector<IndexExpr, 4> lbs(rank - 1, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs;
+    for (int64_t i = 0; i < rank - 1; ++i)
+      ubs.emplace_back(LiteralIndexExpr(inShape[i]));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+              createKrnl);
+          SmallVector<Value, 4> inIndices(loopInd.begin(), loopInd.end());
+          SmallVector<Value, 4> outIndices(loopInd.begin(), loopInd.end());
+          outIndices[rank - 2] = create.math.mul(
+              loopInd[rank - 2], create.math.constantIndex(sH));
+          inIndices.emplace_back(Value());
+          outIndices.emplace_back(Value());
+          Value sWVal = create.math.constantIndex(sW);
+
+          if (vecEnd > 0) {
+            ValueRange vecLoop = create.krnl.defineLoops(1);
+            ValueRange blockedVecLoop = create.krnl.block(vecLoop[0], VL);
+            create.krnl.iterateIE(vecLoop, {blockedVecLoop[0]},
+                {LiteralIndexExpr(0)}, {LiteralIndexExpr(vecEnd)},
+                [&](KrnlBuilder &createKrnl, ValueRange vecIndices) {
+                  MultiDialectBuilder<MathBuilder, VectorBuilder> create(
+                      createKrnl);
+                  inIndices.back() = vecIndices[0];
+                  Value x = create.vec.load(vecType, data, inIndices);
+                  Value first = create.math.mul(vecIndices[0], sWVal);
+                  for (int64_t j = 0; j < sW; ++j) {
+                    Value y =
+                        (sW == 1) ? x : create.vec.shuffle(x, x, masks[j]);
+                    outIndices.back() = create.math.add(
+                        first, create.math.constantIndex(j * VL));
+                    create.vec.store(y, alloc, outIndices);
+                  }
+                });
+          }
+          if (vecEnd < inW) {
+            ValueRange scalarLoop = create.krnl.defineLoops(1);
+            create.krnl.iterateIE(scalarLoop, scalarLoop,
+                {LiteralIndexExpr(vecEnd)}, {LiteralIndexExpr(inW)},
+                [&](KrnlBuilder &createKrnl, ValueRange scalarIndices) {
+                  MultiDialectBuilder<KrnlBuilder, MathBuilder> create(
+                      createKrnl);
+                  inIndices.back() = scalarIndices[0];
+                  Value x = create.krnl.load(data, inIndices);
+                  Value first = create.math.mul(scalarIndices[0], sWVal);
+                  for (int64_t j = 0; j < sW; ++j) {
+                    outIndices.back() = create.math.add(
+                        first, create.math.constantIndex(j));
+                    create.krnl.store(x, alloc, outIndices);
+                  }
+                });
+          }
+
+          // Copy the output row into the next sH - 1 ones.
+          if (sH == 1)
+            return;
+          Value rowOffset = outIndices[0];
+          for (int64_t i = 1; i < rank - 1; ++i)
+            rowOffset = create.math.add(
+                create.math.mul(
+                    rowOffset, create.math.constantIndex(outShape[i])),
+                outIndices[i]);
+          rowOffset =
+              create.math.mul(rowOffset, create.math.constantIndex(outW));
+          Value outWI64 = create.math.constant(rewriter.getI64Type(), outW);
+          for (int64_t k = 1; k < sH; ++k)
+            create.krnl.memcpy(alloc, alloc, outWI64,
+                create.math.add(
+                    rowOffset, create.math.constantIndex(k * outW)),
+                rowOffset);
+        });
+  }
+
+  // Interpolate input along one axis into output, whose other dims are the
+  // ones of input:
+  //   output[..., o, ...] = sum_k coeffs[o, k] * input[..., indices[o, k], ...]
+  // Along the innermost axis, the input is gathered one element at a time.
+  // Along the other axes, the coefficients of o are loaded once for all the
+  // dims after the axis, and the innermost dim is computed VL at a time.
+  void emitResizeAxis(ConversionPatternRewriter &rewriter, Location loc,
+      Value input, Value output, int64_t axis, Value indices, Value coeffs,
+      int64_t K) const {
+    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+    MemRefType outputType = output.getType().cast<MemRefType>();
+    ArrayRef<int64_t> outShape = outputType.getShape();
+    Type elementType = outputType.getElementType();
+    int64_t rank = outShape.size();
+
+    // for i_0 = 0 .. D_0, ..., for o = 0 .. D_axis:
+    int64_t numOuter = axis + 1;
+    ValueRange outerLoops = create.krnl.defineLoops(numOuter);
+    SmallVector<IndexExpr, 4> outerLbs(numOuter, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> outerUbs;
+    for (int64_t i = 0; i < numOuter; ++i)
+      outerUbs.emplace_back(LiteralIndexExpr(outShape[i]));
+    create.krnl.iterateIE(outerLoops, outerLoops, outerLbs, outerUbs,
+        [&](KrnlBuilder &createKrnl, ValueRange outerIndices) {
+          MultiDialectBuilder<KrnlBuilder, MathBuilder, VectorBuilder> create(
+              createKrnl);
+          Value o = outerIndices[axis];
+          SmallVector<Value, 4> taps, weights;
+          for (int64_t k = 0; k < K; ++k) {
+            Value kIndex = create.math.constantIndex(k);
+            Value tap = create.krnl.load(indices, {o, kIndex});
+            taps.emplace_back(create.math.castToIndex(tap));
+            weights.emplace_back(create.krnl.load(coeffs, {o, kIndex}));
+          }
+          // Indices of the k-th tap in the input.
+          auto inputIndices = [&](int64_t k, ValueRange innerIndices) {
+            SmallVector<Value, 4> inIndices(
+                outerIndices.begin(), outerIndices.end());
+            inIndices[axis] = taps[k];
+            inIndices.append(innerIndices.begin(), innerIndices.end());
+            return inIndices;
+          };
+          auto emitScalar = [&](ValueRange innerIndices) {
+            Value result;
+            for (int64_t k = 0; k < K; ++k) {
+              Value x = create.krnl.load(input, inputIndices(k, innerIndices));
+              Value term = create.math.mul(x, weights[k]);
+              result = result ? create.math.add(result, term) : term;
+            }
+            SmallVector<Value, 4> outIndices(
+                outerIndices.begin(), outerIndices.end());
+            outIndices.append(innerIndices.begin(), innerIndices.end());
+            create.krnl.store(result, output, outIndices);
+          };
+          if (axis == rank - 1) {
+            emitScalar({});
+            return;
+          }
+
+          // The innermost dim is split into [0, vecEnd) computed VL at a time
+          // and the remaining elements computed one at a time.
+          int64_t L = outShape[rank - 1];
+          int64_t VL = create.vec.getMachineVectorLength(elementType);
+          int64_t vecEnd = (L / VL) * VL;
+          VectorType vecType = VectorType::get({VL}, elementType);
+          SmallVector<Value, 4> weightVecs;
+          if (vecEnd > 0)
+            for (int64_t k = 0; k < K; ++k)
+              weightVecs.emplace_back(create.vec.splat(vecType, weights[k]));
+          auto emitInnermost = [&](ValueRange middleIndices) {
+            SmallVector<Value, 4> innerIndices(
+                middleIndices.begin(), middleIndices.end());
+            innerIndices.emplace_back(Value());
+            if (vecEnd > 0) {
+              ValueRange vecLoop = create.krnl.defineLoops(1);
+              ValueRange blockedVecLoop = create.krnl.block(vecLoop[0], VL);
+              create.krnl.iterateIE(vecLoop, {blockedVecLoop[0]},
+                  {LiteralIndexExpr(0)}, {LiteralIndexExpr(vecEnd)},
+                  [&](KrnlBuilder &createKrnl, ValueRange vecIndices) {
+                    MultiDialectBuilder<KrnlBuilder, MathBuilder,
+                        VectorBuilder>
+                        create(createKrnl);
+                    innerIndices.back() = vecIndices[0];
+                    Value result;
+                    for (int64_t k = 0; k < K; ++k) {
+                      Value x = create.vec.load(
+                          vecType, input, inputIndices(k, innerIndices));
+                      result = result ? create.vec.fma(x, weightVecs[k], result)
+                                      : create.math.mul(x, weightVecs[k]);
+                    }
+                    SmallVector<Value, 4> outIndices(
+                        outerIndices.begin(), outerIndices.end());
+                    outIndices.append(innerIndices.begin(), innerIndices.end());
+                    create.vec.store(result, output, outIndices);
+                  });
+            }
+            if (vecEnd < L) {
+              ValueRange scalarLoop = create.krnl.defineLoops(1);
+              create.krnl.iterateIE(scalarLoop, scalarLoop,
+                  {LiteralIndexExpr(vecEnd)}, {LiteralIndexExpr(L)},
+                  [&](KrnlBuilder &createKrnl, ValueRange scalarIndices) {
+                    innerIndices.back() = scalarIndices[0];
+                    emitScalar(innerIndices);
+                  });
+            }
+          };
+
+          // for the dims between the axis and the innermost one:
+          int64_t numMiddle = rank - 2 - axis;
+          if (numMiddle == 0) {
+            emitInnermost({});
+            return;
+          }
+          ValueRange middleLoops = create.krnl.defineLoops(numMiddle);
+          SmallVector<IndexExpr, 4> middleLbs(numMiddle, LiteralIndexExpr(0));
+          SmallVector<IndexExpr, 4> middleUbs;
+          for (int64_t i = axis + 1; i < rank - 1; ++i)
+            middleUbs.emplace_back(LiteralIndexExpr(outShape[i]));
+          create.krnl.iterateIE(middleLoops, middleLoops, middleLbs, middleUbs,
+              [&](KrnlBuilder &createKrnl, ValueRange middleIndices) {
+                emitInnermost(middleIndices);
+              });
+        });
+  }
+
+  // Lower a linear or cubic resize as a sequence of 1D interpolations along
+  // each resized axis, from the innermost one to the outermost one, each
+  // written into a buffer and the last one into alloc. The input positions
+  // and coefficients of each output position of an axis are computed at
+  // compile time into constant tables.
+  void emitNativeResize(ConversionPatternRewriter &rewriter, Location loc,
+      ONNXResizeOp resizeOp, Value data, Value alloc,
+      ArrayRef<IndexExpr> scales) const {
+    MultiDialectBuilder<KrnlBuilder, MemRefBuilder> create(rewriter, loc);
+    MemRefType allocType = alloc.getType().cast<MemRefType>();
+    ArrayRef<int64_t> inShape = data.getType().cast<MemRefType>().getShape();
+    ArrayRef<int64_t> outShape = allocType.getShape();
+    Type elementType = allocType.getElementType();
+    Type i64Type = rewriter.getI64Type();
+    int64_t rank = outShape.size();
+    StringRef mode = resizeOp.getMode();
+    int64_t K = (mode == "cubic") ? 4 : 2;
+
+    // Axes along which the resize is not the identity.
+    SmallVector<int64_t, 4> axes;
+    for (int64_t i = rank - 1; i >= 0; --i)
+      if (inShape[i] != outShape[i] || scales[i].getFloatLiteral() != 1.0)
+        axes.emplace_back(i);
+
+    Value input = data;
+    SmallVector<int64_t, 4> shape(inShape.begin(), inShape.end());
+    for (int64_t axis : axes) {
+      int64_t outLen = outShape[axis];
+      SmallVector<int64_t, 64> indexValues;
+      SmallVector<float, 64> coeffValues;
+      computeResizeAxisCoefficients(mode,
+          resizeOp.getCoordinateTransformationMode(),
+          resizeOp.getCubicCoeffA().convertToFloat(),
+          scales[axis].getFloatLiteral(), inShape[axis], outLen, indexValues,
+          coeffValues);
+      MemRefType indexType = MemRefType::get({outLen, K}, i64Type);
+      MemRefType coeffType = MemRefType::get({outLen, K}, elementType);
+      Value indices = create.krnl.constant(indexType, "resize_indices_",
+          DenseElementsAttr::get(
+              RankedTensorType::get(indexType.getShape(), i64Type),
+              llvm::makeArrayRef(indexValues)));
+      Value coeffs = create.krnl.constant(coeffType, "resize_coeffs_",
+          DenseElementsAttr::get(
+              RankedTensorType::get(coeffType.getShape(), elementType),
+              llvm::makeArrayRef(coeffValues)));
+
+      shape[axis] = outLen;
+      Value output = (axis == axes.back())
+                         ? alloc
+                         : create.mem.alignedAlloc(
+                               MemRefType::get(shape, elementType));
+      emitResizeAxis(rewriter, loc, input, output, axis, indices, coeffs, K);
+      input = output;
+    }
+  }
+
   LogicalResult matchAndRewrite(ONNXResizeOp resizeOp,
       ONNXResizeOpAdaptor adaptor,
       ConversionPatternRewriter &rewriter) const final {
@@ -39,12 +448,6 @@ struct ONNXResizeOpLowering : public OpConversionPattern<ONNXResizeOp> {
     MemRefType memRefType = convertedType.cast<MemRefType>();
     int64_t rank = memRefType.getShape().size();
 
-    // Check implementation constraints
-    if (resizeOp.getMode() == "nearest" &&
-        (resizeOp.getCoordinateTransformationMode() != "asymmetric" &&
-            resizeOp.getCoordinateTransformationMode() != "half_pixel"))
-      return emitError(loc, "not implemented yet");
-
     MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
         MemRefBuilder>
         create(rewriter, loc);
@@ -52,9 +455,36 @@ struct ONNXResizeOpLowering : public OpConversionPattern<ONNXResizeOp> {
     // Shape helper: compute output dims and scales.
     ONNXResizeOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
     shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Lower large nearest resizes by integer scales to the replication of
+    // the input elements and rows.
+    if (useNearestIntegerLowering(
+            resizeOp, data, memRefType, shapeHelper.scales)) {
+      Value alloc =
+          create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
+      emitNearestIntegerResize(
+          rewriter, loc, data, alloc, shapeHelper.scales);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
+    // Check implementation constraints
+    if (resizeOp.getMode() == "nearest" &&
+        (resizeOp.getCoordinateTransformationMode() != "asymmetric" &&
+            resizeOp.getCoordinateTransformationMode() != "half_pixel"))
+      return emitError(loc, "not implemented yet");
+
     Value alloc =
         create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims());
 
+    // Lower large linear and cubic resizes of static shapes to Krnl loops.
+    if (useNativeLowering(resizeOp, data, memRefType, shapeHelper.scales)) {
+      emitNativeResize(
+          rewriter, loc, resizeOp, data, alloc, shapeHelper.scales);
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     // Call external function when the mode is not "nearest"
     // Create KrnlCallOp and replace the du chain
     // One of inputs, getScales() and size(), has to be None.
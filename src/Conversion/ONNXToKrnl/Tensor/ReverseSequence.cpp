@@ -19,6 +19,10 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Minimum number of elements of the (batch, time) pairs copied by a
+// krnl.memcpy, below which copying them element by element is as fast.
+static constexpr int64_t kMemcpyMinRunSize = 64;
+
 struct ONNXReverseSequenceOpLowering
     : public OpConversionPattern<ONNXReverseSequenceOp> {
   ONNXReverseSequenceOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
@@ -56,6 +60,44 @@ struct ONNXReverseSequenceOpLowering
     int64_t outputRank = shapeHelper.getOutputDims().size();
     LiteralIndexExpr oneIE(1);
 
+    // The batch and time axes are the two outermost ones, so that the
+    // elements of each (batch, time) pair are contiguous in the input and the
+    // output. They are copied at once by a krnl.memcpy when they are enough.
+    DimsExpr outputDims = shapeHelper.getOutputDims();
+    IndexExpr innerSize = LiteralIndexExpr(1);
+    for (int64_t d = 2; d < outputRank; ++d)
+      innerSize = innerSize * outputDims[d];
+    if (outputRank > 2 && (!innerSize.isLiteral() ||
+                              innerSize.getLiteral() >= kMemcpyMinRunSize)) {
+      Value innerSizeI64 =
+          create.math.cast(rewriter.getI64Type(), innerSize.getValue());
+      ValueRange loopDef = create.krnl.defineLoops(2);
+      SmallVector<IndexExpr, 2> lbs(2, LiteralIndexExpr(0));
+      SmallVector<IndexExpr, 2> ubs = {outputDims[0], outputDims[1]};
+      create.krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+          [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+            IndexExprScope innerLoopScope(createKrnl);
+            SmallVector<IndexExpr, 2> outputInd, inputInd;
+            getIndexExprList<DimIndexExpr>(loopInd, outputInd);
+            getIndexExprList<DimIndexExpr>(loopInd, inputInd);
+            Value lensVal = createKrnl.loadIE(
+                adaptor.getSequenceLens(), outputInd[batchAxis]);
+            IndexExpr lens = NonAffineIndexExpr(lensVal);
+            IndexExpr timeDim = outputInd[timeAxis];
+            inputInd[timeAxis] = IndexExpr::select(
+                timeDim < lens, lens - timeDim - oneIE, timeDim);
+            SymbolIndexExpr dim1(outputDims[1]), inner(innerSize);
+            IndexExpr outputOffset =
+                (outputInd[0] * dim1 + outputInd[1]) * inner;
+            IndexExpr inputOffset =
+                (inputInd[0] * dim1 + inputInd[1]) * inner;
+            createKrnl.memcpy(alloc, adaptor.getInput(), innerSizeI64,
+                outputOffset.getValue(), inputOffset.getValue());
+          });
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     /*
       The semantic of ReverseSequence can be expressed in loop as:
 
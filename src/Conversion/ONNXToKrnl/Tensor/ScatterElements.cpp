@@ -58,15 +58,22 @@ struct ONNXScatterElementsOpLowering
     int64_t outputRank = outputMemRefType.getShape().size();
     assert(outputRank == dataRank && "Output rank not equal to data rank");
 
-    // Insert an allocation and deallocation for the result of this operation.
     IndexExprScope indexScope(create.krnl);
     DimsExpr dataDims;
     create.krnlIE.getShapeAsDims(data, dataDims);
-    Value output = create.mem.alignedAlloc(outputMemRefType, dataDims);
 
-    // Step1: copy the data array into the output array.
-    Value numOfElements = getDynamicMemRefSize(rewriter, loc, data);
-    create.krnl.memcpy(output, data, numOfElements);
+    // Scatter the updates in place into the data array when it is not used
+    // after this operation.
+    Value output = getInPlaceOperandBuffer(op, 0, data, outputMemRefType);
+    if (!output) {
+      // Insert an allocation and deallocation for the result of this
+      // operation.
+      output = create.mem.alignedAlloc(outputMemRefType, dataDims);
+
+      // Step1: copy the data array into the output array.
+      Value numOfElements = getDynamicMemRefSize(rewriter, loc, data);
+      create.krnl.memcpy(output, data, numOfElements);
+    }
 
     // Step2: scatter the updates array into the output array.
     //   index = indices[i][j]...[n]
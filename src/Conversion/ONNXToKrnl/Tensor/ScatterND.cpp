@@ -51,23 +51,84 @@ struct ONNXScatterNDOpLowering : public OpConversionPattern<ONNXScatterNDOp> {
     int64_t outputRank = outputMemRefType.getShape().size();
     assert(outputRank == dataRank && "Output rank not equal to data rank");
 
-    // Insert an allocation and deallocation for the result of this operation.
-    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
         create(rewriter, loc);
     IndexExprScope indexScope(create.krnl);
     DimsExpr dataDims;
     create.krnlIE.getShapeAsDims(data, dataDims);
-    Value output = create.mem.alignedAlloc(outputMemRefType, dataDims);
 
-    // Step1: copy `data` into `output`.
-    Value numOfElements = getDynamicMemRefSize(rewriter, loc, data);
-    create.krnl.memcpy(output, data, numOfElements);
+    // Scatter the updates in place into `data` when it is not used after this
+    // operation.
+    Value output = getInPlaceOperandBuffer(op, 0, data, outputMemRefType);
+    if (!output) {
+      // Insert an allocation and deallocation for the result of this
+      // operation.
+      output = create.mem.alignedAlloc(outputMemRefType, dataDims);
+
+      // Step1: copy `data` into `output`.
+      Value numOfElements = getDynamicMemRefSize(rewriter, loc, data);
+      create.krnl.memcpy(output, data, numOfElements);
+    }
+
+    // Let r = rank(data), q = rank(indices) and k = indices.shape[-1], so that
+    // rank(updates) = q - 1 + r - k. Each index tuple of 'indices' selects a
+    // slice of the output made of its last (r - k) dims.
+    int64_t k = indicesRank - 1 + dataRank - updatesRank;
+    assert(k >= 1 && k <= dataRank && "indices.shape[-1] must be in [1, r]");
+    int64_t numTupleDims = indicesRank - 1;
 
     // Step2: scatter the updates values into the output.
     //   update_indices = indices.shape[:-1]
     //   for idx in np.ndindex(update_indices):
     //     output[indices[idx]] = updates[idx]
     //
+    // The slices are contiguous in the output and in 'updates', so that they
+    // are copied whole when they are not single elements.
+    if (k < dataRank && outputMemRefType.getLayout().isIdentity() &&
+        updates.getType().cast<MemRefType>().getLayout().isIdentity()) {
+      // Number of elements of a slice.
+      IndexExpr sliceSize = LiteralIndexExpr(1);
+      for (int64_t i = k; i < dataRank; ++i)
+        sliceSize = sliceSize * dataDims[i];
+      Value sliceSizeI64 =
+          create.math.cast(rewriter.getI64Type(), sliceSize.getValue());
+      DimsExpr indicesDims;
+      create.krnlIE.getShapeAsDims(indices, indicesDims);
+
+      auto copySlice = [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+        IndexExprScope innerLoopScope(createKrnl);
+        // Row-major offsets of the slices in 'updates' and in the output.
+        DimsExpr indicesAccessFct;
+        getIndexExprList<DimIndexExpr>(loopInd, indicesAccessFct);
+        IndexExpr srcOffset = LiteralIndexExpr(0);
+        for (int64_t i = 0; i < numTupleDims; ++i)
+          srcOffset = srcOffset * SymbolIndexExpr(indicesDims[i]) +
+                      indicesAccessFct[i];
+        IndexExpr destOffset = LiteralIndexExpr(0);
+        for (int64_t i = 0; i < k; ++i) {
+          indicesAccessFct.emplace_back(LiteralIndexExpr(i));
+          Value indexVal = createKrnl.loadIE(indices, indicesAccessFct);
+          indicesAccessFct.pop_back();
+          destOffset = destOffset * SymbolIndexExpr(dataDims[i]) +
+                       NonAffineIndexExpr(indexVal);
+        }
+        SymbolIndexExpr size(sliceSize);
+        createKrnl.memcpy(output, updates, sliceSizeI64,
+            (destOffset * size).getValue(), (srcOffset * size).getValue());
+      };
+      if (numTupleDims == 0) {
+        copySlice(create.krnl, {});
+      } else {
+        ValueRange loopDef = create.krnl.defineLoops(numTupleDims);
+        DimsExpr lbs(numTupleDims, LiteralIndexExpr(0));
+        DimsExpr ubs(indicesDims.begin(), indicesDims.begin() + numTupleDims);
+        create.krnl.iterateIE(loopDef, loopDef, lbs, ubs, copySlice);
+      }
+      rewriter.replaceOp(op, output);
+      return success();
+    }
+
     ValueRange loopDef = create.krnl.defineLoops(updatesRank);
     DimsExpr lbs(updatesRank, LiteralIndexExpr(0)), ubs;
     create.krnlIE.getShapeAsDims(updates, ubs);
@@ -76,28 +137,26 @@ struct ONNXScatterNDOpLowering : public OpConversionPattern<ONNXScatterNDOp> {
           // Insert code inside the loop.
           IndexExprScope innerLoopScope(createKrnl);
 
-          // Access function for 'indices'. Let q = rank(indices).
-          // The first (q-1) indexes traverse the iteration space defined by
-          // indices.shape[:-1], which corresponds to the first (q-1) induction
-          // variable in the loop iteration space.
+          // Access function for 'indices'. The first (q-1) indexes traverse
+          // the iteration space defined by indices.shape[:-1], which
+          // corresponds to the first (q-1) induction variables in the loop
+          // iteration space.
           DimsExpr indicesAccessFct;
           getIndexExprList<DimIndexExpr>(loopInd, indicesAccessFct);
-          indicesAccessFct.truncate(indicesRank - 1);
+          indicesAccessFct.truncate(numTupleDims);
 
-          // Access function for the output. Let r=rank(data), q=rank(indices).
-          // The first indices.shape[-1] indexes are given by looking up the
-          // 'indices' tensor. The remaining (r-q-1) indexes are given by the
-          // loop iteration space.
+          // Access function for the output. The first k indexes are given by
+          // looking up the 'indices' tensor. The remaining (r-k) indexes are
+          // given by the last (r-k) induction variables.
           DimsExpr outputAccessFct;
-          for (unsigned i = 0; i < dataRank; ++i) {
-            if (i < indicesRank - 1) {
-              IndexExpr ind = LiteralIndexExpr(i);
-              indicesAccessFct.emplace_back(ind);
+          for (int64_t i = 0; i < dataRank; ++i) {
+            if (i < k) {
+              indicesAccessFct.emplace_back(LiteralIndexExpr(i));
               Value indexVal = createKrnl.loadIE(indices, indicesAccessFct);
-              IndexExpr index = NonAffineIndexExpr(indexVal);
-              outputAccessFct.emplace_back(index);
+              indicesAccessFct.pop_back();
+              outputAccessFct.emplace_back(NonAffineIndexExpr(indexVal));
             } else {
-              IndexExpr index = SymbolIndexExpr(loopInd[i]);
+              IndexExpr index = SymbolIndexExpr(loopInd[numTupleDims + i - k]);
               outputAccessFct.emplace_back(index);
             }
           }
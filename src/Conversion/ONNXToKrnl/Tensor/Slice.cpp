@@ -19,6 +19,47 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Return a view of the buffer of the data as the output of the slice, when
+// the output is a contiguous range of the data, namely when it takes a range
+// of one dim of the data, whole dims after it and single elements of the dims
+// before it, and when it is not returned by the function.
+static Value emitSliceView(ConversionPatternRewriter &rewriter, Operation *op,
+    Value data, ArrayRef<IndexExpr> starts, ArrayRef<IndexExpr> steps,
+    MemRefType outputMemRefType) {
+  MemRefType dataType = data.getType().cast<MemRefType>();
+  if (!dataType.hasStaticShape() || !outputMemRefType.hasStaticShape() ||
+      !outputMemRefType.getLayout().isIdentity())
+    return nullptr;
+  for (Operation *user : op->getResult(0).getUsers())
+    if (user->hasTrait<OpTrait::ReturnLike>())
+      return nullptr;
+  ArrayRef<int64_t> dataShape = dataType.getShape();
+  ArrayRef<int64_t> outputShape = outputMemRefType.getShape();
+  int64_t rank = dataShape.size();
+  // Dim of the range, after the leading dims of which the output takes one
+  // element.
+  int64_t d = 0;
+  while (d < rank - 1 && outputShape[d] == 1)
+    ++d;
+  int64_t elementOffset = 0, stride = 1;
+  for (int64_t k = rank - 1; k >= 0; --k) {
+    if (!starts[k].isLiteral() || !steps[k].isLiteralAndIdenticalTo(1))
+      return nullptr;
+    if (k > d &&
+        (starts[k].getLiteral() != 0 || outputShape[k] != dataShape[k]))
+      return nullptr;
+    elementOffset += starts[k].getLiteral() * stride;
+    stride *= dataShape[k];
+  }
+  int64_t byteOffset;
+  Value buffer = getOrCreateByteBuffer(rewriter, op, data, byteOffset);
+  if (!buffer)
+    return nullptr;
+  MultiDialectBuilder<MemRefBuilder> create(rewriter, op->getLoc());
+  byteOffset += elementOffset * dataType.getElementTypeBitWidth() / 8;
+  return create.mem.view(buffer, byteOffset, outputMemRefType, {});
+}
+
 struct ONNXSliceOpLowering : public OpConversionPattern<ONNXSliceOp> {
   ONNXSliceOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
       : OpConversionPattern(typeConverter, ctx) {}
@@ -42,10 +83,30 @@ struct ONNXSliceOpLowering : public OpConversionPattern<ONNXSliceOp> {
     MemRefType outputMemRefType = convertedType.cast<MemRefType>();
     int64_t outputRank = outputMemRefType.getShape().size();
 
+    // Alias the data with a view when possible.
+    if (Value view = emitSliceView(rewriter, op, adaptor.getData(),
+            shapeHelper.starts, shapeHelper.steps, outputMemRefType)) {
+      rewriter.replaceOp(op, view);
+      return success();
+    }
+
     // Insert an allocation and deallocation for the output of this operation.
     Value alloc =
         create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
 
+    // With unit steps, copy the contiguous runs of the slice with memcpy when
+    // possible.
+    bool unitSteps = llvm::all_of(shapeHelper.steps,
+        [](IndexExpr step) { return step.isLiteralAndIdenticalTo(1); });
+    SmallVector<IndexExpr, 4> writeStarts(outputRank, LiteralIndexExpr(0));
+    if (unitSteps && canEmitBulkCopy(adaptor.getData(), shapeHelper.starts,
+                         alloc, writeStarts, shapeHelper.getOutputDims())) {
+      emitBulkCopy(rewriter, loc, adaptor.getData(), shapeHelper.starts, alloc,
+          writeStarts, shapeHelper.getOutputDims());
+      rewriter.replaceOp(op, alloc);
+      return success();
+    }
+
     ValueRange loopDef = create.krnl.defineLoops(outputRank);
     SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
     create.krnl.iterateIE(loopDef, loopDef, lbs, shapeHelper.getOutputDims(),
@@ -15,9 +15,6 @@
 #include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
 #include "src/Dialect/Krnl/KrnlHelper.hpp"
 #include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
-#include "llvm/Support/Debug.h"
-
-#define DEBUG_TYPE "space_to_depth_onnx_to_krnl"
 
 using namespace mlir;
 
@@ -35,8 +32,7 @@ struct ONNXSpaceToDepthOpLowering
     Location loc = ONNXLoc<ONNXSpaceToDepthOp>(op);
     ValueRange operands = adaptor.getOperands();
 
-    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, OnnxToKrnlBuilder,
-        MathBuilder>
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MemRefBuilder>
         create(rewriter, loc);
 
     // Get shape.
@@ -45,38 +41,42 @@ struct ONNXSpaceToDepthOpLowering
 
     Value input = adaptor.getInput();
     int64_t bs = adaptor.getBlocksize();
-
-    // Compute the new dimensions.
     assert(create.krnlIE.getShapedTypeRank(input) == 4 &&
            "Input tensor should have rank equal to 4");
 
-    DimIndexExpr B(create.krnlIE.getShapeAsDim(input, 0));
-    DimIndexExpr C(create.krnlIE.getShapeAsDim(input, 1));
-    DimIndexExpr H(create.krnlIE.getShapeAsDim(input, 2));
-    DimIndexExpr W(create.krnlIE.getShapeAsDim(input, 3));
-    DimIndexExpr newC = C * (bs * bs);
-    DimIndexExpr newH = H.floorDiv(bs);
-    DimIndexExpr newW = W.floorDiv(bs);
-
-    // Reshape input tensor to shape [B, C, H/bs, bs, W/bs, bs].
-    LiteralIndexExpr bsLit(bs);
-    SmallVector<DimIndexExpr> outputDims1({B, C, newH, bsLit, newW, bsLit});
-    Value reshapeRes1 = create.krnlOnnx.reshape(input, outputDims1);
-    LLVM_DEBUG(llvm::dbgs() << "reshapeRes1: " << reshapeRes1 << "\n");
-
-    // Transpose the reshape result into shape [B, C, bs, bs, H/bs, W/bs].
-    SmallVector<DimIndexExpr> outputDims2({B, C, bsLit, bsLit, newH, newW});
-    SmallVector<int64_t> perm({0, 1, 3, 5, 2, 4});
-    Value transposeRes =
-        create.krnlOnnx.transpose(reshapeRes1, perm, outputDims2);
-    LLVM_DEBUG(llvm::dbgs() << "transposeRes: " << transposeRes << "\n");
-
-    // Reshape the transpose result into shape [B, C*bs*bs, H/bs, W/bs].
-    SmallVector<DimIndexExpr> outputDims3({B, newC, newH, newW});
-    Value reshapeRes2 = create.krnlOnnx.reshape(transposeRes, outputDims3);
-    LLVM_DEBUG(llvm::dbgs() << "reshapeRes2: " << reshapeRes2 << "\n");
-
-    rewriter.replaceOp(op, reshapeRes2);
+    // Convert the output type to MemRefType.
+    Type convertedType = typeConverter->convertType(*op->result_type_begin());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    MemRefType outputMemRefType = convertedType.cast<MemRefType>();
+    Value alloc =
+        create.mem.alignedAlloc(outputMemRefType, shapeHelper.getOutputDims());
+
+    // Copy the input in a single pass over the input, without materializing
+    // the transposed [B, bs, bs, C, H/bs, W/bs] tensor of the definition,
+    // each output index being an affine function of the input indices:
+    //   output[b, (i * bs + j) * C + c, h, w] = input[b, c, h * bs + i,
+    //       w * bs + j]
+    // The input is read contiguously, and each of its rows is written to bs
+    // contiguous rows of the output.
+    DimsExpr inputDims;
+    create.krnlIE.getShapeAsDims(input, inputDims);
+    ValueRange loopDef = create.krnl.defineLoops(4);
+    SmallVector<IndexExpr, 4> lbs(4, LiteralIndexExpr(0));
+    create.krnl.iterateIE(loopDef, loopDef, lbs, inputDims,
+        [&](KrnlBuilder &createKrnl, ValueRange loopInd) {
+          IndexExprScope innerScope(createKrnl);
+          DimIndexExpr b(loopInd[0]), c(loopInd[1]), ih(loopInd[2]),
+              iw(loopInd[3]);
+          IndexExpr h = ih.floorDiv(bs), i = ih % bs;
+          IndexExpr w = iw.floorDiv(bs), j = iw % bs;
+          SymbolIndexExpr C(inputDims[1]);
+          IndexExpr outputC = (i * bs + j) * C + c;
+          Value val = createKrnl.load(input, loopInd);
+          createKrnl.storeIE(val, alloc, {b, outputC, h, w});
+        });
+
+    rewriter.replaceOp(op, alloc);
     return success();
   }
 };
@@ -19,6 +19,40 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Return views of the buffer of the input as the outputs of the split, when
+// the outputs are contiguous ranges of the input, namely when its dims before
+// the axis are of size 1, and when they are not returned by the function.
+static bool emitSplitViews(ConversionPatternRewriter &rewriter,
+    Operation *op, Value input, unsigned axis,
+    ArrayRef<MemRefType> outputMemRefTypes, SmallVectorImpl<Value> &views) {
+  MemRefType inputType = input.getType().cast<MemRefType>();
+  if (!inputType.hasStaticShape())
+    return false;
+  for (unsigned r = 0; r < axis; ++r)
+    if (inputType.getShape()[r] != 1)
+      return false;
+  for (unsigned i = 0; i < outputMemRefTypes.size(); ++i) {
+    if (!outputMemRefTypes[i].hasStaticShape() ||
+        !outputMemRefTypes[i].getLayout().isIdentity())
+      return false;
+    for (Operation *user : op->getResult(i).getUsers())
+      if (user->hasTrait<OpTrait::ReturnLike>())
+        return false;
+  }
+  int64_t byteOffset;
+  Value buffer = getOrCreateByteBuffer(rewriter, op, input, byteOffset);
+  if (!buffer)
+    return false;
+  MultiDialectBuilder<MemRefBuilder> create(rewriter, op->getLoc());
+  int64_t elementBytes = inputType.getElementTypeBitWidth() / 8;
+  for (MemRefType outputMemRefType : outputMemRefTypes) {
+    views.emplace_back(
+        create.mem.view(buffer, byteOffset, outputMemRefType, {}));
+    byteOffset += outputMemRefType.getNumElements() * elementBytes;
+  }
+  return true;
+}
+
 template <typename OP_TYPE, typename OP_ADAPTOR>
 LogicalResult ONNXSplitOpLoweringCommon(OP_TYPE splitOp, OP_ADAPTOR adaptor,
     ConversionPatternRewriter &rewriter, TypeConverter *typeConverter) {
@@ -40,24 +74,49 @@ LogicalResult ONNXSplitOpLoweringCommon(OP_TYPE splitOp, OP_ADAPTOR adaptor,
       op, operands, &create.krnlIE);
   shapeHelper.computeShapeAndAssertOnFailure();
 
-  // Alloc and dealloc.
-  SmallVector<Value, 4> allocs;
+  // Convert the output types to MemRefType.
+  SmallVector<MemRefType, 4> memRefTypes;
   for (unsigned i = 0; i < outputNum; ++i) {
-    // Convert the output type to MemRefType.
     Type convertedType =
         typeConverter->convertType(splitOp.getOutputs()[i].getType());
     assert(convertedType && convertedType.isa<MemRefType>() &&
            "Failed to convert type to MemRefType");
-    MemRefType memRefType = convertedType.cast<MemRefType>();
+    memRefTypes.emplace_back(convertedType.cast<MemRefType>());
+  }
+
+  // Alias the input with views when possible.
+  SmallVector<Value, 4> views;
+  if (emitSplitViews(rewriter, op, input, axis, memRefTypes, views)) {
+    rewriter.replaceOp(op, views);
+    return success();
+  }
+
+  // Alloc and dealloc.
+  SmallVector<Value, 4> allocs;
+  for (unsigned i = 0; i < outputNum; ++i) {
     Value alloc =
-        create.mem.alignedAlloc(memRefType, shapeHelper.getOutputDims(i));
+        create.mem.alignedAlloc(memRefTypes[i], shapeHelper.getOutputDims(i));
     allocs.emplace_back(alloc);
   }
 
   // Creates loops, one for each output.
+  IndexExpr splitOffset = LiteralIndexExpr(0);
   for (unsigned i = 0; i < outputNum; ++i) {
     OpBuilder::InsertionGuard insertGuard(rewriter);
 
+    // Copy the contiguous runs of the output with memcpy when possible.
+    DimsExpr outputDims(shapeHelper.getOutputDims(i));
+    SmallVector<IndexExpr, 4> readStarts(rank, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> writeStarts(rank, LiteralIndexExpr(0));
+    readStarts[axis] = splitOffset;
+    splitOffset = splitOffset + outputDims[axis];
+    if (canEmitBulkCopy(
+            input, readStarts, allocs[i], writeStarts, outputDims)) {
+      emitBulkCopy(
+          rewriter, loc, input, readStarts, allocs[i], writeStarts, outputDims);
+      continue;
+    }
+
     // Scope for krnl ops
     IndexExprScope childScope(&rewriter, shapeHelper.getScope());
     MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl> create(
@@ -80,6 +80,44 @@ struct ONNXTileOpLowering : public OpConversionPattern<ONNXTileOp> {
     ValueRange loopDef = create.krnl.defineLoops(outputRank);
     SmallVector<IndexExpr, 4> lbs(outputRank, LiteralIndexExpr(0));
 
+    // With a static input, copy the whole input at each of its repetitions
+    // in the output, with memcpy of its contiguous runs when possible.
+    MemRefType inputType = input.getType().cast<MemRefType>();
+    if (inputType.hasStaticShape() && inputType.getNumElements() > 0) {
+      ArrayRef<int64_t> inputShape = inputType.getShape();
+      SmallVector<IndexExpr, 4> inputDims, repeats, writeStarts;
+      for (uint64_t i = 0; i < outputRank; ++i) {
+        inputDims.emplace_back(LiteralIndexExpr(inputShape[i]));
+        repeats.emplace_back(
+            shapeHelper.getOutputDims()[i].floorDiv(inputShape[i]));
+        // The start of a repetition is only known in the loop below.
+        if (repeats[i].isLiteralAndIdenticalTo(1))
+          writeStarts.emplace_back(LiteralIndexExpr(0));
+        else
+          writeStarts.emplace_back(QuestionmarkIndexExpr(false));
+      }
+      if (canEmitBulkCopy(input, lbs, alloc, writeStarts, inputDims)) {
+        create.krnl.iterateIE(loopDef, loopDef, lbs, repeats,
+            [&](KrnlBuilder &createKrnl, ValueRange repeatIndices) {
+              IndexExprScope repeatScope(createKrnl);
+              SmallVector<IndexExpr, 4> readStarts, repeatStarts, sizes;
+              for (uint64_t i = 0; i < outputRank; ++i) {
+                readStarts.emplace_back(LiteralIndexExpr(0));
+                if (repeats[i].isLiteralAndIdenticalTo(1))
+                  repeatStarts.emplace_back(LiteralIndexExpr(0));
+                else
+                  repeatStarts.emplace_back(
+                      DimIndexExpr(repeatIndices[i]) * inputShape[i]);
+                sizes.emplace_back(LiteralIndexExpr(inputShape[i]));
+              }
+              emitBulkCopy(
+                  rewriter, loc, input, readStarts, alloc, repeatStarts, sizes);
+            });
+        rewriter.replaceOp(op, alloc);
+        return success();
+      }
+    }
+
     create.krnl.iterateIE(loopDef, loopDef, lbs, shapeHelper.getOutputDims(),
         [&](KrnlBuilder &createKrnl, ValueRange indices) {
           // Compute the indices used by the input tensor load operation.
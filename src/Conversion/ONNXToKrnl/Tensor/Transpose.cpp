@@ -19,12 +19,21 @@ using namespace mlir;
 
 namespace onnx_mlir {
 
+// Size in bytes of the L1 data cache, half of which holds a tile of the input
+// and its transposed tile of the output.
+static constexpr int64_t kTransposeL1CacheSize = 32 * 1024;
+// Minimum size in bytes of the transposes lowered by tiles, about the size of
+// the L2 cache, below which the element-by-element copy does not thrash.
+static constexpr int64_t kTransposeTiledMinSize = 1024 * 1024;
+
 struct ONNXTransposeOpLowering : public OpConversionPattern<ONNXTransposeOp> {
   using MDBuilder = MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl,
-      MemRefBuilder, MathBuilder>;
+      MemRefBuilder, MathBuilder, VectorBuilder>;
 
-  ONNXTransposeOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
-      : OpConversionPattern(typeConverter, ctx) {}
+  ONNXTransposeOpLowering(
+      TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD)
+      : OpConversionPattern(typeConverter, ctx), enableSIMD(enableSIMD) {}
+  bool enableSIMD;
 
   LogicalResult matchAndRewrite(ONNXTransposeOp transposeOp,
       ONNXTransposeOpAdaptor adaptor,
@@ -66,11 +75,14 @@ struct ONNXTransposeOpLowering : public OpConversionPattern<ONNXTransposeOp> {
     // N dimensions. Input and Output's MemRefs must use an identity layout to
     // make sure the block's elements are consecutive.
     //
-    // Otherwise, do element-wise copying.
+    // Otherwise, do tiled copying for large static transposes, and element-wise
+    // copying for the other ones.
 
     if (auto numLastDims =
             unchangedInnerDimensions(inMemRefType, outMemRefType, permAttr))
       blockTranspose(data, alloc, permAttr, &create, numLastDims);
+    else if (useTiledTranspose(inMemRefType, outMemRefType))
+      tiledTranspose(data, alloc, permAttr, &create);
     else
       scalarTranspose(data, alloc, permAttr, &create);
 
@@ -128,7 +140,9 @@ private:
   // Do transpose by copying elements one-by-one.
   void scalarTranspose(Value inputMemRef, Value outputMemRef,
       Optional<ArrayAttr> permAttr, MDBuilder *create) const {
-    uint64_t rank = outputMemRef.getType().cast<MemRefType>().getRank();
+    MemRefType outMemRefType = outputMemRef.getType().cast<MemRefType>();
+    uint64_t rank = outMemRefType.getRank();
+    bool nontemporal = useNontemporalStores(outMemRefType);
     ValueRange loopDef = create->krnl.defineLoops(rank);
     SmallVector<IndexExpr, 4> lbs(rank, LiteralIndexExpr(0));
     SmallVector<IndexExpr, 4> ubs;
@@ -143,7 +157,189 @@ private:
             storeIndices.emplace_back(DimIndexExpr(index));
           }
           Value loadData = createKrnl.load(inputMemRef, indices);
-          createKrnl.storeIE(loadData, outputMemRef, storeIndices);
+          createKrnl.storeIE(
+              loadData, outputMemRef, storeIndices, nontemporal);
+        });
+  }
+
+  // Determine if the transpose, which permutes the innermost dimension, is
+  // copied by tiles: large transposes of static shapes and identity layouts,
+  // when SIMD is enabled.
+  bool useTiledTranspose(
+      MemRefType inMemRefType, MemRefType outMemRefType) const {
+    Type elementType = inMemRefType.getElementType();
+    if (!enableSIMD || inMemRefType.getRank() < 2 ||
+        !inMemRefType.hasStaticShape() ||
+        !inMemRefType.getLayout().isIdentity() ||
+        !outMemRefType.getLayout().isIdentity() ||
+        !elementType.isIntOrFloat() ||
+        elementType.getIntOrFloatBitWidth() < 8)
+      return false;
+    int64_t sizeInBytes = inMemRefType.getNumElements() *
+                          elementType.getIntOrFloatBitWidth() / 8;
+    return sizeInBytes >= kTransposeTiledMinSize;
+  }
+
+  // Transpose in registers the rows of VL x VL elements, VL being a power of
+  // 2. Each step d swaps the bit d of the row and column indices, by swapping
+  // the d x d blocks off the diagonal of the 2d x 2d blocks.
+  void transposeRows(
+      VectorBuilder &vec, SmallVectorImpl<Value> &rows, int64_t VL) const {
+    for (int64_t d = VL / 2; d >= 1; d /= 2) {
+      SmallVector<int64_t, 16> loMask, hiMask;
+      for (int64_t p = 0; p < VL; ++p) {
+        bool isHi = (p & d) != 0;
+        loMask.emplace_back(isHi ? VL + p - d : p);
+        hiMask.emplace_back(isHi ? VL + p : p + d);
+      }
+      for (int64_t i = 0; i < VL; ++i) {
+        if ((i & d) != 0)
+          continue;
+        Value lo = vec.shuffle(rows[i], rows[i + d], loMask);
+        Value hi = vec.shuffle(rows[i], rows[i + d], hiMask);
+        rows[i] = lo;
+        rows[i + d] = hi;
+      }
+    }
+  }
+
+  // Do transpose by tiles of the input dimensions that are the innermost of
+  // the input, a, and of the output, b. For each index of the other
+  // dimensions, the tiles of tileSize x tileSize elements, which fit in half of
+  // the L1 cache with their transposed tile, are copied by blocks of VL x VL
+  // elements: VL vectors along a are loaded for consecutive b's, transposed in
+  // registers by shuffles, and stored as VL vectors along b for consecutive
+  // a's. The elements beyond the last full blocks are copied one by one.
+  void tiledTranspose(Value inputMemRef, Value outputMemRef,
+      Optional<ArrayAttr> permAttr, MDBuilder *create) const {
+    MemRefType inMemRefType = inputMemRef.getType().cast<MemRefType>();
+    Type elementType = inMemRefType.getElementType();
+    ArrayRef<int64_t> inShape = inMemRefType.getShape();
+    int64_t rank = inMemRefType.getRank();
+    int64_t aDim = rank - 1;
+    int64_t bDim = ArrayAttrIntVal(permAttr, rank - 1);
+    int64_t A = inShape[aDim], B = inShape[bDim];
+    int64_t VL = create->vec.getMachineVectorLength(elementType);
+    VectorType vecType = VectorType::get({VL}, elementType);
+    // Full blocks of VL x VL elements in [0, BV) x [0, AV).
+    int64_t AV = A / VL * VL, BV = B / VL * VL;
+    int64_t elementSize = elementType.getIntOrFloatBitWidth() / 8;
+    int64_t tileSize = VL;
+    while (2 * (2 * tileSize) * (2 * tileSize) * elementSize <=
+           kTransposeL1CacheSize / 2)
+      tileSize *= 2;
+    // Large outputs are stored bypassing the caches, when their rows of B
+    // elements keep the vectors aligned.
+    bool nontemporal =
+        BV == B &&
+        useNontemporalStores(outputMemRef.getType().cast<MemRefType>());
+
+    // Other dimensions, in the order of the input.
+    SmallVector<int64_t, 4> outerDims;
+    for (int64_t d = 0; d < rank; ++d)
+      if (d != aDim && d != bDim)
+        outerDims.emplace_back(d);
+
+    // Input indices, and output indices permuting them.
+    auto getIndices = [&](ValueRange outerIndices, Value b, Value a,
+                          SmallVectorImpl<Value> &inIndices,
+                          SmallVectorImpl<Value> &outIndices) {
+      inIndices.resize(rank);
+      for (size_t i = 0; i < outerDims.size(); ++i)
+        inIndices[outerDims[i]] = outerIndices[i];
+      inIndices[bDim] = b;
+      inIndices[aDim] = a;
+      outIndices.clear();
+      for (int64_t i = 0; i < rank; ++i)
+        outIndices.emplace_back(inIndices[ArrayAttrIntVal(permAttr, i)]);
+    };
+
+    // Copy the block of VL x VL elements at (b, a).
+    auto emitBlock = [&](KrnlBuilder &createKrnl, ValueRange outerIndices,
+                         Value b, Value a) {
+      MultiDialectBuilder<MathBuilder, VectorBuilder> create(createKrnl);
+      SmallVector<Value, 4> inIndices, outIndices;
+      SmallVector<Value, 16> rows;
+      for (int64_t i = 0; i < VL; ++i) {
+        Value bi = create.math.add(b, create.math.constantIndex(i));
+        getIndices(outerIndices, bi, a, inIndices, outIndices);
+        rows.emplace_back(create.vec.load(vecType, inputMemRef, inIndices));
+      }
+      transposeRows(create.vec, rows, VL);
+      for (int64_t p = 0; p < VL; ++p) {
+        Value ap = create.math.add(a, create.math.constantIndex(p));
+        getIndices(outerIndices, b, ap, inIndices, outIndices);
+        if (nontemporal)
+          create.vec.storeNontemporal(rows[p], outputMemRef, outIndices);
+        else
+          create.vec.store(rows[p], outputMemRef, outIndices);
+      }
+    };
+
+    // Copy the elements of [bLB, bUB) x [aLB, aUB) one by one.
+    auto emitScalar = [&](KrnlBuilder &createKrnl, ValueRange outerIndices,
+                          int64_t bLB, int64_t bUB, int64_t aLB, int64_t aUB) {
+      if (bLB >= bUB || aLB >= aUB)
+        return;
+      ValueRange loopDef = createKrnl.defineLoops(2);
+      createKrnl.iterateIE(loopDef, loopDef,
+          {LiteralIndexExpr(bLB), LiteralIndexExpr(aLB)},
+          {LiteralIndexExpr(bUB), LiteralIndexExpr(aUB)},
+          [&](KrnlBuilder &createKrnl, ValueRange indices) {
+            SmallVector<Value, 4> inIndices, outIndices;
+            getIndices(outerIndices, indices[0], indices[1], inIndices,
+                outIndices);
+            Value loadData = createKrnl.load(inputMemRef, inIndices);
+            createKrnl.store(loadData, outputMemRef, outIndices);
+          });
+    };
+
+    auto emitTiles = [&](KrnlBuilder &createKrnl, ValueRange outerIndices) {
+      // for b0 = 0 .. BV step tileSize, a0 = 0 .. AV step tileSize:
+      //   for b = b0 .. min(b0 + tileSize, BV) step VL,
+      //       a = a0 .. min(a0 + tileSize, AV) step VL:
+      if (AV > 0 && BV > 0) {
+        ValueRange tileLoops = createKrnl.defineLoops(2);
+        ValueRange bTile = createKrnl.block(tileLoops[0], tileSize);
+        ValueRange aTile = createKrnl.block(tileLoops[1], tileSize);
+        createKrnl.iterateIE(tileLoops, {bTile[0], aTile[0]},
+            {LiteralIndexExpr(0), LiteralIndexExpr(0)},
+            {LiteralIndexExpr(BV), LiteralIndexExpr(AV)},
+            [&](KrnlBuilder &createKrnl, ValueRange tileIndices) {
+              IndexExprScope tileScope(createKrnl);
+              DimIndexExpr b0(tileIndices[0]), a0(tileIndices[1]);
+              ValueRange blockLoops = createKrnl.defineLoops(2);
+              ValueRange bBlock = createKrnl.block(blockLoops[0], VL);
+              ValueRange aBlock = createKrnl.block(blockLoops[1], VL);
+              createKrnl.iterateIE(blockLoops, {bBlock[0], aBlock[0]},
+                  {b0, a0},
+                  {IndexExpr::min(b0 + tileSize, BV),
+                      IndexExpr::min(a0 + tileSize, AV)},
+                  [&](KrnlBuilder &createKrnl, ValueRange blockIndices) {
+                    emitBlock(createKrnl, outerIndices, blockIndices[0],
+                        blockIndices[1]);
+                  });
+            });
+      }
+      // Remaining columns, and then remaining rows.
+      emitScalar(createKrnl, outerIndices, 0, B, AV, A);
+      emitScalar(createKrnl, outerIndices, BV, B, 0, AV);
+    };
+
+    // Main loop defined over the other dimensions.
+    if (outerDims.empty()) {
+      emitTiles(create->krnl, {});
+      return;
+    }
+    int64_t outerRank = outerDims.size();
+    ValueRange loopDef = create->krnl.defineLoops(outerRank);
+    SmallVector<IndexExpr, 4> lbs(outerRank, LiteralIndexExpr(0));
+    SmallVector<IndexExpr, 4> ubs;
+    for (int64_t d : outerDims)
+      ubs.emplace_back(LiteralIndexExpr(inShape[d]));
+    create->krnl.iterateIE(loopDef, loopDef, lbs, ubs,
+        [&](KrnlBuilder &createKrnl, ValueRange indices) {
+          emitTiles(createKrnl, indices);
         });
   }
 
@@ -219,8 +415,8 @@ private:
 };
 
 void populateLoweringONNXTransposeOpPattern(RewritePatternSet &patterns,
-    TypeConverter &typeConverter, MLIRContext *ctx) {
-  patterns.insert<ONNXTransposeOpLowering>(typeConverter, ctx);
+    TypeConverter &typeConverter, MLIRContext *ctx, bool enableSIMD) {
+  patterns.insert<ONNXTransposeOpLowering>(typeConverter, ctx, enableSIMD);
 }
 
 } // namespace onnx_mlir
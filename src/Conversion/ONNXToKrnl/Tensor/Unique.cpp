@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------- Unique.cpp - Lowering Unique Op ------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file lowers the ONNX Unique Operator to Krnl dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToKrnl/ONNXToKrnlCommon.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+struct ONNXUniqueOpLowering : public OpConversionPattern<ONNXUniqueOp> {
+  ONNXUniqueOpLowering(TypeConverter &typeConverter, MLIRContext *ctx)
+      : OpConversionPattern(typeConverter, ctx) {}
+
+  /// The runtime computes all the outputs in one pass over the items of X,
+  /// its values or its slices along the axis, looked up in a hash table of
+  /// the unique items. It writes the unique items, their first indices and
+  /// their counts into buffers sized for as many unique items as there are
+  /// items, and the number of unique items, which gives the dynamic dims of
+  /// the outputs the unique items are then copied to.
+  LogicalResult matchAndRewrite(ONNXUniqueOp uniqueOp,
+      ONNXUniqueOpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const final {
+    Operation *op = uniqueOp.getOperation();
+    Location loc = ONNXLoc<ONNXUniqueOp>(op);
+    ValueRange operands = adaptor.getOperands();
+    Value X = adaptor.getX();
+    MemRefType xType = X.getType().cast<MemRefType>();
+    Type elementType = xType.getElementType();
+    if (!isSupportedElementType(elementType))
+      return rewriter.notifyMatchFailure(op, "unsupported element type");
+
+    MultiDialectBuilder<KrnlBuilder, IndexExprBuilderForKrnl, MathBuilder,
+        MemRefBuilder>
+        create(rewriter, loc);
+
+    // Get shape, the number of unique items being a question mark.
+    ONNXUniqueOpShapeHelper shapeHelper(op, operands, &create.krnlIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // Normalized axis, -1 if undef.
+    int64_t rank = xType.getRank();
+    Optional<int64_t> optionalAxis = uniqueOp.getAxis();
+    int64_t axis = -1;
+    if (optionalAxis.has_value())
+      axis = (optionalAxis.value() >= 0) ? optionalAxis.value()
+                                         : optionalAxis.value() + rank;
+
+    // Number of items, and number of values of an item.
+    DimsExpr xDims;
+    create.krnlIE.getShapeAsDims(X, xDims);
+    IndexExpr numItems = LiteralIndexExpr(1);
+    IndexExpr itemSize = LiteralIndexExpr(1);
+    for (int64_t d = 0; d < rank; ++d) {
+      if (axis < 0 || d == axis)
+        numItems = numItems * xDims[d];
+      else
+        itemSize = itemSize * xDims[d];
+    }
+
+    // Buffers of the runtime, as if all the items were unique. The inverse
+    // indices have their final shape.
+    Type i64Type = rewriter.getI64Type();
+    DimsExpr yBufferDims;
+    if (axis < 0)
+      yBufferDims.emplace_back(numItems);
+    else
+      yBufferDims = xDims;
+    SmallVector<int64_t, 4> yBufferShape;
+    IndexExpr::getShape(yBufferDims, yBufferShape);
+    Value yBuffer = create.mem.alignedAlloc(
+        MemRefType::get(yBufferShape, elementType), yBufferDims);
+    DimsExpr itemsDims = {numItems};
+    SmallVector<int64_t, 1> itemsShape;
+    IndexExpr::getShape(itemsDims, itemsShape);
+    MemRefType itemsType = MemRefType::get(itemsShape, i64Type);
+    Value indicesBuffer = create.mem.alignedAlloc(itemsType, itemsDims);
+    Value countsBuffer = create.mem.alignedAlloc(itemsType, itemsDims);
+    Value inverse = create.mem.alignedAlloc(
+        uniqueOp.getInverseIndices().getType().isa<NoneType>()
+            ? itemsType
+            : getMemRefType(uniqueOp.getInverseIndices()),
+        itemsDims);
+    Value total = create.mem.alignedAlloc(MemRefType::get({1}, i64Type));
+    Value valAxis = create.math.constant(i64Type, axis);
+    Value valSorted = create.math.constant(i64Type, uniqueOp.getSorted());
+    SmallVector<Value, 8> callOperands = {
+        X, yBuffer, indicesBuffer, inverse, countsBuffer, valAxis, valSorted};
+    rewriter.create<KrnlCallOp>(loc, "omTensorUnique", total, callOperands);
+
+    // Now replace the question marks by the number of unique items.
+    Value numUnique = create.math.castToIndex(
+        create.krnl.load(total, {create.math.constantIndex(0)}));
+    DimIndexExpr numUniqueIE(numUnique);
+    shapeHelper.getOutputDims(0)[axis < 0 ? 0 : axis] = numUniqueIE;
+    shapeHelper.getOutputDims(1)[0] = numUniqueIE;
+    shapeHelper.getOutputDims(3)[0] = numUniqueIE;
+
+    // Copy the unique items out of the buffers, where they come first. The
+    // outputs that are none are left as null values.
+    auto copyOut = [&](Value result, Value buffer, int64_t n,
+                       IndexExpr numElems) -> Value {
+      if (result.getType().isa<NoneType>())
+        return Value();
+      Value alloc = create.mem.alignedAlloc(
+          getMemRefType(result), shapeHelper.getOutputDims(n));
+      create.krnl.memcpy(
+          alloc, buffer, create.math.cast(i64Type, numElems.getValue()));
+      return alloc;
+    };
+    Value Y = copyOut(uniqueOp.getY(), yBuffer, 0, numUniqueIE * itemSize);
+    Value indices =
+        copyOut(uniqueOp.getIndices(), indicesBuffer, 1, numUniqueIE);
+    Value counts = copyOut(uniqueOp.getCounts(), countsBuffer, 3, numUniqueIE);
+    if (uniqueOp.getInverseIndices().getType().isa<NoneType>())
+      inverse = Value();
+
+    rewriter.replaceOp(op, {Y, indices, inverse, counts});
+    return success();
+  }
+
+  MemRefType getMemRefType(Value result) const {
+    Type convertedType = typeConverter->convertType(result.getType());
+    assert(convertedType && convertedType.isa<MemRefType>() &&
+           "Failed to convert type to MemRefType");
+    return convertedType.cast<MemRefType>();
+  }
+
+  // The values are compared as integers and floats of the data types sorted
+  // by the runtime.
+  static bool isSupportedElementType(Type elementType) {
+    if (auto intType = elementType.dyn_cast<IntegerType>()) {
+      unsigned width = intType.getWidth();
+      return width == 1 || width == 8 || width == 16 || width == 32 ||
+             width == 64;
+    }
+    return elementType.isF32() || elementType.isF64();
+  }
+};
+
+void populateLoweringONNXUniqueOpPattern(RewritePatternSet &patterns,
+    TypeConverter &typeConverter, MLIRContext *ctx) {
+  patterns.insert<ONNXUniqueOpLowering>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -310,6 +310,50 @@ struct ONNXElementwiseVariadicOpLoweringToMhlo : public ConversionPattern {
   }
 };
 
+// ONNXWhereOp(C, X, Y) is implemented using MHLO Select(C, X, Y), after
+// broadcasting the condition and the values to the output shape.
+//===----------------------------------------------------------------------===//
+struct ONNXWhereOpLoweringToMhlo : public ConversionPattern {
+  ONNXWhereOpLoweringToMhlo(MLIRContext *ctx)
+      : ConversionPattern(ONNXWhereOp::getOperationName(), 1, ctx) {}
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const final {
+    Location loc = op->getLoc();
+
+    IndexExprBuilderForMhlo createShapeIE(rewriter, loc);
+    ONNXBroadcastOpShapeHelper shapeHelper(op, operands, &createShapeIE);
+    shapeHelper.computeShapeAndAssertOnFailure();
+
+    // The condition does not have the element type of the values, so that
+    // each operand is broadcast to a type built from its own element type.
+    int64_t outputRank = shapeHelper.outputRank;
+    ShapedType outputType = op->getResult(0).getType().cast<ShapedType>();
+    Value resultExtents =
+        mlir::hlo::computeNaryElementwiseBroadcastingResultExtents(
+            loc, op->getOperands(), rewriter);
+    llvm::SmallVector<Value, 4> broadcastedOperands;
+    for (Value operand : op->getOperands()) {
+      RankedTensorType operandType =
+          operand.getType().dyn_cast<RankedTensorType>();
+      if (!operandType)
+        return failure();
+      SmallVector<int64_t, 4> broadcastDimensions = llvm::to_vector<4>(
+          llvm::seq<int64_t>(outputRank - operandType.getRank(), outputRank));
+      RankedTensorType broadcastedType = RankedTensorType::get(
+          outputType.getShape(), operandType.getElementType());
+      broadcastedOperands.push_back(
+          rewriter.create<mhlo::DynamicBroadcastInDimOp>(loc, broadcastedType,
+              operand, resultExtents,
+              rewriter.getI64TensorAttr(broadcastDimensions)));
+    }
+    Value mhloOp = rewriter.create<mhlo::SelectOp>(loc, outputType,
+        broadcastedOperands[0], broadcastedOperands[1],
+        broadcastedOperands[2]);
+    rewriter.replaceOp(op, mhloOp);
+    return success();
+  }
+};
+
 } // namespace
 
 void populateLoweringONNXElementwiseOpToMhloPattern(
@@ -336,7 +380,8 @@ void populateLoweringONNXElementwiseOpToMhloPattern(
       ONNXElementwiseVariadicOpLoweringToMhlo<ONNXDivOp>,
       ONNXElementwiseVariadicOpLoweringToMhlo<ONNXMaxOp>,
       ONNXElementwiseVariadicOpLoweringToMhlo<ONNXMulOp>,
-      ONNXElementwiseVariadicOpLoweringToMhlo<ONNXSubOp>>(ctx);
+      ONNXElementwiseVariadicOpLoweringToMhlo<ONNXSubOp>,
+      ONNXWhereOpLoweringToMhlo>(ctx);
 }
 
 } // namespace onnx_mlir
@@ -0,0 +1,87 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------------Pad.cpp - Lowering Pad Op----------------------------=== //
+//
+// Copyright 2023
+//
+// =============================================================================
+//
+// This file lowers the ONNX Pad Operator to Mhlo dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Conversion/ONNXToMhlo/ONNXToMhloCommon.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// ONNXPadOp(A) in constant mode with constant pads is implemented using MHLO
+// padOp. The other modes are left to the other lowerings.
+struct ONNXPadOpLoweringToMhlo : public ConversionPattern {
+  ONNXPadOpLoweringToMhlo(MLIRContext *ctx)
+      : ConversionPattern(mlir::ONNXPadOp::getOperationName(), 1, ctx) {}
+
+  LogicalResult matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const final {
+    Location loc = op->getLoc();
+    ONNXPadOpAdaptor adaptor(operands, op->getAttrDictionary());
+    ONNXPadOp padOp = cast<ONNXPadOp>(op);
+    Value data = adaptor.getData();
+    Value pads = padOp.getPads();
+    Value constantValue = adaptor.getConstantValue();
+
+    if (adaptor.getMode() != "constant")
+      return failure();
+    if (!isRankedShapedType(data.getType()))
+      return failure();
+    ShapedType dataType = data.getType().cast<ShapedType>();
+    Type elementType = dataType.getElementType();
+    int64_t rank = dataType.getRank();
+    Type outputType = *op->result_type_begin();
+    if (!isRankedShapedType(outputType))
+      return failure();
+
+    // The pads are given as [x1_begin, x2_begin, ..., x1_end, x2_end, ...].
+    ElementsAttr padsAttr = getElementAttributeFromONNXValue(pads);
+    if (!padsAttr || padsAttr.getNumElements() != 2 * rank)
+      return failure();
+    SmallVector<int64_t, 4> padsValues(padsAttr.getValues<int64_t>());
+    SmallVector<int64_t, 4> edgePaddingLow(
+        padsValues.begin(), padsValues.begin() + rank);
+    SmallVector<int64_t, 4> edgePaddingHigh(
+        padsValues.begin() + rank, padsValues.end());
+    SmallVector<int64_t, 4> interiorPadding(rank, 0);
+
+    // The padding value is a scalar tensor, zero by default.
+    Value paddingValue;
+    RankedTensorType scalarType = RankedTensorType::get({}, elementType);
+    if (isFromNone(constantValue))
+      paddingValue = rewriter.create<mhlo::ConstantOp>(
+          loc, rewriter.getZeroAttr(scalarType));
+    else
+      paddingValue =
+          rewriter.create<mhlo::ReshapeOp>(loc, scalarType, constantValue);
+
+    Value result = rewriter.create<mhlo::PadOp>(loc, outputType, data,
+        paddingValue, rewriter.getI64TensorAttr(edgePaddingLow),
+        rewriter.getI64TensorAttr(edgePaddingHigh),
+        rewriter.getI64TensorAttr(interiorPadding));
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+} // namespace
+
+void populateLoweringONNXPadOpToMhloPattern(
+    RewritePatternSet &patterns, MLIRContext *ctx) {
+  patterns.insert<ONNXPadOpLoweringToMhlo>(ctx);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,57 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- Concat.cpp - Concat Op ------------------------------===//
+//
+// Copyright 2023
+//
+// =============================================================================
+//
+// This file lowers ONNX Concat operator to TOSA dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "src/Conversion/ONNXToTOSA/ONNXToTOSACommon.hpp"
+#include "src/Conversion/ONNXToTOSA/ONNXToTOSALegalizeUtils.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+class ONNXConcatOpLoweringToTOSA : public OpConversionPattern<ONNXConcatOp> {
+public:
+  using OpConversionPattern<ONNXConcatOp>::OpConversionPattern;
+  using OpAdaptor = typename ONNXConcatOp::Adaptor;
+  LogicalResult matchAndRewrite(ONNXConcatOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    ValueRange inputs = adaptor.getInputs();
+    auto inputType = inputs[0].getType().dyn_cast<RankedTensorType>();
+    if (!inputType)
+      return rewriter.notifyMatchFailure(
+          op, "tosa.concat only supports ranked tensors");
+
+    // TOSA only takes non-negative axes.
+    int64_t axis = adaptor.getAxis();
+    if (axis < 0)
+      axis += inputType.getRank();
+
+    Type resultType = getTypeConverter()->convertType(op.getResult().getType());
+    tosa::CreateReplaceOpAndInfer<mlir::tosa::ConcatOp>(
+        rewriter, op, resultType, inputs, axis);
+    return success();
+  }
+};
+
+} // namespace
+
+void populateLoweringONNXConcatOpToTOSAPattern(ConversionTarget &target,
+    RewritePatternSet &patterns, TypeConverter &typeConverter,
+    MLIRContext *ctx) {
+  patterns.insert<ONNXConcatOpLoweringToTOSA>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
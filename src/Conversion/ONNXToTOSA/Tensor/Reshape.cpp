@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- Reshape.cpp - Reshape Op ----------------------------===//
+//
+// Copyright 2023
+//
+// =============================================================================
+//
+// This file lowers ONNX Reshape operator to TOSA dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "src/Conversion/ONNXToTOSA/ONNXToTOSACommon.hpp"
+#include "src/Conversion/ONNXToTOSA/ONNXToTOSALegalizeUtils.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+class ONNXReshapeOpLoweringToTOSA : public OpConversionPattern<ONNXReshapeOp> {
+public:
+  using OpConversionPattern<ONNXReshapeOp>::OpConversionPattern;
+  using OpAdaptor = typename ONNXReshapeOp::Adaptor;
+  LogicalResult matchAndRewrite(ONNXReshapeOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    // The new shape is an attribute of tosa.reshape. It is taken from the
+    // result type, which shape inference makes static when the shape operand
+    // is a constant.
+    auto resultType = getTypeConverter()
+                          ->convertType(op.getResult().getType())
+                          .dyn_cast_or_null<RankedTensorType>();
+    if (!resultType || !resultType.hasStaticShape())
+      return rewriter.notifyMatchFailure(
+          op, "tosa.reshape only supports static result shapes");
+
+    tosa::CreateReplaceOpAndInfer<mlir::tosa::ReshapeOp>(rewriter, op,
+        resultType, adaptor.getData(),
+        rewriter.getDenseI64ArrayAttr(resultType.getShape()));
+    return success();
+  }
+};
+
+} // namespace
+
+void populateLoweringONNXReshapeOpToTOSAPattern(ConversionTarget &target,
+    RewritePatternSet &patterns, TypeConverter &typeConverter,
+    MLIRContext *ctx) {
+  patterns.insert<ONNXReshapeOpLoweringToTOSA>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
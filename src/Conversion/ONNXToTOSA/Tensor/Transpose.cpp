@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- Transpose.cpp - Transpose Op ------------------------===//
+//
+// Copyright 2023
+//
+// =============================================================================
+//
+// This file lowers ONNX Transpose operator to TOSA dialect.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "src/Conversion/ONNXToTOSA/DialectBuilder.hpp"
+#include "src/Conversion/ONNXToTOSA/ONNXToTOSACommon.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+class ONNXTransposeOpLoweringToTOSA
+    : public OpConversionPattern<ONNXTransposeOp> {
+public:
+  using OpConversionPattern<ONNXTransposeOp>::OpConversionPattern;
+  using OpAdaptor = typename ONNXTransposeOp::Adaptor;
+  LogicalResult matchAndRewrite(ONNXTransposeOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    TosaBuilder tosaBuilder(rewriter, op->getLoc());
+    Value data = adaptor.getData();
+    auto dataType = data.getType().dyn_cast<RankedTensorType>();
+    if (!dataType)
+      return rewriter.notifyMatchFailure(
+          op, "tosa.transpose only supports ranked tensors");
+
+    // The default permutation reverses the dimensions.
+    int64_t rank = dataType.getRank();
+    llvm::SmallVector<int32_t, 4> perm;
+    if (llvm::Optional<ArrayAttr> permAttr = adaptor.getPerm()) {
+      for (IntegerAttr dim : permAttr->getAsRange<IntegerAttr>())
+        perm.push_back(dim.getInt());
+    } else {
+      for (int64_t i = rank - 1; i >= 0; --i)
+        perm.push_back(i);
+    }
+
+    rewriter.replaceOp(op, tosaBuilder.transpose(data, perm));
+    return success();
+  }
+};
+
+} // namespace
+
+void populateLoweringONNXTransposeOpToTOSAPattern(ConversionTarget &target,
+    RewritePatternSet &patterns, TypeConverter &typeConverter,
+    MLIRContext *ctx) {
+  patterns.insert<ONNXTransposeOpLoweringToTOSA>(typeConverter, ctx);
+}
+
+} // namespace onnx_mlir
@@ -17,6 +17,8 @@
 #include "src/Dialect/Krnl/DialectBuilder.hpp"
 #include "src/Dialect/ONNX/ONNXOps.hpp"
 
+#include <atomic>
+
 using namespace mlir;
 
 namespace onnx_mlir {
@@ -85,21 +87,31 @@ void KrnlBuilder::store(mlir::Value val, mlir::Value memref,
   store(val, memref, computedIndices);
 }
 
-void KrnlBuilder::storeIE(
-    Value val, Value memref, ArrayRef<IndexExpr> indices) const {
+void KrnlBuilder::storeIE(Value val, Value memref, ArrayRef<IndexExpr> indices,
+    bool nontemporal) const {
   SmallVector<Value, 4> indexValues;
   IndexExpr::getValues(indices, indexValues);
-  b().create<KrnlStoreOp>(loc(), val, memref, indexValues);
+  KrnlStoreOp storeOp =
+      b().create<KrnlStoreOp>(loc(), val, memref, indexValues);
+  if (nontemporal)
+    storeOp.setNontemporalAttr(b().getUnitAttr());
+}
+
+void KrnlBuilder::prefetch(
+    Value memref, ValueRange indices, bool isWrite, unsigned locality) const {
+  b().create<KrnlPrefetchOp>(loc(), memref, indices, b().getBoolAttr(isWrite),
+      b().getI32IntegerAttr(locality));
 }
 
 void KrnlBuilder::seqstore(
-    mlir::Value element, mlir::Value seq, mlir::Value index) const {
-  b().create<KrnlSeqStoreOp>(loc(), element, seq, index);
+    mlir::Value element, mlir::Value seq, mlir::Value index, bool copy) const {
+  b().create<KrnlSeqStoreOp>(loc(), element, seq, index,
+      IntegerAttr::get(b().getIntegerType(1, false), copy));
 }
 
 void KrnlBuilder::seqstore(
-    mlir::Value element, mlir::Value seq, IndexExpr index) const {
-  b().create<KrnlSeqStoreOp>(loc(), element, seq, index.getValue());
+    mlir::Value element, mlir::Value seq, IndexExpr index, bool copy) const {
+  seqstore(element, seq, index.getValue(), copy);
 }
 
 Value KrnlBuilder::vectorTypeCast(Value sourceMemref, int64_t vectorLen) const {
@@ -120,6 +132,10 @@ void KrnlBuilder::permute(ValueRange loops, ArrayRef<int64_t> map) const {
   b().create<KrnlPermuteOp>(loc(), loops, map);
 }
 
+void KrnlBuilder::unrollJam(Value loop, int64_t factor) const {
+  b().create<KrnlUnrollJamOp>(loc(), loop, factor);
+}
+
 ValueRange KrnlBuilder::getInductionVarValue(ValueRange loops) const {
   return b()
       .template create<KrnlGetInductionVariableValueOp>(loc(), loops)
@@ -223,7 +239,9 @@ KrnlGetRefOp KrnlBuilder::getRef(
 Value KrnlBuilder::constant(MemRefType type, StringRef name,
     Optional<Attribute> value, Optional<IntegerAttr> offset,
     Optional<IntegerAttr> alignment) const {
-  static int32_t constantID = 0;
+  // Atomic as the functions may be lowered in parallel, the lowering then
+  // numbers the constants again in the order of the module.
+  static std::atomic<int32_t> constantID{0};
   return b().create<KrnlGlobalOp>(loc(), type,
       b().getI64ArrayAttr(type.getShape()),
       b().getStringAttr(name + std::to_string(constantID++)),
@@ -306,8 +324,81 @@ ElementsAttr IndexExprBuilderForKrnl::getConst(mlir::Value value) {
   return nullptr;
 }
 
+// Return true if op comes before the insertion point of the builder, in the
+// same block or in a block enclosing it.
+static bool isBeforeInsertionPoint(Operation *op, OpBuilder &b) {
+  Block *block = b.getInsertionBlock();
+  Block::iterator point = b.getInsertionPoint();
+  while (block && block != op->getBlock()) {
+    Operation *parentOp = block->getParentOp();
+    if (!parentOp)
+      return false;
+    block = parentOp->getBlock();
+    point = Block::iterator(parentOp);
+  }
+  return block && (point == block->end() || op->isBeforeInBlock(&*point));
+}
+
+// Return the scalar stored at position i of a small static array of rank 0 or
+// 1, e.g. the lowered output of a Shape, Dim or Concat of shapes, or null if
+// it is not known. The array, or the array it is a view of, must be allocated
+// in a block only writing it by krnl.store ops of constant indices, each
+// element being stored once before the insertion point of the builder.
+static Value getStoredScalar(Value array, uint64_t i, OpBuilder &b) {
+  auto type = array.getType().dyn_cast<MemRefType>();
+  if (!type || !type.hasStaticShape() || type.getRank() > 1 ||
+      !type.getLayout().isIdentity())
+    return nullptr;
+  // The reshapes of the array, e.g. by Unsqueeze, keep its elements in order.
+  if (auto castOp = array.getDefiningOp<memref::ReinterpretCastOp>()) {
+    auto sourceType = castOp.getSource().getType().dyn_cast<MemRefType>();
+    if (!sourceType || !sourceType.hasStaticShape() ||
+        sourceType.getNumElements() != type.getNumElements())
+      return nullptr;
+    return getStoredScalar(castOp.getSource(), i, b);
+  }
+  auto allocOp = array.getDefiningOp<memref::AllocOp>();
+  if (!allocOp)
+    return nullptr;
+  KrnlStoreOp storeOp;
+  for (Operation *user : array.getUsers()) {
+    if (isa<KrnlLoadOp, memref::DimOp, memref::DeallocOp>(user))
+      continue;
+    if (auto castOp = dyn_cast<memref::ReinterpretCastOp>(user)) {
+      // A view through which the array may be written.
+      if (llvm::any_of(castOp.getResult().getUsers(), [](Operation *op) {
+            return !isa<KrnlLoadOp, memref::DimOp>(op);
+          }))
+        return nullptr;
+      continue;
+    }
+    auto userStoreOp = dyn_cast<KrnlStoreOp>(user);
+    if (!userStoreOp || userStoreOp->getBlock() != allocOp->getBlock())
+      return nullptr;
+    uint64_t position = 0;
+    for (Value index : userStoreOp.getIndices()) {
+      auto indexOp = index.getDefiningOp<arith::ConstantIndexOp>();
+      if (!indexOp)
+        return nullptr;
+      position = indexOp.value();
+    }
+    if (position != i)
+      continue;
+    if (storeOp)
+      return nullptr;
+    storeOp = userStoreOp;
+  }
+  if (!storeOp || !isBeforeInsertionPoint(storeOp, b))
+    return nullptr;
+  return storeOp.getValue();
+}
+
 Value IndexExprBuilderForKrnl::getVal(Value intArrayVal, uint64_t i) {
   MultiDialectBuilder<KrnlBuilder, MathBuilder> create(*this);
+  // Use the scalar stored in a shape computed in this function, rather than
+  // loading it, so that the shape need not be kept in memory.
+  if (Value storedVal = getStoredScalar(intArrayVal, i, b()))
+    return storedVal;
   uint64_t rank = getShapedTypeRank(intArrayVal);
   if (rank == 0)
     return create.krnl.load(intArrayVal, {});
@@ -40,17 +40,25 @@ struct KrnlBuilder : public DialectBuilder {
   // When ranks of offsets<indices, add offsets to the least significant dims.
   void store(mlir::Value val, mlir::Value memref, mlir::ValueRange indices,
       mlir::ValueRange offsets) const;
+  // A nontemporal store bypasses the caches.
   void storeIE(mlir::Value val, mlir::Value memref,
-      mlir::ArrayRef<IndexExpr> indices) const;
+      mlir::ArrayRef<IndexExpr> indices, bool nontemporal = false) const;
+  // Locality ranges from 0, none, to 3, keep in all caches.
+  void prefetch(mlir::Value memref, mlir::ValueRange indices, bool isWrite,
+      unsigned locality) const;
 
-  void seqstore(mlir::Value element, mlir::Value seq, mlir::Value index) const;
-  void seqstore(mlir::Value element, mlir::Value seq, IndexExpr index) const;
+  // Without copy, the element of another sequence is shared.
+  void seqstore(mlir::Value element, mlir::Value seq, mlir::Value index,
+      bool copy = true) const;
+  void seqstore(mlir::Value element, mlir::Value seq, IndexExpr index,
+      bool copy = true) const;
 
   mlir::Value vectorTypeCast(mlir::Value sourceMemref, int64_t vectorLen) const;
 
   mlir::ValueRange defineLoops(int64_t originalLoopNum) const;
   mlir::ValueRange block(mlir::Value loop, int64_t blockSize) const;
   void permute(mlir::ValueRange loops, mlir::ArrayRef<int64_t> map) const;
+  void unrollJam(mlir::Value loop, int64_t factor) const;
   mlir::ValueRange getInductionVarValue(mlir::ValueRange loops) const;
 
   // Lambda passes loop indices as 2nd parameter.
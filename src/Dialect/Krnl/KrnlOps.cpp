@@ -866,6 +866,39 @@ LogicalResult KrnlCopyFromBufferOp::verify() {
   return success();
 }
 
+//===----------------------------------------------------------------------===//
+// KrnlTaskGraphCallOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult KrnlTaskGraphCallOp::verify() {
+  int64_t numTasks = getPredecessorCounts().size();
+  ArrayAttr offsets = getSuccessorOffsets();
+  if ((int64_t)offsets.size() != numTasks + 1)
+    return emitOpError("expect one successor offset per task, plus one");
+  int64_t numSuccessors = getSuccessors().size();
+  SmallVector<int64_t, 16> counts(numTasks, 0);
+  for (int64_t t = 0; t < numTasks; ++t) {
+    int64_t begin = offsets[t].cast<IntegerAttr>().getInt();
+    int64_t end = offsets[t + 1].cast<IntegerAttr>().getInt();
+    if (begin < 0 || begin > end || end > numSuccessors)
+      return emitOpError("successor offsets must be increasing and within the "
+                         "successors");
+    for (int64_t i = begin; i < end; ++i) {
+      int64_t successor = getSuccessors()[i].cast<IntegerAttr>().getInt();
+      // The numbering of the tasks must be a topological order.
+      if (successor <= t || successor >= numTasks)
+        return emitOpError("successors must follow their predecessors");
+      ++counts[successor];
+    }
+  }
+  if (numTasks > 0 && offsets[0].cast<IntegerAttr>().getInt() != 0)
+    return emitOpError("successor offsets must start at 0");
+  for (int64_t t = 0; t < numTasks; ++t)
+    if (getPredecessorCounts()[t].cast<IntegerAttr>().getInt() != counts[t])
+      return emitOpError("predecessor counts must match the successors");
+  return success();
+}
+
 void KrnlSeqExtractOp::getEffects(
     SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
         &effects) {
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Bufferization/IR/AllocationOpInterface.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
@@ -26,3 +28,10 @@
 
 #define GET_OP_CLASSES
 #include "src/Dialect/Krnl/KrnlOps.hpp.inc"
+
+namespace onnx_mlir {
+// Attribute of the KrnlGlobalOps read by parallel loops whose iteration i
+// reads the part i of their data, giving their number of parts, so that the
+// parts are placed on the NUMA nodes running the iterations.
+const std::string KRNL_GLOBAL_NUMA_PARTITIONS_ATTR = "numa_partitions";
+} // namespace onnx_mlir
@@ -26,6 +26,7 @@
 
 // Please do not add dependences on ONNX or KRNL dialects.
 #include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "src/Dialect/Mlir/VectorMachineSupport.hpp"
 
 #define DEBUG_TYPE "dialect_builder"
 
@@ -55,6 +56,14 @@ namespace onnx_mlir {
   return elementOrVectorType;
 }
 
+/* static */ Type MathBuilder::getTypeWithVector(
+    Type elementOrVectorType, Type elementType) {
+  VectorType vectorType = elementOrVectorType.dyn_cast<VectorType>();
+  if (vectorType)
+    return VectorType::get(vectorType.getShape(), elementType);
+  return elementType;
+}
+
 /* static */ bool MathBuilder::isIntegerWithVector(Type elementOrVectorType) {
   Type elementType = elementTypeWithVector(elementOrVectorType);
   return elementType.isa<IntegerType>() || elementType.isa<IndexType>();
@@ -542,22 +551,22 @@ Value MathBuilder::createArithCmp(
 // cast remove the sign of integer types for successful processing, to the
 // best of my understanding.
 Value MathBuilder::castToSignless(Value val, int64_t width) const {
-  assert(val.getType().isa<IntegerType>() &&
-         !val.getType().isSignlessInteger() && "Expecting signed integer type");
-  return b()
-      .create<UnrealizedConversionCastOp>(loc(), b().getIntegerType(width), val)
-      .getResult(0);
+  assert(isIntegerWithVector(val.getType()) &&
+         !elementTypeWithVector(val.getType()).isSignlessInteger() &&
+         "Expecting signed integer type");
+  Type type = getTypeWithVector(val.getType(), b().getIntegerType(width));
+  return b().create<UnrealizedConversionCastOp>(loc(), type, val).getResult(0);
 }
 
 Value MathBuilder::castToUnsigned(Value val, int64_t width) const {
-  assert(val.getType().isa<IntegerType>() && "Expecting integer type");
-  return b()
-      .create<UnrealizedConversionCastOp>(
-          loc(), b().getIntegerType(width, false /*signed*/), val)
-      .getResult(0);
+  assert(isIntegerWithVector(val.getType()) && "Expecting integer type");
+  Type type = getTypeWithVector(
+      val.getType(), b().getIntegerType(width, false /*signed*/));
+  return b().create<UnrealizedConversionCastOp>(loc(), type, val).getResult(0);
 }
 
-// Methods inspired from MLIR TosaToLinalg CastOp.
+// Methods inspired from MLIR TosaToLinalg CastOp. Vectors are converted with
+// the same ops as their elements.
 Value MathBuilder::cast(Type destType, Value src) const {
   // Get source type and check if we need a cast at all.
   Type srcType = src.getType();
@@ -579,26 +588,33 @@ Value MathBuilder::cast(Type destType, Value src) const {
     destIsIndex = true;
   }
 
-  // Only support Integer or Float type at this stage. Index were transformed
-  // to signless int.
-  // TODO: add support for shaped tensor (MemRef, Vector, Tensor?) if needed.
-  assert((srcType.isa<IntegerType>() || srcType.isa<FloatType>()) &&
+  // Only support Integer or Float type at this stage, or vectors of them.
+  // Index were transformed to signless int.
+  // TODO: add support for shaped tensor (MemRef, Tensor?) if needed.
+  Type srcElementType = elementTypeWithVector(srcType);
+  Type destElementType = elementTypeWithVector(destType);
+  assert((srcElementType.isa<IntegerType>() ||
+             srcElementType.isa<FloatType>()) &&
          "support only float or int");
-  assert((destType.isa<IntegerType>() || destType.isa<FloatType>()) &&
+  assert((destElementType.isa<IntegerType>() ||
+             destElementType.isa<FloatType>()) &&
          "support only float or int");
   // Get source and dest type width.
-  int64_t srcWidth = srcType.getIntOrFloatBitWidth();
-  int64_t destWidth = destType.getIntOrFloatBitWidth();
+  int64_t srcWidth = srcElementType.getIntOrFloatBitWidth();
+  int64_t destWidth = destElementType.getIntOrFloatBitWidth();
   bool bitExtend = srcWidth < destWidth;
   bool bitTrunc = srcWidth > destWidth;
+  // Signless integer type of the dest width, or vector of it.
+  Type destSignlessType =
+      getTypeWithVector(destType, b().getIntegerType(destWidth));
 
   LLVM_DEBUG(llvm::dbgs() << "srcType: " << srcType << "\n";
              llvm::dbgs() << "destType: " << destType << "\n";);
 
   // Handle boolean first because they need special handling.
   // Boolean to int/float conversions. Boolean are unsigned.
-  if (srcType.isInteger(1)) {
-    if (destType.isa<FloatType>()) {
+  if (srcElementType.isInteger(1)) {
+    if (destElementType.isa<FloatType>()) {
       return b().create<arith::UIToFPOp>(loc(), destType, src);
     } else {
       Value dest = b().create<arith::ExtUIOp>(loc(), destType, src);
@@ -609,12 +625,13 @@ Value MathBuilder::cast(Type destType, Value src) const {
   }
 
   // Int/Float to booleans, just compare value to be unequal zero.
-  if (destType.isInteger(1)) {
+  if (destElementType.isInteger(1)) {
     Type constantType = srcType;
-    if (srcType.isa<IntegerType>() && !srcType.isSignlessInteger()) {
+    if (srcElementType.isa<IntegerType>() &&
+        !srcElementType.isSignlessInteger()) {
       // An integer constant must be signless.
-      unsigned srcWidth = srcType.cast<IntegerType>().getWidth();
-      constantType = IntegerType::get(srcType.getContext(), srcWidth);
+      constantType = getTypeWithVector(
+          srcType, IntegerType::get(srcType.getContext(), srcWidth));
       src = castToSignless(src, srcWidth);
     }
     Value zero = constant(constantType, 0);
@@ -622,7 +639,7 @@ Value MathBuilder::cast(Type destType, Value src) const {
   }
 
   // Float to float conversions.
-  if (srcType.isa<FloatType>() && destType.isa<FloatType>()) {
+  if (srcElementType.isa<FloatType>() && destElementType.isa<FloatType>()) {
     assert((bitExtend || bitTrunc) && "expected extend or trunc");
     if (bitExtend)
       return b().create<arith::ExtFOp>(loc(), destType, src);
@@ -631,12 +648,13 @@ Value MathBuilder::cast(Type destType, Value src) const {
   }
 
   // Float to int conversions.
-  if (srcType.isa<FloatType>() && destType.isa<IntegerType>()) {
+  if (srcElementType.isa<FloatType>() && destElementType.isa<IntegerType>()) {
     // TosaToLinalg in MLIR uses a fancier algorithm that clamps values to
     // min/max signed/unsigned integer values.
-    if (destType.isUnsignedInteger()) {
-      Value cast = castToSignless(src, srcWidth);
-      return b().create<arith::FPToUIOp>(loc(), destType, cast);
+    if (destElementType.isUnsignedInteger()) {
+      // Arith ops produce signless integers, reconvert output to unsigned.
+      Value cast = b().create<arith::FPToUIOp>(loc(), destSignlessType, src);
+      return castToUnsigned(cast, destWidth);
     } else {
       // Handle signed int.
       Value dest = b().create<arith::FPToSIOp>(loc(), destType, src);
@@ -647,8 +665,8 @@ Value MathBuilder::cast(Type destType, Value src) const {
   }
 
   // Int to float conversion.
-  if (srcType.isa<IntegerType>() && destType.isa<FloatType>()) {
-    if (srcType.isUnsignedInteger()) {
+  if (srcElementType.isa<IntegerType>() && destElementType.isa<FloatType>()) {
+    if (srcElementType.isUnsignedInteger()) {
       Value cast = castToSignless(src, srcWidth);
       return b().create<arith::UIToFPOp>(loc(), destType, cast);
     } else {
@@ -658,24 +676,33 @@ Value MathBuilder::cast(Type destType, Value src) const {
   }
 
   // Int to int conversion.
-  if (srcType.isa<IntegerType>() && destType.isa<IntegerType>()) {
-    if (srcType.isUnsignedInteger()) {
+  if (srcElementType.isa<IntegerType>() &&
+      destElementType.isa<IntegerType>()) {
+    if (srcElementType.isUnsignedInteger()) {
       // Unsigned to unsigned conversion. Has to convert to signless first,
-      // and reconvert output to unsigned.
-      assert(destType.isUnsignedInteger() && "no unsigned/signed conversion");
+      // and reconvert output to unsigned. Unsigned to signed conversion is
+      // only supported when extending, as it then preserves the value.
+      assert((destElementType.isUnsignedInteger() || bitExtend) &&
+             "no truncating unsigned/signed conversion");
       assert((bitExtend || bitTrunc) && "expected extend or trunc");
       Value cast = castToSignless(src, srcWidth);
-      Type castType = b().getIntegerType(destWidth);
       if (bitExtend) {
-        cast = b().create<arith::ExtUIOp>(loc(), castType, cast);
+        cast = b().create<arith::ExtUIOp>(loc(), destSignlessType, cast);
       } else {
         // TosaToLinalg use a clipping algo, not sure if needed.
-        cast = b().create<arith::TruncIOp>(loc(), castType, cast);
+        cast = b().create<arith::TruncIOp>(loc(), destSignlessType, cast);
+      }
+      if (!destElementType.isUnsignedInteger()) {
+        if (destIsIndex)
+          cast =
+              b().create<arith::IndexCastOp>(loc(), b().getIndexType(), cast);
+        return cast;
       }
       return castToUnsigned(cast, destWidth);
     } else {
       // Handle signed integer
-      assert(!destType.isUnsignedInteger() && "no signed/unsigned conversion");
+      assert(!destElementType.isUnsignedInteger() &&
+             "no signed/unsigned conversion");
       Value dest = src;
       if (bitExtend)
         dest = b().create<arith::ExtSIOp>(loc(), destType, src);
@@ -1145,6 +1172,15 @@ Value MemRefBuilder::dim(Value val, Value index) const {
   return Value(b().createOrFold<memref::DimOp>(loc(), val, index));
 }
 
+//===----------------------------------------------------------------------===//
+// Prefetch.
+
+void MemRefBuilder::prefetch(
+    Value val, ValueRange indices, bool isWrite, unsigned locality) const {
+  b().create<memref::PrefetchOp>(
+      loc(), val, indices, isWrite, locality, /*isDataCache=*/true);
+}
+
 //===----------------------------------------------------------------------===//
 // Structured Control Flow (SCF).
 //===----------------------------------------------------------------------===//
@@ -1198,14 +1234,7 @@ void SCFBuilder::yield() const { b().create<scf::YieldOp>(loc()); }
 //===----------------------------------------------------------------------===//
 
 int64_t VectorBuilder::getMachineVectorLength(const Type &elementType) const {
-  unsigned typeBitSize = elementType.getIntOrFloatBitWidth();
-  unsigned simdBitSize;
-  // TODO: use march and mcpu to determine the right size, right now assume
-  // 4*32=128 bits.
-  simdBitSize = 128;
-  assert(simdBitSize >= typeBitSize && simdBitSize % typeBitSize == 0 &&
-         "bad machine vector length");
-  return (simdBitSize / typeBitSize);
+  return VectorMachineSupport::getGlobal().getVectorLength(elementType);
 }
 
 int64_t VectorBuilder::getMachineVectorLength(const VectorType &vecType) const {
@@ -1258,10 +1287,43 @@ void VectorBuilder::storeIE(mlir::Value val, mlir::Value memref,
   store(val, memref, computedIndices);
 }
 
+void VectorBuilder::storeNontemporal(
+    Value val, Value memref, ValueRange indices) const {
+  vector::StoreOp storeOp =
+      b().create<vector::StoreOp>(loc(), val, memref, indices);
+  storeOp->setAttr(gNontemporalAttrName, b().getUnitAttr());
+}
+
+Value VectorBuilder::createMask(int64_t VL, Value numValid) const {
+  VectorType maskType = VectorType::get({VL}, b().getI1Type());
+  return b().create<vector::CreateMaskOp>(loc(), maskType, numValid);
+}
+
+Value VectorBuilder::maskedLoad(VectorType vecType, Value memref,
+    ValueRange indices, Value mask, Value passThru) const {
+  return b().create<vector::MaskedLoadOp>(
+      loc(), vecType, memref, indices, mask, passThru);
+}
+
+void VectorBuilder::maskedStore(
+    Value val, Value memref, ValueRange indices, Value mask) const {
+  b().create<vector::MaskedStoreOp>(loc(), memref, indices, mask, val);
+}
+
 Value VectorBuilder::fma(Value lhs, Value rhs, Value acc) const {
+  // There is no integer fma in the vector dialect.
+  if (MathBuilder::isIntegerWithVector(lhs.getType())) {
+    MathBuilder createMath(*this);
+    return createMath.add(createMath.mul(lhs, rhs), acc);
+  }
   return b().create<vector::FMAOp>(loc(), lhs, rhs, acc);
 }
 
+Value VectorBuilder::reduction(
+    vector::CombiningKind kind, Value value) const {
+  return b().create<vector::ReductionOp>(loc(), kind, value);
+}
+
 // Val is required to be a index/integer/float.
 Value VectorBuilder::splat(VectorType vecType, Value val) const {
   return b().create<vector::SplatOp>(loc(), vecType, val);
@@ -1606,17 +1668,22 @@ void LLVMBuilder::ifThenElse(
   // Branch the block into the THEN and ELSE blocks.
   createLLVM.condBr(condVal, thenBlock, {}, elseBlock, {});
 
-  // Emit code for the THEN block.
+  // Emit code for the THEN block. The code may end in another block than the
+  // THEN block when it contains nested if-then-else constructs.
   b().setInsertionPointToStart(thenBlock);
   thenFn(createLLVM);
-  if (thenBlock->hasNoSuccessors() && !isa<LLVM::ReturnOp>(thenBlock->back()))
+  Block *thenEndBlock = b().getInsertionBlock();
+  if (thenEndBlock->hasNoSuccessors() &&
+      !isa<LLVM::ReturnOp>(thenEndBlock->back()))
     br({}, endBlock);
 
   // Emit code for the ELSE block if required.
   b().setInsertionPointToStart(elseBlock);
   if (elseFn) {
     elseFn(createLLVM);
-    if (elseBlock->hasNoSuccessors() && !isa<LLVM::ReturnOp>(elseBlock->back()))
+    Block *elseEndBlock = b().getInsertionBlock();
+    if (elseEndBlock->hasNoSuccessors() &&
+        !isa<LLVM::ReturnOp>(elseEndBlock->back()))
       br({}, endBlock);
   }
 
@@ -15,6 +15,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/Utils/ReshapeOpsUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/IntegerSet.h"
 #include "mlir/IR/Matchers.h"
@@ -84,6 +85,10 @@ struct MathBuilder final : DialectBuilder {
 
   // Support for vectors
   static mlir::Type elementTypeWithVector(mlir::Type elementOrVectorType);
+  // Return the element type, or a vector of it with the shape of the vector
+  // type `elementOrVectorType`.
+  static mlir::Type getTypeWithVector(
+      mlir::Type elementOrVectorType, mlir::Type elementType);
   static bool isIntegerWithVector(mlir::Type elementOrVectorType);
   static bool isUnsignedIntegerWithVector(mlir::Type elementOrVectorType);
   static bool isFloatWithVector(mlir::Type elementOrVectorType);
@@ -191,9 +196,10 @@ struct ShapeBuilder final : DialectBuilder {
 // MemRef Builder with added support for aligned memory
 //===----------------------------------------------------------------------===//
 
-// Default alignment attribute for all allocation of memory. On most system, it
-// numElems is 16 bytes.
-static constexpr int64_t gDefaultAllocAlign = 16;
+// Default alignment attribute for all allocation of memory, the size of a cache
+// line on most systems, so that the vectors of up to 64 bytes of AVX-512 are
+// aligned. The entry points align their inputs to it as well.
+static constexpr int64_t gDefaultAllocAlign = 64;
 
 struct MemRefBuilder final : DialectBuilder {
   MemRefBuilder(mlir::Location loc) : DialectBuilder(loc) {}
@@ -293,6 +299,11 @@ struct MemRefBuilder final : DialectBuilder {
   mlir::Value dim(mlir::Value val, int64_t index) const;
   mlir::Value dim(mlir::Value val, mlir::Value index) const;
 
+  // Prefetch the data cache line of val at indices, for a read or a write,
+  // with locality from 0 (no locality) to 3 (keep in all cache levels).
+  void prefetch(mlir::Value val, mlir::ValueRange indices, bool isWrite,
+      unsigned locality) const;
+
 private:
   mlir::IntegerAttr computeAlignment(int64_t alignment) const;
   void computeDynSymbols(
@@ -333,6 +344,10 @@ struct SCFBuilder final : DialectBuilder {
 // Vector Builder
 //===----------------------------------------------------------------------===//
 
+// Unit attribute of the memref and vector stores that bypass the caches, which
+// are lowered to nontemporal stores of the LLVM dialect.
+static constexpr llvm::StringLiteral gNontemporalAttrName = "krnl.nontemporal";
+
 struct VectorBuilder final : DialectBuilder {
   VectorBuilder(mlir::Location loc) : DialectBuilder(loc) {}
   VectorBuilder(mlir::OpBuilder &b, mlir::Location loc)
@@ -340,8 +355,9 @@ struct VectorBuilder final : DialectBuilder {
   VectorBuilder(const DialectBuilder &db) : DialectBuilder(db) {}
   virtual ~VectorBuilder() {}
 
-  // Get the machine SIMD vector length for the given elementary type.
-  // This can help guide certain optimizations.
+  // Get the machine SIMD vector length for the given elementary type, as
+  // described by VectorMachineSupport::getGlobal(). This can help guide
+  // certain optimizations.
   int64_t getMachineVectorLength(const mlir::Type &elementType) const;
   int64_t getMachineVectorLength(const mlir::VectorType &vecType) const;
   int64_t getMachineVectorLength(mlir::Value vecValue) const;
@@ -360,6 +376,19 @@ struct VectorBuilder final : DialectBuilder {
       mlir::ValueRange offsets) const;
   void storeIE(mlir::Value val, mlir::Value memref,
       llvm::ArrayRef<IndexExpr> indices, mlir::ValueRange offsets) const;
+  // Store bypassing the caches, at an address aligned to the smaller of the
+  // vector size and gDefaultAllocAlign.
+  void storeNontemporal(
+      mlir::Value val, mlir::Value memref, mlir::ValueRange indices) const;
+  // Mask of the first numValid lanes of a vector of VL lanes.
+  mlir::Value createMask(int64_t VL, mlir::Value numValid) const;
+  // Masked load and store, of the lanes set in the mask only. The other lanes
+  // of the loaded vector are taken from passThru. They are lowered to the
+  // masked moves of AVX-512 and SVE, or to loads with length on z.
+  mlir::Value maskedLoad(mlir::VectorType vecType, mlir::Value memref,
+      mlir::ValueRange indices, mlir::Value mask, mlir::Value passThru) const;
+  void maskedStore(mlir::Value val, mlir::Value memref,
+      mlir::ValueRange indices, mlir::Value mask) const;
 
   // Splat: a single value is copied.
   mlir::Value splat(mlir::VectorType vecType, mlir::Value val) const;
@@ -369,6 +398,9 @@ struct VectorBuilder final : DialectBuilder {
   mlir::Value shuffle(mlir::Value lhs, mlir::Value rhs,
       llvm::SmallVectorImpl<int64_t> &mask) const;
   mlir::Value fma(mlir::Value lhs, mlir::Value rhs, mlir::Value acc) const;
+  // Reduction: all the values of a 1D vector are combined into a scalar.
+  mlir::Value reduction(
+      mlir::vector::CombiningKind kind, mlir::Value value) const;
 
   // Composite functions.
   mlir::Value mergeHigh(mlir::Value lhs, mlir::Value rhs, int64_t step) const;
@@ -568,6 +600,7 @@ struct LLVMBuilder final : DialectBuilder {
   /// ^mainBlock
   ///   ...
   /// ```
+  /// The bodies may contain other if-then-else constructs.
   void ifThenElse(valueFuncRef cond, voidFuncRef thenFn,
       voidFuncRef elseFn = nullptr) const;
 };
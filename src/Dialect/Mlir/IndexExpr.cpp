@@ -41,7 +41,7 @@ namespace onnx_mlir {
 // Initial scope.
 IndexExprScope::IndexExprScope(OpBuilder *rewriter, Location loc)
     : dims(), symbols(), rewriter(rewriter), parentScope(getCurrentScopePtr()),
-      loc(loc), container() {
+      loc(loc), allocator() {
   getCurrentScopePtr() = this;
 }
 
@@ -53,7 +53,7 @@ IndexExprScope::IndexExprScope(
     OpBuilder *innerRewriter, IndexExprScope *enclosingScope)
     : dims(), symbols(), rewriter(innerRewriter),
       parentScope(enclosingScope ? enclosingScope : getCurrentScopePtr()),
-      loc(parentScope->loc), container() {
+      loc(parentScope->loc), allocator() {
   // if (!parentScope)
   //  // Enclosing scope not provided, fetch from environment.
   //  parentScope = getCurrentScopePtr();
@@ -73,11 +73,10 @@ IndexExprScope::IndexExprScope(
     : IndexExprScope(&innerDb.getBuilder(), enclosingScope) {}
 
 IndexExprScope::~IndexExprScope() {
-  // Free the memory of each IndexExprImpl in scope's container.
-  for (IndexExprImpl *obj : container)
-    delete obj;
-  container.clear();
-  // no need to clear the cached copies as they are also in the container.
+  // The memory of each IndexExprImpl is released with the scope's arena, as
+  // they are trivially destructible.
+  static_assert(std::is_trivially_destructible<IndexExprImpl>::value,
+      "IndexExprImpl are not destroyed individually");
   getCurrentScopePtr() = parentScope;
 }
 
@@ -91,8 +90,25 @@ IndexExprScope::~IndexExprScope() {
 // IndexExprScope builder for IndexExpr.
 //===----------------------------------------------------------------------===//
 
-void IndexExprScope::addIndexExprImpl(IndexExprImpl *obj) {
-  container.emplace_back(obj);
+void *IndexExprScope::allocateIndexExprImpl(size_t size) {
+  return allocator.Allocate(size, alignof(IndexExprImpl));
+}
+
+//===----------------------------------------------------------------------===//
+// IndexExprScope memoization of simplified affine expressions.
+//===----------------------------------------------------------------------===//
+
+AffineExpr IndexExprScope::getSimplifiedAffineExpr(AffineExpr expr) {
+  // The simplification depends on the numbers of dims and symbols, which
+  // grow as they are added to the scope.
+  auto key = std::make_tuple(expr, getNumDims(), getNumSymbols());
+  auto iter = simplifiedAffineExprs.find(key);
+  if (iter != simplifiedAffineExprs.end())
+    return iter->second;
+  AffineExpr simpleExpr =
+      simplifyAffineExpr(expr, getNumDims(), getNumSymbols());
+  simplifiedAffineExprs[key] = simpleExpr;
+  return simpleExpr;
 }
 
 //===----------------------------------------------------------------------===//
@@ -22,9 +22,12 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Allocator.h"
 
 #include <cstdint>
 #include <functional>
+#include <tuple>
 #include <string>
 
 /*
@@ -374,8 +377,11 @@ private:
     return scope;
   }
 
-  // Add a new IndexExprImpl in the scope's container.
-  void addIndexExprImpl(IndexExprImpl *obj);
+  // Allocate the memory of a new IndexExprImpl in the scope's arena.
+  void *allocateIndexExprImpl(size_t size);
+
+  // Memoized simplification of the affine expressions of the scope.
+  mlir::AffineExpr getSimplifiedAffineExpr(mlir::AffineExpr expr);
 
   // Support functions for AffineExpr.
   int indexInList(llvm::SmallVectorImpl<mlir::Value> const &list,
@@ -392,9 +398,13 @@ private:
   IndexExprScope *parentScope;
   // Location for ops rewriting.
   mlir::Location loc;
-  // Container of all index expr implementation records, to simplify
-  // live range analysis. ALl will be deleted upon scope destruction.
-  llvm::SmallVector<IndexExprImpl *, 20> container;
+  // Arena of all index expr implementation records, to simplify live range
+  // analysis. All are released at once upon scope destruction.
+  llvm::BumpPtrAllocator allocator;
+  // Structurally identical expressions are simplified once per scope, for
+  // given numbers of dims and symbols.
+  llvm::DenseMap<std::tuple<mlir::AffineExpr, int, int>, mlir::AffineExpr>
+      simplifiedAffineExprs;
 };
 
 //===----------------------------------------------------------------------===//
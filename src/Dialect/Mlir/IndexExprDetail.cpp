@@ -40,11 +40,13 @@ IndexExprImpl::IndexExprImpl()
     : defined(false), literal(false), isFloat(false),
       kind(IndexExprKind::NonAffine), intLit(0), affineExpr(nullptr),
       value(nullptr) {
-  // Set scope from thread private global.
+  // Set scope from thread private global, which also allocated this object.
   scope = IndexExprScope::getCurrentScopePtr();
   assert(scope && "expected IndexExpr Scope to be defined");
-  // Record the new index expr implementation.
-  scope->addIndexExprImpl(this);
+}
+
+/*static*/ void *IndexExprImpl::operator new(size_t size) {
+  return IndexExprScope::getCurrentScope().allocateIndexExprImpl(size);
 }
 
 void IndexExprImpl::initAsUndefined() {
@@ -199,8 +201,7 @@ void IndexExprImpl::initAsKind(Value const val, IndexExprKind const newKind) {
 
 void IndexExprImpl::initAsAffineExpr(AffineExpr const val) {
   // Check if the affine expression is reduced to a constant expr.
-  AffineExpr simpleVal =
-      simplifyAffineExpr(val, scope->getNumDims(), scope->getNumSymbols());
+  AffineExpr simpleVal = scope->getSimplifiedAffineExpr(val);
   AffineConstantExpr constAffineExpr = simpleVal.dyn_cast<AffineConstantExpr>();
   if (constAffineExpr) {
     initAsLiteral(constAffineExpr.getValue(), IndexExprKind::Affine);
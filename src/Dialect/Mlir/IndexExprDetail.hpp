@@ -23,14 +23,18 @@ namespace onnx_mlir {
 // Implementation of the IndexExpr. In nearly all cases, the value described by
 // this data structure is constant. Sole exception is during the reduction
 // operations. IndexExpr are simply a pointer to this data structure. This data
-// structure is allocated in dynamic memory and resides in the scope. It will
-// be automaticaly destroyed at the same time as the scope.
+// structure is allocated in the arena of the current scope. It will be
+// automaticaly released at the same time as the scope.
 
 class IndexExprImpl {
 public:
   // Public constructor.
   IndexExprImpl();
 
+  // Allocation in the arena of the current scope, released with the scope.
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr) {}
+
   // Basic initialization calls.
   void initAsUndefined();
   // Initialize a question mark with the default value of ShapedType::kDynamic.
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- VectorMachineSupport.cpp - Description of the SIMD unit ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the description of the vector unit and of the caches of
+// the target machine.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cassert>
+
+#include "src/Dialect/Mlir/VectorMachineSupport.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+static VectorMachineSupport globalVectorMachineSupport;
+
+int64_t VectorMachineSupport::getVectorLength(Type elementType) const {
+  int64_t typeBitSize = elementType.getIntOrFloatBitWidth();
+  assert(simdBitWidth >= typeBitSize && simdBitWidth % typeBitSize == 0 &&
+         "bad machine vector length");
+  return simdBitWidth / typeBitSize;
+}
+
+int64_t VectorMachineSupport::getRegTileRows(
+    int64_t vecsPerRow, int64_t numAccumulators) const {
+  return std::max<int64_t>(numAccumulators / vecsPerRow, 1);
+}
+
+int64_t VectorMachineSupport::getL1TileRows(
+    Type elementType, int64_t kCols) const {
+  int64_t typeByteSize = (elementType.getIntOrFloatBitWidth() + 7) / 8;
+  return std::max<int64_t>(l1CacheSize / (kCols * typeByteSize), 1);
+}
+
+int64_t VectorMachineSupport::getL2TileCols(
+    Type elementType, int64_t kRows, int64_t jRegTile) const {
+  // A quarter of the cache leaves room for the other tiles and for the tile
+  // of the next iteration being brought in.
+  int64_t typeByteSize = (elementType.getIntOrFloatBitWidth() + 7) / 8;
+  int64_t cols = (l2CacheSize / 4) / (kRows * typeByteSize);
+  return std::max<int64_t>((cols / jRegTile) * jRegTile, jRegTile);
+}
+
+const VectorMachineSupport &VectorMachineSupport::getGlobal() {
+  return globalVectorMachineSupport;
+}
+
+void VectorMachineSupport::setGlobal(const VectorMachineSupport &support) {
+  globalVectorMachineSupport = support;
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,60 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- VectorMachineSupport.hpp - Description of the SIMD unit ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file defines the description of the vector unit and of the caches of
+// the target machine used by the lowerings to size their vectors, unroll
+// factors and tiles.
+//
+// The description is global to the process, as the options of the target it
+// is derived from. The compiler sets it from the target machine of --mtriple,
+// --mcpu and --march before building its passes. The default describes a
+// machine with 16 vector registers of 128 bits and no FMA, as SSE.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "mlir/IR/Types.h"
+
+namespace onnx_mlir {
+
+struct VectorMachineSupport {
+  // Bit width of the vectors the code is generated for.
+  int64_t simdBitWidth = 128;
+  // Number of architected vector registers.
+  int64_t numVectorRegisters = 16;
+  // Whether fused multiply-adds are computed in one instruction.
+  bool hasFMA = false;
+  // Sizes in bytes of the data cache of one core and of the level 2 cache.
+  int64_t l1CacheSize = 32 * 1024;
+  int64_t l2CacheSize = 256 * 1024;
+
+  // Number of elements of the type in a vector.
+  int64_t getVectorLength(mlir::Type elementType) const;
+
+  // Number of rows of the register tiles of a matrix product simdized along
+  // its columns, whose rows of vecsPerRow vectors of accumulators use
+  // numAccumulators of the vector registers.
+  int64_t getRegTileRows(int64_t vecsPerRow, int64_t numAccumulators) const;
+
+  // Number of rows of a tile of kCols columns of a matrix fitting in the
+  // level 1 cache, and number of columns, a multiple of jRegTile, of a tile
+  // of kRows rows using at most half of the level 2 cache.
+  int64_t getL1TileRows(mlir::Type elementType, int64_t kCols) const;
+  int64_t getL2TileCols(
+      mlir::Type elementType, int64_t kRows, int64_t jRegTile) const;
+
+  static const VectorMachineSupport &getGlobal();
+  static void setGlobal(const VectorMachineSupport &support);
+};
+
+} // namespace onnx_mlir
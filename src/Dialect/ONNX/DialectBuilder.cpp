@@ -94,6 +94,15 @@ Value OnnxBuilder::div(Value A, Value B) const {
   return b().create<ONNXDivOp>(loc(), toTensor(A), toTensor(B));
 }
 
+Value OnnxBuilder::gemm(Type Y, Value A, Value B, Value C, float alpha,
+    float beta, bool transA, bool transB) const {
+  IntegerType si64Type = b().getIntegerType(64, /*isSigned=*/true);
+  return b().create<ONNXGemmOp>(loc(), Y, toTensor(A), toTensor(B), C,
+      b().getF32FloatAttr(alpha), b().getF32FloatAttr(beta),
+      IntegerAttr::get(si64Type, APInt(64, transA, /*isSigned=*/true)),
+      IntegerAttr::get(si64Type, APInt(64, transB, /*isSigned=*/true)));
+}
+
 Value OnnxBuilder::matmul(Type Y, Value A, Value B, bool useGemm) const {
   // Gemm only supports rank 2.
   bool canUseGemm = useGemm && A.getType().isa<ShapedType>() &&
@@ -102,19 +111,9 @@ Value OnnxBuilder::matmul(Type Y, Value A, Value B, bool useGemm) const {
                     B.getType().isa<ShapedType>() &&
                     B.getType().cast<ShapedType>().hasRank() &&
                     (B.getType().cast<ShapedType>().getRank() == 2);
-  auto aValue = toTensor(A);
-  auto bValue = toTensor(B);
   if (canUseGemm)
-    return b().create<ONNXGemmOp>(loc(), Y, aValue, bValue,
-        b().createOrFold<ONNXNoneOp>(loc()),
-        /*alpha=*/b().getF32FloatAttr(1.0), /*beta=*/b().getF32FloatAttr(1.0),
-        /*transA=*/
-        IntegerAttr::get(b().getIntegerType(64, /*isSigned=*/true),
-            APInt(64, 0, /*isSigned=*/true)),
-        /*transB=*/
-        IntegerAttr::get(b().getIntegerType(64, /*isSigned=*/true),
-            APInt(64, 0, /*isSigned=*/true)));
-  return b().create<ONNXMatMulOp>(loc(), toTensor(Y), aValue, bValue);
+    return gemm(Y, A, B, none());
+  return b().create<ONNXMatMulOp>(loc(), toTensor(Y), toTensor(A), toTensor(B));
 }
 
 Value OnnxBuilder::min(ValueRange inputs) const {
@@ -144,6 +143,10 @@ Value OnnxBuilder::mul(Type resultType, Value A, Value B) const {
   return b().create<ONNXMulOp>(loc(), resultType, toTensor(A), toTensor(B));
 }
 
+Value OnnxBuilder::none() const {
+  return b().createOrFold<ONNXNoneOp>(loc());
+}
+
 Value OnnxBuilder::reduceSum(Type outputType, Value data, Value axes,
     bool keepDims, bool noop_with_empty_axes) const {
   int64_t i_keepDims = keepDims; // 0 if false, 1 if true
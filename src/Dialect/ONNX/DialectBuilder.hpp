@@ -57,6 +57,11 @@ struct OnnxBuilder : DialectBuilder {
   // ONNXDimGroupOp
   void dimGroup(mlir::Value input, int axis, int groupID) const;
 
+  // ONNXGemmOp
+  mlir::Value gemm(mlir::Type Y, mlir::Value A, mlir::Value B, mlir::Value C,
+      float alpha = 1.0, float beta = 1.0, bool transA = false,
+      bool transB = false) const;
+
   // ONNXMatMulOp or ONNXGemmOp
   mlir::Value matmul(
       mlir::Type Y, mlir::Value A, mlir::Value B, bool useGemm = false) const;
@@ -68,6 +73,9 @@ struct OnnxBuilder : DialectBuilder {
   mlir::Value mul(mlir::Value A, mlir::Value B) const;
   mlir::Value mul(mlir::Type resultType, mlir::Value A, mlir::Value B) const;
 
+  // ONNXNoneOp
+  mlir::Value none() const;
+
   // ONNXReduceSumOp
   mlir::Value reduceSum(mlir::Type outputType, mlir::Value data,
       mlir::Value axes, bool keepDims = true,
@@ -11,6 +11,7 @@
 #include "src/Dialect/ONNX/ElementsAttr/DisposableElementsAttr.hpp"
 #include "src/Dialect/ONNX/ElementsAttr/DisposableElementsAttributeStorage.hpp"
 
+#include "src/Dialect/ONNX/ElementsAttr/ElementsAttrHelper.hpp"
 #include "src/Dialect/ONNX/ElementsAttr/Strides.hpp"
 #include "src/Support/TypeUtilities.hpp"
 
@@ -143,7 +144,16 @@ void DisposableElementsAttr::readWideNums(MutableArrayRef<WideNum> dst) const {
     return;
   }
   ArrayBuffer<WideNum> src = getBufferAsWideNums();
-  restrideArray<WideNum>(getShape(), getStrides(), src.get(), dst);
+  StridedArrayRef<WideNum> stridedSrc(src.get(), getStrides());
+  parallelForSlices(getContext(), getShape(),
+      [&](ArrayRef<int64_t> sliceShape, ArrayRef<int64_t> startIndices,
+          size_t flatBegin) {
+        auto srcSlice = sliceStridedArray(stridedSrc, startIndices);
+        auto dstSlice =
+            dst.slice(flatBegin, ShapedType::getNumElements(sliceShape));
+        restrideArray<WideNum>(
+            sliceShape, srcSlice.strides, srcSlice, dstSlice);
+      });
 }
 
 DenseElementsAttr DisposableElementsAttr::toDenseElementsAttr() const {
@@ -245,11 +255,21 @@ void DisposableElementsAttr::printAsDenseElementsAttr(
   }
 }
 
-void DisposableElementsAttr::readBytesAsWideNums(
-    ArrayRef<char> srcBytes, llvm::MutableArrayRef<WideNum> dst) const {
-  widenArray(getBufferBType(), srcBytes, dst);
-  if (const Transformer &transformer = getTransformer())
-    transformer(dst);
+void DisposableElementsAttr::readBytesAsWideNums(ArrayRef<char> srcBytes,
+    llvm::MutableArrayRef<WideNum> dst, size_t bufferPos) const {
+  // The transformer is element-wise so large arrays are widened and
+  // transformed in independent chunks in parallel.
+  BType bufferBType = getBufferBType();
+  unsigned bytewidth = bytewidthOfBType(bufferBType);
+  const Transformer &transformer = getTransformer();
+  parallelForChunks(getContext(), dst.size(), [&](size_t begin, size_t end) {
+    MutableArrayRef<WideNum> dstChunk = dst.slice(begin, end - begin);
+    widenArray(bufferBType,
+        srcBytes.slice(begin * bytewidth, (end - begin) * bytewidth),
+        dstChunk);
+    if (transformer)
+      transformer(bufferPos + begin, dstChunk);
+  });
 }
 
 ArrayRef<char> DisposableElementsAttr::getBufferBytes() const {
@@ -272,7 +292,7 @@ WideNum DisposableElementsAttr::atFlatIndex(size_t flatIndex) const {
   ArrayRef<char> bytes =
       getBufferBytes().slice(pos * bufBytewidth, bufBytewidth);
   WideNum n;
-  readBytesAsWideNums(bytes, llvm::MutableArrayRef(n));
+  readBytesAsWideNums(bytes, llvm::MutableArrayRef(n), pos);
   return n;
 }
 
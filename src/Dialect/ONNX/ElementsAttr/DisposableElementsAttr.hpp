@@ -49,7 +49,9 @@ struct DisposableElementsAttributeStorage;
 //
 // 3. Element wise transformations are recorded lazily as a lambda and
 // only materialized on read thus avoiding some memory allocations and
-// copies.
+// copies. The lambda gets the buffer positions of the elements, so that
+// combining a tensor with a small tensor broadcast to it, like a per-channel
+// scale or bias, is also recorded lazily.
 //
 // 4. Similarly, some tensor shape transformations can be recorded as
 // 'strides' metadata without rewriting the underlying data. In particular,
@@ -92,7 +94,10 @@ class DisposableElementsAttr
   using WideNum = onnx_mlir::WideNum;
 
   using Buffer = std::shared_ptr<llvm::MemoryBuffer>;
-  using Transformer = std::function<void(llvm::MutableArrayRef<WideNum>)>;
+  // A transformer mutates a chunk of elements, given the buffer position of
+  // the first element of the chunk.
+  using Transformer =
+      std::function<void(size_t, llvm::MutableArrayRef<WideNum>)>;
 
 public:
   // DisposablePool needs access to the private create(), getId(), and dispose()
@@ -280,9 +285,10 @@ public:
 
 private:
   // Widens and transforms bytes into WideNums in accordance with
-  // bufferDType and transformer.
-  void readBytesAsWideNums(
-      ArrayRef<char> bytes, llvm::MutableArrayRef<WideNum>) const;
+  // bufferDType and transformer, where bytes start at buffer position
+  // bufferPos.
+  void readBytesAsWideNums(ArrayRef<char> bytes,
+      llvm::MutableArrayRef<WideNum>, size_t bufferPos = 0) const;
 
   // Similar to DenseElementsAttr::getRawData() in that it returns the
   // underlying raw data, but the data representation can be further removed
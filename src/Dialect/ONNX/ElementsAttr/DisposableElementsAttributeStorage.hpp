@@ -21,7 +21,8 @@ namespace mlir {
 
 struct DisposableElementsAttributeStorage : public AttributeStorage {
   using Buffer = std::shared_ptr<llvm::MemoryBuffer>;
-  using Transformer = std::function<void(llvm::MutableArrayRef<WideNum>)>;
+  using Transformer =
+      std::function<void(size_t, llvm::MutableArrayRef<WideNum>)>;
   using KeyTy = std::tuple<ShapedType, ArrayRef<int64_t>, onnx_mlir::BType,
       onnx_mlir::BType, bool, size_t>;
   static constexpr int TYPE = 0;
@@ -10,6 +10,7 @@
 
 #include "src/Dialect/ONNX/ElementsAttr/DisposablePool.hpp"
 
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/DenseMap.h"
 
 #include <atomic>
@@ -40,28 +41,44 @@ ElementsAttr DisposablePool::createElementsAttr(ShapedType type,
 }
 
 namespace {
+// Calls act on the attributes of the ops nested in moduleOp. The ops of the
+// module body are walked in parallel, act must be thread safe.
 template <typename Action>
 void walkOpsAttrs(ModuleOp moduleOp, DisposablePool::OpAttrDictionary opsAttrs,
     const Action &act) {
   llvm::SmallDenseMap<StringRef, StringRef> opAttrMap(
       opsAttrs.begin(), opsAttrs.end());
-  moduleOp.walk([&opAttrMap, &act](Operation *op) {
-    auto opAttr = opAttrMap.find(op->getName().getIdentifier());
-    if (opAttr != opAttrMap.end()) {
-      StringRef attrName = opAttr->second;
-      if (auto attr = op->getAttrOfType<DisposableElementsAttr>(attrName))
-        act(op, attrName, attr);
-    }
+  SmallVector<Operation *> bodyOps;
+  for (Operation &op : moduleOp.getBody()->getOperations())
+    bodyOps.push_back(&op);
+  parallelForEach(moduleOp.getContext(), bodyOps, [&](Operation *bodyOp) {
+    bodyOp->walk([&opAttrMap, &act](Operation *op) {
+      auto opAttr = opAttrMap.find(op->getName().getIdentifier());
+      if (opAttr != opAttrMap.end()) {
+        StringRef attrName = opAttr->second;
+        if (auto attr = op->getAttrOfType<DisposableElementsAttr>(attrName))
+          act(op, attrName, attr);
+      }
+    });
   });
 }
 } // namespace
 
 void DisposablePool::garbageCollectUnreachable(
     ModuleOp moduleOp, OpAttrDictionary opsAttrs) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    if (numInsertedSinceCollection == 0)
+      return;
+  }
+
   Pool reachable;
+  std::mutex reachableMutex;
   walkOpsAttrs(moduleOp, opsAttrs,
-      [&reachable](Operation *op, StringRef attrName,
+      [&reachable, &reachableMutex](Operation *op, StringRef attrName,
           DisposableElementsAttr disposable) {
+        const std::lock_guard<std::mutex> lock(reachableMutex);
         reachable.try_emplace(disposable.getId(), disposable);
       });
 
@@ -77,15 +94,25 @@ void DisposablePool::garbageCollectUnreachable(
 
 void DisposablePool::scrub(mlir::ModuleOp moduleOp, OpAttrDictionary opsAttrs) {
   std::unordered_map<size_t, mlir::DenseElementsAttr> scrubbed;
+  std::mutex scrubbedMutex;
   walkOpsAttrs(moduleOp, opsAttrs,
-      [&scrubbed](Operation *op, StringRef attrName,
+      [&scrubbed, &scrubbedMutex](Operation *op, StringRef attrName,
           DisposableElementsAttr disposable) {
-        auto insertion = scrubbed.try_emplace(disposable.getId(), nullptr);
-        auto iter = insertion.first;
-        if (insertion.second) { // disposable was inserted
-          iter->second = disposable.toDenseElementsAttr();
+        DenseElementsAttr dense;
+        {
+          const std::lock_guard<std::mutex> lock(scrubbedMutex);
+          auto iter = scrubbed.find(disposable.getId());
+          if (iter != scrubbed.end())
+            dense = iter->second;
+        }
+        if (!dense) {
+          // Converted outside of the lock, two threads converting the same
+          // disposable get the same uniqued DenseElementsAttr.
+          dense = disposable.toDenseElementsAttr();
+          const std::lock_guard<std::mutex> lock(scrubbedMutex);
+          scrubbed.try_emplace(disposable.getId(), dense);
         }
-        op->setAttr(attrName, iter->second);
+        op->setAttr(attrName, dense);
       });
 
   {
@@ -120,11 +147,13 @@ bool DisposablePool::insert(DisposableElementsAttr disposable) {
   auto insertion = pool.try_emplace(disposable.getId(), disposable);
   if (!insertion.second)
     llvm_unreachable("cannot insert existing DisposableElementsAttr");
+  ++numInsertedSinceCollection;
   return true;
 }
 
 void DisposablePool::eraseUnreachable(const Pool &reachable) {
   // Assumes caller holds the mutex.
+  numInsertedSinceCollection = 0;
   for (Pool::iterator it = pool.begin(); it != pool.end();) {
     if (reachable.count(it->first) == 0) {
       // The attribute is unreachable, so we reset the buffer payload shared_ptr
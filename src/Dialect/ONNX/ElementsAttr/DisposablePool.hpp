@@ -21,7 +21,9 @@
 // module level compiler passes: They assume there are no other references to
 // DisposableElementsAttr instances than in attributes in ops within moduleOp.
 // The opsAttrs argument filters the ops and attributes traversal to inspect
-// only the specified op names and attribute names.
+// only the specified op names and attribute names. The ops nested in the
+// module, e.g. its functions, are traversed in parallel when multithreading
+// is enabled in the context.
 //
 //===----------------------------------------------------------------------===//
 
@@ -61,7 +63,11 @@ public:
       mlir::DisposableElementsAttr::Transformer transformer);
 
   // Disposes every DisposableElementsAttr in the pool which is unreachable
-  // (doesn't appear in moduleOp).
+  // (doesn't appear in moduleOp). Does nothing if no DisposableElementsAttr
+  // was created since the last garbage collection: the garbage of the passes
+  // which only drop attributes, e.g. by erasing dead constants, is rare and
+  // collected by the next collection, which avoids traversing the module
+  // after most passes.
   void garbageCollectUnreachable(
       mlir::ModuleOp moduleOp, OpAttrDictionary opsAttrs);
 
@@ -90,8 +96,12 @@ private:
 
   Pool pool;
   bool active = true;
+  // Number of DisposableElementsAttr inserted since the last garbage
+  // collection.
+  size_t numInsertedSinceCollection = 0;
 
-  // Guards all access to instance variables pool and active.
+  // Guards all access to instance variables pool, active and
+  // numInsertedSinceCollection.
   // It is mutable so that it can be used in const methods.
   mutable std::mutex mutex;
 };
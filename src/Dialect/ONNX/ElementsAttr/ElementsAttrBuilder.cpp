@@ -16,6 +16,8 @@
 #include "src/Dialect/ONNX/ElementsAttr/Strides.hpp"
 #include "src/Support/TypeUtilities.hpp"
 
+#include "mlir/IR/Threading.h"
+
 #include <numeric>
 
 using namespace mlir;
@@ -128,6 +130,16 @@ ElementsAttr ElementsAttrBuilder::combine(ElementsAttr lhs, ElementsAttr rhs,
             [rhsNum, combiner](WideNum n) { return combiner(n, rhsNum); }));
   }
 
+  // Keep chains like Mul(Add(x, bias), scale) lazy when the bias and scale
+  // are broadcast, e.g. per channel, so they are evaluated in one pass when
+  // the result is read.
+  if (ElementsAttr lazy = combineWithBroadcast(
+          lhs, rhs, /*broadcastIsLhs=*/false, combinedType, combiner))
+    return lazy;
+  if (ElementsAttr lazy = combineWithBroadcast(
+          rhs, lhs, /*broadcastIsLhs=*/true, combinedType, combiner))
+    return lazy;
+
   auto combinedShape = combinedType.getShape();
 
   SmallVector<int64_t, 4> xpLhsStrides;
@@ -141,8 +153,14 @@ ElementsAttr ElementsAttrBuilder::combine(ElementsAttr lhs, ElementsAttr rhs,
   StridedArrayRef<WideNum> stridedRhs(rhsNums.get(), xpRhsStrides);
 
   return fromWideNums(combinedType, [&](MutableArrayRef<WideNum> dstNums) {
-    mapStrides<WideNum, WideNum, WideNum>(
-        combinedShape, dstNums, stridedLhs, stridedRhs, combiner);
+    parallelForSlices(combinedType.getContext(), combinedShape,
+        [&](ArrayRef<int64_t> sliceShape, ArrayRef<int64_t> startIndices,
+            size_t flatBegin) {
+          mapStrides<WideNum, WideNum, WideNum>(sliceShape,
+              dstNums.slice(flatBegin, ShapedType::getNumElements(sliceShape)),
+              sliceStridedArray(stridedLhs, startIndices),
+              sliceStridedArray(stridedRhs, startIndices), combiner);
+        });
   });
 }
 
@@ -170,6 +188,7 @@ ElementsAttr ElementsAttrBuilder::where(ElementsAttr cond, ElementsAttr lhs,
   SmallVector<int64_t, 4> xpCondStrides;
   ArrayBuffer<WideNum> condNums =
       getWideNumsAndExpandedStrides(cond, combinedShape, xpCondStrides);
+  StridedArrayRef<WideNum> stridedCond(condNums.get(), xpCondStrides);
 
   SmallVector<int64_t, 4> xpLhsStrides;
   ArrayBuffer<WideNum> lhsNums =
@@ -182,21 +201,31 @@ ElementsAttr ElementsAttrBuilder::where(ElementsAttr cond, ElementsAttr lhs,
   StridedArrayRef<WideNum> stridedRhs(rhsNums.get(), xpRhsStrides);
 
   return fromWideNums(combinedType, [&](MutableArrayRef<WideNum> dstNums) {
-    // Copy cond into dstNums with broadcast.
-    restrideArray<WideNum>(
-        combinedShape, xpCondStrides, condNums.get(), dstNums);
-
-    WideNum *end = traverseStrides<WideNum *, WideNum, WideNum>(combinedShape,
-        dstNums.begin(), stridedLhs, stridedRhs,
-        [](WideNum *res, const WideNum *x, const WideNum *y) {
-          *res = res->u64 ? *x : *y;
+    parallelForSlices(combinedType.getContext(), combinedShape,
+        [&](ArrayRef<int64_t> sliceShape, ArrayRef<int64_t> startIndices,
+            size_t flatBegin) {
+          auto condSlice = sliceStridedArray(stridedCond, startIndices);
+          auto dstSlice =
+              dstNums.slice(flatBegin, ShapedType::getNumElements(sliceShape));
+          // Copy cond into dstSlice with broadcast.
+          restrideArray<WideNum>(
+              sliceShape, condSlice.strides, condSlice, dstSlice);
+
+          WideNum *end = traverseStrides<WideNum *, WideNum, WideNum>(
+              sliceShape, dstSlice.begin(),
+              sliceStridedArray(stridedLhs, startIndices),
+              sliceStridedArray(stridedRhs, startIndices),
+              [](WideNum *res, const WideNum *x, const WideNum *y) {
+                *res = res->u64 ? *x : *y;
+              });
+          assert(end == dstSlice.end() && "traverses every dstSlice element");
         });
-    assert(end == dstNums.end() && "traverses every dstNums element");
   });
 }
 
 namespace {
-using ElementsTransformer = std::function<void(llvm::MutableArrayRef<WideNum>)>;
+using ElementsTransformer =
+    std::function<void(size_t, llvm::MutableArrayRef<WideNum>)>;
 
 ElementsTransformer composeTransforms(
     ElementsTransformer first, ElementsTransformer second) {
@@ -204,9 +233,9 @@ ElementsTransformer composeTransforms(
     return second;
   else
     return [fst = std::move(first), snd = std::move(second)](
-               MutableArrayRef<WideNum> dst) {
-      fst(dst);
-      snd(dst);
+               size_t bufferPos, MutableArrayRef<WideNum> dst) {
+      fst(bufferPos, dst);
+      snd(bufferPos, dst);
     };
 }
 
@@ -449,6 +478,142 @@ ElementsAttr ElementsAttrBuilder::reduce(ElementsAttr elms,
   });
 }
 
+namespace {
+// Number of rows of the result of a matmul computed by each parallel task.
+constexpr int64_t matMulRowBlock = 32;
+// Number of rows of the rhs of a matmul accumulated into a block of rows of
+// the result at a time, sized for the rows to stay in cache.
+constexpr int64_t matMulDepthBlock = 128;
+
+// Computes dst[b] = a[b] * b[b] for each batch b of M x K matrices a and
+// K x N matrices b, in the wide type T of the elements. The matrices of
+// batch b start at aOffsets[b] and bOffsets[b] in a and b, with the given
+// strides of their rows and columns, and dst is row-major. Each batch of b
+// is first packed row-major, then the blocks of rows of dst are computed in
+// parallel, accumulating matMulDepthBlock rows of b at a time.
+template <typename T>
+void matMulImpl(MLIRContext *ctx, ArrayRef<WideNum> a,
+    ArrayRef<int64_t> aOffsets, int64_t aRowStride, int64_t aColStride,
+    ArrayRef<WideNum> b, ArrayRef<int64_t> bOffsets, int64_t bRowStride,
+    int64_t bColStride, int64_t M, int64_t K, int64_t N,
+    MutableArrayRef<WideNum> dst) {
+  constexpr BType btype = toBType<T>;
+  int64_t numBatches = aOffsets.size();
+  // Pack each distinct batch of b once, as the batches of b are often
+  // broadcast.
+  SmallVector<int64_t, 4> packedIndex(numBatches);
+  SmallVector<int64_t, 4> packedOffsets;
+  for (int64_t batch = 0; batch < numBatches; ++batch) {
+    auto it = llvm::find(packedOffsets, bOffsets[batch]);
+    packedIndex[batch] = it - packedOffsets.begin();
+    if (it == packedOffsets.end())
+      packedOffsets.push_back(bOffsets[batch]);
+  }
+  std::vector<T> packed(packedOffsets.size() * K * N);
+  for (size_t i = 0; i < packedOffsets.size(); ++i)
+    for (int64_t k = 0; k < K; ++k)
+      for (int64_t n = 0; n < N; ++n) {
+        WideNum bVal = b[packedOffsets[i] + k * bRowStride + n * bColStride];
+        packed[(i * K + k) * N + n] = bVal.to<T>(btype);
+      }
+
+  int64_t rowBlocks = (M + matMulRowBlock - 1) / matMulRowBlock;
+  auto computeRowBlock = [&](size_t task) {
+    int64_t batch = task / rowBlocks;
+    int64_t rowBegin = (task % rowBlocks) * matMulRowBlock;
+    int64_t rowEnd = std::min(rowBegin + matMulRowBlock, M);
+    const T *bBatch = packed.data() + packedIndex[batch] * K * N;
+    std::vector<T> acc((rowEnd - rowBegin) * N, T(0));
+    for (int64_t kBegin = 0; kBegin < K; kBegin += matMulDepthBlock) {
+      int64_t kEnd = std::min(kBegin + matMulDepthBlock, K);
+      for (int64_t m = rowBegin; m < rowEnd; ++m) {
+        T *accRow = acc.data() + (m - rowBegin) * N;
+        const WideNum *aRow = a.data() + aOffsets[batch] + m * aRowStride;
+        for (int64_t k = kBegin; k < kEnd; ++k) {
+          T aVal = aRow[k * aColStride].to<T>(btype);
+          const T *bRow = bBatch + k * N;
+          for (int64_t n = 0; n < N; ++n)
+            accRow[n] += aVal * bRow[n];
+        }
+      }
+    }
+    WideNum *dstRows = dst.data() + (batch * M + rowBegin) * N;
+    for (size_t i = 0; i < acc.size(); ++i)
+      dstRows[i] = WideNum::from<T>(btype, acc[i]);
+  };
+  int64_t numTasks = numBatches * rowBlocks;
+  if (numBatches * M * N * K < minParallelChunkSize) {
+    for (int64_t task = 0; task < numTasks; ++task)
+      computeRowBlock(task);
+  } else {
+    parallelFor(ctx, 0, numTasks, computeRowBlock);
+  }
+}
+} // namespace
+
+ElementsAttr ElementsAttrBuilder::matMul(
+    ElementsAttr lhs, ElementsAttr rhs, ShapedType resultType) {
+  Type elementType = resultType.getElementType();
+  assert(!elementType.isInteger(1) && "matMul does not support bool");
+  // Promote the vectors to matrices, the result has the same elements.
+  if (lhs.getType().getRank() == 1)
+    lhs = reshape(lhs, {1, lhs.getType().getDimSize(0)});
+  if (rhs.getType().getRank() == 1)
+    rhs = reshape(rhs, {rhs.getType().getDimSize(0), 1});
+  ArrayRef<int64_t> lhsShape = lhs.getType().getShape();
+  ArrayRef<int64_t> rhsShape = rhs.getType().getShape();
+  int64_t M = lhsShape.end()[-2];
+  int64_t K = lhsShape.back();
+  int64_t N = rhsShape.back();
+  assert(rhsShape.end()[-2] == K && "matMul reduced dims mismatch");
+
+  // Broadcast the batch dims.
+  ArrayRef<int64_t> lhsBatch = lhsShape.drop_back(2);
+  ArrayRef<int64_t> rhsBatch = rhsShape.drop_back(2);
+  size_t batchRank = std::max(lhsBatch.size(), rhsBatch.size());
+  SmallVector<int64_t, 4> batchShape(batchRank, 1);
+  for (size_t i = 0; i < batchRank; ++i) {
+    if (i + lhsBatch.size() >= batchRank)
+      batchShape[i] = lhsBatch[i + lhsBatch.size() - batchRank];
+    if (i + rhsBatch.size() >= batchRank)
+      batchShape[i] =
+          std::max(batchShape[i], rhsBatch[i + rhsBatch.size() - batchRank]);
+  }
+  SmallVector<int64_t, 6> lhsExpandedShape(batchShape);
+  SmallVector<int64_t, 6> rhsExpandedShape(batchShape);
+  lhsExpandedShape.append({M, K});
+  rhsExpandedShape.append({K, N});
+  SmallVector<int64_t, 6> lhsStrides, rhsStrides;
+  ArrayBuffer<WideNum> lhsNums =
+      getWideNumsAndExpandedStrides(lhs, lhsExpandedShape, lhsStrides);
+  ArrayBuffer<WideNum> rhsNums =
+      getWideNumsAndExpandedStrides(rhs, rhsExpandedShape, rhsStrides);
+
+  // The offsets of the matrices of each batch.
+  int64_t numBatches = ShapedType::getNumElements(batchShape);
+  SmallVector<int64_t, 4> lhsOffsets, rhsOffsets;
+  for (int64_t batch = 0; batch < numBatches; ++batch) {
+    SmallVector<int64_t, 4> indices = unflattenIndex(batchShape, batch);
+    int64_t lhsOffset = 0, rhsOffset = 0;
+    for (size_t i = 0; i < batchRank; ++i) {
+      lhsOffset += indices[i] * lhsStrides[i];
+      rhsOffset += indices[i] * rhsStrides[i];
+    }
+    lhsOffsets.push_back(lhsOffset);
+    rhsOffsets.push_back(rhsOffset);
+  }
+
+  return fromWideNums(resultType, [&](MutableArrayRef<WideNum> dstNums) {
+    wideZeroDispatchNonBool(elementType, [&](auto wideZero) {
+      using T = decltype(wideZero);
+      matMulImpl<T>(resultType.getContext(), lhsNums.get(), lhsOffsets,
+          lhsStrides[batchRank], lhsStrides[batchRank + 1], rhsNums.get(),
+          rhsOffsets, rhsStrides[batchRank], rhsStrides[batchRank + 1], M, K,
+          N, dstNums);
+    });
+  });
+}
+
 auto ElementsAttrBuilder::getElementsProperties(ElementsAttr elements) const
     -> ElementsProperties {
   static Transformer nullTransformer = nullptr;
@@ -513,6 +678,82 @@ ElementsAttr ElementsAttrBuilder::expandAndTransform(ElementsAttr elms,
       composeTransforms(props.transformer, std::move(transformer)));
 }
 
+namespace {
+// An operand broadcast to the other operand of a combine is combined lazily
+// if it has at most 1/lazyCombineMinBroadcast of the combined elements.
+constexpr int64_t lazyCombineMinBroadcast = 16;
+
+// A dim of the combined shape, with the strides of the buffer of the full
+// operand and of the broadcast operand.
+struct LazyCombineDim {
+  int64_t size;
+  int64_t bufferStride;
+  int64_t broadcastStride;
+};
+} // namespace
+
+ElementsAttr ElementsAttrBuilder::combineWithBroadcast(ElementsAttr elms,
+    ElementsAttr broadcast, bool broadcastIsLhs, ShapedType combinedType,
+    WideNum (*combiner)(WideNum, WideNum)) {
+  auto combinedShape = combinedType.getShape();
+  if (elms.getType().getShape() != combinedShape ||
+      broadcast.size() * lazyCombineMinBroadcast >
+          combinedType.getNumElements())
+    return nullptr;
+
+  ElementsProperties props = getElementsProperties(elms);
+  SmallVector<int64_t, 4> xpBroadcastStrides;
+  ArrayBuffer<WideNum> broadcastNums = getWideNumsAndExpandedStrides(
+      broadcast, combinedShape, xpBroadcastStrides);
+
+  // The buffer must hold every element once, in the order of some
+  // permutation of the dims, for the buffer positions to map to the indices
+  // of the elements. The dims are ordered from the innermost in the buffer.
+  SmallVector<LazyCombineDim, 4> dims;
+  for (size_t i = 0; i < combinedShape.size(); ++i)
+    if (combinedShape[i] != 1)
+      dims.push_back(
+          {combinedShape[i], props.strides[i], xpBroadcastStrides[i]});
+  llvm::sort(dims, [](const LazyCombineDim &a, const LazyCombineDim &b) {
+    return a.bufferStride < b.bufferStride;
+  });
+  int64_t bufferStride = 1;
+  for (const LazyCombineDim &dim : dims) {
+    if (dim.bufferStride != bufferStride)
+      return nullptr;
+    bufferStride *= dim.size;
+  }
+
+  // Copy the broadcast elements, which are few, so that the transformer owns
+  // them.
+  auto nums = std::make_shared<const std::vector<WideNum>>(
+      broadcastNums.get().begin(), broadcastNums.get().end());
+  auto transformer = [dims = std::move(dims), nums = std::move(nums),
+                         broadcastIsLhs, combiner](
+                         size_t bufferPos, MutableArrayRef<WideNum> data) {
+    SmallVector<int64_t, 4> indices(dims.size());
+    int64_t pos = 0;
+    for (size_t i = 0; i < dims.size(); ++i) {
+      indices[i] = (bufferPos / dims[i].bufferStride) % dims[i].size;
+      pos += indices[i] * dims[i].broadcastStride;
+    }
+    for (WideNum &n : data) {
+      WideNum b = (*nums)[pos];
+      n = broadcastIsLhs ? combiner(b, n) : combiner(n, b);
+      // Step to the next buffer position.
+      for (size_t i = 0; i < dims.size(); ++i) {
+        pos += dims[i].broadcastStride;
+        if (++indices[i] < dims[i].size)
+          break;
+        pos -= indices[i] * dims[i].broadcastStride;
+        indices[i] = 0;
+      }
+    }
+  };
+  return create(combinedType, props.bufferBType, props.strides, props.buffer,
+      composeTransforms(props.transformer, std::move(transformer)));
+}
+
 ElementsAttr ElementsAttrBuilder::fromRawBytes(
     ShapedType type, BType bufferBType, const Filler<char> &bytesFiller) {
   size_t size = type.getNumElements() * bytewidthOfBType(bufferBType);
@@ -88,7 +88,8 @@ public:
   // Constructs new underlying data by applying the combiner, except in the
   // case where one of the arguments is splat, in that case reuses the other
   // argument's underlying data and just adds the necessary transformation
-  // and broadcast.
+  // and broadcast. Large underlying data is constructed in parallel, so
+  // combiner must be thread safe.
   mlir::ElementsAttr combine(mlir::ElementsAttr lhs, mlir::ElementsAttr rhs,
       mlir::ShapedType combinedType, WideNum (*combiner)(WideNum, WideNum));
 
@@ -140,6 +141,15 @@ public:
       llvm::ArrayRef<unsigned> axes, bool keepdims,
       WideNum (*reducer)(WideNum, WideNum));
 
+  // Returns the matrix product of lhs and rhs like the ONNX MatMul op, with
+  // resultType, broadcasting their batch dims. The element type must not be
+  // bool.
+  //
+  // Constructs new underlying data, computing blocks of rows of the result
+  // in parallel.
+  mlir::ElementsAttr matMul(mlir::ElementsAttr lhs, mlir::ElementsAttr rhs,
+      mlir::ShapedType resultType);
+
 private:
   struct ElementsProperties;
 
@@ -155,19 +165,30 @@ private:
       llvm::ArrayRef<int64_t> expandedShape,
       llvm::SmallVectorImpl<int64_t> &expandedStrides) const;
 
-  // A transformer mutates elements.
-  using Transformer = std::function<void(llvm::MutableArrayRef<WideNum>)>;
+  // A transformer mutates a chunk of elements, given the buffer position of
+  // the first element of the chunk.
+  using Transformer =
+      std::function<void(size_t, llvm::MutableArrayRef<WideNum>)>;
 
   // Constructs a transformer that changes every element to the result of
   // applying the given function to the element.
   template <typename Function = WideNum (*)(WideNum)>
   static inline Transformer functionTransformer(Function fun) {
-    return [fun = std::move(fun)](llvm::MutableArrayRef<WideNum> data) -> void {
+    return [fun = std::move(fun)](
+               size_t, llvm::MutableArrayRef<WideNum> data) -> void {
       for (WideNum &n : data)
         n = fun(n);
     };
   }
 
+  // Combines elms with an operand broadcast to it lazily, with a transformer
+  // reading the operand at the buffer positions of elms, if elms has the
+  // combined shape, its buffer holds every element once, and the operand is
+  // small. Returns null otherwise.
+  mlir::ElementsAttr combineWithBroadcast(mlir::ElementsAttr elms,
+      mlir::ElementsAttr broadcast, bool broadcastIsLhs,
+      mlir::ShapedType combinedType, WideNum (*combiner)(WideNum, WideNum));
+
   mlir::ElementsAttr doTransform(mlir::ElementsAttr elms,
       mlir::Type transformedElementType, Transformer transformer);
 
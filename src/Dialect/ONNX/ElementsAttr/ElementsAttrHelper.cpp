@@ -13,7 +13,10 @@
 #include "src/Dialect/ONNX/ElementsAttr/BType.hpp"
 #include "src/Dialect/ONNX/ElementsAttr/DisposableElementsAttr.hpp"
 
+#include "src/Dialect/ONNX/ElementsAttr/Strides.hpp"
+
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Threading.h"
 
 #include <algorithm>
 
@@ -77,4 +80,48 @@ void readElementsWideNums(ElementsAttr elms, MutableArrayRef<WideNum> dst) {
   readDenseElementsWideNums(elms, dst);
 }
 
+void parallelForChunks(
+    MLIRContext *ctx, size_t size, function_ref<void(size_t, size_t)> fn) {
+  size_t numChunks = size / minParallelChunkSize;
+  if (numChunks <= 1)
+    return fn(0, size);
+  parallelFor(ctx, 0, numChunks, [&](size_t chunk) {
+    // The last chunk absorbs the remainder of the division.
+    size_t begin = chunk * minParallelChunkSize;
+    size_t end = chunk + 1 == numChunks ? size : begin + minParallelChunkSize;
+    fn(begin, end);
+  });
+}
+
+void parallelForSlices(MLIRContext *ctx, ArrayRef<int64_t> shape,
+    function_ref<void(ArrayRef<int64_t>, ArrayRef<int64_t>, size_t)> fn) {
+  int64_t numElements = ShapedType::getNumElements(shape);
+  int64_t numChunks = numElements / minParallelChunkSize;
+  if (numChunks <= 1)
+    return fn(shape, {}, 0);
+
+  // Split the first axis where the outer axes before it, together with the
+  // axis itself, have enough indices for numChunks slices. The axis is split
+  // into ranges of rows spanning about minParallelChunkSize elements.
+  unsigned axis = 0;
+  int64_t outerSize = 1;
+  while (outerSize * shape[axis] < numChunks)
+    outerSize *= shape[axis++];
+  int64_t axisSize = shape[axis];
+  int64_t rowSize = numElements / (outerSize * axisSize);
+  int64_t rowsPerSlice = std::max<int64_t>(1, minParallelChunkSize / rowSize);
+  int64_t slicesPerOuter = (axisSize + rowsPerSlice - 1) / rowsPerSlice;
+  ArrayRef<int64_t> outerShape = shape.take_front(axis);
+  parallelFor(ctx, 0, outerSize * slicesPerOuter, [&](size_t slice) {
+    int64_t outer = slice / slicesPerOuter;
+    int64_t rowBegin = (slice % slicesPerOuter) * rowsPerSlice;
+    int64_t rowEnd = std::min(rowBegin + rowsPerSlice, axisSize);
+    SmallVector<int64_t, 4> startIndices = unflattenIndex(outerShape, outer);
+    startIndices.push_back(rowBegin);
+    SmallVector<int64_t, 4> sliceShape(shape.drop_front(axis));
+    sliceShape[0] = rowEnd - rowBegin;
+    fn(sliceShape, startIndices, (outer * axisSize + rowBegin) * rowSize);
+  });
+}
+
 } // namespace onnx_mlir
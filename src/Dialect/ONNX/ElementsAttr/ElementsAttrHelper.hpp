@@ -16,6 +16,7 @@
 
 #include "mlir/IR/BuiltinAttributeInterfaces.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 
 #include <algorithm>
 
@@ -47,6 +48,29 @@ ArrayBuffer<WideNum> getElementsWideNums(mlir::ElementsAttr elms);
 void readElementsWideNums(
     mlir::ElementsAttr elms, llvm::MutableArrayRef<WideNum> dst);
 
+// Minimum number of elements per task when loops over the elements of large
+// ElementsAttrs are parallelized. Smaller loops run sequentially because the
+// thread pool overhead would outweigh the gains.
+constexpr int64_t minParallelChunkSize = 16384;
+
+// Calls fn(begin, end) for consecutive chunks of [0, size), in parallel with
+// the context's thread pool, or sequentially if multithreading is disabled.
+void parallelForChunks(mlir::MLIRContext *ctx, size_t size,
+    llvm::function_ref<void(size_t begin, size_t end)> fn);
+
+// Calls fn(sliceShape, startIndices, flatBegin) for slices that partition a
+// tensor with the given shape in row-major order, in parallel with the
+// context's thread pool. Each slice spans the axes from startIndices.size()-1
+// and onwards, with sliceShape, and starts at startIndices along the axes
+// before it and at flatBegin in row-major order. Use sliceStridedArray() to
+// map a strided array representation of the tensor to each slice.
+// If the tensor is small, fn is called once with the full shape and empty
+// startIndices.
+void parallelForSlices(mlir::MLIRContext *ctx, llvm::ArrayRef<int64_t> shape,
+    llvm::function_ref<void(llvm::ArrayRef<int64_t> sliceShape,
+        llvm::ArrayRef<int64_t> startIndices, size_t flatBegin)>
+        fn);
+
 // Include template implementations.
 #include "ElementsAttrHelper.hpp.inc"
 
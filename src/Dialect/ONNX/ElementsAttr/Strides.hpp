@@ -119,6 +119,19 @@ struct StridedArrayRef : public llvm::ArrayRef<T> {
       : Base(array), strides(strides) {}
 };
 
+// Returns the part of src that represents a slice of the tensor, which starts
+// at startIndices and spans the axes from startIndices.size()-1 and onwards,
+// as produced by parallelForSlices(). Returns src if startIndices is empty.
+template <typename T>
+StridedArrayRef<T> sliceStridedArray(
+    StridedArrayRef<T> src, llvm::ArrayRef<int64_t> startIndices) {
+  if (startIndices.empty())
+    return src;
+  size_t pos = getStridesPosition(startIndices, src.strides);
+  return StridedArrayRef<T>(src.drop_front(pos),
+      src.strides.drop_front(startIndices.size() - 1));
+}
+
 template <typename Iterator, typename... Args,
     typename Action = llvm::function_ref<void(Iterator, const Args *...)>>
 Iterator traverseStrides(llvm::ArrayRef<int64_t> shape, Iterator begin,
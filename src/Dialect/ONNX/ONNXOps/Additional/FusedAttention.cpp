@@ -0,0 +1,184 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- FusedAttention.cpp - ONNX Operations ----------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect FusedAttention operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Support
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXFusedAttentionOpShapeHelper::computeShape() {
+  ONNXFusedAttentionOpAdaptor operandAdaptor(operands);
+  Value Q = operandAdaptor.getQ();
+  Value V = operandAdaptor.getV();
+  bool isPaged = !isFromNone(operandAdaptor.getBlockTable());
+  int64_t rank = createIE->getShapedTypeRank(Q);
+
+  // Y has the batch dims and the query dim of Q, and the value dim of V. Batch
+  // dims are the same for Q and V, use a literal one if there is one. The
+  // first dim of a paged V is its blocks instead of the batch.
+  DimsExpr outputDims;
+  for (int64_t i = 0; i < rank - 1; ++i) {
+    IndexExpr dim = createIE->getShapeAsDim(Q, i);
+    if (i < rank - 2 && (i > 0 || !isPaged) && !dim.isLiteral()) {
+      IndexExpr vDim = createIE->getShapeAsDim(V, i);
+      if (vDim.isLiteral())
+        dim = vDim;
+    }
+    outputDims.emplace_back(dim);
+  }
+  outputDims.emplace_back(createIE->getShapeAsDim(V, rank - 1));
+  setOutputDims(outputDims);
+  return success();
+}
+
+} // namespace onnx_mlir
+
+//===----------------------------------------------------------------------===//
+// Verify
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXFusedAttentionOp::verify() {
+  ONNXFusedAttentionOpAdaptor operandAdaptor(*this);
+  Value Q = operandAdaptor.getQ();
+  Value K = operandAdaptor.getK();
+  Value V = operandAdaptor.getV();
+  Value mask = operandAdaptor.getMask();
+  if (!hasShapeAndRank(Q) || !hasShapeAndRank(K) || !hasShapeAndRank(V))
+    return success();
+
+  ArrayRef<int64_t> qShape = Q.getType().cast<ShapedType>().getShape();
+  ArrayRef<int64_t> kShape = K.getType().cast<ShapedType>().getShape();
+  ArrayRef<int64_t> vShape = V.getType().cast<ShapedType>().getShape();
+  int64_t rank = qShape.size();
+  if (rank < 2)
+    return emitOpError("Q must have a rank of at least 2");
+  if ((int64_t)kShape.size() != rank || (int64_t)vShape.size() != rank)
+    return emitOpError("Q, K and V must have the same rank");
+
+  // Static dims that must be the same.
+  auto mismatch = [](int64_t a, int64_t b) {
+    return !ShapedType::isDynamic(a) && !ShapedType::isDynamic(b) && a != b;
+  };
+  Value offsets = operandAdaptor.getSequenceOffsets();
+  Value blockTable = operandAdaptor.getBlockTable();
+  Value keyLength = operandAdaptor.getKeyLength();
+  bool isPaged = !isFromNone(blockTable);
+  if (!isPaged && !isFromNone(keyLength))
+    return emitOpError("the key length requires a block table");
+  int64_t numKeys = kShape[rank - 1];
+  if (isPaged) {
+    // Paged K and V are blocks [N, H..., P, D] and [N, H..., P, Dv].
+    if (isFromNone(keyLength))
+      return emitOpError("the block table requires a key length");
+    if (!isFromNone(offsets))
+      return emitOpError("the block table excludes sequence offsets");
+    if (rank < 3)
+      return emitOpError("with a block table, Q must have a rank of at "
+                         "least 3");
+    for (int64_t i = 1; i < rank - 2; ++i)
+      if (mismatch(qShape[i], kShape[i]) || mismatch(qShape[i], vShape[i]))
+        return emitOpError("Q, K and V must have the same head dimensions");
+    if (mismatch(kShape[0], vShape[0]) ||
+        mismatch(kShape[rank - 2], vShape[rank - 2]))
+      return emitOpError("K and V must have the same blocks");
+    if (mismatch(qShape[rank - 1], kShape[rank - 1]))
+      return emitOpError("with a block table, the last dimension of Q must be "
+                         "the last dimension of K");
+    if (hasShapeAndRank(blockTable)) {
+      ArrayRef<int64_t> tableShape =
+          blockTable.getType().cast<ShapedType>().getShape();
+      if (tableShape.size() != 2)
+        return emitOpError("the block table must be a 2D tensor");
+      if (mismatch(tableShape[0], qShape[0]))
+        return emitOpError("the block table must have a row per batch of Q");
+    }
+    if (hasShapeAndRank(keyLength)) {
+      ArrayRef<int64_t> lengthShape =
+          keyLength.getType().cast<ShapedType>().getShape();
+      if (lengthShape.size() != 1 || mismatch(lengthShape[0], 1))
+        return emitOpError("the key length must be a tensor<1xi64>");
+    }
+    numKeys = ShapedType::kDynamic;
+  } else {
+    for (int64_t i = 0; i < rank - 2; ++i)
+      if (mismatch(qShape[i], kShape[i]) || mismatch(qShape[i], vShape[i]))
+        return emitOpError("Q, K and V must have the same batch dimensions");
+    if (mismatch(qShape[rank - 1], kShape[rank - 2]))
+      return emitOpError("the last dimension of Q must be the second to last "
+                         "dimension of K");
+    if (mismatch(kShape[rank - 1], vShape[rank - 2]))
+      return emitOpError("the last dimension of K must be the second to last "
+                         "dimension of V");
+  }
+
+  // Packed sequences are along both the query and key dims.
+  if (!isFromNone(offsets) && hasShapeAndRank(offsets)) {
+    ArrayRef<int64_t> offsetsShape =
+        offsets.getType().cast<ShapedType>().getShape();
+    if (offsetsShape.size() != 1)
+      return emitOpError("the sequence offsets must be a 1D tensor");
+    if (offsetsShape[0] == 0)
+      return emitOpError("the sequence offsets must not be empty");
+    if (mismatch(qShape[rank - 2], kShape[rank - 1]))
+      return emitOpError("with sequence offsets, the second to last dimension "
+                         "of Q must be the last dimension of K");
+  }
+
+  // The mask is unidirectionally broadcastable to the scores [B..., S, T].
+  if (isFromNone(mask) || !hasShapeAndRank(mask))
+    return success();
+  ArrayRef<int64_t> maskShape = mask.getType().cast<ShapedType>().getShape();
+  int64_t maskRank = maskShape.size();
+  if (maskRank > rank)
+    return emitOpError("the mask must not have a higher rank than Q");
+  for (int64_t i = 0; i < maskRank; ++i) {
+    int64_t d = rank - maskRank + i;
+    int64_t scoreDim = (d == rank - 1) ? numKeys : qShape[d];
+    if (maskShape[i] != 1 && mismatch(maskShape[i], scoreDim))
+      return emitOpError("the mask is not broadcastable to the scores");
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXFusedAttentionOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  // If any of Q, K and V is not ranked tensor, do nothing.
+  if (!hasShapeAndRank(getQ()) || !hasShapeAndRank(getK()) ||
+      !hasShapeAndRank(getV()))
+    return success();
+  Type elementType = getQ().getType().cast<ShapedType>().getElementType();
+  ONNXFusedAttentionOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateType(elementType);
+}
+
+//===----------------------------------------------------------------------===//
+// Template instantiation
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+template struct ONNXNonSpecificOpShapeHelper<ONNXFusedAttentionOp>;
+} // namespace onnx_mlir
@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------- FusedConv.cpp - ONNX Operations ------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect FusedConv operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Dialect/ONNX/ONNXOps/ShapeHelper.hpp"
+
+#include "src/Dialect/ONNX/ONNXOps/NN/NNHelper.cpp.inc"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Support
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXFusedConvOpShapeHelper::computeShape() {
+  ONNXFusedConvOp convOp = llvm::cast<ONNXFusedConvOp>(op);
+  ONNXFusedConvOpAdaptor operandAdaptor = ONNXFusedConvOpAdaptor(operands);
+  return customComputeShape(operandAdaptor.getX(), operandAdaptor.getW(),
+      convOp.getKernelShape(), convOp.getAutoPad(), convOp.getPads(),
+      convOp.getStrides(), convOp.getDilations(), /*hasFilter*/ true,
+      /*ceil mode*/ false);
+}
+
+} // namespace onnx_mlir
+
+//===----------------------------------------------------------------------===//
+// Verify
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXFusedConvOp::verify() {
+  // Activations and their parameters.
+  size_t numActivations = getActivations().size();
+  for (Attribute activation : getActivations()) {
+    StringRef name = activation.cast<StringAttr>().getValue();
+    if (name != "Relu" && name != "LeakyRelu" && name != "Clip")
+      return emitOpError("unsupported activation ") << name;
+  }
+  Optional<ArrayAttr> alphaOpt = getActivationAlpha();
+  if (alphaOpt.has_value() && ArrayAttrSize(alphaOpt) != numActivations)
+    return emitOpError("activation_alpha must have one value per activation");
+  Optional<ArrayAttr> betaOpt = getActivationBeta();
+  if (betaOpt.has_value() && ArrayAttrSize(betaOpt) != numActivations)
+    return emitOpError("activation_beta must have one value per activation");
+
+  // Convolution, same checks as for ONNXConvOp.
+  ONNXFusedConvOpAdaptor operandAdaptor = ONNXFusedConvOpAdaptor(*this);
+  Value X = operandAdaptor.getX();
+  Value W = operandAdaptor.getW();
+  Value B = operandAdaptor.getB();
+  int64_t g = getGroup();
+  if (g < 1)
+    return emitOpError("group must be strictly positive");
+  if (!hasShapeAndRank(W))
+    return success();
+  ArrayRef<int64_t> wShape = W.getType().cast<ShapedType>().getShape();
+  int64_t spatialRank = wShape.size() - 2;
+  if (spatialRank < 1)
+    return emitOpError("Spatial rank must be strictly positive");
+  if (wShape[0] != ShapedType::kDynamic && wShape[0] % g != 0)
+    return emitOpError(
+        "Channel Out (M) must be a multiple of the number of groups");
+  if (hasShapeAndRank(X)) {
+    ArrayRef<int64_t> xShape = X.getType().cast<ShapedType>().getShape();
+    if ((int64_t)xShape.size() - 2 != spatialRank)
+      return emitOpError("Input and filter rank mismatch");
+    if (xShape[1] != ShapedType::kDynamic &&
+        wShape[1] != ShapedType::kDynamic && xShape[1] != wShape[1] * g)
+      return emitOpError("Channel In (C) of input must be equal 2nd dim "
+                         "of weights times g");
+  }
+  if (!isFromNone(B) && hasShapeAndRank(B)) {
+    ArrayRef<int64_t> bShape = B.getType().cast<ShapedType>().getShape();
+    if (bShape.size() != 1)
+      return emitOpError("Bias should have a rank of one");
+    if (bShape[0] != ShapedType::kDynamic &&
+        wShape[0] != ShapedType::kDynamic && wShape[0] != bShape[0])
+      return emitOpError(
+          "Bias should have same dimension as first dimension of weights");
+  }
+  if (failed(verifyKernelShape<ONNXFusedConvOp>(
+          this, W, getKernelShape(), spatialRank)))
+    return failure();
+  if (failed(verifyStrides<ONNXFusedConvOp>(this, spatialRank)))
+    return failure();
+  if (failed(verifyDilations<ONNXFusedConvOp>(this, spatialRank)))
+    return failure();
+  if (failed(verifyPadding<ONNXFusedConvOp>(this, spatialRank)))
+    return failure();
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXFusedConvOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  // The activations being pointwise, the output shape is the one of the
+  // convolution.
+  bool hasBias = !isFromNone(getB());
+  if (!hasShapeAndRank(getX()) || !hasShapeAndRank(getW()) ||
+      (hasBias && !hasShapeAndRank(getB())))
+    return success();
+
+  Type elementType = getX().getType().cast<ShapedType>().getElementType();
+  ONNXFusedConvOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateType(elementType);
+}
+
+//===----------------------------------------------------------------------===//
+// Template instantiation
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+template struct ONNXGenericPoolOpShapeHelper<ONNXFusedConvOp>;
+} // namespace onnx_mlir
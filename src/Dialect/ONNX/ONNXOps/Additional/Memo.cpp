@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------------- Memo.cpp - ONNX Operations ---------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect Memo operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Verify
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXMemoOp::verify() {
+  if (getKeys().empty())
+    return emitOpError("expects at least one key");
+  Operation *returnOp = getBody().back().getTerminator();
+  if (!isa<ONNXReturnOp>(returnOp))
+    return emitOpError("body is not terminated by onnx.Return");
+  if (returnOp->getNumOperands() != getNumResults())
+    return emitOpError() << "body #results=" << returnOp->getNumOperands()
+                         << " differ from memo #results=" << getNumResults();
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXMemoOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  doShapeInference(getBody());
+  Operation *returnOp = getBody().back().getTerminator();
+  for (auto [result, type] :
+      llvm::zip(getResults(), returnOp->getOperandTypes()))
+    result.setType(type);
+  return success();
+}
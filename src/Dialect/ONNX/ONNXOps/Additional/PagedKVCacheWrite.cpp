@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------- PagedKVCacheWrite.cpp - ONNX Operations --------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect PagedKVCacheWrite operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Verify
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXPagedKVCacheWriteOp::verify() {
+  Value cache = getCache();
+  Value blockTable = getBlockTable();
+  Value pastLength = getPastLength();
+  Value X = getX();
+  if (hasShapeAndRank(blockTable) &&
+      blockTable.getType().cast<ShapedType>().getRank() != 2)
+    return emitOpError("the block table must be a 2D tensor");
+  if (hasShapeAndRank(pastLength)) {
+    ArrayRef<int64_t> lengthShape =
+        pastLength.getType().cast<ShapedType>().getShape();
+    if (lengthShape.size() != 1 ||
+        (!ShapedType::isDynamic(lengthShape[0]) && lengthShape[0] != 1))
+      return emitOpError("the past length must be a tensor<1xi64>");
+  }
+  if (!hasShapeAndRank(cache) || !hasShapeAndRank(X))
+    return success();
+
+  ArrayRef<int64_t> cacheShape = cache.getType().cast<ShapedType>().getShape();
+  ArrayRef<int64_t> xShape = X.getType().cast<ShapedType>().getShape();
+  int64_t rank = cacheShape.size();
+  if (rank < 3)
+    return emitOpError("the cache must have a rank of at least 3");
+  if ((int64_t)xShape.size() != rank)
+    return emitOpError("the cache and X must have the same rank");
+
+  // Static dims that must be the same, all but the blocks and the tokens.
+  auto mismatch = [](int64_t a, int64_t b) {
+    return !ShapedType::isDynamic(a) && !ShapedType::isDynamic(b) && a != b;
+  };
+  for (int64_t i = 1; i < rank; ++i)
+    if (i != rank - 2 && mismatch(cacheShape[i], xShape[i]))
+      return emitOpError("the cache and X must have the same head and "
+                         "feature dimensions");
+  if (hasShapeAndRank(blockTable) &&
+      mismatch(blockTable.getType().cast<ShapedType>().getShape()[0],
+          xShape[0]))
+    return emitOpError("the block table must have a row per batch of X");
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXPagedKVCacheWriteOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  getY().setType(getCache().getType());
+  return success();
+}
@@ -2,9 +2,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-//===------------------ DFT.cpp - ONNX Operations ---------------------===//
+//===------------------ DFT.cpp - ONNX Operations -------------------------===//
 //
-// Copyright 2019-2022 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -27,34 +27,42 @@ namespace onnx_mlir {
 template <>
 LogicalResult ONNXDFTOpShapeHelper::computeShape() {
   ONNXDFTOpAdaptor operandAdaptor(operands, op->getAttrDictionary());
-  // Get info about input data operand.
+  // Get info about input data operand. Its last dimension is 1 for a real
+  // signal and 2 for a complex one.
   Value input = operandAdaptor.getInput();
-  // Get the rank to compensate for N dimensions.
   int64_t rank = createIE->getShapedTypeRank(input);
+  if (rank < 2)
+    return op->emitError("input must have at least a signal and a component "
+                         "dimension");
 
-  // Axis is a required attribute and should have default value of 1.
+  // Axis of the signal, which cannot be the component dimension.
   int64_t axis = operandAdaptor.getAxis();
+  axis = axis < 0 ? axis + rank : axis;
+  if (axis < 0 || axis >= rank - 1)
+    return op->emitError("axis is out of bound");
 
-  // OneSided is a required attribute and should have default value of 0.
-  // However oneSided can also be a value of 1 and if so a specific shape is
-  // expected Values can be 0 or 1.
-  int64_t oneSided = operandAdaptor.getOnesided();
-  bool isOneSided = (oneSided == 0);
+  // Length of the DFT, which defaults to the length of the signal, and of
+  // which only the first half plus one bins are returned when onesided.
+  IndexExpr length;
+  Value dftLength = operandAdaptor.getDftLength();
+  if (isFromNone(dftLength)) {
+    length = createIE->getShapeAsDim(input, axis);
+  } else {
+    length = createIE->getIntFromArrayAsSymbol(dftLength, 0);
+    if (length.isUndefined())
+      return op->emitError("dft_length input could not be processed");
+  }
+  if (operandAdaptor.getOnesided() == 1)
+    length = length.floorDiv(2) + 1;
 
-  // Compute outputDims for DFT.
-  LiteralIndexExpr one(1);
+  // Output has the shape of the input, with the DFT length along the axis and
+  // the real and imaginary components of the result in the last dimension.
   DimsExpr outputDims;
-  for (int64_t i = 0; i < rank; ++i) {
-    if (isOneSided) {
+  for (int64_t i = 0; i < rank - 1; ++i) {
+    if (i == axis)
+      outputDims.emplace_back(length);
+    else
       outputDims.emplace_back(createIE->getShapeAsDim(input, i));
-    } else {
-      if (axis + 1 == i) {
-        IndexExpr d = createIE->getShapeAsDim(input, i).floorDiv(2) + one;
-        outputDims.emplace_back(d);
-      } else {
-        outputDims.emplace_back(createIE->getShapeAsDim(input, i));
-      }
-    }
   }
   outputDims.emplace_back(LiteralIndexExpr(2));
 
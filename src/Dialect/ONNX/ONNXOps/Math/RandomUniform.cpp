@@ -0,0 +1,60 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------ RandomUniform.cpp - ONNX Operations ---------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect RandomUniform operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXRandomUniformOpShapeHelper::computeShape() {
+  ONNXRandomUniformOp randomOp = llvm::cast<ONNXRandomUniformOp>(op);
+
+  DimsExpr outputDims;
+  createIE->getIntFromArrayAsLiterals(randomOp.getShape(), outputDims);
+  if (!IndexExpr::isNonNegativeLiteral(outputDims))
+    return op->emitError("Random uniform tensor has dynamic dimension.");
+  // Save the final result.
+  setOutputDims(outputDims);
+  return success();
+}
+
+} // namespace onnx_mlir
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXRandomUniformOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  OpBuilder builder(getContext());
+  Type elementType = convertONNXTypeToMLIRType(
+      builder, (onnx::TensorProto_DataType)getDtype());
+  if (!elementType || !elementType.isa<FloatType>())
+    return emitError("dtype attribute is not a float type");
+
+  ONNXRandomUniformOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateType(elementType);
+}
+
+//===----------------------------------------------------------------------===//
+// Template instantiation
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+template struct ONNXNonSpecificOpShapeHelper<ONNXRandomUniformOp>;
+} // namespace onnx_mlir
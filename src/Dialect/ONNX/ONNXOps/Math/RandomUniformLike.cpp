@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- RandomUniformLike.cpp - ONNX Operations -------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect RandomUniformLike operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXRandomUniformLikeOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  if (!hasShapeAndRank(getInput()))
+    return success();
+
+  // Default output tensor type is the input tensor type.
+  Type elementType =
+      getInput().getType().cast<RankedTensorType>().getElementType();
+  if (getDtype()) {
+    OpBuilder builder(getContext());
+    elementType = convertONNXTypeToMLIRType(
+        builder, (onnx::TensorProto_DataType)getDtype().value());
+  }
+  if (!elementType || !elementType.isa<FloatType>())
+    return emitError("output element type is not a float type");
+
+  return inferShapeForUnaryOps(getOperation(), elementType);
+}
@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------ STFT.cpp - ONNX Operations ------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file provides definition of ONNX dialect STFT operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+
+using namespace mlir;
+using namespace mlir::OpTrait::util;
+using namespace onnx_mlir;
+
+//===----------------------------------------------------------------------===//
+// Support
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXSTFTOpShapeHelper::computeShape() {
+  ONNXSTFTOpAdaptor operandAdaptor(operands, op->getAttrDictionary());
+  // Signal is [batch, signal_length, 1] if real and [batch, signal_length, 2]
+  // if complex.
+  Value signal = operandAdaptor.getSignal();
+  Value window = operandAdaptor.getWindow();
+  Value frameLength = operandAdaptor.getFrameLength();
+  if (createIE->getShapedTypeRank(signal) != 3)
+    return op->emitError("signal must be a 3D tensor");
+
+  IndexExpr step =
+      createIE->getIntFromArrayAsSymbol(operandAdaptor.getFrameStep(), 0);
+  if (step.isUndefined())
+    return op->emitError("frame_step input could not be processed");
+
+  // Frame length is given by the frame_length input, or else by the length of
+  // the window.
+  IndexExpr length;
+  if (!isFromNone(frameLength)) {
+    length = createIE->getIntFromArrayAsSymbol(frameLength, 0);
+    if (length.isUndefined())
+      return op->emitError("frame_length input could not be processed");
+  } else if (!isFromNone(window)) {
+    length = createIE->getShapeAsDim(window, 0);
+  } else {
+    return op->emitError("either window or frame_length must be provided");
+  }
+
+  // Output is [batch, frames, bins, 2], with only the first half plus one bins
+  // of each frame when onesided.
+  IndexExpr signalLength = createIE->getShapeAsDim(signal, 1);
+  IndexExpr frames = (signalLength - length).floorDiv(step) + 1;
+  IndexExpr bins = length;
+  if (operandAdaptor.getOnesided() == 1)
+    bins = length.floorDiv(2) + 1;
+
+  DimsExpr outputDims;
+  outputDims.emplace_back(createIE->getShapeAsDim(signal, 0));
+  outputDims.emplace_back(frames);
+  outputDims.emplace_back(bins);
+  outputDims.emplace_back(LiteralIndexExpr(2));
+
+  // Save the final result.
+  setOutputDims(outputDims);
+  return success();
+}
+} // namespace onnx_mlir
+
+//===----------------------------------------------------------------------===//
+// Shape Inference
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXSTFTOp::inferShapes(
+    std::function<void(mlir::Region &)> doShapeInference) {
+  // Cannot infer the output shape if the signal shape is not yet known.
+  if (!hasShapeAndRank(getSignal()))
+    return success();
+  if (!isFromNone(getWindow()) && !hasShapeAndRank(getWindow()))
+    return success();
+
+  Type elementType = getSignal().getType().cast<ShapedType>().getElementType();
+  ONNXSTFTOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateType(elementType);
+}
+
+//===----------------------------------------------------------------------===//
+// Template instantiation
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+template struct ONNXNonSpecificOpShapeHelper<ONNXSTFTOp>;
+} // namespace onnx_mlir
@@ -149,3 +149,96 @@ LogicalResult ONNXInstanceNormalizationOp::verify() {
 }
 
 // TODO: should there be a shape inference for this one?
+
+//===----------------------------------------------------------------------===//
+// GroupNormalization
+//===----------------------------------------------------------------------===//
+
+LogicalResult ONNXGroupNormalizationOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  if (!hasShapeAndRank(getX()))
+    return success();
+
+  auto xType = getX().getType().cast<RankedTensorType>();
+  if (xType.getRank() < 2)
+    return emitOpError("X should have a rank of at least two");
+  int64_t numGroups = getNumGroups();
+  int64_t numChannels = xType.getShape()[1];
+  if (numGroups <= 0 || (!ShapedType::isDynamic(numChannels) &&
+                            numChannels % numGroups != 0))
+    return emitOpError("num_groups should divide the number of channels");
+  // Scale and bias have one value per group.
+  for (Value operand : {getScale(), getBias()}) {
+    if (!hasShapeAndRank(operand))
+      continue;
+    auto operandType = operand.getType().cast<ShapedType>();
+    if (operandType.getRank() != 1 ||
+        (!operandType.isDynamicDim(0) &&
+            operandType.getShape()[0] != numGroups))
+      return emitOpError(
+          "Scale and bias should have one value per group of channels");
+  }
+
+  // Y has the same shape as X.
+  ONNXGroupNormalizationOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateType(xType.getElementType());
+}
+
+//===----------------------------------------------------------------------===//
+// LayerNormalization
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXLayerNormalizationOpShapeHelper::computeShape() {
+  ONNXLayerNormalizationOp lnOp = llvm::cast<ONNXLayerNormalizationOp>(op);
+  ONNXLayerNormalizationOpAdaptor operandAdaptor(operands);
+
+  // Y has the same shape as X.
+  DimsExpr outputDims;
+  createIE->getShapeAsDims(operandAdaptor.getX(), outputDims);
+  setOutputDims(outputDims, 0);
+
+  // Optional Mean and InvStdDev keep the dimensions of X before axis and have
+  // dimensions of 1 from axis on. If none, size is empty.
+  int64_t rank = outputDims.size();
+  int64_t axis = lnOp.getAxis();
+  axis = axis >= 0 ? axis : rank + axis;
+  DimsExpr statDims;
+  for (int64_t i = 0; i < rank; ++i)
+    statDims.emplace_back(i < axis ? outputDims[i] : LiteralIndexExpr(1));
+  DimsExpr noDims;
+  setOutputDims(isFromNone(lnOp.getMean()) ? noDims : statDims, 1);
+  setOutputDims(isFromNone(lnOp.getInvStdDev()) ? noDims : statDims, 2);
+  return success();
+}
+
+} // namespace onnx_mlir
+
+LogicalResult ONNXLayerNormalizationOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  if (!hasShapeAndRank(getX()))
+    return success();
+
+  int64_t rank = getX().getType().cast<RankedTensorType>().getRank();
+  int64_t axis = getAxis();
+  if (axis < -rank || axis >= rank)
+    return emitOpError("axis value is out of range");
+
+  // Mean and InvStdDev are computed in float when stash_type is 1, and in the
+  // element type of X otherwise.
+  Type elementType =
+      getX().getType().cast<RankedTensorType>().getElementType();
+  Type statElementType =
+      getStashType() == 1 ? FloatType::getF32(getContext()) : elementType;
+  ONNXLayerNormalizationOpShapeHelper shapeHelper(getOperation(), {});
+  // Mean and InvStdDev are optional, meaning their types may be None. If that
+  // is the case, computeShapeAndUpdateTypes will not override them.
+  return shapeHelper.computeShapeAndUpdateTypes(
+      {elementType, statElementType, statElementType});
+}
+
+namespace onnx_mlir {
+template struct ONNXNonSpecificOpShapeHelper<ONNXLayerNormalizationOp>;
+} // namespace onnx_mlir
@@ -125,10 +125,52 @@ ONNXOpShapeHelper::~ONNXOpShapeHelper() {
     delete createIE;
 }
 
+// Groups of runtime dimensions set for the current thread, if any.
+static thread_local const ONNXOpShapeHelper::DimGroupMapT *currentDimGroups =
+    nullptr;
+
+void ONNXOpShapeHelper::setDimGroups(const DimGroupMapT *dimGroups) {
+  currentDimGroups = dimGroups;
+}
+
 void ONNXOpShapeHelper::computeShapeAndAssertOnFailure() {
   // Invoke virtual compute shape.
   LogicalResult res = computeShape();
   assert(succeeded(res) && "Failed to compute shape");
+  if (currentDimGroups)
+    useOperandDimsOfSameGroups();
+}
+
+void ONNXOpShapeHelper::useOperandDimsOfSameGroups() {
+  for (unsigned n = 0; n < op->getNumResults(); ++n) {
+    DimsExpr &outputDims = privateOutputsDims[n];
+    for (uint64_t d = 0; d < outputDims.size(); ++d) {
+      if (outputDims[d].isLiteral())
+        continue;
+      auto group = currentDimGroups->find({op->getResult(n), d});
+      if (group == currentDimGroups->end())
+        continue;
+      // Look for an operand dimension of the same group, the original operand
+      // being the one analyzed.
+      bool found = false;
+      for (unsigned i = 0; i < op->getNumOperands() && !found; ++i) {
+        auto type = op->getOperand(i).getType().dyn_cast<RankedTensorType>();
+        if (!type || i >= operands.size() ||
+            !operands[i].getType().isa<ShapedType>())
+          continue;
+        for (int64_t a = 0; a < type.getRank() && !found; ++a) {
+          if (!type.isDynamicDim(a))
+            continue;
+          auto operandGroup = currentDimGroups->find({op->getOperand(i), a});
+          if (operandGroup == currentDimGroups->end() ||
+              operandGroup->second != group->second)
+            continue;
+          outputDims[d] = createIE->getShapeAsDim(operands[i], a);
+          found = true;
+        }
+      }
+    }
+  }
 }
 
 void ONNXOpShapeHelper::setOutputDims(
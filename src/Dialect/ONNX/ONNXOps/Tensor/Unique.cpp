@@ -4,7 +4,7 @@
 
 //===------------------ Unique.cpp - ONNX Operations ---------------------===//
 //
-// Copyright 2019-2022 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -18,6 +18,52 @@ using namespace mlir;
 using namespace mlir::OpTrait::util;
 using namespace onnx_mlir;
 
+//===----------------------------------------------------------------------===//
+// Support
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+
+template <>
+LogicalResult ONNXUniqueOpShapeHelper::computeShape() {
+  ONNXUniqueOp uniqueOp = llvm::cast<ONNXUniqueOp>(op);
+  ONNXUniqueOpAdaptor operandAdaptor(operands);
+  Value X = operandAdaptor.getX();
+  int64_t xRank = createIE->getShapedTypeRank(X);
+  Optional<int64_t> optionalAxis = uniqueOp.getAxis();
+
+  // The number of unique items is only known once they are computed, the
+  // ONNX to Krnl lowering replacing the question marks by their number.
+  IndexExpr numUnique = QuestionmarkIndexExpr(/*isFloat*/ false);
+  DimsExpr yDims, inverseDims;
+  if (!optionalAxis.has_value()) {
+    // The unique values of the flattened input.
+    IndexExpr numElements = LiteralIndexExpr(1);
+    for (int64_t d = 0; d < xRank; ++d)
+      numElements = numElements * createIE->getShapeAsDim(X, d);
+    yDims.emplace_back(numUnique);
+    inverseDims.emplace_back(numElements);
+  } else {
+    // The unique slices along the axis.
+    int64_t axis = optionalAxis.value();
+    if (axis < 0)
+      axis += xRank;
+    assert(axis >= 0 && axis < xRank && "axis out of range");
+    createIE->getShapeAsDims(X, yDims);
+    inverseDims.emplace_back(yDims[axis]);
+    yDims[axis] = numUnique;
+  }
+
+  // Cannot refine shape as we may otherwise loose the dynamic dims.
+  setOutputDims(yDims, /*n*/ 0, /*refineShape*/ false);
+  setOutputDims({numUnique}, /*n*/ 1, /*refineShape*/ false);
+  setOutputDims(inverseDims, /*n*/ 2, /*refineShape*/ false);
+  setOutputDims({numUnique}, /*n*/ 3, /*refineShape*/ false);
+  return success();
+}
+
+} // namespace onnx_mlir
+
 //===----------------------------------------------------------------------===//
 // Verify
 //===----------------------------------------------------------------------===//
@@ -56,4 +102,24 @@ LogicalResult ONNXUniqueOp::verify() {
 // Shape Inference
 //===----------------------------------------------------------------------===//
 
-// TODO
+LogicalResult ONNXUniqueOp::inferShapes(
+    std::function<void(Region &)> doShapeInference) {
+  // Cannot infer the output shapes if the input shape is not yet known.
+  if (!hasShapeAndRank(getX()))
+    return success();
+
+  Builder b(getContext());
+  Type elementType = getX().getType().cast<ShapedType>().getElementType();
+  Type indexType = b.getI64Type();
+  ONNXUniqueOpShapeHelper shapeHelper(getOperation(), {});
+  return shapeHelper.computeShapeAndUpdateTypes(
+      {elementType, indexType, indexType, indexType});
+}
+
+//===----------------------------------------------------------------------===//
+// Template instantiation
+//===----------------------------------------------------------------------===//
+
+namespace onnx_mlir {
+template struct ONNXNonSpecificOpShapeHelper<ONNXUniqueOp>;
+} // namespace onnx_mlir
@@ -38,12 +38,10 @@ UNSUPPORTED_OPS(ONNXDictVectorizerOp)
 UNSUPPORTED_OPS(ONNXFeatureVectorizerOp)
 UNSUPPORTED_OPS(ONNXGradientOp)
 UNSUPPORTED_OPS(ONNXGridSampleOp)
-UNSUPPORTED_OPS(ONNXGroupNormalizationOp)
 UNSUPPORTED_OPS(ONNXHammingWindowOp)
 UNSUPPORTED_OPS(ONNXHannWindowOp)
 UNSUPPORTED_OPS(ONNXImputerOp)
 UNSUPPORTED_OPS(ONNXLabelEncoderOp)
-UNSUPPORTED_OPS(ONNXLayerNormalizationOp)
 UNSUPPORTED_OPS(ONNXLinearClassifierOp)
 UNSUPPORTED_OPS(ONNXLinearRegressorOp)
 UNSUPPORTED_OPS(ONNXLpPoolOp)
@@ -57,19 +55,15 @@ UNSUPPORTED_OPS(ONNXNegativeLogLikelihoodLossOp)
 UNSUPPORTED_OPS(ONNXNormalizerOp)
 UNSUPPORTED_OPS(ONNXPadV11Op)
 UNSUPPORTED_OPS(ONNXPadV2Op)
-UNSUPPORTED_OPS(ONNXRandomUniformLikeOp)
-UNSUPPORTED_OPS(ONNXRandomUniformOp)
 UNSUPPORTED_OPS(ONNXResizeV10Op)
 UNSUPPORTED_OPS(ONNXResizeV11Op)
 UNSUPPORTED_OPS(ONNXSequenceMapOp)
 UNSUPPORTED_OPS(ONNXSVMClassifierOp)
 UNSUPPORTED_OPS(ONNXSVMRegressorOp)
 UNSUPPORTED_OPS(ONNXSoftmaxCrossEntropyLossOp)
-UNSUPPORTED_OPS(ONNXSTFTOp)
 UNSUPPORTED_OPS(ONNXStringNormalizerOp)
 UNSUPPORTED_OPS(ONNXTfIdfVectorizerOp)
 UNSUPPORTED_OPS(ONNXTreeEnsembleClassifierOp)
 UNSUPPORTED_OPS(ONNXTreeEnsembleRegressorOp)
-UNSUPPORTED_OPS(ONNXUniqueOp)
 UNSUPPORTED_OPS(ONNXUpsampleV7Op)
 UNSUPPORTED_OPS(ONNXZipMapOp)
@@ -40,6 +40,43 @@ Value subtractOrNeg(PatternRewriter &rewriter, Location loc, Value A, Value B) {
   return rewriter.create<ONNXSubOp>(loc, A, B);
 }
 
+// Scale the columns of the matrix 'B' of a Gemm by the coefficients 'a' of the
+// BatchNorm in inference mode following the Gemm, whose channels are the
+// columns of the result.
+Value scaleGemmBByColumns(PatternRewriter &rewriter, Location loc, Value B,
+    Value a, IntegerAttr transB) {
+  OnnxBuilder create(rewriter, loc);
+  // The columns of a transposed 'B' are the rows of the stored matrix.
+  if (transB.getValue().getSExtValue() != 0) {
+    Type unsqueezedType = UnrankedTensorType::get(getElementType(a.getType()));
+    a = create.unsqueeze(unsqueezedType, a, create.constantInt64({1}));
+  }
+  return create.mul(B, a);
+}
+
+// Compute the bias 'C_' of a Gemm fused with the following BatchNorm in
+// inference mode, whose coefficients are 'a' = scale / sqrt(var + eps):
+//   C_ = beta * C * a + bias - mean * a
+Value getGemmBiasFusedWithBatchNorm(PatternRewriter &rewriter, Location loc,
+    Value C, FloatAttr beta, Value a, Value bias, Value mean) {
+  OnnxBuilder create(rewriter, loc);
+  Value fusedBias = create.sub(bias, create.mul(mean, a));
+  if (isFromNone(C) || beta.getValueAsDouble() == 0.0)
+    return fusedBias;
+  Value scaledC = create.mul(C, a);
+  if (beta.getValueAsDouble() != 1.0) {
+    Type elementType = getElementType(C.getType());
+    APFloat betaVal = beta.getValue();
+    bool losesInfo;
+    betaVal.convert(elementType.cast<FloatType>().getFloatSemantics(),
+        APFloat::rmNearestTiesToEven, &losesInfo);
+    DenseElementsAttr betaAttr = DenseElementsAttr::get(
+        RankedTensorType::get({1}, elementType), betaVal);
+    scaledC = create.mul(scaledC, create.constant(betaAttr));
+  }
+  return create.add(scaledC, fusedBias);
+}
+
 // Create an ArrayAttr of IntegerAttr(s) of values in [1, N].
 ArrayAttr createArrayAttrOfOneToN(PatternRewriter &rewriter, int N) {
   SmallVector<int64_t, 4> vals;
@@ -444,6 +481,283 @@ private:
   }
 };
 
+// =============================================================================
+// Rewrite patterns for the products of one-hot matrices (not handled in
+// Rewrite.td).
+// =============================================================================
+
+// Return in `values` the values of the constant `value` of integers or floats.
+static bool getConstantValuesAsDoubles(
+    Value value, SmallVectorImpl<double> &values) {
+  ElementsAttr attr = getElementAttributeFromONNXValue(value);
+  if (!attr)
+    return false;
+  Type elementType = attr.getElementType();
+  if (elementType.isa<FloatType>()) {
+    for (APFloat val : attr.getValues<APFloat>())
+      values.emplace_back(val.convertToDouble());
+  } else if (elementType.isa<IntegerType>() && !elementType.isInteger(1)) {
+    for (APInt val : attr.getValues<APInt>())
+      values.emplace_back((double)(elementType.isUnsignedInteger()
+                                       ? (int64_t)val.getZExtValue()
+                                       : val.getSExtValue()));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Return true if `A` is a one-hot matrix OneHot(indices, depth, [0, 1]) along
+// its last dimension, used only by its product by the matrix `W` of static
+// shape depth x K: the rows of the product are then rows of W.
+static bool isOneHotRowSelection(Value A, Value W) {
+  ONNXOneHotOp oneHotOp = A.getDefiningOp<ONNXOneHotOp>();
+  if (!oneHotOp || !A.hasOneUse() || !hasShapeAndRank(oneHotOp.getIndices()))
+    return false;
+  int64_t indicesRank =
+      oneHotOp.getIndices().getType().cast<ShapedType>().getRank();
+  if (oneHotOp.getAxis() != -1 && oneHotOp.getAxis() != indicesRank)
+    return false;
+  SmallVector<double, 1> depth;
+  SmallVector<double, 2> values;
+  if (!getConstantValuesAsDoubles(oneHotOp.getDepth(), depth) ||
+      depth.size() != 1 ||
+      !getConstantValuesAsDoubles(oneHotOp.getValues(), values) ||
+      values.size() != 2 || values[0] != 0.0 || values[1] != 1.0)
+    return false;
+  auto wType = W.getType().dyn_cast<RankedTensorType>();
+  return wType && wType.getRank() == 2 && wType.hasStaticShape() &&
+         (double)wType.getShape()[0] == std::trunc(depth[0]);
+}
+
+// Emit the Gather of the rows of W selected by the one-hot matrix `A`, as
+// matched by isOneHotRowSelection, whose result has type `resultType`.
+//
+// The rows are gathered from W with a row of zeros appended, the one of the
+// indices out of [-depth, depth - 1], for which the one-hot rows have no on
+// value. The other indices are normalized to [0, depth - 1].
+static Value emitOneHotRowGather(PatternRewriter &rewriter, Location loc,
+    Value A, Value W, Type resultType) {
+  OnnxBuilder create(rewriter, loc);
+  ONNXOneHotOp oneHotOp = A.getDefiningOp<ONNXOneHotOp>();
+  Value indices = oneHotOp.getIndices();
+  ArrayRef<int64_t> indicesShape =
+      indices.getType().cast<ShapedType>().getShape();
+  auto wType = W.getType().cast<RankedTensorType>();
+  int64_t depth = wType.getShape()[0];
+  int64_t K = wType.getShape()[1];
+
+  Type i64Type = rewriter.getI64Type();
+  Type indexType = RankedTensorType::get(indicesShape, i64Type);
+  Type boolType = RankedTensorType::get(indicesShape, rewriter.getI1Type());
+  auto indexConstant = [&](int64_t val) {
+    return create.constant(DenseElementsAttr::get(
+        RankedTensorType::get({}, i64Type), ArrayRef<int64_t>{val}));
+  };
+  if (getElementType(indices.getType()) != i64Type)
+    indices = create.cast(indices, TypeAttr::get(i64Type));
+  Value zero = indexConstant(0);
+  Value depthVal = indexConstant(depth);
+  Value isNeg = rewriter.create<ONNXLessOp>(loc, boolType, indices, zero);
+  Value normalized = create.where(indexType, isNeg,
+      rewriter.create<ONNXAddOp>(loc, indexType, indices, depthVal), indices);
+  Value isValid = rewriter.create<ONNXAndOp>(loc, boolType,
+      rewriter.create<ONNXLessOp>(loc, boolType, normalized, depthVal),
+      rewriter.create<ONNXNotOp>(loc, boolType,
+          rewriter.create<ONNXLessOp>(loc, boolType, normalized, zero)));
+  Value rowIndices = create.where(indexType, isValid, normalized, depthVal);
+
+  Type elementType = wType.getElementType();
+  Value zeroRow = create.constant(
+      rewriter.getZeroAttr(RankedTensorType::get({1, K}, elementType)));
+  Value table = create.concat(
+      RankedTensorType::get({depth + 1, K}, elementType), {W, zeroRow}, 0);
+  return rewriter.create<ONNXGatherOp>(loc, resultType, table, rowIndices,
+      rewriter.getIntegerAttr(
+          rewriter.getIntegerType(64, /*isSigned=*/true), 0));
+}
+
+// Rewrite MatMul(OneHot(indices, depth, [0, 1]), W) into a Gather of the rows
+// of W, which avoids materializing the one-hot matrix, as found in embedding
+// lookups of exported NLP models.
+class MatMulOfOneHotToGatherPattern : public OpRewritePattern<ONNXMatMulOp> {
+public:
+  using OpRewritePattern<ONNXMatMulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXMatMulOp matMulOp, PatternRewriter &rewriter) const override {
+    Value A = matMulOp.getA();
+    Value B = matMulOp.getB();
+    if (!isOneHotRowSelection(A, B))
+      return failure();
+    Value rows = emitOneHotRowGather(
+        rewriter, matMulOp.getLoc(), A, B, matMulOp.getType());
+    rewriter.replaceOp(matMulOp, rows);
+    return success();
+  }
+};
+
+// Rewrite Gemm(OneHot(indices, depth, [0, 1]), W, C) without transposition
+// nor scaling into the Gather of the rows of W plus C.
+class GemmOfOneHotToGatherPattern : public OpRewritePattern<ONNXGemmOp> {
+public:
+  using OpRewritePattern<ONNXGemmOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXGemmOp gemmOp, PatternRewriter &rewriter) const override {
+    Location loc = gemmOp.getLoc();
+    Value A = gemmOp.getA();
+    Value B = gemmOp.getB();
+    Value C = gemmOp.getC();
+    bool hasBias = !isFromNone(C);
+    if (gemmOp.getTransA() != 0 || gemmOp.getTransB() != 0 ||
+        gemmOp.getAlpha().convertToDouble() != 1.0 ||
+        (hasBias && gemmOp.getBeta().convertToDouble() != 1.0) ||
+        !isOneHotRowSelection(A, B))
+      return failure();
+    Type resultType = gemmOp.getType();
+    Value rows = emitOneHotRowGather(rewriter, loc, A, B, resultType);
+    if (hasBias)
+      rows = rewriter.create<ONNXAddOp>(loc, resultType, rows, C);
+    rewriter.replaceOp(gemmOp, rows);
+    return success();
+  }
+};
+
+// =============================================================================
+// Rewrite patterns folding the normalization of the input of a convolution
+// into its weights and bias (not handled in Rewrite.td).
+// =============================================================================
+
+// Return true if the convolution pads its input.
+static bool isPaddedConv(ONNXConvOp convOp) {
+  StringRef autoPad = convOp.getAutoPad();
+  if (autoPad == "VALID")
+    return false;
+  if (autoPad != "NOTSET")
+    return true;
+  Optional<ArrayAttr> pads = convOp.getPads();
+  return pads.has_value() && llvm::any_of(pads.value(), [](Attribute pad) {
+    return pad.cast<IntegerAttr>().getInt() != 0;
+  });
+}
+
+// Return true if the value is a constant, or is computed from constants only,
+// e.g. by the ops of an earlier fold, which constant propagation folds.
+static bool isComputedFromConstants(Value value) {
+  if (isDenseONNXConstant(value))
+    return true;
+  Operation *op = value.getDefiningOp();
+  return op && isa<ONNXDialect>(op->getDialect()) &&
+         op->getNumRegions() == 0 && op->getNumOperands() > 0 &&
+         llvm::all_of(op->getOperands(), isComputedFromConstants);
+}
+
+// Return the number of input channels C of the convolution if `c` is a
+// constant of one value per channel of its input, or one value for all of
+// them, i.e. broadcast to the input as [1, C or 1, 1, ..., 1]. Return 0
+// otherwise.
+static int64_t getPerChannelConstantSize(ONNXConvOp convOp, Value c) {
+  auto wType = convOp.getW().getType().dyn_cast<RankedTensorType>();
+  auto cType = c.getType().dyn_cast<RankedTensorType>();
+  if (!wType || !wType.hasStaticShape() || !cType ||
+      !cType.hasStaticShape() || !isDenseONNXConstant(c) ||
+      cType.getElementType() != wType.getElementType())
+    return 0;
+  int64_t rank = wType.getRank();
+  int64_t cRank = cType.getRank();
+  if (cRank > rank)
+    return 0;
+  int64_t size = 1;
+  for (int64_t i = 0; i < cRank; ++i) {
+    int64_t dim = cType.getShape()[i];
+    // Dim i of c is broadcast to dim i + rank - cRank of the input.
+    if (i + rank - cRank == 1 && dim == wType.getShape()[1])
+      size = dim;
+    else if (dim != 1)
+      return 0;
+  }
+  return size;
+}
+
+// Fold the per-channel affine normalization of the input of a convolution,
+// as found at the start of vision models, into the constant weights and bias
+// of the convolution:
+//   Conv(x * s, W, B) = Conv(x, W * s', B)
+//   Conv(x / s, W, B) = Conv(x, W / s', B)
+//   Conv(x + t, W, B) = Conv(x, W, B + ReduceSum(W * t', axes = [1 .. R-1]))
+//   Conv(x - t, W, B) = Conv(x, W, B - ReduceSum(W * t', axes = [1 .. R-1]))
+// where s' and t' are the constants reshaped to [1, C or 1, 1, ..., 1], so
+// that the values of input channel ci scale or shift the weights W[:, ci].
+// The padding of the convolution is zero in the normalized input, so the
+// shifts are only folded into the convolutions without padding, while the
+// scales commute with it. Only the convolutions with a single group are
+// rewritten, whose weights see all the channels. The new weights and bias are
+// then folded into constants by constant propagation, and the normalization,
+// a full pass over the input, is gone. Chains of normalizations, as
+// Div(Sub(x, mean), std), are folded one op at a time.
+class FoldInputNormalizationIntoConvPattern
+    : public OpRewritePattern<ONNXConvOp> {
+public:
+  using OpRewritePattern<ONNXConvOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXConvOp convOp, PatternRewriter &rewriter) const override {
+    Location loc = convOp.getLoc();
+    Value X = convOp.getX();
+    Value W = convOp.getW();
+    Value B = convOp.getB();
+    Operation *normOp = X.getDefiningOp();
+    if (!normOp || !X.hasOneUse() || convOp.getGroup() != 1 ||
+        !isComputedFromConstants(W) ||
+        !isa<ONNXMulOp, ONNXDivOp, ONNXAddOp, ONNXSubOp>(normOp))
+      return failure();
+    bool isScale = isa<ONNXMulOp, ONNXDivOp>(normOp);
+    if (!isScale && isPaddedConv(convOp))
+      return failure();
+    Value x = normOp->getOperand(0);
+    Value c = normOp->getOperand(1);
+    int64_t size = getPerChannelConstantSize(convOp, c);
+    if (size == 0 || x.getType() != X.getType())
+      return failure();
+
+    OnnxBuilder create(rewriter, loc);
+    auto wType = W.getType().cast<RankedTensorType>();
+    int64_t rank = wType.getRank();
+    SmallVector<int64_t, 4> cShape(rank, 1);
+    cShape[1] = size;
+    Value cW = create.reshape(
+        RankedTensorType::get(cShape, wType.getElementType()), c,
+        create.constantInt64(cShape));
+    Value newW = W;
+    Value newB = B;
+    if (isa<ONNXMulOp>(normOp)) {
+      newW = create.mul(W, cW);
+    } else if (isa<ONNXDivOp>(normOp)) {
+      newW = create.div(W, cW);
+    } else {
+      SmallVector<int64_t, 3> axes;
+      for (int64_t i = 1; i < rank; ++i)
+        axes.emplace_back(i);
+      Value shift = create.reduceSum(
+          RankedTensorType::get(
+              {wType.getShape()[0]}, wType.getElementType()),
+          create.mul(W, cW), create.constantInt64(axes), /*keepDims=*/false);
+      if (isa<ONNXSubOp>(normOp))
+        newB = subtractOrNeg(rewriter, loc, B, shift);
+      else
+        newB = isFromNone(B) ? shift : create.add(B, shift);
+    }
+    rewriter.updateRootInPlace(convOp, [&]() {
+      convOp.getXMutable().assign(x);
+      convOp.getWMutable().assign(newW);
+      convOp.getBMutable().assign(newB);
+    });
+    rewriter.eraseOp(normOp);
+    return success();
+  }
+};
+
 namespace {
 // RNNOpRewriteLayoutPattern helper functions and classes.
 
@@ -564,6 +878,7 @@ public:
 void ONNXBatchNormalizationInferenceModeOp::getCanonicalizationPatterns(
     RewritePatternSet &results, MLIRContext *context) {
   results.insert<FuseBatchNormInferenceModeConvPattern>(context);
+  results.insert<FuseBatchNormInferenceModeGemmPattern>(context);
   results.insert<RewriteBatchNormInferenceModeConvPattern1>(context);
   results.insert<RewriteBatchNormInferenceModeConvPattern2>(context);
 }
@@ -596,6 +911,12 @@ void ONNXConstantOp::getCanonicalizationPatterns(
   results.insert<ConstantOpNormalizationPattern6>(context);
 }
 
+/// on the ONNXConvOp.
+void ONNXConvOp::getCanonicalizationPatterns(
+    RewritePatternSet &results, MLIRContext *context) {
+  results.insert<FoldInputNormalizationIntoConvPattern>(context);
+}
+
 /// on the ONNXDepthToSpaceOp.
 void ONNXDepthToSpaceOp::getCanonicalizationPatterns(
     RewritePatternSet &results, MLIRContext *context) {
@@ -614,6 +935,12 @@ void ONNXDimOp::getCanonicalizationPatterns(
   results.insert<DimOpToConstantPattern>(context);
 }
 
+/// on the ONNXGemmOp.
+void ONNXGemmOp::getCanonicalizationPatterns(
+    RewritePatternSet &results, MLIRContext *context) {
+  results.insert<GemmOfOneHotToGatherPattern>(context);
+}
+
 /// on the ONNXGlobalAveragePoolOp.
 void ONNXGlobalAveragePoolOp::getCanonicalizationPatterns(
     RewritePatternSet &results, MLIRContext *context) {
@@ -642,6 +969,7 @@ void ONNXIdentityOp::getCanonicalizationPatterns(
 void ONNXLayoutTransformOp::getCanonicalizationPatterns(
     RewritePatternSet &result, MLIRContext *context) {
   result.insert<ONNXLayoutTransformEliminationPattern>(context);
+  result.insert<ONNXLayoutTransformFusionPattern>(context);
 }
 
 /// on the ONNXLessOp.
@@ -662,6 +990,12 @@ void ONNXLSTMOp::getCanonicalizationPatterns(
   results.insert<RNNOpRewriteLayoutPattern<ONNXLSTMOp>>(context);
 }
 
+/// on the ONNXMatMulOp.
+void ONNXMatMulOp::getCanonicalizationPatterns(
+    RewritePatternSet &results, MLIRContext *context) {
+  results.insert<MatMulOfOneHotToGatherPattern>(context);
+}
+
 /// on the ONNXMulOp.
 void ONNXMulOp::getCanonicalizationPatterns(
     RewritePatternSet &results, MLIRContext *context) {
@@ -93,6 +93,17 @@ struct ONNXOpShapeHelper {
   // Compute shape and assert on failure.
   void computeShapeAndAssertOnFailure();
 
+  // Groups of runtime dimensions known to be equal, mapping each dimension
+  // (value and axis) to the ID of its group.
+  using DimGroupMapT =
+      llvm::DenseMap<std::pair<mlir::Value, uint64_t>, uint64_t>;
+  // Set the groups of runtime dimensions used by the shape helpers of the
+  // current thread, e.g. by a lowering from the result of DimAnalysis, or
+  // reset them with nullptr. When set, computeShapeAndAssertOnFailure
+  // computes each runtime output dimension from an operand dimension of the
+  // same group, so that equal dimensions share their size computations.
+  static void setDimGroups(const DimGroupMapT *dimGroups);
+
   // Invoke the virtual computeShape, and on success, update the types of the
   // original operation. First call is used for operations where all the results
   // share the same output type, second for operations where all results have
@@ -142,6 +153,9 @@ protected:
   IndexExprScope *scope;
 
 private:
+  // Compute the runtime output dims from the operand dims of their group.
+  void useOperandDimsOfSameGroups();
+
   // OutputsDims is computed by the child's struct `computeShape` function. It
   // can be set using setOutputDims and retrieved using getOutputDims.
   llvm::SmallVector<DimsExpr, 1> privateOutputsDims;
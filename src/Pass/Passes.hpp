@@ -27,6 +27,7 @@ class Pass;
 namespace onnx_mlir {
 
 class DisposablePool;
+class ShapeInferenceCache;
 
 /// Pass for removing DisposableElementsAttr attributes.
 std::unique_ptr<mlir::Pass> createScrubDisposablePass(bool closeAfter = true);
@@ -40,11 +41,51 @@ std::unique_ptr<mlir::Pass> createONNXOpTransformPass(
 std::unique_ptr<mlir::Pass> createDecomposeONNXToONNXPass(
     const std::string &target = "");
 
+/// Pass for moving the transposes past the ops computing the same on permuted
+/// operands, so that they cancel out.
+std::unique_ptr<mlir::Pass> createSinkTransposeONNXToONNXPass();
+
 std::unique_ptr<mlir::Pass> createConvOptONNXToONNXPass(
     bool enableSimdDataLayoutOpt = false);
 
+/// Pass for propagating the SIMD data layout of convolutions through the ops
+/// computing the same on any layout.
+std::unique_ptr<mlir::Pass> createPropagateSimdDataLayoutONNXToONNXPass();
+
+/// Pass for fusing scaled dot-product attentions for CPU execution.
+std::unique_ptr<mlir::Pass> createFuseAttentionONNXToONNXPass();
+
+/// Pass for fusing the activations following convolutions for CPU execution.
+std::unique_ptr<mlir::Pass> createFuseConvActivationONNXToONNXPass();
+
+/// Pass for folding the Expand and Tile ops feeding elementwise ops into their
+/// broadcast for CPU execution.
+std::unique_ptr<mlir::Pass> createFoldBroadcastONNXToONNXPass();
+
+/// Pass for moving the ops only used by one branch of an If into that branch.
+std::unique_ptr<mlir::Pass> createSinkIntoIfBranchesONNXToONNXPass();
+
+/// Pass for storing the f32 constant weights of MatMul ops in f16 or bf16,
+/// widened to f32 when loaded by the CPU lowering.
+std::unique_ptr<mlir::Pass> createHalfPrecisionWeightsPass();
+std::unique_ptr<mlir::Pass> createHalfPrecisionWeightsPass(
+    const std::string &weightType);
+
+/// Pass for quantizing the f32 constant weights of MatMul ops to int8 with
+/// per column scales, dequantized when loaded by the CPU lowering.
+std::unique_ptr<mlir::Pass> createQuantizeWeightsPass();
+std::unique_ptr<mlir::Pass> createQuantizeWeightsPass(
+    const std::string &weightType);
+
+/// Pass for shape inference. The passes sharing a cache skip the ops that did
+/// not change since one of them inferred their shapes.
 std::unique_ptr<mlir::Pass> createShapeInferencePass(
-    bool analyzeAllFunctions = false);
+    bool analyzeAllFunctions = false,
+    std::shared_ptr<ShapeInferenceCache> cache = nullptr);
+
+/// Create a cache to share between shape inference passes run on the same
+/// module.
+std::shared_ptr<ShapeInferenceCache> createShapeInferenceCache();
 
 std::unique_ptr<mlir::Pass> createConstPropONNXToONNXPass(bool report = false);
 
@@ -61,6 +102,48 @@ std::unique_ptr<mlir::Pass> createInstrumentONNXSignaturePass();
 std::unique_ptr<mlir::Pass> createSimplifyShapeRelatedOpsPass(
     bool report = false);
 
+/// Pass for specializing the entry point functions for buckets of input shapes.
+std::unique_ptr<mlir::Pass> createShapeSpecializationPass();
+std::unique_ptr<mlir::Pass> createShapeSpecializationPass(
+    const std::string &buckets);
+
+/// Pass for cloning the entry point functions for subsets of their outputs.
+std::unique_ptr<mlir::Pass> createOutputSubsetsPass();
+std::unique_ptr<mlir::Pass> createOutputSubsetsPass(
+    const std::string &subsets, const std::string &nodes);
+
+/// Pass for taking the image inputs of the entry point functions as uint8 NHWC
+/// tensors.
+std::unique_ptr<mlir::Pass> createUint8NHWCInputsPass();
+std::unique_ptr<mlir::Pass> createUint8NHWCInputsPass(
+    const std::string &inputs);
+
+/// Pass for running the fused attentions of the entry point functions over
+/// packed sequences, with an input of sequence offsets.
+std::unique_ptr<mlir::Pass> createPackedSequencesPass();
+std::unique_ptr<mlir::Pass> createPackedSequencesPass(
+    const std::string &offsetsName);
+
+/// Pass for keeping the key/value caches of the fused attentions of the entry
+/// point functions in blocks, with inputs of a block table and of a length.
+std::unique_ptr<mlir::Pass> createPagedKVCachePass();
+
+/// Pass for splitting the entry point functions into pipeline stages.
+std::unique_ptr<mlir::Pass> createSplitPipelineStagesPass();
+std::unique_ptr<mlir::Pass> createSplitPipelineStagesPass(int numStages);
+
+/// Pass for outlining the repeated layers of the model into functions.
+std::unique_ptr<mlir::Pass> createOutlineRepeatedLayersPass();
+
+/// Pass for caching across calls the values only depending on the shapes of
+/// the inputs and on the slowly changing inputs.
+std::unique_ptr<mlir::Pass> createMemoizeSubgraphsPass();
+std::unique_ptr<mlir::Pass> createMemoizeSubgraphsPass(
+    const std::string &inputs);
+
+/// Pass for placing ONNX ops on the cheapest accelerator able to run them.
+std::unique_ptr<mlir::Pass> createAcceleratorPlacementPass();
+
 /// Pass for analyzing unknown dimension in ONNX operations.
 std::unique_ptr<mlir::Pass> createONNXDimAnalysisPass();
 
@@ -69,8 +152,13 @@ std::unique_ptr<mlir::Pass> createONNXPreKrnlVerifyPass();
 
 /// Add pass for lowering to Krnl IR.
 std::unique_ptr<mlir::Pass> createLowerToKrnlPass();
-std::unique_ptr<mlir::Pass> createLowerToKrnlPass(
-    int optLevel, bool enableParallel);
+std::unique_ptr<mlir::Pass> createLowerToKrnlPass(int optLevel,
+    bool enableParallel, int64_t parallelThreshold = 65536,
+    bool enableFusion = false, bool enableStreamingLoops = false,
+    int64_t convWinogradThreshold = 32, bool enableDimAnalysis = false,
+    std::string matmulTileDB = "", std::string targetCPU = "",
+    bool enableBLAS = false, int64_t blasThreshold = 16777216,
+    int64_t sparseWeightThreshold = 80);
 std::unique_ptr<mlir::Pass> createLowerToKrnlPass(
     bool enableTiling, bool enableSIMD, bool enableParallel);
 
@@ -100,6 +188,23 @@ std::unique_ptr<mlir::Pass> createKrnlBundleMemoryPoolsPass();
 
 /// Pass for optimizing memory pools.
 std::unique_ptr<mlir::Pass> createKrnlOptimizeMemoryPoolsPass();
+std::unique_ptr<mlir::Pass> createKrnlOptimizeMemoryPoolsPass(bool planOffsets);
+
+/// Pass for allocating buffers of dynamic shape, and optionally of static
+/// shape, from the runtime arena.
+std::unique_ptr<mlir::Pass> createKrnlEnableDynamicMemoryArenaPass();
+std::unique_ptr<mlir::Pass> createKrnlEnableDynamicMemoryArenaPass(
+    bool allocateDynamic, bool allocateStatic);
+
+/// Pass for dispatching the entry point functions to their specializations.
+std::unique_ptr<mlir::Pass> createShapeDispatchPass();
+
+/// Pass for passing the results of the outlined layers as output arguments.
+std::unique_ptr<mlir::Pass> createOutlinedLayerOutParamsPass();
+
+/// Pass for moving the body of the entry point functions into functions
+/// writing their results into output arguments.
+std::unique_ptr<mlir::Pass> createEntryPointOutParamsPass();
 
 /// Pass for lowering Seq in Krnl dialect.
 std::unique_ptr<mlir::Pass> createConvertSeqToMemrefPass();
@@ -107,10 +212,20 @@ std::unique_ptr<mlir::Pass> createConvertSeqToMemrefPass();
 /// Pass for lowering krnl.region operation.
 std::unique_ptr<mlir::Pass> createLowerKrnlRegionPass();
 
+/// Pass for outlining scf.parallel loops run on the runtime thread pool.
+std::unique_ptr<mlir::Pass> createOutlineParallelLoopsPass();
+
+/// Pass for outlining independent loop nests into task graphs run on the
+/// runtime thread pool.
+std::unique_ptr<mlir::Pass> createOutlineTaskGraphsPass();
+
+/// Pass for merging the Krnl globals of the same type and value.
+std::unique_ptr<mlir::Pass> createDedupKrnlGlobalConstantsPass();
+
 /// Pass for lowering Krnl dialect to LLVM dialect.
 std::unique_ptr<mlir::Pass> createConvertKrnlToLLVMPass();
 std::unique_ptr<mlir::Pass> createConvertKrnlToLLVMPass(
-    bool verifyInputTensors);
+    bool verifyInputTensors, int64_t constantsToFileThreshold);
 
 } // namespace krnl
 
@@ -0,0 +1,269 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- ExecutionBatcher.cpp - ExecutionBatcher Implementation -------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementations of ExecutionBatcher class, which batches
+// concurrent inference requests to compiled binary model libraries.
+//
+//===----------------------------------------------------------------------===//
+
+#include <errno.h>
+#include <string.h>
+
+#include <sstream>
+
+#include "llvm/Support/JSON.h"
+
+#include "ExecutionBatcher.hpp"
+
+namespace onnx_mlir {
+
+ExecutionBatcher::ExecutionBatcher(const ExecutionEntryPoint &entryPoint,
+    int64_t maxBatchSize, std::chrono::microseconds timeout)
+    : _entryPoint(entryPoint), _maxBatchSize(maxBatchSize), _timeout(timeout) {
+  if (maxBatchSize < 1) {
+    errno = EINVAL;
+    throw std::runtime_error("Maximum batch size must be positive.\n");
+  }
+
+  // The first dimension of every input must be dynamic to be batched.
+  std::string inSig = _entryPoint.inputSignature();
+  llvm::Expected<llvm::json::Value> jsonSig = llvm::json::parse(inSig);
+  const llvm::json::Array *jsonInputs =
+      jsonSig ? jsonSig->getAsArray() : nullptr;
+  if (!jsonInputs) {
+    llvm::consumeError(jsonSig.takeError());
+    errno = EINVAL;
+    throw std::runtime_error("Cannot parse input signature of '" +
+                             _entryPoint.getName() + "'.\n");
+  }
+  _numInputs = jsonInputs->size();
+  for (int64_t i = 0; i < _numInputs; ++i) {
+    const llvm::json::Object *jsonInput = (*jsonInputs)[i].getAsObject();
+    const llvm::json::Array *jsonDims =
+        jsonInput ? jsonInput->getArray("dims") : nullptr;
+    // Dynamic dimensions have a negative size in signatures.
+    bool hasDynamicBatchDim = false;
+    if (jsonDims && !jsonDims->empty())
+      if (auto batchDim = (*jsonDims)[0].getAsInteger())
+        hasDynamicBatchDim = *batchDim < 0;
+    if (!hasDynamicBatchDim) {
+      std::stringstream errStr;
+      errStr << "Input " << i << " of '" << _entryPoint.getName()
+             << "' has no dynamic batch dimension." << std::endl;
+      errno = EINVAL;
+      throw std::runtime_error(errStr.str());
+    }
+  }
+
+  _worker = std::thread([this]() { processRequests(); });
+  errno = 0; // No errors.
+}
+
+ExecutionBatcher::~ExecutionBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _queueChanged.notify_one();
+  _worker.join();
+}
+
+std::future<std::vector<OMTensorUniquePtr>> ExecutionBatcher::submit(
+    std::vector<OMTensorUniquePtr> ins) {
+  if ((int64_t)ins.size() != _numInputs) {
+    std::stringstream errStr;
+    errStr << "Wrong number of input tensors: expect " << _numInputs
+           << ", but got " << ins.size() << "." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+  int64_t batchSize = -1;
+  for (const OMTensorUniquePtr &in : ins) {
+    int64_t inBatchSize =
+        omTensorGetRank(in.get()) > 0 ? omTensorGetShape(in.get())[0] : -1;
+    if (inBatchSize <= 0 || (batchSize >= 0 && inBatchSize != batchSize)) {
+      errno = EINVAL;
+      throw std::runtime_error("Input tensors must have the same, positive, "
+                               "batch dimension size.\n");
+    }
+    batchSize = inBatchSize;
+  }
+
+  Request request;
+  request.ins = std::move(ins);
+  request.batchSize = batchSize;
+  request.arrivalTime = std::chrono::steady_clock::now();
+  std::future<std::vector<OMTensorUniquePtr>> outs =
+      request.outs.get_future();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.emplace_back(std::move(request));
+  }
+  _queueChanged.notify_one();
+  errno = 0; // No errors.
+  return outs;
+}
+
+std::vector<OMTensorUniquePtr> ExecutionBatcher::run(
+    std::vector<OMTensorUniquePtr> ins) {
+  return submit(std::move(ins)).get();
+}
+
+void ExecutionBatcher::processRequests() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _queueChanged.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+    if (_queue.empty())
+      return; // Stopping with no more requests.
+
+    // Wait for a full batch, up to the deadline of the oldest request. Pending
+    // requests are run without waiting once stopping.
+    std::chrono::steady_clock::time_point deadline =
+        _queue.front().arrivalTime + _timeout;
+    while (!_stopping && getBatchableSize() < _maxBatchSize &&
+           _queueChanged.wait_until(lock, deadline) !=
+               std::cv_status::timeout) {
+    }
+
+    // Form the batch with the oldest request and the following batchable ones
+    // that fit.
+    std::vector<Request> batch;
+    batch.emplace_back(std::move(_queue.front()));
+    _queue.pop_front();
+    int64_t batchSize = batch.front().batchSize;
+    for (auto it = _queue.begin();
+         it != _queue.end() && batchSize < _maxBatchSize;) {
+      if (batchSize + it->batchSize <= _maxBatchSize &&
+          areBatchable(batch.front(), *it)) {
+        batchSize += it->batchSize;
+        batch.emplace_back(std::move(*it));
+        it = _queue.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+int64_t ExecutionBatcher::getBatchableSize() const {
+  int64_t batchSize = 0;
+  for (const Request &request : _queue) {
+    if (areBatchable(_queue.front(), request))
+      batchSize += request.batchSize;
+    if (batchSize >= _maxBatchSize)
+      break;
+  }
+  return batchSize;
+}
+
+void ExecutionBatcher::runBatch(std::vector<Request> &batch) const {
+  try {
+    // A single request runs as is.
+    if (batch.size() == 1) {
+      batch.front().outs.set_value(_entryPoint.run(std::move(batch[0].ins)));
+      return;
+    }
+
+    // Concatenate the inputs along the batch dimension.
+    int64_t batchSize = 0;
+    for (const Request &request : batch)
+      batchSize += request.batchSize;
+    std::vector<OMTensorUniquePtr> batchedIns;
+    for (int64_t i = 0; i < _numInputs; ++i) {
+      const OMTensor *first = batch.front().ins[i].get();
+      int64_t rank = omTensorGetRank(first);
+      std::vector<int64_t> shape(
+          omTensorGetShape(first), omTensorGetShape(first) + rank);
+      shape[0] = batchSize;
+      OMTensorUniquePtr batchedIn(
+          omTensorCreateEmpty(shape.data(), rank, omTensorGetDataType(first)),
+          omTensorDestroy);
+      if (!batchedIn)
+        throw std::runtime_error(reportAllocationError());
+      char *dataPtr = static_cast<char *>(omTensorGetDataPtr(batchedIn.get()));
+      for (const Request &request : batch) {
+        const OMTensor *in = request.ins[i].get();
+        int64_t bufferSize = omTensorGetBufferSize(in);
+        memcpy(dataPtr, omTensorGetDataPtr(in), bufferSize);
+        dataPtr += bufferSize;
+      }
+      batchedIns.emplace_back(std::move(batchedIn));
+    }
+
+    std::vector<OMTensorUniquePtr> batchedOuts =
+        _entryPoint.run(std::move(batchedIns));
+
+    // Split the outputs along the batch dimension.
+    std::vector<std::vector<OMTensorUniquePtr>> outs(batch.size());
+    for (size_t o = 0; o < batchedOuts.size(); ++o) {
+      const OMTensor *batchedOut = batchedOuts[o].get();
+      int64_t rank = omTensorGetRank(batchedOut);
+      if (rank == 0 || omTensorGetShape(batchedOut)[0] != batchSize) {
+        std::stringstream errStr;
+        errStr << "Output " << o << " of '" << _entryPoint.getName()
+               << "' has no batch dimension." << std::endl;
+        errno = EINVAL;
+        throw std::runtime_error(errStr.str());
+      }
+      std::vector<int64_t> shape(
+          omTensorGetShape(batchedOut), omTensorGetShape(batchedOut) + rank);
+      int64_t rowSize = omTensorGetBufferSize(batchedOut) / batchSize;
+      const char *dataPtr =
+          static_cast<const char *>(omTensorGetDataPtr(batchedOut));
+      for (size_t r = 0; r < batch.size(); ++r) {
+        shape[0] = batch[r].batchSize;
+        OMTensorUniquePtr out(omTensorCreateEmpty(shape.data(), rank,
+                                  omTensorGetDataType(batchedOut)),
+            omTensorDestroy);
+        if (!out)
+          throw std::runtime_error(reportAllocationError());
+        int64_t bufferSize = rowSize * batch[r].batchSize;
+        memcpy(omTensorGetDataPtr(out.get()), dataPtr, bufferSize);
+        dataPtr += bufferSize;
+        outs[r].emplace_back(std::move(out));
+      }
+    }
+
+    for (size_t r = 0; r < batch.size(); ++r)
+      batch[r].outs.set_value(std::move(outs[r]));
+  } catch (...) {
+    // No promise is fulfilled before the last possible error.
+    for (Request &request : batch)
+      request.outs.set_exception(std::current_exception());
+  }
+}
+
+std::string ExecutionBatcher::reportAllocationError() {
+  errno = ENOMEM;
+  return "Cannot allocate batched tensor.\n";
+}
+
+bool ExecutionBatcher::areBatchable(const Request &lhs, const Request &rhs) {
+  for (size_t i = 0; i < lhs.ins.size(); ++i) {
+    const OMTensor *lhsIn = lhs.ins[i].get();
+    const OMTensor *rhsIn = rhs.ins[i].get();
+    int64_t rank = omTensorGetRank(lhsIn);
+    if (omTensorGetDataType(lhsIn) != omTensorGetDataType(rhsIn) ||
+        omTensorGetRank(rhsIn) != rank)
+      return false;
+    const int64_t *lhsShape = omTensorGetShape(lhsIn);
+    const int64_t *rhsShape = omTensorGetShape(rhsIn);
+    for (int64_t d = 1; d < rank; ++d)
+      if (lhsShape[d] != rhsShape[d])
+        return false;
+  }
+  return true;
+}
+
+} // namespace onnx_mlir
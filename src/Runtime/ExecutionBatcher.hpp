@@ -0,0 +1,106 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- ExecutionBatcher.hpp - ExecutionBatcher Declaration ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declarations of ExecutionBatcher class, which batches
+// concurrent inference requests to compiled binary model libraries.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ExecutionSession.hpp"
+
+namespace onnx_mlir {
+
+/* ExecutionBatcher
+ * Class that batches inference requests to an entry point of a compiled model.
+ *
+ * Requests, each a vector of input tensors, are queued and run together in a
+ * worker thread: their inputs are concatenated along the batch dimension, the
+ * model runs once, and its outputs are split back along the batch dimension.
+ * A batch runs as soon as the queued requests add up to maxBatchSize, or when
+ * the oldest queued request has waited for timeout. Only requests whose inputs
+ * have the same data types and the same sizes in all but the batch dimension
+ * are batched together.
+ *
+ * The batch dimension is the first dimension of all inputs and outputs. It
+ * must be dynamic in the input signature of the entry point, as left by
+ * ModelInputShaper for the batch size of most ONNX models. Tensors must have
+ * contiguous row-major data, as created by omTensorCreate.
+ *
+ * The run and submit functions may be called concurrently from any number of
+ * threads. Errors are reported as by ExecutionSession, by throwing
+ * std::runtime_error and setting errno. The error of a batch is reported to
+ * all of its requests.
+ */
+class ExecutionBatcher {
+public:
+  // Create a batcher for the given entry point, whose session must outlive
+  // the batcher.
+  ExecutionBatcher(const ExecutionEntryPoint &entryPoint, int64_t maxBatchSize,
+      std::chrono::microseconds timeout);
+  ExecutionBatcher(const ExecutionBatcher &) = delete;
+  ExecutionBatcher &operator=(const ExecutionBatcher &) = delete;
+  // Run all the queued requests before returning.
+  ~ExecutionBatcher();
+
+  // Queue a request and return the future of its outputs.
+  std::future<std::vector<OMTensorUniquePtr>> submit(
+      std::vector<OMTensorUniquePtr> ins);
+
+  // Queue a request and wait for its outputs.
+  std::vector<OMTensorUniquePtr> run(std::vector<OMTensorUniquePtr> ins);
+
+  int64_t getMaxBatchSize() const { return _maxBatchSize; }
+
+private:
+  struct Request {
+    std::vector<OMTensorUniquePtr> ins;
+    int64_t batchSize;
+    std::chrono::steady_clock::time_point arrivalTime;
+    std::promise<std::vector<OMTensorUniquePtr>> outs;
+  };
+
+  // Worker thread loop, forming and running batches until destruction.
+  void processRequests();
+  // Sum of the batch sizes of the queued requests batchable with the oldest
+  // one, up to the maximum batch size. Must be called with _mutex held.
+  int64_t getBatchableSize() const;
+  // Run the requests as a single batch and fulfill their promises.
+  void runBatch(std::vector<Request> &batch) const;
+
+  static bool areBatchable(const Request &lhs, const Request &rhs);
+  // Set errno and return the message of a runtime error.
+  static std::string reportAllocationError();
+
+  const ExecutionEntryPoint _entryPoint;
+  const int64_t _maxBatchSize;
+  const std::chrono::microseconds _timeout;
+  // Number of inputs of the entry point, from its input signature.
+  int64_t _numInputs = 0;
+
+  // Queued requests, oldest first, guarded by _mutex.
+  std::mutex _mutex;
+  std::condition_variable _queueChanged;
+  std::deque<Request> _queue;
+  bool _stopping = false;
+
+  // Started last, once all the other members are initialized.
+  std::thread _worker;
+};
+} // namespace onnx_mlir
@@ -0,0 +1,268 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ ExecutionPipeline.cpp - ExecutionPipeline Implementation ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementations of ExecutionPipeline class, which runs
+// the pipeline stages of compiled binary model libraries on micro-batches.
+//
+//===----------------------------------------------------------------------===//
+
+#include <errno.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "llvm/Support/JSON.h"
+
+#include "ExecutionPipeline.hpp"
+#include "OMTensorListHelper.hpp"
+
+namespace onnx_mlir {
+
+ExecutionPipeline::ExecutionPipeline(std::vector<ExecutionEntryPoint> stages,
+    std::vector<PipelineStageOptions> options, int64_t queueCapacity)
+    : _stages(std::move(stages)), _options(std::move(options)),
+      _queueCapacity(queueCapacity) {
+  if (_stages.empty()) {
+    errno = EINVAL;
+    throw std::runtime_error("Pipeline must have at least one stage.\n");
+  }
+  if (!_options.empty() && _options.size() != _stages.size()) {
+    errno = EINVAL;
+    throw std::runtime_error("Pipeline options must be given for every "
+                             "stage, or none.\n");
+  }
+  if (queueCapacity < 1) {
+    errno = EINVAL;
+    throw std::runtime_error("Queue capacity must be positive.\n");
+  }
+
+  // The outputs of each stage are the inputs of the next one.
+  std::vector<int64_t> numInputs, numOutputs;
+  for (const ExecutionEntryPoint &stage : _stages) {
+    numInputs.emplace_back(getSignatureSize(stage.inputSignature()));
+    numOutputs.emplace_back(getSignatureSize(stage.outputSignature()));
+    if (numInputs.back() < 0 || numOutputs.back() < 0) {
+      errno = EINVAL;
+      throw std::runtime_error(
+          "Cannot parse signatures of '" + stage.getName() + "'.\n");
+    }
+  }
+  for (size_t k = 0; k + 1 < _stages.size(); ++k) {
+    if (numOutputs[k] != numInputs[k + 1]) {
+      std::stringstream errStr;
+      errStr << "Stage '" << _stages[k].getName() << "' has " << numOutputs[k]
+             << " outputs, but stage '" << _stages[k + 1].getName()
+             << "' has " << numInputs[k + 1] << " inputs." << std::endl;
+      errno = EINVAL;
+      throw std::runtime_error(errStr.str());
+    }
+  }
+  _numInputs = numInputs.front();
+
+  for (size_t k = 0; k < _stages.size(); ++k)
+    _queues.emplace_back(std::make_unique<Queue>());
+  for (size_t k = 0; k < _stages.size(); ++k)
+    _workers.emplace_back([this, k]() { processStage(k); });
+  errno = 0; // No errors.
+}
+
+ExecutionPipeline::~ExecutionPipeline() {
+  // Each stage closes the queue of the next one once it has run all of its
+  // micro-batches.
+  {
+    std::lock_guard<std::mutex> lock(_queues.front()->mutex);
+    _queues.front()->closed = true;
+  }
+  _queues.front()->changed.notify_all();
+  for (std::thread &worker : _workers)
+    worker.join();
+}
+
+std::vector<ExecutionEntryPoint> ExecutionPipeline::getStages(
+    ExecutionSession &session, const std::string &funcName) {
+  int64_t numEntryPoints = 0;
+  const std::string *entryPointNames =
+      session.queryEntryPoints(&numEntryPoints);
+  std::vector<ExecutionEntryPoint> stages;
+  const std::string prefix = "run_" + funcName + "_stage";
+  while (true) {
+    std::string stageName = prefix + std::to_string(stages.size());
+    if (std::find(entryPointNames, entryPointNames + numEntryPoints,
+            stageName) == entryPointNames + numEntryPoints)
+      break;
+    stages.emplace_back(session.getEntryPoint(stageName));
+  }
+  if (stages.empty()) {
+    errno = EINVAL;
+    throw std::runtime_error(
+        "Model has no pipeline stages of '" + funcName + "'.\n");
+  }
+  errno = 0; // No errors.
+  return stages;
+}
+
+std::future<std::vector<OMTensorUniquePtr>> ExecutionPipeline::submit(
+    std::vector<OMTensorUniquePtr> ins) {
+  if ((int64_t)ins.size() != _numInputs) {
+    std::stringstream errStr;
+    errStr << "Wrong number of input tensors: expect " << _numInputs
+           << ", but got " << ins.size() << "." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+  MicroBatch microBatch;
+  microBatch.tensors = std::move(ins);
+  std::future<std::vector<OMTensorUniquePtr>> outs =
+      microBatch.outs.get_future();
+  push(0, std::move(microBatch));
+  errno = 0; // No errors.
+  return outs;
+}
+
+std::vector<OMTensorUniquePtr> ExecutionPipeline::run(
+    std::vector<OMTensorUniquePtr> ins) {
+  return submit(std::move(ins)).get();
+}
+
+std::vector<std::vector<OMTensorUniquePtr>> ExecutionPipeline::run(
+    std::vector<std::vector<OMTensorUniquePtr>> microBatches) {
+  // Check all the micro-batches before queueing any of them.
+  for (const std::vector<OMTensorUniquePtr> &ins : microBatches)
+    if ((int64_t)ins.size() != _numInputs) {
+      std::stringstream errStr;
+      errStr << "Wrong number of input tensors: expect " << _numInputs
+             << ", but got " << ins.size() << "." << std::endl;
+      errno = EINVAL;
+      throw std::runtime_error(errStr.str());
+    }
+  std::vector<std::future<std::vector<OMTensorUniquePtr>>> futures;
+  for (std::vector<OMTensorUniquePtr> &ins : microBatches)
+    futures.emplace_back(submit(std::move(ins)));
+  std::vector<std::vector<OMTensorUniquePtr>> outs;
+  for (std::future<std::vector<OMTensorUniquePtr>> &future : futures)
+    outs.emplace_back(future.get());
+  return outs;
+}
+
+void ExecutionPipeline::push(int64_t stage, MicroBatch microBatch) {
+  Queue &queue = *_queues[stage];
+  {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    queue.changed.wait(lock, [&]() {
+      return (int64_t)queue.microBatches.size() < _queueCapacity;
+    });
+    queue.microBatches.emplace_back(std::move(microBatch));
+  }
+  queue.changed.notify_all();
+}
+
+void ExecutionPipeline::processStage(int64_t stage) {
+  // Run the stage on its own threads and memory, e.g. those of a socket.
+  std::exception_ptr bindError;
+  if (!_options.empty()) {
+    const PipelineStageOptions &options = _options[stage];
+    if (omThreadPoolBind(options.threadPool, options.maxConcurrency) != 0)
+      bindError = std::make_exception_ptr(std::runtime_error(
+          "Cannot bind thread pool of '" + _stages[stage].getName() + "'.\n"));
+    omAllocatorBind(options.allocator);
+  }
+
+  Queue &queue = *_queues[stage];
+  bool isLastStage = stage + 1 == (int64_t)_stages.size();
+  while (true) {
+    MicroBatch microBatch;
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.changed.wait(
+          lock, [&]() { return queue.closed || !queue.microBatches.empty(); });
+      if (queue.microBatches.empty())
+        break; // Closed with no more micro-batches.
+      microBatch = std::move(queue.microBatches.front());
+      queue.microBatches.pop_front();
+    }
+    // Make room for the previous stage.
+    queue.changed.notify_all();
+
+    try {
+      if (bindError)
+        std::rethrow_exception(bindError);
+      microBatch.tensors = runStage(stage, std::move(microBatch.tensors));
+    } catch (...) {
+      microBatch.outs.set_exception(std::current_exception());
+      continue;
+    }
+    if (isLastStage)
+      microBatch.outs.set_value(std::move(microBatch.tensors));
+    else
+      push(stage + 1, std::move(microBatch));
+  }
+
+  if (!isLastStage) {
+    Queue &nextQueue = *_queues[stage + 1];
+    {
+      std::lock_guard<std::mutex> lock(nextQueue.mutex);
+      nextQueue.closed = true;
+    }
+    nextQueue.changed.notify_all();
+  }
+}
+
+std::vector<OMTensorUniquePtr> ExecutionPipeline::runStage(
+    int64_t stage, std::vector<OMTensorUniquePtr> ins) const {
+  // The inputs are kept until the run returns, since the outputs passing them
+  // through refer to their data.
+  std::vector<OMTensor *> omts;
+  for (const OMTensorUniquePtr &in : ins)
+    omts.emplace_back(in.get());
+  OMTensorList *wrappedInput =
+      omTensorListCreate(omts.data(), (int64_t)omts.size());
+  OMTensorList *wrappedOutput = nullptr;
+  try {
+    wrappedOutput = _stages[stage].run(wrappedInput);
+  } catch (...) {
+    omTensorListDestroyShallow(wrappedInput);
+    throw;
+  }
+  omTensorListDestroyShallow(wrappedInput);
+
+  std::vector<OMTensorUniquePtr> outs;
+  for (int64_t i = 0; i < omTensorListGetSize(wrappedOutput); ++i)
+    outs.emplace_back(omTensorListGetOmtByIndex(wrappedOutput, i),
+        omTensorDestroy);
+  omTensorListDestroyShallow(wrappedOutput);
+
+  // An output that is an input passed through by the stage does not own its
+  // data, which is then transferred from the input to the output before the
+  // input is destroyed.
+  for (OMTensorUniquePtr &out : outs) {
+    if (omTensorGetOwning(out.get()))
+      continue;
+    for (OMTensorUniquePtr &in : ins)
+      if (omTensorGetOwning(in.get()) &&
+          omTensorGetDataPtr(in.get()) == omTensorGetDataPtr(out.get())) {
+        omTensorSetOwning(in.get(), false);
+        omTensorSetOwning(out.get(), true);
+        break;
+      }
+  }
+  return outs;
+}
+
+int64_t ExecutionPipeline::getSignatureSize(const std::string &signature) {
+  llvm::Expected<llvm::json::Value> jsonSig = llvm::json::parse(signature);
+  if (!jsonSig) {
+    llvm::consumeError(jsonSig.takeError());
+    return -1;
+  }
+  const llvm::json::Array *jsonTensors = jsonSig->getAsArray();
+  return jsonTensors ? jsonTensors->size() : -1;
+}
+
+} // namespace onnx_mlir
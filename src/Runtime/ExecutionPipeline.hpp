@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ ExecutionPipeline.hpp - ExecutionPipeline Declaration ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declarations of ExecutionPipeline class, which runs the
+// pipeline stages of compiled binary model libraries on micro-batches.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ExecutionSession.hpp"
+
+namespace onnx_mlir {
+
+// Resources of a stage of an ExecutionPipeline, e.g. the threads and the
+// memory of a socket.
+struct PipelineStageOptions {
+  // Pool running the parallel loops of the stage, e.g. created by
+  // omThreadPoolCreate on the cpus of a socket, or null for the default pool.
+  OMThreadPool *threadPool = nullptr;
+  // Maximum number of threads taking part in each loop, or 0 for no limit.
+  int64_t maxConcurrency = 0;
+  // Allocator of the buffers of the stage, e.g. created by omAllocatorCreate
+  // on the memory node of the socket, or null for the default allocator.
+  const OMAllocator *allocator = nullptr;
+};
+
+/* ExecutionPipeline
+ * Class that runs the pipeline stages of a model on micro-batches.
+ *
+ * The stages are entry points whose outputs are the inputs of the next
+ * stage, as compiled with --pipeline-stages into the entry points
+ * run_<func>_stage<k>. These entry points replace run_<func>, so that such a
+ * model must be loaded by an ExecutionSession with defaultEntryPoint set to
+ * false, e.g.
+ *
+ *   ExecutionSession session(libPath, false); // No run_main_graph.
+ *   ExecutionPipeline pipeline(ExecutionPipeline::getStages(session));
+ *
+ * Each stage runs in a worker thread of its own, bound to the thread pool and
+ * the allocator of its options, and takes its micro-batches from a bounded
+ * queue filled by the previous stage. Stage k thus runs micro-batch i while
+ * stage k+1 runs micro-batch i-1, and the activations are passed between the
+ * stages in shared memory, without copies.
+ *
+ * The caller splits its batch into micro-batches, submitted in order. The run
+ * and submit functions may be called concurrently from any number of
+ * threads, submit blocking while the queue of the first stage is full. Errors
+ * are reported as by ExecutionSession, by throwing std::runtime_error and
+ * setting errno. The error of a stage is reported to its micro-batch, which
+ * is not passed to the following stages.
+ */
+class ExecutionPipeline {
+public:
+  // Create a pipeline running the given stages, whose session must outlive
+  // the pipeline. The options are given for every stage, or none. At most
+  // queueCapacity micro-batches wait for each stage.
+  ExecutionPipeline(std::vector<ExecutionEntryPoint> stages,
+      std::vector<PipelineStageOptions> options = {},
+      int64_t queueCapacity = 2);
+  ExecutionPipeline(const ExecutionPipeline &) = delete;
+  ExecutionPipeline &operator=(const ExecutionPipeline &) = delete;
+  // Run all the queued micro-batches before returning.
+  ~ExecutionPipeline();
+
+  // Resolve the stages run_<funcName>_stage<k> of a model, in order.
+  static std::vector<ExecutionEntryPoint> getStages(
+      ExecutionSession &session, const std::string &funcName = "main_graph");
+
+  // Queue a micro-batch and return the future of its outputs.
+  std::future<std::vector<OMTensorUniquePtr>> submit(
+      std::vector<OMTensorUniquePtr> ins);
+
+  // Queue a micro-batch and wait for its outputs.
+  std::vector<OMTensorUniquePtr> run(std::vector<OMTensorUniquePtr> ins);
+
+  // Queue micro-batches, so that the stages run them concurrently, and wait
+  // for their outputs, in order.
+  std::vector<std::vector<OMTensorUniquePtr>> run(
+      std::vector<std::vector<OMTensorUniquePtr>> microBatches);
+
+  int64_t getNumStages() const { return _stages.size(); }
+
+private:
+  struct MicroBatch {
+    std::vector<OMTensorUniquePtr> tensors;
+    std::promise<std::vector<OMTensorUniquePtr>> outs;
+  };
+
+  // Bounded queue of the micro-batches waiting for a stage.
+  struct Queue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<MicroBatch> microBatches;
+    bool closed = false;
+  };
+
+  // Wait for room in the queue of a stage and queue a micro-batch.
+  void push(int64_t stage, MicroBatch microBatch);
+  // Worker thread loop of a stage, until its queue is closed and empty.
+  void processStage(int64_t stage);
+  // Run a stage on the tensors of a micro-batch.
+  std::vector<OMTensorUniquePtr> runStage(
+      int64_t stage, std::vector<OMTensorUniquePtr> ins) const;
+
+  // Return the number of tensors of a signature, or -1 if it is malformed.
+  static int64_t getSignatureSize(const std::string &signature);
+
+  const std::vector<ExecutionEntryPoint> _stages;
+  const std::vector<PipelineStageOptions> _options;
+  const int64_t _queueCapacity;
+  // Number of inputs of the first stage, from its input signature.
+  int64_t _numInputs = 0;
+
+  // Queue of each stage, the last stage fulfilling the promises.
+  std::vector<std::unique_ptr<Queue>> _queues;
+
+  // Started last, once all the other members are initialized.
+  std::vector<std::thread> _workers;
+};
+} // namespace onnx_mlir
@@ -0,0 +1,155 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----- ExecutionScheduler.cpp - ExecutionScheduler Implementation -----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementations of ExecutionScheduler class, which shares
+// the cores of a process between the inferences of the models it hosts.
+//
+//===----------------------------------------------------------------------===//
+
+#include <errno.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "ExecutionScheduler.hpp"
+
+namespace onnx_mlir {
+
+ExecutionScheduler::ExecutionScheduler(int64_t numRunners, OMThreadPool *pool)
+    : _pool(pool) {
+  if (numRunners < 0) {
+    errno = EINVAL;
+    throw std::runtime_error("Number of runners must not be negative.\n");
+  }
+  if (numRunners == 0) {
+    OMThreadPool *runnerPool = pool ? pool : omThreadPoolGetDefault();
+    numRunners = runnerPool ? omThreadPoolGetNumThreads(runnerPool) + 1 : 1;
+  }
+  for (int64_t i = 0; i < numRunners; ++i)
+    _runners.emplace_back([this]() { runRequests(); });
+  errno = 0; // No errors.
+}
+
+ExecutionScheduler::~ExecutionScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _queueChanged.notify_all();
+  for (std::thread &runner : _runners)
+    runner.join();
+}
+
+int64_t ExecutionScheduler::addClass(
+    const ExecutionEntryPoint &entryPoint, const ClassOptions &options) {
+  if (!(options.weight > 0) || options.maxInFlight < 0 ||
+      options.maxConcurrency < 0) {
+    errno = EINVAL;
+    throw std::runtime_error("Invalid scheduling class options.\n");
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  _classes.emplace_back(entryPoint, options);
+  errno = 0; // No errors.
+  return _classes.size() - 1;
+}
+
+std::future<std::vector<OMTensorUniquePtr>> ExecutionScheduler::submit(
+    int64_t classId, std::vector<OMTensorUniquePtr> ins,
+    Clock::time_point deadline) {
+  Request request;
+  request.ins = std::move(ins);
+  std::future<std::vector<OMTensorUniquePtr>> outs =
+      request.outs.get_future();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (classId < 0 || classId >= (int64_t)_classes.size()) {
+      std::stringstream errStr;
+      errStr << "Unknown scheduling class " << classId << "." << std::endl;
+      errno = EINVAL;
+      throw std::runtime_error(errStr.str());
+    }
+    Class &cls = _classes[classId];
+    // A class becoming active is not owed the runner time it did not use
+    // while idle, so it resumes at the share of the active classes.
+    if (cls.queue.empty() && cls.numInFlight == 0)
+      for (const Class &other : _classes)
+        if (&other != &cls && other.options.priority == cls.options.priority &&
+            (!other.queue.empty() || other.numInFlight > 0))
+          cls.usedTime = std::max(cls.usedTime, other.usedTime);
+    cls.queue.emplace(
+        std::make_pair(deadline, _numSubmitted++), std::move(request));
+    ++_numQueued;
+  }
+  _queueChanged.notify_one();
+  errno = 0; // No errors.
+  return outs;
+}
+
+std::vector<OMTensorUniquePtr> ExecutionScheduler::run(int64_t classId,
+    std::vector<OMTensorUniquePtr> ins, Clock::time_point deadline) {
+  return submit(classId, std::move(ins), deadline).get();
+}
+
+ExecutionScheduler::Class *ExecutionScheduler::pickClass() {
+  Class *next = nullptr;
+  for (Class &cls : _classes) {
+    if (cls.queue.empty() || (cls.options.maxInFlight > 0 &&
+                                 cls.numInFlight >= cls.options.maxInFlight))
+      continue;
+    if (!next || cls.options.priority > next->options.priority ||
+        (cls.options.priority == next->options.priority &&
+            cls.usedTime < next->usedTime))
+      next = &cls;
+  }
+  return next;
+}
+
+void ExecutionScheduler::runRequests() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    Class *cls = nullptr;
+    _queueChanged.wait(lock, [&]() {
+      cls = pickClass();
+      return cls || (_stopping && _numQueued == 0);
+    });
+    if (!cls)
+      return; // Stopping with no more requests.
+    auto node = cls->queue.extract(cls->queue.begin());
+    --_numQueued;
+    ++cls->numInFlight;
+    lock.unlock();
+
+    Request &request = node.mapped();
+    Clock::time_point start = Clock::now();
+    if (node.key().first < start) {
+      errno = ETIMEDOUT;
+      request.outs.set_exception(std::make_exception_ptr(std::runtime_error(
+          "Deadline of the inference passed before it started.\n")));
+    } else {
+      try {
+        if (omThreadPoolBind(_pool, cls->options.maxConcurrency) != 0 ||
+            omThreadPoolSetPriority(cls->options.priority) != 0)
+          throw std::runtime_error("Cannot bind the runner to the pool.\n");
+        request.outs.set_value(cls->entryPoint.run(std::move(request.ins)));
+      } catch (...) {
+        request.outs.set_exception(std::current_exception());
+      }
+    }
+    std::chrono::duration<double> used = Clock::now() - start;
+
+    lock.lock();
+    --cls->numInFlight;
+    cls->usedTime += used.count() / cls->options.weight;
+    // The class may be below its limit of inferences in flight again.
+    _queueChanged.notify_all();
+  }
+}
+
+} // namespace onnx_mlir
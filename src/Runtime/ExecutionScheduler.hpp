@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ ExecutionScheduler.hpp - ExecutionScheduler Declaration -------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declarations of ExecutionScheduler class, which shares
+// the cores of a process between the inferences of the models it hosts.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ExecutionSession.hpp"
+
+namespace onnx_mlir {
+
+/* ExecutionScheduler
+ * Class that arbitrates the cores of a process between the inferences of the
+ * models it hosts, e.g. latency-critical and batch ones.
+ *
+ * Each model is registered with a scheduling class, and its inferences are
+ * queued and run by the runner threads of the scheduler. A free runner runs
+ * an inference of the class of highest priority that has queued inferences
+ * and is below its limit of inferences in flight. Among classes of the same
+ * priority, it picks the class that used the least runner time relative to
+ * its weight, for a fair share of the runners. Within a class, inferences run
+ * by earliest deadline first and then in submission order. An inference
+ * whose deadline has passed before it starts fails instead of running late.
+ *
+ * The parallel loops of an inference run on the pool of the scheduler, with
+ * the priority of the class, see omThreadPoolSetPriority, and with at most
+ * maxConcurrency threads, see omThreadPoolBind. The workers of the pool thus
+ * join the loops of latency-critical models first, and the loops of batch
+ * models soak up the idle workers.
+ *
+ * The submit and run functions may be called concurrently from any number of
+ * threads. Errors are reported as by ExecutionSession, by throwing
+ * std::runtime_error and setting errno.
+ */
+class ExecutionScheduler {
+public:
+  struct ClassOptions {
+    // Classes of higher priority run first.
+    int64_t priority = 0;
+    // Share of the runner time among the classes of the same priority.
+    double weight = 1;
+    // Maximum number of inferences of the class in flight, or 0 for no limit.
+    int64_t maxInFlight = 0;
+    // Maximum number of threads taking part in each parallel loop of the
+    // inferences, or 0 for no limit.
+    int64_t maxConcurrency = 0;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  // Create a scheduler running numRunners inferences at a time, or as many as
+  // the threads of the pool with 0, whose loops run on the pool, or on the
+  // default pool when null. The pool must outlive the scheduler.
+  ExecutionScheduler(int64_t numRunners = 0, OMThreadPool *pool = nullptr);
+  ExecutionScheduler(const ExecutionScheduler &) = delete;
+  ExecutionScheduler &operator=(const ExecutionScheduler &) = delete;
+  // Run all the queued inferences before returning.
+  ~ExecutionScheduler();
+
+  // Register the entry point of a model, whose session must outlive the
+  // scheduler, and return the id of its class.
+  int64_t addClass(
+      const ExecutionEntryPoint &entryPoint, const ClassOptions &options);
+
+  // Queue an inference of a class and return the future of its outputs.
+  std::future<std::vector<OMTensorUniquePtr>> submit(int64_t classId,
+      std::vector<OMTensorUniquePtr> ins,
+      Clock::time_point deadline = Clock::time_point::max());
+
+  // Queue an inference of a class and wait for its outputs.
+  std::vector<OMTensorUniquePtr> run(int64_t classId,
+      std::vector<OMTensorUniquePtr> ins,
+      Clock::time_point deadline = Clock::time_point::max());
+
+  int64_t getNumRunners() const { return _runners.size(); }
+
+private:
+  struct Request {
+    std::vector<OMTensorUniquePtr> ins;
+    std::promise<std::vector<OMTensorUniquePtr>> outs;
+  };
+
+  struct Class {
+    Class(const ExecutionEntryPoint &entryPoint, const ClassOptions &options)
+        : entryPoint(entryPoint), options(options) {}
+
+    const ExecutionEntryPoint entryPoint;
+    const ClassOptions options;
+    // Fields below are guarded by _mutex. Queued requests, by deadline and
+    // then submission order.
+    std::map<std::pair<Clock::time_point, uint64_t>, Request> queue;
+    int64_t numInFlight = 0;
+    // Runner time used in seconds, divided by the weight.
+    double usedTime = 0;
+  };
+
+  // Runner thread loop, running inferences until destruction.
+  void runRequests();
+  // Class of the next inference to run, or null if none may run. Must be
+  // called with _mutex held.
+  Class *pickClass();
+
+  OMThreadPool *const _pool;
+
+  // Classes, in registration order, guarded by _mutex. A deque keeps them in
+  // place as classes are added.
+  std::mutex _mutex;
+  std::condition_variable _queueChanged;
+  std::deque<Class> _classes;
+  int64_t _numQueued = 0;
+  uint64_t _numSubmitted = 0;
+  bool _stopping = false;
+
+  // Started last, once all the other members are initialized.
+  std::vector<std::thread> _runners;
+};
+} // namespace onnx_mlir
@@ -4,7 +4,7 @@
 
 //===------- ExecutionSession.cpp - ExecutionSession Implementation -------===//
 //
-// Copyright 2019-2020 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -16,11 +16,24 @@
 #include <errno.h>
 #include <string.h>
 
+#if !defined(_WIN32) && !defined(__MVS__)
+#include <dlfcn.h>
+#endif
+#if defined(__linux__)
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <vector>
 
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
 
@@ -32,12 +45,188 @@ const std::string ExecutionSession::_queryEntryPointsName =
     "omQueryEntryPoints";
 const std::string ExecutionSession::_inputSignatureName = "omInputSignature";
 const std::string ExecutionSession::_outputSignatureName = "omOutputSignature";
+const std::string ExecutionSession::_entryPointIntoSuffix = "_into";
+
+namespace {
+// Return the data type of a type of the signature, e.g. "f32", or
+// ONNX_TYPE_UNDEFINED if it is not the type of a tensor of numbers.
+OM_DATA_TYPE getSignatureDataType(llvm::StringRef type) {
+  return llvm::StringSwitch<OM_DATA_TYPE>(type)
+      .Case("i1", ONNX_TYPE_BOOL)
+      .Case("i8", ONNX_TYPE_INT8)
+      .Case("i16", ONNX_TYPE_INT16)
+      .Case("i32", ONNX_TYPE_INT32)
+      .Case("i64", ONNX_TYPE_INT64)
+      .Case("ui8", ONNX_TYPE_UINT8)
+      .Case("ui16", ONNX_TYPE_UINT16)
+      .Case("ui32", ONNX_TYPE_UINT32)
+      .Case("ui64", ONNX_TYPE_UINT64)
+      .Case("f16", ONNX_TYPE_FLOAT16)
+      .Case("bf16", ONNX_TYPE_BFLOAT16)
+      .Case("f32", ONNX_TYPE_FLOAT)
+      .Case("f64", ONNX_TYPE_DOUBLE)
+      .Default(ONNX_TYPE_UNDEFINED);
+}
+
+#if defined(__linux__)
+struct PrefaultRequest {
+  // Address in the library, e.g. of one of its functions.
+  uintptr_t address;
+  bool lock;
+  // Errno of the first failure to lock pages, or 0.
+  int err;
+};
+
+// Fault in or lock the loadable segments of the shared object holding the
+// address of the request, if it is the one of info.
+int prefaultObject(struct dl_phdr_info *info, size_t, void *data) {
+  auto *request = static_cast<PrefaultRequest *>(data);
+  const ElfW(Phdr) *begin = info->dlpi_phdr;
+  const ElfW(Phdr) *end = begin + info->dlpi_phnum;
+  if (std::none_of(begin, end, [&](const ElfW(Phdr) & phdr) {
+        uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+        return phdr.p_type == PT_LOAD && request->address >= start &&
+               request->address < start + phdr.p_memsz;
+      }))
+    return 0;
+  uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  for (const ElfW(Phdr) *phdr = begin; phdr != end; ++phdr) {
+    if (phdr->p_type != PT_LOAD || !(phdr->p_flags & PF_R))
+      continue;
+    uintptr_t start = (info->dlpi_addr + phdr->p_vaddr) & ~(pageSize - 1);
+    uintptr_t stop = info->dlpi_addr + phdr->p_vaddr + phdr->p_memsz;
+    if (request->lock) {
+      if (mlock(reinterpret_cast<void *>(start), stop - start) != 0 &&
+          !request->err)
+        request->err = errno;
+      continue;
+    }
+    madvise(reinterpret_cast<void *>(start), stop - start, MADV_WILLNEED);
+    for (uintptr_t page = start; page < stop; page += pageSize)
+      (void)*reinterpret_cast<volatile const char *>(page);
+  }
+  // Stop at the shared object of the address.
+  return 1;
+}
+#endif
+
+// Measure of an inference run by the calling thread for the callback of
+// omMetricsSetCallback, measuring nothing when no callback is registered.
+class InferenceMetrics {
+public:
+  InferenceMetrics(const std::string &entryPointName)
+      : callback(omMetricsGetCallback(&context)),
+        entryPointName(entryPointName) {
+    if (!callback)
+      return;
+    omArenaResetPeak();
+    omArenaGetStats(&arenaStats);
+    omThreadPoolTakeMaxThreads();
+    start = std::chrono::steady_clock::now();
+  }
+
+  // Report the inference, given its output list or null if it failed. The
+  // output tensors allocated by the inference are counted with countOutputs.
+  void report(OMTensorList *output, bool countOutputs = true) {
+    if (!callback)
+      return;
+    auto latency = std::chrono::steady_clock::now() - start;
+    int err = errno;
+    OMMemoryStats endArenaStats;
+    omArenaGetStats(&endArenaStats);
+    OMInferenceMetrics metrics;
+    metrics.structSize = sizeof(OMInferenceMetrics);
+    metrics.entryPointName = entryPointName.c_str();
+    metrics.latencyNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    metrics.outputBytes = 0;
+    if (output && countOutputs)
+      for (int64_t i = 0; i < omTensorListGetSize(output); ++i)
+        metrics.outputBytes +=
+            omTensorGetBufferSize(omTensorListGetOmtByIndex(output, i));
+    metrics.peakArenaBytes = endArenaStats.peakBytes - arenaStats.currentBytes;
+    metrics.numArenaAllocs = endArenaStats.numAllocs - arenaStats.numAllocs;
+    metrics.numThreads = omThreadPoolTakeMaxThreads();
+    metrics.errorCode = output ? 0 : err;
+    callback(context, &metrics);
+    errno = err;
+  }
+
+private:
+  void *context = nullptr;
+  const OMMetricsCallback callback;
+  const std::string &entryPointName;
+  OMMemoryStats arenaStats;
+  std::chrono::steady_clock::time_point start;
+};
+} // namespace
 
 ExecutionSession::ExecutionSession(
     std::string sharedLibPath, bool defaultEntryPoint) {
+  loadLibrary(sharedLibPath, defaultEntryPoint, /*bindNow=*/false);
+}
+
+ExecutionSession::ExecutionSession(std::string sharedLibPath,
+    const WarmupOptions &options, bool defaultEntryPoint) {
+  loadLibrary(sharedLibPath, defaultEntryPoint, options.bindNow);
+  warmup(options);
+}
 
+ExecutionSession::ExecutionSession(
+    llvm::MemoryBufferRef sharedLib, bool defaultEntryPoint) {
+#if defined(__linux__)
+  _sharedLibraryFd = memfd_create("onnx-mlir-model", MFD_CLOEXEC);
+  if (_sharedLibraryFd < 0)
+    throw std::runtime_error(reportErrnoError());
+  const char *data = sharedLib.getBufferStart();
+  size_t remaining = sharedLib.getBufferSize();
+  while (remaining > 0) {
+    ssize_t written = write(_sharedLibraryFd, data, remaining);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written < 0) {
+      std::string error = reportErrnoError();
+      close(_sharedLibraryFd);
+      throw std::runtime_error(error);
+    }
+    data += written;
+    remaining -= written;
+  }
+  try {
+    loadLibrary("/proc/self/fd/" + std::to_string(_sharedLibraryFd),
+        defaultEntryPoint, /*bindNow=*/false);
+  } catch (...) {
+    // The destructor is not run for a constructor throwing.
+    if (_sharedLibraryHandle.isValid())
+      llvm::sys::DynamicLibrary::closeLibrary(_sharedLibraryHandle);
+    close(_sharedLibraryFd);
+    throw;
+  }
+#else
+  errno = ENOTSUP;
+  throw std::runtime_error(
+      "Cannot load a library from memory on this platform.");
+#endif
+}
+
+void ExecutionSession::loadLibrary(
+    const std::string &sharedLibPath, bool defaultEntryPoint, bool bindNow) {
+#if !defined(_WIN32) && !defined(__MVS__)
+  // Loading the library once with all its symbols resolved binds them for
+  // the handle below too, which keeps it loaded.
+  void *boundLibrary = nullptr;
+  if (bindNow) {
+    boundLibrary = dlopen(sharedLibPath.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if (!boundLibrary)
+      throw std::runtime_error(reportLibraryOpeningError(sharedLibPath));
+  }
+#endif
   _sharedLibraryHandle =
       llvm::sys::DynamicLibrary::getLibrary(sharedLibPath.c_str());
+#if !defined(_WIN32) && !defined(__MVS__)
+  if (boundLibrary)
+    dlclose(boundLibrary);
+#endif
   if (!_sharedLibraryHandle.isValid())
     throw std::runtime_error(reportLibraryOpeningError(sharedLibPath));
 
@@ -71,21 +260,291 @@ void ExecutionSession::setEntryPoint(const std::string &entryPointName) {
       _sharedLibraryHandle.getAddressOfSymbol(entryPointName.c_str()));
   if (!_entryPointFunc)
     throw std::runtime_error(reportSymbolLoadingError(entryPointName));
+  // Optional, so that models compiled before its introduction still load.
+  _entryPointIntoFunc = reinterpret_cast<entryPointIntoFuncType>(
+      _sharedLibraryHandle.getAddressOfSymbol(
+          (entryPointName + _entryPointIntoSuffix).c_str()));
   _entryPointName = entryPointName;
   errno = 0; // No errors.
 }
 
+ExecutionEntryPoint ExecutionSession::getEntryPoint(
+    const std::string &entryPointName) {
+  auto entryPointFunc = reinterpret_cast<entryPointFuncType>(
+      _sharedLibraryHandle.getAddressOfSymbol(entryPointName.c_str()));
+  if (!entryPointFunc)
+    throw std::runtime_error(reportSymbolLoadingError(entryPointName));
+  auto entryPointIntoFunc = reinterpret_cast<entryPointIntoFuncType>(
+      _sharedLibraryHandle.getAddressOfSymbol(
+          (entryPointName + _entryPointIntoSuffix).c_str()));
+  errno = 0; // No errors.
+  return ExecutionEntryPoint(entryPointName, entryPointFunc,
+      entryPointIntoFunc, _inputSignatureFunc, _outputSignatureFunc);
+}
+
+// Return the names of the tensors of an output signature, or an empty list if
+// it cannot be parsed.
+static std::vector<std::string> getOutputNames(const char *signature) {
+  std::vector<std::string> names;
+  llvm::Expected<llvm::json::Value> jsonSig = llvm::json::parse(signature);
+  if (!jsonSig) {
+    llvm::consumeError(jsonSig.takeError());
+    return names;
+  }
+  if (const llvm::json::Array *jsonTensors = jsonSig->getAsArray())
+    for (const llvm::json::Value &jsonTensor : *jsonTensors) {
+      const llvm::json::Object *object = jsonTensor.getAsObject();
+      auto name = object ? object->getString("name") : std::nullopt;
+      names.emplace_back(name ? name->str() : "");
+    }
+  return names;
+}
+
+ExecutionEntryPoint ExecutionSession::getEntryPointForOutputs(
+    const std::vector<std::string> &outputNames) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(
+        reportUndefinedEntryPointIn("getEntryPointForOutputs"));
+  // The full entry point, its variants for subsets of its outputs and for
+  // groups of extracted nodes.
+  std::string subsetPrefix = _entryPointName + "_subset";
+  std::string extractPrefix = _entryPointName + "_extract";
+  std::string bestName;
+  size_t bestNumOutputs = 0;
+  int64_t numOfEntryPoints = 0;
+  const char **entryPointNames = _queryEntryPointsFunc(&numOfEntryPoints);
+  for (int64_t i = 0; i < numOfEntryPoints; ++i) {
+    std::string name = entryPointNames[i];
+    llvm::StringRef variantIndex(name);
+    unsigned index;
+    if (name != _entryPointName &&
+        ((!variantIndex.consume_front(subsetPrefix) &&
+             !variantIndex.consume_front(extractPrefix)) ||
+            variantIndex.getAsInteger(10, index)))
+      continue;
+    std::vector<std::string> names =
+        getOutputNames(_outputSignatureFunc(name.c_str()));
+    bool computesAll = std::all_of(
+        outputNames.begin(), outputNames.end(), [&](const std::string &n) {
+          return std::find(names.begin(), names.end(), n) != names.end();
+        });
+    if (computesAll && (bestName.empty() || names.size() < bestNumOutputs)) {
+      bestName = name;
+      bestNumOutputs = names.size();
+    }
+  }
+  if (bestName.empty()) {
+    std::stringstream errStr;
+    errStr << "Entry point '" << _entryPointName
+           << "' has no variant computing the requested outputs." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+  return getEntryPoint(bestName);
+}
+
 std::vector<OMTensorUniquePtr> ExecutionSession::run(
     std::vector<OMTensorUniquePtr> ins) {
   if (!_entryPointFunc)
     throw std::runtime_error(reportUndefinedEntryPointIn("run"));
+  return ExecutionEntryPoint::runEntryPointFunc(
+      _entryPointName, _entryPointFunc, std::move(ins));
+}
 
+// Run using public interface. Explicit calls are needed to free tensor & tensor
+// lists.
+OMTensorList *ExecutionSession::run(OMTensorList *input) {
+  if (!_entryPointFunc) {
+    std::stringstream errStr;
+    errStr << "Must set the entry point before calling run function"
+           << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+  return ExecutionEntryPoint::runEntryPointFunc(
+      _entryPointName, _entryPointFunc, input);
+}
+
+std::future<std::vector<OMTensorUniquePtr>> ExecutionSession::runAsync(
+    std::vector<OMTensorUniquePtr> ins) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("runAsync"));
+  return ExecutionEntryPoint::runEntryPointAsyncFunc(
+      _entryPointName, _entryPointFunc, std::move(ins));
+}
+
+void ExecutionSession::runAsync(
+    std::vector<OMTensorUniquePtr> ins, runCallbackType callback) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("runAsync"));
+  ExecutionEntryPoint::runEntryPointAsyncFunc(
+      _entryPointName, _entryPointFunc, std::move(ins), std::move(callback));
+}
+
+void ExecutionSession::runInto(const std::vector<OMTensorUniquePtr> &ins,
+    const std::vector<OMTensorUniquePtr> &outs) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("runInto"));
+  ExecutionEntryPoint::runEntryPointIntoFunc(
+      _entryPointName, _entryPointIntoFunc, ins, outs);
+}
+
+OMTensorList *ExecutionSession::runInto(
+    OMTensorList *input, OMTensorList *output) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("runInto"));
+  return ExecutionEntryPoint::runEntryPointIntoFunc(
+      _entryPointName, _entryPointIntoFunc, input, output);
+}
+
+std::vector<OMTensorUniquePtr> ExecutionSession::runSplitBatch(
+    const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices) {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("runSplitBatch"));
+  return ExecutionEntryPoint::runEntryPointSplitBatchFunc(_entryPointName,
+      _entryPointIntoFunc, _inputSignatureFunc, _outputSignatureFunc, ins,
+      numSlices);
+}
+
+void ExecutionSession::warmup(const WarmupOptions &options) {
+  if (options.numRuns > 0 && !_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("warmup"));
+  if (options.prefault || options.lock)
+    prefault(options.lock);
+  for (int64_t i = 0; i < options.numRuns; ++i)
+    run(createWarmupInputs());
+  errno = 0; // No errors.
+}
+
+void ExecutionSession::prefault(bool lock) {
+#if defined(__linux__)
+  PrefaultRequest request = {
+      reinterpret_cast<uintptr_t>(_queryEntryPointsFunc), lock, 0};
+  dl_iterate_phdr(prefaultObject, &request);
+  if (request.err) {
+    errno = request.err;
+    std::stringstream errStr;
+    errStr << "Cannot lock the library into memory: '" << strerror(errno)
+           << "'." << std::endl;
+    throw std::runtime_error(errStr.str());
+  }
+#endif
+  errno = 0; // No errors.
+}
+
+std::vector<OMTensorUniquePtr> ExecutionSession::createWarmupInputs() const {
+  llvm::Expected<llvm::json::Value> signature =
+      llvm::json::parse(inputSignature());
+  if (!signature) {
+    llvm::consumeError(signature.takeError());
+    throw std::runtime_error(reportWarmupInputError("invalid signature"));
+  }
+  const llvm::json::Array *inputs = signature->getAsArray();
+  if (!inputs)
+    throw std::runtime_error(reportWarmupInputError("invalid signature"));
+  std::vector<OMTensorUniquePtr> ins;
+  for (const llvm::json::Value &input : *inputs) {
+    const llvm::json::Object *object = input.getAsObject();
+    auto type = object ? object->getString("type") : std::nullopt;
+    const llvm::json::Array *dims = object ? object->getArray("dims") : nullptr;
+    if (!type || !dims)
+      throw std::runtime_error(reportWarmupInputError("input not a tensor"));
+    OM_DATA_TYPE dataType = getSignatureDataType(*type);
+    if (dataType == ONNX_TYPE_UNDEFINED)
+      throw std::runtime_error(
+          reportWarmupInputError("input of type " + type->str()));
+    std::vector<int64_t> shape;
+    for (const llvm::json::Value &dim : *dims) {
+      auto dimSize = dim.getAsInteger();
+      if (!dimSize)
+        throw std::runtime_error(reportWarmupInputError("invalid signature"));
+      shape.emplace_back(*dimSize < 0 ? 1 : *dimSize);
+    }
+    OMTensor *tensor = omTensorCreateEmpty(
+        shape.data(), static_cast<int64_t>(shape.size()), dataType);
+    if (!tensor) {
+      errno = ENOMEM;
+      throw std::runtime_error(reportErrnoError());
+    }
+    memset(omTensorGetDataPtr(tensor), 0, omTensorGetBufferSize(tensor));
+    ins.emplace_back(tensor, omTensorDestroy);
+  }
+  return ins;
+}
+
+const std::string ExecutionSession::inputSignature() const {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("signature"));
+  errno = 0; // No errors.
+  return _inputSignatureFunc(_entryPointName.c_str());
+}
+
+const std::string ExecutionSession::outputSignature() const {
+  if (!_entryPointFunc)
+    throw std::runtime_error(reportUndefinedEntryPointIn("signature"));
+  errno = 0; // No errors.
+  return _outputSignatureFunc(_entryPointName.c_str());
+}
+
+std::vector<OMTensorUniquePtr> ExecutionEntryPoint::run(
+    std::vector<OMTensorUniquePtr> ins) const {
+  return runEntryPointFunc(_entryPointName, _entryPointFunc, std::move(ins));
+}
+
+OMTensorList *ExecutionEntryPoint::run(OMTensorList *input) const {
+  return runEntryPointFunc(_entryPointName, _entryPointFunc, input);
+}
+
+std::future<std::vector<OMTensorUniquePtr>> ExecutionEntryPoint::runAsync(
+    std::vector<OMTensorUniquePtr> ins) const {
+  return runEntryPointAsyncFunc(
+      _entryPointName, _entryPointFunc, std::move(ins));
+}
+
+void ExecutionEntryPoint::runAsync(
+    std::vector<OMTensorUniquePtr> ins, runCallbackType callback) const {
+  runEntryPointAsyncFunc(
+      _entryPointName, _entryPointFunc, std::move(ins), std::move(callback));
+}
+
+void ExecutionEntryPoint::runInto(const std::vector<OMTensorUniquePtr> &ins,
+    const std::vector<OMTensorUniquePtr> &outs) const {
+  runEntryPointIntoFunc(_entryPointName, _entryPointIntoFunc, ins, outs);
+}
+
+OMTensorList *ExecutionEntryPoint::runInto(
+    OMTensorList *input, OMTensorList *output) const {
+  return runEntryPointIntoFunc(
+      _entryPointName, _entryPointIntoFunc, input, output);
+}
+
+std::vector<OMTensorUniquePtr> ExecutionEntryPoint::runSplitBatch(
+    const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices) const {
+  return runEntryPointSplitBatchFunc(_entryPointName, _entryPointIntoFunc,
+      _inputSignatureFunc, _outputSignatureFunc, ins, numSlices);
+}
+
+const std::string ExecutionEntryPoint::inputSignature() const {
+  errno = 0; // No errors.
+  return _inputSignatureFunc(_entryPointName.c_str());
+}
+
+const std::string ExecutionEntryPoint::outputSignature() const {
+  errno = 0; // No errors.
+  return _outputSignatureFunc(_entryPointName.c_str());
+}
+
+std::vector<OMTensorUniquePtr> ExecutionEntryPoint::runEntryPointFunc(
+    const std::string &entryPointName, entryPointFuncType entryPointFunc,
+    std::vector<OMTensorUniquePtr> ins) {
   std::vector<OMTensor *> omts;
   for (const auto &inOmt : ins)
     omts.emplace_back(inOmt.get());
   auto *wrappedInput = omTensorListCreate(&omts[0], (int64_t)omts.size());
 
-  auto *wrappedOutput = _entryPointFunc(wrappedInput);
+  InferenceMetrics metrics(entryPointName);
+  auto *wrappedOutput = entryPointFunc(wrappedInput);
+  metrics.report(wrappedOutput);
 
   // We created a wrapper for the input list, but the input list does not really
   // own the tensor in the list, as they are coming as OMTensorUniquePtr. So we
@@ -94,7 +553,7 @@ std::vector<OMTensorUniquePtr> ExecutionSession::run(
   omTensorListDestroyShallow(wrappedInput);
 
   if (!wrappedOutput)
-    throw std::runtime_error(reportErrnoError());
+    throw std::runtime_error(ExecutionSession::reportErrnoError());
   std::vector<OMTensorUniquePtr> outs;
 
   for (int64_t i = 0; i < omTensorListGetSize(wrappedOutput); i++) {
@@ -111,17 +570,12 @@ std::vector<OMTensorUniquePtr> ExecutionSession::run(
   return outs;
 }
 
-// Run using public interface. Explicit calls are needed to free tensor & tensor
-// lists.
-OMTensorList *ExecutionSession::run(OMTensorList *input) {
-  if (!_entryPointFunc) {
-    std::stringstream errStr;
-    errStr << "Must set the entry point before calling run function"
-           << std::endl;
-    errno = EINVAL;
-    throw std::runtime_error(errStr.str());
-  }
-  OMTensorList *output = _entryPointFunc(input);
+OMTensorList *ExecutionEntryPoint::runEntryPointFunc(
+    const std::string &entryPointName, entryPointFuncType entryPointFunc,
+    OMTensorList *input) {
+  InferenceMetrics metrics(entryPointName);
+  OMTensorList *output = entryPointFunc(input);
+  metrics.report(output);
   if (!output) {
     std::stringstream errStr;
     std::string errMessageStr = std::string(strerror(errno));
@@ -133,23 +587,251 @@ OMTensorList *ExecutionSession::run(OMTensorList *input) {
   return output;
 }
 
-const std::string ExecutionSession::inputSignature() const {
-  if (!_entryPointFunc)
-    throw std::runtime_error(reportUndefinedEntryPointIn("signature"));
+std::future<std::vector<OMTensorUniquePtr>>
+ExecutionEntryPoint::runEntryPointAsyncFunc(const std::string &entryPointName,
+    entryPointFuncType entryPointFunc, std::vector<OMTensorUniquePtr> ins) {
+  auto promise =
+      std::make_shared<std::promise<std::vector<OMTensorUniquePtr>>>();
+  std::future<std::vector<OMTensorUniquePtr>> future = promise->get_future();
+  runEntryPointAsyncFunc(entryPointName, entryPointFunc, std::move(ins),
+      [promise](std::vector<OMTensorUniquePtr> outs, std::exception_ptr error) {
+        if (error)
+          promise->set_exception(error);
+        else
+          promise->set_value(std::move(outs));
+      });
+  return future;
+}
+
+void ExecutionEntryPoint::runEntryPointAsyncFunc(
+    const std::string &entryPointName, entryPointFuncType entryPointFunc,
+    std::vector<OMTensorUniquePtr> ins, runCallbackType callback) {
+  struct Request {
+    std::string entryPointName;
+    entryPointFuncType entryPointFunc;
+    std::vector<OMTensorUniquePtr> ins;
+    runCallbackType callback;
+  };
+  auto request = std::make_unique<Request>(Request{
+      entryPointName, entryPointFunc, std::move(ins), std::move(callback)});
+  OMTaskFunc runRequest = [](void *context) {
+    std::unique_ptr<Request> request(static_cast<Request *>(context));
+    std::vector<OMTensorUniquePtr> outs;
+    std::exception_ptr error;
+    try {
+      outs = runEntryPointFunc(request->entryPointName,
+          request->entryPointFunc, std::move(request->ins));
+    } catch (const std::runtime_error &) {
+      error = std::current_exception();
+    }
+    request->callback(std::move(outs), error);
+  };
+  if (omThreadPoolSubmit(nullptr, runRequest, request.get()) != 0)
+    throw std::runtime_error(ExecutionSession::reportErrnoError());
+  // The request is now owned by the task.
+  request.release();
+}
+
+void ExecutionEntryPoint::runEntryPointIntoFunc(
+    const std::string &entryPointName,
+    entryPointIntoFuncType entryPointIntoFunc,
+    const std::vector<OMTensorUniquePtr> &ins,
+    const std::vector<OMTensorUniquePtr> &outs) {
+  if (!entryPointIntoFunc)
+    throw std::runtime_error(
+        ExecutionSession::reportMissingEntryPointInto(entryPointName));
+  std::vector<OMTensor *> inOmts, outOmts;
+  for (const auto &inOmt : ins)
+    inOmts.emplace_back(inOmt.get());
+  for (const auto &outOmt : outs)
+    outOmts.emplace_back(outOmt.get());
+  auto *wrappedInput = omTensorListCreate(inOmts.data(), (int64_t)ins.size());
+  auto *wrappedOutput =
+      omTensorListCreate(outOmts.data(), (int64_t)outs.size());
+
+  InferenceMetrics metrics(entryPointName);
+  OMTensorList *result = entryPointIntoFunc(wrappedInput, wrappedOutput);
+  metrics.report(result, /*countOutputs=*/false);
+
+  // The lists do not own the tensors, which are coming as OMTensorUniquePtr.
+  // So we simply deallocate the list structures without touching the
+  // OMTensors.
+  omTensorListDestroyShallow(wrappedInput);
+  omTensorListDestroyShallow(wrappedOutput);
+
+  if (!result)
+    throw std::runtime_error(ExecutionSession::reportErrnoError());
   errno = 0; // No errors.
-  return _inputSignatureFunc(_entryPointName.c_str());
 }
 
-const std::string ExecutionSession::outputSignature() const {
-  if (!_entryPointFunc)
-    throw std::runtime_error(reportUndefinedEntryPointIn("signature"));
+OMTensorList *ExecutionEntryPoint::runEntryPointIntoFunc(
+    const std::string &entryPointName,
+    entryPointIntoFuncType entryPointIntoFunc, OMTensorList *input,
+    OMTensorList *output) {
+  if (!entryPointIntoFunc)
+    throw std::runtime_error(
+        ExecutionSession::reportMissingEntryPointInto(entryPointName));
+  InferenceMetrics metrics(entryPointName);
+  OMTensorList *wrappedOutput = entryPointIntoFunc(input, output);
+  metrics.report(wrappedOutput, /*countOutputs=*/false);
+  if (!wrappedOutput)
+    throw std::runtime_error(ExecutionSession::reportErrnoError());
   errno = 0; // No errors.
-  return _outputSignatureFunc(_entryPointName.c_str());
+  return wrappedOutput;
+}
+
+std::vector<OMTensorUniquePtr> ExecutionEntryPoint::runEntryPointSplitBatchFunc(
+    const std::string &entryPointName,
+    entryPointIntoFuncType entryPointIntoFunc,
+    signatureFuncType inputSignatureFunc, signatureFuncType outputSignatureFunc,
+    const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices) {
+  if (!entryPointIntoFunc)
+    throw std::runtime_error(
+        ExecutionSession::reportMissingEntryPointInto(entryPointName));
+  if (ins.empty() || omTensorGetRank(ins[0].get()) == 0)
+    throw std::runtime_error(
+        ExecutionSession::reportSplitBatchError("no batched input"));
+  int64_t batchSize = omTensorGetShape(ins[0].get())[0];
+  for (const auto &inOmt : ins)
+    if (omTensorGetRank(inOmt.get()) == 0 ||
+        omTensorGetShape(inOmt.get())[0] != batchSize)
+      throw std::runtime_error(ExecutionSession::reportSplitBatchError(
+          "inputs of different batch sizes"));
+  if (numSlices <= 0) {
+    OMThreadPool *pool = omThreadPoolGetDefault();
+    numSlices = pool ? omThreadPoolGetNumThreads(pool) + 1 : 1;
+  }
+  numSlices = std::max<int64_t>(std::min(numSlices, batchSize), 1);
+
+  auto parseSignature = [&](signatureFuncType signatureFunc) {
+    llvm::Expected<llvm::json::Value> signature =
+        llvm::json::parse(signatureFunc(entryPointName.c_str()));
+    if (!signature) {
+      llvm::consumeError(signature.takeError());
+      throw std::runtime_error(
+          ExecutionSession::reportSplitBatchError("invalid signature"));
+    }
+    if (!signature->getAsArray())
+      throw std::runtime_error(
+          ExecutionSession::reportSplitBatchError("invalid signature"));
+    return std::move(*signature);
+  };
+
+  // A model compiled for a static batch only runs on the whole batch, a slice
+  // of fewer rows being read or written out of its bounds.
+  llvm::json::Value inSignature = parseSignature(inputSignatureFunc);
+  if (numSlices > 1)
+    for (const llvm::json::Value &input : *inSignature.getAsArray()) {
+      const llvm::json::Object *object = input.getAsObject();
+      const llvm::json::Array *dims =
+          object ? object->getArray("dims") : nullptr;
+      auto dimSize =
+          dims && !dims->empty() ? (*dims)[0].getAsInteger() : std::nullopt;
+      if (!dimSize || *dimSize >= 0)
+        throw std::runtime_error(ExecutionSession::reportSplitBatchError(
+            "input of static batch dimension"));
+    }
+
+  // Allocate the outputs from the signature.
+  llvm::json::Value outSignature = parseSignature(outputSignatureFunc);
+  const llvm::json::Array *outputs = outSignature.getAsArray();
+  std::vector<OMTensorUniquePtr> outs;
+  for (const llvm::json::Value &output : *outputs) {
+    const llvm::json::Object *object = output.getAsObject();
+    auto type = object ? object->getString("type") : std::nullopt;
+    const llvm::json::Array *dims = object ? object->getArray("dims") : nullptr;
+    OM_DATA_TYPE dataType =
+        type ? getSignatureDataType(*type) : ONNX_TYPE_UNDEFINED;
+    if (dataType == ONNX_TYPE_UNDEFINED || !dims || dims->empty())
+      throw std::runtime_error(ExecutionSession::reportSplitBatchError(
+          "output not a batched tensor of numbers"));
+    std::vector<int64_t> shape;
+    for (const llvm::json::Value &dim : *dims) {
+      auto dimSize = dim.getAsInteger();
+      bool isBatch = shape.empty();
+      if (!dimSize || (*dimSize < 0 && !isBatch))
+        throw std::runtime_error(ExecutionSession::reportSplitBatchError(
+            "output of dynamic shape beyond the batch"));
+      if (*dimSize >= 0 && isBatch && (*dimSize != batchSize || numSlices > 1))
+        throw std::runtime_error(ExecutionSession::reportSplitBatchError(
+            "output of static batch dimension"));
+      shape.emplace_back(isBatch ? batchSize : *dimSize);
+    }
+    OMTensor *tensor = omTensorCreateEmpty(
+        shape.data(), static_cast<int64_t>(shape.size()), dataType);
+    if (!tensor) {
+      errno = ENOMEM;
+      throw std::runtime_error(ExecutionSession::reportErrnoError());
+    }
+    outs.emplace_back(tensor, omTensorDestroy);
+  }
+
+  // Slice the batch into rows of the inputs and outputs, viewed with their
+  // strides and without owning their data.
+  auto sliceRows = [](const OMTensor *tensor, int64_t begin, int64_t end) {
+    int64_t rank = omTensorGetRank(tensor);
+    int64_t *strides = omTensorGetStrides(tensor);
+    OM_DATA_TYPE dataType = omTensorGetDataType(tensor);
+    std::vector<int64_t> shape(
+        omTensorGetShape(tensor), omTensorGetShape(tensor) + rank);
+    shape[0] = end - begin;
+    char *data = static_cast<char *>(omTensorGetDataPtr(tensor)) +
+                 begin * strides[0] * getDataTypeSize(dataType);
+    OMTensor *view = omTensorCreateWithOwnership(
+        data, shape.data(), rank, dataType, /*owning=*/false);
+    if (!view) {
+      errno = ENOMEM;
+      throw std::runtime_error(ExecutionSession::reportErrnoError());
+    }
+    omTensorSetStrides(view, strides);
+    return OMTensorUniquePtr(view, omTensorDestroy);
+  };
+  struct Slice {
+    std::vector<OMTensorUniquePtr> ins, outs;
+    std::exception_ptr error;
+  };
+  std::vector<Slice> slices(numSlices);
+  for (int64_t k = 0; k < numSlices; ++k) {
+    int64_t begin = k * batchSize / numSlices;
+    int64_t end = (k + 1) * batchSize / numSlices;
+    for (const auto &inOmt : ins)
+      slices[k].ins.emplace_back(sliceRows(inOmt.get(), begin, end));
+    for (const auto &outOmt : outs)
+      slices[k].outs.emplace_back(sliceRows(outOmt.get(), begin, end));
+  }
+
+  struct Request {
+    const std::string &entryPointName;
+    entryPointIntoFuncType entryPointIntoFunc;
+    std::vector<Slice> &slices;
+  } request = {entryPointName, entryPointIntoFunc, slices};
+  OMParallelForBody runSlices = [](void *context, int64_t begin, int64_t end) {
+    auto *request = static_cast<Request *>(context);
+    for (int64_t k = begin; k < end; ++k) {
+      Slice &slice = request->slices[k];
+      try {
+        runEntryPointIntoFunc(request->entryPointName,
+            request->entryPointIntoFunc, slice.ins, slice.outs);
+      } catch (const std::runtime_error &) {
+        slice.error = std::current_exception();
+      }
+    }
+  };
+  omParallelFor(runSlices, &request, numSlices);
+  for (Slice &slice : slices)
+    if (slice.error)
+      std::rethrow_exception(slice.error);
+  errno = 0; // No errors.
+  return outs;
 }
 
 ExecutionSession::~ExecutionSession() {
   if (_sharedLibraryHandle.isValid())
     llvm::sys::DynamicLibrary::closeLibrary(_sharedLibraryHandle);
+#if defined(__linux__)
+  if (_sharedLibraryFd >= 0)
+    close(_sharedLibraryFd);
+#endif
 }
 
 std::string ExecutionSession::reportLibraryOpeningError(
@@ -177,7 +859,35 @@ std::string ExecutionSession::reportUndefinedEntryPointIn(
   return errStr.str();
 }
 
-std::string ExecutionSession::reportErrnoError() const {
+std::string ExecutionSession::reportMissingEntryPointInto(
+    const std::string &entryPointName) {
+  errno = EFAULT; // Bad Address.
+  std::stringstream errStr;
+  errStr << "Cannot load symbol: '" << entryPointName << _entryPointIntoSuffix
+         << "'. Recompile the model to write into preallocated outputs."
+         << std::endl;
+  return errStr.str();
+}
+
+std::string ExecutionSession::reportWarmupInputError(
+    const std::string &description) {
+  errno = EINVAL; // Invalid argument.
+  std::stringstream errStr;
+  errStr << "Cannot synthesize the warm-up inputs: " << description << "."
+         << std::endl;
+  return errStr.str();
+}
+
+std::string ExecutionSession::reportSplitBatchError(
+    const std::string &description) {
+  errno = EINVAL; // Invalid argument.
+  std::stringstream errStr;
+  errStr << "Cannot split the batch across threads: " << description << "."
+         << std::endl;
+  return errStr.str();
+}
+
+std::string ExecutionSession::reportErrnoError() {
   std::string errMessageStr = std::string(strerror(errno));
   std::stringstream errStr;
   errStr << "Runtime error during inference returning with ERRNO code '"
@@ -4,7 +4,7 @@
 
 //===--------- ExecutionSession.hpp - ExecutionSession Declaration --------===//
 //
-// Copyright 2019-2020 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -16,18 +16,130 @@
 #pragma once
 
 #include <cassert>
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "OnnxMlirRuntime.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/MemoryBufferRef.h"
 
 namespace onnx_mlir {
 
 using entryPointFuncType = OMTensorList *(*)(OMTensorList *);
+using entryPointIntoFuncType = OMTensorList *(*)(
+    OMTensorList *, OMTensorList *);
 using queryEntryPointsFuncType = const char **(*)(int64_t *);
 using signatureFuncType = const char *(*)(const char *);
 using OMTensorUniquePtr = std::unique_ptr<OMTensor, decltype(&omTensorDestroy)>;
+// Called with the outputs of an inference run asynchronously, or with the
+// std::runtime_error it failed with.
+using runCallbackType = std::function<void(
+    std::vector<OMTensorUniquePtr> outs, std::exception_ptr error)>;
+
+/* ExecutionEntryPoint
+ * Immutable handle to an entry point resolved by an ExecutionSession.
+ *
+ * The compiled models and their runtime keep no mutable process-global state,
+ * so a single handle can run inferences from any number of threads at once.
+ * Threads thus share one loaded copy of the model library, including its
+ * constants, instead of loading their own. A handle must not outlive the
+ * session that created it. Errors are reported as by ExecutionSession.
+ */
+class ExecutionEntryPoint {
+public:
+  const std::string &getName() const { return _entryPointName; }
+
+  // Use custom deleter since forward declared OMTensor hides destructor
+  std::vector<OMTensorUniquePtr> run(std::vector<OMTensorUniquePtr>) const;
+
+  // Run using public interface. Explicit calls are needed to free tensor &
+  // tensor lists.
+  OMTensorList *run(OMTensorList *input) const;
+
+  // Run asynchronously, as by ExecutionSession.
+  std::future<std::vector<OMTensorUniquePtr>> runAsync(
+      std::vector<OMTensorUniquePtr> ins) const;
+  void runAsync(
+      std::vector<OMTensorUniquePtr> ins, runCallbackType callback) const;
+
+  // Run writing the results into the preallocated output tensors, whose data
+  // type, rank and buffer size must match the results. Their shape and strides
+  // are updated.
+  void runInto(const std::vector<OMTensorUniquePtr> &ins,
+      const std::vector<OMTensorUniquePtr> &outs) const;
+  OMTensorList *runInto(OMTensorList *input, OMTensorList *output) const;
+
+  // Run splitting the batch across threads, as by ExecutionSession.
+  std::vector<OMTensorUniquePtr> runSplitBatch(
+      const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices = 0) const;
+
+  // Get input and output signature as a Json string.
+  const std::string inputSignature() const;
+  const std::string outputSignature() const;
+
+private:
+  friend class ExecutionSession;
+
+  // Run implementations shared with ExecutionSession.
+  static std::vector<OMTensorUniquePtr> runEntryPointFunc(
+      const std::string &entryPointName, entryPointFuncType entryPointFunc,
+      std::vector<OMTensorUniquePtr> ins);
+  static OMTensorList *runEntryPointFunc(const std::string &entryPointName,
+      entryPointFuncType entryPointFunc, OMTensorList *input);
+  static std::future<std::vector<OMTensorUniquePtr>> runEntryPointAsyncFunc(
+      const std::string &entryPointName, entryPointFuncType entryPointFunc,
+      std::vector<OMTensorUniquePtr> ins);
+  static void runEntryPointAsyncFunc(const std::string &entryPointName,
+      entryPointFuncType entryPointFunc, std::vector<OMTensorUniquePtr> ins,
+      runCallbackType callback);
+  static void runEntryPointIntoFunc(const std::string &entryPointName,
+      entryPointIntoFuncType entryPointIntoFunc,
+      const std::vector<OMTensorUniquePtr> &ins,
+      const std::vector<OMTensorUniquePtr> &outs);
+  static OMTensorList *runEntryPointIntoFunc(const std::string &entryPointName,
+      entryPointIntoFuncType entryPointIntoFunc, OMTensorList *input,
+      OMTensorList *output);
+  static std::vector<OMTensorUniquePtr> runEntryPointSplitBatchFunc(
+      const std::string &entryPointName,
+      entryPointIntoFuncType entryPointIntoFunc,
+      signatureFuncType inputSignatureFunc,
+      signatureFuncType outputSignatureFunc,
+      const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices);
+
+  ExecutionEntryPoint(const std::string &entryPointName,
+      entryPointFuncType entryPointFunc,
+      entryPointIntoFuncType entryPointIntoFunc,
+      signatureFuncType inputSignatureFunc,
+      signatureFuncType outputSignatureFunc)
+      : _entryPointName(entryPointName), _entryPointFunc(entryPointFunc),
+        _entryPointIntoFunc(entryPointIntoFunc),
+        _inputSignatureFunc(inputSignatureFunc),
+        _outputSignatureFunc(outputSignatureFunc) {}
+
+  const std::string _entryPointName;
+  const entryPointFuncType _entryPointFunc;
+  // Null for models compiled without "run into" entry points.
+  const entryPointIntoFuncType _entryPointIntoFunc;
+  const signatureFuncType _inputSignatureFunc;
+  const signatureFuncType _outputSignatureFunc;
+};
+
+// Options of the warm-up of an ExecutionSession, see warmup.
+struct WarmupOptions {
+  // Resolve all the symbols of the library when loading it, rather than at
+  // their first call. Only used when creating the session.
+  bool bindNow = true;
+  // Touch the pages of the library, holding its code and constant globals.
+  bool prefault = true;
+  // Lock the pages of the library into memory instead of touching them.
+  bool lock = false;
+  // Number of inferences run on zero inputs shaped from the input signature.
+  int64_t numRuns = 1;
+};
 
 /* ExecutionSession
  * Class that supports executing compiled models.
@@ -41,6 +153,10 @@ using OMTensorUniquePtr = std::unique_ptr<OMTensor, decltype(&omTensorDestroy)>;
  * function.
  * EPERM when the model executed on a machine without a compatible
  * hardware/specialized accelerator.
+ *
+ * The run and signature functions may be called concurrently from several
+ * threads, as long as no thread changes the entry point at the same time with
+ * setEntryPoint. Use getEntryPoint to get handles that are never modified.
  */
 class ExecutionSession {
 public:
@@ -48,6 +164,19 @@ public:
   // This path must point to the actual file, local directory is not searched.
   ExecutionSession(std::string sharedLibPath, bool defaultEntryPoint = true);
 
+  // Create an execution session and warm it up with the given options, so
+  // that it reaches steady-state latency before serving its first requests.
+  ExecutionSession(std::string sharedLibPath, const WarmupOptions &options,
+      bool defaultEntryPoint = true);
+
+  // Create an execution session using the model given in the shared library
+  // held in memory, e.g. compiled by omCompileFromArrayToBuffer, without any
+  // library file. The library is copied into an anonymous memory file, so the
+  // buffer may be freed once the session is created. Only supported on Linux,
+  // failing with ENOTSUP elsewhere.
+  ExecutionSession(
+      llvm::MemoryBufferRef sharedLib, bool defaultEntryPoint = true);
+
   // Get a NULL-terminated array of entry point names.
   // For example {"run_addition, "run_subtraction", NULL}
   // In order to get the number of entry points, pass an integer pointer to the
@@ -57,8 +186,22 @@ public:
   // Set entry point for this session.
   // Call this before running the session or querying signatures if
   // defaultEntryPoint is false or there are multiple entry points in the model.
+  // Not thread safe: must not be called while other threads use the session.
   void setEntryPoint(const std::string &entryPointName);
 
+  // Resolve an entry point into an immutable handle, independently of the
+  // entry point set for this session.
+  ExecutionEntryPoint getEntryPoint(const std::string &entryPointName);
+
+  // Resolve the entry point computing the fewest outputs among the entry
+  // point set for this session and its variants compiled for subsets of its
+  // outputs with --output-subsets, run_<func>_subset<k>, and for groups of
+  // nodes with --extract-nodes, run_<func>_extract<k>, that computes all the
+  // outputs of the given names. Its outputs are in the order of its output
+  // signature. Fails with EINVAL if no such entry point exists.
+  ExecutionEntryPoint getEntryPointForOutputs(
+      const std::vector<std::string> &outputNames);
+
   llvm::sys::DynamicLibrary &getSharedLibraryHandle() {
     return _sharedLibraryHandle;
   };
@@ -70,6 +213,53 @@ public:
   // tensor lists.
   OMTensorList *run(OMTensorList *input);
 
+  // Run asynchronously in a worker of the default thread pool of the runtime,
+  // see omRunAsync, returning the future of the outputs or calling callback
+  // with them in the worker. Several requests may be in flight at once. The
+  // callback must not throw.
+  std::future<std::vector<OMTensorUniquePtr>> runAsync(
+      std::vector<OMTensorUniquePtr> ins);
+  void runAsync(std::vector<OMTensorUniquePtr> ins, runCallbackType callback);
+
+  // Run writing the results into preallocated output tensors owned by the
+  // caller, so that no output memory is allocated for the caller. The data
+  // type, rank and buffer size of each output tensor must match the
+  // corresponding result; its shape and strides are set to the ones of the
+  // result. The wrapped output is returned by the public interface version.
+  void runInto(const std::vector<OMTensorUniquePtr> &ins,
+      const std::vector<OMTensorUniquePtr> &outs);
+  OMTensorList *runInto(OMTensorList *input, OMTensorList *output);
+
+  // Run splitting the batch, the leading dimension of all the inputs, into
+  // numSlices slices of consecutive rows, or one per thread of the default
+  // thread pool with 0, run concurrently by the threads of the pool bound to
+  // the calling thread, see omParallelFor. The parallel loops of the model
+  // then run sequentially in each slice, which pays off for models made of
+  // many small ops, or a large request to a model of poor intra-op
+  // parallelism. The outputs are allocated up front from the output
+  // signature, whose dimensions but the leading batch one must be static, and
+  // each slice writes its rows of the outputs in place through the "run into"
+  // entry point, without any concat. The model must thus be compiled for a
+  // dynamic batch, namely with a leading dimension of -1 in the input and
+  // output signatures, unless the batch runs as a single slice, and with "run
+  // into" entry points, and no computation of the model may mix the rows of
+  // the batch. Fails with EINVAL on other inputs or signatures.
+  std::vector<OMTensorUniquePtr> runSplitBatch(
+      const std::vector<OMTensorUniquePtr> &ins, int64_t numSlices = 0);
+
+  // Take the first inference costs up front: fault in, or lock into memory,
+  // the pages of the library, and run inferences of the entry point on zero
+  // inputs whose dynamic dimensions are 1. These inferences also map the
+  // constants file of the model, if any, and warm up the caches, the memory
+  // arena and the thread pool. Inputs of the signature that are not tensors
+  // of numbers cannot be synthesized and fail with EINVAL.
+  void warmup(const WarmupOptions &options = WarmupOptions());
+
+  // Fault in the pages of the library, or lock them into memory with lock,
+  // which fails with the errno of mlock, e.g. beyond RLIMIT_MEMLOCK. Only
+  // supported on Linux and silently ignored otherwise.
+  void prefault(bool lock = false);
+
   // Get input and output signature as a Json string. For example for nminst:
   // `[ { "type" : "f32" , "dims" : [1 , 1 , 28 , 28] , "name" : "image" } ]`
   const std::string inputSignature() const;
@@ -78,21 +268,39 @@ public:
   ~ExecutionSession();
 
 protected:
+  void loadLibrary(
+      const std::string &sharedLibPath, bool defaultEntryPoint, bool bindNow);
+  std::vector<OMTensorUniquePtr> createWarmupInputs() const;
+
   // Error reporting processing when throwing runtime errors. Set errno as
   // appropriate.
   std::string reportLibraryOpeningError(const std::string &libraryName) const;
   std::string reportSymbolLoadingError(const std::string &symbolName) const;
   std::string reportUndefinedEntryPointIn(
       const std::string &functionName) const;
-  std::string reportErrnoError() const;
+  static std::string reportMissingEntryPointInto(
+      const std::string &entryPointName);
+  static std::string reportErrnoError();
+  static std::string reportWarmupInputError(const std::string &description);
+  static std::string reportSplitBatchError(const std::string &description);
+
+  friend class ExecutionEntryPoint;
 
 protected:
   // Handler to the shared library file being loaded.
   llvm::sys::DynamicLibrary _sharedLibraryHandle;
 
+  // Anonymous memory file holding the library loaded from memory, or -1. It
+  // stays open with the library so that its path names no other library.
+  int _sharedLibraryFd = -1;
+
   // Entry point function.
   std::string _entryPointName;
   entryPointFuncType _entryPointFunc = nullptr;
+  entryPointIntoFuncType _entryPointIntoFunc = nullptr;
+
+  // Suffix of the "run into" variant of an entry point.
+  static const std::string _entryPointIntoSuffix;
 
   // Query entry point function.
   static const std::string _queryEntryPointsName;
@@ -0,0 +1,352 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------- ExecutionState.cpp - ExecutionState Implementation ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementations of ExecutionState class, which runs
+// compiled binary model libraries step by step, keeping their states between
+// the steps.
+//
+//===----------------------------------------------------------------------===//
+
+#include <errno.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "llvm/Support/JSON.h"
+
+#include "ExecutionState.hpp"
+#include "OMTensorListHelper.hpp"
+
+namespace onnx_mlir {
+
+ExecutionState::ExecutionState(const ExecutionEntryPoint &entryPoint,
+    const std::vector<StateBinding> &bindings)
+    : _entryPoint(entryPoint) {
+  std::vector<std::string> inputNames = getSignatureNames(
+      _entryPoint.inputSignature(), _entryPoint.getName());
+  std::vector<std::string> outputNames = getSignatureNames(
+      _entryPoint.outputSignature(), _entryPoint.getName());
+  _inputStates.assign(inputNames.size(), -1);
+  _outputStates.assign(outputNames.size(), -1);
+
+  // Resolve the names of the bindings, each tensor holding at most one state.
+  auto findTensor = [&](const std::vector<std::string> &names,
+                        std::vector<int64_t> &states, const std::string &name,
+                        const std::string &kind) {
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end() || states[it - names.begin()] != -1) {
+      errno = EINVAL;
+      throw std::runtime_error("Entry point '" + _entryPoint.getName() +
+                               "' has no unbound " + kind + " '" + name +
+                               "'.\n");
+    }
+    states[it - names.begin()] = _stateInputs.size();
+    return it - names.begin();
+  };
+  for (const StateBinding &binding : bindings) {
+    int64_t input =
+        findTensor(inputNames, _inputStates, binding.inputName, "input");
+    int64_t output =
+        findTensor(outputNames, _outputStates, binding.outputName, "output");
+    _stateInputs.emplace_back(input);
+    _stateOutputs.emplace_back(output);
+  }
+  errno = 0; // No errors.
+}
+
+ExecutionState::ExecutionState(const ExecutionEntryPoint &entryPoint,
+    const std::vector<StateBinding> &bindings,
+    const PagedKVCacheOptions &pagedOptions)
+    : ExecutionState(entryPoint, bindings) {
+  if (pagedOptions.numBlocks <= 0 || pagedOptions.blockSize <= 0 ||
+      pagedOptions.batchSize <= 0) {
+    errno = EINVAL;
+    throw std::runtime_error("Paged key/value caches need a positive number "
+                             "of blocks, block size and batch size.\n");
+  }
+  _pagedOptions = pagedOptions;
+
+  // The inputs added by --paged-kv-cache, passed by the ExecutionState.
+  std::vector<std::string> inputNames = getSignatureNames(
+      _entryPoint.inputSignature(), _entryPoint.getName());
+  auto findInput = [&](const std::string &name) {
+    auto it = std::find(inputNames.begin(), inputNames.end(), name);
+    if (it == inputNames.end() || _inputStates[it - inputNames.begin()] != -1) {
+      errno = EINVAL;
+      throw std::runtime_error("Entry point '" + _entryPoint.getName() +
+                               "' has no unbound input '" + name +
+                               "' of paged key/value caches.\n");
+    }
+    return it - inputNames.begin();
+  };
+  _blockTableInput = findInput("kv_block_table");
+  _pastLengthInput = findInput("kv_past_length");
+
+  // The states are the caches, whose static dims must fit the blocks.
+  std::vector<std::vector<int64_t>> inputDims = getSignatureDims(
+      _entryPoint.inputSignature(), _entryPoint.getName());
+  for (int64_t i = 0; i < getNumStates(); ++i)
+    checkPagedCache(i, inputDims[_stateInputs[i]]);
+
+  int64_t tableShape[] = {pagedOptions.batchSize, pagedOptions.numBlocks};
+  int64_t lengthShape[] = {1};
+  _blockTable.reset(omTensorCreateEmpty(tableShape, 2, ONNX_TYPE_INT64));
+  _pastLength.reset(omTensorCreateEmpty(lengthShape, 1, ONNX_TYPE_INT64));
+  if (!_blockTable || !_pastLength) {
+    errno = ENOMEM;
+    throw std::runtime_error("Cannot allocate the block table.\n");
+  }
+  resetBlocks();
+  errno = 0; // No errors.
+}
+
+void ExecutionState::reset(std::vector<OMTensorUniquePtr> states) {
+  if ((int64_t)states.size() != getNumStates()) {
+    std::stringstream errStr;
+    errStr << "Wrong number of states: expect " << getNumStates()
+           << ", but got " << states.size() << "." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+  if (isPaged())
+    for (int64_t i = 0; i < getNumStates(); ++i) {
+      const int64_t *shape = omTensorGetShape(states[i].get());
+      int64_t rank = omTensorGetRank(states[i].get());
+      checkPagedCache(i, std::vector<int64_t>(shape, shape + rank));
+    }
+  _states = std::move(states);
+  if (isPaged())
+    resetBlocks();
+  errno = 0; // No errors.
+}
+
+std::vector<OMTensorUniquePtr> ExecutionState::run(
+    std::vector<OMTensorUniquePtr> ins) {
+  if (isPaged()) {
+    errno = EINVAL;
+    throw std::runtime_error("Steps on paged key/value caches need their "
+                             "number of new tokens.\n");
+  }
+  return runStep(std::move(ins));
+}
+
+std::vector<OMTensorUniquePtr> ExecutionState::run(
+    std::vector<OMTensorUniquePtr> ins, int64_t numTokens) {
+  if (!isPaged()) {
+    errno = EINVAL;
+    throw std::runtime_error("Entry point '" + _entryPoint.getName() +
+                             "' has no paged key/value caches.\n");
+  }
+  if (numTokens < 0) {
+    errno = EINVAL;
+    throw std::runtime_error("Wrong number of new tokens.\n");
+  }
+
+  // Reserve the blocks of the new tokens of each sequence, which all have the
+  // same length.
+  int64_t blockSize = _pagedOptions.blockSize;
+  int64_t numBlocks = _pagedOptions.numBlocks;
+  int64_t batchSize = _pagedOptions.batchSize;
+  int64_t *table =
+      static_cast<int64_t *>(omTensorGetDataPtr(_blockTable.get()));
+  int64_t *pastLength =
+      static_cast<int64_t *>(omTensorGetDataPtr(_pastLength.get()));
+  int64_t past = pastLength[0];
+  int64_t firstBlock = (past + blockSize - 1) / blockSize;
+  int64_t lastBlock = (past + numTokens + blockSize - 1) / blockSize;
+  int64_t numNewBlocks = (lastBlock - firstBlock) * batchSize;
+  if (numNewBlocks > (int64_t)_freeBlocks.size()) {
+    std::stringstream errStr;
+    errStr << "Out of key/value cache blocks: need " << numNewBlocks
+           << ", but " << _freeBlocks.size() << " are free." << std::endl;
+    errno = ENOMEM;
+    throw std::runtime_error(errStr.str());
+  }
+  for (int64_t b = 0; b < batchSize; ++b)
+    for (int64_t m = firstBlock; m < lastBlock; ++m) {
+      table[b * numBlocks + m] = _freeBlocks.back();
+      _freeBlocks.pop_back();
+    }
+
+  std::vector<OMTensorUniquePtr> outs;
+  try {
+    outs = runStep(std::move(ins));
+  } catch (...) {
+    // The blocks are freed back in the reverse order of their reservation.
+    for (int64_t b = batchSize - 1; b >= 0; --b)
+      for (int64_t m = lastBlock - 1; m >= firstBlock; --m)
+        _freeBlocks.emplace_back(table[b * numBlocks + m]);
+    throw;
+  }
+  pastLength[0] = past + numTokens;
+  return outs;
+}
+
+void ExecutionState::resetBlocks() {
+  // Blocks are reserved from the back.
+  _freeBlocks.clear();
+  for (int64_t i = _pagedOptions.numBlocks - 1; i >= 0; --i)
+    _freeBlocks.emplace_back(i);
+  int64_t *table =
+      static_cast<int64_t *>(omTensorGetDataPtr(_blockTable.get()));
+  std::fill(table,
+      table + _pagedOptions.batchSize * _pagedOptions.numBlocks, int64_t(0));
+  static_cast<int64_t *>(omTensorGetDataPtr(_pastLength.get()))[0] = 0;
+}
+
+std::vector<OMTensorUniquePtr> ExecutionState::runStep(
+    std::vector<OMTensorUniquePtr> ins) {
+  if (_states.empty() && getNumStates() > 0) {
+    errno = EINVAL;
+    throw std::runtime_error("States must be reset before the first step.\n");
+  }
+  int64_t numInputs =
+      _inputStates.size() - getNumStates() - (isPaged() ? 2 : 0);
+  if ((int64_t)ins.size() != numInputs) {
+    std::stringstream errStr;
+    errStr << "Wrong number of input tensors: expect " << numInputs
+           << ", but got " << ins.size() << "." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+
+  // The states and the inputs are kept until the run returns, since the
+  // outputs passing them through refer to their data.
+  std::vector<OMTensor *> omts;
+  auto in = ins.begin();
+  for (int64_t i = 0; i < (int64_t)_inputStates.size(); ++i) {
+    int64_t state = _inputStates[i];
+    if (i == _blockTableInput)
+      omts.emplace_back(_blockTable.get());
+    else if (i == _pastLengthInput)
+      omts.emplace_back(_pastLength.get());
+    else
+      omts.emplace_back(state >= 0 ? _states[state].get() : (in++)->get());
+  }
+  OMTensorList *wrappedInput =
+      omTensorListCreate(omts.data(), (int64_t)omts.size());
+  OMTensorList *wrappedOutput = nullptr;
+  try {
+    wrappedOutput = _entryPoint.run(wrappedInput);
+  } catch (...) {
+    omTensorListDestroyShallow(wrappedInput);
+    throw;
+  }
+  omTensorListDestroyShallow(wrappedInput);
+
+  std::vector<OMTensorUniquePtr> outs;
+  for (int64_t i = 0; i < omTensorListGetSize(wrappedOutput); ++i)
+    outs.emplace_back(
+        omTensorListGetOmtByIndex(wrappedOutput, i), omTensorDestroy);
+  omTensorListDestroyShallow(wrappedOutput);
+  if (outs.size() != _outputStates.size()) {
+    errno = EINVAL;
+    throw std::runtime_error("Entry point '" + _entryPoint.getName() +
+                             "' does not match its output signature.\n");
+  }
+
+  // An output passing a state or an input through does not own its data,
+  // which is then transferred to the output before the state or the input is
+  // destroyed. Paged caches are passed through and updated in place. The
+  // block table and the past length are kept.
+  for (OMTensorUniquePtr &out : outs) {
+    if (omTensorGetOwning(out.get()))
+      continue;
+    for (OMTensor *omt : omts)
+      if (omt != _blockTable.get() && omt != _pastLength.get() &&
+          omTensorGetOwning(omt) &&
+          omTensorGetDataPtr(omt) == omTensorGetDataPtr(out.get())) {
+        omTensorSetOwning(omt, false);
+        omTensorSetOwning(out.get(), true);
+        break;
+      }
+  }
+
+  // The outputs bound to states replace them.
+  std::vector<OMTensorUniquePtr> stepOuts;
+  for (size_t i = 0; i < outs.size(); ++i) {
+    int64_t state = _outputStates[i];
+    if (state >= 0)
+      _states[state] = std::move(outs[i]);
+    else
+      stepOuts.emplace_back(std::move(outs[i]));
+  }
+  errno = 0; // No errors.
+  return stepOuts;
+}
+
+void ExecutionState::checkPagedCache(
+    int64_t state, const std::vector<int64_t> &dims) const {
+  int64_t rank = dims.size();
+  auto fits = [](int64_t dim, int64_t size) {
+    return dim == -1 || dim == size;
+  };
+  if (rank < 3 || !fits(dims[0], _pagedOptions.numBlocks) ||
+      !fits(dims[rank - 2], _pagedOptions.blockSize)) {
+    std::stringstream errStr;
+    errStr << "Paged key/value cache " << state << " is not a pool of "
+           << _pagedOptions.numBlocks << " blocks of "
+           << _pagedOptions.blockSize << " tokens [" << _pagedOptions.numBlocks
+           << ", ..., " << _pagedOptions.blockSize << ", D]." << std::endl;
+    errno = EINVAL;
+    throw std::runtime_error(errStr.str());
+  }
+}
+
+std::vector<std::vector<int64_t>> ExecutionState::getSignatureDims(
+    const std::string &signature, const std::string &entryPointName) {
+  llvm::Expected<llvm::json::Value> jsonSig = llvm::json::parse(signature);
+  const llvm::json::Array *jsonTensors = nullptr;
+  if (jsonSig)
+    jsonTensors = jsonSig->getAsArray();
+  else
+    llvm::consumeError(jsonSig.takeError());
+  if (!jsonTensors) {
+    errno = EINVAL;
+    throw std::runtime_error(
+        "Cannot parse signatures of '" + entryPointName + "'.\n");
+  }
+  std::vector<std::vector<int64_t>> tensorDims;
+  for (const llvm::json::Value &jsonTensor : *jsonTensors) {
+    const llvm::json::Object *object = jsonTensor.getAsObject();
+    const llvm::json::Array *jsonDims =
+        object ? object->getArray("dims") : nullptr;
+    std::vector<int64_t> dims;
+    if (jsonDims)
+      for (const llvm::json::Value &jsonDim : *jsonDims)
+        dims.emplace_back(jsonDim.getAsInteger().value_or(-1));
+    tensorDims.emplace_back(dims);
+  }
+  return tensorDims;
+}
+
+std::vector<std::string> ExecutionState::getSignatureNames(
+    const std::string &signature, const std::string &entryPointName) {
+  llvm::Expected<llvm::json::Value> jsonSig = llvm::json::parse(signature);
+  const llvm::json::Array *jsonTensors = nullptr;
+  if (jsonSig)
+    jsonTensors = jsonSig->getAsArray();
+  else
+    llvm::consumeError(jsonSig.takeError());
+  if (!jsonTensors) {
+    errno = EINVAL;
+    throw std::runtime_error(
+        "Cannot parse signatures of '" + entryPointName + "'.\n");
+  }
+  std::vector<std::string> names;
+  for (const llvm::json::Value &jsonTensor : *jsonTensors) {
+    const llvm::json::Object *object = jsonTensor.getAsObject();
+    auto name = object ? object->getString("name") : std::nullopt;
+    names.emplace_back(name ? name->str() : "");
+  }
+  return names;
+}
+
+} // namespace onnx_mlir
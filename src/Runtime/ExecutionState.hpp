@@ -0,0 +1,145 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------- ExecutionState.hpp - ExecutionState Declaration ------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains declarations of ExecutionState class, which runs
+// compiled binary model libraries step by step, keeping their states between
+// the steps.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ExecutionSession.hpp"
+
+namespace onnx_mlir {
+
+// Input and output of an entry point holding a state, named as in their
+// signatures, e.g. the hidden state of an LSTM or a key/value cache.
+struct StateBinding {
+  std::string inputName;
+  std::string outputName;
+};
+
+// Paged key/value caches of an entry point compiled with --paged-kv-cache,
+// whose blocks are reserved by the ExecutionState.
+struct PagedKVCacheOptions {
+  // Number of blocks of each cache, shared by the sequences of the batch.
+  int64_t numBlocks = 0;
+  // Number of tokens of a block, the second to last dim of the caches.
+  int64_t blockSize = 16;
+  // Number of sequences decoded at once, the batch dim of the steps.
+  int64_t batchSize = 1;
+};
+
+/* ExecutionState
+ * Class that runs an entry point of a model step by step, e.g. per audio chunk
+ * of a streaming recognizer or per token of a decoder, keeping the states of
+ * the model between the steps.
+ *
+ * The states are bound pairs of an input and an output of the entry point.
+ * They are owned by the ExecutionState and never cross its API: each step
+ * passes the current states to the entry point together with the inputs of
+ * the step, and the outputs bound to the states become the states of the next
+ * step, without copies. An output passing a state or an input through is
+ * given the ownership of its data.
+ *
+ * A key/value cache grown by a Concat in the model is reallocated and copied
+ * by each step, unless the model is compiled with --paged-kv-cache and the
+ * ExecutionState is created with PagedKVCacheOptions. The caches are then the
+ * states bound to the past and present keys and values, set by reset to pools
+ * of numBlocks blocks [numBlocks, H..., blockSize, D] and updated in place,
+ * all the states of the entry point being such caches.
+ * The ExecutionState passes the inputs kv_block_table and kv_past_length of
+ * the entry point: each step reserves free blocks for its new tokens, so that
+ * the step only writes them instead of copying the caches, and reset frees
+ * all the blocks.
+ *
+ * Steps must not run concurrently on the same ExecutionState, which holds a
+ * single stream, but several ExecutionStates may run steps of the same entry
+ * point at once. Errors are reported as by ExecutionSession, by throwing
+ * std::runtime_error and setting errno. The states are unchanged by a step
+ * that fails.
+ */
+class ExecutionState {
+public:
+  // Create the states of the given entry point, whose session must outlive
+  // them. They must be set by reset before the first step.
+  ExecutionState(const ExecutionEntryPoint &entryPoint,
+      const std::vector<StateBinding> &bindings);
+  // Create the states of an entry point with paged key/value caches.
+  ExecutionState(const ExecutionEntryPoint &entryPoint,
+      const std::vector<StateBinding> &bindings,
+      const PagedKVCacheOptions &pagedOptions);
+  ExecutionState(const ExecutionState &) = delete;
+  ExecutionState &operator=(const ExecutionState &) = delete;
+
+  // Set the states, in the order of the bindings, e.g. to zeros or to the
+  // cache of a prompt, and take their ownership. The paged caches are empty
+  // after a reset, their prompt being run as a first step, and fail with
+  // EINVAL if they are not pools of numBlocks blocks of blockSize tokens.
+  void reset(std::vector<OMTensorUniquePtr> states);
+
+  // Run a step on the inputs not bound to states, in the order of the input
+  // signature, and return the outputs not bound to states, in the order of
+  // the output signature.
+  std::vector<OMTensorUniquePtr> run(std::vector<OMTensorUniquePtr> ins);
+
+  // Run a step of numTokens new tokens per sequence on paged key/value caches,
+  // reserving their blocks. Fail with ENOMEM if there are not enough free
+  // blocks.
+  std::vector<OMTensorUniquePtr> run(
+      std::vector<OMTensorUniquePtr> ins, int64_t numTokens);
+
+  int64_t getNumStates() const { return _stateInputs.size(); }
+
+  // Get a state, owned by the ExecutionState until the next step or reset.
+  const OMTensor *getState(int64_t index) const {
+    return _states[index].get();
+  }
+
+private:
+  // Return the names of the tensors of a signature.
+  static std::vector<std::string> getSignatureNames(
+      const std::string &signature, const std::string &entryPointName);
+  // Return the dims of the tensors of a signature, -1 if dynamic.
+  static std::vector<std::vector<int64_t>> getSignatureDims(
+      const std::string &signature, const std::string &entryPointName);
+  // Check that the dims of a state are the ones of a paged cache, a dynamic
+  // dim -1 matching any size.
+  void checkPagedCache(int64_t state, const std::vector<int64_t> &dims) const;
+  // Run a step with the current states.
+  std::vector<OMTensorUniquePtr> runStep(std::vector<OMTensorUniquePtr> ins);
+  // Free all the blocks of the paged caches.
+  void resetBlocks();
+  bool isPaged() const { return _blockTableInput >= 0; }
+
+  const ExecutionEntryPoint _entryPoint;
+  // Input and output index of each state.
+  std::vector<int64_t> _stateInputs;
+  std::vector<int64_t> _stateOutputs;
+  // State index of each input and output, or -1 if it is not bound.
+  std::vector<int64_t> _inputStates;
+  std::vector<int64_t> _outputStates;
+  // Current states, empty until reset.
+  std::vector<OMTensorUniquePtr> _states;
+  // Paged caches: the input index of the block table and of the past length,
+  // or -1 if there are none, the free blocks, the table [batchSize, numBlocks]
+  // of the blocks of each sequence and the number of past tokens.
+  PagedKVCacheOptions _pagedOptions;
+  int64_t _blockTableInput = -1;
+  int64_t _pastLengthInput = -1;
+  std::vector<int64_t> _freeBlocks;
+  OMTensorUniquePtr _blockTable{nullptr, omTensorDestroy};
+  OMTensorUniquePtr _pastLength{nullptr, omTensorDestroy};
+};
+} // namespace onnx_mlir
@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------------- OMBLAS.c - OMBLAS C Implementation ------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementation of the OMBLAS functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OMBLAS.inc"
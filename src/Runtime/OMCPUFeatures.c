@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------- OMCPUFeatures.c - OMCPUFeatures C Implementation ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementation of the OMCPUFeatures functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OMCPUFeatures.inc"
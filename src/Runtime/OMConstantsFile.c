@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------- OMConstantsFile.c - OMConstantsFile C Implementation --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains implementation of the OMConstantsFile functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OMConstantsFile.inc"
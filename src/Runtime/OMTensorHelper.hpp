@@ -85,7 +85,8 @@ OMTensor *omTensorCreateWithShape(const std::vector<int64_t> &dataSizes);
  * omDefineSeed.
  * When called, the random number generator for omTensorCreateWithRandomData
  * will be seeded exactly once. The seed is randomly generated when ignoreSeed
- * is nonnull; otherwise the input seedValue is used.
+ * is nonnull; otherwise the input seedValue is used. The generator is thread
+ * local, so the seed only applies to the calling thread.
  *
  * @param seed input seed.
  * @param hasSeedValue when nonzero, this function uses the provided seed.
@@ -4,7 +4,7 @@
 
 //===----- PyExecutionSession.cpp - PyExecutionSession Implementation -----===//
 //
-// Copyright 2019-2020 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -21,152 +21,467 @@ SUPPRESS_WARNINGS_POP
 
 #include "PyExecutionSession.hpp"
 
+#include "OMTensorListHelper.hpp"
+#include "onnx-mlir/Runtime/OMDLPack.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
 namespace onnx_mlir {
 
 PyExecutionSession::PyExecutionSession(
     std::string sharedLibPath, bool defaultEntryPoint)
     : onnx_mlir::ExecutionSession(sharedLibPath, defaultEntryPoint) {}
 
-std::vector<py::array> PyExecutionSession::pyRun(
-    const std::vector<py::array> &inputsPyArray) {
-  assert(_entryPointFunc && "Entry point not loaded.");
+namespace {
 
-  std::vector<OMTensor *> omts;
-  for (auto inputPyArray : inputsPyArray) {
-    assert(inputPyArray.flags() && py::array::c_style &&
-           "Expect contiguous python array.");
+// Return the ONNX data type of the elements of a NumPy array.
+OM_DATA_TYPE getOMDataType(const py::array &pyArray) {
+  // Borrowed from:
+  // https://github.com/pybind/pybind11/issues/563#issuecomment-267835542
+  if (py::isinstance<py::array_t<float>>(pyArray))
+    return ONNX_TYPE_FLOAT;
+  if (py::isinstance<py::array_t<std::uint8_t>>(pyArray))
+    return ONNX_TYPE_UINT8;
+  if (py::isinstance<py::array_t<std::int8_t>>(pyArray))
+    return ONNX_TYPE_INT8;
+  if (py::isinstance<py::array_t<std::uint16_t>>(pyArray))
+    return ONNX_TYPE_UINT16;
+  if (py::isinstance<py::array_t<std::int16_t>>(pyArray))
+    return ONNX_TYPE_INT16;
+  if (py::isinstance<py::array_t<std::int32_t>>(pyArray))
+    return ONNX_TYPE_INT32;
+  if (py::isinstance<py::array_t<std::int64_t>>(pyArray))
+    return ONNX_TYPE_INT64;
+  // string type missing
+  if (py::isinstance<py::array_t<bool>>(pyArray))
+    return ONNX_TYPE_BOOL;
+  // Missing fp16 support.
+  if (py::isinstance<py::array_t<double>>(pyArray))
+    return ONNX_TYPE_DOUBLE;
+  if (py::isinstance<py::array_t<std::uint32_t>>(pyArray))
+    return ONNX_TYPE_UINT32;
+  if (py::isinstance<py::array_t<std::uint64_t>>(pyArray))
+    return ONNX_TYPE_UINT64;
+  if (py::isinstance<py::array_t<std::complex<float>>>(pyArray))
+    return ONNX_TYPE_COMPLEX64;
+  if (py::isinstance<py::array_t<std::complex<double>>>(pyArray))
+    return ONNX_TYPE_COMPLEX128;
+  // Missing bfloat16 support
+  std::cerr << "Numpy type not supported: " << pyArray.dtype() << ".\n";
+  exit(1);
+}
 
-    void *dataPtr;
-    int64_t ownData = 0;
-    if (inputPyArray.writeable()) {
-      dataPtr = inputPyArray.mutable_data();
-    } else {
-      // If data is not writable, copy them to a writable buffer.
-      auto *copiedData = (float *)malloc(inputPyArray.nbytes());
-      memcpy(copiedData, inputPyArray.data(), inputPyArray.nbytes());
-      dataPtr = copiedData;
-      // We want OMTensor to free up the memory space upon destruction.
-      ownData = 1;
+// Return the NumPy data type of the elements of an OMTensor.
+py::dtype getPyDtype(OMTensor *omt) {
+  // https://numpy.org/devdocs/user/basics.types.html
+  switch (omTensorGetDataType(omt)) {
+  case (OM_DATA_TYPE)onnx::TensorProto::FLOAT:
+    return py::dtype("float32");
+  case (OM_DATA_TYPE)onnx::TensorProto::UINT8:
+    return py::dtype("uint8");
+  case (OM_DATA_TYPE)onnx::TensorProto::INT8:
+    return py::dtype("int8");
+  case (OM_DATA_TYPE)onnx::TensorProto::UINT16:
+    return py::dtype("uint16");
+  case (OM_DATA_TYPE)onnx::TensorProto::INT16:
+    return py::dtype("int16");
+  case (OM_DATA_TYPE)onnx::TensorProto::INT32:
+    return py::dtype("int32");
+  case (OM_DATA_TYPE)onnx::TensorProto::INT64:
+    return py::dtype("int64");
+  case (OM_DATA_TYPE)onnx::TensorProto::STRING:
+    return py::dtype("str");
+  case (OM_DATA_TYPE)onnx::TensorProto::BOOL:
+    return py::dtype("bool_");
+  case (OM_DATA_TYPE)onnx::TensorProto::FLOAT16:
+    return py::dtype("float16");
+  case (OM_DATA_TYPE)onnx::TensorProto::DOUBLE:
+    return py::dtype("float64");
+  case (OM_DATA_TYPE)onnx::TensorProto::UINT32:
+    return py::dtype("uint32");
+  case (OM_DATA_TYPE)onnx::TensorProto::UINT64:
+    return py::dtype("uint64");
+  case (OM_DATA_TYPE)onnx::TensorProto::COMPLEX64:
+    return py::dtype("csingle");
+  case (OM_DATA_TYPE)onnx::TensorProto::COMPLEX128:
+    return py::dtype("cdouble");
+  default:
+    std::cerr << "Unsupported ONNX type in OMTensor: "
+              << omTensorGetDataType(omt) << ".\n";
+    exit(1);
+  }
+}
+
+// Wrap a contiguous NumPy array into an OMTensor without copying its data,
+// which stays owned by the array.
+OMTensor *wrapPyArray(const py::array &pyArray) {
+  // The compiled models never write into their inputs, so the data of
+  // read-only arrays is used in place as well.
+  auto *omt = omTensorCreateWithOwnership(const_cast<void *>(pyArray.data()),
+      (int64_t *)(const_cast<ssize_t *>(pyArray.shape())),
+      (int64_t)pyArray.ndim(), getOMDataType(pyArray), /*owning=*/0);
+  omTensorSetStridesWithPyArrayStrides(
+      omt, (int64_t *)const_cast<ssize_t *>(pyArray.strides()));
+  return omt;
+}
+
+// Wrap NumPy arrays into an OMTensorList without copying their data, which
+// stays owned by the arrays.
+OMTensorList *wrapPyArrays(const std::vector<py::array> &pyArrays) {
+  // The list owns the array of its tensors, which outlives this function.
+  auto **omts = (OMTensor **)malloc(
+      std::max<size_t>(pyArrays.size(), 1) * sizeof(OMTensor *));
+  if (!omts)
+    throw std::bad_alloc();
+  for (size_t i = 0; i < pyArrays.size(); ++i)
+    omts[i] = wrapPyArray(pyArrays[i]);
+  return omTensorListCreateWithOwnership(
+      omts, (int64_t)pyArrays.size(), /*owning=*/1);
+}
+
+// Return true if the strides of the tensor are the ones of its contiguous
+// row-major layout.
+bool isContiguous(OMTensor *omt) {
+  int64_t stride = 1;
+  for (int64_t i = omTensorGetRank(omt) - 1; i >= 0; --i) {
+    int64_t dim = omTensorGetShape(omt)[i];
+    if (dim != 1 && omTensorGetStrides(omt)[i] != stride)
+      return false;
+    stride *= dim;
+  }
+  return true;
+}
+
+// Inputs of a run wrapped into an OMTensorList without copying their data.
+// Each input is a NumPy array, an object of the DLPack protocol, such as a
+// PyTorch tensor on the CPU, or an object convertible to a NumPy array. The
+// wrapped arrays are kept alive, and the DLPack tensors released, when the
+// inputs are destroyed, with the GIL held. The models reading their inputs
+// as contiguous, the strided inputs are copied into contiguous arrays.
+class WrappedInputs {
+public:
+  explicit WrappedInputs(const std::vector<py::object> &inputs) {
+    try {
+      for (const py::object &input : inputs)
+        _omts.emplace_back(wrap(input));
+      _omtl = omTensorListCreate(_omts.data(), (int64_t)_omts.size());
+    } catch (...) {
+      release();
+      throw;
     }
+  }
+  WrappedInputs(const WrappedInputs &) = delete;
+  WrappedInputs &operator=(const WrappedInputs &) = delete;
+  ~WrappedInputs() { release(); }
+
+  OMTensorList *get() const { return _omtl; }
 
-    // Borrowed from:
-    // https://github.com/pybind/pybind11/issues/563#issuecomment-267835542
-    OM_DATA_TYPE dtype;
-    if (py::isinstance<py::array_t<float>>(inputPyArray))
-      dtype = ONNX_TYPE_FLOAT;
-    else if (py::isinstance<py::array_t<std::uint8_t>>(inputPyArray))
-      dtype = ONNX_TYPE_UINT8;
-    else if (py::isinstance<py::array_t<std::int8_t>>(inputPyArray))
-      dtype = ONNX_TYPE_INT8;
-    else if (py::isinstance<py::array_t<std::uint16_t>>(inputPyArray))
-      dtype = ONNX_TYPE_UINT16;
-    else if (py::isinstance<py::array_t<std::int16_t>>(inputPyArray))
-      dtype = ONNX_TYPE_INT16;
-    else if (py::isinstance<py::array_t<std::int32_t>>(inputPyArray))
-      dtype = ONNX_TYPE_INT32;
-    else if (py::isinstance<py::array_t<std::int64_t>>(inputPyArray))
-      dtype = ONNX_TYPE_INT64;
-    // string type missing
-    else if (py::isinstance<py::array_t<bool>>(inputPyArray))
-      dtype = ONNX_TYPE_BOOL;
-    // Missing fp16 support.
-    else if (py::isinstance<py::array_t<double>>(inputPyArray))
-      dtype = ONNX_TYPE_DOUBLE;
-    else if (py::isinstance<py::array_t<std::uint32_t>>(inputPyArray))
-      dtype = ONNX_TYPE_UINT32;
-    else if (py::isinstance<py::array_t<std::uint64_t>>(inputPyArray))
-      dtype = ONNX_TYPE_UINT64;
-    else if (py::isinstance<py::array_t<std::complex<float>>>(inputPyArray))
-      dtype = ONNX_TYPE_COMPLEX64;
-    else if (py::isinstance<py::array_t<std::complex<double>>>(inputPyArray))
-      dtype = ONNX_TYPE_COMPLEX128;
-    // Missing bfloat16 support
-    else {
-      std::cerr << "Numpy type not supported: " << inputPyArray.dtype()
-                << ".\n";
-      exit(1);
+private:
+  OMTensor *wrap(const py::object &input) {
+    if (!py::isinstance<py::array>(input) && py::hasattr(input, "__dlpack__"))
+      return wrapDLPack(input.attr("__dlpack__")());
+    auto pyArray = py::array::ensure(input, py::array::c_style);
+    if (!pyArray)
+      throw py::error_already_set();
+    char kind = pyArray.dtype().kind();
+    if (kind == 'U' || kind == 'S' || kind == 'O')
+      return wrapStrings(pyArray);
+    _pyArrays.emplace_back(pyArray);
+    return wrapPyArray(pyArray);
+  }
+
+  // Copy the str or bytes elements of an array into a string tensor holding
+  // them contiguously, encoded in UTF-8.
+  OMTensor *wrapStrings(const py::array &pyArray) {
+    std::string bytes;
+    std::vector<int64_t> offsets = {0};
+    for (py::handle item : pyArray.attr("ravel")()) {
+      bytes += py::isinstance<py::bytes>(item)
+                   ? item.cast<std::string>()
+                   : py::str(item).cast<std::string>();
+      offsets.emplace_back(bytes.size());
     }
+    std::vector<int64_t> shape(
+        pyArray.shape(), pyArray.shape() + pyArray.ndim());
+    OMTensor *omt = omTensorCreateStrings(
+        bytes.data(), offsets.data(), shape.data(), (int64_t)shape.size());
+    if (!omt)
+      throw std::bad_alloc();
+    return omt;
+  }
 
-    auto *inputOMTensor = omTensorCreateWithOwnership(dataPtr,
-        (int64_t *)(const_cast<ssize_t *>(inputPyArray.shape())),
-        (int64_t)inputPyArray.ndim(), dtype, ownData);
-    omTensorSetStridesWithPyArrayStrides(inputOMTensor,
-        (int64_t *)const_cast<ssize_t *>(inputPyArray.strides()));
+  // Take the DLPack tensor of a capsule, as its consumer.
+  OMTensor *wrapDLPack(py::object capsule) {
+    auto *dlTensor = static_cast<DLManagedTensor *>(
+        PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+    if (!dlTensor)
+      throw py::error_already_set();
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+    _dlTensors.emplace_back(dlTensor);
+    OMTensor *omt = omTensorFromDLPack(dlTensor);
+    if (!omt)
+      throw std::runtime_error(
+          "DLPack inputs must be on the CPU, of an ONNX data type.\n");
+    if (isContiguous(omt))
+      return omt;
+    // Copy the strided tensor through a NumPy array viewing it.
+    std::vector<ssize_t> shape, strides;
+    ssize_t elementSize = getDataTypeSize(omTensorGetDataType(omt));
+    for (int64_t i = 0; i < omTensorGetRank(omt); ++i) {
+      shape.emplace_back(omTensorGetShape(omt)[i]);
+      strides.emplace_back(omTensorGetStrides(omt)[i] * elementSize);
+    }
+    py::array view(getPyDtype(omt), shape, strides, omTensorGetDataPtr(omt));
+    omTensorDestroy(omt);
+    return wrap(view);
+  }
 
-    omts.emplace_back(inputOMTensor);
+  void release() {
+    if (_omtl)
+      omTensorListDestroy(_omtl);
+    else
+      for (OMTensor *omt : _omts)
+        omTensorDestroy(omt);
+    for (DLManagedTensor *dlTensor : _dlTensors)
+      if (dlTensor->deleter)
+        dlTensor->deleter(dlTensor);
+    _omts.clear();
+    _dlTensors.clear();
+    _omtl = nullptr;
   }
 
-  auto *wrappedInput = omTensorListCreate(&omts[0], omts.size());
-  auto *wrappedOutput = _entryPointFunc(wrappedInput);
-  if (!wrappedOutput)
-    throw std::runtime_error(reportErrnoError());
-  std::vector<py::array> outputPyArrays;
-  for (int64_t i = 0; i < omTensorListGetSize(wrappedOutput); i++) {
-    auto *omt = omTensorListGetOmtByIndex(wrappedOutput, i);
+  std::vector<py::array> _pyArrays;
+  std::vector<DLManagedTensor *> _dlTensors;
+  std::vector<OMTensor *> _omts;
+  OMTensorList *_omtl = nullptr;
+};
+
+// Convert the tensors of an OMTensorList into NumPy arrays, taking the
+// ownership of the list. The arrays take the data of the tensors owning it
+// without copying it, and it is then freed with them. They are DLPack
+// producers, e.g. for torch.from_dlpack to share their data as well.
+std::vector<py::array> toPyArrays(OMTensorList *omtl) {
+  std::vector<py::array> pyArrays;
+  for (int64_t i = 0; i < omTensorListGetSize(omtl); i++) {
+    auto *omt = omTensorListGetOmtByIndex(omtl, i);
     auto shape = std::vector<int64_t>(
         omTensorGetShape(omt), omTensorGetShape(omt) + omTensorGetRank(omt));
+    if (omTensorGetDataType(omt) == (OM_DATA_TYPE)onnx::TensorProto::STRING) {
+      // The strings are copied into an array of str objects.
+      auto **strs = static_cast<const char **>(omTensorGetDataPtr(omt));
+      py::list items;
+      for (int64_t j = 0; j < omTensorGetNumElems(omt); j++)
+        items.append(py::str(strs[j]));
+      py::object pyStrings = py::module_::import("numpy").attr("array")(
+          items, py::dtype("O"));
+      pyArrays.emplace_back(pyStrings.attr("reshape")(shape).cast<py::array>());
+    } else if (omTensorGetOwning(omt)) {
+      py::capsule owner(omt,
+          [](void *owned) { omTensorDestroy(static_cast<OMTensor *>(owned)); });
+      pyArrays.emplace_back(
+          py::array(getPyDtype(omt), shape, omTensorGetDataPtr(omt), owner));
+      continue;
+    } else {
+      // The tensors not owning their data, e.g. constants, are copied.
+      pyArrays.emplace_back(
+          py::array(getPyDtype(omt), shape, omTensorGetDataPtr(omt)));
+    }
+    omTensorDestroy(omt);
+  }
+  omTensorListDestroyShallow(omtl);
+  return pyArrays;
+}
+
+// Inference run asynchronously by pyRunAsync, whose Python objects are only
+// touched with the GIL held.
+struct AsyncRun {
+  py::object loop;
+  py::object future;
+  // Keep the data of the inputs alive until the inference is done.
+  std::unique_ptr<WrappedInputs> wrappedInput;
+};
 
-    // https://numpy.org/devdocs/user/basics.types.html
-    py::dtype dtype;
-    switch (omTensorGetDataType(omt)) {
-    case (OM_DATA_TYPE)onnx::TensorProto::FLOAT:
-      dtype = py::dtype("float32");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::UINT8:
-      dtype = py::dtype("uint8");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::INT8:
-      dtype = py::dtype("int8");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::UINT16:
-      dtype = py::dtype("uint16");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::INT16:
-      dtype = py::dtype("int16");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::INT32:
-      dtype = py::dtype("int32");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::INT64:
-      dtype = py::dtype("int64");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::STRING:
-      dtype = py::dtype("str");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::BOOL:
-      dtype = py::dtype("bool_");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::FLOAT16:
-      dtype = py::dtype("float32");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::DOUBLE:
-      dtype = py::dtype("float64");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::UINT32:
-      dtype = py::dtype("uint32");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::UINT64:
-      dtype = py::dtype("uint64");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::COMPLEX64:
-      dtype = py::dtype("csingle");
-      break;
-    case (OM_DATA_TYPE)onnx::TensorProto::COMPLEX128:
-      dtype = py::dtype("cdouble");
-      break;
-    default:
-      std::cerr << "Unsupported ONNX type in OMTensor: "
-                << omTensorGetDataType(omt) << ".\n";
-      exit(1);
+// Set the result of the future of an inference, in the thread of its event
+// loop, once the inference is done.
+void completeAsyncRun(void *context, OMTensorList *wrappedOutput, int err) {
+  py::gil_scoped_acquire acquire;
+  std::unique_ptr<AsyncRun> run(static_cast<AsyncRun *>(context));
+  run->wrappedInput.reset();
+  try {
+    if (wrappedOutput) {
+      std::vector<py::array> outputPyArrays = toPyArrays(wrappedOutput);
+      run->loop.attr("call_soon_threadsafe")(
+          run->future.attr("set_result"), outputPyArrays);
+    } else {
+      py::object error = py::module_::import("builtins")
+                             .attr("RuntimeError")(strerror(err));
+      run->loop.attr("call_soon_threadsafe")(
+          run->future.attr("set_exception"), error);
     }
+  } catch (py::error_already_set &e) {
+    // The event loop was closed meanwhile, nobody awaits the result.
+    e.discard_as_unraisable(__func__);
+  }
+}
+
+// Inferences of a batch run by pyRunBatch. The callback of each request
+// stores its output and wakes up the caller once all of them are done. They
+// touch no Python object, so they run without the GIL.
+struct BatchRun {
+  std::mutex mutex;
+  std::condition_variable allDone;
+  size_t numPending = 0;
+  std::vector<OMTensorList *> outputs;
+  std::vector<int> errs;
+};
 
-    outputPyArrays.emplace_back(
-        py::array(dtype, shape, omTensorGetDataPtr(omt)));
+struct BatchRequest {
+  BatchRun *batch;
+  size_t index;
+};
+
+void completeBatchRequest(void *context, OMTensorList *wrappedOutput, int err) {
+  auto *request = static_cast<BatchRequest *>(context);
+  BatchRun *batch = request->batch;
+  // Notify with the lock held, the batch being destroyed by the caller as
+  // soon as it sees no pending request.
+  std::lock_guard<std::mutex> lock(batch->mutex);
+  batch->outputs[request->index] = wrappedOutput;
+  batch->errs[request->index] = err;
+  if (--batch->numPending == 0)
+    batch->allDone.notify_one();
+}
+
+} // namespace
+
+std::vector<py::array> PyExecutionSession::pyRun(
+    const std::vector<py::object> &inputs) {
+  assert(_entryPointFunc && "Entry point not loaded.");
+
+  WrappedInputs wrappedInput(inputs);
+  OMTensorList *wrappedOutput;
+  {
+    // Release the GIL while the model runs, so that other Python threads,
+    // e.g. serving other requests, run meanwhile. The inputs are kept alive
+    // by wrappedInput.
+    py::gil_scoped_release release;
+    wrappedOutput = _entryPointFunc(wrappedInput.get());
+  }
+  if (!wrappedOutput)
+    throw std::runtime_error(reportErrnoError());
+  return toPyArrays(wrappedOutput);
+}
+
+py::object PyExecutionSession::pyRunAsync(
+    const std::vector<py::object> &inputs) {
+  assert(_entryPointFunc && "Entry point not loaded.");
+
+  // Raises a RuntimeError when not called from a coroutine.
+  py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+  py::object future = loop.attr("create_future")();
+  auto run = std::make_unique<AsyncRun>(
+      AsyncRun{loop, future, std::make_unique<WrappedInputs>(inputs)});
+  if (omRunAsync(/*pool=*/nullptr, _entryPointFunc, run->wrappedInput->get(),
+          completeAsyncRun, run.get()) != 0)
+    throw std::runtime_error(reportErrnoError());
+  // The run is now owned by the callback.
+  run.release();
+  return future;
+}
+
+std::vector<std::vector<py::array>> PyExecutionSession::pyRunBatch(
+    const std::vector<std::vector<py::object>> &inputs) {
+  assert(_entryPointFunc && "Entry point not loaded.");
+
+  // Wrap the inputs of all the requests at once, with the GIL held.
+  size_t numRequests = inputs.size();
+  std::vector<std::unique_ptr<WrappedInputs>> wrappedInputs;
+  for (const std::vector<py::object> &input : inputs)
+    wrappedInputs.emplace_back(std::make_unique<WrappedInputs>(input));
+
+  BatchRun batch;
+  batch.numPending = numRequests;
+  batch.outputs.assign(numRequests, nullptr);
+  batch.errs.assign(numRequests, 0);
+  std::vector<BatchRequest> requests(numRequests);
+  {
+    // Release the GIL while the requests run concurrently in the runtime
+    // thread pool, each of them running its parallel loops in the pool too.
+    // A request may run in the calling thread when the pool has no worker,
+    // so the lock is not held while submitting them.
+    py::gil_scoped_release release;
+    for (size_t i = 0; i < numRequests; ++i) {
+      requests[i] = BatchRequest{&batch, i};
+      if (omRunAsync(/*pool=*/nullptr, _entryPointFunc,
+              wrappedInputs[i]->get(), completeBatchRequest,
+              &requests[i]) != 0) {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.errs[i] = errno;
+        --batch.numPending;
+      }
+    }
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.allDone.wait(lock, [&] { return batch.numPending == 0; });
+  }
+  wrappedInputs.clear();
+
+  // Convert all the outputs, or report the error of the first failed
+  // request once the outputs of the other ones are freed.
+  auto failed = std::find(batch.outputs.begin(), batch.outputs.end(), nullptr);
+  if (failed != batch.outputs.end()) {
+    for (OMTensorList *wrappedOutput : batch.outputs)
+      if (wrappedOutput)
+        omTensorListDestroy(wrappedOutput);
+    errno = batch.errs[failed - batch.outputs.begin()];
+    throw std::runtime_error(reportErrnoError());
+  }
+  std::vector<std::vector<py::array>> outputs;
+  for (OMTensorList *wrappedOutput : batch.outputs)
+    outputs.emplace_back(toPyArrays(wrappedOutput));
+  return outputs;
+}
+
+void PyExecutionSession::pyRunInto(const std::vector<py::object> &inputs,
+    const std::vector<py::array> &outputsPyArray) {
+  assert(_entryPointFunc && "Entry point not loaded.");
+  for (const py::array &outputPyArray : outputsPyArray)
+    if (!outputPyArray.writeable() ||
+        !(outputPyArray.flags() & py::array::c_style))
+      throw std::runtime_error(
+          "Output arrays must be writeable and contiguous.\n");
+  if (!_entryPointIntoFunc)
+    throw std::runtime_error(reportMissingEntryPointInto(_entryPointName));
+
+  WrappedInputs wrappedInput(inputs);
+  auto *wrappedOutput = wrapPyArrays(outputsPyArray);
+  OMTensorList *result;
+  {
+    // Release the GIL while the model runs, see pyRun.
+    py::gil_scoped_release release;
+    result = _entryPointIntoFunc(wrappedInput.get(), wrappedOutput);
+  }
+
+  // The model sets the shape of the output tensors to the one of the
+  // results, which must be the one of the output arrays since the arrays
+  // cannot be reshaped.
+  bool sameShapes = true;
+  if (result) {
+    for (size_t i = 0; i < outputsPyArray.size(); i++) {
+      auto *omt = omTensorListGetOmtByIndex(wrappedOutput, i);
+      sameShapes &= std::equal(omTensorGetShape(omt),
+          omTensorGetShape(omt) + omTensorGetRank(omt),
+          outputsPyArray[i].shape());
+    }
   }
   omTensorListDestroy(wrappedOutput);
-  omTensorListDestroy(wrappedInput);
 
-  return outputPyArrays;
+  if (!result)
+    throw std::runtime_error(reportErrnoError());
+  if (!sameShapes)
+    throw std::runtime_error(
+        "Output arrays must have the shapes of the results.\n");
 }
 
 void PyExecutionSession::pySetEntryPoint(std::string entryPointName) {
@@ -4,7 +4,7 @@
 
 //===------ PyExecutionSession.hpp - PyExecutionSession Declaration -------===//
 //
-// Copyright 2019-2020 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -30,7 +30,23 @@ public:
   PyExecutionSession(std::string sharedLibPath, bool defaultEntryPoint = true);
   std::vector<std::string> pyQueryEntryPoints();
   void pySetEntryPoint(std::string entryPointName);
-  std::vector<py::array> pyRun(const std::vector<py::array> &inputsPyArray);
+  // Run on inputs that are NumPy arrays, or DLPack producers such as the
+  // PyTorch tensors on the CPU, sharing their data. The outputs are NumPy
+  // arrays taking the data of the results, also DLPack producers.
+  std::vector<py::array> pyRun(const std::vector<py::object> &inputs);
+  // Run asynchronously in the runtime thread pool, returning an asyncio
+  // future of the outputs, set in the running event loop.
+  py::object pyRunAsync(const std::vector<py::object> &inputs);
+  // Run many independent requests at once, concurrently in the runtime
+  // thread pool, returning the outputs of each of them. The inputs are all
+  // converted before, and the outputs after, the GIL being released once
+  // while they run.
+  std::vector<std::vector<py::array>> pyRunBatch(
+      const std::vector<std::vector<py::object>> &inputs);
+  // Run writing the results into the given output arrays, whose data type
+  // and shape must be the ones of the results.
+  void pyRunInto(const std::vector<py::object> &inputs,
+      const std::vector<py::array> &outputsPyArray);
   std::string pyInputSignature();
   std::string pyOutputSignature();
 };
@@ -45,6 +61,12 @@ PYBIND11_MODULE(PyRuntime, m) {
       .def("set_entry_point", &onnx_mlir::PyExecutionSession::pySetEntryPoint,
           py::arg("name"))
       .def("run", &onnx_mlir::PyExecutionSession::pyRun, py::arg("input"))
+      .def("run_async", &onnx_mlir::PyExecutionSession::pyRunAsync,
+          py::arg("input"))
+      .def("run_batch", &onnx_mlir::PyExecutionSession::pyRunBatch,
+          py::arg("inputs"))
+      .def("run_into", &onnx_mlir::PyExecutionSession::pyRunInto,
+          py::arg("input"), py::arg("output"))
       .def("input_signature", &onnx_mlir::PyExecutionSession::pyInputSignature)
       .def("output_signature",
           &onnx_mlir::PyExecutionSession::pyOutputSignature);
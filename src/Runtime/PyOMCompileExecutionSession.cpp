@@ -13,6 +13,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sstream>
+
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -31,8 +33,9 @@ namespace onnx_mlir {
 
 PyOMCompileExecutionSession::PyOMCompileExecutionSession(
     std::string inputFileName, std::string sharedLibPath, std::string flags,
-    bool defaultEntryPoint)
-    : onnx_mlir::ExecutionSession(sharedLibPath, defaultEntryPoint) {
+    bool defaultEntryPoint, int64_t maxSpecializations)
+    : onnx_mlir::ExecutionSession(sharedLibPath, defaultEntryPoint),
+      maxSpecializations(maxSpecializations) {
   this->inputFileName = inputFileName;
   if (this->inputFileName.empty()) {
     errorMessage = "No OMCompileExecuteSession was created with the input file "
@@ -53,6 +56,93 @@ PyOMCompileExecutionSession::PyOMCompileExecutionSession(
     // Empty output file name.
     this->sharedLibPath = std::string();
   }
+
+  // The variants get their own output file and input shapes.
+  std::istringstream flagStream(flags);
+  std::string flag;
+  while (flagStream >> flag) {
+    if (flag == "-o") {
+      flagStream >> flag;
+      continue;
+    }
+    if (flag.find("shapeInformation") != std::string::npos) {
+      if (flag.find('=') == std::string::npos)
+        flagStream >> flag;
+      continue;
+    }
+    specializationFlags += flag + " ";
+  }
+}
+
+PyOMCompileExecutionSession::~PyOMCompileExecutionSession() {
+  if (compileThread.joinable())
+    compileThread.join();
+}
+
+std::shared_ptr<ExecutionSession>
+PyOMCompileExecutionSession::getSpecialization(
+    const std::vector<OMTensor *> &inputs) {
+  std::stringstream shapeInfo;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    int64_t rank = omTensorGetRank(inputs[i]);
+    const int64_t *shape = omTensorGetShape(inputs[i]);
+    // Scalars have static shapes.
+    if (rank == 0)
+      continue;
+    if (shapeInfo.tellp() > 0)
+      shapeInfo << ",";
+    shapeInfo << i << ":" << shape[0];
+    for (int64_t d = 1; d < rank; ++d)
+      shapeInfo << "x" << shape[d];
+  }
+
+  std::lock_guard<std::mutex> lock(specializationMutex);
+  for (auto it = specializations.begin(); it != specializations.end(); ++it) {
+    if (it->first != shapeInfo.str())
+      continue;
+    specializations.splice(specializations.begin(), specializations, it);
+    return it->second;
+  }
+  // Compile one variant at a time, the shapes seen during the compilation
+  // being compiled when seen again.
+  if (!isCompiling && !failedShapes.count(shapeInfo.str())) {
+    if (compileThread.joinable())
+      compileThread.join();
+    isCompiling = true;
+    compileThread = std::thread(
+        &PyOMCompileExecutionSession::compileSpecialization, this,
+        shapeInfo.str());
+  }
+  return nullptr;
+}
+
+void PyOMCompileExecutionSession::compileSpecialization(std::string shapeInfo) {
+  std::string outputBaseName =
+      sharedLibPath.substr(0, sharedLibPath.find_last_of(".")) + "_shape" +
+      std::to_string(numSpecializations++);
+  std::string flags = specializationFlags + "-o " + outputBaseName +
+                      " --shapeInformation=" + shapeInfo;
+  const char *outputName = nullptr, *errorMsg = nullptr;
+  std::shared_ptr<ExecutionSession> session;
+  if (omCompileFromFile(inputFileName.c_str(), flags.c_str(), &outputName,
+          &errorMsg) == 0) {
+    try {
+      session = std::make_shared<ExecutionSession>(
+          std::string(outputName), /*defaultEntryPoint=*/false);
+    } catch (const std::runtime_error &) {
+    }
+    free((void *)outputName);
+  }
+
+  std::lock_guard<std::mutex> lock(specializationMutex);
+  isCompiling = false;
+  if (!session) {
+    failedShapes.insert(shapeInfo);
+    return;
+  }
+  specializations.emplace_front(shapeInfo, session);
+  if ((int64_t)specializations.size() > maxSpecializations)
+    specializations.pop_back();
 }
 
 int64_t PyOMCompileExecutionSession::pyGetCompiledResult() { return this->rc; }
@@ -135,7 +225,16 @@ std::vector<py::array> PyOMCompileExecutionSession::pyRun(
   }
 
   auto *wrappedInput = omTensorListCreate(&omts[0], omts.size());
-  auto *wrappedOutput = _entryPointFunc(wrappedInput);
+  // Keep the variant loaded until its outputs are copied.
+  std::shared_ptr<ExecutionSession> specialization;
+  if (maxSpecializations > 0 && !sharedLibPath.empty())
+    specialization = getSpecialization(omts);
+  OMTensorList *wrappedOutput;
+  if (specialization)
+    wrappedOutput =
+        specialization->getEntryPoint(_entryPointName).run(wrappedInput);
+  else
+    wrappedOutput = _entryPointFunc(wrappedInput);
   if (!wrappedOutput)
     throw std::runtime_error(reportErrnoError());
   std::vector<py::array> outputPyArrays;
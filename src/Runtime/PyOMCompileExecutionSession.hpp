@@ -11,8 +11,20 @@
 // This file contains declaration of PyOMCompileExecutionSession class, which
 // helps python programs to compile and run binary model libraries.
 //
+// When given a maximum number of specializations, the session compiles in the
+// background a variant of the model with static shapes for each new shape of
+// the inputs, while the model compiled for any shapes runs the inferences.
+// Later inferences with these shapes run the variant. The most recently used
+// variants are kept loaded, up to the maximum number.
+//
 //===----------------------------------------------------------------------===//
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -28,7 +40,8 @@ class PyOMCompileExecutionSession : public onnx_mlir::ExecutionSession {
 public:
   PyOMCompileExecutionSession(std::string inputFileName,
       std::string sharedLibPath, std::string flags,
-      bool defaultEntryPoint = true);
+      bool defaultEntryPoint = true, int64_t maxSpecializations = 0);
+  ~PyOMCompileExecutionSession();
   std::string pyGetCompiledFileName();
   std::string pyGetErrorMessage();
   int64_t pyGetCompiledResult();
@@ -39,10 +52,34 @@ public:
   std::string pyOutputSignature();
 
 private:
+  // Return the loaded variant specialized for the shapes of the inputs, or
+  // null after starting its compilation if no compilation is in progress.
+  std::shared_ptr<ExecutionSession> getSpecialization(
+      const std::vector<OMTensor *> &inputs);
+  // Compile and load the variant for the shapes given in the format of the
+  // shapeInformation option. Run in compileThread.
+  void compileSpecialization(std::string shapeInfo);
+
   std::string inputFileName;
   std::string sharedLibPath;
   std::string errorMessage;
   int64_t rc;
+
+  // Flags of the compilation of the variants, without output file name and
+  // input shapes.
+  std::string specializationFlags;
+  int64_t maxSpecializations;
+  // Number of variants compiled, to name their output files.
+  int64_t numSpecializations = 0;
+  // Loaded variants with their shapes, most recently used first, guarded by
+  // specializationMutex as the members below.
+  std::mutex specializationMutex;
+  std::list<std::pair<std::string, std::shared_ptr<ExecutionSession>>>
+      specializations;
+  // Shapes whose variant failed to compile, not to compile them again.
+  std::set<std::string> failedShapes;
+  bool isCompiling = false;
+  std::thread compileThread;
 };
 } // namespace onnx_mlir
 
@@ -57,6 +94,11 @@ PYBIND11_MODULE(PyCompileAndRuntime, m) {
                const std::string &, const bool>(),
           py::arg("input_model_path"), py::arg("compiled_file_path"),
           py::arg("flags"), py::arg("use_default_entry_point"))
+      .def(py::init<const std::string &, const std::string &,
+               const std::string &, const bool, const int64_t>(),
+          py::arg("input_model_path"), py::arg("compiled_file_path"),
+          py::arg("flags"), py::arg("use_default_entry_point"),
+          py::arg("max_specializations"))
       .def("get_compiled_result",
           &onnx_mlir::PyOMCompileExecutionSession::pyGetCompiledResult)
       .def("get_compiled_file_name",
@@ -19,6 +19,7 @@
    into libmodel.so */
 void __dummy_do_not_call__(JNIEnv *env, jclass cls, jobject obj) {
   Java_com_ibm_onnxmlir_OMModel_main_1graph_1jni(NULL, NULL, NULL);
+  Java_com_ibm_onnxmlir_OMModel_main_1graph_1reuse_1jni(NULL, NULL, NULL, NULL);
   Java_com_ibm_onnxmlir_OMModel_query_1entry_1points(NULL, NULL);
   Java_com_ibm_onnxmlir_OMModel_input_1signature_1jni(NULL, NULL, NULL);
   Java_com_ibm_onnxmlir_OMModel_output_1signature_1jni(NULL, NULL, NULL);
@@ -4,7 +4,7 @@
 
 //===------------- jniwrapper.c - JNI wrapper Implementation -------------===//
 //
-// Copyright 2019-2022 The IBM Research Authors.
+// Copyright 2019-2023 The IBM Research Authors.
 //
 // =============================================================================
 //
@@ -244,28 +244,47 @@ enum {
 };
 /* clang-format on */
 
-/* Find and initialize Java method IDs in struct jniapi */
+/* Java classes and method IDs needed for making JNI API calls, resolved
+ * once when the model library is loaded by JNI_OnLoad. The classes are
+ * global references, and method IDs remain valid as long as their class
+ * is loaded, so they are shared by all the threads calling the model.
+ */
+static jniapi_t jniapi;
+
+/* Find a Java class and return a global reference to it, or NULL with a
+ * pending exception if the class is not found.
+ */
+static jclass find_global_class(JNIEnv *env, const char *name) {
+  jclass local_cls = (*env)->FindClass(env, name);
+  if (local_cls == NULL)
+    return NULL;
+  jclass global_cls = (*env)->NewGlobalRef(env, local_cls);
+  (*env)->DeleteLocalRef(env, local_cls);
+  return global_cls;
+}
+
+/* Find and initialize Java classes and method IDs in struct jniapi */
 jniapi_t *fill_jniapi(JNIEnv *env, jniapi_t *japi) {
   /* Get Java Exception, Long, String, OMTensor, and OMTensorList classes
    */
   assert(env);
   JNI_VAR_CALL(env, japi->jecpt_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_EXCEPTION]),
+      find_global_class(env, jnistr[CLS_JAVA_LANG_EXCEPTION]),
       japi->jecpt_cls != NULL, NULL, "Class java/lang/Exception not found");
   JNI_VAR_CALL(env, japi->jlong_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_LONG]),
+      find_global_class(env, jnistr[CLS_JAVA_LANG_LONG]),
       japi->jlong_cls != NULL, japi->jecpt_cls,
       "Class java/lang/Long not found");
   JNI_VAR_CALL(env, japi->jstring_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_STRING]),
+      find_global_class(env, jnistr[CLS_JAVA_LANG_STRING]),
       japi->jstring_cls != NULL, japi->jecpt_cls,
       "Class java/lang/String not found");
   JNI_VAR_CALL(env, japi->jomt_cls,
-      (*env)->FindClass(env, jnistr[CLS_COM_IBM_ONNXMLIR_OMTENSOR]),
+      find_global_class(env, jnistr[CLS_COM_IBM_ONNXMLIR_OMTENSOR]),
       japi->jomt_cls != NULL, japi->jecpt_cls,
       "Class com/ibm/onnxmlir/OMTensor not found");
   JNI_VAR_CALL(env, japi->jomtl_cls,
-      (*env)->FindClass(env, jnistr[CLS_COM_IBM_ONNXMLIR_OMTENSORLIST]),
+      find_global_class(env, jnistr[CLS_COM_IBM_ONNXMLIR_OMTENSORLIST]),
       japi->jomtl_cls != NULL, japi->jecpt_cls,
       "Class com/ibm/onnxmlir/OMTensorList not found");
 
@@ -368,9 +387,9 @@ jniapi_t *fill_jniapi(JNIEnv *env, jniapi_t *japi) {
  *   +|----------+            ^ ownership false, owned/freed by Java
  *   |o| | ... | |      +-----|---------+
  *   +-----------+      | _allocatedPtr | (constructed by jniwrapper)
- * jobj_omts, freed     |               |<---+
- * at the end of        | omTensor      |    |
- * omtl_java_to_native  +---------------+  freed by
+ * jobj_omt, deleted    |               |<---+
+ * once its omTensor    | omTensor      |    |
+ * is constructed       +---------------+  freed by
  *                      ^                  omTensorListDestroy(jni_iomtl)
  *        +-------------|---------------+  at the end of
  *        |       +-----|-----------+   |  ..._main_1graph_1jni
@@ -393,55 +412,53 @@ OMTensorList *omtl_java_to_native(
       jomtl_omtn >= 0 && jomtl_omtn <= INT_MAX, japi->jecpt_cls,
       "jomtl_omtn=%ld", jomtl_omtn);
 
-  /* Allocate memory for holding each Java omt object and OMTensor pointers
-   * for constructing native OMTensor array
-   *
-   * jobj_omts are the pointers to the Java OMTensor objects. They are used
-   * to make JNI calls on the OMTensors to retrieve their internal fields
-   * such as data, shape, strides, etc.
+  /* Allocate memory for holding the OMTensor pointers for constructing
+   * native OMTensor array
    *
    * jni_omts are the pointers to the native OMTensor structs we construct,
    * filled in with fields we retrieved from the corresponding Java OMTensor
    * objects, and then given to the native OMTensorList struct.
    */
-  LIB_TYPE_VAR_CALL(jobject *, jobj_omts, malloc(jomtl_omtn * sizeof(jobject)),
-      jobj_omts != NULL, env, japi->jecpt_cls, "jobj_omts=%p", jobj_omts);
   LIB_TYPE_VAR_CALL(OMTensor **, jni_omts,
       malloc(jomtl_omtn * sizeof(OMTensor *)), jni_omts != NULL, env,
       japi->jecpt_cls, "jni_omts=%p", jni_omts);
 
   /* Loop through all the jomtl_omts  */
   for (int i = 0; i < jomtl_omtn; i++) {
-    JNI_VAR_CALL(env, jobj_omts[i],
-        (*env)->GetObjectArrayElement(env, jomtl_omts, i), jobj_omts[i] != NULL,
-        japi->jecpt_cls, "jobj_omts[%d]=%p", i, jobj_omts[i]);
+    /* jobj_omt is the Java OMTensor object used to make JNI calls on the
+     * OMTensor to retrieve its internal fields such as data, shape,
+     * strides, etc.
+     */
+    JNI_TYPE_VAR_CALL(env, jobject, jobj_omt,
+        (*env)->GetObjectArrayElement(env, jomtl_omts, i), jobj_omt != NULL,
+        japi->jecpt_cls, "jobj_omt[%d]=%p", i, jobj_omt);
 
     /* Get data, shape, strides, dataType, rank, and bufferSize by calling
      * corresponding methods
      */
     JNI_TYPE_VAR_CALL(env, jobject, jomt_data,
-        (*env)->CallObjectMethod(env, jobj_omts[i], japi->jomt_getData),
+        (*env)->CallObjectMethod(env, jobj_omt, japi->jomt_getData),
         jomt_data != NULL, japi->jecpt_cls, "omt[%d]:data=%p", i, jomt_data);
     JNI_TYPE_VAR_CALL(env, jobject, jomt_shape,
-        (*env)->CallObjectMethod(env, jobj_omts[i], japi->jomt_getShape),
+        (*env)->CallObjectMethod(env, jobj_omt, japi->jomt_getShape),
         jomt_shape != NULL, japi->jecpt_cls, "omt[%d]:shape=%p", i, jomt_shape);
     JNI_TYPE_VAR_CALL(env, jobject, jomt_strides,
-        (*env)->CallObjectMethod(env, jobj_omts[i], japi->jomt_getStrides),
+        (*env)->CallObjectMethod(env, jobj_omt, japi->jomt_getStrides),
         jomt_strides != NULL, japi->jecpt_cls, "omt[%d]:strides=%p", i,
         jomt_strides);
     JNI_TYPE_VAR_CALL(env, jint, jomt_dataType,
-        (*env)->CallIntMethod(env, jobj_omts[i], japi->jomt_getDataType),
+        (*env)->CallIntMethod(env, jobj_omt, japi->jomt_getDataType),
         jomt_dataType != ONNX_TYPE_UNDEFINED, japi->jecpt_cls,
         "omt[%d]:dataType=%d", i, jomt_dataType);
     JNI_TYPE_VAR_CALL(env, jlong, jomt_bufferSize,
-        (*env)->CallLongMethod(env, jobj_omts[i], japi->jomt_getBufferSize),
+        (*env)->CallLongMethod(env, jobj_omt, japi->jomt_getBufferSize),
         jomt_bufferSize >= 0, japi->jecpt_cls, "omt[%d]:bufferSize=%ld", i,
         jomt_bufferSize);
     JNI_TYPE_VAR_CALL(env, jlong, jomt_rank,
-        (*env)->CallLongMethod(env, jobj_omts[i], japi->jomt_getRank),
+        (*env)->CallLongMethod(env, jobj_omt, japi->jomt_getRank),
         jomt_rank >= 0, japi->jecpt_cls, "omt[%d]:rank=%ld", i, jomt_rank);
     JNI_TYPE_VAR_CALL(env, jlong, jomt_numElems,
-        (*env)->CallLongMethod(env, jobj_omts[i], japi->jomt_getNumElems),
+        (*env)->CallLongMethod(env, jobj_omt, japi->jomt_getNumElems),
         jomt_numElems >= 0, japi->jecpt_cls, "omt[%d]:numElems=%ld", i,
         jomt_numElems);
 
@@ -488,13 +505,17 @@ OMTensorList *omtl_java_to_native(
     JNI_CALL(env,
         (*env)->ReleaseLongArrayElements(env, jomt_strides, jni_strides, 0), 1,
         NULL, "");
-  }
 
-  /* We have constructed the native OMTensor structs so the pointers
-   * to the corresponding Java OMTensor objects used for retrieving
-   * their internal fields are no longer needed.
-   */
-  free(jobj_omts);
+    /* We have constructed the native OMTensor struct so the local
+     * references to the Java objects used for retrieving its internal
+     * fields are no longer needed. Deleting them keeps the number of
+     * local references constant however many inputs the model has.
+     */
+    (*env)->DeleteLocalRef(env, jomt_data);
+    (*env)->DeleteLocalRef(env, jomt_shape);
+    (*env)->DeleteLocalRef(env, jomt_strides);
+    (*env)->DeleteLocalRef(env, jobj_omt);
+  }
 
   /* Create OMTensorList to be constructed and passed to the model
    * shared library. Note that we do own the pointers to the native
@@ -540,9 +561,17 @@ OMTensorList *omtl_java_to_native(
  *        |       +-----------------+   |<---+
  *        | omTensorList                | (constructed by model runtime)
  *        +-----------------------------+
+ *
+ * If java_reuse_omtl is not NULL and has as many OMTensors as the native
+ * OMTensorList, its OMTensor array is filled in and it is returned instead
+ * of a new OMTensorList. Each OMTensor of the same rank and buffer size as
+ * the native OMTensor at the same position is reused: the native data
+ * buffer is copied into its direct byte buffer and later freed by
+ * omTensorListDestroy if owned, and its shape, strides and data type are
+ * updated in place. The other OMTensors are replaced by new ones.
  */
-jobject omtl_native_to_java(
-    JNIEnv *env, jclass cls, OMTensorList *jni_omtl, jniapi_t *japi) {
+jobject omtl_native_to_java(JNIEnv *env, jclass cls, OMTensorList *jni_omtl,
+    jobject java_reuse_omtl, jniapi_t *japi) {
 
   /* Get the OMTensor array in the OMTensorList */
   LIB_TYPE_VAR_CALL(OMTensor **, jni_omts, omTensorListGetOmtArray(jni_omtl),
@@ -553,10 +582,29 @@ jobject omtl_native_to_java(
       jni_omtn > 0 && jni_omtn <= INT_MAX, env, japi->jecpt_cls, "jni_omtn=%ld",
       jni_omtn);
 
-  /* Create OMTensor java object array */
-  JNI_TYPE_VAR_CALL(env, jobjectArray, jobj_omts,
-      (*env)->NewObjectArray(env, jni_omtn, japi->jomt_cls, NULL),
-      jobj_omts != NULL, japi->jecpt_cls, "jobj_omts=%p", jobj_omts);
+  /* Get the OMTensor array of the OMTensorList to reuse, if any, and
+   * only reuse it if it has as many OMTensors as the native one.
+   */
+  jobjectArray jreuse_omts = NULL;
+  if (java_reuse_omtl != NULL) {
+    JNI_VAR_CALL(env, jreuse_omts,
+        (*env)->CallObjectMethod(
+            env, java_reuse_omtl, japi->jomtl_getOmtArray),
+        1, NULL, "");
+    if (jreuse_omts != NULL &&
+        (*env)->GetArrayLength(env, jreuse_omts) != jni_omtn) {
+      (*env)->DeleteLocalRef(env, jreuse_omts);
+      jreuse_omts = NULL;
+    }
+  }
+
+  /* Create OMTensor java object array, unless reusing one */
+  jobjectArray jobj_omts = jreuse_omts;
+  if (jobj_omts == NULL) {
+    JNI_VAR_CALL(env, jobj_omts,
+        (*env)->NewObjectArray(env, jni_omtn, japi->jomt_cls, NULL),
+        jobj_omts != NULL, japi->jecpt_cls, "jobj_omts=%p", jobj_omts);
+  }
 
   /* Loop through the native OMTensor structs */
   for (int i = 0; i < jni_omtn; i++) {
@@ -594,6 +642,65 @@ jobject omtl_native_to_java(
     jint jomt_rank = jni_rank;
     /*jlong jomt_numElems = jni_numElems;*/
 
+    /* Reuse the OMTensor Java object at the same position if it has the
+     * same rank and buffer size, by copying the native data buffer into
+     * its direct byte buffer and updating its shape and strides arrays.
+     */
+    jobject jreuse_omt = NULL;
+    if (jreuse_omts != NULL) {
+      JNI_VAR_CALL(env, jreuse_omt,
+          (*env)->GetObjectArrayElement(env, jreuse_omts, i), 1, NULL, "");
+    }
+    if (jreuse_omt != NULL) {
+      JNI_TYPE_VAR_CALL(env, jlong, jreuse_rank,
+          (*env)->CallLongMethod(env, jreuse_omt, japi->jomt_getRank), 1,
+          NULL, "");
+      JNI_TYPE_VAR_CALL(env, jlong, jreuse_bufferSize,
+          (*env)->CallLongMethod(env, jreuse_omt, japi->jomt_getBufferSize),
+          1, NULL, "");
+      if (jreuse_rank == jni_rank && jreuse_bufferSize == jni_bufferSize) {
+        JNI_TYPE_VAR_CALL(env, jobject, jreuse_data,
+            (*env)->CallObjectMethod(env, jreuse_omt, japi->jomt_getData),
+            jreuse_data != NULL, japi->jecpt_cls, "omt[%d]:jreuse_data=%p",
+            i, jreuse_data);
+        JNI_TYPE_VAR_CALL(env, void *, jreuse_buffer,
+            (*env)->GetDirectBufferAddress(env, jreuse_data),
+            jreuse_buffer != NULL, japi->jecpt_cls,
+            "omt[%d]:jreuse_buffer=%p", i, jreuse_buffer);
+        memcpy(jreuse_buffer, jni_data, jni_bufferSize);
+        LOG_PRINTF(LOG_DEBUG, "omt[%d]:%p data %p copied into %p", i,
+            jni_omts[i], jni_data, jreuse_buffer);
+
+        JNI_TYPE_VAR_CALL(env, jlongArray, jreuse_shape,
+            (*env)->CallObjectMethod(env, jreuse_omt, japi->jomt_getShape),
+            jreuse_shape != NULL, japi->jecpt_cls, "omt[%d]:jreuse_shape=%p",
+            i, jreuse_shape);
+        JNI_CALL(env,
+            (*env)->SetLongArrayRegion(
+                env, jreuse_shape, 0, jomt_rank, (jlong *)jni_shape),
+            1, NULL, "");
+        JNI_TYPE_VAR_CALL(env, jlongArray, jreuse_strides,
+            (*env)->CallObjectMethod(env, jreuse_omt, japi->jomt_getStrides),
+            jreuse_strides != NULL, japi->jecpt_cls,
+            "omt[%d]:jreuse_strides=%p", i, jreuse_strides);
+        JNI_CALL(env,
+            (*env)->SetLongArrayRegion(
+                env, jreuse_strides, 0, jomt_rank, (jlong *)jni_strides),
+            1, NULL, "");
+        JNI_CALL(env,
+            (*env)->CallVoidMethod(
+                env, jreuse_omt, japi->jomt_setDataType, jomt_dataType),
+            1, NULL, "");
+
+        (*env)->DeleteLocalRef(env, jreuse_data);
+        (*env)->DeleteLocalRef(env, jreuse_shape);
+        (*env)->DeleteLocalRef(env, jreuse_strides);
+        (*env)->DeleteLocalRef(env, jreuse_omt);
+        continue;
+      }
+      (*env)->DeleteLocalRef(env, jreuse_omt);
+    }
+
     /* Create direct byte buffer Java object from native data buffer.
      *
      * If jni_owning is true, we take ownership by setting owner flag
@@ -659,8 +766,20 @@ jobject omtl_native_to_java(
     /* Set the OMTensor object in the object array */
     JNI_CALL(env, (*env)->SetObjectArrayElement(env, jobj_omts, i, jobj_omt), 1,
         NULL, "");
+
+    /* The OMTensor object is referenced by the object array, so the
+     * local references created for it are no longer needed.
+     */
+    (*env)->DeleteLocalRef(env, jomt_data);
+    (*env)->DeleteLocalRef(env, jomt_shape);
+    (*env)->DeleteLocalRef(env, jomt_strides);
+    (*env)->DeleteLocalRef(env, jobj_omt);
   }
 
+  /* Return the reused OMTensorList java object */
+  if (jreuse_omts != NULL)
+    return java_reuse_omtl;
+
   /* Create the OMTensorList java object */
   JNI_TYPE_VAR_CALL(env, jobject, java_omtl,
       (*env)->NewObject(
@@ -670,20 +789,52 @@ jobject omtl_native_to_java(
   return java_omtl;
 }
 
-JNIEXPORT jobject JNICALL Java_com_ibm_onnxmlir_OMModel_main_1graph_1jni(
-    JNIEnv *env, jclass cls, jobject java_iomtl) {
+/* Called by the JVM when the model library is loaded by OMModel. Find
+ * and initialize the Java classes and method IDs in struct jniapi once,
+ * rather than on every model inference call. FindClass uses the class
+ * loader of OMModel here, so the OMTensor and OMTensorList classes are
+ * found even if they are not on the system class path.
+ */
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
+  JNIEnv *env;
+  if ((*vm)->GetEnv(vm, (void **)&env, JNI_VERSION_1_6) != JNI_OK)
+    return JNI_ERR;
 
-  /* Apparently J9 cannot have the return pointer of FindClass shared
-   * across threads. So move jniapi into stack so each thread has its
-   * own copy.
-   */
-  jniapi_t jniapi;
+  log_init();
+
+  if (fill_jniapi(env, &jniapi) == NULL)
+    return JNI_ERR;
+  return JNI_VERSION_1_6;
+}
+
+/* Called by the JVM when the class loader of OMModel is garbage
+ * collected. Delete the global references to the Java classes.
+ */
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *reserved) {
+  JNIEnv *env;
+  if ((*vm)->GetEnv(vm, (void **)&env, JNI_VERSION_1_6) != JNI_OK)
+    return;
+
+  jclass *classes[] = {&jniapi.jecpt_cls, &jniapi.jlong_cls,
+      &jniapi.jstring_cls, &jniapi.jomt_cls, &jniapi.jomtl_cls};
+  for (size_t i = 0; i < sizeof(classes) / sizeof(classes[0]); i++) {
+    if (*classes[i] != NULL)
+      (*env)->DeleteGlobalRef(env, *classes[i]);
+    *classes[i] = NULL;
+  }
+}
+
+/* Run the model inference on the Java input OMTensorList, returning the
+ * output OMTensorList. The OMTensors of java_reuse_omtl, if not NULL, are
+ * reused for the output when possible, see omtl_native_to_java.
+ */
+static jobject main_graph(JNIEnv *env, jclass cls, jobject java_iomtl,
+    jobject java_reuse_omtl) {
 
   log_init();
 
-  /* Find and initialize Java method IDs in struct jniapi */
-  CHECK_CALL(jniapi_t *, japi, fill_jniapi(env, &jniapi), japi != NULL,
-      "japi=%p", japi);
+  /* Java classes and method IDs found by JNI_OnLoad */
+  jniapi_t *japi = &jniapi;
 
   /* Convert Java object to native data structure */
   CHECK_CALL(OMTensorList *, jni_iomtl,
@@ -696,8 +847,8 @@ JNIEXPORT jobject JNICALL Java_com_ibm_onnxmlir_OMModel_main_1graph_1jni(
 
   /* Convert native data structure to Java object */
   CHECK_CALL(jobject, java_oomtl,
-      omtl_native_to_java(env, cls, jni_oomtl, japi), java_oomtl != NULL,
-      "java_oomtl=%p", java_oomtl);
+      omtl_native_to_java(env, cls, jni_oomtl, java_reuse_omtl, japi),
+      java_oomtl != NULL, "java_oomtl=%p", java_oomtl);
 
   /* Free intermediate data structures and return Java object */
   omTensorListDestroy(jni_iomtl);
@@ -705,6 +856,16 @@ JNIEXPORT jobject JNICALL Java_com_ibm_onnxmlir_OMModel_main_1graph_1jni(
   return java_oomtl;
 }
 
+JNIEXPORT jobject JNICALL Java_com_ibm_onnxmlir_OMModel_main_1graph_1jni(
+    JNIEnv *env, jclass cls, jobject java_iomtl) {
+  return main_graph(env, cls, java_iomtl, NULL);
+}
+
+JNIEXPORT jobject JNICALL Java_com_ibm_onnxmlir_OMModel_main_1graph_1reuse_1jni(
+    JNIEnv *env, jclass cls, jobject java_iomtl, jobject java_reuse_omtl) {
+  return main_graph(env, cls, java_iomtl, java_reuse_omtl);
+}
+
 #ifdef __MVS__
 /* On z/OS, we convert entry point name in ASCII into EBCDIC for
  * the omInputSignature/omOutputSignaturee function using __a2e_s.
@@ -737,13 +898,9 @@ Java_com_ibm_onnxmlir_OMModel_query_1entry_1points(JNIEnv *env, jclass cls) {
 
   log_init();
 
-  /* Find and initialize Java Exception and String class */
-  JNI_TYPE_VAR_CALL(env, jclass, jecpt_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_EXCEPTION]),
-      jecpt_cls != NULL, NULL, "Class java/lang/Exception not found");
-  JNI_TYPE_VAR_CALL(env, jclass, jstring_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_STRING]), jstring_cls != NULL,
-      jecpt_cls, "Class java/lang/String not found");
+  /* Java Exception and String class found by JNI_OnLoad */
+  jclass jecpt_cls = jniapi.jecpt_cls;
+  jclass jstring_cls = jniapi.jstring_cls;
 
   /* Call query entry points API */
   int64_t neps;
@@ -793,10 +950,8 @@ JNIEXPORT jstring JNICALL Java_com_ibm_onnxmlir_OMModel_input_1signature_1jni(
 
   log_init();
 
-  /* Find and initialize Java Exception class */
-  JNI_TYPE_VAR_CALL(env, jclass, jecpt_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_EXCEPTION]),
-      jecpt_cls != NULL, NULL, "Class java/lang/Exception not found");
+  /* Java Exception class found by JNI_OnLoad */
+  jclass jecpt_cls = jniapi.jecpt_cls;
 
   /* Get reference to the signature Java String object */
   JNI_TYPE_VAR_CALL(env, const char *, jni_ep,
@@ -855,10 +1010,8 @@ JNIEXPORT jstring JNICALL Java_com_ibm_onnxmlir_OMModel_output_1signature_1jni(
 
   log_init();
 
-  /* Find and initialize Java Exception class */
-  JNI_TYPE_VAR_CALL(env, jclass, jecpt_cls,
-      (*env)->FindClass(env, jnistr[CLS_JAVA_LANG_EXCEPTION]),
-      jecpt_cls != NULL, NULL, "Class java/lang/Exception not found");
+  /* Java Exception class found by JNI_OnLoad */
+  jclass jecpt_cls = jniapi.jecpt_cls;
 
   /* Get reference to the signature Java String object */
   JNI_TYPE_VAR_CALL(env, const char *, jni_ep,
@@ -168,6 +168,8 @@ public class OMModel {
     }
 
     private static native OMTensorList main_graph_jni(OMTensorList list);
+    private static native OMTensorList main_graph_reuse_jni(OMTensorList list,
+                                                            OMTensorList output);
     private static native String[] query_entry_points();
     private static native String input_signature_jni(String entry_point);
     private static native String output_signature_jni(String entry_point);
@@ -182,6 +184,30 @@ public class OMModel {
         return main_graph_jni(list);
     }
 
+    /**
+     * Default model runtime entry point reusing the output tensor list
+     * of a previous call
+     *
+     * The output tensors of the same rank and buffer size as the new
+     * outputs, typically all of them when the shapes of the inputs do
+     * not change, get the new outputs copied into their data buffers
+     * instead of new direct byte buffers and tensors being allocated.
+     * The other output tensors are replaced by new ones. Pass the output
+     * of the previous call to avoid putting pressure on the garbage
+     * collector when running the model repeatedly.
+     *
+     * @param list input tensor list
+     * @param output output tensor list of a previous call to reuse, or
+     *        null to allocate a new one
+     * @return output tensor list, output itself if it has been reused
+     */
+    public static OMTensorList mainGraph(OMTensorList list,
+                                         OMTensorList output) {
+        if (output == null)
+            return main_graph_jni(list);
+        return main_graph_reuse_jni(list, output);
+    }
+
     /**
      * Query all entry point names in the model.
      *
@@ -0,0 +1,136 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- DedupKrnlGlobalConstants.cpp - Merge identical Krnl constants ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Models often contain identical initializers, e.g. tied embeddings, repeated
+// shape constants or identical per-layer scales, each lowered to a Krnl global
+// of its own. This pass gives the Krnl globals of the same type and value the
+// same name, so that they share the same LLVM global, or the same data in the
+// constants file, when lowered to LLVM.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace {
+
+// Return the raw data of a dense resource value, or std::nullopt when the
+// blob is not available.
+std::optional<ArrayRef<char>> getResourceData(Attribute value) {
+  auto resourceAttr = value.dyn_cast<DenseResourceElementsAttr>();
+  if (!resourceAttr)
+    return std::nullopt;
+  AsmResourceBlob *blob = resourceAttr.getRawHandle().getBlob();
+  if (!blob)
+    return std::nullopt;
+  return blob->getData();
+}
+
+// Return the hash of the type and value of a constant, or std::nullopt when
+// the constant cannot be merged.
+std::optional<size_t> hashConstant(KrnlGlobalOp op) {
+  if (!op.getValue().has_value() || op.getOffset().has_value())
+    return std::nullopt;
+  Attribute value = op.getValue().value();
+  llvm::hash_code typeHash =
+      llvm::hash_value(op.getResult().getType().getAsOpaquePointer());
+  // Dense elements are uniqued, the contents of resources are hashed.
+  if (value.isa<DenseElementsAttr>())
+    return llvm::hash_combine(typeHash, value.getAsOpaquePointer());
+  if (std::optional<ArrayRef<char>> data = getResourceData(value))
+    return llvm::hash_combine(
+        typeHash, llvm::hash_combine_range(data->begin(), data->end()));
+  return std::nullopt;
+}
+
+bool isSameConstant(KrnlGlobalOp op, KrnlGlobalOp otherOp) {
+  if (op.getResult().getType() != otherOp.getResult().getType())
+    return false;
+  Attribute value = op.getValue().value();
+  Attribute otherValue = otherOp.getValue().value();
+  if (value == otherValue)
+    return true;
+  std::optional<ArrayRef<char>> data = getResourceData(value);
+  std::optional<ArrayRef<char>> otherData = getResourceData(otherValue);
+  return data && otherData && *data == *otherData;
+}
+
+/*!
+ *  Module pass that merges the Krnl globals of the same type and value.
+ */
+class DedupKrnlGlobalConstantsPass
+    : public PassWrapper<DedupKrnlGlobalConstantsPass,
+          OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DedupKrnlGlobalConstantsPass)
+
+  StringRef getArgument() const override { return "dedup-krnl-constants"; }
+
+  StringRef getDescription() const override {
+    return "Merge the Krnl globals of the same type and value.";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+
+    // Groups of identical constants, the first constant of each group giving
+    // its name to the others.
+    SmallVector<SmallVector<KrnlGlobalOp, 1>, 4> groups;
+    llvm::DenseMap<size_t, SmallVector<size_t, 1>> groupsByHash;
+    module.walk([&](KrnlGlobalOp op) {
+      std::optional<size_t> hash = hashConstant(op);
+      if (!hash)
+        return;
+      SmallVector<size_t, 1> &candidates = groupsByHash[*hash];
+      for (size_t g : candidates) {
+        if (isSameConstant(groups[g].front(), op)) {
+          groups[g].emplace_back(op);
+          return;
+        }
+      }
+      candidates.emplace_back(groups.size());
+      groups.emplace_back(SmallVector<KrnlGlobalOp, 1>{op});
+    });
+
+    for (SmallVectorImpl<KrnlGlobalOp> &group : groups) {
+      if (group.size() == 1)
+        continue;
+      // The shared data is aligned as required by all of the constants.
+      std::optional<uint64_t> alignment;
+      for (KrnlGlobalOp op : group)
+        if (std::optional<uint64_t> align = op.getAlignment())
+          alignment = std::max(alignment.value_or(0), *align);
+      StringAttr name = group.front().getNameAttr();
+      for (KrnlGlobalOp op : group) {
+        op.setNameAttr(name);
+        if (alignment)
+          op.setAlignmentAttr(IntegerAttr::get(
+              IntegerType::get(&getContext(), 64), *alignment));
+      }
+    }
+  }
+};
+
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createDedupKrnlGlobalConstantsPass() {
+  return std::make_unique<DedupKrnlGlobalConstantsPass>();
+}
+} // namespace krnl
+} // namespace onnx_mlir
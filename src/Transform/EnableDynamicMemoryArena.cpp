@@ -0,0 +1,293 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- EnableDynamicMemoryArena.cpp - Arena for dynamic MemRefs --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// The memory pools only hold MemRefs of static shape, all the MemRefs of
+// dynamic shape being allocated and freed one by one. This pass allocates the
+// MemRefs of dynamic shape from the memory arena of the runtime instead, which
+// keeps its blocks from one inference to the next.
+//
+// Optionally, the MemRefs of static shape, i.e. the memory pools bundled and
+// planned over the whole function, are allocated from the arena too. The arena
+// then holds all the internal buffers of an inference, in a single block once
+// the first inference has set its peak usage.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/Krnl/DialectBuilder.hpp"
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/KrnlSupport.hpp"
+
+using namespace mlir;
+using namespace onnx_mlir;
+
+namespace {
+
+/// Minimum alignment of the buffers allocated from the arena, the one of
+/// omArenaAlloc.
+const int64_t kArenaMinAlignment = 16;
+
+/*!
+ *  RewritePattern that replaces:
+ *    %0 = memref.alloc(%d) : memref<?x<type>>
+ *    ...
+ *    memref.dealloc %0 : memref<?x<type>>
+ *  with:
+ *    %size = <size of memref<?x<type>> in bytes>
+ *    %mem = krnl.arena_alloc(%size) {alignment = 16 : i64} : memref<?xi8>
+ *    %0 = krnl.getref %mem 0 (%d) : memref<?xi8> -> memref<?x<type>>
+ *
+ *  The buffer is given back to the arena by the krnl.arena_release op inserted
+ *  before the return of the function. It can also be given back where it was
+ *  deallocated, i.e. after its last use:
+ *    %mark = krnl.arena_mark : i64
+ *    %mem = krnl.arena_alloc(%size) {alignment = 16 : i64} : memref<?xi8>
+ *    ...
+ *    krnl.arena_release %mark : i64
+ *  which placeEarlyArenaReleases keeps only where the buffers allocated after
+ *  it are no longer used either.
+ */
+class KrnlEnableDynamicMemoryArena : public OpRewritePattern<memref::AllocOp> {
+public:
+  KrnlEnableDynamicMemoryArena(
+      MLIRContext *context, bool allocateDynamic, bool allocateStatic)
+      : OpRewritePattern<memref::AllocOp>(context),
+        allocateDynamic(allocateDynamic), allocateStatic(allocateStatic) {}
+
+  LogicalResult matchAndRewrite(
+      memref::AllocOp allocOp, PatternRewriter &rewriter) const override {
+    Location loc = allocOp.getLoc();
+    MemRefType memRefType = allocOp.getType();
+
+    // Memory pools already handle MemRefs of static shape, unless these pools
+    // are allocated from the arena too.
+    bool isStatic = hasAllConstantDimensions(memRefType);
+    if (isStatic ? !allocateStatic : !allocateDynamic)
+      return failure();
+
+    // The MemRef type returned by the AllocOp must be normalized.
+    if (!memRefType.getLayout().isIdentity())
+      return failure();
+
+    // Filter out MemRefs with Index type.
+    if (memRefType.getElementType().isIndex())
+      return failure();
+
+    // Only top level MemRefs, which are allocated once per call of the
+    // function.
+    if (!llvm::isa<func::FuncOp>(allocOp->getParentOp()))
+      return failure();
+
+    // The buffer must be deallocated in the function, i.e. it is neither
+    // returned nor stored, to be given back to the arena when the function
+    // returns.
+    SmallVector<memref::DeallocOp, 1> deallocOps;
+    for (Operation *user : allocOp->getUsers()) {
+      if (auto deallocOp = llvm::dyn_cast<memref::DeallocOp>(user))
+        deallocOps.emplace_back(deallocOp);
+      else if (auto storeOp = llvm::dyn_cast<memref::StoreOp>(user))
+        if (storeOp.getValue() == allocOp.getResult())
+          return failure();
+    }
+    if (deallocOps.empty())
+      return failure();
+
+    MultiDialectBuilder<KrnlBuilder, MathBuilder> create(rewriter, loc);
+    Value size = isStatic ? create.math.constant(rewriter.getIntegerType(64),
+                                getMemRefSizeInBytes(allocOp.getResult()))
+                          : getDynamicMemRefSizeInBytes(
+                                memRefType, loc, rewriter, allocOp);
+    int64_t alignment = kArenaMinAlignment;
+    if (allocOp.getAlignment().has_value())
+      alignment = std::max<int64_t>(alignment, allocOp.getAlignment().value());
+    auto arenaType =
+        MemRefType::get({ShapedType::kDynamic}, rewriter.getIntegerType(8));
+    // Deallocations in the block of the buffer are not nested in a region
+    // that may not run, and may give the buffer back early.
+    Block *block = allocOp->getBlock();
+    bool hasBlockDealloc = llvm::any_of(deallocOps,
+        [&](memref::DeallocOp op) { return op->getBlock() == block; });
+    Value mark = hasBlockDealloc ? rewriter.create<KrnlArenaMarkOp>(
+                                       loc, rewriter.getI64Type())
+                                 : Value();
+    Value arena = rewriter.create<KrnlArenaAllocOp>(
+        loc, arenaType, size, rewriter.getI64IntegerAttr(alignment));
+    Value zero = create.math.constant(rewriter.getIntegerType(64), 0);
+    KrnlGetRefOp getRefOp =
+        create.krnl.getRef(memRefType, arena, zero, allocOp.getDynamicSizes());
+
+    for (memref::DeallocOp deallocOp : deallocOps) {
+      if (deallocOp->getBlock() == block)
+        rewriter.replaceOpWithNewOp<KrnlArenaReleaseOp>(deallocOp, mark);
+      else
+        rewriter.eraseOp(deallocOp);
+    }
+    rewriter.replaceOp(allocOp, getRefOp.getResult());
+    return success();
+  }
+
+private:
+  bool allocateDynamic;
+  bool allocateStatic;
+};
+
+/*!
+ *  Module pass that allocates the MemRefs of dynamic shape, and optionally of
+ *  static shape, from the memory arena of the runtime. The functions run by
+ *  the threads of krnl.parallel_call and krnl.task_graph_call ops are left as
+ *  is: the arena of a worker thread would not be released by the calling
+ *  function.
+ */
+class KrnlEnableDynamicMemoryArenaPass
+    : public PassWrapper<KrnlEnableDynamicMemoryArenaPass,
+          OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(KrnlEnableDynamicMemoryArenaPass)
+
+  KrnlEnableDynamicMemoryArenaPass() = default;
+  KrnlEnableDynamicMemoryArenaPass(
+      const KrnlEnableDynamicMemoryArenaPass &pass)
+      : PassWrapper<KrnlEnableDynamicMemoryArenaPass,
+            OperationPass<ModuleOp>>() {}
+  KrnlEnableDynamicMemoryArenaPass(bool allocateDynamic, bool allocateStatic) {
+    this->allocateDynamic = allocateDynamic;
+    this->allocateStatic = allocateStatic;
+  }
+
+  StringRef getArgument() const override {
+    return "enable-dynamic-memory-arena";
+  }
+
+  StringRef getDescription() const override {
+    return "Allocate MemRefs of dynamic shape from the memory arena of the "
+           "runtime.";
+  }
+
+  Option<bool> allocateDynamic{*this, "dynamic",
+      llvm::cl::desc("Allocate the MemRefs of dynamic shape from the arena"),
+      llvm::cl::init(true)};
+
+  Option<bool> allocateStatic{*this, "static",
+      llvm::cl::desc("Allocate the MemRefs of static shape, e.g. the memory "
+                     "pools, from the arena"),
+      llvm::cl::init(false)};
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    MLIRContext *context = &getContext();
+
+    llvm::SmallDenseSet<StringRef, 4> parallelCallees;
+    module.walk([&](KrnlParallelCallOp parallelCallOp) {
+      parallelCallees.insert(parallelCallOp.getCallee());
+    });
+    module.walk([&](KrnlTaskGraphCallOp taskGraphCallOp) {
+      parallelCallees.insert(taskGraphCallOp.getCallee());
+    });
+
+    for (auto function : module.getOps<func::FuncOp>()) {
+      if (function.isExternal() || parallelCallees.count(function.getName()))
+        continue;
+      RewritePatternSet patterns(context);
+      patterns.insert<KrnlEnableDynamicMemoryArena>(
+          context, allocateDynamic, allocateStatic);
+      if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+        return signalPassFailure();
+      for (Block &block : function.getBody())
+        placeEarlyArenaReleases(block);
+      insertArenaMarkAndRelease(function);
+    }
+  }
+
+private:
+  /// Keep the early releases of the buffers of a block that give back to the
+  /// arena only buffers that are no longer used. The arena being a stack, the
+  /// release after the last use of a buffer is kept only once the buffers
+  /// allocated after it are dead too, and then gives back all of them, e.g.
+  /// the temporary buffers of an op lowering allocated after its result. The
+  /// other buffers are given back before the return of the function.
+  void placeEarlyArenaReleases(Block &block) {
+    // Marks of the buffers not given back yet, in allocation order, and
+    // whether they are dead.
+    SmallVector<std::pair<KrnlArenaMarkOp, bool>, 8> stack;
+    SmallVector<KrnlArenaMarkOp, 8> marks;
+    for (Operation &op : llvm::make_early_inc_range(block)) {
+      if (auto markOp = llvm::dyn_cast<KrnlArenaMarkOp>(op)) {
+        stack.emplace_back(markOp, false);
+        marks.emplace_back(markOp);
+        continue;
+      }
+      auto releaseOp = llvm::dyn_cast<KrnlArenaReleaseOp>(op);
+      if (!releaseOp)
+        continue;
+      // Buffers already given back by an earlier release are skipped.
+      auto it = llvm::find_if(stack, [&](auto &entry) {
+        return entry.first.getResult() == releaseOp.getMark();
+      });
+      if (it == stack.end()) {
+        releaseOp.erase();
+        continue;
+      }
+      size_t index = it - stack.begin();
+      it->second = true;
+      size_t size = stack.size();
+      while (size > 0 && stack[size - 1].second)
+        --size;
+      if (size > index) {
+        releaseOp.erase();
+        continue;
+      }
+      // Give back this buffer and the dead ones allocated around it.
+      releaseOp->setOperand(0, stack[size].first.getResult());
+      stack.resize(size);
+    }
+    for (KrnlArenaMarkOp markOp : marks)
+      if (markOp->use_empty())
+        markOp.erase();
+  }
+
+  /// Mark the arena on entry of a function allocating from it, and release it
+  /// on return. Nested calls thus only release their own buffers.
+  void insertArenaMarkAndRelease(func::FuncOp function) {
+    bool usesArena = false;
+    function.walk([&](KrnlArenaAllocOp) { usesArena = true; });
+    Block &entryBlock = function.getBody().front();
+    if (!usesArena || llvm::isa<KrnlArenaMarkOp>(entryBlock.front()))
+      return;
+
+    Location loc = function.getLoc();
+    OpBuilder builder = OpBuilder::atBlockBegin(&function.getBody().front());
+    Value mark = builder.create<KrnlArenaMarkOp>(loc, builder.getI64Type());
+    function.walk([&](func::ReturnOp returnOp) {
+      builder.setInsertionPoint(returnOp);
+      builder.create<KrnlArenaReleaseOp>(returnOp.getLoc(), mark);
+    });
+  }
+};
+
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createKrnlEnableDynamicMemoryArenaPass() {
+  return std::make_unique<KrnlEnableDynamicMemoryArenaPass>();
+}
+
+std::unique_ptr<Pass> createKrnlEnableDynamicMemoryArenaPass(
+    bool allocateDynamic, bool allocateStatic) {
+  return std::make_unique<KrnlEnableDynamicMemoryArenaPass>(
+      allocateDynamic, allocateStatic);
+}
+} // namespace krnl
+} // namespace onnx_mlir
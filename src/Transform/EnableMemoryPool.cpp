@@ -38,10 +38,12 @@ static bool checkOpResultIsReturned(memref::AllocOp *allocOp) {
   // Check if the result value of `allocOp` is an operand of
   // `ReinterpretCastOp`, and store the result value of `ReinterpretCastOp`.
   // Reshape, Squeeze, and Unsqueeze ops are checked because they are lowered to
-  // `ReinterpretCastOp`.
+  // `ReinterpretCastOp`. Views are checked as well, since the outputs of
+  // Concat, Split and Slice may alias their operands with them.
   SmallVector<Value, 32> castOpResults;
   function.walk([allocOp, &castOpResults](Operation *op) {
     if (isa<memref::ReinterpretCastOp>(op) || isa<memref::CastOp>(op) ||
+        isa<memref::ViewOp>(op) || isa<memref::SubViewOp>(op) ||
         isa<ONNXReshapeOp>(op) || isa<ONNXSqueezeV11Op>(op) ||
         isa<ONNXUnsqueezeV11Op>(op)) {
       auto result = allocOp->getResult();
@@ -187,6 +189,62 @@ public:
 
 // TODO: Replace old dealloc with krnl.unsetref.
 
+/*!
+ *  Reuse the buffers of dynamic shape deallocated before the allocation of a
+ *  buffer of the same type and dynamic sizes, in the top level block of the
+ *  function. Replace:
+ *    %0 = memref.alloc(%d) : memref<?x<type>>
+ *    ...
+ *    memref.dealloc %0 : memref<?x<type>>
+ *    %1 = memref.alloc(%d) : memref<?x<type>>
+ *    ...
+ *    memref.dealloc %1 : memref<?x<type>>
+ *  with:
+ *    %0 = memref.alloc(%d) : memref<?x<type>>
+ *    ...
+ *    memref.dealloc %0 : memref<?x<type>>
+ *  The memory pools only hold MemRefs of static shape, and the dynamic sizes
+ *  are the same values for the dimensions proven equal when lowering to Krnl.
+ */
+void reuseDynamicMemRefs(func::FuncOp function) {
+  if (function.getBody().empty())
+    return;
+  Block &topBlock = function.getBody().front();
+  // Allocations whose only deallocation has been seen, with the latter.
+  SmallVector<std::pair<memref::AllocOp, memref::DeallocOp>, 4> freed;
+  for (Operation &op : llvm::make_early_inc_range(topBlock)) {
+    if (auto deallocOp = llvm::dyn_cast<memref::DeallocOp>(op)) {
+      auto allocOp = deallocOp.getMemref().getDefiningOp<memref::AllocOp>();
+      if (!allocOp || allocOp->getBlock() != &topBlock ||
+          hasAllConstantDimensions(allocOp.getType()))
+        continue;
+      int64_t numDeallocs = llvm::count_if(allocOp->getUsers(),
+          [](Operation *user) { return llvm::isa<memref::DeallocOp>(user); });
+      if (numDeallocs == 1)
+        freed.emplace_back(allocOp, deallocOp);
+      continue;
+    }
+    auto allocOp = llvm::dyn_cast<memref::AllocOp>(op);
+    if (!allocOp || hasAllConstantDimensions(allocOp.getType()))
+      continue;
+    auto reusable = llvm::find_if(freed, [&](const auto &entry) {
+      memref::AllocOp freedOp = entry.first;
+      return freedOp.getType() == allocOp.getType() &&
+             freedOp.getDynamicSizes() == allocOp.getDynamicSizes() &&
+             freedOp.getSymbolOperands().empty() &&
+             allocOp.getSymbolOperands().empty() &&
+             freedOp.getAlignment() == allocOp.getAlignment();
+    });
+    if (reusable == freed.end())
+      continue;
+    // The buffer now lives until the deallocation of the new allocation.
+    reusable->second.erase();
+    allocOp.getResult().replaceAllUsesWith(reusable->first.getResult());
+    allocOp.erase();
+    freed.erase(reusable);
+  }
+}
+
 /*!
  *  Function pass that enables memory pooling for MemRefs.
  */
@@ -204,6 +262,8 @@ public:
   void runOnOperation() override {
     auto function = getOperation();
 
+    reuseDynamicMemRefs(function);
+
     ConversionTarget target(getContext());
     RewritePatternSet patterns(&getContext());
     patterns.insert<KrnlEnableMemoryPool>(&getContext());
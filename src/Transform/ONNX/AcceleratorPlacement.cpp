@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- AcceleratorPlacement.cpp - Place ONNX ops on accelerators ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that places each ONNX op on the cheapest of the
+// enabled accelerators able to run it, by setting its `device` attribute to
+// the name of the accelerator in lower case. Every accelerator is asked for
+// the cost of the op with the `getOpCost` hook, so that adding an
+// accelerator does not require changing the other ones.
+//
+// Each accelerator then lowers the ops placed on it, and leaves the other ops
+// to the CPU. An accelerator may refine the placement of its ops, e.g. move
+// them back to the CPU when they are too small, and converts the tensors
+// between its layout and the CPU one at the boundaries of its ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/Support/Debug.h"
+
+#include "src/Accelerators/Accelerator.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Transform/ONNX/ONNXDimAnalysis.hpp"
+
+#define DEBUG_TYPE "accelerator-placement"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+const std::string DEVICE_ATTRIBUTE = "device";
+
+struct AcceleratorPlacementPass
+    : public PassWrapper<AcceleratorPlacementPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(AcceleratorPlacementPass)
+
+  StringRef getArgument() const override { return "accelerator-placement"; }
+
+  StringRef getDescription() const override {
+    return "Place ONNX ops on the cheapest accelerator able to run them.";
+  }
+
+  void runOnOperation() final;
+};
+
+void AcceleratorPlacementPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  MLIRContext *context = &getContext();
+  const llvm::SmallVectorImpl<accel::Accelerator *> &accels =
+      accel::Accelerator::getAccelerators();
+  if (accels.empty())
+    return;
+
+  // Run the unknown dimension analysis to help the accelerators check the
+  // equality of unknown dimensions at compile time.
+  DimAnalysis dimAnalysis(module);
+  dimAnalysis.analyze();
+
+  module.walk([&](Operation *op) {
+    // Ops already placed, e.g. by the user, are kept on their device.
+    if (!isa<ONNXDialect>(op->getDialect()) || isa<ONNXConstantOp>(op) ||
+        op->hasAttr(DEVICE_ATTRIBUTE))
+      return;
+    accel::Accelerator *bestAccel = nullptr;
+    double bestCost = 0;
+    for (accel::Accelerator *accel : accels) {
+      double cost = accel->getOpCost(op, &dimAnalysis);
+      if (cost < 0 || (bestAccel && cost >= bestCost))
+        continue;
+      bestAccel = accel;
+      bestCost = cost;
+    }
+    if (!bestAccel)
+      return;
+    LLVM_DEBUG(llvm::dbgs() << "Place " << op->getName() << " on "
+                            << bestAccel->getName() << ", cost " << bestCost
+                            << " ns\n");
+    op->setAttr(DEVICE_ATTRIBUTE,
+        StringAttr::get(context, StringRef(bestAccel->getName()).lower()));
+  });
+}
+
+} // end anonymous namespace.
+
+std::unique_ptr<Pass> createAcceleratorPlacementPass() {
+  return std::make_unique<AcceleratorPlacementPass>();
+}
+
+} // namespace onnx_mlir
@@ -625,6 +625,113 @@ public:
   }
 };
 
+//===----------------------------------------------------------------------===//
+// Code to perform constant propagation for MatMul and Gemm.
+//===----------------------------------------------------------------------===//
+
+// Maximum number of multiply-adds of a MatMul or Gemm of constants computed at
+// compile time, to bound the compilation time.
+constexpr int64_t maxMatMulConstPropOps = 1LL << 28;
+
+// Check that a matmul of constants producing values of the given type with
+// the given depth K has a static shape, numbers and not too many operations.
+bool isMatMulConstPropCandidate(Value replacingValue, int64_t K) {
+  auto type = replacingValue.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape() ||
+      !type.getElementType().isIntOrFloat() ||
+      type.getElementType().isInteger(1))
+    return false;
+  return type.getNumElements() * K <= maxMatMulConstPropOps;
+}
+
+std::function<WideNum(WideNum)> multiplyBy(Type type, double factor) {
+  return wideZeroDispatchNonBool(type, [factor](auto wideZero) {
+    using WideCppType = decltype(wideZero);
+    return widenumWrapped<WideCppType, WideCppType>([factor](auto x) {
+      return static_cast<WideCppType>(x * factor);
+    });
+  });
+}
+
+class ConstPropMatMulPattern : public OpRewritePattern<ONNXMatMulOp> {
+public:
+  using OpRewritePattern<ONNXMatMulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXMatMulOp matMulOp, PatternRewriter &rewriter) const override {
+    Value A = matMulOp.getA();
+    Value B = matMulOp.getB();
+    Value replacingValue = matMulOp.getResult();
+    if (!isDenseONNXConstant(A) || !isDenseONNXConstant(B))
+      return failure();
+    ElementsAttr lhs = getConstValueElements(A);
+    if (lhs.getType().getRank() == 0 ||
+        !isMatMulConstPropCandidate(
+            replacingValue, lhs.getType().getShape().back()))
+      return failure();
+    ConstPropCounters::count("MatMul", {A, B});
+
+    OnnxElementsAttrBuilder elementsBuilder(rewriter.getContext());
+    ElementsAttr productElements = elementsBuilder.matMul(lhs,
+        getConstValueElements(B),
+        replacingValue.getType().cast<ShapedType>());
+    rewriter.replaceOp(matMulOp,
+        createReplacingConstantOp(rewriter, replacingValue, productElements)
+            .getResult());
+    return success();
+  }
+};
+
+// Y = alpha * A' * B' + beta * C, where A' and B' may be transposed.
+class ConstPropGemmPattern : public OpRewritePattern<ONNXGemmOp> {
+public:
+  using OpRewritePattern<ONNXGemmOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXGemmOp gemmOp, PatternRewriter &rewriter) const override {
+    Value A = gemmOp.getA();
+    Value B = gemmOp.getB();
+    Value C = gemmOp.getC();
+    Value replacingValue = gemmOp.getResult();
+    if (!isDenseONNXConstant(A) || !isDenseONNXConstant(B) ||
+        !(isFromNone(C) || isDenseONNXConstant(C)))
+      return failure();
+    ElementsAttr lhs = getConstValueElements(A);
+    int64_t K = lhs.getType().getShape()[gemmOp.getTransA() ? 0 : 1];
+    if (!isMatMulConstPropCandidate(replacingValue, K))
+      return failure();
+    ConstPropCounters::count("Gemm", {A, B, C});
+
+    OnnxElementsAttrBuilder elementsBuilder(rewriter.getContext());
+    ShapedType replacingType = replacingValue.getType().cast<ShapedType>();
+    Type elemType = replacingType.getElementType();
+    ElementsAttr rhs = getConstValueElements(B);
+    if (gemmOp.getTransA())
+      lhs = elementsBuilder.transpose(lhs, {1, 0});
+    if (gemmOp.getTransB())
+      rhs = elementsBuilder.transpose(rhs, {1, 0});
+    ElementsAttr resultElements =
+        elementsBuilder.matMul(lhs, rhs, replacingType);
+    double alpha = gemmOp.getAlphaAttr().getValueAsDouble();
+    if (alpha != 1.0)
+      resultElements = elementsBuilder.transform(
+          resultElements, elemType, multiplyBy(elemType, alpha));
+    double beta = gemmOp.getBetaAttr().getValueAsDouble();
+    if (!isFromNone(C) && beta != 0.0) {
+      ElementsAttr bias = getConstValueElements(C);
+      if (beta != 1.0)
+        bias = elementsBuilder.transform(
+            bias, elemType, multiplyBy(elemType, beta));
+      resultElements = elementsBuilder.combine(resultElements, bias,
+          replacingType, elementwiseBinaryOpCombiner<ONNXAddOp>(elemType));
+    }
+    rewriter.replaceOp(gemmOp,
+        createReplacingConstantOp(rewriter, replacingValue, resultElements)
+            .getResult());
+    return success();
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // Code to perform constant propagation for CastOp.
 //===----------------------------------------------------------------------===//
@@ -882,6 +989,8 @@ void ConstPropONNXToONNXPass::runOnOperation() {
   patterns.insert<ConstPropSplitPattern>(&getContext());
   patterns.insert<ConstPropSplitV11Pattern>(&getContext());
   patterns.insert<ConstPropScatterNDPattern>(&getContext());
+  patterns.insert<ConstPropMatMulPattern>(&getContext());
+  patterns.insert<ConstPropGemmPattern>(&getContext());
   if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
     signalPassFailure();
 
@@ -332,6 +332,95 @@ public:
     remove(output2);
   }
 
+  // The layout of a contraction of two outputs by MatMul or Gemm: the left
+  // operand is transposed to batch + unshared + reducible subscripts and the
+  // right one to batch + reducible + unshared subscripts, or to their
+  // transposed matrices when a rank 2 Gemm transposes them.
+  struct MatMulPlan {
+    bool swap;   // output2 is the left operand
+    bool transA; // the left operand is reducible + unshared
+    bool transB; // the right operand is unshared + reducible
+    Subscripts batchSubscripts;
+    Subscripts reducibleSubscripts;
+    int64_t cost; // #elements moved by the transposes
+  };
+
+  // Return the subscripts of output that are in set, in their order in output.
+  static Subscripts subscriptsIn(
+      const Output &output, const SubscriptsSet &set) {
+    Subscripts subscripts;
+    for (char x : output.subscripts) {
+      if (set.count(x) != 0)
+        subscripts.push_back(x);
+    }
+    return subscripts;
+  }
+
+  // Choose the operand order and the orders of the batch and reducible
+  // subscripts of a contraction, among the ones of either output, that
+  // minimize the number of elements transposed before the MatMul, and after
+  // it when it is the last contraction and its result is not in the order of
+  // the Einsum result. A rank 2 contraction of floats is computed with a Gemm
+  // that transposes its operands for free.
+  MatMulPlan planMatMul(const Output &output1, const Output &output2,
+      const SubscriptsSet &reducible) const {
+    SubscriptsSet in1 = output1.subscriptsSet();
+    SubscriptsSet in2 = output2.subscriptsSet();
+    SubscriptsSet batch, unshared1, unshared2;
+    for (char x : output1.subscripts) {
+      if (in2.count(x) == 0)
+        unshared1.insert(x);
+      else if (reducible.count(x) == 0)
+        batch.insert(x);
+    }
+    for (char x : output2.subscripts) {
+      if (in1.count(x) == 0)
+        unshared2.insert(x);
+    }
+    bool isLast = outputs.size() == 2;
+    bool canTranspose = batch.empty() && elementType.isa<FloatType>();
+
+    MatMulPlan best;
+    best.cost = -1;
+    for (bool swap : {false, true}) {
+      const Output &left = swap ? output2 : output1;
+      const Output &right = swap ? output1 : output2;
+      Subscripts leftUnshared =
+          subscriptsIn(left, swap ? unshared2 : unshared1);
+      Subscripts rightUnshared =
+          subscriptsIn(right, swap ? unshared1 : unshared2);
+      for (const Output *batchOrder : {&output1, &output2}) {
+        for (const Output *reducibleOrder : {&output1, &output2}) {
+          MatMulPlan plan;
+          plan.swap = swap;
+          plan.batchSubscripts = subscriptsIn(*batchOrder, batch);
+          plan.reducibleSubscripts = subscriptsIn(*reducibleOrder, reducible);
+          const Subscripts &bs = plan.batchSubscripts;
+          const Subscripts &rs = plan.reducibleSubscripts;
+          bool leftInOrder =
+              left.subscripts == Subscripts{bs, leftUnshared, rs};
+          bool rightInOrder =
+              right.subscripts == Subscripts{bs, rs, rightUnshared};
+          plan.transA = !leftInOrder && canTranspose &&
+                        left.subscripts == Subscripts{rs, leftUnshared};
+          plan.transB = !rightInOrder && canTranspose &&
+                        right.subscripts == Subscripts{rightUnshared, rs};
+          plan.cost = 0;
+          if (!leftInOrder && !plan.transA)
+            plan.cost += ShapedType::getNumElements(left.shape);
+          if (!rightInOrder && !plan.transB)
+            plan.cost += ShapedType::getNumElements(right.shape);
+          if (isLast &&
+              result.subscripts != Subscripts{bs, leftUnshared, rightUnshared})
+            plan.cost += ShapedType::getNumElements(result.shape);
+          if (best.cost < 0 || plan.cost < best.cost)
+            best = plan;
+        }
+      }
+    }
+    return best;
+  }
+
   void matmul(
       Output &output1, Output &output2, const SubscriptsSet &reducible) {
     assert(!reducible.empty() && "should call mul() if reducible is empty");
@@ -343,31 +432,31 @@ public:
     // which could be useful to implement Einsum decomposition for types that
     // MatMul doesn't support
 
-    // transpose output1, output2 to put their subscripts in the order:
+    // transpose the left and right operands, output1 and output2 or output2
+    // and output1 as chosen by planMatMul, to put their subscripts in the
+    // order:
     //
-    // output1: sharedKeepSubscripts + subscripts1unshared + reducibleSubscripts
-    // output2: sharedKeepSubscripts + reducibleSubscripts + subscripts2unshared
+    // left: sharedKeepSubscripts + subscripts1unshared + reducibleSubscripts
+    // right: sharedKeepSubscripts + reducibleSubscripts + subscripts2unshared
     //
-    // with sharedKeepSubscripts, reducibleSubscripts in the order they appear
-    // in output1
-    SubscriptsSet in1 = output1.subscriptsSet();
-    SubscriptsSet in2 = output2.subscriptsSet();
-    Subscripts sharedKeepSubscripts;
-    Subscripts reducibleSubscripts;
+    // where subscripts1unshared, subscripts2unshared are the unshared
+    // subscripts of left, right, unless Gemm transposes them
+    MatMulPlan plan = planMatMul(output1, output2, reducible);
+    Output &left = plan.swap ? output2 : output1;
+    Output &right = plan.swap ? output1 : output2;
+    SubscriptsSet in1 = left.subscriptsSet();
+    SubscriptsSet in2 = right.subscriptsSet();
+    const Subscripts &sharedKeepSubscripts = plan.batchSubscripts;
+    const Subscripts &reducibleSubscripts = plan.reducibleSubscripts;
     Subscripts subscripts1unshared;
-    for (char x : output1.subscripts) {
-      if (in2.count(x) == 0) {
+    for (char x : left.subscripts) {
+      if (in2.count(x) == 0)
         subscripts1unshared.push_back(x);
-      } else if (reducible.count(x) != 0) {
-        reducibleSubscripts.push_back(x);
-      } else {
-        sharedKeepSubscripts.push_back(x);
-      }
     }
     assert(reducible.size() == reducibleSubscripts.size() &&
            "reducible subscripts should appear in both outputs");
     Subscripts subscripts2unshared;
-    for (char x : output2.subscripts) {
+    for (char x : right.subscripts) {
       if (in1.count(x) == 0) {
         subscripts2unshared.push_back(x);
       }
@@ -376,23 +465,36 @@ public:
         sharedKeepSubscripts, subscripts1unshared, reducibleSubscripts};
     Subscripts subscripts2transposed{
         sharedKeepSubscripts, reducibleSubscripts, subscripts2unshared};
-    transpose(output1, subscripts1transposed);
-    transpose(output2, subscripts2transposed);
+    if (!plan.transA)
+      transpose(left, subscripts1transposed);
+    if (!plan.transB)
+      transpose(right, subscripts2transposed);
 
     // copy shapes, the ShapeRefs below will point into these copies,
-    // they cannot point into output1.shape and output2.shape because
+    // they cannot point into left.shape and right.shape because
     // they are reshaped before we're done with the ShapeRefs
-    Shape shape1 = output1.shape;
-    Shape shape2 = output2.shape;
-    // read off the shapes corresponding to the transposed subscripts
+    Shape shape1 = left.shape;
+    Shape shape2 = right.shape;
+    // read off the shapes corresponding to the transposed subscripts, the
+    // leading sharedKeep dims being empty when Gemm transposes an operand
     ShapeRef sharedKeep1Shape, unshared1Shape, reducibleShape;
-    std::tie(sharedKeep1Shape, unshared1Shape, reducibleShape) =
-        split3(ArrayRef(shape1), sharedKeepSubscripts.size(),
-            subscripts1unshared.size(), reducibleSubscripts.size());
+    if (plan.transA)
+      std::tie(sharedKeep1Shape, reducibleShape, unshared1Shape) =
+          split3(ArrayRef(shape1), 0, reducibleSubscripts.size(),
+              subscripts1unshared.size());
+    else
+      std::tie(sharedKeep1Shape, unshared1Shape, reducibleShape) =
+          split3(ArrayRef(shape1), sharedKeepSubscripts.size(),
+              subscripts1unshared.size(), reducibleSubscripts.size());
     ShapeRef sharedKeep2Shape, reducible2Shape, unshared2Shape;
-    std::tie(sharedKeep2Shape, reducible2Shape, unshared2Shape) =
-        split3(ArrayRef(shape2), sharedKeepSubscripts.size(),
-            reducibleSubscripts.size(), subscripts2unshared.size());
+    if (plan.transB)
+      std::tie(sharedKeep2Shape, unshared2Shape, reducible2Shape) =
+          split3(ArrayRef(shape2), 0, subscripts2unshared.size(),
+              reducibleSubscripts.size());
+    else
+      std::tie(sharedKeep2Shape, reducible2Shape, unshared2Shape) =
+          split3(ArrayRef(shape2), sharedKeepSubscripts.size(),
+              reducibleSubscripts.size(), subscripts2unshared.size());
     // broadcast not needed because non-result 1-dim axes were squeezed at
     // outset
     assert(
@@ -402,36 +504,44 @@ public:
     int64_t unshared1Size = ShapedType::getNumElements(unshared1Shape);
     int64_t reducibleSize = ShapedType::getNumElements(reducibleShape);
     int64_t unshared2Size = ShapedType::getNumElements(unshared2Shape);
-    Shape reShape1 =
-        shapeConcat(sharedKeep1Shape, {unshared1Size, reducibleSize});
-    Shape reShape2 =
-        shapeConcat(sharedKeep2Shape, {reducibleSize, unshared2Size});
     // left, right are out-of-band subscripts representing
     // unshared1, unshared2 dims
-    const char *left = "(";
-    const char *right = ")";
+    const char *leftSubscript = "(";
+    const char *rightSubscript = ")";
     // red (1st reducible subscript) represents the reshaped reducible dims
     StringRef red = reducibleSubscripts.substr(0, 1);
-    Subscripts reshaped1subscripts{sharedKeepSubscripts, left, red};
-    Subscripts reshaped2subscripts{sharedKeepSubscripts, red, right};
-    reshape(output1, reShape1, reshaped1subscripts);
-    reshape(output2, reShape2, reshaped2subscripts);
+    if (plan.transA)
+      reshape(left, {reducibleSize, unshared1Size}, {red, leftSubscript});
+    else
+      reshape(left,
+          shapeConcat(sharedKeep1Shape, {unshared1Size, reducibleSize}),
+          {sharedKeepSubscripts, leftSubscript, red});
+    if (plan.transB)
+      reshape(right, {unshared2Size, reducibleSize}, {rightSubscript, red});
+    else
+      reshape(right,
+          shapeConcat(sharedKeep2Shape, {reducibleSize, unshared2Size}),
+          {sharedKeepSubscripts, red, rightSubscript});
 
     // matmul
     Shape sharedKeepShape = shapeBroadcast(sharedKeep1Shape, sharedKeep2Shape);
-    output1.subscripts = {sharedKeepSubscripts, left, right};
-    output1.shape =
-        shapeConcat(sharedKeepShape, {unshared1Size, unshared2Size});
-    output1.value = create.onnx.matmul(
-        output1.type(elementType), output1.value, output2.value);
+    left.subscripts = {sharedKeepSubscripts, leftSubscript, rightSubscript};
+    left.shape = shapeConcat(sharedKeepShape, {unshared1Size, unshared2Size});
+    if (plan.transA || plan.transB)
+      left.value = create.onnx.gemm(left.type(elementType), left.value,
+          right.value, create.onnx.none(), /*alpha=*/1.0, /*beta=*/1.0,
+          plan.transA, plan.transB);
+    else
+      left.value = create.onnx.matmul(
+          left.type(elementType), left.value, right.value);
 
     // reshape to get unshared dims back
     Shape shape = shapeConcat(sharedKeepShape, unshared1Shape, unshared2Shape);
     Subscripts subscripts{
         sharedKeepSubscripts, subscripts1unshared, subscripts2unshared};
-    reshape(output1, shape, subscripts);
+    reshape(left, shape, subscripts);
 
-    remove(output2);
+    remove(right);
   }
 
   void contract(Output &output1, Output &output2) {
@@ -455,6 +565,44 @@ public:
     }
   }
 
+  // Return the number of elements of the result of the contraction of the
+  // outputs at i and j, whose subscripts are the ones of the two outputs that
+  // are used by the other outputs or the result.
+  int64_t contractionSize(size_t i, size_t j) {
+    SubscriptsSet keep = otherSubscripts({&outputs[i], &outputs[j]});
+    std::unordered_map<char, int64_t> dims;
+    for (const Output *output : {&outputs[i], &outputs[j]}) {
+      for (size_t a = 0; a < output->size(); ++a) {
+        char x = output->subscripts[a];
+        if (keep.count(x) != 0)
+          dims[x] = std::max(dims[x], output->shape[a]);
+      }
+    }
+    int64_t size = 1;
+    for (const auto &entry : dims) // entry == pair (x, dim)
+      size *= entry.second;
+    return size;
+  }
+
+  // Choose the two outputs to contract next, greedily as the ones whose
+  // contraction has the smallest result, which keeps the intermediate results
+  // and the cost of the contractions that use them small. Ties are broken in
+  // the order of the inputs.
+  std::pair<size_t, size_t> selectContraction() {
+    std::pair<size_t, size_t> best = {0, 1};
+    int64_t bestSize = contractionSize(0, 1);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      for (size_t j = i + 1; j < outputs.size(); ++j) {
+        int64_t size = contractionSize(i, j);
+        if (size < bestSize) {
+          best = {i, j};
+          bestSize = size;
+        }
+      }
+    }
+    return best;
+  }
+
   void finalize() {
     assert(outputs.size() == 1 && "only finalize after all contractions");
     Output &output = outputs[0];
@@ -486,7 +634,9 @@ public:
     }
 
     while (outputs.size() > 1) {
-      contract(outputs[0], outputs[1]);
+      size_t i, j;
+      std::tie(i, j) = selectContraction();
+      contract(outputs[i], outputs[j]);
     }
 
     finalize();
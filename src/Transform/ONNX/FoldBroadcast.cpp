@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------ FoldBroadcast.cpp - ONNX Broadcast Folding Pass ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Models often materialize broadcasts with Expand or Tile ops only to feed
+// elementwise ops, as in
+//   Expand(mask, shape) -> Add(scores, mask)
+// whose lowering writes the whole broadcast tensor to memory before the
+// elementwise op reads it back. This pass replaces such operands of the
+// elementwise ops with multidirectional broadcasting by the inputs of the
+// Expand, or of the Tile when it only repeats dims of size 1, whenever the
+// elementwise op still broadcasts its operands to the same result shape. The
+// lowering of the elementwise op then reads the smaller input directly.
+//
+// The broadcasting elementwise ops of the accelerators may not support all
+// broadcasts. This pass is thus only run when targeting the CPU.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Traits.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return true if the Tile only repeats dims of size 1 of its input, so that it
+// computes the same as an Expand of the input to the output shape.
+bool isBroadcastingTile(ONNXTileOp tileOp) {
+  Type inputType = tileOp.getInput().getType();
+  if (!isRankedShapedType(inputType) ||
+      !isDenseONNXConstant(tileOp.getRepeats()))
+    return false;
+  ArrayRef<int64_t> inputShape = getShape(inputType);
+  ElementsAttr repeats = getElementAttributeFromONNXValue(tileOp.getRepeats());
+  if (repeats.getNumElements() != (int64_t)inputShape.size())
+    return false;
+  for (auto repeat : llvm::enumerate(repeats.getValues<int64_t>())) {
+    if (repeat.value() != 1 && inputShape[repeat.index()] != 1)
+      return false;
+  }
+  return true;
+}
+
+// Return the input broadcast by the Expand or Tile defining `value`, or null
+// if `value` is not defined by such an op.
+Value getBroadcastInput(Value value) {
+  if (auto expandOp = value.getDefiningOp<ONNXExpandOp>())
+    return expandOp.getInput();
+  if (auto tileOp = value.getDefiningOp<ONNXTileOp>())
+    if (isBroadcastingTile(tileOp))
+      return tileOp.getInput();
+  return nullptr;
+}
+
+// Return true if the shapes broadcast to the given one.
+bool broadcastsTo(
+    ArrayRef<SmallVector<int64_t, 4>> shapes, ArrayRef<int64_t> shape) {
+  SmallVector<int64_t, 4> broadcastShape(shapes[0]);
+  for (ArrayRef<int64_t> operandShape : shapes.drop_front()) {
+    SmallVector<int64_t, 4> newShape;
+    if (!OpTrait::util::getBroadcastedShape(
+            broadcastShape, operandShape, newShape))
+      return false;
+    broadcastShape = newShape;
+  }
+  return ArrayRef<int64_t>(broadcastShape) == shape;
+}
+
+/// Rewrite
+/// ```
+///   %m = "onnx.Expand"(%mask, %shape)
+///   %Y = "onnx.Add"(%x, %m)
+/// ```
+/// into
+/// ```
+///   %Y = "onnx.Add"(%x, %mask)
+/// ```
+/// for an elementwise op with multidirectional broadcasting of static shape,
+/// when its operands still broadcast to its result shape. The Expand is
+/// removed once it has no other use.
+template <typename OP>
+struct FoldBroadcastIntoElementwisePattern : public OpRewritePattern<OP> {
+  using OpRewritePattern<OP>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      OP elementwiseOp, PatternRewriter &rewriter) const final {
+    Operation *op = elementwiseOp.getOperation();
+    if (op->getNumResults() != 1)
+      return failure();
+    auto resultType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!resultType || !resultType.hasStaticShape())
+      return failure();
+
+    // Replace the broadcast operands one at a time, as long as the operands
+    // broadcast to the result shape, all of them being ranked.
+    SmallVector<Value, 4> operands(op->getOperands());
+    SmallVector<SmallVector<int64_t, 4>, 4> shapes;
+    for (Value operand : operands) {
+      auto type = operand.getType().dyn_cast<RankedTensorType>();
+      if (!type || !type.hasStaticShape())
+        return failure();
+      shapes.emplace_back(type.getShape());
+    }
+    bool changed = false;
+    for (unsigned i = 0; i < operands.size(); ++i) {
+      Value input = getBroadcastInput(operands[i]);
+      auto inputType =
+          input ? input.getType().dyn_cast<RankedTensorType>() : nullptr;
+      if (!inputType || !inputType.hasStaticShape() ||
+          inputType.getElementType() != getElementType(operands[i].getType()))
+        continue;
+      SmallVector<SmallVector<int64_t, 4>, 4> newShapes(shapes);
+      newShapes[i] = SmallVector<int64_t, 4>(inputType.getShape());
+      if (!broadcastsTo(newShapes, resultType.getShape()))
+        continue;
+      operands[i] = input;
+      shapes = newShapes;
+      changed = true;
+    }
+    if (!changed)
+      return failure();
+    rewriter.updateRootInPlace(op, [&]() { op->setOperands(operands); });
+    return success();
+  }
+};
+
+template <typename OP>
+using BroadcastPattern = FoldBroadcastIntoElementwisePattern<OP>;
+
+struct FoldBroadcastONNXToONNXPass
+    : public PassWrapper<FoldBroadcastONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(FoldBroadcastONNXToONNXPass)
+
+  StringRef getArgument() const override { return "fold-broadcast-onnx"; }
+
+  StringRef getDescription() const override {
+    return "Fold the Expand and Tile ops feeding elementwise ops into their "
+           "implicit broadcast.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    // Elementwise ops with multidirectional broadcasting.
+    patterns.insert<BroadcastPattern<ONNXAddOp>, BroadcastPattern<ONNXAndOp>,
+        BroadcastPattern<ONNXDivOp>, BroadcastPattern<ONNXEqualOp>,
+        BroadcastPattern<ONNXGreaterOp>,
+        BroadcastPattern<ONNXGreaterOrEqualOp>, BroadcastPattern<ONNXLessOp>,
+        BroadcastPattern<ONNXLessOrEqualOp>, BroadcastPattern<ONNXMaxOp>,
+        BroadcastPattern<ONNXMeanOp>, BroadcastPattern<ONNXMinOp>,
+        BroadcastPattern<ONNXModOp>, BroadcastPattern<ONNXMulOp>,
+        BroadcastPattern<ONNXOrOp>, BroadcastPattern<ONNXPowOp>,
+        BroadcastPattern<ONNXSubOp>, BroadcastPattern<ONNXSumOp>,
+        BroadcastPattern<ONNXWhereOp>, BroadcastPattern<ONNXXorOp>>(context);
+    if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a FoldBroadcast pass.
+ */
+std::unique_ptr<mlir::Pass> createFoldBroadcastONNXToONNXPass() {
+  return std::make_unique<FoldBroadcastONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
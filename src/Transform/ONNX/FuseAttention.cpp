@@ -0,0 +1,241 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------- FuseAttention.cpp - ONNX high level Attention Fusion --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file recognizes the scaled dot-product attention of transformers,
+// namely the chain of ops
+//   MatMul(Q, K) -> Mul/Div(scale) -> Add(mask) -> Softmax -> MatMul(V)
+// and rewrites it into an ONNXFusedAttentionOp, whose lowering to Krnl never
+// materializes the scores of all the queries of a head.
+//
+// The fused op has a CPU lowering only. This pass is thus not part of the
+// decomposition of ONNX ops, which is shared with the accelerators.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return the op of type OP defining the value if the value has no other use,
+// or null otherwise.
+template <typename OP>
+OP getSingleUseDefiningOp(Value value) {
+  OP op = value.getDefiningOp<OP>();
+  if (op && op->hasOneUse())
+    return op;
+  return nullptr;
+}
+
+// Get the value of a constant made of a single float.
+bool getScalarFloatConstant(Value value, double &scalar) {
+  ONNXConstantOp constOp = getONNXConstantOp(value);
+  if (!constOp)
+    return false;
+  ElementsAttr attr = constOp.getValueAttr().dyn_cast_or_null<ElementsAttr>();
+  if (!attr || attr.getNumElements() != 1)
+    return false;
+  Type elementType = attr.getElementType();
+  if (!elementType.isF32() && !elementType.isF64())
+    return false;
+  scalar = getScalarValue<double>(constOp, elementType);
+  return true;
+}
+
+// Return the input of a softmax along the innermost axis defining the value,
+// or null.
+Value getInnermostSoftmaxInput(Value value) {
+  Value input;
+  int64_t axis;
+  if (auto softmaxOp = getSingleUseDefiningOp<ONNXSoftmaxOp>(value)) {
+    input = softmaxOp.getInput();
+    axis = softmaxOp.getAxis();
+  } else if (auto softmaxOp =
+                 getSingleUseDefiningOp<ONNXSoftmaxV11Op>(value)) {
+    // The input is coerced into 2D at axis, the same as for opset 13 when
+    // axis is the innermost one.
+    input = softmaxOp.getInput();
+    axis = softmaxOp.getAxis();
+  } else {
+    return nullptr;
+  }
+  if (!hasShapeAndRank(input))
+    return nullptr;
+  int64_t rank = input.getType().cast<ShapedType>().getRank();
+  if (axis < 0)
+    axis += rank;
+  return (axis == rank - 1) ? input : nullptr;
+}
+
+// Return the MatMul(Q, K) of the scores defining the value, optionally
+// multiplied or divided by a scalar constant, and set the scale.
+ONNXMatMulOp getScaledDotProduct(Value value, double &scale) {
+  scale = 1.0;
+  double scalar;
+  if (auto mulOp = getSingleUseDefiningOp<ONNXMulOp>(value)) {
+    if (getScalarFloatConstant(mulOp.getB(), scalar))
+      value = mulOp.getA();
+    else if (getScalarFloatConstant(mulOp.getA(), scalar))
+      value = mulOp.getB();
+    else
+      return nullptr;
+    scale = scalar;
+  } else if (auto divOp = getSingleUseDefiningOp<ONNXDivOp>(value)) {
+    if (!getScalarFloatConstant(divOp.getB(), scalar) || scalar == 0.0)
+      return nullptr;
+    value = divOp.getA();
+    scale = 1.0 / scalar;
+  }
+  return getSingleUseDefiningOp<ONNXMatMulOp>(value);
+}
+
+// Check that Q [B..., S, D], K [B..., D, T] and V [B..., T, Dv] are f32
+// tensors with the same batch dims, and that the mask, if any, is broadcast
+// to the scores [B..., S, T].
+bool areSupportedAttentionOperands(Value Q, Value K, Value V, Value mask) {
+  for (Value val : {Q, K, V}) {
+    if (!isRankedShapedType(val.getType()) ||
+        !getElementType(val.getType()).isF32())
+      return false;
+  }
+  ArrayRef<int64_t> qShape = getShape(Q.getType());
+  ArrayRef<int64_t> kShape = getShape(K.getType());
+  ArrayRef<int64_t> vShape = getShape(V.getType());
+  int64_t rank = qShape.size();
+  if (rank < 2 || (int64_t)kShape.size() != rank ||
+      (int64_t)vShape.size() != rank)
+    return false;
+  // Dims that may be unknown but must not be different. The batch dims are
+  // not broadcast.
+  auto compatible = [](int64_t a, int64_t b) {
+    return ShapedType::isDynamic(a) || ShapedType::isDynamic(b) || a == b;
+  };
+  for (int64_t i = 0; i < rank - 2; ++i)
+    if (!compatible(qShape[i], kShape[i]) || !compatible(qShape[i], vShape[i]))
+      return false;
+  if (!compatible(kShape[rank - 1], vShape[rank - 2]))
+    return false;
+  if (!mask)
+    return true;
+
+  if (!isRankedShapedType(mask.getType()) ||
+      !getElementType(mask.getType()).isF32())
+    return false;
+  ArrayRef<int64_t> maskShape = getShape(mask.getType());
+  int64_t maskRank = maskShape.size();
+  if (maskRank > rank)
+    return false;
+  for (int64_t i = 0; i < maskRank; ++i) {
+    int64_t d = rank - maskRank + i;
+    int64_t scoreDim = (d == rank - 1) ? kShape[d] : qShape[d];
+    if (maskShape[i] != 1 && !compatible(maskShape[i], scoreDim))
+      return false;
+  }
+  return true;
+}
+
+/// Rewrite
+/// ```
+///   %scores = "onnx.MatMul"(%Q, %K)
+///   %scaled = "onnx.Div"(%scores, %c)  // or Mul by a scale, optional
+///   %masked = "onnx.Add"(%scaled, %mask) // optional
+///   %probs = "onnx.Softmax"(%masked) {axis = -1}
+///   %Y = "onnx.MatMul"(%probs, %V)
+/// ```
+/// into
+/// ```
+///   %Y = "onnx.FusedAttention"(%Q, %K, %V, %mask, %none, %none, %none)
+///       {scale = 1 / c}
+/// ```
+/// when the intermediate values have no other use.
+struct FuseAttentionPattern : public OpRewritePattern<ONNXMatMulOp> {
+  using OpRewritePattern<ONNXMatMulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXMatMulOp matMulOp, PatternRewriter &rewriter) const final {
+    Value V = matMulOp.getB();
+    Value scores = getInnermostSoftmaxInput(matMulOp.getA());
+    if (!scores)
+      return failure();
+
+    // Scaled dot product of Q and K, with an optional mask added to it.
+    double scale;
+    Value mask;
+    ONNXMatMulOp qkOp = getScaledDotProduct(scores, scale);
+    if (!qkOp) {
+      ONNXAddOp addOp = getSingleUseDefiningOp<ONNXAddOp>(scores);
+      if (!addOp)
+        return failure();
+      if ((qkOp = getScaledDotProduct(addOp.getA(), scale)))
+        mask = addOp.getB();
+      else if ((qkOp = getScaledDotProduct(addOp.getB(), scale)))
+        mask = addOp.getA();
+      else
+        return failure();
+    }
+    Value Q = qkOp.getA();
+    Value K = qkOp.getB();
+    if (!areSupportedAttentionOperands(Q, K, V, mask))
+      return failure();
+
+    Location loc = matMulOp.getLoc();
+    Value none = rewriter.create<ONNXNoneOp>(loc);
+    if (!mask)
+      mask = none;
+    Value fused = rewriter.create<ONNXFusedAttentionOp>(loc,
+        matMulOp.getResult().getType(), Q, K, V, mask, none, none, none,
+        rewriter.getF32FloatAttr(scale));
+    rewriter.replaceOp(matMulOp, fused);
+    return success();
+  }
+};
+
+struct FuseAttentionONNXToONNXPass
+    : public PassWrapper<FuseAttentionONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(FuseAttentionONNXToONNXPass)
+
+  StringRef getArgument() const override { return "fuse-attention-onnx"; }
+
+  StringRef getDescription() const override {
+    return "Fuse the ONNX ops of scaled dot-product attentions for optimized "
+           "CPU execution.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.insert<FuseAttentionPattern>(context);
+    if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a FuseAttention pass.
+ */
+std::unique_ptr<mlir::Pass> createFuseAttentionONNXToONNXPass() {
+  return std::make_unique<FuseAttentionONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,204 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- FuseConvActivation.cpp - ONNX Conv and Activation Fusion -----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file fuses the pointwise activations following a convolution, namely
+// chains of ops such as
+//   Conv(X, W, B) -> Relu
+//   Conv(X, W, B) -> Clip(min, max)
+// into an ONNXFusedConvOp, whose lowering to Krnl applies the activations to
+// each output value before storing it, saving a sweep over the output tensor
+// per activation. A following Add of a constant is already folded into the
+// bias of the convolution by the canonicalization patterns of ONNXAddOp.
+//
+// The fused op has a CPU lowering only. This pass is thus not part of the
+// decomposition of ONNX ops, which is shared with the accelerators.
+//
+//===----------------------------------------------------------------------===//
+
+#include <limits>
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Activation of a fused convolution, with its parameters.
+struct FusedActivation {
+  StringRef name;
+  float alpha = 0.0;
+  float beta = 0.0;
+};
+
+// Get the value of an optional scalar f32 constant, or the given default
+// value if the value is none.
+bool getOptionalScalarF32Constant(Value value, float defaultValue, float &f) {
+  if (isFromNone(value)) {
+    f = defaultValue;
+    return true;
+  }
+  ONNXConstantOp constOp = getONNXConstantOp(value);
+  if (!constOp)
+    return false;
+  ElementsAttr attr = constOp.getValueAttr().dyn_cast_or_null<ElementsAttr>();
+  if (!attr || attr.getNumElements() != 1 || !attr.getElementType().isF32())
+    return false;
+  f = getScalarValue<double>(constOp, attr.getElementType());
+  return true;
+}
+
+bool getFusedActivation(ONNXReluOp reluOp, FusedActivation &activation) {
+  activation.name = "Relu";
+  return true;
+}
+
+bool getFusedActivation(
+    ONNXLeakyReluOp leakyReluOp, FusedActivation &activation) {
+  activation.name = "LeakyRelu";
+  activation.alpha = leakyReluOp.getAlpha().convertToFloat();
+  return true;
+}
+
+bool getFusedActivation(ONNXClipOp clipOp, FusedActivation &activation) {
+  activation.name = "Clip";
+  return getOptionalScalarF32Constant(clipOp.getMin(),
+             std::numeric_limits<float>::lowest(), activation.alpha) &&
+         getOptionalScalarF32Constant(clipOp.getMax(),
+             std::numeric_limits<float>::max(), activation.beta);
+}
+
+// Get the parameter of the i-th activation of a fused convolution.
+float getActivationParam(Optional<ArrayAttr> params, size_t i) {
+  if (!params.has_value())
+    return 0.0;
+  return params.value()[i].cast<FloatAttr>().getValueAsDouble();
+}
+
+// Return the op of type OP defining the value if the value has no other use,
+// or null otherwise.
+template <typename OP>
+OP getSingleUseDefiningOp(Value value) {
+  OP op = value.getDefiningOp<OP>();
+  if (op && op->hasOneUse())
+    return op;
+  return nullptr;
+}
+
+/// Rewrite
+/// ```
+///   %conv = "onnx.Conv"(%X, %W, %B) {...}
+///   %Y = "onnx.Relu"(%conv)
+/// ```
+/// into
+/// ```
+///   %Y = "onnx.FusedConv"(%X, %W, %B) {..., activations = ["Relu"]}
+/// ```
+/// when the convolution has no other use, and similarly append the activation
+/// to the ones of an onnx.FusedConv.
+template <typename ACTIVATION_OP>
+struct FuseConvActivationPattern : public OpRewritePattern<ACTIVATION_OP> {
+  using OpRewritePattern<ACTIVATION_OP>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ACTIVATION_OP activationOp, PatternRewriter &rewriter) const final {
+    Value input = activationOp->getOperand(0);
+    // The parameters of the activations are f32 attributes.
+    if (!isRankedShapedType(input.getType()) ||
+        !getElementType(input.getType()).isF32())
+      return failure();
+    FusedActivation activation;
+    if (!getFusedActivation(activationOp, activation))
+      return failure();
+
+    // The activations of the convolution, if already fused, followed by this
+    // one.
+    Operation *conv = getSingleUseDefiningOp<ONNXConvOp>(input);
+    if (!conv)
+      conv = getSingleUseDefiningOp<ONNXFusedConvOp>(input);
+    if (!conv)
+      return failure();
+    SmallVector<Attribute, 2> activations;
+    SmallVector<float, 2> alphas, betas;
+    if (auto fusedConvOp = llvm::dyn_cast<ONNXFusedConvOp>(conv)) {
+      Optional<ArrayAttr> alphaOpt = fusedConvOp.getActivationAlpha();
+      Optional<ArrayAttr> betaOpt = fusedConvOp.getActivationBeta();
+      for (auto act : llvm::enumerate(fusedConvOp.getActivations())) {
+        activations.emplace_back(act.value());
+        alphas.emplace_back(getActivationParam(alphaOpt, act.index()));
+        betas.emplace_back(getActivationParam(betaOpt, act.index()));
+      }
+    }
+    activations.emplace_back(rewriter.getStringAttr(activation.name));
+    alphas.emplace_back(activation.alpha);
+    betas.emplace_back(activation.beta);
+
+    // ONNXConvOp and ONNXFusedConvOp have the same operands and convolution
+    // attributes.
+    NamedAttrList attrs(conv->getAttrDictionary());
+    attrs.set("activations", rewriter.getArrayAttr(activations));
+    attrs.set("activation_alpha", rewriter.getF32ArrayAttr(alphas));
+    attrs.set("activation_beta", rewriter.getF32ArrayAttr(betas));
+    Location loc =
+        rewriter.getFusedLoc({conv->getLoc(), activationOp.getLoc()});
+    Value fused = rewriter.create<ONNXFusedConvOp>(loc,
+        activationOp.getResult().getType(), conv->getOperands(),
+        attrs.getAttrs());
+    rewriter.replaceOp(activationOp, fused);
+    rewriter.eraseOp(conv);
+    return success();
+  }
+};
+
+struct FuseConvActivationONNXToONNXPass
+    : public PassWrapper<FuseConvActivationONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(
+      FuseConvActivationONNXToONNXPass)
+
+  StringRef getArgument() const override {
+    return "fuse-conv-activation-onnx";
+  }
+
+  StringRef getDescription() const override {
+    return "Fuse the pointwise activations following convolutions for "
+           "optimized CPU execution.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.insert<FuseConvActivationPattern<ONNXReluOp>,
+        FuseConvActivationPattern<ONNXLeakyReluOp>,
+        FuseConvActivationPattern<ONNXClipOp>>(context);
+    if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a FuseConvActivation pass.
+ */
+std::unique_ptr<mlir::Pass> createFuseConvActivationONNXToONNXPass() {
+  return std::make_unique<FuseConvActivationONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- HalfPrecisionWeights.cpp - Store MatMul weights in f16/bf16 -----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that stores the f32 constant weights of the
+// MatMul ops in f16 or bf16, followed by a Cast back to f32. The CPU lowering
+// of MatMul reads the weights before the Cast and widens them to f32 as they
+// are loaded, so that the computations stay in f32 while the weights take
+// half of the memory and of the memory bandwidth.
+//
+// The constants are cast lazily by the elements builder, the pass must thus
+// run before the DisposableElementsAttrs are scrubbed, and after the constant
+// propagation, which would fold the Casts back into f32 constants.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/OnnxElementsAttrBuilder.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return true if the constant is an f32 tensor used only as the B operand of
+// MatMul ops.
+bool isMatMulWeight(ONNXConstantOp constOp) {
+  Value weight = constOp.getResult();
+  auto type = weight.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.getElementType().isF32() ||
+      !constOp.getValueAttr().isa_and_nonnull<ElementsAttr>() ||
+      weight.use_empty())
+    return false;
+  return llvm::all_of(weight.getUses(), [&](OpOperand &use) {
+    auto matMulOp = dyn_cast<ONNXMatMulOp>(use.getOwner());
+    return matMulOp && use.getOperandNumber() == 1 &&
+           matMulOp.getA() != weight;
+  });
+}
+
+struct HalfPrecisionWeightsPass
+    : public PassWrapper<HalfPrecisionWeightsPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(HalfPrecisionWeightsPass)
+
+  StringRef getArgument() const override { return "half-precision-weights"; }
+
+  StringRef getDescription() const override {
+    return "Store the f32 constant weights of MatMul ops in f16 or bf16.";
+  }
+
+  Option<std::string> weightType{*this, "weight-type",
+      llvm::cl::desc("Element type of the stored weights, f16 or bf16"),
+      llvm::cl::init("f16")};
+
+  HalfPrecisionWeightsPass() = default;
+  HalfPrecisionWeightsPass(const HalfPrecisionWeightsPass &pass)
+      : PassWrapper<HalfPrecisionWeightsPass, OperationPass<func::FuncOp>>() {}
+  HalfPrecisionWeightsPass(const std::string &weightType) {
+    this->weightType = weightType;
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    Type halfType;
+    if (weightType == "f16")
+      halfType = FloatType::getF16(context);
+    else if (weightType == "bf16")
+      halfType = FloatType::getBF16(context);
+    else {
+      function.emitError("unsupported type of the weights: ") << weightType;
+      return signalPassFailure();
+    }
+
+    SmallVector<ONNXConstantOp, 8> weights;
+    function.walk([&](ONNXConstantOp constOp) {
+      if (isMatMulWeight(constOp))
+        weights.emplace_back(constOp);
+    });
+
+    OnnxElementsAttrBuilder elementsBuilder(context);
+    Type f32Type = FloatType::getF32(context);
+    for (ONNXConstantOp constOp : weights) {
+      OpBuilder builder(constOp);
+      MultiDialectBuilder<OnnxBuilder> create(builder, constOp.getLoc());
+      ElementsAttr halfElements = elementsBuilder.castElementType(
+          constOp.getValueAttr().cast<ElementsAttr>(), halfType);
+      Value halfWeight = create.onnx.constant(halfElements);
+      Value weight = create.onnx.cast(halfWeight, TypeAttr::get(f32Type));
+      constOp.getResult().replaceAllUsesWith(weight);
+      constOp.erase();
+    }
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a HalfPrecisionWeights pass.
+ */
+std::unique_ptr<mlir::Pass> createHalfPrecisionWeightsPass() {
+  return std::make_unique<HalfPrecisionWeightsPass>();
+}
+
+std::unique_ptr<mlir::Pass> createHalfPrecisionWeightsPass(
+    const std::string &weightType) {
+  return std::make_unique<HalfPrecisionWeightsPass>(weightType);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,270 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---------- MemoizeSubgraphs.cpp - Memoize Invariant Subgraphs --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Models often compute tables from the shapes of their inputs, such as the
+// positional encodings of the sequence length, or from inputs that rarely
+// change between calls, such as attention masks from a static configuration,
+// and recompute them at every call. This pass finds, in each entry point
+// function, the ops only depending on
+//   - the shapes of the inputs, through onnx.Shape, onnx.Size or onnx.Dim of
+//     the arguments of the function,
+//   - the inputs marked as slowly changing by the `inputs` option,
+//   - constants,
+// and moves the ones computing values used by the rest of the function into
+// the body of an onnx.Memo keyed by the shapes and inputs they depend on. The
+// runtime then caches the results of the memo across calls, computing its body
+// only for the keys missing from the cache.
+//
+// The values cheap to recompute, of static shape and of at most
+// kMaxCheapElements elements such as the shapes given to Reshape, are left
+// out of the memos, so that the lowering of their users still sees the ops
+// computing them. A memo is only created for at least kMinMemoOps ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/SetVector.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+const int64_t kMaxCheapElements = 64;
+const int64_t kMinMemoOps = 2;
+
+// Return true if the value can be cached by the runtime: a ranked tensor of
+// numbers.
+bool isCacheable(Value value) {
+  auto tensorType = value.getType().dyn_cast<RankedTensorType>();
+  return tensorType && !tensorType.getElementType().isa<ONNXStringType>();
+}
+
+// Return true if the value is cheap enough to be recomputed at each call.
+bool isCheap(Value value) {
+  auto tensorType = value.getType().cast<RankedTensorType>();
+  return tensorType.hasStaticShape() &&
+         tensorType.getNumElements() <= kMaxCheapElements;
+}
+
+// Return true if the op reads the shape of an argument of the function.
+bool isShapeOfArgument(Operation *op) {
+  if (!isa<ONNXShapeOp, ONNXSizeOp, ONNXDimOp>(op))
+    return false;
+  return op->getOperand(0).isa<BlockArgument>() &&
+         op->getOperand(0).getParentBlock()->isEntryBlock() &&
+         isa<func::FuncOp>(op->getParentOp());
+}
+
+// Return true if the op computes the same results from the same operands, and
+// can thus be moved into a memo.
+bool isMemoizable(Operation *op) {
+  if (!isa_and_nonnull<ONNXDialect>(op->getDialect()) ||
+      op->getNumRegions() != 0 || !isMemoryEffectFree(op) ||
+      op->getNumResults() == 0)
+    return false;
+  if (isa<ONNXBernoulliOp, ONNXCallOp, ONNXCustomOp, ONNXDropoutOp,
+          ONNXMultinomialOp, ONNXRandomNormalOp, ONNXRandomNormalLikeOp,
+          ONNXRandomUniformOp, ONNXRandomUniformLikeOp>(op))
+    return false;
+  return llvm::all_of(op->getResults(), isCacheable);
+}
+
+struct MemoizeSubgraphsPass
+    : public PassWrapper<MemoizeSubgraphsPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(MemoizeSubgraphsPass)
+
+  StringRef getArgument() const override { return "memoize-subgraphs"; }
+
+  StringRef getDescription() const override {
+    return "Cache across calls the values only depending on the shapes of the "
+           "inputs and on the slowly changing inputs.";
+  }
+
+  Option<std::string> inputs{*this, "inputs",
+      llvm::cl::desc("Indices of the slowly changing inputs of the entry "
+                     "points separated by \",\""),
+      llvm::cl::init("")};
+
+  MemoizeSubgraphsPass() = default;
+  MemoizeSubgraphsPass(const MemoizeSubgraphsPass &pass)
+      : PassWrapper<MemoizeSubgraphsPass, OperationPass<ModuleOp>>() {}
+  MemoizeSubgraphsPass(const std::string &inputs) { this->inputs = inputs; }
+
+  void runOnOperation() final;
+
+private:
+  void memoizeFunction(func::FuncOp funcOp,
+      const llvm::SmallDenseSet<unsigned, 4> &slowInputs, int64_t &nextId);
+};
+
+void MemoizeSubgraphsPass::memoizeFunction(func::FuncOp funcOp,
+    const llvm::SmallDenseSet<unsigned, 4> &slowInputs, int64_t &nextId) {
+  Block &body = funcOp.getBody().front();
+
+  // The values only depending on the keys and on constants, and the ops
+  // computing them that may be moved into the memo.
+  DenseSet<Value> invariants;
+  DenseSet<Operation *> candidates;
+  for (BlockArgument arg : body.getArguments())
+    if (slowInputs.contains(arg.getArgNumber()) && isCacheable(arg))
+      invariants.insert(arg);
+  for (Operation &op : body.without_terminator()) {
+    bool isInvariant = false;
+    if (op.hasTrait<OpTrait::ConstantLike>() || isShapeOfArgument(&op)) {
+      isInvariant = true;
+    } else if (isMemoizable(&op) &&
+               llvm::all_of(op.getOperands(),
+                   [&](Value v) { return invariants.contains(v); })) {
+      isInvariant = true;
+      candidates.insert(&op);
+    }
+    if (isInvariant)
+      invariants.insert(op.result_begin(), op.result_end());
+  }
+
+  // The ops of the memo compute the invariant values worth caching that are
+  // used by the rest of the function, and their operands.
+  auto isUsedOutside = [&](Value value) {
+    return llvm::any_of(value.getUsers(),
+        [&](Operation *user) { return !candidates.contains(user); });
+  };
+  SmallVector<Operation *, 16> worklist;
+  for (Operation *op : candidates)
+    if (llvm::any_of(op->getResults(),
+            [&](Value v) { return isUsedOutside(v) && !isCheap(v); }))
+      worklist.emplace_back(op);
+  DenseSet<Operation *> memoOps;
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!memoOps.insert(op).second)
+      continue;
+    for (Value operand : op->getOperands())
+      if (Operation *def = operand.getDefiningOp())
+        if (candidates.contains(def))
+          worklist.emplace_back(def);
+  }
+  if ((int64_t)memoOps.size() < kMinMemoOps)
+    return;
+
+  // Collect the ops in order, their keys, and their results used outside.
+  SmallVector<Operation *, 16> orderedOps;
+  llvm::SetVector<Value> keys;
+  SmallVector<Value, 4> outputs;
+  for (Operation &op : body.without_terminator()) {
+    if (!memoOps.contains(&op))
+      continue;
+    orderedOps.emplace_back(&op);
+    for (Value operand : op.getOperands()) {
+      Operation *def = operand.getDefiningOp();
+      if (def && (memoOps.contains(def) ||
+                     def->hasTrait<OpTrait::ConstantLike>()))
+        continue;
+      keys.insert(operand);
+    }
+    for (Value result : op.getResults())
+      if (llvm::any_of(result.getUsers(),
+              [&](Operation *user) { return !memoOps.contains(user); }))
+        outputs.emplace_back(result);
+  }
+  if (keys.empty())
+    return;
+
+  // The memo replaces its first op. The shapes and constants it uses are
+  // moved before it, their operands being arguments of the function.
+  Operation *first = orderedOps.front();
+  for (Operation *op : orderedOps)
+    for (Value operand : op->getOperands())
+      if (Operation *def = operand.getDefiningOp())
+        if (!memoOps.contains(def) && first->isBeforeInBlock(def))
+          def->moveBefore(first);
+
+  SmallVector<Location, 16> locs;
+  for (Operation *op : orderedOps)
+    locs.emplace_back(op->getLoc());
+  OpBuilder builder(first);
+  Location loc = builder.getFusedLoc(locs);
+  SmallVector<Type, 4> outputTypes;
+  for (Value output : outputs)
+    outputTypes.emplace_back(output.getType());
+  auto memoOp = builder.create<ONNXMemoOp>(loc, outputTypes,
+      keys.getArrayRef(),
+      builder.getIntegerAttr(
+          builder.getIntegerType(64, /*isSigned=*/true), nextId++));
+  Block *memoBody = builder.createBlock(&memoOp.getBody());
+  for (Operation *op : orderedOps)
+    op->moveBefore(memoBody, memoBody->end());
+  builder.setInsertionPointToEnd(memoBody);
+  builder.create<ONNXReturnOp>(loc, outputs);
+  for (auto [output, result] : llvm::zip(outputs, memoOp.getResults()))
+    output.replaceUsesWithIf(result,
+        [&](OpOperand &use) { return !memoOp->isAncestor(use.getOwner()); });
+}
+
+void MemoizeSubgraphsPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SymbolTable symbolTable(module);
+
+  llvm::SmallDenseSet<unsigned, 4> slowInputs;
+  SmallVector<StringRef, 4> indexStrs;
+  StringRef(inputs).split(indexStrs, ',', -1, /*KeepEmpty=*/false);
+  for (StringRef indexStr : indexStrs) {
+    unsigned index;
+    if (indexStr.trim().getAsInteger(10, index)) {
+      module.emitError("invalid inputs option: ") << inputs;
+      return signalPassFailure();
+    }
+    slowInputs.insert(index);
+  }
+
+  // The ids of the memos are unique in the module.
+  int64_t nextId = 0;
+  module.walk([&](ONNXMemoOp memoOp) {
+    nextId = std::max(nextId, memoOp.getId() + 1);
+  });
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    if (funcOp && !funcOp.isExternal())
+      memoizeFunction(funcOp, slowInputs, nextId);
+  }
+}
+
+} // namespace
+
+/*!
+ * Create a MemoizeSubgraphs pass.
+ */
+std::unique_ptr<mlir::Pass> createMemoizeSubgraphsPass() {
+  return std::make_unique<MemoizeSubgraphsPass>();
+}
+
+std::unique_ptr<mlir::Pass> createMemoizeSubgraphsPass(
+    const std::string &inputs) {
+  return std::make_unique<MemoizeSubgraphsPass>(inputs);
+}
+
+} // namespace onnx_mlir
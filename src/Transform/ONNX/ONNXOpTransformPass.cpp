@@ -15,7 +15,8 @@
 
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/Passes.h"
-#include "llvm/Support/raw_sha1_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 
 #include "src/Dialect/ONNX/ONNXOps.hpp"
 #include "src/Pass/Passes.hpp"
@@ -62,23 +63,50 @@ struct ONNXOpTransformPass : public mlir::PassWrapper<ONNXOpTransformPass,
   void runOnOperation() final;
 
 private:
+  // Return a hash of the structure of the module, made of the names,
+  // attributes, operands and result types of its ops, in order, without
+  // printing it. The attributes and types are uniqued by the context and
+  // hashed by identity, so that large constants are never read. The values
+  // and blocks are numbered in the order they are first seen.
   uint64_t createTagForIR(mlir::ModuleOp module) {
-    // NOTE: This is slow for real models because they contain large
-    // constant tensors that are expensive to print. A workaround is to
-    // elide them from printing with --mlir-elide-elementsattrs-if-larger=1
-    //
-    // TODO: Hash without printing to speed this up, e.g. along the lines of
-    // how blocks are hashed in mlir/lib/Transforms/Utils/RegionUtils.cpp
-    llvm::raw_sha1_ostream sha1_ostream;
-    module->print(sha1_ostream, mlir::OpPrintingFlags());
-    std::array<uint8_t, 20> sha1 = sha1_ostream.sha1();
-    return *reinterpret_cast<uint64_t *>(sha1.data());
+    llvm::DenseMap<Value, unsigned> valueNumbers;
+    llvm::DenseMap<Block *, unsigned> blockNumbers;
+    auto getNumber = [&](Value value) {
+      return valueNumbers.try_emplace(value, valueNumbers.size()).first->second;
+    };
+    auto getBlockNumber = [&](Block *block) {
+      return blockNumbers.try_emplace(block, blockNumbers.size()).first->second;
+    };
+    llvm::hash_code hash(0);
+    module->walk<WalkOrder::PreOrder>([&](Operation *op) {
+      hash = llvm::hash_combine(hash, op->getName(), op->getAttrDictionary(),
+          op->getNumOperands(), op->getNumResults(), op->getNumRegions());
+      for (Value operand : op->getOperands())
+        hash = llvm::hash_combine(hash, getNumber(operand));
+      for (Value result : op->getResults())
+        hash = llvm::hash_combine(hash, getNumber(result), result.getType());
+      for (Block *successor : op->getSuccessors())
+        hash = llvm::hash_combine(hash, getBlockNumber(successor));
+      for (Region &region : op->getRegions()) {
+        hash = llvm::hash_combine(hash, region.getBlocks().size());
+        for (Block &block : region) {
+          hash = llvm::hash_combine(
+              hash, getBlockNumber(&block), block.getNumArguments());
+          for (BlockArgument arg : block.getArguments())
+            hash = llvm::hash_combine(hash, getNumber(arg), arg.getType());
+        }
+      }
+    });
+    return static_cast<size_t>(hash);
   }
 };
 
 void ONNXOpTransformPass::runOnOperation() {
   auto module = getOperation();
 
+  // Only infer the shapes of the ops changed since the previous iterations.
+  std::shared_ptr<onnx_mlir::ShapeInferenceCache> shapeInferenceCache =
+      onnx_mlir::createShapeInferenceCache();
   uint64_t currentTag = createTagForIR(module);
   uint64_t previousTag;
   int n = onnxOpTransformThreshold;
@@ -87,15 +115,29 @@ void ONNXOpTransformPass::runOnOperation() {
     OpPassManager dynamicPM("builtin.module");
     dynamicPM.addNestedPass<func::FuncOp>(
         onnx_mlir::createDecomposeONNXToONNXPass());
-    dynamicPM.addPass(onnx_mlir::createShapeInferencePass());
+    dynamicPM.addPass(
+        onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
     dynamicPM.addPass(mlir::createCanonicalizerPass());
-    dynamicPM.addPass(onnx_mlir::createShapeInferencePass());
+    dynamicPM.addPass(
+        onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
+    dynamicPM.addNestedPass<func::FuncOp>(
+        onnx_mlir::createSinkTransposeONNXToONNXPass());
     // Convolution Optimization currently only for CPU.
     if (onnxOpTransformTargetCPU) {
       dynamicPM.addNestedPass<func::FuncOp>(
           onnx_mlir::createConvOptONNXToONNXPass(
               onnxOpTransformEnableSimdDataLayout));
-      dynamicPM.addPass(onnx_mlir::createShapeInferencePass());
+      dynamicPM.addPass(
+          onnx_mlir::createShapeInferencePass(false, shapeInferenceCache));
+      if (onnxOpTransformEnableSimdDataLayout)
+        dynamicPM.addNestedPass<func::FuncOp>(
+            onnx_mlir::createPropagateSimdDataLayoutONNXToONNXPass());
+      dynamicPM.addNestedPass<func::FuncOp>(
+          onnx_mlir::createFuseAttentionONNXToONNXPass());
+      dynamicPM.addNestedPass<func::FuncOp>(
+          onnx_mlir::createFuseConvActivationONNXToONNXPass());
+      dynamicPM.addNestedPass<func::FuncOp>(
+          onnx_mlir::createFoldBroadcastONNXToONNXPass());
     }
     dynamicPM.addNestedPass<func::FuncOp>(
         onnx_mlir::createConstPropONNXToONNXPass());
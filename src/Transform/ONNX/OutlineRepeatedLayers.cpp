@@ -0,0 +1,397 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- OutlineRepeatedLayers.cpp - Outline the repeated model layers ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that outlines the repeated layers of a model,
+// such as the encoder layers of a transformer, into a function called by each
+// of them, so that the layer is lowered and compiled once instead of once per
+// repetition. A layer is a sequence of ops repeated back to back, the ops of
+// each repetition having the same name, attributes and types and being wired
+// the same way, the repetitions only differing by the values they take from
+// outside of the layer: the activations computed by the previous layer and
+// the weights of the layer, as in
+//   %y0 = "onnx.MatMul"(%x, %w0)   %y1 = "onnx.MatMul"(%z0, %w1)
+//   %z0 = "onnx.Relu"(%y0)         %z1 = "onnx.Relu"(%y1)
+// outlined into
+//   func.func private @main_graph_layer0(%x, %w) { ... }
+//   %z0 = call @main_graph_layer0(%x, %w0)
+//   %z1 = call @main_graph_layer0(%z0, %w1)
+// The constants used by every repetition are cloned into the function, the
+// other values are passed as arguments. The layer is outlined once its values
+// returned to the caller, namely its values used after it, are tensors of
+// static shapes.
+//
+// The outlined functions are marked with the onnx-mlir.outlined_layer unit
+// attribute, so that their results are passed as output arguments once
+// lowered to Krnl, see the outlined-layer-out-params pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Debug.h"
+
+#include <set>
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+#define DEBUG_TYPE "outline-repeated-layers"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+const std::string OUTLINED_LAYER_ATTRIBUTE = "onnx-mlir.outlined_layer";
+
+// A range of ops made of numBlocks repetitions of length ops.
+struct LayerCandidate {
+  size_t start;
+  size_t length;
+  size_t numBlocks;
+};
+
+// The values taken from outside of a block of ops, in the order of their first
+// use.
+struct ExternalValues {
+  SmallVector<Value, 16> values;
+  DenseMap<Value, size_t> indices;
+
+  // Add a value if new and return its index.
+  size_t insert(Value value) {
+    auto [it, inserted] = indices.try_emplace(value, values.size());
+    if (inserted)
+      values.emplace_back(value);
+    return it->second;
+  }
+};
+
+// Return true if an op can be part of an outlined layer: an ONNX op without
+// regions nor memory effects.
+bool isOutlinable(Operation *op) {
+  return isa_and_nonnull<ONNXDialect>(op->getDialect()) &&
+         op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+
+// Return true if an op is the same as the other one, up to its operands and
+// the name of its node.
+bool isSameOp(Operation *op, Operation *other) {
+  if (op->getName() != other->getName() ||
+      op->getNumOperands() != other->getNumOperands() ||
+      op->getResultTypes() != other->getResultTypes() ||
+      op->getOperandTypes() != other->getOperandTypes())
+    return false;
+  SmallVector<NamedAttribute, 4> attrs, otherAttrs;
+  for (NamedAttribute attr : op->getAttrs())
+    if (attr.getName() != "onnx_node_name")
+      attrs.emplace_back(attr);
+  for (NamedAttribute attr : other->getAttrs())
+    if (attr.getName() != "onnx_node_name")
+      otherAttrs.emplace_back(attr);
+  return attrs == otherAttrs;
+}
+
+// Return the hash of an op consistent with isSameOp.
+llvm::hash_code hashOp(Operation *op) {
+  llvm::hash_code hash = llvm::hash_combine(op->getName(),
+      op->getNumOperands(), op->getNumResults());
+  for (NamedAttribute attr : op->getAttrs())
+    if (attr.getName() != "onnx_node_name")
+      hash = llvm::hash_combine(hash, attr.getName(), attr.getValue());
+  for (Type type : op->getResultTypes())
+    hash = llvm::hash_combine(hash, type);
+  for (Type type : op->getOperandTypes())
+    hash = llvm::hash_combine(hash, type);
+  return hash;
+}
+
+struct OutlineRepeatedLayersPass
+    : public PassWrapper<OutlineRepeatedLayersPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OutlineRepeatedLayersPass)
+
+  StringRef getArgument() const override { return "outline-repeated-layers"; }
+
+  StringRef getDescription() const override {
+    return "Outline the repeated layers of the model into functions.";
+  }
+
+  Option<int> minLayerOps{*this, "min-layer-ops",
+      llvm::cl::desc("Minimum number of ops of an outlined layer"),
+      llvm::cl::init(8)};
+
+  OutlineRepeatedLayersPass() = default;
+  OutlineRepeatedLayersPass(const OutlineRepeatedLayersPass &pass)
+      : PassWrapper<OutlineRepeatedLayersPass, OperationPass<ModuleOp>>() {}
+
+  void runOnOperation() final;
+
+private:
+  // Outline the layer repeated the most times, weighted by its number of ops,
+  // of a function. Return failure if no layer is outlined.
+  LogicalResult outlineLayer(SymbolTable &symbolTable, func::FuncOp funcOp);
+
+  // Outline the repetitions of a candidate layer, or its leading ones if the
+  // following ones are wired differently. Return failure if fewer than 2
+  // repetitions are outlined.
+  LogicalResult outlineCandidate(SymbolTable &symbolTable, func::FuncOp funcOp,
+      ArrayRef<Operation *> ops, const LayerCandidate &candidate);
+};
+
+LogicalResult OutlineRepeatedLayersPass::outlineLayer(
+    SymbolTable &symbolTable, func::FuncOp funcOp) {
+  // Number the ops of the function by their class of identical ops, an op
+  // that cannot be outlined being alone in its class.
+  SmallVector<Operation *, 64> ops;
+  SmallVector<int64_t, 64> classes;
+  DenseMap<size_t, SmallVector<std::pair<Operation *, int64_t>, 1>>
+      classesByHash;
+  int64_t numClasses = 0;
+  for (Operation &op : funcOp.front().without_terminator()) {
+    if (op.hasTrait<OpTrait::ConstantLike>())
+      continue;
+    ops.emplace_back(&op);
+    if (!isOutlinable(&op)) {
+      classes.emplace_back(numClasses++);
+      continue;
+    }
+    auto &bucket = classesByHash[static_cast<size_t>(hashOp(&op))];
+    auto it = llvm::find_if(
+        bucket, [&](auto &entry) { return isSameOp(entry.first, &op); });
+    if (it == bucket.end()) {
+      bucket.emplace_back(&op, numClasses);
+      classes.emplace_back(numClasses++);
+    } else {
+      classes.emplace_back(it->second);
+    }
+  }
+
+  // For each layer length, find the longest range repeating a sequence of
+  // that length, namely the longest run of ops identical to the op following
+  // them by that length.
+  size_t numOps = ops.size();
+  SmallVector<LayerCandidate, 8> candidates;
+  for (size_t length = std::max<int>(minLayerOps, 1); 2 * length <= numOps;
+       ++length) {
+    LayerCandidate best = {0, length, 0};
+    size_t runStart = 0;
+    for (size_t i = 0; i + length <= numOps; ++i) {
+      if (i + length < numOps && classes[i] == classes[i + length])
+        continue;
+      size_t numBlocks = (i - runStart + length) / length;
+      if (numBlocks > best.numBlocks)
+        best = {runStart, length, numBlocks};
+      runStart = i + 1;
+    }
+    if (best.numBlocks >= 2)
+      candidates.emplace_back(best);
+  }
+  // Try the candidates saving the most ops first.
+  llvm::stable_sort(candidates, [](const auto &a, const auto &b) {
+    return (a.numBlocks - 1) * a.length > (b.numBlocks - 1) * b.length;
+  });
+  for (const LayerCandidate &candidate : candidates)
+    if (succeeded(outlineCandidate(symbolTable, funcOp, ops, candidate)))
+      return success();
+  return failure();
+}
+
+LogicalResult OutlineRepeatedLayersPass::outlineCandidate(
+    SymbolTable &symbolTable, func::FuncOp funcOp, ArrayRef<Operation *> ops,
+    const LayerCandidate &candidate) {
+  size_t length = candidate.length;
+  auto getBlockOps = [&](size_t b) {
+    return ops.slice(candidate.start + b * length, length);
+  };
+  // The block and position in the block of each op of the candidate.
+  DenseMap<Operation *, std::pair<size_t, size_t>> positions;
+  for (size_t b = 0; b < candidate.numBlocks; ++b)
+    for (auto [p, op] : llvm::enumerate(getBlockOps(b)))
+      positions[op] = {b, p};
+
+  // The values taken from outside of each block, in the order of their first
+  // use, and the blocks wired as the first one.
+  auto isInBlock = [&](Value value, size_t b) {
+    auto it = positions.find(value.getDefiningOp());
+    return it != positions.end() && it->second.first == b;
+  };
+  SmallVector<ExternalValues, 8> externals;
+  size_t numBlocks = 0;
+  for (size_t b = 0; b < candidate.numBlocks; ++b) {
+    ExternalValues blockExternals;
+    bool isWiredAsFirst = true;
+    for (auto [p, op] : llvm::enumerate(getBlockOps(b))) {
+      Operation *firstOp = getBlockOps(0)[p];
+      for (auto [operand, firstOperand] :
+          llvm::zip(op->getOperands(), firstOp->getOperands())) {
+        bool isInternal = isInBlock(operand, b);
+        if (isInternal != isInBlock(firstOperand, 0)) {
+          isWiredAsFirst = false;
+          break;
+        }
+        if (isInternal) {
+          auto result = operand.cast<OpResult>();
+          auto firstResult = firstOperand.cast<OpResult>();
+          if (positions[result.getOwner()].second !=
+                  positions[firstResult.getOwner()].second ||
+              result.getResultNumber() != firstResult.getResultNumber()) {
+            isWiredAsFirst = false;
+            break;
+          }
+          continue;
+        }
+        // Each value taken from outside of the block must be used where the
+        // first block uses the same value.
+        size_t index = blockExternals.insert(operand);
+        if (b > 0 && externals[0].indices.lookup(firstOperand) != index) {
+          isWiredAsFirst = false;
+          break;
+        }
+      }
+      if (!isWiredAsFirst)
+        break;
+    }
+    if (!isWiredAsFirst)
+      break;
+    externals.emplace_back(std::move(blockExternals));
+    ++numBlocks;
+  }
+  if (numBlocks < 2)
+    return failure();
+
+  // The results of the layer: the positions of the values of a block used
+  // outside of it, by the following ops or by the return of the function.
+  Block &body = funcOp.front();
+  std::set<std::pair<size_t, unsigned>> outputs;
+  for (size_t b = 0; b < numBlocks; ++b)
+    for (auto [p, op] : llvm::enumerate(getBlockOps(b)))
+      for (OpResult result : op->getResults())
+        for (Operation *user : result.getUsers()) {
+          auto it = positions.find(body.findAncestorOpInBlock(*user));
+          if (it == positions.end() || it->second.first != b)
+            outputs.insert({p, result.getResultNumber()});
+        }
+  if (outputs.empty())
+    return failure();
+  SmallVector<Type, 4> outputTypes;
+  for (auto [p, resultNumber] : outputs) {
+    Type type = getBlockOps(0)[p]->getResult(resultNumber).getType();
+    auto tensorType = type.dyn_cast<RankedTensorType>();
+    if (!tensorType || !tensorType.hasStaticShape())
+      return failure();
+    outputTypes.emplace_back(type);
+  }
+
+  // The values taken from outside of the blocks are passed as arguments,
+  // except for the constants shared by all the blocks and the NoValues.
+  auto isClonedInto = [&](size_t i) {
+    Value value = externals[0].values[i];
+    Operation *defOp = value.getDefiningOp();
+    if (!defOp || !defOp->hasTrait<OpTrait::ConstantLike>())
+      return false;
+    for (size_t b = 1; b < numBlocks; ++b) {
+      Value other = externals[b].values[i];
+      if (other != value && !(isa<ONNXNoneOp>(defOp) &&
+                                 other.getDefiningOp<ONNXNoneOp>()))
+        return false;
+    }
+    return true;
+  };
+  size_t numExternals = externals[0].values.size();
+  SmallVector<bool, 16> isArgument;
+  SmallVector<Type, 16> argumentTypes;
+  for (size_t i = 0; i < numExternals; ++i) {
+    isArgument.emplace_back(!isClonedInto(i));
+    if (isArgument.back())
+      argumentTypes.emplace_back(externals[0].values[i].getType());
+  }
+
+  // Create the function computing the layer from the first block.
+  Location loc = getBlockOps(0).front()->getLoc();
+  std::string name;
+  for (int n = 0; name.empty() || symbolTable.lookup(name); ++n)
+    name = (funcOp.getName() + "_layer" + Twine(n)).str();
+  auto layerFuncOp = func::FuncOp::create(loc, name,
+      FunctionType::get(&getContext(), argumentTypes, outputTypes));
+  layerFuncOp.setPrivate();
+  layerFuncOp->setAttr(OUTLINED_LAYER_ATTRIBUTE, UnitAttr::get(&getContext()));
+  symbolTable.insert(layerFuncOp, Block::iterator(funcOp));
+  Block *entryBlock = layerFuncOp.addEntryBlock();
+  OpBuilder builder(&getContext());
+  builder.setInsertionPointToStart(entryBlock);
+  IRMapping mapping;
+  for (size_t i = 0, a = 0; i < numExternals; ++i) {
+    Value value = externals[0].values[i];
+    if (isArgument[i])
+      mapping.map(value, entryBlock->getArgument(a++));
+    else
+      builder.clone(*value.getDefiningOp(), mapping);
+  }
+  for (Operation *op : getBlockOps(0))
+    builder.clone(*op, mapping);
+  SmallVector<Value, 4> results;
+  for (auto [p, resultNumber] : outputs)
+    results.emplace_back(
+        mapping.lookup(getBlockOps(0)[p]->getResult(resultNumber)));
+  builder.create<func::ReturnOp>(loc, results);
+
+  // Replace each block by a call to the function.
+  for (size_t b = 0; b < numBlocks; ++b) {
+    ArrayRef<Operation *> blockOps = getBlockOps(b);
+    SmallVector<Value, 16> arguments;
+    for (size_t i = 0; i < numExternals; ++i)
+      if (isArgument[i])
+        arguments.emplace_back(externals[b].values[i]);
+    builder.setInsertionPointAfter(blockOps.back());
+    auto callOp = builder.create<func::CallOp>(
+        blockOps.front()->getLoc(), layerFuncOp, arguments);
+    for (auto [i, output] : llvm::enumerate(outputs))
+      blockOps[output.first]
+          ->getResult(output.second)
+          .replaceAllUsesWith(callOp.getResult(i));
+    for (Operation *op : llvm::reverse(blockOps))
+      op->erase();
+    for (Value value : externals[b].values)
+      if (Operation *defOp = value.getDefiningOp())
+        if (defOp->hasTrait<OpTrait::ConstantLike>() && defOp->use_empty())
+          defOp->erase();
+  }
+  LLVM_DEBUG(llvm::dbgs() << "outlined " << numBlocks << " layers of "
+                          << length << " ops into " << layerFuncOp.getName()
+                          << "\n");
+  return success();
+}
+
+void OutlineRepeatedLayersPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SymbolTable symbolTable(module);
+  SmallVector<func::FuncOp, 4> funcOps;
+  for (auto funcOp : module.getOps<func::FuncOp>())
+    if (!funcOp.isExternal() && funcOp.getBody().hasOneBlock() &&
+        !funcOp->hasAttr(OUTLINED_LAYER_ATTRIBUTE))
+      funcOps.emplace_back(funcOp);
+  for (func::FuncOp funcOp : funcOps)
+    while (succeeded(outlineLayer(symbolTable, funcOp))) {
+    }
+}
+
+} // namespace
+
+std::unique_ptr<Pass> createOutlineRepeatedLayersPass() {
+  return std::make_unique<OutlineRepeatedLayersPass>();
+}
+
+} // namespace onnx_mlir
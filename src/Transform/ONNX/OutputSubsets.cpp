@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- OutputSubsets.cpp - Entry points for subsets of outputs ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that clones the entry point functions of a model
+// for each subset of their outputs given by the user, each clone only
+// returning the outputs of its subset and having an entry point of its own.
+// The ops only computing the other outputs are erased from the clone, so that
+// a caller needing only some outputs of a model with several heads, e.g. only
+// the embedding of a detection, segmentation and embedding model, skips the
+// computation of the other heads.
+//
+// The subsets are given by the names of their outputs, separated by ",", the
+// subsets being separated by ";", as in "boxes,masks;embedding". The clone of
+// function @main_graph for subset k is named @main_graph_subset<k>, and
+// returns the outputs of the subset in the order of the function. The subsets
+// naming an output that a function does not have are not compiled for it.
+//
+// Likewise, the pass clones the functions for each group of internal nodes
+// given by their `onnx_node_name`, e.g. the node computing the embedding fed
+// to the classifier of a model. The clone @main_graph_extract<k> for group k
+// returns the results of the nodes of the group, named by the node names, or
+// <node>_<i> for the nodes with several results, and only runs the part of
+// the model they depend on. The clones share their constants with the
+// functions once the Krnl globals are deduplicated.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/SmallSet.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+using OutputSubset = llvm::SmallSet<std::string, 4>;
+
+struct OutputSubsetsPass
+    : public PassWrapper<OutputSubsetsPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OutputSubsetsPass)
+
+  StringRef getArgument() const override { return "output-subsets"; }
+
+  StringRef getDescription() const override {
+    return "Clone the entry point functions for subsets of their outputs.";
+  }
+
+  Option<std::string> subsets{*this, "subsets",
+      llvm::cl::desc("Subsets of output names separated by \";\", the names "
+                     "of a subset being separated by \",\""),
+      llvm::cl::init("")};
+
+  Option<std::string> nodes{*this, "nodes",
+      llvm::cl::desc("Groups of node names separated by \";\", the names of "
+                     "a group being separated by \",\""),
+      llvm::cl::init("")};
+
+  OutputSubsetsPass() = default;
+  OutputSubsetsPass(const OutputSubsetsPass &pass)
+      : PassWrapper<OutputSubsetsPass, OperationPass<ModuleOp>>() {}
+  OutputSubsetsPass(const std::string &subsets, const std::string &nodes) {
+    this->subsets = subsets;
+    this->nodes = nodes;
+  }
+
+  void runOnOperation() final;
+
+private:
+  // Return a clone of the function only computing the outputs of the subset,
+  // or null if the function has no output of one of the names of the subset.
+  func::FuncOp cloneForSubset(
+      func::FuncOp funcOp, const OutputSubset &subset, int64_t index) const;
+
+  // Return a clone of the function only computing the results of the nodes
+  // of the group, or null if the function has no node of one of the names of
+  // the group.
+  func::FuncOp cloneForNodes(
+      func::FuncOp funcOp, const OutputSubset &group, int64_t index) const;
+
+  // Return a clone of the function of the given name returning the given
+  // values of the function, with the given output names.
+  func::FuncOp cloneReturning(func::FuncOp funcOp, const Twine &name,
+      ArrayRef<Value> values, ArrayRef<std::string> names) const;
+};
+
+func::FuncOp OutputSubsetsPass::cloneForSubset(
+    func::FuncOp funcOp, const OutputSubset &subset, int64_t index) const {
+  ArrayAttr outputNames = funcOp->getAttrOfType<ArrayAttr>("output_names");
+  if (!outputNames)
+    return nullptr;
+  Operation *terminator = funcOp.getBody().front().getTerminator();
+  SmallVector<Value, 4> values;
+  SmallVector<std::string, 4> names;
+  for (auto [i, nameAttr] : llvm::enumerate(outputNames)) {
+    StringRef name = nameAttr.cast<StringAttr>().getValue();
+    if (subset.count(name.str())) {
+      values.emplace_back(terminator->getOperand(i));
+      names.emplace_back(name.str());
+    }
+  }
+  if (values.size() != subset.size())
+    return nullptr;
+  return cloneReturning(
+      funcOp, funcOp.getName() + "_subset" + Twine(index), values, names);
+}
+
+func::FuncOp OutputSubsetsPass::cloneForNodes(
+    func::FuncOp funcOp, const OutputSubset &group, int64_t index) const {
+  // Only the nodes of the body are considered, the nodes of the regions of
+  // the If and Loop ops having no value outside of them.
+  SmallVector<Value, 4> values;
+  SmallVector<std::string, 4> names;
+  int64_t numNodes = 0;
+  for (Operation &op : funcOp.getBody().front().without_terminator()) {
+    auto nodeName = op.getAttrOfType<StringAttr>("onnx_node_name");
+    if (!nodeName || !group.count(nodeName.str()))
+      continue;
+    ++numNodes;
+    for (Value result : op.getResults()) {
+      values.emplace_back(result);
+      names.emplace_back(op.getNumResults() == 1
+                             ? nodeName.str()
+                             : (nodeName.getValue() + "_" +
+                                   Twine(result.getResultNumber()))
+                                   .str());
+    }
+  }
+  if (numNodes != (int64_t)group.size())
+    return nullptr;
+  return cloneReturning(
+      funcOp, funcOp.getName() + "_extract" + Twine(index), values, names);
+}
+
+func::FuncOp OutputSubsetsPass::cloneReturning(func::FuncOp funcOp,
+    const Twine &name, ArrayRef<Value> values,
+    ArrayRef<std::string> names) const {
+  IRMapping mapping;
+  func::FuncOp clone = funcOp.clone(mapping);
+  clone.setName(name.str());
+  Block &body = clone.getBody().front();
+  Operation *terminator = body.getTerminator();
+  SmallVector<Value, 4> results;
+  SmallVector<Type, 4> resultTypes;
+  for (Value value : values) {
+    results.emplace_back(mapping.lookup(value));
+    resultTypes.emplace_back(value.getType());
+  }
+  terminator->setOperands(results);
+  clone.setType(FunctionType::get(
+      &getContext(), clone.getArgumentTypes(), resultTypes));
+  OpBuilder builder(&getContext());
+  SmallVector<StringRef, 4> nameRefs(names.begin(), names.end());
+  clone->setAttr("output_names", builder.getStrArrayAttr(nameRefs));
+
+  // Erase the ops only computing the other outputs, the users of an op
+  // being erased before it.
+  for (Operation &op : llvm::make_early_inc_range(
+           llvm::reverse(body.without_terminator())))
+    if (isOpTriviallyDead(&op))
+      op.erase();
+  return clone;
+}
+
+// Parse a list of sets of names. Return failure if a set is empty.
+static LogicalResult parseNameSets(
+    StringRef option, SmallVectorImpl<OutputSubset> &sets) {
+  SmallVector<StringRef, 4> setStrs;
+  option.split(setStrs, ';', -1, /*KeepEmpty=*/false);
+  for (StringRef setStr : setStrs) {
+    SmallVector<StringRef, 4> nameStrs;
+    setStr.split(nameStrs, ',', -1, /*KeepEmpty=*/false);
+    OutputSubset set;
+    for (StringRef nameStr : nameStrs)
+      set.insert(nameStr.trim().str());
+    if (set.empty())
+      return failure();
+    sets.emplace_back(set);
+  }
+  return success();
+}
+
+void OutputSubsetsPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SmallVector<OutputSubset, 4> outputSubsets;
+  if (failed(parseNameSets(subsets, outputSubsets))) {
+    module.emitError("invalid subsets option: ") << subsets;
+    return signalPassFailure();
+  }
+  SmallVector<OutputSubset, 4> nodeGroups;
+  if (failed(parseNameSets(nodes, nodeGroups))) {
+    module.emitError("invalid nodes option: ") << nodes;
+    return signalPassFailure();
+  }
+  if (outputSubsets.empty() && nodeGroups.empty())
+    return;
+
+  SymbolTable symbolTable(module);
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    if (!funcOp || funcOp.isExternal() || !funcOp.getBody().hasOneBlock())
+      continue;
+    // Insert the clones and their entry points in the order of the subsets.
+    Operation *lastFuncOp = funcOp;
+    OpBuilder builder(entryPointOp);
+    builder.setInsertionPointAfter(entryPointOp);
+    auto insertClone = [&](func::FuncOp clone) {
+      symbolTable.insert(clone, std::next(Block::iterator(lastFuncOp)));
+      builder.create<ONNXEntryPointOp>(entryPointOp.getLoc(), clone);
+      lastFuncOp = clone;
+    };
+    for (auto [k, subset] : llvm::enumerate(outputSubsets)) {
+      if (func::FuncOp clone = cloneForSubset(funcOp, subset, k))
+        insertClone(clone);
+      else
+        funcOp.emitWarning("has no output for subset ")
+            << k << ", not compiled for it";
+    }
+    for (auto [k, group] : llvm::enumerate(nodeGroups)) {
+      if (func::FuncOp clone = cloneForNodes(funcOp, group, k))
+        insertClone(clone);
+      else
+        funcOp.emitWarning("has no node for group ")
+            << k << ", not compiled for it";
+    }
+  }
+}
+
+} // end anonymous namespace.
+
+std::unique_ptr<Pass> createOutputSubsetsPass() {
+  return std::make_unique<OutputSubsetsPass>();
+}
+
+std::unique_ptr<Pass> createOutputSubsetsPass(
+    const std::string &subsets, const std::string &nodes) {
+  return std::make_unique<OutputSubsetsPass>(subsets, nodes);
+}
+
+} // namespace onnx_mlir
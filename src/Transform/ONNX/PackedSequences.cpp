@@ -0,0 +1,141 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ PackedSequences.cpp - Run attentions over packed sequences ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that adds an input of sequence offsets, named by
+// the user, to the entry point functions, and passes it to their fused
+// attentions, so that a transformer encoder runs over sequences packed along
+// the token dimension instead of padded to the longest one. The callers feed
+// the concatenated tokens of all the sequences as a batch of one, and the
+// offsets [s_0, ..., s_n] of the sequences in it: the token-wise ops, such as
+// the MatMuls, the LayerNormalizations and the elementwise ops, run over the
+// packed tokens as over any batch, and the attentions of the queries of a
+// sequence only attend to the keys of the same sequence, so that no work is
+// spent on padding tokens.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+struct PackedSequencesPass
+    : public PassWrapper<PackedSequencesPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PackedSequencesPass)
+
+  StringRef getArgument() const override { return "packed-sequences"; }
+
+  StringRef getDescription() const override {
+    return "Run the fused attentions over sequences packed along the token "
+           "dimension.";
+  }
+
+  Option<std::string> offsetsName{*this, "offsets",
+      llvm::cl::desc("Name of the input of the sequence offsets"),
+      llvm::cl::init("")};
+
+  PackedSequencesPass() = default;
+  PackedSequencesPass(const PackedSequencesPass &pass)
+      : PassWrapper<PackedSequencesPass, OperationPass<ModuleOp>>() {}
+  PackedSequencesPass(const std::string &offsetsName) {
+    this->offsetsName = offsetsName;
+  }
+
+  void runOnOperation() final;
+
+private:
+  // Return true if the attention is over the tokens of a sequence, namely if
+  // its numbers of queries and keys may be the same, and it has no sequence
+  // offsets yet nor paged keys.
+  static bool isSelfAttention(ONNXFusedAttentionOp attentionOp);
+};
+
+bool PackedSequencesPass::isSelfAttention(ONNXFusedAttentionOp attentionOp) {
+  if (!isFromNone(attentionOp.getSequenceOffsets()) ||
+      !isFromNone(attentionOp.getBlockTable()))
+    return false;
+  auto qType = attentionOp.getQ().getType().dyn_cast<RankedTensorType>();
+  auto kType = attentionOp.getK().getType().dyn_cast<RankedTensorType>();
+  if (!qType || !kType || qType.getRank() < 2)
+    return false;
+  int64_t numQueries = qType.getShape()[qType.getRank() - 2];
+  int64_t numKeys = kType.getShape()[kType.getRank() - 1];
+  return ShapedType::isDynamic(numQueries) ||
+         ShapedType::isDynamic(numKeys) || numQueries == numKeys;
+}
+
+void PackedSequencesPass::runOnOperation() {
+  if (offsetsName.empty())
+    return;
+  ModuleOp module = getOperation();
+  MLIRContext *context = &getContext();
+  SymbolTable symbolTable(module);
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    if (!funcOp || funcOp.isExternal())
+      continue;
+    SmallVector<ONNXFusedAttentionOp, 8> attentionOps;
+    funcOp.walk([&](ONNXFusedAttentionOp attentionOp) {
+      if (isSelfAttention(attentionOp))
+        attentionOps.emplace_back(attentionOp);
+    });
+    if (attentionOps.empty()) {
+      funcOp.emitWarning("no fused self-attention, the sequence offsets ")
+          << offsetsName << " are not used";
+      continue;
+    }
+
+    // The offsets are the last input.
+    Block &entryBlock = funcOp.front();
+    auto offsetsType = RankedTensorType::get(
+        {ShapedType::kDynamic}, IntegerType::get(context, 64));
+    Value offsets = entryBlock.addArgument(offsetsType, funcOp.getLoc());
+    funcOp.setType(FunctionType::get(
+        context, entryBlock.getArgumentTypes(), funcOp.getResultTypes()));
+    if (ArrayAttr inputNames =
+            funcOp->getAttrOfType<ArrayAttr>("input_names")) {
+      SmallVector<Attribute, 4> names(inputNames.begin(), inputNames.end());
+      names.emplace_back(StringAttr::get(context, offsetsName));
+      funcOp->setAttr("input_names", ArrayAttr::get(context, names));
+    }
+    for (ONNXFusedAttentionOp attentionOp : attentionOps)
+      attentionOp.getSequenceOffsetsMutable().assign(offsets);
+  }
+}
+
+} // namespace
+
+std::unique_ptr<Pass> createPackedSequencesPass() {
+  return std::make_unique<PackedSequencesPass>();
+}
+
+std::unique_ptr<Pass> createPackedSequencesPass(
+    const std::string &offsetsName) {
+  return std::make_unique<PackedSequencesPass>(offsetsName);
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,248 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- PagedKVCache.cpp - Page the key/value caches of attentions ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that keeps the key/value caches of the decoder
+// attentions of the entry point functions in fixed-size blocks. A decoder
+// step usually concatenates the past keys and values, inputs of the model, to
+// the ones of the new tokens, attends to the result, and returns it as the
+// cache of the next step, so that each step copies the whole cache. The pass
+// rewrites
+// ```
+//   %k = "onnx.Concat"(%past_k, %new_k) {axis = -2}
+//   %kt = "onnx.Transpose"(%k) // swapping the last two dims
+//   %v = "onnx.Concat"(%past_v, %new_v) {axis = -2}
+//   %y = "onnx.FusedAttention"(%q, %kt, %v, %mask, %none, %none, %none)
+//   return %y, %k, %v
+// ```
+// into
+// ```
+//   %k = "onnx.PagedKVCacheWrite"(%past_k, %block_table, %past_length, %new_k)
+//   %v = "onnx.PagedKVCacheWrite"(%past_v, %block_table, %past_length, %new_v)
+//   %length = "onnx.Add"(%past_length, "onnx.Dim"(%new_k) {axis = -2})
+//   %y = "onnx.FusedAttention"(%q, %k, %v, %mask, %none, %block_table,
+//       %length)
+//   return %y, %k, %v
+// ```
+// where the past keys and values become caches of blocks [N, H..., P, D],
+// updated in place, and the block table and the past length are new last
+// inputs of the function, so that a step only writes its new tokens. The
+// runtime reserves the blocks and passes both inputs, see ExecutionState.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Concat of the past keys or values, an input of the function only used by
+// the Concat, and of the ones of the new tokens, along the tokens.
+struct KVConcat {
+  ONNXConcatOp concatOp;
+  BlockArgument past;
+  Value next;
+};
+
+struct PagedKVCachePass
+    : public PassWrapper<PagedKVCachePass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PagedKVCachePass)
+
+  StringRef getArgument() const override { return "paged-kv-cache"; }
+
+  StringRef getDescription() const override {
+    return "Keep the key/value caches of the fused attentions in blocks read "
+           "through a block table.";
+  }
+
+  void runOnOperation() final;
+
+private:
+  // Return the Concat defining the value, if it concatenates an input of the
+  // function and new tokens, and its result is only used by the user and
+  // returned.
+  static std::optional<KVConcat> matchKVConcat(
+      Value value, Operation *user, func::FuncOp funcOp);
+  // Return the concats of the keys and the values of the attention, if it
+  // attends to a key/value cache.
+  static std::optional<std::pair<KVConcat, KVConcat>> matchKVCache(
+      ONNXFusedAttentionOp attentionOp, func::FuncOp funcOp);
+  // Rewrite the attention to read the paged caches.
+  static void pageKVCache(ONNXFusedAttentionOp attentionOp,
+      const KVConcat &keys, const KVConcat &values, Value blockTable,
+      Value pastLength);
+};
+
+std::optional<KVConcat> PagedKVCachePass::matchKVConcat(
+    Value value, Operation *user, func::FuncOp funcOp) {
+  auto concatOp = value.getDefiningOp<ONNXConcatOp>();
+  if (!concatOp || concatOp.getInputs().size() != 2)
+    return std::nullopt;
+  auto type = value.getType().dyn_cast<RankedTensorType>();
+  if (!type || type.getRank() < 3 || !type.getElementType().isF32())
+    return std::nullopt;
+  int64_t rank = type.getRank();
+  int64_t axis = concatOp.getAxis();
+  if (axis < 0)
+    axis += rank;
+  if (axis != rank - 2)
+    return std::nullopt;
+
+  Block &entryBlock = funcOp.front();
+  auto past = concatOp.getInputs()[0].dyn_cast<BlockArgument>();
+  if (!past || past.getOwner() != &entryBlock || !past.hasOneUse() ||
+      !past.getType().isa<RankedTensorType>())
+    return std::nullopt;
+  for (Operation *concatUser : value.getUsers())
+    if (concatUser != user && concatUser != entryBlock.getTerminator())
+      return std::nullopt;
+  return KVConcat{concatOp, past, concatOp.getInputs()[1]};
+}
+
+std::optional<std::pair<KVConcat, KVConcat>> PagedKVCachePass::matchKVCache(
+    ONNXFusedAttentionOp attentionOp, func::FuncOp funcOp) {
+  if (!isFromNone(attentionOp.getSequenceOffsets()) ||
+      !isFromNone(attentionOp.getBlockTable()))
+    return std::nullopt;
+
+  // The keys are transposed by swapping their last two dims.
+  auto transposeOp = attentionOp.getK().getDefiningOp<ONNXTransposeOp>();
+  if (!transposeOp || !transposeOp.getResult().hasOneUse() ||
+      !transposeOp.getPermAttr())
+    return std::nullopt;
+  SmallVector<int64_t, 4> perm;
+  for (Attribute attr : transposeOp.getPermAttr())
+    perm.emplace_back(attr.cast<IntegerAttr>().getInt());
+  int64_t rank = perm.size();
+  if (rank < 3)
+    return std::nullopt;
+  for (int64_t i = 0; i < rank - 2; ++i)
+    if (perm[i] != i)
+      return std::nullopt;
+  if (perm[rank - 2] != rank - 1 || perm[rank - 1] != rank - 2)
+    return std::nullopt;
+
+  std::optional<KVConcat> keys =
+      matchKVConcat(transposeOp.getData(), transposeOp, funcOp);
+  std::optional<KVConcat> values =
+      matchKVConcat(attentionOp.getV(), attentionOp, funcOp);
+  if (!keys || !values || keys->concatOp == values->concatOp)
+    return std::nullopt;
+  return std::make_pair(*keys, *values);
+}
+
+void PagedKVCachePass::pageKVCache(ONNXFusedAttentionOp attentionOp,
+    const KVConcat &keys, const KVConcat &values, Value blockTable,
+    Value pastLength) {
+  OpBuilder builder(attentionOp);
+  MultiDialectBuilder<OnnxBuilder> create(builder, attentionOp.getLoc());
+
+  // The past tokens become caches of blocks [N, H..., P, D].
+  auto pageCache = [&](const KVConcat &kv) {
+    auto pastType = kv.past.getType().cast<RankedTensorType>();
+    SmallVector<int64_t, 4> cacheShape(pastType.getShape());
+    cacheShape[0] = ShapedType::kDynamic;
+    cacheShape[cacheShape.size() - 2] = ShapedType::kDynamic;
+    auto cacheType =
+        RankedTensorType::get(cacheShape, pastType.getElementType());
+    kv.past.setType(cacheType);
+    return builder.create<ONNXPagedKVCacheWriteOp>(attentionOp.getLoc(),
+        cacheType, kv.past, blockTable, pastLength, kv.next);
+  };
+  Value keyCache = pageCache(keys);
+  Value valueCache = pageCache(values);
+  int64_t rank = keyCache.getType().cast<ShapedType>().getRank();
+  Value keyLength =
+      create.onnx.add(pastLength, create.onnx.dim(keys.next, rank - 2));
+  Value paged = builder.create<ONNXFusedAttentionOp>(attentionOp.getLoc(),
+      attentionOp.getY().getType(), attentionOp.getQ(), keyCache, valueCache,
+      attentionOp.getMask(), attentionOp.getSequenceOffsets(), blockTable,
+      keyLength, attentionOp.getScaleAttr());
+
+  // The concats are only returned once the attention is replaced.
+  Operation *transposeOp = attentionOp.getK().getDefiningOp();
+  attentionOp.getY().replaceAllUsesWith(paged);
+  attentionOp.erase();
+  transposeOp->erase();
+  keys.concatOp.getResult().replaceAllUsesWith(keyCache);
+  keys.concatOp.erase();
+  values.concatOp.getResult().replaceAllUsesWith(valueCache);
+  values.concatOp.erase();
+}
+
+void PagedKVCachePass::runOnOperation() {
+  ModuleOp module = getOperation();
+  MLIRContext *context = &getContext();
+  SymbolTable symbolTable(module);
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    if (!funcOp || funcOp.isExternal())
+      continue;
+    // Only the attentions of the function body, where the length and the
+    // cache reads are valid affine symbols once lowered.
+    Block &entryBlock = funcOp.front();
+    SmallVector<std::tuple<ONNXFusedAttentionOp, KVConcat, KVConcat>, 8>
+        caches;
+    for (ONNXFusedAttentionOp attentionOp :
+        entryBlock.getOps<ONNXFusedAttentionOp>())
+      if (auto kv = matchKVCache(attentionOp, funcOp))
+        caches.emplace_back(attentionOp, kv->first, kv->second);
+    if (caches.empty()) {
+      funcOp.emitWarning("no fused attention to a concatenated key/value "
+                         "cache, the caches are not paged");
+      continue;
+    }
+
+    // The block table and the past length are the last inputs.
+    Type i64Type = IntegerType::get(context, 64);
+    Value blockTable = entryBlock.addArgument(
+        RankedTensorType::get(
+            {ShapedType::kDynamic, ShapedType::kDynamic}, i64Type),
+        funcOp.getLoc());
+    Value pastLength = entryBlock.addArgument(
+        RankedTensorType::get({1}, i64Type), funcOp.getLoc());
+    if (ArrayAttr inputNames =
+            funcOp->getAttrOfType<ArrayAttr>("input_names")) {
+      SmallVector<Attribute, 4> names(inputNames.begin(), inputNames.end());
+      names.emplace_back(StringAttr::get(context, "kv_block_table"));
+      names.emplace_back(StringAttr::get(context, "kv_past_length"));
+      funcOp->setAttr("input_names", ArrayAttr::get(context, names));
+    }
+    for (auto &[attentionOp, keys, values] : caches)
+      pageKVCache(attentionOp, keys, values, blockTable, pastLength);
+    funcOp.setType(FunctionType::get(context, entryBlock.getArgumentTypes(),
+        entryBlock.getTerminator()->getOperandTypes()));
+  }
+}
+
+} // namespace
+
+std::unique_ptr<Pass> createPagedKVCachePass() {
+  return std::make_unique<PagedKVCachePass>();
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--- PropagateSimdDataLayout.cpp - ONNX SIMD Data Layout Propagation --===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// With the SIMD data layout optimization, each convolution computes on its
+// image in the blocked NCHW4C layout, between a pair of layout transforms
+// from and back to the standard layout. This pass moves the transforms back
+// to the standard layout past the ops that compute the same on any layout,
+// namely the elementwise ops, pooling, concat, batch normalization, and
+// resize, so that they also compute in the blocked layout. Their results are
+// then transformed back to the standard layout at the graph boundaries or at
+// the ops that need it only, the transforms to the blocked layout of the
+// following convolutions canceling out with the ones back to the standard
+// layout.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/ONNX/ONNXLayoutHelper.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return the tensor in the blocked SIMD layout that the value is transformed
+// back to the standard layout from, or null.
+Value getBlockedLayoutSource(Value value) {
+  auto layoutOp = value.getDefiningOp<ONNXLayoutTransformOp>();
+  if (!layoutOp || hasCustomONNXTensorDataLayout(value.getType()))
+    return nullptr;
+  Value data = layoutOp.getData();
+  if (!hasCustomONNXTensorDataLayout(data.getType()) ||
+      getONNXTensorLayout(data.getType()) !=
+          ONNXTensorEncodingAttr::DataLayout::NCHWxC)
+    return nullptr;
+  return data;
+}
+
+/// Rewrite
+/// ```
+///   %x = "onnx.LayoutTransform"(%xBlocked) {target_layout = "STANDARD"}
+///   %Y = "onnx.Relu"(%x)
+/// ```
+/// into
+/// ```
+///   %yBlocked = "onnx.Relu"(%xBlocked)
+///   %Y = "onnx.LayoutTransform"(%yBlocked) {target_layout = "STANDARD"}
+/// ```
+/// for an op computing the same on any layout of its 4D tensors. Only the
+/// first operand of the op is propagated, or all of them when
+/// ALL_OPERANDS is set. The operands that are not transformed from the
+/// blocked layout, such as the broadcast constants of a binary op, are kept
+/// as is.
+template <typename OP, bool ALL_OPERANDS>
+struct PropagateSimdDataLayoutPattern : public OpRewritePattern<OP> {
+  using OpRewritePattern<OP>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      OP layoutAgnosticOp, PatternRewriter &rewriter) const final {
+    Operation *op = layoutAgnosticOp.getOperation();
+    if (op->getNumResults() != 1)
+      return failure();
+    Value result = op->getResult(0);
+    if (!isRankedShapedType(result.getType()) ||
+        getRank(result.getType()) != 4 ||
+        hasCustomONNXTensorDataLayout(result.getType()))
+      return failure();
+
+    // Blocked tensors transformed to the operands, which must all have the
+    // same layout.
+    SmallVector<Value, 4> operands(op->getOperands());
+    ONNXTensorEncodingAttr encoding;
+    unsigned numCandidates = ALL_OPERANDS ? operands.size() : 1;
+    for (unsigned i = 0; i < numCandidates; ++i) {
+      Value source = getBlockedLayoutSource(operands[i]);
+      if (!source)
+        continue;
+      ONNXTensorEncodingAttr sourceEncoding =
+          getONNXTensorEncoding(source.getType());
+      if (encoding && sourceEncoding != encoding)
+        return failure();
+      encoding = sourceEncoding;
+      operands[i] = source;
+    }
+    if (!encoding)
+      return failure();
+
+    Location loc = op->getLoc();
+    Type blockedType =
+        convertTensorTypeToTensorTypeWithEncoding(result.getType(), encoding);
+    OperationState state(
+        loc, op->getName(), operands, {blockedType}, op->getAttrs());
+    Operation *blockedOp = rewriter.create(state);
+    Value standard = rewriter.create<ONNXLayoutTransformOp>(loc,
+        blockedOp->getResult(0), rewriter.getStringAttr(LAYOUT_STANDARD));
+    rewriter.replaceOp(op, standard);
+    return success();
+  }
+};
+
+template <typename OP>
+using PropagateFirstOperandPattern = PropagateSimdDataLayoutPattern<OP, false>;
+template <typename OP>
+using PropagateAllOperandsPattern = PropagateSimdDataLayoutPattern<OP, true>;
+
+struct PropagateSimdDataLayoutONNXToONNXPass
+    : public PassWrapper<PropagateSimdDataLayoutONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(
+      PropagateSimdDataLayoutONNXToONNXPass)
+
+  StringRef getArgument() const override {
+    return "propagate-simd-data-layout-onnx";
+  }
+
+  StringRef getDescription() const override {
+    return "Propagate the SIMD data layout of convolutions through the ops "
+           "computing the same on any layout.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    // Unary elementwise ops, the other operands of Clip being scalars.
+    patterns.insert<PropagateFirstOperandPattern<ONNXAbsOp>,
+        PropagateFirstOperandPattern<ONNXClipOp>,
+        PropagateFirstOperandPattern<ONNXEluOp>,
+        PropagateFirstOperandPattern<ONNXHardSigmoidOp>,
+        PropagateFirstOperandPattern<ONNXLeakyReluOp>,
+        PropagateFirstOperandPattern<ONNXNegOp>,
+        PropagateFirstOperandPattern<ONNXReluOp>,
+        PropagateFirstOperandPattern<ONNXSeluOp>,
+        PropagateFirstOperandPattern<ONNXSigmoidOp>,
+        PropagateFirstOperandPattern<ONNXSoftplusOp>,
+        PropagateFirstOperandPattern<ONNXTanhOp>>(context);
+    // Binary elementwise ops.
+    patterns.insert<PropagateAllOperandsPattern<ONNXAddOp>,
+        PropagateAllOperandsPattern<ONNXDivOp>,
+        PropagateAllOperandsPattern<ONNXMulOp>,
+        PropagateAllOperandsPattern<ONNXSubOp>>(context);
+    // Ops with parameters per channel or in the other operands.
+    patterns.insert<PropagateFirstOperandPattern<ONNXAveragePoolOp>,
+        PropagateFirstOperandPattern<ONNXBatchNormalizationInferenceModeOp>,
+        PropagateFirstOperandPattern<ONNXMaxPoolSingleOutOp>,
+        PropagateFirstOperandPattern<ONNXResizeOp>>(context);
+    patterns.insert<PropagateAllOperandsPattern<ONNXConcatOp>>(context);
+    // Cancel the transforms back to the standard layout followed by the ones
+    // to the blocked layout of the convolutions.
+    ONNXLayoutTransformOp::getCanonicalizationPatterns(patterns, context);
+    if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a PropagateSimdDataLayout pass.
+ */
+std::unique_ptr<mlir::Pass> createPropagateSimdDataLayoutONNXToONNXPass() {
+  return std::make_unique<PropagateSimdDataLayoutONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,165 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------- QuantizeWeights.cpp - Store MatMul weights in int8 ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that quantizes the f32 constant weights of the
+// MatMul ops to int8, with a symmetric scale per column, followed by a
+// DequantizeLinear back to f32. The CPU lowering of MatMul reads the int8
+// weights before the DequantizeLinear and widens them to f32 as they are
+// loaded, the scales being applied to the columns of the result, so that the
+// activations stay in f32 while the weights take a quarter of the memory and
+// of the memory bandwidth.
+//
+// Like the half precision weights, the pass must run before the
+// DisposableElementsAttrs are scrubbed, and after the constant propagation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ElementsAttr/ElementsAttrHelper.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/OnnxElementsAttrBuilder.hpp"
+#include "src/Pass/Passes.hpp"
+
+#include <cmath>
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Largest magnitude of the symmetric int8 values.
+constexpr float kMaxQuantized = 127.0f;
+
+// Return true if the constant is an f32 tensor of rank 2 or more, with static
+// columns, used only as the B operand of MatMul ops.
+bool isMatMulWeight(ONNXConstantOp constOp) {
+  Value weight = constOp.getResult();
+  auto type = weight.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.getElementType().isF32() || type.getRank() < 2 ||
+      !type.hasStaticShape() ||
+      !constOp.getValueAttr().isa_and_nonnull<ElementsAttr>() ||
+      weight.use_empty())
+    return false;
+  return llvm::all_of(weight.getUses(), [&](OpOperand &use) {
+    auto matMulOp = dyn_cast<ONNXMatMulOp>(use.getOwner());
+    return matMulOp && use.getOperandNumber() == 1 &&
+           matMulOp.getA() != weight;
+  });
+}
+
+struct QuantizeWeightsPass
+    : public PassWrapper<QuantizeWeightsPass, OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(QuantizeWeightsPass)
+
+  StringRef getArgument() const override { return "quantize-weights"; }
+
+  StringRef getDescription() const override {
+    return "Quantize the f32 constant weights of MatMul ops to int8.";
+  }
+
+  Option<std::string> weightType{*this, "weight-type",
+      llvm::cl::desc("Element type of the quantized weights, int8"),
+      llvm::cl::init("int8")};
+
+  QuantizeWeightsPass() = default;
+  QuantizeWeightsPass(const QuantizeWeightsPass &pass)
+      : PassWrapper<QuantizeWeightsPass, OperationPass<func::FuncOp>>() {}
+  QuantizeWeightsPass(const std::string &weightType) {
+    this->weightType = weightType;
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    if (weightType != "int8") {
+      function.emitError("unsupported type of the quantized weights: ")
+          << weightType;
+      return signalPassFailure();
+    }
+
+    SmallVector<ONNXConstantOp, 8> weights;
+    function.walk([&](ONNXConstantOp constOp) {
+      if (isMatMulWeight(constOp))
+        weights.emplace_back(constOp);
+    });
+
+    OnnxElementsAttrBuilder elementsBuilder(context);
+    Type i8Type = IntegerType::get(context, 8);
+    Type f32Type = FloatType::getF32(context);
+    for (ONNXConstantOp constOp : weights) {
+      ElementsAttr elements = constOp.getValueAttr().cast<ElementsAttr>();
+      ArrayRef<int64_t> shape = elements.getShapedType().getShape();
+      int64_t numCols = shape.back();
+      ArrayBuffer<float> buffer = getElementsArray<float>(elements);
+      ArrayRef<float> values = buffer.get();
+
+      // The scale of each column maps its largest magnitude to 127. The
+      // weights with infinite or NaN values are left in f32.
+      std::vector<float> scales(numCols, 0.0f);
+      bool isFinite = true;
+      for (size_t i = 0; i < values.size(); ++i) {
+        isFinite &= std::isfinite(values[i]);
+        float &scale = scales[i % numCols];
+        scale = std::max(scale, std::fabs(values[i]));
+      }
+      if (!isFinite)
+        continue;
+      for (float &scale : scales)
+        scale = scale > 0.0f ? scale / kMaxQuantized : 1.0f;
+
+      ElementsAttr quantized = elementsBuilder.fromArray<int8_t>(
+          RankedTensorType::get(shape, i8Type),
+          [&](MutableArrayRef<int8_t> dst) {
+            for (size_t i = 0; i < values.size(); ++i) {
+              float q = std::round(values[i] / scales[i % numCols]);
+              dst[i] = static_cast<int8_t>(
+                  std::min(std::max(q, -kMaxQuantized), kMaxQuantized));
+            }
+          });
+      ElementsAttr scaleElements = elementsBuilder.fromArray<float>(
+          RankedTensorType::get({numCols}, f32Type),
+          [&](MutableArrayRef<float> dst) {
+            std::copy(scales.begin(), scales.end(), dst.begin());
+          });
+
+      OpBuilder builder(constOp);
+      Location loc = constOp.getLoc();
+      MultiDialectBuilder<OnnxBuilder> create(builder, loc);
+      Value quantizedWeight = create.onnx.constant(quantized);
+      Value scale = create.onnx.constant(scaleElements);
+      Value weight = builder.create<ONNXDequantizeLinearOp>(loc,
+          constOp.getType(), quantizedWeight, scale, create.onnx.none(),
+          builder.getIntegerAttr(builder.getIntegerType(64, /*isSigned=*/true),
+              shape.size() - 1));
+      constOp.getResult().replaceAllUsesWith(weight);
+      constOp.erase();
+    }
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a QuantizeWeights pass.
+ */
+std::unique_ptr<mlir::Pass> createQuantizeWeightsPass() {
+  return std::make_unique<QuantizeWeightsPass>();
+}
+
+std::unique_ptr<mlir::Pass> createQuantizeWeightsPass(
+    const std::string &weightType) {
+  return std::make_unique<QuantizeWeightsPass>(weightType);
+}
+
+} // namespace onnx_mlir
@@ -19,6 +19,8 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Interfaces/CallInterfaces.h"
 #include "mlir/Pass/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -29,6 +31,48 @@
 using namespace mlir;
 
 namespace onnx_mlir {
+
+/*!
+ *  Signatures of the ops inferred by the shape inference passes sharing the
+ *  cache. The signature of an op hashes everything its inferred shapes depend
+ *  on: its operands and their types, its attributes, the attributes of the
+ *  ops defining its operands, e.g. the value of a constant shape, and its
+ *  result types. An op whose signature did not change since it was last
+ *  inferred is skipped, so that the shape inference passes repeated between
+ *  the rewrites only infer the ops created or changed by them, and their
+ *  users whose operand types changed in turn.
+ */
+class ShapeInferenceCache {
+public:
+  static llvm::hash_code getSignature(Operation &op) {
+    llvm::hash_code hash = llvm::hash_combine(op.getName().getAsOpaquePointer(),
+        op.getAttrDictionary().getAsOpaquePointer());
+    for (Value operand : op.getOperands()) {
+      Operation *defOp = operand.getDefiningOp();
+      hash = llvm::hash_combine(hash, operand.getAsOpaquePointer(),
+          operand.getType().getAsOpaquePointer(),
+          defOp ? defOp->getAttrDictionary().getAsOpaquePointer() : nullptr);
+    }
+    for (Type type : op.getResultTypes())
+      hash = llvm::hash_combine(hash, type.getAsOpaquePointer());
+    return hash;
+  }
+
+  // Return true if the op did not change since it was last inferred.
+  bool isInferred(Operation &op) const {
+    auto it = signatures.find(&op);
+    return it != signatures.end() && it->second == getSignature(op);
+  }
+
+  // Record the op as inferred, once its result types are inferred.
+  void setInferred(Operation &op) { signatures[&op] = getSignature(op); }
+
+private:
+  // The ops are kept after being erased, their signatures do not match the
+  // ops later allocated at their address unless the ops are the same.
+  llvm::DenseMap<Operation *, llvm::hash_code> signatures;
+};
+
 namespace {
 
 static SmallVector<func::FuncOp, 4> lookUpFuncsMatching(
@@ -63,12 +107,14 @@ class ShapeInferencePass
     : public PassWrapper<ShapeInferencePass, OperationPass<ModuleOp>> {
 private:
   bool analyzeAllFunctions;
+  std::shared_ptr<ShapeInferenceCache> cache;
 
 public:
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ShapeInferencePass)
 
-  ShapeInferencePass(bool analyzeAllFunctions)
-      : analyzeAllFunctions(analyzeAllFunctions) {}
+  ShapeInferencePass(
+      bool analyzeAllFunctions, std::shared_ptr<ShapeInferenceCache> cache)
+      : analyzeAllFunctions(analyzeAllFunctions), cache(std::move(cache)) {}
 
   StringRef getArgument() const override { return "shape-inference"; }
 
@@ -96,9 +142,9 @@ public:
       signalPassFailure();
   }
 
-  static LogicalResult runShapeInferenceOnRegion(Region &r) {
-    std::function<void(Region &)> doShapeInference = [](Region &region) {
-      (void)ShapeInferencePass::runShapeInferenceOnRegion(region);
+  LogicalResult runShapeInferenceOnRegion(Region &r) {
+    std::function<void(Region &)> doShapeInference = [this](Region &region) {
+      (void)runShapeInferenceOnRegion(region);
     };
 
     // Iterate on the operations that need shape inference i.e the operations
@@ -111,6 +157,11 @@ public:
       if (!containSubgraph(op) && !isUsedByReturnOp(op) &&
           !returnsDynamicOrUnknownShape(op))
         continue;
+      // The ops with a subgraph are always inferred, their shapes depending
+      // on the ops of the subgraph.
+      bool isCached = cache && !containSubgraph(op);
+      if (isCached && cache->isInferred(op))
+        continue;
 
       if (auto shape_op = llvm::dyn_cast<ShapeInference>(op)) {
         // Verify the operation before attempting to infer the shape of the
@@ -123,6 +174,8 @@ public:
         // Attempt to infer the shape of the produced output(s).
         if (failed(shape_op.inferShapes(doShapeInference)))
           return op.emitError("shape inference failed");
+        if (isCached)
+          cache->setInferred(op);
       } else if (!llvm::dyn_cast<CallOpInterface>(op))
         return op.emitError("unable to infer shape of operation without shape "
                             "inference interface");
@@ -130,7 +183,7 @@ public:
     return success();
   }
 
-  static LogicalResult runShapeInferenceOn(func::FuncOp f) {
+  LogicalResult runShapeInferenceOn(func::FuncOp f) {
     // Iterate on the operations that need shape inference i.e the operations
     // that return a dynamic shape or followed by a return op.
     auto &funcBody = f.getBody();
@@ -176,8 +229,14 @@ public:
 /*!
  * Create a Shape Inference pass.
  */
-std::unique_ptr<Pass> createShapeInferencePass(bool analyzeAllFunctions) {
-  return std::make_unique<ShapeInferencePass>(analyzeAllFunctions);
+std::unique_ptr<Pass> createShapeInferencePass(bool analyzeAllFunctions,
+    std::shared_ptr<ShapeInferenceCache> cache) {
+  return std::make_unique<ShapeInferencePass>(
+      analyzeAllFunctions, std::move(cache));
+}
+
+std::shared_ptr<ShapeInferenceCache> createShapeInferenceCache() {
+  return std::make_shared<ShapeInferenceCache>();
 }
 
 } // namespace onnx_mlir
@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----- ShapeSpecialization.cpp - Specialize models for input shapes ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that clones the entry point functions of a model
+// for each bucket of input shapes given by the user, setting the dimensions of
+// the bucket in the types of the inputs of the clone. The clones are compiled
+// with static shapes by the rest of the pipeline, and marked by the
+// `onnx.specialization_of` attribute referring to the function they
+// specialize. Once lowered to Krnl, the shape-dispatch pass turns the entry
+// point functions into dispatchers calling the clone of the bucket matching
+// the shapes of the inputs at runtime, or the generic function otherwise.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+#include <map>
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Dimensions of the inputs of a bucket, by input index. Dynamic dimensions
+// keep the dimension of the function.
+using ShapeBucket = std::map<unsigned, SmallVector<int64_t, 4>>;
+
+struct ShapeSpecializationPass
+    : public PassWrapper<ShapeSpecializationPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ShapeSpecializationPass)
+
+  StringRef getArgument() const override { return "shape-specialization"; }
+
+  StringRef getDescription() const override {
+    return "Clone the entry point functions for buckets of input shapes.";
+  }
+
+  Option<std::string> buckets{*this, "buckets",
+      llvm::cl::desc("Buckets of input shapes separated by \";\", each in the "
+                     "format of the shapeInformation option"),
+      llvm::cl::init("")};
+
+  ShapeSpecializationPass() = default;
+  ShapeSpecializationPass(const ShapeSpecializationPass &pass)
+      : PassWrapper<ShapeSpecializationPass, OperationPass<ModuleOp>>() {}
+  ShapeSpecializationPass(const std::string &buckets) {
+    this->buckets = buckets;
+  }
+
+  void runOnOperation() final;
+
+private:
+  // Parse the buckets option. Return failure if it is malformed.
+  LogicalResult parseBuckets(SmallVectorImpl<ShapeBucket> &parsed) const {
+    SmallVector<StringRef, 4> bucketStrs;
+    StringRef(buckets).split(bucketStrs, ';', -1, /*KeepEmpty=*/false);
+    for (StringRef bucketStr : bucketStrs) {
+      ShapeBucket bucket;
+      SmallVector<StringRef, 4> inputStrs;
+      bucketStr.split(inputStrs, ',', -1, /*KeepEmpty=*/false);
+      for (StringRef inputStr : inputStrs) {
+        auto [indexStr, dimsStr] = inputStr.split(':');
+        unsigned index;
+        if (indexStr.trim().getAsInteger(10, index) || dimsStr.empty())
+          return failure();
+        SmallVector<StringRef, 4> dimStrs;
+        dimsStr.split(dimStrs, 'x');
+        SmallVector<int64_t, 4> dims;
+        for (StringRef dimStr : dimStrs) {
+          int64_t dim;
+          if (dimStr.trim().getAsInteger(10, dim) || (dim <= 0 && dim != -1))
+            return failure();
+          dims.emplace_back(dim == -1 ? ShapedType::kDynamic : dim);
+        }
+        bucket[index] = dims;
+      }
+      parsed.emplace_back(bucket);
+    }
+    return success();
+  }
+
+  // Return the input types of a function specialized for a bucket, or an
+  // empty list if the bucket does not match the inputs or does not refine
+  // any of their dimensions.
+  SmallVector<Type, 4> getSpecializedInputTypes(
+      func::FuncOp funcOp, const ShapeBucket &bucket) const {
+    SmallVector<Type, 4> inputTypes(funcOp.getArgumentTypes());
+    bool isRefined = false;
+    for (const auto &[index, dims] : bucket) {
+      if (index >= inputTypes.size())
+        return {};
+      auto type = inputTypes[index].dyn_cast<RankedTensorType>();
+      if (!type || type.getRank() != (int64_t)dims.size())
+        return {};
+      SmallVector<int64_t, 4> shape(type.getShape());
+      for (size_t i = 0; i < dims.size(); ++i) {
+        if (ShapedType::isDynamic(dims[i]) || dims[i] == shape[i])
+          continue;
+        if (!ShapedType::isDynamic(shape[i]))
+          return {};
+        shape[i] = dims[i];
+        isRefined = true;
+      }
+      inputTypes[index] = RankedTensorType::get(shape, type.getElementType());
+    }
+    if (!isRefined)
+      return {};
+    return inputTypes;
+  }
+};
+
+void ShapeSpecializationPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SmallVector<ShapeBucket, 4> parsedBuckets;
+  if (failed(parseBuckets(parsedBuckets))) {
+    module.emitError("malformed shape buckets: ") << buckets;
+    return signalPassFailure();
+  }
+
+  SymbolTable symbolTable(module);
+  SmallVector<func::FuncOp, 1> funcOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    if (auto funcOp = symbolTable.lookup<func::FuncOp>(
+            funcRef.getLeafReference().getValue()))
+      funcOps.emplace_back(funcOp);
+  });
+
+  for (func::FuncOp funcOp : funcOps) {
+    for (size_t b = 0; b < parsedBuckets.size(); ++b) {
+      SmallVector<Type, 4> inputTypes =
+          getSpecializedInputTypes(funcOp, parsedBuckets[b]);
+      if (inputTypes.empty()) {
+        funcOp.emitWarning("shape bucket ")
+            << b << " does not refine the inputs, ignored";
+        continue;
+      }
+      // The name keeps the name of the function as a prefix, so that shape
+      // inference runs on the clone too.
+      func::FuncOp clone = funcOp.clone();
+      clone.setName((funcOp.getName() + "_shape" + Twine(b)).str());
+      clone.setType(FunctionType::get(
+          &getContext(), inputTypes, funcOp.getResultTypes()));
+      for (auto [arg, type] : llvm::zip(clone.getArguments(), inputTypes))
+        arg.setType(type);
+      clone->setAttr("onnx.specialization_of", FlatSymbolRefAttr::get(funcOp));
+      symbolTable.insert(clone, std::next(Block::iterator(funcOp)));
+    }
+  }
+}
+
+} // end anonymous namespace.
+
+std::unique_ptr<Pass> createShapeSpecializationPass() {
+  return std::make_unique<ShapeSpecializationPass>();
+}
+
+std::unique_ptr<Pass> createShapeSpecializationPass(
+    const std::string &buckets) {
+  return std::make_unique<ShapeSpecializationPass>(buckets);
+}
+
+} // namespace onnx_mlir
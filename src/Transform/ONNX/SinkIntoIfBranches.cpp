@@ -0,0 +1,104 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------- SinkIntoIfBranches.cpp - ONNX If Branch Sinking Pass ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// The ops defined before an If whose results are only used by one of its
+// branches are computed, and their buffers allocated, whatever the branch
+// taken, as in
+//   %y = "onnx.MatMul"(%x, %w)
+//   %r = "onnx.If"(%cond) ({ onnx.Return %y }, { onnx.Return %x })
+// This pass moves such ops without side effects into the branch using them, so
+// that the lowering of the If computes them only when the branch is taken. The
+// buffers of their lowering are then allocated inside the scf.if branch, which
+// the memory pool passes leave out of the pools of the function.
+//
+// The constants are left in place: the canonicalizer hoists them back out of
+// the branches and their lowering only references the global data.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return the branch of the If containing all the uses of the results of `op`,
+// or null if there is no such branch.
+Region *getUsingBranch(Operation *op, ONNXIfOp ifOp) {
+  Region *branch = nullptr;
+  for (Operation *user : op->getUsers()) {
+    Region *userBranch = nullptr;
+    for (Region *region : {&ifOp.getThenBranch(), &ifOp.getElseBranch()})
+      if (region->isAncestor(user->getParentRegion()))
+        userBranch = region;
+    if (!userBranch || (branch && branch != userBranch))
+      return nullptr;
+    branch = userBranch;
+  }
+  return branch;
+}
+
+// Move the ops before the If only used by one of its branches into that
+// branch. The ops are visited in reverse order so that the ops only used by
+// the sunk ops are sunk after them.
+void sinkIntoBranches(ONNXIfOp ifOp) {
+  Operation *op = ifOp->getPrevNode();
+  while (op) {
+    Operation *prevOp = op->getPrevNode();
+    if (op->getNumRegions() == 0 && !op->hasTrait<OpTrait::ConstantLike>() &&
+        !op->use_empty() && isMemoryEffectFree(op)) {
+      if (Region *branch = getUsingBranch(op, ifOp))
+        op->moveBefore(&branch->front(), branch->front().begin());
+    }
+    op = prevOp;
+  }
+}
+
+struct SinkIntoIfBranchesONNXToONNXPass
+    : public PassWrapper<SinkIntoIfBranchesONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(SinkIntoIfBranchesONNXToONNXPass)
+
+  StringRef getArgument() const override {
+    return "sink-into-if-branches-onnx";
+  }
+
+  StringRef getDescription() const override {
+    return "Move the ops only used by one branch of an If into that branch.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    // The outer Ifs are visited first, so that the ops sunk into their
+    // branches are sunk further into the nested Ifs.
+    SmallVector<ONNXIfOp, 4> ifOps;
+    function.walk<WalkOrder::PreOrder>(
+        [&](ONNXIfOp ifOp) { ifOps.push_back(ifOp); });
+    for (ONNXIfOp ifOp : ifOps)
+      sinkIntoBranches(ifOp);
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a SinkIntoIfBranches pass.
+ */
+std::unique_ptr<mlir::Pass> createSinkIntoIfBranchesONNXToONNXPass() {
+  return std::make_unique<SinkIntoIfBranchesONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
@@ -0,0 +1,465 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------- SinkTranspose.cpp - ONNX Transpose Sinking Pass ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// Models exported from frameworks computing in the NHWC layout are full of
+// chains such as
+//   Transpose -> Add(constant) -> Mul -> Transpose
+// whose transposes each lower to a full strided pass over memory. This pass
+// moves the transposes past the ops that compute the same on permuted
+// operands, namely the elementwise ops, with their constant operands
+// permuted at compile time, Concat and Split, with their axis remapped, the
+// reductions and Pad. The transposes meeting along the way are then combined
+// by the canonicalization patterns of ONNXTransposeOp, and removed when their
+// combined permutation is the identity.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Dialect/ONNX/ONNXOps/OpHelper.hpp"
+#include "src/Pass/Passes.hpp"
+#include "src/Support/TypeUtilities.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Get the permutation of a transpose, the reversed dims by default.
+SmallVector<int64_t, 4> getPermutation(ONNXTransposeOp transposeOp) {
+  SmallVector<int64_t, 4> perm;
+  int64_t rank = getRank(transposeOp.getData().getType());
+  if (ArrayAttr permAttr = transposeOp.getPermAttr()) {
+    for (Attribute attr : permAttr)
+      perm.emplace_back(attr.cast<IntegerAttr>().getInt());
+  } else {
+    for (int64_t i = rank - 1; i >= 0; --i)
+      perm.emplace_back(i);
+  }
+  return perm;
+}
+
+// Return the transpose defining the value when it can be moved past its user,
+// namely when the value has no other use and is not a transpose of a
+// transpose, which is combined first, or null.
+ONNXTransposeOp getSinkableTranspose(Value value) {
+  auto transposeOp = value.getDefiningOp<ONNXTransposeOp>();
+  if (!transposeOp || !transposeOp->hasOneUse() ||
+      !isRankedShapedType(transposeOp.getData().getType()) ||
+      transposeOp.getData().getDefiningOp<ONNXTransposeOp>())
+    return nullptr;
+  return transposeOp;
+}
+
+// Get the type whose transpose by perm is the given type.
+Type getUntransposedType(Type type, ArrayRef<int64_t> perm) {
+  ArrayRef<int64_t> shape = getShape(type);
+  SmallVector<int64_t, 4> untransposedShape(shape.size());
+  for (size_t i = 0; i < perm.size(); ++i)
+    untransposedShape[perm[i]] = shape[i];
+  return RankedTensorType::get(untransposedShape, getElementType(type));
+}
+
+// Check that the type is a ranked tensor of the given rank.
+bool isRankedWithRank(Type type, int64_t rank) {
+  return isRankedShapedType(type) && getRank(type) == rank;
+}
+
+// Create the op of the same name and attributes as op on the new operands and
+// with the new result types.
+Operation *cloneWithOperands(PatternRewriter &rewriter, Operation *op,
+    ValueRange operands, TypeRange resultTypes,
+    ArrayRef<NamedAttribute> attrs) {
+  OperationState state(
+      op->getLoc(), op->getName(), operands, resultTypes, attrs);
+  return rewriter.create(state);
+}
+
+// Get the untransposed operands of an op computing the same on permuted
+// operands, all the transposed operands having the same permutation. The
+// operands of a single element, such as the scalars, broadcast the same on
+// any permutation, and the constants are permuted at compile time. Return
+// false if another operand cannot be untransposed or if no operand is
+// transposed.
+bool getUntransposedOperands(PatternRewriter &rewriter, Operation *op,
+    int64_t rank, SmallVectorImpl<Value> &operands,
+    SmallVectorImpl<int64_t> &perm) {
+  operands.clear();
+  perm.clear();
+  for (Value operand : op->getOperands()) {
+    ONNXTransposeOp transposeOp = getSinkableTranspose(operand);
+    if (!transposeOp)
+      continue;
+    SmallVector<int64_t, 4> operandPerm = getPermutation(transposeOp);
+    if (!perm.empty() && operandPerm != ArrayRef<int64_t>(perm))
+      return false;
+    perm.assign(operandPerm.begin(), operandPerm.end());
+  }
+  if (perm.empty() || (int64_t)perm.size() != rank)
+    return false;
+
+  // Inverse permutation, permuting constants back.
+  SmallVector<int64_t, 4> invPerm(rank);
+  for (int64_t i = 0; i < rank; ++i)
+    invPerm[perm[i]] = i;
+
+  for (Value operand : op->getOperands()) {
+    ONNXTransposeOp transposeOp = getSinkableTranspose(operand);
+    if (transposeOp) {
+      operands.emplace_back(transposeOp.getData());
+      continue;
+    }
+    Type type = operand.getType();
+    if (isFromNone(operand) ||
+        (isRankedShapedType(type) && getRank(type) <= rank &&
+            hasStaticShape(type) &&
+            type.cast<ShapedType>().getNumElements() == 1)) {
+      operands.emplace_back(operand);
+      continue;
+    }
+    if (!isDenseONNXConstant(operand) || !isRankedWithRank(type, rank))
+      return false;
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    operands.emplace_back(create.onnx.transpose(getUntransposedType(type, perm),
+        operand, rewriter.getI64ArrayAttr(invPerm)));
+  }
+  return true;
+}
+
+/// Rewrite
+/// ```
+///   %xt = "onnx.Transpose"(%x) {perm = [0, 2, 3, 1]}
+///   %Y = "onnx.Add"(%xt, %c)
+/// ```
+/// into
+/// ```
+///   %ct = "onnx.Transpose"(%c) {perm = [0, 3, 1, 2]}
+///   %y = "onnx.Add"(%x, %ct)
+///   %Y = "onnx.Transpose"(%y) {perm = [0, 2, 3, 1]}
+/// ```
+/// for an elementwise op, the constant transpose being folded by the constant
+/// propagation.
+template <typename OP>
+struct SinkTransposeThroughElementwisePattern : public OpRewritePattern<OP> {
+  using OpRewritePattern<OP>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      OP elementwiseOp, PatternRewriter &rewriter) const final {
+    Operation *op = elementwiseOp.getOperation();
+    if (op->getNumResults() != 1 ||
+        !isRankedShapedType(op->getResult(0).getType()))
+      return failure();
+    Type resultType = op->getResult(0).getType();
+    SmallVector<Value, 4> operands;
+    SmallVector<int64_t, 4> perm;
+    if (!getUntransposedOperands(
+            rewriter, op, getRank(resultType), operands, perm))
+      return failure();
+
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    Operation *untransposedOp = cloneWithOperands(rewriter, op, operands,
+        {getUntransposedType(resultType, perm)}, op->getAttrs());
+    Value transposed = create.onnx.transpose(resultType,
+        untransposedOp->getResult(0), rewriter.getI64ArrayAttr(perm));
+    rewriter.replaceOp(op, transposed);
+    return success();
+  }
+};
+
+/// Rewrite
+/// ```
+///   %Y = "onnx.Concat"(%at, %bt) {axis = i}
+/// ```
+/// with %at and %bt transposes by perm of %a and %b into
+/// ```
+///   %y = "onnx.Concat"(%a, %b) {axis = perm[i]}
+///   %Y = "onnx.Transpose"(%y) {perm = perm}
+/// ```
+struct SinkTransposeThroughConcatPattern
+    : public OpRewritePattern<ONNXConcatOp> {
+  using OpRewritePattern<ONNXConcatOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXConcatOp concatOp, PatternRewriter &rewriter) const final {
+    Operation *op = concatOp.getOperation();
+    Type resultType = concatOp.getResult().getType();
+    if (!isRankedShapedType(resultType))
+      return failure();
+    int64_t rank = getRank(resultType);
+    SmallVector<Value, 4> operands;
+    SmallVector<int64_t, 4> perm;
+    if (!getUntransposedOperands(rewriter, op, rank, operands, perm))
+      return failure();
+
+    int64_t axis = concatOp.getAxis();
+    axis = axis < 0 ? axis + rank : axis;
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    Value concat = create.onnx.concat(
+        getUntransposedType(resultType, perm), operands, perm[axis]);
+    Value transposed = create.onnx.transpose(
+        resultType, concat, rewriter.getI64ArrayAttr(perm));
+    rewriter.replaceOp(op, transposed);
+    return success();
+  }
+};
+
+/// Rewrite
+/// ```
+///   %xt = "onnx.Transpose"(%x) {perm = perm}
+///   %Y0, %Y1 = "onnx.Split"(%xt, %split) {axis = i}
+/// ```
+/// into
+/// ```
+///   %y0, %y1 = "onnx.Split"(%x, %split) {axis = perm[i]}
+///   %Y0 = "onnx.Transpose"(%y0) {perm = perm}
+///   %Y1 = "onnx.Transpose"(%y1) {perm = perm}
+/// ```
+/// The transposes of the parts move the same amount of data as the one of the
+/// whole tensor, and may then cancel out with the following ones.
+struct SinkTransposeThroughSplitPattern : public OpRewritePattern<ONNXSplitOp> {
+  using OpRewritePattern<ONNXSplitOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXSplitOp splitOp, PatternRewriter &rewriter) const final {
+    Operation *op = splitOp.getOperation();
+    ONNXTransposeOp transposeOp = getSinkableTranspose(splitOp.getInput());
+    if (!transposeOp)
+      return failure();
+    SmallVector<int64_t, 4> perm = getPermutation(transposeOp);
+    int64_t rank = perm.size();
+    SmallVector<Type, 4> untransposedTypes;
+    for (Value result : op->getResults()) {
+      if (!isRankedWithRank(result.getType(), rank))
+        return failure();
+      untransposedTypes.emplace_back(
+          getUntransposedType(result.getType(), perm));
+    }
+
+    int64_t axis = splitOp.getAxis();
+    axis = axis < 0 ? axis + rank : axis;
+    NamedAttrList attrs(op->getAttrDictionary());
+    attrs.set("axis", rewriter.getIntegerAttr(
+                          rewriter.getIntegerType(64, /*isSigned=*/true),
+                          perm[axis]));
+    Operation *untransposedOp = cloneWithOperands(rewriter, op,
+        {transposeOp.getData(), splitOp.getSplit()}, untransposedTypes,
+        attrs.getAttrs());
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    SmallVector<Value, 4> transposed;
+    for (auto result : llvm::enumerate(op->getResults()))
+      transposed.emplace_back(create.onnx.transpose(result.value().getType(),
+          untransposedOp->getResult(result.index()),
+          rewriter.getI64ArrayAttr(perm)));
+    rewriter.replaceOp(op, transposed);
+    return success();
+  }
+};
+
+/// Rewrite
+/// ```
+///   %xt = "onnx.Transpose"(%x) {perm = perm}
+///   %Y = "onnx.ReduceSum"(%xt, %axes) {keepdims = 1}
+/// ```
+/// into
+/// ```
+///   %y = "onnx.ReduceSum"(%x, perm[%axes]) {keepdims = 1}
+///   %Y = "onnx.Transpose"(%y) {perm = perm}
+/// ```
+/// for a reduction along constant axes. Without keepdims, the result is
+/// transposed by the permutation of the dims that are kept.
+template <typename OP>
+struct SinkTransposeThroughReductionPattern : public OpRewritePattern<OP> {
+  using OpRewritePattern<OP>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      OP reductionOp, PatternRewriter &rewriter) const final {
+    Operation *op = reductionOp.getOperation();
+    ONNXTransposeOp transposeOp =
+        getSinkableTranspose(reductionOp.getData());
+    Value axesValue = reductionOp.getAxes();
+    Type resultType = reductionOp.getResult().getType();
+    if (!transposeOp || !isDenseONNXConstant(axesValue) ||
+        !isRankedShapedType(resultType))
+      return failure();
+    SmallVector<int64_t, 4> perm = getPermutation(transposeOp);
+    int64_t rank = perm.size();
+
+    // Reduced dims, in the transposed and the untransposed tensors.
+    SmallVector<bool, 4> isReduced(rank, false);
+    SmallVector<int64_t, 4> untransposedAxes;
+    ElementsAttr axesAttr = getElementAttributeFromONNXValue(axesValue);
+    for (IntegerAttr axisAttr : axesAttr.getValues<IntegerAttr>()) {
+      int64_t axis = axisAttr.getInt();
+      axis = axis < 0 ? axis + rank : axis;
+      isReduced[axis] = true;
+      untransposedAxes.emplace_back(perm[axis]);
+    }
+    if (untransposedAxes.empty())
+      return failure();
+
+    // Permutation of the result, the one of the dims that are kept without
+    // keepdims.
+    SmallVector<int64_t, 4> resultPerm;
+    if (reductionOp.getKeepdims() == 1) {
+      resultPerm = perm;
+    } else {
+      for (int64_t i = 0; i < rank; ++i) {
+        if (isReduced[i])
+          continue;
+        // Position of the untransposed dim among the kept ones.
+        int64_t pos = 0;
+        for (int64_t j = 0; j < rank; ++j)
+          if (!isReduced[j] && perm[j] < perm[i])
+            ++pos;
+        resultPerm.emplace_back(pos);
+      }
+    }
+    if (!isRankedWithRank(resultType, resultPerm.size()))
+      return failure();
+
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    Value axes = create.onnx.constantInt64(untransposedAxes);
+    Operation *untransposedOp = cloneWithOperands(rewriter, op,
+        {transposeOp.getData(), axes},
+        {getUntransposedType(resultType, resultPerm)}, op->getAttrs());
+    Value transposed = create.onnx.transpose(resultType,
+        untransposedOp->getResult(0), rewriter.getI64ArrayAttr(resultPerm));
+    rewriter.replaceOp(op, transposed);
+    return success();
+  }
+};
+
+/// Rewrite
+/// ```
+///   %xt = "onnx.Transpose"(%x) {perm = perm}
+///   %Y = "onnx.Pad"(%xt, %pads, %value)
+/// ```
+/// into
+/// ```
+///   %y = "onnx.Pad"(%x, perm[%pads], %value)
+///   %Y = "onnx.Transpose"(%y) {perm = perm}
+/// ```
+/// for constant pads, in any mode.
+struct SinkTransposeThroughPadPattern : public OpRewritePattern<ONNXPadOp> {
+  using OpRewritePattern<ONNXPadOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(
+      ONNXPadOp padOp, PatternRewriter &rewriter) const final {
+    Operation *op = padOp.getOperation();
+    ONNXTransposeOp transposeOp = getSinkableTranspose(padOp.getData());
+    Value padsValue = padOp.getPads();
+    Type resultType = padOp.getResult().getType();
+    if (!transposeOp || !isDenseONNXConstant(padsValue))
+      return failure();
+    SmallVector<int64_t, 4> perm = getPermutation(transposeOp);
+    int64_t rank = perm.size();
+    ElementsAttr padsAttr = getElementAttributeFromONNXValue(padsValue);
+    if (!isRankedWithRank(resultType, rank) ||
+        padsAttr.getNumElements() != 2 * rank)
+      return failure();
+
+    // Begin pads of all the dims, followed by their end pads.
+    SmallVector<int64_t, 8> pads, untransposedPads(2 * rank);
+    for (IntegerAttr padAttr : padsAttr.getValues<IntegerAttr>())
+      pads.emplace_back(padAttr.getInt());
+    for (int64_t i = 0; i < rank; ++i) {
+      untransposedPads[perm[i]] = pads[i];
+      untransposedPads[rank + perm[i]] = pads[rank + i];
+    }
+
+    MultiDialectBuilder<OnnxBuilder> create(rewriter, op->getLoc());
+    Value untransposedPadsValue = create.onnx.constantInt64(untransposedPads);
+    Operation *untransposedOp = cloneWithOperands(rewriter, op,
+        {transposeOp.getData(), untransposedPadsValue,
+            padOp.getConstantValue()},
+        {getUntransposedType(resultType, perm)}, op->getAttrs());
+    Value transposed = create.onnx.transpose(resultType,
+        untransposedOp->getResult(0), rewriter.getI64ArrayAttr(perm));
+    rewriter.replaceOp(op, transposed);
+    return success();
+  }
+};
+
+template <typename OP>
+using ElementwisePattern = SinkTransposeThroughElementwisePattern<OP>;
+template <typename OP>
+using ReductionPattern = SinkTransposeThroughReductionPattern<OP>;
+
+struct SinkTransposeONNXToONNXPass
+    : public PassWrapper<SinkTransposeONNXToONNXPass,
+          OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(SinkTransposeONNXToONNXPass)
+
+  StringRef getArgument() const override { return "sink-transpose-onnx"; }
+
+  StringRef getDescription() const override {
+    return "Move the transposes past the ops computing the same on permuted "
+           "operands, so that they cancel out.";
+  }
+
+  void runOnOperation() final {
+    func::FuncOp function = getOperation();
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    // Unary elementwise ops, the other operands of Clip being scalars.
+    patterns.insert<ElementwisePattern<ONNXAbsOp>,
+        ElementwisePattern<ONNXCastOp>, ElementwisePattern<ONNXCeilOp>,
+        ElementwisePattern<ONNXClipOp>, ElementwisePattern<ONNXEluOp>,
+        ElementwisePattern<ONNXErfOp>, ElementwisePattern<ONNXExpOp>,
+        ElementwisePattern<ONNXFloorOp>,
+        ElementwisePattern<ONNXHardSigmoidOp>,
+        ElementwisePattern<ONNXLeakyReluOp>, ElementwisePattern<ONNXLogOp>,
+        ElementwisePattern<ONNXNegOp>, ElementwisePattern<ONNXReciprocalOp>,
+        ElementwisePattern<ONNXReluOp>, ElementwisePattern<ONNXSeluOp>,
+        ElementwisePattern<ONNXSigmoidOp>, ElementwisePattern<ONNXSoftplusOp>,
+        ElementwisePattern<ONNXSqrtOp>, ElementwisePattern<ONNXTanhOp>>(
+        context);
+    // Binary and variadic elementwise ops, with broadcast.
+    patterns.insert<ElementwisePattern<ONNXAddOp>,
+        ElementwisePattern<ONNXDivOp>, ElementwisePattern<ONNXEqualOp>,
+        ElementwisePattern<ONNXGreaterOp>, ElementwisePattern<ONNXLessOp>,
+        ElementwisePattern<ONNXMaxOp>, ElementwisePattern<ONNXMinOp>,
+        ElementwisePattern<ONNXMulOp>, ElementwisePattern<ONNXPowOp>,
+        ElementwisePattern<ONNXSubOp>, ElementwisePattern<ONNXSumOp>,
+        ElementwisePattern<ONNXWhereOp>>(context);
+    // Ops along axes.
+    patterns.insert<SinkTransposeThroughConcatPattern,
+        SinkTransposeThroughSplitPattern, SinkTransposeThroughPadPattern>(
+        context);
+    patterns.insert<ReductionPattern<ONNXReduceL1Op>,
+        ReductionPattern<ONNXReduceL2Op>,
+        ReductionPattern<ONNXReduceLogSumOp>,
+        ReductionPattern<ONNXReduceLogSumExpOp>,
+        ReductionPattern<ONNXReduceMaxOp>, ReductionPattern<ONNXReduceMeanOp>,
+        ReductionPattern<ONNXReduceMinOp>, ReductionPattern<ONNXReduceProdOp>,
+        ReductionPattern<ONNXReduceSumOp>,
+        ReductionPattern<ONNXReduceSumSquareOp>>(context);
+    // Combine the transposes meeting along the way.
+    ONNXTransposeOp::getCanonicalizationPatterns(patterns, context);
+    if (failed(applyPatternsAndFoldGreedily(function, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+/*!
+ * Create a SinkTranspose pass.
+ */
+std::unique_ptr<mlir::Pass> createSinkTransposeONNXToONNXPass() {
+  return std::make_unique<SinkTransposeONNXToONNXPass>();
+}
+
+} // namespace onnx_mlir
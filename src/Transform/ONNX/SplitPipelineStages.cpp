@@ -0,0 +1,404 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ SplitPipelineStages.cpp - Split models into pipeline stages ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that splits each entry point function of a
+// model into a given number of pipeline stages, each stage being a function
+// computing a contiguous range of the ops of the model with an entry point of
+// its own. The stages are balanced by the estimated cost of their ops, namely
+// the flops of the op and the bytes it reads and writes.
+//
+// The first stage takes the inputs of the model and the last one returns its
+// outputs. The activations computed by a stage and used by the following ones
+// are returned by the stage and passed to the next one, along with the values
+// it only passes through, as in
+//   func.func @main_graph_stage0(%x) -> (%x, %y) { %y = ... }
+//   func.func @main_graph_stage1(%x, %y) -> (%z) { %z = ...(%x, %y) }
+// The outputs of a stage are thus the inputs of the next one, with the same
+// names in the signatures, so that a runtime pipeline executor, such as
+// ExecutionPipeline, can run the stages on different sockets, each stage
+// working on a batch while the next stage works on the previous batch. The
+// constants are cloned into the stages using them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+#define DEBUG_TYPE "split-pipeline-stages"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+// Return the number of elements of a shaped type, counting the dynamic dims
+// as 1, or 1 for other types.
+double getNumElements(Type type) {
+  auto shapedType = type.dyn_cast<ShapedType>();
+  if (!shapedType || !shapedType.hasRank())
+    return 1;
+  double numElements = 1;
+  for (int64_t dim : shapedType.getShape())
+    if (!ShapedType::isDynamic(dim))
+      numElements *= dim;
+  return numElements;
+}
+
+// Return the number of bytes of a value, counting the dynamic dims as 1.
+double getNumBytes(Value value) {
+  Type type = value.getType();
+  auto shapedType = type.dyn_cast<ShapedType>();
+  if (!shapedType || !shapedType.getElementType().isIntOrFloat())
+    return 0;
+  unsigned bitWidth = shapedType.getElementType().getIntOrFloatBitWidth();
+  return getNumElements(type) * ((bitWidth + 7) / 8);
+}
+
+// Return the number of flops of an op: the multiply-adds of the Gemm, MatMul
+// and Conv ops, and one flop per result element for the other ops.
+double getNumFlops(Operation *op) {
+  if (op->getNumResults() == 0)
+    return 0;
+  double numResultElements = getNumElements(op->getResult(0).getType());
+  if (isa<ONNXMatMulOp, ONNXGemmOp>(op)) {
+    auto aType = op->getOperand(0).getType().dyn_cast<ShapedType>();
+    if (aType && aType.hasRank() && aType.getRank() > 0) {
+      int64_t rank = aType.getRank();
+      bool transA = false;
+      if (auto gemmOp = dyn_cast<ONNXGemmOp>(op))
+        transA = gemmOp.getTransA() != 0;
+      int64_t K = aType.getShape()[transA ? rank - 2 : rank - 1];
+      return 2 * numResultElements * (ShapedType::isDynamic(K) ? 1 : K);
+    }
+  }
+  if (auto convOp = dyn_cast<ONNXConvOp>(op)) {
+    auto wType = convOp.getW().getType().dyn_cast<ShapedType>();
+    if (wType && wType.hasRank() && wType.getRank() > 0) {
+      // Each result element is computed from C / group * kH * kW inputs.
+      int64_t M = wType.getShape()[0];
+      double kernelSize =
+          getNumElements(wType) / (ShapedType::isDynamic(M) ? 1 : M);
+      return 2 * numResultElements * kernelSize;
+    }
+  }
+  return numResultElements;
+}
+
+// Return the estimated cost of an op: its flops and the bytes it reads and
+// writes. The cost of an op with regions, e.g. an If or a Loop, is the one of
+// the ops of its regions.
+double getOpCost(Operation *op) {
+  if (op->getNumRegions() > 0) {
+    double cost = 0;
+    for (Region &region : op->getRegions())
+      region.walk([&](Operation *nestedOp) {
+        if (nestedOp->getNumRegions() == 0 &&
+            !nestedOp->hasTrait<OpTrait::ConstantLike>())
+          cost += getOpCost(nestedOp);
+      });
+    return cost;
+  }
+  double cost = getNumFlops(op);
+  for (Value operand : op->getOperands())
+    cost += getNumBytes(operand);
+  for (Value result : op->getResults())
+    cost += getNumBytes(result);
+  return cost;
+}
+
+struct SplitPipelineStagesPass
+    : public PassWrapper<SplitPipelineStagesPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(SplitPipelineStagesPass)
+
+  StringRef getArgument() const override { return "split-pipeline-stages"; }
+
+  StringRef getDescription() const override {
+    return "Split the entry point functions into pipeline stages of balanced "
+           "cost.";
+  }
+
+  Option<int> numStages{*this, "num-stages",
+      llvm::cl::desc("Number of pipeline stages of each entry point function"),
+      llvm::cl::init(1)};
+
+  SplitPipelineStagesPass() = default;
+  SplitPipelineStagesPass(const SplitPipelineStagesPass &pass)
+      : PassWrapper<SplitPipelineStagesPass, OperationPass<ModuleOp>>() {}
+  SplitPipelineStagesPass(int numStages) { this->numStages = numStages; }
+
+  void runOnOperation() final;
+
+private:
+  // Split a function into stages, each with an entry point inserted before
+  // the given entry point of the function. Return failure if the function
+  // cannot be split.
+  LogicalResult splitIntoStages(SymbolTable &symbolTable, func::FuncOp funcOp,
+      ONNXEntryPointOp entryPointOp) const;
+};
+
+LogicalResult SplitPipelineStagesPass::splitIntoStages(SymbolTable &symbolTable,
+    func::FuncOp funcOp, ONNXEntryPointOp entryPointOp) const {
+  if (!funcOp.getBody().hasOneBlock())
+    return failure();
+  Block &body = funcOp.getBody().front();
+  Operation *terminator = body.getTerminator();
+
+  // The constants are cloned into the stages using them, and the other ops
+  // are assigned to stages in order.
+  SmallVector<Operation *, 32> ops;
+  for (Operation &op : body.without_terminator())
+    if (!op.hasTrait<OpTrait::ConstantLike>())
+      ops.emplace_back(&op);
+  int64_t K = std::min<int64_t>(numStages, ops.size());
+  if (K <= 1)
+    return failure();
+
+  // Cut the ops into contiguous stages, an op starting the next stage when
+  // more than half of its cost exceeds the share of the stage, or when each
+  // following stage needs one of the remaining ops.
+  SmallVector<double, 32> costs;
+  double totalCost = 0;
+  for (Operation *op : ops) {
+    costs.emplace_back(getOpCost(op));
+    totalCost += costs.back();
+  }
+  DenseMap<Operation *, int64_t> opStages;
+  SmallVector<double, 4> stageCosts(K, 0);
+  SmallVector<int64_t, 4> stageSizes(K, 0);
+  double accumulatedCost = 0;
+  int64_t stage = 0;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    int64_t remainingOps = ops.size() - i;
+    if (stage < K - 1 && stageSizes[stage] > 0 &&
+        (accumulatedCost + costs[i] / 2 > totalCost * (stage + 1) / K ||
+            remainingOps == K - 1 - stage))
+      ++stage;
+    opStages[ops[i]] = stage;
+    stageCosts[stage] += costs[i];
+    ++stageSizes[stage];
+    accumulatedCost += costs[i];
+  }
+  LLVM_DEBUG({
+    for (int64_t s = 0; s < K; ++s)
+      llvm::dbgs() << funcOp.getName() << " stage " << s << ", cost "
+                   << stageCosts[s] << "\n";
+  });
+
+  // Return the stage of the top-level op using a value, K for the terminator.
+  auto getUserStage = [&](Operation *user) -> int64_t {
+    Operation *op = body.findAncestorOpInBlock(*user);
+    if (op == terminator)
+      return K;
+    auto it = opStages.find(op);
+    return it == opStages.end() ? -1 : it->second;
+  };
+
+  // The values computed by a stage, or inputs of the model, that are used by
+  // the following stages, with the stage defining them, -1 for the inputs,
+  // and the last stage using them.
+  struct CrossingValue {
+    Value value;
+    int64_t defStage;
+    int64_t lastUseStage;
+  };
+  SmallVector<CrossingValue, 32> crossingValues;
+  auto addCrossingValue = [&](Value value, int64_t defStage) {
+    int64_t lastUseStage = defStage;
+    for (Operation *user : value.getUsers())
+      lastUseStage = std::max(lastUseStage, getUserStage(user));
+    if (lastUseStage > defStage)
+      crossingValues.push_back({value, defStage, lastUseStage});
+  };
+  for (BlockArgument arg : funcOp.getArguments())
+    addCrossingValue(arg, -1);
+  for (Operation *op : ops)
+    for (Value result : op->getResults())
+      addCrossingValue(result, opStages[op]);
+
+  // Names of the inputs and outputs of the stages, the intermediate values
+  // being named by their index in the crossing values.
+  ArrayAttr inputNames = funcOp->getAttrOfType<ArrayAttr>("input_names");
+  ArrayAttr outputNames = funcOp->getAttrOfType<ArrayAttr>("output_names");
+  auto getInputName = [&](unsigned i) -> std::string {
+    if (inputNames && i < inputNames.size())
+      return inputNames[i].cast<StringAttr>().str();
+    return "input_" + std::to_string(i);
+  };
+  auto getOutputName = [&](unsigned i) -> std::string {
+    if (outputNames && i < outputNames.size())
+      return outputNames[i].cast<StringAttr>().str();
+    return "output_" + std::to_string(i);
+  };
+  auto getCrossingValueName = [&](unsigned index) -> std::string {
+    Value value = crossingValues[index].value;
+    if (auto arg = value.dyn_cast<BlockArgument>())
+      return getInputName(arg.getArgNumber());
+    return "activation_" + std::to_string(index);
+  };
+
+  // Return the inputs of a stage, with their names: the inputs of the model
+  // for the first stage, and the values defined before the stage and used by
+  // it or the following ones for the other stages.
+  auto getStageInputs = [&](int64_t s, SmallVectorImpl<Value> &values,
+                            SmallVectorImpl<std::string> &names) {
+    if (s == 0) {
+      for (BlockArgument arg : funcOp.getArguments()) {
+        values.emplace_back(arg);
+        names.emplace_back(getInputName(arg.getArgNumber()));
+      }
+      return;
+    }
+    for (unsigned i = 0; i < crossingValues.size(); ++i) {
+      const CrossingValue &crossingValue = crossingValues[i];
+      if (crossingValue.defStage < s && crossingValue.lastUseStage >= s) {
+        values.emplace_back(crossingValue.value);
+        names.emplace_back(getCrossingValueName(i));
+      }
+    }
+  };
+
+  MLIRContext *context = &getContext();
+  Location loc = funcOp.getLoc();
+  OpBuilder entryPointBuilder(entryPointOp);
+  for (int64_t s = 0; s < K; ++s) {
+    SmallVector<Value, 8> inputs, outputs;
+    SmallVector<std::string, 8> inputStageNames, outputStageNames;
+    getStageInputs(s, inputs, inputStageNames);
+    if (s == K - 1) {
+      for (auto operand : llvm::enumerate(terminator->getOperands())) {
+        outputs.emplace_back(operand.value());
+        outputStageNames.emplace_back(getOutputName(operand.index()));
+      }
+    } else {
+      getStageInputs(s + 1, outputs, outputStageNames);
+    }
+
+    // The name keeps the name of the function as a prefix, so that the
+    // stages are recognized as parts of the function.
+    SmallVector<Type, 8> inputTypes, outputTypes;
+    for (Value value : inputs)
+      inputTypes.emplace_back(value.getType());
+    for (Value value : outputs)
+      outputTypes.emplace_back(value.getType());
+    auto stageFunc = func::FuncOp::create(loc,
+        (funcOp.getName() + "_stage" + Twine(s)).str(),
+        FunctionType::get(context, inputTypes, outputTypes));
+    SmallVector<StringRef, 8> inputStageNameRefs(
+        inputStageNames.begin(), inputStageNames.end());
+    SmallVector<StringRef, 8> outputStageNameRefs(
+        outputStageNames.begin(), outputStageNames.end());
+    OpBuilder builder(context);
+    stageFunc->setAttr(
+        "input_names", builder.getStrArrayAttr(inputStageNameRefs));
+    stageFunc->setAttr(
+        "output_names", builder.getStrArrayAttr(outputStageNameRefs));
+    symbolTable.insert(stageFunc, Block::iterator(funcOp));
+
+    // Clone the ops of the stage, and the constants they use.
+    Block *entryBlock = stageFunc.addEntryBlock();
+    builder.setInsertionPointToEnd(entryBlock);
+    IRMapping mapping;
+    for (auto [input, arg] : llvm::zip(inputs, entryBlock->getArguments()))
+      mapping.map(input, arg);
+    auto mapConstant = [&](Value value) {
+      if (mapping.contains(value))
+        return;
+      Operation *constantOp = value.getDefiningOp();
+      assert(constantOp && constantOp->hasTrait<OpTrait::ConstantLike>() &&
+             "Value of another stage not passed to the stage");
+      builder.clone(*constantOp, mapping);
+    };
+    for (Operation *op : ops) {
+      if (opStages[op] != s)
+        continue;
+      for (Value operand : op->getOperands())
+        mapConstant(operand);
+      llvm::SetVector<Value> usedValues;
+      getUsedValuesDefinedAbove(op->getRegions(), usedValues);
+      for (Value value : usedValues)
+        mapConstant(value);
+      builder.clone(*op, mapping);
+    }
+    SmallVector<Value, 8> results;
+    for (Value value : outputs) {
+      mapConstant(value);
+      results.emplace_back(mapping.lookup(value));
+    }
+    builder.create<func::ReturnOp>(loc, results);
+
+    entryPointBuilder.create<ONNXEntryPointOp>(
+        entryPointOp.getLoc(), stageFunc);
+  }
+  return success();
+}
+
+void SplitPipelineStagesPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  if (numStages <= 1)
+    return;
+
+  SymbolTable symbolTable(module);
+  // The specializations of the entry point functions for shapes are
+  // dispatched from their function, which is removed once split.
+  bool hasSpecializations = false;
+  module.walk([&](func::FuncOp funcOp) {
+    if (funcOp->hasAttr("onnx.specialization_of"))
+      hasSpecializations = true;
+  });
+  if (hasSpecializations) {
+    module.emitWarning("the entry point functions specialized for shapes are "
+                       "not split into pipeline stages");
+    return;
+  }
+
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    if (!funcOp || funcOp.isExternal())
+      continue;
+    if (failed(splitIntoStages(symbolTable, funcOp, entryPointOp))) {
+      funcOp.emitWarning("cannot be split into ")
+          << numStages << " pipeline stages, ignored";
+      continue;
+    }
+    // The stages replace the function.
+    entryPointOp.erase();
+    symbolTable.erase(funcOp);
+  }
+}
+
+} // end anonymous namespace.
+
+std::unique_ptr<Pass> createSplitPipelineStagesPass() {
+  return std::make_unique<SplitPipelineStagesPass>();
+}
+
+std::unique_ptr<Pass> createSplitPipelineStagesPass(int numStages) {
+  return std::make_unique<SplitPipelineStagesPass>(numStages);
+}
+
+} // namespace onnx_mlir
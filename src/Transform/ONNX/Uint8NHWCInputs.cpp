@@ -0,0 +1,134 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ Uint8NHWCInputs.cpp - Accept images as uint8 NHWC inputs ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file implements a pass that changes the type of the image inputs of
+// the entry point functions named by the user, of float NCHW tensors, into
+// the uint8 NHWC tensors of the decoded images, so that the callers feed the
+// images as decoded instead of converting and transposing them first. The
+// input is converted back by a Cast to the float type followed by a
+// Transpose to NCHW at the start of the function. The convolutions reading
+// them, typically the first layer once its input normalization is folded into
+// it, read the uint8 NHWC input directly when lowered to Krnl, so that neither
+// the cast nor the transposed input are materialized.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/SmallSet.h"
+
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+
+namespace {
+
+struct Uint8NHWCInputsPass
+    : public PassWrapper<Uint8NHWCInputsPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(Uint8NHWCInputsPass)
+
+  StringRef getArgument() const override { return "uint8-nhwc-inputs"; }
+
+  StringRef getDescription() const override {
+    return "Take the given image inputs as uint8 NHWC tensors.";
+  }
+
+  Option<std::string> inputs{*this, "inputs",
+      llvm::cl::desc("Names of the 4D float NCHW inputs separated by \",\""),
+      llvm::cl::init("")};
+
+  Uint8NHWCInputsPass() = default;
+  Uint8NHWCInputsPass(const Uint8NHWCInputsPass &pass)
+      : PassWrapper<Uint8NHWCInputsPass, OperationPass<ModuleOp>>() {}
+  Uint8NHWCInputsPass(const std::string &inputs) { this->inputs = inputs; }
+
+  void runOnOperation() final;
+
+private:
+  // Take the input of a function as a uint8 NHWC tensor, converted back to
+  // its NCHW type for its users. Return failure if it is not a 4D float
+  // tensor.
+  LogicalResult takeAsUint8NHWC(BlockArgument input);
+};
+
+LogicalResult Uint8NHWCInputsPass::takeAsUint8NHWC(BlockArgument input) {
+  auto type = input.getType().dyn_cast<RankedTensorType>();
+  if (!type || type.getRank() != 4 || !type.getElementType().isa<FloatType>())
+    return failure();
+  ArrayRef<int64_t> shape = type.getShape();
+  auto uint8Type = IntegerType::get(&getContext(), 8, IntegerType::Unsigned);
+  auto nhwcType = RankedTensorType::get(
+      {shape[0], shape[2], shape[3], shape[1]}, uint8Type);
+  input.setType(nhwcType);
+
+  OpBuilder builder(&getContext());
+  builder.setInsertionPointToStart(input.getOwner());
+  OnnxBuilder create(builder, input.getLoc());
+  Value floatInput = create.cast(input, TypeAttr::get(type.getElementType()));
+  Value nchwInput = create.transpose(
+      type, floatInput, builder.getI64ArrayAttr({0, 3, 1, 2}));
+  input.replaceAllUsesExcept(nchwInput, floatInput.getDefiningOp());
+  return success();
+}
+
+void Uint8NHWCInputsPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SmallVector<StringRef, 4> nameStrs;
+  StringRef(inputs).split(nameStrs, ',', -1, /*KeepEmpty=*/false);
+  llvm::SmallSet<std::string, 4> names;
+  for (StringRef nameStr : nameStrs)
+    names.insert(nameStr.trim().str());
+  if (names.empty())
+    return;
+
+  SymbolTable symbolTable(module);
+  SmallVector<ONNXEntryPointOp, 1> entryPointOps;
+  module.walk([&](ONNXEntryPointOp entryPointOp) {
+    entryPointOps.emplace_back(entryPointOp);
+  });
+  for (ONNXEntryPointOp entryPointOp : entryPointOps) {
+    auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+        ONNXEntryPointOp::getEntryPointFuncAttrName());
+    auto funcOp =
+        symbolTable.lookup<func::FuncOp>(funcRef.getLeafReference().getValue());
+    ArrayAttr inputNames =
+        funcOp ? funcOp->getAttrOfType<ArrayAttr>("input_names") : nullptr;
+    if (!inputNames || funcOp.isExternal())
+      continue;
+    for (auto [i, nameAttr] : llvm::enumerate(inputNames)) {
+      StringRef name = nameAttr.cast<StringAttr>().getValue();
+      if (!names.count(name.str()))
+        continue;
+      if (failed(takeAsUint8NHWC(funcOp.getArgument(i))))
+        funcOp.emitWarning("input ")
+            << name << " is not a 4D float tensor, not taken as uint8 NHWC";
+    }
+    funcOp.setType(FunctionType::get(&getContext(),
+        funcOp.getBody().getArgumentTypes(), funcOp.getResultTypes()));
+  }
+}
+
+} // namespace
+
+std::unique_ptr<Pass> createUint8NHWCInputsPass() {
+  return std::make_unique<Uint8NHWCInputsPass>();
+}
+
+std::unique_ptr<Pass> createUint8NHWCInputsPass(const std::string &inputs) {
+  return std::make_unique<Uint8NHWCInputsPass>(inputs);
+}
+
+} // namespace onnx_mlir
@@ -17,11 +17,15 @@
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallSet.h"
 
+#include <limits>
+#include <map>
+
 #include "src/Dialect/Krnl/DialectBuilder.hpp"
 #include "src/Dialect/Krnl/KrnlOps.hpp"
 #include "src/Pass/Passes.hpp"
@@ -433,6 +437,271 @@ bool checkLiveRangesIntersect(
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Offset planning of static memory pools.
+//===----------------------------------------------------------------------===//
+
+/// A slot of a static memory pool, namely the krnl.getref operations sharing
+/// an offset, with its live range given by the positions of the first and last
+/// operations of the top level block using it.
+struct MemoryPoolSlot {
+  SmallVector<KrnlGetRefOp, 2> getRefs;
+  int64_t size = 0;
+  int64_t firstUse = std::numeric_limits<int64_t>::max();
+  int64_t lastUse = std::numeric_limits<int64_t>::min();
+  int64_t offset = 0;
+};
+
+/// Extend a live range with the top level operations using the value or any
+/// MemRef produced by its users, e.g. its views. A use nested in a
+/// krnl.iterate or any other region extends the live range to the whole top
+/// level operation containing it. Return false if the value escapes through a
+/// terminator, in which case its live range is unknown.
+bool extendLiveRange(Value value, Block *topBlock,
+    const llvm::DenseMap<Operation *, int64_t> &positions, int64_t &firstUse,
+    int64_t &lastUse) {
+  for (Operation *user : value.getUsers()) {
+    if (user->hasTrait<OpTrait::IsTerminator>())
+      return false;
+    Operation *topOp = topBlock->findAncestorOpInBlock(*user);
+    assert(topOp && "use of a memory pool outside of its block");
+    int64_t position = positions.lookup(topOp);
+    firstUse = std::min(firstUse, position);
+    lastUse = std::max(lastUse, position);
+    for (Value result : user->getResults())
+      if (result.getType().isa<MemRefType>() &&
+          !extendLiveRange(result, topBlock, positions, firstUse, lastUse))
+        return false;
+  }
+  return true;
+}
+
+/// Collect the slots of a static memory pool of the top level block. Return
+/// false if the pool cannot be planned, i.e. if it has users other than
+/// krnl.getref and dealloc operations, or a krnl.getref with a dynamic shape,
+/// a non constant offset or an unknown live range.
+bool getMemoryPoolSlots(memref::AllocOp memPool,
+    const llvm::DenseMap<Operation *, int64_t> &positions,
+    SmallVectorImpl<MemoryPoolSlot> &slots) {
+  Block *topBlock = memPool->getBlock();
+  int64_t alignment = getAllocAlignment(memPool);
+  std::map<int64_t, MemoryPoolSlot> offsetToSlot;
+  for (Operation *user : memPool->getUsers()) {
+    if (llvm::isa<memref::DeallocOp>(user))
+      continue;
+    KrnlGetRefOp getRef = llvm::dyn_cast<KrnlGetRefOp>(user);
+    if (!getRef || getRef.getMempool() != memPool.getResult() ||
+        getRef->getBlock() != topBlock)
+      return false;
+    auto memRefType = getRef.getResult().getType().cast<MemRefType>();
+    if (!hasAllConstantDimensions(memRefType))
+      return false;
+    IntegerAttr offsetAttr;
+    if (!matchPattern(getRef.getOffset(), m_Constant(&offsetAttr)))
+      return false;
+
+    MemoryPoolSlot &slot = offsetToSlot[offsetAttr.getInt()];
+    int64_t size = getMemRefSizeInBytes(getRef.getResult());
+    if (alignment > 0 && size % alignment > 0)
+      size += alignment - size % alignment;
+    slot.size = std::max(slot.size, size);
+    slot.getRefs.emplace_back(getRef);
+    if (!extendLiveRange(getRef.getResult(), topBlock, positions,
+            slot.firstUse, slot.lastUse))
+      return false;
+  }
+  for (auto &offsetAndSlot : offsetToSlot) {
+    // The krnl.getref operations are hoisted to the top of the block, so
+    // they do not start the live range of their slot unless it is unused.
+    MemoryPoolSlot &slot = offsetAndSlot.second;
+    if (slot.firstUse > slot.lastUse) {
+      int64_t position = positions.lookup(slot.getRefs.front());
+      slot.firstUse = slot.lastUse = position;
+    }
+    slots.emplace_back(slot);
+  }
+  return slots.size() > 1;
+}
+
+/// Segment tree over the positions of the top level block indexing the live
+/// ranges of the slots placed so far, so that the placed slots whose live
+/// ranges intersect a given one are found in O(log n) per slot found, without
+/// visiting the others. A live range is stored in the O(log n) nodes whose
+/// ranges partition it, and a node range intersecting the given live range
+/// implies that the live ranges stored in the node intersect it too.
+class LiveRangeTree {
+public:
+  LiveRangeTree(int64_t numPositions, int64_t numSlots)
+      : numPositions(std::max<int64_t>(numPositions, 1)),
+        nodes(4 * this->numPositions), seenBy(numSlots, -1) {}
+
+  void insert(int64_t slot, int64_t firstUse, int64_t lastUse) {
+    insert(/*node=*/1, 0, numPositions - 1, slot, firstUse, lastUse);
+  }
+
+  /// Append the slots whose live ranges intersect the given one.
+  void findIntersecting(
+      int64_t firstUse, int64_t lastUse, SmallVectorImpl<int64_t> &slots) {
+    ++numQueries;
+    find(/*node=*/1, 0, numPositions - 1, firstUse, lastUse, slots);
+  }
+
+private:
+  struct Node {
+    // Slots whose live range covers the range of the node.
+    SmallVector<int64_t, 0> slots;
+    // Number of slots stored in the subtree of the node.
+    int64_t numStored = 0;
+  };
+
+  int64_t insert(int64_t node, int64_t begin, int64_t end, int64_t slot,
+      int64_t firstUse, int64_t lastUse) {
+    if (lastUse < begin || end < firstUse)
+      return 0;
+    int64_t numStored = 1;
+    if (firstUse <= begin && end <= lastUse) {
+      nodes[node].slots.emplace_back(slot);
+    } else {
+      int64_t middle = begin + (end - begin) / 2;
+      numStored =
+          insert(2 * node, begin, middle, slot, firstUse, lastUse) +
+          insert(2 * node + 1, middle + 1, end, slot, firstUse, lastUse);
+    }
+    nodes[node].numStored += numStored;
+    return numStored;
+  }
+
+  void find(int64_t node, int64_t begin, int64_t end, int64_t firstUse,
+      int64_t lastUse, SmallVectorImpl<int64_t> &slots) {
+    if (lastUse < begin || end < firstUse || nodes[node].numStored == 0)
+      return;
+    // A live range is stored in several nodes, report it once.
+    for (int64_t slot : nodes[node].slots)
+      if (seenBy[slot] != numQueries) {
+        seenBy[slot] = numQueries;
+        slots.emplace_back(slot);
+      }
+    if (begin == end)
+      return;
+    int64_t middle = begin + (end - begin) / 2;
+    find(2 * node, begin, middle, firstUse, lastUse, slots);
+    find(2 * node + 1, middle + 1, end, firstUse, lastUse, slots);
+  }
+
+  const int64_t numPositions;
+  std::vector<Node> nodes;
+  // Last query that reported each slot.
+  std::vector<int64_t> seenBy;
+  int64_t numQueries = 0;
+};
+
+/// Assign the offsets of the slots greedily by decreasing size, as the arena
+/// planner of TFLite does: each slot takes the smallest gap that fits it
+/// between the slots already placed whose live ranges intersect its own, or
+/// goes after them. The slots already placed are indexed by live range, so
+/// that planning takes O(n log n) time plus the time to sort the intersecting
+/// slots of each slot. Return the size of the memory pool.
+int64_t planMemoryPoolSlots(
+    SmallVectorImpl<MemoryPoolSlot> &slots, int64_t numPositions) {
+  auto bySize = [](const MemoryPoolSlot &a, const MemoryPoolSlot &b) {
+    return a.size > b.size;
+  };
+  llvm::stable_sort(slots, bySize);
+  LiveRangeTree placedSlots(numPositions, slots.size());
+  int64_t poolSize = 0;
+  SmallVector<int64_t, 8> liveSlots;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    MemoryPoolSlot &slot = slots[i];
+    liveSlots.clear();
+    placedSlots.findIntersecting(slot.firstUse, slot.lastUse, liveSlots);
+    llvm::sort(liveSlots, [&](int64_t a, int64_t b) {
+      return std::make_pair(slots[a].offset, a) <
+             std::make_pair(slots[b].offset, b);
+    });
+
+    int64_t gapBegin = 0;
+    int64_t bestOffset = -1;
+    int64_t bestGap = std::numeric_limits<int64_t>::max();
+    for (int64_t j : liveSlots) {
+      MemoryPoolSlot &liveSlot = slots[j];
+      int64_t gap = liveSlot.offset - gapBegin;
+      if (gap >= slot.size && gap < bestGap) {
+        bestOffset = gapBegin;
+        bestGap = gap;
+      }
+      gapBegin = std::max(gapBegin, liveSlot.offset + liveSlot.size);
+    }
+    slot.offset = (bestOffset >= 0) ? bestOffset : gapBegin;
+    poolSize = std::max(poolSize, slot.offset + slot.size);
+    placedSlots.insert(i, slot.firstUse, slot.lastUse);
+  }
+  return poolSize;
+}
+
+/// Plan the offsets of the static memory pools of the top level block of a
+/// function over the live ranges of their slots in the whole function, and
+/// shrink the pools accordingly. Planned pools are recorded as compacted so
+/// that the patterns below leave them alone. Planning takes O(n log n) time in
+/// the number of krnl.getref operations, plus the sorting of the slots live at
+/// the same time, where the patterns take quadratic time.
+void planStaticMemoryPools(func::FuncOp function,
+    BlockToCompactedAlignments &blockToStaticPoolAlignments) {
+  if (function.getBody().empty())
+    return;
+  Block *topBlock = &function.getBody().front();
+  llvm::DenseMap<Operation *, int64_t> positions;
+  SmallVector<memref::AllocOp, 4> memPools;
+  int64_t position = 0;
+  for (Operation &op : *topBlock) {
+    positions[&op] = position++;
+    auto allocOp = llvm::dyn_cast<memref::AllocOp>(op);
+    if (!allocOp)
+      continue;
+    // Whether the pool has several slots is checked when collecting them,
+    // without walking the block for each pool.
+    auto memPoolType = allocOp.getType();
+    if (hasAllConstantDimensions(memPoolType) &&
+        memPoolType.getShape().size() == 1 &&
+        getMemRefEltSizeInBytes(memPoolType) == 1)
+      memPools.emplace_back(allocOp);
+  }
+
+  for (memref::AllocOp memPool : memPools) {
+    SmallVector<MemoryPoolSlot, 16> slots;
+    if (!getMemoryPoolSlots(memPool, positions, slots))
+      continue;
+    // The pool is left alone by the patterns even if it does not shrink, as
+    // they would not pack it better and their checks take quadratic time.
+    int64_t poolSize = planMemoryPoolSlots(slots, position);
+    int64_t alignment = getAllocAlignment(memPool);
+    blockToStaticPoolAlignments[topBlock].insert(alignment);
+    if (poolSize >= memPool.getType().getShape()[0])
+      continue;
+
+    OpBuilder builder(memPool);
+    Location loc = memPool.getLoc();
+    MultiDialectBuilder<KrnlBuilder, MemRefBuilder> create(builder, loc);
+    auto newMemPoolType =
+        MemRefType::get({poolSize}, builder.getIntegerType(8));
+    memref::AllocOp newMemPool =
+        (alignment > 0) ? create.mem.alignedAlloc(newMemPoolType, alignment)
+                        : create.mem.alloc(newMemPoolType);
+    for (MemoryPoolSlot &slot : slots) {
+      for (KrnlGetRefOp getRef : slot.getRefs) {
+        builder.setInsertionPoint(getRef);
+        Value offset = builder.create<arith::ConstantOp>(getRef.getLoc(),
+            builder.getIntegerAttr(builder.getIntegerType(64), slot.offset));
+        KrnlGetRefOp newGetRef = create.krnl.getRef(
+            getRef.getResult().getType(), newMemPool, offset);
+        getRef.getResult().replaceAllUsesWith(newGetRef.getResult());
+        getRef.erase();
+      }
+    }
+    memPool.getResult().replaceAllUsesWith(newMemPool.getResult());
+    memPool.erase();
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Rewrite patterns.
 //===----------------------------------------------------------------------===//
@@ -503,11 +772,6 @@ public:
     if (memPoolShape.size() != 1)
       return failure();
 
-    // Determine if the static memory pool is bundled i.e. participates in more
-    // than one getRef.
-    if (getAllocGetRefNum(&staticMemPool) < 2)
-      return failure();
-
     // Get parent block.
     Block *parentBlock = firstGetRef.getOperation()->getBlock();
 
@@ -525,6 +789,12 @@ public:
     if (!llvm::dyn_cast_or_null<func::FuncOp>(parentBlock->getParentOp()))
       return failure();
 
+    // Determine if the static memory pool is bundled i.e. participates in more
+    // than one getRef. This walks the block, so it is checked after the
+    // checks above that are cheap.
+    if (getAllocGetRefNum(&staticMemPool) < 2)
+      return failure();
+
     // List of all GetRefs which share the slot with firstGetRef.
     SmallVector<KrnlGetRefOp, 4> firstGetRefList =
         getAllGetRefWithSameOffset(&firstGetRef);
@@ -732,10 +1002,6 @@ public:
     auto memPoolType = allocOp.getResult().getType().dyn_cast<MemRefType>();
     auto memPoolShape = memPoolType.getShape();
 
-    // This is a memory pool if it is used by at least one getref.
-    if (getAllocGetRefNum(&allocOp) < 1)
-      return failure();
-
     // Only handle alloc ops that return a constant shaped MemRef.
     if (!hasAllConstantDimensions(memPoolType))
       return failure();
@@ -764,6 +1030,11 @@ public:
     if (!llvm::dyn_cast_or_null<func::FuncOp>(parentBlock->getParentOp()))
       return failure();
 
+    // This is a memory pool if it is used by at least one getref. This walks
+    // the block, so it is checked after the checks above that are cheap.
+    if (getAllocGetRefNum(&allocOp) < 1)
+      return failure();
+
     // Compute size of all krnl.getref operations that use this memory pool.
     int64_t usedMemory = getAllocGetRefTotalSize(&allocOp);
 
@@ -879,15 +1150,33 @@ class KrnlOptimizeMemoryPoolsPass
 public:
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(KrnlOptimizeMemoryPoolsPass)
 
+  KrnlOptimizeMemoryPoolsPass() = default;
+  KrnlOptimizeMemoryPoolsPass(const KrnlOptimizeMemoryPoolsPass &pass)
+      : PassWrapper<KrnlOptimizeMemoryPoolsPass,
+            OperationPass<func::FuncOp>>() {}
+  KrnlOptimizeMemoryPoolsPass(bool planOffsets) {
+    this->planOffsets = planOffsets;
+  }
+
   StringRef getArgument() const override { return "optimize-memory-pools"; }
 
   StringRef getDescription() const override {
     return "Optimize the static and dynamic memory pools.";
   }
 
+  Option<bool> planOffsets{*this, "plan-offsets",
+      llvm::cl::desc("Assign the offsets of the static memory pools by size "
+                     "over the live ranges of the whole function"),
+      llvm::cl::init(false)};
+
   void runOnOperation() override {
     auto function = getOperation();
 
+    // Plan the offsets over the whole function first, the patterns below
+    // only reuse slots of the same size within a block.
+    if (planOffsets)
+      planStaticMemoryPools(function, blockToStaticPoolAlignments);
+
     ConversionTarget target(getContext());
     RewritePatternSet patterns(&getContext());
     patterns.insert<KrnlOptimizeStaticMemoryPools>(
@@ -906,3 +1195,8 @@ public:
 std::unique_ptr<Pass> onnx_mlir::krnl::createKrnlOptimizeMemoryPoolsPass() {
   return std::make_unique<KrnlOptimizeMemoryPoolsPass>();
 }
+
+std::unique_ptr<Pass> onnx_mlir::krnl::createKrnlOptimizeMemoryPoolsPass(
+    bool planOffsets) {
+  return std::make_unique<KrnlOptimizeMemoryPoolsPass>(planOffsets);
+}
@@ -0,0 +1,207 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------------- OutlineParallelLoops.cpp ---------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This pass outlines the bodies of scf.parallel loops into functions called by
+// krnl.parallel_call operations, so that the loops run on the thread pool of
+// the runtime instead of being lowered to sequential loops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/RegionUtils.h"
+
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+using namespace onnx_mlir::krnl;
+
+namespace {
+
+/// Return true if values of the given type can be passed to the outlined
+/// function, namely if the conversion to LLVM leaves them as is or unpacks
+/// them from a ranked memref descriptor.
+bool isOutlinableType(Type type) {
+  return type.isa<IndexType, IntegerType, FloatType, VectorType, MemRefType>();
+}
+
+/*!
+ * Replace an scf.parallel loop
+ * ```
+ *   scf.parallel (%i, %j) = (%lb0, %lb1) to (%ub0, %ub1) step (%s0, %s1) {
+ *     body(%i, %j)
+ *   }
+ * ```
+ * by a call of its outlined body on the flattened iteration space
+ * ```
+ *   krnl.parallel_call @f(%n0 * %n1) (%lb0, %lb1, %s0, %s1, %n1, ...)
+ *
+ *   func.func private @f(%begin: index, %end: index, ...) {
+ *     scf.for %k = %begin to %end step %c1 {
+ *       memref.alloca_scope {
+ *         body(%lb0 + (%k floordiv %n1) * %s0, %lb1 + (%k mod %n1) * %s1)
+ *       }
+ *     }
+ *     return
+ *   }
+ * ```
+ * where %n0 and %n1 are the trip counts of the loops. The alloca scope keeps
+ * the stack allocations of the body from growing the stack of the threads.
+ */
+LogicalResult outlineParallelLoop(
+    scf::ParallelOp loop, SymbolTable &symbolTable) {
+  func::FuncOp parentFunc = loop->getParentOfType<func::FuncOp>();
+  if (!parentFunc || loop.getNumResults() != 0)
+    return failure();
+  SetVector<Value> bodyValues;
+  getUsedValuesDefinedAbove(loop.getRegion(), bodyValues);
+  if (!llvm::all_of(bodyValues,
+          [](Value value) { return isOutlinableType(value.getType()); }))
+    return failure();
+
+  Location loc = loop.getLoc();
+  OpBuilder b(loop);
+  Type indexType = b.getIndexType();
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+
+  // Compute the trip counts and the size of the flattened iteration space.
+  int64_t rank = loop.getNumLoops();
+  SmallVector<Value, 4> tripCounts;
+  Value numIterations = one;
+  for (int64_t d = 0; d < rank; ++d) {
+    Value tripCount = b.createOrFold<arith::SubIOp>(
+        loc, loop.getUpperBound()[d], loop.getLowerBound()[d]);
+    tripCount =
+        b.createOrFold<arith::CeilDivSIOp>(loc, tripCount, loop.getStep()[d]);
+    tripCount = b.createOrFold<arith::MaxSIOp>(loc, tripCount, zero);
+    tripCounts.emplace_back(tripCount);
+    numIterations =
+        b.createOrFold<arith::MulIOp>(loc, numIterations, tripCount);
+  }
+
+  // Gather the values used by the outlined body: the bounds needed to rebuild
+  // the induction variables and the values used in the loop body. Constants
+  // are cloned into the outlined function instead of being passed.
+  SetVector<Value> usedValues;
+  usedValues.insert(loop.getLowerBound().begin(), loop.getLowerBound().end());
+  usedValues.insert(loop.getStep().begin(), loop.getStep().end());
+  usedValues.insert(tripCounts.begin() + 1, tripCounts.end());
+  usedValues.insert(bodyValues.begin(), bodyValues.end());
+  SmallVector<Value, 8> args;
+  SmallVector<Operation *, 4> constants;
+  for (Value value : usedValues) {
+    Operation *defOp = value.getDefiningOp();
+    if (defOp && defOp->hasTrait<OpTrait::ConstantLike>())
+      constants.emplace_back(defOp);
+    else
+      args.emplace_back(value);
+  }
+
+  // Create the outlined function after the parent one.
+  SmallVector<Type, 8> argTypes = {indexType, indexType};
+  for (Value arg : args)
+    argTypes.emplace_back(arg.getType());
+  auto outlinedFunc = func::FuncOp::create(loc,
+      (parentFunc.getName() + "_parallel").str(),
+      b.getFunctionType(argTypes, {}));
+  outlinedFunc.setPrivate();
+  symbolTable.insert(outlinedFunc, std::next(parentFunc->getIterator()));
+
+  Block *entryBlock = outlinedFunc.addEntryBlock();
+  OpBuilder fb = OpBuilder::atBlockBegin(entryBlock);
+  IRMapping mapping;
+  for (Operation *constant : constants)
+    fb.clone(*constant, mapping);
+  for (size_t i = 0; i < args.size(); ++i)
+    mapping.map(args[i], entryBlock->getArgument(2 + i));
+  Value funcOne = fb.create<arith::ConstantIndexOp>(loc, 1);
+  fb.create<scf::ForOp>(loc, entryBlock->getArgument(0),
+      entryBlock->getArgument(1), funcOne, ValueRange(),
+      [&](OpBuilder &forBuilder, Location forLoc, Value flatIndex,
+          ValueRange) {
+        auto scopeOp =
+            forBuilder.create<memref::AllocaScopeOp>(forLoc, TypeRange());
+        OpBuilder sb = OpBuilder::atBlockBegin(
+            forBuilder.createBlock(&scopeOp.getBodyRegion()));
+        // Rebuild the induction variables, the innermost one varying fastest.
+        Value remainder = flatIndex;
+        for (int64_t d = rank - 1; d >= 0; --d) {
+          Value index = remainder;
+          if (d > 0) {
+            Value tripCount = mapping.lookup(tripCounts[d]);
+            index = sb.create<arith::RemSIOp>(forLoc, remainder, tripCount);
+            remainder =
+                sb.create<arith::DivSIOp>(forLoc, remainder, tripCount);
+          }
+          Value step = mapping.lookup(loop.getStep()[d]);
+          Value lb = mapping.lookup(loop.getLowerBound()[d]);
+          Value iv = sb.create<arith::AddIOp>(
+              forLoc, lb, sb.create<arith::MulIOp>(forLoc, index, step));
+          mapping.map(loop.getInductionVars()[d], iv);
+        }
+        for (Operation &op : loop.getBody()->without_terminator())
+          sb.clone(op, mapping);
+        sb.create<memref::AllocaScopeReturnOp>(forLoc, ValueRange());
+        forBuilder.setInsertionPointAfter(scopeOp);
+        forBuilder.create<scf::YieldOp>(forLoc);
+      });
+  fb.create<func::ReturnOp>(loc);
+
+  b.create<KrnlParallelCallOp>(
+      loc, SymbolRefAttr::get(outlinedFunc), numIterations, args);
+  loop.erase();
+  return success();
+}
+
+/*!
+ *  Module pass that outlines the outermost scf.parallel loops. Nested
+ *  scf.parallel loops stay in the outlined functions and run sequentially.
+ */
+class OutlineParallelLoopsPass
+    : public PassWrapper<OutlineParallelLoopsPass, OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OutlineParallelLoopsPass)
+
+  StringRef getArgument() const override { return "outline-parallel-loops"; }
+
+  StringRef getDescription() const override {
+    return "Outline scf.parallel loops into functions run on the thread pool "
+           "of the runtime";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    SmallVector<scf::ParallelOp, 4> loops;
+    module.walk([&](scf::ParallelOp loop) {
+      if (!loop->getParentOfType<scf::ParallelOp>())
+        loops.emplace_back(loop);
+    });
+    // Loops that cannot be outlined are left to run sequentially.
+    for (scf::ParallelOp loop : loops)
+      (void)outlineParallelLoop(loop, symbolTable);
+  }
+};
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createOutlineParallelLoopsPass() {
+  return std::make_unique<OutlineParallelLoopsPass>();
+}
+} // namespace krnl
+} // namespace onnx_mlir
@@ -0,0 +1,355 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------------- OutlineTaskGraphs.cpp ------------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This pass outlines the loop nests of a function that do not depend on each
+// other, e.g. those of the branches of a model, into task graphs called by
+// krnl.task_graph_call operations, so that they run concurrently on the
+// thread pool of the runtime instead of one after the other.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseSet.h"
+
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+using namespace onnx_mlir::krnl;
+
+namespace {
+
+/// Return true if values of the given type can be passed to the outlined
+/// function, namely if the conversion to LLVM leaves them as is or unpacks
+/// them from a ranked memref descriptor.
+bool isOutlinableType(Type type) {
+  return type.isa<IndexType, IntegerType, FloatType, VectorType, MemRefType>();
+}
+
+/// Buffers read and written by an op, identified by the memrefs they are
+/// allocated as. The args of the function are a single buffer, as they may
+/// alias each other.
+struct BufferAccesses {
+  llvm::SmallDenseSet<Value, 8> reads;
+  llvm::SmallDenseSet<Value, 8> writes;
+  // Set if the op has effects that are not on known buffers.
+  bool unknown = false;
+
+  bool conflictsWith(const BufferAccesses &other) const {
+    if (unknown || other.unknown)
+      return true;
+    for (Value buffer : writes)
+      if (other.reads.count(buffer) || other.writes.count(buffer))
+        return true;
+    for (Value buffer : other.writes)
+      if (reads.count(buffer))
+        return true;
+    return false;
+  }
+};
+
+/// Return the buffer of a memref, through its views, or null if the memref
+/// is not known to be a buffer of the function.
+Value getBuffer(Value memref, func::FuncOp function) {
+  while (true) {
+    if (auto viewOp = memref.getDefiningOp<ViewLikeOpInterface>())
+      memref = viewOp.getViewSource();
+    else if (auto castOp = memref.getDefiningOp<memref::CastOp>())
+      memref = castOp.getSource();
+    else
+      break;
+  }
+  if (auto arg = memref.dyn_cast<BlockArgument>())
+    return arg.getOwner()->getParentOp() == function ? function.getArgument(0)
+                                                     : Value();
+  Operation *defOp = memref.getDefiningOp();
+  if (isa<KrnlGlobalOp, memref::GetGlobalOp>(defOp))
+    return memref;
+  auto effectOp = dyn_cast<MemoryEffectOpInterface>(defOp);
+  if (effectOp && effectOp.getEffectOnValue<MemoryEffects::Allocate>(memref))
+    return memref;
+  return Value();
+}
+
+/// Gather the accesses of an op and of its nested ops to the buffers defined
+/// outside of the op.
+BufferAccesses getBufferAccesses(Operation *root, func::FuncOp function) {
+  BufferAccesses accesses;
+  auto addAccess = [&](Value memref, bool isWrite) {
+    Value buffer = getBuffer(memref, function);
+    if (!buffer) {
+      accesses.unknown = true;
+      return;
+    }
+    // Buffers allocated by the op itself are not shared.
+    if (Operation *defOp = buffer.getDefiningOp())
+      if (root->isProperAncestor(defOp))
+        return;
+    (isWrite ? accesses.writes : accesses.reads).insert(buffer);
+  };
+  root->walk([&](Operation *op) {
+    if (op->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+      return;
+    auto effectOp = dyn_cast<MemoryEffectOpInterface>(op);
+    if (!effectOp) {
+      // Ops without known effects read and write the memrefs they use, e.g.
+      // calls of library functions.
+      bool usesMemRefs = false;
+      for (Value operand : op->getOperands())
+        if (operand.getType().isa<BaseMemRefType>()) {
+          addAccess(operand, /*isWrite=*/true);
+          usesMemRefs = true;
+        }
+      if (!usesMemRefs)
+        accesses.unknown = true;
+      return;
+    }
+    SmallVector<MemoryEffects::EffectInstance, 4> effects;
+    effectOp.getEffects(effects);
+    for (MemoryEffects::EffectInstance &effect : effects) {
+      if (isa<MemoryEffects::Allocate>(effect.getEffect()))
+        continue;
+      Value value = effect.getValue();
+      if (!value) {
+        accesses.unknown = true;
+        continue;
+      }
+      if (value.getType().isa<BaseMemRefType>())
+        addAccess(value, !isa<MemoryEffects::Read>(effect.getEffect()));
+    }
+  });
+  return accesses;
+}
+
+/// Return the values used by an op and its nested ops, defined outside of it.
+SetVector<Value> getUsedValues(Operation *op) {
+  SetVector<Value> usedValues;
+  usedValues.insert(op->getOperands().begin(), op->getOperands().end());
+  for (Region &region : op->getRegions())
+    getUsedValuesDefinedAbove(region, usedValues);
+  return usedValues;
+}
+
+/// Return true if the op may run as a task: loop nests and calls, without
+/// results and with values known to the outlined function.
+bool isTask(Operation *op) {
+  if (op->getNumResults() != 0 ||
+      !(op->getNumRegions() > 0 ||
+          isa<KrnlCallOp, KrnlMemcpyOp, memref::CopyOp>(op)))
+    return false;
+  return llvm::all_of(getUsedValues(op),
+      [](Value value) { return isOutlinableType(value.getType()); });
+}
+
+/*!
+ * Replace the tasks of a segment of a function
+ * ```
+ *   task0(%a)
+ *   task1(%b)
+ *   task2(%a, %b)
+ * ```
+ * where task2 depends on task0 and task1, by a call of a function running
+ * them by index
+ * ```
+ *   krnl.task_graph_call @f(%a, %b) {predecessorCounts = [0, 0, 2],
+ *       successorOffsets = [0, 1, 2, 2], successors = [2, 2]}
+ *
+ *   func.func private @f(%begin: index, %end: index, %a, %b) {
+ *     scf.for %t = %begin to %end step %c1 {
+ *       scf.if (%t == 0) { task0(%a) }
+ *       scf.if (%t == 1) { task1(%b) }
+ *       scf.if (%t == 2) { task2(%a, %b) }
+ *     }
+ *     return
+ *   }
+ * ```
+ * A task depends on the earlier tasks accessing the same buffers, one of
+ * them writing it, and only the dependencies not implied by the others are
+ * kept. The call replaces the last task, the ops of the function between the
+ * tasks not conflicting with them. Segments whose tasks depend each on the
+ * previous one are left as is.
+ */
+LogicalResult outlineTaskGraph(func::FuncOp function,
+    ArrayRef<Operation *> tasks, ArrayRef<BufferAccesses> accesses,
+    SymbolTable &symbolTable) {
+  int64_t numTasks = tasks.size();
+  SmallVector<SmallVector<int64_t, 4>, 8> successors(numTasks);
+  SmallVector<int64_t, 8> predecessorCounts(numTasks, 0);
+  SmallVector<llvm::BitVector, 8> ancestors(
+      numTasks, llvm::BitVector(numTasks));
+  bool isChain = true;
+  for (int64_t j = 0; j < numTasks; ++j) {
+    // The closest conflicting tasks come first, and imply the dependencies
+    // of the task on their own ancestors.
+    for (int64_t i = j - 1; i >= 0; --i) {
+      if (ancestors[j].test(i) || !accesses[i].conflictsWith(accesses[j]))
+        continue;
+      successors[i].emplace_back(j);
+      ++predecessorCounts[j];
+      ancestors[j] |= ancestors[i];
+      ancestors[j].set(i);
+    }
+    isChain &= (int64_t)ancestors[j].count() == j;
+  }
+  if (isChain)
+    return failure();
+
+  // Gather the values used by the tasks. Constants are cloned into the
+  // outlined function instead of being passed.
+  SetVector<Value> usedValues;
+  for (Operation *task : tasks) {
+    SetVector<Value> taskValues = getUsedValues(task);
+    usedValues.insert(taskValues.begin(), taskValues.end());
+  }
+  SmallVector<Value, 8> args;
+  SmallVector<Operation *, 4> constants;
+  for (Value value : usedValues) {
+    Operation *defOp = value.getDefiningOp();
+    if (defOp && defOp->hasTrait<OpTrait::ConstantLike>())
+      constants.emplace_back(defOp);
+    else
+      args.emplace_back(value);
+  }
+
+  // Create the outlined function after the parent one.
+  Location loc = tasks.back()->getLoc();
+  OpBuilder b(tasks.back());
+  Type indexType = b.getIndexType();
+  SmallVector<Type, 8> argTypes = {indexType, indexType};
+  for (Value arg : args)
+    argTypes.emplace_back(arg.getType());
+  auto outlinedFunc = func::FuncOp::create(loc,
+      (function.getName() + "_tasks").str(), b.getFunctionType(argTypes, {}));
+  outlinedFunc.setPrivate();
+  symbolTable.insert(outlinedFunc, std::next(function->getIterator()));
+
+  Block *entryBlock = outlinedFunc.addEntryBlock();
+  OpBuilder fb = OpBuilder::atBlockBegin(entryBlock);
+  IRMapping mapping;
+  for (Operation *constant : constants)
+    fb.clone(*constant, mapping);
+  for (size_t i = 0; i < args.size(); ++i)
+    mapping.map(args[i], entryBlock->getArgument(2 + i));
+  Value funcOne = fb.create<arith::ConstantIndexOp>(loc, 1);
+  fb.create<scf::ForOp>(loc, entryBlock->getArgument(0),
+      entryBlock->getArgument(1), funcOne, ValueRange(),
+      [&](OpBuilder &forBuilder, Location forLoc, Value taskIndex,
+          ValueRange) {
+        for (int64_t t = 0; t < numTasks; ++t) {
+          Value isTask = forBuilder.create<arith::CmpIOp>(forLoc,
+              arith::CmpIPredicate::eq, taskIndex,
+              forBuilder.create<arith::ConstantIndexOp>(forLoc, t));
+          auto ifOp = forBuilder.create<scf::IfOp>(
+              forLoc, isTask, /*withElseRegion=*/false);
+          OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+          thenBuilder.clone(*tasks[t], mapping);
+        }
+        forBuilder.create<scf::YieldOp>(forLoc);
+      });
+  fb.create<func::ReturnOp>(loc);
+
+  // Flatten the successors of the tasks.
+  SmallVector<int64_t, 8> successorOffsets = {0};
+  SmallVector<int64_t, 16> flatSuccessors;
+  for (int64_t t = 0; t < numTasks; ++t) {
+    llvm::sort(successors[t]);
+    flatSuccessors.append(successors[t].begin(), successors[t].end());
+    successorOffsets.emplace_back(flatSuccessors.size());
+  }
+  b.create<KrnlTaskGraphCallOp>(loc, SymbolRefAttr::get(outlinedFunc),
+      b.getI64ArrayAttr(predecessorCounts),
+      b.getI64ArrayAttr(successorOffsets), b.getI64ArrayAttr(flatSuccessors),
+      args);
+  for (Operation *task : tasks)
+    task->erase();
+  return success();
+}
+
+/// Split the body of a function into segments of tasks, and outline the
+/// segments whose tasks may run concurrently. A segment ends before an op
+/// that conflicts with its tasks, e.g. a load of a buffer they write, and
+/// before tasks whose effects are not known.
+void outlineTaskGraphs(func::FuncOp function, SymbolTable &symbolTable) {
+  SmallVector<Operation *, 8> tasks;
+  SmallVector<BufferAccesses, 8> taskAccesses;
+  auto endSegment = [&]() {
+    if (tasks.size() > 1)
+      (void)outlineTaskGraph(function, tasks, taskAccesses, symbolTable);
+    tasks.clear();
+    taskAccesses.clear();
+  };
+  Block &body = function.getBody().front();
+  for (Operation &op : llvm::make_early_inc_range(body)) {
+    if (op.hasTrait<OpTrait::IsTerminator>())
+      break;
+    BufferAccesses accesses = getBufferAccesses(&op, function);
+    if (isTask(&op) && !accesses.unknown) {
+      tasks.emplace_back(&op);
+      taskAccesses.emplace_back(std::move(accesses));
+      continue;
+    }
+    // Other ops, e.g. allocations and index computations, stay before the
+    // tasks of the segment.
+    if (llvm::any_of(taskAccesses, [&](const BufferAccesses &taskAccess) {
+          return taskAccess.conflictsWith(accesses);
+        }))
+      endSegment();
+  }
+  endSegment();
+}
+
+/*!
+ *  Module pass that outlines the loop nests independent of each other into
+ *  task graphs. It runs on the functions lowered to loops, before their
+ *  scf.parallel loops are outlined, so that the tasks run their own parallel
+ *  loops on the workers left idle by the graph.
+ */
+class OutlineTaskGraphsPass
+    : public PassWrapper<OutlineTaskGraphsPass, OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OutlineTaskGraphsPass)
+
+  StringRef getArgument() const override { return "outline-task-graphs"; }
+
+  StringRef getDescription() const override {
+    return "Outline independent loop nests into task graphs run on the thread "
+           "pool of the runtime";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    SmallVector<func::FuncOp, 4> functions;
+    for (func::FuncOp function : module.getOps<func::FuncOp>())
+      if (!function.isExternal() && function.getBody().hasOneBlock())
+        functions.emplace_back(function);
+    for (func::FuncOp function : functions)
+      outlineTaskGraphs(function, symbolTable);
+  }
+};
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createOutlineTaskGraphsPass() {
+  return std::make_unique<OutlineTaskGraphsPass>();
+}
+} // namespace krnl
+} // namespace onnx_mlir
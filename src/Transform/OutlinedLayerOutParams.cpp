@@ -0,0 +1,235 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------- OutlinedLayerOutParams.cpp -----------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This pass turns the results of the functions outlined by the
+// outline-repeated-layers pass, once lowered to Krnl, into output arguments
+// allocated by their callers, as in
+//   func.func private @main_graph_layer0(%x, %w, %out) {
+//     ... store into %out ...
+//   }
+//   %z0 = memref.alloc()
+//   call @main_graph_layer0(%x, %w0, %z0)
+// so that the buffers of the results are deallocated by the callers as their
+// other buffers, the buffer deallocation not freeing the buffers returned by
+// calls. The buffer returned by a function is replaced by the output argument
+// when it is allocated by the function, and copied into the output argument
+// otherwise.
+//
+// This file also implements the pass that moves the body of the entry point
+// functions whose results are all buffers of static shapes allocated by them
+// into a <func>_into function writing them into output arguments, as in
+//   func.func @main_graph_into(%x, %out) {
+//     ... store into %out ...
+//   }
+//   func.func @main_graph(%x) -> memref<...> {
+//     %z = memref.alloc()
+//     call @main_graph_into(%x, %z)
+//     return %z
+//   }
+// so that the entry points writing into output tensors preallocated by the
+// callers pass their buffers to <func>_into, the results being computed in
+// place instead of allocated and copied.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#include "src/Dialect/Krnl/KrnlOps.hpp"
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+using namespace onnx_mlir;
+
+namespace {
+
+const std::string OUTLINED_LAYER_ATTRIBUTE = "onnx-mlir.outlined_layer";
+const std::string ENTRY_POINT_INTO_SUFFIX = "_into";
+
+/// Return true if the results of the function are memrefs of static shapes.
+bool hasStaticMemRefResults(func::FuncOp funcOp) {
+  return llvm::all_of(funcOp.getResultTypes(), [](Type type) {
+    auto memRefType = type.dyn_cast<MemRefType>();
+    return memRefType && memRefType.hasStaticShape();
+  });
+}
+
+/// Return true if the results of the function are distinct buffers of static
+/// shapes allocated by the function.
+bool hasAllocatedStaticResults(func::FuncOp funcOp) {
+  if (funcOp.isExternal() || !hasStaticMemRefResults(funcOp))
+    return false;
+  auto returnOp = cast<func::ReturnOp>(funcOp.front().getTerminator());
+  SmallVector<Value, 4> results(returnOp.getOperands());
+  return llvm::all_of(results, [&](Value result) {
+    auto allocOp = result.getDefiningOp<memref::AllocOp>();
+    return allocOp && allocOp.getType().getLayout().isIdentity() &&
+           llvm::count(results, result) == 1;
+  });
+}
+
+/// Pass the results of the function as output arguments.
+void resultsToOutParams(func::FuncOp funcOp) {
+  Block &entryBlock = funcOp.front();
+  auto returnOp = cast<func::ReturnOp>(entryBlock.getTerminator());
+  Location loc = returnOp.getLoc();
+  SmallVector<Value, 4> outParams;
+  for (Type type : funcOp.getResultTypes())
+    outParams.emplace_back(entryBlock.addArgument(type, loc));
+
+  OpBuilder builder(returnOp);
+  SmallVector<Value, 4> results(returnOp.getOperands());
+  for (auto [result, outParam] : llvm::zip(results, outParams)) {
+    auto allocOp = result.getDefiningOp<memref::AllocOp>();
+    if (allocOp && allocOp.getType() == outParam.getType() &&
+        llvm::count(results, result) == 1) {
+      result.replaceAllUsesWith(outParam);
+      allocOp.erase();
+      continue;
+    }
+    builder.create<memref::CopyOp>(loc, result, outParam);
+  }
+  builder.create<func::ReturnOp>(loc);
+  returnOp.erase();
+  funcOp.setType(FunctionType::get(
+      funcOp.getContext(), entryBlock.getArgumentTypes(), TypeRange()));
+}
+
+/// Allocate the results of a call to the function and pass them as output
+/// arguments.
+void allocOutParams(func::CallOp callOp, func::FuncOp funcOp) {
+  OpBuilder builder(callOp);
+  MultiDialectBuilder<MemRefBuilder> create(builder, callOp.getLoc());
+  SmallVector<Value, 8> operands(callOp.getOperands());
+  SmallVector<Value, 4> outParams;
+  for (Type type : callOp.getResultTypes()) {
+    outParams.emplace_back(create.mem.alignedAlloc(type.cast<MemRefType>()));
+    operands.emplace_back(outParams.back());
+  }
+  builder.create<func::CallOp>(callOp.getLoc(), funcOp, operands);
+  callOp.replaceAllUsesWith(outParams);
+  callOp.erase();
+}
+
+/*!
+ *  Module pass that passes the results of the outlined layers as output
+ *  arguments.
+ */
+class OutlinedLayerOutParamsPass
+    : public PassWrapper<OutlinedLayerOutParamsPass, OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(OutlinedLayerOutParamsPass)
+
+  StringRef getArgument() const override {
+    return "outlined-layer-out-params";
+  }
+
+  StringRef getDescription() const override {
+    return "Pass the results of the outlined layers as output arguments";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SmallVector<func::FuncOp, 4> layerOps;
+    for (auto funcOp : module.getOps<func::FuncOp>())
+      if (funcOp->hasAttr(OUTLINED_LAYER_ATTRIBUTE) && !funcOp.isExternal() &&
+          hasStaticMemRefResults(funcOp))
+        layerOps.emplace_back(funcOp);
+    for (func::FuncOp funcOp : layerOps) {
+      std::optional<SymbolTable::UseRange> uses =
+          SymbolTable::getSymbolUses(funcOp, module);
+      // The function is left as is if used other than by calls.
+      SmallVector<func::CallOp, 8> callOps;
+      if (!uses || llvm::any_of(*uses, [&](SymbolTable::SymbolUse use) {
+            auto callOp = dyn_cast<func::CallOp>(use.getUser());
+            if (callOp)
+              callOps.emplace_back(callOp);
+            return !callOp;
+          }))
+        continue;
+      resultsToOutParams(funcOp);
+      for (func::CallOp callOp : callOps)
+        allocOutParams(callOp, funcOp);
+    }
+  }
+};
+
+/*!
+ *  Module pass that moves the body of the entry point functions into
+ *  functions writing their results into output arguments.
+ */
+class EntryPointOutParamsPass
+    : public PassWrapper<EntryPointOutParamsPass, OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(EntryPointOutParamsPass)
+
+  StringRef getArgument() const override { return "entry-point-out-params"; }
+
+  StringRef getDescription() const override {
+    return "Move the body of the entry point functions into functions "
+           "writing their results into output arguments";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    SmallVector<func::FuncOp, 1> entryFuncOps;
+    module.walk([&](KrnlEntryPointOp entryPointOp) {
+      auto funcRef = entryPointOp->getAttrOfType<SymbolRefAttr>(
+          KrnlEntryPointOp::getEntryPointFuncAttrName());
+      auto funcOp = symbolTable.lookup<func::FuncOp>(
+          funcRef.getLeafReference().getValue());
+      if (funcOp && hasAllocatedStaticResults(funcOp))
+        entryFuncOps.emplace_back(funcOp);
+    });
+    for (func::FuncOp funcOp : entryFuncOps) {
+      std::string intoName = funcOp.getName().str() + ENTRY_POINT_INTO_SUFFIX;
+      if (symbolTable.lookup(intoName))
+        continue;
+      // The clone computes the results into its output arguments.
+      func::FuncOp intoFuncOp = funcOp.clone();
+      intoFuncOp.setName(intoName);
+      symbolTable.insert(intoFuncOp, std::next(funcOp->getIterator()));
+      resultsToOutParams(intoFuncOp);
+
+      // The entry point function allocates its results and calls the clone.
+      Location loc = funcOp.getLoc();
+      funcOp.eraseBody();
+      Block *entryBlock = funcOp.addEntryBlock();
+      OpBuilder builder = OpBuilder::atBlockEnd(entryBlock);
+      MultiDialectBuilder<MemRefBuilder> create(builder, loc);
+      SmallVector<Value, 8> operands(entryBlock->getArguments());
+      SmallVector<Value, 4> results;
+      for (Type type : funcOp.getResultTypes()) {
+        results.emplace_back(create.mem.alignedAlloc(type.cast<MemRefType>()));
+        operands.emplace_back(results.back());
+      }
+      builder.create<func::CallOp>(loc, intoFuncOp, operands);
+      builder.create<func::ReturnOp>(loc, results);
+    }
+  }
+};
+
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createOutlinedLayerOutParamsPass() {
+  return std::make_unique<OutlinedLayerOutParamsPass>();
+}
+
+std::unique_ptr<Pass> createEntryPointOutParamsPass() {
+  return std::make_unique<EntryPointOutParamsPass>();
+}
+} // namespace krnl
+} // namespace onnx_mlir
@@ -0,0 +1,194 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===----------------- ShapeDispatch.cpp ----------------------------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This pass turns the entry point functions specialized by the
+// shape-specialization pass into dispatchers calling, at runtime, the
+// specialization matching the shapes of the inputs, or the generic function
+// when no specialization matches.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/MapVector.h"
+
+#include "src/Dialect/Mlir/DialectBuilder.hpp"
+#include "src/Pass/Passes.hpp"
+
+using namespace mlir;
+using namespace onnx_mlir;
+
+namespace {
+
+const std::string SPECIALIZATION_OF_ATTRIBUTE = "onnx.specialization_of";
+
+/// Return true if the specialization can be called with the inputs of the
+/// function it specializes, once the shapes of the inputs are checked, and its
+/// results returned by the function.
+bool isCompatible(func::FuncOp funcOp, func::FuncOp specOp) {
+  FunctionType funcType = funcOp.getFunctionType();
+  FunctionType specFuncType = specOp.getFunctionType();
+  if (funcType.getNumInputs() != specFuncType.getNumInputs() ||
+      funcType.getNumResults() != specFuncType.getNumResults())
+    return false;
+  for (auto [type, specType] :
+      llvm::zip(funcType.getInputs(), specFuncType.getInputs()))
+    if (type != specType &&
+        !(type.isa<MemRefType>() && specType.isa<MemRefType>() &&
+            memref::CastOp::areCastCompatible(type, specType)))
+      return false;
+  for (auto [type, specType] :
+      llvm::zip(funcType.getResults(), specFuncType.getResults()))
+    if (type != specType &&
+        !(type.isa<MemRefType>() && specType.isa<MemRefType>() &&
+            memref::CastOp::areCastCompatible(specType, type)))
+      return false;
+  return true;
+}
+
+/*!
+ * Replace the body of an entry point function @f specialized by @f_shape0,
+ * @f_shape1, ... by
+ * ```
+ *   %r = scf.if (shapes of the inputs match @f_shape0) {
+ *     %s = func.call @f_shape0(memref.cast %inputs)
+ *     scf.yield memref.cast %s
+ *   } else {
+ *     %t = scf.if (shapes of the inputs match @f_shape1) {
+ *       ...
+ *     } else {
+ *       %u = func.call @f_dynamic(%inputs)
+ *       scf.yield %u
+ *     }
+ *     scf.yield %t
+ *   }
+ *   return %r
+ * ```
+ * where @f_dynamic has the former body of @f.
+ */
+void dispatch(func::FuncOp funcOp, ArrayRef<func::FuncOp> specOps,
+    SymbolTable &symbolTable) {
+  Location loc = funcOp.getLoc();
+  func::FuncOp dynamicOp = func::FuncOp::create(loc,
+      (funcOp.getName() + "_dynamic").str(), funcOp.getFunctionType());
+  dynamicOp.setPrivate();
+  dynamicOp.getBody().takeBody(funcOp.getBody());
+  symbolTable.insert(dynamicOp, Block::iterator(funcOp));
+
+  Block *entryBlock = funcOp.addEntryBlock();
+  OpBuilder builder = OpBuilder::atBlockBegin(entryBlock);
+  ValueRange inputs = funcOp.getArguments();
+  TypeRange resultTypes = funcOp.getResultTypes();
+
+  // Cast values to the given types, where they differ.
+  auto castTo = [&](OpBuilder &b, ValueRange values, TypeRange types) {
+    SmallVector<Value, 4> casted;
+    for (auto [value, type] : llvm::zip(values, types))
+      casted.emplace_back(value.getType() == type
+                              ? value
+                              : b.create<memref::CastOp>(loc, type, value)
+                                    .getResult());
+    return casted;
+  };
+
+  std::function<SmallVector<Value, 4>(OpBuilder &, size_t)> emitDispatch =
+      [&](OpBuilder &b, size_t index) -> SmallVector<Value, 4> {
+    if (index == specOps.size())
+      return llvm::to_vector<4>(
+          b.create<func::CallOp>(loc, dynamicOp, inputs).getResults());
+    func::FuncOp specOp = specOps[index];
+    MultiDialectBuilder<MathBuilder, MemRefBuilder> create(b, loc);
+    // Check the dimensions that are dynamic in the function and static in the
+    // specialization.
+    Value cond = create.math.constant(b.getI1Type(), 1);
+    for (auto [input, specType] :
+        llvm::zip(inputs, specOp.getArgumentTypes())) {
+      auto type = input.getType().dyn_cast<MemRefType>();
+      if (!type || type == specType)
+        continue;
+      auto specMemRefType = specType.cast<MemRefType>();
+      for (int64_t d = 0; d < type.getRank(); ++d) {
+        int64_t dim = specMemRefType.getDimSize(d);
+        if (!type.isDynamicDim(d) || ShapedType::isDynamic(dim))
+          continue;
+        Value isEqual = create.math.eq(
+            create.mem.dim(input, d), create.math.constantIndex(dim));
+        cond = create.math.andi(cond, isEqual);
+      }
+    }
+    auto ifOp = b.create<scf::IfOp>(loc, resultTypes, cond,
+        /*withElseRegion=*/true);
+    OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+    auto callOp = thenBuilder.create<func::CallOp>(loc, specOp,
+        castTo(thenBuilder, inputs, specOp.getArgumentTypes()));
+    thenBuilder.create<scf::YieldOp>(
+        loc, castTo(thenBuilder, callOp.getResults(), resultTypes));
+    OpBuilder elseBuilder = ifOp.getElseBodyBuilder();
+    elseBuilder.create<scf::YieldOp>(loc, emitDispatch(elseBuilder, index + 1));
+    return llvm::to_vector<4>(ifOp.getResults());
+  };
+  builder.create<func::ReturnOp>(loc, emitDispatch(builder, 0));
+}
+
+/*!
+ *  Module pass that dispatches the entry point functions to their
+ *  specializations for static shapes.
+ */
+class ShapeDispatchPass
+    : public PassWrapper<ShapeDispatchPass, OperationPass<ModuleOp>> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ShapeDispatchPass)
+
+  StringRef getArgument() const override { return "shape-dispatch"; }
+
+  StringRef getDescription() const override {
+    return "Dispatch entry point functions to their specializations for the "
+           "shapes of their inputs";
+  }
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    llvm::MapVector<Operation *, SmallVector<func::FuncOp, 4>> specializations;
+    SmallVector<func::FuncOp, 4> ignoredOps;
+    module.walk([&](func::FuncOp specOp) {
+      auto funcRef =
+          specOp->getAttrOfType<FlatSymbolRefAttr>(SPECIALIZATION_OF_ATTRIBUTE);
+      if (!funcRef)
+        return;
+      specOp->removeAttr(SPECIALIZATION_OF_ATTRIBUTE);
+      specOp.setPrivate();
+      auto funcOp = symbolTable.lookup<func::FuncOp>(funcRef.getValue());
+      if (!funcOp || !isCompatible(funcOp, specOp)) {
+        specOp.emitWarning("shape specialization ignored");
+        ignoredOps.emplace_back(specOp);
+        return;
+      }
+      specializations[funcOp].emplace_back(specOp);
+    });
+    for (func::FuncOp specOp : ignoredOps)
+      specOp.erase();
+    for (auto &[funcOp, specOps] : specializations)
+      dispatch(cast<func::FuncOp>(funcOp), specOps, symbolTable);
+  }
+};
+} // namespace
+
+namespace onnx_mlir {
+namespace krnl {
+std::unique_ptr<Pass> createShapeDispatchPass() {
+  return std::make_unique<ShapeDispatchPass>();
+}
+} // namespace krnl
+} // namespace onnx_mlir
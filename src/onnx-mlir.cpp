@@ -11,20 +11,181 @@
 // Implements main for onnx-mlir driver.
 //===----------------------------------------------------------------------===//
 
+#include "src/Compiler/CompilerCache.hpp"
 #include "src/Compiler/CompilerOptions.hpp"
 #include "src/Compiler/CompilerUtils.hpp"
 #include "src/Version/Version.hpp"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using namespace onnx_mlir;
 
 extern llvm::cl::OptionCategory onnx_mlir::OnnxMlirOptions;
 
-int main(int argc, char *argv[]) {
+// Compile the input file with the parsed options, the arguments giving the
+// key of the compilation cache. Return 0 on success.
+static int compile(int argc, const char *const *argv,
+    const std::string &inputFilename, std::string outputBaseName,
+    EmissionTargetType emissionTarget, bool useCustomEnvFlags) {
+  // Test option requirements.
+  if (!ONNXOpStats.empty() && emissionTarget <= EmitONNXIR)
+    llvm::errs()
+        << "Warning: --onnx-op-stats requires targets like --EmitMLIR, "
+           "--EmitLLVMIR, or binary-generating emit commands.\n";
+
+  // Input file base name, replace path if required.
+  // outputBaseName must specify a file, so ignore invalid values
+  // such as ".", "..", "./", "/.", etc.
+  bool b = false;
+  if (outputBaseName == "" ||
+      (b = std::regex_match(
+           outputBaseName.substr(outputBaseName.find_last_of("/\\") + 1),
+           std::regex("[\\.]*$")))) {
+    if (b)
+      llvm::errs() << "Invalid -o option value " << outputBaseName
+                   << " ignored.\n";
+    outputBaseName = inputFilename.substr(0, inputFilename.find_last_of("."));
+  }
+
+  // Copy the output file from the compilation cache if it has it. The key
+  // covers the options of the command line and of the custom env var, except
+  // for the input and output file names which do not change the artifact.
+  std::string cacheKey;
+  std::string outputFilename =
+      getTargetFilename(outputBaseName, emissionTarget);
+  if (isCompileCacheable(emissionTarget) && inputFilename != "-") {
+    auto model = llvm::MemoryBuffer::getFile(inputFilename);
+    if (model) {
+      std::vector<std::string> options;
+      for (int i = 1; i < argc; ++i) {
+        llvm::StringRef arg(argv[i]);
+        if (arg == inputFilename || arg.startswith("-o=") ||
+            arg.startswith("--o="))
+          continue;
+        if (arg == "-o" || arg == "--o") {
+          ++i;
+          continue;
+        }
+        options.emplace_back(arg.str());
+      }
+      if (useCustomEnvFlags)
+        if (const auto &envFlags = getEnvVar(customEnvFlags))
+          options.emplace_back(envFlags.value());
+      cacheKey = getCompileCacheKey(
+          model.get()->getBuffer(), options, emissionTarget);
+      if (lookupCompileCache(cacheKey, outputFilename))
+        return 0;
+    }
+  }
+
   mlir::MLIRContext context;
   registerDialects(context);
 
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  std::string errorMessage;
+  int rc = processInputFile(inputFilename, context, module, &errorMessage);
+  if (rc != 0) {
+    if (!errorMessage.empty())
+      llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+
+  rc = compileModule(module, context, outputBaseName, emissionTarget);
+  if (rc == 0 && !cacheKey.empty())
+    storeCompileCache(cacheKey, outputFilename);
+  return rc;
+}
+
+#if !defined(_WIN32)
+// Serve the compile requests of the clients connecting to the Unix socket at
+// the path, each request being a line with the working directory of the
+// compile followed by a line of onnx-mlir arguments, answered by a line with
+// the return code of the compile. Each connection is served by its own
+// thread, the compiles being serialized since they parse the arguments into
+// the process-global options and change the working directory. Only return on
+// failure to listen.
+static int serveCompileRequests(const std::string &socketPath,
+    const std::function<int(int, const char *const *)> &compileRequest) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(addr.sun_path)) {
+    llvm::errs() << "Socket path " << socketPath << " is too long\n";
+    return 1;
+  }
+  strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+  unlink(socketPath.c_str());
+  int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0 ||
+      bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(listenFd, SOMAXCONN) != 0) {
+    llvm::errs() << "Cannot listen on " << socketPath << ": "
+                 << strerror(errno) << "\n";
+    return 1;
+  }
+  std::mutex compileMutex;
+  while (true) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      llvm::errs() << "Cannot accept connections on " << socketPath << ": "
+                   << strerror(errno) << "\n";
+      return 1;
+    }
+    std::thread([fd, &compileMutex, &compileRequest]() {
+      // Read the working directory and the arguments, each ending its line.
+      std::string request;
+      char buffer[1024];
+      ssize_t size;
+      while (llvm::count(request, '\n') < 2 &&
+             (size = read(fd, buffer, sizeof(buffer))) > 0)
+        request.append(buffer, size);
+      auto [workingDir, argLine] = llvm::StringRef(request).split('\n');
+      llvm::SmallVector<llvm::StringRef, 16> args;
+      llvm::SplitString(argLine.split('\n').first, args);
+      std::vector<std::string> argStrs = {"onnx-mlir"};
+      for (llvm::StringRef arg : args)
+        argStrs.emplace_back(arg.str());
+      std::vector<const char *> argv;
+      for (const std::string &arg : argStrs)
+        argv.push_back(arg.c_str());
+      int rc;
+      {
+        std::lock_guard<std::mutex> lock(compileMutex);
+        llvm::cl::ResetAllOptionOccurrences();
+        if (llvm::sys::fs::set_current_path(workingDir))
+          rc = InvalidInputFileAccess;
+        else if (!llvm::cl::ParseCommandLineOptions(
+                     argv.size(), argv.data(), "", &llvm::errs()))
+          rc = InvalidCompilerOption;
+        else
+          rc = compileRequest(argv.size(), argv.data());
+      }
+      std::string reply = std::to_string(rc) + "\n";
+      if (write(fd, reply.data(), reply.size()) < 0)
+        llvm::errs() << "Cannot reply to a compile request\n";
+      close(fd);
+    }).detach();
+  }
+}
+#endif
+
+int main(int argc, char *argv[]) {
   llvm::cl::opt<std::string> inputFilename(llvm::cl::Positional,
       llvm::cl::desc("<input file>"), llvm::cl::init("-"),
       llvm::cl::cat(OnnxMlirOptions));
@@ -52,6 +213,14 @@ int main(int argc, char *argv[]) {
           clEnumVal(EmitJNI, "Compile the input into a jar file.")),
       llvm::cl::init(EmitLib), llvm::cl::cat(OnnxMlirOptions));
 
+  llvm::cl::opt<std::string> daemonSocket("daemon",
+      llvm::cl::desc("Serve the compile requests sent to the Unix socket at "
+                     "the given path instead of compiling the input file. "
+                     "A request is a line with the working directory and a "
+                     "line of onnx-mlir arguments, answered by a line with "
+                     "the return code of the compile."),
+      llvm::cl::value_desc("path"), llvm::cl::cat(OnnxMlirOptions));
+
   // Register MLIR command line options.
   mlir::registerAsmPrinterCLOptions();
   mlir::registerMLIRContextCLOptions();
@@ -68,34 +237,20 @@ int main(int argc, char *argv[]) {
     llvm::errs() << "Failed to parse options\n";
     return 1;
   }
-  // Test option requirements.
-  if (!ONNXOpStats.empty() && emissionTarget <= EmitONNXIR)
-    llvm::errs()
-        << "Warning: --onnx-op-stats requires targets like --EmitMLIR, "
-           "--EmitLLVMIR, or binary-generating emit commands.\n";
-
-  mlir::OwningOpRef<mlir::ModuleOp> module;
-  std::string errorMessage;
-  int rc = processInputFile(inputFilename, context, module, &errorMessage);
-  if (rc != 0) {
-    if (!errorMessage.empty())
-      llvm::errs() << errorMessage << "\n";
-    return 1;
-  }
 
-  // Input file base name, replace path if required.
-  // outputBaseName must specify a file, so ignore invalid values
-  // such as ".", "..", "./", "/.", etc.
-  bool b = false;
-  if (outputBaseName == "" ||
-      (b = std::regex_match(
-           outputBaseName.substr(outputBaseName.find_last_of("/\\") + 1),
-           std::regex("[\\.]*$")))) {
-    if (b)
-      llvm::errs() << "Invalid -o option value " << outputBaseName
-                   << " ignored.\n";
-    outputBaseName = inputFilename.substr(0, inputFilename.find_last_of("."));
+#if !defined(_WIN32)
+  // Compile the requests of the clients with the options of their requests,
+  // the context setup and the registrations being done once for all.
+  if (!daemonSocket.empty()) {
+    std::string socketPath = daemonSocket;
+    return serveCompileRequests(
+        socketPath, [&](int requestArgc, const char *const *requestArgv) {
+          return compile(requestArgc, requestArgv, inputFilename,
+              outputBaseName, emissionTarget, /*useCustomEnvFlags=*/false);
+        });
   }
+#endif
 
-  return compileModule(module, context, outputBaseName, emissionTarget);
+  return compile(argc, argv, inputFilename, outputBaseName, emissionTarget,
+      /*useCustomEnvFlags=*/true);
 }
\ No newline at end of file
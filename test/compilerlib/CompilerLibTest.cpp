@@ -14,7 +14,10 @@ using namespace onnx_mlir;
 std::string testFileName;
 std::string outputBaseName;
 std::string flags;
+std::string sessionFlags;
 bool compileFromFile = false;
+bool compileWithSession = false;
+bool compileToBuffer = false;
 
 #define IGNORE_ARG(FLAG)                                                       \
   if (arg.find(FLAG) == 0) {                                                   \
@@ -39,6 +42,8 @@ bool compileFromFile = false;
 bool readArg(const std::string &arg) {
   PARSE_ARG(outputBaseName, "-o");
   PARSE_FLAG(compileFromFile, "--fromfile");
+  PARSE_FLAG(compileWithSession, "--session");
+  PARSE_FLAG(compileToBuffer, "--tobuffer");
   PARSE_UNSUPPORTED_FLAG("--EmitLib");
   IGNORE_ARG("-"); // Ignore all other options.
   testFileName = arg;
@@ -64,7 +69,9 @@ void readCommandLineAndKeepUnused(int &argc, char *argv[]) {
 void readArgsFromCommandLine(int argc, char *argv[]) {
   for (int i = 1; i < argc; i++) {
     flags.append(std::string(argv[i]) + " ");
-    readArg(std::string(argv[i]));
+    // The unused arguments are the options of the compile session.
+    if (!readArg(std::string(argv[i])))
+      sessionFlags.append(std::string(argv[i]) + " ");
   }
 }
 
@@ -88,6 +95,41 @@ int main(int argc, char *argv[]) {
         testFileName.c_str(), flags.c_str(), &compiledFilename, &errorMessage);
     if (retVal != CompilerSuccess && errorMessage != NULL)
       std::cerr << errorMessage;
+  } else if (compileToBuffer) {
+    std::ifstream inFile(
+        testFileName, std::ios_base::in | std::ios_base::binary);
+    std::string test((std::istreambuf_iterator<char>(inFile)),
+        std::istreambuf_iterator<char>());
+    void *library;
+    int64_t librarySize;
+    retVal = omCompileFromArrayToBuffer(test.data(), test.size(), &library,
+        &librarySize, &errorMessage);
+    if (retVal == CompilerSuccess) {
+      // Write the library where the other modes would have compiled it.
+      std::ofstream outFile(
+          outputBaseName + ".so", std::ios_base::out | std::ios_base::binary);
+      outFile.write((const char *)library, librarySize);
+      free(library);
+    } else if (errorMessage != NULL) {
+      std::cerr << errorMessage;
+    }
+  } else if (compileWithSession) {
+    std::ifstream inFile(
+        testFileName, std::ios_base::in | std::ios_base::binary);
+    std::string test((std::istreambuf_iterator<char>(inFile)),
+        std::istreambuf_iterator<char>());
+    OMCompileSession *session =
+        omCompileSessionCreate(sessionFlags.c_str(), &errorMessage);
+    if (!session) {
+      retVal = InvalidCompilerOption;
+    } else {
+      retVal = omCompileSessionCompileFromArray(session, test.data(),
+          test.size(), outputBaseName.c_str(), onnx_mlir::EmitLib,
+          &compiledFilename, &errorMessage);
+      omCompileSessionDestroy(session);
+    }
+    if (retVal != CompilerSuccess && errorMessage != NULL)
+      std::cerr << errorMessage;
   } else {
     std::ifstream inFile(
         testFileName, std::ios_base::in | std::ios_base::binary);
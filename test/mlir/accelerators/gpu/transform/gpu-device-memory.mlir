@@ -0,0 +1,43 @@
+// RUN: onnx-mlir-opt --maccel=GPU --gpu-device-memory %s -split-input-file | FileCheck %s
+
+// Check that a buffer only used by kernels is allocated on the device, that
+// an input is copied once at the entry, and that a buffer returned to the
+// host is copied around the kernel writing it.
+module attributes {gpu.container_module} {
+  gpu.module @kernels {
+    gpu.func @double(%arg0: memref<64xf32>, %arg1: memref<64xf32>) kernel {
+      %0 = gpu.thread_id x
+      %1 = memref.load %arg0[%0] : memref<64xf32>
+      %2 = arith.addf %1, %1 : f32
+      memref.store %2, %arg1[%0] : memref<64xf32>
+      gpu.return
+    }
+  }
+
+  func.func @main_graph(%arg0: memref<64xf32>) -> memref<64xf32> {
+    %c1 = arith.constant 1 : index
+    %c64 = arith.constant 64 : index
+    %0 = memref.alloc() : memref<64xf32>
+    %1 = memref.alloc() : memref<64xf32>
+    gpu.launch_func @kernels::@double blocks in (%c1, %c1, %c1) threads in (%c64, %c1, %c1) args(%arg0 : memref<64xf32>, %0 : memref<64xf32>)
+    gpu.launch_func @kernels::@double blocks in (%c1, %c1, %c1) threads in (%c64, %c1, %c1) args(%0 : memref<64xf32>, %1 : memref<64xf32>)
+    return %1 : memref<64xf32>
+  }
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<64xf32>) -> memref<64xf32> {
+// CHECK:           [[VAR_0_:%.+]] = gpu.alloc{{.*}} : memref<64xf32>
+// CHECK:           gpu.memcpy {{.*}}[[VAR_0_]], [[PARAM_0_]] : memref<64xf32>, memref<64xf32>
+// CHECK:           [[VAR_1_:%.+]] = gpu.alloc{{.*}} : memref<64xf32>
+// CHECK:           [[VAR_2_:%.+]] = memref.alloc() : memref<64xf32>
+// CHECK:           gpu.launch_func  @kernels::@double {{.*}} args([[VAR_0_]] : memref<64xf32>, [[VAR_1_]] : memref<64xf32>)
+// CHECK:           [[VAR_3_:%.+]] = gpu.alloc{{.*}} : memref<64xf32>
+// CHECK:           gpu.memcpy {{.*}}[[VAR_3_]], [[VAR_2_]] : memref<64xf32>, memref<64xf32>
+// CHECK:           gpu.launch_func  @kernels::@double {{.*}} args([[VAR_1_]] : memref<64xf32>, [[VAR_3_]] : memref<64xf32>)
+// CHECK:           gpu.memcpy {{.*}}[[VAR_2_]], [[VAR_3_]] : memref<64xf32>, memref<64xf32>
+// CHECK:           gpu.dealloc {{.*}}[[VAR_3_]] : memref<64xf32>
+// CHECK:           gpu.dealloc {{.*}}[[VAR_1_]] : memref<64xf32>
+// CHECK:           gpu.dealloc {{.*}}[[VAR_0_]] : memref<64xf32>
+// CHECK:           return [[VAR_2_]] : memref<64xf32>
+// CHECK:         }
+}
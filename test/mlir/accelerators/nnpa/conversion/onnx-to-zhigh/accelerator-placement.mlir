@@ -0,0 +1,25 @@
+// RUN: onnx-mlir-opt --maccel=NNPA --accelerator-placement %s -split-input-file | FileCheck %s
+
+// Ops that NNPA can run are placed on it, the other ones are left to the CPU.
+func.func @test_place_on_nnpa(%arg0 : tensor<64x64xf32>, %arg1 : tensor<64x64xf32>) -> tensor<64x64xf32> {
+  %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+  %1 = "onnx.Sqrt"(%0) : (tensor<64x64xf32>) -> tensor<64x64xf32>
+  "func.return"(%1) : (tensor<64x64xf32>) -> ()
+
+// CHECK-LABEL:  func @test_place_on_nnpa
+// CHECK:           "onnx.MatMul"(%arg0, %arg1) {device = "nnpa"}
+// CHECK:           "onnx.Sqrt"
+// CHECK-NOT:       device
+// CHECK:           return
+}
+
+// -----
+
+// Ops already placed are kept on their device.
+func.func @test_keep_placed_op(%arg0 : tensor<64x64xf32>, %arg1 : tensor<64x64xf32>) -> tensor<64x64xf32> {
+  %0 = "onnx.MatMul"(%arg0, %arg1) {device = "cpu"} : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+  "func.return"(%0) : (tensor<64x64xf32>) -> ()
+
+// CHECK-LABEL:  func @test_keep_placed_op
+// CHECK:           "onnx.MatMul"(%arg0, %arg1) {device = "cpu"}
+}
@@ -115,6 +115,43 @@ func.func @test_fuse_onnx_relu_conv2d(%arg0: tensor<5x3x32x32xf32>, %arg1 : tens
 
 // -----
 
+func.func @test_fuse_onnx_relu_add_conv2d(%arg0: tensor<5x3x32x32xf32>, %arg1 : tensor<2x3x2x2xf32>, %arg2: tensor<1x2x1x1xf32>) -> tensor<*xf32> {
+  %bias = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%arg0, %arg1, %bias) {kernel_shape = [2, 2]} : (tensor<5x3x32x32xf32>, tensor<2x3x2x2xf32>, none) -> tensor<*xf32>
+  %1 = "onnx.Add"(%0, %arg2) : (tensor<*xf32>, tensor<1x2x1x1xf32>) -> tensor<*xf32>
+  %2 = "onnx.Relu"(%1) : (tensor<*xf32>) -> tensor<*xf32>
+  return %2 : tensor<*xf32>
+
+// CHECK-LABEL:  func @test_fuse_onnx_relu_add_conv2d
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x3x32x32xf32>, [[PARAM_1_:%.+]]: tensor<2x3x2x2xf32>, [[PARAM_2_:%.+]]: tensor<1x2x1x1xf32>) -> tensor<5x2x31x31xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<2> : tensor<1xi64>
+// CHECK-DAG:       [[VAR_1_:%.+]] = "zhigh.Stick"([[PARAM_0_]]) {layout = "NHWC"} : (tensor<5x3x32x32xf32>) -> tensor<5x32x32x3xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.Reshape"([[PARAM_2_]], [[VAR_0_]]) {allowzero = 0 : si64} : (tensor<1x2x1x1xf32>, tensor<1xi64>) -> tensor<2xf32>
+// CHECK-DAG:       [[VAR_3_:%.+]] = "zhigh.Stick"([[VAR_2_]]) {layout = "1D"} : (tensor<2xf32>) -> tensor<2xf32, #zhigh.layout<{dataLayout = "1D"}>>
+// CHECK:           [[VAR_4_:%.+]] = "zhigh.Conv2D"([[VAR_1_]], {{.*}}, [[VAR_3_]]) {act_func = "ACT_RELU", kernel_shape = [2, 2], padding_type = "VALID_PADDING", strides = [1, 1]}
+// CHECK:           [[VAR_5_:%.+]] = "zhigh.Unstick"([[VAR_4_]]) : (tensor<*xf32>) -> tensor<5x2x31x31xf32>
+// CHECK-NOT:       "onnx.Add"
+// CHECK-NOT:       "onnx.Relu"
+// CHECK:           return [[VAR_5_]] : tensor<5x2x31x31xf32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_not_fuse_onnx_add_conv2d_non_channel_bias(%arg0: tensor<5x3x32x32xf32>, %arg1 : tensor<2x3x2x2xf32>, %arg2: tensor<1x2x31x31xf32>) -> tensor<*xf32> {
+  %bias = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%arg0, %arg1, %bias) {kernel_shape = [2, 2]} : (tensor<5x3x32x32xf32>, tensor<2x3x2x2xf32>, none) -> tensor<*xf32>
+  %1 = "onnx.Add"(%0, %arg2) : (tensor<*xf32>, tensor<1x2x31x31xf32>) -> tensor<*xf32>
+  return %1 : tensor<*xf32>
+
+// CHECK-LABEL:  func @test_not_fuse_onnx_add_conv2d_non_channel_bias
+// CHECK:           "zhigh.Conv2D"
+// CHECK-SAME:      act_func = "ACT_NONE"
+// CHECK:           {{"onnx.Add"|"zhigh.Add"}}
+}
+
+// -----
+
 func.func @test_onnx_conv2d_not_lower_unknown_height_weight_dims(%arg0: tensor<5x3x?x?xf32>, %arg1 : tensor<2x3x2x2xf32>, %arg2: tensor<2xf32>) -> tensor<*xf32> {
   %0 = "onnx.Conv"(%arg0, %arg1, %arg2) {kernel_shape = [2, 2]} : (tensor<5x3x?x?xf32>, tensor<2x3x2x2xf32>, tensor<2xf32>) -> tensor<*xf32>
   return %0 : tensor<*xf32>
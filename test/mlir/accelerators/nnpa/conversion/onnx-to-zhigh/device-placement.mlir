@@ -0,0 +1,38 @@
+// RUN: onnx-mlir-opt --maccel=NNPA --shape-inference --device-placement %s -split-input-file | FileCheck %s
+
+// Small ops cost less on the CPU than their launch and layout conversions on
+// NNPA.
+func.func @test_small_add(%arg0 : tensor<10x10xf32>, %arg1 : tensor<10x10xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<10x10xf32>, tensor<10x10xf32>) -> tensor<*xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_small_add
+// CHECK:           "onnx.Add"(%arg0, %arg1) {device = "cpu"}
+// CHECK:           "onnx.Relu"({{.*}}) {device = "cpu"}
+}
+
+// -----
+
+// A large matmul and the elementwise op consuming it are placed together on
+// NNPA.
+func.func @test_large_matmul_relu(%arg0 : tensor<1024x1024xf32>, %arg1 : tensor<1024x1024xf32>) -> tensor<*xf32> {
+  %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<1024x1024xf32>, tensor<1024x1024xf32>) -> tensor<*xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_large_matmul_relu
+// CHECK:           "onnx.MatMul"(%arg0, %arg1) {device = "nnpa"}
+// CHECK:           "onnx.Relu"({{.*}}) {device = "nnpa"}
+}
+
+// -----
+
+// Ops with unknown costs stay on NNPA.
+func.func @test_dynamic_add(%arg0 : tensor<?x10xf32>, %arg1 : tensor<?x10xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<?x10xf32>, tensor<?x10xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_dynamic_add
+// CHECK:           "onnx.Add"(%arg0, %arg1) {device = "nnpa"}
+}
@@ -592,3 +592,49 @@ func.func @test_onnx_conv2d_not_insert_onnxpad_if_auto_pad_is_valid(%arg0: tenso
   // CHECK-NOT: "onnx.Pad"
 }
 
+
+// -----
+
+// Split the M dimension exceeding the NNPA dimension limit into two tiles.
+func.func @test_matmul_split_for_nnpa_limit(%arg0: tensor<40000x64xf32>, %arg1: tensor<64x128xf32>) -> tensor<40000x128xf32> {
+  %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<40000x64xf32>, tensor<64x128xf32>) -> tensor<40000x128xf32>
+  return %0 : tensor<40000x128xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_split_for_nnpa_limit
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<40000x64xf32>, [[PARAM_1_:%.+]]: tensor<64x128xf32>) -> tensor<40000x128xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<20000> : tensor<2xi64>
+// CHECK:           [[VAR_1_:%.+]]:2 = "onnx.Split"([[PARAM_0_]], [[VAR_0_]]) {axis = 0 : si64} : (tensor<40000x64xf32>, tensor<2xi64>) -> (tensor<20000x64xf32>, tensor<20000x64xf32>)
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.MatMul"([[VAR_1_]]#0, [[PARAM_1_]]) : (tensor<20000x64xf32>, tensor<64x128xf32>) -> tensor<20000x128xf32>
+// CHECK-DAG:       [[VAR_3_:%.+]] = "onnx.MatMul"([[VAR_1_]]#1, [[PARAM_1_]]) : (tensor<20000x64xf32>, tensor<64x128xf32>) -> tensor<20000x128xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.Concat"([[VAR_2_]], [[VAR_3_]]) {axis = 0 : si64} : (tensor<20000x128xf32>, tensor<20000x128xf32>) -> tensor<40000x128xf32>
+// CHECK:           return [[VAR_4_]] : tensor<40000x128xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Split an elementwise op, using the broadcasted operand whole in each tile.
+func.func @test_add_split_for_nnpa_limit(%arg0: tensor<3x40000xf32>, %arg1: tensor<3x1xf32>) -> tensor<3x40000xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<3x40000xf32>, tensor<3x1xf32>) -> tensor<3x40000xf32>
+  return %0 : tensor<3x40000xf32>
+
+// CHECK-LABEL:  func.func @test_add_split_for_nnpa_limit
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<3x40000xf32>, [[PARAM_1_:%.+]]: tensor<3x1xf32>) -> tensor<3x40000xf32> {
+// CHECK:           [[VAR_1_:%.+]]:2 = "onnx.Split"([[PARAM_0_]], {{.*}}) {axis = 1 : si64} : (tensor<3x40000xf32>, tensor<2xi64>) -> (tensor<3x20000xf32>, tensor<3x20000xf32>)
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.Add"([[VAR_1_]]#0, [[PARAM_1_]]) : (tensor<3x20000xf32>, tensor<3x1xf32>) -> tensor<3x20000xf32>
+// CHECK-DAG:       [[VAR_3_:%.+]] = "onnx.Add"([[VAR_1_]]#1, [[PARAM_1_]]) : (tensor<3x20000xf32>, tensor<3x1xf32>) -> tensor<3x20000xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.Concat"([[VAR_2_]], [[VAR_3_]]) {axis = 1 : si64} : (tensor<3x20000xf32>, tensor<3x20000xf32>) -> tensor<3x40000xf32>
+// CHECK:           return [[VAR_4_]] : tensor<3x40000xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Do not split when the reduced dimension K exceeds the limit.
+func.func @test_matmul_no_split_for_nnpa_limit(%arg0: tensor<40000x40000xf32>, %arg1: tensor<40000x128xf32>) -> tensor<40000x128xf32> {
+  %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<40000x40000xf32>, tensor<40000x128xf32>) -> tensor<40000x128xf32>
+  return %0 : tensor<40000x128xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_no_split_for_nnpa_limit
+// CHECK-NOT:       "onnx.Split"
+}
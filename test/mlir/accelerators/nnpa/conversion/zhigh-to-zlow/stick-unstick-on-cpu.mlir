@@ -0,0 +1,50 @@
+// RUN: onnx-mlir-opt --maccel=NNPA --fusion --nnpa-fuse-layout-conversion --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the input computed by a CPU op is stickified, and the output
+// used by a CPU op unstickified, by CPU loops converting between f32 and
+// dlfloat16 through the layout map of the ztensor, to be fused with the loops
+// of the CPU ops.
+
+func.func @test_stick_unstick_on_cpu(%arg0: tensor<4x8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %1 = "zhigh.Stick"(%0) {layout = "2D"} : (tensor<4x8xf32>) -> tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>
+  %2 = "zhigh.Relu"(%1) : (tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>) -> tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>
+  %3 = "zhigh.Unstick"(%2) : (tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>) -> tensor<4x8xf32>
+  %4 = "onnx.Exp"(%3) : (tensor<4x8xf32>) -> tensor<*xf32>
+  return %4 : tensor<*xf32>
+
+// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<(d0, d1) -> (0, d1 floordiv 64, 0, d0 floordiv 32, d0 mod 32, d1 mod 64)>
+// CHECK-LABEL:  func @test_stick_unstick_on_cpu
+// CHECK-NOT:       zlow.stick
+// CHECK:           [[STICKED_:%.+]] = memref.alloc() {{.*}}: memref<4x8xf16, [[MAP_0_]]>
+// CHECK:           krnl.iterate
+// CHECK:             [[FP32_:%.+]] = krnl.load {{.*}} : memref<4x8xf32>
+// CHECK:             [[BITS_:%.+]] = arith.bitcast [[FP32_]] : f32 to i32
+// CHECK:             [[BITS16_:%.+]] = arith.trunci {{.*}} : i32 to i16
+// CHECK:             [[DLF16_:%.+]] = arith.bitcast [[BITS16_]] : i16 to f16
+// CHECK:             krnl.store [[DLF16_]], [[STICKED_]]{{.*}} : memref<4x8xf16, [[MAP_0_]]>
+// CHECK:           "zlow.relu"([[STICKED_]], {{.*}}, [[RELU_:%.+]]) {layout = "2D"}
+// CHECK-NOT:       zlow.unstick
+// CHECK:           krnl.iterate
+// CHECK:             [[LOADED_:%.+]] = krnl.load [[RELU_]]{{.*}} : memref<4x8xf16, [[MAP_0_]]>
+// CHECK:             [[LOADED16_:%.+]] = arith.bitcast [[LOADED_]] : f16 to i16
+// CHECK:             [[LOADED32_:%.+]] = arith.extui [[LOADED16_]] : i16 to i32
+// CHECK:             [[UNSTICKED_:%.+]] = arith.bitcast {{.*}} : i32 to f32
+// CHECK:             krnl.store [[UNSTICKED_]], {{.*}} : memref<4x8xf32>
+// CHECK:           return {{.*}} : memref<4x8xf32>
+}
+
+// -----
+
+// Check that a stickified function argument and an unstickified result
+// returned are left to zDNN.
+
+func.func @test_stick_unstick_not_on_cpu(%arg0: tensor<4x8xf32>) -> tensor<*xf32> {
+  %0 = "zhigh.Stick"(%arg0) {layout = "2D"} : (tensor<4x8xf32>) -> tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>
+  %1 = "zhigh.Unstick"(%0) : (tensor<4x8xf32, #zhigh.layout<{dataLayout = "2D"}>>) -> tensor<*xf32>
+  return %1 : tensor<*xf32>
+
+// CHECK-LABEL:  func @test_stick_unstick_not_on_cpu
+// CHECK:           "zlow.stick"
+// CHECK:           "zlow.unstick"
+}
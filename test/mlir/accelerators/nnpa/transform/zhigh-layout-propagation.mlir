@@ -201,6 +201,68 @@ func.func @onnx_concat_layout_propagation_4d(%arg0: tensor<?x4x4x192xf32, #zhigh
 
 // -----
 
+func.func @onnx_concat_layout_propagation_nhwc_axis_n(%arg0: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>, %arg1: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>> {
+  %0 = "zhigh.Unstick"(%arg0) : (tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<?x100x4x4xf32>
+  %1 = "zhigh.Unstick"(%arg1) : (tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<?x100x4x4xf32>
+  %2 = "onnx.Concat"(%0, %1) {axis = 0 : si64} : (tensor<?x100x4x4xf32>, tensor<?x100x4x4xf32>) -> tensor<?x100x4x4xf32>
+  %3 = "zhigh.Stick"(%2) {layout = "NHWC"} : (tensor<?x100x4x4xf32>) -> tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+  return %3 : tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+
+// CHECK-LABEL:  func.func @onnx_concat_layout_propagation_nhwc_axis_n
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>, [[PARAM_1_:%.+]]: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Concat"([[PARAM_0_]], [[PARAM_1_]]) {axis = 0 : si64} : (tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>, tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+// CHECK:           return [[VAR_0_]] : tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+// CHECK:         }
+}
+
+// -----
+
+func.func @onnx_concat_layout_propagation_4d_axis_h(%arg0: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>, %arg1: tensor<?x6x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>> {
+  %0 = "zhigh.Unstick"(%arg0) : (tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<?x4x4x100xf32>
+  %1 = "zhigh.Unstick"(%arg1) : (tensor<?x6x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<?x6x4x100xf32>
+  %2 = "onnx.Concat"(%0, %1) {axis = 1 : si64} : (tensor<?x4x4x100xf32>, tensor<?x6x4x100xf32>) -> tensor<?x10x4x100xf32>
+  %3 = "zhigh.Stick"(%2) {layout = "4D"} : (tensor<?x10x4x100xf32>) -> tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>
+  return %3 : tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>
+
+// CHECK-LABEL:  func.func @onnx_concat_layout_propagation_4d_axis_h
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>, [[PARAM_1_:%.+]]: tensor<?x6x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Concat"([[PARAM_0_]], [[PARAM_1_]]) {axis = 1 : si64} : (tensor<?x4x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>, tensor<?x6x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>
+// CHECK:           return [[VAR_0_]] : tensor<?x10x4x100xf32, #zhigh.layout<{dataLayout = "4D"}>>
+// CHECK:         }
+}
+
+// -----
+
+func.func @onnx_transpose_layout_propagation_nhwc(%arg0: tensor<1x4x8x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>> {
+  %0 = "zhigh.Unstick"(%arg0) : (tensor<1x4x8x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<1x64x4x8xf32>
+  %1 = "onnx.Transpose"(%0) {perm = [0, 1, 3, 2]} : (tensor<1x64x4x8xf32>) -> tensor<1x64x8x4xf32>
+  %2 = "zhigh.Stick"(%1) {layout = "NHWC"} : (tensor<1x64x8x4xf32>) -> tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+  return %2 : tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+
+// CHECK-LABEL:  func.func @onnx_transpose_layout_propagation_nhwc
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x4x8x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Transpose"([[PARAM_0_]]) {perm = [0, 2, 1, 3]} : (tensor<1x4x8x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>) -> tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+// CHECK:           return [[VAR_0_]] : tensor<1x8x4x64xf32, #zhigh.layout<{dataLayout = "NHWC"}>>
+// CHECK:         }
+}
+
+// -----
+
+func.func @onnx_transpose_layout_propagation_4d(%arg0: tensor<2x4x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>> {
+  %0 = "zhigh.Unstick"(%arg0) : (tensor<2x4x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<2x4x8x64xf32>
+  %1 = "onnx.Transpose"(%0) {perm = [1, 0, 2, 3]} : (tensor<2x4x8x64xf32>) -> tensor<4x2x8x64xf32>
+  %2 = "zhigh.Stick"(%1) {layout = "4D"} : (tensor<4x2x8x64xf32>) -> tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>
+  return %2 : tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>
+
+// CHECK-LABEL:  func.func @onnx_transpose_layout_propagation_4d
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x4x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Transpose"([[PARAM_0_]]) {perm = [1, 0, 2, 3]} : (tensor<2x4x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>) -> tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>
+// CHECK:           return [[VAR_0_]] : tensor<4x2x8x64xf32, #zhigh.layout<{dataLayout = "4D"}>>
+// CHECK:         }
+}
+
+// -----
+
 // TODO: enable this once DLFLOAT16-based calculation is supported.
 // Data layout propagation for ONNX operations.
 // Take ONNXSqrtOp as the representative of unary element-wise ops.
@@ -0,0 +1,44 @@
+// RUN: onnx-mlir-opt --maccel=NNPA --zlow-async-overlap %s -split-input-file | FileCheck %s
+
+func.func @test_overlap_independent_loop(%arg0: memref<1x1x1x1x32x64xf16>, %arg1: memref<2xi64>, %arg2: memref<64xf32>) -> (memref<1x1x1x1x32x64xf16>, memref<64xf32>) {
+  %0 = memref.alloc() {alignment = 4096 : i64} : memref<1x1x1x1x32x64xf16>
+  "zlow.relu"(%arg0, %arg1, %0) {layout = "2D"} : (memref<1x1x1x1x32x64xf16>, memref<2xi64>, memref<1x1x1x1x32x64xf16>) -> ()
+  %1 = memref.alloc() {alignment = 16 : i64} : memref<64xf32>
+  affine.for %arg3 = 0 to 64 {
+    %2 = affine.load %arg2[%arg3] : memref<64xf32>
+    %3 = arith.addf %2, %2 : f32
+    affine.store %3, %1[%arg3] : memref<64xf32>
+  }
+  return %0, %1 : memref<1x1x1x1x32x64xf16>, memref<64xf32>
+
+  // CHECK-LABEL:  func.func @test_overlap_independent_loop
+  // CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {alignment = 4096 : i64} : memref<1x1x1x1x32x64xf16>
+  // CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<64xf32>
+  // CHECK:           scf.parallel ([[I_0_:%.+]]) =
+  // CHECK:             scf.if
+  // CHECK-NEXT:          krnl.region {
+  // CHECK-NEXT:            "zlow.relu"
+  // CHECK:               } else {
+  // CHECK-NEXT:          krnl.region {
+  // CHECK-NEXT:            affine.for
+  // CHECK:           return [[RES_]], [[RES_1_]]
+}
+
+// -----
+
+func.func @test_no_overlap_dependent_loop(%arg0: memref<1x1x1x1x32x64xf16>, %arg1: memref<2xi64>) -> memref<1x1x1x1x32x64xf16> {
+  %0 = memref.alloc() {alignment = 4096 : i64} : memref<1x1x1x1x32x64xf16>
+  "zlow.relu"(%arg0, %arg1, %0) {layout = "2D"} : (memref<1x1x1x1x32x64xf16>, memref<2xi64>, memref<1x1x1x1x32x64xf16>) -> ()
+  %1 = memref.alloc() {alignment = 4096 : i64} : memref<1x1x1x1x32x64xf16>
+  affine.for %arg2 = 0 to 64 {
+    %2 = affine.load %0[0, 0, 0, 0, 0, %arg2] : memref<1x1x1x1x32x64xf16>
+    affine.store %2, %1[0, 0, 0, 0, 0, %arg2] : memref<1x1x1x1x32x64xf16>
+  }
+  return %1 : memref<1x1x1x1x32x64xf16>
+
+  // CHECK-LABEL:  func.func @test_no_overlap_dependent_loop
+  // CHECK-NOT:       scf.parallel
+  // CHECK:           "zlow.relu"
+  // CHECK-NEXT:      memref.alloc
+  // CHECK-NEXT:      affine.for
+}
@@ -0,0 +1,36 @@
+// RUN: onnx-mlir-opt --maccel=NNPA --enable-memory-pool --bundle-memory-pools --canonicalize --optimize-memory-pools="plan-offsets" --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the normalized 4K-aligned zMemRefs of the zlow ops are bundled
+// into a 4K-aligned memory pool whose slots are reused over their live ranges:
+// the output of the second relu takes the slot of the stickified input, dead
+// after the first relu.
+
+func.func @test_zmemref_memory_pool(%arg0: memref<129x65xf32>) -> memref<129x65xf32> {
+  %0 = memref.alloc() : memref<129x65xf32>
+  %1 = memref.alloc() {alignment = 4096 : i64} : memref<1x2x1x5x32x64xf16>
+  %2 = memref.alloc() {alignment = 4096 : i64} : memref<1x2x1x5x32x64xf16>
+  %3 = memref.alloc() {alignment = 4096 : i64} : memref<1x2x1x5x32x64xf16>
+  %shape = memref.alloc() : memref<2xi64>
+  "zlow.stick"(%arg0, %1) : (memref<129x65xf32>, memref<1x2x1x5x32x64xf16>) -> ()
+  "zlow.relu"(%1, %shape, %2) {layout = "2D"} : (memref<1x2x1x5x32x64xf16>, memref<2xi64>, memref<1x2x1x5x32x64xf16>) -> ()
+  "zlow.relu"(%2, %shape, %3) {layout = "2D"} : (memref<1x2x1x5x32x64xf16>, memref<2xi64>, memref<1x2x1x5x32x64xf16>) -> ()
+  "zlow.unstick"(%3, %0) : (memref<1x2x1x5x32x64xf16>, memref<129x65xf32>) -> ()
+  memref.dealloc %1 : memref<1x2x1x5x32x64xf16>
+  memref.dealloc %2 : memref<1x2x1x5x32x64xf16>
+  memref.dealloc %3 : memref<1x2x1x5x32x64xf16>
+  memref.dealloc %shape : memref<2xi64>
+  return %0 : memref<129x65xf32>
+
+// CHECK-LABEL:  func.func @test_zmemref_memory_pool
+// CHECK-DAG:       [[C0_:%.+]] = arith.constant 0 : i64
+// CHECK-DAG:       [[C40960_:%.+]] = arith.constant 40960 : i64
+// CHECK-DAG:       [[POOL_:%.+]] = memref.alloc() {alignment = 4096 : i64} : memref<81920xi8>
+// CHECK-DAG:       [[IN_:%.+]] = "krnl.getref"([[POOL_]], [[C0_]]) : (memref<81920xi8>, i64) -> memref<1x2x1x5x32x64xf16>
+// CHECK-DAG:       [[MID_:%.+]] = "krnl.getref"([[POOL_]], [[C40960_]]) : (memref<81920xi8>, i64) -> memref<1x2x1x5x32x64xf16>
+// CHECK-DAG:       [[OUT_:%.+]] = "krnl.getref"([[POOL_]], [[C0_]]) : (memref<81920xi8>, i64) -> memref<1x2x1x5x32x64xf16>
+// CHECK:           "zlow.stick"(%arg0, [[IN_]])
+// CHECK:           "zlow.relu"([[IN_]], {{.*}}, [[MID_]])
+// CHECK:           "zlow.relu"([[MID_]], {{.*}}, [[OUT_]])
+// CHECK:           "zlow.unstick"([[OUT_]], {{.*}})
+// CHECK:           memref.dealloc [[POOL_]] : memref<81920xi8>
+}
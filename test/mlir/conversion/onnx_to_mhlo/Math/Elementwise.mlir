@@ -271,4 +271,16 @@ func.func @test_leakyrelu_dynamic(%arg0 : tensor<?x10xf32>) -> tensor<?x10xf32>
 // CHECK-DAG:      [[VAR_7_:%.+]] = mhlo.compare  GT, %arg0, %6,  NOTYPE : (tensor<?x10xf32>, tensor<?x10xf32>) -> tensor<?x10xi1>
 // CHECK-NEXT:     [[VAR_8_:%.+]] = mhlo.select [[VAR_7_]], [[PARAM_0_]], [[VAR_3_]] : tensor<?x10xi1>, tensor<?x10xf32>
 // CHECK-NEXT:     return [[VAR_8_]] : tensor<?x10xf32>
-}
\ No newline at end of file
+}
+// -----
+
+func.func @test_where(%arg0 : tensor<3x1xi1>, %arg1 : tensor<3x4xf32>, %arg2 : tensor<4xf32>) -> tensor<3x4xf32> {
+  %0 = "onnx.Where"(%arg0, %arg1, %arg2) : (tensor<3x1xi1>, tensor<3x4xf32>, tensor<4xf32>) -> tensor<3x4xf32>
+  "func.return"(%0) : (tensor<3x4xf32>) -> ()
+// CHECK-LABEL:  func @test_where
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<3x1xi1>, [[PARAM_1_:%.+]]: tensor<3x4xf32>, [[PARAM_2_:%.+]]: tensor<4xf32>) -> tensor<3x4xf32> {
+// CHECK-DAG:      [[VAR_0_:%.+]] = "mhlo.broadcast_in_dim"([[PARAM_0_]]) {broadcast_dimensions = dense<[0, 1]> : tensor<2xi64>} : (tensor<3x1xi1>) -> tensor<3x4xi1>
+// CHECK-DAG:      [[VAR_1_:%.+]] = "mhlo.broadcast_in_dim"([[PARAM_2_]]) {broadcast_dimensions = dense<1> : tensor<1xi64>} : (tensor<4xf32>) -> tensor<3x4xf32>
+// CHECK:          [[VAR_2_:%.+]] = mhlo.select [[VAR_0_]], [[PARAM_1_]], [[VAR_1_]] : tensor<3x4xi1>, tensor<3x4xf32>
+// CHECK-NEXT:     return [[VAR_2_]] : tensor<3x4xf32>
+}
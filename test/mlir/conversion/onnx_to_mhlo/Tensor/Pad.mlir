@@ -0,0 +1,27 @@
+// RUN: onnx-mlir-opt --convert-onnx-to-mhlo %s --canonicalize -split-input-file | FileCheck %s
+
+func.func @test_pad_constant(%arg0 : tensor<2x3xf32>) -> tensor<4x7xf32> {
+  %0 = "onnx.Constant"() {value = dense<[1, 2, 1, 2]> : tensor<4xi64>} : () -> tensor<4xi64>
+  %1 = "onnx.Constant"() {value = dense<1.000000e+00> : tensor<1xf32>} : () -> tensor<1xf32>
+  %2 = "onnx.Pad"(%arg0, %0, %1) {mode = "constant"} : (tensor<2x3xf32>, tensor<4xi64>, tensor<1xf32>) -> tensor<4x7xf32>
+  "func.return"(%2) : (tensor<4x7xf32>) -> ()
+// CHECK-LABEL:  func @test_pad_constant
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x3xf32>) -> tensor<4x7xf32> {
+// CHECK:          [[VAR_0_:%.+]] = mhlo.constant dense<1.000000e+00> : tensor<f32>
+// CHECK:          [[VAR_1_:%.+]] = mhlo.pad [[PARAM_0_]], [[VAR_0_]], low = [1, 2], high = [1, 2], interior = [0, 0] : (tensor<2x3xf32>, tensor<f32>) -> tensor<4x7xf32>
+// CHECK-NEXT:     return [[VAR_1_]] : tensor<4x7xf32>
+}
+
+// -----
+
+func.func @test_pad_default_value(%arg0 : tensor<2x3xf32>) -> tensor<3x3xf32> {
+  %0 = "onnx.Constant"() {value = dense<[1, 0, 0, 0]> : tensor<4xi64>} : () -> tensor<4xi64>
+  %1 = "onnx.NoValue"() {value} : () -> none
+  %2 = "onnx.Pad"(%arg0, %0, %1) {mode = "constant"} : (tensor<2x3xf32>, tensor<4xi64>, none) -> tensor<3x3xf32>
+  "func.return"(%2) : (tensor<3x3xf32>) -> ()
+// CHECK-LABEL:  func @test_pad_default_value
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x3xf32>) -> tensor<3x3xf32> {
+// CHECK:          [[VAR_0_:%.+]] = mhlo.constant dense<0.000000e+00> : tensor<f32>
+// CHECK:          [[VAR_1_:%.+]] = mhlo.pad [[PARAM_0_]], [[VAR_0_]], low = [1, 0], high = [0, 0], interior = [0, 0] : (tensor<2x3xf32>, tensor<f32>) -> tensor<3x3xf32>
+// CHECK-NEXT:     return [[VAR_1_]] : tensor<3x3xf32>
+}
@@ -0,0 +1,21 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-tosa %s -split-input-file | FileCheck %s
+
+func.func @test_concat(%arg0 : tensor<5x5x1x32xf32>, %arg1 : tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32> {
+  %0 = "onnx.Concat"(%arg0, %arg1) { axis = 2 : si64} : (tensor<5x5x1x32xf32>, tensor<5x5x3x32xf32>)  -> tensor<5x5x4x32xf32>
+  "func.return"(%0) : (tensor<5x5x4x32xf32>) -> ()
+// CHECK-LABEL:  func @test_concat
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x5x1x32xf32>, [[PARAM_1_:%.+]]: tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "tosa.concat"([[PARAM_0_]], [[PARAM_1_]]) {axis = 2 : i64} : (tensor<5x5x1x32xf32>, tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<5x5x4x32xf32>
+}
+
+// -----
+
+func.func @test_concat_negative_axis(%arg0 : tensor<5x5x1x32xf32>, %arg1 : tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32> {
+  %0 = "onnx.Concat"(%arg0, %arg1) { axis = -2 : si64} : (tensor<5x5x1x32xf32>, tensor<5x5x3x32xf32>)  -> tensor<5x5x4x32xf32>
+  "func.return"(%0) : (tensor<5x5x4x32xf32>) -> ()
+// CHECK-LABEL:  func @test_concat_negative_axis
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x5x1x32xf32>, [[PARAM_1_:%.+]]: tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "tosa.concat"([[PARAM_0_]], [[PARAM_1_]]) {axis = 2 : i64} : (tensor<5x5x1x32xf32>, tensor<5x5x3x32xf32>) -> tensor<5x5x4x32xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<5x5x4x32xf32>
+}
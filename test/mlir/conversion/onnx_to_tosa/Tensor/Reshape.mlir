@@ -0,0 +1,11 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-tosa %s -split-input-file | FileCheck %s
+
+func.func @test_reshape(%arg0 : tensor<5x5x1x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Constant"() {value = dense<[5, -1]> : tensor<2xi64>} : () -> tensor<2xi64>
+  %1 = "onnx.Reshape"(%arg0, %0) : (tensor<5x5x1x32xf32>, tensor<2xi64>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_reshape
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x5x1x32xf32>) -> tensor<5x160xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "tosa.reshape"([[PARAM_0_]]) {new_shape = array<i64: 5, 160>} : (tensor<5x5x1x32xf32>) -> tensor<5x160xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<5x160xf32>
+}
@@ -0,0 +1,23 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-tosa %s -split-input-file | FileCheck %s
+
+func.func @test_transpose(%arg0 : tensor<5x5x1x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 3, 1, 2]} : (tensor<5x5x1x32xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_transpose
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x5x1x32xf32>) -> tensor<5x32x5x1xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "tosa.const"() {value = dense<[0, 3, 1, 2]> : tensor<4xi32>} : () -> tensor<4xi32>
+// CHECK-NEXT:      [[VAR_1_:%.+]] = "tosa.transpose"([[PARAM_0_]], [[VAR_0_]]) : (tensor<5x5x1x32xf32>, tensor<4xi32>) -> tensor<5x32x5x1xf32>
+// CHECK-NEXT:      return [[VAR_1_]] : tensor<5x32x5x1xf32>
+}
+
+// -----
+
+func.func @test_transpose_default(%arg0 : tensor<5x1x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Transpose"(%arg0) : (tensor<5x1x32xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_transpose_default
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<5x1x32xf32>) -> tensor<32x1x5xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "tosa.const"() {value = dense<[2, 1, 0]> : tensor<3xi32>} : () -> tensor<3xi32>
+// CHECK-NEXT:      [[VAR_1_:%.+]] = "tosa.transpose"([[PARAM_0_]], [[VAR_0_]]) : (tensor<5x1x32xf32>, tensor<3xi32>) -> tensor<32x1x5xf32>
+// CHECK-NEXT:      return [[VAR_1_]] : tensor<32x1x5xf32>
+}
@@ -0,0 +1,34 @@
+// RUN: onnx-mlir --printIR --EmitMLIR --fusion %s | FileCheck %s
+// RUN: onnx-mlir --printIR --EmitMLIR %s | FileCheck %s --check-prefix=NOFUSION
+
+// Test that the loop nests of a Relu and of the Transpose reading its result,
+// which the fusion of the elementwise ops does not merge, are fused after the
+// lowering to affine, and that the Relu buffer shrinks to a single element.
+
+func.func @test_fuse_relu_transpose(%arg0 : tensor<10x20xf32>) -> tensor<20x10xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<10x20xf32>) -> tensor<10x20xf32>
+  %1 = "onnx.Transpose"(%0) {perm = [1, 0]} : (tensor<10x20xf32>) -> tensor<20x10xf32>
+  "func.return"(%1) : (tensor<20x10xf32>) -> ()
+}
+
+// CHECK-LABEL:  func.func @test_fuse_relu_transpose
+// CHECK-NOT:       memref.alloc() {{.*}}: memref<10x20xf32>
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<20x10xf32>
+// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() : memref<1x1xf32>
+// CHECK:           affine.for [[I_0_:%.+]] = 0 to 10 {
+// CHECK:             affine.for [[I_1_:%.+]] = 0 to 20 {
+// CHECK:               affine.load %arg0{{.}}[[I_0_]], [[I_1_]]{{.}} : memref<10x20xf32>
+// CHECK:               affine.store {{.*}}, [[RES_1_]][0, 0] : memref<1x1xf32>
+// CHECK:               [[LOAD_RES_1_MEM_:%.+]] = affine.load [[RES_1_]][0, 0] : memref<1x1xf32>
+// CHECK:               affine.store [[LOAD_RES_1_MEM_]], [[RES_]]{{.}}[[I_1_]], [[I_0_]]{{.}} : memref<20x10xf32>
+// CHECK:             }
+// CHECK:           }
+// CHECK-NOT:       affine.for
+// CHECK:           return [[RES_]] : memref<20x10xf32>
+
+// NOFUSION-LABEL:  func.func @test_fuse_relu_transpose
+// NOFUSION:        memref.alloc() {{.*}}: memref<10x20xf32>
+// NOFUSION:        affine.for
+// NOFUSION:        memref.alloc() {{.*}}: memref<20x10xf32>
+// NOFUSION:        affine.for
+// NOFUSION:        return
@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: onnx-mlir -v --compile-cache-dir=%t/cache %s -o %t/first 2>&1 | FileCheck --check-prefix=MISS %s
+// RUN: onnx-mlir -v --compile-cache-dir=%t/cache %s -o %t/second 2>&1 | FileCheck --check-prefix=HIT %s
+// RUN: cmp %t/first.so %t/second.so
+// RUN: onnx-mlir -v --compile-cache-dir=%t/cache -O3 %s -o %t/third 2>&1 | FileCheck --check-prefix=MISS %s
+
+// REQUIRES: system-linux
+// MISS:       llc {{.*}} -filetype=obj
+// MISS:       Compilation cached: {{.*}}.so copied to {{.*}}cache{{.*}}.so.
+// HIT-NOT:    llc
+// HIT:        Compilation cache hit: {{.*}}second.so copied from {{.*}}cache{{.*}}.so.
+module {
+  func.func @main_graph(%arg0: tensor<1x1xf32>, %arg1: tensor<1x1xf32>) -> tensor<1x1xf32> {
+    %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<1x1xf32>, tensor<1x1xf32>) -> tensor<1x1xf32>
+    return %0 : tensor<1x1xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: onnx-mlir -v --in-process-codegen %s -o %t/single 2>&1 | FileCheck %s
+// RUN: onnx-mlir -v --in-process-codegen --codegen-partitions=2 %s -o %t/split 2>&1 | FileCheck --check-prefix=SPLIT %s
+// RUN: onnx-mlir -v --in-process-codegen -O3 --EmitObj %s -o %t/obj 2>&1 | FileCheck --check-prefix=OBJ %s
+
+// REQUIRES: system-linux
+// CHECK-NOT:  {{/(opt|llc) }}
+// CHECK:      {{.*}}single.o -o {{.*}}single.so -shared -fPIC
+// SPLIT-NOT:  {{/(opt|llc) }}
+// SPLIT:      {{.*}}split.o {{.*}}split.part1.o -o {{.*}}split.so -shared -fPIC
+// SPLIT:      Shared library {{.*}}split.so has been compiled.
+// OBJ-NOT:    {{/(opt|llc) }}
+// OBJ:        Object file {{.*}}obj.o has been compiled.
+module {
+  func.func @main_graph(%arg0: tensor<1x1xf32>, %arg1: tensor<1x1xf32>) -> tensor<1x1xf32> {
+    %0 = "onnx.MatMul"(%arg0, %arg1) : (tensor<1x1xf32>, tensor<1x1xf32>) -> tensor<1x1xf32>
+    return %0 : tensor<1x1xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+}
@@ -3,7 +3,9 @@
 
 // REQUIRES: system-windows
 // CHECK: define dso_local dllexport ptr @run_main_graph_1
+// CHECK: define dso_local dllexport ptr @run_main_graph_1_into
 // CHECK: define dso_local dllexport ptr @run_main_graph_2
+// CHECK: define dso_local dllexport ptr @run_main_graph_2_into
 // CHECK: define dso_local dllexport ptr @omQueryEntryPoints
 // CHECK: define dso_local dllexport ptr @omInputSignature
 // CHECK: define dso_local dllexport ptr @omOutputSignature
@@ -17,6 +17,19 @@ module {
 // CHECK:             ([[ARG0:%.+]]: !llvm.ptr<i8>) -> !llvm.ptr<i8>
 // CHECK:           {{.*}} = llvm.call @omTensorListGetOmtArray([[ARG0]]) : (!llvm.ptr<i8>) -> !llvm.ptr<ptr<i8>>
 
+// COM: The output is a block argument, not owned by the model, so the variant
+// COM: writing into preallocated outputs copies it without freeing it.
+// CHECK-LABEL:   llvm.func @run_main_graph_into
+// CHECK:             ([[ARG0:%.+]]: !llvm.ptr<i8>, [[ARG1:%.+]]: !llvm.ptr<i8>) -> !llvm.ptr<i8>
+// CHECK:           {{.*}} = llvm.call @omTensorListGetSize([[ARG1]]) : (!llvm.ptr<i8>) -> i64
+// CHECK:           {{.*}} = llvm.call @omTensorGetDataType
+// CHECK:           {{.*}} = llvm.call @omTensorGetRank
+// CHECK:           llvm.call @_mlir_ciface_first_entry
+// CHECK:           {{.*}} = llvm.call @omTensorGetBufferSize
+// CHECK:           llvm.call @llvm.memcpy.p0.p0.i64
+// CHECK-NOT:       llvm.call @free
+// CHECK:           llvm.return [[ARG1]] : !llvm.ptr<i8>
+
 // CHECK:         llvm.mlir.global internal constant @_entry_point_arrays() {addr_space = 0 : i32} : !llvm.array<2 x ptr<i8>> {
 // CHECK-DAG:       [[VAR_0_:%.+]] = llvm.mlir.undef : !llvm.array<2 x ptr<i8>>
 // CHECK-DAG:       [[VAR_2_:%.+]] = llvm.mlir.addressof @_entry_point_0 : !llvm.ptr<array<15 x i8>>
@@ -217,3 +230,100 @@ module attributes {"onnx-mlir.accels" = ["Pseudo-0x10001", "NNPA-0x10000"]} {
 // CHECK-NEXT: ^bb3:  // pred: ^bb2
 // CHECK-NEXT:   {{.*}} = llvm.call @omTensorListGetOmtArray(%arg0) : (!llvm.ptr<i8>) -> !llvm.ptr<ptr<i8>>
 }
+
+// -----
+
+// COM: Generate the variant writing into preallocated outputs for an output
+// COM: owned by the model, which is freed once copied.
+module {
+  func.func private @main_graph(%arg0: memref<10xf32>) -> memref<10xf32> {
+    %0 = memref.alloc() : memref<10xf32>
+    return %0 : memref<10xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-LABEL:   llvm.func @run_main_graph_into
+// CHECK:             ([[ARG0:%.+]]: !llvm.ptr<i8>, [[ARG1:%.+]]: !llvm.ptr<i8>) -> !llvm.ptr<i8>
+// CHECK:           llvm.call @_mlir_ciface_main_graph
+// CHECK:           {{.*}} = llvm.call @omTensorGetBufferSize
+// CHECK:           llvm.cond_br
+// CHECK:           llvm.call @free
+// CHECK:           llvm.return
+// CHECK:           llvm.call @llvm.memcpy.p0.p0.i64
+// CHECK:           llvm.call @free
+// CHECK:           llvm.return [[ARG1]] : !llvm.ptr<i8>
+}
+
+// -----
+
+// COM: Align the inputs when the model owns all its outputs, the entry
+// COM: function assuming the alignment of its inputs, which are noalias. The
+// COM: aligned pointer of an alloc is an offset from its allocated pointer.
+module {
+  func.func private @main_graph(%arg0: memref<10xf32>) -> memref<10xf32> {
+    %0 = memref.alloc() {alignment = 64 : i64} : memref<10xf32>
+    return %0 : memref<10xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-LABEL:   llvm.func {{.*}}@main_graph(
+// CHECK-SAME:        {llvm.noalias}
+// CHECK:           llvm.intr.assume
+// CHECK:           [[ALLOCATED:%.+]] = llvm.call @malloc
+// CHECK-NOT:       llvm.inttoptr
+// CHECK:           llvm.getelementptr [[ALLOCATED]]{{.*}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.intr.assume
+
+// CHECK-LABEL:   llvm.func @run_main_graph
+// CHECK-SAME:        ([[ARG0:%.+]]: !llvm.ptr<i8>) -> !llvm.ptr<i8>
+// CHECK-DAG:       [[ALIGNMENT:%.+]] = llvm.mlir.constant(64 : i64) : i64
+// CHECK-DAG:       [[NULL_PTRS:%.+]] = llvm.mlir.null : !llvm.ptr<ptr<i8>>
+// CHECK:           [[PTRS:%.+]] = llvm.call @omTensorListGetAlignedDataPtrs([[ARG0]], [[ALIGNMENT]]) : (!llvm.ptr<i8>, i64) -> !llvm.ptr<ptr<i8>>
+// CHECK:           [[FAILED:%.+]] = llvm.icmp "eq" [[PTRS]], [[NULL_PTRS]] : !llvm.ptr<ptr<i8>>
+// CHECK:           llvm.cond_br [[FAILED]], ^bb1, ^bb2
+// CHECK:         ^bb1:
+// CHECK:           llvm.return {{.*}} : !llvm.ptr<i8>
+// CHECK:         ^bb2:
+// CHECK:           [[PTR_ADDR:%.+]] = llvm.getelementptr [[PTRS]][{{.*}}] : (!llvm.ptr<ptr<i8>>, i64) -> !llvm.ptr<ptr<i8>>
+// CHECK:           [[PTR:%.+]] = llvm.load [[PTR_ADDR]] : !llvm.ptr<ptr<i8>>
+// CHECK:           [[DATA:%.+]] = llvm.bitcast [[PTR]] : !llvm.ptr<i8> to !llvm.ptr<f32>
+// CHECK:           llvm.insertvalue [[DATA]], {{.*}}[0]
+// CHECK:           llvm.insertvalue [[DATA]], {{.*}}[1]
+// CHECK-NOT:       llvm.call @omTensorGetDataPtr
+// CHECK:           llvm.call @_mlir_ciface_main_graph
+// CHECK:           llvm.call @omTensorListFreeAlignedDataPtrs([[ARG0]], [[PTRS]]) : (!llvm.ptr<i8>, !llvm.ptr<ptr<i8>>) -> ()
+// CHECK:           llvm.return
+}
+
+// -----
+
+// COM: Generate the variant writing into preallocated outputs in place when
+// COM: the entry point function has a variant taking its result as an output
+// COM: argument: the buffer of the output tensor is passed to it, without
+// COM: allocating or copying the result.
+module {
+  func.func @main_graph(%arg0: memref<10xf32>) -> memref<10xf32> {
+    %0 = memref.alloc() : memref<10xf32>
+    call @main_graph_into(%arg0, %0) : (memref<10xf32>, memref<10xf32>) -> ()
+    return %0 : memref<10xf32>
+  }
+  func.func @main_graph_into(%arg0: memref<10xf32>, %arg1: memref<10xf32>) {
+    memref.copy %arg0, %arg1 : memref<10xf32> to memref<10xf32>
+    return
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[    { \22type\22 : \22f32\22 , \22dims\22 : [10] , \22name\22 : \22x\22 }\0A\0A]\00@[   { \22type\22 : \22f32\22 , \22dims\22 : [10] , \22name\22 : \22y\22 }\0A\0A]\00"} : () -> ()
+
+// CHECK-LABEL:   llvm.func @run_main_graph_into
+// CHECK:             ([[ARG0:%.+]]: !llvm.ptr<i8>, [[ARG1:%.+]]: !llvm.ptr<i8>) -> !llvm.ptr<i8>
+// CHECK-NOT:       llvm.call @malloc
+// CHECK:           {{.*}} = llvm.call @omTensorGetBufferSize
+// CHECK:           llvm.cond_br
+// CHECK-NOT:       llvm.call @malloc
+// CHECK:           {{.*}} = llvm.call @omTensorGetShape
+// CHECK:           {{.*}} = llvm.call @omTensorGetStrides
+// CHECK-NOT:       llvm.call @malloc
+// CHECK:           llvm.call @_mlir_ciface_main_graph_into
+// CHECK-NOT:       llvm.call @llvm.memcpy.p0.p0.i64
+// CHECK-NOT:       llvm.call @free
+// CHECK:           llvm.return [[ARG1]] : !llvm.ptr<i8>
+}
@@ -0,0 +1,20 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm %s -split-input-file | FileCheck %s
+
+func.func @test_arena(%arg0: index) {
+  %mark = krnl.arena_mark : i64
+  %0 = krnl.arena_alloc(%arg0) {alignment = 16 : i64} : memref<?xi8>
+  krnl.arena_release %mark : i64
+  return
+}
+
+// CHECK-DAG:     llvm.func @omArenaRelease(i64)
+// CHECK-DAG:     llvm.func @omArenaAlloc(i64, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:     llvm.func @omArenaMark() -> i64
+// CHECK-LABEL:   llvm.func @test_arena
+// CHECK-SAME:    ([[SIZE_:%.+]]: i64) {
+// CHECK:           [[MARK_:%.+]] = llvm.call @omArenaMark() : () -> i64
+// CHECK:           [[ALIGNMENT_:%.+]] = llvm.mlir.constant(16 : i64) : i64
+// CHECK:           [[PTR_:%.+]] = llvm.call @omArenaAlloc([[SIZE_]], [[ALIGNMENT_]]) : (i64, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.call @omArenaRelease([[MARK_]]) : (i64) -> ()
+// CHECK:           llvm.return
+// CHECK:         }
@@ -0,0 +1,48 @@
+// RUN: onnx-mlir-opt --dedup-krnl-constants %s -split-input-file | FileCheck %s
+
+func.func @test_dedup_constants() -> (memref<3xf32>, memref<3xf32>, memref<3xf32>) {
+  %0 = "krnl.global"() {name = "constant_0", shape = [3], value = dense<[1.0, 2.0, 3.0]> : tensor<3xf32>} : () -> memref<3xf32>
+  %1 = "krnl.global"() {name = "constant_1", shape = [3], value = dense<[1.0, 2.0, 4.0]> : tensor<3xf32>} : () -> memref<3xf32>
+  %2 = "krnl.global"() {alignment = 64 : i64, name = "constant_2", shape = [3], value = dense<[1.0, 2.0, 3.0]> : tensor<3xf32>} : () -> memref<3xf32>
+  return %0, %1, %2 : memref<3xf32>, memref<3xf32>, memref<3xf32>
+
+  // CHECK-LABEL: func @test_dedup_constants
+  // CHECK-DAG:   "krnl.global"() {alignment = 64 : i64, name = "constant_0", shape = [3], value = dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xf32>} : () -> memref<3xf32>
+  // CHECK-DAG:   "krnl.global"() {name = "constant_1", shape = [3], value = dense<[1.000000e+00, 2.000000e+00, 4.000000e+00]> : tensor<3xf32>} : () -> memref<3xf32>
+  // CHECK-DAG:   "krnl.global"() {alignment = 64 : i64, name = "constant_0", shape = [3], value = dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xf32>} : () -> memref<3xf32>
+  // CHECK-NOT:   "constant_2"
+}
+
+// -----
+
+// Constants of different types are kept apart.
+func.func @test_dedup_constants_types() -> (memref<2xi32>, memref<1x2xi32>) {
+  %0 = "krnl.global"() {name = "constant_0", shape = [2], value = dense<[1, 2]> : tensor<2xi32>} : () -> memref<2xi32>
+  %1 = "krnl.global"() {name = "constant_1", shape = [1, 2], value = dense<[[1, 2]]> : tensor<1x2xi32>} : () -> memref<1x2xi32>
+  return %0, %1 : memref<2xi32>, memref<1x2xi32>
+
+  // CHECK-LABEL: func @test_dedup_constants_types
+  // CHECK:       name = "constant_0"
+  // CHECK:       name = "constant_1"
+}
+
+// -----
+
+func.func @test_dedup_resource_constants() -> (memref<2xf32>, memref<2xf32>) {
+  %0 = "krnl.global"() {name = "constant_0", shape = [2], value = dense_resource<res_0> : tensor<2xf32>} : () -> memref<2xf32>
+  %1 = "krnl.global"() {name = "constant_1", shape = [2], value = dense_resource<res_1> : tensor<2xf32>} : () -> memref<2xf32>
+  return %0, %1 : memref<2xf32>, memref<2xf32>
+
+  // CHECK-LABEL: func @test_dedup_resource_constants
+  // CHECK:       name = "constant_0"
+  // CHECK:       name = "constant_0"
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      res_0: "0x040000000000803F00000040",
+      res_1: "0x040000000000803F00000040"
+    }
+  }
+#-}
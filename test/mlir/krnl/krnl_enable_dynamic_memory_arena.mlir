@@ -0,0 +1,101 @@
+// RUN: onnx-mlir-opt --enable-dynamic-memory-arena %s -split-input-file | FileCheck %s
+
+func.func @test_dynamic_alloc(%arg0: memref<?x10xf32>) -> memref<?x10xf32> {
+  %c0 = arith.constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x10xf32>
+  %1 = memref.alloc(%0) {alignment = 64 : i64} : memref<?x10xf32>
+  %2 = memref.alloc(%0) : memref<?x10xf32>
+  memref.copy %arg0, %1 : memref<?x10xf32> to memref<?x10xf32>
+  memref.copy %1, %2 : memref<?x10xf32> to memref<?x10xf32>
+  memref.dealloc %1 : memref<?x10xf32>
+  return %2 : memref<?x10xf32>
+}
+
+// CHECK-LABEL:  func.func @test_dynamic_alloc
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
+// CHECK:           [[MARK_:%.+]] = krnl.arena_mark : i64
+// CHECK-DAG:       [[C0_I64_:%.+]] = arith.constant 0 : i64
+// CHECK-DAG:       [[DIM_:%.+]] = memref.dim [[PARAM_0_]], {{.*}} : memref<?x10xf32>
+// CHECK:           [[MARK_1_:%.+]] = krnl.arena_mark : i64
+// CHECK:           [[ARENA_:%.+]] = krnl.arena_alloc({{.*}}) {alignment = 64 : i64} : memref<?xi8>
+// CHECK:           [[BUFFER_:%.+]] = "krnl.getref"([[ARENA_]], [[C0_I64_]], [[DIM_]]) : (memref<?xi8>, i64, index) -> memref<?x10xf32>
+// CHECK:           [[RES_:%.+]] = memref.alloc([[DIM_]]) : memref<?x10xf32>
+// CHECK:           memref.copy [[PARAM_0_]], [[BUFFER_]]
+// CHECK:           memref.copy [[BUFFER_]], [[RES_]]
+// CHECK-NOT:       memref.dealloc
+// CHECK:           krnl.arena_release [[MARK_1_]] : i64
+// CHECK:           krnl.arena_release [[MARK_]] : i64
+// CHECK:           return [[RES_]] : memref<?x10xf32>
+// CHECK:         }
+
+// -----
+
+// Check that a buffer is given back to the arena after its last use once the
+// buffers allocated after it are dead too.
+func.func @test_early_release(%arg0: memref<?x10xf32>, %arg1: memref<?x10xf32>) {
+  %c0 = arith.constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x10xf32>
+  %1 = memref.alloc(%0) : memref<?x10xf32>
+  %2 = memref.alloc(%0) : memref<?x10xf32>
+  memref.copy %arg0, %1 : memref<?x10xf32> to memref<?x10xf32>
+  memref.copy %1, %2 : memref<?x10xf32> to memref<?x10xf32>
+  memref.dealloc %1 : memref<?x10xf32>
+  %3 = memref.alloc(%0) : memref<?x10xf32>
+  memref.copy %2, %3 : memref<?x10xf32> to memref<?x10xf32>
+  memref.dealloc %3 : memref<?x10xf32>
+  memref.copy %2, %arg1 : memref<?x10xf32> to memref<?x10xf32>
+  memref.dealloc %2 : memref<?x10xf32>
+  return
+}
+
+// CHECK-LABEL:  func.func @test_early_release
+// CHECK:           [[MARK_:%.+]] = krnl.arena_mark : i64
+// CHECK:           [[MARK_1_:%.+]] = krnl.arena_mark : i64
+// CHECK:           krnl.arena_alloc
+// CHECK-NOT:       krnl.arena_mark
+// CHECK:           krnl.arena_alloc
+// CHECK:           memref.copy
+// CHECK:           memref.copy
+// CHECK-NOT:       krnl.arena_release
+// CHECK:           [[MARK_3_:%.+]] = krnl.arena_mark : i64
+// CHECK:           krnl.arena_alloc
+// CHECK:           memref.copy
+// CHECK:           krnl.arena_release [[MARK_3_]] : i64
+// CHECK:           memref.copy
+// CHECK:           krnl.arena_release [[MARK_1_]] : i64
+// CHECK:           krnl.arena_release [[MARK_]] : i64
+// CHECK:           return
+
+// -----
+
+func.func @test_static_alloc(%arg0: memref<10xf32>) {
+  %0 = memref.alloc() : memref<10xf32>
+  memref.copy %arg0, %0 : memref<10xf32> to memref<10xf32>
+  memref.dealloc %0 : memref<10xf32>
+  return
+}
+
+// CHECK-LABEL:  func.func @test_static_alloc
+// CHECK-NOT:       krnl.arena_mark
+// CHECK:           memref.alloc() : memref<10xf32>
+// CHECK:           memref.dealloc
+// CHECK:           return
+
+// -----
+
+func.func private @test_parallel_body(%arg0: index, %arg1: index, %arg2: index) {
+  %0 = memref.alloc(%arg2) : memref<?xf32>
+  memref.dealloc %0 : memref<?xf32>
+  return
+}
+
+func.func @test_parallel_call(%arg0: index) {
+  krnl.parallel_call @test_parallel_body(%arg0) (%arg0 : index)
+  return
+}
+
+// CHECK-LABEL:  func.func private @test_parallel_body
+// CHECK-NOT:       krnl.arena_alloc
+// CHECK:           memref.alloc
+// CHECK:           memref.dealloc
+// CHECK:           return
@@ -139,3 +139,53 @@ func.func @test_return_cast(%arg0: memref<2x1xf32>) -> memref<1x2xf32> {
   // CHECK: [[VAR_0_:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<2x1xf32>
   // CHECK-NOT: memref.dealloc [[VAR_0_]] :
 }
+
+// -----
+
+func.func @test_reuse_dynamic_memref(%arg0: memref<?x10xf32>) -> memref<?x10xf32> {
+  %c0 = arith.constant 0 : index
+  %0 = memref.dim %arg0, %c0 : memref<?x10xf32>
+  %1 = memref.alloc(%0) {alignment = 16 : i64} : memref<?x10xf32>
+  %2:2 = krnl.define_loops 2
+  krnl.iterate(%2#0, %2#1) with (%2#0 -> %arg1 = 0 to %0, %2#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %arg0[%arg1, %arg2] : memref<?x10xf32>
+    krnl.store %6, %1[%arg1, %arg2] : memref<?x10xf32>
+  }
+  %3 = memref.alloc(%0) {alignment = 16 : i64} : memref<?x10xf32>
+  %4:2 = krnl.define_loops 2
+  krnl.iterate(%4#0, %4#1) with (%4#0 -> %arg1 = 0 to %0, %4#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %1[%arg1, %arg2] : memref<?x10xf32>
+    krnl.store %6, %3[%arg1, %arg2] : memref<?x10xf32>
+  }
+  memref.dealloc %1 : memref<?x10xf32>
+  %5 = memref.alloc(%0) {alignment = 16 : i64} : memref<?x10xf32>
+  %7:2 = krnl.define_loops 2
+  krnl.iterate(%7#0, %7#1) with (%7#0 -> %arg1 = 0 to %0, %7#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %3[%arg1, %arg2] : memref<?x10xf32>
+    krnl.store %6, %5[%arg1, %arg2] : memref<?x10xf32>
+  }
+  memref.dealloc %3 : memref<?x10xf32>
+  %8 = memref.alloc(%0) {alignment = 16 : i64} : memref<?x10xf32>
+  %9:2 = krnl.define_loops 2
+  krnl.iterate(%9#0, %9#1) with (%9#0 -> %arg1 = 0 to %0, %9#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %5[%arg1, %arg2] : memref<?x10xf32>
+    krnl.store %6, %8[%arg1, %arg2] : memref<?x10xf32>
+  }
+  memref.dealloc %5 : memref<?x10xf32>
+  return %8 : memref<?x10xf32>
+
+  // CHECK-LABEL: func @test_reuse_dynamic_memref
+  // CHECK:       [[DIM_:%.+]] = memref.dim
+  // CHECK:       [[VAR_0_:%.+]] = memref.alloc([[DIM_]]) {alignment = 16 : i64} : memref<?x10xf32>
+  // CHECK:       [[VAR_1_:%.+]] = memref.alloc([[DIM_]]) {alignment = 16 : i64} : memref<?x10xf32>
+  // CHECK-NOT:   memref.alloc
+  // CHECK:       krnl.store {{.*}}, [[VAR_0_]]
+  // CHECK:       krnl.store {{.*}}, [[VAR_1_]]
+  // CHECK-NOT:   memref.dealloc
+  // CHECK:       krnl.store {{.*}}, [[VAR_0_]]
+  // CHECK-NOT:   memref.dealloc
+  // CHECK:       krnl.store {{.*}}, [[VAR_1_]]
+  // CHECK:       memref.dealloc [[VAR_0_]] : memref<?x10xf32>
+  // CHECK-NOT:   memref.dealloc
+  // CHECK:       return [[VAR_1_]] : memref<?x10xf32>
+}
@@ -0,0 +1,41 @@
+// RUN: onnx-mlir-opt --enable-dynamic-memory-arena="dynamic=false static=true" %s -split-input-file | FileCheck %s
+
+func.func @test_static_pool(%arg0: memref<10xf32>) -> memref<10xf32> {
+  %c0_i64 = arith.constant 0 : i64
+  %0 = memref.alloc() {alignment = 64 : i64} : memref<4096xi8>
+  %1 = "krnl.getref"(%0, %c0_i64) : (memref<4096xi8>, i64) -> memref<10xf32>
+  %2 = memref.alloc() : memref<10xf32>
+  memref.copy %arg0, %1 : memref<10xf32> to memref<10xf32>
+  memref.copy %1, %2 : memref<10xf32> to memref<10xf32>
+  memref.dealloc %0 : memref<4096xi8>
+  return %2 : memref<10xf32>
+}
+
+// CHECK-LABEL:  func.func @test_static_pool
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<10xf32>) -> memref<10xf32> {
+// CHECK:           [[MARK_:%.+]] = krnl.arena_mark : i64
+// CHECK-DAG:       [[C4096_I64_:%.+]] = arith.constant 4096 : i64
+// CHECK-DAG:       [[C0_I64_:%.+]] = arith.constant 0 : i64
+// CHECK:           [[ARENA_:%.+]] = krnl.arena_alloc([[C4096_I64_]]) {alignment = 64 : i64} : memref<?xi8>
+// CHECK:           [[POOL_:%.+]] = "krnl.getref"([[ARENA_]], {{.*}}) : (memref<?xi8>, i64) -> memref<4096xi8>
+// CHECK:           [[BUFFER_:%.+]] = "krnl.getref"([[POOL_]], {{.*}}) : (memref<4096xi8>, i64) -> memref<10xf32>
+// CHECK:           [[RES_:%.+]] = memref.alloc() : memref<10xf32>
+// CHECK:           memref.copy [[PARAM_0_]], [[BUFFER_]]
+// CHECK-NOT:       memref.dealloc
+// CHECK:           krnl.arena_release [[MARK_]] : i64
+// CHECK:           return [[RES_]] : memref<10xf32>
+// CHECK:         }
+
+// -----
+
+func.func @test_dynamic_alloc_kept(%arg0: index) {
+  %0 = memref.alloc(%arg0) : memref<?xf32>
+  memref.dealloc %0 : memref<?xf32>
+  return
+}
+
+// CHECK-LABEL:  func.func @test_dynamic_alloc_kept
+// CHECK-NOT:       krnl.arena_alloc
+// CHECK:           memref.alloc
+// CHECK:           memref.dealloc
+// CHECK:           return
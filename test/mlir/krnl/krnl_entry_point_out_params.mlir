@@ -0,0 +1,45 @@
+// RUN: onnx-mlir-opt --entry-point-out-params %s -split-input-file | FileCheck %s
+
+// Check that the body of an entry point function is moved into a function
+// writing the result into an output argument, in place of the buffer it
+// allocated, and that the entry point function allocates it and calls it.
+module {
+  func.func @main_graph(%arg0: memref<10xf32>) -> memref<10xf32> {
+    %0 = memref.alloc() {alignment = 16 : i64} : memref<10xf32>
+    %c0 = arith.constant 0 : index
+    %1 = krnl.load %arg0[%c0] : memref<10xf32>
+    krnl.store %1, %0[%c0] : memref<10xf32>
+    return %0 : memref<10xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<10xf32>) -> memref<10xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<10xf32>
+// CHECK:           call @main_graph_into([[PARAM_0_]], [[RES_]]) : (memref<10xf32>, memref<10xf32>) -> ()
+// CHECK:           return [[RES_]] : memref<10xf32>
+// CHECK:         }
+// CHECK-LABEL:  func.func @main_graph_into
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<10xf32>, [[PARAM_1_:%.+]]: memref<10xf32>) {
+// CHECK-NOT:       memref.alloc
+// CHECK:           [[LOAD_:%.+]] = krnl.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<10xf32>
+// CHECK:           krnl.store [[LOAD_]], [[PARAM_1_]]{{.}}{{.*}}{{.}} : memref<10xf32>
+// CHECK-NOT:       memref.copy
+// CHECK:           return
+// CHECK:         }
+}
+
+// -----
+
+// Check that an entry point function returning its input, or a buffer of
+// dynamic shape, is left as is.
+module {
+  func.func @main_graph(%arg0: memref<10xf32>, %arg1: memref<?xf32>) -> (memref<10xf32>, memref<?xf32>) {
+    return %arg0, %arg1 : memref<10xf32>, memref<?xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 2 : i32, numOutputs = 2 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-NOT:       call
+// CHECK-NOT:     func.func @main_graph_into
+}
@@ -0,0 +1,20 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm %s -split-input-file | FileCheck %s
+
+// Test that the address of a global partitioned across the NUMA nodes is the
+// one of its copy returned by omNumaPartitionConstant, cached in a global.
+func.func @test_krnl_global_numa_partitions() -> memref<8x4xf32> {
+  %0 = "krnl.global"() {name = "packed_constant_0", numa_partitions = 2 : i64, shape = [8, 4], value = dense<1.0> : tensor<8x4xf32>} : () -> memref<8x4xf32>
+  return %0 : memref<8x4xf32>
+
+// CHECK-DAG:     llvm.func @omNumaPartitionConstant(!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal @packed_constant_0_numa_addr() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal constant @packed_constant_0(dense<1.000000e+00> : tensor<8x4xf32>)
+// CHECK-LABEL:   llvm.func @test_krnl_global_numa_partitions
+// CHECK-DAG:       [[DATA_:%.+]] = llvm.mlir.addressof @packed_constant_0 : !llvm.ptr<array<8 x array<4 x f32>>>
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @packed_constant_0_numa_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[DATA_I8_:%.+]] = llvm.bitcast [[DATA_]] : !llvm.ptr<array<8 x array<4 x f32>>> to !llvm.ptr<i8>
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.mlir.constant(128 : i64) : i64
+// CHECK-DAG:       [[PARTS_:%.+]] = llvm.mlir.constant(2 : i64) : i64
+// CHECK:           [[COPY_:%.+]] = llvm.call @omNumaPartitionConstant([[ADDR_]], [[DATA_I8_]], [[SIZE_]], [[PARTS_]]) : (!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.bitcast [[COPY_]] : !llvm.ptr<i8> to !llvm.ptr<f32>
+}
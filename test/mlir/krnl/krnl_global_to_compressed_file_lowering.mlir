@@ -0,0 +1,35 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm="constants-to-file-threshold=16" %s | FileCheck %s
+
+// Test that the constants stored into a compressed file are read from the
+// data decompressed at runtime, at their offsets in the uncompressed data.
+module attributes {"onnx-mlir.constants_file" = "krnl_global_to_compressed_file.constants.bin", "onnx-mlir.constants_file_compression" = "lz4-shuffle"} {
+  func.func @main_graph(%arg0: memref<2xf32>) -> memref<2xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_1", shape = [4], value = dense<[0, 1, 2, 3]> : tensor<4xi64>} : () -> memref<4xi64>
+    %2 = "krnl.global"() {name = "constant_2", shape = [2], value = dense<[0.0, 1.0]> : tensor<2xf32>} : () -> memref<2xf32>
+    return %2 : memref<2xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// COM: The 96 bytes of data are stored in 3 chunks of 32 bytes, constant_0
+// COM: with its bytes shuffled, the padding and constant_1, taking 133 bytes
+// COM: with the chunk table.
+// CHECK-DAG:     llvm.func @omLoadCompressedConstantsFile(!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal @_constants_file_addr() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-NOT:     llvm.func @omMMapConstantsFile
+
+// CHECK-LABEL:   llvm.func @main_graph
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @_constants_file_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[OFFSET_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK-DAG:       [[STORED_SIZE_:%.+]] = llvm.mlir.constant(133 : i64) : i64
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.mlir.constant(96 : i64) : i64
+// CHECK:           [[DATA_:%.+]] = llvm.call @omLoadCompressedConstantsFile([[ADDR_]], {{.*}}, [[OFFSET_]], [[STORED_SIZE_]], [[SIZE_]]) : (!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64, i64) -> !llvm.ptr<i8>
+// CHECK:           [[OFFSET_0_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK:           llvm.getelementptr [[DATA_]]{{.}}[[OFFSET_0_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           [[DATA_1_:%.+]] = llvm.call @omLoadCompressedConstantsFile
+// CHECK:           [[OFFSET_1_:%.+]] = llvm.mlir.constant(64 : i64) : i64
+// CHECK:           llvm.getelementptr [[DATA_1_]]{{.}}[[OFFSET_1_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+
+// CHECK-LABEL:   llvm.func @run_main_graph
+// CHECK:           llvm.call @omLoadCompressedConstantsFile
+}
@@ -0,0 +1,51 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm="constants-to-file-threshold=16" %s | FileCheck %s
+
+// Test that the constants of at least 16 bytes are stored into the file given
+// by the module attribute and read from the file mapped at runtime.
+module attributes {"onnx-mlir.constants_file" = "krnl_global_to_file.constants.bin"} {
+  func.func @main_graph(%arg0: memref<2xf32>) -> memref<2xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_1", shape = [4], value = dense<[0, 1, 2, 3]> : tensor<4xi64>} : () -> memref<4xi64>
+    %2 = "krnl.global"() {name = "constant_2", shape = [2], value = dense<[0.0, 1.0]> : tensor<2xf32>} : () -> memref<2xf32>
+    %3 = "krnl.global"() {name = "constant_3", shape = [8], value = dense<1.0> : tensor<8xf32>} : () -> memref<8xf32>
+    return %2 : memref<2xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// COM: The small constant_2 and the splat constant_3 stay embedded.
+// CHECK-DAG:     llvm.func @omMMapConstantsFile(!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal constant @_constants_file_name("krnl_global_to_file.constants.bin\00")
+// CHECK-DAG:     llvm.mlir.global internal @_constants_file_addr() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal constant @constant_2(dense<[0.000000e+00, 1.000000e+00]> : tensor<2xf32>)
+// CHECK-DAG:     llvm.mlir.global internal constant @constant_3(dense<1.000000e+00> : tensor<8xf32>)
+// CHECK-NOT:     llvm.mlir.global internal constant @constant_0
+// CHECK-NOT:     llvm.mlir.global internal constant @constant_1
+
+// COM: constant_0 is at offset 0 and constant_1 at offset 64 in the file of
+// COM: 96 bytes.
+// CHECK-LABEL:   llvm.func @main_graph
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @_constants_file_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[NAME_:%.+]] = llvm.getelementptr {{.*}}[0, 0] : (!llvm.ptr<array<34 x i8>>) -> !llvm.ptr<i8>
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.mlir.constant(96 : i64) : i64
+// CHECK:           [[FILE_:%.+]] = llvm.call @omMMapConstantsFile([[ADDR_]], [[NAME_]], [[SIZE_]]) : (!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           [[OFFSET_0_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK:           [[DATA_0_:%.+]] = llvm.getelementptr [[FILE_]]{{.}}[[OFFSET_0_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.bitcast [[DATA_0_]] : !llvm.ptr<i8> to !llvm.ptr<f32>
+// CHECK:           [[FILE_1_:%.+]] = llvm.call @omMMapConstantsFile
+// CHECK:           [[OFFSET_1_:%.+]] = llvm.mlir.constant(64 : i64) : i64
+// CHECK:           [[DATA_1_:%.+]] = llvm.getelementptr [[FILE_1_]]{{.}}[[OFFSET_1_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.bitcast [[DATA_1_]] : !llvm.ptr<i8> to !llvm.ptr<i64>
+// CHECK:           llvm.mlir.addressof @constant_2
+
+// COM: The entry point maps the file before running the model and returns
+// COM: NULL if the file cannot be mapped.
+// CHECK-LABEL:   llvm.func @run_main_graph
+// CHECK:           [[FILE_:%.+]] = llvm.call @omMMapConstantsFile
+// CHECK:           [[NULL_:%.+]] = llvm.mlir.null : !llvm.ptr<i8>
+// CHECK:           [[FAILED_:%.+]] = llvm.icmp "eq" [[FILE_]], [[NULL_]] : !llvm.ptr<i8>
+// CHECK:           llvm.cond_br [[FAILED_]], ^bb1, ^bb2
+// CHECK:         ^bb1:
+// CHECK:           llvm.return {{.*}} : !llvm.ptr<i8>
+// CHECK:         ^bb2:
+// CHECK:           llvm.call @omTensorListGetOmtArray
+}
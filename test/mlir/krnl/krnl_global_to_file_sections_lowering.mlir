@@ -0,0 +1,63 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm="constants-to-file-threshold=16" %s | FileCheck %s
+
+// Test that the constants of a module with several entry points are stored
+// into sections of the file by the set of functions using them, and that each
+// entry point maps only the sections of its function.
+module attributes {"onnx-mlir.constants_file" = "krnl_global_to_file_sections.constants.bin"} {
+  func.func @first(%arg0: memref<8xf32>) -> memref<8xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<1.0> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_2", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    return %0 : memref<8xf32>
+  }
+  func.func @second(%arg0: memref<8xf32>) -> memref<8xf32> {
+    %0 = "krnl.global"() {name = "constant_1", shape = [8], value = dense<[7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_2", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    return %0 : memref<8xf32>
+  }
+  "krnl.entry_point"() {func = @first, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+  "krnl.entry_point"() {func = @second, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// COM: Section 0 holds constant_0 used by first, section 1 constant_2 used by
+// COM: both functions and section 2 constant_1 used by second, each section
+// COM: of 32 bytes being aligned to 64 KiB.
+// CHECK-DAG:     llvm.func @omMMapConstantsFileSection(!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal @_constants_file_addr_0() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal @_constants_file_addr_1() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-DAG:     llvm.mlir.global internal @_constants_file_addr_2() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-NOT:     llvm.mlir.global internal @_constants_file_addr()
+
+// CHECK-LABEL:   llvm.func @first
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @_constants_file_addr_0 : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SECTION_OFFSET_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK-DAG:       [[SECTION_SIZE_:%.+]] = llvm.mlir.constant(32 : i64) : i64
+// CHECK:           [[SECTION_:%.+]] = llvm.call @omMMapConstantsFileSection([[ADDR_]], {{.*}}, [[SECTION_OFFSET_]], [[SECTION_SIZE_]]) : (!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64, i64) -> !llvm.ptr<i8>
+// CHECK:           [[OFFSET_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK:           llvm.getelementptr [[SECTION_]]{{.}}[[OFFSET_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK-DAG:       [[ADDR_1_:%.+]] = llvm.mlir.addressof @_constants_file_addr_1 : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SECTION_OFFSET_1_:%.+]] = llvm.mlir.constant(65536 : i64) : i64
+// CHECK-DAG:       [[SECTION_SIZE_1_:%.+]] = llvm.mlir.constant(32 : i64) : i64
+// CHECK:           llvm.call @omMMapConstantsFileSection([[ADDR_1_]], {{.*}}, [[SECTION_OFFSET_1_]], [[SECTION_SIZE_1_]])
+
+// CHECK-LABEL:   llvm.func @second
+// CHECK-DAG:       [[ADDR_2_:%.+]] = llvm.mlir.addressof @_constants_file_addr_2 : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SECTION_OFFSET_2_:%.+]] = llvm.mlir.constant(131072 : i64) : i64
+// CHECK:           llvm.call @omMMapConstantsFileSection([[ADDR_2_]], {{.*}}, [[SECTION_OFFSET_2_]], {{.*}})
+// CHECK:           llvm.mlir.addressof @_constants_file_addr_1
+
+// COM: Each entry point maps the sections of its function before running it.
+// CHECK-LABEL:   llvm.func @run_first
+// CHECK:           llvm.mlir.addressof @_constants_file_addr_0
+// CHECK:           llvm.call @omMMapConstantsFileSection
+// CHECK:           llvm.mlir.addressof @_constants_file_addr_1
+// CHECK:           llvm.call @omMMapConstantsFileSection
+// CHECK-NOT:       llvm.mlir.addressof @_constants_file_addr_2
+// CHECK:           llvm.call @omTensorListGetOmtArray
+
+// CHECK-LABEL:   llvm.func @run_second
+// CHECK-NOT:       llvm.mlir.addressof @_constants_file_addr_0
+// CHECK:           llvm.mlir.addressof @_constants_file_addr_1
+// CHECK:           llvm.call @omMMapConstantsFileSection
+// CHECK:           llvm.mlir.addressof @_constants_file_addr_2
+// CHECK:           llvm.call @omMMapConstantsFileSection
+// CHECK:           llvm.call @omTensorListGetOmtArray
+}
@@ -0,0 +1,33 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm="constants-to-file-threshold=16" %s | FileCheck %s
+
+// Test that the constants of at least 16 bytes are written into the raw data
+// of the constants object given by the module attribute, and read from the
+// external global of its data.
+module attributes {"onnx-mlir.constants_object" = "krnl_global_to_object.constants.raw"} {
+  func.func @main_graph(%arg0: memref<2xf32>) -> memref<2xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_1", shape = [4], value = dense<[0, 1, 2, 3]> : tensor<4xi64>} : () -> memref<4xi64>
+    %2 = "krnl.global"() {name = "constant_2", shape = [2], value = dense<[0.0, 1.0]> : tensor<2xf32>} : () -> memref<2xf32>
+    return %2 : memref<2xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// COM: The small constant_2 stays embedded, the data of the other ones is
+// COM: 96 bytes.
+// CHECK-DAG:     llvm.mlir.global external constant @_constants_object_data() {{.*}} : !llvm.array<96 x i8>
+// CHECK-DAG:     llvm.mlir.global internal constant @constant_2(dense<[0.000000e+00, 1.000000e+00]> : tensor<2xf32>)
+// CHECK-NOT:     llvm.mlir.global internal constant @constant_0
+// CHECK-NOT:     llvm.mlir.global internal constant @constant_1
+
+// COM: constant_0 is at offset 0 and constant_1 at offset 64.
+// CHECK-LABEL:   llvm.func @main_graph
+// CHECK:           [[OBJECT_:%.+]] = llvm.mlir.addressof @_constants_object_data : !llvm.ptr<array<96 x i8>>
+// CHECK:           [[DATA_:%.+]] = llvm.bitcast [[OBJECT_]] : !llvm.ptr<array<96 x i8>> to !llvm.ptr<i8>
+// CHECK:           [[OFFSET_0_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK:           [[DATA_0_:%.+]] = llvm.getelementptr [[DATA_]]{{.}}[[OFFSET_0_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.bitcast [[DATA_0_]] : !llvm.ptr<i8> to !llvm.ptr<f32>
+// CHECK:           [[OFFSET_1_:%.+]] = llvm.mlir.constant(64 : i64) : i64
+// CHECK:           [[DATA_1_:%.+]] = llvm.getelementptr {{.*}}{{.}}[[OFFSET_1_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.bitcast [[DATA_1_]] : !llvm.ptr<i8> to !llvm.ptr<i64>
+// CHECK:           llvm.mlir.addressof @constant_2
+}
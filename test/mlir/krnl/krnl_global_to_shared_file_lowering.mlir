@@ -0,0 +1,65 @@
+// RUN: rm -f krnl_global_to_shared_file.shared.bin krnl_global_to_shared_file.shared.bin.index && onnx-mlir-opt --convert-krnl-to-llvm="constants-to-file-threshold=16" %s -split-input-file | FileCheck %s
+
+// Test that the constants of a first module are written into the shared
+// constants file, which does not exist yet, and read from the shared file
+// mapped at runtime.
+module attributes {"onnx-mlir.constants_file" = "krnl_global_to_shared_file_base.constants.bin", "onnx-mlir.shared_constants_file" = "krnl_global_to_shared_file.shared.bin"} {
+  func.func @main_graph(%arg0: memref<2xf32>) -> memref<2xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_1", shape = [4], value = dense<[0, 1, 2, 3]> : tensor<4xi64>} : () -> memref<4xi64>
+    return %arg0 : memref<2xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-DAG:     llvm.mlir.global internal constant @_shared_constants_file_name("krnl_global_to_shared_file.shared.bin\00")
+// CHECK-DAG:     llvm.mlir.global internal @_shared_constants_file_addr() {addr_space = 0 : i32} : !llvm.ptr<i8>
+// CHECK-NOT:     @_constants_file_name
+
+// COM: constant_0 is at offset 0 and constant_1 at offset 64 in the shared
+// COM: file of 96 bytes.
+// CHECK-LABEL:   llvm.func @main_graph
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @_shared_constants_file_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.mlir.constant(96 : i64) : i64
+// CHECK:           [[FILE_:%.+]] = llvm.call @omMMapConstantsFile([[ADDR_]], {{.*}}, [[SIZE_]]) : (!llvm.ptr<ptr<i8>>, !llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           [[OFFSET_0_:%.+]] = llvm.mlir.constant(0 : i64) : i64
+// CHECK:           llvm.getelementptr [[FILE_]]{{.}}[[OFFSET_0_]]{{.}} : (!llvm.ptr<i8>, i64) -> !llvm.ptr<i8>
+// CHECK:           llvm.call @omMMapConstantsFile
+// CHECK:           [[OFFSET_1_:%.+]] = llvm.mlir.constant(64 : i64) : i64
+
+// CHECK-LABEL:   llvm.func @run_main_graph
+// CHECK:           llvm.mlir.addressof @_shared_constants_file_addr
+// CHECK:           llvm.call @omMMapConstantsFile
+}
+
+// -----
+
+// Test that a variant of the first module reads its unchanged constant_0
+// from the shared constants file, and stores its changed constant_1 into its
+// own constants file.
+module attributes {"onnx-mlir.constants_file" = "krnl_global_to_shared_file_variant.constants.bin", "onnx-mlir.shared_constants_file" = "krnl_global_to_shared_file.shared.bin"} {
+  func.func @main_graph(%arg0: memref<2xf32>) -> memref<2xf32> {
+    %0 = "krnl.global"() {name = "constant_0", shape = [8], value = dense<[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0]> : tensor<8xf32>} : () -> memref<8xf32>
+    %1 = "krnl.global"() {name = "constant_1", shape = [4], value = dense<[4, 5, 6, 7]> : tensor<4xi64>} : () -> memref<4xi64>
+    return %arg0 : memref<2xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = "[in_sig]\00@[out_sig]\00"} : () -> ()
+
+// CHECK-DAG:     llvm.mlir.global internal constant @_shared_constants_file_name("krnl_global_to_shared_file.shared.bin\00")
+// CHECK-DAG:     llvm.mlir.global internal constant @_constants_file_name("krnl_global_to_shared_file_variant.constants.bin\00")
+
+// COM: constant_0 is at offset 0 of the shared file of 96 bytes, and
+// COM: constant_1 at offset 0 of the constants file of 32 bytes.
+// CHECK-LABEL:   llvm.func @main_graph
+// CHECK-DAG:       [[SHARED_ADDR_:%.+]] = llvm.mlir.addressof @_shared_constants_file_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SHARED_SIZE_:%.+]] = llvm.mlir.constant(96 : i64) : i64
+// CHECK:           llvm.call @omMMapConstantsFile([[SHARED_ADDR_]], {{.*}}, [[SHARED_SIZE_]])
+// CHECK-DAG:       [[ADDR_:%.+]] = llvm.mlir.addressof @_constants_file_addr : !llvm.ptr<ptr<i8>>
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.mlir.constant(32 : i64) : i64
+// CHECK:           llvm.call @omMMapConstantsFile([[ADDR_]], {{.*}}, [[SIZE_]])
+
+// CHECK-LABEL:   llvm.func @run_main_graph
+// CHECK:           llvm.mlir.addressof @_shared_constants_file_addr
+// CHECK:           llvm.call @omMMapConstantsFile
+// CHECK:           llvm.mlir.addressof @_constants_file_addr
+// CHECK:           llvm.call @omMMapConstantsFile
+}
@@ -0,0 +1,60 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-affine %s -split-input-file | FileCheck %s
+// RUN: onnx-mlir-opt --convert-krnl-to-affine --convert-krnl-to-llvm %s -split-input-file | FileCheck %s --check-prefix=LLVM
+
+func.func @test_krnl_store_nontemporal(%arg0: memref<1024xf32>) -> memref<1024xf32> {
+  %0 = memref.alloc() {alignment = 64 : i64} : memref<1024xf32>
+  %1 = krnl.define_loops 1
+  krnl.iterate(%1) with (%1 -> %i = 0 to 1024) {
+    %2 = krnl.load %arg0[%i] : memref<1024xf32>
+    krnl.store %2, %0[%i] {nontemporal} : memref<1024xf32>
+  }
+  return %0 : memref<1024xf32>
+
+// CHECK-LABEL:  func.func @test_krnl_store_nontemporal
+// CHECK:           affine.for [[I_0_:%.+]] = 0 to 1024 {
+// CHECK:             [[LOAD_:%.+]] = affine.load {{.*}}{{.}}[[I_0_]]{{.}} : memref<1024xf32>
+// CHECK:             memref.store [[LOAD_]], {{.*}}{{.}}[[I_0_]]{{.}} {krnl.nontemporal} : memref<1024xf32>
+
+// LLVM-LABEL:  llvm.func @test_krnl_store_nontemporal
+// LLVM:          llvm.store {{.*}} {nontemporal} : !llvm.ptr<f32>
+}
+
+// -----
+
+func.func @test_vector_store_nontemporal(%arg0: memref<1024xf32>) -> memref<1024xf32> {
+  %0 = memref.alloc() {alignment = 64 : i64} : memref<1024xf32>
+  %1 = krnl.define_loops 1
+  %2, %3 = krnl.block %1 16 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+  krnl.iterate(%2) with (%1 -> %i = 0 to 1024) {
+    %4 = krnl.get_induction_var_value(%2) : (!krnl.loop) -> index
+    %5 = vector.load %arg0[%4] : memref<1024xf32>, vector<16xf32>
+    vector.store %5, %0[%4] {krnl.nontemporal} : memref<1024xf32>, vector<16xf32>
+  }
+  return %0 : memref<1024xf32>
+
+// LLVM-LABEL:  llvm.func @test_vector_store_nontemporal
+// LLVM:          llvm.store {{.*}} {alignment = 64 : i64, nontemporal} : !llvm.ptr<vector<16xf32>>
+}
+
+// -----
+
+func.func @test_krnl_prefetch(%arg0: memref<1000x128xf32>, %arg1: memref<64xindex>) {
+  %c0 = arith.constant 0 : index
+  %1 = krnl.define_loops 1
+  krnl.iterate(%1) with (%1 -> %i = 0 to 64) {
+    krnl.prefetch %arg0[%i, %c0] {isWrite = false, localityHint = 3 : i32} : memref<1000x128xf32>
+    %2 = krnl.load %arg1[%i] : memref<64xindex>
+    krnl.prefetch %arg0[%2, %c0] {isWrite = true, localityHint = 1 : i32} : memref<1000x128xf32>
+  }
+  return
+
+// CHECK-LABEL:  func.func @test_krnl_prefetch
+// CHECK:           affine.for [[I_0_:%.+]] = 0 to 64 {
+// CHECK:             affine.prefetch {{.*}}{{.}}[[I_0_]], {{.*}}{{.}}, read, locality<3>, data : memref<1000x128xf32>
+// CHECK:             [[LOAD_:%.+]] = affine.load {{.*}}{{.}}[[I_0_]]{{.}} : memref<64xindex>
+// CHECK:             memref.prefetch {{.*}}{{.}}[[LOAD_]], {{.*}}{{.}}, write, locality<1>, data : memref<1000x128xf32>
+
+// LLVM-LABEL:  llvm.func @test_krnl_prefetch
+// LLVM:          "llvm.intr.prefetch"
+// LLVM:          "llvm.intr.prefetch"
+}
@@ -0,0 +1,95 @@
+// RUN: onnx-mlir-opt --outline-parallel-loops %s -split-input-file | FileCheck %s
+
+func.func @test_outline_parallel_1d(%arg0: memref<128xf32>) -> memref<128xf32> {
+  %c0 = arith.constant 0 : index
+  %c4 = arith.constant 4 : index
+  %c128 = arith.constant 128 : index
+  %0 = memref.alloc() : memref<128xf32>
+  scf.parallel (%i) = (%c0) to (%c128) step (%c4) {
+    %1 = memref.load %arg0[%i] : memref<128xf32>
+    memref.store %1, %0[%i] : memref<128xf32>
+    scf.yield
+  }
+  return %0 : memref<128xf32>
+
+// CHECK-LABEL:  func.func @test_outline_parallel_1d
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<128xf32>) -> memref<128xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() : memref<128xf32>
+// CHECK:           [[VAR_c32_:%.+]] = arith.constant 32 : index
+// CHECK-NOT:       scf.parallel
+// CHECK:           krnl.parallel_call @test_outline_parallel_1d_parallel{{ *}}([[VAR_c32_]]){{ *}}([[PARAM_0_]], [[RES_]] : memref<128xf32>, memref<128xf32>)
+// CHECK:           return [[RES_]] : memref<128xf32>
+// CHECK:         }
+// CHECK:         func.func private @test_outline_parallel_1d_parallel([[BEGIN_:%.+]]: index, [[END_:%.+]]: index, [[ARG_0_:%.+]]: memref<128xf32>, [[ARG_1_:%.+]]: memref<128xf32>) {
+// CHECK-DAG:       [[VAR_c0_:%.+]] = arith.constant 0 : index
+// CHECK-DAG:       [[VAR_c4_:%.+]] = arith.constant 4 : index
+// CHECK-DAG:       [[VAR_c1_:%.+]] = arith.constant 1 : index
+// CHECK:           scf.for [[I_0_:%.+]] = [[BEGIN_]] to [[END_]] step [[VAR_c1_]] {
+// CHECK:             memref.alloca_scope {
+// CHECK:               [[VAR_0_:%.+]] = arith.muli [[I_0_]], [[VAR_c4_]] : index
+// CHECK:               [[VAR_1_:%.+]] = arith.addi [[VAR_c0_]], [[VAR_0_]] : index
+// CHECK:               [[LOAD_:%.+]] = memref.load [[ARG_0_]]{{.}}[[VAR_1_]]{{.}} : memref<128xf32>
+// CHECK:               memref.store [[LOAD_]], [[ARG_1_]]{{.}}[[VAR_1_]]{{.}} : memref<128xf32>
+// CHECK:             }
+// CHECK:           }
+// CHECK:           return
+// CHECK:         }
+}
+
+// -----
+
+// The iteration space of multi-dimensional loops is flattened.
+
+func.func @test_outline_parallel_2d(%arg0: memref<?x64xf32>, %arg1: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c64 = arith.constant 64 : index
+  %cst = arith.constant 0.0 : f32
+  scf.parallel (%i, %j) = (%c0, %c0) to (%arg1, %c64) step (%c1, %c1) {
+    memref.store %cst, %arg0[%i, %j] : memref<?x64xf32>
+    scf.yield
+  }
+  return
+
+// CHECK-LABEL:  func.func @test_outline_parallel_2d
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x64xf32>, [[PARAM_1_:%.+]]: index) {
+// CHECK:           [[VAR_0_:%.+]] = arith.maxsi [[PARAM_1_]], {{.*}} : index
+// CHECK:           [[VAR_1_:%.+]] = arith.muli [[VAR_0_]], {{.*}} : index
+// CHECK:           krnl.parallel_call @test_outline_parallel_2d_parallel{{ *}}([[VAR_1_]]){{ *}}([[PARAM_0_]] : memref<?x64xf32>)
+// CHECK:         func.func private @test_outline_parallel_2d_parallel({{.*}}: index, {{.*}}: index, [[ARG_0_:%.+]]: memref<?x64xf32>) {
+// CHECK-DAG:       [[VAR_c64_:%.+]] = arith.constant 64 : index
+// CHECK-DAG:       [[VAR_cst_:%.+]] = arith.constant 0.000000e+00 : f32
+// CHECK:           scf.for [[I_0_:%.+]] =
+// CHECK:             memref.alloca_scope {
+// CHECK-DAG:           [[VAR_2_:%.+]] = arith.remsi [[I_0_]], [[VAR_c64_]] : index
+// CHECK-DAG:           [[VAR_3_:%.+]] = arith.divsi [[I_0_]], [[VAR_c64_]] : index
+// CHECK:               memref.store [[VAR_cst_]], [[ARG_0_]]{{.}}{{.*}}{{.}} : memref<?x64xf32>
+}
+
+// -----
+
+// Nested loops stay in the outlined function.
+
+func.func @test_outline_parallel_nested(%arg0: memref<16x16xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %cst = arith.constant 0.0 : f32
+  scf.parallel (%i) = (%c0) to (%c16) step (%c1) {
+    scf.parallel (%j) = (%c0) to (%c16) step (%c1) {
+      memref.store %cst, %arg0[%i, %j] : memref<16x16xf32>
+      scf.yield
+    }
+    scf.yield
+  }
+  return
+
+// CHECK-LABEL:  func.func @test_outline_parallel_nested
+// CHECK-NOT:       scf.parallel
+// CHECK:           krnl.parallel_call @test_outline_parallel_nested_parallel
+// CHECK:         func.func private @test_outline_parallel_nested_parallel
+// CHECK:           scf.for
+// CHECK:             memref.alloca_scope {
+// CHECK:               scf.parallel
+// CHECK-NOT:         krnl.parallel_call
+}
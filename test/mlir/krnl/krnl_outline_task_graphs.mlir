@@ -0,0 +1,119 @@
+// RUN: onnx-mlir-opt --outline-task-graphs %s -split-input-file | FileCheck %s
+
+// The loop nests of two independent branches run concurrently, before the
+// loop nest joining them.
+
+func.func @test_task_graph_branches(%arg0: memref<64xf32>) -> memref<64xf32> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c64 = arith.constant 64 : index
+  %0 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %1 = memref.load %arg0[%i] : memref<64xf32>
+    %2 = arith.addf %1, %1 : f32
+    memref.store %2, %0[%i] : memref<64xf32>
+  }
+  %3 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %4 = memref.load %arg0[%i] : memref<64xf32>
+    %5 = arith.mulf %4, %4 : f32
+    memref.store %5, %3[%i] : memref<64xf32>
+  }
+  %6 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %7 = memref.load %0[%i] : memref<64xf32>
+    %8 = memref.load %3[%i] : memref<64xf32>
+    %9 = arith.subf %7, %8 : f32
+    memref.store %9, %6[%i] : memref<64xf32>
+  }
+  return %6 : memref<64xf32>
+
+// CHECK-LABEL:  func.func @test_task_graph_branches
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<64xf32>) -> memref<64xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() : memref<64xf32>
+// CHECK:           [[RES_1_:%.+]] = memref.alloc() : memref<64xf32>
+// CHECK:           [[RES_2_:%.+]] = memref.alloc() : memref<64xf32>
+// CHECK-NOT:       scf.for
+// CHECK:           krnl.task_graph_call @test_task_graph_branches_tasks([[PARAM_0_]], [[RES_]], [[RES_1_]], [[RES_2_]] : memref<64xf32>, memref<64xf32>, memref<64xf32>, memref<64xf32>) {predecessorCounts = [0, 0, 2], successorOffsets = [0, 1, 2, 2], successors = [2, 2]}
+// CHECK:           return [[RES_2_]] : memref<64xf32>
+// CHECK:         }
+// CHECK:         func.func private @test_task_graph_branches_tasks([[BEGIN_:%.+]]: index, [[END_:%.+]]: index, [[ARG_0_:%.+]]: memref<64xf32>, [[ARG_1_:%.+]]: memref<64xf32>, [[ARG_2_:%.+]]: memref<64xf32>, [[ARG_3_:%.+]]: memref<64xf32>) {
+// CHECK:           scf.for [[TASK_:%.+]] = [[BEGIN_]] to [[END_]] step {{.*}} {
+// CHECK:             [[VAR_0_:%.+]] = arith.cmpi eq, [[TASK_]], {{.*}} : index
+// CHECK:             scf.if [[VAR_0_]] {
+// CHECK:               scf.for
+// CHECK:                 arith.addf
+// CHECK:                 memref.store {{.*}}, [[ARG_1_]]{{.}}
+// CHECK:             scf.if
+// CHECK:               scf.for
+// CHECK:                 arith.mulf
+// CHECK:                 memref.store {{.*}}, [[ARG_2_]]{{.}}
+// CHECK:             scf.if
+// CHECK:               scf.for
+// CHECK:                 arith.subf
+// CHECK:                 memref.store {{.*}}, [[ARG_3_]]{{.}}
+// CHECK:           return
+// CHECK:         }
+}
+
+// -----
+
+// Loop nests depending each on the previous one are left as is.
+
+func.func @test_task_graph_chain(%arg0: memref<64xf32>) -> memref<64xf32> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c64 = arith.constant 64 : index
+  %0 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %1 = memref.load %arg0[%i] : memref<64xf32>
+    memref.store %1, %0[%i] : memref<64xf32>
+  }
+  %2 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %3 = memref.load %0[%i] : memref<64xf32>
+    memref.store %3, %2[%i] : memref<64xf32>
+  }
+  return %2 : memref<64xf32>
+
+// CHECK-LABEL:  func.func @test_task_graph_chain
+// CHECK-NOT:       krnl.task_graph_call
+// CHECK:           scf.for
+// CHECK:           scf.for
+// CHECK-NOT:     func.func
+}
+
+// -----
+
+// A load of a buffer written by the tasks ends their graph.
+
+func.func @test_task_graph_segments(%arg0: memref<64xf32>) -> (memref<64xf32>, memref<64xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c64 = arith.constant 64 : index
+  %0 = memref.alloc() : memref<64xf32>
+  %1 = memref.alloc() : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    %2 = memref.load %arg0[%i] : memref<64xf32>
+    memref.store %2, %0[%i] : memref<64xf32>
+  }
+  scf.for %i = %c0 to %c64 step %c1 {
+    %3 = memref.load %arg0[%i] : memref<64xf32>
+    memref.store %3, %1[%i] : memref<64xf32>
+  }
+  %4 = memref.load %0[%c0] : memref<64xf32>
+  scf.for %i = %c0 to %c64 step %c1 {
+    memref.store %4, %0[%i] : memref<64xf32>
+  }
+  scf.for %i = %c0 to %c64 step %c1 {
+    memref.store %4, %1[%i] : memref<64xf32>
+  }
+  return %0, %1 : memref<64xf32>, memref<64xf32>
+
+// CHECK-LABEL:  func.func @test_task_graph_segments
+// CHECK:           krnl.task_graph_call @test_task_graph_segments_tasks({{.*}}) {predecessorCounts = [0, 0], successorOffsets = [0, 0, 0], successors = []}
+// CHECK:           memref.load
+// CHECK:           krnl.task_graph_call @test_task_graph_segments_tasks{{.+}}({{.*}}) {predecessorCounts = [0, 0], successorOffsets = [0, 0, 0], successors = []}
+// CHECK-NOT:       scf.for
+// CHECK:           return
+}
@@ -0,0 +1,31 @@
+// RUN: onnx-mlir-opt --outlined-layer-out-params %s -split-input-file | FileCheck %s
+
+// Check that the result of an outlined layer is allocated by its callers and
+// passed as an output argument, replacing the buffer allocated by the layer.
+module {
+  func.func private @main_graph_layer0(%arg0: memref<4x8xf32>) -> memref<4x8xf32> attributes {"onnx-mlir.outlined_layer"} {
+    %0 = memref.alloc() {alignment = 16 : i64} : memref<4x8xf32>
+    memref.copy %arg0, %0 : memref<4x8xf32> to memref<4x8xf32>
+    return %0 : memref<4x8xf32>
+  }
+  func.func @main_graph(%arg0: memref<4x8xf32>) -> memref<4x8xf32> {
+    %0 = call @main_graph_layer0(%arg0) : (memref<4x8xf32>) -> memref<4x8xf32>
+    %1 = call @main_graph_layer0(%0) : (memref<4x8xf32>) -> memref<4x8xf32>
+    return %1 : memref<4x8xf32>
+  }
+
+// CHECK-LABEL:  func.func private @main_graph_layer0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x8xf32>, [[PARAM_1_:%.+]]: memref<4x8xf32>) attributes {"onnx-mlir.outlined_layer"} {
+// CHECK-NOT:       memref.alloc
+// CHECK:           memref.copy [[PARAM_0_]], [[PARAM_1_]] : memref<4x8xf32> to memref<4x8xf32>
+// CHECK:           return
+// CHECK:         }
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x8xf32>) -> memref<4x8xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x8xf32>
+// CHECK:           call @main_graph_layer0([[PARAM_0_]], [[RES_]]) : (memref<4x8xf32>, memref<4x8xf32>) -> ()
+// CHECK:           [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<4x8xf32>
+// CHECK:           call @main_graph_layer0([[RES_]], [[RES_1_]]) : (memref<4x8xf32>, memref<4x8xf32>) -> ()
+// CHECK:           return [[RES_1_]] : memref<4x8xf32>
+// CHECK:         }
+}
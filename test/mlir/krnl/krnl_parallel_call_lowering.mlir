@@ -0,0 +1,59 @@
+// RUN: onnx-mlir-opt --convert-krnl-to-llvm %s -split-input-file | FileCheck %s
+
+func.func private @test_parallel_body(%arg0: index, %arg1: index, %arg2: memref<10xf32>, %arg3: f32) {
+  return
+}
+
+func.func @test_parallel_call(%arg0: memref<10xf32>, %arg1: f32, %arg2: index) {
+  krnl.parallel_call @test_parallel_body(%arg2) (%arg0, %arg1 : memref<10xf32>, f32)
+  return
+}
+
+// CHECK:         llvm.func @omParallelFor(!llvm.ptr<func<void (ptr<i8>, i64, i64)>>, !llvm.ptr<i8>, i64)
+// CHECK:         llvm.func internal @test_parallel_body_trampoline([[CONTEXT_:%.+]]: !llvm.ptr<i8>, [[BEGIN_:%.+]]: i64, [[END_:%.+]]: i64) {
+// CHECK:           [[VAR_0_:%.+]] = llvm.bitcast [[CONTEXT_]] : !llvm.ptr<i8> to !llvm.ptr<struct<(struct<(ptr<f32>, ptr<f32>, i64, array<1 x i64>, array<1 x i64>)>, f32)>>
+// CHECK:           [[VAR_1_:%.+]] = llvm.load [[VAR_0_]]
+// CHECK:           [[VAR_2_:%.+]] = llvm.extractvalue [[VAR_1_]][0]
+// CHECK-DAG:       [[ALLOCATED_:%.+]] = llvm.extractvalue [[VAR_2_]][0]
+// CHECK-DAG:       [[ALIGNED_:%.+]] = llvm.extractvalue [[VAR_2_]][1]
+// CHECK-DAG:       [[OFFSET_:%.+]] = llvm.extractvalue [[VAR_2_]][2]
+// CHECK-DAG:       [[SIZE_:%.+]] = llvm.extractvalue [[VAR_2_]][3, 0]
+// CHECK-DAG:       [[STRIDE_:%.+]] = llvm.extractvalue [[VAR_2_]][4, 0]
+// CHECK-DAG:       [[VAR_3_:%.+]] = llvm.extractvalue [[VAR_1_]][1]
+// CHECK:           llvm.call @test_parallel_body([[BEGIN_]], [[END_]], [[ALLOCATED_]], [[ALIGNED_]], [[OFFSET_]], [[SIZE_]], [[STRIDE_]], [[VAR_3_]]) : (i64, i64, !llvm.ptr<f32>, !llvm.ptr<f32>, i64, i64, i64, f32) -> ()
+// CHECK:           llvm.return
+// CHECK:         }
+
+// CHECK-LABEL:   llvm.func @test_parallel_call
+// CHECK:           [[STACK_:%.+]] = llvm.intr.stacksave : !llvm.ptr<i8>
+// CHECK:           [[CONTEXT_ADDR_:%.+]] = llvm.alloca {{.*}} x !llvm.struct<(struct<(ptr<f32>, ptr<f32>, i64, array<1 x i64>, array<1 x i64>)>, f32)>
+// CHECK:           llvm.store {{.*}}, [[CONTEXT_ADDR_]]
+// CHECK:           [[CONTEXT_PTR_:%.+]] = llvm.bitcast [[CONTEXT_ADDR_]] : {{.*}} to !llvm.ptr<i8>
+// CHECK:           [[BODY_:%.+]] = llvm.mlir.addressof @test_parallel_body_trampoline : !llvm.ptr<func<void (ptr<i8>, i64, i64)>>
+// CHECK:           llvm.call @omParallelFor([[BODY_]], [[CONTEXT_PTR_]], {{.*}}) : (!llvm.ptr<func<void (ptr<i8>, i64, i64)>>, !llvm.ptr<i8>, i64) -> ()
+// CHECK:           llvm.intr.stackrestore [[STACK_]]
+
+// -----
+
+func.func private @test_task_graph_body(%arg0: index, %arg1: index, %arg2: memref<10xf32>) {
+  return
+}
+
+func.func @test_task_graph_call(%arg0: memref<10xf32>) {
+  krnl.task_graph_call @test_task_graph_body(%arg0 : memref<10xf32>) {predecessorCounts = [0, 0, 2], successorOffsets = [0, 1, 2, 2], successors = [2, 2]}
+  return
+}
+
+// CHECK-DAG:     llvm.mlir.global internal constant @_test_task_graph_body_predecessor_counts(dense<[0, 0, 2]> : tensor<3xi64>) {addr_space = 0 : i32} : !llvm.array<3 x i64>
+// CHECK-DAG:     llvm.mlir.global internal constant @_test_task_graph_body_successor_offsets(dense<[0, 1, 2, 2]> : tensor<4xi64>) {addr_space = 0 : i32} : !llvm.array<4 x i64>
+// CHECK-DAG:     llvm.mlir.global internal constant @_test_task_graph_body_successors(dense<2> : tensor<2xi64>) {addr_space = 0 : i32} : !llvm.array<2 x i64>
+// CHECK-DAG:     llvm.func @omRunTaskGraph(!llvm.ptr<func<void (ptr<i8>, i64, i64)>>, !llvm.ptr<i8>, i64, !llvm.ptr<i64>, !llvm.ptr<i64>, !llvm.ptr<i64>)
+// CHECK-DAG:     llvm.func internal @test_task_graph_body_trampoline
+
+// CHECK-LABEL:   llvm.func @test_task_graph_call
+// CHECK:           [[STACK_:%.+]] = llvm.intr.stacksave : !llvm.ptr<i8>
+// CHECK:           [[CONTEXT_PTR_:%.+]] = llvm.bitcast {{.*}} to !llvm.ptr<i8>
+// CHECK:           [[BODY_:%.+]] = llvm.mlir.addressof @test_task_graph_body_trampoline : !llvm.ptr<func<void (ptr<i8>, i64, i64)>>
+// CHECK-DAG:       [[NUM_TASKS_:%.+]] = llvm.mlir.constant(3 : i64) : i64
+// CHECK:           llvm.call @omRunTaskGraph([[BODY_]], [[CONTEXT_PTR_]], [[NUM_TASKS_]], {{.*}}, {{.*}}, {{.*}}) : (!llvm.ptr<func<void (ptr<i8>, i64, i64)>>, !llvm.ptr<i8>, i64, !llvm.ptr<i64>, !llvm.ptr<i64>, !llvm.ptr<i64>) -> ()
+// CHECK:           llvm.intr.stackrestore [[STACK_]]
@@ -0,0 +1,90 @@
+// RUN: onnx-mlir-opt -O3 --optimize-memory-pools="plan-offsets" --canonicalize %s -split-input-file | FileCheck %s
+
+/// 1. Slots of different sizes share the memory of a dead slot.
+func.func @plan_different_sizes(%arg0: memref<10x20xf32>) -> memref<10x10xf32> {
+  %c0_i64 = arith.constant 0 : i64
+  %c800_i64 = arith.constant 800 : i64
+  %c1200_i64 = arith.constant 1200 : i64
+  %0 = memref.alloc() : memref<10x10xf32>
+  %1 = memref.alloc() : memref<1600xi8>
+  %2 = "krnl.getref"(%1, %c0_i64) : (memref<1600xi8>, i64) -> memref<10x20xf32>
+  %3 = "krnl.getref"(%1, %c800_i64) : (memref<1600xi8>, i64) -> memref<10x10xf32>
+  %4 = "krnl.getref"(%1, %c1200_i64) : (memref<1600xi8>, i64) -> memref<10x10xf32>
+  %5:2 = krnl.define_loops 2
+  krnl.iterate(%5#0, %5#1) with (%5#0 -> %arg1 = 0 to 10, %5#1 -> %arg2 = 0 to 20) {
+    %10 = krnl.load %arg0[%arg1, %arg2] : memref<10x20xf32>
+    %11 = arith.mulf %10, %10 : f32
+    krnl.store %11, %2[%arg1, %arg2] : memref<10x20xf32>
+  }
+  %6:2 = krnl.define_loops 2
+  krnl.iterate(%6#0, %6#1) with (%6#0 -> %arg1 = 0 to 10, %6#1 -> %arg2 = 0 to 10) {
+    %10 = krnl.load %2[%arg1, %arg2] : memref<10x20xf32>
+    krnl.store %10, %0[%arg1, %arg2] : memref<10x10xf32>
+  }
+  %7:2 = krnl.define_loops 2
+  krnl.iterate(%7#0, %7#1) with (%7#0 -> %arg1 = 0 to 10, %7#1 -> %arg2 = 0 to 10) {
+    %10 = krnl.load %arg0[%arg1, %arg2] : memref<10x20xf32>
+    krnl.store %10, %3[%arg1, %arg2] : memref<10x10xf32>
+  }
+  %8:2 = krnl.define_loops 2
+  krnl.iterate(%8#0, %8#1) with (%8#0 -> %arg1 = 0 to 10, %8#1 -> %arg2 = 0 to 10) {
+    %10 = krnl.load %arg0[%arg2, %arg1] : memref<10x20xf32>
+    krnl.store %10, %4[%arg1, %arg2] : memref<10x10xf32>
+  }
+  %9:2 = krnl.define_loops 2
+  krnl.iterate(%9#0, %9#1) with (%9#0 -> %arg1 = 0 to 10, %9#1 -> %arg2 = 0 to 10) {
+    %10 = krnl.load %0[%arg1, %arg2] : memref<10x10xf32>
+    %11 = krnl.load %3[%arg1, %arg2] : memref<10x10xf32>
+    %12 = krnl.load %4[%arg1, %arg2] : memref<10x10xf32>
+    %13 = arith.mulf %11, %12 : f32
+    %14 = arith.addf %10, %13 : f32
+    krnl.store %14, %0[%arg1, %arg2] : memref<10x10xf32>
+  }
+  memref.dealloc %1 : memref<1600xi8>
+  return %0 : memref<10x10xf32>
+
+  // CHECK-LABEL: plan_different_sizes
+  // CHECK-DAG: [[C0:%.+]] = arith.constant 0 : i64
+  // CHECK-DAG: [[C400:%.+]] = arith.constant 400 : i64
+  // CHECK-DAG: [[MEMPOOL:%.+]] = memref.alloc() : memref<800xi8>
+  // CHECK: "krnl.getref"([[MEMPOOL]], [[C0]]) : (memref<800xi8>, i64) -> memref<10x20xf32>
+  // CHECK: "krnl.getref"([[MEMPOOL]], [[C0]]) : (memref<800xi8>, i64) -> memref<10x10xf32>
+  // CHECK: "krnl.getref"([[MEMPOOL]], [[C400]]) : (memref<800xi8>, i64) -> memref<10x10xf32>
+  // CHECK: memref.dealloc [[MEMPOOL]] : memref<800xi8>
+}
+
+// -----
+
+/// 2. Slots used in the same loop nest do not share memory.
+func.func @plan_same_loop_nest(%arg0: memref<10x10xf32>) -> memref<10x10xf32> {
+  %c0_i64 = arith.constant 0 : i64
+  %c400_i64 = arith.constant 400 : i64
+  %0 = memref.alloc() : memref<10x10xf32>
+  %1 = memref.alloc() : memref<800xi8>
+  %2 = "krnl.getref"(%1, %c0_i64) : (memref<800xi8>, i64) -> memref<10x10xf32>
+  %3 = "krnl.getref"(%1, %c400_i64) : (memref<800xi8>, i64) -> memref<10x10xf32>
+  %4:2 = krnl.define_loops 2
+  krnl.iterate(%4#0, %4#1) with (%4#0 -> %arg1 = 0 to 10, %4#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %arg0[%arg1, %arg2] : memref<10x10xf32>
+    krnl.store %6, %2[%arg1, %arg2] : memref<10x10xf32>
+    %7 = krnl.define_loops 1
+    krnl.iterate(%7) with (%7 -> %arg3 = 0 to 10) {
+      %8 = krnl.load %2[%arg1, %arg3] : memref<10x10xf32>
+      krnl.store %8, %3[%arg1, %arg3] : memref<10x10xf32>
+    }
+  }
+  %5:2 = krnl.define_loops 2
+  krnl.iterate(%5#0, %5#1) with (%5#0 -> %arg1 = 0 to 10, %5#1 -> %arg2 = 0 to 10) {
+    %6 = krnl.load %3[%arg1, %arg2] : memref<10x10xf32>
+    krnl.store %6, %0[%arg1, %arg2] : memref<10x10xf32>
+  }
+  memref.dealloc %1 : memref<800xi8>
+  return %0 : memref<10x10xf32>
+
+  // CHECK-LABEL: plan_same_loop_nest
+  // CHECK-DAG: [[C0:%.+]] = arith.constant 0 : i64
+  // CHECK-DAG: [[C400:%.+]] = arith.constant 400 : i64
+  // CHECK-DAG: [[MEMPOOL:%.+]] = memref.alloc() : memref<800xi8>
+  // CHECK: "krnl.getref"([[MEMPOOL]], [[C0]]) : (memref<800xi8>, i64) -> memref<10x10xf32>
+  // CHECK: "krnl.getref"([[MEMPOOL]], [[C400]]) : (memref<800xi8>, i64) -> memref<10x10xf32>
+}
@@ -19,7 +19,7 @@ func.func @test_random_normal_lowering() -> memref<3x4x5xf32> {
   // CHECK: [[ALL_VALUES:%.+]] = llvm.mlir.constant(60 : index) : i64
 
   /// Populate tensor:
-  // CHECK: [[ALIGNED_TENSOR_MEMORY:%.+]] = llvm.inttoptr {{.*}} : i64 to !llvm.ptr<f32>
+  // CHECK: [[ALIGNED_TENSOR_MEMORY:%.+]] = llvm.bitcast {{.*}} : !llvm.ptr<i8> to !llvm.ptr<f32>
   // CHECK: llvm.mlir.undef : !llvm.struct<(ptr<f32>, ptr<f32>, i64, array<3 x i64>, array<3 x i64>)>
   // CHECK: [[OUTPUT_TENSOR:%.+]] = llvm.insertvalue {{.*}}, {{.*}}[4, 2] : !llvm.struct<(ptr<f32>, ptr<f32>, i64, array<3 x i64>, array<3 x i64>)>
   // CHECK: llvm.call @get_random_normal_value_f32([[ALIGNED_TENSOR_MEMORY]], [[ALL_VALUES]], [[MEAN]], [[SCALE]], [[SEED]]) : (!llvm.ptr<f32>, i64, f32, f32, f32) -> ()
@@ -65,7 +65,7 @@ func.func @test_random_normal_dynamic_lowering(%arg0: memref<3x4x?x?xf32>) -> me
   /// Allocate aligned tensor:
   // CHECK: [[POINTER:%.+]] = llvm.mlir.null : !llvm.ptr<f32>
   // CHECK: llvm.getelementptr [[POINTER]][%[[MUL3]]]
-  // CHECK: [[ALIGNED_TENSOR_MEMORY:%.+]] = llvm.inttoptr {{.*}} : i64 to !llvm.ptr<f32>
+  // CHECK: [[ALIGNED_TENSOR_MEMORY:%.+]] = llvm.bitcast {{.*}} : !llvm.ptr<i8> to !llvm.ptr<f32>
 
   /// Populate tensor:
   // CHECK: llvm.mlir.undef : !llvm.struct<(ptr<f32>, ptr<f32>, i64, array<4 x i64>, array<4 x i64>)>
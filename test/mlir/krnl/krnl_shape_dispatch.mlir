@@ -0,0 +1,39 @@
+// RUN: onnx-mlir-opt --shape-dispatch %s -split-input-file | FileCheck %s
+
+module {
+  func.func @main_graph(%arg0: memref<?x128xf32>) -> memref<?x128xf32> {
+    %c0 = arith.constant 0 : index
+    %0 = memref.dim %arg0, %c0 : memref<?x128xf32>
+    %1 = memref.alloc(%0) : memref<?x128xf32>
+    return %1 : memref<?x128xf32>
+  }
+  func.func @main_graph_shape0(%arg0: memref<8x128xf32>) -> memref<8x128xf32> attributes {onnx.specialization_of = @main_graph} {
+    %0 = memref.alloc() : memref<8x128xf32>
+    return %0 : memref<8x128xf32>
+  }
+  "krnl.entry_point"() {func = @main_graph, numInputs = 1 : i32, numOutputs = 1 : i32, signature = ""} : () -> ()
+
+// CHECK-LABEL:  func.func private @main_graph_dynamic
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x128xf32>) -> memref<?x128xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) : memref<?x128xf32>
+// CHECK:           return [[RES_]] : memref<?x128xf32>
+// CHECK:         }
+// CHECK:         func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x128xf32>) -> memref<?x128xf32> {
+// CHECK:           [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], {{.*}} : memref<?x128xf32>
+// CHECK:           [[VAR_0_:%.+]] = arith.cmpi eq, [[VAR_dim_]], {{.*}} : index
+// CHECK:           [[VAR_1_:%.+]] = arith.andi {{.*}}, [[VAR_0_]] : i1
+// CHECK:           [[VAR_2_:%.+]] = scf.if [[VAR_1_]] -> (memref<?x128xf32>) {
+// CHECK:             [[VAR_cast_:%.+]] = memref.cast [[PARAM_0_]] : memref<?x128xf32> to memref<8x128xf32>
+// CHECK:             [[VAR_3_:%.+]] = func.call @main_graph_shape0([[VAR_cast_]]) : (memref<8x128xf32>) -> memref<8x128xf32>
+// CHECK:             [[VAR_cast_1_:%.+]] = memref.cast [[VAR_3_]] : memref<8x128xf32> to memref<?x128xf32>
+// CHECK:             scf.yield [[VAR_cast_1_]] : memref<?x128xf32>
+// CHECK:           } else {
+// CHECK:             [[VAR_3_:%.+]] = func.call @main_graph_dynamic([[PARAM_0_]]) : (memref<?x128xf32>) -> memref<?x128xf32>
+// CHECK:             scf.yield [[VAR_3_]] : memref<?x128xf32>
+// CHECK:           }
+// CHECK:           return [[VAR_2_]] : memref<?x128xf32>
+// CHECK:         }
+// CHECK:         func.func private @main_graph_shape0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<8x128xf32>) -> memref<8x128xf32> {
+}
@@ -0,0 +1,57 @@
+// RUN: onnx-mlir-opt -O3 --convert-krnl-to-affine %s -split-input-file | FileCheck %s
+
+// Check that the loop is unrolled and jammed into its inner loop, the values
+// loaded by the copies of the body being next to each other.
+
+func.func @unroll_jam(%arg0 : memref<4x8xf32>, %arg1 : memref<4xf32>) {
+  %ii = krnl.define_loops 1
+  krnl.unroll_jam %ii 2 : !krnl.loop
+  krnl.iterate(%ii) with (%ii -> %i = 0 to 4) {
+    %jj = krnl.define_loops 1
+    krnl.iterate(%jj) with (%jj -> %j = 0 to 8) {
+      %0 = krnl.load %arg0[%i, %j] : memref<4x8xf32>
+      %1 = krnl.load %arg1[%i] : memref<4xf32>
+      %2 = arith.addf %0, %1 : f32
+      krnl.store %2, %arg1[%i] : memref<4xf32>
+    }
+  }
+  return
+
+  // CHECK-DAG:   [[MAP_:#.+]] = affine_map<(d0) -> (d0 + 1)>
+  // CHECK-LABEL: unroll_jam
+  // CHECK:       affine.for [[I_:%.+]] = 0 to 4 step 2 {
+  // CHECK:         affine.for [[J_:%.+]] = 0 to 8 {
+  // CHECK:           affine.load %arg0{{.}}[[I_]], [[J_]]{{.}} : memref<4x8xf32>
+  // CHECK:           affine.store {{.*}}, %arg1{{.}}[[I_]]{{.}} : memref<4xf32>
+  // CHECK:           [[I_1_:%.+]] = affine.apply [[MAP_]]([[I_]])
+  // CHECK:           affine.load %arg0{{.}}[[I_1_]], [[J_]]{{.}} : memref<4x8xf32>
+  // CHECK:           affine.store {{.*}}, %arg1{{.}}[[I_1_]]{{.}} : memref<4xf32>
+  // CHECK:         }
+  // CHECK:       }
+}
+
+// -----
+
+// Check that the loop is left as is when the bounds of its inner loop depend
+// on it.
+
+func.func @unroll_jam_dependent_bounds(%arg0 : memref<4x8xf32>) {
+  %ii = krnl.define_loops 1
+  krnl.unroll_jam %ii 2 : !krnl.loop
+  krnl.iterate(%ii) with (%ii -> %i = 0 to 4) {
+    %jj = krnl.define_loops 1
+    krnl.iterate(%jj) with (%jj -> %j = %i to 8) {
+      %cst = arith.constant 0.0 : f32
+      krnl.store %cst, %arg0[%i, %j] : memref<4x8xf32>
+    }
+  }
+  return
+
+  // CHECK-LABEL: unroll_jam_dependent_bounds
+  // CHECK:       affine.for [[I_:%.+]] = 0 to 4 {
+  // CHECK:         affine.for [[J_:%.+]] = {{.*}}[[I_]]{{.*}} to 8 {
+  // CHECK-NOT:     affine.apply
+  // CHECK:           affine.store {{.*}}, %arg0{{.}}[[I_]], [[J_]]{{.}} : memref<4x8xf32>
+  // CHECK:         }
+  // CHECK:       }
+}
@@ -144,6 +144,53 @@ func.func @test_conv_batchnormtestmode_fusion(%arg0 : tensor<1x3x224x224xf32>, %
 
 // -----
 
+func.func @test_gemm_batchnormtestmode_fusion(%arg0 : tensor<8x16xf32>, %arg1 : tensor<16x32xf32>, %arg2 : tensor<32xf32>, %scale : tensor<32xf32>, %bias : tensor<32xf32>, %mean : tensor<32xf32>, %var : tensor<32xf32>) -> tensor<8x32xf32> {
+    %0 = "onnx.Gemm"(%arg0, %arg1, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32, transA = 0 : si64, transB = 0 : si64} : (tensor<8x16xf32>, tensor<16x32xf32>, tensor<32xf32>) -> tensor<8x32xf32>
+    %1 = "onnx.BatchNormalizationInferenceMode"(%0, %scale, %bias, %mean, %var) {epsilon = 1.00000007E-5 : f32} : (tensor<8x32xf32>, tensor<32xf32>, tensor<32xf32>, tensor<32xf32>, tensor<32xf32>) -> tensor<8x32xf32>
+    return %1 : tensor<8x32xf32>
+
+    // CHECK-LABEL:  func.func @test_gemm_batchnormtestmode_fusion
+    // CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<8x16xf32>, [[PARAM_1_:%.+]]: tensor<16x32xf32>, [[PARAM_2_:%.+]]: tensor<32xf32>, [[PARAM_3_:%.+]]: tensor<32xf32>, [[PARAM_4_:%.+]]: tensor<32xf32>, [[PARAM_5_:%.+]]: tensor<32xf32>, [[PARAM_6_:%.+]]: tensor<32xf32>) -> tensor<8x32xf32> {
+    // CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<1.00000007E-5> : tensor<1xf32>
+    // CHECK:           [[VAR_1_:%.+]] = "onnx.Add"([[PARAM_6_]], [[VAR_0_]])
+    // CHECK:           [[VAR_2_:%.+]] = "onnx.Sqrt"([[VAR_1_]])
+    // CHECK:           [[VAR_3_:%.+]] = "onnx.Div"([[PARAM_3_]], [[VAR_2_]])
+    // CHECK-DAG:       [[VAR_4_:%.+]] = "onnx.Mul"([[PARAM_1_]], [[VAR_3_]])
+    // CHECK-DAG:       [[VAR_5_:%.+]] = "onnx.Mul"([[PARAM_5_]], [[VAR_3_]])
+    // CHECK:           [[VAR_6_:%.+]] = "onnx.Sub"([[PARAM_4_]], [[VAR_5_]])
+    // CHECK:           [[VAR_7_:%.+]] = "onnx.Mul"([[PARAM_2_]], [[VAR_3_]])
+    // CHECK:           [[VAR_8_:%.+]] = "onnx.Add"([[VAR_7_]], [[VAR_6_]])
+    // CHECK:           [[VAR_9_:%.+]] = "onnx.Gemm"([[PARAM_0_]], [[VAR_4_]], [[VAR_8_]]) {alpha = 1.000000e+00 : f32, beta = 1.000000e+00 : f32, transA = 0 : si64, transB = 0 : si64}
+    // CHECK-NOT: {{.*}} = "onnx.BatchNormalizationInferenceMode"{{.*}}
+    // CHECK:           return [[VAR_9_]] : tensor<8x32xf32>
+}
+
+// -----
+
+func.func @test_gemm_batchnormtestmode_fusion_transb_nobias(%arg0 : tensor<8x16xf32>, %arg1 : tensor<32x16xf32>, %scale : tensor<32xf32>, %bias : tensor<32xf32>, %mean : tensor<32xf32>, %var : tensor<32xf32>) -> tensor<8x32xf32> {
+    %cst = "onnx.NoValue"() {value} : () -> none
+    %0 = "onnx.Gemm"(%arg0, %arg1, %cst) {alpha = 1.0 : f32, beta = 1.0 : f32, transA = 0 : si64, transB = 1 : si64} : (tensor<8x16xf32>, tensor<32x16xf32>, none) -> tensor<8x32xf32>
+    %1 = "onnx.BatchNormalizationInferenceMode"(%0, %scale, %bias, %mean, %var) {epsilon = 1.00000007E-5 : f32} : (tensor<8x32xf32>, tensor<32xf32>, tensor<32xf32>, tensor<32xf32>, tensor<32xf32>) -> tensor<8x32xf32>
+    return %1 : tensor<8x32xf32>
+
+    // CHECK-LABEL:  func.func @test_gemm_batchnormtestmode_fusion_transb_nobias
+    // CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<8x16xf32>, [[PARAM_1_:%.+]]: tensor<32x16xf32>, [[PARAM_2_:%.+]]: tensor<32xf32>, [[PARAM_3_:%.+]]: tensor<32xf32>, [[PARAM_4_:%.+]]: tensor<32xf32>, [[PARAM_5_:%.+]]: tensor<32xf32>) -> tensor<8x32xf32> {
+    // CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<1.00000007E-5> : tensor<1xf32>
+    // CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<1> : tensor<1xi64>
+    // CHECK:           [[VAR_2_:%.+]] = "onnx.Add"([[PARAM_5_]], [[VAR_0_]])
+    // CHECK:           [[VAR_3_:%.+]] = "onnx.Sqrt"([[VAR_2_]])
+    // CHECK:           [[VAR_4_:%.+]] = "onnx.Div"([[PARAM_2_]], [[VAR_3_]])
+    // CHECK:           [[VAR_5_:%.+]] = "onnx.Unsqueeze"([[VAR_4_]], [[VAR_1_]])
+    // CHECK-DAG:       [[VAR_6_:%.+]] = "onnx.Mul"([[PARAM_1_]], [[VAR_5_]])
+    // CHECK-DAG:       [[VAR_7_:%.+]] = "onnx.Mul"([[PARAM_4_]], [[VAR_4_]])
+    // CHECK:           [[VAR_8_:%.+]] = "onnx.Sub"([[PARAM_3_]], [[VAR_7_]])
+    // CHECK:           [[VAR_9_:%.+]] = "onnx.Gemm"([[PARAM_0_]], [[VAR_6_]], [[VAR_8_]]) {alpha = 1.000000e+00 : f32, beta = 1.000000e+00 : f32, transA = 0 : si64, transB = 1 : si64}
+    // CHECK-NOT: {{.*}} = "onnx.BatchNormalizationInferenceMode"{{.*}}
+    // CHECK:           return [[VAR_9_]] : tensor<8x32xf32>
+}
+
+// -----
+
 // Check the removal of identity transposes.
 // CHECK-LABEL: func @test_transpose_removal(%arg0: tensor<10x11x12x13xf32>) -> tensor<10x11x12x13xf32> {
 func.func @test_transpose_removal(%arg0: tensor<10x11x12x13xf32>) -> tensor<10x11x12x13xf32> {
@@ -713,6 +760,54 @@ func.func @test_fuse_mul_conv(%arg0: tensor<1x1x28x28xf32>) -> tensor<*xf32> {
 
 // -----
 
+// Check that the normalization of the input is folded into the weights and
+// bias of a convolution without padding.
+func.func @test_fold_normalization_conv(%arg0: tensor<1x3x8x8xf32>) -> tensor<1x4x6x6xf32> {
+    %0 = onnx.Constant dense<[[[0.485]], [[0.456]], [[0.406]]]> : tensor<3x1x1xf32>
+    %1 = onnx.Constant dense<[[[0.229]], [[0.224]], [[0.225]]]> : tensor<3x1x1xf32>
+    %2 = onnx.Constant dense<1.0> : tensor<4x3x3x3xf32>
+    %3 = onnx.Constant dense<0.5> : tensor<4xf32>
+    %4 = "onnx.Sub"(%arg0, %0) : (tensor<1x3x8x8xf32>, tensor<3x1x1xf32>) -> tensor<1x3x8x8xf32>
+    %5 = "onnx.Div"(%4, %1) : (tensor<1x3x8x8xf32>, tensor<3x1x1xf32>) -> tensor<1x3x8x8xf32>
+    %6 = "onnx.Conv"(%5, %2, %3) {kernel_shape = [3, 3]} : (tensor<1x3x8x8xf32>, tensor<4x3x3x3xf32>, tensor<4xf32>) -> tensor<1x4x6x6xf32>
+    return %6 : tensor<1x4x6x6xf32>
+
+// CHECK-LABEL:  func.func @test_fold_normalization_conv
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3x8x8xf32>) -> tensor<1x4x6x6xf32> {
+// CHECK-NOT:       "onnx.Sub"([[PARAM_0_]]
+// CHECK:           [[VAR_W_:%.+]] = "onnx.Div"({{.*}}) : (tensor<4x3x3x3xf32>, tensor<1x3x1x1xf32>) -> tensor<4x3x3x3xf32>
+// CHECK:           [[VAR_SHIFT_:%.+]] = "onnx.Mul"([[VAR_W_]], {{.*}}) : (tensor<4x3x3x3xf32>, tensor<1x3x1x1xf32>) -> tensor<4x3x3x3xf32>
+// CHECK:           [[VAR_SUM_:%.+]] = "onnx.ReduceSum"([[VAR_SHIFT_]], {{.*}}) {keepdims = 0 : si64, noop_with_empty_axes = 0 : si64} : (tensor<4x3x3x3xf32>, tensor<3xi64>) -> tensor<4xf32>
+// CHECK:           [[VAR_B_:%.+]] = "onnx.Sub"({{.*}}, [[VAR_SUM_]]) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+// CHECK:           [[VAR_Y_:%.+]] = "onnx.Conv"([[PARAM_0_]], [[VAR_W_]], [[VAR_B_]])
+// CHECK:           return [[VAR_Y_]] : tensor<1x4x6x6xf32>
+}
+
+// -----
+
+// Check that the shift of the input of a padded convolution is not folded,
+// the padding being zero in the shifted input, while its scale is.
+func.func @test_fold_normalization_conv_padded(%arg0: tensor<1x3x8x8xf32>) -> tensor<1x4x8x8xf32> {
+    %0 = onnx.Constant dense<[[[0.485]], [[0.456]], [[0.406]]]> : tensor<3x1x1xf32>
+    %1 = onnx.Constant dense<[[[0.229]], [[0.224]], [[0.225]]]> : tensor<3x1x1xf32>
+    %2 = onnx.Constant dense<1.0> : tensor<4x3x3x3xf32>
+    %3 = "onnx.NoValue"() {value} : () -> none
+    %4 = "onnx.Sub"(%arg0, %0) : (tensor<1x3x8x8xf32>, tensor<3x1x1xf32>) -> tensor<1x3x8x8xf32>
+    %5 = "onnx.Div"(%4, %1) : (tensor<1x3x8x8xf32>, tensor<3x1x1xf32>) -> tensor<1x3x8x8xf32>
+    %6 = "onnx.Conv"(%5, %2, %3) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x3x8x8xf32>, tensor<4x3x3x3xf32>, none) -> tensor<1x4x8x8xf32>
+    return %6 : tensor<1x4x8x8xf32>
+
+// CHECK-LABEL:  func.func @test_fold_normalization_conv_padded
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3x8x8xf32>) -> tensor<1x4x8x8xf32> {
+// CHECK:           [[VAR_X_:%.+]] = "onnx.Sub"([[PARAM_0_]], {{.*}}) : (tensor<1x3x8x8xf32>, tensor<3x1x1xf32>) -> tensor<1x3x8x8xf32>
+// CHECK:           [[VAR_W_:%.+]] = "onnx.Div"({{.*}}) : (tensor<4x3x3x3xf32>, tensor<1x3x1x1xf32>) -> tensor<4x3x3x3xf32>
+// CHECK-NOT:       "onnx.ReduceSum"
+// CHECK:           [[VAR_Y_:%.+]] = "onnx.Conv"([[VAR_X_]], [[VAR_W_]], {{.*}})
+// CHECK:           return [[VAR_Y_]] : tensor<1x4x8x8xf32>
+}
+
+// -----
+
 func.func @test_less(%arg0 : tensor<i32>, %arg1 : tensor<i32>) -> tensor<i1> {
   %0 = "onnx.Cast"(%arg0) {to = f32} : (tensor<i32>) -> tensor<f32>
   %1 = "onnx.Cast"(%arg1) {to = f32} : (tensor<i32>) -> tensor<f32>
@@ -954,3 +1049,76 @@ func.func @shape_transform_identity_map(%arg0: tensor<128x128xf32>) -> tensor<12
 // CHECK:           return [[PARAM_0_]] : tensor<128x128xf32>
 // CHECK:         }
 }
+
+// -----
+
+func.func @test_layout_transform_fusion(%arg0: tensor<5x3x32x32xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<5x3x32x32xf32, #onnx.layout<{dataLayout = "NCHW4C"}>> {
+    %0 = "onnx.LayoutTransform"(%arg0) {target_layout = "STANDARD"} : (tensor<5x3x32x32xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<5x3x32x32xf32>
+    %1 = "onnx.LayoutTransform"(%0) {target_layout = #onnx.layout<{dataLayout = "NCHW4C"}>} : (tensor<5x3x32x32xf32>) -> tensor<5x3x32x32xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+    return %1 : tensor<5x3x32x32xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+
+// CHECK-LABEL: test_layout_transform_fusion
+// CHECK-NOT: "onnx.LayoutTransform"
+// CHECK: return %arg0
+}
+
+// -----
+
+// Rewrite the product of a one-hot matrix into a Gather of rows.
+func.func @test_matmul_onehot_to_gather(%arg0: tensor<2x3xi64>, %arg1: tensor<10x8xf32>) -> tensor<2x3x8xf32> {
+  %depth = onnx.Constant dense<10> : tensor<i64>
+  %values = onnx.Constant dense<[0.0, 1.0]> : tensor<2xf32>
+  %0 = "onnx.OneHot"(%arg0, %depth, %values) {axis = -1 : si64} : (tensor<2x3xi64>, tensor<i64>, tensor<2xf32>) -> tensor<2x3x10xf32>
+  %1 = "onnx.MatMul"(%0, %arg1) : (tensor<2x3x10xf32>, tensor<10x8xf32>) -> tensor<2x3x8xf32>
+  return %1 : tensor<2x3x8xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_onehot_to_gather
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x3xi64>, [[PARAM_1_:%.+]]: tensor<10x8xf32>) -> tensor<2x3x8xf32> {
+// CHECK-DAG:       [[VAR_ZERO_:%.+]] = onnx.Constant dense<0> : tensor<i64>
+// CHECK-DAG:       [[VAR_DEPTH_:%.+]] = onnx.Constant dense<10> : tensor<i64>
+// CHECK-DAG:       [[VAR_ROW_:%.+]] = onnx.Constant dense<0.000000e+00> : tensor<1x8xf32>
+// CHECK-NOT:       "onnx.OneHot"
+// CHECK:           [[VAR_IDX_:%.+]] = "onnx.Where"({{.*}}, [[VAR_DEPTH_]]) : (tensor<2x3xi1>, tensor<2x3xi64>, tensor<i64>) -> tensor<2x3xi64>
+// CHECK:           [[VAR_TABLE_:%.+]] = "onnx.Concat"([[PARAM_1_]], [[VAR_ROW_]]) {axis = 0 : si64} : (tensor<10x8xf32>, tensor<1x8xf32>) -> tensor<11x8xf32>
+// CHECK:           [[VAR_RES_:%.+]] = "onnx.Gather"([[VAR_TABLE_]], [[VAR_IDX_]]) {axis = 0 : si64} : (tensor<11x8xf32>, tensor<2x3xi64>) -> tensor<2x3x8xf32>
+// CHECK-NOT:       "onnx.MatMul"
+// CHECK:           return [[VAR_RES_]] : tensor<2x3x8xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Rewrite the Gemm of a one-hot matrix with a bias into a Gather of rows plus
+// the bias.
+func.func @test_gemm_onehot_to_gather_add(%arg0: tensor<4xi32>, %arg1: tensor<10x8xf32>, %arg2: tensor<8xf32>) -> tensor<4x8xf32> {
+  %depth = onnx.Constant dense<10> : tensor<i64>
+  %values = onnx.Constant dense<[0.0, 1.0]> : tensor<2xf32>
+  %0 = "onnx.OneHot"(%arg0, %depth, %values) {axis = -1 : si64} : (tensor<4xi32>, tensor<i64>, tensor<2xf32>) -> tensor<4x10xf32>
+  %1 = "onnx.Gemm"(%0, %arg1, %arg2) : (tensor<4x10xf32>, tensor<10x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+  return %1 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_gemm_onehot_to_gather_add
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<4xi32>, [[PARAM_1_:%.+]]: tensor<10x8xf32>, [[PARAM_2_:%.+]]: tensor<8xf32>) -> tensor<4x8xf32> {
+// CHECK:           "onnx.Cast"([[PARAM_0_]]) {{.*}}to = i64{{.*}} : (tensor<4xi32>) -> tensor<4xi64>
+// CHECK:           [[VAR_RES_:%.+]] = "onnx.Gather"({{.*}}) {axis = 0 : si64} : (tensor<11x8xf32>, tensor<4xi64>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_ADD_:%.+]] = "onnx.Add"([[VAR_RES_]], [[PARAM_2_]]) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+// CHECK-NOT:       "onnx.Gemm"
+// CHECK:           return [[VAR_ADD_]] : tensor<4x8xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Keep the product of a one-hot matrix with other values than [0, 1].
+func.func @test_matmul_onehot_values_no_gather(%arg0: tensor<4xi64>, %arg1: tensor<10x8xf32>) -> tensor<4x8xf32> {
+  %depth = onnx.Constant dense<10> : tensor<i64>
+  %values = onnx.Constant dense<[0.0, 2.0]> : tensor<2xf32>
+  %0 = "onnx.OneHot"(%arg0, %depth, %values) {axis = -1 : si64} : (tensor<4xi64>, tensor<i64>, tensor<2xf32>) -> tensor<4x10xf32>
+  %1 = "onnx.MatMul"(%0, %arg1) : (tensor<4x10xf32>, tensor<10x8xf32>) -> tensor<4x8xf32>
+  return %1 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_onehot_values_no_gather
+// CHECK:           "onnx.OneHot"
+// CHECK:           "onnx.MatMul"
+// CHECK-NOT:       "onnx.Gather"
+}
@@ -984,3 +984,66 @@ func.func @test_reshape() -> tensor<*xf32> {
 // CHECK:           return [[VAR_0_]] : tensor<1x9xf32>
 // CHECK:         }
 }
+
+// -----
+
+func.func @test_matmul() -> tensor<2x2xf32> {
+  %0 = onnx.Constant dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>
+  %1 = onnx.Constant dense<[[5.0, 6.0], [7.0, 8.0]]> : tensor<2x2xf32>
+  %2 = "onnx.MatMul"(%0, %1) : (tensor<2x2xf32>, tensor<2x2xf32>) -> tensor<2x2xf32>
+  "func.return"(%2) : (tensor<2x2xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul
+// CHECK-SAME:   () -> tensor<2x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}[1.900000e+01, 2.200000e+01], [4.300000e+01, 5.000000e+01]{{.}}> : tensor<2x2xf32>
+// CHECK-NOT:       onnx.MatMul
+// CHECK:           return [[VAR_0_]] : tensor<2x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_matmul_broadcast() -> tensor<2x1x1xf32> {
+  %0 = onnx.Constant dense<[[[1.0, 2.0]], [[3.0, 4.0]]]> : tensor<2x1x2xf32>
+  %1 = onnx.Constant dense<[[1.0], [1.0]]> : tensor<2x1xf32>
+  %2 = "onnx.MatMul"(%0, %1) : (tensor<2x1x2xf32>, tensor<2x1xf32>) -> tensor<2x1x1xf32>
+  "func.return"(%2) : (tensor<2x1x1xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_broadcast
+// CHECK-SAME:   () -> tensor<2x1x1xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}{{.}}[3.000000e+00]{{.}}, {{.}}[7.000000e+00]{{.}}{{.}}> : tensor<2x1x1xf32>
+// CHECK:           return [[VAR_0_]] : tensor<2x1x1xf32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_matmul_vector() -> tensor<2xi32> {
+  %0 = onnx.Constant dense<[1, 2, 3]> : tensor<3xi32>
+  %1 = onnx.Constant dense<[[1, 0], [0, 1], [1, 1]]> : tensor<3x2xi32>
+  %2 = "onnx.MatMul"(%0, %1) : (tensor<3xi32>, tensor<3x2xi32>) -> tensor<2xi32>
+  "func.return"(%2) : (tensor<2xi32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_vector
+// CHECK-SAME:   () -> tensor<2xi32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<[4, 5]> : tensor<2xi32>
+// CHECK:           return [[VAR_0_]] : tensor<2xi32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_gemm() -> tensor<2x2xf32> {
+  %0 = onnx.Constant dense<[[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]> : tensor<2x3xf32>
+  %1 = onnx.Constant dense<[[1.0, 0.0, 1.0], [0.0, 1.0, 0.0]]> : tensor<2x3xf32>
+  %2 = onnx.Constant dense<[1.0, 2.0]> : tensor<2xf32>
+  %3 = "onnx.Gemm"(%0, %1, %2) {alpha = 2.0 : f32, beta = 0.5 : f32, transB = 1 : si64} : (tensor<2x3xf32>, tensor<2x3xf32>, tensor<2xf32>) -> tensor<2x2xf32>
+  "func.return"(%3) : (tensor<2x2xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm
+// CHECK-SAME:   () -> tensor<2x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}[8.500000e+00, 5.000000e+00], [2.050000e+01, 1.100000e+01]{{.}}> : tensor<2x2xf32>
+// CHECK-NOT:       onnx.Gemm
+// CHECK:           return [[VAR_0_]] : tensor<2x2xf32>
+// CHECK:         }
+}
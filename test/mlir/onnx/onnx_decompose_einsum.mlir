@@ -66,8 +66,8 @@ func.func @test_einsum_mul3_broadcast(%arg0: tensor<1x3xf32>, %arg1: tensor<1x1x
   return %0 : tensor<2x3xf32>
 // CHECK-LABEL:  func @test_einsum_mul3_broadcast
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3xf32>, [[PARAM_1_:%.+]]: tensor<1x1xf32>, [[PARAM_2_:%.+]]: tensor<2x1xf32>) -> tensor<2x3xf32> {
-// CHECK:           [[VAR_0_:%.+]] = "onnx.Mul"([[PARAM_0_]], [[PARAM_1_]]) : (tensor<1x3xf32>, tensor<1x1xf32>) -> tensor<1x3xf32>
-// CHECK:           [[VAR_1_:%.+]] = "onnx.Mul"([[VAR_0_]], [[PARAM_2_]]) : (tensor<1x3xf32>, tensor<2x1xf32>) -> tensor<2x3xf32>
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Mul"([[PARAM_1_]], [[PARAM_2_]]) : (tensor<1x1xf32>, tensor<2x1xf32>) -> tensor<2x1xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Mul"([[PARAM_0_]], [[VAR_0_]]) : (tensor<1x3xf32>, tensor<2x1xf32>) -> tensor<2x3xf32>
 // CHECK:           return [[VAR_1_]] : tensor<2x3xf32>
 }
 
@@ -116,3 +116,36 @@ func.func @test_einsum_ibh_hnd(%arg0: tensor<128x1x1024xf16>, %arg1: tensor<1024
 // CHECK:           [[VAR_6_:%.+]] = "onnx.Reshape"([[VAR_4_]], [[VAR_5_]]) {allowzero = 0 : si64} : (tensor<128x1024xf16>, tensor<4xi64>) -> tensor<128x1x16x64xf16>
 // CHECK:           return [[VAR_6_]] : tensor<128x1x16x64xf16>
 }
+
+// The right operand is in the transposed order (k, j), which Gemm transposes.
+func.func @test_einsum_matmul_transb(%arg0: tensor<3x4xf32>, %arg1: tensor<5x4xf32>) -> tensor<3x5xf32> {
+  %0 = "onnx.Einsum"(%arg0, %arg1) {equation = "ij,kj->ik"} : (tensor<3x4xf32>, tensor<5x4xf32>) -> tensor<3x5xf32>
+  return %0 : tensor<3x5xf32>
+// CHECK-LABEL:  func.func @test_einsum_matmul_transb
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<3x4xf32>, [[PARAM_1_:%.+]]: tensor<5x4xf32>) -> tensor<3x5xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK-NEXT:      [[VAR_1_:%.+]] = "onnx.Gemm"([[PARAM_0_]], [[PARAM_1_]], [[VAR_0_]]) {alpha = 1.000000e+00 : f32, beta = 1.000000e+00 : f32, transA = 0 : si64, transB = 1 : si64} : (tensor<3x4xf32>, tensor<5x4xf32>, none) -> tensor<3x5xf32>
+// CHECK-NEXT:      return [[VAR_1_]] : tensor<3x5xf32>
+}
+
+// Swapping the operands of the batched MatMul avoids transposing both of them
+// and the result.
+func.func @test_einsum_matmul_swap(%arg0: tensor<2x4x3xf32>, %arg1: tensor<2x5x4xf32>) -> tensor<2x5x3xf32> {
+  %0 = "onnx.Einsum"(%arg0, %arg1) {equation = "bji,bkj->bki"} : (tensor<2x4x3xf32>, tensor<2x5x4xf32>) -> tensor<2x5x3xf32>
+  return %0 : tensor<2x5x3xf32>
+// CHECK-LABEL:  func.func @test_einsum_matmul_swap
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x4x3xf32>, [[PARAM_1_:%.+]]: tensor<2x5x4xf32>) -> tensor<2x5x3xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "onnx.MatMul"([[PARAM_1_]], [[PARAM_0_]]) : (tensor<2x5x4xf32>, tensor<2x4x3xf32>) -> tensor<2x5x3xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<2x5x3xf32>
+}
+
+// The contraction over k, whose result is smallest, is done first.
+func.func @test_einsum_chain(%arg0: tensor<8x2xf32>, %arg1: tensor<2x8xf32>, %arg2: tensor<8x3xf32>) -> tensor<8x3xf32> {
+  %0 = "onnx.Einsum"(%arg0, %arg1, %arg2) {equation = "ij,jk,kl->il"} : (tensor<8x2xf32>, tensor<2x8xf32>, tensor<8x3xf32>) -> tensor<8x3xf32>
+  return %0 : tensor<8x3xf32>
+// CHECK-LABEL:  func.func @test_einsum_chain
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<8x2xf32>, [[PARAM_1_:%.+]]: tensor<2x8xf32>, [[PARAM_2_:%.+]]: tensor<8x3xf32>) -> tensor<8x3xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "onnx.MatMul"([[PARAM_1_]], [[PARAM_2_]]) : (tensor<2x8xf32>, tensor<8x3xf32>) -> tensor<2x3xf32>
+// CHECK-NEXT:      [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_0_]]) : (tensor<8x2xf32>, tensor<2x3xf32>) -> tensor<8x3xf32>
+// CHECK-NEXT:      return [[VAR_1_]] : tensor<8x3xf32>
+}
@@ -135,3 +135,32 @@ func.func @test_enable_memory_pool_2(%arg0: memref<10x10xf32>, %arg1: memref<10x
 // CHECK:           return [[RES_]] : memref<10x20xf32>
 // CHECK:         }
 }
+
+// -----
+
+/// The intermediate values allocated in a branch are not allocated in the
+/// memory pool of the function.
+func.func @test_enable_memory_pool_branch(%arg0: memref<10x10xf32>, %arg1: i1) -> memref<10x10xf32> {
+    %0 = memref.alloc() : memref<10x10xf32>
+    scf.if %arg1 {
+      %1 = memref.alloc() : memref<10x10xf32>
+      memref.copy %arg0, %1 : memref<10x10xf32> to memref<10x10xf32>
+      memref.copy %1, %0 : memref<10x10xf32> to memref<10x10xf32>
+      memref.dealloc %1 : memref<10x10xf32>
+    } else {
+      memref.copy %arg0, %0 : memref<10x10xf32> to memref<10x10xf32>
+    }
+    return %0 : memref<10x10xf32>
+
+// CHECK-LABEL:  func @test_enable_memory_pool_branch
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<10x10xf32>, [[PARAM_1_:%.+]]: i1) -> memref<10x10xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() : memref<10x10xf32>
+// CHECK-NOT:       krnl.getref
+// CHECK:           scf.if [[PARAM_1_]] {
+// CHECK:             [[RES_1_:%.+]] = memref.alloc() : memref<10x10xf32>
+// CHECK:             memref.copy [[PARAM_0_]], [[RES_1_]] : memref<10x10xf32> to memref<10x10xf32>
+// CHECK:             memref.copy [[RES_1_]], [[RES_]] : memref<10x10xf32> to memref<10x10xf32>
+// CHECK:             memref.dealloc [[RES_1_]] : memref<10x10xf32>
+// CHECK:           } else {
+// CHECK:           return [[RES_]] : memref<10x10xf32>
+}
@@ -0,0 +1,62 @@
+// RUN: onnx-mlir-opt --fold-broadcast-onnx %s -split-input-file | FileCheck %s
+
+func.func @test_fold_expand_add(%x: tensor<2x4x8x8xf32>, %mask: tensor<2x1x1x8xf32>) -> tensor<2x4x8x8xf32> {
+  %shape = onnx.Constant dense<[2, 4, 8, 8]> : tensor<4xi64>
+  %0 = "onnx.Expand"(%mask, %shape) : (tensor<2x1x1x8xf32>, tensor<4xi64>) -> tensor<2x4x8x8xf32>
+  %1 = "onnx.Add"(%x, %0) : (tensor<2x4x8x8xf32>, tensor<2x4x8x8xf32>) -> tensor<2x4x8x8xf32>
+  return %1 : tensor<2x4x8x8xf32>
+
+// CHECK-LABEL:  func.func @test_fold_expand_add
+// CHECK-SAME:   ([[X_:%.+]]: tensor<2x4x8x8xf32>, [[MASK_:%.+]]: tensor<2x1x1x8xf32>) -> tensor<2x4x8x8xf32> {
+// CHECK-NOT:       "onnx.Expand"
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Add"([[X_]], [[MASK_]]) : (tensor<2x4x8x8xf32>, tensor<2x1x1x8xf32>) -> tensor<2x4x8x8xf32>
+// CHECK:           return [[VAR_0_]] : tensor<2x4x8x8xf32>
+}
+
+// -----
+
+func.func @test_fold_tile_mul(%x: tensor<4x8xf32>, %y: tensor<4x1xf32>) -> tensor<4x8xf32> {
+  %repeats = onnx.Constant dense<[1, 8]> : tensor<2xi64>
+  %0 = "onnx.Tile"(%y, %repeats) : (tensor<4x1xf32>, tensor<2xi64>) -> tensor<4x8xf32>
+  %1 = "onnx.Mul"(%0, %x) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+  return %1 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_fold_tile_mul
+// CHECK-SAME:   ([[X_:%.+]]: tensor<4x8xf32>, [[Y_:%.+]]: tensor<4x1xf32>) -> tensor<4x8xf32> {
+// CHECK-NOT:       "onnx.Tile"
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Mul"([[Y_]], [[X_]]) : (tensor<4x1xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK:           return [[VAR_0_]] : tensor<4x8xf32>
+}
+
+// -----
+
+// The Tile repeats a dim of size 4 and does not broadcast.
+func.func @test_no_fold_tile(%x: tensor<8x8xf32>, %y: tensor<4x1xf32>) -> tensor<8x8xf32> {
+  %repeats = onnx.Constant dense<[2, 8]> : tensor<2xi64>
+  %0 = "onnx.Tile"(%y, %repeats) : (tensor<4x1xf32>, tensor<2xi64>) -> tensor<8x8xf32>
+  %1 = "onnx.Mul"(%0, %x) : (tensor<8x8xf32>, tensor<8x8xf32>) -> tensor<8x8xf32>
+  return %1 : tensor<8x8xf32>
+
+// CHECK-LABEL:  func.func @test_no_fold_tile
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Tile"
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Mul"([[VAR_1_]], {{.*}}) : (tensor<8x8xf32>, tensor<8x8xf32>) -> tensor<8x8xf32>
+}
+
+// -----
+
+// Both operands are expanded: only one of them can be replaced without
+// changing the result shape.
+func.func @test_fold_one_expand(%x: tensor<4x1xf32>, %y: tensor<1x8xf32>) -> tensor<4x8xf32> {
+  %shape = onnx.Constant dense<[4, 8]> : tensor<2xi64>
+  %0 = "onnx.Expand"(%x, %shape) : (tensor<4x1xf32>, tensor<2xi64>) -> tensor<4x8xf32>
+  %1 = "onnx.Expand"(%y, %shape) : (tensor<1x8xf32>, tensor<2xi64>) -> tensor<4x8xf32>
+  %2 = "onnx.Sub"(%0, %1) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+  return %2 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_fold_one_expand
+// CHECK-SAME:   ([[X_:%.+]]: tensor<4x1xf32>, [[Y_:%.+]]: tensor<1x8xf32>) -> tensor<4x8xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<[4, 8]> : tensor<2xi64>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Expand"([[Y_]], [[VAR_0_]]) : (tensor<1x8xf32>, tensor<2xi64>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Sub"([[X_]], [[VAR_1_]]) : (tensor<4x1xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK:           return [[VAR_2_]] : tensor<4x8xf32>
+}
@@ -0,0 +1,63 @@
+// RUN: onnx-mlir-opt --fuse-attention-onnx %s -split-input-file | FileCheck %s
+
+func.func @test_fuse_attention_div_mask(%q: tensor<2x8x128x64xf32>, %k: tensor<2x8x64x128xf32>, %v: tensor<2x8x128x64xf32>, %mask: tensor<2x1x1x128xf32>) -> tensor<2x8x128x64xf32> {
+  %c = onnx.Constant dense<8.000000e+00> : tensor<f32>
+  %0 = "onnx.MatMul"(%q, %k) : (tensor<2x8x128x64xf32>, tensor<2x8x64x128xf32>) -> tensor<2x8x128x128xf32>
+  %1 = "onnx.Div"(%0, %c) : (tensor<2x8x128x128xf32>, tensor<f32>) -> tensor<2x8x128x128xf32>
+  %2 = "onnx.Add"(%1, %mask) : (tensor<2x8x128x128xf32>, tensor<2x1x1x128xf32>) -> tensor<2x8x128x128xf32>
+  %3 = "onnx.Softmax"(%2) {axis = -1 : si64} : (tensor<2x8x128x128xf32>) -> tensor<2x8x128x128xf32>
+  %4 = "onnx.MatMul"(%3, %v) : (tensor<2x8x128x128xf32>, tensor<2x8x128x64xf32>) -> tensor<2x8x128x64xf32>
+  return %4 : tensor<2x8x128x64xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_attention_div_mask
+// CHECK-SAME:   ([[Q_:%.+]]: tensor<2x8x128x64xf32>, [[K_:%.+]]: tensor<2x8x64x128xf32>, [[V_:%.+]]: tensor<2x8x128x64xf32>, [[MASK_:%.+]]: tensor<2x1x1x128xf32>) -> tensor<2x8x128x64xf32> {
+// CHECK:           [[NONE_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedAttention"([[Q_]], [[K_]], [[V_]], [[MASK_]], [[NONE_]], [[NONE_]], [[NONE_]]) {scale = 1.250000e-01 : f32} : (tensor<2x8x128x64xf32>, tensor<2x8x64x128xf32>, tensor<2x8x128x64xf32>, tensor<2x1x1x128xf32>, none, none, none) -> tensor<2x8x128x64xf32>
+// CHECK-NOT:       "onnx.Softmax"
+// CHECK:           return [[VAR_0_]] : tensor<2x8x128x64xf32>
+}
+
+// -----
+
+func.func @test_fuse_attention_mul_no_mask(%q: tensor<?x128x64xf32>, %k: tensor<?x64x?xf32>, %v: tensor<?x?x32xf32>) -> tensor<?x128x32xf32> {
+  %c = onnx.Constant dense<1.250000e-01> : tensor<1xf32>
+  %0 = "onnx.MatMul"(%q, %k) : (tensor<?x128x64xf32>, tensor<?x64x?xf32>) -> tensor<?x128x?xf32>
+  %1 = "onnx.Mul"(%c, %0) : (tensor<1xf32>, tensor<?x128x?xf32>) -> tensor<?x128x?xf32>
+  %2 = "onnx.Softmax"(%1) {axis = 2 : si64} : (tensor<?x128x?xf32>) -> tensor<?x128x?xf32>
+  %3 = "onnx.MatMul"(%2, %v) : (tensor<?x128x?xf32>, tensor<?x?x32xf32>) -> tensor<?x128x32xf32>
+  return %3 : tensor<?x128x32xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_attention_mul_no_mask
+// CHECK-SAME:   ([[Q_:%.+]]: tensor<?x128x64xf32>, [[K_:%.+]]: tensor<?x64x?xf32>, [[V_:%.+]]: tensor<?x?x32xf32>) -> tensor<?x128x32xf32> {
+// CHECK:           [[NONE_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedAttention"([[Q_]], [[K_]], [[V_]], [[NONE_]], [[NONE_]], [[NONE_]], [[NONE_]]) {scale = 1.250000e-01 : f32} : (tensor<?x128x64xf32>, tensor<?x64x?xf32>, tensor<?x?x32xf32>, none, none, none, none) -> tensor<?x128x32xf32>
+// CHECK:           return [[VAR_0_]] : tensor<?x128x32xf32>
+}
+
+// -----
+
+// The scores are used by another op, no fusion.
+func.func @test_fuse_attention_scores_used_twice(%q: tensor<4x16x8xf32>, %k: tensor<4x8x16xf32>, %v: tensor<4x16x8xf32>) -> (tensor<4x16x8xf32>, tensor<4x16x16xf32>) {
+  %0 = "onnx.MatMul"(%q, %k) : (tensor<4x16x8xf32>, tensor<4x8x16xf32>) -> tensor<4x16x16xf32>
+  %1 = "onnx.Softmax"(%0) {axis = -1 : si64} : (tensor<4x16x16xf32>) -> tensor<4x16x16xf32>
+  %2 = "onnx.MatMul"(%1, %v) : (tensor<4x16x16xf32>, tensor<4x16x8xf32>) -> tensor<4x16x8xf32>
+  return %2, %0 : tensor<4x16x8xf32>, tensor<4x16x16xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_attention_scores_used_twice
+// CHECK-NOT:       "onnx.FusedAttention"
+// CHECK:           "onnx.Softmax"
+}
+
+// -----
+
+// The softmax is not along the innermost axis, no fusion.
+func.func @test_fuse_attention_softmax_axis(%q: tensor<4x16x8xf32>, %k: tensor<4x8x16xf32>, %v: tensor<4x16x8xf32>) -> tensor<4x16x8xf32> {
+  %0 = "onnx.MatMul"(%q, %k) : (tensor<4x16x8xf32>, tensor<4x8x16xf32>) -> tensor<4x16x16xf32>
+  %1 = "onnx.Softmax"(%0) {axis = 1 : si64} : (tensor<4x16x16xf32>) -> tensor<4x16x16xf32>
+  %2 = "onnx.MatMul"(%1, %v) : (tensor<4x16x16xf32>, tensor<4x16x8xf32>) -> tensor<4x16x8xf32>
+  return %2 : tensor<4x16x8xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_attention_softmax_axis
+// CHECK-NOT:       "onnx.FusedAttention"
+// CHECK:           "onnx.Softmax"
+}
@@ -0,0 +1,62 @@
+// RUN: onnx-mlir-opt --fuse-conv-activation-onnx %s -split-input-file | FileCheck %s
+
+func.func @test_fuse_conv_relu(%x: tensor<1x3x32x32xf32>, %w: tensor<8x3x3x3xf32>, %b: tensor<8xf32>) -> tensor<1x8x30x30xf32> {
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<1x8x30x30xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<1x8x30x30xf32>) -> tensor<1x8x30x30xf32>
+  return %1 : tensor<1x8x30x30xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_conv_relu
+// CHECK-SAME:   ([[X_:%.+]]: tensor<1x3x32x32xf32>, [[W_:%.+]]: tensor<8x3x3x3xf32>, [[B_:%.+]]: tensor<8xf32>) -> tensor<1x8x30x30xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedConv"([[X_]], [[W_]], [[B_]]) {activation_alpha = [0.000000e+00 : f32], activation_beta = [0.000000e+00 : f32], activations = ["Relu"], auto_pad = "NOTSET", group = 1 : si64, kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<1x8x30x30xf32>
+// CHECK-NOT:       "onnx.Relu"
+// CHECK:           return [[VAR_0_]] : tensor<1x8x30x30xf32>
+}
+
+// -----
+
+func.func @test_fuse_conv_clip(%x: tensor<1x3x32x32xf32>, %w: tensor<8x3x3x3xf32>) -> tensor<1x8x30x30xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %min = onnx.Constant dense<0.000000e+00> : tensor<f32>
+  %max = onnx.Constant dense<6.000000e+00> : tensor<f32>
+  %0 = "onnx.Conv"(%x, %w, %none) {kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, none) -> tensor<1x8x30x30xf32>
+  %1 = "onnx.Clip"(%0, %min, %max) : (tensor<1x8x30x30xf32>, tensor<f32>, tensor<f32>) -> tensor<1x8x30x30xf32>
+  return %1 : tensor<1x8x30x30xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_conv_clip
+// CHECK-SAME:   ([[X_:%.+]]: tensor<1x3x32x32xf32>, [[W_:%.+]]: tensor<8x3x3x3xf32>) -> tensor<1x8x30x30xf32> {
+// CHECK:           [[NONE_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedConv"([[X_]], [[W_]], [[NONE_]]) {activation_alpha = [0.000000e+00 : f32], activation_beta = [6.000000e+00 : f32], activations = ["Clip"], auto_pad = "NOTSET", group = 1 : si64, kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, none) -> tensor<1x8x30x30xf32>
+// CHECK-NOT:       "onnx.Clip"
+// CHECK:           return [[VAR_0_]] : tensor<1x8x30x30xf32>
+}
+
+// -----
+
+func.func @test_fuse_conv_leakyrelu_relu(%x: tensor<1x3x32x32xf32>, %w: tensor<8x3x3x3xf32>, %b: tensor<8xf32>) -> tensor<1x8x30x30xf32> {
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<1x8x30x30xf32>
+  %1 = "onnx.LeakyRelu"(%0) {alpha = 1.250000e-01 : f32} : (tensor<1x8x30x30xf32>) -> tensor<1x8x30x30xf32>
+  %2 = "onnx.Relu"(%1) : (tensor<1x8x30x30xf32>) -> tensor<1x8x30x30xf32>
+  return %2 : tensor<1x8x30x30xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_conv_leakyrelu_relu
+// CHECK-SAME:   ([[X_:%.+]]: tensor<1x3x32x32xf32>, [[W_:%.+]]: tensor<8x3x3x3xf32>, [[B_:%.+]]: tensor<8xf32>) -> tensor<1x8x30x30xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedConv"([[X_]], [[W_]], [[B_]]) {activation_alpha = [1.250000e-01 : f32, 0.000000e+00 : f32], activation_beta = [0.000000e+00 : f32, 0.000000e+00 : f32], activations = ["LeakyRelu", "Relu"], auto_pad = "NOTSET", group = 1 : si64, kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<1x8x30x30xf32>
+// CHECK-NOT:       "onnx.LeakyRelu"
+// CHECK-NOT:       "onnx.Relu"
+// CHECK:           return [[VAR_0_]] : tensor<1x8x30x30xf32>
+}
+
+// -----
+
+// The convolution has another use, no fusion.
+
+func.func @test_fuse_conv_relu_multiple_uses(%x: tensor<1x3x32x32xf32>, %w: tensor<8x3x3x3xf32>, %b: tensor<8xf32>) -> (tensor<1x8x30x30xf32>, tensor<1x8x30x30xf32>) {
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3]} : (tensor<1x3x32x32xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<1x8x30x30xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<1x8x30x30xf32>) -> tensor<1x8x30x30xf32>
+  return %0, %1 : tensor<1x8x30x30xf32>, tensor<1x8x30x30xf32>
+
+// CHECK-LABEL:  func.func @test_fuse_conv_relu_multiple_uses
+// CHECK:           "onnx.Conv"
+// CHECK:           "onnx.Relu"
+// CHECK-NOT:       "onnx.FusedConv"
+}
@@ -0,0 +1,37 @@
+// RUN: onnx-mlir-opt --half-precision-weights %s -split-input-file | FileCheck %s
+// RUN: onnx-mlir-opt --half-precision-weights="weight-type=bf16" %s -split-input-file | FileCheck %s --check-prefix=BF16
+
+func.func @test_matmul_weight(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %0 = onnx.Constant dense<[[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]> : tensor<3x2xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<4x3xf32>, tensor<3x2xf32>) -> tensor<4x2xf32>
+  return %1 : tensor<4x2xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_weight
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<4x3xf32>) -> tensor<4x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}[1.000000e+00, 2.000000e+00], [3.000000e+00, 4.000000e+00], [5.000000e+00, 6.000000e+00]{{.}}> : tensor<3x2xf16>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Cast"([[VAR_0_]]) {to = f32} : (tensor<3x2xf16>) -> tensor<3x2xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_1_]]) : (tensor<4x3xf32>, tensor<3x2xf32>) -> tensor<4x2xf32>
+// CHECK:           return [[VAR_2_]] : tensor<4x2xf32>
+
+// BF16-LABEL:  func.func @test_matmul_weight
+// BF16:           [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}[1.000000e+00, 2.000000e+00], [3.000000e+00, 4.000000e+00], [5.000000e+00, 6.000000e+00]{{.}}> : tensor<3x2xbf16>
+// BF16:           "onnx.Cast"([[VAR_0_]]) {to = f32} : (tensor<3x2xbf16>) -> tensor<3x2xf32>
+}
+
+// -----
+
+// The weights used by other ops than MatMul, or as the A operand of MatMul,
+// are left in f32.
+
+func.func @test_not_matmul_weight(%arg0: tensor<3x3xf32>) -> (tensor<3x3xf32>, tensor<3x3xf32>) {
+  %0 = onnx.Constant dense<1.0> : tensor<3x3xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  %2 = "onnx.Add"(%1, %0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  %3 = onnx.Constant dense<2.0> : tensor<3x3xf32>
+  %4 = "onnx.MatMul"(%3, %arg0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  return %2, %4 : tensor<3x3xf32>, tensor<3x3xf32>
+
+// CHECK-LABEL:  func.func @test_not_matmul_weight
+// CHECK-NOT:       "onnx.Cast"
+// CHECK:           return
+}
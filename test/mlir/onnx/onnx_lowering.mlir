@@ -1851,28 +1851,12 @@ func.func private @test_split_equal(%arg0 : tensor<16x32x64xf32>) -> (tensor<*xf
   %0, %1 = "onnx.Split"(%arg0, %cst) { axis = 0 : si64} : (tensor<16x32x64xf32>, none) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 8)>
   // CHECK-LABEL: @test_split_equal
-  // CHECK:     [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK:     [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK:     [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK:     krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 8,
-  // CHECK-SAME:             [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:       [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) :
-  // CHECK-SAME:    (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:       [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:       krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK:     }
-  // CHECK:     [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK:     krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 8,
-  // CHECK-SAME:             [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:       [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) :
-  // CHECK-SAME:    (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:       [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#0{{.}}
-  // CHECK:       [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:       krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK:     }
-  // CHECK:     return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
+  // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
+  // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
+  // CHECK: "krnl.memcpy"([[RES_0]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: "krnl.memcpy"([[RES_1]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
 }
 
 // -----
@@ -1882,23 +1866,26 @@ func.func private @test_split_variable(%arg0 : tensor<16x32x64xf32>) -> (tensor<
   %0, %1 = "onnx.Split"(%arg0, %split) { axis = 1 : si64} : (tensor<16x32x64xf32>, tensor<2xi64>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 2)>
+  // CHECK-DAG: [[MAP_0_:#.+]] = affine_map<(d0) -> (d0 * 2048)>
+  // CHECK-DAG: [[MAP_1_:#.+]] = affine_map<(d0) -> (d0 * 128)>
+  // CHECK-DAG: [[MAP_2_:#.+]] = affine_map<(d0) -> (d0 * 2048 + 128)>
+  // CHECK-DAG: [[MAP_3_:#.+]] = affine_map<(d0) -> (d0 * 1920)>
   // CHECK-LABEL: @test_split_variable
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<16x2x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<16x30x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 2, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x2x64xf32>
+  // CHECK: [[DEF_LOOP_0:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_0]]) with ([[DEF_LOOP_0]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_0]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_0:%.+]] = affine.apply [[MAP_0_]]([[IV]])
+  // CHECK-DAG:   [[DEST_0:%.+]] = affine.apply [[MAP_1_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_0]], %arg0, {{.*}}, [[DEST_0]], [[SRC_0]]) : (memref<16x2x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 30, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#1{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[INDEX]], [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x30x64xf32>
+  // CHECK: [[DEF_LOOP_1:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_1]]) with ([[DEF_LOOP_1]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_1]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_1:%.+]] = affine.apply [[MAP_2_]]([[IV]])
+  // CHECK-DAG:   [[DEST_1:%.+]] = affine.apply [[MAP_3_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_1]], %arg0, {{.*}}, [[DEST_1]], [[SRC_1]]) : (memref<16x30x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
   // CHECK: return [[RES_0]], [[RES_1]] : memref<16x2x64xf32>, memref<16x30x64xf32>
 }
@@ -1909,24 +1896,11 @@ func.func private @test_splitv11_equal(%arg0 : tensor<16x32x64xf32>) -> (tensor<
   %0, %1 = "onnx.SplitV11"(%arg0) { axis = 0 : si64} : (tensor<16x32x64xf32>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 8)>
   // CHECK-LABEL: @test_splitv11_equal
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 8, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 8, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#0{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK: }
+  // CHECK: "krnl.memcpy"([[RES_0]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: "krnl.memcpy"([[RES_1]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
 }
 
@@ -1936,28 +1910,171 @@ func.func private @test_splitv11_variable(%arg0 : tensor<16x32x64xf32>) -> (tens
   %0, %1 = "onnx.SplitV11"(%arg0) { axis = 1 : si64, split = [2, 30]} : (tensor<16x32x64xf32>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 2)>
+  // CHECK-DAG: [[MAP_0_:#.+]] = affine_map<(d0) -> (d0 * 2048)>
+  // CHECK-DAG: [[MAP_1_:#.+]] = affine_map<(d0) -> (d0 * 128)>
+  // CHECK-DAG: [[MAP_2_:#.+]] = affine_map<(d0) -> (d0 * 2048 + 128)>
+  // CHECK-DAG: [[MAP_3_:#.+]] = affine_map<(d0) -> (d0 * 1920)>
   // CHECK-LABEL: @test_splitv11_variable
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<16x2x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<16x30x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 2, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x2x64xf32>
+  // CHECK: [[DEF_LOOP_0:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_0]]) with ([[DEF_LOOP_0]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_0]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_0:%.+]] = affine.apply [[MAP_0_]]([[IV]])
+  // CHECK-DAG:   [[DEST_0:%.+]] = affine.apply [[MAP_1_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_0]], %arg0, {{.*}}, [[DEST_0]], [[SRC_0]]) : (memref<16x2x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 30, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#1{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[INDEX]], [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x30x64xf32>
+  // CHECK: [[DEF_LOOP_1:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_1]]) with ([[DEF_LOOP_1]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_1]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_1:%.+]] = affine.apply [[MAP_2_]]([[IV]])
+  // CHECK-DAG:   [[DEST_1:%.+]] = affine.apply [[MAP_3_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_1]], %arg0, {{.*}}, [[DEST_1]], [[SRC_1]]) : (memref<16x30x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
   // CHECK: return [[RES_0]], [[RES_1]] : memref<16x2x64xf32>, memref<16x30x64xf32>
 }
 
 // -----
 
+// Slice whole rows with a single memcpy.
+func.func private @test_slice_bulk_copy(%arg0 : tensor<16x128xf32>) -> tensor<*xf32> {
+  %starts = onnx.Constant dense<[2, 0]> : tensor<2xi64>
+  %ends = onnx.Constant dense<[10, 128]> : tensor<2xi64>
+  %axes = "onnx.NoValue"() {value} : () -> none
+  %steps = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Slice"(%arg0, %starts, %ends, %axes, %steps) : (tensor<16x128xf32>, tensor<2xi64>, tensor<2xi64>, none, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_slice_bulk_copy
+  // CHECK: [[RES_:%.+]] = memref.alloc() {{.*}}: memref<8x128xf32>
+  // CHECK-NOT: krnl.iterate
+  // CHECK: "krnl.memcpy"([[RES_]], %arg0, {{.*}}) : (memref<8x128xf32>, memref<16x128xf32>, i64, index, index) -> ()
+  // CHECK: return [[RES_]] : memref<8x128xf32>
+}
+
+// -----
+
+// Pad whole rows: memset the padding, then copy the input with one memcpy.
+func.func private @test_pad_bulk_copy(%arg0 : tensor<4x64xf32>) -> tensor<6x64xf32> {
+  %pads = onnx.Constant dense<[1, 0, 1, 0]> : tensor<4xi64>
+  %value = onnx.Constant dense<0.000000e+00> : tensor<1xf32>
+  %0 = "onnx.Pad"(%arg0, %pads, %value) {mode = "constant"} : (tensor<4x64xf32>, tensor<4xi64>, tensor<1xf32>) -> tensor<6x64xf32>
+  "func.return"(%0) : (tensor<6x64xf32>) -> ()
+
+  // CHECK-LABEL: @test_pad_bulk_copy
+  // CHECK: [[RES_:%.+]] = memref.alloc() {{.*}}: memref<6x64xf32>
+  // CHECK: krnl.memset [[RES_]], {{.*}} : memref<6x64xf32>
+  // CHECK-NOT: krnl.iterate
+  // CHECK: "krnl.memcpy"([[RES_]], %arg0, {{.*}}) : (memref<6x64xf32>, memref<4x64xf32>, i64, index, index) -> ()
+  // CHECK: return [[RES_]] : memref<6x64xf32>
+}
+
+// -----
+
+// Tile rows: one memcpy of the whole input per repetition.
+func.func private @test_tile_bulk_copy(%arg0 : tensor<4x64xf32>) -> tensor<*xf32> {
+  %repeats = onnx.Constant dense<[3, 1]> : tensor<2xi64>
+  %0 = "onnx.Tile"(%arg0, %repeats) : (tensor<4x64xf32>, tensor<2xi64>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_tile_bulk_copy
+  // CHECK: [[RES_:%.+]] = memref.alloc() {{.*}}: memref<12x64xf32>
+  // CHECK: [[LOOP_0_:%.+]]:2 = krnl.define_loops 2
+  // CHECK: krnl.iterate([[LOOP_0_]]#0, [[LOOP_0_]]#1) with ([[LOOP_0_]]#0 -> %arg1 = 0 to 3, [[LOOP_0_]]#1 -> %arg2 = 0 to 1){
+  // CHECK:   "krnl.memcpy"([[RES_]], %arg0, {{.*}}) : (memref<12x64xf32>, memref<4x64xf32>, i64, index, index) -> ()
+  // CHECK: }
+  // CHECK: return [[RES_]] : memref<12x64xf32>
+}
+
+// -----
+
+// Concat in place: the inputs are computed directly into views of the output.
+func.func private @test_concat_in_place(%arg0 : tensor<1x4x64xf32>, %arg1 : tensor<1x2x64xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<1x4x64xf32>) -> tensor<1x4x64xf32>
+  %1 = "onnx.Relu"(%arg1) : (tensor<1x2x64xf32>) -> tensor<1x2x64xf32>
+  %2 = "onnx.Concat"(%0, %1) {axis = 1 : si64} : (tensor<1x4x64xf32>, tensor<1x2x64xf32>) -> tensor<1x6x64xf32>
+  %3 = "onnx.Relu"(%2) : (tensor<1x6x64xf32>) -> tensor<*xf32>
+  "func.return"(%3) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_concat_in_place
+  // CHECK: [[BUF_:%.+]] = memref.alloc() {{.*}}: memref<1536xi8>
+  // CHECK: [[VIEW_0_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<1536xi8> to memref<1x4x64xf32>
+  // CHECK: krnl.iterate
+  // CHECK: krnl.store {{.*}}, [[VIEW_0_]]{{.}}{{.*}}{{.}} : memref<1x4x64xf32>
+  // CHECK: [[VIEW_1_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<1536xi8> to memref<1x2x64xf32>
+  // CHECK: krnl.iterate
+  // CHECK: krnl.store {{.*}}, [[VIEW_1_]]{{.}}{{.*}}{{.}} : memref<1x2x64xf32>
+  // CHECK-NOT: krnl.memcpy
+  // CHECK: [[VIEW_2_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<1536xi8> to memref<1x6x64xf32>
+  // CHECK: krnl.iterate
+  // CHECK: krnl.load [[VIEW_2_]]{{.}}{{.*}}{{.}} : memref<1x6x64xf32>
+}
+
+// -----
+
+// Split along the outermost non-unit axis: the outputs are views of the input.
+func.func private @test_split_views(%arg0 : tensor<1x16x64xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<1x16x64xf32>) -> tensor<1x16x64xf32>
+  %1, %2 = "onnx.SplitV11"(%0) {axis = 1 : si64} : (tensor<1x16x64xf32>) -> (tensor<1x8x64xf32>, tensor<1x8x64xf32>)
+  %3 = "onnx.Add"(%1, %2) : (tensor<1x8x64xf32>, tensor<1x8x64xf32>) -> tensor<*xf32>
+  "func.return"(%3) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_split_views
+  // CHECK: [[BUF_:%.+]] = memref.alloc() {{.*}}: memref<4096xi8>
+  // CHECK: [[VIEW_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<4096xi8> to memref<1x16x64xf32>
+  // CHECK: krnl.store {{.*}}, [[VIEW_]]{{.}}{{.*}}{{.}} : memref<1x16x64xf32>
+  // CHECK: [[VIEW_0_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<4096xi8> to memref<1x8x64xf32>
+  // CHECK: [[CST_2048_:%.+]] = arith.constant 2048 : index
+  // CHECK: [[VIEW_1_:%.+]] = memref.view [[BUF_]]{{.}}[[CST_2048_]]{{.}}[] : memref<4096xi8> to memref<1x8x64xf32>
+  // CHECK-NOT: krnl.memcpy
+  // CHECK-DAG: krnl.load [[VIEW_0_]]{{.}}{{.*}}{{.}} : memref<1x8x64xf32>
+  // CHECK-DAG: krnl.load [[VIEW_1_]]{{.}}{{.*}}{{.}} : memref<1x8x64xf32>
+}
+
+// -----
+
+// Slice of contiguous rows: the output is a view of the data.
+func.func private @test_slice_view(%arg0 : tensor<16x64xf32>) -> tensor<*xf32> {
+  %starts = onnx.Constant dense<[4]> : tensor<1xi64>
+  %ends = onnx.Constant dense<[12]> : tensor<1xi64>
+  %axes = onnx.Constant dense<[0]> : tensor<1xi64>
+  %steps = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Relu"(%arg0) : (tensor<16x64xf32>) -> tensor<16x64xf32>
+  %1 = "onnx.Slice"(%0, %starts, %ends, %axes, %steps) : (tensor<16x64xf32>, tensor<1xi64>, tensor<1xi64>, tensor<1xi64>, none) -> tensor<*xf32>
+  %2 = "onnx.Exp"(%1) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%2) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_slice_view
+  // CHECK: [[BUF_:%.+]] = memref.alloc() {{.*}}: memref<4096xi8>
+  // CHECK: [[VIEW_:%.+]] = memref.view [[BUF_]][{{.*}}][] : memref<4096xi8> to memref<16x64xf32>
+  // CHECK: krnl.store {{.*}}, [[VIEW_]]{{.}}{{.*}}{{.}} : memref<16x64xf32>
+  // CHECK: [[CST_1024_:%.+]] = arith.constant 1024 : index
+  // CHECK: [[SLICE_:%.+]] = memref.view [[BUF_]]{{.}}[[CST_1024_]]{{.}}[] : memref<4096xi8> to memref<8x64xf32>
+  // CHECK: [[RES_:%.+]] = memref.alloc() {{.*}}: memref<8x64xf32>
+  // CHECK: krnl.load [[SLICE_]]{{.}}{{.*}}{{.}} : memref<8x64xf32>
+  // CHECK: return [[RES_]] : memref<8x64xf32>
+}
+
+// -----
+
+// Exp of a dead intermediate is computed in place in its buffer.
+func.func private @test_unary_in_place(%arg0 : tensor<16x64xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<16x64xf32>) -> tensor<*xf32>
+  %1 = "onnx.Exp"(%0) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_unary_in_place
+  // CHECK: [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x64xf32>
+  // CHECK-NOT: memref.alloc
+  // CHECK: krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<16x64xf32>
+  // CHECK: [[LOAD_:%.+]] = krnl.load [[RES_]]{{.}}{{.*}}{{.}} : memref<16x64xf32>
+  // CHECK: [[EXP_:%.+]] = math.exp [[LOAD_]] : f32
+  // CHECK: krnl.store [[EXP_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<16x64xf32>
+  // CHECK: return [[RES_]] : memref<16x64xf32>
+}
+
+// -----
+
 func.func private @cast_lowering_sametype(%arg0: tensor<f32>) -> tensor<f32> {
   %0 = "onnx.Cast"(%arg0) {to = f32} : (tensor<f32>) -> tensor<f32>
   "func.return"(%0) : (tensor<f32>) -> ()
@@ -2826,7 +2943,7 @@ func.func @test_loop(%arg0: tensor<i64>, %arg1: tensor<i1>, %arg2: tensor<?xf32>
 // CHECK-DAG:             [[VAR_15_:%.+]] = builtin.unrealized_conversion_cast [[VAR_13_]] : tensor<?xf32> to memref<?xf32>
 // CHECK-DAG:             [[LOAD_VAR_14_MEM_:%.+]] = krnl.load [[VAR_14_]][] : memref<i1>
 // CHECK:                 krnl.store [[LOAD_VAR_14_MEM_]], [[RES_1_]][] : memref<i1>
-// CHECK:                 "krnl.seqstore"([[VAR_15_]], [[RES_]], [[VAR_8_]]) : (memref<?xf32>, memref<?xmemref<?xf32>>, index) -> ()
+// CHECK:                 "krnl.seqstore"([[VAR_15_]], [[RES_]], [[VAR_8_]]) {copy = 1 : ui1} : (memref<?xf32>, memref<?xmemref<?xf32>>, index) -> ()
 // CHECK:               }) : () -> ()
 // CHECK:             }
 // CHECK:           }
@@ -3082,6 +3199,51 @@ func.func @test_resize2(%arg0 : tensor<3x4xf32>) -> tensor<*xf32> {
 
 // -----
 
+func.func @test_resize_linear_native(%arg0 : tensor<1x2x32x32xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = onnx.Constant dense<[0.000000e+00, 0.000000e+00, 0.000000e+00, 0.000000e+00, 1.000000e+00, 1.000000e+00, 1.000000e+00, 1.000000e+00]> : tensor<8xf32>
+  %1 = onnx.Constant dense<[1.000000e+00, 1.000000e+00, 2.000000e+00, 2.000000e+00]> : tensor<4xf32>
+  %2 = "onnx.Resize"(%arg0, %0, %1, %cst) {mode = "linear"} : (tensor<1x2x32x32xf32>, tensor<8xf32>, tensor<4xf32>, none) -> tensor<*xf32>
+  "func.return"(%2) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_resize_linear_native
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x2x32x32xf32>) -> memref<1x2x64x64xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x2x64x64xf32>
+// CHECK-DAG:       [[VAR_W_INDICES_:%.+]] = "krnl.global"() {{.*}}name = "resize_indices_{{.*}}shape = [64, 2]{{.*}} : () -> memref<64x2xi64>
+// CHECK-DAG:       [[VAR_W_COEFFS_:%.+]] = "krnl.global"() {{.*}}name = "resize_coeffs_{{.*}}shape = [64, 2]{{.*}} : () -> memref<64x2xf32>
+// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1x2x32x64xf32>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.store {{.*}}, [[RES_1_]][{{.*}}] : memref<1x2x32x64xf32>
+// CHECK-DAG:       [[VAR_H_INDICES_:%.+]] = "krnl.global"() {{.*}}name = "resize_indices_{{.*}}shape = [64, 2]{{.*}} : () -> memref<64x2xi64>
+// CHECK-DAG:       [[VAR_H_COEFFS_:%.+]] = "krnl.global"() {{.*}}name = "resize_coeffs_{{.*}}shape = [64, 2]{{.*}} : () -> memref<64x2xf32>
+// CHECK:           krnl.iterate
+// CHECK:             vector.load [[RES_1_]][{{.*}}] : memref<1x2x32x64xf32>, vector<{{.*}}xf32>
+// CHECK:             vector.fma
+// CHECK:             vector.store {{.*}}, [[RES_]][{{.*}}] : memref<1x2x64x64xf32>, vector<{{.*}}xf32>
+// CHECK:           return [[RES_]] : memref<1x2x64x64xf32>
+}
+
+// -----
+
+func.func @test_resize_nearest_integer_scales(%arg0 : tensor<1x2x32x32xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = onnx.Constant dense<[1.000000e+00, 1.000000e+00, 2.000000e+00, 2.000000e+00]> : tensor<4xf32>
+  %1 = "onnx.Resize"(%arg0, %cst, %0, %cst) {mode = "nearest"} : (tensor<1x2x32x32xf32>, none, tensor<4xf32>, none) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_resize_nearest_integer_scales
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x2x32x32xf32>) -> memref<1x2x64x64xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x2x64x64xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 2, {{.*}} = 0 to 32){
+// CHECK:             vector.load [[PARAM_0_]][{{.*}}] : memref<1x2x32x32xf32>, vector<{{.*}}xf32>
+// CHECK:             vector.shuffle
+// CHECK:             vector.store {{.*}}, [[RES_]][{{.*}}] : memref<1x2x64x64xf32>, vector<{{.*}}xf32>
+// CHECK:             vector.shuffle
+// CHECK:             vector.store {{.*}}, [[RES_]][{{.*}}] : memref<1x2x64x64xf32>, vector<{{.*}}xf32>
+// CHECK:             "krnl.memcpy"([[RES_]], [[RES_]], {{.*}}) : (memref<1x2x64x64xf32>, memref<1x2x64x64xf32>, i64, index, index) -> ()
+// CHECK:           return [[RES_]] : memref<1x2x64x64xf32>
+}
+
+// -----
+
 func.func @test_gather_scalar(%arg0: tensor<4xi64>, %arg1: tensor<i64>) -> tensor<i64> {
   %0 = "onnx.Gather"(%arg0, %arg1) {axis = 0 : si64} : (tensor<4xi64>, tensor<i64>) -> tensor<i64>
   return %0 : tensor<i64>
@@ -3111,12 +3273,45 @@ func.func @test_gather_scalar(%arg0: tensor<4xi64>, %arg1: tensor<i64>) -> tenso
 
 // -----
 
+func.func @test_gather_rows(%arg0: tensor<1000x128xf32>, %arg1: tensor<64xi64>) -> tensor<*xf32> {
+  %0 = "onnx.Gather"(%arg0, %arg1) {axis = 0 : si64} : (tensor<1000x128xf32>, tensor<64xi64>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_gather_rows
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1000x128xf32>, [[PARAM_1_:%.+]]: memref<64xi64>) -> memref<64x128xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<64x128xf32>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.prefetch [[PARAM_0_]][{{.*}}] {isWrite = false, localityHint = 3 : i32} : memref<1000x128xf32>
+// CHECK:             "krnl.memcpy"([[RES_]], [[PARAM_0_]], {{.*}}) : (memref<64x128xf32>, memref<1000x128xf32>, i64, index, index) -> ()
+// CHECK:           return [[RES_]] : memref<64x128xf32>
+}
+
+// -----
+
+func.func @test_gather_embedding_bag(%arg0: tensor<1000x128xf32>, %arg1: tensor<16x8xi64>) -> tensor<*xf32> {
+  %axes = onnx.Constant dense<1> : tensor<1xi64>
+  %0 = "onnx.Gather"(%arg0, %arg1) {axis = 0 : si64} : (tensor<1000x128xf32>, tensor<16x8xi64>) -> tensor<*xf32>
+  %1 = "onnx.ReduceSum"(%0, %axes) {keepdims = 0 : si64} : (tensor<*xf32>, tensor<1xi64>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  func @test_gather_embedding_bag
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1000x128xf32>, [[PARAM_1_:%.+]]: memref<16x8xi64>) -> memref<16x128xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x128xf32>
+// CHECK-NOT:       memref<16x8x128xf32>
+// CHECK:           krnl.iterate
+// CHECK:             scf.for {{.*}} iter_args({{.*}}) -> (vector<{{.*}}xf32>)
+// CHECK:               vector.load
+// CHECK:               arith.addf
+// CHECK:             vector.store
+// CHECK:           return [[RES_]] : memref<16x128xf32>
+}
+
+// -----
+
 func.func @test_gather_elements(%arg0: tensor<4xi64>, %arg1: tensor<2xi64>) -> tensor<2xi64> {
   %0 = "onnx.GatherElements"(%arg0, %arg1) : (tensor<4xi64>, tensor<2xi64>) -> tensor<2xi64>
   return %0 : tensor<2xi64>
 // CHECK-LABEL:  @test_gather_elements
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4xi64>, [[PARAM_1:%.+]]: memref<2xi64>) -> memref<2xi64> {
-// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<2xi64>
+// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2xi64>
 // CHECK-DAG:       [[LOOP_0:%.+]] = krnl.define_loops 1
 // CHECK:           krnl.iterate([[LOOP_0]]) with ([[LOOP_0]] -> [[I_0:%.+]] = 0 to 2){
 // CHECK:             [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_0]]) : (!krnl.loop) -> index
@@ -3144,7 +3339,7 @@ func.func @test_gather_nd_1(%arg0 : tensor<2x2xf32>, %arg1 : tensor<2x2xi64>) ->
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<2x2xf32>, [[PARAM_1:%.+]]: memref<2x2xi64>) -> memref<2xf32> {
 // CHECK:           [[RESHAPED_INDICES:%.+]] = memref.reinterpret_cast %arg1 to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x2xi64> to memref<1x2x2xi64>
 // CHECK:           [[RESHAPED_DATA:%.+]] = memref.reinterpret_cast %arg0 to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x2xf32> to memref<1x2x2xf32>
-// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() : memref<2xf32>
+// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2xf32>
 // CHECK-DAG:       [[RES_BUFFER_INDEX:%.+]] = memref.alloca() : memref<index>
 // CHECK-DAG:       [[CST_0_0:%.+]] = arith.constant 0 : index
 // CHECK-DAG:       [[CST_1_0:%.+]] = arith.constant 1 : index
@@ -3178,7 +3373,7 @@ func.func @test_gather_nd_2(%arg0 : tensor<2x2x2xf32>, %arg1 : tensor<2x1x2xi64>
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<2x2x2xf32>, [[PARAM_1:%.+]]: memref<2x1x2xi64>) -> memref<2x1x2xf32> {
 // CHECK-DAG:       [[RESHAPED_INDICES:%.+]] = memref.reinterpret_cast [[PARAM_1]] to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x1x2xi64> to memref<1x2x2xi64>
 // CHECK-DAG:       [[RESHAPED_DATA:%.+]] = memref.reinterpret_cast [[PARAM_0]] to offset: [0], sizes: [1, 2, 2, 2], strides: [8, 4, 2, 1] : memref<2x2x2xf32> to memref<1x2x2x2xf32>
-// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() : memref<4xf32>
+// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<4xf32>
 // CHECK:           [[CST_0_0:%.+]] = arith.constant 0 : index
 // CHECK:           [[CST_1_0:%.+]] = arith.constant 1 : index
 // CHECK:           [[RES_INDEX_BUFFER:%.+]] = memref.alloca() : memref<index>
@@ -3192,19 +3387,13 @@ func.func @test_gather_nd_2(%arg0 : tensor<2x2x2xf32>, %arg1 : tensor<2x1x2xi64>
 // CHECK-DAG:         [[CST_1_1:%.+]] = arith.constant 1 : index
 // CHECK:             [[LOAD_INDEX_2:%.+]] = krnl.load [[RESHAPED_INDICES]]{{.}}[[IV]]#0, [[IV]]#1, [[CST_1_1]]{{.}} : memref<1x2x2xi64>
 // CHECK-DAG:         [[INDEX_2:%.+]] = arith.index_cast [[LOAD_INDEX_2]] : i64 to index
-// CHECK-DAG:         [[CST_0_2:%.+]] = arith.constant 0 : index
+// CHECK-DAG:         [[CST_2_0:%.+]] = arith.constant 2 : index
+// CHECK-DAG:         [[CST_2_1:%.+]] = arith.constant 2 : i64
 // CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:         [[DATA_1:%.+]] = krnl.load [[RESHAPED_DATA]]{{.}}[[IV]]#0, [[INDEX_1]], [[INDEX_2]], [[CST_0_2]]{{.}} : memref<1x2x2x2xf32>
 // CHECK-DAG:         [[RES_INDEX_1:%.+]] = krnl.load [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             krnl.store [[DATA_1]], [[RES_BUFFER]]{{.}}[[RES_INDEX_1]]{{.}} : memref<4xf32>
-// CHECK:             [[PLUS_ONE:%.+]] = arith.addi [[RES_INDEX_1]], [[CST_1_0]] : index
-// CHECK:             krnl.store [[PLUS_ONE]], [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             [[CST_1_2:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[DATA_2:%.+]] = krnl.load [[RESHAPED_DATA]]{{.}}[[IV]]#0, [[INDEX_1]], [[INDEX_2]], [[CST_1_2]]{{.}} : memref<1x2x2x2xf32>
-// CHECK-DAG:         [[RES_INDEX_2:%.+]] = krnl.load [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             krnl.store [[DATA_2]], [[RES_BUFFER]]{{.}}[[RES_INDEX_2]]{{.}} : memref<4xf32>
-// CHECK:             [[PLUS_ONE_1:%.+]] = arith.addi [[RES_INDEX_2]], [[CST_1_0]] : index
-// CHECK:             krnl.store [[PLUS_ONE_1]], [[RES_INDEX_BUFFER]][] : memref<index>
+// CHECK:             "krnl.memcpy"([[RES_BUFFER]], [[PARAM_0]], [[CST_2_1]], [[RES_INDEX_1]], {{.*}}) : (memref<4xf32>, memref<2x2x2xf32>, i64, index, index) -> ()
+// CHECK:             [[PLUS_TWO:%.+]] = arith.addi [[RES_INDEX_1]], [[CST_2_0]] : index
+// CHECK:             krnl.store [[PLUS_TWO]], [[RES_INDEX_BUFFER]][] : memref<index>
 // CHECK:           }
 // CHECK:           [[RES:%.+]] = memref.reinterpret_cast [[RES_BUFFER]] to offset: [0], sizes: [2, 1, 2], strides: [2, 2, 1] : memref<4xf32> to memref<2x1x2xf32>
 // CHECK:           return [[RES]] : memref<2x1x2xf32>
@@ -3244,11 +3433,33 @@ func.func @test_reversesequence_1(%arg0: tensor<10x?xf32>, %arg1: tensor<10xi64>
 
 // -----
 
+// The contiguous elements of each (batch, time) pair are copied at once.
+func.func @test_reversesequence_memcpy(%arg0: tensor<4x8x64xf32>, %arg1: tensor<8xi64>) -> tensor<*xf32> {
+  %0 = "onnx.ReverseSequence"(%arg0, %arg1) {batch_axis = 1 : si64, time_axis = 0 : si64} : (tensor<4x8x64xf32>, tensor<8xi64>) -> tensor<*xf32>
+  return %0 : tensor<*xf32>
+
+// CHECK-LABEL:  func.func @test_reversesequence_memcpy
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x8x64xf32>, [[PARAM_1_:%.+]]: memref<8xi64>) -> memref<4x8x64xf32> {
+// CHECK-DAG:       [[CST_64_:%.+]] = arith.constant 64 : i64
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x8x64xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} -> [[I_0_:%.+]] = 0 to 4, {{.*}} -> [[I_1_:%.+]] = 0 to 8){
+// CHECK:             [[VAR_1_:%.+]]:2 = krnl.get_induction_var_value
+// CHECK:             krnl.load [[PARAM_1_]]{{.}}[[VAR_1_]]#1] : memref<8xi64>
+// CHECK:             arith.select
+// CHECK:             "krnl.memcpy"([[RES_]], [[PARAM_0_]], [[CST_64_]], {{.*}}, {{.*}}) : (memref<4x8x64xf32>, memref<4x8x64xf32>, i64, index, index) -> ()
+// CHECK-NOT:         krnl.store
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<4x8x64xf32>
+// CHECK:         }
+}
+
+// -----
+
 func.func @test_random_normal1() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 1 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal1
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -3263,7 +3474,7 @@ func.func @test_random_normal2() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal2
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -3278,7 +3489,7 @@ func.func @test_random_normal3() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal3
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -3293,7 +3504,7 @@ func.func @test_random_normal_like1(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 1 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like1
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -3307,7 +3518,7 @@ func.func @test_random_normal_like2(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like2
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -3321,7 +3532,7 @@ func.func @test_random_normal_like3(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like3
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -3339,7 +3550,7 @@ func.func @test_random_normal_like4(%arg0: tensor<3x4x?x?xf32>) -> tensor<*xf32>
 // CHECK-DAG:       [[DIM2:%.+]] = memref.dim %arg0, [[C2]] : memref<3x4x?x?xf32>
 // CHECK-DAG:       [[C3:%.+]] = arith.constant 3 : index
 // CHECK-DAG:       [[DIM3:%.+]] = memref.dim %arg0, [[C3]] : memref<3x4x?x?xf32>
-// CHECK-DAG:       [[DYN_ALLOC:%.+]] = memref.alloc([[DIM2]], [[DIM3]]) {alignment = 16 : i64} : memref<3x4x?x?xf32>
+// CHECK-DAG:       [[DYN_ALLOC:%.+]] = memref.alloc([[DIM2]], [[DIM3]]) {alignment = 64 : i64} : memref<3x4x?x?xf32>
 // CHECK-DAG:       [[C12:%.+]] = arith.constant 12 : index
 // CHECK-DAG:       [[C2:%.+]] = arith.constant 2 : index
 // CHECK-DAG:       [[DIM2:%.+]] = memref.dim %arg0, [[C2]] : memref<3x4x?x?xf32>
@@ -3359,7 +3570,7 @@ func.func @test_random_normal_like5(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like5
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -3368,6 +3579,60 @@ func.func @test_random_normal_like5(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
 // CHECK:           return [[ALLOC]] : memref<3x4x5xf32>
 }
 
+// -----
+func.func @test_random_uniform(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
+  %0 = "onnx.RandomUniform"() {shape = [3, 4, 5], dtype = 1 : si64, low = -1.0 : f32, high = 2.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+// CHECK-LABEL:  @test_random_uniform
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[LOW:%.+]] = arith.constant -1.000000e+00 : f64
+// CHECK-DAG:       [[HIGH:%.+]] = arith.constant 2.000000e+00 : f64
+// CHECK-DAG:       [[SEED:%.+]] = arith.constant 2.000000e+00 : f64
+// CHECK:           "krnl.call"([[ALLOC]], [[LOW]], [[HIGH]], [[SEED]]) {funcName = "omTensorRandomUniform"} : (memref<3x4x5xf32>, f64, f64, f64) -> ()
+// CHECK:           return [[ALLOC]] : memref<3x4x5xf32>
+}
+
+// -----
+func.func @test_random_uniform_like(%arg0: tensor<3x?xf32>) -> tensor<*xf64> {
+  %0 = "onnx.RandomUniformLike"(%arg0) {dtype = 11 : si64, seed = 2.0 : f32} : (tensor<3x?xf32>) -> tensor<*xf64>
+  "func.return"(%0) : (tensor<*xf64>) -> ()
+// CHECK-LABEL:  @test_random_uniform_like
+// CHECK-DAG:       [[C1:%.+]] = arith.constant 1 : index
+// CHECK-DAG:       [[DIM1:%.+]] = memref.dim %arg0, [[C1]] : memref<3x?xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc([[DIM1]]) {alignment = 64 : i64} : memref<3x?xf64>
+// CHECK-DAG:       [[LOW:%.+]] = arith.constant 0.000000e+00 : f64
+// CHECK-DAG:       [[HIGH:%.+]] = arith.constant 1.000000e+00 : f64
+// CHECK-DAG:       [[SEED:%.+]] = arith.constant 2.000000e+00 : f64
+// CHECK:           "krnl.call"([[ALLOC]], [[LOW]], [[HIGH]], [[SEED]]) {funcName = "omTensorRandomUniform"} : (memref<3x?xf64>, f64, f64, f64) -> ()
+// CHECK:           return [[ALLOC]] : memref<3x?xf64>
+}
+
+// -----
+func.func @test_bernoulli(%arg0: tensor<3x4xf32>) -> tensor<*xi1> {
+  %0 = "onnx.Bernoulli"(%arg0) {dtype = 9 : si64, seed = 2.0 : f32} : (tensor<3x4xf32>) -> tensor<*xi1>
+  "func.return"(%0) : (tensor<*xi1>) -> ()
+// CHECK-LABEL:  @test_bernoulli
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<3x4xf32>) -> memref<3x4xi1> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4xi1>
+// CHECK-DAG:       [[UNIFORM_:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4xf32>
+// CHECK-DAG:       [[LOW_:%.+]] = arith.constant 0.000000e+00 : f64
+// CHECK-DAG:       [[HIGH_:%.+]] = arith.constant 1.000000e+00 : f64
+// CHECK-DAG:       [[SEED_:%.+]] = arith.constant 2.000000e+00 : f64
+// CHECK:           "krnl.call"([[UNIFORM_]], [[LOW_]], [[HIGH_]], [[SEED_]]) {funcName = "omTensorRandomUniform"} : (memref<3x4xf32>, f64, f64, f64) -> ()
+// CHECK-DAG:       [[TRUE_:%.+]] = arith.constant true
+// CHECK-DAG:       [[FALSE_:%.+]] = arith.constant false
+// CHECK-DAG:       [[LOOP_0_:%.+]]:2 = krnl.define_loops 2
+// CHECK:           krnl.iterate([[LOOP_0_]]#0, [[LOOP_0_]]#1) with ([[LOOP_0_]]#0 -> [[I_0_:%.+]] = 0 to 3, [[LOOP_0_]]#1 -> [[I_1_:%.+]] = 0 to 4){
+// CHECK:             [[IV_:%.+]]:2 = krnl.get_induction_var_value([[LOOP_0_]]#0, [[LOOP_0_]]#1) : (!krnl.loop, !krnl.loop) -> (index, index)
+// CHECK-DAG:         [[PROB_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[IV_]]#0, [[IV_]]#1] : memref<3x4xf32>
+// CHECK-DAG:         [[VAL_:%.+]] = krnl.load [[UNIFORM_]]{{.}}[[IV_]]#0, [[IV_]]#1] : memref<3x4xf32>
+// CHECK:             [[IS_ONE_:%.+]] = arith.cmpf olt, [[VAL_]], [[PROB_]] : f32
+// CHECK:             [[SELECT_:%.+]] = arith.select [[IS_ONE_]], [[TRUE_]], [[FALSE_]] : i1
+// CHECK:             krnl.store [[SELECT_]], [[RES_]]{{.}}[[IV_]]#0, [[IV_]]#1] : memref<3x4xi1>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<3x4xi1>
+}
+
 // -----
 
 func.func @test_scatter_elements1(%arg0: tensor<3x3xf32>, %arg1: tensor<3x2xi64>, %arg2: tensor<3x2xf32>) -> (tensor<*xf32>,tensor<*xf32>) {
@@ -3377,7 +3642,7 @@ func.func @test_scatter_elements1(%arg0: tensor<3x3xf32>, %arg1: tensor<3x2xi64>
 // CHECK-LABEL:  @test_scatter_elements1
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<3x3xf32>, [[PARAM_1:%.+]]: memref<3x2xi64>, [[PARAM_2:%.+]]: memref<3x2xf32>) -> (memref<3x3xf32>, memref<3x3xf32>) {
 // CHECK-DAG:       [[CST_3:%.+]] = arith.constant 3 : index
-// CHECK-DAG:       [[RES1:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x3xf32>
+// CHECK-DAG:       [[RES1:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x3xf32>
 // CHECK-DAG:       [[CST_9:%.+]] = arith.constant 9 : i64
 // CHECK-DAG:       [[CST_0:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES1]], %arg0, [[CST_9]], [[CST_0]], [[CST_0]]) : (memref<3x3xf32>, memref<3x3xf32>, i64, index, index) -> ()
@@ -3396,7 +3661,7 @@ func.func @test_scatter_elements1(%arg0: tensor<3x3xf32>, %arg1: tensor<3x2xi64>
 // CHECK:             krnl.store [[UPDATE_VAL]], [[RES1]]{{.}}[[SEL]], [[IV]]#1{{.}} : memref<3x3xf32>
 // CHECK-NEXT:      }
 //
-// CHECK-DAG:       [[RES2:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x3xf32>
+// CHECK-DAG:       [[RES2:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x3xf32>
 // CHECK-DAG:       [[CST_9_1:%.+]] = arith.constant 9 : i64
 // CHECK-DAG:       [[CST_0_1:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES2]], %arg0, [[CST_9_1]], [[CST_0_1]], [[CST_0_1]]) : (memref<3x3xf32>, memref<3x3xf32>, i64, index, index) -> ()
@@ -3425,26 +3690,53 @@ func.func @test_scatter_nd1(%arg0: tensor<4x4x4xf32>, %arg1: tensor<2x1xi64>, %a
 // CHECK-LABEL:  @test_scatter_nd1
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4x4x4xf32>, [[PARAM_1:%.+]]: memref<2x1xi64>, [[PARAM_2:%.+]]: memref<2x4x4xf32>) -> memref<4x4x4xf32> {
 // CHECK-DAG:       [[CST_4:%.+]] = arith.constant 4 : index
-// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<4x4x4xf32>
+// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<4x4x4xf32>
 // CHECK-DAG:       [[CST_64:%.+]] = arith.constant 64 : i64
 // CHECK-DAG:       [[CST_0:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES]], %arg0, [[CST_64]], [[CST_0]], [[CST_0]]) : (memref<4x4x4xf32>, memref<4x4x4xf32>, i64, index, index) -> ()
-// CHECK:           [[LOOP_0:%.+]]:3 = krnl.define_loops 3
-// CHECK:           krnl.iterate([[LOOP_0]]#0, [[LOOP_0]]#1, [[LOOP_0]]#2) with
-// CHECK-SAME:      ([[LOOP_0]]#0 -> [[I_0:%.+]] = 0 to 2, [[LOOP_0]]#1 -> [[I_1:%.+]] = 0 to 4, [[LOOP_0]]#2 -> [[I_2:%.+]] = 0 to 4){
-// CHECK-DAG:         [[IV:%.+]]:3 = krnl.get_induction_var_value([[LOOP_0]]#0, [[LOOP_0]]#1, [[LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-// CHECK-DAG:         [[CST_0:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:         [[INDEX:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]]#0, [[CST_0]]{{.}} : memref<2x1xi64>
-// CHECK-DAG:         [[UPDATE:%.+]] = krnl.load [[PARAM_2]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<2x4x4xf32>
-// CHECK-DAG:         [[CAST_INDEX:%.+]] = arith.index_cast [[INDEX]] : i64 to index
-// CHECK:             krnl.store [[UPDATE]], [[RES]]{{.}}[[CAST_INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<4x4x4xf32>
+// CHECK-DAG:       [[CST_16:%.+]] = arith.constant 16 : index
+// CHECK-DAG:       [[SLICE_SIZE:%.+]] = arith.index_cast [[CST_16]] : index to i64
+// CHECK-DAG:       [[LOOP_0:%.+]] = krnl.define_loops 1
+// CHECK:           krnl.iterate([[LOOP_0]]) with ([[LOOP_0]] -> [[I_0:%.+]] = 0 to 2){
+// CHECK-DAG:         [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_0]]) : (!krnl.loop) -> index
+// CHECK-DAG:         [[CST_0_1:%.+]] = arith.constant 0 : index
+// CHECK:             [[INDEX:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_0_1]]{{.}} : memref<2x1xi64>
+// CHECK:             [[CAST_INDEX:%.+]] = arith.index_cast [[INDEX]] : i64 to index
+// CHECK:             "krnl.memcpy"([[RES]], [[PARAM_2]], [[SLICE_SIZE]], {{.*}}, {{.*}}) : (memref<4x4x4xf32>, memref<2x4x4xf32>, i64, index, index) -> ()
 // CHECK-NEXT:      }
 // CHECK:           return [[RES]] : memref<4x4x4xf32>
 }
 
 // -----
 
+// COM: Test ScatterND with indices.shape[-1] == rank(data), scattering single
+// COM: elements in place into the result of a previous operation.
+func.func @test_scatter_nd_inplace(%arg0: tensor<4x4xf32>, %arg1: tensor<3x2xi64>, %arg2: tensor<3xf32>) -> tensor<4x4xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+  %1 = "onnx.ScatterND"(%0, %arg1, %arg2) : (tensor<4x4xf32>, tensor<3x2xi64>, tensor<3xf32>) -> tensor<4x4xf32>
+  return %1 : tensor<4x4xf32>
+// CHECK-LABEL:  @test_scatter_nd_inplace
+// CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4x4xf32>, [[PARAM_1:%.+]]: memref<3x2xi64>, [[PARAM_2:%.+]]: memref<3xf32>) -> memref<4x4xf32> {
+// CHECK:           [[RES:%.+]] = memref.alloc() {{.*}} : memref<4x4xf32>
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       "krnl.memcpy"
+// CHECK:           [[LOOP_1:%.+]] = krnl.define_loops 1
+// CHECK:           krnl.iterate([[LOOP_1]]) with ([[LOOP_1]] -> [[I_1:%.+]] = 0 to 3){
+// CHECK-DAG:         [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_1]]) : (!krnl.loop) -> index
+// CHECK-DAG:         [[CST_0:%.+]] = arith.constant 0 : index
+// CHECK:             [[INDEX_0:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_0]]{{.}} : memref<3x2xi64>
+// CHECK-DAG:         [[CAST_INDEX_0:%.+]] = arith.index_cast [[INDEX_0]] : i64 to index
+// CHECK-DAG:         [[CST_1:%.+]] = arith.constant 1 : index
+// CHECK:             [[INDEX_1:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_1]]{{.}} : memref<3x2xi64>
+// CHECK-DAG:         [[CAST_INDEX_1:%.+]] = arith.index_cast [[INDEX_1]] : i64 to index
+// CHECK-DAG:         [[UPDATE:%.+]] = krnl.load [[PARAM_2]]{{.}}[[IV]]{{.}} : memref<3xf32>
+// CHECK:             krnl.store [[UPDATE]], [[RES]]{{.}}[[CAST_INDEX_0]], [[CAST_INDEX_1]]{{.}} : memref<4x4xf32>
+// CHECK-NEXT:      }
+// CHECK:           return [[RES]] : memref<4x4xf32>
+}
+
+// -----
+
 func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3xi64>  {
   %0 = onnx.Constant {value = dense<0> : tensor<1xi64>} : tensor<i64>
   %7 = "onnx.SequenceErase"(%arg0, %0) : (!onnx.Seq<tensor<?x4x5xf32>>, tensor<i64>) -> !onnx.Seq<tensor<?x4x5xf32>>
@@ -3473,7 +3765,7 @@ func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3x
 // CHECK:           krnl.iterate([[LOOP_0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[VAR_8_]]){
 // CHECK:             [[VAR_24_:%.+]] = krnl.get_induction_var_value([[LOOP_0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_PARAM_0_MEM_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[VAR_24_]]{{.}} : memref<?xmemref<?x4x5xf32>>
-// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_]], [[VAR_3_]], [[VAR_8_]]) : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
+// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_]], [[VAR_3_]], [[VAR_24_]]) {copy = 0 : ui1} : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
 // CHECK:           }
 // CHECK:           [[VAR_c1_2_:%.+]] = arith.constant 1 : index
 // CHECK-DAG:       [[VAR_10_:%.+]] = arith.addi [[VAR_8_]], [[VAR_c1_2_]] : index
@@ -3483,7 +3775,7 @@ func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3x
 // CHECK-DAG:         [[LOAD_PARAM_0_MEM_1_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[VAR_24_1_]]{{.}} : memref<?xmemref<?x4x5xf32>>
 // CHECK-DAG:         [[VAR_c1_8_:%.+]] = arith.constant 1 : index
 // CHECK:             [[VAR_26_:%.+]] = arith.subi [[VAR_24_1_]], [[VAR_c1_8_]] : index
-// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_1_]], [[VAR_3_]], [[VAR_26_]]) : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
+// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_1_]], [[VAR_3_]], [[VAR_26_]]) {copy = 0 : ui1} : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
 // CHECK:           }
 // CHECK:           [[VAR_c0_3_:%.+]] = arith.constant 0 : index
 // CHECK-DAG:       [[VAR_12_:%.+]] = memref.dim [[VAR_3_]], [[VAR_c0_3_]] : memref<?xmemref<?x4x5xf32>>
@@ -3591,3 +3883,144 @@ func.func @test_isnan(%arg0 : tensor<2x3x4xf32>) -> tensor<*xi1> {
 // CHECK: {{.*}}store [[ERF]], [[ALLOC]][[[IV]]#0, [[IV]]#1, [[IV]]#2] : memref<2x3x4xi1>
 // CHECK: return [[ALLOC]] : memref<2x3x4xi1>
 }
+
+// -----
+
+//===----------------------------------------------------------------------===//
+/// Test krnl lowering for DFT and STFT.
+//===----------------------------------------------------------------------===//
+func.func @test_dft(%arg0 : tensor<3x8x1xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.DFT"(%arg0, %cst) {onesided = 1 : si64} : (tensor<3x8x1xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_dft
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<3x8x1xf32>) -> memref<3x5x2xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<3x5x2xf32>
+// CHECK-DAG:       [[AXIS_:%.+]] = arith.constant 1 : i64
+// CHECK-DAG:       [[LENGTH_:%.+]] = arith.index_cast {{.*}} : index to i64
+// CHECK-DAG:       [[INVERSE_:%.+]] = arith.constant 0 : i64
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[AXIS_]], [[LENGTH_]], [[INVERSE_]]) {funcName = "omTensorDFT"} : (memref<3x5x2xf32>, memref<3x8x1xf32>, i64, i64, i64) -> ()
+// CHECK:           return [[RES_]] : memref<3x5x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_stft(%arg0 : tensor<2x1000x1xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = onnx.Constant dense<160> : tensor<i64>
+  %1 = onnx.Constant dense<400> : tensor<i64>
+  %2 = "onnx.STFT"(%arg0, %0, %cst, %1) : (tensor<2x1000x1xf32>, tensor<i64>, none, tensor<i64>) -> tensor<*xf32>
+  "func.return"(%2) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_stft
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2x1000x1xf32>) -> memref<2x4x201x2xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x4x201x2xf32>
+// CHECK-DAG:       [[WINDOW_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?xf32>
+// CHECK:           krnl.memset [[WINDOW_]], {{.*}} : memref<?xf32>
+// CHECK:           [[STEP_:%.+]] = arith.index_cast {{.*}} : index to i64
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[WINDOW_]], [[STEP_]]) {funcName = "omTensorSTFT"} : (memref<2x4x201x2xf32>, memref<2x1000x1xf32>, memref<?xf32>, i64) -> ()
+// CHECK:           return [[RES_]] : memref<2x4x201x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Unique computes the unique slices in the runtime, into buffers for as many
+// unique slices as there are slices, which are then copied to the outputs.
+
+func.func @test_unique_axis(%arg0 : tensor<2x4xf32>) -> (tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>) {
+  %Y, %indices, %inverse, %counts = "onnx.Unique"(%arg0) {axis = 1 : si64, sorted = 1 : si64} : (tensor<2x4xf32>) -> (tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>)
+  "func.return"(%Y, %indices, %inverse, %counts) : (tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>) -> ()
+
+// CHECK-LABEL:  func @test_unique_axis
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2x4xf32>) -> (memref<2x?xf32>, memref<?xi64>, memref<4xi64>, memref<?xi64>) {
+// CHECK-DAG:       [[Y_BUF_:%.+]] = memref.alloc() {{.*}}: memref<2x4xf32>
+// CHECK-DAG:       [[INDICES_BUF_:%.+]] = memref.alloc() {{.*}}: memref<4xi64>
+// CHECK-DAG:       [[COUNTS_BUF_:%.+]] = memref.alloc() {{.*}}: memref<4xi64>
+// CHECK-DAG:       [[INVERSE_:%.+]] = memref.alloc() {{.*}}: memref<4xi64>
+// CHECK-DAG:       [[TOTAL_:%.+]] = memref.alloc() {{.*}}: memref<1xi64>
+// CHECK:           "krnl.call"([[TOTAL_]], [[PARAM_0_]], [[Y_BUF_]], [[INDICES_BUF_]], [[INVERSE_]], [[COUNTS_BUF_]], {{.*}}, {{.*}}) {funcName = "omTensorUnique"} : (memref<1xi64>, memref<2x4xf32>, memref<2x4xf32>, memref<4xi64>, memref<4xi64>, memref<4xi64>, i64, i64) -> ()
+// CHECK:           [[NUM_:%.+]] = krnl.load [[TOTAL_]]{{.}}{{.*}}{{.}} : memref<1xi64>
+// CHECK:           [[NUM_UNIQUE_:%.+]] = arith.index_cast [[NUM_]] : i64 to index
+// CHECK:           [[Y_:%.+]] = memref.alloc([[NUM_UNIQUE_]]) {{.*}}: memref<2x?xf32>
+// CHECK:           "krnl.memcpy"([[Y_]], [[Y_BUF_]], {{.*}}) : (memref<2x?xf32>, memref<2x4xf32>, i64, index, index) -> ()
+// CHECK:           [[INDICES_:%.+]] = memref.alloc([[NUM_UNIQUE_]]) {{.*}}: memref<?xi64>
+// CHECK:           "krnl.memcpy"([[INDICES_]], [[INDICES_BUF_]], {{.*}}) : (memref<?xi64>, memref<4xi64>, i64, index, index) -> ()
+// CHECK:           [[COUNTS_:%.+]] = memref.alloc([[NUM_UNIQUE_]]) {{.*}}: memref<?xi64>
+// CHECK:           "krnl.memcpy"([[COUNTS_]], [[COUNTS_BUF_]], {{.*}}) : (memref<?xi64>, memref<4xi64>, i64, index, index) -> ()
+// CHECK:           return [[Y_]], [[INDICES_]], [[INVERSE_]], [[COUNTS_]] : memref<2x?xf32>, memref<?xi64>, memref<4xi64>, memref<?xi64>
+// CHECK:         }
+}
+
+// -----
+
+// The outputs of Unique that are none are not copied.
+
+func.func @test_unique_no_axis(%arg0 : tensor<?x3xi64>) -> tensor<*xi64> {
+  %Y, %indices, %inverse, %counts = "onnx.Unique"(%arg0) {sorted = 0 : si64} : (tensor<?x3xi64>) -> (tensor<*xi64>, none, none, none)
+  "func.return"(%Y) : (tensor<*xi64>) -> ()
+
+// CHECK-LABEL:  func @test_unique_no_axis
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x3xi64>) -> memref<?xi64> {
+// CHECK:           "krnl.call"([[TOTAL_:%.+]], [[PARAM_0_]], [[Y_BUF_:%.+]], {{.*}}) {funcName = "omTensorUnique"} : (memref<1xi64>, memref<?x3xi64>, memref<?xi64>, memref<?xi64>, memref<?xi64>, memref<?xi64>, i64, i64) -> ()
+// CHECK:           [[Y_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?xi64>
+// CHECK:           "krnl.memcpy"([[Y_]], [[Y_BUF_]], {{.*}}) : (memref<?xi64>, memref<?xi64>, i64, index, index) -> ()
+// CHECK-NOT:       krnl.memcpy
+// CHECK:           return [[Y_]] : memref<?xi64>
+// CHECK:         }
+}
+
+// -----
+
+// The dense one-hot tensor is set to the off value, and only the on value of
+// the indices in bounds is stored.
+func.func @test_onehot(%arg0: tensor<4xi64>) -> tensor<*xf32> {
+  %depth = onnx.Constant dense<10> : tensor<i64>
+  %values = onnx.Constant dense<[0.0, 1.0]> : tensor<2xf32>
+  %0 = "onnx.OneHot"(%arg0, %depth, %values) {axis = -1 : si64} : (tensor<4xi64>, tensor<i64>, tensor<2xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_onehot
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x10xf32>
+// CHECK:           krnl.memset [[RES_]], {{.*}} : memref<4x10xf32>
+// CHECK:           krnl.iterate
+// CHECK:             scf.if
+// CHECK:               krnl.store {{.*}}, [[RES_]]{{.*}} : memref<4x10xf32>
+// CHECK-NOT:       krnl.iterate
+// CHECK:           return [[RES_]] : memref<4x10xf32>
+}
+
+// -----
+
+// The results of a memo are loaded from the cache of the runtime on a hit,
+// and computed by its body and stored into the cache otherwise.
+func.func @test_memo(%arg0: tensor<1x?xi64>) -> tensor<1x?xf32> {
+  %0 = "onnx.Memo"(%arg0) ({
+    %1 = "onnx.Cast"(%arg0) {to = f32} : (tensor<1x?xi64>) -> tensor<1x?xf32>
+    %2 = "onnx.Neg"(%1) : (tensor<1x?xf32>) -> tensor<1x?xf32>
+    onnx.Return %2 : tensor<1x?xf32>
+  }) {id = 0 : si64} : (tensor<1x?xi64>) -> tensor<1x?xf32>
+  "func.return"(%0) : (tensor<1x?xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_memo
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x?xi64>) -> memref<1x?xf32> {
+// CHECK:           [[STATE_:%.+]] = memref.alloca() : memref<4xi64>
+// CHECK:           "krnl.call"([[STATE_]], [[PARAM_0_]], {{.*}}, {{.*}}, {{.*}}) {funcName = "omMemoKey"} : (memref<4xi64>, memref<1x?xi64>, i64, i64, i64) -> ()
+// CHECK:           "krnl.call"([[STATE_]], {{.*}}) {funcName = "omMemoLookup"} : (memref<4xi64>, i64) -> ()
+// CHECK:           [[HIT_:%.+]] = krnl.load [[STATE_]]{{.}}{{.*}}{{.}} : memref<4xi64>
+// CHECK:           [[COND_:%.+]] = arith.cmpi eq, [[HIT_]], {{.*}} : i64
+// CHECK:           [[RES_:%.+]] = scf.if [[COND_]] -> (memref<1x?xf32>) {
+// CHECK:             [[CACHED_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<1x?xf32>
+// CHECK:             "krnl.call"([[CACHED_]], [[STATE_]], {{.*}}) {funcName = "omMemoLoad"} : (memref<1x?xf32>, memref<4xi64>, i64) -> ()
+// CHECK:             scf.yield [[CACHED_]] : memref<1x?xf32>
+// CHECK:           } else {
+// CHECK:             krnl.iterate
+// CHECK:             [[COMPUTED_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<1x?xf32>
+// CHECK:             krnl.iterate
+// CHECK:             "krnl.call"([[STATE_]], [[COMPUTED_]], {{.*}}) {funcName = "omMemoStore"} : (memref<4xi64>, memref<1x?xf32>, i64) -> ()
+// CHECK:             scf.yield [[COMPUTED_]] : memref<1x?xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<1x?xf32>
+}
@@ -122,6 +122,36 @@ func.func private @test_add(%arg0 : tensor<10x10xf32>, %arg1 : tensor<10x10xf32>
 // -----
 
 
+func.func private @test_add_bias(%arg0 : tensor<4x8xf32>, %arg1 : tensor<8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_add_bias
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x8xf32>, [[PARAM_1_:%.+]]: memref<8xf32>) -> memref<4x8xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x8xf32>
+// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<4x8xf32>, memref<1xindex>) -> memref<32xf32>
+// CHECK-DAG:       [[VAR_reshape_1_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<4x8xf32>, memref<1xindex>) -> memref<32xf32>
+// CHECK-DAG:       [[VAR_reshape_2_:%.+]] = memref.reshape [[PARAM_1_]]({{.*}}) : (memref<8xf32>, memref<1xindex>) -> memref<8xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           krnl.iterate([[LOOP_0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to 4){
+// CHECK:             [[VAR_1_:%.+]] = krnl.get_induction_var_value([[LOOP_0_]]) : (!krnl.loop) -> index
+// CHECK:             [[LOOP_1_:%.+]] = krnl.define_loops 1
+// CHECK:             [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_1_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:             krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_1_]] -> [[I_1_:%.+]] = 0 to 8){
+// CHECK:               [[VAR_2_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
+// CHECK:               [[VAR_3_:%.+]] = affine.apply {{.*}}
+// CHECK-DAG:           [[LOAD_VAR_reshape_1_MEM_:%.+]] = vector.load [[VAR_reshape_1_]]{{.}}[[VAR_3_]]{{.}} : memref<32xf32>, vector<4xf32>
+// CHECK-DAG:           [[LOAD_VAR_reshape_2_MEM_:%.+]] = vector.load [[VAR_reshape_2_]]{{.}}[[VAR_2_]]{{.}} : memref<8xf32>, vector<4xf32>
+// CHECK:               [[VAR_6_:%.+]] = arith.addf [[LOAD_VAR_reshape_1_MEM_]], [[LOAD_VAR_reshape_2_MEM_]] : vector<4xf32>
+// CHECK:               vector.store [[VAR_6_]], [[VAR_reshape_]]{{.}}[[VAR_3_]]{{.}} : memref<32xf32>, vector<4xf32>
+// CHECK:             }
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<4x8xf32>
+// CHECK:         }
+}
+
+// -----
+
 func.func private @test_mul(%arg0 : tensor<10x10xf32>, %arg1 : tensor<10x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Mul"(%arg0, %arg1) : (tensor<10x10xf32>, tensor<10x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
@@ -360,56 +390,25 @@ func.func private @test_exp(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Exp"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_exp
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.exp [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -420,56 +419,25 @@ func.func private @test_tanh(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Tanh"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_tanh
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.tanh [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -480,50 +448,14 @@ func.func private @test_sinh(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Sinh"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sinh
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -539,7 +471,12 @@ func.func private @test_sinh(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_13_:%.+]] = arith.divf [[VAR_12_]], [[VAR_8_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_13_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -550,50 +487,14 @@ func.func private @test_cosh(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Cosh"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_cosh
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -609,7 +510,12 @@ func.func private @test_cosh(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_13_:%.+]] = arith.divf [[VAR_12_]], [[VAR_8_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_13_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -620,56 +526,25 @@ func.func private @test_cos(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Cos"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_cos
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.cos [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -680,56 +555,25 @@ func.func private @test_sin(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Sin"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sin
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.sin [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -740,56 +584,25 @@ func.func private @test_log(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Log"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_log
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.log [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -800,50 +613,14 @@ func.func private @test_sigmoid(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Sigmoid"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sigmoid
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -858,7 +635,12 @@ func.func private @test_sigmoid(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_12_:%.+]] = arith.divf [[VAR_8_]], [[VAR_11_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_12_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -869,50 +651,14 @@ func.func private @test_relu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Relu"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_relu
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -921,7 +667,12 @@ func.func private @test_relu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_9_:%.+]] = arith.select [[VAR_8_]], [[LOAD_VAR_reshape_MEM_]], [[VAR_7_]] : vector<4xi1>, vector<4xf32>
 // CHECK:             vector.store [[VAR_9_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1145,50 +896,14 @@ func.func private @test_elu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Elu"(%arg0) {alpha=2.0:f32} : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_elu
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -1207,7 +922,12 @@ func.func private @test_elu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_14_:%.+]] = arith.select [[VAR_11_]], [[VAR_13_]], [[LOAD_VAR_reshape_MEM_]] : vector<4xi1>, vector<4xf32>
 // CHECK:             vector.store [[VAR_14_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1218,50 +938,14 @@ func.func private @test_leakyrelu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.LeakyRelu"(%arg0) {alpha=1.0:f32} : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_leakyrelu
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -1275,7 +959,12 @@ func.func private @test_leakyrelu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_11_:%.+]] = arith.select [[VAR_9_]], [[VAR_10_]], [[LOAD_VAR_reshape_MEM_]] : vector<4xi1>, vector<4xf32>
 // CHECK:             vector.store [[VAR_11_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1286,50 +975,14 @@ func.func private @test_selu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Selu"(%arg0) {alpha=1.0:f32, gamma=2.0:f32} : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_selu
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -1349,7 +1002,12 @@ func.func private @test_selu(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_15_:%.+]] = arith.mulf [[VAR_9_]], [[VAR_14_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_15_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1360,50 +1018,14 @@ func.func private @test_hardsigmoid(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.HardSigmoid"(%arg0) {alpha=1.0:f32, beta=2.0:f32} : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_hardsigmoid
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -1426,7 +1048,12 @@ func.func private @test_hardsigmoid(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_16_:%.+]] = arith.select [[VAR_15_]], [[VAR_14_]], [[VAR_8_]] : vector<4xi1>, vector<4xf32>
 // CHECK:             vector.store [[VAR_16_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1437,50 +1064,14 @@ func.func private @test_reciprocal(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Reciprocal"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_reciprocal
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_1_dot_000000_:%.+]] = arith.constant 1.000000e+00 : f32
@@ -1488,7 +1079,12 @@ func.func private @test_reciprocal(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_8_:%.+]] = arith.divf [[VAR_7_]], [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_8_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1499,50 +1095,14 @@ func.func private @test_softplus(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Softplus"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_softplus
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[VAR_7_:%.+]] = math.exp [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
@@ -1552,7 +1112,12 @@ func.func private @test_softplus(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_10_:%.+]] = math.log [[VAR_9_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_10_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1563,50 +1128,14 @@ func.func private @test_softsign(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Softsign"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_softsign
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[VAR_7_:%.+]] = math.absf [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
@@ -1616,7 +1145,12 @@ func.func private @test_softsign(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_10_:%.+]] = arith.divf [[LOAD_VAR_reshape_MEM_]], [[VAR_9_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_10_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -1691,6 +1225,32 @@ func.func private @test_reducemax_v13_negative_inf_i64(%arg0 : tensor<2x3xi64>)
 
 // -----
 
+// The scalar reduction unrolls and jams the loop over the kept rows into the
+// loop over the reduced columns, reducing 4 rows at a time.
+
+func.func private @test_reducemax_v13_unroll_jam_i32(%arg0 : tensor<8x16xi32>) -> tensor<*xi32> {
+  %0 ="onnx.ReduceMaxV13"(%arg0) {axes=[1], keepdims = 0 : si64} : (tensor<8x16xi32>)-> tensor<*xi32>
+  "func.return"(%0) : (tensor<*xi32>) -> ()
+  // CHECK-LABEL: test_reducemax_v13_unroll_jam_i32
+  // CHECK:       [[LOOP_1_:%.+]]:2 = krnl.define_loops 2
+  // CHECK:       krnl.unroll_jam [[LOOP_1_]]#0 4 : !krnl.loop
+  // CHECK:       krnl.iterate([[LOOP_1_]]#0, [[LOOP_1_]]#1) with ([[LOOP_1_]]#0 -> {{.*}} = 0 to 8, [[LOOP_1_]]#1 -> {{.*}} = 0 to 16){
+}
+
+// -----
+
+// Both dims are reduced, the loops are left as is.
+
+func.func private @test_reducemax_v13_no_unroll_jam_i32(%arg0 : tensor<2x8x16xi32>) -> tensor<*xi32> {
+  %0 ="onnx.ReduceMaxV13"(%arg0) {axes=[1, 2], keepdims = 0 : si64} : (tensor<2x8x16xi32>)-> tensor<*xi32>
+  "func.return"(%0) : (tensor<*xi32>) -> ()
+  // CHECK-LABEL: test_reducemax_v13_no_unroll_jam_i32
+  // CHECK-NOT:   krnl.unroll_jam
+  // CHECK:       return
+}
+
+// -----
+
 func.func private @test_reducemin_v13(%arg0 : tensor<3x2x2xf32>) -> tensor<*xf32> {
   %0 ="onnx.ReduceMinV13"(%arg0) {axes=[1], keepdims = 0 : si64} : (tensor<3x2x2xf32>)-> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
@@ -1960,8 +1520,83 @@ func.func @test_reducesum2(%arg0: tensor<3x2x2xf32>, %arg1: tensor<?xi64>) -> te
 // CHECK:             [[VAR_16_:%.+]] = arith.addf [[LOAD_RES_1_MEM_]], [[LOAD_PARAM_0_MEM_]] : f32
 // CHECK:             krnl.store [[VAR_16_]], [[RES_1_]]{{.}}[[VAR_7_1_]], [[VAR_10_1_]], [[VAR_13_]]{{.}} : memref<3x1x2xf32>
 // CHECK:           }
-// CHECK:           return [[RES_1_]] : memref<3x1x2xf32>
-// CHECK:         }
+// CHECK:           return [[RES_1_]] : memref<3x1x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Reductions that keep the innermost dimension combine vectors of input values
+// with vectors of output values.
+
+func.func @test_reducemean_channels_simd(%arg0 : tensor<1x64x8x8xf32>) -> tensor<*xf32> {
+  %0 ="onnx.ReduceMeanV13"(%arg0) {axes=[1], keepdims = 1 : si64} : (tensor<1x64x8x8xf32>)-> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_reducemean_channels_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x64x8x8xf32>) -> memref<1x1x8x8xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x1x8x8xf32>
+// CHECK:           [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[RES_]] to offset: [0], sizes: [64], strides: [1] : memref<1x1x8x8xf32> to memref<64xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 64){
+// CHECK:             vector.store {{.*}}, [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}} : memref<64xf32>, vector<4xf32>
+// CHECK:           }
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 64, {{.*}} = 0 to 8){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 8){
+// CHECK-DAG:           [[LOAD_PARAM_0_:%.+]] = vector.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x64x8x8xf32>, vector<4xf32>
+// CHECK-DAG:           [[LOAD_RES_:%.+]] = vector.load [[RES_]]{{.}}{{.*}}{{.}} : memref<1x1x8x8xf32>, vector<4xf32>
+// CHECK:               [[VAR_ADD_:%.+]] = arith.addf [[LOAD_RES_]], [[LOAD_PARAM_0_]] : vector<4xf32>
+// CHECK:               vector.store [[VAR_ADD_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x1x8x8xf32>, vector<4xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 64){
+// CHECK:             arith.divf {{.*}} : vector<4xf32>
+// CHECK:           return [[RES_]] : memref<1x1x8x8xf32>
+}
+
+// -----
+
+// Full reductions accumulate vectors of the flattened input, whose lanes are
+// combined at the end.
+
+func.func @test_reducesum_full_simd(%arg0 : tensor<1x64x8x8xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 ="onnx.ReduceSum"(%arg0, %cst) {keepdims = 0 : si64} : (tensor<1x64x8x8xf32>, none)-> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_reducesum_full_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x64x8x8xf32>) -> memref<f32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<f32>
+// CHECK:           [[VAR_reinterpret_cast_0_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [4096], strides: [1] : memref<1x64x8x8xf32> to memref<4096xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 4096){
+// CHECK:             vector.load [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}} : memref<4096xf32>, vector<4xf32>
+// CHECK:             arith.addf {{.*}} : vector<4xf32>
+// CHECK:           }
+// CHECK:           vector.reduction <add>, {{.*}} : vector<4xf32> into f32
+// CHECK:           krnl.store {{.*}} : memref<1xf32>
+// CHECK:           return [[RES_]] : memref<f32>
+}
+
+// -----
+
+// Reductions keeping the outermost dims reduce each contiguous row of the
+// input with vectors, whose lanes are combined at the end.
+
+func.func @test_reducemean_rows_simd(%arg0 : tensor<1x64x8x8xf32>) -> tensor<*xf32> {
+  %0 ="onnx.ReduceMeanV13"(%arg0) {axes=[2, 3], keepdims = 1 : si64} : (tensor<1x64x8x8xf32>)-> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_reducemean_rows_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x64x8x8xf32>) -> memref<1x64x1x1xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x64x1x1xf32>
+// CHECK:           [[VAR_reinterpret_cast_0_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [4096], strides: [1] : memref<1x64x8x8xf32> to memref<4096xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 64){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 64){
+// CHECK:               vector.load [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}} : memref<4096xf32>, vector<4xf32>
+// CHECK:               arith.addf {{.*}} : vector<4xf32>
+// CHECK:             }
+// CHECK:             vector.reduction <add>, {{.*}} : vector<4xf32> into f32
+// CHECK:           }
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 64){
+// CHECK:             arith.divf {{.*}} : vector<4xf32>
+// CHECK:           return [[RES_]] : memref<1x64x1x1xf32>
 }
 
 // -----
@@ -1971,56 +1606,25 @@ func.func private @test_sqrt(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Sqrt"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sqrt
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.sqrt [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -2189,50 +1793,14 @@ func.func private @test_sign_f(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Sign"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sign_f
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK-DAG:         [[CST_0_dot_000000_:%.+]] = arith.constant 0.000000e+00 : f32
@@ -2251,7 +1819,12 @@ func.func private @test_sign_f(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
 // CHECK:             [[VAR_13_:%.+]] = arith.select [[VAR_12_]], [[VAR_7_]], [[VAR_11_]] : vector<4xi1>, vector<4xf32>
 // CHECK:             vector.store [[VAR_13_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -2262,50 +1835,14 @@ func.func private @test_sign_i(%arg0 : tensor<?x10xi32>) -> tensor<*xi32> {
   %0 = "onnx.Sign"(%arg0) : (tensor<?x10xi32>) -> tensor<*xi32>
   "func.return"(%0) : (tensor<*xi32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_sign_i
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xi32>) -> memref<?x10xi32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xi32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xi32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xi32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xi32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK-DAG:         [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xi32>, vector<4xi32>
 // CHECK-DAG:         [[CST_0_6_:%.+]] = arith.constant 0 : i32
@@ -2324,7 +1861,12 @@ func.func private @test_sign_i(%arg0 : tensor<?x10xi32>) -> tensor<*xi32> {
 // CHECK:             [[VAR_13_:%.+]] = arith.select [[VAR_12_]], [[VAR_7_]], [[VAR_11_]] : vector<4xi1>, vector<4xi32>
 // CHECK:             vector.store [[VAR_13_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xi32>, vector<4xi32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xi32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xi32>, vector<4xi1>, vector<4xi32> into vector<4xi32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xi32>, vector<4xi1>, vector<4xi32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xi32>
 // CHECK:         }
 }
 
@@ -2421,56 +1963,25 @@ func.func private @test_abs_float(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Abs"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_abs_float
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.absf [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -2481,56 +1992,25 @@ func.func private @test_abs_int(%arg0 : tensor<?x10xi32>) -> tensor<*xi32> {
   %0 = "onnx.Abs"(%arg0) : (tensor<?x10xi32>) -> tensor<*xi32>
   "func.return"(%0) : (tensor<*xi32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_abs_int
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xi32>) -> memref<?x10xi32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xi32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xi32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xi32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xi32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xi32>, memref<1xindex>) -> memref<?xi32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xi32>, vector<4xi32>
 // CHECK:             [[VAR_7_:%.+]] = math.absi [[LOAD_VAR_reshape_MEM_]] : vector<4xi32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xi32>, vector<4xi32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xi32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xi32>, vector<4xi1>, vector<4xi32> into vector<4xi32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xi32>, vector<4xi1>, vector<4xi32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xi32>
 // CHECK:         }
 }
 
@@ -2546,200 +2026,99 @@ func.func private @test_constant_dense_2d_value(%arg0: tensor<1xf32>) -> tensor<
 
 // -----
 
-func.func private @test_pool_general_computation(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
-  %0 = "onnx.AveragePool"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
-  "func.return"(%0) : (tensor<*xf32>) -> ()
-
-  // CHECK-DAG: #{{.*}} = affine_map<(d0) -> (0, d0)>
-  // CHECK-DAG: #{{.*}} = affine_map<(d0) -> (32, d0 + 2)>
-  // CHECK-DAG: #{{.*}} = affine_map<(d0, d1) -> (0, d1)>
-  // CHECK-DAG: #{{.*}} = affine_map<(d0, d1) -> (32, d1 + 2)>
-  // CHECK-DAG: #[[BOUND:.+]] = affine_map<(d0)[s0, s1, s2, s3, s4] -> (s0 - ((s2 ceildiv s4) * s4 - s2), -(d0 * s3 - s2) + s0, d0 * s3 + (s1 - 1) * s4 - s2 - ((s2 ceildiv s4) * s4 - s2) + 1, d0 * s3 + (s1 - 1) * s4 - s2 - (d0 * s3 - s2) + 1)>
-
-  // CHECK-LABEL: @test_pool_general_computation
+// Pooling windows whose taps are all in the image are computed VL output
+// columns at a time, and the columns reaching into the padding, or past the
+// last full block, one at a time.
 
-  // CHECK: [[RES:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
-  // CHECK: [[IDENTITY:%.+]] = arith.constant 0.000000e+00 : f32
-
-  // CHECK: [[REDUCTION_VAL:%.+]] = memref.alloca() : memref<f32>
-  // CHECK: [[OUTPUT_LOOPS:%.+]]:4 = krnl.define_loops 4
-  // CHECK: krnl.iterate([[OUTPUT_LOOPS]]#0, [[OUTPUT_LOOPS]]#1, [[OUTPUT_LOOPS]]#2, [[OUTPUT_LOOPS]]#3) with ([[OUTPUT_LOOPS]]#0 -> %arg1 = 0 to 1, [[OUTPUT_LOOPS]]#1 -> %arg2 = 0 to 3, [[OUTPUT_LOOPS]]#2 -> %arg3 = 0 to 31, [[OUTPUT_LOOPS]]#3 -> %arg4 = 0 to 31){
-  // CHECK:   [[IV:%.+]]:4 = krnl.get_induction_var_value([[OUTPUT_LOOPS]]#0, [[OUTPUT_LOOPS]]#1, [[OUTPUT_LOOPS]]#2, [[OUTPUT_LOOPS]]#3) : (!krnl.loop, !krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index, index)
-
-  // CHECK:   krnl.store [[IDENTITY]], [[REDUCTION_VAL]][] : memref<f32>
-
-  // CHECK:   [[POOL_LOOPS:%.+]]:2 = krnl.define_loops 2
-  // CHECK:   krnl.iterate([[POOL_LOOPS]]#0, [[POOL_LOOPS]]#1) with ([[POOL_LOOPS]]#0 -> %arg5 = 0 to min #[[BOUND]]([[IV]]#2)[{{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}], [[POOL_LOOPS]]#1 -> %arg6 = 0 to min #[[BOUND]]([[IV]]#3)[{{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}]){
-  // CHECK:     {{.*}} = krnl.load %arg0[[[IV]]#0, [[IV]]#1, {{.*}}, {{.*}}] : memref<1x3x32x32xf32>
-  // CHECK:     {{.*}} = krnl.load [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:     krnl.store {{.*}}, [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:   }
-
-  // CHECK:   [[LOAD_REDUCTION:%.+]] = krnl.load [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:   krnl.store [[LOAD_REDUCTION]], [[RES]][[[IV]]#0, [[IV]]#1, [[IV]]#2, [[IV]]#3] : memref<1x3x31x31xf32>
-  // CHECK: }
-}
-
-// -----
-
-func.func private @test_averagepool_identity_value(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
+func.func private @test_averagepool_simd(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
   %0 = "onnx.AveragePool"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-  // CHECK-LABEL: @test_averagepool_identity_value
-  // CHECK: [[RES:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
-  // CHECK: [[IDENTITY:%.+]] = arith.constant 0.000000e+00 : f32
-  // CHECK: [[REDUCTION_VAL:%.+]] = memref.alloca() : memref<f32>
-  // CHECK: krnl.store [[IDENTITY]], [[REDUCTION_VAL]][] : memref<f32>
+// CHECK-LABEL:  func.func private @test_averagepool_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x3x32x32xf32>) -> memref<1x3x31x31xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
+// CHECK-NOT:       memref.alloca
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 3){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 31){
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 28){
+// CHECK-COUNT-4:         vector.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x3x32x32xf32>, vector<4xf32>
+// CHECK:                 arith.divf {{.*}} : vector<4xf32>
+// CHECK:                 vector.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x3x31x31xf32>, vector<4xf32>
+// CHECK:               }
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 28 to 31){
+// CHECK-COUNT-4:         krnl.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x3x32x32xf32>
+// CHECK:                 arith.divf {{.*}} : f32
+// CHECK:                 krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x3x31x31xf32>
+// CHECK:           return [[RES_]] : memref<1x3x31x31xf32>
 }
 
 // -----
 
-func.func private @test_maxpool_identity_value(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
-  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
+func.func private @test_maxpool_simd_pads_strides(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [3, 3], pads = [1, 1, 1, 1], strides = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-  // CHECK-LABEL: @test_maxpool_identity_value
-  // CHECK: [[RES:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
-  // CHECK: [[IDENTITY:%.+]] = arith.constant 0xFF800000 : f32
-  // CHECK: [[REDUCTION_VAL:%.+]] = memref.alloca() : memref<f32>
-  // CHECK: krnl.store [[IDENTITY]], [[REDUCTION_VAL]][] : memref<f32>
+// CHECK-LABEL:  func.func private @test_maxpool_simd_pads_strides
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x3x32x32xf32>) -> memref<1x3x16x16xf32> {
+// CHECK-DAG:       [[IDENTITY_:%.+]] = arith.constant 0xFF800000 : f32
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x3x16x16xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 3){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 16){
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 1){
+// CHECK:                 krnl.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x3x32x32xf32>
+// CHECK:                 arith.select {{.*}}, [[IDENTITY_]] : f32
+// CHECK:                 arith.cmpf ogt, {{.*}} : f32
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 1 to 13){
+// CHECK:                 vector.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x3x32x32xf32>, vector<8xf32>
+// CHECK:                 arith.select {{.*}} : vector<8xf32>
+// CHECK:                 vector.shuffle {{.*}} [0, 2, 4, 6] : vector<8xf32>, vector<8xf32>
+// CHECK:                 arith.cmpf ogt, {{.*}} : vector<4xf32>
+// CHECK:                 vector.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x3x16x16xf32>, vector<4xf32>
+// CHECK:               }
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 13 to 16){
+// CHECK:           return [[RES_]] : memref<1x3x16x16xf32>
 }
 
 // -----
 
-func.func private @test_averagepool_pooling_operation(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
-  %0 = "onnx.AveragePool"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
-  "func.return"(%0) : (tensor<*xf32>) -> ()
-
-  // CHECK-LABEL: @test_averagepool_pooling_operation
-  // CHECK: [[RES:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
+// Dilated pooling windows are not computed with SIMD code.
 
-  // CHECK: [[REDUCTION_VAL:%.+]] = memref.alloca() : memref<f32>
-  // CHECK: [[OUTPUT_LOOPS:%.+]]:4 = krnl.define_loops 4
-  // CHECK: krnl.iterate([[OUTPUT_LOOPS]]#0, [[OUTPUT_LOOPS]]#1, [[OUTPUT_LOOPS]]#2, [[OUTPUT_LOOPS]]#3) with ([[OUTPUT_LOOPS]]#0 -> %arg1 = 0 to 1, [[OUTPUT_LOOPS]]#1 -> %arg2 = 0 to 3, [[OUTPUT_LOOPS]]#2 -> %arg3 = 0 to 31, [[OUTPUT_LOOPS]]#3 -> %arg4 = 0 to 31){
-  // CHECK:   [[IV:%.+]]:4 = krnl.get_induction_var_value([[OUTPUT_LOOPS]]#0, [[OUTPUT_LOOPS]]#1, [[OUTPUT_LOOPS]]#2, [[OUTPUT_LOOPS]]#3) : (!krnl.loop, !krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index, index)
-
-  // CHECK:   krnl.store {{.*}}, [[REDUCTION_VAL]][] : memref<f32>
-
-  // CHECK:   [[POOL_LOOPS:%.+]]:2 = krnl.define_loops 2
-  // CHECK:   krnl.iterate([[POOL_LOOPS]]#0, [[POOL_LOOPS]]#1) with ([[POOL_LOOPS]]#0 -> %arg5 = 0 to min #{{.*}}([[IV]]#2)[{{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}], [[POOL_LOOPS]]#1 -> %arg6 = 0 to min #{{.*}}([[IV]]#3)[{{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}]){
-
-  // CHECK:     [[INPUT_LOAD:%.+]] = krnl.load %arg0[[[IV]]#0, [[IV]]#1, {{.*}}, {{.*}}] : memref<1x3x32x32xf32>
-  // CHECK:     [[OUTPUT_LOAD:%.+]] = krnl.load [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:     [[SUM:%.+]] = arith.addf [[OUTPUT_LOAD]], [[INPUT_LOAD]] : f32
-  // CHECK:     krnl.store [[SUM]], [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:   }
-  // CHECK:   [[LOAD_REDUCTION:%.+]] = krnl.load [[REDUCTION_VAL]][] : memref<f32>
-  // CHECK:   krnl.store [[LOAD_REDUCTION]], [[RES]][[[IV]]#0, [[IV]]#1, [[IV]]#2, [[IV]]#3] : memref<1x3x31x31xf32>
+func.func private @test_maxpool_dilated_no_simd(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2], dilations = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
 
-  // CHECK:   [[NUMERATOR:%.+]] = krnl.load [[RES]][[[IV]]#0, [[IV]]#1, [[IV]]#2, [[IV]]#3] : memref<1x3x31x31xf32>
-  // CHECK:   [[AVERAGE:%.+]] = arith.divf [[NUMERATOR]], {{.*}} : f32
-  // CHECK:   krnl.store [[AVERAGE]], [[RES]][[[IV]]#0, [[IV]]#1, [[IV]]#2, [[IV]]#3] : memref<1x3x31x31xf32>
-  // CHECK: }
+// CHECK-LABEL:  func.func private @test_maxpool_dilated_no_simd
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x3x30x30xf32>
+// CHECK:           [[RES_1_:%.+]] = memref.alloca() : memref<f32>
+// CHECK:           [[LOOP_0_:%.+]]:4 = krnl.define_loops 4
+// CHECK-NOT:       vector.load
+// CHECK:           return [[RES_]] : memref<1x3x30x30xf32>
 }
 
 // -----
 
-func.func private @test_maxpool_pooling_operation(%arg0 : tensor<1x3x32x32xf32>) -> tensor<*xf32> {
-  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2]} : (tensor<1x3x32x32xf32>) -> tensor<*xf32>
+// The scalar code pools blocks of 4 channels together, the loop over the
+// channels of a block being unrolled and jammed into the pooling loops.
+
+func.func private @test_maxpool_dilated_channel_block(%arg0 : tensor<1x8x32x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [2, 2], dilations = [2, 2]} : (tensor<1x8x32x32xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<(d0) -> (d0 + 1)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<(d0) -> (d0 + 2)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<(d0) -> (0, d0)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0) -> (32, d0 + 2)>
-// CHECK-DAG:   [[MAP_4_:#.+]] = affine_map<(d0, d1) -> (d1 + 1)>
-// CHECK-DAG:   [[MAP_5_:#.+]] = affine_map<(d0, d1) -> (d1 + 2)>
-// CHECK-DAG:   [[MAP_6_:#.+]] = affine_map<(d0, d1) -> (0, d1)>
-// CHECK-DAG:   [[MAP_7_:#.+]] = affine_map<(d0, d1) -> (32, d1 + 2)>
-// CHECK-DAG:   [[MAP_8_:#.+]] = affine_map<(d0)[s0, s1, s2, s3, s4] -> (s0 - ((s2 ceildiv s4) * s4 - s2), -(d0 * s3 - s2) + s0, d0 * s3 + (s1 - 1) * s4 - s2 - ((s2 ceildiv s4) * s4 - s2) + 1, d0 * s3 + (s1 - 1) * s4 - s2 - (d0 * s3 - s2) + 1)>
-// CHECK-LABEL:  func.func private @test_maxpool_pooling_operation
-// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x3x32x32xf32>) -> memref<1x3x31x31xf32> {
-// CHECK-DAG:       [[CST_2_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:       [[CST_2_1_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:       [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_3_:%.+]] = arith.constant 3 : index
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_32_:%.+]] = arith.constant 32 : index
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_1_3_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_1_4_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_2_2_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:       [[CST_30_:%.+]] = arith.constant 30 : index
-// CHECK-DAG:       [[CST_31_:%.+]] = arith.constant 31 : index
-// CHECK-DAG:       [[CST_32_1_:%.+]] = arith.constant 32 : index
-// CHECK-DAG:       [[CST_1_5_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_1_6_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_1_7_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_2_3_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:       [[CST_30_1_:%.+]] = arith.constant 30 : index
-// CHECK-DAG:       [[CST_31_1_:%.+]] = arith.constant 31 : index
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x3x31x31xf32>
-// CHECK-DAG:       [[CST_0_5_:%.+]] = arith.constant 0xFF800000 : f32
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloca() : memref<f32>
-// CHECK-DAG:       [[LOOP_0_:%.+]]:4 = krnl.define_loops 4
-// CHECK-DAG:       [[CST_0_6_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[CST_1_8_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_3_1_:%.+]] = arith.constant 3 : index
-// CHECK-DAG:       [[CST_31_2_:%.+]] = arith.constant 31 : index
-// CHECK-DAG:       [[CST_31_3_:%.+]] = arith.constant 31 : index
-// CHECK:           krnl.iterate([[LOOP_0_]]#0, [[LOOP_0_]]#1, [[LOOP_0_]]#2, [[LOOP_0_]]#3) with ([[LOOP_0_]]#0 -> [[I_0_:%.+]] = 0 to 1, [[LOOP_0_]]#1 -> [[I_1_:%.+]] = 0 to 3, [[LOOP_0_]]#2 -> [[I_2_:%.+]] = 0 to 31, [[LOOP_0_]]#3 -> [[I_3_:%.+]] = 0 to 31){
-// CHECK:             [[VAR_1_:%.+]]:4 = krnl.get_induction_var_value([[LOOP_0_]]#0, [[LOOP_0_]]#1, [[LOOP_0_]]#2, [[LOOP_0_]]#3) : (!krnl.loop, !krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index, index)
-// CHECK:             krnl.store [[CST_0_5_]], [[RES_1_]][] : memref<f32>
-// CHECK-DAG:         [[CST_32_2_:%.+]] = arith.constant 32 : index
-// CHECK-DAG:         [[CST_2_4_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:         [[CST_0_7_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:         [[CST_1_9_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_1_10_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_32_3_:%.+]] = arith.constant 32 : index
-// CHECK-DAG:         [[CST_2_5_:%.+]] = arith.constant 2 : index
-// CHECK-DAG:         [[CST_0_8_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:         [[CST_1_11_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_1_12_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_1_13_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_1_14_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[VAR_2_:%.+]] = affine.apply [[MAP_0_]]([[VAR_1_]]#2)
-// CHECK-DAG:         [[CST_1_15_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[VAR_3_:%.+]] = affine.apply [[MAP_1_]]([[VAR_1_]]#2)
-// CHECK-DAG:         [[VAR_4_:%.+]] = affine.max [[MAP_2_]]([[VAR_1_]]#2)
-// CHECK-DAG:         [[VAR_5_:%.+]] = affine.min [[MAP_3_]]([[VAR_1_]]#2)
-// CHECK-DAG:         [[CST_0_9_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:         [[VAR_6_:%.+]] = affine.min [[MAP_2_]]([[VAR_1_]]#2)
-// CHECK-DAG:         [[CST_1_16_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[CST_1_17_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[VAR_7_:%.+]] = affine.apply [[MAP_4_]]([[VAR_1_]]#2, [[VAR_1_]]#3)
-// CHECK-DAG:         [[CST_1_18_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[VAR_8_:%.+]] = affine.apply [[MAP_5_]]([[VAR_1_]]#2, [[VAR_1_]]#3)
-// CHECK-DAG:         [[VAR_9_:%.+]] = affine.max [[MAP_6_]]([[VAR_1_]]#2, [[VAR_1_]]#3)
-// CHECK-DAG:         [[VAR_10_:%.+]] = affine.min [[MAP_7_]]([[VAR_1_]]#2, [[VAR_1_]]#3)
-// CHECK-DAG:         [[CST_0_10_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:         [[VAR_11_:%.+]] = affine.min [[MAP_6_]]([[VAR_1_]]#2, [[VAR_1_]]#3)
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:         [[VAR_12_:%.+]] = arith.subi [[VAR_5_]], [[VAR_4_]] : index
-// CHECK-DAG:         [[VAR_13_:%.+]] = arith.subi [[VAR_10_]], [[VAR_9_]] : index
-// CHECK-DAG:         [[LOOP_1_:%.+]]:2 = krnl.define_loops 2
-// CHECK:             krnl.iterate([[LOOP_1_]]#0, [[LOOP_1_]]#1) with ([[LOOP_1_]]#0 -> [[I_4_:%.+]] = 0 to min [[MAP_8_]]([[VAR_1_]]#2){{.}}[[CST_32_2_]], [[CST_2_4_]], [[CST_0_7_]], [[CST_1_9_]], [[CST_1_10_]]{{.}}, [[LOOP_1_]]#1 -> [[I_5_:%.+]] = 0 to min [[MAP_8_]]([[VAR_1_]]#3){{.}}[[CST_32_3_]], [[CST_2_5_]], [[CST_0_8_]], [[CST_1_11_]], [[CST_1_12_]]{{.}}){
-// CHECK-DAG:           [[VAR_16_:%.+]] = arith.addi [[I_4_]], [[VAR_4_]] : index
-// CHECK-DAG:           [[VAR_17_:%.+]] = arith.addi [[I_5_]], [[VAR_9_]] : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:           [[LOAD_PARAM_0_MEM_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[VAR_1_]]#0, [[VAR_1_]]#1, [[VAR_1_]]6, [[VAR_1_]]7] : memref<1x3x32x32xf32>
-// CHECK-DAG:           [[LOAD_RES_1_MEM_:%.+]] = krnl.load [[RES_1_]][] : memref<f32>
-// CHECK:               [[VAR_20_:%.+]] = arith.cmpf ogt, [[LOAD_RES_1_MEM_]], [[LOAD_PARAM_0_MEM_]] : f32
-// CHECK:               [[VAR_21_:%.+]] = arith.select [[VAR_20_]], [[LOAD_RES_1_MEM_]], [[LOAD_PARAM_0_MEM_]] : f32
-// CHECK:               krnl.store [[VAR_21_]], [[RES_1_]][] : memref<f32>
-// CHECK:             }
-// CHECK:             [[LOAD_RES_1_MEM_1_:%.+]] = krnl.load [[RES_1_]][] : memref<f32>
-// CHECK:             krnl.store [[LOAD_RES_1_MEM_1_]], [[RES_]]{{.}}[[VAR_1_]]#0, [[VAR_1_]]#1, [[VAR_1_]]#2, [[VAR_1_]]#3] : memref<1x3x31x31xf32>
-// CHECK:           }
-// CHECK:           return [[RES_]] : memref<1x3x31x31xf32>
-// CHECK:         }
+// CHECK-LABEL:  func.func private @test_maxpool_dilated_channel_block
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x8x30x30xf32>
+// CHECK:           [[RES_1_:%.+]] = memref.alloca() : memref<4xf32>
+// CHECK:           [[LOOP_0_:%.+]]:4 = krnl.define_loops 4
+// CHECK:           krnl.iterate([[LOOP_0_]]#0, [[LOOP_0_]]#1, [[LOOP_0_]]#2, [[LOOP_0_]]#3) with ([[LOOP_0_]]#0 -> {{.*}} = 0 to 1, [[LOOP_0_]]#1 -> {{.*}} = 0 to 2, [[LOOP_0_]]#2 -> {{.*}} = 0 to 30, [[LOOP_0_]]#3 -> {{.*}} = 0 to 30){
+// CHECK:             [[LOOP_1_:%.+]] = krnl.define_loops 1
+// CHECK:             krnl.unroll_jam [[LOOP_1_]] 4 : !krnl.loop
+// CHECK:             krnl.iterate([[LOOP_1_]]) with ([[LOOP_1_]] -> [[I_:%.+]] = 0 to 4){
+// CHECK:               krnl.store {{.*}}, [[RES_1_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:               krnl.iterate
+// CHECK:                 krnl.load %arg0{{.}}{{.*}}{{.}} : memref<1x8x32x32xf32>
+// CHECK:                 krnl.load [[RES_1_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:               krnl.load [[RES_1_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:               krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x8x30x30xf32>
+// CHECK:           return [[RES_]] : memref<1x8x30x30xf32>
 }
 
 // -----
@@ -2803,28 +2182,12 @@ func.func private @test_split_equal(%arg0 : tensor<16x32x64xf32>) -> (tensor<*xf
   %0, %1 = "onnx.Split"(%arg0, %cst) { axis = 0 : si64} : (tensor<16x32x64xf32>, none) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 8)>
   // CHECK-LABEL: @test_split_equal
-  // CHECK:     [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK:     [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK:     [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK:     krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 8,
-  // CHECK-SAME:             [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:       [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) :
-  // CHECK-SAME:    (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:       [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:       krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK:     }
-  // CHECK:     [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK:     krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 8,
-  // CHECK-SAME:             [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:       [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) :
-  // CHECK-SAME:    (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:       [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#0{{.}}
-  // CHECK:       [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:       krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK:     }
-  // CHECK:     return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
+  // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
+  // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
+  // CHECK: "krnl.memcpy"([[RES_0]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: "krnl.memcpy"([[RES_1]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
 }
 
 // -----
@@ -2834,23 +2197,26 @@ func.func private @test_split_variable(%arg0 : tensor<16x32x64xf32>) -> (tensor<
   %0, %1 = "onnx.Split"(%arg0, %split) { axis = 1 : si64} : (tensor<16x32x64xf32>, tensor<2xi64>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 2)>
+  // CHECK-DAG: [[MAP_0_:#.+]] = affine_map<(d0) -> (d0 * 2048)>
+  // CHECK-DAG: [[MAP_1_:#.+]] = affine_map<(d0) -> (d0 * 128)>
+  // CHECK-DAG: [[MAP_2_:#.+]] = affine_map<(d0) -> (d0 * 2048 + 128)>
+  // CHECK-DAG: [[MAP_3_:#.+]] = affine_map<(d0) -> (d0 * 1920)>
   // CHECK-LABEL: @test_split_variable
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<16x2x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<16x30x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 2, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x2x64xf32>
+  // CHECK: [[DEF_LOOP_0:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_0]]) with ([[DEF_LOOP_0]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_0]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_0:%.+]] = affine.apply [[MAP_0_]]([[IV]])
+  // CHECK-DAG:   [[DEST_0:%.+]] = affine.apply [[MAP_1_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_0]], %arg0, {{.*}}, [[DEST_0]], [[SRC_0]]) : (memref<16x2x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 30, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#1{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[INDEX]], [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x30x64xf32>
+  // CHECK: [[DEF_LOOP_1:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_1]]) with ([[DEF_LOOP_1]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_1]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_1:%.+]] = affine.apply [[MAP_2_]]([[IV]])
+  // CHECK-DAG:   [[DEST_1:%.+]] = affine.apply [[MAP_3_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_1]], %arg0, {{.*}}, [[DEST_1]], [[SRC_1]]) : (memref<16x30x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
   // CHECK: return [[RES_0]], [[RES_1]] : memref<16x2x64xf32>, memref<16x30x64xf32>
 }
@@ -2861,24 +2227,11 @@ func.func private @test_splitv11_equal(%arg0 : tensor<16x32x64xf32>) -> (tensor<
   %0, %1 = "onnx.SplitV11"(%arg0) { axis = 0 : si64} : (tensor<16x32x64xf32>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 8)>
   // CHECK-LABEL: @test_splitv11_equal
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<8x32x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 8, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 8, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 32, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#0{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<8x32x64xf32>
-  // CHECK: }
+  // CHECK: "krnl.memcpy"([[RES_0]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
+  // CHECK: "krnl.memcpy"([[RES_1]], %arg0, {{.*}}) : (memref<8x32x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: return [[RES_0]], [[RES_1]] : memref<8x32x64xf32>, memref<8x32x64xf32>
 }
 
@@ -2888,22 +2241,26 @@ func.func private @test_splitv11_variable(%arg0 : tensor<16x32x64xf32>) -> (tens
   %0, %1 = "onnx.SplitV11"(%arg0) { axis = 1 : si64, split = [2, 30]} : (tensor<16x32x64xf32>) -> (tensor<*xf32>, tensor<*xf32>)
   "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
 
-  // CHECK: [[INDEX_MAP:#.+]] = affine_map<(d0) -> (d0 + 2)>
+  // CHECK-DAG: [[MAP_0_:#.+]] = affine_map<(d0) -> (d0 * 2048)>
+  // CHECK-DAG: [[MAP_1_:#.+]] = affine_map<(d0) -> (d0 * 128)>
+  // CHECK-DAG: [[MAP_2_:#.+]] = affine_map<(d0) -> (d0 * 2048 + 128)>
+  // CHECK-DAG: [[MAP_3_:#.+]] = affine_map<(d0) -> (d0 * 1920)>
   // CHECK-LABEL: @test_splitv11_variable
-
   // CHECK: [[RES_0:%.+]] = memref.alloc() {{.*}}: memref<16x2x64xf32>
   // CHECK: [[RES_1:%.+]] = memref.alloc() {{.*}}: memref<16x30x64xf32>
-  // CHECK: [[DEF_LOOP_0:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) with ([[DEF_LOOP_0]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_0]]#1 -> %arg2 = 0 to 2, [[DEF_LOOP_0]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[IV:%.+]]:3 = krnl.get_induction_var_value([[DEF_LOOP_0]]#0, [[DEF_LOOP_0]]#1, [[DEF_LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-  // CHECK:   [[LOAD_0:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_0]], [[RES_0]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x2x64xf32>
+  // CHECK: [[DEF_LOOP_0:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_0]]) with ([[DEF_LOOP_0]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_0]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_0:%.+]] = affine.apply [[MAP_0_]]([[IV]])
+  // CHECK-DAG:   [[DEST_0:%.+]] = affine.apply [[MAP_1_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_0]], %arg0, {{.*}}, [[DEST_0]], [[SRC_0]]) : (memref<16x2x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
-  // CHECK: [[DEF_LOOP_1:%.+]]:3 = krnl.define_loops 3
-  // CHECK: krnl.iterate([[DEF_LOOP_1]]#0, [[DEF_LOOP_1]]#1, [[DEF_LOOP_1]]#2) with ([[DEF_LOOP_1]]#0 -> %arg1 = 0 to 16, [[DEF_LOOP_1]]#1 -> %arg2 = 0 to 30, [[DEF_LOOP_1]]#2 -> %arg3 = 0 to 64){
-  // CHECK:   [[INDEX:%.+]] = affine.apply [[INDEX_MAP]]{{.}}[[IV]]#1{{.}}
-  // CHECK:   [[LOAD_1:%.+]] = krnl.load %arg0{{.}}[[IV]]#0, [[INDEX]], [[IV]]#2{{.}} : memref<16x32x64xf32>
-  // CHECK:   krnl.store [[LOAD_1]], [[RES_1]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<16x30x64xf32>
+  // CHECK: [[DEF_LOOP_1:%.+]] = krnl.define_loops 1
+  // CHECK: krnl.iterate([[DEF_LOOP_1]]) with ([[DEF_LOOP_1]] -> %arg1 = 0 to 16){
+  // CHECK:   [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOP_1]]) : (!krnl.loop) -> index
+  // CHECK-DAG:   [[SRC_1:%.+]] = affine.apply [[MAP_2_]]([[IV]])
+  // CHECK-DAG:   [[DEST_1:%.+]] = affine.apply [[MAP_3_]]([[IV]])
+  // CHECK:   "krnl.memcpy"([[RES_1]], %arg0, {{.*}}, [[DEST_1]], [[SRC_1]]) : (memref<16x30x64xf32>, memref<16x32x64xf32>, i64, index, index) -> ()
   // CHECK: }
   // CHECK: return [[RES_0]], [[RES_1]] : memref<16x2x64xf32>, memref<16x30x64xf32>
 }
@@ -2985,17 +2342,44 @@ func.func private @cast_lowering_f64f32_10(%arg0: tensor<10xf64>) -> tensor<*xf3
 
   // CHECK-LABEL: cast_lowering_f64f32_10
   // CHECK: [[RES:%.+]] = memref.alloc() {{.*}}: memref<10xf32>
+  // CHECK-DAG: [[FLAT_IN:%.+]] = memref.reshape %arg0({{.*}}) : (memref<10xf64>, memref<1xindex>) -> memref<10xf64>
+  // CHECK-DAG: [[FLAT_RES:%.+]] = memref.reshape [[RES]]({{.*}}) : (memref<10xf32>, memref<1xindex>) -> memref<10xf32>
   // CHECK: [[DEF_LOOPS:%.+]] = krnl.define_loops 1
-  // CHECK: krnl.iterate([[DEF_LOOPS]]) with ([[DEF_LOOPS]] -> %arg1 = 0 to 10){
-  // CHECK: [[IV:%.+]] = krnl.get_induction_var_value([[DEF_LOOPS]]) : (!krnl.loop) -> index
-  // CHECK: [[LOAD1:%.+]] = krnl.load %arg0[[[IV]]] : memref<10xf64>
-  // CHECK: [[FPTRUNC:%.+]] = arith.truncf [[LOAD1]] : f64 to f32
-  // CHECK: krnl.store [[FPTRUNC]], [[RES]][[[IV]]] : memref<10xf32>
+  // CHECK: [[BLOCK_TILE:%.+]], [[BLOCK_IN:%.+]] = krnl.block [[DEF_LOOPS]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+  // CHECK: krnl.iterate([[BLOCK_TILE]]) with ([[DEF_LOOPS]] -> %arg1 = 0 to 8){
+  // CHECK: [[IV:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE]]) : (!krnl.loop) -> index
+  // CHECK: [[LOAD1:%.+]] = vector.load [[FLAT_IN]][[[IV]]] : memref<10xf64>, vector<4xf64>
+  // CHECK: [[FPTRUNC:%.+]] = arith.truncf [[LOAD1]] : vector<4xf64> to vector<4xf32>
+  // CHECK: vector.store [[FPTRUNC]], [[FLAT_RES]][[[IV]]] : memref<10xf32>, vector<4xf32>
+  // CHECK: }
+  // CHECK-NOT: scf.if
+  // CHECK: [[MASK:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+  // CHECK: [[LOAD2:%.+]] = vector.maskedload [[FLAT_IN]]{{.}}{{.*}}{{.}}, [[MASK]], {{.*}} : memref<10xf64>, vector<4xi1>, vector<4xf64> into vector<4xf64>
+  // CHECK: [[FPTRUNC2:%.+]] = arith.truncf [[LOAD2]] : vector<4xf64> to vector<4xf32>
+  // CHECK: vector.maskedstore [[FLAT_RES]]{{.}}{{.*}}{{.}}, [[MASK]], [[FPTRUNC2]] : memref<10xf32>, vector<4xi1>, vector<4xf32>
   // CHECK: return [[RES]] : memref<10xf32>
 }
 
 // -----
 
+func.func private @cast_lowering_ui8f32_simd(%arg0: tensor<3x8xui8>) -> tensor<*xf32> {
+  %0 = "onnx.Cast"(%arg0) {to = f32} : (tensor<3x8xui8>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: cast_lowering_ui8f32_simd
+  // CHECK-DAG: [[RES:%.+]] = memref.alloc() {{.*}}: memref<3x8xf32>
+  // CHECK-DAG: [[FLAT_IN:%.+]] = memref.reshape %arg0({{.*}}) : (memref<3x8xui8>, memref<1xindex>) -> memref<24xui8>
+  // CHECK-DAG: [[FLAT_RES:%.+]] = memref.reshape [[RES]]({{.*}}) : (memref<3x8xf32>, memref<1xindex>) -> memref<24xf32>
+  // CHECK: krnl.iterate
+  // CHECK: [[LOAD:%.+]] = vector.load [[FLAT_IN]][{{.*}}] : memref<24xui8>, vector<4xui8>
+  // CHECK: [[SIGNLESS:%.+]] = builtin.unrealized_conversion_cast [[LOAD]] : vector<4xui8> to vector<4xi8>
+  // CHECK: [[VAL:%.+]] = arith.uitofp [[SIGNLESS]] : vector<4xi8> to vector<4xf32>
+  // CHECK: vector.store [[VAL]], [[FLAT_RES]][{{.*}}] : memref<24xf32>, vector<4xf32>
+  // CHECK: return [[RES]] : memref<3x8xf32>
+}
+
+// -----
+
 func.func private @cast_lowering_int_wider_int(%arg0: tensor<i32>) -> tensor<i64> {
   %0 = "onnx.Cast"(%arg0) {to = i64} : (tensor<i32>) -> tensor<i64>
   "func.return"(%0) : (tensor<i64>) -> ()
@@ -3399,56 +2783,25 @@ func.func private @test_floor(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Floor"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_floor
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.floor [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -3459,56 +2812,25 @@ func.func private @test_ceil(%arg0 : tensor<?x10xf32>) -> tensor<*xf32> {
   %0 = "onnx.Ceil"(%arg0) : (tensor<?x10xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
-// mlir2FileCheck.py
-// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<()[s0] -> (s0 * 40)>
-// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<()[s0] -> (s0 * 40 + 16)>
-// CHECK-DAG:   [[MAP_2_:#.+]] = affine_map<()[s0] -> (s0 * 10)>
-// CHECK-DAG:   [[MAP_3_:#.+]] = affine_map<(d0)[s0] -> (d0)>
 // CHECK-LABEL:  func.func private @test_ceil
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x10xf32>) -> memref<?x10xf32> {
-// CHECK:           [[CST_0_:%.+]] = arith.constant 0 : index
-// CHECK-DAG:       [[VAR_dim_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_40_:%.+]] = arith.constant 40 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_0_:%.+]] = affine.apply [[MAP_0_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:       [[VAR_1_:%.+]] = affine.apply [[MAP_1_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[RES_:%.+]] = memref.alloc([[VAR_1_]]) {{.*}}: memref<?xi8>
-// CHECK-DAG:       [[CST_0_1_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_view_:%.+]] = memref.view [[RES_]]{{.}}[[CST_0_1_]]{{.}}{{.}}[[VAR_dim_]]{{.}} : memref<?xi8> to memref<?x10xf32>
-// CHECK-DAG:       [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_dim_2_:%.+]] = memref.dim [[PARAM_0_]], [[CST_0_2_]] : memref<?x10xf32>
-// CHECK-DAG:       [[CST_10_1_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_2_:%.+]] = arith.constant 10 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:       [[VAR_2_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_2_]]{{.}}
-// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_2_]], [[RES_1_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]([[RES_1_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:       [[CST_10_3_:%.+]] = arith.constant 10 : index
-// CHECK-DAG:       [[VAR_3_:%.+]] = affine.apply [[MAP_2_]](){{.}}[[VAR_dim_]]{{.}}
-// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:       [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:           affine.store [[VAR_3_]], [[RES_2_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:       [[VAR_reshape_12_:%.+]] = memref.reshape [[VAR_view_]]([[RES_2_]]) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
-// CHECK-DAG:       [[LOOP_0_:%.+]] = krnl.define_loops 1
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x10xf32>
+// CHECK:           [[VAR_reshape_:%.+]] = memref.reshape [[PARAM_0_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[VAR_reshape_12_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<?x10xf32>, memref<1xindex>) -> memref<?xf32>
+// CHECK:           [[LOOP_0_:%.+]] = krnl.define_loops 1
 // CHECK:           [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_0_]] 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:           [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[MAP_3_]]([[VAR_3_]]){{.}}[[VAR_dim_]]{{.}}){
+// CHECK:           krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to {{.*}}){
 // CHECK:             [[VAR_5_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:             [[VAR_7_:%.+]] = math.ceil [[LOAD_VAR_reshape_MEM_]] : vector<4xf32>
 // CHECK:             vector.store [[VAR_7_]], [[VAR_reshape_12_]]{{.}}[[VAR_5_]]{{.}} : memref<?xf32>, vector<4xf32>
 // CHECK:           }
-// CHECK:           return [[VAR_view_]] : memref<?x10xf32>
+// CHECK:           scf.if {{.*}} {
+// CHECK:             [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<4xi1>
+// CHECK:             vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32> into vector<4xf32>
+// CHECK:             vector.maskedstore [[VAR_reshape_12_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<?xf32>, vector<4xi1>, vector<4xf32>
+// CHECK:           }
+// CHECK:           return [[RES_]] : memref<?x10xf32>
 // CHECK:         }
 }
 
@@ -3862,7 +3184,6 @@ func.func private @test_loop_simple_main_graph(%arg0: tensor<i64>, %arg1: tensor
   }) : (tensor<i64>, tensor<i1>, tensor<1xi64>) -> tensor<1xi64>
   return %0 : tensor<1xi64>
 
-// mlir2FileCheck.py
 // CHECK-LABEL:  func.func private @test_loop_simple_main_graph
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<i64>, [[PARAM_1_:%.+]]: memref<i1>, [[PARAM_2_:%.+]]: memref<1xi64>) -> memref<1xi64> {
 // CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1xi64>
@@ -3889,46 +3210,17 @@ func.func private @test_loop_simple_main_graph(%arg0: tensor<i64>, %arg1: tensor
 // CHECK-DAG:             [[VAR_7_:%.+]] = arith.index_cast [[VAR_5_1_]] : index to i64
 // CHECK-DAG:             [[RES_2_:%.+]] = memref.alloc() : memref<i64>
 // CHECK:                 krnl.store [[VAR_7_]], [[RES_2_]][] : memref<i64>
-// CHECK-DAG:             [[CST_1_1_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_1_2_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_1_3_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_8_:%.+]] = arith.constant 8 : index
-// CHECK-DAG:             [[CST_8_1_:%.+]] = arith.constant 8 : index
-// CHECK-DAG:             [[CST_16_:%.+]] = arith.constant 16 : index
-// CHECK-DAG:             [[RES_3_:%.+]] = memref.alloc() {{.*}}: memref<16xi8>
-// CHECK-DAG:             [[CST_0_2_:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:             [[VAR_view_:%.+]] = memref.view [[RES_3_]]{{.}}[[CST_0_2_]]{{.}}[] : memref<16xi8> to memref<1xi64>
-// CHECK-DAG:             [[CST_1_4_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_1_5_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_1_6_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[RES_4_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:             [[CST_0_3_:%.+]] = arith.constant 0 : index
-// CHECK:                 affine.store [[CST_1_5_]], [[RES_4_]]{{.}}[[CST_0_3_]]{{.}} : memref<1xindex>
-// CHECK-DAG:             [[VAR_reshape_:%.+]] = memref.reshape [[RES_]]([[RES_]]_12) : (memref<1xi64>, memref<1xindex>) -> memref<1xi64>
-// CHECK-DAG:             [[CST_1_7_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[RES_5_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:             [[CST_0_4_:%.+]] = arith.constant 0 : index
-// CHECK:                 affine.store [[CST_1_7_]], [[RES_5_]]{{.}}[[CST_0_4_]]{{.}} : memref<1xindex>
-// CHECK-DAG:             [[VAR_reshape_17_:%.+]] = memref.reshape [[RES_2_]]([[RES_5_]]) : (memref<i64>, memref<1xindex>) -> memref<1xi64>
-// CHECK-DAG:             [[CST_1_8_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[CST_1_9_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[RES_6_:%.+]] = memref.alloc() {{.*}}: memref<1xindex>
-// CHECK-DAG:             [[CST_0_5_:%.+]] = arith.constant 0 : index
-// CHECK:                 affine.store [[CST_1_8_]], [[RES_6_]]{{.}}[[CST_0_5_]]{{.}} : memref<1xindex>
-// CHECK-DAG:             [[VAR_reshape_22_:%.+]] = memref.reshape [[VAR_view_]]([[RES_6_]]) : (memref<1xi64>, memref<1xindex>) -> memref<1xi64>
-// CHECK-DAG:             [[CST_1_10_:%.+]] = arith.constant 1 : index
-// CHECK-DAG:             [[LOOP_2_:%.+]] = krnl.define_loops 1
-// CHECK:                 [[BLOCK_TILE__0_:%.+]], [[BLOCK_IN__0_:%.+]] = krnl.block [[LOOP_2_]] 2 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
-// CHECK:                 [[CST_0_6_:%.+]] = arith.constant 0 : index
-// CHECK:                 krnl.iterate([[BLOCK_TILE__0_]]) with ([[LOOP_2_]] -> [[I_2_:%.+]] = 0 to 1){
-// CHECK:                   [[VAR_14_:%.+]] = krnl.get_induction_var_value([[BLOCK_TILE__0_]]) : (!krnl.loop) -> index
-// CHECK-DAG:               [[LOAD_VAR_reshape_MEM_:%.+]] = vector.load [[VAR_reshape_]]{{.}}[[VAR_14_]]{{.}} : memref<1xi64>, vector<2xi64>
-// CHECK-DAG:               [[LOAD_VAR_reshape_17_MEM_:%.+]] = vector.load [[VAR_reshape_17_]]{{.}}[[VAR_14_]]{{.}} : memref<1xi64>, vector<2xi64>
-// CHECK:                   [[VAR_17_:%.+]] = arith.addi [[LOAD_VAR_reshape_MEM_]], [[LOAD_VAR_reshape_17_MEM_]] : vector<2xi64>
-// CHECK:                   vector.store [[VAR_17_]], [[VAR_reshape_22_]]{{.}}[[VAR_14_]]{{.}} : memref<1xi64>, vector<2xi64>
-// CHECK:                 }
-// CHECK-DAG:             [[VAR_9_:%.+]] = builtin.unrealized_conversion_cast [[VAR_view_]] : memref<1xi64> to tensor<1xi64>
+// CHECK:                 [[RES_3_:%.+]] = memref.alloc() {{.*}}: memref<1xi64>
+// CHECK:                 [[VAR_reshape_:%.+]] = memref.reshape [[RES_]]({{.*}}) : (memref<1xi64>, memref<1xindex>) -> memref<1xi64>
+// CHECK:                 [[VAR_reshape_17_:%.+]] = memref.reshape [[RES_2_]]({{.*}}) : (memref<i64>, memref<1xindex>) -> memref<1xi64>
+// CHECK:                 [[VAR_reshape_22_:%.+]] = memref.reshape [[RES_3_]]({{.*}}) : (memref<1xi64>, memref<1xindex>) -> memref<1xi64>
+// CHECK-NOT:             krnl.iterate
+// CHECK:                 [[MASK_:%.+]] = vector.create_mask {{.*}} : vector<2xi1>
+// CHECK-DAG:             [[LOAD_VAR_reshape_MEM_:%.+]] = vector.maskedload [[VAR_reshape_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<1xi64>, vector<2xi1>, vector<2xi64> into vector<2xi64>
+// CHECK-DAG:             [[LOAD_VAR_reshape_17_MEM_:%.+]] = vector.maskedload [[VAR_reshape_17_]]{{.}}{{.*}}{{.}}, [[MASK_]], {{.*}} : memref<1xi64>, vector<2xi1>, vector<2xi64> into vector<2xi64>
+// CHECK:                 [[VAR_17_:%.+]] = arith.addi [[LOAD_VAR_reshape_MEM_]], [[LOAD_VAR_reshape_17_MEM_]] : vector<2xi64>
+// CHECK:                 vector.maskedstore [[VAR_reshape_22_]]{{.}}{{.*}}{{.}}, [[MASK_]], [[VAR_17_]] : memref<1xi64>, vector<2xi1>, vector<2xi64>
+// CHECK-DAG:             [[VAR_9_:%.+]] = builtin.unrealized_conversion_cast [[RES_3_]] : memref<1xi64> to tensor<1xi64>
 // CHECK-DAG:             [[VAR_10_:%.+]] = builtin.unrealized_conversion_cast [[PARAM_1_]] : memref<i1> to memref<i1>
 // CHECK-NOT: separator of consecutive DAGs
 // CHECK-DAG:             [[VAR_11_:%.+]] = builtin.unrealized_conversion_cast [[VAR_9_]] : tensor<1xi64> to memref<1xi64>
@@ -4017,7 +3309,7 @@ func.func @test_loop(%arg0: tensor<i64>, %arg1: tensor<i1>, %arg2: tensor<?xf32>
 // CHECK-DAG:             [[VAR_15_:%.+]] = builtin.unrealized_conversion_cast [[VAR_13_]] : tensor<?xf32> to memref<?xf32>
 // CHECK-DAG:             [[LOAD_VAR_14_MEM_:%.+]] = krnl.load [[VAR_14_]][] : memref<i1>
 // CHECK:                 krnl.store [[LOAD_VAR_14_MEM_]], [[RES_1_]][] : memref<i1>
-// CHECK:                 "krnl.seqstore"([[VAR_15_]], [[RES_]], [[VAR_8_]]) : (memref<?xf32>, memref<?xmemref<?xf32>>, index) -> ()
+// CHECK:                 "krnl.seqstore"([[VAR_15_]], [[RES_]], [[VAR_8_]]) {copy = 1 : ui1} : (memref<?xf32>, memref<?xmemref<?xf32>>, index) -> ()
 // CHECK:               }) : () -> ()
 // CHECK:             }
 // CHECK:           }
@@ -4307,7 +3599,7 @@ func.func @test_gather_elements(%arg0: tensor<4xi64>, %arg1: tensor<2xi64>) -> t
   return %0 : tensor<2xi64>
 // CHECK-LABEL:  @test_gather_elements
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4xi64>, [[PARAM_1:%.+]]: memref<2xi64>) -> memref<2xi64> {
-// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<2xi64>
+// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2xi64>
 // CHECK-DAG:       [[LOOP_0:%.+]] = krnl.define_loops 1
 // CHECK:           krnl.iterate([[LOOP_0]]) with ([[LOOP_0]] -> [[I_0:%.+]] = 0 to 2){
 // CHECK:             [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_0]]) : (!krnl.loop) -> index
@@ -4335,7 +3627,7 @@ func.func @test_gather_nd_1(%arg0 : tensor<2x2xf32>, %arg1 : tensor<2x2xi64>) ->
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<2x2xf32>, [[PARAM_1:%.+]]: memref<2x2xi64>) -> memref<2xf32> {
 // CHECK:           [[RESHAPED_INDICES:%.+]] = memref.reinterpret_cast %arg1 to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x2xi64> to memref<1x2x2xi64>
 // CHECK:           [[RESHAPED_DATA:%.+]] = memref.reinterpret_cast %arg0 to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x2xf32> to memref<1x2x2xf32>
-// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() : memref<2xf32>
+// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2xf32>
 // CHECK-DAG:       [[RES_BUFFER_INDEX:%.+]] = memref.alloca() : memref<index>
 // CHECK-DAG:       [[CST_0_0:%.+]] = arith.constant 0 : index
 // CHECK-DAG:       [[CST_1_0:%.+]] = arith.constant 1 : index
@@ -4369,7 +3661,7 @@ func.func @test_gather_nd_2(%arg0 : tensor<2x2x2xf32>, %arg1 : tensor<2x1x2xi64>
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<2x2x2xf32>, [[PARAM_1:%.+]]: memref<2x1x2xi64>) -> memref<2x1x2xf32> {
 // CHECK-DAG:       [[RESHAPED_INDICES:%.+]] = memref.reinterpret_cast [[PARAM_1]] to offset: [0], sizes: [1, 2, 2], strides: [4, 2, 1] : memref<2x1x2xi64> to memref<1x2x2xi64>
 // CHECK-DAG:       [[RESHAPED_DATA:%.+]] = memref.reinterpret_cast [[PARAM_0]] to offset: [0], sizes: [1, 2, 2, 2], strides: [8, 4, 2, 1] : memref<2x2x2xf32> to memref<1x2x2x2xf32>
-// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() : memref<4xf32>
+// CHECK-DAG:       [[RES_BUFFER:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<4xf32>
 // CHECK:           [[CST_0_0:%.+]] = arith.constant 0 : index
 // CHECK:           [[CST_1_0:%.+]] = arith.constant 1 : index
 // CHECK:           [[RES_INDEX_BUFFER:%.+]] = memref.alloca() : memref<index>
@@ -4383,19 +3675,13 @@ func.func @test_gather_nd_2(%arg0 : tensor<2x2x2xf32>, %arg1 : tensor<2x1x2xi64>
 // CHECK-DAG:         [[CST_1_1:%.+]] = arith.constant 1 : index
 // CHECK:             [[LOAD_INDEX_2:%.+]] = krnl.load [[RESHAPED_INDICES]]{{.}}[[IV]]#0, [[IV]]#1, [[CST_1_1]]{{.}} : memref<1x2x2xi64>
 // CHECK-DAG:         [[INDEX_2:%.+]] = arith.index_cast [[LOAD_INDEX_2]] : i64 to index
-// CHECK-DAG:         [[CST_0_2:%.+]] = arith.constant 0 : index
+// CHECK-DAG:         [[CST_2_0:%.+]] = arith.constant 2 : index
+// CHECK-DAG:         [[CST_2_1:%.+]] = arith.constant 2 : i64
 // CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:         [[DATA_1:%.+]] = krnl.load [[RESHAPED_DATA]]{{.}}[[IV]]#0, [[INDEX_1]], [[INDEX_2]], [[CST_0_2]]{{.}} : memref<1x2x2x2xf32>
 // CHECK-DAG:         [[RES_INDEX_1:%.+]] = krnl.load [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             krnl.store [[DATA_1]], [[RES_BUFFER]]{{.}}[[RES_INDEX_1]]{{.}} : memref<4xf32>
-// CHECK:             [[PLUS_ONE:%.+]] = arith.addi [[RES_INDEX_1]], [[CST_1_0]] : index
-// CHECK:             krnl.store [[PLUS_ONE]], [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             [[CST_1_2:%.+]] = arith.constant 1 : index
-// CHECK-DAG:         [[DATA_2:%.+]] = krnl.load [[RESHAPED_DATA]]{{.}}[[IV]]#0, [[INDEX_1]], [[INDEX_2]], [[CST_1_2]]{{.}} : memref<1x2x2x2xf32>
-// CHECK-DAG:         [[RES_INDEX_2:%.+]] = krnl.load [[RES_INDEX_BUFFER]][] : memref<index>
-// CHECK:             krnl.store [[DATA_2]], [[RES_BUFFER]]{{.}}[[RES_INDEX_2]]{{.}} : memref<4xf32>
-// CHECK:             [[PLUS_ONE_1:%.+]] = arith.addi [[RES_INDEX_2]], [[CST_1_0]] : index
-// CHECK:             krnl.store [[PLUS_ONE_1]], [[RES_INDEX_BUFFER]][] : memref<index>
+// CHECK:             "krnl.memcpy"([[RES_BUFFER]], [[PARAM_0]], [[CST_2_1]], [[RES_INDEX_1]], {{.*}}) : (memref<4xf32>, memref<2x2x2xf32>, i64, index, index) -> ()
+// CHECK:             [[PLUS_TWO:%.+]] = arith.addi [[RES_INDEX_1]], [[CST_2_0]] : index
+// CHECK:             krnl.store [[PLUS_TWO]], [[RES_INDEX_BUFFER]][] : memref<index>
 // CHECK:           }
 // CHECK:           [[RES:%.+]] = memref.reinterpret_cast [[RES_BUFFER]] to offset: [0], sizes: [2, 1, 2], strides: [2, 2, 1] : memref<4xf32> to memref<2x1x2xf32>
 // CHECK:           return [[RES]] : memref<2x1x2xf32>
@@ -4439,7 +3725,7 @@ func.func @test_random_normal1() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 1 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal1
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -4454,7 +3740,7 @@ func.func @test_random_normal2() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal2
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -4469,7 +3755,7 @@ func.func @test_random_normal3() -> tensor<*xf32> {
   %0 = "onnx.RandomNormal"() {shape = [3, 4, 5], dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32} : () -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal3
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -4484,7 +3770,7 @@ func.func @test_random_normal_like1(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 1 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like1
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -4498,7 +3784,7 @@ func.func @test_random_normal_like2(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like2
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -4512,7 +3798,7 @@ func.func @test_random_normal_like3(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {dtype = 2 : si64, mean = 0.0 :f32, scale = 1.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like3
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf64>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf64>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f64
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f64
@@ -4530,7 +3816,7 @@ func.func @test_random_normal_like4(%arg0: tensor<3x4x?x?xf32>) -> tensor<*xf32>
 // CHECK-DAG:       [[DIM2:%.+]] = memref.dim %arg0, [[C2]] : memref<3x4x?x?xf32>
 // CHECK-DAG:       [[C3:%.+]] = arith.constant 3 : index
 // CHECK-DAG:       [[DIM3:%.+]] = memref.dim %arg0, [[C3]] : memref<3x4x?x?xf32>
-// CHECK-DAG:       [[DYN_ALLOC:%.+]] = memref.alloc([[DIM2]], [[DIM3]]) {alignment = 16 : i64} : memref<3x4x?x?xf32>
+// CHECK-DAG:       [[DYN_ALLOC:%.+]] = memref.alloc([[DIM2]], [[DIM3]]) {alignment = 64 : i64} : memref<3x4x?x?xf32>
 // CHECK-DAG:       [[C12:%.+]] = arith.constant 12 : index
 // CHECK-DAG:       [[C2:%.+]] = arith.constant 2 : index
 // CHECK-DAG:       [[DIM2:%.+]] = memref.dim %arg0, [[C2]] : memref<3x4x?x?xf32>
@@ -4550,7 +3836,7 @@ func.func @test_random_normal_like5(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32> {
   %0 = "onnx.RandomNormalLike"(%arg0) {mean = 0.0 :f32, scale = 1.0 : f32, seed = 2.0 : f32} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 // CHECK-LABEL:  @test_random_normal_like5
-// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x4x5xf32>
+// CHECK-DAG:       [[ALLOC:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x4x5xf32>
 // CHECK-DAG:       [[ALL_VALUES:%.+]] = arith.constant 60 : index
 // CHECK-DAG:       [[MEAN:%.+]] = arith.constant 0.000000e+00 : f32
 // CHECK-DAG:       [[SCALE:%.+]] = arith.constant 1.000000e+00 : f32
@@ -4568,7 +3854,7 @@ func.func @test_scatter_elements1(%arg0: tensor<3x3xf32>, %arg1: tensor<3x2xi64>
 // CHECK-LABEL:  @test_scatter_elements1
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<3x3xf32>, [[PARAM_1:%.+]]: memref<3x2xi64>, [[PARAM_2:%.+]]: memref<3x2xf32>) -> (memref<3x3xf32>, memref<3x3xf32>) {
 // CHECK-DAG:       [[CST_3:%.+]] = arith.constant 3 : index
-// CHECK-DAG:       [[RES1:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x3xf32>
+// CHECK-DAG:       [[RES1:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x3xf32>
 // CHECK-DAG:       [[CST_9:%.+]] = arith.constant 9 : i64
 // CHECK-DAG:       [[CST_0:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES1]], %arg0, [[CST_9]], [[CST_0]], [[CST_0]]) : (memref<3x3xf32>, memref<3x3xf32>, i64, index, index) -> ()
@@ -4587,7 +3873,7 @@ func.func @test_scatter_elements1(%arg0: tensor<3x3xf32>, %arg1: tensor<3x2xi64>
 // CHECK:             krnl.store [[UPDATE_VAL]], [[RES1]]{{.}}[[SEL]], [[IV]]#1{{.}} : memref<3x3xf32>
 // CHECK-NEXT:      }
 //
-// CHECK-DAG:       [[RES2:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<3x3xf32>
+// CHECK-DAG:       [[RES2:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<3x3xf32>
 // CHECK-DAG:       [[CST_9_1:%.+]] = arith.constant 9 : i64
 // CHECK-DAG:       [[CST_0_1:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES2]], %arg0, [[CST_9_1]], [[CST_0_1]], [[CST_0_1]]) : (memref<3x3xf32>, memref<3x3xf32>, i64, index, index) -> ()
@@ -4616,26 +3902,53 @@ func.func @test_scatter_nd1(%arg0: tensor<4x4x4xf32>, %arg1: tensor<2x1xi64>, %a
 // CHECK-LABEL:  @test_scatter_nd1
 // CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4x4x4xf32>, [[PARAM_1:%.+]]: memref<2x1xi64>, [[PARAM_2:%.+]]: memref<2x4x4xf32>) -> memref<4x4x4xf32> {
 // CHECK-DAG:       [[CST_4:%.+]] = arith.constant 4 : index
-// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<4x4x4xf32>
+// CHECK-DAG:       [[RES:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<4x4x4xf32>
 // CHECK-DAG:       [[CST_64:%.+]] = arith.constant 64 : i64
 // CHECK-DAG:       [[CST_0:%.+]] = arith.constant 0 : index
 // CHECK:           "krnl.memcpy"([[RES]], %arg0, [[CST_64]], [[CST_0]], [[CST_0]]) : (memref<4x4x4xf32>, memref<4x4x4xf32>, i64, index, index) -> ()
-// CHECK:           [[LOOP_0:%.+]]:3 = krnl.define_loops 3
-// CHECK:           krnl.iterate([[LOOP_0]]#0, [[LOOP_0]]#1, [[LOOP_0]]#2) with
-// CHECK-SAME:      ([[LOOP_0]]#0 -> [[I_0:%.+]] = 0 to 2, [[LOOP_0]]#1 -> [[I_1:%.+]] = 0 to 4, [[LOOP_0]]#2 -> [[I_2:%.+]] = 0 to 4){
-// CHECK-DAG:         [[IV:%.+]]:3 = krnl.get_induction_var_value([[LOOP_0]]#0, [[LOOP_0]]#1, [[LOOP_0]]#2) : (!krnl.loop, !krnl.loop, !krnl.loop) -> (index, index, index)
-// CHECK-DAG:         [[CST_0:%.+]] = arith.constant 0 : index
-// CHECK-NOT: separator of consecutive DAGs
-// CHECK-DAG:         [[INDEX:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]]#0, [[CST_0]]{{.}} : memref<2x1xi64>
-// CHECK-DAG:         [[UPDATE:%.+]] = krnl.load [[PARAM_2]]{{.}}[[IV]]#0, [[IV]]#1, [[IV]]#2{{.}} : memref<2x4x4xf32>
-// CHECK-DAG:         [[CAST_INDEX:%.+]] = arith.index_cast [[INDEX]] : i64 to index
-// CHECK:             krnl.store [[UPDATE]], [[RES]]{{.}}[[CAST_INDEX]], [[IV]]#1, [[IV]]#2{{.}} : memref<4x4x4xf32>
+// CHECK-DAG:       [[CST_16:%.+]] = arith.constant 16 : index
+// CHECK-DAG:       [[SLICE_SIZE:%.+]] = arith.index_cast [[CST_16]] : index to i64
+// CHECK-DAG:       [[LOOP_0:%.+]] = krnl.define_loops 1
+// CHECK:           krnl.iterate([[LOOP_0]]) with ([[LOOP_0]] -> [[I_0:%.+]] = 0 to 2){
+// CHECK-DAG:         [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_0]]) : (!krnl.loop) -> index
+// CHECK-DAG:         [[CST_0_1:%.+]] = arith.constant 0 : index
+// CHECK:             [[INDEX:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_0_1]]{{.}} : memref<2x1xi64>
+// CHECK:             [[CAST_INDEX:%.+]] = arith.index_cast [[INDEX]] : i64 to index
+// CHECK:             "krnl.memcpy"([[RES]], [[PARAM_2]], [[SLICE_SIZE]], {{.*}}, {{.*}}) : (memref<4x4x4xf32>, memref<2x4x4xf32>, i64, index, index) -> ()
 // CHECK-NEXT:      }
 // CHECK:           return [[RES]] : memref<4x4x4xf32>
 }
 
 // -----
 
+// COM: Test ScatterND with indices.shape[-1] == rank(data), scattering single
+// COM: elements in place into the result of a previous operation.
+func.func @test_scatter_nd_inplace(%arg0: tensor<4x4xf32>, %arg1: tensor<3x2xi64>, %arg2: tensor<3xf32>) -> tensor<4x4xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+  %1 = "onnx.ScatterND"(%0, %arg1, %arg2) : (tensor<4x4xf32>, tensor<3x2xi64>, tensor<3xf32>) -> tensor<4x4xf32>
+  return %1 : tensor<4x4xf32>
+// CHECK-LABEL:  @test_scatter_nd_inplace
+// CHECK-SAME:   ([[PARAM_0:%.+]]: memref<4x4xf32>, [[PARAM_1:%.+]]: memref<3x2xi64>, [[PARAM_2:%.+]]: memref<3xf32>) -> memref<4x4xf32> {
+// CHECK:           [[RES:%.+]] = memref.alloc() {{.*}} : memref<4x4xf32>
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       "krnl.memcpy"
+// CHECK:           [[LOOP_1:%.+]] = krnl.define_loops 1
+// CHECK:           krnl.iterate([[LOOP_1]]) with ([[LOOP_1]] -> [[I_1:%.+]] = 0 to 3){
+// CHECK-DAG:         [[IV:%.+]] = krnl.get_induction_var_value([[LOOP_1]]) : (!krnl.loop) -> index
+// CHECK-DAG:         [[CST_0:%.+]] = arith.constant 0 : index
+// CHECK:             [[INDEX_0:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_0]]{{.}} : memref<3x2xi64>
+// CHECK-DAG:         [[CAST_INDEX_0:%.+]] = arith.index_cast [[INDEX_0]] : i64 to index
+// CHECK-DAG:         [[CST_1:%.+]] = arith.constant 1 : index
+// CHECK:             [[INDEX_1:%.+]] = krnl.load [[PARAM_1]]{{.}}[[IV]], [[CST_1]]{{.}} : memref<3x2xi64>
+// CHECK-DAG:         [[CAST_INDEX_1:%.+]] = arith.index_cast [[INDEX_1]] : i64 to index
+// CHECK-DAG:         [[UPDATE:%.+]] = krnl.load [[PARAM_2]]{{.}}[[IV]]{{.}} : memref<3xf32>
+// CHECK:             krnl.store [[UPDATE]], [[RES]]{{.}}[[CAST_INDEX_0]], [[CAST_INDEX_1]]{{.}} : memref<4x4xf32>
+// CHECK-NEXT:      }
+// CHECK:           return [[RES]] : memref<4x4xf32>
+}
+
+// -----
+
 func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3xi64>  {
   %0 = onnx.Constant {value = dense<0> : tensor<1xi64>} : tensor<i64>
   %7 = "onnx.SequenceErase"(%arg0, %0) : (!onnx.Seq<tensor<?x4x5xf32>>, tensor<i64>) -> !onnx.Seq<tensor<?x4x5xf32>>
@@ -4664,7 +3977,7 @@ func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3x
 // CHECK:           krnl.iterate([[LOOP_0_]]) with ([[LOOP_0_]] -> [[I_0_:%.+]] = 0 to [[VAR_8_]]){
 // CHECK:             [[VAR_24_:%.+]] = krnl.get_induction_var_value([[LOOP_0_]]) : (!krnl.loop) -> index
 // CHECK:             [[LOAD_PARAM_0_MEM_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[VAR_24_]]{{.}} : memref<?xmemref<?x4x5xf32>>
-// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_]], [[VAR_3_]], [[VAR_8_]]) : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
+// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_]], [[VAR_3_]], [[VAR_24_]]) {copy = 0 : ui1} : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
 // CHECK:           }
 // CHECK:           [[VAR_c1_2_:%.+]] = arith.constant 1 : index
 // CHECK-DAG:       [[VAR_10_:%.+]] = arith.addi [[VAR_8_]], [[VAR_c1_2_]] : index
@@ -4674,7 +3987,7 @@ func.func @test_sequence_erase(%arg0: !onnx.Seq<tensor<?x4x5xf32>>) -> tensor<3x
 // CHECK-DAG:         [[LOAD_PARAM_0_MEM_1_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[VAR_24_1_]]{{.}} : memref<?xmemref<?x4x5xf32>>
 // CHECK-DAG:         [[VAR_c1_8_:%.+]] = arith.constant 1 : index
 // CHECK:             [[VAR_26_:%.+]] = arith.subi [[VAR_24_1_]], [[VAR_c1_8_]] : index
-// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_1_]], [[VAR_3_]], [[VAR_26_]]) : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
+// CHECK:             "krnl.seqstore"([[LOAD_PARAM_0_MEM_1_]], [[VAR_3_]], [[VAR_26_]]) {copy = 0 : ui1} : (memref<?x4x5xf32>, memref<?xmemref<?x4x5xf32>>, index) -> ()
 // CHECK:           }
 // CHECK:           [[VAR_c0_3_:%.+]] = arith.constant 0 : index
 // CHECK-DAG:       [[VAR_12_:%.+]] = memref.dim [[VAR_3_]], [[VAR_c0_3_]] : memref<?xmemref<?x4x5xf32>>
@@ -4782,3 +4095,68 @@ func.func @test_isnan(%arg0 : tensor<2x3x4xf32>) -> tensor<*xi1> {
 // CHECK: {{.*}}store [[ERF]], [[ALLOC]][[[IV]]#0, [[IV]]#1, [[IV]]#2] : memref<2x3x4xi1>
 // CHECK: return [[ALLOC]] : memref<2x3x4xi1>
 }
+
+// -----
+
+// ArgMax along the innermost axis tracks the best value and its index in each
+// lane, then reduces the lanes to the first index of the best value.
+
+func.func @test_argmax_simd(%arg0 : tensor<4x1000xf32>) -> tensor<*xi64> {
+  %0 = "onnx.ArgMax"(%arg0) {axis = -1 : si64, keepdims = 0 : si64} : (tensor<4x1000xf32>) -> tensor<*xi64>
+  "func.return"(%0) : (tensor<*xi64>) -> ()
+
+// CHECK-LABEL:  func @test_argmax_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x1000xf32>) -> memref<4xi64> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4xi64>
+// CHECK:           krnl.iterate
+// CHECK:             [[SIMD_:%.+]]:2 = scf.for {{.*}} iter_args({{.*}}) -> (vector<[[VL_:[0-9]+]]xf32>, vector<[[VL_]]xi32>) {
+// CHECK:               vector.load [[PARAM_0_]]{{.*}} : memref<4x1000xf32>, vector<[[VL_]]xf32>
+// CHECK:               arith.cmpf ogt, {{.*}} : vector<[[VL_]]xf32>
+// CHECK:             [[TAIL_:%.+]]:2 = scf.for {{.*}} -> (f32, i32) {
+// CHECK:             [[MAX_:%.+]] = vector.reduction <maxf>, [[SIMD_]]#0 : vector<[[VL_]]xf32> into f32
+// CHECK:             vector.reduction <minsi>, {{.*}} : vector<[[VL_]]xi32> into i32
+// CHECK:             krnl.store {{.*}}, [[RES_]]{{.*}} : memref<4xi64>
+// CHECK:           return [[RES_]] : memref<4xi64>
+}
+
+// -----
+
+// Hardmax along the innermost axis clears each row before setting its argmax.
+
+func.func @test_hardmax_simd(%arg0 : tensor<4x1000xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Hardmax"(%arg0) {axis = -1 : si64} : (tensor<4x1000xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_hardmax_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x1000xf32>) -> memref<4x1000xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x1000xf32>
+// CHECK:           krnl.iterate
+// CHECK:             scf.for {{.*}} -> (vector<[[VL_:[0-9]+]]xf32>, vector<[[VL_]]xi32>) {
+// CHECK:             vector.reduction <maxf>
+// CHECK:             vector.store {{.*}}, [[RES_]]{{.*}} : memref<4x1000xf32>, vector<[[VL_]]xf32>
+// CHECK:             krnl.store {{.*}}, [[RES_]]{{.*}} : memref<4x1000xf32>
+// CHECK:           return [[RES_]] : memref<4x1000xf32>
+}
+
+// -----
+
+func.func @test_lrn_simd(%arg0 : tensor<1x8x6x6xf32>) -> tensor<*xf32> {
+  %0 = "onnx.LRN"(%arg0) {alpha = 1.000000e-04 : f32, beta = 7.500000e-01 : f32, bias = 1.000000e+00 : f32, size = 3 : si64} : (tensor<1x8x6x6xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func @test_lrn_simd
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x8x6x6xf32>) -> memref<1x8x6x6xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x8x6x6xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [1, 8, 36], strides: [288, 36, 1] : memref<1x8x6x6xf32> to memref<1x8x36xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_0_:%.+]] = memref.reinterpret_cast [[RES_]] to offset: [0], sizes: [1, 8, 36], strides: [288, 36, 1] : memref<1x8x6x6xf32> to memref<1x8x36xf32>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.iterate
+// CHECK:               scf.for {{.*}} -> (vector<[[VL_:[0-9]+]]xf32>) {
+// CHECK:                 arith.mulf {{.*}} : vector<[[VL_]]xf32>
+// CHECK:               scf.for {{.*}} -> (vector<[[VL_]]xf32>) {
+// CHECK:                 math.powf {{.*}} : vector<[[VL_]]xf32>
+// CHECK:                 vector.store {{.*}}, [[VAR_reinterpret_cast_0_]]{{.*}} : memref<1x8x36xf32>, vector<[[VL_]]xf32>
+// CHECK:                 arith.select {{.*}} : vector<[[VL_]]xf32>
+// CHECK:                 arith.select {{.*}} : vector<[[VL_]]xf32>
+// CHECK:           return [[RES_]] : memref<1x8x6x6xf32>
+}
@@ -0,0 +1,107 @@
+// RUN: echo '{"matmul_tiles": [{"mcpu": "z16", "op": "MatMul", "shape": [256, 256, 256], "reg": [4, 8, 8], "backend": "krnl"}, {"mcpu": "z16", "op": "Conv", "shape": [4, 36, 27], "backend": "blas"}]}' > %t.json
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl="enable-blas matmul-tile-db=%t.json target-cpu=z16" --canonicalize %s -split-input-file | FileCheck %s
+
+// COM: The Gemm, MatMul and Conv ops of at least blas-threshold flops, or of
+// COM: dynamic shapes, or tuned for the BLAS library are computed by the
+// COM: runtime with the external BLAS library.
+
+func.func private @test_gemm_blas(%arg0 : tensor<256x256xf32>, %arg1 : tensor<256x256xf32>, %arg2 : tensor<256xf32>) -> tensor<*xf32> {
+  %0 ="onnx.Gemm"(%arg0, %arg1, %arg2) {alpha = 1.0 : f32, beta = 2.0 : f32, transB = 1 : si64} : (tensor<256x256xf32>, tensor<256x256xf32>, tensor<256xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_gemm_blas
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<256x256xf32>, [[PARAM_1_:%.+]]: memref<256x256xf32>, [[PARAM_2_:%.+]]: memref<256xf32>) -> memref<256x256xf32> {
+// CHECK-DAG:       [[ALPHA_:%.+]] = arith.constant 1.000000e+00 : f64
+// CHECK-DAG:       [[BETA_:%.+]] = arith.constant 2.000000e+00 : f64
+// CHECK-DAG:       [[TRANS_A_:%.+]] = arith.constant 0 : i64
+// CHECK-DAG:       [[TRANS_B_:%.+]] = arith.constant 1 : i64
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<256x256xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]], [[PARAM_2_]], [[TRANS_A_]], [[TRANS_B_]], [[ALPHA_]], [[BETA_]]) {funcName = "omTensorGemm"} : (memref<256x256xf32>, memref<256x256xf32>, memref<256x256xf32>, memref<256xf32>, i64, i64, f64, f64) -> ()
+// CHECK:           return [[RES_]] : memref<256x256xf32>
+}
+
+// -----
+
+func.func private @test_gemm_blas_dynamic_no_c(%arg0 : tensor<?x64xf32>, %arg1 : tensor<64x32xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 ="onnx.Gemm"(%arg0, %arg1, %cst) : (tensor<?x64xf32>, tensor<64x32xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_gemm_blas_dynamic_no_c
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x64xf32>, [[PARAM_1_:%.+]]: memref<64x32xf32>) -> memref<?x32xf32> {
+// CHECK-DAG:       [[ZERO_:%.+]] = arith.constant 0.000000e+00 : f64
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x32xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]], [[RES_]], {{.*}}, {{.*}}, {{.*}}, [[ZERO_]]) {funcName = "omTensorGemm"} : (memref<?x32xf32>, memref<?x64xf32>, memref<64x32xf32>, memref<?x32xf32>, i64, i64, f64, f64) -> ()
+// CHECK:           return [[RES_]] : memref<?x32xf32>
+}
+
+// -----
+
+func.func private @test_matmul_blas_batched(%arg0 : tensor<4x128x256xf32>, %arg1 : tensor<256x128xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<4x128x256xf32>, tensor<256x128xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_matmul_blas_batched
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x128x256xf32>, [[PARAM_1_:%.+]]: memref<256x128xf32>) -> memref<4x128x128xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x128x128xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]]) {funcName = "omTensorMatMul"} : (memref<4x128x128xf32>, memref<4x128x256xf32>, memref<256x128xf32>) -> ()
+// CHECK:           return [[RES_]] : memref<4x128x128xf32>
+}
+
+// -----
+
+// COM: Below the threshold.
+
+func.func private @test_matmul_small(%arg0 : tensor<16x16xf32>, %arg1 : tensor<16x16xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<16x16xf32>, tensor<16x16xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_matmul_small
+// CHECK-NOT:       krnl.call
+// CHECK:           krnl.matmul
+}
+
+// -----
+
+// COM: Tuned for the generated code.
+
+func.func private @test_matmul_tuned_krnl(%arg0 : tensor<256x256xf32>, %arg1 : tensor<256x256xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<256x256xf32>, tensor<256x256xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_matmul_tuned_krnl
+// CHECK-NOT:       krnl.call
+// CHECK:           krnl.matmul {{.*}} {aTileSize = [], bTileSize = [], cTileSize = [], computeTileSize = [4, 8, 8]}
+}
+
+// -----
+
+func.func private @test_conv_blas(%arg0 : tensor<1x64x56x56xf32>, %arg1 : tensor<64x64x3x3xf32>, %arg2 : tensor<64xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Conv"(%arg0, %arg1, %arg2) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x64x56x56xf32>, tensor<64x64x3x3xf32>, tensor<64xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_conv_blas
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x64x56x56xf32>, [[PARAM_1_:%.+]]: memref<64x64x3x3xf32>, [[PARAM_2_:%.+]]: memref<64xf32>) -> memref<1x64x56x56xf32> {
+// CHECK-DAG:       [[ONE_:%.+]] = arith.constant 1 : i64
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x64x56x56xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]], [[PARAM_2_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]]) {funcName = "omTensorConv"} : (memref<1x64x56x56xf32>, memref<1x64x56x56xf32>, memref<64x64x3x3xf32>, memref<64xf32>, i64, i64, i64, i64, i64, i64, i64, i64) -> ()
+// CHECK:           return [[RES_]] : memref<1x64x56x56xf32>
+}
+
+// -----
+
+// COM: Tuned for the BLAS library, without bias.
+
+func.func private @test_conv_tuned_blas(%arg0 : tensor<1x3x8x8xf32>, %arg1 : tensor<4x3x3x3xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%arg0, %arg1, %cst) {kernel_shape = [3, 3]} : (tensor<1x3x8x8xf32>, tensor<4x3x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_conv_tuned_blas
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x3x8x8xf32>, [[PARAM_1_:%.+]]: memref<4x3x3x3xf32>) -> memref<1x4x6x6xf32> {
+// CHECK-DAG:       [[ZERO_:%.+]] = arith.constant 0 : i64
+// CHECK-DAG:       [[ONE_:%.+]] = arith.constant 1 : i64
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x4x6x6xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]], [[PARAM_1_]], [[ZERO_]], [[ONE_]], [[ZERO_]], [[ZERO_]], [[ONE_]], [[ONE_]], [[ONE_]], [[ONE_]]) {funcName = "omTensorConv"} : (memref<1x4x6x6xf32>, memref<1x3x8x8xf32>, memref<4x3x3x3xf32>, memref<4x3x3x3xf32>, i64, i64, i64, i64, i64, i64, i64, i64) -> ()
+// CHECK:           return [[RES_]] : memref<1x4x6x6xf32>
+}
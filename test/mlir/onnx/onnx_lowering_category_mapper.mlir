@@ -10,11 +10,12 @@ func.func private @test_category_mapper_string_to_int64(%arg0 : tensor<2x2x!onnx
   // CHECK-LABEL: test_category_mapper_string_to_int64
   // CHECK-DAG: [[ZERO_i64:%.+]] = arith.constant 0 : i64
   // CHECK-DAG: [[LEN:%.+]] = arith.constant 3 : i32
-  // CHECK-DAG: [[ALLOCA:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<2x2xi64>
-  // CHECK-DAG: [[G:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[1, 0, -3]> : tensor<3xi32>} : () -> memref<3xi32>
-  // CHECK-DAG: [[V:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[1, 2, 0]> : tensor<3xi32>} : () -> memref<3xi32>
+  // CHECK-DAG: [[ALLOCA:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2x2xi64>
+  // CHECK-DAG: [[G:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[-3, -2, -1]> : tensor<3xi32>} : () -> memref<3xi32>
+  // CHECK-DAG: [[V:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[2, 1, 0]> : tensor<3xi32>} : () -> memref<3xi32>
   // CHECK-DAG: [[CAT_INT64s:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[1, 2, 3]> : tensor<3xi64>} : () -> memref<3xi64>
   // CHECK-DAG: [[CAT_STRINGS:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<["cat", "dog", "cow"]> : tensor<3x!krnl.string>} : () -> memref<3x!krnl.string>
+  // CHECK-DAG: [[CAT_LENGTHS:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<4> : tensor<3xi64>} : () -> memref<3xi64>
   // CHECK-DAG: [[DEFAULT_INT64:%.+]] = arith.constant -1 : i64
   // CHECK-DAG: [[ZERO:%.+]] = arith.constant 0 : i32
   // CHECK-DAG: [[LOOP_0:%.+]]:2 = krnl.define_loops 2
@@ -24,8 +25,8 @@ func.func private @test_category_mapper_string_to_int64(%arg0 : tensor<2x2x!onnx
   // CHECK:     [[LOAD1:%.+]] = krnl.load [[REF]]{{.}}[[IVS]]#0, [[IVS]]#1{{.}} : memref<2x!krnl.string>
   // CHECK:     [[INDEX:%.+]] = "krnl.find_index"([[LOAD1]], [[G]], [[V]], [[LEN]]) : (!krnl.string, memref<3xi32>, memref<3xi32>, i32) -> index
   // CHECK:     [[LOAD2:%.+]] = krnl.load [[CAT_STRINGS]]{{.}}[[INDEX]]{{.}} : memref<3x!krnl.string>
-  // CHECK:     [[STRLEN:%.+]] = "krnl.strlen"([[LOAD2]]) : (!krnl.string) -> i64
-  // CHECK:     [[STRNCMP:%.+]] = "krnl.strncmp"([[LOAD1]], [[LOAD2]], [[STRLEN]]) : (!krnl.string, !krnl.string, i64) -> i32
+  // CHECK:     [[LENGTH:%.+]] = krnl.load [[CAT_LENGTHS]]{{.}}[[INDEX]]{{.}} : memref<3xi64>
+  // CHECK:     [[STRNCMP:%.+]] = "krnl.strncmp"([[LOAD1]], [[LOAD2]], [[LENGTH]]) : (!krnl.string, !krnl.string, i64) -> i32
   // CHECK:     [[VALID:%.+]] = arith.cmpi eq, [[STRNCMP]], [[ZERO]] : i32
   // CHECK:     scf.if [[VALID]] {
   // CHECK:     [[LOAD3:%.+]] = krnl.load [[CAT_INT64s]]{{.}}[[INDEX]]{{.}} : memref<3xi64>
@@ -45,9 +46,9 @@ func.func private @test_category_mapper_int64_to_string(%arg0 : tensor<2x2xi64>)
 
   // CHECK-LABEL: test_category_mapper_int64_to_string
   // CHECK-DAG: [[LEN:%.+]] = arith.constant 3 : i32  
-  // CHECK-DAG: [[ALLOCA:%.+]] = memref.alloc() {alignment = 16 : i64} : memref<2x2x!krnl.string>
-  // CHECK-DAG: [[G:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[-1, 1, 0]> : tensor<3xi32>} : () -> memref<3xi32>
-  // CHECK-DAG: [[V:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[2, 1, 0]> : tensor<3xi32>} : () -> memref<3xi32>
+  // CHECK-DAG: [[ALLOCA:%.+]] = memref.alloc() {alignment = 64 : i64} : memref<2x2x!krnl.string>
+  // CHECK-DAG: [[G:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[1, -1, 0]> : tensor<3xi32>} : () -> memref<3xi32>
+  // CHECK-DAG: [[V:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[0, 2, 1]> : tensor<3xi32>} : () -> memref<3xi32>
   // CHECK-DAG: [[CAT_INT64s:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<[1, 2, 3]> : tensor<3xi64>} : () -> memref<3xi64>
   // CHECK-DAG: [[CAT_STRINGS:%.+]] = "krnl.global"() {name = {{.*}}, shape = [3], value = dense<["cat", "dog", "cow"]> : tensor<3x!krnl.string>} : () -> memref<3x!krnl.string>
   // CHECK-DAG: [[DEFAULT_STRING:%.+]] = "krnl.global"() {name = {{.*}}, shape = [], value = dense<"none"> : tensor<!krnl.string>} : () -> memref<!krnl.string>
@@ -0,0 +1,53 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that a depthwise convolution computes the output columns whose taps
+// are all in the image 4 at a time with vector loads and fmas, and the ones
+// reaching into the padding one at a time.
+
+func.func @test_conv_depthwise_pad(%x: tensor<1x8x16x16xf32>, %w: tensor<8x1x3x3xf32>, %b: tensor<8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Conv"(%x, %w, %b) {group = 8 : si64, kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x8x16x16xf32>, tensor<8x1x3x3xf32>, tensor<8xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_depthwise_pad
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x8x16x16xf32>, [[W_:%.+]]: memref<8x1x3x3xf32>, [[B_:%.+]]: memref<8xf32>) -> memref<1x8x16x16xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x8x16x16xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 8){
+// CHECK-COUNT-9:     krnl.load [[W_]]{{.}}{{.*}}{{.}} : memref<8x1x3x3xf32>
+// CHECK:             krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<8xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 16){
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 1){
+// CHECK:                 [[IMAGE_:%.+]] = krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x8x16x16xf32>
+// CHECK:                 arith.select {{.*}}, [[IMAGE_]], {{.*}} : f32
+// CHECK:                 krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x8x16x16xf32>
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} -> {{.*}} = 1 to 13){
+// CHECK:                 [[VEC_:%.+]] = vector.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x8x16x16xf32>, vector<4xf32>
+// CHECK:                 [[SEL_:%.+]] = arith.select {{.*}}, [[VEC_]], {{.*}} : vector<4xf32>
+// CHECK:                 vector.fma [[SEL_]], {{.*}}, {{.*}} : vector<4xf32>
+// CHECK-COUNT-8:         vector.fma
+// CHECK:                 vector.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x8x16x16xf32>, vector<4xf32>
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 13 to 16){
+// CHECK:                 krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x8x16x16xf32>
+// CHECK:           return [[RES_]] : memref<1x8x16x16xf32>
+}
+
+// -----
+
+// With a stride of 2, each tap loads 8 contiguous columns of the image, of
+// which every other one is kept.
+
+func.func @test_conv_depthwise_stride(%x: tensor<1x4x17x17xf32>, %w: tensor<4x1x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%x, %w, %none) {group = 4 : si64, kernel_shape = [3, 3], strides = [2, 2]} : (tensor<1x4x17x17xf32>, tensor<4x1x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_depthwise_stride
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} -> {{.*}} = 0 to 4){
+// CHECK:             [[VEC_:%.+]] = vector.load {{.*}} : memref<1x4x17x17xf32>, vector<8xf32>
+// CHECK:             [[STRIDED_:%.+]] = vector.shuffle [[VEC_]], [[VEC_]] [0, 2, 4, 6] : vector<8xf32>, vector<8xf32>
+// CHECK:             vector.fma [[STRIDED_]], {{.*}}, {{.*}} : vector<4xf32>
+// CHECK:             vector.store {{.*}} : memref<1x4x8x8xf32>, vector<4xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 4 to 8){
+// CHECK-NOT:         arith.select
+// CHECK:             krnl.store {{.*}} : memref<1x4x8x8xf32>
+// CHECK:           return {{.*}} : memref<1x4x8x8xf32>
+}
@@ -0,0 +1,72 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the direct loop nest computes blocks of 4 output channels, with
+// one reduction value each, the loop over the channels of a block being
+// unrolled and jammed into the reduction loops.
+
+func.func @test_conv_direct_channel_block(%x: tensor<1x1x8x8xf32>, %w: tensor<8x1x3x3xf32>, %b: tensor<8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3]} : (tensor<1x1x8x8xf32>, tensor<8x1x3x3xf32>, tensor<8xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_direct_channel_block
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x1x8x8xf32>, [[W_:%.+]]: memref<8x1x3x3xf32>, [[B_:%.+]]: memref<8xf32>) -> memref<1x8x6x6xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x8x6x6xf32>
+// CHECK-DAG:       [[ACC_:%.+]] = memref.alloca() : memref<4xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 1, {{.*}} = 0 to 2){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 6, {{.*}} = 0 to 6){
+// CHECK:               [[LOOP_:%.+]] = krnl.define_loops 1
+// CHECK:               krnl.unroll_jam [[LOOP_]] 4 : !krnl.loop
+// CHECK:               krnl.iterate([[LOOP_]]) with ([[LOOP_]] -> [[I_:%.+]] = 0 to 4){
+// CHECK:                 krnl.store {{.*}}, [[ACC_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:                 krnl.iterate({{.*}}) with ({{.*}}){
+// CHECK-DAG:               [[IMAGE_:%.+]] = krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x1x8x8xf32>
+// CHECK-DAG:               [[FILTER_:%.+]] = krnl.load [[W_]]{{.}}{{.*}}{{.}} : memref<8x1x3x3xf32>
+// CHECK-DAG:               [[RED_:%.+]] = krnl.load [[ACC_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:                   [[MUL_:%.+]] = arith.mulf [[IMAGE_]], [[FILTER_]] : f32
+// CHECK:                   [[SUM_:%.+]] = arith.addf [[RED_]], [[MUL_]] : f32
+// CHECK:                   krnl.store [[SUM_]], [[ACC_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:                 }
+// CHECK:                 [[RESULT_:%.+]] = krnl.load [[ACC_]]{{.}}[[I_]]{{.}} : memref<4xf32>
+// CHECK:                 [[BIAS_:%.+]] = krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<8xf32>
+// CHECK:                 [[OUT_:%.+]] = arith.addf [[RESULT_]], [[BIAS_]] : f32
+// CHECK:                 krnl.store [[OUT_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x8x6x6xf32>
+// CHECK:           return [[RES_]] : memref<1x8x6x6xf32>
+}
+
+// -----
+
+// The number of output channels is not a multiple of the block, they are
+// computed one at a time.
+
+func.func @test_conv_direct_no_channel_block(%x: tensor<1x1x8x8xf32>, %w: tensor<6x1x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%x, %w, %none) {kernel_shape = [3, 3]} : (tensor<1x1x8x8xf32>, tensor<6x1x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_direct_no_channel_block
+// CHECK:           memref.alloca() : memref<f32>
+// CHECK-NOT:       krnl.unroll_jam
+// CHECK:           return {{.*}} : memref<1x6x6x6xf32>
+}
+
+// -----
+
+// Check that the uint8 NHWC image cast and transposed to NCHW is read on load
+// by the convolution, without materializing the cast nor the transpose.
+
+func.func @test_conv_direct_uint8_nhwc(%x: tensor<1x8x8x1xui8>, %w: tensor<8x1x3x3xf32>, %b: tensor<8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Cast"(%x) {to = f32} : (tensor<1x8x8x1xui8>) -> tensor<1x8x8x1xf32>
+  %1 = "onnx.Transpose"(%0) {perm = [0, 3, 1, 2]} : (tensor<1x8x8x1xf32>) -> tensor<*xf32>
+  %2 = "onnx.Conv"(%1, %w, %b) {kernel_shape = [3, 3]} : (tensor<*xf32>, tensor<8x1x3x3xf32>, tensor<8xf32>) -> tensor<*xf32>
+  "func.return"(%2) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_direct_uint8_nhwc
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x8x8x1xui8>, [[W_:%.+]]: memref<8x1x3x3xf32>, [[B_:%.+]]: memref<8xf32>) -> memref<1x8x6x6xf32> {
+// CHECK-NOT:       memref<1x8x8x1xf32>
+// CHECK-NOT:       memref<1x1x8x8xf32>
+// CHECK:           [[IMAGE_:%.+]] = krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x8x8x1xui8>
+// CHECK:           [[SIGNLESS_:%.+]] = builtin.unrealized_conversion_cast [[IMAGE_]] : ui8 to i8
+// CHECK:           [[FLOAT_:%.+]] = arith.uitofp [[SIGNLESS_]] : i8 to f32
+// CHECK:           arith.mulf [[FLOAT_]], {{.*}} : f32
+// CHECK:           return {{.*}} : memref<1x8x6x6xf32>
+}
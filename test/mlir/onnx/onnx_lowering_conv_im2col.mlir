@@ -0,0 +1,42 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that a large enough convolution is lowered to an im2col buffer of
+// [CI * KH * KW, HO * WO] elements, zero in the padding, multiplied by the
+// filter viewed as a [CO, CI * KH * KW] matrix with krnl.matmul.
+
+func.func @test_conv_im2col_pad(%x: tensor<1x3x16x16xf32>, %w: tensor<8x3x3x3xf32>, %b: tensor<8xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x3x16x16xf32>, tensor<8x3x3x3xf32>, tensor<8xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_im2col_pad
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x3x16x16xf32>, [[W_:%.+]]: memref<8x3x3x3xf32>, [[B_:%.+]]: memref<8xf32>) -> memref<1x8x16x16xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x8x16x16xf32>
+// CHECK-DAG:       [[FILTER_:%.+]] = memref.reinterpret_cast [[W_]] to offset: [0], sizes: [8, 27], strides: [27, 1] : memref<8x3x3x3xf32> to memref<8x27xf32>
+// CHECK-DAG:       [[RES_VIEW_:%.+]] = memref.reinterpret_cast [[RES_]] to offset: [0], sizes: [1, 8, 256], strides: [2048, 256, 1] : memref<1x8x16x16xf32> to memref<1x8x256xf32>
+// CHECK-DAG:       [[COL_:%.+]] = memref.alloc() {{.*}}: memref<27x256xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 3, {{.*}} = 0 to 3, {{.*}} = 0 to 3, {{.*}} = 0 to 16, {{.*}} = 0 to 16){
+// CHECK:               [[IMAGE_:%.+]] = krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x3x16x16xf32>
+// CHECK:               [[VAL_:%.+]] = arith.select {{.*}}, [[IMAGE_]], {{.*}} : f32
+// CHECK:               krnl.store [[VAL_]], [[COL_]]{{.}}{{.*}}{{.}} : memref<27x256xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 8, {{.*}} = 0 to 256){
+// CHECK:               [[BIAS_:%.+]] = krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<8xf32>
+// CHECK:               krnl.store [[BIAS_]], [[RES_VIEW_]]{{.}}{{.*}}{{.}} : memref<1x8x256xf32>
+// CHECK:             krnl.matmul [[FILTER_]]{{.}}{{.*}}{{.}}, [[COL_]]{{.}}{{.*}}{{.}}, [[RES_VIEW_]]{{.}}{{.*}}{{.}}, {{.*}} {aTileSize = [], bTileSize = [], cTileSize = [], computeTileSize = [4, 8, 8]} : memref<8x27xf32>, memref<27x256xf32>, memref<1x8x256xf32>
+// CHECK:           return [[RES_]] : memref<1x8x16x16xf32>
+}
+
+// -----
+
+// The convolution has too few output channels, it is lowered to the direct
+// loop nest.
+
+func.func @test_conv_im2col_small(%x: tensor<1x3x16x16xf32>, %w: tensor<4x3x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%x, %w, %none) {kernel_shape = [3, 3]} : (tensor<1x3x16x16xf32>, tensor<4x3x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_im2col_small
+// CHECK-NOT:       krnl.matmul
+// CHECK:           return {{.*}} : memref<1x4x14x14xf32>
+}
@@ -0,0 +1,55 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that a 2D transposed convolution of static shapes is lowered to the
+// multiplication of the transposed filter, a [COPerGroup * KH * KW, CI] matrix,
+// by the input viewed as a [CI, H * W] matrix with krnl.matmul, followed by
+// the col2im of the column buffer into the output, vectorized along the
+// output width.
+
+func.func @test_conv_transpose_gemm(%x: tensor<1x4x8x8xf32>, %w: tensor<4x2x3x3xf32>, %b: tensor<2xf32>) -> tensor<*xf32> {
+  %0 = "onnx.ConvTranspose"(%x, %w, %b) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x4x8x8xf32>, tensor<4x2x3x3xf32>, tensor<2xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_transpose_gemm
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x4x8x8xf32>, [[W_:%.+]]: memref<4x2x3x3xf32>, [[B_:%.+]]: memref<2xf32>) -> memref<1x2x8x8xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x2x8x8xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 2, {{.*}} = 0 to 8, {{.*}} = 0 to 8){
+// CHECK:             [[BIAS_:%.+]] = krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<2xf32>
+// CHECK:             krnl.store [[BIAS_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x2x8x8xf32>
+// CHECK-DAG:       [[WT_:%.+]] = memref.alloc() {{.*}}: memref<1x18x4xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 4, {{.*}} = 0 to 2, {{.*}} = 0 to 3, {{.*}} = 0 to 3){
+// CHECK:             [[FILTER_:%.+]] = krnl.load [[W_]]{{.}}{{.*}}{{.}} : memref<4x2x3x3xf32>
+// CHECK:             krnl.store [[FILTER_]], [[WT_]]{{.}}{{.*}}{{.}} : memref<1x18x4xf32>
+// CHECK-DAG:       [[X_VIEW_:%.+]] = memref.reinterpret_cast [[X_]] to offset: [0], sizes: [1, 1, 4, 64], strides: [256, 256, 64, 1] : memref<1x4x8x8xf32> to memref<1x1x4x64xf32>
+// CHECK-DAG:       [[COL_:%.+]] = memref.alloc() {{.*}}: memref<18x64xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 1){
+// CHECK:             krnl.memset [[COL_]], {{.*}} : memref<18x64xf32>
+// CHECK:             krnl.matmul [[WT_]]{{.}}{{.*}}{{.}}, [[X_VIEW_]]{{.}}{{.*}}{{.}}, [[COL_]]{{.}}{{.*}}{{.}}, {{.*}} {aTileSize = [], bTileSize = [], cTileSize = [], computeTileSize = [4, 8, 4]} : memref<1x18x4xf32>, memref<1x1x4x64xf32>, memref<18x64xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 2){
+// CHECK:               [[CONTRIB_:%.+]] = vector.load [[COL_]]{{.}}{{.*}}{{.}} : memref<18x64xf32>, vector<4xf32>
+// CHECK:               [[OUT_:%.+]] = vector.load [[RES_]]{{.}}{{.*}}{{.}} : memref<1x2x8x8xf32>, vector<4xf32>
+// CHECK:               [[SUM_:%.+]] = arith.addf [[OUT_]], [[CONTRIB_]] : vector<4xf32>
+// CHECK:               vector.store [[SUM_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x2x8x8xf32>, vector<4xf32>
+// CHECK:           return [[RES_]] : memref<1x2x8x8xf32>
+}
+
+// -----
+
+// A transposed convolution of dynamic shapes is lowered to the direct loop
+// nest, scattering each input value into the output.
+
+func.func @test_conv_transpose_dynamic(%x: tensor<?x4x?x?xf32>, %w: tensor<4x2x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.ConvTranspose"(%x, %w, %none) {kernel_shape = [3, 3], strides = [2, 2], output_padding = [1, 1], pads = [1, 1, 1, 1]} : (tensor<?x4x?x?xf32>, tensor<4x2x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_transpose_dynamic
+// CHECK-NOT:       krnl.matmul
+// CHECK:           krnl.memset
+// CHECK:           [[FILTER_:%.+]] = krnl.load {{.*}} : memref<4x2x3x3xf32>
+// CHECK:           [[IMAGE_:%.+]] = krnl.load {{.*}} : memref<?x4x?x?xf32>
+// CHECK:           [[OUT_:%.+]] = krnl.load {{.*}} : memref<?x2x?x?xf32>
+// CHECK:           [[PROD_:%.+]] = arith.mulf [[IMAGE_]], [[FILTER_]] : f32
+// CHECK:           [[SUM_:%.+]] = arith.addf [[OUT_]], [[PROD_]] : f32
+// CHECK:           krnl.store [[SUM_]], {{.*}} : memref<?x2x?x?xf32>
+}
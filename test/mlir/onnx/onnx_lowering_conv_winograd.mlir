@@ -0,0 +1,66 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that a 3x3 convolution of stride 1 with enough channels is lowered
+// with Winograd F(4x4, 3x3): the constant filter is transformed at compile
+// time into 36 matrices multiplying the transformed input tiles.
+
+func.func @test_conv_winograd_f4x4_constant_filter(%x: tensor<1x32x8x8xf32>, %b: tensor<32xf32>) -> tensor<*xf32> {
+  %w = onnx.Constant dense<1.000000e+00> : tensor<32x32x3x3xf32>
+  %0 = "onnx.Conv"(%x, %w, %b) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x32x8x8xf32>, tensor<32x32x3x3xf32>, tensor<32xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_winograd_f4x4_constant_filter
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x32x8x8xf32>, [[B_:%.+]]: memref<32xf32>) -> memref<1x32x8x8xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x32x8x8xf32>
+// CHECK-DAG:       [[U_:%.+]] = "krnl.global"() {alignment = 128 : i64, name = "winograd_filter_{{.*}}", shape = [36, 32, 32], value = dense<{{.*}}> : tensor<36x32x32xf32>} : () -> memref<36x32x32xf32>
+// CHECK-DAG:       [[V_:%.+]] = memref.alloc() {{.*}}: memref<36x32x4xf32>
+// CHECK-DAG:       [[M_:%.+]] = memref.alloc() {{.*}}: memref<36x32x4xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 32, {{.*}} = 0 to 2, {{.*}} = 0 to 2){
+// CHECK:               krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<1x32x8x8xf32>
+// CHECK:               krnl.store {{.*}}, [[V_]]{{.}}{{.*}}{{.}} : memref<36x32x4xf32>
+// CHECK:             krnl.memset [[M_]], {{.*}} : memref<36x32x4xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 36){
+// CHECK:               krnl.matmul [[U_]]{{.}}{{.*}}{{.}}, [[V_]]{{.}}{{.*}}{{.}}, [[M_]]{{.}}{{.*}}{{.}}, {{.*}} : memref<36x32x32xf32>, memref<36x32x4xf32>, memref<36x32x4xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 32, {{.*}} = 0 to 2, {{.*}} = 0 to 2){
+// CHECK:               krnl.load [[M_]]{{.}}{{.*}}{{.}} : memref<36x32x4xf32>
+// CHECK:               krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<32xf32>
+// CHECK:               krnl.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x32x8x8xf32>
+// CHECK:           return [[RES_]] : memref<1x32x8x8xf32>
+}
+
+// -----
+
+// Winograd F(2x2, 3x3) for a small output, the filter of the function
+// argument being transformed at runtime.
+
+func.func @test_conv_winograd_f2x2(%x: tensor<1x32x6x6xf32>, %w: tensor<32x32x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%x, %w, %none) {kernel_shape = [3, 3]} : (tensor<1x32x6x6xf32>, tensor<32x32x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_winograd_f2x2
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x32x6x6xf32>, [[W_:%.+]]: memref<32x32x3x3xf32>) -> memref<1x32x4x4xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x32x4x4xf32>
+// CHECK-DAG:       [[U_:%.+]] = memref.alloc() {{.*}}: memref<16x32x32xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 32, {{.*}} = 0 to 32){
+// CHECK:             krnl.load [[W_]]{{.}}{{.*}}{{.}} : memref<32x32x3x3xf32>
+// CHECK:             krnl.store {{.*}}, [[U_]]{{.}}{{.*}}{{.}} : memref<16x32x32xf32>
+// CHECK:           krnl.matmul [[U_]]{{.}}{{.*}}{{.}}, {{.*}} : memref<16x32x32xf32>, memref<16x32x4xf32>, memref<16x32x4xf32>
+// CHECK:           return [[RES_]] : memref<1x32x4x4xf32>
+}
+
+// -----
+
+// Too few channels for Winograd with the default threshold.
+
+func.func @test_conv_winograd_few_channels(%x: tensor<1x8x16x16xf32>, %w: tensor<8x8x3x3xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Conv"(%x, %w, %none) {kernel_shape = [3, 3], pads = [1, 1, 1, 1]} : (tensor<1x8x16x16xf32>, tensor<8x8x3x3xf32>, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_conv_winograd_few_channels
+// CHECK-NOT:       memref<16x8x8xf32>
+// CHECK-NOT:       memref<36x8x8xf32>
+// CHECK:           return {{.*}} : memref<1x8x16x16xf32>
+}
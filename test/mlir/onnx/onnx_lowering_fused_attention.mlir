@@ -0,0 +1,92 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the fused attention is lowered to loops over the queries, with
+// an inner loop over tiles of 64 keys whose scores are kept in a small
+// buffer, and an online softmax rescaling the accumulator of each query.
+
+func.func @test_fused_attention(%q: tensor<2x8x16xf32>, %k: tensor<2x16x100xf32>, %v: tensor<2x100x32xf32>, %mask: tensor<1x100xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.FusedAttention"(%q, %k, %v, %mask, %none, %none, %none) {scale = 2.500000e-01 : f32} : (tensor<2x8x16xf32>, tensor<2x16x100xf32>, tensor<2x100x32xf32>, tensor<1x100xf32>, none, none, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fused_attention
+// CHECK-SAME:   ([[Q_:%.+]]: memref<2x8x16xf32>, [[K_:%.+]]: memref<2x16x100xf32>, [[V_:%.+]]: memref<2x100x32xf32>, [[MASK_:%.+]]: memref<1x100xf32>) -> memref<2x8x32xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x8x32xf32>
+// CHECK-DAG:       [[SCORES_:%.+]] = memref.alloca() {{.*}}: memref<64xf32>
+// CHECK-DAG:       [[ACC_:%.+]] = memref.alloc() {{.*}}: memref<32xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 2, {{.*}} = 0 to 8){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 100){
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 16){
+// CHECK:                 vector.load [[K_]]{{.}}{{.*}}{{.}} : memref<2x16x100xf32>, vector<16xf32>
+// CHECK:               vector.load [[MASK_]]{{.}}{{.*}}{{.}} : memref<1x100xf32>, vector<16xf32>
+// CHECK:             vector.reduction <maxf>, {{.*}} : vector<16xf32> into f32
+// CHECK:             math.exp {{.*}} : vector<16xf32>
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:                 vector.load [[V_]]{{.}}{{.*}}{{.}} : memref<2x100x32xf32>, vector<16xf32>
+// CHECK:             vector.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<2x8x32xf32>, vector<16xf32>
+// CHECK:           return [[RES_]] : memref<2x8x32xf32>
+}
+
+// -----
+
+func.func @test_fused_attention_no_mask_dynamic(%q: tensor<?x5x8xf32>, %k: tensor<?x8x?xf32>, %v: tensor<?x?x8xf32>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.FusedAttention"(%q, %k, %v, %none, %none, %none, %none) : (tensor<?x5x8xf32>, tensor<?x8x?xf32>, tensor<?x?x8xf32>, none, none, none, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fused_attention_no_mask_dynamic
+// CHECK-SAME:   ([[Q_:%.+]]: memref<?x5x8xf32>, [[K_:%.+]]: memref<?x8x?xf32>, [[V_:%.+]]: memref<?x?x8xf32>) -> memref<?x5x8xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x5x8xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to {{.*}}, {{.*}} = 0 to 5){
+// CHECK:             math.exp {{.*}} : f32
+// CHECK:           return [[RES_]] : memref<?x5x8xf32>
+}
+
+// -----
+
+// Check that with packed sequences, the range of keys of each token is
+// computed first, and that the tiles of keys of a query only cover its range.
+
+func.func @test_fused_attention_packed_sequences(%q: tensor<1x4x?x16xf32>, %k: tensor<1x4x16x?xf32>, %v: tensor<1x4x?x16xf32>, %offsets: tensor<?xi64>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.FusedAttention"(%q, %k, %v, %none, %offsets, %none, %none) {scale = 2.500000e-01 : f32} : (tensor<1x4x?x16xf32>, tensor<1x4x16x?xf32>, tensor<1x4x?x16xf32>, none, tensor<?xi64>, none, none) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fused_attention_packed_sequences
+// CHECK-SAME:   ([[Q_:%.+]]: memref<1x4x?x16xf32>, [[K_:%.+]]: memref<1x4x16x?xf32>, [[V_:%.+]]: memref<1x4x?x16xf32>, [[OFFSETS_:%.+]]: memref<?xi64>) -> memref<1x4x?x16xf32> {
+// CHECK-DAG:       [[START_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?xindex>
+// CHECK-DAG:       [[END_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?xindex>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to {{.*}}){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to {{.*}}){
+// CHECK:               krnl.load [[OFFSETS_]]{{.}}{{.*}}{{.}} : memref<?xi64>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 4, {{.*}} = 0 to {{.*}}){
+// CHECK:             krnl.region {
+// CHECK:               [[BEGIN_:%.+]] = krnl.load [[START_]]{{.}}{{.*}}{{.}} : memref<?xindex>
+// CHECK:               [[KEY_END_:%.+]] = krnl.load [[END_]]{{.}}{{.*}}{{.}} : memref<?xindex>
+// CHECK:               math.exp {{.*}} : vector<16xf32>
+// CHECK:               arith.select {{.*}} : f32
+}
+
+// -----
+
+// Check that with a block table, the keys and values are read from the
+// blocks of the caches, the score of each key being a dot product over the
+// head dim, and that the number of keys is loaded from the key length.
+
+func.func @test_fused_attention_paged(%q: tensor<2x4x1x16xf32>, %k: tensor<?x4x?x16xf32>, %v: tensor<?x4x?x16xf32>, %table: tensor<2x?xi64>, %length: tensor<1xi64>) -> tensor<*xf32> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.FusedAttention"(%q, %k, %v, %none, %none, %table, %length) {scale = 2.500000e-01 : f32} : (tensor<2x4x1x16xf32>, tensor<?x4x?x16xf32>, tensor<?x4x?x16xf32>, none, none, tensor<2x?xi64>, tensor<1xi64>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fused_attention_paged
+// CHECK-SAME:   ([[Q_:%.+]]: memref<2x4x1x16xf32>, [[K_:%.+]]: memref<?x4x?x16xf32>, [[V_:%.+]]: memref<?x4x?x16xf32>, [[TABLE_:%.+]]: memref<2x?xi64>, [[LENGTH_:%.+]]: memref<1xi64>) -> memref<2x4x1x16xf32> {
+// CHECK:           krnl.load [[LENGTH_]]{{.}}{{.*}}{{.}} : memref<1xi64>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 2, {{.*}} = 0 to 4, {{.*}} = 0 to 1){
+// CHECK:             krnl.load [[TABLE_]]{{.}}{{.*}}{{.}} : memref<2x?xi64>
+// CHECK:             vector.load [[Q_]]{{.}}{{.*}}{{.}} : memref<2x4x1x16xf32>, vector<16xf32>
+// CHECK:             vector.load [[K_]]{{.}}{{.*}}{{.}} : memref<?x4x?x16xf32>, vector<16xf32>
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             vector.reduction <maxf>, {{.*}} : vector<16xf32> into f32
+// CHECK:             krnl.load [[TABLE_]]{{.}}{{.*}}{{.}} : memref<2x?xi64>
+// CHECK:             vector.load [[V_]]{{.}}{{.*}}{{.}} : memref<?x4x?x16xf32>, vector<16xf32>
+}
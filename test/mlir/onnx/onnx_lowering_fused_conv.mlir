@@ -0,0 +1,26 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the activations of the fused convolution are applied to each
+// output value after the bias, right before it is stored.
+
+func.func @test_fused_conv_leakyrelu_clip(%x: tensor<1x3x8x8xf32>, %w: tensor<4x3x3x3xf32>, %b: tensor<4xf32>) -> tensor<*xf32> {
+  %0 = "onnx.FusedConv"(%x, %w, %b) {activations = ["LeakyRelu", "Clip"], activation_alpha = [1.250000e-01 : f32, 0.000000e+00 : f32], activation_beta = [0.000000e+00 : f32, 6.000000e+00 : f32], kernel_shape = [3, 3]} : (tensor<1x3x8x8xf32>, tensor<4x3x3x3xf32>, tensor<4xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fused_conv_leakyrelu_clip
+// CHECK-SAME:   ([[X_:%.+]]: memref<1x3x8x8xf32>, [[W_:%.+]]: memref<4x3x3x3xf32>, [[B_:%.+]]: memref<4xf32>) -> memref<1x4x6x6xf32> {
+// CHECK-DAG:       [[CST_0_:%.+]] = arith.constant 0.000000e+00 : f32
+// CHECK-DAG:       [[CST_ALPHA_:%.+]] = arith.constant 1.250000e-01 : f32
+// CHECK-DAG:       [[CST_6_:%.+]] = arith.constant 6.000000e+00 : f32
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x4x6x6xf32>
+// CHECK:           krnl.iterate
+// CHECK:             [[BIAS_:%.+]] = krnl.load [[B_]]{{.}}{{.*}}{{.}} : memref<4xf32>
+// CHECK:             [[VAR_SUM_:%.+]] = arith.addf {{.*}}, [[BIAS_]] : f32
+// CHECK-DAG:         [[VAR_NEG_:%.+]] = arith.cmpf olt, [[VAR_SUM_]], [[CST_0_]] : f32
+// CHECK-DAG:         [[VAR_MUL_:%.+]] = arith.mulf [[VAR_SUM_]], [[CST_ALPHA_]] : f32
+// CHECK:             [[VAR_LEAKY_:%.+]] = arith.select [[VAR_NEG_]], [[VAR_MUL_]], [[VAR_SUM_]] : f32
+// CHECK:             [[VAR_MAX_:%.+]] = arith.maxf [[VAR_LEAKY_]], [[CST_0_]] : f32
+// CHECK:             [[VAR_MIN_:%.+]] = arith.minf [[VAR_MAX_]], [[CST_6_]] : f32
+// CHECK:             krnl.store [[VAR_MIN_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x4x6x6xf32>
+// CHECK:           return [[RES_]] : memref<1x4x6x6xf32>
+}
@@ -0,0 +1,71 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-krnl=enable-fusion --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that chains of elementwise ops are computed in a single loop nest,
+// without intermediate buffers.
+
+// -----
+
+func.func @test_fuse_add_relu_mul_sigmoid(%arg0 : tensor<16x32xf32>, %arg1 : tensor<16x32xf32>, %arg2 : tensor<32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<16x32xf32>, tensor<16x32xf32>) -> tensor<*xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<*xf32>) -> tensor<*xf32>
+  %2 = "onnx.Mul"(%arg2, %1) : (tensor<32xf32>, tensor<*xf32>) -> tensor<*xf32>
+  %3 = "onnx.Sigmoid"(%2) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%3) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_fuse_add_relu_mul_sigmoid
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<16x32xf32>, [[PARAM_1_:%.+]]: memref<16x32xf32>, [[PARAM_2_:%.+]]: memref<32xf32>) -> memref<16x32xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK-NOT:       memref.alloc
+// CHECK:           krnl.iterate
+// CHECK-DAG:         [[LOAD_PARAM_0_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[I_0_:%.+]], [[I_1_:%.+]]{{.}} : memref<16x32xf32>
+// CHECK-DAG:         [[LOAD_PARAM_1_:%.+]] = krnl.load [[PARAM_1_]]{{.}}[[I_0_]], [[I_1_]]{{.}} : memref<16x32xf32>
+// CHECK:             [[VAR_ADD_:%.+]] = arith.addf [[LOAD_PARAM_0_]], [[LOAD_PARAM_1_]] : f32
+// CHECK:             [[LOAD_PARAM_2_:%.+]] = krnl.load [[PARAM_2_]]{{.}}[[I_1_]]{{.}} : memref<32xf32>
+// CHECK:             [[VAR_MUL_:%.+]] = arith.mulf [[LOAD_PARAM_2_]], {{.*}} : f32
+// CHECK:             math.exp
+// CHECK:             krnl.store {{.*}}, [[RES_]]{{.}}[[I_0_]], [[I_1_]]{{.}} : memref<16x32xf32>
+// CHECK-NOT:       krnl.iterate
+// CHECK:           return [[RES_]] : memref<16x32xf32>
+}
+
+// -----
+
+// A value with several users is stored in its own buffer.
+
+func.func @test_no_fuse_multiple_uses(%arg0 : tensor<16x32xf32>, %arg1 : tensor<16x32xf32>) -> (tensor<*xf32>, tensor<*xf32>) {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<16x32xf32>, tensor<16x32xf32>) -> tensor<*xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_no_fuse_multiple_uses
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK:           krnl.iterate
+// CHECK:             arith.addf
+// CHECK:           [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK:           krnl.iterate
+// CHECK:           return [[RES_]], [[RES_1_]] : memref<16x32xf32>, memref<16x32xf32>
+}
+
+// -----
+
+// An operand defined after the root of the chain stops the fusion, so Mul is
+// fused with Exp instead of Relu.
+
+func.func @test_no_fuse_late_operand(%arg0 : tensor<16x32xf32>, %arg1 : tensor<16x32xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<16x32xf32>) -> tensor<*xf32>
+  %1 = "onnx.Exp"(%arg1) : (tensor<16x32xf32>) -> tensor<*xf32>
+  %2 = "onnx.Mul"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> tensor<*xf32>
+  "func.return"(%2) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_no_fuse_late_operand
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK:           krnl.iterate
+// CHECK:             arith.select
+// CHECK:           [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK:           krnl.iterate
+// CHECK:             [[VAR_EXP_:%.+]] = math.exp
+// CHECK:             [[LOAD_RES_:%.+]] = krnl.load [[RES_]]
+// CHECK:             arith.mulf [[LOAD_RES_]], [[VAR_EXP_]] : f32
+// CHECK-NOT:       memref.alloc
+// CHECK:           return [[RES_1_]] : memref<16x32xf32>
+}
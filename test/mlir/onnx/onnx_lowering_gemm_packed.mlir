@@ -0,0 +1,72 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+// RUN: echo '{"matmul_tiles": [{"mcpu": "z16", "op": "Gemm", "shape": [2, 6, 3], "reg": [1, 2, 2], "cache": [2, 4, 2]}]}' > %t.json
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl="matmul-tile-db=%t.json target-cpu=z16" --canonicalize %s -split-input-file | FileCheck %s --check-prefix=TILED
+
+// Check that a constant B of the tiled Gemm is packed at compile time in the
+// layout of its tile buffers, and used in place instead of being copied.
+
+// -----
+
+func.func @test_gemm_packed_b(%arg0 : tensor<128x256xf32>, %arg2 : tensor<512xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<256x512xf32>
+  %1 ="onnx.Gemm"(%arg0, %0, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32} : (tensor<128x256xf32>, tensor<256x512xf32>, tensor<512xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_packed_b
+// CHECK:           [[PACKED_:%.+]] = "krnl.global"() {alignment = 128 : i64, name = "packed_constant_{{.*}}", shape = [2048, 64], value = dense<1.000000e+00> : tensor<2048x64xf32>} : () -> memref<2048x64xf32>
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<128x512xf32>
+// CHECK:           memref.alloc() {{.*}}: memref<32x256xf32>
+// CHECK-NOT:       memref.alloc() {{.*}}: memref<256x64xf32>
+// CHECK:           krnl.copy_to_tile_buffer {{.*}} : memref<32x256xf32>, memref<128x256xf32>
+// CHECK-NOT:       krnl.copy_to_tile_buffer {{.*}} memref<256x512xf32>
+// CHECK:           krnl.matmul {{.*}}, [[PACKED_]]{{.*}} : memref<32x256xf32>, memref<2048x64xf32>
+// CHECK:           return [[RES_]] : memref<128x512xf32>
+}
+
+// -----
+
+// A constant transposed B is packed as well.
+
+func.func @test_gemm_packed_b_trans(%arg0 : tensor<128x256xf32>, %arg2 : tensor<512xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<512x256xf32>
+  %1 ="onnx.Gemm"(%arg0, %0, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32, transB = 1 : si64} : (tensor<128x256xf32>, tensor<512x256xf32>, tensor<512xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_packed_b_trans
+// CHECK:           [[PACKED_:%.+]] = "krnl.global"() {alignment = 128 : i64, name = "packed_constant_{{.*}}", shape = [2048, 64], value = dense<1.000000e+00> : tensor<2048x64xf32>} : () -> memref<2048x64xf32>
+// CHECK:           krnl.matmul {{.*}}, [[PACKED_]]{{.*}} : memref<32x256xf32>, memref<2048x64xf32>
+}
+
+// -----
+
+// B is not packed when padding its panels would more than double its size.
+
+func.func @test_gemm_small_b_not_packed(%arg0 : tensor<128x256xf32>, %arg2 : tensor<16xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<256x16xf32>
+  %1 ="onnx.Gemm"(%arg0, %0, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32} : (tensor<128x256xf32>, tensor<256x16xf32>, tensor<16xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_small_b_not_packed
+// CHECK-NOT:       packed_constant_
+// CHECK:           krnl.copy_to_tile_buffer {{.*}} : memref<256x64xf32>, memref<256x16xf32>
+}
+
+// -----
+
+// With cache tiles of 4 columns and 2 rows, the element (k, j) of B is at
+// ((j / 4) * 3 + k) * 4 + j % 4 in the packed B, made of the panels of the
+// columns [0, 4) and [4, 6), padded with zeros, each of the 3 rows of B. The
+// tiles of the panel of j1 then start at the row -(j1 / 4) * 3 of the packed
+// B, so that the row k1 of the tile is the row (j1 / 4) * 3 + k1 of its panel.
+
+func.func @test_gemm_packed_b_panels(%arg0 : tensor<2x3xf32>, %arg2 : tensor<6xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<[[0.0, 1.0, 2.0, 3.0, 4.0, 5.0], [10.0, 11.0, 12.0, 13.0, 14.0, 15.0], [20.0, 21.0, 22.0, 23.0, 24.0, 25.0]]> : tensor<3x6xf32>
+  %1 ="onnx.Gemm"(%arg0, %0, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32} : (tensor<2x3xf32>, tensor<3x6xf32>, tensor<6xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// TILED-DAG:   [[MAP_PANEL_:#.+]] = affine_map<(d0) -> ((d0 floordiv 4) * -3)>
+// TILED-LABEL:  func.func @test_gemm_packed_b_panels
+// TILED:           [[PACKED_:%.+]] = "krnl.global"() {alignment = 128 : i64, name = "packed_constant_{{.*}}", shape = [6, 4], value = dense<{{\[\[}}0.000000e+00, 1.000000e+00, 2.000000e+00, 3.000000e+00], [1.000000e+01, 1.100000e+01, 1.200000e+01, 1.300000e+01], [2.000000e+01, 2.100000e+01, 2.200000e+01, 2.300000e+01], [4.000000e+00, 5.000000e+00, 0.000000e+00, 0.000000e+00], [1.400000e+01, 1.500000e+01, 0.000000e+00, 0.000000e+00], [2.400000e+01, 2.500000e+01, 0.000000e+00, 0.000000e+00]]> : tensor<6x4xf32>} : () -> memref<6x4xf32>
+// TILED:           [[PANEL_START_:%.+]] = affine.apply [[MAP_PANEL_]]([[J1_:%.+]])
+// TILED:           krnl.matmul {{.*}}, [[PACKED_]]{{.}}[[PANEL_START_]], [[J1_]]{{.}}, {{.*}} : memref<2x2xf32>, memref<6x4xf32>, memref<2x6xf32>
+}
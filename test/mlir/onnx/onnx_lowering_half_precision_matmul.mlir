@@ -0,0 +1,54 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the matrix multiplications read the half precision weights
+// before their Cast to f32, which is not materialized.
+
+// -----
+
+func.func @test_matmul_f16_weight(%arg0: tensor<16x32xf32>) -> tensor<16x64xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<32x64xf16>
+  %1 = "onnx.Cast"(%0) {to = f32} : (tensor<32x64xf16>) -> tensor<32x64xf32>
+  %2 = "onnx.MatMul"(%arg0, %1) : (tensor<16x32xf32>, tensor<32x64xf32>) -> tensor<16x64xf32>
+  return %2 : tensor<16x64xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_f16_weight
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<16x32xf32>) -> memref<16x64xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = "krnl.global"() {{.*}} : () -> memref<32x64xf16>
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x64xf32>
+// CHECK-NOT:       memref<32x64xf32>
+// CHECK:           krnl.matmul [[PARAM_0_]]{{.*}}, [[VAR_0_]]{{.*}}, [[RES_]]{{.*}} : memref<16x32xf32>, memref<32x64xf16>, memref<16x64xf32>
+// CHECK:           return [[RES_]] : memref<16x64xf32>
+}
+
+// -----
+
+func.func @test_matmul_1d_bf16_weight(%arg0: tensor<32xf32>) -> tensor<64xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<32x64xbf16>
+  %1 = "onnx.Cast"(%0) {to = f32} : (tensor<32x64xbf16>) -> tensor<32x64xf32>
+  %2 = "onnx.MatMul"(%arg0, %1) : (tensor<32xf32>, tensor<32x64xf32>) -> tensor<64xf32>
+  return %2 : tensor<64xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_1d_bf16_weight
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<32xf32>) -> memref<64xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "krnl.global"() {{.*}} : () -> memref<32x64xbf16>
+// CHECK-NOT:       memref<32x64xf32>
+// CHECK:           krnl.iterate
+// CHECK:             [[LOAD_B_:%.+]] = krnl.load [[VAR_0_]]{{.}}{{.*}}{{.}} : memref<32x64xbf16>
+// CHECK:             arith.extf [[LOAD_B_]] : bf16 to f32
+// CHECK:           return
+}
+
+// -----
+
+// A Cast also used by another op than MatMul is materialized.
+
+func.func @test_matmul_shared_cast(%arg0: tensor<16x32xf32>) -> (tensor<16x64xf32>, tensor<32x64xf32>) {
+  %0 = onnx.Constant dense<1.0> : tensor<32x64xf16>
+  %1 = "onnx.Cast"(%0) {to = f32} : (tensor<32x64xf16>) -> tensor<32x64xf32>
+  %2 = "onnx.MatMul"(%arg0, %1) : (tensor<16x32xf32>, tensor<32x64xf32>) -> tensor<16x64xf32>
+  return %2, %1 : tensor<16x64xf32>, tensor<32x64xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_shared_cast
+// CHECK:           [[CAST_:%.+]] = memref.alloc() {{.*}}: memref<32x64xf32>
+// CHECK:           krnl.matmul {{.*}}, [[CAST_]]{{.*}} : memref<16x32xf32>, memref<32x64xf32>, memref<16x64xf32>
+}
@@ -8,12 +8,38 @@ func.func @test_seqstore(%arg0: memref<?x3xf32>, %arg1: memref<?xmemref<?x?xf32>
     return %arg0 : memref<?x3xf32>
 // CHECK-LABEL:  func @test_seqstore
 // CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x3xf32>, [[PARAM_1_:%.+]]: memref<?xmemref<?x?xf32>>, [[PARAM_2_:%.+]]: index) -> memref<?x3xf32> {
-// CHECK:           [[VAR_c0_:%.+]] = arith.constant 0 : index
-// CHECK:           [[VAR_0_:%.+]] = memref.dim [[PARAM_0_]], [[VAR_c0_]] : memref<?x3xf32>
-// CHECK:           [[RES_:%.+]] = memref.alloc([[VAR_0_]]) {{.*}}: memref<?x3xf32>
-// CHECK:           memref.copy [[PARAM_0_]], [[RES_]] : memref<?x3xf32> to memref<?x3xf32>
-// CHECK:           [[VAR_2_:%.+]] = memref.cast [[RES_]] : memref<?x3xf32> to memref<?x?xf32>
-// CHECK:           memref.store [[VAR_2_]], [[PARAM_1_]]{{.}}[[PARAM_2_]]{{.}} : memref<?xmemref<?x?xf32>>
+// CHECK:           [[VAR_0_:%.+]] = memref.dim [[PARAM_0_]], {{.*}} : memref<?x3xf32>
+// CHECK:           [[VAR_1_:%.+]] = arith.muli {{.*}}, [[VAR_0_]] : index
+// CHECK:           [[VAR_2_:%.+]] = arith.muli [[VAR_1_]], {{.*}} : index
+// CHECK:           [[VAR_3_:%.+]] = arith.addi [[VAR_2_]], {{.*}} : index
+// CHECK:           [[RES_:%.+]] = memref.alloc([[VAR_3_]]) {alignment = 64 : i64} : memref<?xi8>
+// CHECK:           [[VAR_4_:%.+]] = memref.view [[RES_]]{{.}}{{.*}}{{.}}{{.}}[[VAR_0_]]{{.}} : memref<?xi8> to memref<?x3xf32>
+// CHECK:           [[VAR_5_:%.+]] = memref.view [[RES_]]{{.}}{{.*}}{{.}}[] : memref<?xi8> to memref<i64>
+// CHECK:           memref.store {{.*}}, [[VAR_5_]][] : memref<i64>
+// CHECK:           memref.copy [[PARAM_0_]], [[VAR_4_]] : memref<?x3xf32> to memref<?x3xf32>
+// CHECK:           [[VAR_6_:%.+]] = memref.cast [[VAR_4_]] : memref<?x3xf32> to memref<?x?xf32>
+// CHECK:           memref.store [[VAR_6_]], [[PARAM_1_]]{{.}}[[PARAM_2_]]{{.}} : memref<?xmemref<?x?xf32>>
+// CHECK:           return [[PARAM_0_]] : memref<?x3xf32>
+}
+
+// -----
+
+func.func @test_seqstore_nocopy(%arg0: memref<?x3xf32>, %arg1: memref<?xmemref<?x?xf32>>, %arg2: index) -> memref<?x3xf32>  {
+    "krnl.seqstore"(%arg0, %arg1, %arg2) {copy = 0 : ui1} : (memref<?x3xf32>, memref<?xmemref<?x?xf32>>, index) -> ()
+    return %arg0 : memref<?x3xf32>
+// CHECK-LABEL:  func @test_seqstore_nocopy
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x3xf32>, [[PARAM_1_:%.+]]: memref<?xmemref<?x?xf32>>, [[PARAM_2_:%.+]]: index) -> memref<?x3xf32> {
+// CHECK-NOT:       memref.alloc
+// CHECK:           [[VAR_0_:%.+]] = memref.extract_aligned_pointer_as_index [[PARAM_0_]] : memref<?x3xf32> -> index
+// CHECK:           [[VAR_1_:%.+]] = arith.subi [[VAR_0_]], {{.*}} : index
+// CHECK:           [[VAR_2_:%.+]] = arith.index_cast [[VAR_1_]] : index to i64
+// CHECK:           [[VAR_3_:%.+]] = llvm.inttoptr [[VAR_2_]] : i64 to !llvm.ptr<i64>
+// CHECK:           [[VAR_4_:%.+]] = llvm.load [[VAR_3_]] : !llvm.ptr<i64>
+// CHECK:           [[VAR_5_:%.+]] = arith.addi [[VAR_4_]], {{.*}} : i64
+// CHECK:           llvm.store [[VAR_5_]], [[VAR_3_]] : !llvm.ptr<i64>
+// CHECK-NOT:       memref.copy
+// CHECK:           [[VAR_6_:%.+]] = memref.cast [[PARAM_0_]] : memref<?x3xf32> to memref<?x?xf32>
+// CHECK:           memref.store [[VAR_6_]], [[PARAM_1_]]{{.}}[[PARAM_2_]]{{.}} : memref<?xmemref<?x?xf32>>
 // CHECK:           return [[PARAM_0_]] : memref<?x3xf32>
 }
 
@@ -56,7 +82,18 @@ func.func @test_seqdealloc(%arg1: memref<?xmemref<?x3xf32>>, %arg2: index) -> in
 // CHECK-DAG:       [[VAR_c1_:%.+]] = arith.constant 1 : index
 // CHECK:           scf.for [[I_0_:%.+]] = [[VAR_c0_0_]] to [[VAR_0_]] step [[VAR_c1_]] {
 // CHECK:             [[LOAD_PARAM_0_MEM_:%.+]] = memref.load [[PARAM_0_]]{{.}}[[I_0_]]{{.}} : memref<?xmemref<?x3xf32>>
-// CHECK:             memref.dealloc [[LOAD_PARAM_0_MEM_]] : memref<?x3xf32>
+// CHECK:             [[VAR_1_:%.+]] = memref.extract_aligned_pointer_as_index [[LOAD_PARAM_0_MEM_]] : memref<?x3xf32> -> index
+// CHECK:             [[VAR_2_:%.+]] = arith.subi [[VAR_1_]], {{.*}} : index
+// CHECK:             [[VAR_3_:%.+]] = arith.index_cast [[VAR_2_]] : index to i64
+// CHECK:             [[VAR_4_:%.+]] = llvm.inttoptr [[VAR_3_]] : i64 to !llvm.ptr<i64>
+// CHECK:             [[VAR_5_:%.+]] = llvm.load [[VAR_4_]] : !llvm.ptr<i64>
+// CHECK:             [[VAR_6_:%.+]] = arith.subi [[VAR_5_]], {{.*}} : i64
+// CHECK:             [[VAR_7_:%.+]] = arith.cmpi eq, [[VAR_6_]], {{.*}} : i64
+// CHECK:             scf.if [[VAR_7_]] {
+// CHECK:               memref.dealloc [[LOAD_PARAM_0_MEM_]] : memref<?x3xf32>
+// CHECK:             } else {
+// CHECK:               llvm.store [[VAR_6_]], [[VAR_4_]] : !llvm.ptr<i64>
+// CHECK:             }
 // CHECK:           }
 // CHECK:           memref.dealloc [[PARAM_0_]] : memref<?xmemref<?x3xf32>>
 // CHECK:           return [[PARAM_1_]] : index
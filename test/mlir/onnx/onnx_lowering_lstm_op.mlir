@@ -875,3 +875,24 @@ func.func private @test_lstm_unknown_dims(%arg0: tensor<?x?x?xf32>, %arg1: tenso
 // CHECK:           return [[RES_]] : memref<1x?x4xf32>
 // CHECK:         }
 }
+
+// -----
+
+// Check that the input is projected at all timesteps with a single matmul
+// before the sequence loop for a long enough static sequence length.
+func.func private @test_lstm_batched_input_projection(%arg0: tensor<16x2x3xf32>, %arg1: tensor<1x16x3xf32>, %arg2: tensor<1x16x4xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %Y, %Y_h, %Y_c = "onnx.LSTM"(%arg0, %arg1, %arg2, %cst, %cst, %cst, %cst, %cst) {hidden_size = 4 : si64} : (tensor<16x2x3xf32>, tensor<1x16x3xf32>, tensor<1x16x4xf32>, none, none, none, none, none) -> (none, tensor<*xf32>, none)
+  return %Y_h : tensor<*xf32>
+
+// CHECK-LABEL:  func.func private @test_lstm_batched_input_projection
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<16x2x3xf32>, [[PARAM_1_:%.+]]: memref<1x16x3xf32>, [[PARAM_2_:%.+]]: memref<1x16x4xf32>) -> memref<1x2x4xf32> {
+// CHECK:           [[VAR_X2D_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [32, 3], strides: [3, 1] : memref<16x2x3xf32> to memref<32x3xf32>
+// CHECK:           krnl.matmul {{.*}}[[VAR_X2D_]]
+// CHECK:           [[VAR_XWT_:%.+]] = memref.reinterpret_cast {{.*}} to offset: [0], sizes: [16, 2, 16], strides: [32, 16, 1] : memref<32x16xf32> to memref<16x2x16xf32>
+// CHECK:           krnl.iterate
+// CHECK:             memref.subview [[VAR_XWT_]]
+// CHECK-NOT:         memref.reinterpret_cast [[PARAM_0_]]
+// CHECK:           return
+// CHECK:         }
+}
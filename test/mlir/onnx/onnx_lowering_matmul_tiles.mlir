@@ -0,0 +1,47 @@
+// RUN: echo '{"matmul_tiles": [{"mcpu": "z16", "op": "MatMul", "shape": [16, 16, 16], "reg": [2, 16, 4]}, {"mcpu": "z16", "op": "Gemm", "shape": [64, 64, 64], "reg": [2, 8, 8], "cache": [16, 32, 32]}, {"mcpu": "z14", "op": "MatMul", "shape": [16, 16, 8], "reg": [1, 1, 1]}]}' > %t.json
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl="matmul-tile-db=%t.json target-cpu=z16" --canonicalize %s -split-input-file | FileCheck %s
+
+// COM: The tile sizes of the MatMul and Gemm ops of the shapes tuned for the
+// COM: target cpu are read from the tuning database, the others are the default.
+
+func.func private @test_matmul_tuned(%arg0 : tensor<16x16xf32>, %arg1 : tensor<16x16xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<16x16xf32>, tensor<16x16xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_matmul_tuned
+// CHECK:           [[LOOP_0_:%.+]]:3 = krnl.define_loops 3
+// CHECK:           krnl.block [[LOOP_0_]]#0 2 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.block [[LOOP_0_]]#1 16 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.block [[LOOP_0_]]#2 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.matmul {{.*}} {aTileSize = [], bTileSize = [], cTileSize = [], computeTileSize = [2, 16, 4]}
+}
+
+// -----
+
+// COM: Sizes only tuned for another cpu.
+
+func.func private @test_matmul_untuned(%arg0 : tensor<16x8xf32>, %arg1 : tensor<8x16xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<16x8xf32>, tensor<8x16xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_matmul_untuned
+// CHECK:           krnl.matmul {{.*}} {aTileSize = [], bTileSize = [], cTileSize = [], computeTileSize = [4, 8, 8]}
+}
+
+// -----
+
+func.func private @test_gemm_tuned(%arg0 : tensor<64x64xf32>, %arg1 : tensor<64x64xf32>, %arg2 : tensor<64xf32>) -> tensor<*xf32> {
+  %0 ="onnx.Gemm"(%arg0, %arg1, %arg2) : (tensor<64x64xf32>, tensor<64x64xf32>, tensor<64xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func private @test_gemm_tuned
+// CHECK-DAG:       memref.alloc() {{.*}}: memref<16x32xf32>
+// CHECK-DAG:       memref.alloc() {{.*}}: memref<32x32xf32>
+// CHECK:           [[LOOP_0_:%.+]]:3 = krnl.define_loops 3
+// CHECK:           [[BLOCK_TILE_I_:%.+]], [[BLOCK_IN_I_:%.+]] = krnl.block [[LOOP_0_]]#0 16 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.block [[BLOCK_IN_I_]] 2 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           [[BLOCK_TILE_J_:%.+]], [[BLOCK_IN_J_:%.+]] = krnl.block [[LOOP_0_]]#1 32 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.block [[BLOCK_IN_J_]] 8 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.block [[LOOP_0_]]#2 32 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:           krnl.matmul {{.*}} computeTileSize = [2, 8, 32]
+}
@@ -1775,3 +1775,31 @@ func.func @test_nonmaxsuppression_unknown_dims(%arg0: tensor<?x?x?xf32>, %arg1:
 // CHECK:           return [[RES_8_]] : memref<?x3xi64>
 // CHECK:         }
 }
+
+// -----
+
+// With many boxes, the candidates of each class are only the boxes whose scores
+// are greater than the threshold, in the descending order of scores, and their
+// corners and areas are computed once.
+
+func.func @test_nonmaxsuppression_many_boxes(%arg0: tensor<1x100x4xf32>, %arg1: tensor<1x2x100xf32>, %arg2: tensor<1xi64>, %arg3: tensor<1xf32>, %arg4: tensor<1xf32>) -> tensor<?x3xi64> {
+  %0 = "onnx.NonMaxSuppression"(%arg0, %arg1, %arg2, %arg3, %arg4) {center_point_box = 1 : si64} : (tensor<1x100x4xf32>, tensor<1x2x100xf32>, tensor<1xi64>, tensor<1xf32>, tensor<1xf32>) -> tensor<?x3xi64>
+  return %0 : tensor<?x3xi64>
+
+// CHECK-LABEL:  func.func @test_nonmaxsuppression_many_boxes
+// CHECK:           "krnl.call"({{.*}}) {funcName = "omTensorSort"} : (memref<1x2x100xindex>, memref<1x2x100xf32>, i64, i64) -> ()
+// CHECK:           [[CORNERS_:%.+]] = memref.alloc() {{.*}}: memref<1x5x100xf32>
+// CHECK:           krnl.iterate
+// CHECK:             arith.divf
+// CHECK:           [[SELECTED_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<1x2x?xindex>
+// CHECK:           krnl.iterate
+// CHECK:             scf.for
+// CHECK:             [[REMOVED_:%.+]] = memref.alloc() {{.*}}: memref<100xi1>
+// CHECK:             scf.for
+// CHECK:               scf.if
+// CHECK:                 scf.for
+// CHECK-NOT:               arith.divf
+// CHECK:                   krnl.load [[CORNERS_]]
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x3xi64>
+// CHECK:           return [[RES_]] : memref<?x3xi64>
+}
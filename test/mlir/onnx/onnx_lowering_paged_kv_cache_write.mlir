@@ -0,0 +1,21 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the new tokens are stored into the cache at the positions given
+// by the block table, and that the cache is returned as is.
+
+func.func @test_paged_kv_cache_write(%cache: tensor<?x4x?x16xf32>, %table: tensor<2x?xi64>, %length: tensor<1xi64>, %x: tensor<2x4x1x16xf32>) -> tensor<?x4x?x16xf32> {
+  %0 = "onnx.PagedKVCacheWrite"(%cache, %table, %length, %x) : (tensor<?x4x?x16xf32>, tensor<2x?xi64>, tensor<1xi64>, tensor<2x4x1x16xf32>) -> tensor<?x4x?x16xf32>
+  "func.return"(%0) : (tensor<?x4x?x16xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_paged_kv_cache_write
+// CHECK-SAME:   ([[CACHE_:%.+]]: memref<?x4x?x16xf32>, [[TABLE_:%.+]]: memref<2x?xi64>, [[LENGTH_:%.+]]: memref<1xi64>, [[X_:%.+]]: memref<2x4x1x16xf32>) -> memref<?x4x?x16xf32> {
+// CHECK-NOT:       memref.alloc
+// CHECK:           [[PAST_:%.+]] = krnl.load [[LENGTH_]]{{.}}{{.*}}{{.}} : memref<1xi64>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 2, {{.*}} = 0 to 4, {{.*}} = 0 to 1, {{.*}} = 0 to 16){
+// CHECK:             arith.divsi
+// CHECK:             [[BLOCK_:%.+]] = krnl.load [[TABLE_]]{{.}}{{.*}}{{.}} : memref<2x?xi64>
+// CHECK:             arith.remsi
+// CHECK:             [[VAL_:%.+]] = krnl.load [[X_]]{{.}}{{.*}}{{.}} : memref<2x4x1x16xf32>
+// CHECK:             krnl.store [[VAL_]], [[CACHE_]]{{.}}{{.*}}{{.}} : memref<?x4x?x16xf32>
+// CHECK:           return [[CACHE_]] : memref<?x4x?x16xf32>
+}
@@ -0,0 +1,433 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl=enable-parallel --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the outer tiled loops of MatMul and Gemm are distributed with
+// scf.parallel when parallelization is enabled.
+
+// -----
+
+func.func @test_matmul_2d_parallel(%arg0 : tensor<64x128xf32>, %arg1 : tensor<128x256xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<64x128xf32>, tensor<128x256xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_2d_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<64x256xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               [[VAR_UB_:%.+]] = arith.minsi
+// CHECK:               krnl.iterate
+// CHECK:                 krnl.matmul
+// CHECK:           return [[RES_]] : memref<64x256xf32>
+}
+
+// -----
+
+func.func @test_matmul_broadcast_parallel(%arg0 : tensor<12x64x128xf32>, %arg1 : tensor<128x256xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<12x64x128xf32>, tensor<128x256xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_broadcast_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<12x64x256xf32>
+// CHECK:           scf.parallel ([[B_0_:%.+]], [[I_0_:%.+]]) = ({{.*}}, {{.*}}) to ({{.*}}, {{.*}}) step ({{.*}}, {{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 krnl.matmul
+// CHECK:           return [[RES_]] : memref<12x64x256xf32>
+}
+
+// -----
+
+func.func @test_matmul_small_m_parallel(%arg0 : tensor<1x128xf32>, %arg1 : tensor<128x1024xf32>) -> tensor<*xf32> {
+  %0 ="onnx.MatMul"(%arg0, %arg1) : (tensor<1x128xf32>, tensor<128x1024xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_small_m_parallel
+// CHECK-DAG:       [[CST_32_:%.+]] = arith.constant 32 : index
+// CHECK-DAG:       [[CST_1024_:%.+]] = arith.constant 1024 : index
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x1024xf32>
+// CHECK:           scf.parallel ([[J_0_:%.+]]) = ({{.*}}) to ([[CST_1024_]]) step ([[CST_32_]]) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               scf.for
+// CHECK-COUNT-8:         vector.fma
+// CHECK:           return [[RES_]] : memref<1x1024xf32>
+}
+
+// -----
+
+func.func @test_gemm_parallel(%arg0 : tensor<128x256xf32>, %arg1 : tensor<256x512xf32>, %arg2 : tensor<512xf32>) -> tensor<*xf32> {
+  %0 ="onnx.Gemm"(%arg0, %arg1, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32} : (tensor<128x256xf32>, tensor<256x512xf32>, tensor<512xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<128x512xf32>
+// CHECK:           scf.parallel ([[J_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK-DAG:           memref.alloca() {{.*}}: memref<32x256xf32>
+// CHECK-DAG:           memref.alloca() {{.*}}: memref<256x64xf32>
+// CHECK:               krnl.iterate
+// CHECK:                 krnl.matmul
+// CHECK:           return [[RES_]] : memref<128x512xf32>
+}
+
+// -----
+
+// The panels of a large packed constant B, read by the iterations of the
+// parallel loop, are partitioned across the NUMA nodes.
+
+func.func @test_gemm_parallel_numa_partitions(%arg0 : tensor<128x1024xf32>, %arg2 : tensor<1024xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<1.0> : tensor<1024x1024xf32>
+  %1 ="onnx.Gemm"(%arg0, %0, %arg2) {alpha = 1.0 : f32, beta = 1.0 : f32} : (tensor<128x1024xf32>, tensor<1024x1024xf32>, tensor<1024xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_parallel_numa_partitions
+// CHECK:           [[PACKED_:%.+]] = "krnl.global"() {alignment = 128 : i64, name = "packed_constant_{{.*}}", numa_partitions = 16 : i64, shape = [16384, 64], value = dense<1.000000e+00> : tensor<16384x64xf32>} : () -> memref<16384x64xf32>
+// CHECK:           scf.parallel ([[J_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:                 krnl.matmul {{.*}}, [[PACKED_]]{{.*}} : memref<32x256xf32>, memref<16384x64xf32>
+}
+
+// -----
+
+// Elementwise ops over large tensors are distributed. The SIMD code over the
+// flattened tensor is split in chunks.
+
+func.func @test_relu_parallel(%arg0 : tensor<1x256x56x56xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<1x256x56x56xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_relu_parallel
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               [[VAR_UB_:%.+]] = arith.minsi
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load
+// CHECK:                 vector.store
+}
+
+// -----
+
+// With broadcasting, the outermost dimension that is not 1 is distributed.
+
+func.func @test_add_broadcast_parallel(%arg0 : tensor<1x256x56x56xf32>, %arg1 : tensor<256x1x1xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Add"(%arg0, %arg1) : (tensor<1x256x56x56xf32>, tensor<256x1x1xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_add_broadcast_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x256x56x56xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 arith.addf
+// CHECK:           return [[RES_]] : memref<1x256x56x56xf32>
+}
+
+// -----
+
+// Elementwise ops over small tensors are kept sequential.
+
+func.func @test_relu_small_sequential(%arg0 : tensor<10x10xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Relu"(%arg0) : (tensor<10x10xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_relu_small_sequential
+// CHECK-NOT:       scf.parallel
+// CHECK:           krnl.iterate
+}
+
+// -----
+
+// The two directions of a bidirectional LSTM run concurrently.
+
+func.func @test_lstm_bidirectional_parallel(%arg0: tensor<7x2x3xf32>, %arg1: tensor<2x16x3xf32>, %arg2: tensor<2x16x4xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %Y, %Y_h, %Y_c = "onnx.LSTM"(%arg0, %arg1, %arg2, %cst, %cst, %cst, %cst, %cst) {direction = "bidirectional", hidden_size = 4 : si64} : (tensor<7x2x3xf32>, tensor<2x16x3xf32>, tensor<2x16x4xf32>, none, none, none, none, none) -> (none, tensor<*xf32>, none)
+  "func.return"(%Y_h) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_lstm_bidirectional_parallel
+// CHECK-DAG:       [[VAR_c0_:%.+]] = arith.constant 0 : index
+// CHECK-DAG:       [[VAR_c1_:%.+]] = arith.constant 1 : index
+// CHECK-DAG:       [[VAR_c2_:%.+]] = arith.constant 2 : index
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ([[VAR_c0_]]) to ([[VAR_c2_]]) step ([[VAR_c1_]]) {
+// CHECK:             [[VAR_FWD_:%.+]] = arith.cmpi eq, [[I_0_]], [[VAR_c0_]] : index
+// CHECK:             scf.if [[VAR_FWD_]] {
+// CHECK:               "krnl.region"() ({
+// CHECK:                 krnl.iterate
+// CHECK:             } else {
+// CHECK:               "krnl.region"() ({
+// CHECK:                 krnl.iterate
+// CHECK:           return
+}
+
+// -----
+
+// The elementwise computations of each timestep are distributed over a
+// large batch.
+
+func.func @test_rnn_batch_parallel(%arg0: tensor<7x32x3xf32>, %arg1: tensor<1x4x3xf32>, %arg2: tensor<1x4x4xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %Y, %Y_h = "onnx.RNN"(%arg0, %arg1, %arg2, %cst, %cst, %cst) {hidden_size = 4 : si64} : (tensor<7x32x3xf32>, tensor<1x4x3xf32>, tensor<1x4x4xf32>, none, none, none) -> (none, tensor<*xf32>)
+  "func.return"(%Y_h) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_rnn_batch_parallel
+// CHECK:           krnl.iterate
+// CHECK:             scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:               "krnl.region"() ({
+// CHECK:                 krnl.iterate
+// CHECK:                   math.tanh
+// CHECK:           return
+}
+
+// -----
+
+// Full reductions of large tensors reduce chunks of the flattened input into
+// partial results in parallel, then reduce the partial results.
+
+func.func @test_reducemean_full_parallel(%arg0 : tensor<1x256x56x56xf32>) -> tensor<*xf32> {
+  %0 ="onnx.ReduceMeanV13"(%arg0) {keepdims = 0 : si64} : (tensor<1x256x56x56xf32>)-> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_reducemean_full_parallel
+// CHECK:           [[PARTIALS_:%.+]] = memref.alloc() {{.*}}: memref<49xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load
+// CHECK:                 arith.addf {{.*}} : vector<4xf32>
+// CHECK:               vector.reduction <add>
+// CHECK:               krnl.store {{.*}}, [[PARTIALS_]]{{.}}[[I_0_]]{{.}} : memref<49xf32>
+// CHECK:           vector.reduction <add>
+// CHECK:           arith.divf
+// CHECK:           return
+}
+
+// -----
+
+// Scans along long axes are computed by blocks in parallel: local scans of
+// the blocks, a sequential pass computing the carries of the blocks, and the
+// addition of the carries to the rows of their blocks.
+
+func.func @test_cumsum_blocked_parallel(%arg0 : tensor<16384x8xf32>) -> tensor<*xf32> {
+  %axis = onnx.Constant dense<0> : tensor<i32>
+  %0 = "onnx.CumSum"(%arg0, %axis) : (tensor<16384x8xf32>, tensor<i32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_cumsum_blocked_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16384x8xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]], [[I_1_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load
+// CHECK:                 arith.addf {{.*}} : vector<4xf32>
+// CHECK:           [[CARRIES_:%.+]] = memref.alloc() {{.*}}: memref<1x4x8xf32>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 1 to 4){
+// CHECK:               vector.store {{.*}}, [[CARRIES_]]
+// CHECK:           scf.parallel ([[I_2_:%.+]], [[I_3_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load [[CARRIES_]]
+// CHECK:                 arith.addf {{.*}} : vector<4xf32>
+// CHECK:           return [[RES_]] : memref<16384x8xf32>
+}
+
+// -----
+
+// The (n, c) planes of a pooling are computed in parallel.
+
+func.func @test_maxpool_parallel(%arg0 : tensor<1x64x56x56xf32>) -> tensor<*xf32> {
+  %0 = "onnx.MaxPoolSingleOut"(%arg0) {auto_pad = "NOTSET", kernel_shape = [3, 3], pads = [1, 1, 1, 1], strides = [2, 2]} : (tensor<1x64x56x56xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_maxpool_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x64x28x28xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]], [[I_1_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load
+// CHECK:                 arith.cmpf ogt, {{.*}} : vector<4xf32>
+// CHECK:           return [[RES_]] : memref<1x64x28x28xf32>
+}
+
+// -----
+
+// Reductions keeping the outermost dims, e.g. the ones GlobalAveragePool is
+// rewritten into, reduce each contiguous row of the input in parallel.
+
+func.func @test_reducemean_rows_parallel(%arg0 : tensor<1x256x7x7xf32>) -> tensor<*xf32> {
+  %0 ="onnx.ReduceMeanV13"(%arg0) {axes=[2, 3], keepdims = 1 : si64} : (tensor<1x256x7x7xf32>)-> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_reducemean_rows_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x256x1x1xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 vector.load
+// CHECK:                 arith.addf {{.*}} : vector<4xf32>
+// CHECK:               vector.reduction <add>
+// CHECK:           arith.divf
+// CHECK:           return [[RES_]] : memref<1x256x1x1xf32>
+}
+
+// -----
+
+// The lookups of CategoryMapper are distributed over the outermost dimension
+// of the input.
+
+func.func @test_category_mapper_parallel(%arg0 : tensor<?x16xi64>) -> tensor<*x!onnx.String> {
+  %0 = "onnx.CategoryMapper"(%arg0) {cats_int64s = [1, 2, 3], cats_strings = ["cat", "dog", "cow"], default_string = "none"} : (tensor<?x16xi64>) -> tensor<*x!onnx.String>
+  "func.return"(%0) : (tensor<*x!onnx.String>) -> ()
+
+// CHECK-LABEL:  func.func @test_category_mapper_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x16x!krnl.string>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             "krnl.region"() ({
+// CHECK:               krnl.iterate
+// CHECK:                 "krnl.find_index"
+// CHECK:                 scf.if
+// CHECK:           return [[RES_]] : memref<?x16x!krnl.string>
+}
+
+// -----
+
+// NonZero counts the nonzero values by blocks of the input in parallel, then
+// writes their indices in parallel, in the runtime.
+
+func.func @test_nonzero_parallel(%arg0 : tensor<?x64xi1>) -> tensor<*xi64> {
+  %0 = "onnx.NonZero"(%arg0) : (tensor<?x64xi1>) -> tensor<*xi64>
+  "func.return"(%0) : (tensor<*xi64>) -> ()
+
+// CHECK-LABEL:  func.func @test_nonzero_parallel
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x64xi1>) -> memref<2x?xi64> {
+// CHECK-DAG:       [[CST_256_:%.+]] = arith.constant 256 : index
+// CHECK-DAG:       [[OFFSETS_:%.+]] = memref.alloc() {{.*}}: memref<257xi64>
+// CHECK:           "krnl.call"([[OFFSETS_]], [[PARAM_0_]]) {funcName = "omTensorNonZeroCount"} : (memref<257xi64>, memref<?x64xi1>) -> ()
+// CHECK:           [[TOTAL_:%.+]] = krnl.load [[OFFSETS_]]{{.}}[[CST_256_]]{{.}} : memref<257xi64>
+// CHECK:           [[COUNT_:%.+]] = arith.index_cast [[TOTAL_]] : i64 to index
+// CHECK:           [[RES_:%.+]] = memref.alloc([[COUNT_]]) {{.*}}: memref<2x?xi64>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[OFFSETS_]]) {funcName = "omTensorNonZero"} : (memref<2x?xi64>, memref<?x64xi1>, memref<257xi64>) -> ()
+// CHECK:           return [[RES_]] : memref<2x?xi64>
+}
+
+// -----
+
+// Compress counts the true conditions by blocks in parallel, then copies the
+// slices of the blocks in parallel, in the runtime.
+
+func.func @test_compress_parallel(%arg0 : tensor<?x64xf32>, %arg1 : tensor<?xi1>) -> tensor<?x64xf32> {
+  %0 = "onnx.Compress"(%arg0, %arg1) {axis = 0 : si64} : (tensor<?x64xf32>, tensor<?xi1>) -> tensor<?x64xf32>
+  "func.return"(%0) : (tensor<?x64xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_compress_parallel
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x64xf32>, [[PARAM_1_:%.+]]: memref<?xi1>) -> memref<?x64xf32> {
+// CHECK-DAG:       [[CST_256_:%.+]] = arith.constant 256 : index
+// CHECK-DAG:       [[AXIS_:%.+]] = arith.constant 0 : i64
+// CHECK-DAG:       [[OFFSETS_:%.+]] = memref.alloc() {{.*}}: memref<257xi64>
+// CHECK:           "krnl.call"([[OFFSETS_]], [[PARAM_1_]]) {funcName = "omTensorNonZeroCount"} : (memref<257xi64>, memref<?xi1>) -> ()
+// CHECK:           [[TOTAL_:%.+]] = krnl.load [[OFFSETS_]]{{.}}[[CST_256_]]{{.}} : memref<257xi64>
+// CHECK:           [[COUNT_:%.+]] = arith.index_cast [[TOTAL_]] : i64 to index
+// CHECK:           [[RES_:%.+]] = memref.alloc([[COUNT_]]) {{.*}}: memref<?x64xf32>
+// CHECK:           "krnl.call"([[RES_]], [[PARAM_0_]], [[PARAM_1_]], [[OFFSETS_]], [[AXIS_]]) {funcName = "omTensorCompress"} : (memref<?x64xf32>, memref<?x64xf32>, memref<?xi1>, memref<257xi64>, i64) -> ()
+// CHECK:           return [[RES_]] : memref<?x64xf32>
+}
+
+// -----
+
+// The iterations of a Loop whose condition and loop carried dependencies pass
+// through the body unchanged are independent and run in parallel.
+
+func.func @test_loop_parallel(%arg0: tensor<i64>, %arg1: tensor<i1>, %arg2: tensor<4xf32>) -> tensor<?x4xf32> {
+  %0 = "onnx.Loop"(%arg0, %arg1, %arg2) ({
+  ^bb0(%arg3: tensor<i64>, %arg4: tensor<i1>, %arg5: tensor<4xf32>):
+    %1 = "onnx.Add"(%arg5, %arg2) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+    onnx.Return %arg4, %arg5, %1 : tensor<i1>, tensor<4xf32>, tensor<4xf32>
+  }) : (tensor<i64>, tensor<i1>, tensor<4xf32>) -> (tensor<4xf32>, tensor<?x4xf32>)
+  return %0#1 : tensor<?x4xf32>
+
+// CHECK-LABEL:  func.func @test_loop_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x4xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             scf.if
+// CHECK:               "krnl.region"() ({
+// CHECK:                 memref.alloc() : memref<i64>
+// CHECK:                 krnl.store {{.*}}, [[RES_]]{{.}}[[I_0_]], {{.*}}{{.}} : memref<?x4xf32>
+// CHECK-NOT:             krnl.store {{.*}} : memref<i1>
+// CHECK:           return [[RES_]] : memref<?x4xf32>
+}
+
+// -----
+
+// The iterations of a Loop updating a loop carried dependency stay sequential.
+
+func.func @test_loop_carried_sequential(%arg0: tensor<i64>, %arg1: tensor<i1>, %arg2: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = "onnx.Loop"(%arg0, %arg1, %arg2) ({
+  ^bb0(%arg3: tensor<i64>, %arg4: tensor<i1>, %arg5: tensor<4xf32>):
+    %1 = "onnx.Add"(%arg5, %arg2) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+    onnx.Return %arg4, %1 : tensor<i1>, tensor<4xf32>
+  }) : (tensor<i64>, tensor<i1>, tensor<4xf32>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+
+// CHECK-LABEL:  func.func @test_loop_carried_sequential
+// CHECK-NOT:       scf.parallel
+// CHECK:           krnl.iterate
+// CHECK-NOT:       scf.parallel
+// CHECK:           return
+}
+
+// -----
+
+// The iterations of a Scan whose scan carried dependencies pass through the
+// body unchanged run in parallel, each one on its own slice of the inputs.
+
+func.func @test_scan_parallel(%arg0: tensor<2xf32>, %arg1: tensor<3x2xf32>) -> tensor<3x2xf32> {
+  %0:2 = "onnx.Scan"(%arg0, %arg1) ({
+  ^bb0(%arg2: tensor<2xf32>, %arg3: tensor<2xf32>):
+    %1 = "onnx.Add"(%arg2, %arg3) : (tensor<2xf32>, tensor<2xf32>) -> tensor<2xf32>
+    onnx.Return %arg2, %1 : tensor<2xf32>, tensor<2xf32>
+  }) {num_scan_inputs = 1 : si64} : (tensor<2xf32>, tensor<3x2xf32>) -> (tensor<2xf32>, tensor<3x2xf32>)
+  return %0#1 : tensor<3x2xf32>
+
+// CHECK-LABEL:  func.func @test_scan_parallel
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<3x2xf32>
+// CHECK:           scf.parallel ([[I_0_:%.+]]) = ({{.*}}) to ({{.*}}) step ({{.*}}) {
+// CHECK:             memref.alloc() {{.*}}: memref<2xf32>
+// CHECK:             krnl.store {{.*}}, [[RES_]]{{.}}[[I_0_]], {{.*}}{{.}} : memref<3x2xf32>
+// CHECK:           return [[RES_]] : memref<3x2xf32>
+}
+
+// -----
+
+// The rows of ArgMin along the innermost axis are computed in parallel.
+
+func.func @test_argmin_parallel(%arg0 : tensor<8x4096xf32>) -> tensor<8x1xi64> {
+  %0 = "onnx.ArgMin"(%arg0) {axis = 1 : si64, keepdims = 1 : si64} : (tensor<8x4096xf32>) -> tensor<8x1xi64>
+  "func.return"(%0) : (tensor<8x1xi64>) -> ()
+
+// CHECK-LABEL:  func.func @test_argmin_parallel
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<8x4096xf32>) -> memref<8x1xi64> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<8x1xi64>
+// CHECK:           scf.parallel ([[ROW_:%.+]]) =
+// CHECK:             krnl.region {
+// CHECK:               scf.for {{.*}} -> (vector<[[VL_:[0-9]+]]xf32>, vector<[[VL_]]xi32>) {
+// CHECK:                 arith.cmpf olt, {{.*}} : vector<[[VL_]]xf32>
+// CHECK:               vector.reduction <minf>
+// CHECK:               krnl.store {{.*}}, [[RES_]]{{.}}[[ROW_]], {{.*}}{{.}} : memref<8x1xi64>
+// CHECK:           return [[RES_]] : memref<8x1xi64>
+}
+
+// -----
+
+func.func @test_groupnorm_parallel(%arg0 : tensor<4x8x16x16xf32>, %arg1 : tensor<2xf32>, %arg2 : tensor<2xf32>) -> tensor<4x8x16x16xf32> {
+  %0 = "onnx.GroupNormalization"(%arg0, %arg1, %arg2) {num_groups = 2 : si64} : (tensor<4x8x16x16xf32>, tensor<2xf32>, tensor<2xf32>) -> tensor<4x8x16x16xf32>
+  "func.return"(%0) : (tensor<4x8x16x16xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_groupnorm_parallel
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x8x16x16xf32>, [[PARAM_1_:%.+]]: memref<2xf32>, [[PARAM_2_:%.+]]: memref<2xf32>) -> memref<4x8x16x16xf32> {
+// CHECK:           scf.parallel ([[ROW_:%.+]]) =
+// CHECK:             krnl.region {
+// CHECK:               memref.alloca() {{.*}}: memref<16xf32>
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 1024){
+// CHECK:                 vector.load {{.*}} : memref<8x1024xf32>, vector<16xf32>
+// CHECK:               vector.reduction <add>
+// CHECK:               arith.remsi [[ROW_]], {{.*}} : index
+// CHECK:               krnl.iterate({{.*}}) with ({{.*}} = 0 to 1024){
+// CHECK:                 vector.store {{.*}} : memref<8x1024xf32>, vector<16xf32>
+}
@@ -0,0 +1,90 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// -----
+
+func.func @test_quantize_linear(%arg0: tensor<6xf32>, %arg1: tensor<f32>, %arg2: tensor<ui8>) -> tensor<6xui8> {
+  %0 = "onnx.QuantizeLinear"(%arg0, %arg1, %arg2) {axis = 1 : si64} : (tensor<6xf32>, tensor<f32>, tensor<ui8>) -> tensor<6xui8>
+  return %0 : tensor<6xui8>
+
+// CHECK-LABEL:  func.func @test_quantize_linear
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<6xf32>, [[PARAM_1_:%.+]]: memref<f32>, [[PARAM_2_:%.+]]: memref<ui8>) -> memref<6xui8> {
+// CHECK-DAG:       [[CST_0_:%.+]] = arith.constant 0.000000e+00 : f32
+// CHECK-DAG:       [[CST_255_:%.+]] = arith.constant 2.550000e+02 : f32
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<6xui8>
+// CHECK:           krnl.iterate
+// CHECK:             [[LOAD_X_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[I_0_:%.+]]{{.}} : memref<6xf32>
+// CHECK:             [[LOAD_SCALE_:%.+]] = krnl.load [[PARAM_1_]][] : memref<f32>
+// CHECK:             [[LOAD_ZP_:%.+]] = krnl.load [[PARAM_2_]][] : memref<ui8>
+// CHECK:             [[DIV_:%.+]] = arith.divf [[LOAD_X_]], [[LOAD_SCALE_]] : f32
+// CHECK:             math.floor
+// CHECK:             arith.addf
+// CHECK:             arith.maxf {{.*}}, [[CST_0_]] : f32
+// CHECK:             arith.minf {{.*}}, [[CST_255_]] : f32
+// CHECK:             [[INT_:%.+]] = arith.fptoui {{.*}} : f32 to i8
+// CHECK:             [[UINT_:%.+]] = builtin.unrealized_conversion_cast [[INT_]] : i8 to ui8
+// CHECK:             krnl.store [[UINT_]], [[RES_]]{{.}}[[I_0_]]{{.}} : memref<6xui8>
+// CHECK:           return [[RES_]] : memref<6xui8>
+}
+
+// -----
+
+func.func @test_quantize_linear_axis(%arg0: tensor<1x3x2xf32>, %arg1: tensor<3xf32>, %arg2: tensor<3xi8>) -> tensor<1x3x2xi8> {
+  %0 = "onnx.QuantizeLinear"(%arg0, %arg1, %arg2) {axis = 1 : si64} : (tensor<1x3x2xf32>, tensor<3xf32>, tensor<3xi8>) -> tensor<1x3x2xi8>
+  return %0 : tensor<1x3x2xi8>
+
+// CHECK-LABEL:  func.func @test_quantize_linear_axis
+// CHECK-DAG:       [[CST_MIN_:%.+]] = arith.constant -1.280000e+02 : f32
+// CHECK-DAG:       [[CST_MAX_:%.+]] = arith.constant 1.270000e+02 : f32
+// CHECK:           krnl.iterate
+// CHECK:             [[IV_:%.+]]:3 = krnl.get_induction_var_value
+// CHECK:             krnl.load {{.*}}{{.}}[[IV_]]#1{{.}} : memref<3xf32>
+// CHECK:             krnl.load {{.*}}{{.}}[[IV_]]#1{{.}} : memref<3xi8>
+// CHECK:             arith.maxf {{.*}}, [[CST_MIN_]] : f32
+// CHECK:             arith.minf {{.*}}, [[CST_MAX_]] : f32
+// CHECK:             arith.fptosi {{.*}} : f32 to i8
+}
+
+// -----
+
+func.func @test_dequantize_linear(%arg0: tensor<4xui8>, %arg1: tensor<f32>, %arg2: tensor<ui8>) -> tensor<4xf32> {
+  %0 = "onnx.DequantizeLinear"(%arg0, %arg1, %arg2) {axis = 1 : si64} : (tensor<4xui8>, tensor<f32>, tensor<ui8>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+
+// CHECK-LABEL:  func.func @test_dequantize_linear
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4xui8>, [[PARAM_1_:%.+]]: memref<f32>, [[PARAM_2_:%.+]]: memref<ui8>) -> memref<4xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4xf32>
+// CHECK:           krnl.iterate
+// CHECK:             [[LOAD_X_:%.+]] = krnl.load [[PARAM_0_]]{{.}}[[I_0_:%.+]]{{.}} : memref<4xui8>
+// CHECK:             [[X_:%.+]] = builtin.unrealized_conversion_cast [[LOAD_X_]] : ui8 to i8
+// CHECK:             [[X_F_:%.+]] = arith.uitofp [[X_]] : i8 to f32
+// CHECK:             [[SCALE_:%.+]] = krnl.load [[PARAM_1_]][] : memref<f32>
+// CHECK:             [[LOAD_ZP_:%.+]] = krnl.load [[PARAM_2_]][] : memref<ui8>
+// CHECK:             [[ZP_:%.+]] = builtin.unrealized_conversion_cast [[LOAD_ZP_]] : ui8 to i8
+// CHECK:             [[ZP_F_:%.+]] = arith.uitofp [[ZP_]] : i8 to f32
+// CHECK:             [[SUB_:%.+]] = arith.subf [[X_F_]], [[ZP_F_]] : f32
+// CHECK:             [[MUL_:%.+]] = arith.mulf [[SUB_]], [[SCALE_]] : f32
+// CHECK:             krnl.store [[MUL_]], [[RES_]]{{.}}[[I_0_]]{{.}} : memref<4xf32>
+// CHECK:           return [[RES_]] : memref<4xf32>
+}
+
+// -----
+
+func.func @test_dynamic_quantize_linear(%arg0: tensor<?x2xf32>) -> (tensor<?x2xui8>, tensor<f32>, tensor<ui8>) {
+  %y, %y_scale, %y_zero_point = "onnx.DynamicQuantizeLinear"(%arg0) : (tensor<?x2xf32>) -> (tensor<?x2xui8>, tensor<f32>, tensor<ui8>)
+  return %y, %y_scale, %y_zero_point : tensor<?x2xui8>, tensor<f32>, tensor<ui8>
+
+// CHECK-LABEL:  func.func @test_dynamic_quantize_linear
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x2xui8>
+// CHECK-DAG:       [[RES_SCALE_:%.+]] = memref.alloc() {{.*}}: memref<f32>
+// CHECK-DAG:       [[RES_ZP_:%.+]] = memref.alloc() {{.*}}: memref<ui8>
+// CHECK:           krnl.iterate
+// CHECK:             arith.minf
+// CHECK:             arith.maxf
+// CHECK:           [[SCALE_:%.+]] = arith.divf {{.*}} : f32
+// CHECK:           krnl.store [[SCALE_]], [[RES_SCALE_]][] : memref<f32>
+// CHECK:           arith.cmpf oeq, [[SCALE_]]
+// CHECK:           krnl.store {{.*}}, [[RES_ZP_]][] : memref<ui8>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.store {{.*}}, [[RES_]]{{.*}} : memref<?x2xui8>
+// CHECK:           return [[RES_]], [[RES_SCALE_]], [[RES_ZP_]] : memref<?x2xui8>, memref<f32>, memref<ui8>
+}
@@ -0,0 +1,94 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the integer matrix multiplications accumulate the inputs minus
+// their zero points in i32 with the tiled krnl.matmul.
+
+// -----
+
+func.func @test_matmulinteger(%arg0: tensor<16x32xui8>, %arg1: tensor<32x64xui8>, %arg2: tensor<ui8>, %arg3: tensor<64xui8>) -> tensor<16x64xi32> {
+  %0 = "onnx.MatMulInteger"(%arg0, %arg1, %arg2, %arg3) : (tensor<16x32xui8>, tensor<32x64xui8>, tensor<ui8>, tensor<64xui8>) -> tensor<16x64xi32>
+  return %0 : tensor<16x64xi32>
+
+// CHECK-LABEL:  func.func @test_matmulinteger
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<16x32xui8>, [[PARAM_1_:%.+]]: memref<32x64xui8>, [[PARAM_2_:%.+]]: memref<ui8>, [[PARAM_3_:%.+]]: memref<64xui8>) -> memref<16x64xi32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x64xi32>
+// CHECK-DAG:       [[A_:%.+]] = memref.alloc() {{.*}}: memref<16x32xi32>
+// CHECK:           krnl.iterate
+// CHECK:             krnl.load [[PARAM_0_]]
+// CHECK:             arith.extui {{.*}} : i8 to i32
+// CHECK:             krnl.load [[PARAM_2_]][] : memref<ui8>
+// CHECK:             arith.subi
+// CHECK:           [[B_:%.+]] = memref.alloc() {{.*}}: memref<32x64xi32>
+// CHECK:           krnl.iterate
+// CHECK:             [[IV_:%.+]]:2 = krnl.get_induction_var_value
+// CHECK:             krnl.load [[PARAM_3_]]{{.}}[[IV_]]#1{{.}} : memref<64xui8>
+// CHECK:             arith.subi
+// CHECK:           krnl.matmul [[A_]]{{.*}}, [[B_]]{{.*}}, [[RES_]]{{.*}} : memref<16x32xi32>, memref<32x64xi32>, memref<16x64xi32>
+// CHECK:           return [[RES_]] : memref<16x64xi32>
+}
+
+// -----
+
+func.func @test_qlinearmatmul(%arg0: tensor<16x32xi8>, %arg1: tensor<f32>, %arg2: tensor<i8>, %arg3: tensor<32x64xi8>, %arg4: tensor<f32>, %arg5: tensor<i8>, %arg6: tensor<f32>, %arg7: tensor<i8>) -> tensor<16x64xi8> {
+  %0 = "onnx.QLinearMatMul"(%arg0, %arg1, %arg2, %arg3, %arg4, %arg5, %arg6, %arg7) : (tensor<16x32xi8>, tensor<f32>, tensor<i8>, tensor<32x64xi8>, tensor<f32>, tensor<i8>, tensor<f32>, tensor<i8>) -> tensor<16x64xi8>
+  return %0 : tensor<16x64xi8>
+
+// CHECK-LABEL:  func.func @test_qlinearmatmul
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x64xi8>
+// CHECK-DAG:       [[ACC_:%.+]] = memref.alloc() {{.*}}: memref<16x64xi32>
+// CHECK:           arith.extsi {{.*}} : i8 to i32
+// CHECK:           krnl.matmul {{.*}}, {{.*}}, [[ACC_]]{{.*}} : memref<16x32xi32>, memref<32x64xi32>, memref<16x64xi32>
+// CHECK:           krnl.iterate
+// CHECK:             [[LOAD_ACC_:%.+]] = krnl.load [[ACC_]]
+// CHECK:             arith.sitofp [[LOAD_ACC_]] : i32 to f32
+// CHECK:             arith.divf
+// CHECK:             arith.fptosi {{.*}} : f32 to i8
+// CHECK:             krnl.store {{.*}}, [[RES_]]
+// CHECK:           return [[RES_]] : memref<16x64xi8>
+}
+
+// -----
+
+// Check that the matrix multiplications read the int8 weights before their
+// DequantizeLinear, which is not materialized, and scale the columns of their
+// results.
+
+func.func @test_matmul_int8_weight(%arg0: tensor<16x32xf32>) -> tensor<16x64xf32> {
+  %0 = onnx.Constant dense<3> : tensor<32x64xi8>
+  %1 = onnx.Constant dense<0.5> : tensor<64xf32>
+  %2 = "onnx.NoValue"() {value} : () -> none
+  %3 = "onnx.DequantizeLinear"(%0, %1, %2) {axis = 1 : si64} : (tensor<32x64xi8>, tensor<64xf32>, none) -> tensor<32x64xf32>
+  %4 = "onnx.MatMul"(%arg0, %3) : (tensor<16x32xf32>, tensor<32x64xf32>) -> tensor<16x64xf32>
+  return %4 : tensor<16x64xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_int8_weight
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<16x32xf32>) -> memref<16x64xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = "krnl.global"() {{.*}} : () -> memref<32x64xi8>
+// CHECK-DAG:       [[VAR_1_:%.+]] = "krnl.global"() {{.*}} : () -> memref<64xf32>
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<16x64xf32>
+// CHECK-NOT:       memref<32x64xf32>
+// CHECK:           krnl.matmul [[PARAM_0_]]{{.*}}, [[VAR_0_]]{{.*}}, [[RES_]]{{.*}} : memref<16x32xf32>, memref<32x64xi8>, memref<16x64xf32>
+// CHECK:           krnl.iterate
+// CHECK-DAG:         [[LOAD_C_:%.+]] = krnl.load [[RES_]]{{.}}[[I_:%.+]], [[J_:%.+]]{{.}} : memref<16x64xf32>
+// CHECK-DAG:         [[LOAD_S_:%.+]] = krnl.load [[VAR_1_]]{{.}}[[J_]]{{.}} : memref<64xf32>
+// CHECK:             [[MUL_:%.+]] = arith.mulf [[LOAD_C_]], [[LOAD_S_]] : f32
+// CHECK:             krnl.store [[MUL_]], [[RES_]]{{.}}[[I_]], [[J_]]{{.}} : memref<16x64xf32>
+// CHECK:           return [[RES_]] : memref<16x64xf32>
+}
+
+// -----
+
+// A DequantizeLinear with a zero point is materialized.
+
+func.func @test_matmul_zero_point(%arg0: tensor<16x32xf32>) -> tensor<16x64xf32> {
+  %0 = onnx.Constant dense<3> : tensor<32x64xi8>
+  %1 = onnx.Constant dense<0.5> : tensor<64xf32>
+  %2 = onnx.Constant dense<1> : tensor<64xi8>
+  %3 = "onnx.DequantizeLinear"(%0, %1, %2) {axis = 1 : si64} : (tensor<32x64xi8>, tensor<64xf32>, tensor<64xi8>) -> tensor<32x64xf32>
+  %4 = "onnx.MatMul"(%arg0, %3) : (tensor<16x32xf32>, tensor<32x64xf32>) -> tensor<16x64xf32>
+  return %4 : tensor<16x64xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_zero_point
+// CHECK:           memref.alloc() {{.*}}: memref<32x64xf32>
+// CHECK:           krnl.matmul {{.*}} : memref<16x32xf32>, memref<32x64xf32>, memref<16x64xf32>
+}
@@ -412,3 +412,28 @@ func.func private @test_rnn_unknown_dims(%arg0: tensor<?x?x?xf32>, %arg1: tensor
 // CHECK:           return [[RES_]] : memref<1x?x4xf32>
 // CHECK:         }
 }
+
+// -----
+
+// Check that with sequence_lens, the sequence loop stops at the longest
+// sequence and each timestep only computes the sequences still running, the
+// leading rows of the batch sorted by decreasing length.
+func.func private @test_rnn_forward_mode_sequence_lens(%arg0: tensor<7x2x3xf32>, %arg1: tensor<1x4x3xf32>, %arg2: tensor<1x4x4xf32>, %arg3: tensor<1x8xf32>, %arg4: tensor<2xi32>, %arg5: tensor<1x2x4xf32>) -> (tensor<*xf32>, tensor<*xf32>) {
+  %Y, %Y_h = "onnx.RNN"(%arg0, %arg1, %arg2, %arg3, %arg4, %arg5) {hidden_size = 4 : si64} : (tensor<7x2x3xf32>, tensor<1x4x3xf32>, tensor<1x4x4xf32>, tensor<1x8xf32>, tensor<2xi32>, tensor<1x2x4xf32>) -> (tensor<*xf32>, tensor<*xf32>)
+  return %Y, %Y_h : tensor<*xf32>, tensor<*xf32>
+// CHECK-LABEL:  func private @test_rnn_forward_mode_sequence_lens
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<7x2x3xf32>, [[PARAM_1_:%.+]]: memref<1x4x3xf32>, [[PARAM_2_:%.+]]: memref<1x4x4xf32>, [[PARAM_3_:%.+]]: memref<1x8xf32>, [[PARAM_4_:%.+]]: memref<2xi32>, [[PARAM_5_:%.+]]: memref<1x2x4xf32>) -> (memref<7x1x2x4xf32>, memref<1x2x4xf32>) {
+// CHECK-DAG:       [[ORDER_:%.+]] = memref.alloc() {{.*}}: memref<2xindex>
+// CHECK-DAG:       [[ACTIVE_:%.+]] = memref.alloc() {{.*}}: memref<7xindex>
+// CHECK-DAG:       [[MAX_LENGTH_:%.+]] = memref.alloc() {{.*}}: memref<index>
+// CHECK:           [[VAR_MAX_LENGTH_:%.+]] = krnl.load [[MAX_LENGTH_]][] : memref<index>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} to {{.*}}[[VAR_MAX_LENGTH_]]{{.*}}){
+// CHECK:             krnl.region {
+// CHECK:               [[VAR_ACTIVE_:%.+]] = krnl.load [[ACTIVE_]]{{.}}{{%.+}}{{.}} : memref<7xindex>
+// CHECK:               memref.reinterpret_cast {{%.+}} to offset: [0], sizes: {{.}}[[VAR_ACTIVE_]], 4], strides: [4, 1] : memref<2x4xf32> to memref<?x4xf32>
+// CHECK:               "onnx.MatMul"({{%.+}}, {{%.+}}) : (tensor<?x4xf32>, tensor<4x4xf32>) -> tensor<?x4xf32>
+// CHECK:             }
+// CHECK:           }
+// CHECK:           arith.select {{%.+}}, {{%.+}}, {{%.+}} : f32
+// CHECK:           krnl.store {{%.+}}, {{%.+}}{{.}}{{%.+}}, {{%.+}}, {{%.+}}, {{%.+}}{{.}} : memref<7x1x2x4xf32>
+}
@@ -0,0 +1,131 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that Softmax along the innermost dimension and LayerNormalization,
+// InstanceNormalization and GroupNormalization are lowered to SIMD codes over
+// the rows of contiguous values, with vector accumulators reduced at the end of
+// each row. Softmax computes the values left after the last full vector with
+// masked vectors, and the normalizations with scalar loops.
+
+func.func @test_softmax_innermost_axis(%arg0 : tensor<2x3x100xf32>) -> tensor<*xf32> {
+  %0 = "onnx.Softmax"(%arg0) {axis = -1 : si64} : (tensor<2x3x100xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_softmax_innermost_axis
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2x3x100xf32>) -> memref<2x3x100xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x3x100xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [6, 100], strides: [100, 1] : memref<2x3x100xf32> to memref<6x100xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_0_:%.+]] = memref.reinterpret_cast [[RES_]] to offset: [0], sizes: [6, 100], strides: [100, 1] : memref<2x3x100xf32> to memref<6x100xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 6){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 96){
+// CHECK:               vector.load [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}} : memref<6x100xf32>, vector<16xf32>
+// CHECK:               arith.maxf {{.*}} : vector<16xf32>
+// CHECK:             vector.maskedload [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}}, {{.*}}, {{.*}} : memref<6x100xf32>, vector<16xi1>, vector<16xf32> into vector<16xf32>
+// CHECK:             arith.maxf {{.*}} : vector<16xf32>
+// CHECK:             vector.reduction <maxf>, {{.*}} : vector<16xf32> into f32
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 96){
+// CHECK:               math.exp {{.*}} : vector<16xf32>
+// CHECK:             vector.maskedload [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}}, {{.*}}, {{.*}} : memref<6x100xf32>, vector<16xi1>, vector<16xf32> into vector<16xf32>
+// CHECK:             math.exp {{.*}} : vector<16xf32>
+// CHECK:             vector.maskedstore [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}}, {{.*}}, {{.*}} : memref<6x100xf32>, vector<16xi1>, vector<16xf32>
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 96){
+// CHECK:               vector.store {{.*}}, [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}} : memref<6x100xf32>, vector<16xf32>
+// CHECK:             vector.maskedstore [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}}, {{.*}}, {{.*}} : memref<6x100xf32>, vector<16xi1>, vector<16xf32>
+// CHECK-NOT:         krnl.iterate
+// CHECK:           return [[RES_]] : memref<2x3x100xf32>
+}
+
+// -----
+
+func.func @test_layernorm(%arg0 : tensor<4x256xf32>, %arg1 : tensor<256xf32>, %arg2 : tensor<256xf32>) -> tensor<*xf32> {
+  %Y, %Mean, %InvStdDev = "onnx.LayerNormalization"(%arg0, %arg1, %arg2) {axis = -1 : si64, epsilon = 1.000000e-05 : f32} : (tensor<4x256xf32>, tensor<256xf32>, tensor<256xf32>) -> (tensor<*xf32>, none, none)
+  "func.return"(%Y) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_layernorm
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<4x256xf32>, [[PARAM_1_:%.+]]: memref<256xf32>, [[PARAM_2_:%.+]]: memref<256xf32>) -> memref<4x256xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<4x256xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 4){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 256){
+// CHECK:               [[LOAD_X_:%.+]] = vector.load {{.*}} : memref<4x256xf32>, vector<16xf32>
+// CHECK:               arith.addf {{.*}}, [[LOAD_X_]] : vector<16xf32>
+// CHECK:               arith.mulf [[LOAD_X_]], [[LOAD_X_]] : vector<16xf32>
+// CHECK-NOT:         krnl.iterate({{.*}}) with ({{.*}} = 256 to 256){
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             math.sqrt {{.*}} : f32
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 256){
+// CHECK-COUNT-2:       vector.load {{.*}} : memref<256xf32>, vector<16xf32>
+// CHECK:               vector.store {{.*}} : memref<4x256xf32>, vector<16xf32>
+// CHECK:           return [[RES_]] : memref<4x256xf32>
+}
+
+// -----
+
+func.func @test_layernorm_mean_invstddev(%arg0 : tensor<?x3x32xf32>, %arg1 : tensor<3x32xf32>) -> (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>) {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %Y, %Mean, %InvStdDev = "onnx.LayerNormalization"(%arg0, %arg1, %none) {axis = 1 : si64} : (tensor<?x3x32xf32>, tensor<3x32xf32>, none) -> (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>)
+  "func.return"(%Y, %Mean, %InvStdDev) : (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_layernorm_mean_invstddev
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<?x3x32xf32>, [[PARAM_1_:%.+]]: memref<3x32xf32>) -> (memref<?x3x32xf32>, memref<?x1x1xf32>, memref<?x1x1xf32>) {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x3x32xf32>
+// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x1x1xf32>
+// CHECK-DAG:       [[RES_2_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x1x1xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[RES_1_]] to offset: [0], sizes: {{.*}}, strides: [1] : memref<?x1x1xf32> to memref<?xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_0_:%.+]] = memref.reinterpret_cast [[RES_2_]] to offset: [0], sizes: {{.*}}, strides: [1] : memref<?x1x1xf32> to memref<?xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to {{.*}}){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 96){
+// CHECK:             vector.reduction <add>
+// CHECK:             krnl.store {{.*}}, [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}} : memref<?xf32>
+// CHECK:             krnl.store {{.*}}, [[VAR_reinterpret_cast_0_]]{{.}}{{.*}}{{.}} : memref<?xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 96){
+// CHECK-NOT:           arith.addf {{.*}} : vector<16xf32>
+// CHECK:               vector.store
+// CHECK:           return [[RES_]], [[RES_1_]], [[RES_2_]] : memref<?x3x32xf32>, memref<?x1x1xf32>, memref<?x1x1xf32>
+}
+
+// -----
+
+func.func @test_instancenorm(%arg0 : tensor<2x3x16x16xf32>, %arg1 : tensor<3xf32>, %arg2 : tensor<3xf32>) -> tensor<*xf32> {
+  %0 = "onnx.InstanceNormalization"(%arg0, %arg1, %arg2) {epsilon = 0.00999999977 : f32} : (tensor<2x3x16x16xf32>, tensor<3xf32>, tensor<3xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_instancenorm
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2x3x16x16xf32>, [[PARAM_1_:%.+]]: memref<3xf32>, [[PARAM_2_:%.+]]: memref<3xf32>) -> memref<2x3x16x16xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x3x16x16xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [6, 256], strides: [256, 1] : memref<2x3x16x16xf32> to memref<6x256xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 6){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 256){
+// CHECK:               vector.load [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}} : memref<6x256xf32>, vector<16xf32>
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             arith.remsi {{.*}}, {{.*}} : index
+// CHECK:             krnl.load [[PARAM_1_]]{{.}}{{.*}}{{.}} : memref<3xf32>
+// CHECK:             krnl.load [[PARAM_2_]]{{.}}{{.*}}{{.}} : memref<3xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 256){
+// CHECK:               vector.fma {{.*}} : vector<16xf32>
+// CHECK:               vector.store {{.*}} : memref<6x256xf32>, vector<16xf32>
+// CHECK:           return [[RES_]] : memref<2x3x16x16xf32>
+}
+
+// -----
+
+func.func @test_groupnorm(%arg0 : tensor<2x6x10x10xf32>, %arg1 : tensor<3xf32>, %arg2 : tensor<3xf32>) -> tensor<*xf32> {
+  %0 = "onnx.GroupNormalization"(%arg0, %arg1, %arg2) {num_groups = 3 : si64} : (tensor<2x6x10x10xf32>, tensor<3xf32>, tensor<3xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_groupnorm
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2x6x10x10xf32>, [[PARAM_1_:%.+]]: memref<3xf32>, [[PARAM_2_:%.+]]: memref<3xf32>) -> memref<2x6x10x10xf32> {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x6x10x10xf32>
+// CHECK-DAG:       [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[PARAM_0_]] to offset: [0], sizes: [6, 200], strides: [200, 1] : memref<2x6x10x10xf32> to memref<6x200xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 6){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 192){
+// CHECK:               vector.load [[VAR_reinterpret_cast_]]{{.}}{{.*}}{{.}} : memref<6x200xf32>, vector<16xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 192 to 200){
+// CHECK:             vector.reduction <add>, {{.*}} : vector<16xf32> into f32
+// CHECK:             krnl.load [[PARAM_1_]]{{.}}{{.*}}{{.}} : memref<3xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 192){
+// CHECK:               vector.fma {{.*}} : vector<16xf32>
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 192 to 200){
+// CHECK:           return [[RES_]] : memref<2x6x10x10xf32>
+}
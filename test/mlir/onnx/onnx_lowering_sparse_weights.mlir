@@ -0,0 +1,59 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the pruned constant weights of MatMul and Gemm are converted to a
+// block-sparse form of 1x4 blocks, of which only the nonzero ones are
+// multiplied.
+
+// -----
+
+func.func @test_matmul_sparse_b(%arg0 : tensor<2x8xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<[[0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [1.0, 2.0, 3.0, 4.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 5.0, 6.0, 7.0, 8.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0]]> : tensor<8x8xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<2x8xf32>, tensor<8x8xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_sparse_b
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2x8xf32>
+// CHECK-DAG:       [[OFFSETS_:%.+]] = "krnl.global"() {name = "sparse_offsets_{{.*}}", shape = [3], value = dense<[0, 1, 2]> : tensor<3xi32>} : () -> memref<3xi32>
+// CHECK-DAG:       [[ROWS_:%.+]] = "krnl.global"() {name = "sparse_rows_{{.*}}", shape = [2], value = dense<[1, 6]> : tensor<2xi32>} : () -> memref<2xi32>
+// CHECK-DAG:       [[VALUES_:%.+]] = "krnl.global"() {name = "sparse_values_{{.*}}", shape = [2, 4], value = dense<{{.}}[1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00], [5.000000e+00, 6.000000e+00, 7.000000e+00, 8.000000e+00]]> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+// CHECK:           krnl.iterate
+// CHECK:             [[SUM_:%.+]] = scf.for {{.*}} iter_args({{.*}}) -> (vector<4xf32>) {
+// CHECK:               [[B_:%.+]] = vector.load [[VALUES_]]{{.*}} : memref<2x4xf32>, vector<4xf32>
+// CHECK:               vector.fma {{.*}}, [[B_]], {{.*}} : vector<4xf32>
+// CHECK:             vector.store [[SUM_]], [[RES_]]{{.*}} : memref<2x8xf32>, vector<4xf32>
+// CHECK:           return [[RES_]] : memref<2x8xf32>
+}
+
+// -----
+
+// The transposed B of Gemm is converted as well, scaled by alpha, the bias
+// being added afterwards.
+
+func.func @test_gemm_sparse_b_trans(%arg0 : tensor<2x8xf32>, %arg1 : tensor<4xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<[[0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 2.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 3.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 4.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0]]> : tensor<4x8xf32>
+  %1 = "onnx.Gemm"(%arg0, %0, %arg1) {alpha = 2.0 : f32, beta = 1.0 : f32, transB = 1 : si64} : (tensor<2x8xf32>, tensor<4x8xf32>, tensor<4xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_gemm_sparse_b_trans
+// CHECK-DAG:       "krnl.global"() {name = "sparse_offsets_{{.*}}", shape = [2], value = dense<[0, 1]> : tensor<2xi32>} : () -> memref<2xi32>
+// CHECK-DAG:       "krnl.global"() {name = "sparse_rows_{{.*}}", shape = [1], value = dense<1> : tensor<1xi32>} : () -> memref<1xi32>
+// CHECK-DAG:       "krnl.global"() {name = "sparse_values_{{.*}}", shape = [1, 4], value = dense<{{.}}[2.000000e+00, 4.000000e+00, 6.000000e+00, 8.000000e+00]]> : tensor<1x4xf32>} : () -> memref<1x4xf32>
+// CHECK:           vector.fma
+// CHECK:           krnl.iterate
+// CHECK:             [[C_:%.+]] = krnl.load %arg1
+// CHECK:             arith.addf {{.*}}[[C_]]
+}
+
+// -----
+
+// Weights with too few zero blocks stay dense.
+
+func.func @test_matmul_dense_b(%arg0 : tensor<2x8xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<[[0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0], [1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0], [0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 5.0, 6.0, 7.0, 8.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0]]> : tensor<8x8xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<2x8xf32>, tensor<8x8xf32>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_matmul_dense_b
+// CHECK-NOT:       sparse_values_
+// CHECK:           "krnl.global"() {name = "constant_{{.*}}", shape = [8, 8]
+}
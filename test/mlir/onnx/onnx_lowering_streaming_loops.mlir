@@ -0,0 +1,66 @@
+// RUN: onnx-mlir-opt --shape-inference --convert-onnx-to-krnl='enable-streaming-loops' --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that the scan output with a dynamic dim is written in place into a
+// buffer allocated by the first iteration, instead of being accumulated into
+// a sequence and copied after the loop, and that the buffer of the iteration
+// number is allocated before the loop.
+
+func.func @test_loop_streaming(%arg0: tensor<i64>, %arg1: tensor<i1>, %arg2: tensor<?xf32>) -> (tensor<?x?xf32>) {
+  %0 = "onnx.Loop"(%arg0, %arg1) ({
+  ^bb0(%arg3: tensor<i64>, %arg4: tensor<i1>):
+    %1 = "onnx.Add"(%arg2, %arg2) : (tensor<?xf32>, tensor<?xf32>) -> (tensor<?xf32>)
+    onnx.Return %arg4, %1 : tensor<i1>, tensor<?xf32>
+  }) : (tensor<i64>, tensor<i1>) -> tensor<?x?xf32>
+  return %0 : tensor<?x?xf32>
+
+// CHECK-LABEL:  func.func @test_loop_streaming
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<i64>, [[PARAM_1_:%.+]]: memref<i1>, [[PARAM_2_:%.+]]: memref<?xf32>) -> memref<?x?xf32> {
+// CHECK-DAG:       [[CST_0_:%.+]] = arith.constant 0 : index
+// CHECK:           [[EMPTY_:%.+]] = memref.alloc({{.*}}, [[CST_0_]]) {{.*}}: memref<?x?xf32>
+// CHECK:           [[HOLDER_:%.+]] = memref.alloc() {{.*}}: memref<1xmemref<?x?xf32>>
+// CHECK:           krnl.store [[EMPTY_]], [[HOLDER_]]{{.}}[[CST_0_]]{{.}} : memref<1xmemref<?x?xf32>>
+// CHECK:           [[IV_MEM_:%.+]] = memref.alloc() : memref<i64>
+// CHECK:           krnl.iterate
+// CHECK:             scf.if
+// CHECK:               "krnl.region"() ({
+// CHECK-NOT:             memref.alloc() : memref<i64>
+// CHECK:                 krnl.store {{.*}}, [[IV_MEM_]][] : memref<i64>
+// CHECK:                 [[FIRST_:%.+]] = arith.cmpi eq, {{.*}}, [[CST_0_]] : index
+// CHECK:                 scf.if [[FIRST_]] {
+// CHECK:                   [[LOAD_EMPTY_:%.+]] = krnl.load [[HOLDER_]]{{.}}[[CST_0_]]{{.}} : memref<1xmemref<?x?xf32>>
+// CHECK:                   [[BUFFER_:%.+]] = memref.alloc({{.*}}) {{.*}}: memref<?x?xf32>
+// CHECK:                   krnl.store [[BUFFER_]], [[HOLDER_]]{{.}}[[CST_0_]]{{.}} : memref<1xmemref<?x?xf32>>
+// CHECK:                 }
+// CHECK:                 [[LOAD_BUFFER_:%.+]] = krnl.load [[HOLDER_]]{{.}}[[CST_0_]]{{.}} : memref<1xmemref<?x?xf32>>
+// CHECK:                 krnl.iterate
+// CHECK:                   krnl.store {{.*}}, [[LOAD_BUFFER_]]{{.}}{{.*}}{{.}} : memref<?x?xf32>
+// CHECK-NOT:       krnl.seqstore
+// CHECK:           [[RES_:%.+]] = krnl.load [[HOLDER_]]{{.}}[[CST_0_]]{{.}} : memref<1xmemref<?x?xf32>>
+// CHECK:           return [[RES_]] : memref<?x?xf32>
+}
+
+// -----
+
+// Check that the buffer of the slice of the scan input is allocated before the
+// scan iteration.
+
+func.func @test_scan_streaming(%arg0: tensor<2xf32>, %arg1: tensor<3x2xf32>) -> (tensor<*xf32>, tensor<*xf32>) {
+  %0:2 = "onnx.Scan"(%arg0, %arg1) ({
+  ^bb0(%arg2: tensor<2xf32>, %arg3: tensor<2xf32>):
+    %1 = "onnx.Add"(%arg2, %arg3) : (tensor<2xf32>, tensor<2xf32>) -> tensor<2xf32>
+    onnx.Return %1, %1 : tensor<2xf32>, tensor<2xf32>
+  }) {num_scan_inputs = 1 : si64} : (tensor<2xf32>, tensor<3x2xf32>) -> (tensor<*xf32>, tensor<*xf32>)
+  return %0#0, %0#1 : tensor<*xf32>, tensor<*xf32>
+
+// CHECK-LABEL:  func.func @test_scan_streaming
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<2xf32>, [[PARAM_1_:%.+]]: memref<3x2xf32>) -> (memref<2xf32>, memref<3x2xf32>) {
+// CHECK-DAG:       [[RES_:%.+]] = memref.alloc() {{.*}}: memref<2xf32>
+// CHECK-DAG:       [[RES_1_:%.+]] = memref.alloc() {{.*}}: memref<3x2xf32>
+// CHECK:           [[SLICE_:%.+]] = memref.alloc() {{.*}}: memref<2xf32>
+// CHECK:           krnl.iterate
+// CHECK-NOT:         memref.alloc() {{.*}}: memref<2xf32>
+// CHECK:             krnl.iterate
+// CHECK:               [[LOAD_:%.+]] = krnl.load [[PARAM_1_]]{{.}}{{.*}}, {{.*}}{{.}} : memref<3x2xf32>
+// CHECK:               krnl.store [[LOAD_]], [[SLICE_]]{{.}}{{.*}}{{.}} : memref<2xf32>
+// CHECK:           return [[RES_]], [[RES_1_]] : memref<2xf32>, memref<3x2xf32>
+}
@@ -0,0 +1,47 @@
+// RUN: onnx-mlir-opt -O3 --shape-inference --convert-onnx-to-krnl --canonicalize %s -split-input-file | FileCheck %s
+
+// Check that a large transpose permuting the innermost dimension is copied by
+// tiles of 32 x 32 elements, themselves copied by blocks of 4 x 4 elements
+// transposed in registers by shuffles.
+
+func.func @test_transpose_tiled(%arg0: tensor<1x64x64x64xf32>) -> tensor<1x64x64x64xf32> {
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x64x64x64xf32>) -> tensor<1x64x64x64xf32>
+  "func.return"(%0) : (tensor<1x64x64x64xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_transpose_tiled
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x64x64x64xf32>) -> memref<1x64x64x64xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x64x64x64xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 64){
+// CHECK:             [[LOOP_1_:%.+]]:2 = krnl.define_loops 2
+// CHECK:             [[BLOCK_TILE_0_:%.+]], [[BLOCK_IN_0_:%.+]] = krnl.block [[LOOP_1_]]#0 32 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:             [[BLOCK_TILE_1_:%.+]], [[BLOCK_IN_1_:%.+]] = krnl.block [[LOOP_1_]]#1 32 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:             krnl.iterate([[BLOCK_TILE_0_]], [[BLOCK_TILE_1_]]) with ([[LOOP_1_]]#0 -> {{.*}} = 0 to 64, [[LOOP_1_]]#1 -> {{.*}} = 0 to 64){
+// CHECK:               krnl.block {{.*}} 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:               krnl.block {{.*}} 4 : (!krnl.loop) -> (!krnl.loop, !krnl.loop)
+// CHECK:               krnl.iterate
+// CHECK-COUNT-4:         vector.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x64x64x64xf32>, vector<4xf32>
+// CHECK-COUNT-8:         vector.shuffle {{.*}} : vector<4xf32>, vector<4xf32>
+// CHECK-COUNT-4:         vector.store {{.*}}, [[RES_]]{{.}}{{.*}}{{.}} : memref<1x64x64x64xf32>, vector<4xf32>
+// CHECK:           return [[RES_]] : memref<1x64x64x64xf32>
+}
+
+// -----
+
+// Check that the NCHW to NHWC transpose of an image of 3 channels, with no
+// full block of 4 x 4 elements, copies each row of the input to the
+// interleaved one of the output, one element at a time.
+
+func.func @test_transpose_tiled_nchw_to_nhwc(%arg0: tensor<1x3x512x256xf32>) -> tensor<1x512x256x3xf32> {
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x3x512x256xf32>) -> tensor<1x512x256x3xf32>
+  "func.return"(%0) : (tensor<1x512x256x3xf32>) -> ()
+
+// CHECK-LABEL:  func.func @test_transpose_tiled_nchw_to_nhwc
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: memref<1x3x512x256xf32>) -> memref<1x512x256x3xf32> {
+// CHECK:           [[RES_:%.+]] = memref.alloc() {{.*}}: memref<1x512x256x3xf32>
+// CHECK:           krnl.iterate({{.*}}) with ({{.*}} = 0 to 1, {{.*}} = 0 to 512){
+// CHECK:             krnl.iterate({{.*}}) with ({{.*}} = 0 to 3, {{.*}} = 0 to 256){
+// CHECK:               [[LOAD_:%.+]] = krnl.load [[PARAM_0_]]{{.}}{{.*}}{{.}} : memref<1x3x512x256xf32>
+// CHECK:               krnl.store [[LOAD_]], [[RES_]]{{.}}{{.*}}{{.}} : memref<1x512x256x3xf32>
+// CHECK-NOT:       vector.shuffle
+// CHECK:           return [[RES_]] : memref<1x512x256x3xf32>
+}
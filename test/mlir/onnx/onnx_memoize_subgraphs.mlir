@@ -0,0 +1,79 @@
+// RUN: onnx-mlir-opt --memoize-subgraphs="inputs=1" %s -split-input-file | FileCheck %s
+
+// Check that the table computed from the sequence length is memoized, keyed
+// by the dimension it depends on.
+module {
+  func.func @main_graph(%arg0: tensor<?x?x64xf32>) -> tensor<?x?x64xf32> {
+    %0 = "onnx.Dim"(%arg0) {axis = 1 : si64} : (tensor<?x?x64xf32>) -> tensor<1xi64>
+    %1 = onnx.Constant dense<64> : tensor<1xi64>
+    %2 = "onnx.Concat"(%0, %1) {axis = 0 : si64} : (tensor<1xi64>, tensor<1xi64>) -> tensor<2xi64>
+    %3 = "onnx.ConstantOfShape"(%2) {value = dense<1.0> : tensor<1xf32>} : (tensor<2xi64>) -> tensor<?x64xf32>
+    %4 = "onnx.Sin"(%3) : (tensor<?x64xf32>) -> tensor<?x64xf32>
+    %5 = "onnx.Add"(%arg0, %4) : (tensor<?x?x64xf32>, tensor<?x64xf32>) -> tensor<?x?x64xf32>
+    return %5 : tensor<?x?x64xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<?x?x64xf32>) -> tensor<?x?x64xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = "onnx.Dim"([[PARAM_0_]]) {axis = 1 : si64} : (tensor<?x?x64xf32>) -> tensor<1xi64>
+// CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<64> : tensor<1xi64>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Memo"([[VAR_0_]]) ({
+// CHECK:             [[VAR_3_:%.+]] = "onnx.Concat"([[VAR_0_]], [[VAR_1_]]) {axis = 0 : si64} : (tensor<1xi64>, tensor<1xi64>) -> tensor<2xi64>
+// CHECK:             [[VAR_4_:%.+]] = "onnx.ConstantOfShape"([[VAR_3_]]) {value = dense<1.000000e+00> : tensor<1xf32>} : (tensor<2xi64>) -> tensor<?x64xf32>
+// CHECK:             [[VAR_5_:%.+]] = "onnx.Sin"([[VAR_4_]]) : (tensor<?x64xf32>) -> tensor<?x64xf32>
+// CHECK:             onnx.Return [[VAR_5_]] : tensor<?x64xf32>
+// CHECK:           }) {id = 0 : si64} : (tensor<1xi64>) -> tensor<?x64xf32>
+// CHECK:           [[VAR_6_:%.+]] = "onnx.Add"([[PARAM_0_]], [[VAR_2_]]) : (tensor<?x?x64xf32>, tensor<?x64xf32>) -> tensor<?x?x64xf32>
+// CHECK:           return [[VAR_6_]] : tensor<?x?x64xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Check that the mask computed from the slowly changing input is memoized,
+// keyed by that input.
+module {
+  func.func @main_graph(%arg0: tensor<1x?x?xf32>, %arg1: tensor<1x?xi64>) -> tensor<1x?x?xf32> {
+    %0 = onnx.Constant dense<1.0> : tensor<f32>
+    %1 = onnx.Constant dense<-10000.0> : tensor<f32>
+    %2 = "onnx.Cast"(%arg1) {to = f32} : (tensor<1x?xi64>) -> tensor<1x?xf32>
+    %3 = "onnx.Sub"(%0, %2) : (tensor<f32>, tensor<1x?xf32>) -> tensor<1x?xf32>
+    %4 = "onnx.Mul"(%3, %1) : (tensor<1x?xf32>, tensor<f32>) -> tensor<1x?xf32>
+    %5 = "onnx.Add"(%arg0, %4) : (tensor<1x?x?xf32>, tensor<1x?xf32>) -> tensor<1x?x?xf32>
+    return %5 : tensor<1x?x?xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x?x?xf32>, [[PARAM_1_:%.+]]: tensor<1x?xi64>) -> tensor<1x?x?xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Memo"([[PARAM_1_]]) ({
+// CHECK:             "onnx.Cast"([[PARAM_1_]])
+// CHECK:             "onnx.Sub"
+// CHECK:             [[VAR_1_:%.+]] = "onnx.Mul"
+// CHECK:             onnx.Return [[VAR_1_]] : tensor<1x?xf32>
+// CHECK:           }) {id = 0 : si64} : (tensor<1x?xi64>) -> tensor<1x?xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Add"([[PARAM_0_]], [[VAR_0_]]) : (tensor<1x?x?xf32>, tensor<1x?xf32>) -> tensor<1x?x?xf32>
+// CHECK:           return [[VAR_2_]] : tensor<1x?x?xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Check that the shapes cheap to recompute are not memoized.
+module {
+  func.func @main_graph(%arg0: tensor<?x?x64xf32>) -> tensor<?x64xf32> {
+    %0 = "onnx.Dim"(%arg0) {axis = 0 : si64} : (tensor<?x?x64xf32>) -> tensor<1xi64>
+    %1 = onnx.Constant dense<-1> : tensor<1xi64>
+    %2 = onnx.Constant dense<64> : tensor<1xi64>
+    %3 = "onnx.Concat"(%1, %2) {axis = 0 : si64} : (tensor<1xi64>, tensor<1xi64>) -> tensor<2xi64>
+    %4 = "onnx.Mul"(%3, %0) : (tensor<2xi64>, tensor<1xi64>) -> tensor<2xi64>
+    %5 = "onnx.Reshape"(%arg0, %4) {allowzero = 0 : si64} : (tensor<?x?x64xf32>, tensor<2xi64>) -> tensor<?x64xf32>
+    return %5 : tensor<?x64xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-NOT:       "onnx.Memo"
+// CHECK:           "onnx.Reshape"
+}
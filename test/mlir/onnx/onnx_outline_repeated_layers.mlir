@@ -0,0 +1,68 @@
+// RUN: onnx-mlir-opt --outline-repeated-layers="min-layer-ops=3" %s -split-input-file | FileCheck %s
+
+// Check that the repeated layers are outlined into a function taking their
+// input and weights as arguments, the bias shared by the layers being cloned
+// into the function.
+module {
+  func.func @main_graph(%arg0: tensor<4x8xf32>) -> tensor<4x8xf32> {
+    %0 = onnx.Constant dense<1.0> : tensor<8x8xf32>
+    %1 = onnx.Constant dense<2.0> : tensor<8x8xf32>
+    %2 = onnx.Constant dense<3.0> : tensor<8x8xf32>
+    %3 = onnx.Constant dense<0.5> : tensor<8xf32>
+    %4 = "onnx.MatMul"(%arg0, %0) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+    %5 = "onnx.Add"(%4, %3) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+    %6 = "onnx.Relu"(%5) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+    %7 = "onnx.MatMul"(%6, %1) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+    %8 = "onnx.Add"(%7, %3) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+    %9 = "onnx.Relu"(%8) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+    %10 = "onnx.MatMul"(%9, %2) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+    %11 = "onnx.Add"(%10, %3) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+    %12 = "onnx.Relu"(%11) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+    return %12 : tensor<4x8xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func private @main_graph_layer0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<4x8xf32>, [[PARAM_1_:%.+]]: tensor<8x8xf32>) -> tensor<4x8xf32> attributes {"onnx-mlir.outlined_layer"} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<5.000000e-01> : tensor<8xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[PARAM_1_]]) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Add"([[VAR_1_]], [[VAR_0_]]) : (tensor<4x8xf32>, tensor<8xf32>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_3_:%.+]] = "onnx.Relu"([[VAR_2_]]) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK:           return [[VAR_3_]] : tensor<4x8xf32>
+// CHECK:         }
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<8x8xf32>
+// CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<2.000000e+00> : tensor<8x8xf32>
+// CHECK-DAG:       [[VAR_2_:%.+]] = onnx.Constant dense<3.000000e+00> : tensor<8x8xf32>
+// CHECK-NOT:       onnx.Constant dense<5.000000e-01>
+// CHECK:           [[VAR_3_:%.+]] = call @main_graph_layer0([[PARAM_0_]], [[VAR_0_]]) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_4_:%.+]] = call @main_graph_layer0([[VAR_3_]], [[VAR_1_]]) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK:           [[VAR_5_:%.+]] = call @main_graph_layer0([[VAR_4_]], [[VAR_2_]]) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK:           return [[VAR_5_]] : tensor<4x8xf32>
+// CHECK:         }
+}
+
+// -----
+
+// Check that layers of the same ops wired differently, the residual of the
+// first layer being its input and the one of the second layer the input of
+// the model, are not outlined.
+module {
+  func.func @main_graph(%arg0: tensor<4x8xf32>) -> tensor<4x8xf32> {
+    %0 = onnx.Constant dense<1.0> : tensor<8x8xf32>
+    %1 = onnx.Constant dense<2.0> : tensor<8x8xf32>
+    %2 = "onnx.MatMul"(%arg0, %0) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+    %3 = "onnx.Add"(%2, %arg0) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+    %4 = "onnx.Relu"(%3) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+    %5 = "onnx.MatMul"(%4, %1) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+    %6 = "onnx.Add"(%5, %arg0) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+    %7 = "onnx.Relu"(%6) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+    return %7 : tensor<4x8xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-NOT:     func.func private
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-NOT:       call
+}
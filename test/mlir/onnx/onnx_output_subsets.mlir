@@ -0,0 +1,89 @@
+// RUN: onnx-mlir-opt --output-subsets="subsets=embedding;boxes,masks nodes=backbone/matmul,backbone/relu;missing" %s -split-input-file | FileCheck %s
+
+// Check that each subset gets an entry point only computing its outputs, in
+// the order of the function.
+module {
+  func.func @main_graph(%arg0: tensor<1x64xf32>) -> (tensor<1x64xf32>, tensor<1x64xf32>, tensor<1x64xf32>) attributes {input_names = ["x"], output_names = ["masks", "boxes", "embedding"]} {
+    %0 = onnx.Constant dense<1.0> : tensor<64x64xf32>
+    %1 = "onnx.MatMul"(%arg0, %0) : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+    %2 = "onnx.Relu"(%1) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+    %3 = "onnx.Sigmoid"(%2) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+    %4 = "onnx.Tanh"(%2) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+    %5 = "onnx.MatMul"(%1, %0) : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+    return %3, %4, %5 : tensor<1x64xf32>, tensor<1x64xf32>, tensor<1x64xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   -> (tensor<1x64xf32>, tensor<1x64xf32>, tensor<1x64xf32>)
+// CHECK:         func.func @main_graph_subset0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x64xf32>) -> tensor<1x64xf32> attributes {input_names = ["x"], output_names = ["embedding"]} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<64x64xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_0_]]) : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+// CHECK-NOT:       onnx.Relu
+// CHECK:           [[VAR_2_:%.+]] = "onnx.MatMul"([[VAR_1_]], [[VAR_0_]]) : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+// CHECK:           return [[VAR_2_]] : tensor<1x64xf32>
+// CHECK:         }
+// CHECK:         func.func @main_graph_subset1
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x64xf32>) -> (tensor<1x64xf32>, tensor<1x64xf32>) attributes {input_names = ["x"], output_names = ["masks", "boxes"]} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<64x64xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_0_]]) : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+// CHECK:           [[VAR_3_:%.+]] = "onnx.Sigmoid"([[VAR_2_]]) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.Tanh"([[VAR_2_]]) : (tensor<1x64xf32>) -> tensor<1x64xf32>
+// CHECK-NOT:       onnx.MatMul
+// CHECK:           return [[VAR_3_]], [[VAR_4_]] : tensor<1x64xf32>, tensor<1x64xf32>
+// CHECK:         }
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_subset0} : () -> ()
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_subset1} : () -> ()
+}
+
+// -----
+
+// Check that a subset naming an output the function does not have is not
+// compiled.
+module {
+  func.func @main_graph(%arg0: tensor<4x128xf32>) -> tensor<4x128xf32> attributes {input_names = ["x"], output_names = ["embedding"]} {
+    %0 = "onnx.Relu"(%arg0) : (tensor<4x128xf32>) -> tensor<4x128xf32>
+    return %0 : tensor<4x128xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK:         func.func @main_graph_subset0
+// CHECK-NOT:     func.func @main_graph_subset1
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_subset0} : () -> ()
+// CHECK-NOT:     "onnx.EntryPoint"
+}
+
+// -----
+
+// Check that a group of nodes gets an entry point returning their results and
+// only running the part of the function they depend on.
+module {
+  func.func @main_graph(%arg0: tensor<1x64xf32>) -> tensor<1x10xf32> attributes {input_names = ["x"], output_names = ["logits"]} {
+    %0 = onnx.Constant dense<1.0> : tensor<64x64xf32>
+    %1 = onnx.Constant dense<1.0> : tensor<64x10xf32>
+    %2 = "onnx.MatMul"(%arg0, %0) {onnx_node_name = "backbone/matmul"} : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+    %3 = "onnx.Relu"(%2) {onnx_node_name = "backbone/relu"} : (tensor<1x64xf32>) -> tensor<1x64xf32>
+    %4 = "onnx.MatMul"(%3, %1) {onnx_node_name = "head/matmul"} : (tensor<1x64xf32>, tensor<64x10xf32>) -> tensor<1x10xf32>
+    return %4 : tensor<1x10xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK:         func.func @main_graph_extract0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x64xf32>) -> (tensor<1x64xf32>, tensor<1x64xf32>) attributes {input_names = ["x"], output_names = ["backbone/matmul", "backbone/relu"]} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<64x64xf32>
+// CHECK-NOT:       tensor<64x10xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_0_]]) {onnx_node_name = "backbone/matmul"} : (tensor<1x64xf32>, tensor<64x64xf32>) -> tensor<1x64xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]) {onnx_node_name = "backbone/relu"} : (tensor<1x64xf32>) -> tensor<1x64xf32>
+// CHECK-NOT:       onnx.MatMul
+// CHECK:           return [[VAR_1_]], [[VAR_2_]] : tensor<1x64xf32>, tensor<1x64xf32>
+// CHECK:         }
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_extract0} : () -> ()
+// CHECK-NOT:     "onnx.EntryPoint"
+}
@@ -0,0 +1,36 @@
+// RUN: onnx-mlir-opt --packed-sequences="offsets=offsets" %s -split-input-file -verify-diagnostics | FileCheck %s
+
+// Check that the offsets are added as the last input and passed to the fused
+// self-attention.
+module {
+  func.func @main_graph(%arg0: tensor<1x4x?x16xf32>, %arg1: tensor<1x4x16x?xf32>, %arg2: tensor<1x4x?x16xf32>) -> tensor<1x4x?x16xf32> attributes {input_names = ["q", "k", "v"], output_names = ["y"]} {
+    %none = "onnx.NoValue"() {value} : () -> none
+    %0 = "onnx.FusedAttention"(%arg0, %arg1, %arg2, %none, %none, %none, %none) {scale = 2.500000e-01 : f32} : (tensor<1x4x?x16xf32>, tensor<1x4x16x?xf32>, tensor<1x4x?x16xf32>, none, none, none, none) -> tensor<1x4x?x16xf32>
+    return %0 : tensor<1x4x?x16xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x4x?x16xf32>, [[PARAM_1_:%.+]]: tensor<1x4x16x?xf32>, [[PARAM_2_:%.+]]: tensor<1x4x?x16xf32>, [[PARAM_3_:%.+]]: tensor<?xi64>) -> tensor<1x4x?x16xf32> attributes {input_names = ["q", "k", "v", "offsets"], output_names = ["y"]} {
+// CHECK:           [[NONE_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_0_:%.+]] = "onnx.FusedAttention"([[PARAM_0_]], [[PARAM_1_]], [[PARAM_2_]], [[NONE_]], [[PARAM_3_]], [[NONE_]], [[NONE_]]) {scale = 2.500000e-01 : f32} : (tensor<1x4x?x16xf32>, tensor<1x4x16x?xf32>, tensor<1x4x?x16xf32>, none, tensor<?xi64>, none, none) -> tensor<1x4x?x16xf32>
+// CHECK:           return [[VAR_0_]] : tensor<1x4x?x16xf32>
+}
+
+// -----
+
+// Check that a cross-attention between different numbers of queries and keys
+// is left as is, and that the offsets are not added without self-attention.
+module {
+  // expected-warning @+1 {{no fused self-attention, the sequence offsets offsets are not used}}
+  func.func @main_graph(%arg0: tensor<1x8x16xf32>, %arg1: tensor<1x16x32xf32>, %arg2: tensor<1x32x16xf32>) -> tensor<1x8x16xf32> attributes {input_names = ["q", "k", "v"], output_names = ["y"]} {
+    %none = "onnx.NoValue"() {value} : () -> none
+    %0 = "onnx.FusedAttention"(%arg0, %arg1, %arg2, %none, %none, %none, %none) : (tensor<1x8x16xf32>, tensor<1x16x32xf32>, tensor<1x32x16xf32>, none, none, none, none) -> tensor<1x8x16xf32>
+    return %0 : tensor<1x8x16xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x16xf32>, [[PARAM_1_:%.+]]: tensor<1x16x32xf32>, [[PARAM_2_:%.+]]: tensor<1x32x16xf32>) -> tensor<1x8x16xf32>
+// CHECK:           "onnx.FusedAttention"({{.*}}, {{.*}}, {{.*}}, [[NONE_:%.+]], [[NONE_]], [[NONE_]], [[NONE_]])
+}
@@ -0,0 +1,50 @@
+// RUN: onnx-mlir-opt --paged-kv-cache %s -split-input-file -verify-diagnostics | FileCheck %s
+
+// Check that the past keys and values concatenated for a fused attention
+// become paged caches written in place, and that the block table and the
+// past length are added as the last inputs.
+module {
+  func.func @main_graph(%arg0: tensor<1x4x1x16xf32>, %arg1: tensor<1x4x?x16xf32>, %arg2: tensor<1x4x?x16xf32>, %arg3: tensor<1x4x1x16xf32>, %arg4: tensor<1x4x1x16xf32>) -> (tensor<1x4x1x16xf32>, tensor<1x4x?x16xf32>, tensor<1x4x?x16xf32>) attributes {input_names = ["q", "past_k", "past_v", "k", "v"], output_names = ["y", "present_k", "present_v"]} {
+    %none = "onnx.NoValue"() {value} : () -> none
+    %0 = "onnx.Concat"(%arg1, %arg3) {axis = -2 : si64} : (tensor<1x4x?x16xf32>, tensor<1x4x1x16xf32>) -> tensor<1x4x?x16xf32>
+    %1 = "onnx.Transpose"(%0) {perm = [0, 1, 3, 2]} : (tensor<1x4x?x16xf32>) -> tensor<1x4x16x?xf32>
+    %2 = "onnx.Concat"(%arg2, %arg4) {axis = 2 : si64} : (tensor<1x4x?x16xf32>, tensor<1x4x1x16xf32>) -> tensor<1x4x?x16xf32>
+    %3 = "onnx.FusedAttention"(%arg0, %1, %2, %none, %none, %none, %none) {scale = 2.500000e-01 : f32} : (tensor<1x4x1x16xf32>, tensor<1x4x16x?xf32>, tensor<1x4x?x16xf32>, none, none, none, none) -> tensor<1x4x1x16xf32>
+    return %3, %0, %2 : tensor<1x4x1x16xf32>, tensor<1x4x?x16xf32>, tensor<1x4x?x16xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x4x1x16xf32>, [[PARAM_1_:%.+]]: tensor<?x4x?x16xf32>, [[PARAM_2_:%.+]]: tensor<?x4x?x16xf32>, [[PARAM_3_:%.+]]: tensor<1x4x1x16xf32>, [[PARAM_4_:%.+]]: tensor<1x4x1x16xf32>, [[PARAM_5_:%.+]]: tensor<?x?xi64>, [[PARAM_6_:%.+]]: tensor<1xi64>) -> (tensor<1x4x1x16xf32>, tensor<?x4x?x16xf32>, tensor<?x4x?x16xf32>) attributes {input_names = ["q", "past_k", "past_v", "k", "v", "kv_block_table", "kv_past_length"], output_names = ["y", "present_k", "present_v"]} {
+// CHECK:           [[NONE_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK-DAG:       [[VAR_0_:%.+]] = "onnx.PagedKVCacheWrite"([[PARAM_1_]], [[PARAM_5_]], [[PARAM_6_]], [[PARAM_3_]]) : (tensor<?x4x?x16xf32>, tensor<?x?xi64>, tensor<1xi64>, tensor<1x4x1x16xf32>) -> tensor<?x4x?x16xf32>
+// CHECK-DAG:       [[VAR_1_:%.+]] = "onnx.PagedKVCacheWrite"([[PARAM_2_]], [[PARAM_5_]], [[PARAM_6_]], [[PARAM_4_]]) : (tensor<?x4x?x16xf32>, tensor<?x?xi64>, tensor<1xi64>, tensor<1x4x1x16xf32>) -> tensor<?x4x?x16xf32>
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.Dim"([[PARAM_3_]]) {axis = 2 : si64} : (tensor<1x4x1x16xf32>) -> tensor<1xi64>
+// CHECK:           [[VAR_3_:%.+]] = "onnx.Add"([[PARAM_6_]], [[VAR_2_]]) : (tensor<1xi64>, tensor<1xi64>) -> tensor<1xi64>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.FusedAttention"([[PARAM_0_]], [[VAR_0_]], [[VAR_1_]], [[NONE_]], [[NONE_]], [[PARAM_5_]], [[VAR_3_]]) {scale = 2.500000e-01 : f32} : (tensor<1x4x1x16xf32>, tensor<?x4x?x16xf32>, tensor<?x4x?x16xf32>, none, none, tensor<?x?xi64>, tensor<1xi64>) -> tensor<1x4x1x16xf32>
+// CHECK-NOT:       "onnx.Concat"
+// CHECK:           return [[VAR_4_]], [[VAR_0_]], [[VAR_1_]] : tensor<1x4x1x16xf32>, tensor<?x4x?x16xf32>, tensor<?x4x?x16xf32>
+}
+
+// -----
+
+// Check that a concatenated cache with another use is left as is, and that
+// the inputs are not added without a paged cache.
+module {
+  // expected-warning @+1 {{no fused attention to a concatenated key/value cache, the caches are not paged}}
+  func.func @main_graph(%arg0: tensor<1x4x1x16xf32>, %arg1: tensor<1x4x?x16xf32>, %arg2: tensor<1x4x?x16xf32>, %arg3: tensor<1x4x1x16xf32>, %arg4: tensor<1x4x1x16xf32>) -> (tensor<1x4x1x16xf32>, tensor<1x4x?x16xf32>) attributes {input_names = ["q", "past_k", "past_v", "k", "v"], output_names = ["y", "z"]} {
+    %none = "onnx.NoValue"() {value} : () -> none
+    %0 = "onnx.Concat"(%arg1, %arg3) {axis = -2 : si64} : (tensor<1x4x?x16xf32>, tensor<1x4x1x16xf32>) -> tensor<1x4x?x16xf32>
+    %1 = "onnx.Transpose"(%0) {perm = [0, 1, 3, 2]} : (tensor<1x4x?x16xf32>) -> tensor<1x4x16x?xf32>
+    %2 = "onnx.Concat"(%arg2, %arg4) {axis = 2 : si64} : (tensor<1x4x?x16xf32>, tensor<1x4x1x16xf32>) -> tensor<1x4x?x16xf32>
+    %3 = "onnx.FusedAttention"(%arg0, %1, %2, %none, %none, %none, %none) : (tensor<1x4x1x16xf32>, tensor<1x4x16x?xf32>, tensor<1x4x?x16xf32>, none, none, none, none) -> tensor<1x4x1x16xf32>
+    %4 = "onnx.Relu"(%0) : (tensor<1x4x?x16xf32>) -> tensor<1x4x?x16xf32>
+    return %3, %4 : tensor<1x4x1x16xf32>, tensor<1x4x?x16xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x4x1x16xf32>, [[PARAM_1_:%.+]]: tensor<1x4x?x16xf32>, [[PARAM_2_:%.+]]: tensor<1x4x?x16xf32>, [[PARAM_3_:%.+]]: tensor<1x4x1x16xf32>, [[PARAM_4_:%.+]]: tensor<1x4x1x16xf32>) -> (tensor<1x4x1x16xf32>, tensor<1x4x?x16xf32>)
+// CHECK-NOT:       "onnx.PagedKVCacheWrite"
+// CHECK:           "onnx.FusedAttention"({{.*}}, {{.*}}, {{.*}}, [[NONE_:%.+]], [[NONE_]], [[NONE_]], [[NONE_]])
+}
@@ -0,0 +1,58 @@
+// RUN: onnx-mlir-opt --propagate-simd-data-layout-onnx %s -split-input-file | FileCheck %s
+
+// Check that the elementwise and pooling ops compute in the blocked layout of
+// the convolution, and that the transforms to and back from it cancel out.
+
+func.func @test_propagate_relu_maxpool(%arg0: tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>> {
+  %0 = "onnx.LayoutTransform"(%arg0) {target_layout = "STANDARD"} : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x16x16xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<1x8x16x16xf32>) -> tensor<1x8x16x16xf32>
+  %2 = "onnx.MaxPoolSingleOut"(%1) {kernel_shape = [2, 2], strides = [2, 2]} : (tensor<1x8x16x16xf32>) -> tensor<1x8x8x8xf32>
+  %3 = "onnx.LayoutTransform"(%2) {target_layout = #onnx.layout<{dataLayout = "NCHW4C"}>} : (tensor<1x8x8x8xf32>) -> tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+  return %3 : tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+
+// CHECK-LABEL:  func.func @test_propagate_relu_maxpool
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>> {
+// CHECK-NOT:       "onnx.LayoutTransform"
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Relu"([[PARAM_0_]]) : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MaxPoolSingleOut"([[VAR_0_]]) {{.*}} : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+// CHECK-NOT:       "onnx.LayoutTransform"
+// CHECK:           return [[VAR_1_]] : tensor<1x8x8x8xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+}
+
+// -----
+
+// Check that the operands not transformed from the blocked layout, such as a
+// broadcast constant, are kept as is, and that the result is transformed back
+// to the standard layout at the boundary of the graph.
+
+func.func @test_propagate_add_concat(%arg0: tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>, %arg1: tensor<1x4x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x12x16x16xf32> {
+  %cst = onnx.Constant dense<1.0> : tensor<8x1x1xf32>
+  %0 = "onnx.LayoutTransform"(%arg0) {target_layout = "STANDARD"} : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x16x16xf32>
+  %1 = "onnx.Add"(%0, %cst) : (tensor<1x8x16x16xf32>, tensor<8x1x1xf32>) -> tensor<1x8x16x16xf32>
+  %2 = "onnx.LayoutTransform"(%arg1) {target_layout = "STANDARD"} : (tensor<1x4x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x4x16x16xf32>
+  %3 = "onnx.Concat"(%1, %2) {axis = 1 : si64} : (tensor<1x8x16x16xf32>, tensor<1x4x16x16xf32>) -> tensor<1x12x16x16xf32>
+  return %3 : tensor<1x12x16x16xf32>
+
+// CHECK-LABEL:  func.func @test_propagate_add_concat
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>, [[PARAM_1_:%.+]]: tensor<1x4x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x12x16x16xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<8x1x1xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Add"([[PARAM_0_]], [[VAR_0_]]) : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>, tensor<8x1x1xf32>) -> tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Concat"([[VAR_1_]], [[PARAM_1_]]) {axis = 1 : si64} : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>, tensor<1x4x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x12x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>
+// CHECK:           [[VAR_3_:%.+]] = "onnx.LayoutTransform"([[VAR_2_]]) {target_layout = "STANDARD"} : (tensor<1x12x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x12x16x16xf32>
+// CHECK:           return [[VAR_3_]] : tensor<1x12x16x16xf32>
+}
+
+// -----
+
+// Check that the ops depending on the layout keep their standard input.
+
+func.func @test_propagate_softmax(%arg0: tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x16x16xf32> {
+  %0 = "onnx.LayoutTransform"(%arg0) {target_layout = "STANDARD"} : (tensor<1x8x16x16xf32, #onnx.layout<{dataLayout = "NCHW4C"}>>) -> tensor<1x8x16x16xf32>
+  %1 = "onnx.Softmax"(%0) {axis = 1 : si64} : (tensor<1x8x16x16xf32>) -> tensor<1x8x16x16xf32>
+  return %1 : tensor<1x8x16x16xf32>
+
+// CHECK-LABEL:  func.func @test_propagate_softmax
+// CHECK:           [[VAR_0_:%.+]] = "onnx.LayoutTransform"
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Softmax"([[VAR_0_]]) {axis = 1 : si64} : (tensor<1x8x16x16xf32>) -> tensor<1x8x16x16xf32>
+// CHECK:           return [[VAR_1_]] : tensor<1x8x16x16xf32>
+}
@@ -0,0 +1,34 @@
+// RUN: onnx-mlir-opt --quantize-weights %s -split-input-file | FileCheck %s
+
+func.func @test_matmul_weight(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %0 = onnx.Constant dense<[[1.0, -0.5], [-2.54, 0.25], [0.0, 1.0]]> : tensor<3x2xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<4x3xf32>, tensor<3x2xf32>) -> tensor<4x2xf32>
+  return %1 : tensor<4x2xf32>
+
+// CHECK-LABEL:  func.func @test_matmul_weight
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<4x3xf32>) -> tensor<4x2xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<{{.}}[50, -64], [-127, 32], [0, 127]{{.}}> : tensor<3x2xi8>
+// CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<{{.*}}> : tensor<2xf32>
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_3_:%.+]] = "onnx.DequantizeLinear"([[VAR_0_]], [[VAR_1_]], [[VAR_2_]]) {axis = 1 : si64} : (tensor<3x2xi8>, tensor<2xf32>, none) -> tensor<3x2xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_3_]]) : (tensor<4x3xf32>, tensor<3x2xf32>) -> tensor<4x2xf32>
+// CHECK:           return [[VAR_4_]] : tensor<4x2xf32>
+}
+
+// -----
+
+// The weights used by other ops than MatMul, or as the A operand of MatMul,
+// are left in f32.
+
+func.func @test_not_matmul_weight(%arg0: tensor<3x3xf32>) -> (tensor<3x3xf32>, tensor<3x3xf32>) {
+  %0 = onnx.Constant dense<1.0> : tensor<3x3xf32>
+  %1 = "onnx.MatMul"(%arg0, %0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  %2 = "onnx.Add"(%1, %0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  %3 = onnx.Constant dense<2.0> : tensor<3x3xf32>
+  %4 = "onnx.MatMul"(%3, %arg0) : (tensor<3x3xf32>, tensor<3x3xf32>) -> tensor<3x3xf32>
+  return %2, %4 : tensor<3x3xf32>, tensor<3x3xf32>
+
+// CHECK-LABEL:  func.func @test_not_matmul_weight
+// CHECK-NOT:       "onnx.DequantizeLinear"
+// CHECK:           return
+}
@@ -94,29 +94,69 @@ func.func @test_default_transpose(%arg0 : tensor<5x5x1x32xf32>) -> tensor<*xf32>
 //===----------------------------------------------------------------------===//
 /// Test shape inference for DFT.
 //===----------------------------------------------------------------------===//
-func.func @test_dft(%arg0: tensor<1x8x10x12xf32> , %arg1 : tensor<i32>) -> tensor<*xf32> {
-  %0 = "onnx.DFT"(%arg0, %arg1) : (tensor<1x8x10x12xf32>, tensor<i32>) -> tensor<*xf32>
+func.func @test_dft(%arg0: tensor<1x8x10x1xf32> , %arg1 : tensor<i32>) -> tensor<*xf32> {
+  %0 = "onnx.DFT"(%arg0, %arg1) : (tensor<1x8x10x1xf32>, tensor<i32>) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
 // mlir2FileCheck.py
 // CHECK-LABEL:  func.func @test_dft
-// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x10x12xf32>, [[PARAM_1_:%.+]]: tensor<i32>) -> tensor<1x8x10x12x2xf32> {
-// CHECK:           [[VAR_0_:%.+]] = "onnx.DFT"([[PARAM_0_]], [[PARAM_1_]]) {axis = 1 : si64, inverse = 0 : si64, onesided = 0 : si64} : (tensor<1x8x10x12xf32>, tensor<i32>) -> tensor<1x8x10x12x2xf32>
-// CHECK:           return [[VAR_0_]] : tensor<1x8x10x12x2xf32>
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x10x1xf32>, [[PARAM_1_:%.+]]: tensor<i32>) -> tensor<1x?x10x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.DFT"([[PARAM_0_]], [[PARAM_1_]]) {axis = 1 : si64, inverse = 0 : si64, onesided = 0 : si64} : (tensor<1x8x10x1xf32>, tensor<i32>) -> tensor<1x?x10x2xf32>
+// CHECK:           return [[VAR_0_]] : tensor<1x?x10x2xf32>
 // CHECK:         }
 }
 
 // -----
 
-func.func @test_dft_one_sided(%arg0: tensor<1x8x10x12xf32> , %arg1 : tensor<i32>) -> tensor<*xf32> {
-  %0 = "onnx.DFT"(%arg0, %arg1) { onesided = 1 : si64} : (tensor<1x8x10x12xf32>, tensor<i32>) -> tensor<*xf32>
+func.func @test_dft_one_sided(%arg0: tensor<1x8x10x1xf32>) -> tensor<*xf32> {
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.DFT"(%arg0, %cst) { onesided = 1 : si64} : (tensor<1x8x10x1xf32>, none) -> tensor<*xf32>
   "func.return"(%0) : (tensor<*xf32>) -> ()
 
 // mlir2FileCheck.py
 // CHECK-LABEL:  func.func @test_dft_one_sided
-// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x10x12xf32>, [[PARAM_1_:%.+]]: tensor<i32>) -> tensor<1x8x6x12x2xf32> {
-// CHECK:           [[VAR_0_:%.+]] = "onnx.DFT"([[PARAM_0_]], [[PARAM_1_]]) {axis = 1 : si64, inverse = 0 : si64, onesided = 1 : si64} : (tensor<1x8x10x12xf32>, tensor<i32>) -> tensor<1x8x6x12x2xf32>
-// CHECK:           return [[VAR_0_]] : tensor<1x8x6x12x2xf32>
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x10x1xf32>) -> tensor<1x5x10x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_1_:%.+]] = "onnx.DFT"([[PARAM_0_]], [[VAR_0_]]) {axis = 1 : si64, inverse = 0 : si64, onesided = 1 : si64} : (tensor<1x8x10x1xf32>, none) -> tensor<1x5x10x2xf32>
+// CHECK:           return [[VAR_1_]] : tensor<1x5x10x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+func.func @test_dft_length_axis(%arg0: tensor<1x8x10x2xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<16> : tensor<i64>
+  %1 = "onnx.DFT"(%arg0, %0) { axis = -2 : si64} : (tensor<1x8x10x2xf32>, tensor<i64>) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// mlir2FileCheck.py
+// CHECK-LABEL:  func.func @test_dft_length_axis
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x8x10x2xf32>) -> tensor<1x8x16x2xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<16> : tensor<i64>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.DFT"([[PARAM_0_]], [[VAR_0_]]) {axis = -2 : si64, inverse = 0 : si64, onesided = 0 : si64} : (tensor<1x8x10x2xf32>, tensor<i64>) -> tensor<1x8x16x2xf32>
+// CHECK:           return [[VAR_1_]] : tensor<1x8x16x2xf32>
+// CHECK:         }
+}
+
+// -----
+
+//===----------------------------------------------------------------------===//
+/// Test shape inference for STFT.
+//===----------------------------------------------------------------------===//
+
+func.func @test_stft(%arg0: tensor<2x1000x1xf32>, %arg1: tensor<400xf32>) -> tensor<*xf32> {
+  %0 = onnx.Constant dense<160> : tensor<i64>
+  %cst = "onnx.NoValue"() {value} : () -> none
+  %1 = "onnx.STFT"(%arg0, %0, %arg1, %cst) : (tensor<2x1000x1xf32>, tensor<i64>, tensor<400xf32>, none) -> tensor<*xf32>
+  "func.return"(%1) : (tensor<*xf32>) -> ()
+
+// mlir2FileCheck.py
+// CHECK-LABEL:  func.func @test_stft
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<2x1000x1xf32>, [[PARAM_1_:%.+]]: tensor<400xf32>) -> tensor<2x4x201x2xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<160> : tensor<i64>
+// CHECK-DAG:       [[VAR_1_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK:           [[VAR_2_:%.+]] = "onnx.STFT"([[PARAM_0_]], [[VAR_0_]], [[PARAM_1_]], [[VAR_1_]]) {onesided = 1 : si64} : (tensor<2x1000x1xf32>, tensor<i64>, tensor<400xf32>, none) -> tensor<2x4x201x2xf32>
+// CHECK:           return [[VAR_2_]] : tensor<2x4x201x2xf32>
 // CHECK:         }
 }
 
@@ -2286,6 +2326,48 @@ func.func @test_dropout_no_mask(%arg0: tensor<1x2x3x4xf32>, %arg1: tensor<1xf32>
 
 // -----
 
+//===----------------------------------------------------------------------===//
+/// Test shape inference for LayerNormalization.
+//===----------------------------------------------------------------------===//
+
+func.func @test_layer_normalization(%arg0: tensor<2x3x4xf32>, %arg1: tensor<3x4xf32>, %arg2: tensor<3x4xf32>) -> (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>) {
+  %Y, %Mean, %InvStdDev = "onnx.LayerNormalization"(%arg0, %arg1, %arg2) {axis = 1 : si64} : (tensor<2x3x4xf32>, tensor<3x4xf32>, tensor<3x4xf32>) -> (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>)
+  "func.return"(%Y, %Mean, %InvStdDev) : (tensor<*xf32>, tensor<*xf32>, tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: test_layer_normalization
+  // CHECK: [[Y:%.+]], [[MEAN:%.+]], [[INV_STD_DEV:%.+]] = "onnx.LayerNormalization"(%arg0, %arg1, %arg2) {axis = 1 : si64} : (tensor<2x3x4xf32>, tensor<3x4xf32>, tensor<3x4xf32>) -> (tensor<2x3x4xf32>, tensor<2x1x1xf32>, tensor<2x1x1xf32>)
+  // CHECK: return [[Y]], [[MEAN]], [[INV_STD_DEV]] : tensor<2x3x4xf32>, tensor<2x1x1xf32>, tensor<2x1x1xf32>
+}
+
+// -----
+
+func.func @test_layer_normalization_no_stats(%arg0: tensor<?x8xf16>, %arg1: tensor<8xf16>) -> tensor<*xf16> {
+  %none = "onnx.NoValue"() {value} : () -> none
+  %Y, %Mean, %InvStdDev = "onnx.LayerNormalization"(%arg0, %arg1, %none) : (tensor<?x8xf16>, tensor<8xf16>, none) -> (tensor<*xf16>, none, none)
+  "func.return"(%Y) : (tensor<*xf16>) -> ()
+
+  // CHECK-LABEL: test_layer_normalization_no_stats
+  // CHECK: [[Y:%.+]], [[MEAN:%.+]], [[INV_STD_DEV:%.+]] = "onnx.LayerNormalization"(%arg0, %arg1, {{.*}}) : (tensor<?x8xf16>, tensor<8xf16>, none) -> (tensor<?x8xf16>, none, none)
+  // CHECK: return [[Y]] : tensor<?x8xf16>
+}
+
+// -----
+
+//===----------------------------------------------------------------------===//
+/// Test shape inference for GroupNormalization.
+//===----------------------------------------------------------------------===//
+
+func.func @test_group_normalization(%arg0: tensor<?x6x4x4xf32>, %arg1: tensor<3xf32>, %arg2: tensor<3xf32>) -> tensor<*xf32> {
+  %0 = "onnx.GroupNormalization"(%arg0, %arg1, %arg2) {num_groups = 3 : si64} : (tensor<?x6x4x4xf32>, tensor<3xf32>, tensor<3xf32>) -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: test_group_normalization
+  // CHECK: [[Y:%.+]] = "onnx.GroupNormalization"(%arg0, %arg1, %arg2) {num_groups = 3 : si64} : (tensor<?x6x4x4xf32>, tensor<3xf32>, tensor<3xf32>) -> tensor<?x6x4x4xf32>
+  // CHECK: return [[Y]] : tensor<?x6x4x4xf32>
+}
+
+// -----
+
 //===----------------------------------------------------------------------===//
 /// Test shape inference for OneHotEncoder.
 //===----------------------------------------------------------------------===//
@@ -2841,6 +2923,32 @@ func.func @test_random_normal_like_type_default1(%arg0: tensor<1x1x28x28xf64>) -
 
 // -----
 
+// Test RandomUniform static
+
+func.func @test_random_uniform_f64() -> tensor<*xf32> {
+  %0 = "onnx.RandomUniform"() {shape = [3, 4, 5], dtype = 11 : si64, low = 0.0 : f32, high = 1.0 : f32, seed = 2.0 : f32} : () -> tensor<*xf32>
+  "func.return"(%0) : (tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_random_uniform_f64
+  // CHECK: [[R0:%.+]] = "onnx.RandomUniform"() {dtype = 11 : si64, high = 1.000000e+00 : f32, low = 0.000000e+00 : f32, seed = 2.000000e+00 : f32, shape = [3, 4, 5]} : () -> tensor<3x4x5xf64>
+}
+
+// -----
+
+// Test RandomUniformLike dynamic, with and without dtype
+
+func.func @test_random_uniform_like_dynamic(%arg0: tensor<1x?x28xf32>) -> (tensor<*xf32>, tensor<*xf32>) {
+  %0 = "onnx.RandomUniformLike"(%arg0) {dtype = 10 : si64} : (tensor<1x?x28xf32>) -> tensor<*xf32>
+  %1 = "onnx.RandomUniformLike"(%arg0) : (tensor<1x?x28xf32>) -> tensor<*xf32>
+  "func.return"(%0, %1) : (tensor<*xf32>, tensor<*xf32>) -> ()
+
+  // CHECK-LABEL: @test_random_uniform_like_dynamic
+  // CHECK: [[R0:%.+]] = "onnx.RandomUniformLike"(%arg0) {dtype = 10 : si64, high = 1.000000e+00 : f32, low = 0.000000e+00 : f32} : (tensor<1x?x28xf32>) -> tensor<1x?x28xf16>
+  // CHECK: [[R1:%.+]] = "onnx.RandomUniformLike"(%arg0) {high = 1.000000e+00 : f32, low = 0.000000e+00 : f32} : (tensor<1x?x28xf32>) -> tensor<1x?x28xf32>
+}
+
+// -----
+
 //===----------------------------------------------------------------------===//
 // Test NonMaxSuppression
 
@@ -2898,6 +3006,34 @@ func.func @compress_no_axis(%arg0: tensor<3x2xf32>, %arg1: tensor<3xi1>) -> tens
 
 // -----
 
+// Test unique
+
+func.func @unique_axis(%arg0: tensor<2x4xf32>) -> (tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>) {
+  %Y, %indices, %inverse, %counts = "onnx.Unique"(%arg0) {axis = -1 : si64} : (tensor<2x4xf32>) -> (tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>)
+  return %Y, %indices, %inverse, %counts : tensor<*xf32>, tensor<*xi64>, tensor<*xi64>, tensor<*xi64>
+
+// CHECK-LABEL:  func @unique_axis
+// CHECK-SAME:   ([[X_:%.+]]: tensor<2x4xf32>) -> (tensor<2x?xf32>, tensor<?xi64>, tensor<4xi64>, tensor<?xi64>) {
+// CHECK:           [[Y_:%.+]], [[INDICES_:%.+]], [[INVERSE_:%.+]], [[COUNTS_:%.+]] = "onnx.Unique"([[X_]]) {axis = -1 : si64} : (tensor<2x4xf32>) -> (tensor<2x?xf32>, tensor<?xi64>, tensor<4xi64>, tensor<?xi64>)
+// CHECK:           return [[Y_]], [[INDICES_]], [[INVERSE_]], [[COUNTS_]] : tensor<2x?xf32>, tensor<?xi64>, tensor<4xi64>, tensor<?xi64>
+// CHECK:         }
+}
+
+// -----
+
+func.func @unique_no_axis(%arg0: tensor<?x3xi32>) -> (tensor<*xi32>, none, tensor<*xi64>, none) {
+  %Y, %indices, %inverse, %counts = "onnx.Unique"(%arg0) {sorted = 0 : si64} : (tensor<?x3xi32>) -> (tensor<*xi32>, none, tensor<*xi64>, none)
+  return %Y, %indices, %inverse, %counts : tensor<*xi32>, none, tensor<*xi64>, none
+
+// CHECK-LABEL:  func @unique_no_axis
+// CHECK-SAME:   ([[X_:%.+]]: tensor<?x3xi32>) -> (tensor<?xi32>, none, tensor<?xi64>, none) {
+// CHECK:           [[Y_:%.+]], [[INDICES_:%.+]], [[INVERSE_:%.+]], [[COUNTS_:%.+]] = "onnx.Unique"([[X_]]) {sorted = 0 : si64} : (tensor<?x3xi32>) -> (tensor<?xi32>, none, tensor<?xi64>, none)
+// CHECK:           return [[Y_]], [[INDICES_]], [[INVERSE_]], [[COUNTS_]] : tensor<?xi32>, none, tensor<?xi64>, none
+// CHECK:         }
+}
+
+// -----
+
 func.func @hardmax(%arg0: tensor<3x4x5xf32>) -> tensor<*xf32>{
   %0 = "onnx.Hardmax"(%arg0) {axis = 1 : si64} : (tensor<3x4x5xf32>) -> tensor<*xf32>
   return %0 : tensor<*xf32>
@@ -0,0 +1,41 @@
+// RUN: onnx-mlir-opt --shape-specialization="buckets=0:1x128;0:8x128,1:8x-1" %s -split-input-file | FileCheck %s
+
+module {
+  func.func @main_graph(%arg0: tensor<?x128xf32>, %arg1: tensor<?x?xf32>) -> tensor<*xf32> {
+    %0 = "onnx.Add"(%arg0, %arg1) : (tensor<?x128xf32>, tensor<?x?xf32>) -> tensor<*xf32>
+    return %0 : tensor<*xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<?x128xf32>, [[PARAM_1_:%.+]]: tensor<?x?xf32>) -> tensor<*xf32> {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Add"([[PARAM_0_]], [[PARAM_1_]]) : (tensor<?x128xf32>, tensor<?x?xf32>) -> tensor<*xf32>
+// CHECK:           return [[VAR_0_]] : tensor<*xf32>
+// CHECK:         }
+// CHECK:         func.func @main_graph_shape1
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<8x128xf32>, [[PARAM_1_:%.+]]: tensor<8x?xf32>) -> tensor<*xf32> attributes {onnx.specialization_of = @main_graph} {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Add"([[PARAM_0_]], [[PARAM_1_]]) : (tensor<8x128xf32>, tensor<8x?xf32>) -> tensor<*xf32>
+// CHECK:           return [[VAR_0_]] : tensor<*xf32>
+// CHECK:         }
+// CHECK:         func.func @main_graph_shape0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x128xf32>, [[PARAM_1_:%.+]]: tensor<?x?xf32>) -> tensor<*xf32> attributes {onnx.specialization_of = @main_graph} {
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Add"([[PARAM_0_]], [[PARAM_1_]]) : (tensor<1x128xf32>, tensor<?x?xf32>) -> tensor<*xf32>
+// CHECK:           return [[VAR_0_]] : tensor<*xf32>
+// CHECK:         }
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+}
+
+// -----
+
+// Check that a bucket that does not refine the inputs is ignored.
+module {
+  func.func @main_graph(%arg0: tensor<4x128xf32>) -> tensor<4x128xf32> {
+    %0 = "onnx.Relu"(%arg0) : (tensor<4x128xf32>) -> tensor<4x128xf32>
+    return %0 : tensor<4x128xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-NOT:     func.func
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+}
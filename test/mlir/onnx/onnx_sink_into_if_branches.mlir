@@ -0,0 +1,80 @@
+// RUN: onnx-mlir-opt --sink-into-if-branches-onnx %s -split-input-file | FileCheck %s
+
+func.func @test_sink_into_then_branch(%cond: tensor<i1>, %x: tensor<4x8xf32>, %w: tensor<8x8xf32>) -> tensor<4x8xf32> {
+  %0 = "onnx.MatMul"(%x, %w) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+  %1 = "onnx.Relu"(%0) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %2 = "onnx.If"(%cond) ({
+    onnx.Return %1 : tensor<4x8xf32>
+  }, {
+    onnx.Return %x : tensor<4x8xf32>
+  }) : (tensor<i1>) -> tensor<4x8xf32>
+  return %2 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_sink_into_then_branch
+// CHECK-SAME:   ([[COND_:%.+]]: tensor<i1>, [[X_:%.+]]: tensor<4x8xf32>, [[W_:%.+]]: tensor<8x8xf32>) -> tensor<4x8xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "onnx.If"([[COND_]]) ({
+// CHECK-NEXT:        [[VAR_1_:%.+]] = "onnx.MatMul"([[X_]], [[W_]]) : (tensor<4x8xf32>, tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        onnx.Return [[VAR_2_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }, {
+// CHECK-NEXT:        onnx.Return [[X_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }) : (tensor<i1>) -> tensor<4x8xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<4x8xf32>
+}
+
+// -----
+
+func.func @test_sink_into_else_branch(%cond: tensor<i1>, %x: tensor<4x8xf32>) -> tensor<4x8xf32> {
+  %0 = "onnx.Sigmoid"(%x) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %1 = "onnx.If"(%cond) ({
+    onnx.Return %x : tensor<4x8xf32>
+  }, {
+    %2 = "onnx.Add"(%0, %x) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+    onnx.Return %2 : tensor<4x8xf32>
+  }) : (tensor<i1>) -> tensor<4x8xf32>
+  return %1 : tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_sink_into_else_branch
+// CHECK-SAME:   ([[COND_:%.+]]: tensor<i1>, [[X_:%.+]]: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = "onnx.If"([[COND_]]) ({
+// CHECK-NEXT:        onnx.Return [[X_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }, {
+// CHECK-NEXT:        [[VAR_1_:%.+]] = "onnx.Sigmoid"([[X_]]) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        [[VAR_2_:%.+]] = "onnx.Add"([[VAR_1_]], [[X_]]) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        onnx.Return [[VAR_2_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }) : (tensor<i1>) -> tensor<4x8xf32>
+// CHECK-NEXT:      return [[VAR_0_]] : tensor<4x8xf32>
+}
+
+// -----
+
+/// Values used by both branches, or after the If, and constants are not sunk.
+func.func @test_no_sink(%cond: tensor<i1>, %x: tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+  %c = onnx.Constant dense<1.000000e+00> : tensor<4x8xf32>
+  %0 = "onnx.Relu"(%x) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %1 = "onnx.Sigmoid"(%x) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %2 = "onnx.If"(%cond) ({
+    %3 = "onnx.Add"(%0, %c) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+    onnx.Return %3 : tensor<4x8xf32>
+  }, {
+    %3 = "onnx.Mul"(%0, %1) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+    onnx.Return %3 : tensor<4x8xf32>
+  }) : (tensor<i1>) -> tensor<4x8xf32>
+  %4 = "onnx.Add"(%1, %2) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+  return %2, %4 : tensor<4x8xf32>, tensor<4x8xf32>
+
+// CHECK-LABEL:  func.func @test_no_sink
+// CHECK-SAME:   ([[COND_:%.+]]: tensor<i1>, [[X_:%.+]]: tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+// CHECK-NEXT:      [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<4x8xf32>
+// CHECK-NEXT:      [[VAR_1_:%.+]] = "onnx.Relu"([[X_]]) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:      [[VAR_2_:%.+]] = "onnx.Sigmoid"([[X_]]) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:      [[VAR_3_:%.+]] = "onnx.If"([[COND_]]) ({
+// CHECK-NEXT:        [[VAR_4_:%.+]] = "onnx.Add"([[VAR_1_]], [[VAR_0_]]) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        onnx.Return [[VAR_4_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }, {
+// CHECK-NEXT:        [[VAR_4_1_:%.+]] = "onnx.Mul"([[VAR_1_]], [[VAR_2_]]) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:        onnx.Return [[VAR_4_1_]] : tensor<4x8xf32>
+// CHECK-NEXT:      }) : (tensor<i1>) -> tensor<4x8xf32>
+// CHECK-NEXT:      [[VAR_5_:%.+]] = "onnx.Add"([[VAR_2_]], [[VAR_3_]]) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NEXT:      return [[VAR_3_]], [[VAR_5_]] : tensor<4x8xf32>, tensor<4x8xf32>
+}
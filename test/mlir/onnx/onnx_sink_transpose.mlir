@@ -0,0 +1,87 @@
+// RUN: onnx-mlir-opt --sink-transpose-onnx %s -split-input-file | FileCheck %s
+
+// Check that the transposes move past the elementwise ops, the constant
+// operand being permuted back, and cancel out.
+
+func.func @test_sink_transpose_add_mul(%arg0: tensor<1x3x4x5xf32>) -> tensor<1x3x4x5xf32> {
+  %cst = onnx.Constant dense<1.0> : tensor<1x4x5x3xf32>
+  %scale = onnx.Constant dense<2.0> : tensor<f32>
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x3x4x5xf32>) -> tensor<1x4x5x3xf32>
+  %1 = "onnx.Add"(%0, %cst) : (tensor<1x4x5x3xf32>, tensor<1x4x5x3xf32>) -> tensor<1x4x5x3xf32>
+  %2 = "onnx.Mul"(%1, %scale) : (tensor<1x4x5x3xf32>, tensor<f32>) -> tensor<1x4x5x3xf32>
+  %3 = "onnx.Transpose"(%2) {perm = [0, 3, 1, 2]} : (tensor<1x4x5x3xf32>) -> tensor<1x3x4x5xf32>
+  return %3 : tensor<1x3x4x5xf32>
+
+// CHECK-LABEL:  func.func @test_sink_transpose_add_mul
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3x4x5xf32>) -> tensor<1x3x4x5xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<1x4x5x3xf32>
+// CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<2.000000e+00> : tensor<f32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Transpose"([[VAR_0_]]) {perm = [0, 3, 1, 2]} : (tensor<1x4x5x3xf32>) -> tensor<1x3x4x5xf32>
+// CHECK:           [[VAR_3_:%.+]] = "onnx.Add"([[PARAM_0_]], [[VAR_2_]]) : (tensor<1x3x4x5xf32>, tensor<1x3x4x5xf32>) -> tensor<1x3x4x5xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.Mul"([[VAR_3_]], [[VAR_1_]]) : (tensor<1x3x4x5xf32>, tensor<f32>) -> tensor<1x3x4x5xf32>
+// CHECK-NOT:       "onnx.Transpose"
+// CHECK:           return [[VAR_4_]] : tensor<1x3x4x5xf32>
+}
+
+// -----
+
+// Check that Split and Concat compute along the remapped axis.
+
+func.func @test_sink_transpose_split_concat(%arg0: tensor<1x4x6x8xf32>) -> tensor<1x4x6x8xf32> {
+  %split = onnx.Constant dense<2> : tensor<2xi64>
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x4x6x8xf32>) -> tensor<1x6x8x4xf32>
+  %1:2 = "onnx.Split"(%0, %split) {axis = 3 : si64} : (tensor<1x6x8x4xf32>, tensor<2xi64>) -> (tensor<1x6x8x2xf32>, tensor<1x6x8x2xf32>)
+  %2 = "onnx.Relu"(%1#0) : (tensor<1x6x8x2xf32>) -> tensor<1x6x8x2xf32>
+  %3 = "onnx.Sigmoid"(%1#1) : (tensor<1x6x8x2xf32>) -> tensor<1x6x8x2xf32>
+  %4 = "onnx.Concat"(%2, %3) {axis = -1 : si64} : (tensor<1x6x8x2xf32>, tensor<1x6x8x2xf32>) -> tensor<1x6x8x4xf32>
+  %5 = "onnx.Transpose"(%4) {perm = [0, 3, 1, 2]} : (tensor<1x6x8x4xf32>) -> tensor<1x4x6x8xf32>
+  return %5 : tensor<1x4x6x8xf32>
+
+// CHECK-LABEL:  func.func @test_sink_transpose_split_concat
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x4x6x8xf32>) -> tensor<1x4x6x8xf32> {
+// CHECK-NOT:       "onnx.Transpose"
+// CHECK:           [[VAR_1_:%.+]]:2 = "onnx.Split"([[PARAM_0_]], {{.*}}) {axis = 1 : si64} : (tensor<1x4x6x8xf32>, tensor<2xi64>) -> (tensor<1x2x6x8xf32>, tensor<1x2x6x8xf32>)
+// CHECK-DAG:       [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]#0) : (tensor<1x2x6x8xf32>) -> tensor<1x2x6x8xf32>
+// CHECK-DAG:       [[VAR_3_:%.+]] = "onnx.Sigmoid"([[VAR_1_]]#1) : (tensor<1x2x6x8xf32>) -> tensor<1x2x6x8xf32>
+// CHECK:           [[VAR_4_:%.+]] = "onnx.Concat"([[VAR_2_]], [[VAR_3_]]) {axis = 1 : si64} : (tensor<1x2x6x8xf32>, tensor<1x2x6x8xf32>) -> tensor<1x4x6x8xf32>
+// CHECK-NOT:       "onnx.Transpose"
+// CHECK:           return [[VAR_4_]] : tensor<1x4x6x8xf32>
+}
+
+// -----
+
+// Check that a reduction without keepdims and Pad compute along the remapped
+// axes, the kept dims of the reduction being in the untransposed order.
+
+func.func @test_sink_transpose_reduce(%arg0: tensor<1x3x4x5xf32>) -> tensor<1x3xf32> {
+  %axes = onnx.Constant dense<[1, 2]> : tensor<2xi64>
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x3x4x5xf32>) -> tensor<1x4x5x3xf32>
+  %1 = "onnx.ReduceMean"(%0, %axes) {keepdims = 0 : si64} : (tensor<1x4x5x3xf32>, tensor<2xi64>) -> tensor<1x3xf32>
+  return %1 : tensor<1x3xf32>
+
+// CHECK-LABEL:  func.func @test_sink_transpose_reduce
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3x4x5xf32>) -> tensor<1x3xf32> {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<[2, 3]> : tensor<2xi64>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.ReduceMean"([[PARAM_0_]], [[VAR_0_]]) {keepdims = 0 : si64} : (tensor<1x3x4x5xf32>, tensor<2xi64>) -> tensor<1x3xf32>
+// CHECK-NOT:       "onnx.Transpose"
+// CHECK:           return [[VAR_1_]] : tensor<1x3xf32>
+}
+
+// -----
+
+func.func @test_sink_transpose_pad(%arg0: tensor<1x3x4x5xf32>) -> tensor<1x3x6x7xf32> {
+  %pads = onnx.Constant dense<[0, 1, 1, 0, 0, 1, 1, 0]> : tensor<8xi64>
+  %none = "onnx.NoValue"() {value} : () -> none
+  %0 = "onnx.Transpose"(%arg0) {perm = [0, 2, 3, 1]} : (tensor<1x3x4x5xf32>) -> tensor<1x4x5x3xf32>
+  %1 = "onnx.Pad"(%0, %pads, %none) {mode = "edge"} : (tensor<1x4x5x3xf32>, tensor<8xi64>, none) -> tensor<1x6x7x3xf32>
+  %2 = "onnx.Transpose"(%1) {perm = [0, 3, 1, 2]} : (tensor<1x6x7x3xf32>) -> tensor<1x3x6x7xf32>
+  return %2 : tensor<1x3x6x7xf32>
+
+// CHECK-LABEL:  func.func @test_sink_transpose_pad
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x3x4x5xf32>) -> tensor<1x3x6x7xf32> {
+// CHECK-DAG:       [[VAR_0_:%.+]] = "onnx.NoValue"() {value} : () -> none
+// CHECK-DAG:       [[VAR_1_:%.+]] = onnx.Constant dense<[0, 0, 1, 1, 0, 0, 1, 1]> : tensor<8xi64>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Pad"([[PARAM_0_]], [[VAR_1_]], [[VAR_0_]]) {mode = "edge"} : (tensor<1x3x4x5xf32>, tensor<8xi64>, none) -> tensor<1x3x6x7xf32>
+// CHECK-NOT:       "onnx.Transpose"
+// CHECK:           return [[VAR_2_]] : tensor<1x3x6x7xf32>
+}
@@ -0,0 +1,48 @@
+// RUN: onnx-mlir-opt --split-pipeline-stages="num-stages=2" %s -split-input-file | FileCheck %s
+
+// Check that the MatMuls are balanced between the stages, the input used by
+// the second stage being passed through the first one.
+module {
+  func.func @main_graph(%arg0: tensor<64x64xf32>, %arg1: tensor<64x64xf32>) -> tensor<64x64xf32> attributes {input_names = ["x", "y"], output_names = ["z"]} {
+    %0 = onnx.Constant dense<1.0> : tensor<64x64xf32>
+    %1 = "onnx.MatMul"(%arg0, %0) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+    %2 = "onnx.Relu"(%1) : (tensor<64x64xf32>) -> tensor<64x64xf32>
+    %3 = "onnx.MatMul"(%2, %0) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+    %4 = "onnx.Add"(%3, %arg1) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+    return %4 : tensor<64x64xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph_stage0
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<64x64xf32>, [[PARAM_1_:%.+]]: tensor<64x64xf32>) -> (tensor<64x64xf32>, tensor<64x64xf32>) attributes {input_names = ["x", "y"], output_names = ["y", "activation_2"]} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<64x64xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_0_]], [[VAR_0_]]) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]) : (tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           return [[PARAM_1_]], [[VAR_2_]] : tensor<64x64xf32>, tensor<64x64xf32>
+// CHECK:         }
+// CHECK:         func.func @main_graph_stage1
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<64x64xf32>, [[PARAM_1_:%.+]]: tensor<64x64xf32>) -> tensor<64x64xf32> attributes {input_names = ["y", "activation_2"], output_names = ["z"]} {
+// CHECK:           [[VAR_0_:%.+]] = onnx.Constant dense<1.000000e+00> : tensor<64x64xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.MatMul"([[PARAM_1_]], [[VAR_0_]]) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Add"([[VAR_1_]], [[PARAM_0_]]) : (tensor<64x64xf32>, tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           return [[VAR_2_]] : tensor<64x64xf32>
+// CHECK:         }
+// CHECK-NOT:     func.func @main_graph(
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_stage0} : () -> ()
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph_stage1} : () -> ()
+}
+
+// -----
+
+// Check that a function with a single op is not split.
+module {
+  func.func @main_graph(%arg0: tensor<4x128xf32>) -> tensor<4x128xf32> {
+    %0 = "onnx.Relu"(%arg0) : (tensor<4x128xf32>) -> tensor<4x128xf32>
+    return %0 : tensor<4x128xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-NOT:     func.func
+// CHECK:         "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+}
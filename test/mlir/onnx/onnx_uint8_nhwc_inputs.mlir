@@ -0,0 +1,34 @@
+// RUN: onnx-mlir-opt --uint8-nhwc-inputs="inputs=image,mask" %s -split-input-file -verify-diagnostics | FileCheck %s
+
+// Check that the image input is taken as a uint8 NHWC tensor, cast and
+// transposed back to NCHW for its users.
+module {
+  func.func @main_graph(%arg0: tensor<1x3x224x224xf32>, %arg1: tensor<1x10xf32>) -> tensor<1x3x224x224xf32> attributes {input_names = ["image", "scale"], output_names = ["y"]} {
+    %0 = "onnx.Relu"(%arg0) : (tensor<1x3x224x224xf32>) -> tensor<1x3x224x224xf32>
+    return %0 : tensor<1x3x224x224xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x224x224x3xui8>, [[PARAM_1_:%.+]]: tensor<1x10xf32>) -> tensor<1x3x224x224xf32>
+// CHECK:           [[VAR_0_:%.+]] = "onnx.Cast"([[PARAM_0_]]) {to = f32} : (tensor<1x224x224x3xui8>) -> tensor<1x224x224x3xf32>
+// CHECK:           [[VAR_1_:%.+]] = "onnx.Transpose"([[VAR_0_]]) {perm = [0, 3, 1, 2]} : (tensor<1x224x224x3xf32>) -> tensor<1x3x224x224xf32>
+// CHECK:           [[VAR_2_:%.+]] = "onnx.Relu"([[VAR_1_]]) : (tensor<1x3x224x224xf32>) -> tensor<1x3x224x224xf32>
+// CHECK:           return [[VAR_2_]] : tensor<1x3x224x224xf32>
+}
+
+// -----
+
+// Check that an input that is not a 4D float tensor is left as is.
+module {
+  // expected-warning @+1 {{input mask is not a 4D float tensor, not taken as uint8 NHWC}}
+  func.func @main_graph(%arg0: tensor<1x224x224xf32>) -> tensor<1x224x224xf32> attributes {input_names = ["mask"], output_names = ["y"]} {
+    %0 = "onnx.Relu"(%arg0) : (tensor<1x224x224xf32>) -> tensor<1x224x224xf32>
+    return %0 : tensor<1x224x224xf32>
+  }
+  "onnx.EntryPoint"() {func = @main_graph} : () -> ()
+
+// CHECK-LABEL:  func.func @main_graph
+// CHECK-SAME:   ([[PARAM_0_:%.+]]: tensor<1x224x224xf32>) -> tensor<1x224x224xf32>
+// CHECK-NOT:       onnx.Cast
+}
@@ -0,0 +1,382 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-- DataMovementModel.cpp - Building Data Movement Models for tests ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains functions that build models consisting of an
+// onnx.Transpose, onnx.Gather, onnx.Concat or onnx.Resize op, and compile
+// them.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cmath>
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// =============================================================================
+// Transpose with a given permutation
+
+TransposeLibBuilder::TransposeLibBuilder(const std::string &modelName,
+    const std::vector<int64_t> &xShape, const std::vector<int64_t> &perm)
+    : ModelLibBuilder(modelName), xShape(xShape), perm(perm) {
+  for (int64_t p : perm)
+    yShape.emplace_back(xShape[p]);
+}
+
+bool TransposeLibBuilder::build() {
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{xType};
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+
+  auto transposeOp = builder.create<ONNXTransposeOp>(
+      loc, /*Y=*/yType, /*X=*/xVal, /*perm=*/builder.getI64ArrayAttr(perm));
+
+  llvm::SmallVector<Value, 1> results = {transposeOp.getResult()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool TransposeLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>(xShape, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool TransposeLibBuilder::prepareInputs() {
+  return TransposeLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool TransposeLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>(yShape);
+  if (!x || !res || !ref)
+    return false;
+  std::vector<int64_t> xIndex(xShape.size());
+  for (std::vector<int64_t> &yIndex : omTensorComputeIndexSet(ref)) {
+    for (size_t i = 0; i < perm.size(); ++i)
+      xIndex[perm[i]] = yIndex[i];
+    omTensorGetElem<float>(ref, yIndex) = omTensorGetElem<float>(x, xIndex);
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+// =============================================================================
+// Gather of rows of a 2D tensor
+
+GatherLibBuilder::GatherLibBuilder(
+    const std::string &modelName, const int R, const int C, const int I)
+    : ModelLibBuilder(modelName), R(R), C(C), I(I) {}
+
+bool GatherLibBuilder::build() {
+  llvm::SmallVector<int64_t, 2> dataShape = {R, C};
+  llvm::SmallVector<int64_t, 1> indicesShape = {I};
+  llvm::SmallVector<int64_t, 2> yShape = {I, C};
+  auto dataType = RankedTensorType::get(dataShape, builder.getF32Type());
+  auto indicesType =
+      RankedTensorType::get(indicesShape, builder.getIntegerType(64));
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 2> inputsType{dataType, indicesType};
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto dataVal = entryBlock.getArgument(0);
+  auto indicesVal = entryBlock.getArgument(1);
+
+  auto gatherOp = builder.create<ONNXGatherOp>(loc, /*Y=*/yType,
+      /*data=*/dataVal, /*indices=*/indicesVal,
+      /*axis=*/builder.getSI64IntegerAttr(0));
+
+  llvm::SmallVector<Value, 1> results = {gatherOp.getResult()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool GatherLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 2;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>({R, C}, dataRangeLB, dataRangeUB);
+  list[1] = omTensorCreateWithShape<int64_t>({I});
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  if (!inputs || !list[0] || !list[1])
+    return false;
+  // Rows are spread over the data, as looked up from an embedding table.
+  for (int64_t i = 0; i < I; ++i)
+    omTensorGetElem<int64_t>(list[1], {i}) = (i * 48271 + 11) % R;
+  return true;
+}
+
+bool GatherLibBuilder::prepareInputs() {
+  return GatherLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool GatherLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *data = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *indices = omTensorListGetOmtByIndex(inputs, 1);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({I, C});
+  if (!data || !indices || !res || !ref)
+    return false;
+  for (int64_t i = 0; i < I; ++i) {
+    int64_t r = omTensorGetElem<int64_t>(indices, {i});
+    for (int64_t c = 0; c < C; ++c)
+      omTensorGetElem<float>(ref, {i, c}) =
+          omTensorGetElem<float>(data, {r, c});
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+// =============================================================================
+// Concat of 2D tensors of the same shape along one axis
+
+ConcatLibBuilder::ConcatLibBuilder(const std::string &modelName,
+    const int numInputs, const int N, const int C, const int axis)
+    : ModelLibBuilder(modelName), numInputs(numInputs), N(N), C(C),
+      axis(axis) {}
+
+bool ConcatLibBuilder::build() {
+  llvm::SmallVector<int64_t, 2> xShape = {N, C};
+  llvm::SmallVector<int64_t, 2> yShape = {N, C};
+  yShape[axis] *= numInputs;
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 4> inputsType(numInputs, xType);
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+
+  auto concatOp = builder.create<ONNXConcatOp>(loc, /*Y=*/yType,
+      /*inputs=*/entryBlock.getArguments(),
+      /*axis=*/builder.getSI64IntegerAttr(axis));
+
+  llvm::SmallVector<Value, 1> results = {concatOp.getResult()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool ConcatLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  OMTensor **list = (OMTensor **)malloc(numInputs * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  bool ok = true;
+  for (int i = 0; i < numInputs; ++i) {
+    list[i] =
+        omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+    ok = ok && list[i];
+  }
+  inputs = omTensorListCreateWithOwnership(list, numInputs, true);
+  return inputs && ok;
+}
+
+bool ConcatLibBuilder::prepareInputs() {
+  return ConcatLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool ConcatLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = axis == 0
+                      ? omTensorCreateWithShape<float>({N * numInputs, C})
+                      : omTensorCreateWithShape<float>({N, C * numInputs});
+  if (!res || !ref)
+    return false;
+  for (int64_t i = 0; i < numInputs; ++i) {
+    OMTensor *x = omTensorListGetOmtByIndex(inputs, i);
+    for (int64_t n = 0; n < N; ++n) {
+      for (int64_t c = 0; c < C; ++c) {
+        std::vector<int64_t> yIndex =
+            axis == 0 ? std::vector<int64_t>{i * N + n, c}
+                      : std::vector<int64_t>{n, i * C + c};
+        omTensorGetElem<float>(ref, yIndex) = omTensorGetElem<float>(x, {n, c});
+      }
+    }
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+// =============================================================================
+// Resize of the 2 innermost dims of a 4D tensor by an integer scale
+
+ResizeLibBuilder::ResizeLibBuilder(const std::string &modelName, const int N,
+    const int C, const int H, const int W, const int scale,
+    const bool isLinear)
+    : ModelLibBuilder(modelName), N(N), C(C), H(H), W(W), scale(scale),
+      isLinear(isLinear) {}
+
+bool ResizeLibBuilder::build() {
+  llvm::SmallVector<int64_t, 4> xShape = {N, C, H, W};
+  llvm::SmallVector<int64_t, 4> yShape = {N, C, H * scale, W * scale};
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{xType};
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+
+  MultiDialectBuilder<OnnxBuilder> create(builder, loc);
+  float scaleVal = scale;
+  llvm::SmallVector<float, 4> scales = {1, 1, scaleVal, scaleVal};
+  auto scalesType = RankedTensorType::get({4}, builder.getF32Type());
+  Value scalesVal = create.onnx.constant(
+      DenseElementsAttr::get(scalesType, llvm::ArrayRef(scales)));
+  Value noneVal = builder.create<ONNXNoneOp>(loc);
+  llvm::SmallVector<NamedAttribute, 3> attrs;
+  if (isLinear) {
+    attrs.emplace_back(builder.getNamedAttr(
+        "coordinate_transformation_mode", builder.getStringAttr("half_pixel")));
+    attrs.emplace_back(
+        builder.getNamedAttr("mode", builder.getStringAttr("linear")));
+  } else {
+    attrs.emplace_back(builder.getNamedAttr(
+        "coordinate_transformation_mode", builder.getStringAttr("asymmetric")));
+    attrs.emplace_back(
+        builder.getNamedAttr("mode", builder.getStringAttr("nearest")));
+    attrs.emplace_back(
+        builder.getNamedAttr("nearest_mode", builder.getStringAttr("floor")));
+  }
+  auto resizeOp = builder.create<ONNXResizeOp>(loc, TypeRange{yType},
+      /*X, roi, scales, sizes=*/ValueRange{xVal, noneVal, scalesVal, noneVal},
+      attrs);
+
+  llvm::SmallVector<Value, 1> results = {resizeOp.getResult()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool ResizeLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] = omTensorCreateWithRandomData<float>(
+      {N, C, H, W}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool ResizeLibBuilder::prepareInputs() {
+  return ResizeLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+// Get the input coordinate of an output coordinate along a resized dim, as
+// the lower input index and the weight of the upper one for linear resizes.
+static int64_t getInputCoordinate(
+    int64_t out, int64_t inSize, int scale, bool isLinear, float &weight) {
+  weight = 0.0;
+  if (!isLinear)
+    return out / scale;
+  // Half pixel coordinates, clamped to the input.
+  float in = std::min(
+      std::max((out + 0.5f) / scale - 0.5f, 0.0f), (float)(inSize - 1));
+  int64_t lower = (int64_t)std::floor(in);
+  weight = in - lower;
+  return lower;
+}
+
+bool ResizeLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C, H * scale, W * scale});
+  if (!x || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      for (int64_t h = 0; h < H * scale; ++h) {
+        float hWeight;
+        int64_t h0 = getInputCoordinate(h, H, scale, isLinear, hWeight);
+        int64_t h1 = std::min(h0 + 1, (int64_t)H - 1);
+        for (int64_t w = 0; w < W * scale; ++w) {
+          float wWeight;
+          int64_t w0 = getInputCoordinate(w, W, scale, isLinear, wWeight);
+          int64_t w1 = std::min(w0 + 1, (int64_t)W - 1);
+          float top =
+              omTensorGetElem<float>(x, {n, c, h0, w0}) * (1 - wWeight) +
+              omTensorGetElem<float>(x, {n, c, h0, w1}) * wWeight;
+          float bottom =
+              omTensorGetElem<float>(x, {n, c, h1, w0}) * (1 - wWeight) +
+              omTensorGetElem<float>(x, {n, c, h1, w1}) * wWeight;
+          omTensorGetElem<float>(ref, {n, c, h, w}) =
+              top * (1 - hWeight) + bottom * hWeight;
+        }
+      }
+    }
+  }
+  bool ok = areCloseFloat(res, ref, /*rtol=*/1e-4, /*atol=*/1e-4);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -0,0 +1,120 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//========-- ElementwiseModel.cpp - Building Elementwise Models for tests -===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains a function that builds a model consisting of a chain of
+// elementwise ops and compiles it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// =============================================================================
+// Chain of onnx.Add, onnx.Mul and onnx.Relu ops
+
+ElementwiseChainLibBuilder::ElementwiseChainLibBuilder(
+    const std::string &modelName, const int N, const int C, const int numOps,
+    const bool isDynamic)
+    : ModelLibBuilder(modelName), N(N), C(C), numOps(numOps),
+      isDynamic(isDynamic) {}
+
+bool ElementwiseChainLibBuilder::build() {
+  int64_t N1 = isDynamic ? ShapedType::kDynamic : N;
+  llvm::SmallVector<int64_t, 2> shape = {N1, C};
+  auto type = RankedTensorType::get(shape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 2> inputsType{type, type};
+  llvm::SmallVector<Type, 1> outputsType{type};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+  auto yVal = entryBlock.getArgument(1);
+
+  // The ops cycle through Add(., Y), Mul(., Y) and Relu(.).
+  Value val = xVal;
+  for (int i = 0; i < numOps; ++i) {
+    if (i % 3 == 0)
+      val = builder.create<ONNXAddOp>(loc, type, val, yVal);
+    else if (i % 3 == 1)
+      val = builder.create<ONNXMulOp>(loc, type, val, yVal);
+    else
+      val = builder.create<ONNXReluOp>(loc, type, val);
+  }
+
+  llvm::SmallVector<Value, 1> results = {val};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool ElementwiseChainLibBuilder::prepareInputs(
+    float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 2;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+  list[1] =
+      omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0] && list[1];
+}
+
+bool ElementwiseChainLibBuilder::prepareInputs() {
+  return ElementwiseChainLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool ElementwiseChainLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *y = omTensorListGetOmtByIndex(inputs, 1);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C});
+  if (!x || !y || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      float val = omTensorGetElem<float>(x, {n, c});
+      float yVal = omTensorGetElem<float>(y, {n, c});
+      for (int i = 0; i < numOps; ++i) {
+        if (i % 3 == 0)
+          val = val + yVal;
+        else if (i % 3 == 1)
+          val = val * yVal;
+        else
+          val = (val > 0.0) ? val : 0.0;
+      }
+      omTensorGetElem<float>(ref, {n, c}) = val;
+    }
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -27,9 +27,13 @@ namespace test {
 
 GemmLibBuilder::GemmLibBuilder(const std::string &modelName, const int I,
     const int J, const int K, const int aTrans, const int bTrans,
-    const int cRank, const float alphaVal, const float betaVal)
+    const int cRank, const float alphaVal, const float betaVal,
+    const bool isConstantB)
     : ModelLibBuilder(modelName), I(I), J(J), K(K), aTrans(aTrans),
-      bTrans(bTrans), cRank(cRank), alphaVal(alphaVal), betaVal(betaVal) {}
+      bTrans(bTrans), cRank(cRank), alphaVal(alphaVal), betaVal(betaVal),
+      isConstantB(isConstantB), bOmt(nullptr) {}
+
+GemmLibBuilder::~GemmLibBuilder() { omTensorDestroy(bOmt); }
 
 bool GemmLibBuilder::build() {
   aShape = {I, K};
@@ -51,14 +55,24 @@ bool GemmLibBuilder::build() {
   auto yType = RankedTensorType::get(yShape, builder.getF32Type());
 
   llvm::SmallVector<Type, 3> inputsType{aType, bType, cType};
+  if (isConstantB)
+    inputsType = {aType, cType};
   llvm::SmallVector<Type, 1> outputsType{yType};
 
   func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
   Block &entryBlock = funcOp.getBody().front();
 
-  auto aVal = entryBlock.getArgument(0);
-  auto bVal = entryBlock.getArgument(1);
-  auto cVal = entryBlock.getArgument(2);
+  Value aVal = entryBlock.getArgument(0);
+  Value bVal, cVal;
+  if (isConstantB) {
+    bOmt = omTensorCreateWithRandomData<float>(
+        llvm::ArrayRef(bShape), -omDefaultRangeBound, omDefaultRangeBound);
+    bVal = buildONNXConstantOp(bOmt, bType);
+    cVal = entryBlock.getArgument(1);
+  } else {
+    bVal = entryBlock.getArgument(1);
+    cVal = entryBlock.getArgument(2);
+  }
 
   FloatAttr alphaAttr = FloatAttr::get(builder.getF32Type(), alphaVal);
   FloatAttr betaAttr = FloatAttr::get(builder.getF32Type(), betaVal);
@@ -80,18 +94,19 @@ bool GemmLibBuilder::build() {
 }
 
 bool GemmLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
-  constexpr int num = 3;
+  const int num = isConstantB ? 2 : 3;
   OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
   if (!list)
     return false;
   list[0] = omTensorCreateWithRandomData<float>(
       llvm::ArrayRef(aShape), dataRangeLB, dataRangeUB);
-  list[1] = omTensorCreateWithRandomData<float>(
-      llvm::ArrayRef(bShape), dataRangeLB, dataRangeUB);
-  list[2] = omTensorCreateWithRandomData<float>(
+  if (!isConstantB)
+    list[1] = omTensorCreateWithRandomData<float>(
+        llvm::ArrayRef(bShape), dataRangeLB, dataRangeUB);
+  list[num - 1] = omTensorCreateWithRandomData<float>(
       llvm::ArrayRef(cShape), dataRangeLB, dataRangeUB);
   inputs = omTensorListCreateWithOwnership(list, num, true);
-  return inputs && list[0] && list[1] && list[2];
+  return inputs && list[0] && list[1] && list[num - 1];
 }
 
 bool GemmLibBuilder::prepareInputs() {
@@ -110,8 +125,8 @@ bool GemmLibBuilder::verifyOutputs() {
   if (!inputs || !outputs)
     return false;
   OMTensor *a = omTensorListGetOmtByIndex(inputs, 0);
-  OMTensor *b = omTensorListGetOmtByIndex(inputs, 1);
-  OMTensor *c = omTensorListGetOmtByIndex(inputs, 2);
+  OMTensor *b = isConstantB ? bOmt : omTensorListGetOmtByIndex(inputs, 1);
+  OMTensor *c = omTensorListGetOmtByIndex(inputs, isConstantB ? 1 : 2);
   OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
   OMTensor *ref = omTensorCreateWithShape<float>({I, J});
   if (!a || !b || !c || !res || !ref)
@@ -0,0 +1,124 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//======-- LargeConstantsModel.cpp - Building Large Constant Models -=========//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains a function that builds a model consisting of a chain of
+// onnx.Add ops with large constants, and compiles it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Values of the elements of the two constants of each layer, generated rather
+// than stored so that the reference does not hold a copy of the constants.
+static float getConstantA(int64_t layer, int64_t i) {
+  return ((layer * 7 + i) % 13) * 0.01;
+}
+
+static float getConstantB(int64_t layer, int64_t i) {
+  return ((layer * 3 + i) % 11) * -0.01;
+}
+
+// =============================================================================
+// Chain of Add(., Add(A, B)) layers with NxC constants A and B
+
+LargeConstantsLibBuilder::LargeConstantsLibBuilder(const std::string &modelName,
+    const int numLayers, const int N, const int C)
+    : ModelLibBuilder(modelName), numLayers(numLayers), N(N), C(C) {}
+
+bool LargeConstantsLibBuilder::build() {
+  llvm::SmallVector<int64_t, 2> shape = {N, C};
+  auto type = RankedTensorType::get(shape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{type};
+  llvm::SmallVector<Type, 1> outputsType{type};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  Value val = entryBlock.getArgument(0);
+
+  // Build the constants of one layer at a time, so that only the attributes
+  // hold their values.
+  MultiDialectBuilder<OnnxBuilder> create(builder, loc);
+  std::vector<float> values(N * C);
+  for (int64_t layer = 0; layer < numLayers; ++layer) {
+    for (int64_t i = 0; i < N * C; ++i)
+      values[i] = getConstantA(layer, i);
+    Value aVal = create.onnx.constant(
+        DenseElementsAttr::get(type, llvm::ArrayRef(values)));
+    for (int64_t i = 0; i < N * C; ++i)
+      values[i] = getConstantB(layer, i);
+    Value bVal = create.onnx.constant(
+        DenseElementsAttr::get(type, llvm::ArrayRef(values)));
+    Value sumVal = builder.create<ONNXAddOp>(loc, type, aVal, bVal);
+    val = builder.create<ONNXAddOp>(loc, type, val, sumVal);
+  }
+
+  llvm::SmallVector<Value, 1> results = {val};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool LargeConstantsLibBuilder::prepareInputs(
+    float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool LargeConstantsLibBuilder::prepareInputs() {
+  return LargeConstantsLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool LargeConstantsLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C});
+  if (!x || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      int64_t i = n * C + c;
+      float val = omTensorGetElem<float>(x, {n, c});
+      for (int64_t layer = 0; layer < numLayers; ++layer)
+        val += getConstantA(layer, i) + getConstantB(layer, i);
+      omTensorGetElem<float>(ref, {n, c}) = val;
+    }
+  }
+  bool ok = areCloseFloat(res, ref, /*rtol=*/1e-4, /*atol=*/1e-4);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -29,13 +29,15 @@ namespace test {
 // =============================================================================
 // Model consisting of onnx.Add, onnx.LeakyRelu and onnx.Sub ops
 
-LeakyReluLibBuilder::LeakyReluLibBuilder(
-    const std::string &modelName, const int N, const float alphaVal)
-    : ModelLibBuilder(modelName), N(N), alphaVal(alphaVal) {}
+LeakyReluLibBuilder::LeakyReluLibBuilder(const std::string &modelName,
+    const int N, const float alphaVal, const bool isDynamic)
+    : ModelLibBuilder(modelName), N(N), alphaVal(alphaVal),
+      isDynamic(isDynamic) {}
 
 bool LeakyReluLibBuilder::build() {
-  llvm::SmallVector<int64_t, 1> xShape = {N};
-  llvm::SmallVector<int64_t, 1> yShape = {N};
+  int64_t N1 = isDynamic ? ShapedType::kDynamic : N;
+  llvm::SmallVector<int64_t, 1> xShape = {N1};
+  llvm::SmallVector<int64_t, 1> yShape = {N1};
   auto xType = RankedTensorType::get(xShape, builder.getF32Type());
   auto yType = RankedTensorType::get(yShape, builder.getF32Type());
 
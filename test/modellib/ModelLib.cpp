@@ -12,11 +12,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+
 #include "mlir/IR/BuiltinOps.h"
 
 #include "include/OnnxMlirRuntime.h"
 #include "src/Compiler/CompilerUtils.hpp"
 #include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/ExecutionBatcher.hpp"
+#include "src/Runtime/ExecutionPipeline.hpp"
 #include "src/Runtime/OMTensorHelper.hpp"
 #include "test/modellib/ModelLib.hpp"
 
@@ -46,7 +53,9 @@ bool ModelLibBuilder::compileAndLoad() {
     return false;
   std::string libFilename =
       getTargetFilename(sharedLibBaseName, onnx_mlir::EmitLib);
-  exec = new ExecutionSession(libFilename);
+  // A model split into pipeline stages has no run_main_graph entry point.
+  exec = new ExecutionSession(libFilename,
+      /*defaultEntryPoint=*/pipelineStages <= 1);
   return exec != nullptr;
 }
 
@@ -94,6 +103,217 @@ bool ModelLibBuilder::run() {
   return true;
 }
 
+bool ModelLibBuilder::runConcurrently(int numThreads) {
+  assert(inputs && exec && "expected successful compile and load");
+  assert(numThreads > 0 && "expected at least one thread");
+  if (outputs) {
+    omTensorListDestroy(outputs);
+    outputs = nullptr; // Reset in case run has an exception.
+  }
+  std::vector<OMTensorList *> threadOutputs(numThreads, nullptr);
+  std::vector<std::thread> threads;
+  try {
+    const ExecutionEntryPoint entryPoint =
+        exec->getEntryPoint("run_main_graph");
+    for (int t = 0; t < numThreads; ++t)
+      threads.emplace_back([&, t]() {
+        try {
+          threadOutputs[t] = entryPoint.run(inputs);
+        } catch (const std::runtime_error &error) {
+          std::cerr << "error while running thread " << t << ": "
+                    << error.what() << std::endl;
+        }
+      });
+    for (std::thread &thread : threads)
+      thread.join();
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  // All the threads must compute the same outputs as the first one.
+  bool success = true;
+  for (int t = 0; t < numThreads && success; ++t) {
+    if (!threadOutputs[t]) {
+      success = false;
+      break;
+    }
+    int64_t numOutputs = omTensorListGetSize(threadOutputs[t]);
+    success = numOutputs == omTensorListGetSize(threadOutputs[0]);
+    for (int64_t i = 0; i < numOutputs && success; ++i) {
+      OMTensor *res = omTensorListGetOmtByIndex(threadOutputs[t], i);
+      OMTensor *ref = omTensorListGetOmtByIndex(threadOutputs[0], i);
+      success = omTensorGetBufferSize(res) == omTensorGetBufferSize(ref) &&
+                memcmp(omTensorGetDataPtr(res), omTensorGetDataPtr(ref),
+                    omTensorGetBufferSize(res)) == 0;
+    }
+    if (!success)
+      std::cerr << "outputs of thread " << t << " differ" << std::endl;
+  }
+  for (int t = (success ? 1 : 0); t < numThreads; ++t)
+    omTensorListDestroy(threadOutputs[t]);
+  if (success)
+    outputs = threadOutputs[0];
+  return success;
+}
+
+// Return the concatenation along their first dimension of the outputs of
+// consecutive runs on rows of the inputs, or null on failure.
+static OMTensorList *concatOutputs(
+    const std::vector<std::vector<OMTensorUniquePtr>> &runOutputs) {
+  int64_t numOutputs = runOutputs[0].size();
+  OMTensor **list = (OMTensor **)malloc(numOutputs * sizeof(OMTensor *));
+  if (!list)
+    return nullptr;
+  for (int64_t o = 0; o < numOutputs; ++o) {
+    OMTensor *first = runOutputs[0][o].get();
+    int64_t rank = omTensorGetRank(first);
+    std::vector<int64_t> shape(
+        omTensorGetShape(first), omTensorGetShape(first) + rank);
+    shape[0] = 0;
+    for (const std::vector<OMTensorUniquePtr> &outs : runOutputs)
+      shape[0] += omTensorGetShape(outs[o].get())[0];
+    list[o] =
+        omTensorCreateEmpty(shape.data(), rank, omTensorGetDataType(first));
+    char *dataPtr = static_cast<char *>(omTensorGetDataPtr(list[o]));
+    for (const std::vector<OMTensorUniquePtr> &outs : runOutputs) {
+      OMTensor *out = outs[o].get();
+      memcpy(dataPtr, omTensorGetDataPtr(out), omTensorGetBufferSize(out));
+      dataPtr += omTensorGetBufferSize(out);
+    }
+  }
+  return omTensorListCreateWithOwnership(list, numOutputs, true);
+}
+
+bool ModelLibBuilder::runBatched(int maxBatchSize) {
+  assert(inputs && exec && "expected successful compile and load");
+  if (outputs) {
+    omTensorListDestroy(outputs);
+    outputs = nullptr; // Reset in case run has an exception.
+  }
+  int64_t numInputs = omTensorListGetSize(inputs);
+  int64_t numRows = omTensorGetShape(omTensorListGetOmtByIndex(inputs, 0))[0];
+  std::vector<std::vector<OMTensorUniquePtr>> rowOutputs;
+  try {
+    ExecutionBatcher batcher(exec->getEntryPoint("run_main_graph"),
+        maxBatchSize, std::chrono::milliseconds(10));
+    std::vector<std::future<std::vector<OMTensorUniquePtr>>> futureOutputs;
+    for (int64_t r = 0; r < numRows; ++r) {
+      // Each request refers to a row of the inputs, without copying it.
+      std::vector<OMTensorUniquePtr> rowInputs;
+      for (int64_t i = 0; i < numInputs; ++i) {
+        OMTensor *in = omTensorListGetOmtByIndex(inputs, i);
+        int64_t rank = omTensorGetRank(in);
+        std::vector<int64_t> shape(
+            omTensorGetShape(in), omTensorGetShape(in) + rank);
+        int64_t rowSize = omTensorGetBufferSize(in) / numRows;
+        shape[0] = 1;
+        rowInputs.emplace_back(
+            omTensorCreate(static_cast<char *>(omTensorGetDataPtr(in)) +
+                               r * rowSize,
+                shape.data(), rank, omTensorGetDataType(in)),
+            omTensorDestroy);
+      }
+      futureOutputs.emplace_back(batcher.submit(std::move(rowInputs)));
+    }
+    for (auto &futureOutput : futureOutputs)
+      rowOutputs.emplace_back(futureOutput.get());
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  // Concatenate the outputs of the requests.
+  outputs = concatOutputs(rowOutputs);
+  return outputs != nullptr;
+}
+
+bool ModelLibBuilder::runPipelined(int numMicroBatches) {
+  assert(inputs && exec && "expected successful compile and load");
+  assert(numMicroBatches > 0 && "expected at least one micro-batch");
+  if (outputs) {
+    omTensorListDestroy(outputs);
+    outputs = nullptr; // Reset in case run has an exception.
+  }
+  int64_t numInputs = omTensorListGetSize(inputs);
+  int64_t numRows = omTensorGetShape(omTensorListGetOmtByIndex(inputs, 0))[0];
+  std::vector<std::vector<OMTensorUniquePtr>> microBatchOutputs;
+  try {
+    ExecutionPipeline pipeline(ExecutionPipeline::getStages(*exec));
+    // Each micro-batch refers to contiguous rows of the inputs, without
+    // copying them, the first micro-batches having one more row.
+    std::vector<std::vector<OMTensorUniquePtr>> microBatches;
+    int64_t firstRow = 0;
+    for (int64_t m = 0; m < numMicroBatches; ++m) {
+      int64_t numMicroBatchRows =
+          numRows / numMicroBatches + (m < numRows % numMicroBatches ? 1 : 0);
+      std::vector<OMTensorUniquePtr> microBatchInputs;
+      for (int64_t i = 0; i < numInputs; ++i) {
+        OMTensor *in = omTensorListGetOmtByIndex(inputs, i);
+        int64_t rank = omTensorGetRank(in);
+        std::vector<int64_t> shape(
+            omTensorGetShape(in), omTensorGetShape(in) + rank);
+        int64_t rowSize = omTensorGetBufferSize(in) / numRows;
+        shape[0] = numMicroBatchRows;
+        microBatchInputs.emplace_back(
+            omTensorCreate(static_cast<char *>(omTensorGetDataPtr(in)) +
+                               firstRow * rowSize,
+                shape.data(), rank, omTensorGetDataType(in)),
+            omTensorDestroy);
+      }
+      microBatches.emplace_back(std::move(microBatchInputs));
+      firstRow += numMicroBatchRows;
+    }
+    microBatchOutputs = pipeline.run(std::move(microBatches));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  // Concatenate the outputs of the micro-batches.
+  outputs = concatOutputs(microBatchOutputs);
+  return outputs != nullptr;
+}
+
+bool ModelLibBuilder::runSplitBatch(int numSlices) {
+  assert(inputs && exec && "expected successful compile and load");
+  if (outputs) {
+    omTensorListDestroy(outputs);
+    outputs = nullptr; // Reset in case run has an exception.
+  }
+  std::vector<OMTensorUniquePtr> ins;
+  for (int64_t i = 0; i < omTensorListGetSize(inputs); ++i) {
+    OMTensor *in = omTensorListGetOmtByIndex(inputs, i);
+    ins.emplace_back(omTensorCreate(omTensorGetDataPtr(in),
+                         omTensorGetShape(in), omTensorGetRank(in),
+                         omTensorGetDataType(in)),
+        omTensorDestroy);
+  }
+  std::vector<OMTensorUniquePtr> outs;
+  try {
+    outs = exec->runSplitBatch(ins, numSlices);
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  int64_t numOutputs = outs.size();
+  OMTensor **list = (OMTensor **)malloc(numOutputs * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  for (int64_t o = 0; o < numOutputs; ++o)
+    list[o] = outs[o].release();
+  outputs = omTensorListCreateWithOwnership(list, numOutputs, true);
+  return outputs != nullptr;
+}
+
+bool ModelLibBuilder::runAndDiscard() {
+  assert(inputs && exec && "expected successful compile and load");
+  try {
+    omTensorListDestroy(exec->run(inputs));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
 void ModelLibBuilder::setRandomNumberGeneratorSeed(const std::string &envVar) {
   bool hasSeedValue = false;
   unsigned int seed = 0;
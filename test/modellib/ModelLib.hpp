@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <type_traits>
 
@@ -26,6 +27,7 @@
 #include "src/Compiler/CompilerUtils.hpp"
 #include "src/Dialect/ONNX/ONNXOps.hpp"
 #include "src/Runtime/ExecutionSession.hpp"
+#include "src/Runtime/ExecutionState.hpp"
 
 namespace onnx_mlir {
 namespace test {
@@ -116,6 +118,28 @@ public:
   virtual bool prepareInputs() = 0;
   // Run model using prepared inputs, resulting in outputs. It must run fourth.
   bool run();
+  // Same as run, except that the model runs from numThreads threads at once
+  // with a shared entry point handle. Fails unless all the threads compute
+  // identical outputs, which then become the outputs of the run.
+  bool runConcurrently(int numThreads);
+  // Same as run, except that the inputs are split along their first dimension
+  // into single row requests, run through an ExecutionBatcher with the given
+  // maximum batch size, and whose outputs are concatenated back. The first
+  // dimension of the model inputs must be dynamic.
+  bool runBatched(int maxBatchSize);
+  // Same as run, except that the inputs are split along their first dimension
+  // into numMicroBatches micro-batches, run through an ExecutionPipeline of
+  // the stages of the model, and whose outputs are concatenated back. The
+  // model must be compiled with --pipeline-stages, and the first dimension of
+  // its inputs must be dynamic.
+  bool runPipelined(int numMicroBatches);
+  // Same as run, except that the batch, namely the first dimension of the
+  // inputs, is split into numSlices slices run concurrently by
+  // ExecutionSession::runSplitBatch.
+  bool runSplitBatch(int numSlices);
+  // Same as run, except that the outputs are freed instead of kept, so that
+  // any number of threads may call it at once, e.g. to measure throughput.
+  bool runAndDiscard();
   // Verify outputs from a run with reference data. It can run last.
   virtual bool verifyOutputs() = 0;
 
@@ -225,11 +249,15 @@ private:
   const llvm::ArrayRef<T2> expOutput; // expected result.
 };
 
+// Gemm of A and B, which is a random constant of the model when isConstantB
+// is set, the inputs then being A and C only.
 class GemmLibBuilder : public ModelLibBuilder {
 public:
   GemmLibBuilder(const std::string &modelName, const int I, const int J,
       const int K, const int aTrans, const int bTrans, const int cRank,
-      const float alphaVal, const float betaVal);
+      const float alphaVal, const float betaVal,
+      const bool isConstantB = false);
+  virtual ~GemmLibBuilder();
   bool build() final;
   bool prepareInputs() final;
   bool prepareInputs(float dataRangeLB, float dataRangeUB);
@@ -240,8 +268,10 @@ private:
   // Data that defines model.
   const int I, J, K, aTrans, bTrans, cRank;
   const float alphaVal, betaVal;
+  const bool isConstantB;
   // Derived data that defines model.
   llvm::SmallVector<int64_t, 2> aShape, bShape, cShape;
+  OMTensor *bOmt;
 };
 
 class ScanLibBuilder : public ModelLibBuilder {
@@ -266,8 +296,8 @@ private:
 
 class LeakyReluLibBuilder : public ModelLibBuilder {
 public:
-  LeakyReluLibBuilder(
-      const std::string &modelName, const int N, const float alpha);
+  LeakyReluLibBuilder(const std::string &modelName, const int N,
+      const float alpha, const bool isDynamic = false);
   bool build() final;
   bool prepareInputs() final;
   bool prepareInputs(float dataRangeLB, float dataRangeUB);
@@ -278,12 +308,183 @@ private:
   // Data that defines model.
   const int N;
   const float alphaVal;
+  const bool isDynamic;
   // Derived data that defines model.
   llvm::SmallVector<int64_t, 2> xShape, yShape;
   // model definition in std::string
   std::string moduleIR;
 };
 
+// Chain of numOps elementwise ops over NxC tensors X and Y, cycling through
+// Add(., Y), Mul(., Y) and Relu(.), starting from X. The chain is computed in
+// a single loop nest when compiled with --fusion. N is dynamic in the model
+// when isDynamic is set.
+class ElementwiseChainLibBuilder : public ModelLibBuilder {
+public:
+  ElementwiseChainLibBuilder(const std::string &modelName, const int N,
+      const int C, const int numOps, const bool isDynamic = false);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int N, C, numOps;
+  const bool isDynamic;
+};
+
+// Softmax of a NxC tensor along its innermost axis.
+class SoftmaxLibBuilder : public ModelLibBuilder {
+public:
+  SoftmaxLibBuilder(const std::string &modelName, const int N, const int C);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int N, C;
+};
+
+// LayerNormalization of a NxC tensor along its innermost axis, with scale and
+// bias of size C.
+class LayerNormLibBuilder : public ModelLibBuilder {
+public:
+  LayerNormLibBuilder(const std::string &modelName, const int N, const int C);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  static constexpr float epsilon = 1e-5;
+  // Data that defines model.
+  const int N, C;
+};
+
+// ReduceSum, or ReduceMean when isMean, of a NxCxH tensor over one axis,
+// keeping the reduced dim.
+class ReduceLibBuilder : public ModelLibBuilder {
+public:
+  ReduceLibBuilder(const std::string &modelName, const bool isMean,
+      const int N, const int C, const int H, const int axis);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const bool isMean;
+  const int N, C, H, axis;
+  // Derived data that defines model.
+  std::vector<int64_t> xShape, yShape;
+};
+
+// MaxPool, or AveragePool when not isMax, of a NxCxHxW tensor with a KxK
+// kernel and the given stride in both dims, without padding.
+class Pool2DLibBuilder : public ModelLibBuilder {
+public:
+  Pool2DLibBuilder(const std::string &modelName, const bool isMax, const int N,
+      const int C, const int H, const int W, const int K, const int stride);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const bool isMax;
+  const int N, C, H, W, K, stride;
+  // Derived data that defines model.
+  const int HOut, WOut;
+};
+
+// Transpose of a tensor of the given shape by the given permutation.
+class TransposeLibBuilder : public ModelLibBuilder {
+public:
+  TransposeLibBuilder(const std::string &modelName,
+      const std::vector<int64_t> &xShape, const std::vector<int64_t> &perm);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const std::vector<int64_t> xShape, perm;
+  // Derived data that defines model.
+  std::vector<int64_t> yShape;
+};
+
+// Gather of I rows, spread over a RxC tensor, along its first axis.
+class GatherLibBuilder : public ModelLibBuilder {
+public:
+  GatherLibBuilder(
+      const std::string &modelName, const int R, const int C, const int I);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int R, C, I;
+};
+
+// Concat of numInputs NxC tensors along the given axis.
+class ConcatLibBuilder : public ModelLibBuilder {
+public:
+  ConcatLibBuilder(const std::string &modelName, const int numInputs,
+      const int N, const int C, const int axis);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int numInputs, N, C, axis;
+};
+
+// Resize of the HxW innermost dims of a NxCxHxW tensor by an integer scale,
+// in nearest mode with asymmetric coordinates, or in linear mode with half
+// pixel coordinates when isLinear.
+class ResizeLibBuilder : public ModelLibBuilder {
+public:
+  ResizeLibBuilder(const std::string &modelName, const int N, const int C,
+      const int H, const int W, const int scale, const bool isLinear);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int N, C, H, W, scale;
+  const bool isLinear;
+};
+
+// Chain of numLayers layers adding the sum of two NxC constants to the input,
+// the constants being generated from their layer and position. The sums of
+// constants are folded by the compiler, making it a stress test for constant
+// propagation and the emission of large constants.
+class LargeConstantsLibBuilder : public ModelLibBuilder {
+public:
+  LargeConstantsLibBuilder(const std::string &modelName, const int numLayers,
+      const int N, const int C);
+  bool build() final;
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int numLayers, N, C;
+};
+
 // 2x2 matmul with no broadcast
 class MatMul2DLibBuilder : public ModelLibBuilder {
 public:
@@ -466,5 +667,71 @@ private:
   OMTensor *wOmt, *rOmt, *bOmt;
 };
 
+// Accumulation of NxC inputs X into a state S, run step by step through an
+// ExecutionState. Each step returns S + X as the next state, and passes the
+// past state and the input X through as its outputs.
+class StateAccumulatorLibBuilder : public ModelLibBuilder {
+public:
+  StateAccumulatorLibBuilder(const std::string &modelName, const int N,
+      const int C, const int numSteps);
+  bool build() final;
+  // Prepare the inputs of the numSteps steps.
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  // Reset the state to zeros, and forget the outputs of the steps.
+  bool resetStates();
+  // Run a step on a copy of its input, keeping its outputs. The input has a
+  // wrong shape when isCorrupted, which fails the step when the model
+  // verifies its inputs.
+  bool runStep(int step, bool isCorrupted = false);
+  // Verify the outputs of the steps, run in order since the reset, and the
+  // state, with a naive implementation.
+  bool verifyOutputs() final;
+
+private:
+  // Data that defines model.
+  const int N, C, numSteps;
+  // Input of each step, and outputs of each step run.
+  std::vector<OMTensorUniquePtr> stepInputs;
+  std::vector<std::vector<OMTensorUniquePtr>> stepOutputs;
+  std::unique_ptr<onnx_mlir::ExecutionState> state;
+};
+
+// Decoder attention over a key/value cache, run step by step through an
+// ExecutionState. Each step concatenates the keys and values of T new tokens
+// [B, H, T, D] to the past ones, bound to the states, and attends the queries
+// of the new tokens to all the keys. The caches are paged when numBlocks is
+// positive, the model being then compiled with --paged-kv-cache.
+class KVCacheAttentionLibBuilder : public ModelLibBuilder {
+public:
+  KVCacheAttentionLibBuilder(const std::string &modelName, const int B,
+      const int H, const int T, const int D, const int numSteps,
+      const int numBlocks = 0, const int blockSize = 16);
+  bool build() final;
+  // Prepare the inputs of the numSteps steps.
+  bool prepareInputs() final;
+  bool prepareInputs(float dataRangeLB, float dataRangeUB);
+  // Copy the inputs of the steps of another model.
+  bool prepareInputs(const KVCacheAttentionLibBuilder &other);
+  // Reset the caches to empty ones, and forget the outputs of the steps.
+  bool resetStates();
+  // Run a step, keeping its output. Its queries have a wrong shape when
+  // isCorrupted, which fails the step when the model verifies its inputs.
+  bool runStep(int step, bool isCorrupted = false);
+  // Verify the outputs of the steps, run in order since the reset, with a
+  // naive implementation.
+  bool verifyOutputs() final;
+  // Verify the outputs of the steps with the ones of another model.
+  bool verifyOutputs(const KVCacheAttentionLibBuilder &other);
+
+private:
+  // Data that defines model.
+  const int B, H, T, D, numSteps, numBlocks, blockSize;
+  // Queries, keys and values of each step, and output of each step run.
+  std::vector<std::vector<OMTensorUniquePtr>> stepInputs;
+  std::vector<OMTensorUniquePtr> stepOutputs;
+  std::unique_ptr<onnx_mlir::ExecutionState> state;
+};
+
 } // namespace test
 } // namespace onnx_mlir
@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-- NormalizationModel.cpp - Building Normalization Models for tests --===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains functions that build models consisting of an
+// onnx.Softmax or an onnx.LayerNormalization op along the innermost axis, and
+// compile them.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cmath>
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// =============================================================================
+// Softmax along the innermost axis
+
+SoftmaxLibBuilder::SoftmaxLibBuilder(
+    const std::string &modelName, const int N, const int C)
+    : ModelLibBuilder(modelName), N(N), C(C) {}
+
+bool SoftmaxLibBuilder::build() {
+  llvm::SmallVector<int64_t, 2> shape = {N, C};
+  auto type = RankedTensorType::get(shape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{type};
+  llvm::SmallVector<Type, 1> outputsType{type};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+
+  auto softmaxOp = builder.create<ONNXSoftmaxOp>(loc,
+      /*Y=*/type, /*X=*/xVal, /*axis=*/builder.getSI64IntegerAttr(-1));
+
+  llvm::SmallVector<Value, 1> results = {softmaxOp.getResult()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool SoftmaxLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool SoftmaxLibBuilder::prepareInputs() {
+  return SoftmaxLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool SoftmaxLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C});
+  if (!x || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    float max = omTensorGetElem<float>(x, {n, 0});
+    for (int64_t c = 1; c < C; ++c)
+      max = std::max(max, omTensorGetElem<float>(x, {n, c}));
+    float sum = 0.0;
+    for (int64_t c = 0; c < C; ++c) {
+      float val = std::exp(omTensorGetElem<float>(x, {n, c}) - max);
+      omTensorGetElem<float>(ref, {n, c}) = val;
+      sum += val;
+    }
+    for (int64_t c = 0; c < C; ++c)
+      omTensorGetElem<float>(ref, {n, c}) /= sum;
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+// =============================================================================
+// LayerNormalization along the innermost axis, with scale and bias
+
+LayerNormLibBuilder::LayerNormLibBuilder(
+    const std::string &modelName, const int N, const int C)
+    : ModelLibBuilder(modelName), N(N), C(C) {}
+
+bool LayerNormLibBuilder::build() {
+  llvm::SmallVector<int64_t, 2> xShape = {N, C};
+  llvm::SmallVector<int64_t, 1> scaleShape = {C};
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto scaleType = RankedTensorType::get(scaleShape, builder.getF32Type());
+  auto noneType = builder.getNoneType();
+
+  llvm::SmallVector<Type, 3> inputsType{xType, scaleType, scaleType};
+  llvm::SmallVector<Type, 1> outputsType{xType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+  auto scaleVal = entryBlock.getArgument(1);
+  auto biasVal = entryBlock.getArgument(2);
+
+  llvm::SmallVector<NamedAttribute, 2> attrs = {
+      builder.getNamedAttr("axis", builder.getSI64IntegerAttr(-1)),
+      builder.getNamedAttr("epsilon", builder.getF32FloatAttr(epsilon))};
+  auto layerNormOp = builder.create<ONNXLayerNormalizationOp>(loc,
+      /*Y, Mean, InvStdDev=*/TypeRange{xType, noneType, noneType},
+      /*X, Scale, B=*/ValueRange{xVal, scaleVal, biasVal}, attrs);
+
+  llvm::SmallVector<Value, 1> results = {layerNormOp.getY()};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool LayerNormLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 3;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB);
+  list[1] = omTensorCreateWithRandomData<float>({C}, dataRangeLB, dataRangeUB);
+  list[2] = omTensorCreateWithRandomData<float>({C}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0] && list[1] && list[2];
+}
+
+bool LayerNormLibBuilder::prepareInputs() {
+  return LayerNormLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool LayerNormLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *scale = omTensorListGetOmtByIndex(inputs, 1);
+  OMTensor *bias = omTensorListGetOmtByIndex(inputs, 2);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C});
+  if (!x || !scale || !bias || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    float mean = 0.0;
+    for (int64_t c = 0; c < C; ++c)
+      mean += omTensorGetElem<float>(x, {n, c});
+    mean /= C;
+    float variance = 0.0;
+    for (int64_t c = 0; c < C; ++c) {
+      float diff = omTensorGetElem<float>(x, {n, c}) - mean;
+      variance += diff * diff;
+    }
+    variance /= C;
+    float invStdDev = 1.0 / std::sqrt(variance + epsilon);
+    for (int64_t c = 0; c < C; ++c)
+      omTensorGetElem<float>(ref, {n, c}) =
+          (omTensorGetElem<float>(x, {n, c}) - mean) * invStdDev *
+              omTensorGetElem<float>(scale, {c}) +
+          omTensorGetElem<float>(bias, {c});
+  }
+  bool ok = areCloseFloat(res, ref, /*rtol=*/1e-4, /*atol=*/1e-4);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//================-- PoolModel.cpp - Building Pool Models for tests -=========//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains a function that builds a model consisting of an
+// onnx.MaxPoolSingleOut or an onnx.AveragePool op, and compiles it.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// =============================================================================
+// 2D MaxPool or AveragePool with square kernel and stride, without padding
+
+Pool2DLibBuilder::Pool2DLibBuilder(const std::string &modelName,
+    const bool isMax, const int N, const int C, const int H, const int W,
+    const int K, const int stride)
+    : ModelLibBuilder(modelName), isMax(isMax), N(N), C(C), H(H), W(W), K(K),
+      stride(stride), HOut((H - K) / stride + 1), WOut((W - K) / stride + 1) {
+}
+
+bool Pool2DLibBuilder::build() {
+  llvm::SmallVector<int64_t, 4> xShape = {N, C, H, W};
+  llvm::SmallVector<int64_t, 4> yShape = {N, C, HOut, WOut};
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{xType};
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+
+  llvm::SmallVector<NamedAttribute, 3> attrs = {
+      builder.getNamedAttr("auto_pad", builder.getStringAttr("VALID")),
+      builder.getNamedAttr("kernel_shape", builder.getI64ArrayAttr({K, K})),
+      builder.getNamedAttr(
+          "strides", builder.getI64ArrayAttr({stride, stride}))};
+  Value poolVal;
+  if (isMax)
+    poolVal = builder.create<ONNXMaxPoolSingleOutOp>(
+        loc, TypeRange{yType}, ValueRange{xVal}, attrs);
+  else
+    poolVal = builder.create<ONNXAveragePoolOp>(
+        loc, TypeRange{yType}, ValueRange{xVal}, attrs);
+
+  llvm::SmallVector<Value, 1> results = {poolVal};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool Pool2DLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] = omTensorCreateWithRandomData<float>(
+      {N, C, H, W}, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool Pool2DLibBuilder::prepareInputs() {
+  return Pool2DLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool Pool2DLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C, HOut, WOut});
+  if (!x || !res || !ref)
+    return false;
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      for (int64_t h = 0; h < HOut; ++h) {
+        for (int64_t w = 0; w < WOut; ++w) {
+          float val = isMax ? omTensorGetElem<float>(
+                                  x, {n, c, h * stride, w * stride})
+                            : 0.0;
+          for (int64_t kh = 0; kh < K; ++kh) {
+            for (int64_t kw = 0; kw < K; ++kw) {
+              float elem = omTensorGetElem<float>(
+                  x, {n, c, h * stride + kh, w * stride + kw});
+              val = isMax ? std::max(val, elem) : val + elem;
+            }
+          }
+          omTensorGetElem<float>(ref, {n, c, h, w}) =
+              isMax ? val : val / (K * K);
+        }
+      }
+    }
+  }
+  bool ok = areCloseFloat(res, ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//==============-- ReduceModel.cpp - Building Reduce Models for tests -=======//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains a function that builds a model consisting of an
+// onnx.ReduceSum or an onnx.ReduceMean op over one axis, and compiles it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/DialectBuilder.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// =============================================================================
+// ReduceSum or ReduceMean over one axis of a 3D tensor, keeping the dims
+
+ReduceLibBuilder::ReduceLibBuilder(const std::string &modelName,
+    const bool isMean, const int N, const int C, const int H, const int axis)
+    : ModelLibBuilder(modelName), isMean(isMean), N(N), C(C), H(H),
+      axis(axis), xShape({N, C, H}), yShape({N, C, H}) {
+  yShape[axis] = 1;
+}
+
+bool ReduceLibBuilder::build() {
+  auto xType = RankedTensorType::get(xShape, builder.getF32Type());
+  auto yType = RankedTensorType::get(yShape, builder.getF32Type());
+
+  llvm::SmallVector<Type, 1> inputsType{xType};
+  llvm::SmallVector<Type, 1> outputsType{yType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  Block &entryBlock = funcOp.getBody().front();
+  auto xVal = entryBlock.getArgument(0);
+
+  MultiDialectBuilder<OnnxBuilder> create(builder, loc);
+  Value axesVal = create.onnx.constantInt64({axis});
+  IntegerAttr keepDimsAttr = builder.getSI64IntegerAttr(1);
+  IntegerAttr noopAttr = builder.getSI64IntegerAttr(0);
+  Value reduceVal;
+  if (isMean)
+    reduceVal = builder.create<ONNXReduceMeanOp>(
+        loc, yType, xVal, axesVal, keepDimsAttr, noopAttr);
+  else
+    reduceVal = builder.create<ONNXReduceSumOp>(
+        loc, yType, xVal, axesVal, keepDimsAttr, noopAttr);
+
+  llvm::SmallVector<Value, 1> results = {reduceVal};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool ReduceLibBuilder::prepareInputs(float dataRangeLB, float dataRangeUB) {
+  constexpr int num = 1;
+  OMTensor **list = (OMTensor **)malloc(num * sizeof(OMTensor *));
+  if (!list)
+    return false;
+  list[0] =
+      omTensorCreateWithRandomData<float>(xShape, dataRangeLB, dataRangeUB);
+  inputs = omTensorListCreateWithOwnership(list, num, true);
+  return inputs && list[0];
+}
+
+bool ReduceLibBuilder::prepareInputs() {
+  return ReduceLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool ReduceLibBuilder::verifyOutputs() {
+  // Get inputs and outputs.
+  if (!inputs || !outputs)
+    return false;
+  OMTensor *x = omTensorListGetOmtByIndex(inputs, 0);
+  OMTensor *res = omTensorListGetOmtByIndex(outputs, 0);
+  OMTensor *ref = omTensorCreateWithShape<float>(yShape);
+  if (!x || !res || !ref)
+    return false;
+  for (std::vector<int64_t> &yIndex : omTensorComputeIndexSet(ref)) {
+    std::vector<int64_t> xIndex = yIndex;
+    float sum = 0.0;
+    for (xIndex[axis] = 0; xIndex[axis] < xShape[axis]; ++xIndex[axis])
+      sum += omTensorGetElem<float>(x, xIndex);
+    omTensorGetElem<float>(ref, yIndex) = isMean ? sum / xShape[axis] : sum;
+  }
+  bool ok = areCloseFloat(res, ref, /*rtol=*/1e-4, /*atol=*/1e-4);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -0,0 +1,383 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ StateModel.cpp - Building Models Run Step by Step for tests ---===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains functions that build models whose states are kept
+// between steps by an ExecutionState, e.g. an accumulator or a key/value
+// cache attended to by onnx.FusedAttention, and run them step by step to
+// check their results.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerUtils.hpp"
+#include "src/Dialect/ONNX/ONNXOps.hpp"
+#include "src/Runtime/OMTensorHelper.hpp"
+#include "test/modellib/ModelLib.hpp"
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Tensor referring to the data of another one, without owning it.
+static OMTensorUniquePtr createView(const OMTensor *omt) {
+  return OMTensorUniquePtr(
+      omTensorCreate(omTensorGetDataPtr(omt), omTensorGetShape(omt),
+          omTensorGetRank(omt), omTensorGetDataType(omt)),
+      omTensorDestroy);
+}
+
+// =============================================================================
+// Accumulation into a state
+
+StateAccumulatorLibBuilder::StateAccumulatorLibBuilder(
+    const std::string &modelName, const int N, const int C, const int numSteps)
+    : ModelLibBuilder(modelName), N(N), C(C), numSteps(numSteps) {}
+
+bool StateAccumulatorLibBuilder::build() {
+  auto type = RankedTensorType::get({N, C}, builder.getF32Type());
+
+  llvm::SmallVector<Type, 2> inputsType{type, type};
+  llvm::SmallVector<Type, 3> outputsType{type, type, type};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  // The state is bound by its names.
+  funcOp->setAttr("input_names", builder.getStrArrayAttr({"x", "state"}));
+  funcOp->setAttr("output_names",
+      builder.getStrArrayAttr({"next_state", "past_state", "input"}));
+  Block &entryBlock = funcOp.getBody().front();
+  Value xVal = entryBlock.getArgument(0);
+  Value stateVal = entryBlock.getArgument(1);
+
+  Value nextStateVal = builder.create<ONNXAddOp>(loc, type, stateVal, xVal);
+
+  llvm::SmallVector<Value, 3> results = {nextStateVal, stateVal, xVal};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool StateAccumulatorLibBuilder::prepareInputs(
+    float dataRangeLB, float dataRangeUB) {
+  stepInputs.clear();
+  for (int s = 0; s < numSteps; ++s) {
+    stepInputs.emplace_back(
+        omTensorCreateWithRandomData<float>({N, C}, dataRangeLB, dataRangeUB),
+        omTensorDestroy);
+    if (!stepInputs.back())
+      return false;
+  }
+  return true;
+}
+
+bool StateAccumulatorLibBuilder::prepareInputs() {
+  return StateAccumulatorLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool StateAccumulatorLibBuilder::resetStates() {
+  assert(exec && "expected successful compile and load");
+  try {
+    if (!state)
+      state = std::make_unique<ExecutionState>(
+          exec->getEntryPoint("run_main_graph"),
+          std::vector<StateBinding>{{"state", "next_state"}});
+    std::vector<OMTensorUniquePtr> states;
+    states.emplace_back(
+        omTensorCreateWithShape<float>({N, C}), omTensorDestroy);
+    if (!states.back())
+      return false;
+    memset(omTensorGetDataPtr(states.back().get()), 0,
+        omTensorGetBufferSize(states.back().get()));
+    state->reset(std::move(states));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while resetting: " << error.what() << std::endl;
+    return false;
+  }
+  stepOutputs.clear();
+  stepOutputs.resize(numSteps);
+  return true;
+}
+
+bool StateAccumulatorLibBuilder::runStep(int step, bool isCorrupted) {
+  assert(state && step < numSteps && "expected states reset");
+  // The input owns a copy of its data, whose ownership goes to the output
+  // passing it through.
+  const OMTensor *x = stepInputs[step].get();
+  std::vector<OMTensorUniquePtr> ins;
+  ins.emplace_back(omTensorCreateWithShape<float>({N, isCorrupted ? C + 1 : C}),
+      omTensorDestroy);
+  if (!ins.back())
+    return false;
+  if (!isCorrupted)
+    memcpy(omTensorGetDataPtr(ins.back().get()), omTensorGetDataPtr(x),
+        omTensorGetBufferSize(x));
+  try {
+    stepOutputs[step] = state->run(std::move(ins));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool StateAccumulatorLibBuilder::verifyOutputs() {
+  OMTensor *ref = omTensorCreateWithShape<float>({N, C});
+  if (!ref)
+    return false;
+  memset(omTensorGetDataPtr(ref), 0, omTensorGetBufferSize(ref));
+  bool ok = true;
+  for (int s = 0; s < numSteps && ok && !stepOutputs[s].empty(); ++s) {
+    // The outputs passing the past state and the input through own their
+    // data, and outlive the state and the input.
+    ok = stepOutputs[s].size() == 2;
+    for (const OMTensorUniquePtr &out : stepOutputs[s])
+      ok = ok && omTensorGetOwning(out.get());
+    ok = ok && areCloseFloat(stepOutputs[s][0].get(), ref) &&
+         areCloseFloat(stepOutputs[s][1].get(), stepInputs[s].get());
+    for (int64_t n = 0; n < N; ++n)
+      for (int64_t c = 0; c < C; ++c)
+        omTensorGetElem<float>(ref, {n, c}) +=
+            omTensorGetElem<float>(stepInputs[s].get(), {n, c});
+  }
+  // The state is the accumulation of the inputs of the steps.
+  ok = ok && areCloseFloat(state->getState(0), ref);
+  omTensorDestroy(ref);
+  return ok;
+}
+
+// =============================================================================
+// Attention over a key/value cache
+
+KVCacheAttentionLibBuilder::KVCacheAttentionLibBuilder(
+    const std::string &modelName, const int B, const int H, const int T,
+    const int D, const int numSteps, const int numBlocks, const int blockSize)
+    : ModelLibBuilder(modelName), B(B), H(H), T(T), D(D), numSteps(numSteps),
+      numBlocks(numBlocks), blockSize(blockSize) {}
+
+bool KVCacheAttentionLibBuilder::build() {
+  Type f32Type = builder.getF32Type();
+  auto tokensType = RankedTensorType::get({B, H, T, D}, f32Type);
+  auto cacheType =
+      RankedTensorType::get({B, H, ShapedType::kDynamic, D}, f32Type);
+  auto keysType =
+      RankedTensorType::get({B, H, D, ShapedType::kDynamic}, f32Type);
+
+  llvm::SmallVector<Type, 5> inputsType{
+      tokensType, cacheType, cacheType, tokensType, tokensType};
+  llvm::SmallVector<Type, 3> outputsType{tokensType, cacheType, cacheType};
+
+  func::FuncOp funcOp = createEmptyTestFunction(inputsType, outputsType);
+  // The states are bound to the caches by their names.
+  funcOp->setAttr("input_names",
+      builder.getStrArrayAttr({"q", "past_k", "past_v", "k", "v"}));
+  funcOp->setAttr("output_names",
+      builder.getStrArrayAttr({"y", "present_k", "present_v"}));
+  Block &entryBlock = funcOp.getBody().front();
+  Value qVal = entryBlock.getArgument(0);
+  Value pastKVal = entryBlock.getArgument(1);
+  Value pastVVal = entryBlock.getArgument(2);
+  Value kVal = entryBlock.getArgument(3);
+  Value vVal = entryBlock.getArgument(4);
+
+  IntegerAttr axisAttr = builder.getSI64IntegerAttr(2);
+  Value presentKVal = builder.create<ONNXConcatOp>(
+      loc, cacheType, ValueRange{pastKVal, kVal}, axisAttr);
+  Value presentVVal = builder.create<ONNXConcatOp>(
+      loc, cacheType, ValueRange{pastVVal, vVal}, axisAttr);
+  Value keysVal = builder.create<ONNXTransposeOp>(
+      loc, keysType, presentKVal, builder.getI64ArrayAttr({0, 1, 3, 2}));
+  Value noneVal = builder.create<ONNXNoneOp>(loc);
+  Value yVal = builder.create<ONNXFusedAttentionOp>(loc, tokensType, qVal,
+      keysVal, presentVVal, noneVal, noneVal, noneVal, noneVal,
+      builder.getF32FloatAttr(1.0 / std::sqrt(D)));
+
+  llvm::SmallVector<Value, 3> results = {yVal, presentKVal, presentVVal};
+  builder.create<func::ReturnOp>(loc, results);
+  module.push_back(funcOp);
+
+  createEntryPoint(funcOp);
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::prepareInputs(
+    float dataRangeLB, float dataRangeUB) {
+  stepInputs.clear();
+  for (int s = 0; s < numSteps; ++s) {
+    std::vector<OMTensorUniquePtr> ins;
+    for (int i = 0; i < 3; ++i) {
+      ins.emplace_back(omTensorCreateWithRandomData<float>(
+                           {B, H, T, D}, dataRangeLB, dataRangeUB),
+          omTensorDestroy);
+      if (!ins.back())
+        return false;
+    }
+    stepInputs.emplace_back(std::move(ins));
+  }
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::prepareInputs() {
+  return KVCacheAttentionLibBuilder::prepareInputs(
+      -omDefaultRangeBound, omDefaultRangeBound);
+}
+
+bool KVCacheAttentionLibBuilder::prepareInputs(
+    const KVCacheAttentionLibBuilder &other) {
+  assert(other.numSteps >= numSteps && "expected the inputs of all steps");
+  stepInputs.clear();
+  for (int s = 0; s < numSteps; ++s) {
+    std::vector<OMTensorUniquePtr> ins;
+    for (const OMTensorUniquePtr &otherIn : other.stepInputs[s]) {
+      ins.emplace_back(omTensorCreateWithShape<float>({B, H, T, D}),
+          omTensorDestroy);
+      if (!ins.back())
+        return false;
+      memcpy(omTensorGetDataPtr(ins.back().get()),
+          omTensorGetDataPtr(otherIn.get()),
+          omTensorGetBufferSize(otherIn.get()));
+    }
+    stepInputs.emplace_back(std::move(ins));
+  }
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::resetStates() {
+  assert(exec && "expected successful compile and load");
+  try {
+    if (!state) {
+      ExecutionEntryPoint entryPoint = exec->getEntryPoint("run_main_graph");
+      std::vector<StateBinding> bindings = {
+          {"past_k", "present_k"}, {"past_v", "present_v"}};
+      if (numBlocks > 0)
+        state = std::make_unique<ExecutionState>(entryPoint, bindings,
+            PagedKVCacheOptions{numBlocks, blockSize, B});
+      else
+        state = std::make_unique<ExecutionState>(entryPoint, bindings);
+    }
+    // The paged caches are pools of blocks, the others have no tokens and
+    // refer to no data.
+    static float noData;
+    std::vector<OMTensorUniquePtr> states;
+    int64_t emptyShape[] = {B, H, 0, D};
+    for (int i = 0; i < 2; ++i) {
+      if (numBlocks > 0)
+        states.emplace_back(
+            omTensorCreateWithShape<float>({numBlocks, H, blockSize, D}),
+            omTensorDestroy);
+      else
+        states.emplace_back(
+            omTensorCreate(&noData, emptyShape, 4, ONNX_TYPE_FLOAT),
+            omTensorDestroy);
+      if (!states.back())
+        return false;
+    }
+    state->reset(std::move(states));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while resetting: " << error.what() << std::endl;
+    return false;
+  }
+  stepOutputs.clear();
+  stepOutputs.resize(numSteps);
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::runStep(int step, bool isCorrupted) {
+  assert(state && step < numSteps && "expected states reset");
+  std::vector<OMTensorUniquePtr> ins;
+  for (const OMTensorUniquePtr &in : stepInputs[step])
+    ins.emplace_back(createView(in.get()));
+  if (isCorrupted)
+    ins[0].reset(omTensorCreateWithShape<float>({B, H, T + 1, D}));
+  std::vector<OMTensorUniquePtr> outs;
+  try {
+    outs = numBlocks > 0 ? state->run(std::move(ins), T)
+                         : state->run(std::move(ins));
+  } catch (const std::runtime_error &error) {
+    std::cerr << "error while running: " << error.what() << std::endl;
+    return false;
+  }
+  stepOutputs[step] = std::move(outs[0]);
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::verifyOutputs() {
+  float scale = 1.0 / std::sqrt(D);
+  for (int s = 0; s < numSteps; ++s) {
+    const OMTensor *res = stepOutputs[s].get();
+    if (!res)
+      continue;
+    // The queries of the step attend to the keys of all the steps so far.
+    int64_t numKeys = (s + 1) * T;
+    const OMTensor *q = stepInputs[s][0].get();
+    OMTensor *ref = omTensorCreateWithShape<float>({B, H, T, D});
+    if (!ref)
+      return false;
+    std::vector<float> scores(numKeys);
+    for (int64_t b = 0; b < B; ++b)
+      for (int64_t h = 0; h < H; ++h)
+        for (int64_t t = 0; t < T; ++t) {
+          float maxScore = -std::numeric_limits<float>::infinity();
+          for (int64_t j = 0; j < numKeys; ++j) {
+            const OMTensor *k = stepInputs[j / T][1].get();
+            float score = 0;
+            for (int64_t d = 0; d < D; ++d)
+              score += omTensorGetElem<float>(q, {b, h, t, d}) *
+                       omTensorGetElem<float>(k, {b, h, j % T, d});
+            scores[j] = scale * score;
+            maxScore = std::max(maxScore, scores[j]);
+          }
+          float sum = 0;
+          for (int64_t j = 0; j < numKeys; ++j) {
+            scores[j] = std::exp(scores[j] - maxScore);
+            sum += scores[j];
+          }
+          for (int64_t d = 0; d < D; ++d) {
+            float val = 0;
+            for (int64_t j = 0; j < numKeys; ++j) {
+              const OMTensor *v = stepInputs[j / T][2].get();
+              val += scores[j] * omTensorGetElem<float>(v, {b, h, j % T, d});
+            }
+            omTensorGetElem<float>(ref, {b, h, t, d}) = val / sum;
+          }
+        }
+    bool ok = areCloseFloat(res, ref);
+    omTensorDestroy(ref);
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+bool KVCacheAttentionLibBuilder::verifyOutputs(
+    const KVCacheAttentionLibBuilder &other) {
+  for (int s = 0; s < numSteps; ++s) {
+    if (!stepOutputs[s])
+      continue;
+    if (s >= other.numSteps ||
+        !areCloseFloat(stepOutputs[s].get(), other.stepOutputs[s].get()))
+      return false;
+  }
+  return true;
+}
+
+} // namespace test
+} // namespace onnx_mlir
@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- TestConcurrentRun.cpp - test concurrent inferences -------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test inferences running concurrently from
+// several threads on a single loaded model library.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE("./TestConcurrentRun_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether Gemm run concurrently from numThreads threads, sharing one
+// entry point handle, computes the results of a naive implementation of Gemm.
+static bool isOMGemmConcurrentRunCorrectFor(
+    const int I, const int J, const int K, const int numThreads) {
+  static int testNum = 0;
+  printf("attempt %d with i %d, j %d, k %d, threads %d\n", ++testNum, I, J, K,
+      numThreads);
+
+  GemmLibBuilder gemm(SHARED_LIB_BASE.str(), I, J, K, /*aTrans=*/0,
+      /*bTrans=*/0, /*cRank=*/1, /*alphaVal=*/1.0, /*betaVal=*/1.0);
+  return gemm.build() && gemm.compileAndLoad() &&
+         gemm.prepareInputsFromEnv("TEST_DATARANGE") &&
+         gemm.runConcurrently(numThreads) && gemm.verifyOutputs();
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover remover(
+      onnx_mlir::getTargetFilename(SHARED_LIB_BASE.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestConcurrentRun\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Concurrent run correctness", [&]() {
+      const int maxRange = 50;
+      const int I = *rc::gen::inRange(1, maxRange);
+      const int J = *rc::gen::inRange(1, maxRange);
+      const int K = *rc::gen::inRange(1, maxRange);
+      const int numThreads = *rc::gen::inRange(2, 9);
+      RC_ASSERT(isOMGemmConcurrentRunCorrectFor(I, J, K, numThreads));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
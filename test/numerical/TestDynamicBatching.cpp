@@ -0,0 +1,75 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===---- TestDynamicBatching.cpp - test batching of single requests ------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test the ExecutionBatcher, which batches
+// single row requests to a model with a dynamic batch dimension.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE(
+    "./TestDynamicBatching_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether N single row requests to LeakyRelu, run in batches of at most
+// maxBatchSize rows, compute the results of a naive implementation.
+static bool isOMLeakyReluBatchedTheSameAsNaiveImplFor(
+    const int N, const int maxBatchSize, const float alphaVal) {
+  static int testNum = 0;
+  printf("attempt %d with N %d, max batch size %d, alpha %7.3f\n", ++testNum,
+      N, maxBatchSize, (double)alphaVal);
+
+  LeakyReluLibBuilder leakyRelu(
+      SHARED_LIB_BASE.str(), N, alphaVal, /*isDynamic=*/true);
+  return leakyRelu.build() && leakyRelu.compileAndLoad() &&
+         leakyRelu.prepareInputsFromEnv("TEST_DATARANGE") &&
+         leakyRelu.runBatched(maxBatchSize) && leakyRelu.verifyOutputs();
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover remover(
+      onnx_mlir::getTargetFilename(SHARED_LIB_BASE.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestDynamicBatching\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Dynamic batching correctness", [&]() {
+      const int maxRange = 50;
+      const int N = *rc::gen::inRange(1, maxRange);
+      const int maxBatchSize = *rc::gen::inRange(1, 17);
+      float alpha = *rc::gen::inRange(-10, 10) / 10.0;
+      RC_ASSERT(
+          isOMLeakyReluBatchedTheSameAsNaiveImplFor(N, maxBatchSize, alpha));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ TestExecutionState.cpp - test models run step by step ---------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test the ExecutionState, which runs a model
+// step by step, keeping its states between the steps.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include <cerrno>
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE(
+    "./TestExecutionState_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether the accumulation of the NxC inputs of numSteps steps into a
+// state computes the results of a naive implementation, the outputs of each
+// step passing the past state and the input through, and whether the step
+// corruptedStep first fails and leaves the state unchanged.
+static bool isOMStateAccumulatorTheSameAsNaiveImplFor(
+    const int N, const int C, const int numSteps, const int corruptedStep) {
+  static int testNum = 0;
+  printf("attempt %d with N %d, C %d, num steps %d, corrupted step %d\n",
+      ++testNum, N, C, numSteps, corruptedStep);
+
+  StateAccumulatorLibBuilder accumulator(
+      SHARED_LIB_BASE.str(), N, C, numSteps);
+  if (!accumulator.build() || !accumulator.compileAndLoad() ||
+      !accumulator.prepareInputs() || !accumulator.resetStates())
+    return false;
+  for (int s = 0; s < numSteps; ++s) {
+    if (s == corruptedStep &&
+        (accumulator.runStep(s, /*isCorrupted=*/true) || errno != EINVAL))
+      return false;
+    if (!accumulator.runStep(s))
+      return false;
+  }
+  return accumulator.verifyOutputs();
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover remover(
+      onnx_mlir::getTargetFilename(SHARED_LIB_BASE.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  // The corrupted steps fail when the inputs are verified.
+  verifyInputTensors = true;
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestExecutionState\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Execution state correctness", [&]() {
+      const int N = *rc::gen::inRange(1, 20);
+      const int C = *rc::gen::inRange(1, 20);
+      const int numSteps = *rc::gen::inRange(1, 8);
+      const int corruptedStep = *rc::gen::inRange(0, numSteps);
+      RC_ASSERT(isOMStateAccumulatorTheSameAsNaiveImplFor(
+          N, C, numSteps, corruptedStep));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
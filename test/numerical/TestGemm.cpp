@@ -54,19 +54,21 @@ void omPrintAsPython(OMTensor *tensor, std::string name) {
 
 // Returns whether onnx-mlir compiled Gemm is producing the same results
 // as a naive implementation of Gemm for a specific set of Gemm
-// parameters/configuration. Gemm: A[IxK] * B[KxJ] = C[IxJ]
+// parameters/configuration. Gemm: A[IxK] * B[KxJ] = C[IxJ]. B is a constant
+// of the model, packed at compile time, when isConstantB is set.
 static bool isOMGemmTheSameAsNaiveImplFor(const int I, const int J, const int K,
     const int aTrans, const int bTrans, const int cRank, const double alphaVal,
-    const double betaVal) {
+    const double betaVal, const bool isConstantB = false) {
 
   static int testNum = 0;
-  printf("attempt %d with i %d, j %d, k %d%s%s, cRank %d, alpha %7.3f, beta "
-         "%7.3f\n",
+  printf("attempt %d with i %d, j %d, k %d%s%s%s, cRank %d, alpha %7.3f, "
+         "beta %7.3f\n",
       ++testNum, I, J, K, (aTrans ? ", aTrans" : ""),
-      (bTrans ? ", bTrans" : ""), cRank, alphaVal, betaVal);
+      (bTrans ? ", bTrans" : ""), (isConstantB ? ", constant B" : ""), cRank,
+      alphaVal, betaVal);
 
-  GemmLibBuilder gemm(
-      SHARED_LIB_BASE.str(), I, J, K, aTrans, bTrans, cRank, alphaVal, betaVal);
+  GemmLibBuilder gemm(SHARED_LIB_BASE.str(), I, J, K, aTrans, bTrans, cRank,
+      alphaVal, betaVal, isConstantB);
   return gemm.build() && gemm.compileAndLoad() &&
          gemm.checkInstructionFromEnv("TEST_INSTRUCTION") &&
          gemm.prepareInputsFromEnv("TEST_DATARANGE") && gemm.run() &&
@@ -123,6 +125,24 @@ int main(int argc, char *argv[]) {
       return 1;
   }
 
+  if (true) {
+    printf("RapidCheck test case generation with a constant B.\n");
+    bool success = rc::check("Gemm with constant B correctness", [&]() {
+      // The last panel and tile of the packed B are partial, as J and K are
+      // odd while the cache tile sizes are powers of two.
+      const int I = *rc::gen::inRange(1, 20);
+      const int J = 2 * *rc::gen::inRange(16, 128) + 1;
+      const int K = 2 * *rc::gen::inRange(64, 256) + 1;
+      const int aTrans = *rc::gen::inRange(0, 2);
+      const int bTrans = *rc::gen::inRange(0, 2);
+      const int cRank = *rc::gen::inRange(1, 3);
+      RC_ASSERT(isOMGemmTheSameAsNaiveImplFor(I, J, K, aTrans, bTrans, cRank,
+          1.0, 1.0, /*isConstantB=*/true));
+    });
+    if (!success)
+      return 1;
+  }
+
   if (false) {
     // Was too slow on some machines, disable test.
     printf("\n\nIndividual test case generation (benchmarks).\n");
@@ -0,0 +1,130 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ TestPagedKVCache.cpp - test paged key/value cache decoding ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test the decoding of a model compiled with
+// --paged-kv-cache through an ExecutionState, against the same model
+// concatenating its key/value caches.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include <cerrno>
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE_CONCAT(
+    "./TestPagedKVCache_concat_main_graph");
+static const llvm::StringRef SHARED_LIB_BASE_PAGED(
+    "./TestPagedKVCache_paged_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether the attention of B sequences of H heads of size D, decoding
+// numSteps steps of T tokens on paged caches of blocks of blockSize tokens,
+// computes the results of the attention on concatenated caches. The step
+// corruptedStep first fails and frees its blocks. The caches have extraBlocks
+// blocks more than the steps need, less than one per sequence, so that the
+// next step runs out of blocks unless its tokens fit in the last blocks. The
+// steps are decoded again after a reset, which frees all the blocks.
+static bool isOMPagedKVCacheTheSameAsConcatKVCacheFor(const int B,
+    const int H, const int T, const int D, const int numSteps,
+    const int blockSize, const int extraBlocks, const int corruptedStep) {
+  static int testNum = 0;
+  printf("attempt %d with B %d, H %d, T %d, D %d, num steps %d, block size "
+         "%d, extra blocks %d, corrupted step %d\n",
+      ++testNum, B, H, T, D, numSteps, blockSize, extraBlocks, corruptedStep);
+
+  int numSequenceBlocks = (numSteps * T + blockSize - 1) / blockSize;
+  int numBlocks = B * numSequenceBlocks + extraBlocks;
+  bool isLastStepFitting = (numSteps + 1) * T <= numSequenceBlocks * blockSize;
+
+  // The reference runs all the steps.
+  pagedKVCache = false;
+  KVCacheAttentionLibBuilder concat(
+      SHARED_LIB_BASE_CONCAT.str(), B, H, T, D, numSteps + 1);
+  if (!concat.build() || !concat.compileAndLoad() || !concat.prepareInputs() ||
+      !concat.resetStates())
+    return false;
+  for (int s = 0; s <= numSteps; ++s)
+    if (!concat.runStep(s))
+      return false;
+  if (!concat.verifyOutputs())
+    return false;
+
+  pagedKVCache = true;
+  KVCacheAttentionLibBuilder paged(SHARED_LIB_BASE_PAGED.str(), B, H, T, D,
+      numSteps + 1, numBlocks, blockSize);
+  if (!paged.build() || !paged.compileAndLoad() ||
+      !paged.prepareInputs(concat) || !paged.resetStates())
+    return false;
+  for (int run = 0; run < 2; ++run) {
+    // A failed step frees its blocks and keeps the past length.
+    for (int s = 0; s < numSteps; ++s) {
+      if (run == 0 && s == corruptedStep &&
+          (paged.runStep(s, /*isCorrupted=*/true) || errno != EINVAL))
+        return false;
+      if (!paged.runStep(s))
+        return false;
+    }
+    bool isLastStepRun = paged.runStep(numSteps);
+    if (isLastStepRun != isLastStepFitting ||
+        (!isLastStepRun && errno != ENOMEM))
+      return false;
+    if (!paged.verifyOutputs(concat) || !paged.resetStates())
+      return false;
+  }
+  return true;
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover concatRemover(onnx_mlir::getTargetFilename(
+      SHARED_LIB_BASE_CONCAT.str(), onnx_mlir::EmitLib));
+  llvm::FileRemover pagedRemover(onnx_mlir::getTargetFilename(
+      SHARED_LIB_BASE_PAGED.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  // The corrupted steps fail when the inputs are verified.
+  verifyInputTensors = true;
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestPagedKVCache\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Paged key/value cache correctness", [&]() {
+      const int B = *rc::gen::inRange(1, 4);
+      const int H = *rc::gen::inRange(1, 4);
+      const int T = *rc::gen::inRange(1, 5);
+      const int D = *rc::gen::inRange(1, 17);
+      const int numSteps = *rc::gen::inRange(1, 6);
+      const int blockSize = *rc::gen::inRange(1, 9);
+      const int extraBlocks = *rc::gen::inRange(0, B);
+      const int corruptedStep = *rc::gen::inRange(0, numSteps);
+      RC_ASSERT(isOMPagedKVCacheTheSameAsConcatKVCacheFor(
+          B, H, T, D, numSteps, blockSize, extraBlocks, corruptedStep));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--- TestPipelineStages.cpp - test pipelines of split model stages ----===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test the ExecutionPipeline, which runs the
+// stages of a model compiled with --pipeline-stages on micro-batches.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE(
+    "./TestPipelineStages_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether a chain of numOps elementwise ops over NxC tensors, split
+// into pipeline stages and run on numMicroBatches micro-batches, computes the
+// results of a naive implementation.
+static bool isOMElementwiseChainPipelinedTheSameAsNaiveImplFor(
+    const int N, const int C, const int numOps, const int numMicroBatches) {
+  static int testNum = 0;
+  printf("attempt %d with N %d, C %d, num ops %d, num micro-batches %d\n",
+      ++testNum, N, C, numOps, numMicroBatches);
+
+  ElementwiseChainLibBuilder chain(
+      SHARED_LIB_BASE.str(), N, C, numOps, /*isDynamic=*/true);
+  return chain.build() && chain.compileAndLoad() &&
+         chain.prepareInputs() &&
+         chain.runPipelined(numMicroBatches) && chain.verifyOutputs();
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover remover(
+      onnx_mlir::getTargetFilename(SHARED_LIB_BASE.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  // The model is split into stages, and then loaded without its default
+  // entry point run_main_graph.
+  pipelineStages = 3;
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestPipelineStages\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Pipeline stages correctness", [&]() {
+      const int N = *rc::gen::inRange(1, 20);
+      const int C = *rc::gen::inRange(1, 20);
+      const int numOps = *rc::gen::inRange(3, 10);
+      const int numMicroBatches = *rc::gen::inRange(1, N + 1);
+      RC_ASSERT(isOMElementwiseChainPipelinedTheSameAsNaiveImplFor(
+          N, C, numOps, numMicroBatches));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------ TestSplitBatch.cpp - test batches split across threads --------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains the code to test ExecutionSession::runSplitBatch, which
+// splits the batch of a request to a model into slices run concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+// Common.hpp needs to be included first to correctly surpress the rapidcheck.h
+// warnings.
+#include "Common.hpp"
+
+#include <cerrno>
+
+#include "src/Runtime/OMTensorHelper.hpp"
+
+static const llvm::StringRef SHARED_LIB_BASE("./TestSplitBatch_main_graph");
+
+using namespace mlir;
+
+namespace onnx_mlir {
+namespace test {
+
+// Returns whether LeakyRelu, run on N rows split into numSlices slices,
+// computes the results of a naive implementation when its batch is dynamic
+// or run as a single slice, and is rejected when its static batch is split.
+static bool isOMLeakyReluSplitBatchTheSameAsNaiveImplFor(const int N,
+    const int numSlices, const float alphaVal, const bool isDynamic) {
+  static int testNum = 0;
+  printf("attempt %d with N %d, num slices %d, alpha %7.3f, %s batch\n",
+      ++testNum, N, numSlices, (double)alphaVal,
+      isDynamic ? "dynamic" : "static");
+
+  LeakyReluLibBuilder leakyRelu(
+      SHARED_LIB_BASE.str(), N, alphaVal, isDynamic);
+  if (!leakyRelu.build() || !leakyRelu.compileAndLoad() ||
+      !leakyRelu.prepareInputsFromEnv("TEST_DATARANGE"))
+    return false;
+  // The slices are at most one per row.
+  if (!isDynamic && std::min(numSlices, N) > 1)
+    return !leakyRelu.runSplitBatch(numSlices) && errno == EINVAL;
+  return leakyRelu.runSplitBatch(numSlices) && leakyRelu.verifyOutputs();
+}
+
+} // namespace test
+} // namespace onnx_mlir
+
+int main(int argc, char *argv[]) {
+  using namespace onnx_mlir;
+  using namespace onnx_mlir::test;
+
+  llvm::FileRemover remover(
+      onnx_mlir::getTargetFilename(SHARED_LIB_BASE.str(), onnx_mlir::EmitLib));
+
+  ModelLibBuilder::setRandomNumberGeneratorSeed("TEST_SEED");
+  setCompilerOption(OptionKind::CompilerOptLevel, "3");
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "TestSplitBatch\n", nullptr, "TEST_ARGS");
+  std::string target = getCompilerOption(OptionKind::TargetAccel);
+  std::cout << "Target options: \"" << target << "\"\n";
+  if (true) {
+    printf("RapidCheck test case generation.\n");
+    bool success = rc::check("Split batch correctness", [&]() {
+      const int maxRange = 50;
+      const int N = *rc::gen::inRange(1, maxRange);
+      const int numSlices = *rc::gen::inRange(1, 9);
+      float alpha = *rc::gen::inRange(-10, 10) / 10.0;
+      const bool isDynamic = *rc::gen::arbitrary<bool>();
+      RC_ASSERT(isOMLeakyReluSplitBatchTheSameAsNaiveImplFor(
+          N, numSlices, alpha, isDynamic));
+    });
+    if (!success)
+      return 1;
+  }
+  return 0;
+}
@@ -21,13 +21,32 @@
 #
 # --max-relative-slowdown <pct>: When using --readrun or --compare, indicate on each line whether
 # the relative change exceeds the specified percent increase, and exit(1) if more than one benchmark 
-# does so. (Exit(0) if one or fewer do so).
+# does so. (Exit(0) if one or fewer do so). When using --check-baseline, set the relative threshold
+# (default 5%).
+#
+#
+# Regression tracking against a baseline uses the following options, with --run or --runall:
+#
+# --repetitions <n>: Run each benchmark n times (default 5), and summarize its times by their median
+# and their median absolute deviation (MAD).
+#
+# --save-baseline <filename>: Store the medians and MADs of real_time in the JSON file, keyed by the
+# compiler options found in the PERF_ARGS env var and then by "PerfOp/benchmark/shape". Entries of
+# other benchmarks or options already in the file are kept.
+#
+# --check-baseline <filename>: Compare the medians to the ones stored for the same compiler options
+# and benchmarks, and exit(1) if any benchmark slowed down significantly, namely when its median grew
+# by more than the max relative slowdown and by more than --noise-mads times the larger of the two
+# MADs.
+#
+# --noise-mads <k>: Number of MADs a slowdown must exceed to be significant (default 3).
 #
 #
 ########################################################################################################
 
 
 
+import json
 import os
 import subprocess
 import sys
@@ -43,6 +62,8 @@ Readrun               = False
 Compare               = False
 PrintOutputs          = False
 LimitSlowdown         = False
+SaveBaseline          = False
+CheckBaseline         = False
 
 # Activated in the event that more than one compared metric exceeds specified max slowdown
 SlowdownLimitExceeded = False
@@ -53,10 +74,26 @@ RuntimeEpoch = int(time.time())
 # This shall contain additional options added to arguments
 ArgOptions = []
 
+# Options of the baseline regression tracking, set by their arguments
+MaxRelativeSlowdown = 5.0
+Repetitions         = 5
+NoiseMADs           = 3.0
+BaselineFilename    = None
+
+# Metric stored in baselines
+BaselineMetric = "real_time"
+
 # Add compatible ops here; used when script is run with '--runall'
 OpsWithPerformanceBenchmarks = [
     'Gemm',
-    'Conv'
+    'Conv',
+    'Elementwise',
+    'Normalization',
+    'Reduce',
+    'Pool',
+    'DataMovement',
+    'Scaling',
+    'Compile'
 ]
 
 # List of argument flags to allow
@@ -66,7 +103,11 @@ ValidArgs = [
     'run',
     'runall',
     'readrun',
-    'compare'
+    'compare',
+    'repetitions',
+    'save-baseline',
+    'check-baseline',
+    'noise-mads'
 ]
 
 ########################################################################################################
@@ -98,6 +139,8 @@ def print_usage(error_message):
         "--compare <filename> <filename> <metric>\n\n"
         "Options:\n"
         "--verbose\n--max-relative-slowdown <percent value>\n"
+        "--repetitions <n>\n--save-baseline <filename>\n--check-baseline <filename>\n"
+        "--noise-mads <k>\n"
     )
     sys.exit()
 
@@ -124,6 +167,19 @@ def ReadSysArgs():
 
 
 
+    # Subroutine for handling options of the baseline regression tracking, which are
+    # kept out of ArgOptions so that they can be given in any order
+    def ReadBaselineOption(i):
+        arg = sys.argv[i]
+        if (len(sys.argv) <= i + 1 or (sys.argv[i+1])[:2] == "--"):
+            print_usage("Missing " + arg + " option(s)")
+        if (not (Run or Runall)):
+            print_usage(arg + " requires --run or --runall")
+
+        option = sys.argv[i+1]
+        sys.argv[i+1] = "/ignorethis"
+        return option
+
     # Number of supplied run arguments (must not exceed 1)
     SuppliedRunArgs = 0
 
@@ -169,6 +225,32 @@ def ReadSysArgs():
             # Check that the options are supplied
             ValidateOptions(i, NumberOfExpectedOptions)
 
+            global MaxRelativeSlowdown
+            MaxRelativeSlowdown = float(ArgOptions[-1])
+
+        # --repetitions argument
+        elif (argname == "repetitions"):
+            global Repetitions
+            Repetitions = int(ReadBaselineOption(i))
+            if (Repetitions < 1):
+                print_usage("--repetitions must be at least 1")
+
+        # --noise-mads argument
+        elif (argname == "noise-mads"):
+            global NoiseMADs
+            NoiseMADs = float(ReadBaselineOption(i))
+
+        # --save-baseline and --check-baseline arguments
+        elif (argname in ["save-baseline", "check-baseline"]):
+            global SaveBaseline, CheckBaseline, BaselineFilename
+            if (SaveBaseline or CheckBaseline):
+                print_usage("Supply only one of --save-baseline and --check-baseline")
+            if (argname == "save-baseline"):
+                SaveBaseline = True
+            else:
+                CheckBaseline = True
+            BaselineFilename = ReadBaselineOption(i)
+
         # --run argument
         elif (argname == "run"):
             global Run
@@ -270,7 +352,7 @@ def ExtractFileOutput(filename):
 
 # Runs Benchmark binary and writes CSV results to file
 # Function returns CSV-format result
-def RunPerformanceBenchmark(op):
+def RunPerformanceBenchmark(op, ExtraOptions=[]):
 
     PerfOp = "Perf" + op
 
@@ -282,7 +364,7 @@ def RunPerformanceBenchmark(op):
 
     print("Running " + PerfOp + " ...")
 
-    result = (subprocess.run([BenchmarkCommand] + BenchmarkOptions, capture_output=True, text=True)).stdout
+    result = (subprocess.run([BenchmarkCommand] + BenchmarkOptions + ExtraOptions, capture_output=True, text=True)).stdout
 
     print("Results written to " + OutName)
 
@@ -359,6 +441,116 @@ def ReadCSVOutput(result):
 
 
 
+# Returns the median of a non-empty list of numbers
+def Median(values):
+    values = sorted(values)
+    mid = len(values) // 2
+    if (len(values) % 2 == 1):
+        return values[mid]
+    return (values[mid - 1] + values[mid]) / 2
+
+
+
+# Runs the benchmarks of op Repetitions times, and returns a dictionary mapping
+# "PerfOp/benchmark/shape" to the median and MAD of BaselineMetric
+def RunRepeatedBenchmark(op):
+
+    RepetitionOptions = [
+        "--benchmark_repetitions=" + str(Repetitions),
+        "--benchmark_report_aggregates_only=false"
+    ]
+    RawBenchmarkOutput = RunPerformanceBenchmark(op, RepetitionOptions)
+
+    # Set by --verbose argument
+    if (PrintOutputs):
+        WriteFormattedOutput(RawBenchmarkOutput, None)
+
+    # Gather the samples of each benchmark, skipping the aggregates computed by
+    # the benchmark library and the benchmarks that did not report times
+    Samples = {}
+    TimeUnits = {}
+    Aggregates = ("_mean", "_median", "_stddev", "_cv")
+    for OutputDict in ReadCSVOutput(RawBenchmarkOutput):
+        name = OutputDict["name"].strip('"')
+        if (name.endswith(Aggregates) or not OutputDict.get(BaselineMetric)):
+            continue
+        key = "Perf" + op + "/" + name
+        Samples.setdefault(key, []).append(float(OutputDict[BaselineMetric]))
+        TimeUnits[key] = OutputDict["time_unit"]
+
+    Summaries = {}
+    for key, values in Samples.items():
+        median = Median(values)
+        Summaries[key] = {
+            "median": median,
+            "mad": Median([abs(v - median) for v in values]),
+            "repetitions": len(values),
+            "time_unit": TimeUnits[key]
+        }
+    return Summaries
+
+
+
+# Compiler options of the benchmarks, used as the first key of baselines
+def BaselineOptionsKey():
+    return os.environ.get("PERF_ARGS", "").strip()
+
+
+
+# Reads a baseline file, or returns an empty baseline if it does not exist yet
+def ReadBaseline(filename):
+    if (not os.path.exists(filename)):
+        return {}
+    with open(filename, "r") as f:
+        return json.load(f)
+
+
+
+# Merges the summaries into the baseline file, under the current compiler options
+def WriteBaseline(filename, Summaries):
+    Baseline = ReadBaseline(filename)
+    Baseline.setdefault(BaselineOptionsKey(), {}).update(Summaries)
+    with open(filename, "w") as f:
+        json.dump(Baseline, f, indent=2, sort_keys=True)
+        f.write("\n")
+    print("Baseline of " + str(len(Summaries)) + " benchmarks written to " + filename)
+
+
+
+# Compares the summaries to the baseline stored for the current compiler
+# options, and returns the number of significant slowdowns
+def CheckAgainstBaseline(filename, Summaries):
+    Baseline = ReadBaseline(filename).get(BaselineOptionsKey(), {})
+
+    Slowdowns = 0
+    for key in sorted(Summaries.keys()):
+        New = Summaries[key]
+        if (key not in Baseline):
+            print(key + ": no baseline")
+            continue
+        Old = Baseline[key]
+        if (Old["time_unit"] != New["time_unit"] or Old["median"] <= 0):
+            print(key + ": baseline has incompatible time unit or value")
+            continue
+
+        Difference = New["median"] - Old["median"]
+        Pct        = (Difference / Old["median"]) * 100
+        Noise      = NoiseMADs * max(Old["mad"], New["mad"])
+
+        Line  = key + " " + BaselineMetric + " median: "
+        Line += str(round(Old["median"], 2)) + " -> " + str(round(New["median"], 2))
+        Line += " " + New["time_unit"] + " (" + str(round(Pct, 2)) + "%, noise "
+        Line += str(round(Noise, 2)) + ")"
+        if (Pct > MaxRelativeSlowdown and Difference > Noise):
+            Line += " [SIGNIFICANT SLOWDOWN]"
+            Slowdowns += 1
+        print(Line)
+
+    print(str(Slowdowns) + " significant slowdown(s) out of " + str(len(Summaries)) + " benchmarks")
+    return Slowdowns
+
+
+
 # Called only if --verbose flag is supplied
 def WriteFormattedOutput(RawBenchmarkOutput, SpecificArg):
 
@@ -396,8 +588,24 @@ def main():
     # Read in script arguments safely
     ReadSysArgs()
 
+    # Run the benchmarks repeatedly, and save or check their baseline
+    if (SaveBaseline or CheckBaseline):
+        Ops = [ArgOptions[0]] if (Run) else OpsWithPerformanceBenchmarks
+
+        Summaries = {}
+        for op in Ops:
+            Summaries.update(RunRepeatedBenchmark(op))
+
+        if (SaveBaseline):
+            WriteBaseline(BaselineFilename, Summaries)
+        elif (CheckAgainstBaseline(BaselineFilename, Summaries) > 0):
+            global SlowdownLimitExceeded
+            SlowdownLimitExceeded = True
+
+
+
     # Compute performance benchmarks for specified op, and write to output file
-    if (Run):
+    elif (Run):
         op = ArgOptions[0]
 
         # Get CSV benchmark results and write to output file
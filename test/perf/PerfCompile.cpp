@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===============-- PerfCompile.cpp - Compilation performance tests -=========//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests measuring the compilation of large synthetic
+// models: long chains of elementwise ops, and chains of ops with large
+// constants to fold and emit.
+//   * Time is set to report in seconds (s), and includes loading the model.
+//   * The wall time (_MS) and peak RSS (_RSS_KB) of the phases of the last
+//     compilation are found in the compile profile. The peak RSS of the
+//     passes is the one of the process, so best run each test in its own
+//     process, using --benchmark_filter.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "include/OnnxMlirCompiler.h"
+#include "src/Compiler/CompilerOptions.hpp"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfcompile");
+const std::string profileName("./perfcompile.profile.json");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+using ModelFactory =
+    std::function<std::unique_ptr<onnx_mlir::test::ModelLibBuilder>()>;
+
+// Phase of a pass of the compile profile.
+static std::string getPhase(llvm::StringRef pass) {
+  if (pass == "shape-inference")
+    return "SHAPE_INFERENCE";
+  if (pass == "constprop-onnx")
+    return "CONSTPROP";
+  if (pass == "convert-onnx-to-krnl")
+    return "ONNX_TO_KRNL";
+  if (pass.startswith("convert-krnl-to-"))
+    return "KRNL_TO_LLVM";
+  return "";
+}
+
+// Record the wall time and the peak RSS of the phases of the compile profile.
+// The tools run by the compiler, e.g. opt, llc and the linker, are the CODEGEN
+// phase, and the rest of the compilation the OTHER phase.
+static void recordProfile(benchmark::State &state) {
+  auto buffer = llvm::MemoryBuffer::getFile(profileName);
+  if (!buffer) {
+    state.SkipWithError("failed to read the compile profile");
+    return;
+  }
+  llvm::Expected<llvm::json::Value> profile =
+      llvm::json::parse((*buffer)->getBuffer());
+  if (!profile || !profile->getAsObject()) {
+    llvm::consumeError(profile.takeError());
+    state.SkipWithError("failed to parse the compile profile");
+    return;
+  }
+  const llvm::json::Object &root = *profile->getAsObject();
+
+  std::map<std::string, double> wallMs, peakRSSKB;
+  auto record = [&](const std::string &phase, const llvm::json::Object &run) {
+    wallMs[phase] += run.getNumber("wall_ms").value_or(0);
+    peakRSSKB[phase] =
+        std::max(peakRSSKB[phase], run.getNumber("peak_rss_kb").value_or(0));
+  };
+  if (const llvm::json::Array *passes = root.getArray("passes"))
+    for (const llvm::json::Value &pass : *passes)
+      if (const llvm::json::Object *run = pass.getAsObject()) {
+        std::string phase = getPhase(run->getString("pass").value_or(""));
+        if (!phase.empty())
+          record(phase, *run);
+      }
+  if (const llvm::json::Array *tools = root.getArray("subprocesses"))
+    for (const llvm::json::Value &tool : *tools)
+      if (const llvm::json::Object *run = tool.getAsObject())
+        record("CODEGEN", *run);
+
+  double totalMs = root.getNumber("total_wall_ms").value_or(0);
+  double otherMs = totalMs;
+  for (auto &entry : wallMs) {
+    state.counters[entry.first + "_MS"] = entry.second;
+    state.counters[entry.first + "_RSS_KB"] = peakRSSKB[entry.first];
+    otherMs -= entry.second;
+  }
+  state.counters["OTHER_MS"] = std::max(otherMs, 0.0);
+  state.counters["TOTAL_MS"] = totalMs;
+  state.counters["PEAK_RSS_KB"] = root.getNumber("peak_rss_kb").value_or(0);
+}
+
+// Build a new model for each iteration, untimed, then compile and load it
+// with the compile profile enabled.
+static void compile(benchmark::State &state, const ModelFactory &factory) {
+  onnx_mlir::compileProfile = profileName;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<onnx_mlir::test::ModelLibBuilder> model = factory();
+    bool success = model->build();
+    state.ResumeTiming();
+    success = success && model->compileAndLoad(opts);
+    if (!success) {
+      state.SkipWithError("failed compile");
+      break;
+    }
+  }
+  onnx_mlir::compileProfile = "";
+  recordProfile(state);
+}
+
+// Chains of 10k to 100k elementwise ops on small tensors.
+static void BM_Compile_ElementwiseChain(benchmark::State &state) {
+  int numOps = state.range(0);
+  compile(state, [&]() {
+    return std::make_unique<onnx_mlir::test::ElementwiseChainLibBuilder>(
+        modelName, 1, 16, numOps);
+  });
+  state.counters["OPS"] = numOps;
+}
+BENCHMARK(BM_Compile_ElementwiseChain)
+    ->Arg(10000)
+    ->Arg(30000)
+    ->Arg(100000)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+
+// Chains of layers with two 1024x1024 constants, namely 8MB, per layer, for a
+// total of 256MB to 4GB of constants.
+static void BM_Compile_LargeConstants(benchmark::State &state) {
+  int numLayers = state.range(0);
+  int N = 1024;
+  int C = 1024;
+  compile(state, [&]() {
+    return std::make_unique<onnx_mlir::test::LargeConstantsLibBuilder>(
+        modelName, numLayers, N, C);
+  });
+  state.counters["OPS"] = 4.0 * numLayers;
+  state.counters["CONSTANT_BYTES"] = 2.0 * numLayers * N * C * sizeof(float);
+}
+BENCHMARK(BM_Compile_LargeConstants)
+    ->Arg(32)
+    ->Arg(128)
+    ->Arg(512)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+
+PERF_MAIN()
@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//==========-- PerfDataMovement.cpp - Data movement performance tests -=======//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests for ops that mostly move data: Transpose, Gather,
+// Concat and Resize.
+//   * Time is set to report in miliseconds (ms)
+//   * Bandwidth counts the data read and written once.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfdatamovement");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+// Swap the two innermost dims of a NxSxS tensor.
+static void BM_Transpose(benchmark::State &state) {
+  int64_t N = state.range(0);
+  int64_t S = state.range(1);
+  onnx_mlir::test::TransposeLibBuilder model(modelName, {N, S, S}, {0, 2, 1});
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed transpose");
+  for (auto _ : state)
+    model.run();
+  perf_recordBandwidth(state, 2.0 * N * S * S * sizeof(float));
+}
+BENCHMARK(BM_Transpose)
+    ->ArgsProduct({{1, 16}, {64, 256, 1024}})
+    ->Unit(benchmark::kMillisecond);
+
+// Gather I rows of C elements out of a table of R rows.
+static void BM_Gather(benchmark::State &state) {
+  int R = 16384;
+  int C = state.range(0);
+  int I = state.range(1);
+  onnx_mlir::test::GatherLibBuilder model(modelName, R, C, I);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed gather");
+  for (auto _ : state)
+    model.run();
+  // Rows read and written, plus the int64 indices.
+  perf_recordBandwidth(
+      state, 2.0 * I * C * sizeof(float) + 1.0 * I * sizeof(int64_t));
+}
+BENCHMARK(BM_Gather)
+    ->ArgsProduct({{64, 1024}, {256, 4096}})
+    ->Unit(benchmark::kMillisecond);
+
+// Concat numInputs NxC tensors along axis 0 or 1.
+static void BM_Concat(benchmark::State &state) {
+  int numInputs = state.range(0);
+  int N = 256;
+  int C = state.range(1);
+  int axis = state.range(2);
+  onnx_mlir::test::ConcatLibBuilder model(modelName, numInputs, N, C, axis);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed concat");
+  for (auto _ : state)
+    model.run();
+  perf_recordBandwidth(state, 2.0 * numInputs * N * C * sizeof(float));
+}
+BENCHMARK(BM_Concat)
+    ->ArgsProduct({{2, 8}, {256, 4096}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Upsample a NxCxHxW tensor by a factor 2, nearest (0) or linear (1).
+static void BM_Resize(benchmark::State &state) {
+  bool isLinear = state.range(0);
+  int N = 1;
+  int C = 16;
+  int H = state.range(1);
+  int W = state.range(1);
+  int scale = 2;
+  onnx_mlir::test::ResizeLibBuilder model(
+      modelName, N, C, H, W, scale, isLinear);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed resize");
+  for (auto _ : state)
+    model.run();
+  double xSize = 1.0 * N * C * H * W;
+  perf_recordBandwidth(state, (xSize + xSize * scale * scale) * sizeof(float));
+}
+BENCHMARK(BM_Resize)
+    ->ArgsProduct({{0, 1}, {64, 256}})
+    ->Unit(benchmark::kMillisecond);
+
+PERF_MAIN()
@@ -0,0 +1,51 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//============-- PerfElementwise.cpp - Elementwise performance tests -========//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests for chains of elementwise ops, compiled with and
+// without fusion of the elementwise ops.
+//   * Time is set to report in miliseconds (ms)
+//   * Bandwidth counts the inputs and output of the chain once, which is the
+//     minimum traffic of a fully fused chain.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "src/Compiler/CompilerOptions.hpp"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfelementwise");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+// Arguments are: fusion (0 or 1), N, C, and the number of ops in the chain.
+static void BM_ElementwiseChain(benchmark::State &state) {
+  bool fusion = state.range(0);
+  int N = state.range(1);
+  int C = state.range(2);
+  int numOps = state.range(3);
+  onnx_mlir::enableFusion = fusion;
+  onnx_mlir::test::ElementwiseChainLibBuilder model(modelName, N, C, numOps);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed elementwise chain");
+  for (auto _ : state)
+    model.run();
+  perf_recordFlops(state, 1.0 * N * C * numOps);
+  // Two inputs and one output.
+  perf_recordBandwidth(state, 3.0 * N * C * sizeof(float));
+}
+BENCHMARK(BM_ElementwiseChain)
+    ->ArgsProduct({{0, 1}, {1, 64}, {4096, 65536}, {1, 3, 9}})
+    ->Unit(benchmark::kMillisecond);
+
+PERF_MAIN()
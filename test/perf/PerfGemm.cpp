@@ -42,6 +42,25 @@ BENCHMARK(BM_MatrixVectorProduct)
     ->Unit(benchmark::kMillisecond)
     ->Complexity();
 
+// Vector times matrix, as in the decoding steps of language models.
+static void BM_VectorMatrixProduct(benchmark::State &state) {
+  int I = 1;
+  int J = state.range(0);
+  int K = state.range(0);
+  onnx_mlir::test::MatMul2DLibBuilder model(modelName, I, J, K);
+  assert(model.build() && model.compileAndLoad() && model.prepareInputs() &&
+         "failed matmul");
+  for (auto _ : state)
+    model.run();
+  state.SetComplexityN(J);
+  perf_recordFlops(state, 2.0 * I * J * K);
+}
+BENCHMARK(BM_VectorMatrixProduct)
+    ->RangeMultiplier(2)
+    ->Range(16, 2048)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+
 static void BM_MatmulSquare(benchmark::State &state) {
   int I = state.range(0);
   int J = state.range(0);
@@ -12,6 +12,13 @@
 // actions.
 //===----------------------------------------------------------------------===//
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "llvm/Support/CommandLine.h"
 
 #include "test/perf/PerfHelper.hpp"
@@ -26,6 +33,93 @@ void perf_recordFlops(benchmark::State &state, float f) {
       f, benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1000);
 }
 
+// Pass b as a (double) number of bytes read and written by the measurement,
+// counting each input and output once, and report it as the actual number
+// (BYTES) and as a rate per seconds (BW).
+void perf_recordBandwidth(benchmark::State &state, float b) {
+  state.counters["BW"] = benchmark::Counter(b,
+      benchmark::Counter::kIsRate | benchmark::Counter::kIsIterationInvariant,
+      benchmark::Counter::OneK::kIs1000);
+  state.counters["BYTES"] = benchmark::Counter(
+      b, benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1000);
+}
+
+// Run the loop of a scaling benchmark, where numCallers threads call run(t),
+// with t in [0, numCallers), once per iteration. Report the throughput and,
+// relative to the last run at one thread with the same key, the speedup and
+// efficiency.
+void perf_runScaling(benchmark::State &state, const std::string &key,
+    int numThreads, int numCallers, const std::function<void(int)> &run) {
+  // Throughput of the last run at one thread of each key.
+  static std::map<std::string, double> singleThreadThroughputs;
+
+  // The other callers wait for the benchmark thread to start an iteration,
+  // which then waits for all of them to be done with it.
+  std::mutex mutex;
+  std::condition_variable condition;
+  int64_t iteration = 0;
+  int pendingCallers = 0;
+  bool done = false;
+  std::vector<std::thread> callers;
+  for (int t = 1; t < numCallers; ++t)
+    callers.emplace_back([&, t]() {
+      int64_t lastIteration = 0;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(
+              lock, [&]() { return done || iteration != lastIteration; });
+          if (done)
+            return;
+          lastIteration = iteration;
+        }
+        run(t);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingCallers == 0)
+          condition.notify_all();
+      }
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++iteration;
+      pendingCallers = numCallers - 1;
+    }
+    condition.notify_all();
+    run(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return pendingCallers == 0; });
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  condition.notify_all();
+  for (std::thread &caller : callers)
+    caller.join();
+
+  double throughput =
+      (elapsed.count() > 0)
+          ? numCallers * (double)state.iterations() / elapsed.count()
+          : 0.0;
+  if (numThreads == 1)
+    singleThreadThroughputs[key] = throughput;
+  state.counters["THREADS"] = numThreads;
+  state.counters["INFS"] = benchmark::Counter(numCallers,
+      benchmark::Counter::kIsRate | benchmark::Counter::kIsIterationInvariant);
+  auto singleThread = singleThreadThroughputs.find(key);
+  if (singleThread != singleThreadThroughputs.end() && singleThread->second) {
+    double speedup = throughput / singleThread->second;
+    state.counters["SPEEDUP"] = speedup;
+    state.counters["EFFICIENCY"] = speedup / numThreads;
+  }
+}
+
 // Define performance main, with default opt level of 3, and scan PERF_ARGS to
 // override default onnx-mlir compiler options.
 int perf_main(int argc, char **argv) {
@@ -12,12 +12,32 @@
 // actions.
 //===----------------------------------------------------------------------===//
 
+#include <functional>
+#include <string>
+
 #include <benchmark/benchmark.h>
 
 // Pass f as a (double) number of FLOP in the measurement and report it as the
 // actual number (FLOP) and as a rate per seconds (FLOPS).
 void perf_recordFlops(benchmark::State &state, float f);
 
+// Pass b as a (double) number of bytes read and written by the measurement,
+// counting each input and output once, and report it as the actual number
+// (BYTES) and as a rate per seconds (BW).
+void perf_recordBandwidth(benchmark::State &state, float b);
+
+// Run the loop of a scaling benchmark, where numCallers threads call run(t),
+// with t in [0, numCallers), once per iteration. Caller 0 is the benchmark
+// thread, the others are started once for the whole loop. The benchmark uses
+// numThreads threads, e.g. numThreads callers of one model (inter-op), or one
+// caller of a model whose parallel loops run on numThreads threads (intra-op).
+// Report numThreads (THREADS) and the throughput in inferences per seconds
+// (INFS). Report as well the speedup (SPEEDUP) and efficiency, namely speedup
+// per thread (EFFICIENCY), relative to the last run at one thread of the
+// benchmark with the same key, which should thus run first.
+void perf_runScaling(benchmark::State &state, const std::string &key,
+    int numThreads, int numCallers, const std::function<void(int)> &run);
+
 // Define performance main, with default opt level of 3, and scan PERF_ARGS to
 // override default onnx-mlir compiler options.
 int perf_main(int argc, char **argv);
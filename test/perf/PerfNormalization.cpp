@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//==========-- PerfNormalization.cpp - Normalization performance tests -======//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests for Softmax and LayerNormalization along the
+// innermost axis.
+//   * Time is set to report in miliseconds (ms)
+//   * Bandwidth counts each input and output once.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfnormalization");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+static void BM_Softmax(benchmark::State &state) {
+  int N = state.range(0);
+  int C = state.range(1);
+  onnx_mlir::test::SoftmaxLibBuilder model(modelName, N, C);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed softmax");
+  for (auto _ : state)
+    model.run();
+  perf_recordBandwidth(state, 2.0 * N * C * sizeof(float));
+}
+BENCHMARK(BM_Softmax)
+    ->ArgsProduct({{1, 64, 1024}, {128, 1024, 4096}})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_LayerNorm(benchmark::State &state) {
+  int N = state.range(0);
+  int C = state.range(1);
+  onnx_mlir::test::LayerNormLibBuilder model(modelName, N, C);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed layer norm");
+  for (auto _ : state)
+    model.run();
+  // Input, output, scale and bias.
+  perf_recordBandwidth(state, (2.0 * N * C + 2.0 * C) * sizeof(float));
+}
+BENCHMARK(BM_LayerNorm)
+    ->ArgsProduct({{1, 64, 1024}, {128, 1024, 4096}})
+    ->Unit(benchmark::kMillisecond);
+
+PERF_MAIN()
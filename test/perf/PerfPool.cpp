@@ -0,0 +1,59 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===================-- PerfPool.cpp - Pooling performance tests -============//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests for MaxPool and AveragePool with square kernels.
+//   * Time is set to report in miliseconds (ms)
+//   * Bandwidth counts the input and output once.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfpool");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+// Arguments are: N, H and W, and the kernel size K, with stride K for K=2 and
+// stride 1 otherwise.
+static void pool(benchmark::State &state, bool isMax) {
+  int N = state.range(0);
+  int C = 16;
+  int H = state.range(1);
+  int W = state.range(1);
+  int K = state.range(2);
+  int S = (K == 2) ? 2 : 1;
+  onnx_mlir::test::Pool2DLibBuilder model(modelName, isMax, N, C, H, W, K, S);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed pool");
+  for (auto _ : state)
+    model.run();
+  double HOut = (H - K) / S + 1;
+  double WOut = (W - K) / S + 1;
+  double ySize = 1.0 * N * C * HOut * WOut;
+  perf_recordFlops(state, ySize * K * K);
+  perf_recordBandwidth(state, (1.0 * N * C * H * W + ySize) * sizeof(float));
+}
+
+static void BM_MaxPool2D(benchmark::State &state) { pool(state, true); }
+BENCHMARK(BM_MaxPool2D)
+    ->ArgsProduct({{1, 16}, {64, 256}, {2, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_AveragePool2D(benchmark::State &state) { pool(state, false); }
+BENCHMARK(BM_AveragePool2D)
+    ->ArgsProduct({{1, 16}, {64, 256}, {2, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+PERF_MAIN()
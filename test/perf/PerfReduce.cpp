@@ -0,0 +1,55 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//================-- PerfReduce.cpp - Reduction performance tests -===========//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests for ReduceSum and ReduceMean over each axis of a
+// 3D tensor.
+//   * Time is set to report in miliseconds (ms)
+//   * Bandwidth counts the input and output once.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfreduce");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+static void reduce(benchmark::State &state, bool isMean) {
+  int N = state.range(0);
+  int C = state.range(1);
+  int H = state.range(1);
+  int axis = state.range(2);
+  onnx_mlir::test::ReduceLibBuilder model(modelName, isMean, N, C, H, axis);
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed reduce");
+  for (auto _ : state)
+    model.run();
+  double xSize = 1.0 * N * C * H;
+  double ySize = xSize / (axis == 0 ? N : (axis == 1 ? C : H));
+  perf_recordFlops(state, xSize);
+  perf_recordBandwidth(state, (xSize + ySize) * sizeof(float));
+}
+
+static void BM_ReduceSum(benchmark::State &state) { reduce(state, false); }
+BENCHMARK(BM_ReduceSum)
+    ->ArgsProduct({{1, 16}, {64, 256}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_ReduceMean(benchmark::State &state) { reduce(state, true); }
+BENCHMARK(BM_ReduceMean)
+    ->ArgsProduct({{1, 16}, {64, 256}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+PERF_MAIN()
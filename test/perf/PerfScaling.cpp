@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//=============-- PerfScaling.cpp - Multi-threaded scaling tests -============//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains tests running models at 1 to 8 threads, either with the
+// parallel loops of one inference running on these threads (intra-op), or
+// with these threads running inferences of one model at once (inter-op).
+//   * Time is set to report in miliseconds (ms), measured in real time.
+//   * Speedup and efficiency are relative to the same test at one thread.
+//   * Default opt level is O3, options found in PERF_ARGS override default.
+//
+//===----------------------------------------------------------------------===//
+
+#include <benchmark/benchmark.h>
+
+#include "include/OnnxMlirCompiler.h"
+#include "include/OnnxMlirRuntime.h"
+#include "src/Compiler/CompilerOptions.hpp"
+#include "test/modellib/ModelLib.hpp"
+#include "test/perf/PerfHelper.hpp"
+
+const std::string modelName("./perfscaling");
+const onnx_mlir::CompilerOptionList opts{
+    {onnx_mlir::OptionKind::CompilerOptLevel, "3"}};
+
+// Run one inference at a time of a model compiled with --parallel, whose
+// loops run on the benchmark thread and numThreads - 1 workers of a pool.
+static void intraOp(benchmark::State &state, const std::string &key,
+    onnx_mlir::test::ModelLibBuilder &model, int numThreads) {
+  onnx_mlir::enableParallel = true;
+  bool success =
+      model.build() && model.compileAndLoad(opts) && model.prepareInputs();
+  onnx_mlir::enableParallel = false;
+  assert(success && "failed intra-op model");
+  OMThreadPool *pool = omThreadPoolCreate(numThreads - 1, nullptr);
+  assert(pool && omThreadPoolBind(pool, numThreads) == 0 &&
+         "failed thread pool");
+  perf_runScaling(state, key, numThreads, /*numCallers=*/1,
+      [&](int) { model.runAndDiscard(); });
+  omThreadPoolBind(nullptr, 0);
+  omThreadPoolDestroy(pool);
+}
+
+// Run inferences of a sequential model from numThreads threads at once.
+static void interOp(benchmark::State &state, const std::string &key,
+    onnx_mlir::test::ModelLibBuilder &model, int numThreads) {
+  assert(model.build() && model.compileAndLoad(opts) && model.prepareInputs() &&
+         "failed inter-op model");
+  perf_runScaling(state, key, numThreads, /*numCallers=*/numThreads,
+      [&](int) { model.runAndDiscard(); });
+}
+
+static void BM_IntraOp_Matmul(benchmark::State &state) {
+  int I = state.range(0);
+  int numThreads = state.range(1);
+  onnx_mlir::test::MatMul2DLibBuilder model(modelName, I, I, I);
+  intraOp(state, "IntraOp_Matmul/" + std::to_string(I), model, numThreads);
+  perf_recordFlops(state, 2.0 * I * I * I);
+}
+BENCHMARK(BM_IntraOp_Matmul)
+    ->ArgsProduct({{256, 1024}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_InterOp_Matmul(benchmark::State &state) {
+  int I = state.range(0);
+  int numThreads = state.range(1);
+  onnx_mlir::test::MatMul2DLibBuilder model(modelName, I, I, I);
+  interOp(state, "InterOp_Matmul/" + std::to_string(I), model, numThreads);
+  perf_recordFlops(state, 2.0 * numThreads * I * I * I);
+}
+BENCHMARK(BM_InterOp_Matmul)
+    ->ArgsProduct({{256, 1024}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Memory bound chain of elementwise ops, to expose contention on bandwidth.
+static void BM_IntraOp_Elementwise(benchmark::State &state) {
+  int N = state.range(0);
+  int C = 4096;
+  int numThreads = state.range(1);
+  onnx_mlir::test::ElementwiseChainLibBuilder model(modelName, N, C, 3);
+  intraOp(
+      state, "IntraOp_Elementwise/" + std::to_string(N), model, numThreads);
+  perf_recordBandwidth(state, 3.0 * N * C * sizeof(float));
+}
+BENCHMARK(BM_IntraOp_Elementwise)
+    ->ArgsProduct({{64, 1024}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_InterOp_Elementwise(benchmark::State &state) {
+  int N = state.range(0);
+  int C = 4096;
+  int numThreads = state.range(1);
+  onnx_mlir::test::ElementwiseChainLibBuilder model(modelName, N, C, 3);
+  interOp(
+      state, "InterOp_Elementwise/" + std::to_string(N), model, numThreads);
+  perf_recordBandwidth(state, 3.0 * numThreads * N * C * sizeof(float));
+}
+BENCHMARK(BM_InterOp_Elementwise)
+    ->ArgsProduct({{64, 1024}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+PERF_MAIN()
@@ -19,6 +19,7 @@
 
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 using namespace mlir;
@@ -163,6 +164,80 @@ public:
 
     return 0;
   }
+
+  // Tests element loops that are large enough to run in parallel.
+  int test_combine_large() {
+    std::cout << "test_combine_large:" << std::endl;
+
+    constexpr int64_t n = 100;
+    ShapedType lhsType = RankedTensorType::get({4, n, n}, I64);
+    std::vector<int64_t> lhsElms(4 * n * n);
+    std::iota(lhsElms.begin(), lhsElms.end(), 0);
+    auto lhs = elmsBuilder.fromMemoryBuffer(lhsType, buffer<int64_t>(lhsElms));
+    ShapedType rhsType = RankedTensorType::get({n, 1}, I64);
+    std::vector<int64_t> rhsElms(n);
+    for (int64_t i = 0; i < n; ++i)
+      rhsElms[i] = i * 1000000;
+    auto rhs = elmsBuilder.fromMemoryBuffer(rhsType, buffer<int64_t>(rhsElms));
+
+    auto add = [](WideNum a, WideNum b) { return WideNum(a.i64 + b.i64); };
+    auto c = elmsBuilder.combine(lhs, rhs, lhsType, add);
+    auto cValues = c.getValues<int64_t>();
+    for (int64_t i = 0; i < 4 * n * n; ++i)
+      assert(cValues[i] == i + ((i / n) % n) * 1000000);
+
+    // Combine a transposed, non-contiguous, argument.
+    auto t = elmsBuilder.transpose(lhs, {2, 1, 0});
+    ShapedType tType = RankedTensorType::get({n, n, 4}, I64);
+    auto d = elmsBuilder.combine(t, rhs, tType, add);
+    auto dValues = d.cast<DisposableElementsAttr>()
+                       .toDenseElementsAttr()
+                       .getValues<int64_t>();
+    for (int64_t i = 0; i < n; ++i)
+      for (int64_t j = 0; j < n; ++j)
+        for (int64_t k = 0; k < 4; ++k)
+          assert(dValues[(i * n + j) * 4 + k] ==
+                 k * n * n + j * n + i + j * 1000000);
+
+    return 0;
+  }
+
+  // Tests a chain of lazy combines with broadcast operands and a transpose.
+  int test_combine_chain() {
+    std::cout << "test_combine_chain:" << std::endl;
+
+    constexpr int64_t n = 100;
+    ShapedType xType = RankedTensorType::get({4, n, n}, I64);
+    std::vector<int64_t> xElms(4 * n * n);
+    std::iota(xElms.begin(), xElms.end(), 0);
+    auto x = elmsBuilder.fromMemoryBuffer(xType, buffer<int64_t>(xElms));
+    ShapedType biasType = RankedTensorType::get({n, 1}, I64);
+    std::vector<int64_t> biasElms(n);
+    for (int64_t i = 0; i < n; ++i)
+      biasElms[i] = i * 1000000;
+    auto bias =
+        elmsBuilder.fromMemoryBuffer(biasType, buffer<int64_t>(biasElms));
+    ShapedType scaleType = RankedTensorType::get({4}, I64);
+    auto scale =
+        elmsBuilder.fromMemoryBuffer(scaleType, buffer<int64_t>({1, 2, 3, 4}));
+
+    auto add = [](WideNum a, WideNum b) { return WideNum(a.i64 + b.i64); };
+    auto mul = [](WideNum a, WideNum b) { return WideNum(a.i64 * b.i64); };
+    auto c = elmsBuilder.combine(x, bias, xType, add);
+    auto t = elmsBuilder.transpose(c, {2, 1, 0});
+    ShapedType tType = RankedTensorType::get({n, n, 4}, I64);
+    auto d = elmsBuilder.combine(scale, t, tType, mul);
+    auto dValues = d.cast<DisposableElementsAttr>()
+                       .toDenseElementsAttr()
+                       .getValues<int64_t>();
+    for (int64_t i = 0; i < n; ++i)
+      for (int64_t j = 0; j < n; ++j)
+        for (int64_t k = 0; k < 4; ++k)
+          assert(dValues[(i * n + j) * 4 + k] ==
+                 (k * n * n + j * n + i + j * 1000000) * (k + 1));
+
+    return 0;
+  }
 };
 
 } // namespace
@@ -173,6 +248,8 @@ int main(int argc, char *argv[]) {
   failures += test.test_splat();
   failures += test.test_transpose();
   failures += test.test_cast();
+  failures += test.test_combine_large();
+  failures += test.test_combine_chain();
   if (failures != 0) {
     std::cerr << failures << " test failures\n";
     return 1;
@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===-------------- OMAllocatorTest.c - OMAllocator Unit Test -------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains unit tests of the allocators of the runtime.
+//
+//===----------------------------------------------------------------------===//
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "onnx-mlir/Runtime/OMAllocator.h"
+#include "onnx-mlir/Runtime/OMArena.h"
+
+static int isAligned(void *ptr, int64_t alignment) {
+  return ((uintptr_t)ptr & (uintptr_t)(alignment - 1)) == 0;
+}
+
+// Allocate, fill and free buffers of various sizes and alignments.
+static void checkAllocator(const OMAllocator *allocator) {
+  int64_t sizes[] = {0, 1, 1000, 1 << 16, (1 << 21) + 1};
+  for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); ++i) {
+    for (int64_t alignment = 1; alignment <= (1 << 22); alignment <<= 3) {
+      char *ptr =
+          (char *)allocator->alloc(allocator->context, sizes[i], alignment);
+      assert(ptr && isAligned(ptr, alignment));
+      memset(ptr, i, sizes[i]);
+      for (int64_t j = 0; j < sizes[i]; ++j)
+        assert(ptr[j] == (char)i);
+      allocator->free(allocator->context, ptr, sizes[i]);
+    }
+  }
+  assert(!allocator->alloc(allocator->context, -1, 16));
+  assert(!allocator->alloc(allocator->context, 16, 3));
+}
+
+// Allocator counting the bytes allocated by the malloc one.
+static int64_t allocatedBytes = 0;
+
+static void *countingAlloc(void *context, int64_t size, int64_t alignment) {
+  const OMAllocator *allocator = (const OMAllocator *)context;
+  allocatedBytes += size;
+  return allocator->alloc(allocator->context, size, alignment);
+}
+
+static void countingFree(void *context, void *ptr, int64_t size) {
+  const OMAllocator *allocator = (const OMAllocator *)context;
+  allocatedBytes -= size;
+  allocator->free(allocator->context, ptr, size);
+}
+
+void testOMAllocator() {
+  assert(omAllocatorGet() == omAllocatorGetMalloc());
+  checkAllocator(omAllocatorGetMalloc());
+
+  // Built-in allocators, huge pages and NUMA placement being best effort.
+  assert(!omAllocatorCreate(OM_PAGES_DEFAULT, -3));
+  OMAllocatorPages pages[] = {
+      OM_PAGES_DEFAULT, OM_PAGES_TRANSPARENT_HUGE, OM_PAGES_EXPLICIT_HUGE};
+  int64_t nodes[] = {OM_NUMA_NODE_ANY, OM_NUMA_NODE_LOCAL, 0};
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      OMAllocator *allocator = omAllocatorCreate(pages[i], nodes[j]);
+      assert(allocator);
+      checkAllocator(allocator);
+      omAllocatorDestroy(allocator);
+    }
+  }
+
+  // The blocks of the arena are allocated by the allocator of the thread
+  // and freed by the allocator that allocated them.
+  OMAllocator counting = {
+      countingAlloc, countingFree, (void *)omAllocatorGetMalloc()};
+  omAllocatorBind(&counting);
+  assert(omAllocatorGet() == &counting);
+  char *buffer = (char *)omArenaAlloc(1000, 64);
+  assert(buffer && isAligned(buffer, 64) && allocatedBytes >= 1000);
+  memset(buffer, 1, 1000);
+  omAllocatorBind(NULL);
+  assert(omAllocatorGet() == omAllocatorGetMalloc());
+  omArenaRelease(0);
+  omArenaDestroy();
+  assert(allocatedBytes == 0);
+
+  // The default allocator is used by the threads without any other.
+  omAllocatorSetDefault(&counting);
+  assert(omAllocatorGet() == &counting);
+  assert(omArenaAlloc(1 << 20, 16) && allocatedBytes >= (1 << 20));
+  omArenaRelease(0);
+  omArenaDestroy();
+  assert(allocatedBytes == 0);
+  omAllocatorSetDefault(NULL);
+  assert(omAllocatorGet() == omAllocatorGetMalloc());
+}
+
+void testOMMemoryStats() {
+  // The blocks of the arena are accounted by the allocator stats, and the
+  // buffers by the arena stats.
+  OMMemoryStats before, stats;
+  omAllocatorGetStats(&before);
+  assert(omArenaAlloc(1000, 64) && omArenaAlloc(3000, 16));
+  omArenaGetStats(&stats);
+  assert(stats.currentBytes >= 4000 && stats.peakBytes == stats.currentBytes);
+  assert(stats.numAllocs == 2);
+  omAllocatorGetStats(&stats);
+  assert(stats.currentBytes >= before.currentBytes + 4000);
+  assert(stats.peakBytes >= stats.currentBytes);
+  assert(stats.numAllocs == before.numAllocs + 1);
+
+  omArenaRelease(0);
+  omArenaGetStats(&stats);
+  assert(stats.currentBytes == 0 && stats.peakBytes >= 4000);
+  omArenaResetPeak();
+  assert(omArenaAlloc(100, 16));
+  omArenaGetStats(&stats);
+  assert(stats.peakBytes >= 100 && stats.peakBytes < 4000);
+  omArenaRelease(0);
+  omArenaDestroy();
+  omArenaGetStats(&stats);
+  assert(stats.currentBytes == 0 && stats.peakBytes == 0);
+  omAllocatorGetStats(&stats);
+  assert(stats.currentBytes == before.currentBytes);
+
+  const OMAllocator *allocator = omAllocatorGetMalloc();
+  void *ptr = omAllocatorAlloc(allocator, 1 << 20, 64);
+  assert(ptr);
+  omAllocatorGetStats(&stats);
+  assert(stats.currentBytes == before.currentBytes + (1 << 20));
+  assert(stats.peakBytes >= stats.currentBytes);
+  omAllocatorFree(allocator, ptr, 1 << 20);
+  omAllocatorGetStats(&stats);
+  assert(stats.currentBytes == before.currentBytes);
+}
+
+int main() {
+  testOMAllocator();
+  testOMMemoryStats();
+  return 0;
+}
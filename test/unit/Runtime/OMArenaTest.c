@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===------------------ OMArenaTest.c - OMArena Unit Test -----------------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains unit tests of the memory arena of the runtime.
+//
+//===----------------------------------------------------------------------===//
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "onnx-mlir/Runtime/OMArena.h"
+
+#define NUM_BUFFERS 64
+#define LARGE_SIZE (1 << 20)
+
+static int isAligned(void *ptr, int64_t alignment) {
+  return ((uintptr_t)ptr & (uintptr_t)(alignment - 1)) == 0;
+}
+
+// Allocate buffers of growing sizes and alignments, overflowing the first
+// block, and check that they do not overlap.
+static void allocBuffers(char *buffers[NUM_BUFFERS]) {
+  for (int i = 0; i < NUM_BUFFERS; ++i) {
+    int64_t size = 1000 * (i + 1);
+    int64_t alignment = (int64_t)1 << (i % 8);
+    buffers[i] = (char *)omArenaAlloc(size, alignment);
+    assert(buffers[i] && isAligned(buffers[i], alignment));
+    assert(isAligned(buffers[i], 16));
+    memset(buffers[i], i, size);
+  }
+  for (int i = 0; i < NUM_BUFFERS; ++i)
+    for (int64_t j = 0; j < 1000 * (i + 1); ++j)
+      assert(buffers[i][j] == (char)i);
+}
+
+void testOMArena() {
+  char *buffers[NUM_BUFFERS];
+
+  // Invalid arguments.
+  assert(!omArenaAlloc(-1, 16));
+  assert(!omArenaAlloc(16, 3));
+  assert(omArenaMark() == 0);
+
+  // Buffers of a first inference.
+  int64_t mark = omArenaMark();
+  allocBuffers(buffers);
+  assert(omArenaMark() > mark);
+  omArenaRelease(mark);
+  assert(omArenaMark() == 0);
+
+  // The next inferences fit in a single block: their buffers are allocated
+  // in order at the same addresses.
+  char *previous[NUM_BUFFERS];
+  allocBuffers(previous);
+  for (int i = 1; i < NUM_BUFFERS; ++i)
+    assert(previous[i] > previous[i - 1]);
+  omArenaRelease(0);
+  allocBuffers(buffers);
+  for (int i = 0; i < NUM_BUFFERS; ++i)
+    assert(buffers[i] == previous[i]);
+
+  // Nested marks give back the buffers allocated after them only.
+  mark = omArenaMark();
+  char *large = (char *)omArenaAlloc(LARGE_SIZE, 64);
+  assert(large && isAligned(large, 64));
+  memset(large, 1, LARGE_SIZE);
+  omArenaRelease(mark);
+  assert(omArenaMark() == mark);
+  char *reused = (char *)omArenaAlloc(16, 16);
+  assert(reused);
+  for (int i = 0; i < NUM_BUFFERS; ++i)
+    assert(buffers[i][0] == (char)i);
+  omArenaRelease(0);
+
+  // A reserved block holds the buffers of the next inference.
+  omArenaDestroy();
+  assert(omArenaReserve(LARGE_SIZE) == 0);
+  char *first = (char *)omArenaAlloc(16, 16);
+  char *second = (char *)omArenaAlloc(LARGE_SIZE - 16, 16);
+  assert(first && second && second == first + 16);
+  assert(omArenaReserve(2 * LARGE_SIZE) == 0);
+  assert(omArenaMark() == LARGE_SIZE);
+  omArenaRelease(0);
+
+  // Empty buffers and destruction.
+  assert(omArenaAlloc(0, 16));
+  omArenaRelease(0);
+  omArenaDestroy();
+  assert(omArenaMark() == 0);
+}
+
+int main() {
+  testOMArena();
+  return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------- OMInstrumentTest.c - OMInstrument Unit Test ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains unit tests of the profiling and tracing modes of
+// OMInstrument.
+//
+//===----------------------------------------------------------------------===//
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "onnx-mlir/Runtime/OMInstrument.h"
+
+#define REPORT_FILE "OMInstrumentTest.profile.txt"
+#define TRACE_FILE "OMInstrumentTest.trace.json"
+
+// Tags of the points before and after an op, reporting time.
+static const int64_t beforeTag = (1 << 0) | (1 << 2);
+static const int64_t afterTag = (1 << 1) | (1 << 2);
+
+// Return the count of the report line ending with the given op, or -1.
+static long long getReportedCount(const char *op) {
+  FILE *file = fopen(REPORT_FILE, "r");
+  assert(file);
+  char line[512];
+  long long count = -1;
+  while (count < 0 && fgets(line, sizeof(line), file)) {
+    line[strcspn(line, "\n")] = '\0';
+    size_t lineLen = strlen(line), opLen = strlen(op);
+    if (line[0] != '#' && lineLen > opLen &&
+        strcmp(line + lineLen - opLen, op) == 0 &&
+        line[lineLen - opLen - 1] == ' ')
+      count = strtoll(line, NULL, 10);
+  }
+  fclose(file);
+  return count;
+}
+
+// Return whether a header line of the report contains the given string.
+static bool isInReportHeader(const char *str) {
+  FILE *file = fopen(REPORT_FILE, "r");
+  assert(file);
+  char line[512];
+  bool found = false;
+  while (!found && fgets(line, sizeof(line), file))
+    found = line[0] == '#' && strstr(line, str);
+  fclose(file);
+  return found;
+}
+
+void testOMInstrumentProfile() {
+  // The hardware counters are reported as 0 where they cannot be read.
+#ifdef _WIN32
+  _putenv_s("OMINSTRUMENTPROFILE", REPORT_FILE);
+  _putenv_s("OMINSTRUMENTCOUNTERS", "1");
+#else
+  setenv("OMINSTRUMENTPROFILE", REPORT_FILE, 1);
+  setenv("OMINSTRUMENTCOUNTERS", "1", 1);
+#endif
+  OMInstrumentInit();
+
+  // Ops with points before and after them, including a nested op.
+  for (int i = 0; i < 3; ++i) {
+    OMInstrumentPoint("onnx.Loop", beforeTag, "loop1");
+    OMInstrumentPoint("onnx.Add", beforeTag, "add1");
+    OMInstrumentPoint("onnx.Add", afterTag, "add1");
+    OMInstrumentPoint("onnx.Loop", afterTag, "loop1");
+  }
+  // Ops with points after them only, more than fit in a ring buffer.
+  for (int i = 0; i < 3000; ++i)
+    OMInstrumentPoint("onnx.Relu", afterTag, i % 2 ? "relu1" : "NOTSET");
+
+  assert(OMInstrumentProfileReport(REPORT_FILE) == 0);
+  assert(getReportedCount("onnx.Loop") == 3);
+  assert(getReportedCount("onnx.Add (add1)") == 3);
+  assert(getReportedCount("onnx.Relu") == 3000);
+  assert(getReportedCount("onnx.Relu (relu1)") == 1500);
+  assert(isInReportHeader("bytes      IPC  LLC-MPKI  op"));
+
+  OMInstrumentProfileReset();
+  OMInstrumentPoint("onnx.Add", afterTag, "add1");
+  assert(OMInstrumentProfileReport(REPORT_FILE) == 0);
+  assert(getReportedCount("onnx.Add") == 1);
+  assert(getReportedCount("onnx.Relu") == -1);
+
+  // NNPA ops and conversions are split from CPU ops.
+  OMInstrumentProfileReset();
+  OMInstrumentPoint("zlow.stick", beforeTag, "add2");
+  OMInstrumentBytes(4096);
+  OMInstrumentPoint("zlow.stick", afterTag, "add2");
+  OMInstrumentPoint("zlow.add", beforeTag, "add2");
+  OMInstrumentPoint("zlow.add", afterTag, "add2");
+  assert(OMInstrumentProfileReport(REPORT_FILE) == 0);
+  assert(getReportedCount("nnpa") == 1);
+  assert(getReportedCount("stick/unstick") == 1);
+  assert(getReportedCount("cpu") == 0);
+}
+
+// Return the number of occurrences of str in the trace file.
+static int getTraceCount(const char *str) {
+  FILE *file = fopen(TRACE_FILE, "r");
+  assert(file);
+  static char trace[1 << 16];
+  size_t size = fread(trace, 1, sizeof(trace) - 1, file);
+  fclose(file);
+  trace[size] = '\0';
+  int count = 0;
+  for (const char *c = strstr(trace, str); c; c = strstr(c + 1, str))
+    count++;
+  return count;
+}
+
+void testOMInstrumentTrace() {
+  // Nothing is traced before tracing mode is enabled.
+  OMInstrumentPoint("onnx.Sub", afterTag, "sub1");
+  OMInstrumentTraceEnable();
+  for (int i = 0; i < 2; ++i) {
+    OMInstrumentPoint("onnx.Loop", beforeTag, "loop1");
+    OMInstrumentPoint("onnx.Add", beforeTag, "add\"1");
+    OMInstrumentBytes(64);
+    OMInstrumentPoint("onnx.Add", afterTag, "add\"1");
+    OMInstrumentPoint("onnx.Loop", afterTag, "loop1");
+  }
+  assert(OMInstrumentTraceWrite(TRACE_FILE) == 0);
+  assert(getTraceCount("{\"traceEvents\":[") == 1);
+  assert(getTraceCount("\"ph\":\"X\"") == 4);
+  assert(getTraceCount("{\"name\":\"onnx.Loop\"") == 2);
+  assert(getTraceCount("{\"name\":\"onnx.Sub\"") == 0);
+  assert(getTraceCount("\"node\":\"add\\\"1\",\"bytes\":64,") == 2);
+  assert(getTraceCount("\"tid\":0,") == 4);
+  assert(getTraceCount(",\"cycles\":") == 4);
+  assert(getTraceCount("\"dropped_events\":0}") == 1);
+}
+
+int main() {
+  testOMInstrumentProfile();
+  testOMInstrumentTrace();
+  return 0;
+}
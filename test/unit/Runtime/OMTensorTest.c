@@ -15,6 +15,7 @@
 //===----------------------------------------------------------------------===//
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "OnnxMlirRuntime.h"
 
@@ -35,7 +36,57 @@ void testOMTensorCtor() {
   assert(strides_ptr[1] == 1);
 }
 
+// Check the shape and strides of tensors of ranks with inline and allocated
+// shapes, created again after being destroyed.
+void testOMTensorReuse() {
+  float data[1] = {1.f};
+  int64_t shape[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+  for (int iter = 0; iter < 3; iter++) {
+    for (int64_t rank = 0; rank <= 8; rank += 2) {
+      OMTensor *tensor = omTensorCreate(data, shape, rank, ONNX_TYPE_FLOAT);
+      assert(tensor);
+      assert(omTensorGetRank(tensor) == rank);
+      omTensorSetShape(tensor, shape);
+      for (int64_t i = 0; i < rank; i++) {
+        assert(omTensorGetShape(tensor)[i] == 1);
+        assert(omTensorGetStrides(tensor)[i] == 1);
+      }
+      assert(omTensorGetNumElems(tensor) == 1);
+      omTensorDestroy(tensor);
+    }
+  }
+}
+
+// Check that the strings of a string tensor are held contiguously, null
+// terminated, and are given back with their offsets.
+void testOMTensorStrings() {
+  const char bytes[] = "catdogcow";
+  int64_t offsets[5] = {0, 3, 3, 6, 9};
+  int64_t shape[2] = {2, 2};
+  OMTensor *tensor = omTensorCreateStrings(bytes, offsets, shape, 2);
+  assert(tensor);
+  assert(omTensorGetDataType(tensor) == ONNX_TYPE_STRING);
+  const char **strs = (const char **)omTensorGetDataPtr(tensor);
+  assert(strcmp(strs[0], "cat") == 0);
+  assert(strcmp(strs[1], "") == 0);
+  assert(strcmp(strs[2], "dog") == 0);
+  assert(strcmp(strs[3], "cow") == 0);
+  for (int i = 0; i < 3; i++)
+    assert(strs[i + 1] == strs[i] + strlen(strs[i]) + 1);
+
+  char copy[9];
+  int64_t copyOffsets[5];
+  assert(omTensorGetStrings(tensor, NULL, NULL) == 9);
+  assert(omTensorGetStrings(tensor, copy, copyOffsets) == 9);
+  assert(memcmp(copy, bytes, 9) == 0);
+  for (int i = 0; i < 5; i++)
+    assert(copyOffsets[i] == offsets[i]);
+  omTensorDestroy(tensor);
+}
+
 int main() {
   testOMTensorCtor();
+  testOMTensorReuse();
+  testOMTensorStrings();
   return 0;
 }
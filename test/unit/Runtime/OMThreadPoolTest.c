@@ -0,0 +1,259 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//===--------------- OMThreadPoolTest.c - OMThreadPool Unit Test ----------===//
+//
+// Copyright 2023 The IBM Research Authors.
+//
+// =============================================================================
+//
+// This file contains unit tests of the thread pool running parallel loops and
+// tasks.
+//
+//===----------------------------------------------------------------------===//
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "onnx-mlir/Runtime/OMThreadPool.h"
+
+#define NUM_ITERATIONS 10000
+#define NUM_TASKS 16
+
+typedef struct {
+  int counts[NUM_ITERATIONS];
+  int64_t numCalls;
+  int nested;
+} LoopContext;
+
+static void countIterations(void *context, int64_t begin, int64_t end) {
+  LoopContext *loop = (LoopContext *)context;
+  assert(0 <= begin && begin < end && end <= NUM_ITERATIONS);
+  for (int64_t i = begin; i < end; ++i)
+    __atomic_fetch_add(&loop->counts[i], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&loop->numCalls, 1, __ATOMIC_RELAXED);
+}
+
+static void countNestedIterations(void *context, int64_t begin, int64_t end) {
+  LoopContext *loop = (LoopContext *)context;
+  // Nested loops run sequentially, in a single call.
+  LoopContext nestedLoop;
+  memset(&nestedLoop, 0, sizeof(nestedLoop));
+  omParallelFor(countIterations, &nestedLoop, NUM_ITERATIONS);
+  assert(nestedLoop.numCalls == 1);
+  countIterations(loop, begin, end);
+}
+
+// Check that every iteration of a loop runs exactly once.
+static void checkLoop(OMParallelForBody body, int64_t *numCalls) {
+  static LoopContext loop;
+  memset(&loop, 0, sizeof(loop));
+  omParallelFor(body, &loop, NUM_ITERATIONS);
+  for (int64_t i = 0; i < NUM_ITERATIONS; ++i)
+    assert(loop.counts[i] == 1);
+  if (numCalls)
+    *numCalls = loop.numCalls;
+}
+
+typedef struct {
+  int64_t numCalls;
+  int64_t numLoopCalls;
+} TaskContext;
+
+// Task running a parallel loop, whose iterations must all run once.
+static void runTask(void *context) {
+  TaskContext *task = (TaskContext *)context;
+  LoopContext *loop = (LoopContext *)calloc(1, sizeof(LoopContext));
+  assert(loop);
+  omParallelFor(countIterations, loop, NUM_ITERATIONS);
+  for (int64_t i = 0; i < NUM_ITERATIONS; ++i)
+    assert(loop->counts[i] == 1);
+  __atomic_fetch_add(&task->numLoopCalls, loop->numCalls, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&task->numCalls, 1, __ATOMIC_RELAXED);
+  free(loop);
+}
+
+typedef struct {
+  OMTensorList *output;
+  int err;
+  int64_t numCalls;
+} RunContext;
+
+static OMTensorList *echoEntryPoint(OMTensorList *input) { return input; }
+
+static OMTensorList *failingEntryPoint(OMTensorList *input) {
+  errno = EPERM;
+  return NULL;
+}
+
+static void recordRun(void *context, OMTensorList *output, int err) {
+  RunContext *run = (RunContext *)context;
+  run->output = output;
+  run->err = err;
+  __atomic_fetch_add(&run->numCalls, 1, __ATOMIC_RELAXED);
+}
+
+// Diamond graph 0 -> {1, 2} -> 3 followed by independent tasks 4 to 7, each
+// task running a parallel loop.
+#define NUM_GRAPH_TASKS 8
+static const int64_t predecessorCounts[NUM_GRAPH_TASKS] = {
+    0, 1, 1, 2, 0, 0, 0, 0};
+static const int64_t successorOffsets[NUM_GRAPH_TASKS + 1] = {
+    0, 2, 3, 4, 4, 4, 4, 4, 4};
+static const int64_t successors[] = {1, 2, 3, 3};
+
+typedef struct {
+  int64_t numDone;
+  int64_t doneAt[NUM_GRAPH_TASKS];
+  TaskContext loops;
+} GraphContext;
+
+static void runGraphTasks(void *context, int64_t begin, int64_t end) {
+  GraphContext *graph = (GraphContext *)context;
+  assert(0 <= begin && begin < end && end <= NUM_GRAPH_TASKS);
+  for (int64_t t = begin; t < end; ++t) {
+    // The predecessors of the task are done.
+    for (int64_t p = 0; p < NUM_GRAPH_TASKS; ++p)
+      for (int64_t i = successorOffsets[p]; i < successorOffsets[p + 1]; ++i)
+        if (successors[i] == t)
+          assert(__atomic_load_n(&graph->doneAt[p], __ATOMIC_ACQUIRE) > 0);
+    runTask(&graph->loops);
+    int64_t done = __atomic_add_fetch(&graph->numDone, 1, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&graph->doneAt[t], done, __ATOMIC_RELEASE);
+  }
+}
+
+// Check that every task of the graph runs exactly once, after its
+// predecessors.
+static void checkGraph() {
+  GraphContext graph;
+  memset(&graph, 0, sizeof(graph));
+  omRunTaskGraph(runGraphTasks, &graph, NUM_GRAPH_TASKS, predecessorCounts,
+      successorOffsets, successors);
+  assert(graph.numDone == NUM_GRAPH_TASKS);
+  assert(graph.loops.numCalls == NUM_GRAPH_TASKS);
+  for (int64_t t = 0; t < NUM_GRAPH_TASKS; ++t)
+    assert(graph.doneAt[t] > 0);
+}
+
+static void runNestedGraph(void *context, int64_t begin, int64_t end) {
+  // Graphs nested in a loop body run sequentially.
+  checkGraph();
+  countIterations(context, begin, end);
+}
+
+void testOMRunTaskGraph() {
+  // Default pool, and graphs nested in loops.
+  checkGraph();
+  checkLoop(runNestedGraph, NULL);
+
+  // Explicit pools, with and without workers.
+  OMThreadPool *pool = omThreadPoolCreate(3, NULL);
+  assert(pool);
+  assert(omThreadPoolBind(pool, 0) == 0);
+  for (int64_t i = 0; i < NUM_TASKS; ++i)
+    checkGraph();
+  assert(omThreadPoolBind(pool, 2) == 0);
+  checkGraph();
+  OMThreadPool *emptyPool = omThreadPoolCreate(0, NULL);
+  assert(emptyPool);
+  assert(omThreadPoolBind(emptyPool, 0) == 0);
+  checkGraph();
+  omRunTaskGraph(runGraphTasks, NULL, 0, NULL, NULL, NULL);
+
+  assert(omThreadPoolBind(NULL, 0) == 0);
+  omThreadPoolDestroy(emptyPool);
+  omThreadPoolDestroy(pool);
+}
+
+void testOMThreadPoolSubmit() {
+  // Destroying the pools waits for their tasks.
+  TaskContext task = {0, 0};
+  OMThreadPool *pool = omThreadPoolCreate(3, NULL);
+  assert(pool);
+  for (int64_t i = 0; i < NUM_TASKS; ++i)
+    assert(omThreadPoolSubmit(pool, runTask, &task) == 0);
+  omThreadPoolDestroy(pool);
+  assert(task.numCalls == NUM_TASKS);
+  assert(task.numLoopCalls >= NUM_TASKS);
+
+  // Tasks run in the calling thread with pools without workers.
+  memset(&task, 0, sizeof(task));
+  OMThreadPool *emptyPool = omThreadPoolCreate(0, NULL);
+  assert(emptyPool);
+  assert(omThreadPoolSubmit(emptyPool, runTask, &task) == 0);
+  assert(task.numCalls == 1);
+  assert(omThreadPoolSubmit(emptyPool, NULL, &task) == -1 && errno == EINVAL);
+  omThreadPoolDestroy(emptyPool);
+
+  // Inferences report their output or their error.
+  RunContext runs[2];
+  memset(runs, 0, sizeof(runs));
+  OMTensorList *input = (OMTensorList *)&runs;
+  pool = omThreadPoolCreate(2, NULL);
+  assert(pool);
+  assert(omRunAsync(pool, echoEntryPoint, input, recordRun, &runs[0]) == 0);
+  assert(omRunAsync(pool, failingEntryPoint, input, recordRun, &runs[1]) == 0);
+  assert(omRunAsync(pool, echoEntryPoint, input, NULL, NULL) == -1);
+  omThreadPoolDestroy(pool);
+  assert(runs[0].numCalls == 1 && runs[0].output == input && runs[0].err == 0);
+  assert(runs[1].numCalls == 1 && !runs[1].output && runs[1].err == EPERM);
+}
+
+void testOMThreadPool() {
+  int64_t numCalls;
+
+  // Default pool.
+  assert(omThreadPoolGetDefault());
+  checkLoop(countIterations, NULL);
+  checkLoop(countNestedIterations, NULL);
+
+  // Explicit pool, with pinned and unpinned workers.
+  int64_t cpus[] = {0, -1, 0};
+  OMThreadPool *pool = omThreadPoolCreate(3, cpus);
+  assert(pool && omThreadPoolGetNumThreads(pool) == 3);
+  assert(omThreadPoolBind(pool, 0) == 0);
+  checkLoop(countIterations, &numCalls);
+  assert(numCalls >= 4);
+  checkLoop(countNestedIterations, NULL);
+  int64_t maxThreads = omThreadPoolTakeMaxThreads();
+  assert(1 <= maxThreads && maxThreads <= 4);
+
+  // Capped concurrency.
+  assert(omThreadPoolBind(pool, 1) == 0);
+  checkLoop(countIterations, &numCalls);
+  assert(numCalls == 1);
+  assert(omThreadPoolTakeMaxThreads() == 1);
+  assert(omThreadPoolTakeMaxThreads() == 0);
+
+  // Prioritized loops.
+  assert(omThreadPoolBind(pool, 0) == 0);
+  assert(omThreadPoolSetPriority(1) == 0);
+  checkLoop(countIterations, &numCalls);
+  assert(numCalls >= 4);
+  assert(omThreadPoolSetPriority(0) == 0);
+  assert(omThreadPoolBind(pool, -1) == -1);
+
+  // Empty loops and pools.
+  omParallelFor(countIterations, NULL, 0);
+  OMThreadPool *emptyPool = omThreadPoolCreate(0, NULL);
+  assert(emptyPool && omThreadPoolGetNumThreads(emptyPool) == 0);
+  assert(omThreadPoolBind(emptyPool, 0) == 0);
+  checkLoop(countIterations, &numCalls);
+  assert(numCalls == 1);
+  assert(!omThreadPoolCreate(-1, NULL));
+
+  assert(omThreadPoolBind(NULL, 0) == 0);
+  omThreadPoolDestroy(emptyPool);
+  omThreadPoolDestroy(pool);
+}
+
+int main() {
+  testOMThreadPool();
+  testOMThreadPoolSubmit();
+  testOMRunTaskGraph();
+  return 0;
+}
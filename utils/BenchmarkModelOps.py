@@ -0,0 +1,324 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+
+####################### BenchmarkModelOps.py ###################################
+#
+# Copyright 2023 The IBM Research Authors.
+#
+################################################################################
+#
+# This script benchmarks the ops of a model one at a time, at the shapes and
+# attributes they have in the model, and ranks them by their contribution to
+# the latency of the model, to tell which lowerings to optimize for it.
+#
+################################################################################
+
+import argparse
+import json
+import logging
+import os
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+import onnx
+from onnx import helper, numpy_helper, shape_inference
+
+"""
+Note:
+    - Environment variable ONNX_MLIR_HOME is needed to find onnx-mlir and
+      run-onnx-lib, which must be built for dynamically loaded models with
+      utils/build-run-onnx-lib.sh.
+    - The ops of the model are grouped by signature: op type, types and
+      shapes of the operands after shape inference, and attributes. Each
+      signature is benchmarked once, on a model made of a single op of that
+      signature, compiled with --compile-args and timed in the benchmark mode
+      of run-onnx-lib. Ops whose shapes are not static, and ops with
+      subgraphs, e.g. Loop and If, are left out.
+    - The constant operands of an op, initializers or outputs of Constant
+      ops, keep their values in the one-op model, e.g. for the shape of a
+      Reshape or for the weights of a Conv to be packed at compile time.
+    - The FLOPs of the Conv, ConvTranspose, MatMul and Gemm ops count a
+      multiply and an add per MAC, and the ones of the elementwise ops one
+      per output element. The bytes are the sizes of the operands and
+      results, so that the bandwidth is the one achieved reading each operand
+      once.
+    - The ops are ranked by the total latency of their signature, the p50
+      latency times the number of ops of the signature in the model.
+
+Example:
+    $ ONNX_MLIR_HOME=/onnx-mlir/build/Release/ /onnx-mlir/utils/BenchmarkModelOps.py --compile-args="-O3 --mcpu=z16" -o ops.json model.onnx
+"""
+
+if (not os.environ.get('ONNX_MLIR_HOME', None)):
+    raise RuntimeError(
+        "Environment variable ONNX_MLIR_HOME is not set, please set it to the path to "
+        "the HOME directory for onnx-mlir. The HOME directory for onnx-mlir refers to "
+        "the parent folder containing the bin, lib, etc. sub-folders in which ONNX-MLIR "
+        "executables and libraries can be found.")
+
+LOG_LEVEL = { 'debug':    logging.DEBUG,
+              'info':     logging.INFO,
+              'warning':  logging.WARNING,
+              'error':    logging.ERROR,
+              'critical': logging.CRITICAL }
+
+"""Commands will be called in this script.
+"""
+ONNX_MLIR_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin', 'onnx-mlir')]
+RUN_ONNX_LIB_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin',
+                                 'run-onnx-lib')]
+
+# Ops counting one flop per output element.
+ELEMENTWISE_OPS = { 'Abs', 'Add', 'Clip', 'Div', 'Elu', 'Erf', 'Exp',
+                    'Gelu', 'HardSigmoid', 'LeakyRelu', 'Log', 'Max', 'Min',
+                    'Mul', 'Neg', 'Pow', 'PRelu', 'Reciprocal', 'Relu',
+                    'Sigmoid', 'Softplus', 'Sqrt', 'Sub', 'Sum', 'Tanh' }
+
+# Ops that are not benchmarked, having no computation or subgraphs.
+SKIPPED_OPS = { 'Constant', 'If', 'Loop', 'Scan' }
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('model',
+                        help="ONNX model whose ops are benchmarked.")
+    parser.add_argument('-b',
+                        '--bench',
+                        type=int,
+                        default=50,
+                        help="Number of timed inferences per op, default 50.")
+    parser.add_argument('-c',
+                        '--compile-args',
+                        default='-O3',
+                        help="Options passed to onnx-mlir to compile the ops,"
+                        " the ones the model is compiled with, default -O3.")
+    parser.add_argument('-l',
+                        '--log-level',
+                        choices=[ 'debug', 'info', 'warning', 'error', 'critical' ],
+                        default='info',
+                        help="log level, default info")
+    parser.add_argument('-o',
+                        '--output',
+                        default='',
+                        help="Json report of the ops, not written by default.")
+    parser.add_argument('--warmup',
+                        type=int,
+                        default=5,
+                        help="Number of untimed inferences per op, default 5.")
+    return parser.parse_args()
+
+
+# log to stderr so that stdout can be used for the summary
+def get_logger():
+    logging.basicConfig(stream=sys.stderr,
+                        level=LOG_LEVEL[args.log_level],
+                        format='[%(asctime)s] %(levelname)s: %(message)s')
+    return logging.getLogger('BenchmarkModelOps.py')
+
+args = get_args()
+logger = get_logger()
+
+
+def execute(cmds):
+    logger.debug('cmd={}'.format(' '.join(cmds)))
+    process = subprocess.run(cmds, stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT, universal_newlines=True)
+    return (process.returncode == 0, process.stdout)
+
+
+# Return the static shape of a value, or None if it is not fully known.
+def get_static_shape(value_info):
+    dims = value_info.type.tensor_type.shape.dim
+    if not value_info.type.tensor_type.HasField('shape'):
+        return None
+    if not all(d.HasField('dim_value') for d in dims):
+        return None
+    return [d.dim_value for d in dims]
+
+
+def get_num_elements(shape):
+    return int(np.prod(shape)) if shape else 1
+
+
+def get_elem_size(elem_type):
+    return np.dtype(helper.tensor_dtype_to_np_dtype(elem_type)).itemsize
+
+
+# Return the FLOPs of an op, or None if they are not known.
+def get_flops(node, attrs, input_shapes, output_shapes):
+    op = node.op_type
+    if op in ('Conv', 'ConvTranspose') and len(input_shapes[1]) >= 3:
+        # MACs per output element of Conv, per input element of
+        # ConvTranspose.
+        macs = get_num_elements(input_shapes[1][1:])
+        shape = output_shapes[0] if op == 'Conv' else input_shapes[0]
+        return 2 * get_num_elements(shape) * macs
+    if op == 'MatMul' and len(input_shapes[0]) >= 1:
+        return 2 * get_num_elements(output_shapes[0]) * input_shapes[0][-1]
+    if op == 'Gemm':
+        a = input_shapes[0]
+        K = a[0] if attrs.get('transA', 0) else a[1]
+        return 2 * get_num_elements(output_shapes[0]) * K
+    if op in ELEMENTWISE_OPS:
+        return get_num_elements(output_shapes[0])
+    return None
+
+
+# Return the one-op models to benchmark by signature, with the number of ops
+# of the signature and its FLOPs and bytes.
+def get_benchmarked_ops(model):
+    model = shape_inference.infer_shapes(model)
+    graph = model.graph
+    values = {}
+    for v in list(graph.input) + list(graph.value_info) + list(graph.output):
+        values[v.name] = v
+    constants = { i.name: i for i in graph.initializer }
+    for node in graph.node:
+        if node.op_type == 'Constant' and len(node.attribute) == 1 and \
+           node.attribute[0].name == 'value':
+            tensor = onnx.TensorProto()
+            tensor.CopyFrom(node.attribute[0].t)
+            tensor.name = node.output[0]
+            constants[tensor.name] = tensor
+
+    def type_of(name):
+        if name in constants:
+            return constants[name].data_type, list(constants[name].dims)
+        if name not in values:
+            return None, None
+        return (values[name].type.tensor_type.elem_type,
+                get_static_shape(values[name]))
+
+    ops = {}
+    for node in graph.node:
+        if node.op_type in SKIPPED_OPS or node.domain not in ('', 'ai.onnx'):
+            continue
+        inputs = [ type_of(name) if name else (None, None)
+                   for name in node.input ]
+        outputs = [ type_of(name) for name in node.output ]
+        if any(name and s is None
+               for name, (_, s) in zip(node.input, inputs)) or \
+           any(s is None for _, s in outputs):
+            continue
+        attrs = { attr.name: helper.get_attribute_value(attr)
+                  for attr in node.attribute }
+        # Constant operands are part of the signature, e.g. for Reshape.
+        consts = [ numpy_helper.to_array(constants[name]).tobytes()
+                   if name in constants and
+                      get_num_elements(constants[name].dims) <= 64 else None
+                   for name in node.input ]
+        key = (node.op_type, str(inputs), str(outputs),
+               str(sorted((k, str(v)) for k, v in attrs.items())),
+               str(consts))
+        if key in ops:
+            ops[key]['count'] += 1
+            continue
+        input_shapes = [ s for _, s in inputs ]
+        output_shapes = [ s for _, s in outputs ]
+        nbytes = sum(get_num_elements(s) * get_elem_size(t)
+                     for t, s in inputs + outputs if t)
+        ops[key] = {
+            'op': node.op_type,
+            'node': node.name,
+            'inputs': [ s for s in input_shapes if s is not None ],
+            'outputs': output_shapes,
+            'attributes': { k: str(v) for k, v in attrs.items() },
+            'count': 1,
+            'flops': get_flops(node, attrs, input_shapes, output_shapes),
+            'bytes': nbytes,
+            'model': make_one_op_model(model, node, inputs, outputs,
+                                       constants),
+        }
+    return ops
+
+
+# Return a model made of a copy of the node, whose constant operands keep
+# their values and being constant.
+def make_one_op_model(model, node, inputs, outputs, constants):
+    graph_inputs, inits = [], []
+    for name, (elem_type, shape) in zip(node.input, inputs):
+        if not name:
+            continue
+        if name in constants:
+            inits.append(constants[name])
+        else:
+            graph_inputs.append(helper.make_tensor_value_info(
+                name, elem_type, shape))
+    graph_outputs = [ helper.make_tensor_value_info(name, elem_type, shape)
+                      for name, (elem_type, shape) in zip(node.output,
+                                                          outputs) ]
+    graph = helper.make_graph([node], 'benchmarked_op', graph_inputs,
+                              graph_outputs, inits)
+    one_op = helper.make_model(graph, opset_imports=model.opset_import)
+    one_op.ir_version = model.ir_version
+    return one_op
+
+
+# Compile and run the one-op model, and return its median latency in us, or
+# None if it failed.
+def time_op(one_op, tmpdir):
+    onnx_file = os.path.join(tmpdir, 'op.onnx')
+    onnx.save(one_op, onnx_file)
+    output_base = os.path.join(tmpdir, 'op')
+    ok, msg = execute(ONNX_MLIR_CMD + args.compile_args.split() +
+                      ['--EmitLib', onnx_file, '-o', output_base])
+    if not ok:
+        logger.debug('compilation failed: {}'.format(msg))
+        return None
+    ok, msg = execute(RUN_ONNX_LIB_CMD + ['-b', str(args.bench),
+                                          '-w', str(args.warmup),
+                                          output_base + '.so'])
+    lines = msg.strip().splitlines()
+    try:
+        return json.loads(lines[-1])['latency_us']['p50'] if ok else None
+    except (IndexError, KeyError, ValueError):
+        logger.debug('run failed: {}'.format(msg))
+        return None
+
+
+def main():
+    ops = get_benchmarked_ops(onnx.load(args.model))
+    if not ops:
+        logger.warning('There is no op with static shapes.')
+
+    results = []
+    for n, op in enumerate(ops.values()):
+        logger.info('Benchmarking {} {} ({}/{})'.format(op['op'], op['inputs'],
+                                                       n + 1, len(ops)))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            us = time_op(op.pop('model'), tmpdir)
+        if us is None:
+            logger.error('{} {}: benchmark failed'.format(op['op'],
+                                                          op['inputs']))
+            continue
+        op['p50_us'] = us
+        op['total_us'] = us * op['count']
+        op['gflops'] = op['flops'] / us / 1e3 if op['flops'] and us else None
+        op['gbytes_per_s'] = op['bytes'] / us / 1e3 if us else None
+        results.append(op)
+    results.sort(key=lambda op: op['total_us'], reverse=True)
+
+    total_us = sum(op['total_us'] for op in results)
+    print('{:<20} {:>5} {:>12} {:>12} {:>7} {:>9} {:>9}  {}'.format(
+        'op', 'count', 'p50 us', 'total us', 'percent', 'GFLOP/s', 'GB/s',
+        'inputs'))
+    for op in results:
+        op['percent'] = 100.0 * op['total_us'] / total_us if total_us else 0.0
+        gflops = '{:.2f}'.format(op['gflops']) if op['gflops'] else '-'
+        print('{:<20} {:>5} {:>12.1f} {:>12.1f} {:>6.2f}% {:>9} {:>9.2f}  {}'
+              .format(op['op'], op['count'], op['p50_us'], op['total_us'],
+                      op['percent'], gflops, op['gbytes_per_s'] or 0.0,
+                      op['inputs']))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({ 'model': args.model,
+                        'compile_args': args.compile_args,
+                        'ops': results }, f, indent=2)
+            f.write('\n')
+        print('Report written to ' + args.output)
+
+if __name__ == "__main__":
+    main()
@@ -67,33 +67,57 @@ auto printUsage = [](auto &out, const char *name) {
   out << R"""(
     -e name | --entry-point name
          Name of the ONNX model entry point.
-         Default is "run_main_graph".)""";
+         Default is "run_main_graph".
+    -l | --library-per-thread
+         With -b, load a copy of the model for each thread, so that
+         the threads share no state of the model.)""";
 #endif
   out << R"""(
+    -b NUM | --bench NUM
+         Benchmark the model with NUM timed iterations in total,
+         shared by the threads, and print the latency percentiles
+         and the throughput as json.
     -h | --help
          Print help message.
     -n NUM | --iterations NUM
          Number of times to run the tests, default 1.
     -m NUM | --meas NUM
          Measure the kernel execution time NUM times.
+    -q QPS | --qps QPS
+         With -b, issue the iterations at QPS per second in total,
+         and measure their latency from the time they are due.
+         Default 0, each thread runs its iterations back to back.
     -r | -reuse true|false
          Reuse input data, default on
+    -t NUM | --threads NUM
+         With -b, run the iterations from NUM threads sharing the
+         model, each with its own inputs, default 1.
     -v | --verbose
          Print the shape of the inputs and outputs.
-
+    -w NUM | --warmup NUM
+         With -b, run NUM untimed iterations on each thread first,
+         default 1.
   )""";
 };
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <dlfcn.h>
+#include <fstream>
 #include <getopt.h>
 #include <iostream>
+#include <stdlib.h>
 #include <string>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
 // Json reader & LLVM support.
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
 
 // Include ONNX-MLIR Runtime support.
 #include "OnnxMlirRuntime.h"
@@ -132,7 +156,7 @@ void (*dll_omTensorListDestroy)(OMTensorList *);
 #define OM_TENSOR_CREATE omTensorCreateWithOwnership
 #define OM_TENSOR_LIST_CREATE omTensorListCreateWithOwnership
 #define OM_TENSOR_LIST_DESTROY omTensorListDestroy
-#define OPTIONS "hn:m:vd:r:"
+#define OPTIONS "b:hn:m:q:t:vw:d:r:"
 #else
 #define RUN_MAIN_GRAPH dll_run_main_graph
 #define OM_INPUT_SIGNATURE dll_omInputSignature
@@ -140,7 +164,7 @@ void (*dll_omTensorListDestroy)(OMTensorList *);
 #define OM_TENSOR_CREATE dll_omTensorCreateWithOwnership
 #define OM_TENSOR_LIST_CREATE dll_omTensorListCreateWithOwnership
 #define OM_TENSOR_LIST_DESTROY dll_omTensorListDestroy
-#define OPTIONS "e:hn:m:vd:r:"
+#define OPTIONS "b:e:hln:m:q:t:vw:d:r:"
 #endif
 
 // Global variables to record what we should do in this run.
@@ -149,24 +173,44 @@ static bool verbose = false;
 static bool reuseInput = true;
 static bool measureExecTime = false;
 static vector<int64_t> dimKnownAtRuntime;
+// Benchmark mode, enabled by a positive number of timed iterations.
+static int benchIterations = 0;
+static int warmupIterations = 1;
+static int benchThreads = 1;
+static double targetQPS = 0;
+static bool libraryPerThread = false;
+static double loadTimeInSec = 0;
+static string modelName;
+static string modelEntryPointName;
 
 void usage(const char *name) {
   printUsage(cout, name);
   exit(1);
 }
 
-void loadDLL(string name, string entryPointName) {
-  cout << "Load model file " << name << " with entry point " << entryPointName
-       << endl;
+// Open the model library, looking it up in the current dir too.
+void *openDLL(string &name) {
   void *handle = dlopen(name.c_str(), RTLD_LAZY);
   if (!handle) {
     string qualifiedName = "./" + name;
     cout << "  Did not find model, try in current dir " << qualifiedName
          << endl;
     handle = dlopen(qualifiedName.c_str(), RTLD_LAZY);
+    if (handle)
+      name = qualifiedName;
   }
   assert(handle && "Error loading the model's dll file; you may have provide a "
                    "fully qualified path");
+  return handle;
+}
+
+void loadDLL(string name, string entryPointName) {
+  cout << "Load model file " << name << " with entry point " << entryPointName
+       << endl;
+  chrono::steady_clock::time_point loadStartTime = chrono::steady_clock::now();
+  void *handle = openDLL(name);
+  modelName = name;
+  modelEntryPointName = entryPointName;
   dll_run_main_graph = (OMTensorList * (*)(OMTensorList *))
       dlsym(handle, entryPointName.c_str());
   assert(!dlerror() && "failed to load entry point");
@@ -187,6 +231,9 @@ void loadDLL(string name, string entryPointName) {
   dll_omTensorListDestroy =
       (void (*)(OMTensorList *))dlsym(handle, "omTensorListDestroy");
   assert(!dlerror() && "failed to load omTensorListDestroy");
+  loadTimeInSec =
+      chrono::duration<double>(chrono::steady_clock::now() - loadStartTime)
+          .count();
 }
 
 // Parse input arguments.
@@ -195,13 +242,18 @@ void parseArgs(int argc, char **argv) {
   int c;
   string entryPointName("run_main_graph");
   static struct option long_options[] = {
-      {"dim", required_argument, 0, 'd'},         // dimensions.
-      {"entry-point", required_argument, 0, 'e'}, // Entry point.
-      {"help", no_argument, 0, 'h'},              // Help.
-      {"iterations", required_argument, 0, 'n'},  // Number of iterations.
-      {"meas", required_argument, 0, 'm'},        // Measurement of time.
-      {"reuse", required_argument, 0, 'r'},       // cached input.
-      {"verbose", no_argument, 0, 'v'},           // Verbose.
+      {"bench", required_argument, 0, 'b'},        // Benchmark mode.
+      {"dim", required_argument, 0, 'd'},          // dimensions.
+      {"entry-point", required_argument, 0, 'e'},  // Entry point.
+      {"help", no_argument, 0, 'h'},               // Help.
+      {"iterations", required_argument, 0, 'n'},   // Number of iterations.
+      {"library-per-thread", no_argument, 0, 'l'}, // Library per thread.
+      {"meas", required_argument, 0, 'm'},         // Measurement of time.
+      {"qps", required_argument, 0, 'q'},          // Target load.
+      {"reuse", required_argument, 0, 'r'},        // cached input.
+      {"threads", required_argument, 0, 't'},      // Number of threads.
+      {"verbose", no_argument, 0, 'v'},            // Verbose.
+      {"warmup", required_argument, 0, 'w'},       // Warmup iterations.
       {0, 0, 0, 0}};
 
   while (true) {
@@ -212,6 +264,9 @@ void parseArgs(int argc, char **argv) {
     switch (c) {
     case 0:
       break;
+    case 'b':
+      benchIterations = atoi(optarg);
+      break;
     case 'd': {
       // Read json array for undefined values.
       dimKnownAtRuntime.clear();
@@ -231,6 +286,9 @@ void parseArgs(int argc, char **argv) {
     case 'e':
       entryPointName = optarg;
       break;
+    case 'l':
+      libraryPerThread = true;
+      break;
     case 'n':
       sIterations = atoi(optarg);
       break;
@@ -254,9 +312,18 @@ void parseArgs(int argc, char **argv) {
         usage(argv[0]);
       }
       break;
+    case 'q':
+      targetQPS = atof(optarg);
+      break;
+    case 't':
+      benchThreads = atoi(optarg);
+      break;
     case 'v':
       verbose = true;
       break;
+    case 'w':
+      warmupIterations = atoi(optarg);
+      break;
     default:
       usage(argv[0]);
     }
@@ -264,6 +331,12 @@ void parseArgs(int argc, char **argv) {
   // Make sure that iterations are positive.
   if (sIterations < 1)
     sIterations = 1;
+  if (benchThreads < 1)
+    benchThreads = 1;
+  if (warmupIterations < 0)
+    warmupIterations = 0;
+  if (targetQPS < 0)
+    targetQPS = 0;
 
 // Process the DLL.
 #if LOAD_MODEL_STATICALLY
@@ -271,6 +344,11 @@ void parseArgs(int argc, char **argv) {
     cout << "Error: model.so was compiled in, cannot provide one now" << endl;
     usage(argv[0]);
   }
+  if (libraryPerThread) {
+    cout << "Error: model.so was compiled in, cannot load it per thread"
+         << endl;
+    usage(argv[0]);
+  }
 #else
   if (optind == argc) {
     cout << "Error: need one model.so dynamic library" << endl;
@@ -467,10 +545,171 @@ void displayTime() {
   }
 }
 
+// Entry points of a model library used by the benchmark threads.
+struct ModelLibrary {
+  OMTensorList *(*runMainGraph)(OMTensorList *);
+  void (*tensorListDestroy)(OMTensorList *);
+};
+
+// State of a benchmark thread, with the latencies of its timed iterations.
+struct BenchThread {
+  ModelLibrary library;
+  OMTensorList *input;
+  vector<double> latencyInMicroSec;
+  chrono::steady_clock::time_point lastStopTime;
+};
+
+#if !LOAD_MODEL_STATICALLY
+// Load a private copy of the model library, since the dynamic loader loads a
+// library only once per process. The copy is removed once loaded, and its
+// constants file, if any, is still looked up in the directory of the model.
+ModelLibrary loadDLLCopy() {
+  size_t sep = modelName.rfind('/');
+  string modelDir = sep == string::npos ? "." : modelName.substr(0, sep);
+  setenv("OM_CONSTANTS_PATH", modelDir.c_str(), /*overwrite=*/0);
+  char copyName[] = "/tmp/run-onnx-lib-XXXXXX";
+  int fd = mkstemp(copyName);
+  assert(fd >= 0 && "failed to create a copy of the model");
+  close(fd);
+  {
+    ifstream from(modelName, ios::binary);
+    ofstream to(copyName, ios::binary | ios::trunc);
+    to << from.rdbuf();
+    assert(from && to && "failed to copy the model");
+  }
+  void *handle = dlopen(copyName, RTLD_LAZY | RTLD_LOCAL);
+  unlink(copyName);
+  assert(handle && "failed to load a copy of the model");
+  ModelLibrary library;
+  library.runMainGraph = (OMTensorList * (*)(OMTensorList *))
+      dlsym(handle, modelEntryPointName.c_str());
+  assert(!dlerror() && "failed to load entry point");
+  library.tensorListDestroy =
+      (void (*)(OMTensorList *))dlsym(handle, "omTensorListDestroy");
+  assert(!dlerror() && "failed to load omTensorListDestroy");
+  return library;
+}
+#endif
+
+// Return the p-th percentile of sorted values, by the nearest rank method.
+double percentile(const vector<double> &sorted, double p) {
+  size_t rank = (size_t)ceil(p / 100 * sorted.size());
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Run the benchmark: each thread runs its warmup iterations, then the threads
+// share the timed iterations. Without target load, each thread runs its
+// iterations back to back and their latency is their run time. With a target
+// load, iteration k is due k / QPS seconds after the start, and its latency
+// is measured from then, so that the time waiting for a thread is counted.
+void benchmark() {
+  vector<BenchThread> threads(benchThreads);
+  for (BenchThread &thread : threads) {
+    thread.library = {RUN_MAIN_GRAPH, OM_TENSOR_LIST_DESTROY};
+#if !LOAD_MODEL_STATICALLY
+    if (libraryPerThread)
+      thread.library = loadDLLCopy();
+#endif
+    thread.input =
+        omTensorListCreateFromInputSignature(nullptr, true, false, true);
+    assert(thread.input && "failed to scan signature");
+  }
+
+  // Time a first inference alone, which takes the one time costs such as
+  // faulting in the library and its constants.
+  chrono::steady_clock::time_point firstStartTime = chrono::steady_clock::now();
+  OMTensorList *firstOutput = threads[0].library.runMainGraph(threads[0].input);
+  chrono::duration<double, micro> firstLatency =
+      chrono::steady_clock::now() - firstStartTime;
+  if (firstOutput)
+    threads[0].library.tensorListDestroy(firstOutput);
+
+  cout << "Start benchmarking " << benchIterations << " iterations on "
+       << benchThreads << " threads after " << warmupIterations
+       << " warmup iterations" << endl;
+  atomic<int> numReadyThreads(0);
+  atomic<bool> started(false);
+  atomic<int64_t> nextIteration(0);
+  chrono::steady_clock::time_point startTime;
+  chrono::duration<double> period(targetQPS > 0 ? 1 / targetQPS : 0);
+  auto runThread = [&](BenchThread &thread) {
+    ModelLibrary &library = thread.library;
+    for (int i = 0; i < warmupIterations; ++i) {
+      OMTensorList *output = library.runMainGraph(thread.input);
+      if (output)
+        library.tensorListDestroy(output);
+    }
+    numReadyThreads++;
+    while (!started)
+      this_thread::yield();
+    for (int64_t i = nextIteration++; i < benchIterations;
+         i = nextIteration++) {
+      chrono::steady_clock::time_point dueTime =
+          startTime + chrono::duration_cast<chrono::steady_clock::duration>(
+                          period * (double)i);
+      if (targetQPS > 0)
+        this_thread::sleep_until(dueTime);
+      else
+        dueTime = chrono::steady_clock::now();
+      OMTensorList *output = library.runMainGraph(thread.input);
+      thread.lastStopTime = chrono::steady_clock::now();
+      if (output)
+        library.tensorListDestroy(output);
+      thread.latencyInMicroSec.emplace_back(
+          chrono::duration<double, micro>(thread.lastStopTime - dueTime)
+              .count());
+    }
+  };
+  vector<std::thread> workers;
+  for (BenchThread &thread : threads)
+    workers.emplace_back(runThread, std::ref(thread));
+  while (numReadyThreads < benchThreads)
+    this_thread::yield();
+  startTime = chrono::steady_clock::now();
+  started = true;
+  for (std::thread &worker : workers)
+    worker.join();
+
+  vector<double> latencies;
+  chrono::steady_clock::time_point stopTime = startTime;
+  for (BenchThread &thread : threads) {
+    latencies.insert(latencies.end(), thread.latencyInMicroSec.begin(),
+        thread.latencyInMicroSec.end());
+    if (!thread.latencyInMicroSec.empty())
+      stopTime = max(stopTime, thread.lastStopTime);
+    OM_TENSOR_LIST_DESTROY(thread.input);
+  }
+  sort(latencies.begin(), latencies.end());
+  double duration = chrono::duration<double>(stopTime - startTime).count();
+  double mean = 0;
+  for (double latency : latencies)
+    mean += latency;
+  mean /= latencies.size();
+
+  llvm::json::Object latency{{"min", latencies.front()}, {"mean", mean},
+      {"p50", percentile(latencies, 50)}, {"p90", percentile(latencies, 90)},
+      {"p99", percentile(latencies, 99)},
+      {"p99.9", percentile(latencies, 99.9)}, {"max", latencies.back()}};
+  llvm::json::Object report{{"model", modelName}, {"threads", benchThreads},
+      {"library_per_thread", libraryPerThread}, {"load_s", loadTimeInSec},
+      {"first_inference_us", firstLatency.count()},
+      {"warmup_iterations", warmupIterations},
+      {"iterations", benchIterations}, {"target_qps", targetQPS},
+      {"duration_s", duration},
+      {"throughput_qps", duration > 0 ? latencies.size() / duration : 0.0},
+      {"latency_us", std::move(latency)}};
+  llvm::outs() << llvm::json::Value(std::move(report)) << "\n";
+  llvm::outs().flush();
+}
+
 // Perform generation of input, run, measure time,...
 int main(int argc, char **argv) {
   // Init args.
   parseArgs(argc, argv);
+  if (benchIterations > 0) {
+    benchmark();
+    return 0;
+  }
   // Init inputs.
   OMTensorList *tensorListIn =
       omTensorListCreateFromInputSignature(nullptr, true, verbose, false);
@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+
+################### RunONNXModelZooBenchmark.py ################################
+#
+# Copyright 2023 The IBM Research Authors.
+#
+################################################################################
+#
+# This script is used to benchmark models in https://github.com/onnx/models
+# end to end, from their compilation to their steady state inferences.
+#
+################################################################################
+
+import argparse
+import json
+import logging
+import os
+import platform
+import subprocess
+import sys
+import tarfile
+import tempfile
+import time
+
+from datetime import datetime
+
+"""
+Note:
+    - This script downloads the selected models from the model zoo, unless
+      they are already in the work dir.
+    - Environment variable ONNX_MLIR_HOME is needed to find onnx-mlir and
+      run-onnx-lib, which must be built for dynamically loaded models with
+      utils/build-run-onnx-lib.sh.
+    - Each model is compiled with each option set given by `-c`, and run in
+      the benchmark mode of run-onnx-lib.
+    - For each model and option set, the report records the compile time,
+      the size of the .so, its load time, the latency of a first inference,
+      the steady state latency percentiles and throughput, and the peak RSS
+      of the compiler and of the run.
+
+Example:
+    $ ONNX_MLIR_HOME=/onnx-mlir/build/Release/ /onnx-mlir/utils/RunONNXModelZooBenchmark.py -m "resnet50-v1-12 mobilenetv2-12" --compile-args=-O2 --compile-args="-O3 --parallel" -o report.json
+"""
+
+if (not os.environ.get('ONNX_MLIR_HOME', None)):
+    raise RuntimeError(
+        "Environment variable ONNX_MLIR_HOME is not set, please set it to the path to "
+        "the HOME directory for onnx-mlir. The HOME directory for onnx-mlir refers to "
+        "the parent folder containing the bin, lib, etc. sub-folders in which ONNX-MLIR "
+        "executables and libraries can be found.")
+
+LOG_LEVEL = { 'debug':    logging.DEBUG,
+              'info':     logging.INFO,
+              'warning':  logging.WARNING,
+              'error':    logging.ERROR,
+              'critical': logging.CRITICAL }
+
+ONNX_MODEL_ZOO_DOWNLOAD = 'https://github.com/onnx/models/raw/main'
+
+"""Commands will be called in this script.
+"""
+ONNX_MLIR_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin', 'onnx-mlir')]
+RUN_ONNX_LIB_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin',
+                                 'run-onnx-lib')]
+# Use curl instead of wget since most systems have curl preinstalled
+# and curl is more flexible than wget
+CURL_CMD = ['curl', '--insecure', '--retry', '50', '--location', '--silent']
+
+# Models benchmarked by default, by their path in the model zoo.
+MODEL_PATHS = {
+    'resnet50-v1-12':
+        'vision/classification/resnet/model/resnet50-v1-12.tar.gz',
+    'mobilenetv2-12':
+        'vision/classification/mobilenet/model/mobilenetv2-12.tar.gz',
+    'bertsquad-12':
+        'text/machine_comprehension/bert-squad/model/bertsquad-12.tar.gz',
+    'yolov4':
+        'vision/object_detection_segmentation/yolov4/model/yolov4.tar.gz',
+    'gpt2-10':
+        'text/machine_comprehension/gpt-2/model/gpt2-10.tar.gz',
+}
+
+# Values of the dynamic dimensions of the model inputs, passed to
+# run-onnx-lib with -d, namely a batch size of 1 and, for GPT-2, a sequence of
+# 8 tokens. Models not listed have no dynamic dimensions.
+MODEL_DIMS = {
+    'resnet50-v1-12': '[1]',
+    'mobilenetv2-12': '[1]',
+    'bertsquad-12':   '[1, 1, 1, 1]',
+    'yolov4':         '[1]',
+    'gpt2-10':        '[1, 1, 8]',
+}
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-b',
+                        '--bench',
+                        type=int,
+                        default=100,
+                        help="Number of timed inferences per model, default 100.")
+    parser.add_argument('-c',
+                        '--compile-args',
+                        action='append',
+                        help="Option set passed to onnx-mlir to compile the models."
+                        " Repeat to compare several option sets, e.g. --compile-args=-O2"
+                        " --compile-args=\"-O3 --parallel\". Default -O3.")
+    parser.add_argument('-d',
+                        '--dims',
+                        action='append',
+                        default=[],
+                        metavar='model_name=json_array',
+                        help="Values of the dynamic dimensions of the inputs of a"
+                        " model, overriding the default ones, e.g."
+                        " 'gpt2-10=[1, 1, 32]'.")
+    parser.add_argument('-k',
+                        '--keep-models',
+                        action='store_true',
+                        help="Keep the pulled models.")
+    parser.add_argument('-l',
+                        '--log-level',
+                        choices=[ 'debug', 'info', 'warning', 'error', 'critical' ],
+                        default='info',
+                        help="log level, default info")
+    parser.add_argument('-m',
+                        '--model',
+                        metavar='model_name',
+                        default=' '.join(MODEL_PATHS.keys()),
+                        help="List of models to benchmark, by name for the default"
+                        " ones or by their path in the model zoo, e.g."
+                        " 'resnet50-v1-12 vision/classification/squeezenet/model/"
+                        "squeezenet1.0-12.tar.gz'. Default all of "
+                        + ', '.join(MODEL_PATHS.keys()) + ".")
+    parser.add_argument('-o',
+                        '--output',
+                        default='modelzoo-benchmark.json',
+                        help="Json report file, default modelzoo-benchmark.json.")
+    parser.add_argument('-t',
+                        '--threads',
+                        type=int,
+                        default=1,
+                        help="Number of threads running the timed inferences,"
+                        " default 1.")
+    parser.add_argument('-w',
+                        '--workdir',
+                        default=os.getcwd(),
+                        help="Work dir for downloading, default cwd.")
+    parser.add_argument('--warmup',
+                        type=int,
+                        default=10,
+                        help="Number of untimed inferences per thread, default 10.")
+    return parser.parse_args()
+
+
+# log to stderr so that stdout can be used for the summary
+def get_logger():
+    logging.basicConfig(stream=sys.stderr,
+                        level=LOG_LEVEL[args.log_level],
+                        format='[%(asctime)s] %(levelname)s: %(message)s')
+    return logging.getLogger('RunONNXModelZooBenchmark.py')
+
+args = get_args()
+logger = get_logger()
+
+
+# Run a command, and return whether it succeeded, its output, its wall time in
+# seconds, and its peak RSS in KB, namely the maximum resident set size of the
+# process reported by wait4, or None where wait4 is not available.
+def execute_and_measure(cmds, cwd=None):
+    logger.debug('cmd={} cwd={}'.format(' '.join(cmds), cwd))
+    start = time.monotonic()
+    process = subprocess.Popen(cmds, cwd=cwd,
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT,
+                               universal_newlines=True)
+    if not hasattr(os, 'wait4'):
+        stdout, _ = process.communicate()
+        return (process.returncode == 0, stdout, time.monotonic() - start, None)
+
+    stdout = process.stdout.read()
+    process.stdout.close()
+    _, status, rusage = os.wait4(process.pid, 0)
+    wall_time = time.monotonic() - start
+    # Record the exit status so that Popen does not wait for the process again.
+    process.returncode = os.waitstatus_to_exitcode(status)
+    peak_rss_kb = rusage.ru_maxrss
+    if platform.system() == 'Darwin':
+        # ru_maxrss is in bytes on macOS, and in KB on Linux.
+        peak_rss_kb //= 1024
+    return (process.returncode == 0, stdout, wall_time, peak_rss_kb)
+
+
+# Download the model unless already in the work dir, and return the path of
+# its .tar.gz.
+def pull_model(model_path, work_dir):
+    model_tar_gz = os.path.join(work_dir, model_path.split('/')[-1])
+    if os.path.exists(model_tar_gz):
+        return model_tar_gz
+    model_url = ONNX_MODEL_ZOO_DOWNLOAD + '/' + model_path
+    logger.info('Downloading {}'.format(model_url))
+    ok, msg, _, _ = execute_and_measure(
+        CURL_CMD + [model_url, '--output', model_tar_gz], cwd=work_dir)
+    if not ok or not os.path.exists(model_tar_gz):
+        logger.error('failed to download {}: {}'.format(model_url, msg))
+        return None
+    return model_tar_gz
+
+
+# Compile and run the model with one option set, and return its results.
+def benchmark_model(model_name, onnx_file, compile_args, dims, tmpdir):
+    result = { 'model': model_name, 'compile_args': compile_args,
+               'status': 'failed' }
+
+    # Compile, timing the compiler and measuring its peak RSS.
+    output_base = os.path.join(tmpdir, 'model')
+    logger.info('Compiling {} with "{}"'.format(model_name, compile_args))
+    ok, msg, compile_time, compile_rss_kb = execute_and_measure(
+        ONNX_MLIR_CMD + compile_args.split() +
+        ['--EmitLib', onnx_file, '-o', output_base])
+    if not ok:
+        logger.error('[{}] compilation failed: {}'.format(model_name, msg))
+        result['error'] = 'compilation failed'
+        return result
+    so_file = output_base + '.so'
+    result['compile_s'] = round(compile_time, 3)
+    result['compile_peak_rss_kb'] = compile_rss_kb
+    result['so_bytes'] = os.path.getsize(so_file)
+
+    # Run, reading the json report on the last line of run-onnx-lib.
+    logger.info('Running {} for {} iterations'.format(model_name, args.bench))
+    options = ['-b', str(args.bench), '-w', str(args.warmup),
+               '-t', str(args.threads)]
+    if dims:
+        options += ['-d', dims]
+    ok, msg, _, run_rss_kb = execute_and_measure(
+        RUN_ONNX_LIB_CMD + options + [so_file])
+    lines = msg.strip().splitlines()
+    report = None
+    if ok and lines:
+        try:
+            report = json.loads(lines[-1])
+        except ValueError:
+            pass
+    if not report:
+        logger.error('[{}] run failed: {}'.format(model_name, msg))
+        result['error'] = 'run failed'
+        return result
+    latency = report['latency_us']
+    result['load_s'] = report['load_s']
+    result['first_inference_us'] = report['first_inference_us']
+    result['p50_us'] = latency['p50']
+    result['p99_us'] = latency['p99']
+    result['mean_us'] = latency['mean']
+    result['throughput_qps'] = report['throughput_qps']
+    result['run_peak_rss_kb'] = run_rss_kb
+    result['status'] = 'passed'
+    return result
+
+
+# Benchmark a model with all the option sets, extracting it once.
+def pull_and_benchmark_model(model_name, model_path, compile_args_list,
+                             dims, work_dir):
+    model_tar_gz = pull_model(model_path, work_dir)
+    if not model_tar_gz:
+        return [ { 'model': model_name, 'compile_args': compile_args,
+                   'status': 'failed', 'error': 'download failed' }
+                 for compile_args in compile_args_list ]
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmpdir:
+        logger.debug('Extracting the .tar.gz to {}'.format(tmpdir))
+        with tarfile.open(model_tar_gz, 'r:gz') as tgz:
+            tgz.extractall(tmpdir)
+        # ignore files starting with "." created by Mac OSX!
+        onnx_files = sorted(
+            os.path.join(root, f) for root, _, files in os.walk(tmpdir)
+            for f in files if f.endswith('.onnx') and not f.startswith('.'))
+        if not onnx_files:
+            logger.warning('There is no .onnx file for {}. Ignored.'.format(
+                model_name))
+        for compile_args in compile_args_list:
+            if not onnx_files:
+                results.append({ 'model': model_name,
+                                 'compile_args': compile_args,
+                                 'status': 'failed', 'error': 'no .onnx file' })
+                continue
+            results.append(benchmark_model(model_name, onnx_files[0],
+                                           compile_args, dims, tmpdir))
+
+    if not args.keep_models:
+        # remove the model to save the storage space.
+        os.remove(model_tar_gz)
+    return results
+
+
+def main():
+    work_dir = os.path.realpath(args.workdir)
+    compile_args_list = args.compile_args if args.compile_args else ['-O3']
+
+    dims = dict(MODEL_DIMS)
+    for d in args.dims:
+        name, sep, value = d.partition('=')
+        if not sep:
+            logger.error('expected model_name=json_array for -d, got ' + d)
+            sys.exit(1)
+        dims[name] = value
+
+    # Models are given by name for the default ones, or by path in the zoo.
+    results = []
+    for model in args.model.split():
+        model_path = MODEL_PATHS.get(model, model)
+        model_name = model_path.split('/')[-1]
+        if model_name.endswith('.tar.gz'):
+            model_name = model_name[:-len('.tar.gz')]
+        results += pull_and_benchmark_model(model_name, model_path,
+                                            compile_args_list,
+                                            dims.get(model_name), work_dir)
+
+    report = { 'date':     datetime.now().strftime("%Y-%m-%d %H:%M:%S"),
+               'commit':   os.getenv('ONNX_MLIR_HEAD_COMMIT_HASH', ''),
+               'machine':  platform.machine(),
+               'bench':    args.bench,
+               'warmup':   args.warmup,
+               'threads':  args.threads,
+               'results':  results }
+    with open(args.output, 'w') as f:
+        json.dump(report, f, indent=2)
+        f.write('\n')
+
+    # Output summary to stdout
+    print('{:<20} {:<24} {:>10} {:>12} {:>10} {:>10} {:>10} {:>12}'.format(
+        'model', 'compile args', 'compile s', 'so bytes', 'p50 us', 'p99 us',
+        'qps', 'run RSS KB'))
+    for r in results:
+        if r['status'] != 'passed':
+            print('{:<20} {:<24} {}'.format(r['model'], r['compile_args'],
+                                            r['error']))
+            continue
+        print('{:<20} {:<24} {:>10.2f} {:>12} {:>10.1f} {:>10.1f} {:>10.1f} {:>12}'
+              .format(r['model'], r['compile_args'], r['compile_s'],
+                      r['so_bytes'], r['p50_us'], r['p99_us'],
+                      r['throughput_qps'], r['run_peak_rss_kb']))
+    print('Report written to ' + args.output)
+
+    failed = [ r for r in results if r['status'] != 'passed' ]
+    sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+    main()
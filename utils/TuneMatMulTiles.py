@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+
+######################## TuneMatMulTiles.py ####################################
+#
+# Copyright 2023 The IBM Research Authors.
+#
+################################################################################
+#
+# This script autotunes the register and cache tile sizes of the MatMul and
+# Gemm ops of a model on the host, and records the best ones in a tuning
+# database that onnx-mlir reads with --matmul-tile-db.
+#
+################################################################################
+
+import argparse
+import json
+import logging
+import os
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+import onnx
+from onnx import helper, numpy_helper, shape_inference
+
+"""
+Note:
+    - Environment variable ONNX_MLIR_HOME is needed to find onnx-mlir and
+      run-onnx-lib, which must be built for dynamically loaded models with
+      utils/build-run-onnx-lib.sh.
+    - The tuned ops are the 2D MatMul ops and the Gemm ops of the model whose
+      shapes are static after shape inference. Each distinct shape is tuned
+      once, on a model made of a single op of that shape.
+    - The candidate tile sizes are compiled with the tile sizes given to
+      onnx-mlir by a database made of the candidate only, and timed in the
+      benchmark mode of run-onnx-lib. The sizes are tuned one at a time,
+      keeping the best value of each before tuning the next one.
+    - With --blas-library, each shape is also timed with the external BLAS
+      library, and the faster backend is recorded in the entry, "blas" or
+      "krnl" for the generated code. Compile with the same --blas-library
+      for the shapes of the "blas" backend to be computed by the library.
+    - The best tile sizes are merged into the output database under the
+      --mcpu given, replacing the entries of the same cpu, op and shape. Use
+      the same --mcpu when compiling with the database.
+
+Example:
+    $ ONNX_MLIR_HOME=/onnx-mlir/build/Release/ /onnx-mlir/utils/TuneMatMulTiles.py --mcpu=z16 -o tiles.json model.onnx
+    $ onnx-mlir -O3 --mcpu=z16 --matmul-tile-db=tiles.json model.onnx
+"""
+
+if (not os.environ.get('ONNX_MLIR_HOME', None)):
+    raise RuntimeError(
+        "Environment variable ONNX_MLIR_HOME is not set, please set it to the path to "
+        "the HOME directory for onnx-mlir. The HOME directory for onnx-mlir refers to "
+        "the parent folder containing the bin, lib, etc. sub-folders in which ONNX-MLIR "
+        "executables and libraries can be found.")
+
+LOG_LEVEL = { 'debug':    logging.DEBUG,
+              'info':     logging.INFO,
+              'warning':  logging.WARNING,
+              'error':    logging.ERROR,
+              'critical': logging.CRITICAL }
+
+"""Commands will be called in this script.
+"""
+ONNX_MLIR_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin', 'onnx-mlir')]
+RUN_ONNX_LIB_CMD = [os.path.join(os.environ['ONNX_MLIR_HOME'], 'bin',
+                                 'run-onnx-lib')]
+
+# Default tile sizes of the lowering, the starting point of the tuning, and
+# the candidate values of each size. The K register tile of Gemm is its K
+# cache tile, so that it is not tuned separately.
+DEFAULT_TILES = {
+    'MatMul': { 'reg': [4, 8, 8] },
+    'Gemm':   { 'reg': [4, 16, 8], 'cache': [32, 64, 256] },
+}
+CANDIDATES = {
+    'MatMul': [ ('reg', 0, [1, 2, 4, 8]),
+                ('reg', 1, [4, 8, 16, 32]),
+                ('reg', 2, [4, 8, 16, 32]) ],
+    'Gemm':   [ ('reg', 0, [2, 4, 8]),
+                ('reg', 1, [4, 8, 16, 32]),
+                ('cache', 0, [16, 32, 64, 128]),
+                ('cache', 1, [32, 64, 128, 256]),
+                ('cache', 2, [64, 128, 256, 512]) ],
+}
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('model',
+                        help="ONNX model whose MatMul and Gemm ops are tuned.")
+    parser.add_argument('--blas-library',
+                        default='',
+                        help="CBLAS library also timed for each shape, e.g."
+                        " openblas, passed to onnx-mlir.")
+    parser.add_argument('-b',
+                        '--bench',
+                        type=int,
+                        default=50,
+                        help="Number of timed inferences per candidate, default 50.")
+    parser.add_argument('-c',
+                        '--compile-args',
+                        default='-O3',
+                        help="Options passed to onnx-mlir to compile the candidates,"
+                        " default -O3.")
+    parser.add_argument('-l',
+                        '--log-level',
+                        choices=[ 'debug', 'info', 'warning', 'error', 'critical' ],
+                        default='info',
+                        help="log level, default info")
+    parser.add_argument('-o',
+                        '--output',
+                        default='matmul-tiles.json',
+                        help="Tuning database, updated if it exists, default"
+                        " matmul-tiles.json.")
+    parser.add_argument('--mcpu',
+                        required=True,
+                        help="Target cpu of the tuned sizes, passed to onnx-mlir.")
+    parser.add_argument('--warmup',
+                        type=int,
+                        default=5,
+                        help="Number of untimed inferences per candidate, default 5.")
+    return parser.parse_args()
+
+
+# log to stderr so that stdout can be used for the summary
+def get_logger():
+    logging.basicConfig(stream=sys.stderr,
+                        level=LOG_LEVEL[args.log_level],
+                        format='[%(asctime)s] %(levelname)s: %(message)s')
+    return logging.getLogger('TuneMatMulTiles.py')
+
+args = get_args()
+logger = get_logger()
+
+
+def execute(cmds):
+    logger.debug('cmd={}'.format(' '.join(cmds)))
+    process = subprocess.run(cmds, stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT, universal_newlines=True)
+    return (process.returncode == 0, process.stdout)
+
+
+# Return the static shape of a value, or None if it is not fully known.
+def get_static_shape(value_info):
+    dims = value_info.type.tensor_type.shape.dim
+    if not all(d.HasField('dim_value') for d in dims):
+        return None
+    return [d.dim_value for d in dims]
+
+
+# Return the one-op models to tune, by op and (I, J, K) sizes, for the 2D
+# MatMul ops and the Gemm ops with static shapes.
+def get_tuned_ops(model):
+    model = shape_inference.infer_shapes(model)
+    graph = model.graph
+    values = {}
+    for v in list(graph.input) + list(graph.value_info) + list(graph.output):
+        values[v.name] = v
+    initializers = { i.name: i for i in graph.initializer }
+    elem_types = {}
+    for v in values.values():
+        elem_types[v.name] = v.type.tensor_type.elem_type
+    for i in graph.initializer:
+        elem_types[i.name] = i.data_type
+
+    def shape_of(name):
+        if name in initializers:
+            return list(initializers[name].dims)
+        return get_static_shape(values[name]) if name in values else None
+
+    ops = {}
+    for node in graph.node:
+        if node.op_type not in ('MatMul', 'Gemm'):
+            continue
+        shapes = [ shape_of(name) for name in node.input if name ]
+        if any(s is None or len(s) > 2 for s in shapes):
+            continue
+        a, b = shapes[0], shapes[1]
+        if len(a) != 2 or len(b) != 2:
+            continue
+        attrs = { attr.name: helper.get_attribute_value(attr)
+                  for attr in node.attribute }
+        if node.op_type == 'Gemm':
+            I, K = (a[1], a[0]) if attrs.get('transA', 0) else (a[0], a[1])
+            J = b[0] if attrs.get('transB', 0) else b[1]
+        else:
+            I, K, J = a[0], a[1], b[1]
+        key = (node.op_type, I, J, K)
+        if key not in ops:
+            ops[key] = make_one_op_model(node, shapes, initializers,
+                                          elem_types[node.input[0]])
+    return ops
+
+
+# Return a model made of a copy of the node, whose constant operands keep
+# being constant, e.g. for a constant B of Gemm to be packed.
+def make_one_op_model(node, shapes, initializers, elem_type):
+    inputs, inits = [], []
+    for n, name in enumerate(node.input):
+        if name in initializers:
+            init = initializers[name]
+            array = np.random.uniform(
+                -1.0, 1.0, list(init.dims)).astype(
+                    onnx.helper.tensor_dtype_to_np_dtype(init.data_type))
+            inits.append(numpy_helper.from_array(array, name))
+        elif name:
+            inputs.append(helper.make_tensor_value_info(name, elem_type,
+                                                        shapes[n]))
+    output = helper.make_tensor_value_info(node.output[0], elem_type, None)
+    graph = helper.make_graph([node], 'tuned_op', inputs, [output], inits)
+    model = helper.make_model(graph)
+    model.opset_import[0].version = 13
+    return shape_inference.infer_shapes(model)
+
+
+# Compile and run the one-op model with the given tile sizes, and return its
+# median latency in us, or None if it failed.
+def time_candidate(op, shape, tiles, onnx_file, tmpdir, extra_args=[]):
+    db_file = os.path.join(tmpdir, 'candidate.json')
+    entry = { 'mcpu': args.mcpu, 'op': op, 'shape': list(shape) }
+    entry.update(tiles)
+    with open(db_file, 'w') as f:
+        json.dump({ 'matmul_tiles': [ entry ] }, f)
+
+    output_base = os.path.join(tmpdir, 'model')
+    ok, msg = execute(ONNX_MLIR_CMD + args.compile_args.split() +
+                      ['--mcpu=' + args.mcpu, '--matmul-tile-db=' + db_file,
+                       '--EmitLib', onnx_file, '-o', output_base] + extra_args)
+    if not ok:
+        logger.debug('compilation of {} failed: {}'.format(tiles, msg))
+        return None
+    ok, msg = execute(RUN_ONNX_LIB_CMD + ['-b', str(args.bench),
+                                          '-w', str(args.warmup),
+                                          output_base + '.so'])
+    lines = msg.strip().splitlines()
+    try:
+        return json.loads(lines[-1])['latency_us']['p50'] if ok else None
+    except (IndexError, KeyError, ValueError):
+        logger.debug('run of {} failed: {}'.format(tiles, msg))
+        return None
+
+
+# Tune the sizes one at a time, and return the best tile sizes and latency.
+def tune_op(op, shape, model, tmpdir):
+    onnx_file = os.path.join(tmpdir, 'op.onnx')
+    onnx.save(model, onnx_file)
+    best = json.loads(json.dumps(DEFAULT_TILES[op]))
+    best_us = time_candidate(op, shape, best, onnx_file, tmpdir)
+    if best_us is None:
+        logger.error('{} {}: default tile sizes failed'.format(op, shape))
+        return None, None
+    for kind, dim, values in CANDIDATES[op]:
+        for value in values:
+            tiles = json.loads(json.dumps(best))
+            tiles[kind][dim] = value
+            # Cache tiles are blocked by register tiles.
+            if 'cache' in tiles and any(tiles['cache'][d] % tiles['reg'][d]
+                                        for d in range(2)):
+                continue
+            if tiles == best:
+                continue
+            us = time_candidate(op, shape, tiles, onnx_file, tmpdir)
+            logger.debug('{} {}: {} takes {} us'.format(op, shape, tiles, us))
+            if us is not None and us < best_us:
+                best, best_us = tiles, us
+    # Compare the best generated code with the BLAS library.
+    if args.blas_library:
+        blas = { 'backend': 'blas' }
+        us = time_candidate(op, shape, blas, onnx_file, tmpdir,
+                            ['--blas-library=' + args.blas_library])
+        logger.debug('{} {}: blas takes {} us'.format(op, shape, us))
+        if us is not None and us < best_us:
+            return blas, us
+        best['backend'] = 'krnl'
+    return best, best_us
+
+
+def main():
+    tuned_ops = get_tuned_ops(onnx.load(args.model))
+    if not tuned_ops:
+        logger.warning('There is no MatMul or Gemm op with static shapes.')
+
+    db = { 'matmul_tiles': [] }
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            db = json.load(f)
+
+    print('{:<8} {:<20} {:<36} {:>10}'.format('op', 'shape (I, J, K)',
+                                              'tiles', 'p50 us'))
+    for (op, I, J, K), model in sorted(tuned_ops.items()):
+        shape = [I, J, K]
+        logger.info('Tuning {} of shape {}'.format(op, shape))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tiles, us = tune_op(op, shape, model, tmpdir)
+        if not tiles:
+            continue
+        db['matmul_tiles'] = [ e for e in db['matmul_tiles']
+                               if (e['mcpu'], e['op'], e['shape']) !=
+                                  (args.mcpu, op, shape) ]
+        entry = { 'mcpu': args.mcpu, 'op': op, 'shape': shape }
+        entry.update(tiles)
+        db['matmul_tiles'].append(entry)
+        print('{:<8} {:<20} {:<36} {:>10.1f}'.format(op, str(shape),
+                                                     json.dumps(tiles), us))
+
+    with open(args.output, 'w') as f:
+        json.dump(db, f, indent=2)
+        f.write('\n')
+    print('Tuning database written to ' + args.output)
+
+if __name__ == "__main__":
+    main()
@@ -312,8 +312,10 @@ OpsWithCanonicalizer = [
     'Add',
     'Cast',
     'Constant',
+    'Conv',
     'DepthToSpace',
     'Dropout',
+    'Gemm',
     'GlobalAveragePool',
     'GlobalMaxPool',
     'GRU',
@@ -321,6 +323,7 @@ OpsWithCanonicalizer = [
     'Less',
     'Loop',
     'LSTM',
+    'MatMul',
     'Mul',
     'Reshape',
     'RNN',